@@ -59,6 +59,8 @@ void AudioPlayer::seek(int seconds) {
     this->vorbisProducer->seek(seconds);
 }
 
+void AudioPlayer::preload(fs::path const& file) { this->vorbisProducer->preload(file); }
+
 auto AudioPlayer::getOutputDevices() -> std::vector<DeviceInfo> { return this->portAudioConsumer->getOutputDevices(); }
 
 auto AudioPlayer::getSettings() -> Settings& { return this->settings; }
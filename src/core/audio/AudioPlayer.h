@@ -38,6 +38,11 @@ public:
     void pause();
     void seek(int seconds);
 
+    /**
+     * Open the file in the background, so that its next playback starts at once
+     */
+    void preload(fs::path const& file);
+
     std::vector<DeviceInfo> getOutputDevices();
 
     Settings& getSettings();
@@ -12,109 +12,174 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
-#include <deque>
+#include <cstdint>
+#include <iterator>
 #include <limits>
 #include <mutex>
+#include <utility>
 #include <vector>
 
+/**
+ * @brief Single producer, single consumer ring buffer of interleaved samples
+ *
+ * One side of the queue runs in a PortAudio callback, which must neither block nor allocate: emplace() and pop() only
+ * copy the samples and update the atomic positions. The buffer is allocated by setAudioAttributes(), before the
+ * streams start. A producer faster than its consumer loses the frames which do not fit (see getDroppedSamples()).
+ *
+ * The other side runs in a thread of its own, which waits for room or for samples with waitForConsumer() and
+ * waitForProducer(). The real-time side never notifies it: the waits return after POLL_INTERVAL at the latest.
+ */
 template <typename T>
 class AudioQueue {
 public:
+    /**
+     * Capacity of the queue, about 5 seconds at 48 kHz
+     */
+    static constexpr size_t CAPACITY_FRAMES = 1U << 18U;
+
+    /**
+     * Longest time between two checks of the queue by a waiting thread
+     */
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{5};
+
+    /**
+     * Empty the queue. Neither the producer nor the consumer may be running.
+     */
     void reset() {
-        std::lock_guard<std::mutex> lock(internalLock);
-        this->popNotified = false;
-        this->pushNotified = false;
-        this->streamEnd = false;
-        internalQueue.clear();
-
-        this->sampleRate = -1;
-        this->channels = 0;
+        std::lock_guard<std::mutex> lock(waitLock);
+        this->readPosition.store(0, std::memory_order_relaxed);
+        this->writePosition.store(0, std::memory_order_relaxed);
+        this->droppedSamples.store(0, std::memory_order_relaxed);
+        this->streamEnd.store(false, std::memory_order_relaxed);
+
+        this->sampleRate.store(-1, std::memory_order_relaxed);
+        this->channels.store(0, std::memory_order_relaxed);
     }
 
-    bool empty() {
-        std::lock_guard<std::mutex> lock(internalLock);
-        return internalQueue.empty();
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @return the number of samples in the queue
+     */
+    size_t size() const {
+        return this->writePosition.load(std::memory_order_acquire) - this->readPosition.load(std::memory_order_acquire);
     }
 
-    size_t size() {
-        std::lock_guard<std::mutex> lock(internalLock);
-        return internalQueue.size();
+    /**
+     * @return the number of samples the queue can hold
+     */
+    size_t capacity() const {
+        return CAPACITY_FRAMES * std::max<size_t>(this->channels.load(std::memory_order_acquire), 1);
     }
 
+    /**
+     * Append the samples, by the producer. The frames which do not fit are dropped.
+     * @return the number of samples appended
+     */
     template <typename Iter>
-    void emplace(Iter begI, Iter endI) {
-        std::lock_guard<std::mutex> lock(internalLock);
-        std::move(begI, endI, std::front_inserter(internalQueue));
+    size_t emplace(Iter begI, Iter endI) {
+        auto count = static_cast<size_t>(std::distance(begI, endI));
+        const size_t write = this->writePosition.load(std::memory_order_relaxed);
+        const size_t free = this->buffer.size() - (write - this->readPosition.load(std::memory_order_acquire));
+        const size_t frame = std::max<size_t>(this->channels.load(std::memory_order_relaxed), 1);
+
+        if (count > free) {
+            this->droppedSamples.fetch_add(count - free + free % frame, std::memory_order_relaxed);
+            count = free - free % frame;
+        }
+        if (count == 0) {
+            return 0;
+        }
 
-        this->pushNotified = true;
-        this->pushLockCondition.notify_one();
+        const size_t start = write % this->buffer.size();
+        const size_t first = std::min(count, this->buffer.size() - start);
+        auto midI = std::next(begI, static_cast<std::ptrdiff_t>(first));
+        std::move(begI, midI, std::next(this->buffer.begin(), static_cast<std::ptrdiff_t>(start)));
+        std::move(midI, std::next(midI, static_cast<std::ptrdiff_t>(count - first)), this->buffer.begin());
+
+        this->writePosition.store(write + count, std::memory_order_release);
+        return count;
     }
 
+    /**
+     * Remove up to nSamples samples, as whole frames, by the consumer
+     * @return the end of the samples written to insertIter
+     */
     template <typename InsertIter>
     InsertIter pop(InsertIter insertIter, size_t nSamples) {
-        std::lock_guard<std::mutex> lock(internalLock);
-
-        if (this->channels == 0) {
-            this->popNotified = true;
-            this->popLockCondition.notify_one();
+        const size_t frame = this->channels.load(std::memory_order_relaxed);
+        if (frame == 0) {
             return insertIter;
         }
 
+        const size_t read = this->readPosition.load(std::memory_order_relaxed);
+        const size_t available = this->writePosition.load(std::memory_order_acquire) - read;
+        const size_t count = std::min(nSamples, available - available % frame);
+        if (count == 0) {
+            return insertIter;
+        }
 
-        auto queueSize = internalQueue.size();
-        auto returnBufferLength = std::min<size_t>(nSamples, queueSize - queueSize % this->channels);
-        auto begI = rbegin(internalQueue);
-        auto endI = std::next(begI, returnBufferLength);
-
-        auto ret = std::move(begI, endI, insertIter);
-        internalQueue.erase(endI.base(), begI.base());
+        const size_t start = read % this->buffer.size();
+        const size_t first = std::min(count, this->buffer.size() - start);
+        auto begI = std::next(this->buffer.begin(), static_cast<std::ptrdiff_t>(start));
+        auto ret = std::move(begI, std::next(begI, static_cast<std::ptrdiff_t>(first)), insertIter);
+        auto wrapI = std::next(this->buffer.begin(), static_cast<std::ptrdiff_t>(count - first));
+        ret = std::move(this->buffer.begin(), wrapI, ret);
 
-        this->popNotified = true;
-        this->popLockCondition.notify_one();
+        this->readPosition.store(read + count, std::memory_order_release);
         return ret;
     }
 
     void signalEndOfStream() {
-        std::lock_guard<std::mutex> lock(internalLock);
-        this->streamEnd = true;
-        this->pushNotified = true;
-        this->popNotified = true;
-        this->pushLockCondition.notify_one();
-        this->popLockCondition.notify_one();
+        {
+            std::lock_guard<std::mutex> lock(waitLock);
+            this->streamEnd.store(true, std::memory_order_release);
+        }
+        this->waitCondition.notify_all();
     }
 
-    void waitForProducer(std::unique_lock<std::mutex>& lock) {
-        // static_assert(lock.mutex() == &this->queueLock);
-        assert(lock.mutex() == &this->queueLock);
-        while (!this->pushNotified && !hasStreamEnded()) { this->pushLockCondition.wait(lock); }
-        this->pushNotified = false;
+    /**
+     * Wait until the queue holds more than `samples` samples or the stream ended, by the consumer thread
+     * @return false if POLL_INTERVAL elapsed before
+     */
+    bool waitForProducer(size_t samples) {
+        std::unique_lock<std::mutex> lock(waitLock);
+        return this->waitCondition.wait_for(lock, POLL_INTERVAL,
+                                            [&]() { return size() > samples || hasStreamEnded(); });
     }
 
-    void waitForConsumer(std::unique_lock<std::mutex>& lock) {
-        // static_assert(lock.mutex() == &this->queueLock);
-        assert(lock.mutex() == &this->queueLock);
-        while (!this->popNotified && !hasStreamEnded()) { this->popLockCondition.wait(lock); }
-        this->popNotified = false;
+    /**
+     * Wait until the queue holds fewer than `samples` samples or the stream ended, by the producer thread
+     * @return false if POLL_INTERVAL elapsed before
+     */
+    bool waitForConsumer(size_t samples) {
+        std::unique_lock<std::mutex> lock(waitLock);
+        return this->waitCondition.wait_for(lock, POLL_INTERVAL,
+                                            [&]() { return size() < samples || hasStreamEnded(); });
     }
 
-    bool hasStreamEnded() {
-        std::lock_guard<std::mutex> lock(internalLock);
-        return this->streamEnd;
-    }
+    bool hasStreamEnded() const { return this->streamEnd.load(std::memory_order_acquire); }
 
-    [[nodiscard]] std::unique_lock<std::mutex> acquire_lock() {
-        std::unique_lock retLock{this->queueLock, std::defer_lock};
-        std::lock(retLock, this->internalLock);
-        std::lock_guard{this->internalLock, std::adopt_lock};
-        return retLock;
-    }
+    /**
+     * @return the number of samples the producer could not append since the last reset()
+     */
+    size_t getDroppedSamples() const { return this->droppedSamples.load(std::memory_order_relaxed); }
 
+    /**
+     * Set the attributes of the stream and allocate the buffer. Neither the producer nor the consumer may be running.
+     */
     void setAudioAttributes(double lSampleRate, unsigned int lChannels) {
-        std::lock_guard<std::mutex> lock(internalLock);
-        this->sampleRate = lSampleRate;
-        this->channels = lChannels;
+        const size_t samples = CAPACITY_FRAMES * std::max(lChannels, 1U);
+        if (this->buffer.size() != samples) {
+            assert(empty());
+            this->buffer.resize(samples);
+        }
+        this->sampleRate.store(lSampleRate, std::memory_order_relaxed);
+        this->channels.store(lChannels, std::memory_order_release);
     }
 
     /**
@@ -123,24 +188,29 @@ public:
      * Todo (readability, type-safety): create a struct AudioAttributes; remove this comment
      */
 
-    [[nodiscard]] std::pair<double, uint32_t> getAudioAttributes() {
-        std::lock_guard<std::mutex> lock(internalLock);
-        return {this->sampleRate, this->channels};
+    [[nodiscard]] std::pair<double, uint32_t> getAudioAttributes() const {
+        return {this->sampleRate.load(std::memory_order_relaxed), this->channels.load(std::memory_order_acquire)};
     }
 
 private:
-    std::mutex queueLock;
-    std::mutex internalLock;
+    std::vector<T> buffer = std::vector<T>(CAPACITY_FRAMES);
 
-    std::deque<T> internalQueue;
+    /**
+     * Number of samples ever written and read, the ring buffer is indexed by their remainder
+     */
+    std::atomic<size_t> writePosition{0};
+    std::atomic<size_t> readPosition{0};
+
+    std::atomic<size_t> droppedSamples{0};
 
-    std::condition_variable pushLockCondition;
-    std::condition_variable popLockCondition;
+    /**
+     * Only for the threads waiting and the changes they must not miss
+     */
+    std::mutex waitLock;
+    std::condition_variable waitCondition;
 
-    double sampleRate{std::numeric_limits<double>::quiet_NaN()};
-    uint32_t channels{0};
+    std::atomic<double> sampleRate{std::numeric_limits<double>::quiet_NaN()};
+    std::atomic<uint32_t> channels{0};
 
-    bool streamEnd{false};
-    bool pushNotified{false};
-    bool popNotified{false};
+    std::atomic<bool> streamEnd{false};
 };
@@ -22,3 +22,7 @@ auto AudioRecorder::isRecording() const -> bool { return this->portAudioProducer
 auto AudioRecorder::getInputDevices() const -> std::vector<DeviceInfo> {
     return this->portAudioProducer->getInputDevices();
 }
+
+auto AudioRecorder::getStats() const -> VorbisEncoderStats { return this->vorbisConsumer->getStats(); }
+
+auto AudioRecorder::getWaveform() const -> std::shared_ptr<const Waveform> { return this->vorbisConsumer->getWaveform(); }
@@ -35,6 +35,16 @@ struct AudioRecorder final {
     bool isRecording() const;
     std::vector<DeviceInfo> getInputDevices() const;
 
+    /**
+     * @return the statistics of the current or last recording
+     */
+    VorbisEncoderStats getStats() const;
+
+    /**
+     * @return the waveform of the current or last recording
+     */
+    std::shared_ptr<const Waveform> getWaveform() const;
+
 private:
     Settings& settings;
 
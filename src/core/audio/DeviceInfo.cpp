@@ -8,6 +8,13 @@ DeviceInfo::DeviceInfo(portaudio::Device* device, bool selected):
         outputChannels((device->isFullDuplexDevice() || device->isOutputOnlyDevice()) ? device->maxOutputChannels() :
                                                                                         0) {}
 
+DeviceInfo::DeviceInfo(DeviceInfo const& info, bool selected):
+        deviceName(info.deviceName),
+        index(info.index),
+        selected(selected),
+        inputChannels(info.inputChannels),
+        outputChannels(info.outputChannels) {}
+
 auto DeviceInfo::getDeviceName() const -> const std::string& { return deviceName; }
 
 auto DeviceInfo::getIndex() const -> PaDeviceIndex { return index; }
@@ -20,6 +20,11 @@ class DeviceInfo {
 public:
     DeviceInfo(portaudio::Device* device, bool selected);
 
+    /**
+     * A copy of the device with another selection
+     */
+    DeviceInfo(DeviceInfo const& info, bool selected);
+
 public:
     const std::string& getDeviceName() const;
     PaDeviceIndex getIndex() const;
@@ -1,12 +1,18 @@
 #include "VorbisConsumer.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 
 #include "SNDFileCpp.h"
 
 using namespace xoj;
 
+/**
+ * Frames given to the encoder at once
+ */
+constexpr auto FRAMES_PER_WRITE = size_t{1024U};
+
 auto VorbisConsumer::start(fs::path const& file) -> bool {
     auto [sampleRate, channels] = this->audioQueue.getAudioAttributes();
 
@@ -27,26 +33,52 @@ auto VorbisConsumer::start(fs::path const& file) -> bool {
         return false;
     }
 
-    this->consumerThread = std::thread([this, sfFile = std::move(sfFile), channels = channels] {
-        auto lock{audioQueue.acquire_lock()};
-        auto buffer_size{size_t(64 * channels)};
+    double fileQuality = this->quality;
+    if (!sf_command(sfFile.get(), SFC_SET_VBR_ENCODING_QUALITY, &fileQuality, sizeof(fileQuality))) {
+        g_warning("VorbisConsumer: could not set the encoding quality to %f", fileQuality);
+    }
+
+    this->sampleRate = sfInfo.samplerate;
+    this->encodedFrames = 0;
+    this->encodeMicroseconds = 0;
+    this->waveform = std::make_shared<Waveform>(sfInfo.samplerate);
+    this->file = file;
+
+    this->consumerThread = std::thread([this, sfFile = std::move(sfFile), channels = channels,
+                                        waveform = this->waveform] {
+        auto buffer_size{size_t(FRAMES_PER_WRITE * channels)};
         std::vector<float> buffer;
         buffer.reserve(buffer_size);  // efficiency
         double audioGain = this->settings.getAudioGain();
 
         while (!(this->stopConsumer || (audioQueue.hasStreamEnded() && audioQueue.empty()))) {
-            audioQueue.waitForProducer(lock);
-            while (audioQueue.size() > buffer_size || (audioQueue.hasStreamEnded() && !audioQueue.empty())) {
+            audioQueue.waitForProducer(buffer_size - 1);
+            while (audioQueue.size() >= buffer_size || (audioQueue.hasStreamEnded() && !audioQueue.empty())) {
                 buffer.resize(0);
                 this->audioQueue.pop(std::back_inserter(buffer), buffer_size);
                 // apply gain
                 if (audioGain != 1.0) {
                     std::for_each(begin(buffer), end(buffer), [audioGain](auto& val) { val *= audioGain; });
                 }
-                sf_writef_float(sfFile.get(), buffer.data(),
-                                std::min<sf_count_t>(sf_count_t(buffer.size()) / channels, 64));
+
+                auto encodeStart = std::chrono::steady_clock::now();
+                auto frames = sf_count_t(buffer.size()) / channels;
+                sf_writef_float(sfFile.get(), buffer.data(), frames);
+                auto encodeTime = std::chrono::steady_clock::now() - encodeStart;
+
+                this->encodeMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(encodeTime).count();
+                this->encodedFrames += static_cast<size_t>(frames);
+
+                waveform->addFrames(buffer.data(), static_cast<size_t>(frames), channels);
             }
         }
+
+        auto stats = getStats();
+        if (stats.droppedSamples > 0) {
+            g_warning("VorbisConsumer: %zu audio samples were lost, the recording could not be written fast enough",
+                      stats.droppedSamples);
+        }
+        this->quality = adaptQuality(this->quality, stats.encodeSpeed, stats.droppedSamples > 0);
     });
     return true;
 }
@@ -56,6 +88,15 @@ void VorbisConsumer::join() {
     if (this->consumerThread.joinable()) {
         this->consumerThread.join();
     }
+
+    // The audio file is complete once the thread closed it
+    if (this->waveform && !this->file.empty()) {
+        this->waveform->finish();
+        if (!this->waveform->save(this->file)) {
+            g_warning("VorbisConsumer: the waveform of \"%s\" could not be saved", this->file.u8string().c_str());
+        }
+        this->file.clear();
+    }
 }
 
 void VorbisConsumer::stop() {
@@ -65,3 +106,30 @@ void VorbisConsumer::stop() {
     // Wait for consumer to finish
     join();
 }
+
+auto VorbisConsumer::getStats() const -> VorbisEncoderStats {
+    VorbisEncoderStats stats;
+    stats.encodedFrames = this->encodedFrames;
+    stats.droppedSamples = this->audioQueue.getDroppedSamples();
+    stats.queuedSamples = this->audioQueue.size();
+    stats.queueCapacity = this->audioQueue.capacity();
+    stats.quality = this->quality;
+
+    auto microseconds = this->encodeMicroseconds.load();
+    if (microseconds > 0 && this->sampleRate > 0) {
+        stats.encodeSpeed = static_cast<double>(stats.encodedFrames) / this->sampleRate / (1e-6 * double(microseconds));
+    }
+    return stats;
+}
+
+auto VorbisConsumer::getWaveform() const -> std::shared_ptr<const Waveform> { return this->waveform; }
+
+auto VorbisConsumer::adaptQuality(double quality, double encodeSpeed, bool dropped) -> double {
+    if (dropped || (encodeSpeed > 0 && encodeSpeed < MIN_ENCODE_SPEED)) {
+        return std::max(MIN_QUALITY, quality - 0.1);
+    }
+    if (encodeSpeed > COMFORTABLE_ENCODE_SPEED) {
+        return std::min(DEFAULT_QUALITY, quality + 0.05);
+    }
+    return quality;
+}
@@ -12,7 +12,9 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <fstream>
+#include <memory>
 #include <thread>
 #include <utility>
 
@@ -20,8 +22,34 @@
 
 #include "AudioQueue.h"
 #include "DeviceInfo.h"
+#include "Waveform.h"
 #include "filesystem.h"
 
+/**
+ * Live statistics of the recording
+ */
+struct VorbisEncoderStats {
+    size_t encodedFrames = 0;
+
+    /**
+     * Samples lost because the queue was full
+     */
+    size_t droppedSamples = 0;
+
+    size_t queuedSamples = 0;
+    size_t queueCapacity = 0;
+
+    /**
+     * Seconds of audio encoded per second spent encoding, 0 before the first block
+     */
+    double encodeSpeed = 0;
+
+    /**
+     * VBR quality of the recording, from 0 to 1
+     */
+    double quality = 0;
+};
+
 class VorbisConsumer final {
 public:
     explicit VorbisConsumer(Settings& settings, AudioQueue<float>& audioQueue):
@@ -32,10 +60,50 @@ public:
     void join();
     void stop();
 
+    VorbisEncoderStats getStats() const;
+
+    /**
+     * @return The waveform of the current or last recording, built from the samples as they are encoded. It is saved
+     *         next to the audio file once the recording ended.
+     */
+    std::shared_ptr<const Waveform> getWaveform() const;
+
+    /**
+     * The quality of the next recording, lower if the encoder could not keep up with the last one. libvorbis cannot
+     * change the quality of a stream once it started.
+     * @param encodeSpeed Seconds of audio encoded per second spent encoding
+     * @param dropped Whether samples were lost
+     */
+    static double adaptQuality(double quality, double encodeSpeed, bool dropped);
+
+    static constexpr double DEFAULT_QUALITY = 0.4;
+    static constexpr double MIN_QUALITY = 0.1;
+
+    /**
+     * Encoding slower than that leaves too little margin for the other threads: the quality is lowered
+     */
+    static constexpr double MIN_ENCODE_SPEED = 4;
+
+    /**
+     * Encoding faster than that can afford a higher quality, up to DEFAULT_QUALITY
+     */
+    static constexpr double COMFORTABLE_ENCODE_SPEED = 16;
+
 private:
     Settings& settings;
     AudioQueue<float>& audioQueue;
 
     std::thread consumerThread{};
     std::atomic<bool> stopConsumer{false};
+
+    std::atomic<double> quality{DEFAULT_QUALITY};
+    std::atomic<size_t> encodedFrames{0};
+    std::atomic<int64_t> encodeMicroseconds{0};
+    double sampleRate = 0;
+
+    std::shared_ptr<Waveform> waveform;
+    /**
+     * The file being recorded, until its waveform is saved
+     */
+    fs::path file;
 };
@@ -1,56 +1,96 @@
 #include "VorbisProducer.h"
 
-#include <glib.h>
+#include <algorithm>
+#include <vector>
 
-#include "audio/SNDFileCpp.h"
+#include <glib.h>
 
 using namespace xoj;
 
 constexpr auto sample_buffer_size = size_t{16384U};
 
-auto VorbisProducer::start(fs::path const& file, unsigned int timestamp) -> bool {
-    SF_INFO sfInfo{};
-    auto sfFile = audio::make_snd_file(file, SFM_READ, &sfInfo);
+auto VorbisProducer::open(fs::path const& file) -> bool {
+    std::error_code ec;
+    auto size = fs::file_size(file, ec);
+    auto modified = fs::last_write_time(file, ec);
+    if (this->openFile.file && this->openFile.path == file && this->openFile.size == size &&
+        this->openFile.modified == modified && !ec) {
+        return true;
+    }
+
+    this->openFile = OpenFile{};
+    auto sfFile = audio::make_snd_file(file, SFM_READ, &this->openFile.info);
     if (!sfFile) {
         g_warning("VorbisProducer: input file \"%s\" could not be opened\ncaused by:%s", file.u8string().c_str(),
                   sf_strerror(sfFile.get()));
         return false;
     }
+    this->openFile.path = file;
+    this->openFile.size = size;
+    this->openFile.modified = modified;
+    this->openFile.file = std::move(sfFile);
+    return true;
+}
+
+void VorbisProducer::preload(fs::path const& file) {
+    if (this->running) {
+        return;
+    }
+    stop();
+    this->producerThread = std::thread([this, file] { open(file); });
+}
+
+auto VorbisProducer::start(fs::path const& file, unsigned int timestamp) -> bool {
+    // A preload of the file may still run
+    stop();
+    if (!open(file)) {
+        return false;
+    }
+    SF_INFO sfInfo = this->openFile.info;
+    SNDFILE* sfFile = this->openFile.file.get();
 
-    sf_count_t seekPosition = sfInfo.samplerate / 1000 * sf_count_t(timestamp);
+    sf_count_t seekPosition = sf_count_t(sfInfo.samplerate) * sf_count_t(timestamp) / 1000;
 
     if (seekPosition < sfInfo.frames) {
-        sf_seek(sfFile.get(), seekPosition, SEEK_SET);
+        sf_seek(sfFile, seekPosition, SEEK_SET);
     } else {
         g_warning("VorbisProducer: Seeking outside of audio file extent");
     }
 
     this->audioQueue.setAudioAttributes(sfInfo.samplerate, static_cast<unsigned int>(sfInfo.channels));
 
-    this->producerThread = std::thread([this, sfInfo, sfFile = std::move(sfFile)] {
+    this->seekSeconds = 0;
+    this->running = true;
+    this->producerThread = std::thread([this, sfInfo, sfFile] {
         sf_count_t numFrames{1};
         size_t const bufferSize{size_t(1024U) * size_t(sfInfo.channels)};
         std::vector<float> sampleBuffer(bufferSize);
-        auto lock = audioQueue.acquire_lock();
+
+        // Relative to the frames read, which are ahead of the playback by the queued ones
+        auto applySeek = [&]() {
+            if (auto tmpSeekSeconds = this->seekSeconds.load(); tmpSeekSeconds != 0) {
+                sf_count_t position = sf_seek(sfFile, 0, SEEK_CUR) + sf_count_t(tmpSeekSeconds) * sfInfo.samplerate;
+                sf_seek(sfFile, std::clamp<sf_count_t>(position, 0, std::max<sf_count_t>(sfInfo.frames - 1, 0)),
+                        SEEK_SET);
+                this->seekSeconds -= tmpSeekSeconds;
+            }
+        };
 
         while (!this->stopProducer && numFrames > 0 && !this->audioQueue.hasStreamEnded()) {
             sampleBuffer.resize(bufferSize);
-            numFrames = sf_readf_float(sfFile.get(), sampleBuffer.data(), 1024);
+            numFrames = sf_readf_float(sfFile, sampleBuffer.data(), 1024);
             sampleBuffer.resize(size_t(numFrames * sfInfo.channels));
 
             while (this->audioQueue.size() >= sample_buffer_size && !this->audioQueue.hasStreamEnded() &&
-                   !this->stopProducer) {
-                audioQueue.waitForConsumer(lock);
-            }
-
-            if (auto tmpSeekSeconds = this->seekSeconds.load(); tmpSeekSeconds != 0) {
-                sf_seek(sfFile.get(), tmpSeekSeconds * sfInfo.samplerate, SEEK_CUR);
-                this->seekSeconds -= tmpSeekSeconds;
+                   !this->stopProducer && this->seekSeconds == 0) {
+                audioQueue.waitForConsumer(sample_buffer_size);
             }
 
             this->audioQueue.emplace(begin(sampleBuffer), end(sampleBuffer));
+            applySeek();
         }
         this->audioQueue.signalEndOfStream();
+        this->running = false;
     });
     return true;
 }
@@ -1,7 +1,7 @@
 /*
  * Xournal++
  *
- * Class to read audio data from an mp3 file
+ * Class to read audio data from an audio file
  *
  * @author Xournal++ Team
  * https://github.com/xournalpp/xournalpp
@@ -12,9 +12,12 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <thread>
 #include <utility>
 
+#include "audio/SNDFileCpp.h"
+
 #include "AudioQueue.h"
 #include "DeviceInfo.h"
 #include "filesystem.h"
@@ -27,10 +30,37 @@ struct VorbisProducer final {
     void stop();
     void seek(int seconds);
 
+    /**
+     * Open the file in the background, e.g. once it is recorded, so that the next playback of it starts at once.
+     * Nothing is done while a playback runs.
+     */
+    void preload(fs::path const& file);
+
+private:
+    /**
+     * Open the file, or keep the one already open if it is the same and did not change on disk
+     * @return false if it could not be opened
+     */
+    bool open(fs::path const& file);
+
 private:
     AudioQueue<float>& audioQueue;
     std::thread producerThread{};
 
+    /**
+     * The file last played, kept open between the playbacks: seeking to another stroke of the same recording does not
+     * read and set up the decoder again. Only used by the producer thread while it runs.
+     */
+    struct OpenFile {
+        fs::path path;
+        std::uintmax_t size = 0;
+        fs::file_time_type modified{};
+        SF_INFO info{};
+        xoj::audio::SNDFileGuard file;
+    };
+    OpenFile openFile;
+
     std::atomic<bool> stopProducer{false};
+    std::atomic<bool> running{false};
     std::atomic<int> seekSeconds{0};
 };
@@ -0,0 +1,217 @@
+#include "Waveform.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+
+#include "SNDFileCpp.h"
+
+using namespace xoj;
+
+/**
+ * Frames decoded at once by compute()
+ */
+constexpr auto FRAMES_PER_READ = size_t{4096U};
+
+constexpr std::array<char, 8> FILE_MAGIC = {'X', 'O', 'P', 'P', 'W', 'A', 'V', 'E'};
+constexpr uint32_t FILE_VERSION = 1;
+
+static auto quantize(float sample) -> int8_t {
+    return static_cast<int8_t>(std::clamp(std::lround(sample * 127.0f), -127L, 127L));
+}
+
+Waveform::Waveform(double sampleRate): sampleRate(sampleRate), levels(1) {}
+
+void Waveform::addFrames(const float* samples, size_t frames, unsigned int channels) {
+    std::lock_guard lock(this->mutex);
+    for (size_t i = 0; i < frames; i++) {
+        for (unsigned int c = 0; c < channels; c++) {
+            float sample = samples[i * channels + c];
+            if (this->pendingFrames == 0 && c == 0) {
+                this->pendingMin = this->pendingMax = sample;
+            } else {
+                this->pendingMin = std::min(this->pendingMin, sample);
+                this->pendingMax = std::max(this->pendingMax, sample);
+            }
+        }
+        this->frames++;
+        if (++this->pendingFrames == FRAMES_PER_PEAK) {
+            addBucket({quantize(this->pendingMin), quantize(this->pendingMax)});
+            this->pendingFrames = 0;
+        }
+    }
+}
+
+void Waveform::finish() {
+    std::lock_guard lock(this->mutex);
+    if (this->pendingFrames > 0) {
+        addBucket({quantize(this->pendingMin), quantize(this->pendingMax)});
+        this->pendingFrames = 0;
+    }
+}
+
+void Waveform::addBucket(Bucket bucket) {
+    this->levels.front().push_back(bucket);
+    for (size_t k = 0; this->levels[k].size() % 2 == 0; k++) {
+        if (this->levels.size() == k + 1) {
+            this->levels.emplace_back();
+        }
+        const Bucket& a = this->levels[k][this->levels[k].size() - 2];
+        const Bucket& b = this->levels[k].back();
+        this->levels[k + 1].push_back({std::min(a.min, b.min), std::max(a.max, b.max)});
+    }
+}
+
+auto Waveform::getSampleRate() const -> double { return this->sampleRate; }
+
+auto Waveform::getDuration() const -> size_t {
+    std::lock_guard lock(this->mutex);
+    return this->sampleRate > 0 ? static_cast<size_t>(static_cast<double>(this->frames) * 1000 / this->sampleRate) : 0;
+}
+
+auto Waveform::getPeaks(size_t from, size_t to, size_t columns) const -> std::vector<Peak> {
+    std::vector<Peak> peaks(columns, Peak{0, 0});
+    if (columns == 0 || to <= from || this->sampleRate <= 0) {
+        return peaks;
+    }
+
+    std::lock_guard lock(this->mutex);
+    const double framesPerColumn = static_cast<double>(to - from) * this->sampleRate / 1000 / double(columns);
+    size_t level = 0;
+    while (level + 1 < this->levels.size() && double(FRAMES_PER_PEAK << (level + 1)) <= framesPerColumn) {
+        level++;
+    }
+
+    // The combination of the buckets of a level from the frame f0 to the frame f1
+    auto combine = [this](size_t k, double f0, double f1, Bucket& peak, bool& found) {
+        const auto& buckets = this->levels[k];
+        const double bucketFrames = double(FRAMES_PER_PEAK << k);
+        auto i0 = static_cast<size_t>(std::floor(f0 / bucketFrames));
+        auto i1 = std::max(i0 + 1, static_cast<size_t>(std::ceil(f1 / bucketFrames)));
+        for (size_t i = i0; i < std::min(i1, buckets.size()); i++) {
+            peak.min = found ? std::min(peak.min, buckets[i].min) : buckets[i].min;
+            peak.max = found ? std::max(peak.max, buckets[i].max) : buckets[i].max;
+            found = true;
+        }
+    };
+
+    const double start = static_cast<double>(from) * this->sampleRate / 1000;
+    // The last peaks of the first level are not in the coarser levels yet
+    const double coarseEnd = double(this->levels[level].size() * (FRAMES_PER_PEAK << level));
+    for (size_t c = 0; c < columns; c++) {
+        double f0 = start + framesPerColumn * double(c);
+        double f1 = f0 + framesPerColumn;
+        Bucket peak{0, 0};
+        bool found = false;
+        if (f0 < coarseEnd) {
+            combine(level, f0, std::min(f1, coarseEnd), peak, found);
+        }
+        if (f1 > coarseEnd && level > 0) {
+            combine(0, std::max(f0, coarseEnd), f1, peak, found);
+        }
+        if (found) {
+            peaks[c] = {float(peak.min) / 127.0f, float(peak.max) / 127.0f};
+        }
+    }
+    return peaks;
+}
+
+auto Waveform::getPath(fs::path const& audioFile) -> fs::path {
+    auto path = audioFile;
+    path += ".peaks";
+    return path;
+}
+
+auto Waveform::save(fs::path const& audioFile) const -> bool {
+    std::error_code ec;
+    auto audioSize = static_cast<uint64_t>(fs::file_size(audioFile, ec));
+    if (ec) {
+        return false;
+    }
+
+    // Written aside first: a waveform cut short would be taken for the whole recording
+    auto path = getPath(audioFile);
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        std::lock_guard lock(this->mutex);
+        const auto& buckets = this->levels.front();
+        auto frameCount = static_cast<uint64_t>(this->frames);
+        auto count = static_cast<uint64_t>(buckets.size());
+
+        out.write(FILE_MAGIC.data(), FILE_MAGIC.size());
+        out.write(reinterpret_cast<const char*>(&FILE_VERSION), sizeof(FILE_VERSION));
+        out.write(reinterpret_cast<const char*>(&this->sampleRate), sizeof(this->sampleRate));
+        out.write(reinterpret_cast<const char*>(&frameCount), sizeof(frameCount));
+        out.write(reinterpret_cast<const char*>(&audioSize), sizeof(audioSize));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char*>(buckets.data()), static_cast<std::streamsize>(count * sizeof(Bucket)));
+        if (!out) {
+            out.close();
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+    }
+    fs::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+auto Waveform::load(fs::path const& audioFile) -> std::unique_ptr<Waveform> {
+    std::ifstream in(getPath(audioFile), std::ios::binary);
+    if (!in) {
+        return nullptr;
+    }
+
+    std::array<char, FILE_MAGIC.size()> magic{};
+    uint32_t version = 0;
+    double sampleRate = 0;
+    uint64_t frameCount = 0;
+    uint64_t audioSize = 0;
+    uint64_t count = 0;
+    in.read(magic.data(), magic.size());
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&sampleRate), sizeof(sampleRate));
+    in.read(reinterpret_cast<char*>(&frameCount), sizeof(frameCount));
+    in.read(reinterpret_cast<char*>(&audioSize), sizeof(audioSize));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+
+    std::error_code ec;
+    if (!in || magic != FILE_MAGIC || version != FILE_VERSION || !(sampleRate > 0) ||
+        audioSize != static_cast<uint64_t>(fs::file_size(audioFile, ec)) || ec ||
+        count > frameCount / FRAMES_PER_PEAK + 1) {
+        return nullptr;
+    }
+
+    std::vector<Bucket> buckets(count);
+    in.read(reinterpret_cast<char*>(buckets.data()), static_cast<std::streamsize>(count * sizeof(Bucket)));
+    if (!in) {
+        return nullptr;
+    }
+
+    auto waveform = std::make_unique<Waveform>(sampleRate);
+    for (const Bucket& b: buckets) { waveform->addBucket(b); }
+    waveform->frames = static_cast<size_t>(frameCount);
+    return waveform;
+}
+
+auto Waveform::compute(fs::path const& audioFile, std::atomic<bool> const& cancel) -> std::unique_ptr<Waveform> {
+    SF_INFO info{};
+    auto sfFile = audio::make_snd_file(audioFile, SFM_READ, &info);
+    if (!sfFile || info.channels <= 0) {
+        return nullptr;
+    }
+
+    auto waveform = std::make_unique<Waveform>(info.samplerate);
+    std::vector<float> buffer(FRAMES_PER_READ * static_cast<size_t>(info.channels));
+    sf_count_t read = 0;
+    while ((read = sf_readf_float(sfFile.get(), buffer.data(), sf_count_t(FRAMES_PER_READ))) > 0) {
+        if (cancel) {
+            return nullptr;
+        }
+        waveform->addFrames(buffer.data(), static_cast<size_t>(read), static_cast<unsigned int>(info.channels));
+    }
+    waveform->finish();
+    return waveform;
+}
@@ -0,0 +1,118 @@
+/*
+ * Xournal++
+ *
+ * Overview of the loudness of an audio recording
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "filesystem.h"
+
+/**
+ * @brief The minimum and the maximum of the samples of a recording, for runs of frames of growing length
+ *
+ * The first level holds one peak per FRAMES_PER_PEAK frames, each next one a peak per two peaks of the previous one.
+ * A timeline of any width reads the level closest to its resolution, without decoding the audio again.
+ *
+ * The peaks are added as the audio is recorded or decoded, from one thread, while others may read them. They are
+ * saved next to the audio file (see getPath()), with the size of the audio file they were computed from.
+ */
+class Waveform final {
+public:
+    explicit Waveform(double sampleRate);
+
+    struct Peak {
+        float min;
+        float max;
+    };
+
+    /**
+     * Frames of the audio per peak of the first level
+     */
+    static constexpr size_t FRAMES_PER_PEAK = 512;
+
+    /**
+     * Add interleaved samples, the channels are mixed into the same peaks
+     */
+    void addFrames(const float* samples, size_t frames, unsigned int channels);
+
+    /**
+     * Add the frames of the last peak, which are fewer than FRAMES_PER_PEAK, at the end of the audio
+     */
+    void finish();
+
+    double getSampleRate() const;
+
+    /**
+     * @return The length of the audio added so far, in milliseconds
+     */
+    size_t getDuration() const;
+
+    /**
+     * @return `columns` peaks spread from `from` to `to` (milliseconds from the start of the audio), {0, 0} where
+     *         there is no audio
+     */
+    std::vector<Peak> getPeaks(size_t from, size_t to, size_t columns) const;
+
+    /**
+     * Save the peaks next to the audio file they were computed from
+     */
+    bool save(fs::path const& audioFile) const;
+
+    /**
+     * @return The peaks saved for the audio file, or nullptr if there are none or the file changed since
+     */
+    static std::unique_ptr<Waveform> load(fs::path const& audioFile);
+
+    /**
+     * Decode the audio file
+     * @return nullptr if the file could not be read or `cancel` was set meanwhile
+     */
+    static std::unique_ptr<Waveform> compute(fs::path const& audioFile, std::atomic<bool> const& cancel);
+
+    /**
+     * @return The file holding the peaks of an audio file
+     */
+    static fs::path getPath(fs::path const& audioFile);
+
+private:
+    /**
+     * The samples scaled to [-127, 127], which is detailed enough for a drawing and keeps the pyramid small: two bytes
+     * per peak, about 0.7 MB per hour at 48 kHz
+     */
+    struct Bucket {
+        int8_t min;
+        int8_t max;
+    };
+
+    void addBucket(Bucket bucket);
+
+private:
+    double sampleRate;
+
+    /**
+     * Guards the levels and the frame count
+     */
+    mutable std::mutex mutex;
+    std::vector<std::vector<Bucket>> levels;
+    size_t frames = 0;
+
+    /**
+     * The peak of the frames not in the first level yet
+     */
+    float pendingMin = 0;
+    float pendingMax = 0;
+    size_t pendingFrames = 0;
+};
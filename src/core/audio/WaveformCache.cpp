@@ -0,0 +1,71 @@
+#include "WaveformCache.h"
+
+#include <utility>
+
+#include <glib.h>
+
+WaveformCache::WaveformCache(std::function<void()> onComputed): onComputed(std::move(onComputed)) {}
+
+WaveformCache::~WaveformCache() {
+    {
+        std::lock_guard lock(this->mutex);
+        this->stopped = true;
+    }
+    this->wakeUp.notify_all();
+    if (this->worker.joinable()) {
+        this->worker.join();
+    }
+}
+
+auto WaveformCache::get(fs::path const& audioFile) -> std::shared_ptr<const Waveform> {
+    std::lock_guard lock(this->mutex);
+    if (auto it = this->waveforms.find(audioFile); it != this->waveforms.end()) {
+        return it->second;
+    }
+
+    this->waveforms.emplace(audioFile, nullptr);
+    this->queue.push_back(audioFile);
+    if (!this->worker.joinable()) {
+        // Started with the first request: most documents have no audio
+        this->worker = std::thread([this] { run(); });
+    }
+    this->wakeUp.notify_one();
+    return nullptr;
+}
+
+void WaveformCache::put(fs::path const& audioFile, std::shared_ptr<const Waveform> waveform) {
+    std::lock_guard lock(this->mutex);
+    this->waveforms[audioFile] = std::move(waveform);
+}
+
+void WaveformCache::run() {
+    std::unique_lock lock(this->mutex);
+    while (!this->stopped) {
+        this->wakeUp.wait(lock, [this] { return this->stopped || !this->queue.empty(); });
+        if (this->stopped) {
+            return;
+        }
+        fs::path file = std::move(this->queue.front());
+        this->queue.pop_front();
+        lock.unlock();
+
+        std::shared_ptr<Waveform> waveform = Waveform::load(file);
+        if (!waveform) {
+            waveform = Waveform::compute(file, this->stopped);
+            if (waveform && !waveform->save(file)) {
+                g_message("WaveformCache: the waveform of \"%s\" could not be saved", file.u8string().c_str());
+            }
+        }
+
+        lock.lock();
+        auto& entry = this->waveforms[file];
+        if (!entry) {
+            entry = std::move(waveform);
+        }
+        if (entry && this->onComputed) {
+            lock.unlock();
+            this->onComputed();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * Xournal++
+ *
+ * The waveforms of the audio recordings, computed in the background
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Waveform.h"
+#include "filesystem.h"
+
+/**
+ * @brief The Waveform%s of the audio files, each decoded once
+ *
+ * A waveform is read from the file saved next to the audio file if it is up to date, else decoded by a thread of the
+ * cache and saved for the next time. The recordings hand their waveform over, see put().
+ */
+class WaveformCache final {
+public:
+    /**
+     * @param onComputed Called from the thread of the cache once a waveform asked for is available
+     */
+    explicit WaveformCache(std::function<void()> onComputed);
+    WaveformCache(WaveformCache const&) = delete;
+    auto operator=(WaveformCache const&) -> WaveformCache& = delete;
+    ~WaveformCache();
+
+    /**
+     * @return The waveform of the audio file, or nullptr until it is computed or if the file cannot be read
+     */
+    std::shared_ptr<const Waveform> get(fs::path const& audioFile);
+
+    /**
+     * Add the waveform of a recording which just ended
+     */
+    void put(fs::path const& audioFile, std::shared_ptr<const Waveform> waveform);
+
+private:
+    void run();
+
+private:
+    std::function<void()> onComputed;
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+
+    /**
+     * The waveforms by audio file, nullptr while one is computed or if it failed
+     */
+    std::map<fs::path, std::shared_ptr<const Waveform>> waveforms;
+    std::deque<fs::path> queue;
+
+    std::atomic<bool> stopped{false};
+    std::thread worker;
+};
@@ -18,6 +18,12 @@ void ActionEnabledListener::unregisterListener() {
     }
 }
 
+void ActionEnabledListener::listenedActionChanged() {
+    if (this->handler) {
+        this->handler->invalidateEnabledListeners();
+    }
+}
+
 ActionSelectionListener::ActionSelectionListener() { this->handler = nullptr; }
 
 ActionSelectionListener::~ActionSelectionListener() { unregisterListener(); }
@@ -40,17 +46,93 @@ ActionHandler::ActionHandler() = default;
 ActionHandler::~ActionHandler() = default;
 
 void ActionHandler::fireEnableAction(ActionType action, bool enabled) {
-    for (ActionEnabledListener* listener: this->enabledListener) { listener->actionEnabledAction(action, enabled); }
+    updateEnabledListeners();
+
+    auto [state, added] = this->enabledState.try_emplace(action, enabled);
+    if (!added && state->second == enabled) {
+        return;
+    }
+    state->second = enabled;
+
+    auto listeners = this->enabledListenerByAction.find(action);
+    if (listeners == this->enabledListenerByAction.end()) {
+        return;
+    }
+    for (ActionEnabledListener* listener: listeners->second) { listener->actionEnabledAction(action, enabled); }
+}
+
+void ActionHandler::addListener(ActionEnabledListener* listener) {
+    this->enabledListener.push_back(listener);
+    invalidateEnabledListeners();
+}
+
+void ActionHandler::removeListener(ActionEnabledListener* listener) {
+    this->enabledListener.remove(listener);
+    invalidateEnabledListeners();
+}
+
+auto ActionHandler::isActionEnabled(ActionType action) const -> bool {
+    auto state = this->enabledState.find(action);
+    return state == this->enabledState.end() || state->second;
 }
 
-void ActionHandler::addListener(ActionEnabledListener* listener) { this->enabledListener.push_back(listener); }
+void ActionHandler::invalidateEnabledListeners() { this->enabledListenerValid = false; }
 
-void ActionHandler::removeListener(ActionEnabledListener* listener) { this->enabledListener.remove(listener); }
+void ActionHandler::updateEnabledListeners() {
+    if (this->enabledListenerValid) {
+        return;
+    }
+    this->enabledListenerValid = true;
+
+    this->enabledListenerByAction.clear();
+    std::vector<ActionEnabledListener*> changed;
+    for (ActionEnabledListener* listener: this->enabledListener) {
+        ActionType action = listener->getListenedAction();
+        this->enabledListenerByAction[action].push_back(listener);
+        if (!listener->indexed || listener->indexedAction != action) {
+            listener->indexed = true;
+            listener->indexedAction = action;
+            changed.push_back(listener);
+        }
+    }
+
+    // The listeners only follow the changes of the state: the new ones start from the current one
+    for (ActionEnabledListener* listener: changed) {
+        auto state = this->enabledState.find(listener->indexedAction);
+        if (state != this->enabledState.end()) {
+            listener->actionEnabledAction(state->first, state->second);
+        }
+    }
+}
 
 void ActionHandler::fireActionSelected(ActionGroup group, ActionType action) {
-    for (ActionSelectionListener* listener: this->selectionListener) { listener->actionSelected(group, action); }
+    updateSelectionListeners();
+
+    auto listeners = this->selectionListenerByGroup.find(group);
+    if (listeners == this->selectionListenerByGroup.end()) {
+        return;
+    }
+    for (ActionSelectionListener* listener: listeners->second) { listener->actionSelected(group, action); }
 }
 
-void ActionHandler::addListener(ActionSelectionListener* listener) { this->selectionListener.push_back(listener); }
+void ActionHandler::addListener(ActionSelectionListener* listener) {
+    this->selectionListener.push_back(listener);
+    this->selectionListenerValid = false;
+}
+
+void ActionHandler::removeListener(ActionSelectionListener* listener) {
+    this->selectionListener.remove(listener);
+    this->selectionListenerValid = false;
+}
 
-void ActionHandler::removeListener(ActionSelectionListener* listener) { this->selectionListener.remove(listener); }
+void ActionHandler::updateSelectionListeners() {
+    if (this->selectionListenerValid) {
+        return;
+    }
+    this->selectionListenerValid = true;
+
+    this->selectionListenerByGroup.clear();
+    for (ActionSelectionListener* listener: this->selectionListener) {
+        this->selectionListenerByGroup[listener->getListenedGroup()].push_back(listener);
+    }
+}
@@ -13,6 +13,7 @@
 
 #include <list>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <gtk/gtk.h>
@@ -31,11 +32,30 @@ public:
 public:
     virtual void actionEnabledAction(ActionType action, bool enabled) = 0;
 
+    /**
+     * @return The action of which the listener is notified
+     */
+    virtual ActionType getListenedAction() const = 0;
+
     void registerListener(ActionHandler* handler);
     void unregisterListener();
 
+protected:
+    /**
+     * To be called when getListenedAction() changes: the listener is notified of the state of its new action
+     */
+    void listenedActionChanged();
+
 private:
     ActionHandler* handler = nullptr;
+
+    /**
+     * Whether the listener is in the table of the handler, with its action at that time
+     */
+    bool indexed = false;
+    ActionType indexedAction = ACTION_NONE;
+
+    friend class ActionHandler;
 };
 
 class ActionSelectionListener {
@@ -45,6 +65,11 @@ public:
 
     virtual void actionSelected(ActionGroup group, ActionType action) = 0;
 
+    /**
+     * @return The group of which the listener is notified, which must not change once the listener is constructed
+     */
+    virtual ActionGroup getListenedGroup() const = 0;
+
     void registerListener(ActionHandler* handler);
     void unregisterListener();
 
@@ -52,6 +77,14 @@ private:
     ActionHandler* handler;
 };
 
+/**
+ * Dispatches the actions of the menus and the toolbars, and notifies their items of the state of the actions
+ *
+ * The listeners are kept in tables by action and by group, built on the first notification after a change of the
+ * listeners: a notification only reaches the few items concerned instead of all the items of the toolbars. The last
+ * enabled state of each action is kept as well, so that notifying an unchanged state costs a lookup, and the items
+ * added later (e.g. by a reload of the toolbars) get the current state.
+ */
 class ActionHandler {
 public:
     ActionHandler();
@@ -65,11 +98,34 @@ public:
     void addListener(ActionEnabledListener* listener);
     void removeListener(ActionEnabledListener* listener);
 
+    /**
+     * @return The state last passed to fireEnableAction(), true for the actions never disabled
+     */
+    bool isActionEnabled(ActionType action) const;
+
     void fireActionSelected(ActionGroup group, ActionType action);
     void addListener(ActionSelectionListener* listener);
     void removeListener(ActionSelectionListener* listener);
 
+private:
+    /**
+     * Rebuild the tables of the enabled listeners if they changed, and notify the new ones of the state of their action
+     */
+    void updateEnabledListeners();
+    void updateSelectionListeners();
+
+    void invalidateEnabledListeners();
+
 private:
     std::list<ActionEnabledListener*> enabledListener;
     std::list<ActionSelectionListener*> selectionListener;
+
+    std::unordered_map<ActionType, std::vector<ActionEnabledListener*>> enabledListenerByAction;
+    std::unordered_map<ActionGroup, std::vector<ActionSelectionListener*>> selectionListenerByGroup;
+    bool enabledListenerValid = false;
+    bool selectionListenerValid = false;
+
+    std::unordered_map<ActionType, bool> enabledState;
+
+    friend class ActionEnabledListener;
 };
@@ -32,6 +32,7 @@ auto AudioController::startRecording() -> bool {
 
         g_message("Start recording");
 
+        initAudio();
         bool isRecording = this->audioRecorder->start(getAudioFolder() / data);
 
         if (!isRecording) {
@@ -39,47 +40,83 @@ auto AudioController::startRecording() -> bool {
             this->timestamp = 0;
         }
 
+        updateTimeline();
         return isRecording;
     }
     return false;
 }
 
+void AudioController::initAudio() {
+    if (this->autoSys) {
+        return;
+    }
+    this->autoSys = std::make_unique<portaudio::AutoSystem>();
+    this->audioRecorder = std::make_unique<AudioRecorder>(this->settings);
+    this->audioPlayer = std::make_unique<AudioPlayer>(this->control, this->settings);
+}
+
 auto AudioController::stopRecording() -> bool {
-    if (this->audioRecorder->isRecording()) {
+    if (isRecording()) {
+        auto file = getAudioFolder() / audioFilename;
         audioFilename = "";
         this->timestamp = 0;
 
         g_message("Stop recording");
 
         this->audioRecorder->stop();
+        this->waveforms.put(file, this->audioRecorder->getWaveform());
+
+        // The recording is usually played back right after
+        this->audioPlayer->preload(file);
+        this->playbackFile = file;
+        updateTimeline();
     }
     return true;
 }
 
-auto AudioController::isRecording() -> bool { return this->audioRecorder->isRecording(); }
+auto AudioController::isRecording() -> bool { return this->audioRecorder && this->audioRecorder->isRecording(); }
 
-auto AudioController::isPlaying() -> bool { return this->audioPlayer->isPlaying(); }
+auto AudioController::isPlaying() -> bool { return this->audioPlayer && this->audioPlayer->isPlaying(); }
 
 auto AudioController::startPlayback(fs::path const& file, unsigned int timestamp) -> bool {
+    initAudio();
     this->audioPlayer->stop();
     bool status = this->audioPlayer->start(file, timestamp);
     if (status) {
         this->control.getWindow()->getToolMenuHandler()->enableAudioPlaybackButtons();
+        if (this->playbackFile != file) {
+            this->playbackFile = file;
+            updateTimeline();
+        }
     }
     return status;
 }
 
 void AudioController::pausePlayback() {
+    if (!this->audioPlayer) {
+        return;
+    }
     this->control.getWindow()->getToolMenuHandler()->setAudioPlaybackPaused(true);
 
     this->audioPlayer->pause();
 }
 
-void AudioController::seekForwards() { this->audioPlayer->seek(this->settings.getDefaultSeekTime()); }
+void AudioController::seekForwards() {
+    if (this->audioPlayer) {
+        this->audioPlayer->seek(this->settings.getDefaultSeekTime());
+    }
+}
 
-void AudioController::seekBackwards() { this->audioPlayer->seek(-1 * this->settings.getDefaultSeekTime()); }
+void AudioController::seekBackwards() {
+    if (this->audioPlayer) {
+        this->audioPlayer->seek(-1 * this->settings.getDefaultSeekTime());
+    }
+}
 
 void AudioController::continuePlayback() {
+    if (!this->audioPlayer) {
+        return;
+    }
     this->control.getWindow()->getToolMenuHandler()->setAudioPlaybackPaused(false);
 
     this->audioPlayer->play();
@@ -87,7 +124,9 @@ void AudioController::continuePlayback() {
 
 void AudioController::stopPlayback() {
     this->control.getWindow()->getToolMenuHandler()->disableAudioPlaybackButtons();
-    this->audioPlayer->stop();
+    if (this->audioPlayer) {
+        this->audioPlayer->stop();
+    }
 }
 
 auto AudioController::getAudioFilename() const -> fs::path const& { return this->audioFilename; }
@@ -107,6 +146,58 @@ auto AudioController::getAudioFolder() const -> fs::path {
 
 auto AudioController::getStartTime() const -> size_t { return this->timestamp; }
 
-auto AudioController::getOutputDevices() const -> vector<DeviceInfo> { return this->audioPlayer->getOutputDevices(); }
+auto AudioController::getRecordingStats() const -> VorbisEncoderStats {
+    return this->audioRecorder ? this->audioRecorder->getStats() : VorbisEncoderStats{};
+}
+
+auto AudioController::getTimeline() -> AudioTimeline* { return &this->timeline; }
 
-auto AudioController::getInputDevices() const -> vector<DeviceInfo> { return this->audioRecorder->getInputDevices(); }
+auto AudioController::getCurrentAudioFile() const -> fs::path {
+    if (!this->audioFilename.empty()) {
+        return this->settings.getAudioFolder() / this->audioFilename;
+    }
+    return this->playbackFile;
+}
+
+auto AudioController::getWaveform(fs::path const& file) -> std::shared_ptr<const Waveform> {
+    if (isRecording() && file == getCurrentAudioFile()) {
+        return this->audioRecorder->getWaveform();
+    }
+    return this->waveforms.get(file);
+}
+
+void AudioController::onWaveformComputed() {
+    Util::execInUiThread([this] { updateTimeline(); });
+}
+
+void AudioController::updateTimeline() {
+    if (MainWindow* win = this->control.getWindow()) {
+        win->getToolMenuHandler()->updateAudioTimeline();
+    }
+}
+
+/**
+ * @return The cached devices, with the selection of the current settings
+ */
+static auto withSelection(vector<DeviceInfo> const& devices, PaDeviceIndex selected) -> vector<DeviceInfo> {
+    vector<DeviceInfo> result;
+    result.reserve(devices.size());
+    for (auto const& device: devices) { result.emplace_back(device, device.getIndex() == selected); }
+    return result;
+}
+
+auto AudioController::getOutputDevices() -> vector<DeviceInfo> {
+    if (!this->outputDevices) {
+        initAudio();
+        this->outputDevices = this->audioPlayer->getOutputDevices();
+    }
+    return withSelection(*this->outputDevices, this->settings.getAudioOutputDevice());
+}
+
+auto AudioController::getInputDevices() -> vector<DeviceInfo> {
+    if (!this->inputDevices) {
+        initAudio();
+        this->inputDevices = this->audioRecorder->getInputDevices();
+    }
+    return withSelection(*this->inputDevices, this->settings.getAudioInputDevice());
+}
@@ -11,14 +11,18 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "audio/AudioPlayer.h"
 #include "audio/AudioRecorder.h"
+#include "audio/WaveformCache.h"
 #include "control/settings/Settings.h"
 #include "gui/toolbarMenubar/ToolMenuHandler.h"
 
+#include "AudioTimeline.h"
 #include "Control.h"
 #include "filesystem.h"
 
@@ -44,21 +48,72 @@ public:
     fs::path const& getAudioFilename() const;
     fs::path getAudioFolder() const;
     size_t getStartTime() const;
-    std::vector<DeviceInfo> getOutputDevices() const;
-    std::vector<DeviceInfo> getInputDevices() const;
+
+    /**
+     * The devices are enumerated once, when the audio is initialized: PortAudio does not look for new ones later
+     */
+    std::vector<DeviceInfo> getOutputDevices();
+    std::vector<DeviceInfo> getInputDevices();
+
+    /**
+     * @return the statistics of the encoder of the current or last recording
+     */
+    VorbisEncoderStats getRecordingStats() const;
+
+    /**
+     * The elements of the document by their time in the recordings, to seek to them or to follow the playback
+     */
+    AudioTimeline* getTimeline();
+
+    /**
+     * @return The file being recorded, else the one last played, or an empty path
+     */
+    fs::path getCurrentAudioFile() const;
+
+    /**
+     * @return The waveform of the audio file, growing while it is recorded, or nullptr until it is computed in the
+     *         background. The audio timeline of the toolbar is updated once it is.
+     */
+    std::shared_ptr<const Waveform> getWaveform(fs::path const& file);
+
+private:
+    /**
+     * Initializes PortAudio and creates the recorder and the player, if not done yet. The initialization probes all the
+     * audio devices and can take long: it is deferred to the first recording, playback or listing of the devices.
+     */
+    void initAudio();
+
+    /**
+     * Draw the audio timeline of the toolbar again
+     */
+    void updateTimeline();
+
+    /**
+     * Called by the thread of the WaveformCache
+     */
+    void onWaveformComputed();
 
 private:
     Settings& settings;
     Control& control;
 
     /**
-     * RAII initializer don't move below the portaudio::System::instance() calls in
-     * AudioRecorder and AudioPlayer
+     * RAII initializer, created before and destroyed after the portaudio::System::instance() users in AudioRecorder
+     * and AudioPlayer
      * */
-    portaudio::AutoSystem autoSys;
-    std::unique_ptr<AudioRecorder> audioRecorder = std::make_unique<AudioRecorder>(settings);
-    std::unique_ptr<AudioPlayer> audioPlayer = std::make_unique<AudioPlayer>(control, settings);
+    std::unique_ptr<portaudio::AutoSystem> autoSys;
+    std::unique_ptr<AudioRecorder> audioRecorder;
+    std::unique_ptr<AudioPlayer> audioPlayer;
+
+    std::optional<std::vector<DeviceInfo>> inputDevices;
+    std::optional<std::vector<DeviceInfo>> outputDevices;
 
     fs::path audioFilename;
     size_t timestamp = 0;
+
+    fs::path playbackFile;
+
+    AudioTimeline timeline;
+
+    WaveformCache waveforms{[this] { onWaveformComputed(); }};
 };
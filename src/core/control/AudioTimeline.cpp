@@ -0,0 +1,122 @@
+#include "AudioTimeline.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "model/AudioElement.h"
+#include "model/Layer.h"
+#include "model/XojPage.h"
+
+AudioTimeline::AudioTimeline() = default;
+
+AudioTimeline::~AudioTimeline() = default;
+
+void AudioTimeline::undoRedoChanged() {}
+
+void AudioTimeline::undoRedoPageChanged(PageRef page) { this->dirtyPages.insert(std::move(page)); }
+
+void AudioTimeline::reset() {
+    this->dirtyPages.clear();
+    this->pages.clear();
+    this->files.clear();
+}
+
+auto AudioTimeline::indexPage(const PageRef& page) -> PageEntries {
+    PageEntries indexed{page, {}};
+    for (Layer* layer: *page->getLayers()) {
+        for (Element* e: layer->getElements()) {
+            if (e->getType() != ELEMENT_STROKE && e->getType() != ELEMENT_TEXT) {
+                continue;
+            }
+            auto* audio = static_cast<AudioElement*>(e);
+            if (!audio->getAudioFilename().empty()) {
+                indexed.entries.emplace_back(audio->getAudioFilename(), Entry{audio->getTimestamp(), e, page});
+            }
+        }
+    }
+    return indexed;
+}
+
+auto AudioTimeline::update(Document* doc, const fs::path& filename) -> const std::vector<Entry>* {
+    bool changed = false;
+
+    std::set<XojPage*> present;
+    for (size_t i = 0; i < doc->getPageCount(); i++) {
+        PageRef page = doc->getPage(i);
+        present.insert(page.get());
+
+        auto it = this->pages.find(page.get());
+        if (it == this->pages.end()) {
+            this->pages.emplace(page.get(), indexPage(page));
+            changed = true;
+        } else if (this->dirtyPages.count(page)) {
+            it->second = indexPage(page);
+            changed = true;
+        }
+    }
+    this->dirtyPages.clear();
+
+    for (auto it = this->pages.begin(); it != this->pages.end();) {
+        if (present.count(it->first)) {
+            ++it;
+        } else {
+            it = this->pages.erase(it);
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        // The entries with the same timestamp stay in the order of the document
+        this->files.clear();
+        for (size_t i = 0; i < doc->getPageCount(); i++) {
+            for (auto& [file, entry]: this->pages[doc->getPage(i).get()].entries) {
+                this->files[file].push_back(entry);
+            }
+        }
+        for (auto& [file, entries]: this->files) {
+            std::stable_sort(entries.begin(), entries.end(),
+                             [](const Entry& a, const Entry& b) { return a.timestamp < b.timestamp; });
+        }
+    }
+
+    auto it = this->files.find(filename);
+    return it == this->files.end() ? nullptr : &it->second;
+}
+
+static auto lowerBound(const std::vector<AudioTimeline::Entry>& entries, size_t timestamp) {
+    return std::lower_bound(entries.begin(), entries.end(), timestamp,
+                            [](const AudioTimeline::Entry& e, size_t t) { return e.timestamp < t; });
+}
+
+auto AudioTimeline::getElementsBetween(Document* doc, const fs::path& filename, size_t from, size_t to)
+        -> std::vector<Entry> {
+    const std::vector<Entry>* entries = update(doc, filename);
+    if (!entries || from >= to) {
+        return {};
+    }
+    return {lowerBound(*entries, from), lowerBound(*entries, to)};
+}
+
+auto AudioTimeline::findNext(Document* doc, const fs::path& filename, size_t timestamp) -> std::optional<Entry> {
+    const std::vector<Entry>* entries = update(doc, filename);
+    if (!entries) {
+        return std::nullopt;
+    }
+    auto it = lowerBound(*entries, timestamp);
+    if (it == entries->end()) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+auto AudioTimeline::findPrevious(Document* doc, const fs::path& filename, size_t timestamp) -> std::optional<Entry> {
+    const std::vector<Entry>* entries = update(doc, filename);
+    if (!entries) {
+        return std::nullopt;
+    }
+    auto it = lowerBound(*entries, timestamp);
+    if (it == entries->begin()) {
+        return std::nullopt;
+    }
+    return *std::prev(it);
+}
@@ -0,0 +1,98 @@
+/*
+ * Xournal++
+ *
+ * Index of the elements of the document by their position in the audio recordings
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+#include "model/Document.h"
+#include "model/Element.h"
+#include "model/PageRef.h"
+#include "undo/UndoRedoHandler.h"
+
+#include "filesystem.h"
+
+/**
+ * @brief The strokes and texts of the document, sorted by audio file and by timestamp
+ *
+ * Answers which elements were written at some time of a recording, without going through all the elements of the
+ * document. The pages changed since the last query, as reported by the UndoRedoHandler, and the pages added to the
+ * document are indexed again on the next query, the pages removed from the document are dropped.
+ *
+ * The audio files are named as in the elements, see AudioElement::getAudioFilename(). The timestamps are in
+ * milliseconds from the start of the recording.
+ */
+class AudioTimeline: public UndoRedoListener {
+public:
+    AudioTimeline();
+    ~AudioTimeline() override;
+
+    struct Entry {
+        size_t timestamp;
+        Element* element;
+        PageRef page;
+    };
+
+public:
+    void undoRedoChanged() override;
+    void undoRedoPageChanged(PageRef page) override;
+
+    /**
+     * @return The elements recorded from `from` (included) to `to` (excluded), by timestamp. Must be called with the
+     *         document locked.
+     */
+    std::vector<Entry> getElementsBetween(Document* doc, const fs::path& filename, size_t from, size_t to);
+
+    /**
+     * @return The first element recorded at or after the timestamp. Must be called with the document locked.
+     */
+    std::optional<Entry> findNext(Document* doc, const fs::path& filename, size_t timestamp);
+
+    /**
+     * @return The last element recorded before the timestamp. Must be called with the document locked.
+     */
+    std::optional<Entry> findPrevious(Document* doc, const fs::path& filename, size_t timestamp);
+
+    /**
+     * Forget the index, the next query indexes the whole document
+     */
+    void reset();
+
+private:
+    /**
+     * Update the index to the pages of the document
+     * @return The entries of the audio file, or nullptr if there is none
+     */
+    const std::vector<Entry>* update(Document* doc, const fs::path& filename);
+
+    struct PageEntries {
+        PageRef page;
+        std::vector<std::pair<fs::path, Entry>> entries;
+    };
+
+    static PageEntries indexPage(const PageRef& page);
+
+private:
+    /**
+     * The pages changed since the last query
+     */
+    std::set<PageRef> dirtyPages;
+
+    std::map<XojPage*, PageEntries> pages;
+
+    /**
+     * The entries of all the pages, rebuilt when a page changed
+     */
+    std::map<fs::path, std::vector<Entry>> files;
+};
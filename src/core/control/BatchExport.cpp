@@ -0,0 +1,112 @@
+#include "BatchExport.h"
+
+#include <algorithm>
+#include <exception>
+#include <vector>
+
+#include "control/jobs/ImageExport.h"
+#include "control/xojfile/LoadHandler.h"
+#include "util/StringUtils.h"
+#include "util/i18n.h"
+
+#include "ExportHelper.h"
+#include "filesystem.h"
+
+BatchExport::BatchExport(int pngDpi, int pngWidth, int pngHeight, int quality, ExportBackgroundType exportBackground,
+                         bool progressiveMode):
+        pngDpi(pngDpi),
+        pngWidth(pngWidth),
+        pngHeight(pngHeight),
+        quality(quality),
+        exportBackground(exportBackground),
+        progressiveMode(progressiveMode) {}
+
+auto BatchExport::run(std::istream& jobs, std::ostream& status) -> size_t {
+    size_t succeeded = 0;
+    size_t failed = 0;
+
+    std::string line;
+    for (size_t lineNr = 1; std::getline(jobs, line); lineNr++) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        std::vector<std::string> fields = StringUtils::split(line, '\t');
+        std::string error;
+        bool success = false;
+        if (fields.size() < 2 || fields.size() > 3 || fields[0].empty() || fields[1].empty()) {
+            error = _("Expected INPUT<TAB>OUTPUT[<TAB>RANGE]");
+        } else {
+            try {
+                success = runJob(fields[0], fields[1], fields.size() == 3 ? fields[2].c_str() : nullptr, error);
+            } catch (const std::exception& e) { error = e.what(); }
+        }
+
+        if (success) {
+            succeeded++;
+            status << "ok\t" << lineNr << "\t" << fields[1] << std::endl;
+        } else {
+            failed++;
+            // Keep the status on one line
+            std::replace_if(
+                    error.begin(), error.end(), [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+            status << "error\t" << lineNr << "\t" << error << std::endl;
+        }
+    }
+
+    status << "done\t" << succeeded << "\t" << failed << std::endl;
+    return failed;
+}
+
+auto BatchExport::runJob(const std::string& input, const std::string& output, const char* range, std::string& error)
+        -> bool {
+    LoadHandler loader;
+    loader.setPdfDocumentPool(&this->pdfDocuments);
+
+    Document* doc = loader.loadDocument(fs::u8path(input));
+    if (doc == nullptr) {
+        error = loader.getLastError();
+        return false;
+    }
+    if (doc->getPageCount() == 0) {
+        error = _("The document has no page");
+        return false;
+    }
+
+    auto path = fs::u8path(output);
+    if (path.extension() == ".pdf") {
+        return ExportHelper::tryExportPdf(doc, path, range, this->exportBackground, this->progressiveMode, error);
+    }
+    ExportGraphicsFormat format = ImageExport::getFormatForExtension(path);
+    if (format != EXPORT_GRAPHICS_UNDEFINED) {
+        PdfCache* cache = ImageExport::isRasterFormat(format) ? getPdfCache(doc) : nullptr;
+        return ExportHelper::tryExportImg(doc, path, range, this->pngDpi, this->pngWidth, this->pngHeight,
+                                          this->quality, this->exportBackground, error, cache);
+    }
+    error = _("Unsupported output format, expected .pdf, .png, .svg, .jpg, .jpeg or .webp");
+    return false;
+}
+
+auto BatchExport::getPdfCache(Document* doc) -> PdfCache* {
+    if (doc->getPdfPageCount() == 0 || this->exportBackground == EXPORT_BACKGROUND_NONE) {
+        return nullptr;
+    }
+
+    std::shared_ptr<PdfCache> cache = PdfCache::getShared(doc->getPdfDocument(), nullptr, true);
+    auto it = std::find(this->pdfCaches.begin(), this->pdfCaches.end(), cache);
+    if (it != this->pdfCaches.end()) {
+        this->pdfCaches.splice(this->pdfCaches.begin(), this->pdfCaches, it);
+        return cache.get();
+    }
+
+    cache->setMaxBytes(PDF_CACHE_BYTES);
+    cache->setMaxSize(PDF_CACHE_PAGES);
+    this->pdfCaches.push_front(cache);
+    while (this->pdfCaches.size() > MAX_PDF_CACHES) {
+        this->pdfCaches.pop_back();
+    }
+    return cache.get();
+}
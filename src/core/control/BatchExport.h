@@ -0,0 +1,83 @@
+/*
+ * Xournal++
+ *
+ * Exports many documents in one process
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "control/PdfCache.h"
+#include "control/jobs/BaseExportJob.h"
+#include "pdf/base/XojPdfDocumentPool.h"
+
+class Document;
+
+/**
+ * @brief Runs a list of exports, one per line of the job list:
+ *
+ *     INPUT<TAB>OUTPUT[<TAB>RANGE]
+ *
+ * The format is guessed from the extension of OUTPUT: .pdf, .png, .svg, .jpg, .jpeg or .webp. Empty lines and lines starting with '#' are
+ * skipped. The other export options are the same for all the jobs.
+ *
+ * One status line is written per job, then a summary line, with tab separated fields:
+ *
+ *     ok<TAB>LINE<TAB>OUTPUT
+ *     error<TAB>LINE<TAB>MESSAGE
+ *     done<TAB>SUCCEEDED<TAB>FAILED
+ *
+ * The PDF backgrounds are shared by the documents of the list, see XojPdfDocumentPool, and so are their
+ * rasterizations for the raster image exports, see PdfCache::getShared().
+ */
+class BatchExport {
+public:
+    BatchExport(int pngDpi, int pngWidth, int pngHeight, int quality, ExportBackgroundType exportBackground,
+                bool progressiveMode);
+
+public:
+    /**
+     * @return The number of failed jobs
+     */
+    size_t run(std::istream& jobs, std::ostream& status);
+
+private:
+    /**
+     * @return true on success, the error message otherwise
+     */
+    bool runJob(const std::string& input, const std::string& output, const char* range, std::string& error);
+
+    /**
+     * @return The cache of the PDF background of the document, kept for the next jobs
+     */
+    PdfCache* getPdfCache(Document* doc);
+
+private:
+    int pngDpi;
+    int pngWidth;
+    int pngHeight;
+    int quality;
+    ExportBackgroundType exportBackground;
+    bool progressiveMode;
+
+    XojPdfDocumentPool pdfDocuments;
+
+    /**
+     * The caches of the last PDF backgrounds, the most recently used first
+     */
+    std::list<std::shared_ptr<PdfCache>> pdfCaches;
+
+    static constexpr size_t MAX_PDF_CACHES = 4;
+    static constexpr size_t PDF_CACHE_BYTES = 256 * 1024 * 1024;
+    static constexpr size_t PDF_CACHE_PAGES = 1024;
+};
@@ -6,6 +6,7 @@
 #include <cairo-svg.h>
 #include <config.h>
 
+#include "model/ElementContainer.h"
 #include "model/Text.h"
 #include "util/Util.h"
 #include "util/pixbuf-utils.h"
@@ -73,21 +74,42 @@ auto ElementCompareFunc(Element* a, Element* b) -> bool {
 static GdkAtom atomSvg1 = gdk_atom_intern_static_string("image/svg");
 static GdkAtom atomSvg2 = gdk_atom_intern_static_string("image/svg+xml");
 
-// The contents of the clipboard
-class ClipboardContents {
+static auto svgWriteFunction(GString* string, const unsigned char* data, unsigned int length) -> cairo_status_t {
+    g_string_append_len(string, reinterpret_cast<const gchar*>(data), length);
+    return CAIRO_STATUS_SUCCESS;
+}
+
+/**
+ * The contents of the clipboard
+ *
+ * The images of the selection are only rendered once another application asks for them: copying a dense selection
+ * within Xournal++ only needs the serialized elements. They are rendered from copies of the elements, which do not
+ * change with the selection.
+ */
+class ClipboardContents: public ElementContainer {
 public:
-    ClipboardContents(string text, GdkPixbuf* image, string svg, GString* str) {
-        this->text = std::move(text);
-        this->image = image;
-        this->svg = std::move(svg);
-        this->str = str;
+    ClipboardContents(string text, const EditSelection* selection, GString* str):
+            text(std::move(text)),
+            str(str),
+            x(selection->getXOnView()),
+            y(selection->getYOnView()),
+            width(selection->getWidth()),
+            height(selection->getHeight()) {
+        for (Element* e: selection->getElements()) { this->elements.push_back(e->clone()); }
     }
 
-    ~ClipboardContents() {
-        g_object_unref(this->image);
+    ~ClipboardContents() override {
+        for (Element* e: this->elements) { delete e; }
+        if (this->image) {
+            g_object_unref(this->image);
+        }
+        if (this->svg) {
+            g_string_free(this->svg, true);
+        }
         g_string_free(this->str, true);
     }
 
+    const std::vector<Element*>& getElements() const override { return this->elements; }
 
     static void getFunction(GtkClipboard* clipboard, GtkSelectionData* selection, guint info,
                             ClipboardContents* contents) {
@@ -98,10 +120,11 @@ public:
         } else if (target == gdk_atom_intern_static_string("image/png") ||
                    target == gdk_atom_intern_static_string("image/jpeg") ||
                    target == gdk_atom_intern_static_string("image/gif")) {
-            gtk_selection_data_set_pixbuf(selection, contents->image);
+            gtk_selection_data_set_pixbuf(selection, contents->getImage());
         } else if (atomSvg1 == target || atomSvg2 == target) {
-            gtk_selection_data_set(selection, target, 8, reinterpret_cast<guchar const*>(contents->svg.c_str()),
-                                   static_cast<gint>(contents->svg.length()));
+            GString* svg = contents->getSvg();
+            gtk_selection_data_set(selection, target, 8, reinterpret_cast<guchar const*>(svg->str),
+                                   static_cast<gint>(svg->len));
         } else if (atomXournal == target) {
             gtk_selection_data_set(selection, target, 8, reinterpret_cast<guchar*>(contents->str->str),
                                    static_cast<gint>(contents->str->len));
@@ -110,17 +133,74 @@ public:
 
     static void clearFunction(GtkClipboard* clipboard, ClipboardContents* contents) { delete contents; }
 
+private:
+    /**
+     * @return The selection rendered at 300 dpi, rendered on the first call
+     */
+    GdkPixbuf* getImage() {
+        if (this->image) {
+            return this->image;
+        }
+
+        double dpiFactor = 1.0 / Util::DPI_NORMALIZATION_FACTOR * 300.0;
+
+        int width = static_cast<int>(this->width * dpiFactor);
+        int height = static_cast<int>(this->height * dpiFactor);
+        cairo_surface_t* surfacePng = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+        cairo_t* crPng = cairo_create(surfacePng);
+        cairo_scale(crPng, dpiFactor, dpiFactor);
+
+        cairo_translate(crPng, -this->x, -this->y);
+
+        xoj::view::SelectionView view(this);
+        view.draw(xoj::view::Context::createDefault(crPng));
+
+        cairo_destroy(crPng);
+
+        this->image = xoj_pixbuf_get_from_surface(surfacePng, 0, 0, width, height);
+
+        cairo_surface_destroy(surfacePng);
+        return this->image;
+    }
+
+    /**
+     * @return The selection as SVG, rendered on the first call
+     */
+    GString* getSvg() {
+        if (this->svg) {
+            return this->svg;
+        }
+
+        this->svg = g_string_sized_new(1048576);  // 1MB
+
+        cairo_surface_t* surfaceSVG = cairo_svg_surface_create_for_stream(
+                reinterpret_cast<cairo_write_func_t>(svgWriteFunction), this->svg, this->width, this->height);
+        cairo_t* crSVG = cairo_create(surfaceSVG);
+
+        xoj::view::SelectionView view(this);
+        view.draw(xoj::view::Context::createDefault(crSVG));
+
+        cairo_surface_destroy(surfaceSVG);
+        cairo_destroy(crSVG);
+        return this->svg;
+    }
+
 private:
     string text;
-    GdkPixbuf* image;
-    string svg;
     GString* str;
-};
 
-static auto svgWriteFunction(GString* string, const unsigned char* data, unsigned int length) -> cairo_status_t {
-    g_string_append_len(string, reinterpret_cast<const gchar*>(data), length);
-    return CAIRO_STATUS_SUCCESS;
-}
+    /**
+     * Copies of the selected elements and the bounds of the selection
+     */
+    std::vector<Element*> elements;
+    double x;
+    double y;
+    double width;
+    double height;
+
+    GdkPixbuf* image = nullptr;
+    GString* svg = nullptr;
+};
 
 auto ClipboardHandler::copy() -> bool {
     if (!this->selection) {
@@ -157,45 +237,6 @@ auto ClipboardHandler::copy() -> bool {
         text += t->getText();
     }
 
-    /////////////////////////////////////////////////////////////////
-    // prepare image contents: PNG
-    /////////////////////////////////////////////////////////////////
-
-    double dpiFactor = 1.0 / Util::DPI_NORMALIZATION_FACTOR * 300.0;
-
-    int width = static_cast<int>(selection->getWidth() * dpiFactor);
-    int height = static_cast<int>(selection->getHeight() * dpiFactor);
-    cairo_surface_t* surfacePng = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
-    cairo_t* crPng = cairo_create(surfacePng);
-    cairo_scale(crPng, dpiFactor, dpiFactor);
-
-    cairo_translate(crPng, -selection->getXOnView(), -selection->getYOnView());
-
-    xoj::view::SelectionView view(this->selection);
-    view.draw(xoj::view::Context::createDefault(crPng));
-
-    cairo_destroy(crPng);
-
-    GdkPixbuf* image = xoj_pixbuf_get_from_surface(surfacePng, 0, 0, width, height);
-
-    cairo_surface_destroy(surfacePng);
-
-    /////////////////////////////////////////////////////////////////
-    // prepare image contents: SVG
-    /////////////////////////////////////////////////////////////////
-
-    GString* svgString = g_string_sized_new(1048576);  // 1MB
-
-    cairo_surface_t* surfaceSVG =
-            cairo_svg_surface_create_for_stream(reinterpret_cast<cairo_write_func_t>(svgWriteFunction), svgString,
-                                                selection->getWidth(), selection->getHeight());
-    cairo_t* crSVG = cairo_create(surfaceSVG);
-
-    view.draw(xoj::view::Context::createDefault(crSVG));
-
-    cairo_surface_destroy(surfaceSVG);
-    cairo_destroy(crSVG);
-
     /////////////////////////////////////////////////////////////////
     // copy to clipboard
     /////////////////////////////////////////////////////////////////
@@ -208,7 +249,7 @@ auto ClipboardHandler::copy() -> bool {
     if (!text.empty()) {
         gtk_target_list_add_text_targets(list, 0);
     }
-    // we always copy an image to clipboard
+    // we always offer an image, rendered if it is requested
     gtk_target_list_add_image_targets(list, 0, true);
     gtk_target_list_add(list, atomSvg1, 0, 0);
     gtk_target_list_add(list, atomSvg2, 0, 0);
@@ -216,7 +257,7 @@ auto ClipboardHandler::copy() -> bool {
 
     targets = gtk_target_table_new_from_list(list, &n_targets);
 
-    auto* contents = new ClipboardContents(text, image, svgString->str, out.getStr());
+    auto* contents = new ClipboardContents(text, this->selection, out.getStr());
 
     gtk_clipboard_set_with_data(this->clipboard, targets, static_cast<guint>(n_targets),
                                 reinterpret_cast<GtkClipboardGetFunc>(ClipboardContents::getFunction),
@@ -226,8 +267,6 @@ auto ClipboardHandler::copy() -> bool {
     gtk_target_table_free(targets, n_targets);
     gtk_target_list_unref(list);
 
-    g_string_free(svgString, true);
-
     return true;
 }
 
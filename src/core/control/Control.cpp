@@ -1,5 +1,6 @@
 #include "Control.h"
 
+#include <algorithm>
 #include <ctime>
 #include <memory>
 #include <numeric>
@@ -8,11 +9,17 @@
 
 #include "control/jobs/AutosaveJob.h"
 #include "control/jobs/BaseExportJob.h"
+#include "control/jobs/BeautifyJob.h"
 #include "control/jobs/CustomExportJob.h"
+#include "control/jobs/ImageImportJob.h"
+#include "control/jobs/LatexRecompileJob.h"
 #include "control/jobs/PdfExportJob.h"
 #include "control/jobs/SaveJob.h"
+#include "control/jobs/UploadJob.h"
 #include "control/layer/LayerController.h"
 #include "control/pagetype/PageTypeHandler.h"
+#include "control/xojfile/AutosaveJournal.h"
+#include "control/xojfile/RemoteFile.h"
 #include "gui/PdfFloatingToolbox.h"
 #include "gui/TextEditor.h"
 #include "gui/XournalView.h"
@@ -21,6 +28,7 @@
 #include "gui/dialog/FillOpacityDialog.h"
 #include "gui/dialog/FormatDialog.h"
 #include "gui/dialog/GotoDialog.h"
+#include "gui/dialog/MemoryDialog.h"
 #include "gui/dialog/PageTemplateDialog.h"
 #include "gui/dialog/SelectBackgroundColorDialog.h"
 #include "gui/dialog/SettingsDialog.h"
@@ -29,14 +37,20 @@
 #include "gui/inputdevices/HandRecognition.h"
 #include "gui/toolbarMenubar/model/ToolbarData.h"
 #include "gui/toolbarMenubar/model/ToolbarModel.h"
+#include "gui/widgets/XournalWidget.h"
+#include "model/ImageStore.h"
 #include "model/StrokeStyle.h"
+#include "pdf/base/XojPdfDocumentPool.h"
 #include "plugin/PluginController.h"
+#include "stockdlg/ImageOpenDlg.h"
 #include "stockdlg/XojOpenDlg.h"
 #include "undo/AddUndoAction.h"
 #include "undo/DeleteUndoAction.h"
+#include "undo/GroupUndoAction.h"
 #include "undo/InsertDeletePageUndoAction.h"
 #include "undo/InsertUndoAction.h"
 #include "util/PathUtil.h"
+#include "util/Profiler.h"
 #include "util/Stacktrace.h"
 #include "util/StringUtils.h"
 #include "util/Util.h"
@@ -49,6 +63,7 @@
 #include "FullscreenHandler.h"
 #include "LatexController.h"
 #include "PageBackgroundChangeController.h"
+#include "PdfReloader.h"
 #include "PrintHandler.h"
 #include "UndoRedoController.h"
 #include "config-dev.h"
@@ -56,11 +71,16 @@
 
 using std::string;
 
+int Control::instances = 0;
+
 Control::Control(GApplication* gtkApp, GladeSearchpath* gladeSearchPath): gtkApp(gtkApp) {
+    instances++;
     this->recent = new RecentManager();
     this->undoRedo = new UndoRedoHandler(this);
     this->recent->addListener(this);
     this->undoRedo->addUndoRedoListener(this);
+    this->autosaveJournal = new AutosaveJournal();
+    this->undoRedo->addUndoRedoListener(this->autosaveJournal);
     this->isBlocking = false;
 
     this->gladeSearchPath = gladeSearchPath;
@@ -74,7 +94,10 @@ Control::Control(GApplication* gtkApp, GladeSearchpath* gladeSearchPath): gtkApp
 
     auto name = Util::getConfigFile(SETTINGS_XML_FILE);
     this->settings = new Settings(std::move(name));
-    this->settings->load();
+    {
+        xoj::util::Profiler::Scope scope("startup: settings", "startup");
+        this->settings->load();
+    }
 
     this->applyPreferredLanguage();
 
@@ -82,15 +105,21 @@ Control::Control(GApplication* gtkApp, GladeSearchpath* gladeSearchPath): gtkApp
     this->newPageType = std::make_unique<PageTypeMenu>(this->pageTypes, settings, true, true);
 
     this->audioController = new AudioController(this->settings, this);
+    this->undoRedo->addUndoRedoListener(this->audioController->getTimeline());
 
     this->scrollHandler = new ScrollHandler(this);
 
     this->scheduler = new XournalScheduler();
+    this->scheduler->setWorkerCount(this->settings->getSchedulerThreadCount());
 
     this->doc = new Document(this);
+    this->doc->setPdfDocumentPool(&XojPdfDocumentPool::getInstance());
+    this->pdfReloader = std::make_unique<PdfReloader>(this);
 
-    // for crashhandling
-    setEmergencyDocument(this->doc);
+    // for crashhandling, the document of the first window
+    if (instances == 1) {
+        setEmergencyDocument(this->doc);
+    }
 
     this->zoom = new ZoomControl();
     this->zoom->setZoomStep(this->settings->getZoomStep() / 100.0);
@@ -113,8 +142,11 @@ Control::Control(GApplication* gtkApp, GladeSearchpath* gladeSearchPath): gtkApp
 
     this->fullscreenHandler = new FullscreenHandler(settings);
 
-    this->pluginController = new PluginController(this);
-    this->pluginController->registerToolbar();
+    {
+        xoj::util::Profiler::Scope scope("startup: plugins", "startup");
+        this->pluginController = new PluginController(this);
+        this->pluginController->registerToolbar();
+    }
 }
 
 Control::~Control() {
@@ -122,7 +154,23 @@ Control::~Control() {
     this->enableAutosave(false);
 
     deleteLastAutosaveFile("");
+    if (this->backgroundExport) {
+        this->backgroundExport->cancel();
+        this->backgroundExportThread.join();
+        // Drops its pending afterRun() call, which would refer to this Control
+        this->backgroundExport->deleteJob();
+        this->backgroundExport->unref();
+        this->backgroundExport = nullptr;
+    }
+    if (this->backgroundUpload) {
+        // Not cancelled: the document is only saved once uploaded
+        this->backgroundUploadThread.join();
+        this->backgroundUpload->deleteJob();
+        this->backgroundUpload->unref();
+        this->backgroundUpload = nullptr;
+    }
     this->scheduler->stop();
+    this->pdfReloader.reset();
     this->changedPages.clear();  // can be removed, will be done by implicit destructor
 
     delete this->pluginController;
@@ -133,6 +181,8 @@ Control::~Control() {
     this->recent = nullptr;
     delete this->undoRedo;
     this->undoRedo = nullptr;
+    delete this->autosaveJournal;
+    this->autosaveJournal = nullptr;
     delete this->settings;
     this->settings = nullptr;
     delete this->toolHandler;
@@ -141,6 +191,10 @@ Control::~Control() {
     this->sidebar = nullptr;
     delete this->doc;
     this->doc = nullptr;
+    // Read by the pages of the document, of all the windows
+    if (--instances == 0) {
+        RemoteFile::removeLocalCopies();
+    }
     delete this->searchBar;
     this->searchBar = nullptr;
     delete this->scrollHandler;
@@ -200,6 +254,18 @@ void Control::renameLastAutosaveFile() {
         errors.emplace_back(FS(fmtstr % filename.u8string() % renamed.u8string() % e.what()));
     }
 
+    // The changes appended since the snapshot go along with it
+    auto journal = AutosaveJournal::getJournalPath(filename);
+    if (fs::exists(journal)) {
+        auto renamedJournal = AutosaveJournal::getJournalPath(renamed);
+        try {
+            Util::safeRenameFile(journal, renamedJournal);
+        } catch (fs::filesystem_error const& e) {
+            auto fmtstr = _F("Could not rename autosave file from \"{1}\" to \"{2}\": {3}");
+            errors.emplace_back(FS(fmtstr % journal.u8string() % renamedJournal.u8string() % e.what()));
+        }
+    }
+
 
     if (!errors.empty()) {
         string error = std::accumulate(errors.begin() + 1, errors.end(), *errors.begin(),
@@ -215,6 +281,9 @@ void Control::setLastAutosaveFile(fs::path newAutosaveFile) { this->lastAutosave
 
 void Control::deleteLastAutosaveFile(fs::path newAutosaveFile) {
     fs::remove(this->lastAutosaveFilename);
+    if (!this->lastAutosaveFilename.empty()) {
+        fs::remove(AutosaveJournal::getJournalPath(this->lastAutosaveFilename));
+    }
     this->lastAutosaveFilename = std::move(newAutosaveFile);
 }
 
@@ -309,6 +378,10 @@ auto Control::autosaveCallback(Control* control) -> bool {
         // do nothing, nothing changed
         return true;
     }
+    if (control->remainingPages && !control->remainingPages->isFinished()) {
+        // The document is not complete yet
+        return true;
+    }
 
 
     g_message("Info: autosave document...");
@@ -480,6 +553,9 @@ void Control::actionPerformed(ActionType type, ActionGroup group, GdkEvent* even
         case ACTION_APPEND_NEW_PDF_PAGES:
             appendNewPdfPages();
             break;
+        case ACTION_IMPORT_IMAGES:
+            importImages();
+            break;
         case ACTION_NEW_PAGE_AT_END:
             insertNewPage(this->doc->getPageCount());
             break;
@@ -792,6 +868,12 @@ void Control::actionPerformed(ActionType type, ActionGroup group, GdkEvent* even
         case ACTION_TEX:
             runLatex();
             break;
+        case ACTION_TEX_RECOMPILE:
+            recompileLatex();
+            break;
+        case ACTION_BEAUTIFY:
+            beautify();
+            break;
 
             // Menu View
         case ACTION_ZOOM_100:
@@ -977,6 +1059,9 @@ void Control::actionPerformed(ActionType type, ActionGroup group, GdkEvent* even
         case ACTION_ABOUT:
             showAbout();
             break;
+        case ACTION_MEMORY_REPORT:
+            showMemoryReport();
+            break;
 
         case ACTION_NONE:
             // do nothing
@@ -1354,6 +1439,9 @@ void Control::appendNewPdfPages() {
         string msg = FS(_F("No pdf pages available to append. You may need to reopen the document first."));
         XojMsgBox::showErrorToUser(getGtkWindow(), msg);
     }
+
+    std::vector<PageRef> newPages;
+    newPages.reserve(insertCount);
     for (size_t i = 0; i != insertCount; ++i) {
 
         doc->lock();
@@ -1363,12 +1451,26 @@ void Control::appendNewPdfPages() {
         if (pdf) {
             auto newPage = std::make_shared<XojPage>(pdf->getWidth(), pdf->getHeight());
             newPage->setBackgroundPdfPageNr(currentPdfPageCount + i);
-            insertPage(newPage, pageCount + i);
+            newPages.push_back(std::move(newPage));
         } else {
             string msg = FS(_F("Unable to retrieve pdf page."));  // should not happen
             XojMsgBox::showErrorToUser(getGtkWindow(), msg);
         }
     }
+    insertPages(newPages, pageCount);
+}
+
+void Control::importImages() {
+    bool attach = false;
+    std::vector<fs::path> files = ImageOpenDlg::showMultiple(getGtkWindow(), this->settings, &attach);
+    if (files.empty()) {
+        return;
+    }
+    clearSelectionEndText();
+
+    auto* job = new ImageImportJob(this, std::move(files), getCurrentPageNo() + 1, attach);
+    this->scheduler->addJob(job, JOB_PRIORITY_NONE);
+    job->unref();
 }
 
 void Control::insertPage(const PageRef& page, size_t position) {
@@ -1391,6 +1493,34 @@ void Control::insertPage(const PageRef& page, size_t position) {
     undoRedo->addUndoAction(std::make_unique<InsertDeletePageUndoAction>(page, position, true));
 }
 
+void Control::insertPages(const std::vector<PageRef>& pages, size_t position) {
+    if (pages.size() <= 1) {
+        if (!pages.empty()) {
+            insertPage(pages.front(), position);
+        }
+        return;
+    }
+
+    this->doc->lock();
+    this->doc->insertPages(pages.begin(), pages.end(), position);
+    this->doc->unlock();
+
+    // One notification: the views and the sidebar are laid out once
+    firePagesInserted(position, pages.size());
+
+    getCursor()->updateCursor();
+
+    scrollHandler->scrollToPage(position);
+    firePageSelected(position);
+
+    updateDeletePageButton();
+    auto undo = std::make_unique<GroupUndoAction>();
+    for (size_t i = 0; i < pages.size(); i++) {
+        undo->addAction(std::make_unique<InsertDeletePageUndoAction>(pages[i], position + i, true));
+    }
+    undoRedo->addUndoAction(std::move(undo));
+}
+
 void Control::gotoPage() {
     auto* dlg = new GotoDialog(this->gladeSearchPath, int(this->doc->getPageCount()));
 
@@ -1999,6 +2129,8 @@ void Control::showSettings() {
         scrollHandler->scrollToPage(getCurrentPageNo());
     }
 
+    // The cursors drawn with the previous highlight settings
+    getCursor()->clearCache();
     if (stylusCursorType != settings->getStylusCursorType() || highlightPosition != settings->isHighlightPosition()) {
         getCursor()->updateCursor();
     }
@@ -2006,6 +2138,9 @@ void Control::showSettings() {
     win->updateScrollbarSidebarPosition();
     this->updateWindowTitle();
 
+    // The frame reused while scrolling has the previous colors
+    gtk_xournal_repaint(win->getXournal()->getWidget());
+
     enableAutosave(settings->isAutosaveEnabled());
 
     this->zoom->setZoomStep(settings->getZoomStep() / 100.0);
@@ -2082,13 +2217,21 @@ auto Control::openFile(fs::path filepath, int scrollToPage, bool forceOpen) -> b
         return loadPdf(filepath, scrollToPage);
     }
 
-    LoadHandler loadHandler;
-    Document* loadedDocument = loadHandler.loadDocument(filepath);
-    if ((loadedDocument != nullptr && loadHandler.isAttachedPdfMissing()) ||
-        !loadHandler.getMissingPdfFilename().empty()) {
+    auto loadHandler = std::make_unique<LoadHandler>();
+    loadHandler->setLazyPageLoading(settings->isLazyPageLoading());
+    loadHandler->setPdfDocumentPool(&XojPdfDocumentPool::getInstance());
+
+    // The document is shown once the pages up to the one to show are parsed, the others are added as they are parsed
+    MetadataEntry md = MetadataManager::getForFile(filepath);
+    int shownPage = scrollToPage >= 0 ? scrollToPage : (md.valid ? md.page : 0);
+    loadHandler->setFirstPageCount(static_cast<size_t>(std::max(shownPage, 0)) + RemainingPagesLoader::FIRST_PAGES);
+
+    Document* loadedDocument = loadHandler->loadDocument(filepath);
+    if ((loadedDocument != nullptr && loadHandler->isAttachedPdfMissing()) ||
+        !loadHandler->getMissingPdfFilename().empty()) {
         // give the user a second chance to select a new PDF filepath, or to discard the PDF
 
-        const fs::path missingFilePath = fs::path(loadHandler.getMissingPdfFilename());
+        const fs::path missingFilePath = fs::path(loadHandler->getMissingPdfFilename());
         const std::string msg1 =
                 FS(_F("The attached background file {1} could not be found. It might have been moved, renamed or "
                       "deleted.\nIt was last seen at: {2}") %
@@ -2099,7 +2242,7 @@ auto Control::openFile(fs::path filepath, int scrollToPage, bool forceOpen) -> b
                    missingFilePath.filename().string() % missingFilePath.parent_path().string());
         GtkWidget* dialog =
                 gtk_message_dialog_new(getGtkWindow(), GTK_DIALOG_MODAL, GTK_MESSAGE_QUESTION, GTK_BUTTONS_NONE, "%s",
-                                       loadHandler.isAttachedPdfMissing() ? msg1.c_str() : msg2.c_str());
+                                       loadHandler->isAttachedPdfMissing() ? msg1.c_str() : msg2.c_str());
 
         gtk_dialog_add_button(GTK_DIALOG(dialog), _("Select another PDF"), 1);
         gtk_dialog_add_button(GTK_DIALOG(dialog), _("Remove PDF Background"), 2);
@@ -2110,27 +2253,27 @@ auto Control::openFile(fs::path filepath, int scrollToPage, bool forceOpen) -> b
 
         if (res == 2)  // remove PDF background
         {
-            loadHandler.removePdfBackground();
-            loadedDocument = loadHandler.loadDocument(filepath);
+            loadHandler->removePdfBackground();
+            loadedDocument = loadHandler->loadDocument(filepath);
         } else if (res == 1)  // select another PDF background
         {
             bool attachToDocument = false;
             XojOpenDlg dlg(getGtkWindow(), this->settings);
             auto pdfFilename = dlg.showOpenDialog(true, attachToDocument);
             if (!pdfFilename.empty()) {
-                loadHandler.setPdfReplacement(pdfFilename, attachToDocument);
-                loadedDocument = loadHandler.loadDocument(filepath);
+                loadHandler->setPdfReplacement(pdfFilename, attachToDocument);
+                loadedDocument = loadHandler->loadDocument(filepath);
             }
         }
     }
 
     if (!loadedDocument) {
-        string msg = FS(_F("Error opening file \"{1}\"") % filepath.u8string()) + "\n" + loadHandler.getLastError();
+        string msg = FS(_F("Error opening file \"{1}\"") % filepath.u8string()) + "\n" + loadHandler->getLastError();
         XojMsgBox::showErrorToUser(getGtkWindow(), msg);
 
         fileLoaded(scrollToPage);
         return false;
-    } else if (loadHandler.getFileVersion() > FILE_FORMAT_VERSION) {
+    } else if (loadHandler->getFileVersion() > FILE_FORMAT_VERSION) {
         GtkWidget* dialog = gtk_message_dialog_new(
                 getGtkWindow(), GTK_DIALOG_MODAL, GTK_MESSAGE_WARNING, GTK_BUTTONS_YES_NO, "%s",
                 _("The file being loaded has a file format version newer than the one currently supported by this "
@@ -2150,6 +2293,20 @@ auto Control::openFile(fs::path filepath, int scrollToPage, bool forceOpen) -> b
     *this->doc = *loadedDocument;
     this->doc->unlock();
 
+    if (loadHandler->hasRemainingPages()) {
+        auto done = [this, filepath](const std::string& error) {
+            if (!error.empty()) {
+                std::string msg = FS(_F("Error opening file \"{1}\"") % filepath.u8string()) + "\n" + error;
+                XojMsgBox::showErrorToUser(getGtkWindow(), msg);
+            }
+        };
+        auto addPages = [this](const std::vector<PageRef>& pages, const Document* pdf) {
+            appendLoadedPages(pages, pdf);
+        };
+        this->remainingPages =
+                std::make_unique<RemainingPagesLoader>(std::move(loadHandler), std::move(addPages), std::move(done));
+    }
+
     // Set folder as last save path, so the next save will be at the current document location
     // This is important because of the new .xopp format, where Xournal .xoj handled as import,
     // not as file to load
@@ -2160,8 +2317,32 @@ auto Control::openFile(fs::path filepath, int scrollToPage, bool forceOpen) -> b
     return true;
 }
 
+void Control::appendLoadedPages(const std::vector<PageRef>& pages, const Document* pdf) {
+    this->doc->lock();
+    if (pdf) {
+        this->doc->setPdfFrom(*pdf);
+    }
+    size_t first = this->doc->getPageCount();
+    this->doc->addPages(pages.begin(), pages.end());
+    this->doc->unlock();
+
+    if (pdf) {
+        fireDocumentChanged(DOCUMENT_CHANGE_PDF_BOOKMARKS);
+    }
+    firePagesInserted(first, pages.size());
+    updateDeletePageButton();
+}
+
+void Control::finishLoading() {
+    if (this->remainingPages) {
+        this->remainingPages->finish();
+    }
+}
+
 auto Control::loadPdf(const fs::path& filepath, int scrollToPage) -> bool {
     LoadHandler loadHandler;
+    loadHandler.setLazyPageLoading(settings->isLazyPageLoading());
+    loadHandler.setPdfDocumentPool(&XojPdfDocumentPool::getInstance());
 
     if (settings->isAutoloadPdfXoj()) {
         Document* tmp;
@@ -2315,9 +2496,8 @@ auto Control::annotatePdf(fs::path filepath, bool /*attachPdf*/, bool attachToDo
 }
 
 void Control::print() {
-    this->doc->lock();
-    PrintHandler::print(this->doc, getCurrentPageNo(), this->getGtkWindow());
-    this->doc->unlock();
+    finishLoading();
+    PrintHandler::print(this->doc, this->scheduler, getCurrentPageNo(), this->getGtkWindow());
 }
 
 void Control::block(const string& name) {
@@ -2350,20 +2530,139 @@ void Control::unblock() {
     getCursor()->setCursorBusy(false);
     disableSidebarTmp(false);
 
-    gtk_widget_hide(this->statusbar);
+    if (this->backgroundExport) {
+        // The statusbar shows the progress of the export again
+        gtk_label_set_text(this->lbState, _("Exporting"));
+    } else if (this->backgroundUpload) {
+        gtk_label_set_text(this->lbState, _("Uploading"));
+    } else {
+        gtk_widget_hide(this->statusbar);
+    }
 
     this->isBlocking = false;
 }
 
+void Control::exportInBackground(BaseExportJob* job) {
+    this->statusbar = this->win->get("statusbar");
+    this->lbState = GTK_LABEL(this->win->get("lbState"));
+    this->pgState = GTK_PROGRESS_BAR(this->win->get("pgState"));
+
+    gtk_label_set_text(this->lbState, _("Exporting"));
+    gtk_progress_bar_set_fraction(this->pgState, 0);
+    gtk_widget_show(this->win->get("btCancelState"));
+    gtk_widget_show(this->statusbar);
+    this->maxState = 100;
+
+    job->ref();
+    this->backgroundExport = job;
+    this->backgroundExportThread = std::thread([job]() { job->runInBackground(); });
+}
+
+void Control::backgroundExportFinished() {
+    if (!this->backgroundExport) {
+        return;
+    }
+    // The export only queued its afterRun() call before returning
+    this->backgroundExportThread.join();
+    this->backgroundExport->unref();
+    this->backgroundExport = nullptr;
+
+    if (this->backgroundUpload) {
+        gtk_label_set_text(this->lbState, _("Uploading"));
+        return;
+    }
+    gtk_widget_hide(this->win->get("btCancelState"));
+    if (!this->isBlocking) {
+        gtk_widget_hide(this->statusbar);
+    }
+}
+
+void Control::cancelBackgroundExport() {
+    if (this->backgroundExport) {
+        this->backgroundExport->cancel();
+    }
+    if (this->backgroundUpload) {
+        this->backgroundUpload->cancelUpload();
+    }
+}
+
+void Control::uploadInBackground(const fs::path& staged, const fs::path& target) {
+    if (this->backgroundUpload) {
+        // Replaced by the new save
+        this->backgroundUpload->cancelUpload();
+        this->backgroundUploadThread.join();
+        this->backgroundUpload->deleteJob();
+        this->backgroundUpload->unref();
+        this->backgroundUpload = nullptr;
+    }
+
+    this->statusbar = this->win->get("statusbar");
+    this->lbState = GTK_LABEL(this->win->get("lbState"));
+    this->pgState = GTK_PROGRESS_BAR(this->win->get("pgState"));
+
+    if (!this->backgroundExport) {
+        gtk_label_set_text(this->lbState, _("Uploading"));
+        gtk_progress_bar_set_fraction(this->pgState, 0);
+    }
+    gtk_widget_show(this->win->get("btCancelState"));
+    gtk_widget_show(this->statusbar);
+
+    auto* job = new UploadJob(this, staged, target);
+    this->backgroundUpload = job;
+    this->backgroundUploadThread = std::thread([job]() { job->runInBackground(); });
+}
+
+void Control::backgroundUploadFinished() {
+    if (!this->backgroundUpload) {
+        return;
+    }
+    if (this->backgroundUploadThread.joinable()) {
+        this->backgroundUploadThread.join();
+    }
+    std::string error = this->backgroundUpload->getError();
+    this->backgroundUpload->unref();
+    this->backgroundUpload = nullptr;
+
+    if (!this->backgroundExport) {
+        gtk_widget_hide(this->win->get("btCancelState"));
+        if (!this->isBlocking) {
+            gtk_widget_hide(this->statusbar);
+        }
+    }
+
+    if (!error.empty()) {
+        // The file keeps its previous version
+        this->undoRedo->documentSaveFailed();
+        updateWindowTitle();
+        XojMsgBox::showErrorToUser(getGtkWindow(), FS(_F("Save file error: {1}") % error));
+    }
+}
+
+void Control::finishBackgroundUpload() {
+    if (!this->backgroundUpload) {
+        return;
+    }
+    this->backgroundUploadThread.join();
+    // Its afterRun() call is dropped, the upload is finished at once
+    this->backgroundUpload->deleteJob();
+    backgroundUploadFinished();
+}
+
 void Control::setMaximumState(int max) { this->maxState = max; }
 
 void Control::setCurrentState(int state) {
     Util::execInUiThread([=]() { gtk_progress_bar_set_fraction(this->pgState, gdouble(state) / this->maxState); });
 }
 
+void Control::setStateDuration(int state, std::chrono::steady_clock::duration duration) {
+    g_debug("Step %d of %d took %.1f ms", state + 1, this->maxState,
+            std::chrono::duration<double, std::milli>(duration).count());
+}
+
 auto Control::save(bool synchron) -> bool {
     // clear selection before saving
     clearSelectionEndText();
+    finishLoading();
 
     this->doc->lock();
     fs::path filepath = this->doc->getFilepath();
@@ -2378,7 +2677,7 @@ auto Control::save(bool synchron) -> bool {
     auto* job = new SaveJob(this);
     bool result = true;
     if (synchron) {
-        result = job->save();
+        result = job->save() && job->upload();
         unblock();
         this->resetSavedStatus();
     } else {
@@ -2491,8 +2790,15 @@ void Control::exportAs() {
 }
 
 void Control::exportBase(BaseExportJob* job) {
+    finishLoading();
     if (job->showFilechooser()) {
-        this->scheduler->addJob(job, JOB_PRIORITY_NONE);
+        if (job->canRunInBackground() && !this->backgroundExport) {
+            // The job blocked the UI while the export was set up
+            unblock();
+            exportInBackground(job);
+        } else {
+            this->scheduler->addJob(job, JOB_PRIORITY_NONE);
+        }
     } else {
         // The job blocked, so we have to unblock, because the job unblocks only after run
         unblock();
@@ -2501,6 +2807,7 @@ void Control::exportBase(BaseExportJob* job) {
 }
 
 auto Control::saveAs() -> bool {
+    finishLoading();
     if (!showSaveDialog()) {
         return false;
     }
@@ -2545,13 +2852,24 @@ void Control::quit(bool allowCancel) {
     this->scheduler->unlock();
     this->scheduler->stop();  // Finish current task. Must be called to finish pending saves.
     this->closeDocument();    // Must be done after all jobs has finished (Segfault on save/export)
-    settings->save();
+    settings->flush();
+
+    GtkApplication* app = GTK_APPLICATION(gtkApp);
+    if (this->win && g_list_length(gtk_application_get_windows(app)) > 1) {
+        // The other windows of the single instance mode keep the application running
+        GtkWindow* window = GTK_WINDOW(this->win->getWindow());
+        gtk_widget_hide(GTK_WIDGET(window));
+        gtk_application_remove_window(app, window);
+        return;
+    }
     g_application_quit(G_APPLICATION(gtkApp));
 }
 
 auto Control::close(const bool allowDestroy, const bool allowCancel) -> bool {
     clearSelectionEndText();
     metadata->documentChanged();
+    // A failed upload leaves the document changed
+    finishBackgroundUpload();
 
     bool discard = false;
     const bool fileRemoved = !doc->getFilepath().empty() && !fs::exists(this->doc->getFilepath());
@@ -2597,6 +2915,8 @@ auto Control::close(const bool allowDestroy, const bool allowCancel) -> bool {
 }
 
 void Control::closeDocument() {
+    // The pages still parsed belong to the closed document
+    this->remainingPages.reset();
     this->undoRedo->clearContents();
 
     this->doc->lock();
@@ -2639,6 +2959,11 @@ void Control::showAbout() {
     dlg.show(GTK_WINDOW(this->win->getWindow()));
 }
 
+void Control::showMemoryReport() {
+    MemoryDialog dlg(this->gladeSearchPath, this);
+    dlg.show(GTK_WINDOW(this->win->getWindow()));
+}
+
 void Control::clipboardCutCopyEnabled(bool enabled) {
     fireEnableAction(ACTION_CUT, enabled);
     fireEnableAction(ACTION_COPY, enabled);
@@ -2657,7 +2982,28 @@ void Control::clipboardPasteText(string text) {
 
 void Control::clipboardPasteImage(GdkPixbuf* img) {
     auto image = new Image();
-    image->setImage(img);
+
+    // Encoding large screenshots takes a while: the image is shown as a placeholder until they are ready
+    GdkPixbuf* pixbuf = GDK_PIXBUF(g_object_ref(img));
+    image->setImage(ImageStore::getAsync(
+            [pixbuf]() {
+                cairo_surface_t* surface = cairo_image_surface_create(
+                        CAIRO_FORMAT_ARGB32, gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf));
+                cairo_t* cr = cairo_create(surface);
+                gdk_cairo_set_source_pixbuf(cr, pixbuf, 0, 0);
+                cairo_paint(cr);
+                cairo_destroy(cr);
+                g_object_unref(pixbuf);
+                return ImageStore::Decoded{ImageStore::encodePng(surface), surface};
+            },
+            [this]() {
+                Util::execInUiThread([this]() {
+                    EditSelection* selection = this->win ? this->win->getXournal()->getSelection() : nullptr;
+                    if (selection) {
+                        selection->repaintElements();
+                    }
+                });
+            }));
 
     auto width =
             static_cast<double>(gdk_pixbuf_get_width(img)) / settings->getDisplayDpi() * Util::DPI_NORMALIZATION_FACTOR;
@@ -2916,12 +3262,39 @@ void Control::runLatex() {
     latex.run();
 }
 
+void Control::recompileLatex() {
+    // The selected images are not in their layer
+    clearSelectionEndText();
+
+    auto* job = new LatexRecompileJob(this, getToolHandler()->getTool(TOOL_TEXT).getColor());
+    this->scheduler->addJob(job, JOB_PRIORITY_NONE);
+    job->unref();
+}
+
+void Control::beautify() {
+    // The selected strokes are put back in their layer
+    std::vector<Element*> selected;
+    if (EditSelection* selection = win ? win->getXournal()->getSelection() : nullptr) {
+        selected = selection->getElements();
+        if (selected.empty()) {
+            return;
+        }
+    }
+    clearSelectionEndText();
+
+    auto* job = new BeautifyJob(this, std::move(selected), getCurrentPage());
+    this->scheduler->addJob(job, JOB_PRIORITY_NONE);
+    job->unref();
+}
+
 /**
  * GETTER / SETTER
  */
 
 auto Control::getUndoRedoHandler() -> UndoRedoHandler* { return this->undoRedo; }
 
+auto Control::getAutosaveJournal() -> AutosaveJournal* { return this->autosaveJournal; }
+
 auto Control::getZoomControl() -> ZoomControl* { return this->zoom; }
 
 auto Control::getCursor() -> XournalppCursor* { return this->cursor; }
@@ -2932,6 +3305,8 @@ auto Control::getToolHandler() -> ToolHandler* { return this->toolHandler; }
 
 auto Control::getScheduler() -> XournalScheduler* { return this->scheduler; }
 
+auto Control::getPdfReloader() -> PdfReloader* { return this->pdfReloader.get(); }
+
 auto Control::getWindow() -> MainWindow* { return this->win; }
 
 auto Control::getGtkWindow() const -> GtkWindow* { return GTK_WINDOW(this->win->getWindow()); }
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "control/jobs/ProgressListener.h"
@@ -33,11 +34,13 @@
 #include "AudioController.h"
 #include "ClipboardHandler.h"
 #include "RecentManager.h"
+#include "RemainingPagesLoader.h"
 #include "ScrollHandler.h"
 #include "ToolHandler.h"
 
 
 class AudioController;
+class AutosaveJournal;
 class FullscreenHandler;
 class Sidebar;
 class XojPageView;
@@ -51,7 +54,9 @@ class MetadataCallbackData;
 class PageBackgroundChangeController;
 class PageTypeHandler;
 class PageTypeMenu;
+class PdfReloader;
 class BaseExportJob;
+class UploadJob;
 class LayerController;
 class PluginController;
 
@@ -116,9 +121,18 @@ public:
     // The core handler for inserting latex
     void runLatex();
 
+    // Compile all the latex formulas again, e.g. after changing the template
+    void recompileLatex();
+
+    // Replace the strokes of the selection, or of the current page, by the recognized shapes
+    void beautify();
+
     // Menu Help
     void showAbout();
 
+    // The memory of the document and of the caches
+    void showMemoryReport();
+
     void actionPerformed(ActionType type, ActionGroup group, GdkEvent* event, GtkMenuItem* menuitem,
                          GtkToolButton* toolbutton, bool enabled) override;
 
@@ -192,7 +206,15 @@ public:
     void addDefaultPage(std::string pageTemplate);
     void insertNewPage(size_t position);
     void appendNewPdfPages();
+    /**
+     * Asks for images and inserts a page for each of them after the current page, see ImageImportJob
+     */
+    void importImages();
     void insertPage(const PageRef& page, size_t position);
+    /**
+     * Inserts consecutive pages with a single notification of the listeners and a single undo action
+     */
+    void insertPages(const std::vector<PageRef>& pages, size_t position);
     void deletePage();
 
     /**
@@ -227,9 +249,47 @@ public:
 
     XournalScheduler* getScheduler();
 
+    /**
+     * Reads the PDF background again once its file changes
+     */
+    PdfReloader* getPdfReloader();
+
     void block(const std::string& name);
     void unblock();
 
+    /**
+     * Runs the export on a thread of its own while the document is edited: it neither waits for the jobs of the
+     * scheduler, e.g. the rendering, nor delays them. Its progress is shown in the statusbar, with a button to cancel
+     * it. Only one export runs in the background at a time.
+     */
+    void exportInBackground(BaseExportJob* job);
+
+    /**
+     * Called on the UI thread by the export, once it stopped
+     */
+    void backgroundExportFinished();
+
+    /**
+     * Cancels the export and the upload running in the background
+     */
+    void cancelBackgroundExport();
+
+    /**
+     * Uploads a remote document saved into a staging folder on a thread of its own, see RemoteFile. Its progress is
+     * shown like the one of a background export. An upload still running is replaced.
+     */
+    void uploadInBackground(const fs::path& staged, const fs::path& target);
+
+    /**
+     * Called on the UI thread by the upload, once it stopped: shows its error, and marks the document changed then
+     */
+    void backgroundUploadFinished();
+
+    /**
+     * Waits for the upload running in the background, e.g. before the document is closed
+     */
+    void finishBackgroundUpload();
+
     void renameLastAutosaveFile();
     void setLastAutosaveFile(fs::path newAutosaveFile);
     void deleteLastAutosaveFile(fs::path newAutosaveFile);
@@ -242,6 +302,7 @@ public:
     ZoomControl* getZoomControl();
     Document* getDocument();
     UndoRedoHandler* getUndoRedoHandler();
+    AutosaveJournal* getAutosaveJournal();
     MainWindow* getWindow();
     GtkWindow* getGtkWindow() const;
     ScrollHandler* getScrollHandler();
@@ -281,6 +342,7 @@ public:
     // ProgressListener interface
     void setMaximumState(int max) override;
     void setCurrentState(int state) override;
+    void setStateDuration(int state, std::chrono::steady_clock::duration duration) override;
 
 public:
     // ClipboardListener interface
@@ -338,6 +400,16 @@ private:
      */
     void closeDocument();
 
+    /**
+     * Append the pages parsed after the document was shown, see RemainingPagesLoader
+     */
+    void appendLoadedPages(const std::vector<PageRef>& pages, const Document* pdf);
+
+    /**
+     * Wait until all the pages of the document are parsed and added, before it is saved or exported
+     */
+    void finishLoading();
+
     /**
      * Applies the preferred language to the UI
      */
@@ -345,6 +417,7 @@ private:
 
     RecentManager* recent = nullptr;
     UndoRedoHandler* undoRedo = nullptr;
+    AutosaveJournal* autosaveJournal = nullptr;
     ZoomControl* zoom = nullptr;
 
     Settings* settings = nullptr;
@@ -369,6 +442,11 @@ private:
 
     GApplication* gtkApp = nullptr;
 
+    /**
+     * The windows of the process, see --single-instance
+     */
+    static int instances;
+
     /**
      * The cursor handler
      */
@@ -406,6 +484,18 @@ private:
     int maxState = 0;
     bool isBlocking;
 
+    /**
+     * The export running in the background, see exportInBackground(), and its thread
+     */
+    BaseExportJob* backgroundExport = nullptr;
+    std::thread backgroundExportThread;
+
+    /**
+     * The upload running in the background, see uploadInBackground(), and its thread
+     */
+    UploadJob* backgroundUpload = nullptr;
+    std::thread backgroundUploadThread;
+
     GladeSearchpath* gladeSearchPath;
 
     MetadataManager* metadata;
@@ -413,6 +503,13 @@ private:
     PageTypeHandler* pageTypes;
     std::unique_ptr<PageTypeMenu> newPageType;
 
+    /**
+     * Parses the pages of the opened document after the first ones, until they are all added
+     */
+    std::unique_ptr<RemainingPagesLoader> remainingPages;
+
+    std::unique_ptr<PdfReloader> pdfReloader;
+
     PageBackgroundChangeController* pageBackgroundChangeController;
 
     LayerController* layerController;
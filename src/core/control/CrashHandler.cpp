@@ -5,6 +5,7 @@
 #include <config-dev.h>
 #include <gtk/gtk.h>
 
+#include "control/xojfile/EmergencyDump.h"
 #include "control/xojfile/SaveHandler.h"
 #include "model/Document.h"
 #include "util/PathUtil.h"
@@ -28,6 +29,12 @@ void emergencySave() {
 
     g_warning(_("Trying to emergency save the current open document…"));
 
+    // The dump does not build the XML tree nor compress, it is converted into the emergency save on the next start
+    if (EmergencyDump::write(document)) {
+        g_warning("%s", FC(_F("Successfully saved document to \"{1}\"") % EmergencyDump::getFilepath().string()));
+        return;
+    }
+
     auto const& filepath = Util::getConfigFile("emergencysave.xopp");
 
     SaveHandler handler;
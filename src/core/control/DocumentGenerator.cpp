@@ -0,0 +1,231 @@
+#include "DocumentGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <cairo-pdf.h>
+#include <cairo.h>
+
+#include "model/Document.h"
+#include "model/Font.h"
+#include "model/Image.h"
+#include "model/Layer.h"
+#include "model/PageType.h"
+#include "model/Point.h"
+#include "model/Stroke.h"
+#include "model/TexImage.h"
+#include "model/Text.h"
+#include "model/XojPage.h"
+#include "util/StringUtils.h"
+#include "util/i18n.h"
+
+static constexpr double PAGE_WIDTH = 595;
+static constexpr double PAGE_HEIGHT = 842;
+static constexpr double MARGIN = 20;
+
+static auto appendToString(void* closure, const unsigned char* data, unsigned int length) -> cairo_status_t {
+    static_cast<std::string*>(closure)->append(reinterpret_cast<const char*>(data), length);
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static auto parseNumber(const std::string& key, const std::string& value) -> size_t {
+    size_t end = 0;
+    unsigned long long number = 0;
+    try {
+        number = std::stoull(value, &end);
+    } catch (const std::exception&) { end = 0; }
+    if (value.empty() || end != value.size() || value.front() == '-') {
+        throw std::invalid_argument(FS(FORMAT_STR("Invalid value \"{1}\" of {2}") % value % key));
+    }
+    return static_cast<size_t>(number);
+}
+
+auto DocumentGenerator::parseOptions(const std::string& spec) -> Options {
+    Options options;
+    for (const std::string& entry: StringUtils::split(spec, ',')) {
+        if (entry.empty()) {
+            continue;
+        }
+        auto separator = entry.find('=');
+        if (separator == std::string::npos) {
+            throw std::invalid_argument(FS(FORMAT_STR("Expected KEY=VALUE instead of \"{1}\"") % entry));
+        }
+        std::string key = entry.substr(0, separator);
+        size_t value = parseNumber(key, entry.substr(separator + 1));
+
+        if (key == "pages") {
+            options.pages = value;
+        } else if (key == "layers") {
+            options.layers = std::max<size_t>(value, 1);
+        } else if (key == "strokes") {
+            options.strokes = value;
+        } else if (key == "points") {
+            options.points = value;
+        } else if (key == "pressure") {
+            options.pressure = value != 0;
+        } else if (key == "images") {
+            options.images = value;
+        } else if (key == "texts") {
+            options.texts = value;
+        } else if (key == "tex") {
+            options.texImages = value;
+        } else if (key == "seed") {
+            options.seed = static_cast<uint32_t>(value);
+        } else {
+            throw std::invalid_argument(FS(FORMAT_STR("Unknown key \"{1}\"") % key));
+        }
+    }
+    return options;
+}
+
+DocumentGenerator::DocumentGenerator(Options options): options(options) {
+    if (this->options.texImages == 0) {
+        return;
+    }
+
+    cairo_surface_t* surface = cairo_pdf_surface_create_for_stream(&appendToString, &this->texPdf, 60, 24);
+    cairo_t* cr = cairo_create(surface);
+    cairo_select_font_face(cr, "Serif", CAIRO_FONT_SLANT_ITALIC, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 14);
+    cairo_move_to(cr, 4, 17);
+    cairo_show_text(cr, "e = mc²");
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+}
+
+void DocumentGenerator::generate(Document* doc) {
+    std::vector<PageRef> pages;
+    pages.reserve(this->options.pages);
+    for (size_t p = 0; p < this->options.pages; p++) {
+        std::seed_seq seed{this->options.seed, static_cast<uint32_t>(p)};
+        std::mt19937 random(seed);
+
+        auto page = std::make_shared<XojPage>(PAGE_WIDTH, PAGE_HEIGHT);
+        page->setBackgroundType(PageType(PageTypeFormat::Lined));
+        for (size_t l = 0; l < this->options.layers; l++) {
+            auto* layer = new Layer();
+            addStrokes(layer, random);
+            if (l == 0) {
+                addImages(layer, random);
+                addTexts(layer, random);
+                addTexImages(layer, random);
+            }
+            page->addLayer(layer);
+        }
+
+        pages.push_back(std::move(page));
+    }
+
+    // At once: each addition renumbers the pages
+    doc->addPages(pages.begin(), pages.end());
+}
+
+void DocumentGenerator::addStrokes(Layer* layer, std::mt19937& random) const {
+    static const std::vector<Color> COLORS = {Color(0x000000U), Color(0x3333ccU), Color(0xff0000U), Color(0x008000U)};
+
+    std::uniform_real_distribution<double> startX(MARGIN, PAGE_WIDTH - MARGIN);
+    std::uniform_real_distribution<double> startY(MARGIN, PAGE_HEIGHT - MARGIN);
+    std::normal_distribution<double> turn(0, 0.4);
+    std::uniform_real_distribution<double> force(0.3, 1.0);
+    std::uniform_int_distribution<size_t> color(0, COLORS.size() - 1);
+
+    for (size_t s = 0; s < this->options.strokes; s++) {
+        auto* stroke = new Stroke();
+        stroke->setColor(COLORS[color(random)]);
+        stroke->setWidth(1.41);
+        if (s % 20 == 19) {
+            stroke->setToolType(STROKE_TOOL_HIGHLIGHTER);
+            stroke->setColor(Color(0xffff00U));
+            stroke->setWidth(8.5);
+        }
+
+        // A random walk with some inertia, like handwriting
+        double x = startX(random);
+        double y = startY(random);
+        double angle = 0;
+        for (size_t i = 0; i < std::max<size_t>(this->options.points, 2); i++) {
+            angle += turn(random);
+            x = std::clamp(x + 1.2 * std::cos(angle), 0.0, PAGE_WIDTH);
+            y = std::clamp(y + 1.2 * std::sin(angle), 0.0, PAGE_HEIGHT);
+            stroke->addPoint(this->options.pressure ? Point(x, y, force(random)) : Point(x, y));
+        }
+        layer->addElement(stroke);
+    }
+}
+
+void DocumentGenerator::addImages(Layer* layer, std::mt19937& random) const {
+    std::uniform_real_distribution<double> x(MARGIN, PAGE_WIDTH / 2);
+    std::uniform_real_distribution<double> y(MARGIN, PAGE_HEIGHT / 2);
+    std::uniform_real_distribution<double> channel(0, 1);
+
+    for (size_t i = 0; i < this->options.images; i++) {
+        // A gradient of random colors, so that the images are not shared by the ImageStore
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, 256, 192);
+        cairo_t* cr = cairo_create(surface);
+        cairo_pattern_t* gradient = cairo_pattern_create_linear(0, 0, 256, 192);
+        cairo_pattern_add_color_stop_rgb(gradient, 0, channel(random), channel(random), channel(random));
+        cairo_pattern_add_color_stop_rgb(gradient, 1, channel(random), channel(random), channel(random));
+        cairo_set_source(cr, gradient);
+        cairo_paint(cr);
+        cairo_pattern_destroy(gradient);
+        cairo_destroy(cr);
+
+        std::string png;
+        cairo_surface_write_to_png_stream(surface, &appendToString, &png);
+        cairo_surface_destroy(surface);
+
+        auto* image = new Image();
+        image->setImage(std::move(png));
+        image->setX(x(random));
+        image->setY(y(random));
+        image->setWidth(256);
+        image->setHeight(192);
+        layer->addElement(image);
+    }
+}
+
+void DocumentGenerator::addTexts(Layer* layer, std::mt19937& random) const {
+    static const std::vector<std::string> WORDS = {"lorem", "ipsum",  "dolor",   "sit",   "amet",  "consectetur",
+                                                   "proof", "lemma",  "theorem", "since", "hence", "therefore"};
+
+    std::uniform_real_distribution<double> x(MARGIN, PAGE_WIDTH - 250);
+    std::uniform_real_distribution<double> y(MARGIN, PAGE_HEIGHT - 80);
+    std::uniform_int_distribution<size_t> word(0, WORDS.size() - 1);
+
+    XojFont font;
+    font.setName("Sans");
+    font.setSize(12);
+
+    for (size_t i = 0; i < this->options.texts; i++) {
+        std::string content;
+        for (size_t line = 0; line < 4; line++) {
+            for (size_t w = 0; w < 6; w++) { content += WORDS[word(random)] + (w < 5 ? " " : "\n"); }
+        }
+
+        auto* text = new Text();
+        text->setFont(font);
+        text->setText(content);
+        text->setX(x(random));
+        text->setY(y(random));
+        layer->addElement(text);
+    }
+}
+
+void DocumentGenerator::addTexImages(Layer* layer, std::mt19937& random) const {
+    std::uniform_real_distribution<double> x(MARGIN, PAGE_WIDTH - 80);
+    std::uniform_real_distribution<double> y(MARGIN, PAGE_HEIGHT - 40);
+
+    for (size_t i = 0; i < this->options.texImages; i++) {
+        auto* image = new TexImage();
+        image->setText("$e = mc^2$");
+        image->loadData(std::string(this->texPdf));
+        image->setX(x(random));
+        image->setY(y(random));
+        image->setWidth(60);
+        image->setHeight(24);
+        layer->addElement(image);
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * Xournal++
+ *
+ * Generates large documents for scale testing
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+class Document;
+class Layer;
+
+/**
+ * @brief Fills a document with random handwriting, images, texts and TeX images
+ *
+ * The content only depends on the options: the same options always give the same document, so a problem reported on
+ * a huge document can be reproduced from one line. Each page is drawn from its own seed, derived from the seed of the
+ * options and the page number.
+ *
+ * The options are given as a comma separated list of KEY=VALUE, e.g. "pages=500,strokes=2000,points=300", see
+ * parseOptions(). The missing keys keep their default value.
+ */
+class DocumentGenerator {
+public:
+    struct Options {
+        size_t pages = 10;
+        size_t layers = 1;
+
+        /// Per layer
+        size_t strokes = 200;
+        size_t points = 100;
+        bool pressure = true;
+
+        /// Per page, on the first layer
+        size_t images = 0;
+        size_t texts = 0;
+        size_t texImages = 0;
+
+        uint32_t seed = 1;
+    };
+
+    /**
+     * Keys: pages, layers, strokes, points, pressure (0 or 1), images, texts, tex, seed
+     *
+     * @throws std::invalid_argument on an unknown key or an invalid value
+     */
+    static Options parseOptions(const std::string& spec);
+
+    explicit DocumentGenerator(Options options);
+
+public:
+    /**
+     * @brief Appends the generated pages to the document
+     */
+    void generate(Document* doc);
+
+private:
+    void addStrokes(Layer* layer, std::mt19937& random) const;
+    void addImages(Layer* layer, std::mt19937& random) const;
+    void addTexts(Layer* layer, std::mt19937& random) const;
+    void addTexImages(Layer* layer, std::mt19937& random) const;
+
+private:
+    Options options;
+
+    /**
+     * The PDF of the TeX images, shared by all of them
+     */
+    std::string texPdf;
+};
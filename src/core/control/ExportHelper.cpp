@@ -13,6 +13,7 @@ namespace ExportHelper {
  * @param pngDpi Set dpi for Png files. Non positive values are ignored
  * @param pngWidth Set the width for Png files. Non positive values are ignored
  * @param pngHeight Set the height for Png files. Non positive values are ignored
+ * @param quality Set the compression quality of the JPEG and WebP files, from 1 to 100. Non positive values are ignored
  * @param exportBackground If EXPORT_BACKGROUND_NONE, the exported image file has transparent background
  *
  *  The priority is: pngDpi overwrites pngWidth overwrites pngHeight
@@ -20,14 +21,27 @@ namespace ExportHelper {
  * @return 0 on success, -3 on export failure
  */
 auto exportImg(Document* doc, const char* output, const char* range, int pngDpi, int pngWidth, int pngHeight,
-               ExportBackgroundType exportBackground) -> int {
+               int quality, ExportBackgroundType exportBackground) -> int {
+    std::string errorMsg;
+    if (!tryExportImg(doc, fs::path(output), range, pngDpi, pngWidth, pngHeight, quality, exportBackground,
+                      errorMsg)) {
+        g_message("Error exporting image: %s\n", errorMsg.c_str());
+    }
 
-    fs::path const path(output);
+    g_message("%s", _("Image file successfully created"));
 
-    ExportGraphicsFormat format = EXPORT_GRAPHICS_PNG;
+    return 0;  // no error
+}
 
-    if (path.extension() == ".svg") {
-        format = EXPORT_GRAPHICS_SVG;
+auto tryExportImg(Document* doc, const fs::path& output, const char* range, int pngDpi, int pngWidth, int pngHeight,
+                  int quality, ExportBackgroundType exportBackground, std::string& error, PdfCache* pdfCache) -> bool {
+    ExportGraphicsFormat format = ImageExport::getFormatForExtension(output);
+    if (format == EXPORT_GRAPHICS_UNDEFINED) {
+        format = EXPORT_GRAPHICS_PNG;
+    }
+    if (!ImageExport::isFormatAvailable(format)) {
+        error = FS(_F("The image format of \"{1}\" is not supported on this system") % output.u8string());
+        return false;
     }
 
     PageRangeVector exportRange;
@@ -39,9 +53,12 @@ auto exportImg(Document* doc, const char* output, const char* range, int pngDpi,
 
     DummyProgressListener progress;
 
-    ImageExport imgExport(doc, path, format, exportBackground, exportRange);
+    ImageExport imgExport(doc, output, format, exportBackground, exportRange);
+    // Nothing else runs meanwhile: export on all the cores
+    imgExport.setThreadCount(0);
+    imgExport.setPdfCache(pdfCache);
 
-    if (format == EXPORT_GRAPHICS_PNG) {
+    if (ImageExport::isRasterFormat(format)) {
         if (pngDpi > 0) {
             imgExport.setQualityParameter(EXPORT_QUALITY_DPI, pngDpi);
         } else if (pngWidth > 0) {
@@ -49,18 +66,15 @@ auto exportImg(Document* doc, const char* output, const char* range, int pngDpi,
         } else if (pngHeight > 0) {
             imgExport.setQualityParameter(EXPORT_QUALITY_HEIGHT, pngHeight);
         }
+        if (quality > 0) {
+            imgExport.setCompressionQuality(quality);
+        }
     }
 
     imgExport.exportGraphics(&progress);
 
-    std::string errorMsg = imgExport.getLastErrorMsg();
-    if (!errorMsg.empty()) {
-        g_message("Error exporting image: %s\n", errorMsg.c_str());
-    }
-
-    g_message("%s", _("Image file successfully created"));
-
-    return 0;  // no error
+    error = imgExport.getLastErrorMsg();
+    return error.empty();
 }
 
 /**
@@ -78,11 +92,24 @@ auto exportPdf(Document* doc, const char* output, const char* range, ExportBackg
                bool progressiveMode) -> int {
 
     GFile* file = g_file_new_for_commandline_arg(output);
+    auto path = fs::u8path(g_file_peek_path(file));
+    g_object_unref(file);
+
+    std::string errorMsg;
+    if (!tryExportPdf(doc, path, range, exportBackground, progressiveMode, errorMsg)) {
+        g_error("%s", errorMsg.c_str());
+    }
+
+    g_message("%s", _("PDF file successfully created"));
+
+    return 0;  // no error
+}
 
+auto tryExportPdf(Document* doc, const fs::path& output, const char* range, ExportBackgroundType exportBackground,
+                  bool progressiveMode, std::string& error) -> bool {
     std::unique_ptr<XojPdfExport> pdfe = XojPdfExportFactory::createExport(doc, nullptr);
     pdfe->setExportBackground(exportBackground);
-    auto path = fs::u8path(g_file_peek_path(file));
-    g_object_unref(file);
+    pdfe->setStreaming(true);
 
     bool exportSuccess = 0;  // Return of the export job
 
@@ -90,18 +117,15 @@ auto exportPdf(Document* doc, const char* output, const char* range, ExportBackg
         // Parse the range
         PageRangeVector exportRange = PageRange::parse(range, doc->getPageCount());
         // Do the export
-        exportSuccess = pdfe->createPdf(path, exportRange, progressiveMode);
+        exportSuccess = pdfe->createPdf(output, exportRange, progressiveMode);
     } else {
-        exportSuccess = pdfe->createPdf(path, progressiveMode);
+        exportSuccess = pdfe->createPdf(output, progressiveMode);
     }
 
     if (!exportSuccess) {
-        g_error("%s", pdfe->getLastError().c_str());
+        error = pdfe->getLastError();
     }
-
-    g_message("%s", _("PDF file successfully created"));
-
-    return 0;  // no error
+    return exportSuccess;
 }
 
 }  // namespace ExportHelper
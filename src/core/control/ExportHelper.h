@@ -30,14 +30,27 @@ namespace ExportHelper {
  * @param pngDpi Set dpi for Png files. Non positive values are ignored
  * @param pngWidth Set the width for Png files. Non positive values are ignored
  * @param pngHeight Set the height for Png files. Non positive values are ignored
+ * @param quality Set the compression quality of the JPEG and WebP files, from 1 to 100. Non positive values are ignored
  * @param exportBackground If EXPORT_BACKGROUND_NONE, the exported image file has transparent background
  *
- *  The priority is: pngDpi overwrites pngWidth overwrites pngHeight
+ *  The format is given by the extension of the output: .svg, .jpg, .jpeg, .webp, else PNG. The size parameters apply
+ *  to all the raster formats, the priority is: pngDpi overwrites pngWidth overwrites pngHeight
  *
  * @return 0 on success, -2 on failure opening the input file, -3 on export failure
  */
 int exportImg(Document* doc, const char* output, const char* range, int pngDpi, int pngWidth, int pngHeight,
-              ExportBackgroundType exportBackground);
+              int quality, ExportBackgroundType exportBackground);
+
+/**
+ * @brief Same as exportImg(), without printing anything
+ * @param error The error message, if the export failed
+ * @param pdfCache Paints the PDF background of the raster pages, see ImageExport::setPdfCache()
+ *
+ * @return true on success
+ */
+bool tryExportImg(Document* doc, const fs::path& output, const char* range, int pngDpi, int pngWidth, int pngHeight,
+                  int quality, ExportBackgroundType exportBackground, std::string& error,
+                  PdfCache* pdfCache = nullptr);
 
 /**
  * @brief Export the input file as pdf
@@ -53,5 +66,15 @@ int exportImg(Document* doc, const char* output, const char* range, int pngDpi,
 int exportPdf(Document* doc, const char* output, const char* range, ExportBackgroundType exportBackground,
               bool progressiveMode);
 
+/**
+ * @brief Same as exportPdf(), without printing anything nor aborting on failure
+ * @param output Path to the output file, not a command line argument
+ * @param error The error message, if the export failed
+ *
+ * @return true on success
+ */
+bool tryExportPdf(Document* doc, const fs::path& output, const char* range, ExportBackgroundType exportBackground,
+                  bool progressiveMode, std::string& error);
+
 
 }  // namespace ExportHelper
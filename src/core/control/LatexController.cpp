@@ -28,7 +28,8 @@ LatexController::LatexController(Control* control):
         dlg(control->getGladeSearchPath()),
         doc(control->getDocument()),
         texTmpDir(Util::getTmpDirSubfolder("tex")),
-        generator(settings) {
+        generator(settings),
+        cache(Util::getCacheSubfolder("tex")) {
     Util::ensureFolderExists(this->texTmpDir);
 }
 
@@ -131,8 +132,9 @@ auto LatexController::showTexEditDialog() -> string {
     bool isNewFormula = this->initialTex.empty();
     this->dlg.setFinalTex(isNewFormula ? "x^2" : this->initialTex);
 
-    if (this->temporaryRender != nullptr) {
-        this->dlg.setTempRender(this->temporaryRender->getPdf());
+    if (PopplerDocument* pdf = this->temporaryRender ? this->temporaryRender->openPdf() : nullptr) {
+        this->dlg.setTempRender(pdf);
+        g_object_unref(pdf);
     }
 
     this->dlg.show(GTK_WINDOW(control->getWindow()->getWindow()), isNewFormula);
@@ -152,6 +154,15 @@ void LatexController::triggerImageUpdate(const string& texString) {
     this->lastPreviewedTex = texString;
     const std::string texContents = LatexGenerator::templateSub(
             texString, this->latexTemplate, this->control->getToolHandler()->getTool(TOOL_TEXT).getColor());
+    this->lastPreviewedKey = LatexCache::getKey(this->settings, texContents);
+    if (auto pdf = this->cache.load(this->lastPreviewedKey)) {
+        // Compiled already: no need to run LaTeX
+        this->isValidTex = true;
+        showRendered(std::move(*pdf));
+        updateStatus();
+        return;
+    }
+
     auto result = generator.asyncRun(this->texTmpDir, texContents);
     if (auto* err = std::get_if<LatexGenerator::GenError>(&result)) {
         XojMsgBox::showErrorToUser(this->control->getGtkWindow(), err->message);
@@ -203,9 +214,12 @@ void LatexController::onPdfRenderComplete(GObject* procObj, GAsyncResult* res, L
     bool shouldUpdate = self->lastPreviewedTex != currentTex;
     if (err == nullptr) {
         self->isValidTex = true;
-        self->temporaryRender = self->loadRendered(currentTex);
-        if (self->temporaryRender != nullptr) {
-            self->dlg.setTempRender(self->temporaryRender->getPdf());
+        fs::path pdfPath = self->texTmpDir / "tex.pdf";
+        if (auto pdf = Util::readString(pdfPath, true)) {
+            self->cache.store(self->lastPreviewedKey, *pdf);
+            self->showRendered(std::move(*pdf));
+        } else {
+            self->temporaryRender = nullptr;
         }
     }
 
@@ -248,20 +262,22 @@ void LatexController::deleteOldImage() {
     }
 }
 
-auto LatexController::loadRendered(string renderedTex) -> std::unique_ptr<TexImage> {
-    if (!this->isValidTex) {
-        return nullptr;
+void LatexController::showRendered(string pdf) {
+    this->temporaryRender = loadRendered(this->lastPreviewedTex, std::move(pdf));
+    if (PopplerDocument* rendered = this->temporaryRender ? this->temporaryRender->openPdf() : nullptr) {
+        this->dlg.setTempRender(rendered);
+        g_object_unref(rendered);
     }
+}
 
-    fs::path pdfPath = texTmpDir / "tex.pdf";
-    auto contents = Util::readString(pdfPath, true);
-    if (!contents) {
+auto LatexController::loadRendered(string renderedTex, string pdf) -> std::unique_ptr<TexImage> {
+    if (!this->isValidTex) {
         return nullptr;
     }
 
     auto img = std::make_unique<TexImage>();
     GError* err{};
-    bool loaded = img->loadData(std::move(*contents), &err);
+    bool loaded = img->loadData(std::move(pdf), &err);
 
     if (err != nullptr) {
         string message = FS(_F("Could not load LaTeX PDF file: {1}") % err->message);
@@ -269,7 +285,7 @@ auto LatexController::loadRendered(string renderedTex) -> std::unique_ptr<TexIma
         XojMsgBox::showErrorToUser(control->getGtkWindow(), message);
         g_error_free(err);
         return nullptr;
-    } else if (!loaded || !img->getPdf()) {
+    } else if (!loaded || !img->hasPdf()) {
         XojMsgBox::showErrorToUser(control->getGtkWindow(), FS(_F("Could not load LaTeX PDF file")));
         return nullptr;
     }
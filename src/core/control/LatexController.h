@@ -20,6 +20,7 @@
 
 #include <poppler.h>
 
+#include "control/latex/LatexCache.h"
 #include "control/latex/LatexGenerator.h"
 #include "control/settings/LatexSettings.h"
 #include "gui/dialog/LatexDialog.h"
@@ -109,9 +110,14 @@ private:
     bool isUpdating();
 
     /**
-     * Load the preview PDF from disk and create a TexImage object.
+     * Create a TexImage object from the preview PDF.
      */
-    std::unique_ptr<TexImage> loadRendered(std::string renderedTex);
+    std::unique_ptr<TexImage> loadRendered(std::string renderedTex, std::string pdf);
+
+    /**
+     * Show the preview PDF in the dialog.
+     */
+    void showRendered(std::string pdf);
 
     /**
      * Insert the generated preview TexImage into the current page.
@@ -148,6 +154,11 @@ private:
      */
     std::string lastPreviewedTex;
 
+    /**
+     * The key in the cache of the PDF being generated, see LatexCache::getKey().
+     */
+    std::string lastPreviewedKey;
+
     /**
      * Whether a preview is currently being generated.
      */
@@ -216,4 +227,9 @@ private:
     std::unique_ptr<TexImage> temporaryRender;
 
     LatexGenerator generator;
+
+    /**
+     * The PDF files compiled previously, by this or another run of the dialog.
+     */
+    LatexCache cache;
 };
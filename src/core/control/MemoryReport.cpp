@@ -0,0 +1,168 @@
+#include "MemoryReport.h"
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+
+#include <glib.h>
+
+#include "control/Control.h"
+#include "control/PdfCache.h"
+#include "gui/MainWindow.h"
+#include "gui/PageView.h"
+#include "gui/XournalView.h"
+#include "gui/sidebar/Sidebar.h"
+#include "model/Document.h"
+#include "model/Element.h"
+#include "model/ImageStore.h"
+#include "model/Layer.h"
+#include "model/XojPage.h"
+#include "undo/UndoRedoHandler.h"
+#include "util/i18n.h"
+#include "view/TexImageCache.h"
+
+/**
+ * The page views are rendered to ARGB32 surfaces
+ */
+constexpr size_t BYTES_PER_PIXEL = 4;
+
+void MemoryReport::Counter::add(size_t elementBytes) {
+    this->count++;
+    this->bytes += elementBytes;
+}
+
+auto MemoryReport::Counter::operator+=(const Counter& other) -> Counter& {
+    this->count += other.count;
+    this->bytes += other.bytes;
+    return *this;
+}
+
+void MemoryReport::Page::add(const Element* e) {
+    size_t bytes = e->getMemoryUsage();
+    switch (e->getType()) {
+        case ELEMENT_STROKE:
+            this->strokes.add(bytes);
+            break;
+        case ELEMENT_IMAGE:
+            this->images.add(bytes);
+            break;
+        case ELEMENT_TEXIMAGE:
+            this->texImages.add(bytes);
+            break;
+        case ELEMENT_TEXT:
+            this->texts.add(bytes);
+            break;
+        default:
+            this->others.add(bytes);
+            break;
+    }
+}
+
+auto MemoryReport::Page::getBytes() const -> size_t {
+    return this->strokes.bytes + this->images.bytes + this->texImages.bytes + this->texts.bytes + this->others.bytes;
+}
+
+auto MemoryReport::Page::operator+=(const Page& other) -> Page& {
+    this->strokes += other.strokes;
+    this->images += other.images;
+    this->texImages += other.texImages;
+    this->texts += other.texts;
+    this->others += other.others;
+    return *this;
+}
+
+MemoryReport::MemoryReport(Document* doc) {
+    doc->lock();
+    this->pages.resize(doc->getPageCount());
+    for (size_t i = 0; i < this->pages.size(); i++) {
+        PageRef page = doc->getPage(i);
+        Page& entry = this->pages[i];
+        // Not loaded for the report
+        entry.pending = page->hasPendingLayers();
+        if (entry.pending) {
+            continue;
+        }
+        for (const Layer* layer: *page->getLayers()) {
+            entry.others.add(sizeof(Layer));
+            for (const Element* e: layer->getElements()) { entry.add(e); }
+        }
+        this->elements += entry;
+    }
+    doc->unlock();
+
+    this->imageStoreBytes = ImageStore::getBytes();
+    this->texImageCacheBytes = xoj::view::TexImageCache::getInstance().getBytes();
+}
+
+void MemoryReport::addControl(Control* control) {
+    this->undoBytes = control->getUndoRedoHandler()->getMemoryUsage();
+
+    MainWindow* win = control->getWindow();
+    if (win == nullptr) {
+        return;
+    }
+    XournalView* xournal = win->getXournal();
+    for (size_t i = 0; i < this->pages.size(); i++) {
+        if (XojPageView* view = xournal->getExistingViewFor(i)) {
+            this->pageBuffers.add(static_cast<size_t>(view->getBufferPixels()) * BYTES_PER_PIXEL);
+            this->snapshotBytes += static_cast<size_t>(view->getSnapshotPixels()) * BYTES_PER_PIXEL;
+        }
+    }
+    if (PdfCache* cache = xournal->getCache()) {
+        this->pdfCacheBytes = cache->getBytes();
+    }
+    if (Sidebar* sidebar = control->getSidebar()) {
+        this->previewBytes = sidebar->getThumbnailCache()->getBytes();
+    }
+}
+
+auto MemoryReport::getTotalBytes() const -> size_t {
+    return this->elements.getBytes() + this->imageStoreBytes + this->texImageCacheBytes + this->undoBytes +
+           this->pageBuffers.bytes + this->snapshotBytes + this->pdfCacheBytes + this->previewBytes;
+}
+
+static auto formatBytes(size_t bytes) -> std::string {
+    gchar* str = g_format_size_full(bytes, G_FORMAT_SIZE_IEC_UNITS);
+    std::string s = str;
+    g_free(str);
+    return s;
+}
+
+auto MemoryReport::toString(bool pageDetails) const -> std::string {
+    std::ostringstream out;
+    auto line = [&out](const std::string& name, const std::string& value, size_t bytes) {
+        out << std::left << std::setw(28) << name << std::right << std::setw(12) << value << std::setw(14)
+            << formatBytes(bytes) << "\n";
+    };
+    auto counter = [&line](const std::string& name, const Counter& c) { line(name, std::to_string(c.count), c.bytes); };
+
+    counter(_("Strokes"), this->elements.strokes);
+    counter(_("Images"), this->elements.images);
+    counter(_("LaTeX formulas"), this->elements.texImages);
+    counter(_("Texts"), this->elements.texts);
+    counter(_("Layers and others"), this->elements.others);
+    line(_("Image data (shared)"), "", this->imageStoreBytes);
+    line(_("Rendered LaTeX formulas"), "", this->texImageCacheBytes);
+    line(_("Undo and redo"), "", this->undoBytes);
+    counter(_("Page views"), this->pageBuffers);
+    line(_("Snapshots of the layers"), "", this->snapshotBytes);
+    line(_("PDF renderings"), "", this->pdfCacheBytes);
+    line(_("Previews"), "", this->previewBytes);
+    line(_("Total"), "", getTotalBytes());
+
+    if (pageDetails) {
+        out << "\n";
+        for (size_t i = 0; i < this->pages.size(); i++) {
+            const Page& page = this->pages[i];
+            std::string name = FS(_F("Page {1}") % static_cast<int64_t>(i + 1));
+            if (page.pending) {
+                line(name, _("not loaded"), 0);
+            } else {
+                line(name, std::to_string(page.strokes.count + page.images.count + page.texImages.count +
+                                          page.texts.count),
+                     page.getBytes());
+            }
+        }
+    }
+    return out.str();
+}
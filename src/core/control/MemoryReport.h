@@ -0,0 +1,108 @@
+/*
+ * Xournal++
+ *
+ * Where the memory of a document goes
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class Control;
+class Document;
+class Element;
+
+/**
+ * @brief The approximate memory of the elements of each page of a document, and of the caches of the views
+ *
+ * The sizes are the ones reported by the elements (see Element::getMemoryUsage()) and by the caches, gathered on
+ * demand: each element knows its size without decoding or unpacking its content, so a report of a large document
+ * only takes a pass over its elements. Shown by the "Document Statistics" dialog, printed by the --memory-report
+ * option and returned by app.getMemoryReport() to the plugins.
+ */
+class MemoryReport {
+public:
+    struct Counter {
+        size_t count = 0;
+        size_t bytes = 0;
+
+        void add(size_t elementBytes);
+        Counter& operator+=(const Counter& other);
+    };
+
+    struct Page {
+        /**
+         * The layers of the page are pending (see XojPage::hasPendingLayers()): its elements are not in memory
+         */
+        bool pending = false;
+
+        Counter strokes;
+        Counter images;
+        Counter texImages;
+        Counter texts;
+        Counter others;
+
+        void add(const Element* e);
+        size_t getBytes() const;
+        Page& operator+=(const Page& other);
+    };
+
+public:
+    /**
+     * Measures the elements of the pages. Locks the document.
+     */
+    explicit MemoryReport(Document* doc);
+
+    /**
+     * Adds the undo actions and the caches of the window: the rendered tiles of the page views, the PDF renderings and
+     * the previews. Must be called from the UI thread.
+     */
+    void addControl(Control* control);
+
+public:
+    std::vector<Page> pages;
+
+    /**
+     * The elements of all the pages
+     */
+    Page elements;
+
+    /**
+     * The image data of all the documents, each counted once, see ImageStore
+     */
+    size_t imageStoreBytes = 0;
+
+    /**
+     * The rendered LaTeX formulas of all the documents, see TexImageCache
+     */
+    size_t texImageCacheBytes = 0;
+
+    size_t undoBytes = 0;
+
+    /**
+     * The view buffers by page view, and the snapshots of the layers kept during the edits
+     */
+    Counter pageBuffers;
+    size_t snapshotBytes = 0;
+
+    size_t pdfCacheBytes = 0;
+    size_t previewBytes = 0;
+
+    /**
+     * @return The sum of the above, the elements counted once
+     */
+    size_t getTotalBytes() const;
+
+    /**
+     * @param pageDetails Include a line per page
+     * @return The report as a table for a monospace font
+     */
+    std::string toString(bool pageDetails) const;
+};
@@ -35,13 +35,18 @@ void PageBackgroundChangeController::changeAllPagesBackground(const PageType& pt
 
     auto groupUndoAction = std::make_unique<GroupUndoAction>();
 
-    for (size_t p = 0; p < doc->getPageCount(); p++) {
-        auto undoAction = commitPageTypeChange(p, pt);
+    // The listeners are notified once for all the pages: the page views only rerender the pages they show, and the
+    // sidebar previews are rendered again when they are next drawn
+    const size_t pageCount = doc->getPageCount();
+    for (size_t p = 0; p < pageCount; p++) {
+        auto undoAction = applyPageTypeChange(doc->getPage(p), pt);
         if (undoAction) {
             groupUndoAction->addAction(std::move(undoAction));
         }
     }
 
+    control->firePagesChanged(0, pageCount);
+    control->updateBackgroundSizeButton();
     control->getUndoRedoHandler()->addUndoAction(std::move(groupUndoAction));
 
     ignoreEvent = true;
@@ -86,9 +91,18 @@ auto PageBackgroundChangeController::commitPageTypeChange(const size_t pageNum,
         return {};
     }
 
-    Document* doc = control->getDocument();
-    const size_t pageNr = doc->indexOf(page);
-    g_assert(pageNr != npos);
+    auto undoAction = applyPageTypeChange(page, pageType);
+
+    control->firePageChanged(pageNum);
+    control->updateBackgroundSizeButton();
+    return undoAction;
+}
+
+auto PageBackgroundChangeController::applyPageTypeChange(const PageRef& page, const PageType& pageType)
+        -> std::unique_ptr<UndoAction> {
+    if (!page) {
+        return {};
+    }
 
     // Get values for Undo / Redo
     const double origW = page->getWidth();
@@ -100,8 +114,6 @@ auto PageBackgroundChangeController::commitPageTypeChange(const size_t pageNum,
     // Apply the new background
     applyPageBackground(page, pageType);
 
-    control->firePageChanged(pageNr);
-    control->updateBackgroundSizeButton();
     return std::make_unique<PageBackgroundChangedUndoAction>(page, origType, origPdfPage, origBackgroundImage, origW,
                                                              origH);
 }
@@ -85,6 +85,11 @@ private:
      */
     auto commitPageTypeChange(size_t pageNum, const PageType& pageType) -> std::unique_ptr<UndoAction>;
 
+    /**
+     * Change the page type, without notifying the listeners
+     */
+    auto applyPageTypeChange(const PageRef& page, const PageType& pageType) -> std::unique_ptr<UndoAction>;
+
 private:
     Control* control = nullptr;
     PageTypeMenu currentPageType;
@@ -0,0 +1,74 @@
+#include "PageResidency.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "model/Document.h"
+#include "model/XojPage.h"
+
+PageResidency::PageResidency(size_t budget): budget(budget) {}
+
+void PageResidency::setBudget(size_t budget) { this->budget = budget; }
+
+auto PageResidency::update(Document& doc, const std::function<bool(size_t)>& isInUse) -> size_t {
+    this->updates++;
+
+    doc.lock();
+
+    // Rebuilt with the pages of the document only, the removed pages are forgotten
+    std::unordered_map<const XojPage*, Entry> current;
+    current.reserve(doc.getPageCount());
+
+    std::vector<std::pair<uint64_t, PageRef>> candidates;
+    this->loadedMemory = 0;
+    for (size_t i = 0; i < doc.getPageCount(); i++) {
+        PageRef page = doc.getPage(i);
+        Entry entry;
+        if (auto it = this->entries.find(page.get()); it != this->entries.end()) {
+            entry = it->second;
+        }
+
+        bool loaded = !page->hasPendingLayers();
+        uint64_t revision = page->getRevision();
+        if (entry.lastUse == 0 || entry.loaded != loaded || entry.revision != revision) {
+            entry.bytes = page->getMemoryUsage();
+            entry.loaded = loaded;
+            entry.revision = revision;
+        }
+        if (entry.lastUse == 0 || isInUse(i)) {
+            entry.lastUse = this->updates;
+        } else if (loaded && page->getLayerReloader()) {
+            candidates.emplace_back(entry.lastUse, page);
+        }
+
+        this->loadedMemory += entry.bytes;
+        current[page.get()] = entry;
+    }
+
+    size_t unloaded = 0;
+    if (this->budget > 0 && this->loadedMemory > this->budget) {
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (auto& [lastUse, page]: candidates) {
+            if (this->loadedMemory <= this->budget) {
+                break;
+            }
+            Entry& entry = current[page.get()];
+            if (!page->unloadLayers(page->getLayerReloader())) {
+                continue;
+            }
+            this->loadedMemory -= entry.bytes;
+            entry.bytes = 0;
+            entry.loaded = false;
+            unloaded++;
+        }
+    }
+
+    doc.unlock();
+
+    this->entries = std::move(current);
+    return unloaded;
+}
+
+auto PageResidency::getLoadedMemory() const -> size_t { return this->loadedMemory; }
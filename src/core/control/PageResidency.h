@@ -0,0 +1,67 @@
+/*
+ * Xournal++
+ *
+ * Keeps the loaded pages of a document within a memory budget
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+class Document;
+class XojPage;
+
+/**
+ * @brief Unloads the layers of the least recently used pages, to be parsed again from the file on next access
+ *
+ * Only the pages unchanged since they were loaded lazily are unloaded (see XojPage::getLayerReloader()): the others
+ * could not be created again. The memory of each page is measured again only when its revision changes.
+ *
+ * Not thread safe: called from the UI thread, see XournalView::clearMemoryTimer().
+ */
+class PageResidency {
+public:
+    /**
+     * @param budget The memory of the elements of all the loaded pages, in bytes. 0 for no limit.
+     */
+    explicit PageResidency(size_t budget);
+
+    void setBudget(size_t budget);
+
+    /**
+     * Marks the pages in use as the most recently used, and unloads the least recently used others until the loaded
+     * pages are within the budget. Locks the document.
+     *
+     * @param isInUse Whether the page of the index is in use, e.g. has a view: its elements may be referred to
+     * @return The number of pages unloaded
+     */
+    size_t update(Document& doc, const std::function<bool(size_t)>& isInUse);
+
+    /**
+     * @return The memory of the loaded pages measured by the last update()
+     */
+    size_t getLoadedMemory() const;
+
+private:
+    struct Entry {
+        uint64_t lastUse = 0;
+        /// The revision the memory was measured at, and whether the layers were loaded then
+        uint64_t revision = 0;
+        bool loaded = false;
+        size_t bytes = 0;
+    };
+
+    size_t budget;
+    size_t loadedMemory = 0;
+    uint64_t updates = 0;
+
+    std::unordered_map<const XojPage*, Entry> entries;
+};
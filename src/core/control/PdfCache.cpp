@@ -3,10 +3,13 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <iterator>
 #include <utility>
 
 #include "control/settings/Settings.h"
 #include "pdf/base/XojPdfDocument.h"
+#include "util/Profiler.h"
+#include "util/Util.h"
 #include "util/i18n.h"
 
 class PdfCacheEntry {
@@ -22,10 +25,13 @@ public:
      * @param img is the result of rendering popplerPage
      * @param zoom is the zoom at which the page was rendered.
      */
-    PdfCacheEntry(XojPdfPageSPtr popplerPage, cairo_surface_t* img, double zoom) {
+    PdfCacheEntry(std::pair<size_t, int> key, XojPdfPageSPtr popplerPage, cairo_surface_t* img, double zoom) {
+        this->key = key;
         this->popplerPage = std::move(popplerPage);
         this->rendered = img;
         this->zoom = zoom;
+        this->bytes = static_cast<size_t>(cairo_image_surface_get_stride(img)) *
+                      static_cast<size_t>(cairo_image_surface_get_height(img));
     }
 
     ~PdfCacheEntry() {
@@ -34,103 +40,295 @@ public:
         this->rendered = nullptr;
     }
 
+    std::pair<size_t, int> key;
     double zoom;
     XojPdfPageSPtr popplerPage;
     cairo_surface_t* rendered;
+    size_t bytes;
 };
 
-PdfCache::PdfCache(const XojPdfDocument& doc, Settings* settings): pdfDocument(doc) { updateSettings(settings); }
+PdfCache::PdfCache(const XojPdfDocument& doc, Settings* settings, bool forExport):
+        pdfDocument(doc), forExport(forExport) {
+    updateSettings(settings);
+}
+
+/**
+ * The caches in use, see PdfCache::getShared()
+ */
+static std::mutex sharedCachesMutex;
+static std::vector<std::weak_ptr<PdfCache>> sharedCaches;
+
+auto PdfCache::getShared(const XojPdfDocument& doc, Settings* settings, bool forExport) -> std::shared_ptr<PdfCache> {
+    std::lock_guard<std::mutex> lock(sharedCachesMutex);
+    sharedCaches.erase(std::remove_if(sharedCaches.begin(), sharedCaches.end(),
+                                      [](const std::weak_ptr<PdfCache>& c) { return c.expired(); }),
+                       sharedCaches.end());
+
+    XojPdfDocument key(doc);
+    for (const std::weak_ptr<PdfCache>& weak: sharedCaches) {
+        if (auto cache = weak.lock(); cache && cache->forExport == forExport && cache->pdfDocument == key) {
+            cache->updateSettings(settings);
+            return cache;
+        }
+    }
+
+    auto cache = std::make_shared<PdfCache>(doc, settings, forExport);
+    sharedCaches.push_back(cache);
+    return cache;
+}
 
 PdfCache::~PdfCache() {
     clearCache();
     this->size = 0;
 }
 
-void PdfCache::setRefreshThreshold(double threshold) { this->zoomRefreshThreshold = threshold; }
+void PdfCache::setRefreshThreshold(double threshold) {
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    if (this->zoomRefreshThreshold != threshold) {
+        // The zoom buckets change with the threshold
+        this->zoomRefreshThreshold = threshold;
+        for (PdfCacheEntry* e: this->data) { delete e; }
+        this->data.clear();
+        this->index.clear();
+        this->bytes = 0;
+    }
+}
 
 void PdfCache::setMaxSize(size_t newSize) {
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
     this->size = newSize;
-    while (this->data.size() > this->size) {
-        delete this->data.back();
-        this->data.pop_back();
-    }
+    shrink();
+}
+
+void PdfCache::setMaxBytes(size_t newMaxBytes) {
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    this->maxBytes = newMaxBytes;
+    shrink();
+}
+
+auto PdfCache::getBytes() const -> size_t {
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    return this->bytes;
 }
 
 void PdfCache::updateSettings(Settings* settings) {
     if (settings) {
         setMaxSize(settings->getPdfPageCacheSize());
+        setMaxBytes(size_t{settings->getPdfCacheMemorySize()} * 1024U * 1024U);
         setRefreshThreshold(settings->getPDFPageRerenderThreshold());
     }
 }
 
 void PdfCache::clearCache() {
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
     for (PdfCacheEntry* e: this->data) { delete e; }
     this->data.clear();
+    this->index.clear();
+    this->bytes = 0;
 }
 
-auto PdfCache::lookup(size_t pdfPageNo) const -> PdfCacheEntry* {
-    for (PdfCacheEntry* e: this->data) {
-        if (static_cast<size_t>(e->popplerPage->getPageId()) == pdfPageNo) {
-            return e;
+void PdfCache::adopt(PdfCache& previous, const std::vector<size_t>& previousPages) {
+    if (&previous == this) {
+        return;
+    }
+
+    std::scoped_lock lock(this->cacheMutex, previous.cacheMutex);
+    if (previous.forExport != this->forExport || previous.zoomRefreshThreshold != this->zoomRefreshThreshold) {
+        // Not the same zoom buckets
+        return;
+    }
+
+    // The pages of this PDF showing each page of the previous one
+    std::unordered_map<size_t, std::vector<size_t>> pagesOf;
+    for (size_t page = 0; page < previousPages.size(); page++) {
+        if (previousPages[page] != npos) {
+            pagesOf[previousPages[page]].push_back(page);
         }
     }
 
-    return nullptr;
+    // In the order of use of the previous cache, after the entries of this one
+    for (PdfCacheEntry* e: previous.data) {
+        auto it = pagesOf.find(e->key.first);
+        if (it == pagesOf.end()) {
+            continue;
+        }
+        for (size_t page: it->second) {
+            const CacheKey key{page, e->key.second};
+            if (this->index.count(key) || this->pending.count(key)) {
+                continue;
+            }
+            // The Poppler page of the previous PDF is not kept: obtain() takes the one of this PDF for other zooms
+            auto* ne = new PdfCacheEntry(key, nullptr, cairo_surface_reference(e->rendered), e->zoom);
+            this->data.push_back(ne);
+            this->index[key] = std::prev(this->data.end());
+            this->bytes += ne->bytes;
+        }
+    }
+    shrink();
 }
 
-PdfCacheEntry* PdfCache::cache(XojPdfPageSPtr popplerPage, cairo_surface_t* img, double zoom) {
-    while (this->data.size() > this->size) {
-        delete this->data.back();
-        this->data.pop_back();
+auto PdfCache::CacheKeyHash::operator()(const CacheKey& key) const -> size_t {
+    return std::hash<size_t>()(key.first) ^ (std::hash<int>()(key.second) << 1U);
+}
+
+auto PdfCache::keyFor(size_t pdfPageNo, double zoom) const -> CacheKey {
+    if (this->forExport) {
+        // The exports render at a few fixed zooms, which are kept to the thousandth
+        return {pdfPageNo, static_cast<int>(std::lround(zoom * 1000))};
+    }
+    // Pages are never rasterized below zoom 1, see bucketZoom()
+    double ratio = 1.0 + std::max(this->zoomRefreshThreshold, 1.0) / 100.0;
+    int bucket = static_cast<int>(std::ceil(std::log(std::max(zoom, 1.0)) / std::log(ratio) - 1e-9));
+    return {pdfPageNo, std::max(bucket, 0)};
+}
+
+auto PdfCache::bucketZoom(int bucket) const -> double {
+    if (this->forExport) {
+        return bucket / 1000.0;
+    }
+    double ratio = 1.0 + std::max(this->zoomRefreshThreshold, 1.0) / 100.0;
+    return std::pow(ratio, bucket);
+}
+
+auto PdfCache::lookup(const CacheKey& key) -> PdfCacheEntry* {
+    auto it = this->index.find(key);
+    if (it == this->index.end()) {
+        return nullptr;
     }
 
-    auto* ne = new PdfCacheEntry(std::move(popplerPage), img, zoom);
+    // Move to the front of the LRU list
+    this->data.splice(this->data.begin(), this->data, it->second);
+    return *it->second;
+}
+
+auto PdfCache::cache(const CacheKey& key, XojPdfPageSPtr popplerPage, cairo_surface_t* img, double zoom)
+        -> PdfCacheEntry* {
+    auto* ne = new PdfCacheEntry(key, std::move(popplerPage), img, zoom);
     this->data.push_front(ne);
+    this->index[key] = this->data.begin();
+    this->bytes += ne->bytes;
+
+    shrink();
 
     return ne;
 }
 
-void PdfCache::render(cairo_t* cr, size_t pdfPageNo, double zoom, double pageWidth, double pageHeight) {
-    std::lock_guard<std::mutex> lock(this->renderMutex);
+void PdfCache::shrink() {
+    // Always keep the most recent entry, it is about to be painted
+    while (this->data.size() > 1 && (this->data.size() > this->size || this->bytes > this->maxBytes)) {
+        PdfCacheEntry* e = this->data.back();
+        this->index.erase(e->key);
+        this->bytes -= e->bytes;
+        this->data.pop_back();
+        delete e;
+    }
+}
 
-    PdfCacheEntry* cacheResult = lookup(pdfPageNo);
+auto PdfCache::obtain(size_t pdfPageNo, double zoom) -> cairo_surface_t* {
+    std::unique_lock<std::mutex> lock(this->cacheMutex);
+    const CacheKey key = keyFor(pdfPageNo, zoom);
 
-    bool needsRefresh = cacheResult == nullptr;
+    // Another thread may already be rasterizing this page at this zoom: wait for its result
+    this->renderedCond.wait(lock, [&]() { return this->pending.count(key) == 0; });
 
-    if (!needsRefresh) {
-        double averagedZoom = (zoom + cacheResult->zoom) / 2.0;
-        double percentZoomChange = std::abs(cacheResult->zoom - zoom) * 100.0 / averagedZoom;
+    if (PdfCacheEntry* entry = lookup(key)) {
+        xoj::util::Profiler::getInstance().countAccess("PDF cache", true);
+        return cairo_surface_reference(entry->rendered);
+    }
+    xoj::util::Profiler::getInstance().countAccess("PDF cache", false);
 
-        // If we do have a cached result, is its rendering quality
-        // acceptable for our current zoom?
-        needsRefresh = (zoom > 1.0 && percentZoomChange > this->zoomRefreshThreshold);
+    XojPdfPageSPtr popplerPage;
+    for (auto& [k, it]: this->index) {
+        if (k.first == key.first) {
+            popplerPage = (*it)->popplerPage;
+            break;
+        }
+    }
+    if (!popplerPage) {
+        popplerPage = pdfDocument.getPage(key.first);
+    }
+    if (!popplerPage) {
+        return nullptr;
     }
 
-    if (needsRefresh) {
-        double renderZoom = std::max(zoom, 1.0);
+    double renderZoom = bucketZoom(key.second);
+    this->pending.insert(key);
+    lock.unlock();
 
-        auto popplerPage = cacheResult ? cacheResult->popplerPage : pdfDocument.getPage(pdfPageNo);
+    auto* img = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                           static_cast<int>(std::ceil(popplerPage->getWidth() * renderZoom)),
+                                           static_cast<int>(std::ceil(popplerPage->getHeight() * renderZoom)));
+    cairo_surface_set_device_scale(img, renderZoom, renderZoom);
 
-        if (!popplerPage) {
-            g_warning("PdfCache::render Could not get the pdf page %zu from the document", pdfPageNo);
-            renderMissingPdfPage(cr, pageWidth, pageHeight);
-            return;
+    {
+        xoj::util::Profiler::Scope scope("PDF page rasterization");
+        cairo_t* cr2 = cairo_create(img);
+        if (this->forExport) {
+            popplerPage->renderForPrinting(cr2);
+        } else {
+            popplerPage->render(cr2);
         }
+        cairo_destroy(cr2);
+    }
 
-        auto* img = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
-                                               static_cast<int>(std::ceil(popplerPage->getWidth() * renderZoom)),
-                                               static_cast<int>(std::ceil(popplerPage->getHeight() * renderZoom)));
-        cairo_surface_set_device_scale(img, renderZoom, renderZoom);
+    lock.lock();
+    this->pending.erase(key);
+    PdfCacheEntry* entry = cache(key, std::move(popplerPage), img, renderZoom);
+    cairo_surface_t* result = cairo_surface_reference(entry->rendered);
+    lock.unlock();
 
-        cairo_t* cr2 = cairo_create(img);
-        popplerPage->render(cr2);
-        cairo_destroy(cr2);
+    this->renderedCond.notify_all();
+    return result;
+}
+
+auto PdfCache::obtainClosest(size_t pdfPageNo, double zoom) -> cairo_surface_t* {
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    const CacheKey key = keyFor(pdfPageNo, zoom);
+    PdfCacheEntry* closest = nullptr;
+    for (PdfCacheEntry* e: this->data) {
+        if (e->key.first == pdfPageNo &&
+            (!closest || std::abs(e->key.second - key.second) < std::abs(closest->key.second - key.second))) {
+            closest = e;
+        }
+    }
+    if (!closest) {
+        return nullptr;
+    }
+    closest = lookup(closest->key);
+    xoj::util::Profiler::getInstance().countAccess("PDF cache", true);
+    return cairo_surface_reference(closest->rendered);
+}
 
-        cacheResult = cache(popplerPage, img, renderZoom);
+void PdfCache::render(cairo_t* cr, size_t pdfPageNo, double zoom, double pageWidth, double pageHeight, bool draft) {
+    cairo_surface_t* rendered = draft ? obtainClosest(pdfPageNo, zoom) : nullptr;
+    if (!rendered) {
+        rendered = obtain(pdfPageNo, zoom);
     }
 
-    cairo_set_source_surface(cr, cacheResult->rendered, 0, 0);
+    if (!rendered) {
+        g_warning("PdfCache::render Could not get the pdf page %zu from the document", pdfPageNo);
+        renderMissingPdfPage(cr, pageWidth, pageHeight);
+        return;
+    }
+
+    cairo_set_source_surface(cr, rendered, 0, 0);
+    if (draft) {
+        cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_FAST);
+    }
     cairo_paint(cr);
+    cairo_surface_destroy(rendered);
+}
+
+void PdfCache::prefetch(size_t pdfPageNo, double zoom) {
+    cairo_surface_t* rendered = obtain(pdfPageNo, zoom);
+    if (rendered) {
+        cairo_surface_destroy(rendered);
+    }
+}
+
+auto PdfCache::contains(size_t pdfPageNo, double zoom) -> bool {
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    return this->index.count(keyFor(pdfPageNo, zoom)) > 0;
 }
 
 void PdfCache::renderMissingPdfPage(cairo_t* cr, double pageWidth, double pageHeight) {
@@ -11,9 +11,14 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <cairo.h>
@@ -26,11 +31,32 @@
 class PdfCacheEntry;
 class Settings;
 
+/**
+ * @brief Cache of rasterized PDF pages
+ *
+ * Pages are rasterized at discrete zoom levels ("buckets"), so that small zoom changes reuse the same rendering.
+ * Entries are keyed by (PDF page, zoom bucket) and evicted in least recently used order once the cache exceeds its
+ * memory budget.
+ *
+ * The cache is thread safe. Rasterization happens without holding the lock of the cache, so cached pages can be
+ * painted while another page is being rasterized.
+ *
+ * The views of the documents sharing a Poppler document (see XojPdfDocumentPool) share their cache, see getShared().
+ */
 class PdfCache {
 public:
-    PdfCache(const XojPdfDocument& doc, Settings* settings);
+    /**
+     * @param forExport Rasterize the pages for printing, at the exact zoom of the export instead of a bucket
+     */
+    PdfCache(const XojPdfDocument& doc, Settings* settings, bool forExport = false);
     virtual ~PdfCache();
 
+    /**
+     * @return The cache of the Poppler document of doc, shared with the other users of the same document as long as one
+     *         holds it. Created if there is none yet. The settings are applied to it, unless nullptr.
+     */
+    static std::shared_ptr<PdfCache> getShared(const XojPdfDocument& doc, Settings* settings, bool forExport = false);
+
 private:
     PdfCache(const PdfCache& cache);
     void operator=(const PdfCache& cache);
@@ -42,13 +68,36 @@ public:
      * @param pdfPageNo The page number (in the pdf document)
      * @param zoom The current zoom level
      * @param pageWidth/pageHeight Xournal++ page dimensions
+     * @param draft Paint the closest rasterization already cached, with the fast filter, rather than rasterizing the
+     *              page at this zoom, for a rendering done again once the view settles
+     */
+    void render(cairo_t* cr, size_t pdfPageNo, double zoom, double pageWidth, double pageHeight, bool draft = false);
+
+    /**
+     * @brief Rasterize the page into the cache, if it is not there yet, so that a later render() is fast
+     * @param pdfPageNo The page number (in the pdf document)
+     * @param zoom The zoom level the page will be rendered at
+     */
+    void prefetch(size_t pdfPageNo, double zoom);
+
+    /**
+     * @return true if the page is cached for this zoom level
      */
-    void render(cairo_t* cr, size_t pdfPageNo, double zoom, double pageWidth, double pageHeight);
+    bool contains(size_t pdfPageNo, double zoom);
+
     /**
      * @brief Empty the cache
      */
     void clearCache();
 
+    /**
+     * @brief Take over the renderings of the pages of a previous version of the PDF which did not change
+     * @param previous The cache of the previous version of the PDF
+     * @param previousPages For each page of this PDF, the page of the previous one which looks the same, or npos.
+     *                      See PdfPageSignature::match().
+     */
+    void adopt(PdfCache& previous, const std::vector<size_t>& previousPages);
+
 public:
 
     /**
@@ -60,8 +109,21 @@ public:
      */
     void setRefreshThreshold(double percentDifference);
 
+    /**
+     * @brief Set the maximum number of cached renderings
+     */
     void setMaxSize(size_t newSize);
 
+    /**
+     * @brief Set the memory budget of the cache, in bytes
+     */
+    void setMaxBytes(size_t newMaxBytes);
+
+    /**
+     * @return The memory of the cached renderings, in bytes
+     */
+    size_t getBytes() const;
+
     void updateSettings(Settings* settings);
 
     /**
@@ -70,22 +132,76 @@ public:
     static void renderMissingPdfPage(cairo_t* cr, double pageWidth, double pageHeight);
 
 private:
+    using CacheKey = std::pair<size_t, int>;
+
+    struct CacheKeyHash {
+        size_t operator()(const CacheKey& key) const;
+    };
+
+    /**
+     * @return The key of the rendering of the page used for this zoom. Must be called with the lock held.
+     */
+    CacheKey keyFor(size_t pdfPageNo, double zoom) const;
+
+    /**
+     * @return The zoom at which the pages of the bucket are rasterized
+     */
+    double bucketZoom(int bucket) const;
+
+    /**
+     * @brief Get the rendering of the page for this zoom, rasterizing it if needed.
+     * @return A new reference to the rendered surface (to be destroyed by the caller), or nullptr if the page
+     *         could not be rendered
+     */
+    cairo_surface_t* obtain(size_t pdfPageNo, double zoom);
+
+    /**
+     * @return A new reference to the cached rendering of the page with the zoom closest to this one, or nullptr if the
+     *         page is not cached at any zoom
+     */
+    cairo_surface_t* obtainClosest(size_t pdfPageNo, double zoom);
+
     /**
-     * @brief Look up for a cache entry for the page with number pdfPgeNo in the PDF.
+     * @brief Look up for a cache entry, and mark it as the most recently used. Must be called with the lock held.
      */
-    PdfCacheEntry* lookup(size_t pdfPageNo) const;
+    PdfCacheEntry* lookup(const CacheKey& key);
+
+    /**
+     * @brief Push a cache entry, and evict the least recently used ones. Must be called with the lock held.
+     */
+    PdfCacheEntry* cache(const CacheKey& key, XojPdfPageSPtr popplerPage, cairo_surface_t* img, double zoom);
+
     /**
-     * @brief Push a cache entry
+     * @brief Evict entries until the cache fits in its limits. Must be called with the lock held.
      */
-    PdfCacheEntry* cache(XojPdfPageSPtr popplerPage, cairo_surface_t* img, double zoom);
+    void shrink();
 
 private:
     XojPdfDocument pdfDocument;
 
-    std::mutex renderMutex;
+    mutable std::mutex cacheMutex;
+
+    /**
+     * Signaled whenever a rasterization finishes
+     */
+    std::condition_variable renderedCond;
+
+    /**
+     * Renderings currently being rasterized
+     */
+    std::set<CacheKey> pending;
 
+    /**
+     * The entries, the most recently used first
+     */
     std::list<PdfCacheEntry*> data;
+    std::unordered_map<CacheKey, std::list<PdfCacheEntry*>::iterator, CacheKeyHash> index;
+
     std::list<PdfCacheEntry*>::size_type size = 0;
+    size_t maxBytes = 0;
+    size_t bytes = 0;
+
+    double zoomRefreshThreshold = 0;
 
-    double zoomRefreshThreshold;
+    bool forExport;
 };
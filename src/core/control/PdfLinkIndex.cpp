@@ -0,0 +1,63 @@
+#include "PdfLinkIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+static auto area(const XojPdfRectangle& r) -> double { return (r.x2 - r.x1) * (r.y2 - r.y1); }
+
+PdfLinkIndex::PdfLinkIndex(std::vector<XojPdfPage::Link> links, double width, double height):
+        links(std::move(links)) {
+    for (XojPdfPage::Link& link: this->links) {
+        // Normalized, so that the lookups only compare x1 < x2 and y1 < y2
+        const XojPdfRectangle& r = link.rect;
+        link.rect = {std::min(r.x1, r.x2), std::min(r.y1, r.y2), std::max(r.x1, r.x2), std::max(r.y1, r.y2)};
+    }
+
+    // The links first, the smallest first: the cells keep this order
+    std::stable_sort(this->links.begin(), this->links.end(), [](const auto& a, const auto& b) {
+        if (a.annotation != b.annotation) {
+            return !a.annotation;
+        }
+        return area(a.rect) < area(b.rect);
+    });
+
+    if (width > 0 && height > 0) {
+        this->columns = std::clamp<size_t>(static_cast<size_t>(std::ceil(width / CELL_SIZE)), 1, MAX_CELLS);
+        this->rows = std::clamp<size_t>(static_cast<size_t>(std::ceil(height / CELL_SIZE)), 1, MAX_CELLS);
+        this->cellWidth = width / static_cast<double>(this->columns);
+        this->cellHeight = height / static_cast<double>(this->rows);
+    }
+
+    this->cells.resize(this->columns * this->rows);
+    for (size_t i = 0; i < this->links.size(); i++) {
+        const XojPdfRectangle& r = this->links[i].rect;
+        for (size_t y = row(r.y1); y <= row(r.y2); y++) {
+            for (size_t x = column(r.x1); x <= column(r.x2); x++) {
+                this->cells[y * this->columns + x].push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+}
+
+auto PdfLinkIndex::column(double x) const -> size_t {
+    double c = std::floor(x / this->cellWidth);
+    return c <= 0 ? 0 : std::min(static_cast<size_t>(c), this->columns - 1);
+}
+
+auto PdfLinkIndex::row(double y) const -> size_t {
+    double r = std::floor(y / this->cellHeight);
+    return r <= 0 ? 0 : std::min(static_cast<size_t>(r), this->rows - 1);
+}
+
+auto PdfLinkIndex::linkAt(double x, double y) const -> const XojPdfPage::Link* {
+    for (uint32_t i: this->cells[row(y) * this->columns + column(x)]) {
+        const XojPdfRectangle& r = this->links[i].rect;
+        if (x >= r.x1 && x <= r.x2 && y >= r.y1 && y <= r.y2) {
+            return &this->links[i];
+        }
+    }
+    return nullptr;
+}
+
+auto PdfLinkIndex::getLinkCount() const -> size_t { return this->links.size(); }
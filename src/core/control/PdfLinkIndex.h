@@ -0,0 +1,67 @@
+/*
+ * Xournal++
+ *
+ * The links and the annotations of a PDF page, indexed for the hit tests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pdf/base/XojPdfPage.h"
+
+/**
+ * @brief The links and the annotations of a PDF page in a grid of cells, each listing the links over it
+ *
+ * Hovering tests the position of each motion event: the link dense pages (indexes, references...) have hundreds of
+ * links, and Poppler would look them all up again. The links are extracted once, in the background (see PdfTextCache),
+ * and a hit test only looks at the few links of one cell.
+ *
+ * The index is immutable and can be queried by several threads at once. The coordinates are the ones of the page,
+ * with the origin in the top left corner.
+ */
+class PdfLinkIndex {
+public:
+    /**
+     * @param links As XojPdfPage::getLinks()
+     * @param width, height The size of the page
+     */
+    PdfLinkIndex(std::vector<XojPdfPage::Link> links, double width, double height);
+
+public:
+    /**
+     * @return The link at the point, the smallest one if they overlap, a link before an annotation. nullptr if none.
+     */
+    const XojPdfPage::Link* linkAt(double x, double y) const;
+
+    size_t getLinkCount() const;
+
+    /// The size of a cell, in points, unless the page has more than MAX_CELLS cells on a side
+    static constexpr double CELL_SIZE = 32;
+    static constexpr size_t MAX_CELLS = 64;
+
+private:
+    /**
+     * @return The cell of the coordinate, clamped to the grid
+     */
+    size_t column(double x) const;
+    size_t row(double y) const;
+
+private:
+    std::vector<XojPdfPage::Link> links;
+
+    size_t columns = 1;
+    size_t rows = 1;
+    double cellWidth = CELL_SIZE;
+    double cellHeight = CELL_SIZE;
+
+    /// The links over each cell, row by row, in the order of linkAt()
+    std::vector<std::vector<uint32_t>> cells;
+};
@@ -0,0 +1,109 @@
+#include "PdfPageSignature.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+
+#include <cairo.h>
+
+#include "util/Util.h"
+
+/**
+ * FNV-1a, chained over the parts of the page
+ */
+static void hashBytes(uint64_t& hash, const void* data, size_t length) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+template <typename T>
+static void hashValue(uint64_t& hash, const T& value) {
+    hashBytes(hash, &value, sizeof(value));
+}
+
+static void hashString(uint64_t& hash, const std::string& s) {
+    hashValue(hash, s.size());
+    hashBytes(hash, s.data(), s.size());
+}
+
+auto PdfPageSignature::operator==(const PdfPageSignature& other) const -> bool {
+    return this->width == other.width && this->height == other.height && this->hash == other.hash;
+}
+
+auto PdfPageSignature::operator!=(const PdfPageSignature& other) const -> bool { return !(*this == other); }
+
+auto PdfPageSignature::of(const XojPdfPage& page) -> PdfPageSignature {
+    PdfPageSignature signature;
+    signature.width = page.getWidth();
+    signature.height = page.getHeight();
+    uint64_t hash = 14695981039346656037ULL;
+
+    hashString(hash, page.getText());
+    for (const XojPdfPage::Link& link: page.getLinks()) {
+        hashValue(hash, link.rect.x1);
+        hashValue(hash, link.rect.y1);
+        hashValue(hash, link.rect.x2);
+        hashValue(hash, link.rect.y2);
+        hashValue(hash, link.destPage);
+        hashValue(hash, link.destTop);
+        hashValue(hash, link.annotation);
+        hashString(hash, link.text);
+    }
+
+    double longer = std::max(signature.width, signature.height);
+    if (longer > 0) {
+        double scale = RASTER_SIZE / longer;
+        int w = std::max(1, static_cast<int>(std::ceil(signature.width * scale)));
+        int h = std::max(1, static_cast<int>(std::ceil(signature.height * scale)));
+        cairo_surface_t* img = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+        cairo_t* cr = cairo_create(img);
+        cairo_scale(cr, scale, scale);
+        page.render(cr);
+        cairo_destroy(cr);
+        cairo_surface_flush(img);
+
+        const unsigned char* data = cairo_image_surface_get_data(img);
+        const int stride = cairo_image_surface_get_stride(img);
+        for (int y = 0; y < h; y++) {
+            // Not the padding at the end of the rows
+            hashBytes(hash, data + static_cast<ptrdiff_t>(y) * stride, static_cast<size_t>(w) * 4U);
+        }
+        cairo_surface_destroy(img);
+    }
+
+    signature.hash = hash;
+    return signature;
+}
+
+auto PdfPageSignature::match(const std::vector<PdfPageSignature>& before, const std::vector<PdfPageSignature>& after)
+        -> std::vector<size_t> {
+    // The pages of before by hash, in order
+    std::unordered_map<uint64_t, std::vector<size_t>> byHash;
+    for (size_t i = 0; i < before.size(); i++) { byHash[before[i].hash].push_back(i); }
+
+    std::vector<size_t> result(after.size(), npos);
+    for (size_t i = 0; i < after.size(); i++) {
+        if (i < before.size() && before[i] == after[i]) {
+            result[i] = i;
+            continue;
+        }
+        auto it = byHash.find(after[i].hash);
+        if (it == byHash.end()) {
+            continue;
+        }
+        // The pages inserted or removed before shift the next ones: the closest page is most likely the same
+        auto distance = [i](size_t j) { return j > i ? j - i : i - j; };
+        size_t best = npos;
+        for (size_t j: it->second) {
+            if (before[j] == after[i] && (best == npos || distance(j) < distance(best))) {
+                best = j;
+            }
+        }
+        result[i] = best;
+    }
+    return result;
+}
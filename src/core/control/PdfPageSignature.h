@@ -0,0 +1,69 @@
+/*
+ * Xournal++
+ *
+ * What a PDF page looks like, to tell the pages unchanged by a new version of the PDF
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pdf/base/XojPdfDocument.h"
+#include "pdf/base/XojPdfPage.h"
+
+/**
+ * @brief The size of a PDF page and a hash of its text, of its links and of a small rasterization of it
+ *
+ * The PDF backgrounds regenerated by a build (LaTeX, slides...) mostly keep their pages as they are: the pages with the
+ * same signature are taken as the same, and keep their rasterizations when the PDF is reloaded, see PdfReloader.
+ */
+struct PdfPageSignature {
+    double width = 0;
+    double height = 0;
+    uint64_t hash = 0;
+
+    bool operator==(const PdfPageSignature& other) const;
+    bool operator!=(const PdfPageSignature& other) const;
+
+    /**
+     * The longer side of the rasterization hashed, in pixels: small changes of the drawings, which change no text,
+     * still change a few pixels
+     */
+    static constexpr int RASTER_SIZE = 96;
+
+    /**
+     * Rasterizes the page. Can be called by several threads at once.
+     */
+    static PdfPageSignature of(const XojPdfPage& page);
+
+    /**
+     * @return The signatures of all the pages of the document, in order. Empty if `cancel` returned true meanwhile.
+     */
+    template <typename Cancel>
+    static std::vector<PdfPageSignature> ofAll(const XojPdfDocument& pdf, Cancel cancel) {
+        std::vector<PdfPageSignature> signatures;
+        signatures.reserve(pdf.getPageCount());
+        for (size_t i = 0; i < pdf.getPageCount(); i++) {
+            if (cancel()) {
+                return {};
+            }
+            XojPdfPageSPtr page = pdf.getPage(i);
+            signatures.push_back(page ? of(*page) : PdfPageSignature{});
+        }
+        return signatures;
+    }
+
+    /**
+     * @return For each page of `after`, a page of `before` with the same signature, the closest one to the same
+     *         number, or npos if there is none
+     */
+    static std::vector<size_t> match(const std::vector<PdfPageSignature>& before,
+                                     const std::vector<PdfPageSignature>& after);
+};
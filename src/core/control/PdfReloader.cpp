@@ -0,0 +1,186 @@
+#include "PdfReloader.h"
+
+#include <utility>
+
+#include "control/jobs/XournalScheduler.h"
+#include "model/Document.h"
+#include "model/XojPage.h"
+#include "util/PathUtil.h"
+
+#include "Control.h"
+#include "PdfCache.h"
+
+PdfReloader::PdfReloader(Control* control): control(control) { registerListener(control); }
+
+PdfReloader::~PdfReloader() { unwatch(); }
+
+void PdfReloader::documentChanged(DocumentChangeType type) {
+    if (type == DOCUMENT_CHANGE_CLEARED || type == DOCUMENT_CHANGE_COMPLETE) {
+        // The jobs were dropped with the views of the previous document
+        this->generation++;
+        this->reloading = false;
+        this->changedAgain = false;
+    } else if (type != DOCUMENT_CHANGE_PDF_BOOKMARKS) {
+        return;
+    }
+
+    Document* doc = this->control->getDocument();
+    doc->lock();
+    fs::path path = doc->getPdfPageCount() != 0 ? doc->getPdfFilepath() : fs::path{};
+    doc->unlock();
+
+    if (path != this->file) {
+        unwatch();
+        if (!path.empty()) {
+            watch(path);
+        }
+    }
+}
+
+void PdfReloader::watch(const fs::path& file) {
+    GFile* gfile = Util::toGFile(file);
+    GError* error = nullptr;
+    this->monitor = g_file_monitor_file(gfile, G_FILE_MONITOR_WATCH_MOVES, nullptr, &error);
+    g_object_unref(gfile);
+    if (!this->monitor) {
+        g_warning("PdfReloader: cannot watch %s: %s", file.u8string().c_str(), error ? error->message : "");
+        if (error) {
+            g_error_free(error);
+        }
+        return;
+    }
+
+    this->file = file;
+    g_signal_connect(this->monitor, "changed", G_CALLBACK(&fileChangedCallback), this);
+}
+
+void PdfReloader::unwatch() {
+    if (this->settleTimeout) {
+        g_source_remove(this->settleTimeout);
+        this->settleTimeout = 0;
+    }
+    if (this->monitor) {
+        g_file_monitor_cancel(this->monitor);
+        g_object_unref(this->monitor);
+        this->monitor = nullptr;
+    }
+    this->file = fs::path{};
+    this->signedPdf = XojPdfDocument();
+    this->signatures.clear();
+}
+
+void PdfReloader::fileChangedCallback(GFileMonitor*, GFile*, GFile*, GFileMonitorEvent event, PdfReloader* self) {
+    switch (event) {
+        case G_FILE_MONITOR_EVENT_CHANGED:
+        case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+        case G_FILE_MONITOR_EVENT_CREATED:
+        case G_FILE_MONITOR_EVENT_MOVED_IN:
+        case G_FILE_MONITOR_EVENT_RENAMED:
+            break;
+        default:
+            return;
+    }
+
+    // Read once the file stopped changing
+    if (self->settleTimeout) {
+        g_source_remove(self->settleTimeout);
+    }
+    self->settleTimeout = g_timeout_add(SETTLE_DELAY, reinterpret_cast<GSourceFunc>(settledCallback), self);
+}
+
+auto PdfReloader::settledCallback(PdfReloader* self) -> bool {
+    self->settleTimeout = 0;
+    self->reload();
+    return false;
+}
+
+void PdfReloader::reload() {
+    if (this->reloading) {
+        this->changedAgain = true;
+        return;
+    }
+
+    Document* doc = this->control->getDocument();
+    doc->lock();
+    XojPdfDocument pdf = doc->getPdfDocument();
+    doc->unlock();
+
+    std::vector<PdfPageSignature> known;
+    if (pdf == this->signedPdf) {
+        known = this->signatures;
+    }
+    this->reloading = true;
+    this->control->getScheduler()->addReloadPdf(this->control, this->generation, this->file, std::move(pdf),
+                                                std::move(known));
+}
+
+void PdfReloader::reloaded(unsigned int generation, const XojPdfDocument& previous,
+                           std::vector<PdfPageSignature> previousSignatures, XojPdfDocument pdf,
+                           std::vector<PdfPageSignature> signatures) {
+    if (generation != this->generation) {
+        return;
+    }
+    this->reloading = false;
+
+    if (pdf.isLoaded() && signatures.size() == pdf.getPageCount() &&
+        previousSignatures.size() == previous.getPageCount()) {
+        apply(previous, previousSignatures, std::move(pdf), std::move(signatures));
+    }
+
+    if (this->changedAgain) {
+        this->changedAgain = false;
+        reload();
+    }
+}
+
+void PdfReloader::apply(const XojPdfDocument& previous, const std::vector<PdfPageSignature>& previousSignatures,
+                        XojPdfDocument pdf, std::vector<PdfPageSignature> signatures) {
+    Document* doc = this->control->getDocument();
+    XojPdfDocument expected(previous);
+    doc->lock();
+    XojPdfDocument current = doc->getPdfDocument();
+    doc->unlock();
+    if (!(current == expected)) {
+        return;
+    }
+
+    const std::vector<size_t> previousPages = PdfPageSignature::match(previousSignatures, signatures);
+
+    // Held until the views take it, see DOCUMENT_CHANGE_PDF_RELOADED
+    std::shared_ptr<PdfCache> cache = PdfCache::getShared(pdf, this->control->getSettings());
+    cache->adopt(*PdfCache::getShared(previous, nullptr), previousPages);
+
+    std::vector<size_t> resized;
+    std::vector<size_t> changed;
+    doc->lock();
+    doc->reloadPdf(pdf);
+    for (size_t i = 0; i < doc->getPageCount(); i++) {
+        PageRef page = doc->getPage(i);
+        if (!page->getBackgroundType().isPdfPage()) {
+            continue;
+        }
+        size_t p = page->getPdfPageNr();
+        if (p < previousPages.size() && previousPages[p] == p) {
+            continue;
+        }
+        changed.push_back(i);
+
+        // The pages which had the size of their background keep it
+        if (p < previousSignatures.size() && p < signatures.size() &&
+            page->getWidth() == previousSignatures[p].width && page->getHeight() == previousSignatures[p].height &&
+            (signatures[p].width != page->getWidth() || signatures[p].height != page->getHeight()) &&
+            signatures[p].width > 0 && signatures[p].height > 0) {
+            doc->setPageSize(page, signatures[p].width, signatures[p].height);
+            resized.push_back(i);
+        }
+    }
+    doc->unlock();
+
+    this->signedPdf = std::move(pdf);
+    this->signatures = std::move(signatures);
+
+    this->control->fireDocumentChanged(DOCUMENT_CHANGE_PDF_RELOADED);
+    this->control->fireDocumentChanged(DOCUMENT_CHANGE_PDF_BOOKMARKS);
+    for (size_t page: resized) { this->control->firePageSizeChanged(page); }
+    for (size_t page: changed) { this->control->firePageChanged(page); }
+}
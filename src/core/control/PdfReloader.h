@@ -0,0 +1,98 @@
+/*
+ * Xournal++
+ *
+ * Reloads the PDF background once its file changes
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <gio/gio.h>
+#include <glib.h>
+
+#include "model/DocumentListener.h"
+#include "pdf/base/XojPdfDocument.h"
+
+#include "PdfPageSignature.h"
+#include "filesystem.h"
+
+class Control;
+
+/**
+ * @brief Watches the PDF background of the document, and reads it again once its file changed, e.g. rebuilt by LaTeX
+ *
+ * The new version is read and compared with the previous one in the background (see PdfReloadJob): the pages with the
+ * same signature (see PdfPageSignature) keep their rasterizations in the PDF cache, their views and their previews.
+ * Only the pages whose background changed are rendered again.
+ */
+class PdfReloader: public DocumentListener {
+public:
+    explicit PdfReloader(Control* control);
+    ~PdfReloader() override;
+
+    PdfReloader(const PdfReloader&) = delete;
+    PdfReloader& operator=(const PdfReloader&) = delete;
+
+public:
+    void documentChanged(DocumentChangeType type) override;
+
+    /**
+     * The job reading the file finished, on the UI thread
+     * @param generation As given to the job, the result is dropped if another document was loaded since
+     * @param pdf The new version of the PDF, not loaded if the file could not be read
+     * @param previousSignatures, signatures The signatures of the pages of `previous` and of `pdf`
+     */
+    void reloaded(unsigned int generation, const XojPdfDocument& previous,
+                  std::vector<PdfPageSignature> previousSignatures, XojPdfDocument pdf,
+                  std::vector<PdfPageSignature> signatures);
+
+    /**
+     * The time without change of the file before it is read again: the builds write it in several steps
+     */
+    static constexpr guint SETTLE_DELAY = 1000;
+
+private:
+    void watch(const fs::path& file);
+    void unwatch();
+
+    /**
+     * Starts the job reading the file, or has it read again after the running one
+     */
+    void reload();
+
+    /**
+     * Use the new version of the PDF. Dropped if the document uses another PDF than `previous` now.
+     */
+    void apply(const XojPdfDocument& previous, const std::vector<PdfPageSignature>& previousSignatures,
+               XojPdfDocument pdf, std::vector<PdfPageSignature> signatures);
+
+    static void fileChangedCallback(GFileMonitor* monitor, GFile* file, GFile* otherFile, GFileMonitorEvent event,
+                                    PdfReloader* self);
+    static bool settledCallback(PdfReloader* self);
+
+private:
+    Control* control;
+
+    fs::path file;
+    GFileMonitor* monitor = nullptr;
+    guint settleTimeout = 0;
+
+    /**
+     * Counts the loaded documents and the reloads, see reloaded()
+     */
+    unsigned int generation = 0;
+    bool reloading = false;
+    bool changedAgain = false;
+
+    /**
+     * The signatures of the pages of the current PDF, if it was reloaded already
+     */
+    XojPdfDocument signedPdf;
+    std::vector<PdfPageSignature> signatures;
+};
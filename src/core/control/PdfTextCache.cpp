@@ -0,0 +1,63 @@
+#include "PdfTextCache.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "util/Profiler.h"
+
+PdfTextCache::PdfTextCache(XojPdfDocument doc): pdfDocument(std::move(doc)) {}
+
+auto PdfTextCache::find(size_t pdfPage) -> Entry* {
+    for (auto it = this->data.begin(); it != this->data.end(); ++it) {
+        if (it->pdfPage == pdfPage) {
+            this->data.splice(this->data.begin(), this->data, it);
+            return &this->data.front();
+        }
+    }
+    return nullptr;
+}
+
+auto PdfTextCache::get(size_t pdfPage) -> std::shared_ptr<const PdfTextLayout> {
+    std::lock_guard lock(this->cacheMutex);
+    Entry* entry = find(pdfPage);
+    return entry ? entry->layout : nullptr;
+}
+
+auto PdfTextCache::getLinks(size_t pdfPage) -> std::shared_ptr<const PdfLinkIndex> {
+    std::lock_guard lock(this->cacheMutex);
+    Entry* entry = find(pdfPage);
+    return entry ? entry->links : nullptr;
+}
+
+auto PdfTextCache::markPending(size_t pdfPage) -> bool {
+    std::lock_guard lock(this->cacheMutex);
+    for (const auto& entry: this->data) {
+        if (entry.pdfPage == pdfPage) {
+            return false;
+        }
+    }
+    return this->pending.insert(pdfPage).second;
+}
+
+void PdfTextCache::extract(size_t pdfPage) {
+    std::shared_ptr<const PdfTextLayout> layout;
+    std::shared_ptr<const PdfLinkIndex> links;
+    {
+        xoj::util::Profiler::Scope scope("PDF text layout extraction");
+        XojPdfPageSPtr page = this->pdfDocument.getPage(pdfPage);
+        if (page) {
+            XojPdfPage::TextLayout text = page->getTextLayout();
+            layout = std::make_shared<const PdfTextLayout>(std::move(text.text), text.charBoxes);
+            links = std::make_shared<const PdfLinkIndex>(page->getLinks(), page->getWidth(), page->getHeight());
+        } else {
+            layout = std::make_shared<const PdfTextLayout>(std::string(), std::vector<XojPdfRectangle>());
+            links = std::make_shared<const PdfLinkIndex>(std::vector<XojPdfPage::Link>(), 0, 0);
+        }
+    }
+
+    std::lock_guard lock(this->cacheMutex);
+    this->pending.erase(pdfPage);
+    this->data.push_front({pdfPage, std::move(layout), std::move(links)});
+    while (this->data.size() > MAX_PAGES) { this->data.pop_back(); }
+}
@@ -0,0 +1,91 @@
+/*
+ * Xournal++
+ *
+ * Cache of the text layouts and the links of the PDF pages
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+
+#include "pdf/base/XojPdfDocument.h"
+
+#include "PdfLinkIndex.h"
+#include "PdfTextLayout.h"
+
+/**
+ * @brief The PdfTextLayout%s and the PdfLinkIndex%es of the last used PDF pages
+ *
+ * The layouts and the links are extracted together by a PdfTextJob, so the UI thread never waits for Poppler: until
+ * the layout of a page is there, the selection and the search query Poppler directly, and its links are not shown.
+ *
+ * The cache is thread safe. The extraction happens without holding the lock of the cache.
+ */
+class PdfTextCache {
+public:
+    explicit PdfTextCache(XojPdfDocument doc);
+
+    PdfTextCache(const PdfTextCache&) = delete;
+    PdfTextCache& operator=(const PdfTextCache&) = delete;
+
+public:
+    /**
+     * @return The layout of the page, and marks it as the most recently used, or nullptr if it is not extracted yet
+     * @param pdfPage The page number (in the pdf document)
+     */
+    std::shared_ptr<const PdfTextLayout> get(size_t pdfPage);
+
+    /**
+     * @return The links of the page, like get()
+     */
+    std::shared_ptr<const PdfLinkIndex> getLinks(size_t pdfPage);
+
+    /**
+     * @return true if the page must be extracted: it is neither cached nor being extracted. It is then marked as being
+     *         extracted, until extract() is called.
+     */
+    bool markPending(size_t pdfPage);
+
+    /**
+     * Extract the layout and the links of the page, if they are not cached yet. Called by the PdfTextJob.
+     */
+    void extract(size_t pdfPage);
+
+    static constexpr size_t MAX_PAGES = 32;
+
+private:
+    struct Entry {
+        size_t pdfPage;
+        std::shared_ptr<const PdfTextLayout> layout;
+        std::shared_ptr<const PdfLinkIndex> links;
+    };
+
+    /**
+     * @return The entry of the page, marked as the most recently used, or nullptr. Called with the lock held.
+     */
+    Entry* find(size_t pdfPage);
+
+private:
+    XojPdfDocument pdfDocument;
+
+    std::mutex cacheMutex;
+
+    /**
+     * The pages, the most recently used first
+     */
+    std::list<Entry> data;
+
+    /**
+     * The pages whose extraction is scheduled or running
+     */
+    std::set<size_t> pending;
+};
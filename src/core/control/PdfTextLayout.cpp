@@ -0,0 +1,291 @@
+#include "PdfTextLayout.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <utility>
+
+#include "SearchIndex.h"
+
+static auto utf8Length(unsigned char lead) -> size_t {
+    if ((lead & 0xE0) == 0xC0) {
+        return 2;
+    }
+    if ((lead & 0xF0) == 0xE0) {
+        return 3;
+    }
+    if ((lead & 0xF8) == 0xF0) {
+        return 4;
+    }
+    return 1;
+}
+
+static auto unite(const XojPdfRectangle& a, const XojPdfRectangle& b) -> XojPdfRectangle {
+    return {std::min(a.x1, b.x1), std::min(a.y1, b.y1), std::max(a.x2, b.x2), std::max(a.y2, b.y2)};
+}
+
+PdfTextLayout::PdfTextLayout(std::string text, const std::vector<XojPdfRectangle>& boxes): text(std::move(text)) {
+    XojPdfRectangle box(0, 0, 0, 0);
+    for (size_t offset = 0; offset < this->text.size();) {
+        size_t length = utf8Length(static_cast<unsigned char>(this->text[offset]));
+        length = std::min(length, this->text.size() - offset);
+        if (this->chars.size() < boxes.size()) {
+            const XojPdfRectangle& b = boxes[this->chars.size()];
+            // Normalized, so that the lookups only compare x1 < x2 and y1 < y2
+            box = {std::min(b.x1, b.x2), std::min(b.y1, b.y2), std::max(b.x1, b.x2), std::max(b.y1, b.y2)};
+        }
+        this->chars.push_back({box, offset, length});
+        offset += length;
+    }
+
+    // A line ends with a newline, or where the next character is not beside the previous one
+    bool newLine = true;
+    for (size_t c = 0; c < this->chars.size(); c++) {
+        const XojPdfRectangle& charBox = this->chars[c].box;
+        if (!newLine && !isNewline(c)) {
+            const XojPdfRectangle& lineBox = this->lines.back().box;
+            double center = (charBox.y1 + charBox.y2) / 2;
+            newLine = center < lineBox.y1 || center > lineBox.y2;
+        }
+
+        if (newLine) {
+            this->lines.push_back({charBox, c, c + 1});
+            newLine = false;
+        } else {
+            Line& line = this->lines.back();
+            // The box of a newline is not meaningful, unless the line is empty
+            if (!isNewline(c)) {
+                line.box = unite(line.box, charBox);
+            }
+            line.end = c + 1;
+        }
+        newLine = isNewline(c);
+    }
+
+    for (size_t l = 0; l < this->lines.size(); l++) {
+        this->linesByBottom.push_back(l);
+        this->maxLineHeight = std::max(this->maxLineHeight, this->lines[l].box.y2 - this->lines[l].box.y1);
+    }
+    std::sort(this->linesByBottom.begin(), this->linesByBottom.end(),
+              [this](size_t a, size_t b) { return this->lines[a].box.y2 < this->lines[b].box.y2; });
+
+    // The normalized text, character by character. Most PDF text is ASCII: it is only lower cased.
+    this->searchOffsets.reserve(this->chars.size());
+    for (size_t c = 0; c < this->chars.size(); c++) {
+        this->searchOffsets.push_back(this->searchText.size());
+        const Char& ch = this->chars[c];
+        if (isSpace(c)) {
+            if (!this->searchText.empty() && this->searchText.back() != ' ') {
+                this->searchText += ' ';
+            }
+        } else if (ch.length == 1 && static_cast<unsigned char>(this->text[ch.offset]) < 0x80) {
+            auto lower = std::tolower(static_cast<unsigned char>(this->text[ch.offset]));
+            this->searchText += static_cast<char>(lower);
+        } else {
+            this->searchText += SearchIndex::normalize(this->text.substr(ch.offset, ch.length));
+        }
+    }
+}
+
+auto PdfTextLayout::getCharCount() const -> size_t { return this->chars.size(); }
+
+auto PdfTextLayout::getLineCount() const -> size_t { return this->lines.size(); }
+
+auto PdfTextLayout::isSpace(size_t c) const -> bool {
+    const Char& ch = this->chars[c];
+    if (ch.length != 1) {
+        return false;
+    }
+    char byte = this->text[ch.offset];
+    return byte == ' ' || byte == '\t' || byte == '\n' || byte == '\r' || byte == '\f' || byte == '\v';
+}
+
+auto PdfTextLayout::isNewline(size_t c) const -> bool {
+    const Char& ch = this->chars[c];
+    return ch.length == 1 && this->text[ch.offset] == '\n';
+}
+
+auto PdfTextLayout::intersects(const XojPdfRectangle& box, const XojPdfRectangle& area) -> bool {
+    // As Poppler, the characters which only touch the area are not selected
+    return std::min(box.x2, area.x2) > std::max(box.x1, area.x1) &&
+           std::min(box.y2, area.y2) > std::max(box.y1, area.y1);
+}
+
+auto PdfTextLayout::linesBetween(double top, double bottom) const -> std::vector<size_t> {
+    // A line overlapping the band has its bottom in [top, bottom + maxLineHeight]
+    auto byBottom = [this](size_t l, double y) { return this->lines[l].box.y2 < y; };
+    auto begin = std::lower_bound(this->linesByBottom.begin(), this->linesByBottom.end(), top, byBottom);
+    auto end = std::lower_bound(begin, this->linesByBottom.end(), bottom + this->maxLineHeight + 1e-9, byBottom);
+
+    std::vector<size_t> result;
+    for (auto it = begin; it != end; ++it) {
+        if (this->lines[*it].box.y1 <= bottom) {
+            result.push_back(*it);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+auto PdfTextLayout::positionAt(double x, double y) const -> size_t {
+    if (this->lines.empty()) {
+        return 0;
+    }
+
+    // The line at the height of the point which is the closest horizontally, else the closest vertically
+    auto distance = [](double v, double min, double max) { return v < min ? min - v : (v > max ? v - max : 0.0); };
+    std::vector<size_t> candidates = linesBetween(y, y);
+    if (candidates.empty()) {
+        candidates.resize(this->lines.size());
+        for (size_t l = 0; l < this->lines.size(); l++) { candidates[l] = l; }
+    }
+    size_t best = candidates.front();
+    double bestDistance = HUGE_VAL;
+    for (size_t l: candidates) {
+        const XojPdfRectangle& box = this->lines[l].box;
+        double d = distance(y, box.y1, box.y2) * 1e6 + distance(x, box.x1, box.x2);
+        if (d < bestDistance) {
+            best = l;
+            bestDistance = d;
+        }
+    }
+
+    const Line& line = this->lines[best];
+    size_t position = line.first;
+    for (size_t c = line.first; c < line.end && !isNewline(c); c++) {
+        const XojPdfRectangle& box = this->chars[c].box;
+        if (x < (box.x1 + box.x2) / 2) {
+            return c;
+        }
+        position = c + 1;
+    }
+    return position;
+}
+
+auto PdfTextLayout::lineOf(size_t c) const -> size_t {
+    auto it = std::upper_bound(this->lines.begin(), this->lines.end(), c,
+                               [](size_t c, const Line& line) { return c < line.first; });
+    return static_cast<size_t>(it - this->lines.begin()) - 1;
+}
+
+auto PdfTextLayout::selectRange(const XojPdfRectangle& rect, XojPdfPageSelectionStyle style) const
+        -> std::pair<size_t, size_t> {
+    if (this->chars.empty()) {
+        return {0, 0};
+    }
+
+    size_t start = positionAt(rect.x1, rect.y1);
+    size_t stop = positionAt(rect.x2, rect.y2);
+    size_t first = std::min(start, stop);
+    size_t end = std::max(start, stop);
+
+    if (style == XojPdfPageSelectionStyle::Word) {
+        while (first > 0 && !isSpace(first - 1)) { first--; }
+        while (end < this->chars.size() && !isSpace(end)) { end++; }
+    } else if (style == XojPdfPageSelectionStyle::Line) {
+        size_t lastLine = lineOf(end > first ? end - 1 : std::min(first, this->chars.size() - 1));
+        first = this->lines[lineOf(std::min(first, this->chars.size() - 1))].first;
+        end = this->lines[lastLine].end;
+    }
+    return {first, end};
+}
+
+auto PdfTextLayout::lineBoxes(size_t first, size_t end) const -> std::vector<XojPdfRectangle> {
+    std::vector<XojPdfRectangle> boxes;
+    if (first >= end) {
+        return boxes;
+    }
+    for (size_t l = lineOf(first); l < this->lines.size() && this->lines[l].first < end; l++) {
+        const Line& line = this->lines[l];
+        bool empty = true;
+        XojPdfRectangle box;
+        for (size_t c = std::max(first, line.first); c < std::min(end, line.end); c++) {
+            if (isNewline(c)) {
+                continue;
+            }
+            box = empty ? this->chars[c].box : unite(box, this->chars[c].box);
+            empty = false;
+        }
+        if (!empty) {
+            boxes.push_back(box);
+        }
+    }
+    return boxes;
+}
+
+auto PdfTextLayout::selectText(const XojPdfRectangle& rect, XojPdfPageSelectionStyle style) const -> std::string {
+    if (style != XojPdfPageSelectionStyle::Area) {
+        auto [first, end] = selectRange(rect, style);
+        if (first >= end) {
+            return "";
+        }
+        size_t offset = this->chars[first].offset;
+        return this->text.substr(offset, this->chars[end - 1].offset + this->chars[end - 1].length - offset);
+    }
+
+    XojPdfRectangle area(std::min(rect.x1, rect.x2), std::min(rect.y1, rect.y2), std::max(rect.x1, rect.x2),
+                         std::max(rect.y1, rect.y2));
+    std::string selected;
+    for (size_t l: linesBetween(area.y1, area.y2)) {
+        bool newLine = !selected.empty();
+        for (size_t c = this->lines[l].first; c < this->lines[l].end; c++) {
+            if (isNewline(c) || !intersects(this->chars[c].box, area)) {
+                continue;
+            }
+            if (newLine) {
+                selected += '\n';
+                newLine = false;
+            }
+            selected.append(this->text, this->chars[c].offset, this->chars[c].length);
+        }
+    }
+    return selected;
+}
+
+auto PdfTextLayout::selectTextLines(const XojPdfRectangle& rect, XojPdfPageSelectionStyle style) const
+        -> std::vector<XojPdfRectangle> {
+    if (style != XojPdfPageSelectionStyle::Area) {
+        auto [first, end] = selectRange(rect, style);
+        return lineBoxes(first, end);
+    }
+
+    XojPdfRectangle area(std::min(rect.x1, rect.x2), std::min(rect.y1, rect.y2), std::max(rect.x1, rect.x2),
+                         std::max(rect.y1, rect.y2));
+    std::vector<XojPdfRectangle> boxes;
+    for (size_t l: linesBetween(area.y1, area.y2)) {
+        // The consecutive characters in the area are merged
+        bool run = false;
+        for (size_t c = this->lines[l].first; c < this->lines[l].end; c++) {
+            if (isNewline(c) || !intersects(this->chars[c].box, area)) {
+                run = false;
+                continue;
+            }
+            if (run) {
+                boxes.back() = unite(boxes.back(), this->chars[c].box);
+            } else {
+                boxes.push_back(this->chars[c].box);
+                run = true;
+            }
+        }
+    }
+    return boxes;
+}
+
+auto PdfTextLayout::findText(const std::string& text) const -> std::vector<XojPdfRectangle> {
+    std::vector<XojPdfRectangle> results;
+    std::string searched = SearchIndex::normalize(text);
+    if (searched.empty()) {
+        return results;
+    }
+
+    for (size_t pos = this->searchText.find(searched); pos != std::string::npos;
+         pos = this->searchText.find(searched, pos + searched.size())) {
+        // The characters whose normalized text overlaps the occurrence
+        auto first = std::upper_bound(this->searchOffsets.begin(), this->searchOffsets.end(), pos) - 1;
+        auto end = std::lower_bound(first, this->searchOffsets.end(), pos + searched.size());
+        auto boxes = lineBoxes(static_cast<size_t>(first - this->searchOffsets.begin()),
+                               static_cast<size_t>(end - this->searchOffsets.begin()));
+        results.insert(results.end(), boxes.begin(), boxes.end());
+    }
+    return results;
+}
@@ -0,0 +1,118 @@
+/*
+ * Xournal++
+ *
+ * The text of a PDF page with the box of each character
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "pdf/base/XojPdfPage.h"
+
+/**
+ * @brief The characters of a PDF page with their boxes, grouped in lines, for the text selection and the search
+ *
+ * Poppler lays the page out again for each query, and the selection queries it on each motion event. The layout is
+ * extracted once, in the background (see PdfTextCache), and the queries only look at the lines overlapping the
+ * selection: the lines are indexed by their bottom.
+ *
+ * The layout is immutable and can be queried by several threads at once. The coordinates are the ones of the page,
+ * with the origin in the top left corner.
+ */
+class PdfTextLayout {
+public:
+    /**
+     * @param text The text of the page, in reading order, as XojPdfPage::getText()
+     * @param boxes The box of each character of the text, see XojPdfPage::getTextLayout()
+     */
+    PdfTextLayout(std::string text, const std::vector<XojPdfRectangle>& boxes);
+
+public:
+    /**
+     * @return The selected text, like XojPdfPage::selectText()
+     */
+    std::string selectText(const XojPdfRectangle& rect, XojPdfPageSelectionStyle style) const;
+
+    /**
+     * @return One rectangle per line of the selected text, like XojPdfPage::selectTextLines()
+     */
+    std::vector<XojPdfRectangle> selectTextLines(const XojPdfRectangle& rect, XojPdfPageSelectionStyle style) const;
+
+    /**
+     * @return The boxes of the occurrences of the text, one per line they span. The comparison is the one of the
+     *         SearchIndex, see SearchIndex::normalize().
+     */
+    std::vector<XojPdfRectangle> findText(const std::string& text) const;
+
+    size_t getCharCount() const;
+    size_t getLineCount() const;
+
+private:
+    struct Char {
+        XojPdfRectangle box;
+        /// Of its bytes in the text
+        size_t offset;
+        size_t length;
+    };
+
+    struct Line {
+        XojPdfRectangle box;
+        /// The characters [first, end)
+        size_t first;
+        size_t end;
+    };
+
+    /**
+     * The characters of the selection, in [first, end), for the styles but XojPdfPageSelectionStyle::Area
+     */
+    std::pair<size_t, size_t> selectRange(const XojPdfRectangle& rect, XojPdfPageSelectionStyle style) const;
+
+    /**
+     * @return Whether the character intersects the area, for XojPdfPageSelectionStyle::Area
+     */
+    static bool intersects(const XojPdfRectangle& box, const XojPdfRectangle& area);
+
+    /**
+     * @return The lines overlapping the band between top and bottom, in reading order
+     */
+    std::vector<size_t> linesBetween(double top, double bottom) const;
+
+    /**
+     * @return The position in the text (between two characters) closest to the point
+     */
+    size_t positionAt(double x, double y) const;
+
+    /**
+     * @return The line of the character
+     */
+    size_t lineOf(size_t c) const;
+
+    /**
+     * @return One box per line of the characters [first, end)
+     */
+    std::vector<XojPdfRectangle> lineBoxes(size_t first, size_t end) const;
+
+    bool isSpace(size_t c) const;
+    bool isNewline(size_t c) const;
+
+private:
+    std::string text;
+    std::vector<Char> chars;
+    std::vector<Line> lines;
+
+    /// The lines sorted by their bottom, for linesBetween()
+    std::vector<size_t> linesByBottom;
+    double maxLineHeight = 0;
+
+    /// The normalized text of findText(), and the offset in it of each character
+    std::string searchText;
+    std::vector<size_t> searchOffsets;
+};
@@ -1,25 +1,63 @@
 #include "PrintHandler.h"
 
+#include <algorithm>
 #include <cmath>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
 
 #include <config-dev.h>
 
+#include "control/jobs/XournalScheduler.h"
 #include "model/Document.h"
 #include "util/PathUtil.h"
 #include "util/XojMsgBox.h"
 #include "util/i18n.h"
 #include "util/safe_casts.h"
-#include "view/DocumentView.h"
 
 namespace {
-void drawPage(GtkPrintOperation* /*operation*/, GtkPrintContext* context, int pageNr, Document* doc) {
-    cairo_t* cr = gtk_print_context_get_cairo_context(context);
-
-    PageRef page = doc->getPage(static_cast<size_t>(pageNr));
-    if (!page) {
-        return;
+/// The pages rendered by the workers ahead of the one the print operation draws
+constexpr int RENDER_AHEAD = 8;
+
+constexpr auto STATE_KEY = "xoj-print-state";
+
+/**
+ * @brief A running print operation. The pages are recorded by PrintPageJob%s and replayed into the print context in
+ * the order the print operation asks for them.
+ */
+struct PrintState {
+    ~PrintState() {
+        for (auto& [pageNr, recording]: recordings) { cairo_surface_destroy(recording); }
     }
 
+    Document* doc = nullptr;
+    XournalScheduler* scheduler = nullptr;
+    GtkPrintOperation* op = nullptr;
+    fs::path settingsFile;
+
+    /// The pages when printing started: the document may be edited meanwhile
+    std::vector<PageRef> pages;
+
+    /// The recorded pages which were not printed yet
+    std::map<int, cairo_surface_t*> recordings;
+    std::set<int> scheduled;
+
+    /// The page whose drawing waits for its recording, or -1
+    int deferredPage = -1;
+    GtkPrintContext* deferredContext = nullptr;
+
+    bool finished = false;
+};
+
+auto getState(GtkPrintOperation* op) -> std::shared_ptr<PrintState> {
+    return *static_cast<std::shared_ptr<PrintState>*>(g_object_get_data(G_OBJECT(op), STATE_KEY));
+}
+
+void replay(GtkPrintContext* context, const PageRef& page, cairo_surface_t* recording) {
+    cairo_t* cr = gtk_print_context_get_cairo_context(context);
+    cairo_save(cr);
+
     double width = page->getWidth();
     double height = page->getHeight();
 
@@ -28,23 +66,73 @@ void drawPage(GtkPrintOperation* /*operation*/, GtkPrintContext* context, int pa
         cairo_translate(cr, 0, -height);
     }
 
-    if (page->getBackgroundType().isPdfPage()) {
-        XojPdfPageSPtr popplerPage = doc->getPdfPage(page->getPdfPageNr());
-        if (popplerPage) {
-            popplerPage->renderForPrinting(cr);
+    cairo_set_source_surface(cr, recording, 0, 0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+void pageRendered(const std::shared_ptr<PrintState>& state, int pageNr, cairo_surface_t* recording) {
+    if (state->finished) {
+        cairo_surface_destroy(recording);
+        return;
+    }
+    state->scheduled.erase(pageNr);
+
+    if (pageNr != state->deferredPage) {
+        state->recordings.emplace(pageNr, recording);
+        return;
+    }
+    replay(state->deferredContext, state->pages[static_cast<size_t>(pageNr)], recording);
+    cairo_surface_destroy(recording);
+    state->deferredPage = -1;
+    state->deferredContext = nullptr;
+    gtk_print_operation_draw_page_finish(state->op);
+}
+
+/**
+ * Schedule the recording of the page and of the next ones
+ */
+void renderAhead(const std::shared_ptr<PrintState>& state, int pageNr) {
+    int end = std::min(pageNr + RENDER_AHEAD, static_cast<int>(state->pages.size()));
+    for (int p = pageNr; p < end; p++) {
+        if (state->scheduled.count(p) || state->recordings.count(p)) {
+            continue;
         }
+        state->scheduled.insert(p);
+        state->scheduler->addPrintPage(state.get(), state->doc, state->pages[static_cast<size_t>(p)],
+                                       [state, p](cairo_surface_t* recording) { pageRendered(state, p, recording); });
+    }
+}
+
+void drawPage(GtkPrintOperation* op, GtkPrintContext* context, int pageNr, gpointer /*userdata*/) {
+    auto state = getState(op);
+    if (pageNr < 0 || static_cast<size_t>(pageNr) >= state->pages.size()) {
+        return;
     }
 
-    DocumentView view;
-    view.drawPage(page, cr, true /* dont render eraseable */, true /* dont show pdf background*/);
+    renderAhead(state, pageNr);
+
+    auto it = state->recordings.find(pageNr);
+    if (it != state->recordings.end()) {
+        replay(context, state->pages[static_cast<size_t>(pageNr)], it->second);
+        cairo_surface_destroy(it->second);
+        state->recordings.erase(it);
+        return;
+    }
+
+    // The main loop keeps running until the workers recorded the page, see pageRendered()
+    state->deferredPage = pageNr;
+    state->deferredContext = context;
+    gtk_print_operation_set_defer_drawing(op);
 }
 
-void requestPageSetup(GtkPrintOperation* /*op*/, GtkPrintContext* /*ctx*/, int pageNr, GtkPageSetup* setup,
-                      Document* doc) {
-    PageRef page = doc->getPage(static_cast<size_t>(pageNr));  // Can't be negative
-    if (!page) {
+void requestPageSetup(GtkPrintOperation* op, GtkPrintContext* /*ctx*/, int pageNr, GtkPageSetup* setup,
+                      gpointer /*userdata*/) {
+    auto state = getState(op);
+    if (pageNr < 0 || static_cast<size_t>(pageNr) >= state->pages.size()) {
         return;
     }
+    const PageRef& page = state->pages[static_cast<size_t>(pageNr)];
 
     double width = page->getWidth();
     double height = page->getHeight();
@@ -67,10 +155,34 @@ inline void handlePrintError(GError*& error, const char* message) {
         error = nullptr;
     }
 }
+
+/**
+ * Save the settings or report the error, once. Called when the print operation is done, or when it failed at once.
+ */
+void finish(GtkPrintOperation* op, GtkPrintOperationResult res) {
+    auto state = getState(op);
+    if (state->finished) {
+        return;
+    }
+    state->finished = true;
+    state->scheduler->removePrintPages(state.get());
+
+    if (GTK_PRINT_OPERATION_RESULT_APPLY == res) {
+        GtkPrintSettings* settings = gtk_print_operation_get_print_settings(op);
+        gtk_print_settings_to_file(settings, state->settingsFile.u8string().c_str(), nullptr);
+    } else if (GTK_PRINT_OPERATION_RESULT_ERROR == res) {
+        constexpr auto msg = "Running print operation failed with %s";
+        XojMsgBox::showErrorToUser(nullptr, _(msg));
+        GError* error{};
+        gtk_print_operation_get_error(op, &error);
+        handlePrintError(error, msg);
+    }
+}
+
+void printDone(GtkPrintOperation* op, GtkPrintOperationResult res, gpointer /*userdata*/) { finish(op, res); }
 }  // namespace
 
-// Todo: maybe loop over this twice,
-void PrintHandler::print(Document* doc, size_t currentPage, GtkWindow* parent) {
+void PrintHandler::print(Document* doc, XournalScheduler* scheduler, size_t currentPage, GtkWindow* parent) {
     GtkPrintSettings* settings{};
     auto filepath = Util::getConfigFile(PRINT_CONFIG_FILE);
     if (fs::exists(filepath)) {
@@ -84,26 +196,43 @@ void PrintHandler::print(Document* doc, size_t currentPage, GtkWindow* parent) {
     }
 
     GtkPrintOperation* op = gtk_print_operation_new();
+
+    auto state = std::make_shared<PrintState>();
+    state->doc = doc;
+    state->scheduler = scheduler;
+    state->op = op;
+    state->settingsFile = filepath;
+    doc->lockShared();
+    for (size_t i = 0; i < doc->getPageCount(); i++) { state->pages.push_back(doc->getPage(i)); }
+    doc->unlockShared();
+    // Released with the print operation, the jobs still running keep their own reference
+    g_object_set_data_full(G_OBJECT(op), STATE_KEY, new std::shared_ptr<PrintState>(state), [](gpointer data) {
+        delete static_cast<std::shared_ptr<PrintState>*>(data);
+    });
+
     gtk_print_operation_set_print_settings(op, settings);
-    gtk_print_operation_set_n_pages(op, strict_cast<int>(doc->getPageCount()));
+    gtk_print_operation_set_n_pages(op, strict_cast<int>(state->pages.size()));
     gtk_print_operation_set_current_page(op, strict_cast<int>(currentPage));
     gtk_print_operation_set_job_name(op, "Xournal++");
     gtk_print_operation_set_unit(op, GTK_UNIT_POINTS);
     gtk_print_operation_set_use_full_page(op, true);
-    g_signal_connect(op, "draw_page", G_CALLBACK(drawPage), doc);
-    g_signal_connect(op, "request-page-setup", G_CALLBACK(requestPageSetup), doc);
+    // The pages are rendered by the workers: the UI stays responsive, and GTK shows the progress with a cancel button
+    gtk_print_operation_set_allow_async(op, true);
+    gtk_print_operation_set_show_progress(op, true);
+    g_signal_connect(op, "draw_page", G_CALLBACK(drawPage), nullptr);
+    g_signal_connect(op, "request-page-setup", G_CALLBACK(requestPageSetup), nullptr);
+    g_signal_connect(op, "done", G_CALLBACK(printDone), nullptr);
 
     GError* error{};
     GtkPrintOperationResult res = gtk_print_operation_run(op, GTK_PRINT_OPERATION_ACTION_PRINT_DIALOG, parent, &error);
     g_object_unref(settings);
-    if (GTK_PRINT_OPERATION_RESULT_APPLY == res) {
-        settings = gtk_print_operation_get_print_settings(op);
-        gtk_print_settings_to_file(settings, filepath.u8string().c_str(), nullptr);
-    } else if (GTK_PRINT_OPERATION_RESULT_ERROR == res) {
-        constexpr auto msg = "Running print operation failed with %s";
-        XojMsgBox::showErrorToUser(nullptr, _(msg));
-        handlePrintError(error, msg);
+    if (GTK_PRINT_OPERATION_RESULT_ERROR == res) {
+        handlePrintError(error, "Running print operation failed with %s");
+    }
+    if (GTK_PRINT_OPERATION_RESULT_IN_PROGRESS != res) {
+        finish(op, res);
     }
 
+    // GTK keeps the operation alive until it is done
     g_object_unref(op);
 }
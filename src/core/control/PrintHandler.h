@@ -11,11 +11,17 @@
 
 #pragma once
 
-#include <gtk/gtk.h>
+#include <cstddef>
 
+#include <gtk/gtk.h>
 
 class Document;
+class XournalScheduler;
 
 namespace PrintHandler {
-void print(Document* doc, size_t currentPage, GtkWindow* parent);
+/**
+ * Show the print dialog and print the document. The pages are rendered by the workers of the scheduler while the
+ * print operation runs asynchronously: this returns before the printing is done.
+ */
+void print(Document* doc, XournalScheduler* scheduler, size_t currentPage, GtkWindow* parent);
 }
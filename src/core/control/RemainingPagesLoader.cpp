@@ -0,0 +1,99 @@
+#include "RemainingPagesLoader.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+#include "control/xojfile/LoadHandler.h"
+#include "util/Util.h"
+
+struct RemainingPagesLoader::State {
+    std::unique_ptr<LoadHandler> handler;
+    AddPages addPages;
+    Done done;
+
+    std::atomic<bool> cancelled{false};
+
+    /**
+     * The batches not added yet, and whether the parser ended, protected by mutex
+     */
+    std::mutex mutex;
+    std::deque<std::pair<std::vector<PageRef>, const Document*>> batches;
+    bool parsed = false;
+    std::string error;
+
+    /**
+     * Only accessed on the UI thread
+     */
+    bool finished = false;
+};
+
+RemainingPagesLoader::RemainingPagesLoader(std::unique_ptr<LoadHandler> handler, AddPages addPages, Done done):
+        state(std::make_shared<State>()) {
+    this->state->handler = std::move(handler);
+    this->state->addPages = std::move(addPages);
+    this->state->done = std::move(done);
+
+    // The idle callbacks keep the state: they may run after the loader was destroyed, then they do nothing
+    this->thread = std::thread([state = this->state]() {
+        bool loaded = state->handler->loadRemainingPages(
+                [&state](std::vector<PageRef> pages, const Document* pdf) {
+                    {
+                        std::lock_guard<std::mutex> lock(state->mutex);
+                        state->batches.emplace_back(std::move(pages), pdf);
+                    }
+                    Util::execInUiThread([state]() { addParsedPages(*state); });
+                },
+                state->cancelled);
+
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->parsed = true;
+            if (!loaded) {
+                state->error = state->handler->getLastError();
+            }
+        }
+        Util::execInUiThread([state]() { addParsedPages(*state); });
+    });
+}
+
+RemainingPagesLoader::~RemainingPagesLoader() {
+    this->state->cancelled = true;
+    if (this->thread.joinable()) {
+        this->thread.join();
+    }
+}
+
+void RemainingPagesLoader::finish() {
+    if (this->thread.joinable()) {
+        this->thread.join();
+    }
+    addParsedPages(*this->state);
+}
+
+auto RemainingPagesLoader::isFinished() const -> bool { return this->state->finished; }
+
+void RemainingPagesLoader::addParsedPages(State& state) {
+    if (state.cancelled || state.finished) {
+        return;
+    }
+
+    std::deque<std::pair<std::vector<PageRef>, const Document*>> batches;
+    bool parsed = false;
+    std::string error;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        std::swap(batches, state.batches);
+        parsed = state.parsed;
+        error = state.error;
+    }
+
+    for (const auto& [pages, pdf]: batches) {
+        state.addPages(pages, pdf);
+    }
+    if (parsed) {
+        state.finished = true;
+        state.done(error);
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * Xournal++
+ *
+ * Adds the pages of a document opened before they were all parsed
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "model/PageRef.h"
+
+class Document;
+class LoadHandler;
+
+/**
+ * @brief Parses the pages after the first ones on a thread of its own, and adds them to the document on the UI thread
+ *
+ * The document is shown as soon as its first pages are parsed (see LoadHandler::setFirstPageCount()), the others are
+ * added in batches, in order, as they are parsed.
+ */
+class RemainingPagesLoader {
+public:
+    /**
+     * @param pages The consecutive pages to append to the document
+     * @param pdf The document with the PDF background read for these pages, nullptr if it was not read for them
+     */
+    using AddPages = std::function<void(const std::vector<PageRef>& pages, const Document* pdf)>;
+
+    /**
+     * @param error The error message if the pages could not all be parsed, empty otherwise
+     */
+    using Done = std::function<void(const std::string& error)>;
+
+    /**
+     * Starts parsing the remaining pages of the handler
+     *
+     * @param addPages Called on the UI thread with each batch
+     * @param done Called on the UI thread after the last batch
+     */
+    RemainingPagesLoader(std::unique_ptr<LoadHandler> handler, AddPages addPages, Done done);
+
+    /**
+     * Stops parsing: the pages not added yet are dropped
+     */
+    ~RemainingPagesLoader();
+
+    RemainingPagesLoader(const RemainingPagesLoader&) = delete;
+    RemainingPagesLoader& operator=(const RemainingPagesLoader&) = delete;
+
+    /**
+     * Waits until all the pages are parsed, and adds them. Called on the UI thread.
+     */
+    void finish();
+
+    /**
+     * @return Whether all the pages were added
+     */
+    bool isFinished() const;
+
+    /**
+     * The number of pages parsed before the document is shown, after the page to show first
+     */
+    static constexpr size_t FIRST_PAGES = 8;
+
+private:
+    struct State;
+
+    /**
+     * Adds the parsed batches, on the UI thread
+     */
+    static void addParsedPages(State& state);
+
+private:
+    std::shared_ptr<State> state;
+    std::thread thread;
+};
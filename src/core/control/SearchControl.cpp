@@ -1,11 +1,14 @@
 #include "SearchControl.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "model/Layer.h"
 #include "model/Text.h"
 #include "view/TextView.h"
 
+#include "PdfTextLayout.h"
+
 using std::string;
 
 SearchControl::SearchControl(const PageRef& page, XojPdfPageSPtr pdf) {
@@ -17,6 +20,10 @@ SearchControl::~SearchControl() { freeSearchResults(); }
 
 void SearchControl::freeSearchResults() { this->results.clear(); }
 
+void SearchControl::setTextLayout(std::shared_ptr<const PdfTextLayout> layout) { this->layout = std::move(layout); }
+
+auto SearchControl::hasResults() const -> bool { return !this->results.empty(); }
+
 void SearchControl::paint(cairo_t* cr, double zoom, const GdkRGBA& color) {
     // set the line always the same size on display
     cairo_set_line_width(cr, 1 / zoom);
@@ -31,18 +38,9 @@ void SearchControl::paint(cairo_t* cr, double zoom, const GdkRGBA& color) {
     }
 }
 
-auto SearchControl::search(std::string text, int* occures, double* top) -> bool {
-    freeSearchResults();
-
-    if (text.empty()) {
-        return true;
-    }
-
-    if (this->pdf) {
-        this->results = this->pdf->findText(text);
-    }
-
-    for (Layer* l: *this->page->getLayers()) {
+auto SearchControl::findInTextElements(const PageRef& page, std::string text) -> std::vector<XojPdfRectangle> {
+    std::vector<XojPdfRectangle> results;
+    for (Layer* l: *page->getLayers()) {
         if (!l->isVisible()) {
             continue;
         }
@@ -53,27 +51,45 @@ auto SearchControl::search(std::string text, int* occures, double* top) -> bool
 
                 std::vector<XojPdfRectangle> textResult = xoj::view::TextView::findText(t, text);
 
-                this->results.insert(this->results.end(), textResult.begin(), textResult.end());
+                results.insert(results.end(), textResult.begin(), textResult.end());
             }
         }
     }
+    return results;
+}
 
-    if (occures) {
-        *occures = this->results.size();
+auto SearchControl::getTop(const std::vector<XojPdfRectangle>& results) -> double {
+    if (results.empty()) {
+        return 0;
     }
 
-    if (top) {
-        if (this->results.empty()) {
-            *top = 0;
-        } else {
+    double min = results[0].y1;
+    for (XojPdfRectangle rect: results) { min = std::min(min, rect.y1); }
+    return min;
+}
 
-            XojPdfRectangle first = this->results[0];
+auto SearchControl::search(std::string text, int* occures, double* top) -> bool {
+    freeSearchResults();
 
-            double min = first.y1;
-            for (XojPdfRectangle rect: this->results) { min = std::min(min, rect.y1); }
+    if (text.empty()) {
+        return true;
+    }
 
-            *top = min;
-        }
+    if (this->layout) {
+        this->results = this->layout->findText(text);
+    } else if (this->pdf) {
+        this->results = this->pdf->findText(text);
+    }
+
+    std::vector<XojPdfRectangle> textResults = findInTextElements(this->page, text);
+    this->results.insert(this->results.end(), textResults.begin(), textResults.end());
+
+    if (occures) {
+        *occures = this->results.size();
+    }
+
+    if (top) {
+        *top = getTop(this->results);
     }
 
     return !this->results.empty();
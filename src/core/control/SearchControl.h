@@ -11,23 +11,50 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "model/PageRef.h"
 #include "pdf/base/XojPdfPage.h"
 
+class PdfTextLayout;
+
 class SearchControl {
 public:
     SearchControl(const PageRef& page, XojPdfPageSPtr pdf);
     virtual ~SearchControl();
 
     bool search(std::string text, int* occures, double* top);
+
+    /**
+     * The PDF text is searched in the layout instead of by Poppler, once it is extracted
+     */
+    void setTextLayout(std::shared_ptr<const PdfTextLayout> layout);
     void paint(cairo_t* cr, double zoom, const GdkRGBA& color);
 
+    /**
+     * @return Whether the last search found the text on the page
+     */
+    bool hasResults() const;
+
+    /**
+     * @return The occurrences of the text in the visible text elements of the page. Call with the document locked.
+     */
+    static std::vector<XojPdfRectangle> findInTextElements(const PageRef& page, std::string text);
+
+    /**
+     * @return The topmost position of the occurrences
+     */
+    static double getTop(const std::vector<XojPdfRectangle>& results);
+
 private:
     void freeSearchResults();
 
 private:
     PageRef page;
     XojPdfPageSPtr pdf;
+    std::shared_ptr<const PdfTextLayout> layout;
 
     std::vector<XojPdfRectangle> results;
 };
@@ -0,0 +1,115 @@
+#include "SearchIndex.h"
+
+#include <utility>
+
+#include <glib.h>
+
+#include "control/jobs/SearchIndexJob.h"
+#include "control/jobs/XournalScheduler.h"
+#include "model/Document.h"
+#include "model/Layer.h"
+#include "model/Text.h"
+#include "model/XojPage.h"
+#include "util/StringUtils.h"
+
+SearchIndex::PdfText::PdfText(XojPdfDocument pdf): pdf(std::move(pdf)) {
+    size_t count = this->pdf.isLoaded() ? this->pdf.getPageCount() : 0;
+    this->pages.resize(count);
+    this->extracted.resize(count, false);
+}
+
+void SearchIndex::PdfText::extract() {
+    for (size_t i = 0; i < this->pages.size() && !this->cancelled; i++) {
+        XojPdfPageSPtr page = this->pdf.getPage(i);
+        std::string text = page ? normalize(page->getText()) : std::string();
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pages[i] = std::move(text);
+        this->extracted[i] = true;
+    }
+}
+
+void SearchIndex::PdfText::cancel() { this->cancelled = true; }
+
+auto SearchIndex::PdfText::mayContain(size_t pdfPage, const std::string& normalizedText) const -> bool {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (pdfPage >= this->pages.size() || !this->extracted[pdfPage]) {
+        return true;
+    }
+    return this->pages[pdfPage].find(normalizedText) != std::string::npos;
+}
+
+auto SearchIndex::PdfText::isFor(XojPdfDocument pdf) const -> bool { return this->pdf == pdf; }
+
+SearchIndex::~SearchIndex() {
+    if (auto text = std::atomic_load(&this->pdfText)) {
+        text->cancel();
+    }
+}
+
+void SearchIndex::update(Document* doc, XournalScheduler* scheduler) {
+    doc->lock();
+    XojPdfDocument pdf = doc->getPdfDocument();
+    doc->unlock();
+
+    auto text = std::atomic_load(&this->pdfText);
+    if (text && text->isFor(pdf)) {
+        return;
+    }
+
+    if (text) {
+        text->cancel();
+    }
+    text = std::make_shared<PdfText>(std::move(pdf));
+    std::atomic_store(&this->pdfText, text);
+    scheduler->addSearchIndex(std::move(text));
+}
+
+auto SearchIndex::mayContain(const PageRef& page, const std::string& text) const -> bool {
+    if (text.empty()) {
+        return false;
+    }
+
+    // Same comparison as TextView::findText()
+    std::string pattern = StringUtils::toLowerCase(text);
+    for (Layer* l: *page->getLayers()) {
+        if (!l->isVisible()) {
+            continue;
+        }
+        for (Element* e: l->getElements()) {
+            if (e->getType() == ELEMENT_TEXT &&
+                StringUtils::toLowerCase(dynamic_cast<Text*>(e)->getText()).find(pattern) != std::string::npos) {
+                return true;
+            }
+        }
+    }
+
+    size_t pdfPage = page->getPdfPageNr();
+    if (pdfPage == npos) {
+        return false;
+    }
+    auto pdfText = std::atomic_load(&this->pdfText);
+    return !pdfText || pdfText->mayContain(pdfPage, normalize(text));
+}
+
+auto SearchIndex::normalize(const std::string& text) -> std::string {
+    gchar* normalized = g_utf8_normalize(text.c_str(), static_cast<gssize>(text.length()), G_NORMALIZE_ALL);
+    gchar* folded = g_utf8_casefold(normalized ? normalized : text.c_str(), -1);
+    g_free(normalized);
+
+    std::string result;
+    bool space = false;
+    for (const gchar* c = folded; *c; c++) {
+        if (g_ascii_isspace(*c)) {
+            space = true;
+            continue;
+        }
+        if (space && !result.empty()) {
+            result += ' ';
+        }
+        space = false;
+        result += *c;
+    }
+    g_free(folded);
+    return result;
+}
@@ -0,0 +1,93 @@
+/*
+ * Xournal++
+ *
+ * Text of the pages, to find the pages a searched text may be on
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "model/PageRef.h"
+#include "pdf/base/XojPdfDocument.h"
+
+class Document;
+class XournalScheduler;
+
+/**
+ * @brief Finds the pages a searched text may be on, without asking Poppler to search each of them
+ *
+ * The text of the PDF background is extracted once per document, in the background (see SearchIndexJob), and kept
+ * normalized. Searching for the next occurrence only searches the pages whose text contains the searched one. The
+ * text elements are checked on the page itself, so that their edits are taken into account right away.
+ *
+ * A page whose PDF text was not extracted yet may contain any text. mayContain() can be called by the SearchJob while
+ * the index is updated.
+ */
+class SearchIndex {
+public:
+    /**
+     * @brief The text of the pages of a PDF document, filled in by SearchIndexJob
+     */
+    class PdfText {
+    public:
+        explicit PdfText(XojPdfDocument pdf);
+
+        /**
+         * Extract the text of all the pages, until cancelled. Called by SearchIndexJob.
+         */
+        void extract();
+
+        void cancel();
+
+        /**
+         * @return false if the page does not contain the normalized text, true if it may
+         */
+        bool mayContain(size_t pdfPage, const std::string& normalizedText) const;
+
+        bool isFor(XojPdfDocument pdf) const;
+
+    private:
+        XojPdfDocument pdf;
+        std::atomic<bool> cancelled{false};
+
+        std::vector<std::string> pages;
+        std::vector<bool> extracted;
+        mutable std::mutex mutex;
+    };
+
+    SearchIndex() = default;
+    ~SearchIndex();
+
+    SearchIndex(const SearchIndex&) = delete;
+    SearchIndex& operator=(const SearchIndex&) = delete;
+
+public:
+    /**
+     * Extract the text of the PDF of the document in the background, unless it is done already
+     */
+    void update(Document* doc, XournalScheduler* scheduler);
+
+    /**
+     * @return false if the page does not contain the text, true if it may
+     */
+    bool mayContain(const PageRef& page, const std::string& text) const;
+
+    /**
+     * @return The text folded to lower case and compatibility characters (e.g. ligatures), with the runs of
+     *         whitespace replaced by a single space
+     */
+    static std::string normalize(const std::string& text);
+
+private:
+    std::shared_ptr<PdfText> pdfText;
+};
@@ -121,6 +121,9 @@ void ToolHandler::initTools() {
 }
 
 ToolHandler::~ToolHandler() {
+    if (this->flushChangesSource) {
+        g_source_remove(this->flushChangesSource);
+    }
     // Do not delete settings!
     this->settings = nullptr;
 }
@@ -181,7 +184,63 @@ void ToolHandler::selectTool(ToolType type) {
 void ToolHandler::fireToolChanged() {
     for (auto&& listener: this->toolChangeListeners) { listener(this->activeTool->type); }
 
-    stateChangeListener->toolChanged();
+    notifyChanges(CHANGE_TOOL);
+}
+
+void ToolHandler::notifyChanges(unsigned changes) {
+    this->pendingChanges |= changes;
+    if (!this->flushChangesSource) {
+        // Before the redraw (GDK_PRIORITY_REDRAW), after the pending input events
+        this->flushChangesSource = g_idle_add_full(
+                G_PRIORITY_HIGH_IDLE, reinterpret_cast<GSourceFunc>(flushChangesCallback), this, nullptr);
+    }
+}
+
+auto ToolHandler::flushChangesCallback(ToolHandler* self) -> gboolean {
+    self->flushChangesSource = 0;
+    self->flushChanges();
+    return G_SOURCE_REMOVE;
+}
+
+void ToolHandler::flushChanges() {
+    if (this->flushChangesSource) {
+        g_source_remove(this->flushChangesSource);
+        this->flushChangesSource = 0;
+    }
+    unsigned changes = this->pendingChanges;
+    this->pendingChanges = 0;
+
+    if (changes & CHANGE_TOOL) {
+        // ToolListener::toolChanged() updates the color, size and fill of the tools having them
+        if (hasCapability(TOOL_CAP_COLOR)) {
+            changes &= ~CHANGE_COLOR;
+        }
+        if (hasCapability(TOOL_CAP_SIZE)) {
+            changes &= ~CHANGE_SIZE;
+        }
+        if (hasCapability(TOOL_CAP_FILL)) {
+            changes &= ~CHANGE_FILL;
+        }
+    }
+
+    if (changes & CHANGE_COLOR) {
+        this->stateChangeListener->toolColorChanged();
+    }
+    if (changes & CHANGE_SIZE) {
+        notifyChanges(CHANGE_SIZE);
+    }
+    if (changes & CHANGE_FILL) {
+        notifyChanges(CHANGE_FILL);
+    }
+    if (changes & CHANGE_TOOL) {
+        this->stateChangeListener->toolChanged();
+    }
+    if (changes & CHANGE_LINE_STYLE) {
+        notifyChanges(CHANGE_LINE_STYLE);
+    }
+    if (changes & CHANGE_CUSTOM_COLOR) {
+        this->stateChangeListener->setCustomColorSelected();
+    }
 }
 
 void ToolHandler::addToolChangedListener(ToolChangedCallback listener) {
@@ -220,7 +279,7 @@ void ToolHandler::setPenSize(ToolSize size) {
     this->tools[TOOL_PEN - TOOL_PEN]->setSize(size);
 
     if (this->activeTool->type == TOOL_PEN) {
-        this->stateChangeListener->toolSizeChanged();
+        notifyChanges(CHANGE_SIZE);
     }
 }
 
@@ -228,7 +287,7 @@ void ToolHandler::setEraserSize(ToolSize size) {
     this->tools[TOOL_ERASER - TOOL_PEN]->setSize(size);
 
     if (this->activeTool->type == TOOL_ERASER) {
-        this->stateChangeListener->toolSizeChanged();
+        notifyChanges(CHANGE_SIZE);
     }
 }
 
@@ -236,7 +295,7 @@ void ToolHandler::setHighlighterSize(ToolSize size) {
     this->tools[TOOL_HIGHLIGHTER - TOOL_PEN]->setSize(size);
 
     if (this->activeTool->type == TOOL_HIGHLIGHTER) {
-        this->stateChangeListener->toolSizeChanged();
+        notifyChanges(CHANGE_SIZE);
     }
 }
 
@@ -244,7 +303,7 @@ void ToolHandler::setPenFillEnabled(bool fill, bool fireEvent) {
     this->tools[TOOL_PEN - TOOL_PEN]->setFill(fill);
 
     if (this->activeTool->type == TOOL_PEN && fireEvent) {
-        this->stateChangeListener->toolFillChanged();
+        notifyChanges(CHANGE_FILL);
     }
 }
 
@@ -258,7 +317,7 @@ void ToolHandler::setHighlighterFillEnabled(bool fill, bool fireEvent) {
     this->tools[TOOL_HIGHLIGHTER - TOOL_PEN]->setFill(fill);
 
     if (this->activeTool->type == TOOL_HIGHLIGHTER && fireEvent) {
-        this->stateChangeListener->toolFillChanged();
+        notifyChanges(CHANGE_FILL);
     }
 }
 
@@ -285,7 +344,7 @@ void ToolHandler::setSize(ToolSize size) {
 
     Tool* tool = this->toolbarSelectedTool;
     tool->setSize(clippedSize);
-    this->stateChangeListener->toolSizeChanged();
+    notifyChanges(CHANGE_SIZE);
 }
 
 void ToolHandler::setButtonSize(ToolSize size, Button button) {
@@ -295,12 +354,12 @@ void ToolHandler::setButtonSize(ToolSize size, Button button) {
 
     Tool* tool = getButtonTool(button);
     tool->setSize(clippedSize);
-    this->stateChangeListener->toolSizeChanged();
+    notifyChanges(CHANGE_SIZE);
 }
 
 void ToolHandler::setLineStyle(const LineStyle& style) {
     this->tools[TOOL_PEN - TOOL_PEN]->setLineStyle(style);
-    this->stateChangeListener->toolLineStyleChanged();
+    notifyChanges(CHANGE_LINE_STYLE);
 }
 
 void ToolHandler::setColor(Color color, bool userSelection) {
@@ -309,17 +368,15 @@ void ToolHandler::setColor(Color color, bool userSelection) {
     }
     Tool* tool = this->activeTool;
     tool->setColor(color);
-    this->stateChangeListener->toolColorChanged();
+    notifyChanges(CHANGE_COLOR | CHANGE_CUSTOM_COLOR);
     if (userSelection)
         this->stateChangeListener->changeColorOfSelection();
-    this->stateChangeListener->setCustomColorSelected();
 }
 
 void ToolHandler::setButtonColor(Color color, Button button) {
     Tool* tool = this->getButtonTool(button);
     tool->setColor(color);
-    this->stateChangeListener->toolColorChanged();
-    this->stateChangeListener->setCustomColorSelected();
+    notifyChanges(CHANGE_COLOR | CHANGE_CUSTOM_COLOR);
 }
 
 auto ToolHandler::getColor() -> Color {
@@ -530,9 +587,7 @@ void ToolHandler::setSelectionEditTools(bool setColor, bool setSize, bool setFil
 
     if (this->activeTool->type == TOOL_SELECT_RECT || this->activeTool->type == TOOL_SELECT_REGION ||
         this->activeTool->type == TOOL_SELECT_OBJECT || this->activeTool->type == TOOL_PLAY_OBJECT) {
-        this->stateChangeListener->toolColorChanged();
-        this->stateChangeListener->toolSizeChanged();
-        this->stateChangeListener->toolFillChanged();
+        notifyChanges(CHANGE_COLOR | CHANGE_SIZE | CHANGE_FILL);
         this->fireToolChanged();
     }
 }
@@ -17,6 +17,8 @@
 #include <string>
 #include <vector>
 
+#include <glib.h>
+
 #include "control/settings/Settings.h"
 #include "control/settings/SettingsEnums.h"
 #include "util/Color.h"
@@ -214,9 +216,21 @@ public:
     /**
      * @brief Update the Toolbar and the cursor based on the active Tool
      *
+     * The listeners given to addToolChangedListener() are called right away, the ToolListener once per main loop
+     * iteration, see flushChanges().
      */
     void fireToolChanged();
 
+    /**
+     * @brief Notify the ToolListener of the pending changes now
+     *
+     * The changes of the tools are collected and passed to the ToolListener in an idle callback run before the next
+     * redraw, so that bursts of them (e.g. the stylus buttons toggling the tool, or a plugin setting colors in a loop)
+     * update the toolbars and the cursor once. Every change is notified once, and a change of the tool includes the
+     * changes of the color, size and fill it supports.
+     */
+    void flushChanges();
+
     /**
      * @brief Listen for tool changes.
      *
@@ -331,6 +345,23 @@ public:
 protected:
     void initTools();
 
+private:
+    enum Change : unsigned {
+        CHANGE_COLOR = 1 << 0,
+        CHANGE_CUSTOM_COLOR = 1 << 1,
+        CHANGE_SIZE = 1 << 2,
+        CHANGE_FILL = 1 << 3,
+        CHANGE_LINE_STYLE = 1 << 4,
+        CHANGE_TOOL = 1 << 5,
+    };
+
+    /**
+     * Queue the changes for flushChanges()
+     */
+    void notifyChanges(unsigned changes);
+
+    static gboolean flushChangesCallback(ToolHandler* self);
+
 private:
     std::array<std::unique_ptr<Tool>, TOOL_COUNT> tools;
 
@@ -369,4 +400,10 @@ private:
     ToolListener* stateChangeListener = nullptr;
     ActionHandler* actionHandler = nullptr;
     Settings* settings = nullptr;
+
+    /**
+     * The changes not yet passed to the ToolListener, see Change
+     */
+    unsigned pendingChanges = 0;
+    guint flushChangesSource = 0;
 };
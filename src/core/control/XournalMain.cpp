@@ -1,26 +1,44 @@
 #include "XournalMain.h"
 
 #include <algorithm>
+#include <cstring>
 #include <exception>
+#include <fstream>
+#include <iostream>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
 #include <libintl.h>
 
+#include "control/xojfile/EmergencyDump.h"
 #include "control/xojfile/LoadHandler.h"
+#include "control/xojfile/SaveHandler.h"
 #include "gui/GladeSearchpath.h"
 #include "gui/MainWindow.h"
 #include "gui/XournalView.h"
+#include "gui/inputdevices/InputContext.h"
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/XojPage.h"
 #include "undo/EmergencySaveRestore.h"
+#include "util/PathUtil.h"
+#include "util/Profiler.h"
 #include "util/Stacktrace.h"
 #include "util/StringUtils.h"
 #include "util/XojMsgBox.h"
 #include "util/i18n.h"
 
+#include "BatchExport.h"
 #include "Control.h"
+#include "DocumentGenerator.h"
 #include "ExportHelper.h"
+#include "MemoryReport.h"
 #include "config-dev.h"
+#include "config-features.h"
 #include "config-git.h"
 #include "config-paths.h"
 #include "config.h"
@@ -29,6 +47,13 @@
 #if __linux__
 #include <libgen.h>
 #endif
+
+#ifdef ENABLE_UI_RESOURCES
+#include "xournalpp-resources.h"
+#endif
+
+using xoj::util::Profiler;
+
 namespace {
 
 constexpr auto APP_FLAGS = GApplicationFlags(G_APPLICATION_SEND_ENVIRONMENT | G_APPLICATION_NON_UNIQUE);
@@ -53,7 +78,11 @@ void checkForEmergencySave(Control* control);
 auto exportPdf(const char* input, const char* output, const char* range, ExportBackgroundType exportBackground,
                bool progressiveMode) -> int;
 auto exportImg(const char* input, const char* output, const char* range, int pngDpi, int pngWidth, int pngHeight,
-               ExportBackgroundType exportBackground) -> int;
+               int quality, ExportBackgroundType exportBackground) -> int;
+auto exportBatch(const char* jobFile, int pngDpi, int pngWidth, int pngHeight, int quality,
+                 ExportBackgroundType exportBackground, bool progressiveMode) -> int;
+auto generateDocument(const char* spec, const char* output) -> int;
+auto printMemoryReport(const char* input) -> int;
 
 void initResourcePath(GladeSearchpath* gladePath, const gchar* relativePathAndFile, bool failIfNotFound = true);
 
@@ -193,6 +222,11 @@ void checkForErrorlog() {
 void checkForEmergencySave(Control* control) {
     auto file = Util::getConfigFile("emergencysave.xopp");
 
+    // The crash handler only dumps the pages, which are saved as a regular file before restoring them
+    if (EmergencyDump::convert(EmergencyDump::getFilepath(), file)) {
+        g_message("Converted the emergency dump to \"%s\"", file.u8string().c_str());
+    }
+
     if (!fs::exists(file)) {
         return;
     }
@@ -233,6 +267,7 @@ void checkForEmergencySave(Control* control) {
  * @param pngDpi Set dpi for Png files. Non positive values are ignored
  * @param pngWidth Set the width for Png files. Non positive values are ignored
  * @param pngHeight Set the height for Png files. Non positive values are ignored
+ * @param quality Set the compression quality of the JPEG and WebP files. Non positive values are ignored
  * @param exportBackground If EXPORT_BACKGROUND_NONE, the exported image file has transparent background
  *
  *  The priority is: pngDpi overwrites pngWidth overwrites pngHeight
@@ -240,7 +275,7 @@ void checkForEmergencySave(Control* control) {
  * @return 0 on success, -2 on failure opening the input file, -3 on export failure
  */
 auto exportImg(const char* input, const char* output, const char* range, int pngDpi, int pngWidth, int pngHeight,
-               ExportBackgroundType exportBackground) -> int {
+               int quality, ExportBackgroundType exportBackground) -> int {
     LoadHandler loader;
 
     Document* doc = loader.loadDocument(input);
@@ -248,7 +283,7 @@ auto exportImg(const char* input, const char* output, const char* range, int png
         g_error("%s", loader.getLastError().c_str());
     }
 
-    return ExportHelper::exportImg(doc, output, range, pngDpi, pngWidth, pngHeight, exportBackground);
+    return ExportHelper::exportImg(doc, output, range, pngDpi, pngWidth, pngHeight, quality, exportBackground);
 }
 
 /**
@@ -273,6 +308,83 @@ auto exportPdf(const char* input, const char* output, const char* range, ExportB
     return ExportHelper::exportPdf(doc, output, range, exportBackground, progressiveMode);
 }
 
+/**
+ * @brief Run the exports of a job list, see BatchExport
+ * @param jobFile Path to the job list, "-" for the standard input
+ *
+ * @return 0 if all the exports succeeded, -2 on failure opening the job list, -3 if an export failed
+ */
+auto exportBatch(const char* jobFile, int pngDpi, int pngWidth, int pngHeight, int quality,
+                 ExportBackgroundType exportBackground, bool progressiveMode) -> int {
+    BatchExport batch(pngDpi, pngWidth, pngHeight, quality, exportBackground, progressiveMode);
+
+    size_t failed = 0;
+    if (strcmp(jobFile, "-") == 0) {
+        failed = batch.run(std::cin, std::cout);
+    } else {
+        std::ifstream jobs(fs::u8path(jobFile));
+        if (!jobs) {
+            std::cerr << "Could not open the job list " << jobFile << std::endl;
+            return -2;
+        }
+        failed = batch.run(jobs, std::cout);
+    }
+    return failed == 0 ? 0 : -3;
+}
+
+/**
+ * @brief Write a generated document, see DocumentGenerator
+ * @param spec The options of the generator, e.g. "pages=100,strokes=500"
+ * @param output Path to the output file
+ *
+ * @return 0 on success, -2 on invalid options, -3 on failure writing the file
+ */
+auto generateDocument(const char* spec, const char* output) -> int {
+    DocumentGenerator::Options options;
+    try {
+        options = DocumentGenerator::parseOptions(spec);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Invalid generator options: " << e.what() << std::endl;
+        return -2;
+    }
+
+    DocumentHandler handler;
+    Document doc(&handler);
+    DocumentGenerator(options).generate(&doc);
+
+    SaveHandler saver;
+    saver.prepareSave(&doc);
+    saver.saveTo(fs::u8path(output));
+    if (!saver.getErrorMessage().empty()) {
+        std::cerr << saver.getErrorMessage() << std::endl;
+        return -3;
+    }
+    return 0;
+}
+
+/**
+ * @brief Print the memory of the elements of the input file, page by page, see MemoryReport
+ * @param input Path to the input file
+ *
+ * @return 0 on success, -2 on failure opening the input file
+ */
+auto printMemoryReport(const char* input) -> int {
+    LoadHandler loader;
+    std::unique_ptr<Document> doc(loader.loadDocument(input));
+    if (!doc) {
+        std::cerr << loader.getLastError() << std::endl;
+        return -2;
+    }
+
+    // The pages are loaded lazily
+    doc->lock();
+    for (size_t i = 0; i < doc->getPageCount(); i++) { doc->getPage(i)->getLayers(); }
+    doc->unlock();
+
+    std::cout << MemoryReport(doc.get()).toString(true);
+    return 0;
+}
+
 struct XournalMainPrivate {
     XournalMainPrivate() = default;
     XournalMainPrivate(XournalMainPrivate&&) = delete;
@@ -284,23 +396,46 @@ struct XournalMainPrivate {
         g_strfreev(optFilename);
         g_free(pdfFilename);
         g_free(imgFilename);
+        g_free(batchFilename);
+        g_free(profileFilename);
+        g_free(generateSpec);
+        g_free(recordInputFilename);
+        g_free(replayInputFilename);
     }
 
     gchar** optFilename{};
     gchar* pdfFilename{};
     gchar* imgFilename{};
+    gchar* batchFilename{};
+    gchar* profileFilename{};
+    gchar* generateSpec{};
+    gchar* recordInputFilename{};
+    gchar* replayInputFilename{};
+    gboolean startupProfile = false;
     gboolean showVersion = false;
+    gboolean memoryReport = false;
+    gboolean singleInstance = false;
     int openAtPageNumber = 0;  // when no --page is used, the document opens at the page specified in the metadata file
     gchar* exportRange{};
     int exportPngDpi = -1;
     int exportPngWidth = -1;
     int exportPngHeight = -1;
+    int exportImgQuality = -1;
     gboolean exportNoBackground = false;
     gboolean exportNoRuling = false;
     gboolean progressiveMode = false;
     std::unique_ptr<GladeSearchpath> gladePath;
     std::unique_ptr<Control> control;
     std::unique_ptr<MainWindow> win;
+
+    /**
+     * The windows opened by the later launches with --single-instance, see on_open_files()
+     */
+    struct Window {
+        std::unique_ptr<Control> control;
+        std::unique_ptr<MainWindow> win;
+    };
+    std::vector<Window> otherWindows;
 };
 using XMPtr = XournalMainPrivate*;
 
@@ -381,7 +516,12 @@ void initResourcePath(GladeSearchpath* gladePath, const gchar* relativePathAndFi
     }
 }
 
-void on_activate(GApplication*, XMPtr) {}
+void on_activate(GApplication* application, XMPtr) {
+    // Launched again with --single-instance, but without file
+    if (GtkWindow* window = gtk_application_get_active_window(GTK_APPLICATION(application))) {
+        gtk_window_present(window);
+    }
+}
 
 void on_command_line(GApplication*, GApplicationCommandLine*, XMPtr) {
     g_message("XournalMain::on_command_line: This should never happen, please file a bugreport with a detailed "
@@ -389,30 +529,123 @@ void on_command_line(GApplication*, GApplicationCommandLine*, XMPtr) {
     // Todo: implement this, if someone files the bug report
 }
 
-void on_open_files(GApplication*, gpointer, gint, gchar*, XMPtr) {
-    g_message("XournalMain::on_open_files: This should never happen, please file a bugreport with a detailed "
-              "description how to reproduce this message");
-    // Todo: implement this, if someone files the bug report
+/**
+ * @brief Opens `file` in a new window, for a later launch with --single-instance
+ *
+ * The window has its own Control, but shares the UI definitions, the icons, the PDF documents and their caches of the
+ * process: nothing is loaded again but the settings and the file.
+ */
+void openWindow(GApplication* application, XMPtr app_data, const fs::path& file, int page) {
+    auto begin = Profiler::Clock::now();
+    auto control = std::make_unique<Control>(application, app_data->gladePath.get());
+    auto win = std::make_unique<MainWindow>(app_data->gladePath.get(), control.get());
+    control->initWindow(win.get());
+    win->show(nullptr);
+
+    bool opened = false;
+    try {
+        if (fs::exists(file)) {
+            opened = control->openFile(file, page - 1);  // First page for user is page 1
+        } else {
+            opened = control->newFile("", file);
+        }
+    } catch (fs::filesystem_error const& e) {
+        std::string msg = FS(_F("Sorry, Xournal++ cannot open remote files at the moment.\n"
+                                "You have to copy the file to a local directory.") %
+                             file.u8string() % e.what());
+        XojMsgBox::showErrorToUser(static_cast<GtkWindow*>(*win), msg);
+        opened = control->newFile("", file);
+    }
+    control->getScheduler()->start();
+    if (!opened) {
+        control->newFile();
+    }
+
+    // There is a timing issue with the layout, see on_startup()
+    Util::execInUiThread([xournal = win->getXournal()]() { xournal->layoutPages(); });
+    gtk_application_add_window(GTK_APPLICATION(application), GTK_WINDOW(win->getWindow()));
+    app_data->otherWindows.push_back({std::move(control), std::move(win)});
+    Profiler::getInstance().addTiming("single instance: open window", "startup", begin, Profiler::Clock::now() - begin);
+}
+
+void on_open_files(GApplication* application, GFile** files, gint count, gchar* hint, XMPtr app_data) {
+    // The page given with --page, see on_handle_local_options()
+    int page = hint ? static_cast<int>(g_ascii_strtoll(hint, nullptr, 10)) : 0;
+    for (gint i = 0; i < count; i++) {
+        fs::path path = Util::fromGFile(files[i]);
+        if (!path.empty()) {
+            openWindow(application, app_data, path, page);
+        }
+    }
+}
+
+/**
+ * @brief Drops the Control of a window closed by Control::quit(), while other windows remain
+ *
+ * The first window is kept until the shutdown: the crash handler and the --profile output refer to it.
+ */
+void on_window_removed(GtkApplication*, GtkWindow* window, XMPtr app_data) {
+    auto& windows = app_data->otherWindows;
+    auto it = std::find_if(windows.begin(), windows.end(),
+                           [window](auto& w) { return GTK_WINDOW(w.win->getWindow()) == window; });
+    if (it == windows.end()) {
+        return;
+    }
+    auto closed = std::make_shared<XournalMainPrivate::Window>(std::move(*it));
+    windows.erase(it);
+    // Not from the handlers of the window
+    Util::execInUiThread([closed]() mutable {
+        closed->win.reset();
+        closed->control.reset();
+    });
+}
+
+/**
+ * @brief Print the durations of the startup phases, once the main loop is idle after the first frames
+ */
+void printStartupProfile(Profiler::Clock::time_point start) {
+    Util::execInUiThread(
+            [start]() {
+                auto& profiler = Profiler::getInstance();
+                profiler.addTiming("startup: until idle", "startup", start, Profiler::Clock::now() - start);
+                for (auto& [name, timing]: profiler.getTimings()) {
+                    if (StringUtils::startsWith(name, "startup")) {
+                        std::cout << name << ": " << timing.totalMs << " ms" << std::endl;
+                    }
+                }
+            },
+            G_PRIORITY_LOW);
 }
 
 void on_startup(GApplication* application, XMPtr app_data) {
+    auto startupBegin = Profiler::Clock::now();
     initLocalisation();
     ensure_input_model_compatibility();
     MigrateResult migrateResult = migrateSettings();
 
+#ifdef ENABLE_UI_RESOURCES
+    {
+        Profiler::Scope scope("startup: ui resources", "startup");
+        xournalpp_register_resource();
+    }
+#endif
+
     app_data->gladePath = std::make_unique<GladeSearchpath>();
     initResourcePath(app_data->gladePath.get(), "ui/about.glade");
     initResourcePath(app_data->gladePath.get(), "ui/xournalpp.css", false);
 
-    app_data->control = std::make_unique<Control>(application, app_data->gladePath.get());
+    {
+        Profiler::Scope scope("startup: control", "startup");
+        app_data->control = std::make_unique<Control>(application, app_data->gladePath.get());
+    }
 
     // Set up icons
     {
-        const auto uiPath = app_data->gladePath->getFirstSearchPath();
-        const auto lightColorIcons = (uiPath / "iconsColor-light").u8string();
-        const auto darkColorIcons = (uiPath / "iconsColor-dark").u8string();
-        const auto lightLucideIcons = (uiPath / "iconsLucide-light").u8string();
-        const auto darkLucideIcons = (uiPath / "iconsLucide-dark").u8string();
+        Profiler::Scope scope("startup: icons", "startup");
+        const std::string lightColorIcons = "iconsColor-light";
+        const std::string darkColorIcons = "iconsColor-dark";
+        const std::string lightLucideIcons = "iconsLucide-light";
+        const std::string darkLucideIcons = "iconsLucide-dark";
 
         // icon load order from lowest priority to highest priority
         std::vector<std::string> iconLoadOrder = {};
@@ -434,7 +667,19 @@ void on_startup(GApplication* application, XMPtr app_data) {
             }
         }
 
-        for (auto& p: iconLoadOrder) { gtk_icon_theme_prepend_search_path(gtk_icon_theme_get_default(), p.c_str()); }
+        GtkIconTheme* iconTheme = gtk_icon_theme_get_default();
+        const auto uiPath = app_data->gladePath->getFirstSearchPath();
+        for (auto& p: iconLoadOrder) {
+            if (GladeSearchpath::findResource(p).empty()) {
+                gtk_icon_theme_prepend_search_path(iconTheme, (uiPath / p).u8string().c_str());
+            }
+        }
+        // The resource paths are looked at in the order they are added, the highest priority first
+        for (auto it = iconLoadOrder.rbegin(); it != iconLoadOrder.rend(); ++it) {
+            if (auto resource = GladeSearchpath::findResource(*it + "/hicolor"); !resource.empty()) {
+                gtk_icon_theme_add_resource_path(iconTheme, resource.c_str());
+            }
+        }
     }
 
     auto& globalLatexTemplatePath = app_data->control->getSettings()->latexSettings.globalTemplatePath;
@@ -444,8 +689,11 @@ void on_startup(GApplication* application, XMPtr app_data) {
         app_data->control->getSettings()->save();
     }
 
-    app_data->win = std::make_unique<MainWindow>(app_data->gladePath.get(), app_data->control.get());
-    app_data->control->initWindow(app_data->win.get());
+    {
+        Profiler::Scope scope("startup: main window", "startup");
+        app_data->win = std::make_unique<MainWindow>(app_data->gladePath.get(), app_data->control.get());
+        app_data->control->initWindow(app_data->win.get());
+    }
 
     if (migrateResult.status != MigrateStatus::NotNeeded) {
         Util::execInUiThread(
@@ -454,6 +702,7 @@ void on_startup(GApplication* application, XMPtr app_data) {
 
     app_data->win->show(nullptr);
 
+    auto openBegin = Profiler::Clock::now();
     bool opened = false;
     if (app_data->optFilename) {
         if (g_strv_length(app_data->optFilename) != 1) {
@@ -492,17 +741,47 @@ void on_startup(GApplication* application, XMPtr app_data) {
     if (!opened) {
         app_data->control->newFile();
     }
+    Profiler::getInstance().addTiming("startup: document", "startup", openBegin, Profiler::Clock::now() - openBegin);
 
     checkForErrorlog();
     checkForEmergencySave(app_data->control.get());
+    EmergencyDump::prepare();
 
     // There is a timing issue with the layout
     // This fixes it, see #405
     Util::execInUiThread([=]() { app_data->control->getWindow()->getXournal()->layoutPages(); });
+
+    if (app_data->recordInputFilename) {
+        auto* input = app_data->win->getXournal()->getInputContext();
+        if (!input->startRecording(Util::fromGFilename(app_data->recordInputFilename, false))) {
+            g_warning("Could not write the input recording %s", app_data->recordInputFilename);
+        }
+    }
+    if (app_data->replayInputFilename) {
+        // Once the pages are laid out, so that the recorded positions hit the same pages
+        Util::execInUiThread([=]() {
+            auto* input = app_data->win->getXournal()->getInputContext();
+            try {
+                input->startReplay(Util::fromGFilename(app_data->replayInputFilename, false), [=]() {
+                    for (auto& line: Profiler::getInstance().getSummary()) {
+                        std::cout << line << std::endl;
+                    }
+                    g_application_quit(application);
+                });
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                g_application_quit(application);
+            }
+        });
+    }
     gtk_application_add_window(GTK_APPLICATION(application), GTK_WINDOW(app_data->win->getWindow()));
+
+    if (app_data->startupProfile) {
+        printStartupProfile(startupBegin);
+    }
 }
 
-auto on_handle_local_options(GApplication*, GVariantDict*, XMPtr app_data) -> gint {
+auto on_handle_local_options(GApplication* application, GVariantDict*, XMPtr app_data) -> gint {
     initCAndCoutLocales();
 
     auto print_version = [&] {
@@ -534,6 +813,35 @@ auto on_handle_local_options(GApplication*, GVariantDict*, XMPtr app_data) -> gi
         return (0);
     }
 
+    if (app_data->profileFilename || app_data->startupProfile) {
+        Profiler::getInstance().setEnabled(true);
+    }
+
+    if (app_data->batchFilename) {
+        // Nothing but the status lines on the standard output
+        try {
+            return exportBatch(app_data->batchFilename, app_data->exportPngDpi, app_data->exportPngWidth,
+                               app_data->exportPngHeight, app_data->exportImgQuality,
+                               app_data->exportNoBackground ? EXPORT_BACKGROUND_NONE :
+                               app_data->exportNoRuling     ? EXPORT_BACKGROUND_UNRULED :
+                                                              EXPORT_BACKGROUND_ALL,
+                               app_data->progressiveMode);
+        } catch (std::exception const& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    if (app_data->generateSpec) {
+        if (!app_data->optFilename || !*app_data->optFilename) {
+            std::cerr << "--generate needs the path of the output file" << std::endl;
+            return 1;
+        }
+        return exec_guarded([&] { return generateDocument(app_data->generateSpec, *app_data->optFilename); },
+                            "generateDocument");
+    }
+    if (app_data->memoryReport && app_data->optFilename && *app_data->optFilename) {
+        return exec_guarded([&] { return printMemoryReport(*app_data->optFilename); }, "printMemoryReport");
+    }
     if (app_data->pdfFilename && app_data->optFilename && *app_data->optFilename) {
         return exec_guarded(
                 [&] {
@@ -550,19 +858,71 @@ auto on_handle_local_options(GApplication*, GVariantDict*, XMPtr app_data) -> gi
                 [&] {
                     return exportImg(*app_data->optFilename, app_data->imgFilename, app_data->exportRange,
                                      app_data->exportPngDpi, app_data->exportPngWidth, app_data->exportPngHeight,
+                                     app_data->exportImgQuality,
                                      app_data->exportNoBackground ? EXPORT_BACKGROUND_NONE :
                                      app_data->exportNoRuling     ? EXPORT_BACKGROUND_UNRULED :
                                                                     EXPORT_BACKGROUND_ALL);
                 },
                 "exportImg");
     }
+
+    if (app_data->singleInstance) {
+        g_application_set_flags(application, GApplicationFlags((APP_FLAGS & ~G_APPLICATION_NON_UNIQUE) |
+                                                               G_APPLICATION_HANDLES_OPEN));
+        GError* error = nullptr;
+        if (!g_application_register(application, nullptr, &error)) {
+            // E.g. no session bus: go on as a separate process
+            g_warning("Could not register the application: %s", error->message);
+            g_error_free(error);
+        } else if (g_application_get_is_remote(application)) {
+            // The running instance opens the files, in new windows
+            std::vector<GFile*> files;
+            for (gchar** f = app_data->optFilename; f && *f; f++) {
+                files.push_back(g_file_new_for_commandline_arg(*f));
+            }
+            if (files.empty()) {
+                g_application_activate(application);
+            } else {
+                std::string page = std::to_string(app_data->openAtPageNumber);
+                g_application_open(application, files.data(), static_cast<gint>(files.size()), page.c_str());
+            }
+            for (GFile* f: files) {
+                g_object_unref(f);
+            }
+            return 0;
+        }
+    }
     return -1;
 }
 
-void on_shutdown(GApplication*, XMPtr app_data) {
+void on_shutdown(GApplication* application, XMPtr app_data) {
+    // The windows are destroyed with app_data
+    g_signal_handlers_disconnect_by_func(application, reinterpret_cast<gpointer>(&on_window_removed), app_data);
+    for (auto& window: app_data->otherWindows) {
+        window.control->saveSettings();
+        window.win->getXournal()->clearSelection();
+        window.control->getScheduler()->stop();
+    }
+
     app_data->control->saveSettings();
     app_data->win->getXournal()->clearSelection();
     app_data->control->getScheduler()->stop();
+    EmergencyDump::release();
+
+    if (app_data->profileFilename) {
+        auto& profiler = Profiler::getInstance();
+        std::string prefix = app_data->profileFilename;
+        std::ofstream trace(prefix + ".json");
+        profiler.writeTrace(trace);
+        std::ofstream csv(prefix + ".csv");
+        profiler.writeCsv(csv);
+        std::ofstream input(prefix + ".input.csv");
+        app_data->win->getXournal()->getInputContext()->getInputMetrics().writeCsv(input);
+        if (!trace || !csv || !input) {
+            g_warning("Could not write the render measurements to %s.json, %s.csv and %s.input.csv", prefix.c_str(),
+                      prefix.c_str(), prefix.c_str());
+        }
+    }
 }
 
 }  // namespace
@@ -577,6 +937,7 @@ auto XournalMain::run(int argc, char** argv) -> int {
     g_signal_connect(app, "startup", G_CALLBACK(&on_startup), &app_data);
     g_signal_connect(app, "shutdown", G_CALLBACK(&on_shutdown), &app_data);
     g_signal_connect(app, "handle-local-options", G_CALLBACK(&on_handle_local_options), &app_data);
+    g_signal_connect(app, "window-removed", G_CALLBACK(&on_window_removed), &app_data);
 
     std::array options = {GOptionEntry{"page", 'n', 0, G_OPTION_ARG_INT, &app_data.openAtPageNumber,
                                        _("Jump to Page (first Page: 1)"), "N"},
@@ -584,6 +945,33 @@ auto XournalMain::run(int argc, char** argv) -> int {
                                        "<input>", nullptr},
                           GOptionEntry{"version", 0, 0, G_OPTION_ARG_NONE, &app_data.showVersion,
                                        _("Get version of xournalpp"), nullptr},
+                          GOptionEntry{"profile", 0, 0, G_OPTION_ARG_FILENAME, &app_data.profileFilename,
+                                       _("Record the render timings, written to FILE.json (Chrome trace format) "
+                                         "and FILE.csv on exit, and the input statistics to FILE.input.csv"),
+                                       "FILE"},
+                          GOptionEntry{"startup-profile", 0, 0, G_OPTION_ARG_NONE, &app_data.startupProfile,
+                                       _("Print the durations of the startup phases"), nullptr},
+                          GOptionEntry{"record-input", 0, 0, G_OPTION_ARG_FILENAME, &app_data.recordInputFilename,
+                                       _("Record the pen, mouse and touch input to FILE, for --replay-input"),
+                                       "FILE"},
+                          GOptionEntry{"replay-input", 0, 0, G_OPTION_ARG_FILENAME, &app_data.replayInputFilename,
+                                       _("Replay the input recorded in FILE with its timing, then print\n"
+                                         "                                 the timings and quit. Use the same window\n"
+                                         "                                 size and zoom as the recording"),
+                                       "FILE"},
+                          GOptionEntry{"generate", 0, 0, G_OPTION_ARG_STRING, &app_data.generateSpec,
+                                       _("Write a generated document to <input>, for scale testing\n"
+                                         "                                 SPEC: comma separated KEY=VALUE of pages,\n"
+                                         "                                 layers, strokes, points, pressure, images,\n"
+                                         "                                 texts, tex and seed"),
+                                       "SPEC"},
+                          GOptionEntry{"single-instance", 0, 0, G_OPTION_ARG_NONE, &app_data.singleInstance,
+                                       _("Open <input> in a new window of the running Xournal++, if any"),
+                                       nullptr},
+                          GOptionEntry{"memory-report", 0, 0, G_OPTION_ARG_NONE, &app_data.memoryReport,
+                                       _("Print the approximate memory of the elements of <input>, page\n"
+                                         "                                 by page, and quit"),
+                                       nullptr},
                           GOptionEntry{nullptr}};  // Must be terminated by a nullptr. See gtk doc
     g_application_add_main_option_entries(G_APPLICATION(app), options.data());
 
@@ -598,6 +986,12 @@ auto XournalMain::run(int argc, char** argv) -> int {
                            "                                 Guess the output format from the extension of IMGFILE\n"
                            "                                 Supported formats: .png, .svg"),
                          "IMGFILE"},
+            GOptionEntry{"export-batch", 0, 0, G_OPTION_ARG_FILENAME, &app_data.batchFilename,
+                         _("Run the exports listed in JOBFILE, \"-\" for the standard input, in one process\n"
+                           "                                 One job per line: INPUT<TAB>OUTPUT[<TAB>RANGE]\n"
+                           "                                 The format is guessed from the extension of OUTPUT\n"
+                           "                                 Prints one tab separated status line per job"),
+                         "JOBFILE"},
             GOptionEntry{"export-no-background", 0, 0, G_OPTION_ARG_NONE, &app_data.exportNoBackground,
                          _("Export without background\n"
                            "                                 The exported file has transparent or white background,\n"
@@ -633,6 +1027,10 @@ auto XournalMain::run(int argc, char** argv) -> int {
                       "                                 No effect without -i/--create-img=foo.png\n"
                       "                                 Ignored if --export-png-dpi or --export-png-width is used"),
                     "N"},
+            GOptionEntry{"export-img-quality", 0, 0, G_OPTION_ARG_INT, &app_data.exportImgQuality,
+                         _("Set the compression quality of JPEG and WebP exports, from 1 to 100. Default is 90\n"
+                           "                                 No effect without -i/--create-img=foo.jpg or foo.webp"),
+                         "N"},
             GOptionEntry{nullptr}};  // Must be terminated by a nullptr. See gtk doc
     GOptionGroup* exportGroup = g_option_group_new("export", _("Advanced export options"),
                                                    _("Display advanced export options"), nullptr, nullptr);
@@ -1,9 +1,13 @@
 #include "AutosaveJob.h"
 
+#include <memory>
+
 #include "control/Control.h"
+#include "control/xojfile/AutosaveJournal.h"
 #include "control/xojfile/SaveHandler.h"
 #include "util/XojMsgBox.h"
 #include "util/i18n.h"
+#include "util/logger/AsyncLog.h"
 
 #include "filesystem.h"
 
@@ -19,16 +23,16 @@ void AutosaveJob::afterRun() {
 
 void AutosaveJob::run() {
     SaveHandler handler;
+    handler.setBinaryStrokes(control->getSettings()->isSaveBinaryStrokes());
+    AutosaveJournal* journal = control->getAutosaveJournal();
 
     control->getUndoRedoHandler()->documentAutosaved();
+    gint64 startTime = g_get_monotonic_time();
 
     Document* doc = control->getDocument();
 
     doc->lock();
-    handler.prepareSave(doc);
     auto filepath = doc->getFilepath();
-    doc->unlock();
-
     if (filepath.empty()) {
         filepath = Util::getAutosaveFilepath();
     } else {
@@ -37,14 +41,42 @@ void AutosaveJob::run() {
     Util::clearExtensions(filepath);
     filepath += ".autosave.xopp";
 
-    control->renameLastAutosaveFile();
+    std::unique_ptr<Document> snapshot;
+    if (journal->needsSnapshot(doc, filepath)) {
+        // The document is saved from a snapshot, so that it can be edited in the meantime
+        snapshot = doc->snapshot();
+        journal->snapshotTaken(doc, filepath);
+    } else {
+        journal->prepareRecord(doc);
+    }
+    doc->unlock();
+
+    if (snapshot) {
+        handler.loadOverwrittenLayers(doc, filepath);
+        handler.prepareSave(snapshot.get());
+        control->renameLastAutosaveFile();
+
+        // A journal left next to the file belongs to an older snapshot
+        std::error_code ec;
+        fs::remove(AutosaveJournal::getJournalPath(filepath), ec);
+
+        g_message("%s", FS(_F("Autosaving to {1}") % filepath.string()).c_str());
 
-    g_message("%s", FS(_F("Autosaving to {1}") % filepath.string()).c_str());
+        handler.saveTo(filepath);
+        this->error = handler.getErrorMessage();
+    } else {
+        g_message("%s", FS(_F("Autosaving the changes to {1}") % AutosaveJournal::getJournalPath(filepath).string())
+                                .c_str());
+
+        this->error = journal->writeRecord();
+    }
 
-    handler.saveTo(filepath);
+    XOJ_LOG_EVENT("autosave", {{"ms", static_cast<double>(g_get_monotonic_time() - startTime) / 1000},
+                               {"snapshot", snapshot ? 1.0 : 0.0},
+                               {"failed", this->error.empty() ? 0.0 : 1.0}});
 
-    this->error = handler.getErrorMessage();
     if (!this->error.empty()) {
+        journal->reset();
         callAfterRun();
     } else {
         // control->deleteLastAutosaveFile(filepath);
@@ -106,7 +106,29 @@ auto BaseExportJob::testAndSetFilepath(fs::path file) -> bool {
 }
 
 void BaseExportJob::afterRun() {
+    if (this->background) {
+        control->backgroundExportFinished();
+    }
     if (!this->errorMsg.empty()) {
         XojMsgBox::showErrorToUser(control->getGtkWindow(), this->errorMsg);
     }
 }
+
+auto BaseExportJob::canRunInBackground() const -> bool { return false; }
+
+void BaseExportJob::runInBackground() {
+    this->background = true;
+    run();
+    // Also when there is no error, to hide the progress
+    callAfterRun();
+}
+
+void BaseExportJob::setMaximumState(int max) { control->setMaximumState(max); }
+
+void BaseExportJob::setCurrentState(int state) { control->setCurrentState(state); }
+
+void BaseExportJob::setStateDuration(int state, std::chrono::steady_clock::duration duration) {
+    control->setStateDuration(state, duration);
+}
+
+auto BaseExportJob::isCancelRequested() -> bool { return isCancelled(); }
@@ -17,6 +17,7 @@
 #include "util/PathUtil.h"
 
 #include "BlockingJob.h"
+#include "ProgressListener.h"
 #include "filesystem.h"
 
 /**
@@ -28,7 +29,7 @@ enum ExportBackgroundType { EXPORT_BACKGROUND_NONE, EXPORT_BACKGROUND_UNRULED, E
 
 class Control;
 
-class BaseExportJob: public BlockingJob {
+class BaseExportJob: public BlockingJob, public ProgressListener {
 public:
     BaseExportJob(Control* control, const std::string& name);
 
@@ -42,6 +43,24 @@ public:
     virtual bool showFilechooser();
     std::string getFilterName() const;
 
+    /**
+     * @return Whether the export only reads a snapshot of the document, and can run while the document is edited. Only
+     *         valid after showFilechooser().
+     */
+    virtual bool canRunInBackground() const;
+
+    /**
+     * Runs the export on the calling thread, without blocking the UI, see Control::exportInBackground()
+     */
+    void runInBackground();
+
+public:
+    // ProgressListener interface, forwarded to the Control
+    void setMaximumState(int max) override;
+    void setCurrentState(int state) override;
+    void setStateDuration(int state, std::chrono::steady_clock::duration duration) override;
+    bool isCancelRequested() override;
+
 protected:
     void initDialog();
     virtual void addFilterToDialog() = 0;
@@ -60,6 +79,11 @@ protected:
      */
     std::string errorMsg;
 
+    /**
+     * Whether the export runs with runInBackground()
+     */
+    bool background = false;
+
     class ExportType {
     public:
         std::string extension;
@@ -0,0 +1,126 @@
+#include "BeautifyJob.h"
+
+#include <atomic>
+#include <exception>
+#include <unordered_set>
+#include <utility>
+
+#include "control/Control.h"
+#include "control/settings/Settings.h"
+#include "control/shaperecognizer/ShapeRecognizer.h"
+#include "control/tools/SnapToGridInputHandler.h"
+#include "model/Document.h"
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+#include "undo/GroupUndoAction.h"
+#include "undo/RecognizerUndoAction.h"
+#include "util/i18n.h"
+
+#include "Executor.h"
+
+BeautifyJob::BeautifyJob(Control* control, std::vector<Element*> selected, PageRef page):
+        BlockingJob(control, _("Beautify")), selected(std::move(selected)), page(std::move(page)) {}
+
+BeautifyJob::~BeautifyJob() = default;
+
+void BeautifyJob::collectStrokes() {
+    auto addStrokes = [this](const PageRef& page, Layer* layer, auto&& filter) {
+        for (Element* e: layer->getElements()) {
+            if (e->getType() != ELEMENT_STROKE || !filter(e)) {
+                continue;
+            }
+            auto* stroke = dynamic_cast<Stroke*>(e);
+            if (stroke->getToolType() != STROKE_TOOL_ERASER) {
+                this->shapes.push_back({page, layer, stroke, nullptr});
+            }
+        }
+    };
+
+    if (this->selected.empty()) {
+        if (this->page) {
+            for (Layer* layer: *this->page->getLayers()) {
+                addStrokes(this->page, layer, [](Element*) { return true; });
+            }
+        }
+        return;
+    }
+
+    // A cleared selection is put in the selected layer of the page it was dropped on
+    std::unordered_set<Element*> elements(this->selected.begin(), this->selected.end());
+    Document* doc = control->getDocument();
+    for (size_t i = 0; i < doc->getPageCount() && !elements.empty(); i++) {
+        PageRef p = doc->getPage(i);
+        for (Layer* layer: *p->getLayers()) {
+            addStrokes(p, layer, [&elements](Element* e) { return elements.erase(e) > 0; });
+        }
+    }
+}
+
+void BeautifyJob::run() {
+    Document* doc = control->getDocument();
+    doc->lock();
+    collectStrokes();
+    control->setMaximumState(static_cast<int>(this->shapes.size()));
+
+    // The points of a stroke are unpacked by the task recognizing it, with the document locked
+    std::atomic<int> done{0};
+    TaskGroup tasks(JOB_PRIORITY_NONE, &this->cancelled);
+    tasks.forEach(this->shapes.size(), [this, &done](size_t i) {
+        Shape& s = this->shapes[i];
+        ShapeRecognizer reco;
+        if (Stroke* shape = reco.recognizePatterns(s.stroke)) {
+            // As StrokeHandler::strokeRecognizerDetected()
+            shape->setWidth(s.stroke->hasPressure() ? s.stroke->getAvgPressure() : s.stroke->getWidth());
+            s.shape.reset(shape);
+        }
+        int count = ++done;
+        if (count % 64 == 0) {
+            control->setCurrentState(count);
+        }
+    });
+    try {
+        tasks.join();
+    } catch (const std::exception& e) {
+        g_warning("Beautify: %s", e.what());
+    }
+    doc->unlock();
+
+    callAfterRun();
+}
+
+void BeautifyJob::afterRun() {
+    auto undo = std::make_unique<GroupUndoAction>();
+    size_t recognized = 0;
+
+    SnapToGridInputHandler snappingHandler(control->getSettings());
+    bool snap = control->getSettings()->getSnapRecognizedShapesEnabled();
+
+    Document* doc = control->getDocument();
+    doc->lock();
+    for (Shape& s: this->shapes) {
+        if (!s.shape) {
+            continue;
+        }
+        Element::Index pos = s.layer->indexOf(s.stroke);
+        if (pos == Element::InvalidIndex) {
+            continue;
+        }
+        if (snap) {
+            snappingHandler.snapShapeToGrid(s.shape.get());
+        }
+
+        Stroke* shape = s.shape.release();
+        s.layer->removeElement(s.stroke, false);
+        s.layer->insertElement(shape, pos);
+        s.page->fireElementChanged(s.stroke);
+        s.page->fireElementChanged(shape);
+        undo->addAction(std::make_unique<RecognizerUndoAction>(s.page, s.layer, s.stroke, shape));
+        recognized++;
+    }
+    doc->unlock();
+
+    if (recognized > 0) {
+        control->getUndoRedoHandler()->addUndoAction(std::move(undo));
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * Xournal++
+ *
+ * Runs the shape recognizer over the strokes of a selection or a page
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "model/PageRef.h"
+
+#include "BlockingJob.h"
+
+class Element;
+class Layer;
+class Stroke;
+
+/**
+ * @brief Replaces the strokes of a selection, or of all the layers of a page, by the shapes the ShapeRecognizer finds
+ * in them
+ *
+ * The strokes are recognized in parallel on the Executor, each with its own recognizer as when they are drawn. The
+ * shapes then replace the strokes at their position in their layer on the UI thread, as one undo action.
+ */
+class BeautifyJob: public BlockingJob {
+public:
+    /**
+     * @param selected The elements of the selection, once the selection is cleared. Empty for the whole page.
+     * @param page The page to beautify if there is no selection
+     */
+    BeautifyJob(Control* control, std::vector<Element*> selected, PageRef page);
+
+protected:
+    ~BeautifyJob() override;
+
+public:
+    void run() override;
+    void afterRun() override;
+
+private:
+    struct Shape {
+        PageRef page;
+        Layer* layer;
+        Stroke* stroke;
+
+        /**
+         * The recognized shape, nullptr if none
+         */
+        std::unique_ptr<Stroke> shape;
+    };
+
+    /**
+     * Find the strokes to recognize. Must be called with the document locked.
+     */
+    void collectStrokes();
+
+private:
+    std::vector<Element*> selected;
+    PageRef page;
+
+    std::vector<Shape> shapes;
+};
@@ -22,6 +22,10 @@ CustomExportJob::CustomExportJob(Control* control): BaseExportJob(control, _("Cu
     filters[_("PDF files")] = new ExportType(".pdf");
     filters[_("PNG graphics")] = new ExportType(".png");
     filters[_("SVG graphics")] = new ExportType(".svg");
+    filters[_("JPEG graphics")] = new ExportType(".jpg");
+    if (ImageExport::isFormatAvailable(EXPORT_GRAPHICS_WEBP)) {
+        filters[_("WebP graphics")] = new ExportType(".webp");
+    }
     filters[_("Xournal (Compatibility)")] = new ExportType(".xoj");
 }
 
@@ -70,9 +74,13 @@ auto CustomExportJob::showFilechooser() -> bool {
         format = EXPORT_GRAPHICS_PDF;
     } else if (filepath.extension() == ".svg") {
         dlg.removeQualitySetting();
+        dlg.showStrokeSimplification();
         format = EXPORT_GRAPHICS_SVG;
-    } else if (filepath.extension() == ".png") {
-        format = EXPORT_GRAPHICS_PNG;
+    } else {
+        format = ImageExport::getFormatForExtension(filepath);
+        if (format == EXPORT_GRAPHICS_JPEG || format == EXPORT_GRAPHICS_WEBP) {
+            dlg.showCompressionQuality();
+        }
     }
 
     dlg.initPages(control->getCurrentPageNo() + 1, doc->getPageCount());
@@ -86,38 +94,59 @@ auto CustomExportJob::showFilechooser() -> bool {
 
     exportRange = dlg.getRange();
     progressiveMode = dlg.progressiveMode();
+    simplifyStrokes = dlg.simplifyStrokes();
     exportBackground = dlg.getBackgroundType();
 
-    if (format == EXPORT_GRAPHICS_PNG) {
+    if (ImageExport::isRasterFormat(format)) {
         pngQualityParameter = dlg.getPngQualityParameter();
+        compressionQuality = dlg.getCompressionQuality();
     }
 
     doc->unlock();
     return true;
 }
 
+auto CustomExportJob::canRunInBackground() const -> bool {
+    // The .xoj export loads the overwritten layers from the document itself
+    return !exportTypeXoj;
+}
+
 /**
  * Create one Graphics file per page
  */
-void CustomExportJob::exportGraphics() {
-    ImageExport imgExport(control->getDocument(), filepath, format, exportBackground, exportRange);
-    if (format == EXPORT_GRAPHICS_PNG) {
+void CustomExportJob::exportGraphics(Document* doc) {
+    ImageExport imgExport(doc, filepath, format, exportBackground, exportRange);
+    if (ImageExport::isRasterFormat(format)) {
         imgExport.setQualityParameter(pngQualityParameter);
+        imgExport.setCompressionQuality(compressionQuality);
     }
-    imgExport.exportGraphics(control);
+    // The document is a snapshot, no one else accesses its pages
+    imgExport.setThreadCount(0);
+    if (simplifyStrokes) {
+        imgExport.setStrokeTolerance(ImageExport::SVG_STROKE_TOLERANCE);
+    }
+    imgExport.exportGraphics(this);
     errorMsg = imgExport.getLastErrorMsg();
 }
 
 void CustomExportJob::run() {
     if (exportTypeXoj) {
         SaveJob::updatePreview(control);
-        Document* doc = this->control->getDocument();
+    }
+
+    // The document is exported from a snapshot, so that it can be edited in the meantime
+    Document* doc = this->control->getDocument();
+    XojExportHandler h;
+    if (exportTypeXoj) {
+        h.loadOverwrittenLayers(doc, filepath);
+    }
+    doc->lock();
+    std::unique_ptr<Document> snapshot = doc->snapshot();
+    doc->unlock();
 
-        XojExportHandler h;
-        doc->lock();
-        h.prepareSave(doc);
+    if (exportTypeXoj) {
+        h.prepareSave(snapshot.get());
         h.saveTo(filepath, this->control);
-        doc->unlock();
 
         if (!h.getErrorMessage().empty()) {
             this->lastError = FS(_F("Save file error: {1}") % h.getErrorMessage());
@@ -125,24 +154,33 @@ void CustomExportJob::run() {
             callAfterRun();
         }
     } else if (format == EXPORT_GRAPHICS_PDF) {
-        // don't lock the page here for the whole flow, else we get a dead lock...
-        // the ui is blocked, so there should be no changes...
-        Document* doc = control->getDocument();
-
-        std::unique_ptr<XojPdfExport> pdfe = XojPdfExportFactory::createExport(doc, control);
+        std::unique_ptr<XojPdfExport> pdfe = XojPdfExportFactory::createExport(snapshot.get(), this);
 
         pdfe->setExportBackground(exportBackground);
+        pdfe->setStreaming(true);
 
         if (!pdfe->createPdf(this->filepath, exportRange, progressiveMode)) {
             this->errorMsg = pdfe->getLastError();
         }
 
     } else {
-        exportGraphics();
+        exportGraphics(snapshot.get());
+    }
+
+    if (isCancelled()) {
+        // A truncated PDF would look complete at first sight, the image files of the exported pages are kept
+        this->errorMsg.clear();
+        if (format == EXPORT_GRAPHICS_PDF) {
+            std::error_code ec;
+            fs::remove(this->filepath, ec);
+        }
+    } else if (!this->errorMsg.empty() && !this->background) {
+        callAfterRun();
     }
 }
 
 void CustomExportJob::afterRun() {
+    BaseExportJob::afterRun();
     if (!this->lastError.empty()) {
         XojMsgBox::showErrorToUser(control->getGtkWindow(), this->lastError);
     }
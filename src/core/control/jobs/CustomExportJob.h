@@ -33,6 +33,7 @@ public:
 
 public:
     bool showFilechooser() override;
+    bool canRunInBackground() const override;
 
 protected:
     void afterRun() override;
@@ -42,7 +43,7 @@ protected:
     /**
      * Create one Graphics file per page
      */
-    void exportGraphics();
+    void exportGraphics(Document* doc);
 
     bool testAndSetFilepath(fs::path file) override;
 
@@ -57,6 +58,11 @@ private:
      */
     RasterImageQualityParameter pngQualityParameter = RasterImageQualityParameter();
 
+    /**
+     * @brief Quality of the JPEG and WebP compression
+     */
+    int compressionQuality = ImageExport::DEFAULT_COMPRESSION_QUALITY;
+
     /**
      * Export graphics format
      */
@@ -77,6 +83,11 @@ private:
      */
     bool progressiveMode = false;
 
+    /**
+     * Simplify the strokes of the SVG export
+     */
+    bool simplifyStrokes = false;
+
     std::string lastError;
 
     std::string chosenFilterName;
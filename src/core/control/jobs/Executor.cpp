@@ -0,0 +1,210 @@
+#include "Executor.h"
+
+#include <algorithm>
+#include <utility>
+
+/**
+ * The executor and the queues of the current thread, if it is a thread of an executor
+ */
+static thread_local Executor* currentExecutor = nullptr;
+static thread_local size_t currentWorker = 0;
+
+Executor::Executor(unsigned int threadCount) {
+    // Keep one core for the UI thread, like the Scheduler
+    unsigned int count = threadCount == 0 ? std::max(std::thread::hardware_concurrency(), 2U) - 1 : threadCount;
+    this->threadCount = std::clamp(count, 1U, MAX_THREADS);
+    for (unsigned int i = 0; i < this->threadCount; i++) { this->workers.push_back(std::make_unique<Worker>()); }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(this->idleMutex);
+        this->stopping = true;
+    }
+    this->taskAdded.notify_all();
+
+    for (std::thread& thread: this->threads) { thread.join(); }
+}
+
+auto Executor::getInstance() -> Executor& {
+    static Executor instance;
+    return instance;
+}
+
+auto Executor::getThreadCount() const -> unsigned int { return this->threadCount; }
+
+void Executor::startThreads() {
+    for (size_t i = 0; i < this->workers.size(); i++) { this->threads.emplace_back(&Executor::workerLoop, this, i); }
+}
+
+void Executor::push(Task task, JobPriority priority) {
+    std::call_once(this->started, &Executor::startThreads, this);
+
+    // A thread of the executor keeps its tasks, the others spread theirs
+    size_t index = currentExecutor == this ? currentWorker : this->nextWorker++ % this->workers.size();
+    this->queued++;
+    {
+        Worker& worker = *this->workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[priority].push_back(std::move(task));
+    }
+    {
+        // The idle threads check the count with the lock held
+        std::lock_guard<std::mutex> lock(this->idleMutex);
+    }
+    this->taskAdded.notify_one();
+}
+
+auto Executor::pop(size_t self, TaskGroup* group, Task& task) -> bool {
+    const size_t count = this->workers.size();
+    for (int priority = JOB_PRIORITY_URGENT; priority < JOB_N_PRIORITIES; priority++) {
+        for (size_t k = 0; k < count; k++) {
+            Worker& worker = *this->workers[(self + k) % count];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            std::deque<Task>& queue = worker.queues[priority];
+            if (queue.empty()) {
+                continue;
+            }
+
+            if (group == nullptr) {
+                // The own tasks are the most recent ones, the stolen ones the oldest (and likely the largest)
+                if (k == 0) {
+                    task = std::move(queue.back());
+                    queue.pop_back();
+                } else {
+                    task = std::move(queue.front());
+                    queue.pop_front();
+                }
+                this->queued--;
+                return true;
+            }
+
+            auto it = std::find_if(queue.rbegin(), queue.rend(), [group](const Task& t) { return t.group == group; });
+            if (it != queue.rend()) {
+                task = std::move(*it);
+                queue.erase(std::next(it).base());
+                this->queued--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Executor::workerLoop(size_t index) {
+    currentExecutor = this;
+    currentWorker = index;
+
+    while (true) {
+        Task task;
+        if (pop(index, nullptr, task)) {
+            task.group->runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(this->idleMutex);
+        this->taskAdded.wait(lock, [this]() { return this->stopping || this->queued > 0; });
+        if (this->stopping) {
+            return;
+        }
+    }
+}
+
+TaskGroup::TaskGroup(JobPriority priority, const std::atomic<bool>* cancelled, Executor& executor):
+        executor(executor), priority(priority), externalCancel(cancelled) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        join();
+    } catch (...) {
+        // The exception was not asked for
+    }
+}
+
+void TaskGroup::fork(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pending++;
+        this->queued++;
+    }
+    this->executor.push({this, std::move(task)}, this->priority);
+    {
+        // A join may wait for the tasks forked by a running task
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->changed.notify_all();
+    }
+}
+
+void TaskGroup::forEach(size_t count, const std::function<void(size_t)>& f) {
+    if (count == 0) {
+        return;
+    }
+    // A few tasks per thread, so that the threads which finish first steal the remaining ones
+    const size_t chunk = std::max<size_t>(1, count / (4 * this->executor.getThreadCount()));
+    auto body = std::make_shared<std::function<void(size_t)>>(f);
+    for (size_t start = 0; start < count; start += chunk) {
+        size_t end = std::min(start + chunk, count);
+        fork([this, body, start, end]() {
+            for (size_t i = start; i < end && !isCancelled(); i++) { (*body)(i); }
+        });
+    }
+}
+
+void TaskGroup::join() {
+    size_t self = currentExecutor == &this->executor ? currentWorker : 0;
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (this->pending > 0) {
+        if (this->queued == 0) {
+            // Only running tasks are left, they may fork more
+            this->changed.wait(lock, [this]() { return this->pending == 0 || this->queued > 0; });
+            continue;
+        }
+
+        lock.unlock();
+        Executor::Task task;
+        if (this->executor.pop(self, this, task)) {
+            runTask(task);
+        } else {
+            // Being pushed, or taken by another thread
+            std::this_thread::yield();
+        }
+        lock.lock();
+    }
+
+    if (this->error) {
+        std::exception_ptr error = std::exchange(this->error, nullptr);
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskGroup::cancel() { this->cancelled = true; }
+
+auto TaskGroup::isCancelled() const -> bool {
+    return this->cancelled || (this->externalCancel != nullptr && *this->externalCancel);
+}
+
+void TaskGroup::runTask(Executor::Task& task) {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->queued--;
+    }
+
+    if (!isCancelled()) {
+        try {
+            task.run();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (!this->error) {
+                this->error = std::current_exception();
+            }
+            this->cancelled = true;
+        }
+    }
+    // Destroy the captures before the group may be
+    task.run = nullptr;
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->pending--;
+    // Notified with the lock held: the group may be destroyed as soon as it is released
+    this->changed.notify_all();
+}
@@ -0,0 +1,174 @@
+/*
+ * Xournal++
+ *
+ * Work-stealing threads for the parallel parts of the jobs
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Scheduler.h"
+
+class TaskGroup;
+
+/**
+ * @brief Threads running the tasks forked by the jobs, e.g. the pages of an export or the pages of a search
+ *
+ * The Scheduler runs one Job per worker; a job which can split its work forks tasks in a TaskGroup and joins them. Each
+ * thread of the executor has its own queues: the tasks it forks are pushed to its back and popped from there, the idle
+ * threads steal from the front of the queues of the others, so that the large tasks forked first are split further by
+ * the thieves. The tasks forked from other threads are spread over the queues.
+ *
+ * The queues are kept per JobPriority: the tasks forked by a job rendering the visible pages go before those of an
+ * export. The thread joining a group runs the queued tasks of its group itself, so a join never waits for a queued task
+ * and a Scheduler worker may join from a job.
+ *
+ * Process wide, the threads are started by the first fork. Thread safe.
+ */
+class Executor {
+public:
+    /**
+     * @param threadCount Number of threads, 0 to keep one core for the UI thread
+     */
+    explicit Executor(unsigned int threadCount = 0);
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    static Executor& getInstance();
+
+public:
+    unsigned int getThreadCount() const;
+
+    static constexpr unsigned int MAX_THREADS = 16;
+
+private:
+    struct Task {
+        TaskGroup* group;
+        std::function<void()> run;
+    };
+
+    /**
+     * The queues of a thread, by priority. Tasks are pushed to and popped from the back by their thread, and stolen
+     * from the front.
+     */
+    struct Worker {
+        std::mutex mutex;
+        std::array<std::deque<Task>, JOB_N_PRIORITIES> queues;
+    };
+
+    void push(Task task, JobPriority priority);
+
+    /**
+     * Pops a task of the thread, or steals one, the highest priority first
+     * @param group Only a task of this group, if not nullptr
+     */
+    bool pop(size_t self, TaskGroup* group, Task& task);
+
+    void workerLoop(size_t index);
+
+    void startThreads();
+
+private:
+    unsigned int threadCount;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::once_flag started;
+
+    /**
+     * Number of queued tasks, the idle threads wait for it to become positive
+     */
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> nextWorker{0};
+
+    std::mutex idleMutex;
+    std::condition_variable taskAdded;
+    bool stopping = false;
+
+    friend class TaskGroup;
+};
+
+/**
+ * @brief Tasks forked together and joined, e.g. by a Job
+ *
+ * A task may fork more tasks into its group. The exception thrown by a task first is rethrown by join(), the remaining
+ * tasks are then skipped as if the group was cancelled.
+ */
+class TaskGroup {
+public:
+    /**
+     * @param priority Priority of the tasks, usually the one of the Job forking them
+     * @param cancelled Skips the tasks not yet started once it is true, e.g. the flag of a Job (see Job::cancel())
+     */
+    explicit TaskGroup(JobPriority priority = JOB_PRIORITY_NONE, const std::atomic<bool>* cancelled = nullptr,
+                       Executor& executor = Executor::getInstance());
+
+    /**
+     * Joins the tasks, without rethrowing their exception
+     */
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+public:
+    void fork(std::function<void()> task);
+
+    /**
+     * Forks tasks calling f(i) for each i in [0, count), a few calls per task
+     */
+    void forEach(size_t count, const std::function<void(size_t)>& f);
+
+    /**
+     * Runs the queued tasks of the group and waits for the running ones. Rethrows the first exception of a task.
+     */
+    void join();
+
+    /**
+     * The tasks not yet started are skipped
+     */
+    void cancel();
+
+    /**
+     * @return true once cancelled, for the running tasks to stop early
+     */
+    bool isCancelled() const;
+
+private:
+    void runTask(Executor::Task& task);
+
+private:
+    Executor& executor;
+    JobPriority priority;
+    const std::atomic<bool>* externalCancel;
+    std::atomic<bool> cancelled{false};
+
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    /**
+     * Forked tasks which did not return yet, and those of them still in a queue
+     */
+    size_t pending = 0;
+    size_t queued = 0;
+    std::exception_ptr error;
+
+    friend class Executor;
+};
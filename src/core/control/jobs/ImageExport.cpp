@@ -1,18 +1,32 @@
 #include "ImageExport.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <utility>
+#include <vector>
 
 #include <cairo-svg.h>
 
+#include "control/PdfCache.h"
+#include "control/tools/StrokeDecimator.h"
 #include "model/Document.h"
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include "util/ParallelLoop.h"
+#include "util/PngWriter.h"
+#include "util/SurfacePool.h"
 #include "util/Util.h"
 #include "util/i18n.h"
+#include "util/pixbuf-utils.h"
 
 #include "ProgressListener.h"
 
 using std::string;
+using xoj::util::PngWriter;
+using xoj::util::SurfacePool;
 
 
 ImageExport::ImageExport(Document* doc, fs::path file, ExportGraphicsFormat format,
@@ -36,14 +50,136 @@ void ImageExport::setQualityParameter(ExportQualityCriterion criterion, int valu
     this->qualityParameter = RasterImageQualityParameter(criterion, value);
 }
 
+void ImageExport::setThreadCount(unsigned int threads) { this->threads = threads; }
+
+void ImageExport::setStrokeTolerance(double tolerance) { this->strokeTolerance = tolerance; }
+
+void ImageExport::setPdfCache(PdfCache* cache) { this->pdfCache = cache; }
+
+void ImageExport::setCompressionQuality(int quality) { this->compressionQuality = std::clamp(quality, 1, 100); }
+
+auto ImageExport::getFormatForExtension(const fs::path& file) -> ExportGraphicsFormat {
+    std::string ext = file.extension().u8string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return g_ascii_tolower(c); });
+    if (ext == ".png") {
+        return EXPORT_GRAPHICS_PNG;
+    }
+    if (ext == ".svg") {
+        return EXPORT_GRAPHICS_SVG;
+    }
+    if (ext == ".jpg" || ext == ".jpeg") {
+        return EXPORT_GRAPHICS_JPEG;
+    }
+    if (ext == ".webp") {
+        return EXPORT_GRAPHICS_WEBP;
+    }
+    return EXPORT_GRAPHICS_UNDEFINED;
+}
+
+auto ImageExport::isRasterFormat(ExportGraphicsFormat format) -> bool {
+    return format == EXPORT_GRAPHICS_PNG || format == EXPORT_GRAPHICS_JPEG || format == EXPORT_GRAPHICS_WEBP;
+}
+
+/**
+ * @return The name of the GdkPixbuf writer of the format, nullptr if the export does not use GdkPixbuf
+ */
+static auto getPixbufType(ExportGraphicsFormat format) -> const char* {
+    switch (format) {
+        case EXPORT_GRAPHICS_JPEG:
+            return "jpeg";
+        case EXPORT_GRAPHICS_WEBP:
+            return "webp";
+        default:
+            return nullptr;
+    }
+}
+
+auto ImageExport::isFormatAvailable(ExportGraphicsFormat format) -> bool {
+    const char* type = getPixbufType(format);
+    if (type == nullptr) {
+        return format != EXPORT_GRAPHICS_UNDEFINED;
+    }
+
+    bool available = false;
+    GSList* formats = gdk_pixbuf_get_formats();
+    for (GSList* f = formats; f != nullptr && !available; f = f->next) {
+        auto* pixbufFormat = static_cast<GdkPixbufFormat*>(f->data);
+        gchar* name = gdk_pixbuf_format_get_name(pixbufFormat);
+        available = strcmp(name, type) == 0 && gdk_pixbuf_format_is_writable(pixbufFormat);
+        g_free(name);
+    }
+    g_slist_free(formats);
+    return available;
+}
+
+/**
+ * @brief Keep the points of the stroke as StrokeHandler does while it is drawn with the same tolerance
+ */
+static void simplifyStroke(Stroke* stroke, double tolerance) {
+    const std::vector<Point>& points = stroke->getPointVector();
+    if (points.size() < 3) {
+        return;
+    }
+
+    StrokeDecimator decimator(tolerance);
+    const bool pressure = stroke->hasPressure();
+    std::vector<Point> kept{points.front()};
+    kept.reserve(points.size());
+    for (size_t i = 1; i < points.size(); i++) {
+        // The z of a point is the width of the segment from it
+        const bool replaced =
+                kept.size() >= 2 && decimator.replacesLast(kept[kept.size() - 2], kept.back(), points[i],
+                                                           pressure ? kept.back().z - kept[kept.size() - 2].z : 0.0);
+        if (replaced) {
+            kept.back() = points[i];
+        } else {
+            kept.push_back(points[i]);
+            decimator.reset();
+        }
+    }
+    if (kept.size() < points.size()) {
+        stroke->setPointVector(std::move(kept));
+    }
+}
+
 /**
  * @brief Get the last error message
  * @return The last error message to show to the user
  */
-auto ImageExport::getLastErrorMsg() const -> string { return lastError; }
+auto ImageExport::getLastErrorMsg() const -> string {
+    std::lock_guard<std::mutex> lock(this->errorMutex);
+    return lastError;
+}
+
+void ImageExport::setLastError(std::string msg) {
+    std::lock_guard<std::mutex> lock(this->errorMutex);
+    this->lastError = std::move(msg);
+}
+
+auto ImageExport::getPngSize(double width, double height, double zoomRatio, int& pixelWidth, int& pixelHeight)
+        -> double {
+    switch (this->qualityParameter.getQualityCriterion()) {
+        case EXPORT_QUALITY_WIDTH:
+            zoomRatio = ((double)this->qualityParameter.getValue()) / width;
+            pixelWidth = this->qualityParameter.getValue();
+            pixelHeight = (int)std::round(height * zoomRatio);
+            break;
+        case EXPORT_QUALITY_HEIGHT:
+            zoomRatio = ((double)this->qualityParameter.getValue()) / height;
+            pixelWidth = (int)std::round(width * zoomRatio);
+            pixelHeight = this->qualityParameter.getValue();
+            break;
+        case EXPORT_QUALITY_DPI:  // Use the zoomRatio given as argument
+            pixelWidth = (int)std::round(width * zoomRatio);
+            pixelHeight = (int)std::round(height * zoomRatio);
+            break;
+    }
+    return zoomRatio;
+}
 
 /**
  * @brief Create Cairo surface for a given page
+ * @param target the surface to create
  * @param width the width of the page being exported
  * @param height the height of the page being exported
  * @param id the id of the page being exported
@@ -54,35 +190,33 @@ auto ImageExport::getLastErrorMsg() const -> string { return lastError; }
  * height (in pixels). In this case, the zoomRatio (and the DPI) is page-dependent as soon as the document has pages of
  * different sizes.
  */
-auto ImageExport::createSurface(double width, double height, size_t id, double zoomRatio) -> double {
+auto ImageExport::createSurface(Target& target, double width, double height, size_t id, double zoomRatio) -> double {
     switch (this->format) {
         case EXPORT_GRAPHICS_PNG:
-            switch (this->qualityParameter.getQualityCriterion()) {
-                case EXPORT_QUALITY_WIDTH:
-                    zoomRatio = ((double)this->qualityParameter.getValue()) / width;
-                    this->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, this->qualityParameter.getValue(),
-                                                               (int)std::round(height * zoomRatio));
-                    break;
-                case EXPORT_QUALITY_HEIGHT:
-                    zoomRatio = ((double)this->qualityParameter.getValue()) / height;
-                    this->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, (int)std::round(width * zoomRatio),
-                                                               this->qualityParameter.getValue());
-                    break;
-                case EXPORT_QUALITY_DPI:  // Use the zoomRatio given as argument
-                    this->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, (int)std::round(width * zoomRatio),
-                                                               (int)std::round(height * zoomRatio));
-                    break;
+        case EXPORT_GRAPHICS_JPEG:
+        case EXPORT_GRAPHICS_WEBP: {
+            int pixelWidth = 0;
+            int pixelHeight = 0;
+            zoomRatio = getPngSize(width, height, zoomRatio, pixelWidth, pixelHeight);
+            // JPEG has no transparency: the pages are on white
+            const bool opaque = this->format == EXPORT_GRAPHICS_JPEG;
+            target.surface = SurfacePool::createSurface(opaque ? CAIRO_FORMAT_RGB24 : CAIRO_FORMAT_ARGB32, pixelWidth,
+                                                       pixelHeight);
+            target.cr = cairo_create(target.surface);
+            if (opaque) {
+                cairo_set_source_rgb(target.cr, 1, 1, 1);
+                cairo_paint(target.cr);
             }
-            this->cr = cairo_create(this->surface);
-            cairo_scale(this->cr, zoomRatio, zoomRatio);
+            cairo_scale(target.cr, zoomRatio, zoomRatio);
             return zoomRatio;
+        }
         case EXPORT_GRAPHICS_SVG:
-            this->surface = cairo_svg_surface_create(getFilenameWithNumber(id).u8string().c_str(), width, height);
-            cairo_svg_surface_restrict_to_version(this->surface, CAIRO_SVG_VERSION_1_2);
-            this->cr = cairo_create(this->surface);
+            target.surface = cairo_svg_surface_create(getFilenameWithNumber(id).u8string().c_str(), width, height);
+            cairo_svg_surface_restrict_to_version(target.surface, CAIRO_SVG_VERSION_1_2);
+            target.cr = cairo_create(target.surface);
             break;
         default:
-            this->lastError = _("Unsupported graphics format: ") + std::to_string(this->format);
+            setLastError(_("Unsupported graphics format: ") + std::to_string(this->format));
     }
     return 0.0;
 }
@@ -90,18 +224,42 @@ auto ImageExport::createSurface(double width, double height, size_t id, double z
 /**
  * Free / store the surface
  */
-auto ImageExport::freeSurface(size_t id) -> bool {
-    cairo_destroy(this->cr);
+auto ImageExport::freeSurface(Target& target, size_t id) -> bool {
+    cairo_destroy(target.cr);
 
     cairo_status_t status = CAIRO_STATUS_SUCCESS;
+    bool saved = true;
     if (format == EXPORT_GRAPHICS_PNG) {
         auto filepath = getFilenameWithNumber(id);
-        status = cairo_surface_write_to_png(surface, filepath.u8string().c_str());
+        status = cairo_surface_write_to_png(target.surface, filepath.u8string().c_str());
+    } else if (const char* type = getPixbufType(format)) {
+        saved = savePixbuf(target.surface, type, id);
     }
-    cairo_surface_destroy(surface);
+    cairo_surface_destroy(target.surface);
 
     // we ignore this problem
-    return status == CAIRO_STATUS_SUCCESS;
+    return status == CAIRO_STATUS_SUCCESS && saved;
+}
+
+auto ImageExport::savePixbuf(cairo_surface_t* surface, const char* type, size_t id) -> bool {
+    GdkPixbuf* pixbuf = xoj_pixbuf_get_from_surface(surface, 0, 0, cairo_image_surface_get_width(surface),
+                                                    cairo_image_surface_get_height(surface));
+    if (pixbuf == nullptr) {
+        return false;
+    }
+
+    const std::string quality = std::to_string(this->compressionQuality);
+    GError* err = nullptr;
+    bool saved = gdk_pixbuf_save(pixbuf, getFilenameWithNumber(id).u8string().c_str(), type, &err, "quality",
+                                 quality.c_str(), nullptr);
+    if (err) {
+        setLastError(FS(_F("Error saving the image: {1}") % err->message));
+        g_error_free(err);
+    } else if (!saved) {
+        setLastError(_("Error save image #2"));
+    }
+    g_object_unref(pixbuf);
+    return saved;
 }
 
 /**
@@ -138,32 +296,107 @@ void ImageExport::exportImagePage(size_t pageId, size_t id, double zoomRatio, Ex
     PageRef page = doc->getPage(pageId);
     doc->unlock();
 
-    zoomRatio = createSurface(page->getWidth(), page->getHeight(), id, zoomRatio);
+    if (format == EXPORT_GRAPHICS_SVG && this->strokeTolerance > 0) {
+        // Each page is exported by a single thread
+        for (Layer* layer: *page->getLayers()) {
+            for (Element* e: layer->getElements()) {
+                if (e->getType() == ELEMENT_STROKE) {
+                    simplifyStroke(static_cast<Stroke*>(e), this->strokeTolerance);
+                }
+            }
+        }
+    }
+
+    // The other raster formats have smaller size limits than the surfaces anyway
+    if (format == EXPORT_GRAPHICS_PNG) {
+        int pixelWidth = 0;
+        int pixelHeight = 0;
+        double ratio = getPngSize(page->getWidth(), page->getHeight(), zoomRatio, pixelWidth, pixelHeight);
+        if (pixelWidth > MAX_SURFACE_SIZE || pixelHeight > MAX_SURFACE_SIZE ||
+            static_cast<size_t>(pixelWidth) * static_cast<size_t>(pixelHeight) * 4 > MAX_SURFACE_BYTES) {
+            exportTiledPngPage(page, id, ratio, pixelWidth, pixelHeight, view);
+            return;
+        }
+    }
+
+    Target target;
+    zoomRatio = createSurface(target, page->getWidth(), page->getHeight(), id, zoomRatio);
+    if (target.surface == nullptr) {
+        return;
+    }
 
-    cairo_status_t state = cairo_surface_status(this->surface);
+    cairo_status_t state = cairo_surface_status(target.surface);
     if (state != CAIRO_STATUS_SUCCESS) {
-        this->lastError = _("Error save image #1");
+        setLastError(_("Error save image #1"));
+        cairo_destroy(target.cr);
+        cairo_surface_destroy(target.surface);
         return;
     }
 
+    drawPage(page, target.cr, zoomRatio, isRasterFormat(format), view);
+
+    if (!freeSurface(target, id)) {
+        // could not create this file... GdkPixbuf gives its own error
+        if (getPixbufType(format) == nullptr) {
+            setLastError(_("Error save image #2"));
+        }
+        return;
+    }
+}
+
+void ImageExport::drawPage(const PageRef& page, cairo_t* cr, double zoomRatio, bool usePdfCache, DocumentView& view) {
     if (page->getBackgroundType().isPdfPage() && (exportBackground != EXPORT_BACKGROUND_NONE)) {
         auto pgNo = page->getPdfPageNr();
         XojPdfPageSPtr popplerPage = doc->getPdfPage(pgNo);
         if (!popplerPage) {
-            this->lastError = _("Error while exporting the pdf background: I cannot find the pdf page number ");
-            this->lastError += std::to_string(pgNo);
+            setLastError(_("Error while exporting the pdf background: I cannot find the pdf page number ") +
+                         std::to_string(pgNo));
+        } else if (this->pdfCache != nullptr && usePdfCache) {
+            this->pdfCache->render(cr, pgNo, zoomRatio, page->getWidth(), page->getHeight());
         } else {
             popplerPage->renderForPrinting(cr);
         }
     }
 
-    view.drawPage(page, this->cr, true /* dont render eraseable */, true /* don't rerender the pdf background */,
+    view.drawPage(page, cr, true /* dont render eraseable */, true /* don't rerender the pdf background */,
                   exportBackground == EXPORT_BACKGROUND_NONE, exportBackground <= EXPORT_BACKGROUND_UNRULED);
+}
 
-    if (!freeSurface(id)) {
-        // could not create this file...
-        this->lastError = _("Error save image #2");
-        return;
+void ImageExport::exportTiledPngPage(const PageRef& page, size_t id, double zoomRatio, int width, int height,
+                                     DocumentView& view) {
+    PngWriter writer(getFilenameWithNumber(id), static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+
+    // The rows of a band are rendered in place, by tiles of at most MAX_SURFACE_SIZE columns: the page may be wider
+    // than a cairo surface
+    const auto rowPixels = static_cast<size_t>(width);
+    const int stride = width * 4;
+    const int bandHeight = static_cast<int>(
+            std::clamp<size_t>(MAX_SURFACE_BYTES / 4 / rowPixels, 1, static_cast<size_t>(MAX_SURFACE_SIZE)));
+    std::vector<uint32_t> band(rowPixels * static_cast<size_t>(std::min(bandHeight, height)));
+
+    bool ok = true;
+    for (int y = 0; y < height && ok; y += bandHeight) {
+        const int rows = std::min(bandHeight, height - y);
+        std::fill(band.begin(), band.end(), 0U);
+        for (int x = 0; x < width && ok; x += MAX_SURFACE_SIZE) {
+            const int columns = std::min(MAX_SURFACE_SIZE, width - x);
+            cairo_surface_t* tile = cairo_image_surface_create_for_data(
+                    reinterpret_cast<unsigned char*>(band.data() + x), CAIRO_FORMAT_ARGB32, columns, rows, stride);
+            cairo_t* cr = cairo_create(tile);
+            cairo_translate(cr, -x, -y);
+            cairo_scale(cr, zoomRatio, zoomRatio);
+            // The PDF cache would render the whole page at once
+            drawPage(page, cr, zoomRatio, false, view);
+            cairo_destroy(cr);
+            cairo_surface_flush(tile);
+            ok = cairo_surface_status(tile) == CAIRO_STATUS_SUCCESS;
+            cairo_surface_destroy(tile);
+        }
+        for (int r = 0; r < rows && ok; r++) { ok = writer.writeRow(band.data() + static_cast<size_t>(r) * rowPixels); }
+    }
+
+    if (!ok || !writer.close()) {
+        setLastError(writer.getLastError().empty() ? _("Error save image #2") : writer.getLastError());
     }
 }
 
@@ -193,25 +426,45 @@ void ImageExport::exportGraphics(ProgressListener* stateListener) {
      * Compute the zoomRatio only once if using DPI as a PNG quality criterion
      */
     double zoomRatio = 1.0;
-    if ((this->format == EXPORT_GRAPHICS_PNG) && (this->qualityParameter.getQualityCriterion() == EXPORT_QUALITY_DPI)) {
+    if (isRasterFormat(this->format) && (this->qualityParameter.getQualityCriterion() == EXPORT_QUALITY_DPI)) {
         zoomRatio = ((double)this->qualityParameter.getValue()) / Util::DPI_NORMALIZATION_FACTOR;
     }
 
-    DocumentView view;
-    int current = 0;
-
+    std::vector<size_t> pages;
+    pages.reserve(selectedCount);
     for (size_t i = 0; i < count; i++) {
-        auto id = i + 1;
-        if (onePage) {
-            id = SINGLE_PAGE;
+        if (selectedPages[i]) {
+            pages.push_back(i);
         }
+    }
 
-        if (selectedPages[i]) {
-            stateListener->setCurrentState(current++);
+    // The pages may end in any order: the progress is the number of pages exported before the first unfinished one
+    std::mutex progressMutex;
+    std::vector<char> done(pages.size(), false);
+    size_t progress = 0;
 
-            exportImagePage(i, id, zoomRatio, format, view);  // Todo(narrowing): remove cast
+    // Each thread exports one page at a time, so that at most one surface per thread is in memory
+    xoj::util::ParallelLoop loop(this->threads);
+    loop.run(pages.size(), [&](size_t n) {
+        if (stateListener->isCancelRequested()) {
+            return;
         }
-    }
+        size_t i = pages[n];
+        auto id = onePage ? SINGLE_PAGE : i + 1;
+
+        DocumentView view;
+        exportImagePage(i, id, zoomRatio, format, view);
+
+        std::lock_guard<std::mutex> lock(progressMutex);
+        done[n] = true;
+        size_t previous = progress;
+        while (progress < done.size() && done[progress]) {
+            progress++;
+        }
+        if (progress != previous) {
+            stateListener->setCurrentState(static_cast<int>(progress));
+        }
+    });
 }
 
 RasterImageQualityParameter::RasterImageQualityParameter() = default;
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <string>
 
 #include <gtk/gtk.h>
@@ -22,9 +23,17 @@
 #include "filesystem.h"
 
 class Document;
+class PdfCache;
 class ProgressListener;
 
-enum ExportGraphicsFormat { EXPORT_GRAPHICS_UNDEFINED, EXPORT_GRAPHICS_PDF, EXPORT_GRAPHICS_PNG, EXPORT_GRAPHICS_SVG };
+enum ExportGraphicsFormat {
+    EXPORT_GRAPHICS_UNDEFINED,
+    EXPORT_GRAPHICS_PDF,
+    EXPORT_GRAPHICS_PNG,
+    EXPORT_GRAPHICS_SVG,
+    EXPORT_GRAPHICS_JPEG,
+    EXPORT_GRAPHICS_WEBP
+};
 
 /**
  * @brief List of available criterion for determining a PNG export quality.
@@ -33,7 +42,7 @@ enum ExportGraphicsFormat { EXPORT_GRAPHICS_UNDEFINED, EXPORT_GRAPHICS_PDF, EXPO
 enum ExportQualityCriterion { EXPORT_QUALITY_DPI, EXPORT_QUALITY_WIDTH, EXPORT_QUALITY_HEIGHT };
 
 /**
- * @brief A class storing the available quality parameters for PNG export
+ * @brief A class storing the available quality parameters for PNG export, also used by the JPEG and WebP exports
  */
 class RasterImageQualityParameter {
 public:
@@ -96,9 +105,67 @@ public:
      */
     void setQualityParameter(ExportQualityCriterion criterion, int value);
 
+    /**
+     * @brief Export several pages at once
+     * @param threads The number of pages rendered and written concurrently, each with its own surface. 0 for the number
+     * of cores, 1 (the default) to export the pages one after another.
+     */
+    void setThreadCount(unsigned int threads);
+
+    /**
+     * @brief Drop the points of the strokes of the SVG pages which deviate less than the tolerance from the simplified
+     * path, see StrokeDecimator. The strokes of the document are changed: only for the export of a snapshot.
+     * @param tolerance In page coordinates, 0 (the default) keeps all the points
+     */
+    void setStrokeTolerance(double tolerance);
+
+    /**
+     * @brief Paint the PDF backgrounds of the PNG pages from a cache of the PDF of the document, e.g. shared by several
+     * exports of documents with the same background (see PdfCache::getShared()). nullptr (the default) renders them.
+     */
+    void setPdfCache(PdfCache* cache);
+
+    /**
+     * @brief Set the quality of the JPEG and WebP compression, from 1 to 100
+     */
+    void setCompressionQuality(int quality);
+
+    /**
+     * @brief Get the format of an image file from its extension: .png, .svg, .jpg, .jpeg or .webp
+     * @return EXPORT_GRAPHICS_UNDEFINED for the other extensions
+     */
+    static ExportGraphicsFormat getFormatForExtension(const fs::path& file);
+
+    /**
+     * @return true for the formats whose pages are rendered to pixels: PNG, JPEG and WebP
+     */
+    static bool isRasterFormat(ExportGraphicsFormat format);
+
+    /**
+     * @return false if the format cannot be written here. JPEG and WebP are written by GdkPixbuf, WebP only if its
+     * WebP module is installed.
+     */
+    static bool isFormatAvailable(ExportGraphicsFormat format);
+
+    static constexpr int DEFAULT_COMPRESSION_QUALITY = 90;
+
+    /**
+     * The tolerance of the simplification of the strokes offered by the export dialog, in points
+     */
+    static constexpr double SVG_STROKE_TOLERANCE = 0.1;
+
 private:
+    /**
+     * @brief The surface a page is exported to
+     */
+    struct Target {
+        cairo_surface_t* surface = nullptr;
+        cairo_t* cr = nullptr;
+    };
+
     /**
      * @brief Create Cairo surface for a given page
+     * @param target the surface to create
      * @param width the width of the page being exported
      * @param height the height of the page being exported
      * @param id the id of the page being exported
@@ -108,12 +175,30 @@ private:
      *          The return value may differ from that of the parameter zoomRatio
      *          if the export has fixed page width or height (in pixels)
      */
-    double createSurface(double width, double height, size_t id, double zoomRatio);
+    double createSurface(Target& target, double width, double height, size_t id, double zoomRatio);
+
+    /**
+     * @brief Get the size in pixels of a PNG page
+     * @param zoomRatio the zoom ratio for PNG exports with fixed DPI
+     * @return the zoom ratio of the page, see createSurface()
+     */
+    double getPngSize(double width, double height, double zoomRatio, int& pixelWidth, int& pixelHeight);
 
     /**
      * Free / store the surface
      */
-    bool freeSurface(size_t id);
+    bool freeSurface(Target& target, size_t id);
+
+    /**
+     * @brief Encode the surface with GdkPixbuf
+     * @param type The name of the GdkPixbuf format, e.g. "jpeg"
+     */
+    bool savePixbuf(cairo_surface_t* surface, const char* type, size_t id);
+
+    /**
+     * @brief Keep the error message to show to the user, from any of the export threads
+     */
+    void setLastError(std::string msg);
 
     /**
      * @brief Get a filename with a (page) number appended
@@ -134,6 +219,33 @@ private:
      */
     void exportImagePage(size_t pageId, size_t id, double zoomRatio, ExportGraphicsFormat format, DocumentView& view);
 
+    /**
+     * @brief Draw the PDF background and the layers of a page
+     * @param usePdfCache Paint the PDF background from pdfCache, if set
+     */
+    void drawPage(const PageRef& page, cairo_t* cr, double zoomRatio, bool usePdfCache, DocumentView& view);
+
+    /**
+     * @brief Export a PNG page too large for a single surface, see MAX_SURFACE_BYTES
+     *
+     * The page is rendered in bands of rows, each band streamed to the file by a PngWriter before the next one is
+     * rendered over it: the memory is bounded by the size of a band whatever the resolution, e.g. for posters.
+     * @param width the width of the image in pixels
+     * @param height the height of the image in pixels
+     */
+    void exportTiledPngPage(const PageRef& page, size_t id, double zoomRatio, int width, int height,
+                            DocumentView& view);
+
+    /**
+     * The largest image surface cairo can create, in pixels
+     */
+    static constexpr int MAX_SURFACE_SIZE = 32767;
+
+    /**
+     * The PNG pages larger than this are exported in bands of this size, see exportTiledPngPage()
+     */
+    static constexpr size_t MAX_SURFACE_BYTES = 256 * 1024 * 1024;
+
     static constexpr size_t SINGLE_PAGE = size_t(-1);
 
 public:
@@ -168,17 +280,32 @@ public:
     RasterImageQualityParameter qualityParameter = RasterImageQualityParameter();
 
     /**
-     * Export surface
+     * Number of pages exported concurrently, see setThreadCount()
      */
-    cairo_surface_t* surface = nullptr;
+    unsigned int threads = 1;
 
     /**
-     * Cairo context
+     * See setStrokeTolerance()
      */
-    cairo_t* cr = nullptr;
+    double strokeTolerance = 0;
+
+    /**
+     * See setPdfCache()
+     */
+    PdfCache* pdfCache = nullptr;
+
+    /**
+     * See setCompressionQuality()
+     */
+    int compressionQuality = DEFAULT_COMPRESSION_QUALITY;
 
     /**
      * The last error message to show to the user
      */
     std::string lastError;
+
+    /**
+     * Protects lastError
+     */
+    mutable std::mutex errorMutex;
 };
@@ -0,0 +1,156 @@
+#include "ImageImportJob.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include "control/Control.h"
+#include "control/settings/PageTemplateSettings.h"
+#include "control/settings/Settings.h"
+#include "model/BackgroundImage.h"
+#include "model/Document.h"
+#include "model/XojPage.h"
+#include "util/XojMsgBox.h"
+#include "util/i18n.h"
+
+#include "Executor.h"
+
+ImageImportJob::ImageImportJob(Control* control, std::vector<fs::path> files, size_t position, bool attach):
+        BlockingJob(control, _("Import Images")), position(position), attach(attach) {
+    this->images.reserve(files.size());
+    for (auto& file: files) {
+        Image image;
+        image.file = std::move(file);
+        this->images.push_back(std::move(image));
+    }
+
+    PageTemplateSettings model;
+    model.parse(control->getSettings()->getPageTemplate());
+    this->pageWidth = model.getPageWidth();
+    this->pageHeight = model.getPageHeight();
+    this->dpi = control->getSettings()->getImageImportDpi();
+}
+
+ImageImportJob::~ImageImportJob() {
+    for (Image& image: this->images) {
+        if (image.pixbuf) {
+            g_object_unref(image.pixbuf);
+        }
+    }
+}
+
+auto ImageImportJob::layout(int width, int height, double pageWidth, double pageHeight, unsigned int dpi) -> Layout {
+    // The template turned like the image, e.g. landscape for a photo taken across the page
+    const double longSide = std::max(pageWidth, pageHeight);
+    const double shortSide = std::min(pageWidth, pageHeight);
+    const bool landscape = width > height;
+    const double boxWidth = landscape ? longSide : shortSide;
+    const double boxHeight = landscape ? shortSide : longSide;
+
+    // In points per pixel
+    const double scale = std::min(boxWidth / width, boxHeight / height);
+
+    Layout result{width * scale, height * scale, 1.0};
+    if (dpi > 0) {
+        result.pixelScale = std::min(1.0, scale * dpi / 72.0);
+    }
+    return result;
+}
+
+void ImageImportJob::decode(Image& image) const {
+    const std::string filename = image.file.u8string();
+    int width = 0;
+    int height = 0;
+    if (!gdk_pixbuf_get_file_info(filename.c_str(), &width, &height) || width <= 0 || height <= 0) {
+        image.error = _("Unknown image format");
+        return;
+    }
+
+    // The size of the stored pixels: the orientation of a photo is applied once it is decoded
+    Layout l = layout(width, height, this->pageWidth, this->pageHeight, this->dpi);
+
+    GError* error = nullptr;
+    GdkPixbuf* pixbuf = nullptr;
+    if (l.pixelScale < 1.0) {
+        // The JPEG loader decodes at a fraction of the size directly
+        pixbuf = gdk_pixbuf_new_from_file_at_scale(filename.c_str(),
+                                                   std::max(1, static_cast<int>(std::ceil(width * l.pixelScale))),
+                                                   std::max(1, static_cast<int>(std::ceil(height * l.pixelScale))),
+                                                   true, &error);
+    } else {
+        pixbuf = gdk_pixbuf_new_from_file(filename.c_str(), &error);
+    }
+    if (!pixbuf) {
+        image.error = error ? error->message : _("Unknown image format");
+        if (error) {
+            g_error_free(error);
+        }
+        return;
+    }
+
+    GdkPixbuf* oriented = gdk_pixbuf_apply_embedded_orientation(pixbuf);
+    if (oriented) {
+        if (gdk_pixbuf_get_width(oriented) != gdk_pixbuf_get_width(pixbuf)) {
+            std::swap(l.pageWidth, l.pageHeight);
+        }
+        g_object_unref(pixbuf);
+        pixbuf = oriented;
+    }
+
+    image.pixbuf = pixbuf;
+    image.pageWidth = l.pageWidth;
+    image.pageHeight = l.pageHeight;
+}
+
+void ImageImportJob::run() {
+    control->setMaximumState(static_cast<int>(this->images.size()));
+
+    std::atomic<int> done{0};
+    TaskGroup tasks(JOB_PRIORITY_NONE, &this->cancelled);
+    tasks.forEach(this->images.size(), [this, &done](size_t i) {
+        decode(this->images[i]);
+        control->setCurrentState(++done);
+    });
+    try {
+        tasks.join();
+    } catch (const std::exception& e) {
+        g_warning("Image import: %s", e.what());
+    }
+
+    callAfterRun();
+}
+
+void ImageImportJob::afterRun() {
+    if (isCancelled()) {
+        return;
+    }
+
+    std::vector<PageRef> pages;
+    pages.reserve(this->images.size());
+    std::string failed;
+    for (Image& image: this->images) {
+        if (!image.pixbuf) {
+            failed += "\n" + image.file.filename().u8string() + ": " + image.error;
+            continue;
+        }
+        BackgroundImage img;
+        img.loadPixbuf(image.pixbuf, image.file);
+        img.setAttach(this->attach);
+
+        auto page = std::make_shared<XojPage>(image.pageWidth, image.pageHeight);
+        page->setBackgroundImage(img);
+        page->setBackgroundType(PageType(PageTypeFormat::Image));
+        pages.push_back(std::move(page));
+    }
+
+    if (!pages.empty()) {
+        control->insertPages(pages, std::min(this->position, control->getDocument()->getPageCount()));
+    }
+    if (!failed.empty()) {
+        XojMsgBox::showErrorToUser(control->getGtkWindow(),
+                                   FS(_F("These images could not be imported:{1}") % failed));
+    }
+}
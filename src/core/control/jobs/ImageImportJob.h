@@ -0,0 +1,92 @@
+/*
+ * Xournal++
+ *
+ * A job which imports images as new pages
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <gtk/gtk.h>
+
+#include "BlockingJob.h"
+#include "filesystem.h"
+
+/**
+ * @brief Appends a page with an image background for each image of a batch, e.g. the scans of a paper notebook
+ *
+ * The images are decoded in parallel on the Executor, at the resolution of the page set by
+ * Settings::getImageImportDpi(), without decoding the full image first where the loader of the format can scale. The
+ * pages are then inserted on the UI thread at once, as one undo action.
+ */
+class ImageImportJob: public BlockingJob {
+public:
+    /**
+     * @param files The images, in the order of the pages
+     * @param position The index of the first new page in the document
+     * @param attach Whether the images are saved in the file, downscaled, or as a reference to their file
+     */
+    ImageImportJob(Control* control, std::vector<fs::path> files, size_t position, bool attach);
+
+protected:
+    ~ImageImportJob() override;
+
+public:
+    void run() override;
+    void afterRun() override;
+
+    struct Layout {
+        double pageWidth;
+        double pageHeight;
+
+        /**
+         * The downscaling of the image to the resolution of the page, 1 if it is not larger
+         */
+        double pixelScale;
+    };
+
+    /**
+     * The page of an image of width x height pixels: the image as large as it fits in a page of the template size,
+     * turned like the image.
+     * @param dpi The resolution of the image on the page, 0 to keep all the pixels
+     */
+    static Layout layout(int width, int height, double pageWidth, double pageHeight, unsigned int dpi);
+
+private:
+    struct Image {
+        fs::path file;
+
+        /**
+         * The decoded image, nullptr if it could not be read
+         */
+        GdkPixbuf* pixbuf = nullptr;
+        double pageWidth = 0;
+        double pageHeight = 0;
+        std::string error;
+    };
+
+    /**
+     * Decodes the image, called by the tasks of the Executor
+     */
+    void decode(Image& image) const;
+
+private:
+    std::vector<Image> images;
+    size_t position;
+    bool attach;
+
+    /**
+     * The page template, read on the UI thread
+     */
+    double pageWidth;
+    double pageHeight;
+    unsigned int dpi;
+};
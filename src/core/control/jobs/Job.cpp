@@ -17,6 +17,7 @@ void Job::ref() {
 }
 
 void Job::deleteJob() {
+    cancel();
     this->onDelete();
 
     if (this->afterRunId) {
@@ -25,6 +26,10 @@ void Job::deleteJob() {
     }
 }
 
+void Job::cancel() { this->cancelled.store(true, std::memory_order_relaxed); }
+
+auto Job::isCancelled() const -> bool { return this->cancelled.load(std::memory_order_relaxed); }
+
 void Job::onDelete() {}
 
 void Job::execute() { this->run(); }
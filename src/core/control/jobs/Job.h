@@ -12,6 +12,7 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 
 enum JobType { JOB_TYPE_BLOCKING, JOB_TYPE_PREVIEW, JOB_TYPE_RENDER, JOB_TYPE_AUTOSAVE };
 
@@ -49,6 +50,13 @@ public:
      */
     void deleteJob();
 
+    /**
+     * Ask the job to stop: a running job checks isCancelled() between its steps, and does not publish its results
+     */
+    void cancel();
+
+    bool isCancelled() const;
+
 public:
     virtual JobType getType() = 0;
 
@@ -86,6 +94,12 @@ protected:
      */
     virtual void onDelete();
 
+protected:
+    /**
+     * Set by cancel(), e.g. passed to DocumentView::setCancellation()
+     */
+    std::atomic<bool> cancelled{false};
+
 private:
     /**
      * Internal callback sent to the GLib main loop which invokes `afterRun`.
@@ -96,4 +110,11 @@ private:
     unsigned int afterRunId = 0;
 
     std::atomic<unsigned int> refCount;
+
+    /**
+     * Set by the Scheduler when the job is queued: its deadline and its waiting time are measured from it
+     */
+    std::chrono::steady_clock::time_point queuedAt;
+
+    friend class Scheduler;
 };
@@ -0,0 +1,223 @@
+#include "LatexRecompileJob.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <variant>
+
+#include <glib.h>
+
+#include "control/Control.h"
+#include "model/Document.h"
+#include "model/Layer.h"
+#include "model/TexImage.h"
+#include "model/XojPage.h"
+#include "undo/DeleteUndoAction.h"
+#include "undo/GroupUndoAction.h"
+#include "undo/InsertUndoAction.h"
+#include "util/PathUtil.h"
+#include "util/XojMsgBox.h"
+#include "util/i18n.h"
+
+/**
+ * Formulas compile in a fraction of a second, but LaTeX takes a while to start
+ */
+constexpr size_t MAX_PROCESSES = 8;
+
+LatexRecompileJob::LatexRecompileJob(Control* control, Color textColor):
+        BlockingJob(control, _("Compile LaTeX")),
+        textColor(textColor),
+        generator(control->getSettings()->latexSettings),
+        cache(Util::getCacheSubfolder("tex")),
+        texTmpDir(Util::getTmpDirSubfolder("tex")) {}
+
+LatexRecompileJob::~LatexRecompileJob() = default;
+
+auto LatexRecompileJob::getNumProcesses() -> size_t {
+    return std::clamp(static_cast<size_t>(g_get_num_processors()), size_t{1}, MAX_PROCESSES);
+}
+
+void LatexRecompileJob::run() {
+    auto latexTemplate = Util::readString(control->getSettings()->latexSettings.globalTemplatePath, false);
+    if (!latexTemplate) {
+        this->errorMsg = _("Failed to read global template file. Please check your settings.");
+        callAfterRun();
+        return;
+    }
+
+    collectFormulas(*latexTemplate);
+    compile();
+    callAfterRun();
+}
+
+void LatexRecompileJob::collectFormulas(const std::string& latexTemplate) {
+    Document* doc = control->getDocument();
+    doc->lock();
+    for (size_t i = 0; i < doc->getPageCount(); i++) {
+        PageRef page = doc->getPage(i);
+        for (Layer* layer: *page->getLayers()) {
+            for (Element* e: layer->getElements()) {
+                if (e->getType() == ELEMENT_TEXIMAGE) {
+                    auto* image = dynamic_cast<TexImage*>(e);
+                    this->formulas.push_back(
+                            {page, layer, image, LatexGenerator::templateSub(image->getText(), latexTemplate, textColor),
+                             {}});
+                }
+            }
+        }
+    }
+    doc->unlock();
+}
+
+void LatexRecompileJob::compile() {
+    struct Process {
+        size_t formula;
+        std::string key;
+        fs::path dir;
+        GSubprocess* proc;
+    };
+
+    // Each process has its own folder, as the generator writes "tex.tex" and LaTeX "tex.pdf"
+    std::vector<fs::path> freeDirs;
+    for (size_t i = 0; i < getNumProcesses(); i++) {
+        freeDirs.push_back(this->texTmpDir / ("recompile-" + std::to_string(i)));
+    }
+
+    const LatexSettings& settings = control->getSettings()->latexSettings;
+    control->setMaximumState(static_cast<int>(this->formulas.size()));
+    int done = 0;
+
+    std::deque<Process> running;
+    size_t next = 0;
+    while (true) {
+        while (next < this->formulas.size() && !freeDirs.empty() && this->errorMsg.empty()) {
+            Formula& formula = this->formulas[next];
+            std::string key = LatexCache::getKey(settings, formula.contents);
+            if (auto pdf = this->cache.load(key)) {
+                formula.pdf = std::move(*pdf);
+                next++;
+                control->setCurrentState(++done);
+                continue;
+            }
+
+            fs::path dir = freeDirs.back();
+            Util::ensureFolderExists(dir);
+            std::error_code ec;
+            fs::remove(dir / "tex.pdf", ec);
+
+            auto result = this->generator.asyncRun(dir, formula.contents);
+            if (auto* err = std::get_if<LatexGenerator::GenError>(&result)) {
+                // The same for all the formulas, e.g. the program is not found
+                this->errorMsg = err->message;
+                break;
+            }
+            freeDirs.pop_back();
+            running.push_back({next, std::move(key), std::move(dir), std::get<GSubprocess*>(result)});
+            next++;
+        }
+
+        if (running.empty()) {
+            break;
+        }
+
+        // The processes are about as long, so waiting for them in order keeps the others busy
+        Process process = std::move(running.front());
+        running.pop_front();
+
+        Formula& formula = this->formulas[process.formula];
+        GError* err = nullptr;
+        if (g_subprocess_wait_check(process.proc, nullptr, &err)) {
+            if (auto pdf = Util::readString(process.dir / "tex.pdf", false)) {
+                this->cache.store(process.key, *pdf);
+                formula.pdf = std::move(*pdf);
+            }
+        } else {
+            g_message("latex: could not compile \"%s\": %s", formula.image->getText().c_str(), err->message);
+            g_error_free(err);
+        }
+        if (formula.pdf.empty()) {
+            this->failed++;
+        }
+
+        g_object_unref(process.proc);
+        freeDirs.push_back(std::move(process.dir));
+        control->setCurrentState(++done);
+    }
+}
+
+auto LatexRecompileJob::replace(const Formula& formula, Element::Index pos) -> TexImage* {
+    TexImage* old = formula.image;
+    auto img = std::make_unique<TexImage>();
+    GError* err = nullptr;
+    if (!img->loadData(std::string(formula.pdf), &err) || !img->hasPdf()) {
+        if (err) {
+            g_message("latex: could not load the PDF of \"%s\": %s", old->getText().c_str(), err->message);
+            g_error_free(err);
+        }
+        this->failed++;
+        return nullptr;
+    }
+
+    // Same place and height as the previous image, see LatexController::loadRendered()
+    double ratio = img->getElementWidth() / img->getElementHeight();
+    img->setX(old->getX());
+    img->setY(old->getY());
+    img->setColor(old->getColor());
+    img->setText(old->getText());
+    if (ratio > 0 && old->getElementHeight() > 0) {
+        img->setWidth(old->getElementHeight() * ratio);
+        img->setHeight(old->getElementHeight());
+    }
+
+    formula.layer->removeElement(old, false);
+    formula.layer->insertElement(img.get(), pos);
+    formula.page->fireElementChanged(old);
+    formula.page->fireElementChanged(img.get());
+    return img.release();
+}
+
+void LatexRecompileJob::afterRun() {
+    auto undo = std::make_unique<GroupUndoAction>();
+    bool changed = false;
+
+    Document* doc = control->getDocument();
+    doc->lock();
+    for (const Formula& formula: this->formulas) {
+        if (formula.pdf.empty()) {
+            continue;
+        }
+        TexImage* old = formula.image;
+        Element::Index pos = formula.layer->indexOf(old);
+        if (pos == Element::InvalidIndex) {
+            // Deleted meanwhile
+            continue;
+        }
+        TexImage* img = replace(formula, pos);
+        if (!img) {
+            continue;
+        }
+
+        // The insertion is undone first, then the previous image is inserted again at its position
+        undo->addAction(std::make_unique<InsertUndoAction>(formula.page, formula.layer, img));
+        auto del = std::make_unique<DeleteUndoAction>(formula.page, false);
+        del->addElement(formula.layer, old, pos);
+        undo->addAction(std::move(del));
+        changed = true;
+    }
+    doc->unlock();
+
+    if (changed) {
+        control->getUndoRedoHandler()->addUndoAction(std::move(undo));
+    }
+
+    if (!this->errorMsg.empty()) {
+        XojMsgBox::showErrorToUser(control->getGtkWindow(), this->errorMsg);
+    } else if (this->failed > 0) {
+        XojMsgBox::showErrorToUser(control->getGtkWindow(),
+                                   FS(_F("{1} of the {2} LaTeX formulas could not be compiled") %
+                                      static_cast<int64_t>(this->failed) %
+                                      static_cast<int64_t>(this->formulas.size())));
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ * Xournal++
+ *
+ * Job to compile again all the LaTeX formulas of the document
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "control/latex/LatexCache.h"
+#include "control/latex/LatexGenerator.h"
+#include "model/Element.h"
+#include "model/PageRef.h"
+#include "util/Color.h"
+
+#include "BlockingJob.h"
+#include "filesystem.h"
+
+class Layer;
+class TexImage;
+
+/**
+ * @brief Compiles all the TeX images of the document with the current LaTeX settings and template
+ *
+ * The formulas are compiled by up to getNumProcesses() LaTeX processes at once, or taken from the LatexCache. The
+ * images are then replaced on the UI thread, as one undo action.
+ */
+class LatexRecompileJob: public BlockingJob {
+public:
+    /**
+     * @param textColor The color of the formulas, as chosen in the LaTeX dialog
+     */
+    LatexRecompileJob(Control* control, Color textColor);
+
+protected:
+    ~LatexRecompileJob() override;
+
+public:
+    void run() override;
+    void afterRun() override;
+
+    /**
+     * @return The maximum number of LaTeX processes running at once
+     */
+    static size_t getNumProcesses();
+
+private:
+    struct Formula {
+        PageRef page;
+        Layer* layer;
+        TexImage* image;
+
+        /**
+         * The instantiated template
+         */
+        std::string contents;
+
+        /**
+         * The compiled PDF, empty if it could not be compiled
+         */
+        std::string pdf;
+    };
+
+    /**
+     * Find the TeX images of the document
+     */
+    void collectFormulas(const std::string& latexTemplate);
+
+    /**
+     * Compile the formulas which are not in the cache
+     */
+    void compile();
+
+    /**
+     * Replace the image, at the given position in its layer, by the compiled one. Must be called with the document
+     * locked.
+     * @return The new image, or nullptr if the PDF could not be loaded
+     */
+    TexImage* replace(const Formula& formula, Element::Index pos);
+
+private:
+    Color textColor;
+
+    LatexGenerator generator;
+    LatexCache cache;
+    fs::path texTmpDir;
+
+    std::vector<Formula> formulas;
+
+    /**
+     * Number of formulas which could not be compiled
+     */
+    size_t failed = 0;
+
+    /**
+     * Error message to show to the user
+     */
+    std::string errorMsg;
+};
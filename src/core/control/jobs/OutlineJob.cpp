@@ -0,0 +1,37 @@
+#include "OutlineJob.h"
+
+#include <utility>
+
+#include "control/Control.h"
+#include "util/Profiler.h"
+
+OutlineJob::OutlineJob(Control* control, XojPdfDocument pdf): control(control), pdf(std::move(pdf)) {}
+
+auto OutlineJob::getType() -> JobType { return JOB_TYPE_RENDER; }
+
+auto OutlineJob::getSource() -> void* { return this->control->getDocument(); }
+
+void OutlineJob::run() {
+    {
+        xoj::util::Profiler::Scope scope("read pdf outline", "load");
+        this->outline = Document::readOutline(this->pdf);
+    }
+    callAfterRun();
+}
+
+void OutlineJob::afterRun() {
+    if (isCancelled()) {
+        return;
+    }
+
+    Document* doc = this->control->getDocument();
+    doc->lock();
+    doc->setOutline(this->pdf, std::move(this->outline));
+    // Also if the outline was built meanwhile, e.g. by an export, without notification
+    bool changed = !doc->isOutlineOutdated();
+    doc->unlock();
+
+    if (changed) {
+        this->control->fireDocumentChanged(DOCUMENT_CHANGE_PDF_BOOKMARKS);
+    }
+}
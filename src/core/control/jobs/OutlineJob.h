@@ -0,0 +1,54 @@
+/*
+ * Xournal++
+ *
+ * A job which reads the outline of the PDF
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "model/Document.h"
+#include "pdf/base/XojPdfDocument.h"
+
+#include "Job.h"
+
+class Control;
+
+/**
+ * @brief Reads the outline of the PDF in the background, then builds the contents model of the document in the UI
+ * thread and notifies the listeners with DOCUMENT_CHANGE_PDF_BOOKMARKS
+ *
+ * The outline is dropped if another PDF was loaded meanwhile, see Document::setOutline().
+ */
+class OutlineJob: public Job {
+public:
+    OutlineJob(Control* control, XojPdfDocument pdf);
+
+protected:
+    ~OutlineJob() override = default;
+
+public:
+    JobType getType() override;
+
+    void* getSource() override;
+
+    void run() override;
+
+protected:
+    void afterRun() override;
+
+private:
+    Control* control;
+    XojPdfDocument pdf;
+
+    /**
+     * The result, set by run()
+     */
+    std::vector<Document::OutlineEntry> outline;
+};
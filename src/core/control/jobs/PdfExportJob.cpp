@@ -27,10 +27,14 @@ auto PdfExportJob::testAndSetFilepath(fs::path file) -> bool {
 void PdfExportJob::run() {
     Document* doc = control->getDocument();
 
+    // The document is exported from a snapshot, so that it can be edited in the meantime
     doc->lock();
-    std::unique_ptr<XojPdfExport> pdfe = XojPdfExportFactory::createExport(doc, control);
+    std::unique_ptr<Document> snapshot = doc->snapshot();
     doc->unlock();
 
+    std::unique_ptr<XojPdfExport> pdfe = XojPdfExportFactory::createExport(snapshot.get(), control);
+    pdfe->setStreaming(true);
+
     if (!pdfe->createPdf(this->filepath, false)) {
         this->errorMsg = pdfe->getLastError();
         if (control->getWindow()) {
@@ -0,0 +1,18 @@
+#include "PdfPrefetchJob.h"
+
+#include <utility>
+
+#include "control/PdfCache.h"
+
+PdfPrefetchJob::PdfPrefetchJob(PdfCache* cache, std::vector<size_t> pdfPages, double zoom):
+        cache(cache), pdfPages(std::move(pdfPages)), zoom(zoom) {}
+
+void PdfPrefetchJob::onDelete() { this->cache = nullptr; }
+
+auto PdfPrefetchJob::getType() -> JobType { return JOB_TYPE_RENDER; }
+
+auto PdfPrefetchJob::getSource() -> void* { return this->cache; }
+
+void PdfPrefetchJob::run() {
+    for (size_t pdfPage: this->pdfPages) { this->cache->prefetch(pdfPage, this->zoom); }
+}
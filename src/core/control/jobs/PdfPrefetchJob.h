@@ -0,0 +1,47 @@
+/*
+ * Xournal++
+ *
+ * A job which rasterizes PDF pages into the PdfCache ahead of time
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "Job.h"
+
+class PdfCache;
+
+/**
+ * @brief Warms the PdfCache with the PDF backgrounds of the pages around the current one, so that turning the page
+ * does not have to wait for Poppler.
+ */
+class PdfPrefetchJob: public Job {
+public:
+    /**
+     * @param pdfPages The pages to rasterize (numbers in the pdf document)
+     * @param zoom The zoom the pages will be rendered at
+     */
+    PdfPrefetchJob(PdfCache* cache, std::vector<size_t> pdfPages, double zoom);
+
+protected:
+    void onDelete() override;
+    ~PdfPrefetchJob() override = default;
+
+public:
+    JobType getType() override;
+
+    void* getSource() override;
+
+    void run() override;
+
+private:
+    PdfCache* cache;
+    std::vector<size_t> pdfPages;
+    double zoom;
+};
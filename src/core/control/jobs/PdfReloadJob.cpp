@@ -0,0 +1,51 @@
+#include "PdfReloadJob.h"
+
+#include <utility>
+
+#include <glib.h>
+
+#include "control/Control.h"
+#include "control/PdfReloader.h"
+#include "util/Profiler.h"
+
+PdfReloadJob::PdfReloadJob(Control* control, unsigned int generation, fs::path file, XojPdfDocument previous,
+                           std::vector<PdfPageSignature> previousSignatures):
+        control(control),
+        generation(generation),
+        file(std::move(file)),
+        previous(std::move(previous)),
+        previousSignatures(std::move(previousSignatures)) {}
+
+auto PdfReloadJob::getType() -> JobType { return JOB_TYPE_RENDER; }
+
+auto PdfReloadJob::getSource() -> void* { return this->control->getPdfReloader(); }
+
+void PdfReloadJob::run() {
+    {
+        xoj::util::Profiler::Scope scope("reload pdf", "load");
+        GError* error = nullptr;
+        if (this->pdf.load(this->file, "", &error)) {
+            auto cancelled = [this]() { return isCancelled(); };
+            if (this->previousSignatures.size() != this->previous.getPageCount()) {
+                this->previousSignatures = PdfPageSignature::ofAll(this->previous, cancelled);
+            }
+            this->signatures = PdfPageSignature::ofAll(this->pdf, cancelled);
+        } else {
+            // E.g. while it is being written, it is read again once it changes again
+            g_warning("PdfReloadJob: the PDF could not be read again: %s", error ? error->message : "");
+            if (error) {
+                g_error_free(error);
+            }
+            this->pdf = XojPdfDocument();
+        }
+    }
+    callAfterRun();
+}
+
+void PdfReloadJob::afterRun() {
+    if (isCancelled()) {
+        return;
+    }
+    this->control->getPdfReloader()->reloaded(this->generation, this->previous, std::move(this->previousSignatures),
+                                              std::move(this->pdf), std::move(this->signatures));
+}
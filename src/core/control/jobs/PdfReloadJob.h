@@ -0,0 +1,64 @@
+/*
+ * Xournal++
+ *
+ * A job which reads the new version of the PDF background
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "control/PdfPageSignature.h"
+#include "pdf/base/XojPdfDocument.h"
+
+#include "Job.h"
+#include "filesystem.h"
+
+class Control;
+
+/**
+ * @brief Reads the PDF file again and signs its pages in the background, then hands them over to the PdfReloader of
+ * the control in the UI thread, see PdfReloader::reloaded()
+ */
+class PdfReloadJob: public Job {
+public:
+    /**
+     * @param generation Handed back to PdfReloader::reloaded()
+     * @param previous The PDF the document uses now
+     * @param previousSignatures The signatures of its pages, empty if they are not known yet
+     */
+    PdfReloadJob(Control* control, unsigned int generation, fs::path file, XojPdfDocument previous,
+                 std::vector<PdfPageSignature> previousSignatures);
+
+protected:
+    ~PdfReloadJob() override = default;
+
+public:
+    JobType getType() override;
+
+    void* getSource() override;
+
+    void run() override;
+
+protected:
+    void afterRun() override;
+
+private:
+    Control* control;
+    unsigned int generation;
+    fs::path file;
+
+    XojPdfDocument previous;
+    std::vector<PdfPageSignature> previousSignatures;
+
+    /**
+     * The result, set by run()
+     */
+    XojPdfDocument pdf;
+    std::vector<PdfPageSignature> signatures;
+};
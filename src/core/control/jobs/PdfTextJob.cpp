@@ -0,0 +1,13 @@
+#include "PdfTextJob.h"
+
+#include "control/PdfTextCache.h"
+
+PdfTextJob::PdfTextJob(PdfTextCache* cache, size_t pdfPage): cache(cache), pdfPage(pdfPage) {}
+
+void PdfTextJob::onDelete() { this->cache = nullptr; }
+
+auto PdfTextJob::getType() -> JobType { return JOB_TYPE_RENDER; }
+
+auto PdfTextJob::getSource() -> void* { return this->cache; }
+
+void PdfTextJob::run() { this->cache->extract(this->pdfPage); }
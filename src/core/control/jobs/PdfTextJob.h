@@ -0,0 +1,44 @@
+/*
+ * Xournal++
+ *
+ * A job which extracts the text layout of a PDF page into the PdfTextCache
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "Job.h"
+
+class PdfTextCache;
+
+/**
+ * @brief Extracts the PdfTextLayout of a page, so that the selection and the search of its text do not query Poppler
+ */
+class PdfTextJob: public Job {
+public:
+    /**
+     * @param pdfPage The page (number in the pdf document), marked as pending in the cache
+     */
+    PdfTextJob(PdfTextCache* cache, size_t pdfPage);
+
+protected:
+    void onDelete() override;
+    ~PdfTextJob() override = default;
+
+public:
+    JobType getType() override;
+
+    void* getSource() override;
+
+    void run() override;
+
+private:
+    PdfTextCache* cache;
+    size_t pdfPage;
+};
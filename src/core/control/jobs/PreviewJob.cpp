@@ -1,11 +1,16 @@
 #include "PreviewJob.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "control/Control.h"
 #include "gui/Shadow.h"
 #include "gui/sidebar/previews/base/SidebarPreviewBase.h"
 #include "gui/sidebar/previews/base/SidebarPreviewBaseEntry.h"
-#include "gui/sidebar/previews/layer/SidebarPreviewLayerEntry.h"
+#include "gui/sidebar/previews/base/ThumbnailCache.h"
 #include "model/Document.h"
+#include "util/Profiler.h"
+#include "util/SurfacePool.h"
 #include "view/DocumentView.h"
 #include "view/LayerView.h"
 #include "view/PdfView.h"
@@ -23,7 +28,7 @@ auto PreviewJob::getType() -> JobType { return JOB_TYPE_PREVIEW; }
 void PreviewJob::initGraphics() {
     GtkAllocation alloc;
     gtk_widget_get_allocation(this->sidebarPreview->widget, &alloc);
-    crBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, alloc.width, alloc.height);
+    crBuffer = xoj::util::SurfacePool::createSurface(CAIRO_FORMAT_ARGB32, alloc.width, alloc.height);
     zoom = this->sidebarPreview->sidebar->getZoom();
     cr2 = cairo_create(crBuffer);
 }
@@ -41,15 +46,8 @@ void PreviewJob::finishPaint() {
     }
     this->sidebarPreview->crBuffer = crBuffer;
 
-    // The preview widget can be referenced after this is deleted.
-    // Only it should be referenced in the callback.
-    GtkWidget* previewWidget = this->sidebarPreview->widget;
-    g_object_ref(previewWidget);
-
-    Util::execInUiThread([previewWidget]() {
-        gtk_widget_queue_draw(previewWidget);
-        g_object_unref(previewWidget);
-    });
+    // The preview widget can be referenced after this is deleted
+    Util::queueDrawInUiThread(this->sidebarPreview->widget);
 
     this->sidebarPreview->drawingMutex.unlock();
 }
@@ -61,19 +59,13 @@ void PreviewJob::drawBackgroundPdf(Document* doc) {
                       this->sidebarPreview->page->getWidth(), this->sidebarPreview->page->getHeight());
 }
 
-void PreviewJob::drawPage() {
+void PreviewJob::drawPage(PreviewRenderType type, Layer::Index layer) {
     DocumentView view;
+    view.setLevelOfDetail(this->zoom);
     PageRef page = this->sidebarPreview->page;
     Document* doc = this->sidebarPreview->sidebar->getControl()->getDocument();
-    PreviewRenderType type = this->sidebarPreview->getRenderType();
-    Layer::Index layer = 0;
-
-    doc->lock();
 
-    // getLayer is not defined for page preview
-    if (type != RENDER_TYPE_PAGE_PREVIEW) {
-        layer = (dynamic_cast<SidebarPreviewLayerEntry*>(this->sidebarPreview))->getLayer();
-    }
+    doc->lockPage(*page);
 
     // Pdf::drawPage needs to go before DocumentView::initDrawing until DocumentView learns to do it and the first
     // switch block can go away and the layer assignment into the remaining switch block.
@@ -97,6 +89,7 @@ void PreviewJob::drawPage() {
     }
 
     auto context = xoj::view::Context::createDefault(cr2);
+    context.detailTolerance = view.getDetailTolerance();
 
     switch (type) {
         case RENDER_TYPE_PAGE_PREVIEW:
@@ -109,7 +102,7 @@ void PreviewJob::drawPage() {
             view.initDrawing(page, cr2, true);
             if (layer == 0) {
                 view.drawBackground();
-            } else {
+            } else if (layer <= page->getLayerCount()) {
                 Layer* drawLayer = (*page->getLayers())[layer - 1];
                 xoj::view::LayerView layerView(drawLayer);
                 layerView.draw(context);
@@ -121,7 +114,7 @@ void PreviewJob::drawPage() {
             // render all layers up to layer
             view.initDrawing(page, cr2, true);
             view.drawBackground();
-            for (Layer::Index i = 0; i < layer; i++) {
+            for (Layer::Index i = 0; i < std::min(layer, page->getLayerCount()); i++) {
                 Layer* drawLayer = (*page->getLayers())[i];
                 xoj::view::LayerView layerView(drawLayer);
                 layerView.draw(context);
@@ -135,7 +128,7 @@ void PreviewJob::drawPage() {
     }
 
     cairo_destroy(cr2);
-    doc->unlock();
+    doc->unlockPage(*page);
 }
 
 void PreviewJob::clipToPage() {
@@ -145,14 +138,98 @@ void PreviewJob::clipToPage() {
     cairo_clip(cr2);
 }
 
+void PreviewJob::render(PreviewRenderType type, Layer::Index layer) {
+    initGraphics();
+    drawBorder();
+    clipToPage();
+    drawPage(type, layer);
+}
+
+auto PreviewJob::composeLayerStack(const ThumbnailCache::Key& key, uint64_t revision) -> cairo_surface_t* {
+    ThumbnailCache* thumbnails = this->sidebarPreview->sidebar->getThumbnailCache();
+    cairo_surface_t* stack = xoj::util::SurfacePool::createSurface(CAIRO_FORMAT_ARGB32, key.width, key.height);
+    cairo_t* cr = cairo_create(stack);
+
+    Layer::Index first = 0;
+    if (key.layer > 0) {
+        ThumbnailCache::Key belowKey = key;
+        belowKey.layer = key.layer - 1;
+        if (cairo_surface_t* below = thumbnails->get(belowKey)) {
+            cairo_set_source_surface(cr, below, 0, 0);
+            cairo_paint(cr);
+            cairo_surface_destroy(below);
+            first = key.layer;
+        }
+    }
+
+    for (Layer::Index i = first; i <= key.layer; i++) {
+        ThumbnailCache::Key layerKey = key;
+        layerKey.type = RENDER_TYPE_PAGE_LAYER;
+        layerKey.layer = i;
+        cairo_surface_t* layer = thumbnails->get(layerKey);
+        if (layer == nullptr) {
+            render(RENDER_TYPE_PAGE_LAYER, i);
+            layer = std::exchange(this->crBuffer, nullptr);
+            thumbnails->put(layerKey, revision, layer);
+        }
+        cairo_set_source_surface(cr, layer, 0, 0);
+        cairo_paint(cr);
+        cairo_surface_destroy(layer);
+    }
+
+    cairo_destroy(cr);
+    return stack;
+}
+
 void PreviewJob::run() {
     if (this->sidebarPreview == nullptr) {
         return;
     }
 
-    initGraphics();
-    drawBorder();
-    clipToPage();
-    drawPage();
+    xoj::util::Profiler::Scope scope("PreviewJob");
+
+    ThumbnailCache* thumbnails = this->sidebarPreview->sidebar->getThumbnailCache();
+    Document* doc = this->sidebarPreview->sidebar->getControl()->getDocument();
+
+    // Read before rendering: a change of the page during the rendering makes the preview outdated
+    uint64_t revision = thumbnails->getRevision(this->sidebarPreview->page);
+
+    // The pages not changed since the document was loaded, and whose layers were not parsed yet
+    fs::path saved;
+    ThumbnailDiskCache* disk = thumbnails->getDiskCache();
+    if (disk && this->sidebarPreview->getRenderType() == RENDER_TYPE_PAGE_PREVIEW) {
+        GtkAllocation alloc;
+        gtk_widget_get_allocation(this->sidebarPreview->widget, &alloc);
+        saved = disk->getFile(this->sidebarPreview->page, alloc.width, alloc.height);
+        if (!saved.empty()) {
+            if (cairo_surface_t* loaded = disk->load(saved, alloc.width, alloc.height)) {
+                crBuffer = loaded;
+                finishPaint();
+                return;
+            }
+        }
+    }
+
+    doc->lockShared();
+    ThumbnailCache::Key key = this->sidebarPreview->getThumbnailKey();
+    doc->unlockShared();
+
+    if (cairo_surface_t* cached = thumbnails->get(key)) {
+        crBuffer = cached;
+        finishPaint();
+        return;
+    }
+
+    PreviewRenderType type = this->sidebarPreview->getRenderType();
+    if (type == RENDER_TYPE_PAGE_LAYERSTACK) {
+        // The layers are shared with the other stack previews and with the layer sidebar
+        crBuffer = composeLayerStack(key, revision);
+    } else {
+        render(type, key.layer);
+    }
+    thumbnails->put(key, revision, crBuffer);
+    if (!saved.empty() && thumbnails->getRevision(this->sidebarPreview->page) == revision) {
+        disk->store(saved, crBuffer);
+    }
     finishPaint();
 }
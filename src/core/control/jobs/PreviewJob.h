@@ -16,6 +16,10 @@
 
 #include <gtk/gtk.h>
 
+#include "gui/sidebar/previews/base/PreviewRenderType.h"
+#include "gui/sidebar/previews/base/ThumbnailCache.h"
+#include "model/Layer.h"
+
 #include "Job.h"
 
 
@@ -46,7 +50,19 @@ private:
     void drawBorder();
     void finishPaint();
     void drawBackgroundPdf(Document* doc);
-    void drawPage();
+    void drawPage(PreviewRenderType type, Layer::Index layer);
+
+    /**
+     * Renders the preview into crBuffer
+     */
+    void render(PreviewRenderType type, Layer::Index layer);
+
+    /**
+     * Composes the layer stack preview of the key from the previews of its layers, those which are not cached yet
+     * are rendered and cached. Starts from the stack preview of the layer below if it is cached.
+     * @return The new preview
+     */
+    cairo_surface_t* composeLayerStack(const ThumbnailCache::Key& key, uint64_t revision);
 
 private:
     /**
@@ -0,0 +1,51 @@
+#include "PrintPageJob.h"
+
+#include <utility>
+
+#include "model/Document.h"
+#include "util/Profiler.h"
+#include "view/DocumentView.h"
+
+PrintPageJob::PrintPageJob(void* source, Document* doc, PageRef page,
+                           std::function<void(cairo_surface_t*)> rendered):
+        source(source), doc(doc), page(std::move(page)), rendered(std::move(rendered)) {}
+
+PrintPageJob::~PrintPageJob() {
+    if (this->recording) {
+        cairo_surface_destroy(this->recording);
+    }
+}
+
+auto PrintPageJob::getType() -> JobType { return JOB_TYPE_RENDER; }
+
+auto PrintPageJob::getSource() -> void* { return this->source; }
+
+void PrintPageJob::run() {
+    xoj::util::Profiler::Scope scope("print page");
+
+    cairo_rectangle_t extents = {0, 0, this->page->getWidth(), this->page->getHeight()};
+    this->recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &extents);
+    cairo_t* cr = cairo_create(this->recording);
+
+    this->doc->lockPage(*this->page);
+    if (this->page->getBackgroundType().isPdfPage()) {
+        if (XojPdfPageSPtr popplerPage = this->doc->getPdfPage(this->page->getPdfPageNr())) {
+            popplerPage->renderForPrinting(cr);
+        }
+    }
+
+    DocumentView view;
+    view.setCancellation(&this->cancelled);
+    view.drawPage(this->page, cr, true /* dont render eraseable */, true /* dont show pdf background*/);
+    this->doc->unlockPage(*this->page);
+
+    cairo_destroy(cr);
+    callAfterRun();
+}
+
+void PrintPageJob::afterRun() {
+    if (isCancelled()) {
+        return;
+    }
+    this->rendered(std::exchange(this->recording, nullptr));
+}
@@ -0,0 +1,57 @@
+/*
+ * Xournal++
+ *
+ * Renders a page to be printed in the background
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <functional>
+
+#include <cairo.h>
+
+#include "model/PageRef.h"
+
+#include "Job.h"
+
+class Document;
+
+/**
+ * @brief Records the drawing of a page for the print operation, see PrintHandler
+ *
+ * The page is drawn with its PDF background into a recording surface, which the print operation replays on the UI
+ * thread: the printout stays vectorial, and the pages are rendered by several workers at once.
+ */
+class PrintPageJob: public Job {
+public:
+    /**
+     * @param source The print operation, to remove its jobs
+     * @param rendered Called on the UI thread with the recording, which it owns, unless the job is cancelled
+     */
+    PrintPageJob(void* source, Document* doc, PageRef page, std::function<void(cairo_surface_t*)> rendered);
+
+protected:
+    ~PrintPageJob() override;
+
+public:
+    JobType getType() override;
+
+    void* getSource() override;
+
+    void run() override;
+
+    void afterRun() override;
+
+private:
+    void* source;
+    Document* doc;
+    PageRef page;
+    std::function<void(cairo_surface_t*)> rendered;
+
+    cairo_surface_t* recording = nullptr;
+};
@@ -11,11 +11,23 @@
 
 #pragma once
 
+#include <chrono>
+
 class ProgressListener {
 public:
     virtual void setMaximumState(int max) = 0;
     virtual void setCurrentState(int state) = 0;
 
+    /**
+     * The time taken by the step which led to the state, e.g. the export of a page
+     */
+    virtual void setStateDuration(int state, std::chrono::steady_clock::duration duration){};
+
+    /**
+     * Polled between the steps: the operation stops early if it returns true
+     */
+    virtual bool isCancelRequested() { return false; }
+
     virtual ~ProgressListener(){};
 };
 
@@ -1,152 +1,381 @@
 #include "RenderJob.h"
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
 
 #include "control/Control.h"
 #include "control/ToolHandler.h"
 #include "gui/PageView.h"
 #include "gui/XournalView.h"
+#include "gui/widgets/XournalWidget.h"
 #include "model/Document.h"
+#include "util/Profiler.h"
 #include "util/Rectangle.h"
+#include "util/SurfacePool.h"
 #include "util/Util.h"
 #include "view/DocumentView.h"
 #include "view/PdfView.h"
 
+using xoj::util::Profiler;
 using xoj::util::Rectangle;
+using xoj::util::SurfacePool;
 
 RenderJob::RenderJob(XojPageView* view): view(view) {}
 
 auto RenderJob::getSource() -> void* { return this->view; }
 
-void RenderJob::rerenderRectangle(Rectangle<double> const& rect) {
-    double zoom = view->xournal->getZoom();
+void RenderJob::renderArea(cairo_t* cr, Rectangle<double> const& area, double scale, Part part) {
     Document* doc = view->xournal->getDocument();
-    doc->lock();
+    doc->lockShared();
     double pageWidth = view->page->getWidth();
     double pageHeight = view->page->getHeight();
-    doc->unlock();
+    doc->unlockShared();
+
+    DocumentView v;
+    Control* control = view->getXournal()->getControl();
+    v.setMarkAudioStroke(control->getToolHandler()->getToolType() == TOOL_PLAY_OBJECT);
+    v.limitArea(area.x, area.y, area.width, area.height);
+    v.setLevelOfDetail(scale);
+    v.setCancellation(&this->cancelled);
+    v.setDraft(this->draft);
+
+    bool backgroundVisible = view->page->isLayerVisible(0);
+    if (part != Part::LAYERS && backgroundVisible && view->page->getBackgroundType().isPdfPage()) {
+        auto pgNo = view->page->getPdfPageNr();
+        PdfCache* cache = view->xournal->getCache();
+        PdfView::drawPage(cache, pgNo, cr, scale, pageWidth, pageHeight, this->draft);
+    }
+
+    // The elements are drawn without the page lock: the tools and the render jobs of the other pages run meanwhile
+    PageSnapshot snapshot = doc->lockSnapshot(*view->page, area);
+    v.setSnapshot(&snapshot);
+    switch (part) {
+        case Part::ALL:
+            v.drawPage(view->page, cr, false);
+            break;
+        case Part::BACKGROUND:
+            v.drawPageBackground(view->page, cr);
+            break;
+        case Part::LAYERS:
+            v.drawPageLayers(view->page, cr, false);
+            break;
+    }
+    doc->unlockSnapshot();
+}
+
+auto RenderJob::keepsBackground() const -> bool {
+    auto type = view->page->getBackgroundType();
+    return view->page->isLayerVisible(0) && (type.isPdfPage() || type.isImagePage());
+}
+
+auto RenderJob::renderTile(TiledPageBuffer::TileKey const& key, cairo_surface_t** background) -> cairo_surface_t* {
+    Profiler::Scope scope("render tile");
+
+    auto createTile = [this, &key]() {
+        cairo_surface_t* surface = SurfacePool::createSurface(CAIRO_FORMAT_ARGB32, TiledPageBuffer::TILE_SIZE,
+                                                              TiledPageBuffer::TILE_SIZE);
+        cairo_t* cr = cairo_create(surface);
+        if (this->draft) {
+            cairo_set_antialias(cr, CAIRO_ANTIALIAS_FAST);
+        }
+        cairo_translate(cr, -key.x * TiledPageBuffer::TILE_SIZE, -key.y * TiledPageBuffer::TILE_SIZE);
+        cairo_scale(cr, key.scale, key.scale);
+        return std::make_pair(surface, cr);
+    };
+
+    auto [tile, cr] = createTile();
+    *background = nullptr;
+    if (keepsBackground()) {
+        auto [bg, crBackground] = createTile();
+        renderArea(crBackground, key.getPageRect(), key.scale, Part::BACKGROUND);
+        cairo_destroy(crBackground);
+        *background = bg;
+
+        cairo_save(cr);
+        cairo_identity_matrix(cr);
+        cairo_set_source_surface(cr, bg, 0, 0);
+        cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+        cairo_paint(cr);
+        cairo_restore(cr);
+        renderArea(cr, key.getPageRect(), key.scale, Part::LAYERS);
+    } else {
+        renderArea(cr, key.getPageRect(), key.scale, Part::ALL);
+    }
+
+    cairo_destroy(cr);
+    return tile;
+}
+
+auto RenderJob::isCurrent() const -> bool {
+    return !isCancelled() && this->view->renderGeneration.load() == this->generation;
+}
+
+auto RenderJob::isSuperseded(double tileScale) const -> bool {
+    double scale = this->view->xournal->getZoom() * this->view->xournal->getDpiScaleFactor();
+    return tileScale != scale && tileScale != TiledPageBuffer::getPreviewScale(scale);
+}
+
+auto RenderJob::rerenderRectangle(Rectangle<double> const& rect, double scale) -> bool {
+    Profiler::Scope scope("rerender rectangle");
 
     /**
      * Make sure the mask is big enough
      * The +1 covers examples like rect.x = 0.4, rect.width = 1 and zoom = 1
      * We need a mask of width 2 pixels for that...
      **/
-    auto x = int(std::floor(rect.x * zoom));
-    auto y = int(std::floor(rect.y * zoom));
-    auto width = int(std::ceil(rect.width * zoom)) + 1;
-    auto height = int(std::ceil(rect.height * zoom)) + 1;
+    auto x = int(std::floor(rect.x * scale));
+    auto y = int(std::floor(rect.y * scale));
+    auto width = int(std::ceil(rect.width * scale)) + 1;
+    auto height = int(std::ceil(rect.height * scale)) + 1;
 
-    cairo_surface_t* rectBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_surface_t* rectBuffer = SurfacePool::createSurface(CAIRO_FORMAT_ARGB32, width, height);
     cairo_t* crRect = cairo_create(rectBuffer);
     cairo_translate(crRect, -x, -y);
-    cairo_scale(crRect, zoom, zoom);
-
-    DocumentView v;
-    Control* control = view->getXournal()->getControl();
-    v.setMarkAudioStroke(control->getToolHandler()->getToolType() == TOOL_PLAY_OBJECT);
-    v.limitArea(rect.x, rect.y, rect.width, rect.height);
+    if (this->draft) {
+        cairo_set_antialias(crRect, CAIRO_ANTIALIAS_FAST);
+    }
 
-    bool backgroundVisible = view->page->isLayerVisible(0);
-    if (backgroundVisible && view->page->getBackgroundType().isPdfPage()) {
-        auto pgNo = view->page->getPdfPageNr();
-        PdfCache* cache = view->xournal->getCache();
-        PdfView::drawPage(cache, pgNo, crRect, zoom, pageWidth, pageHeight);
+    // The backgrounds kept in the tiles are copied instead of drawn again, e.g. the PDF under the ink being edited
+    bool copyBackground = false;
+    if (keepsBackground()) {
+        view->drawingMutex.lock();
+        copyBackground = view->buffer.hasBackgrounds(scale, rect);
+        if (copyBackground) {
+            cairo_set_operator(crRect, CAIRO_OPERATOR_SOURCE);
+            view->buffer.forEachBackground(scale, rect, [&](const TiledPageBuffer::TileKey& key, cairo_surface_t* bg) {
+                cairo_set_source_surface(crRect, bg, key.x * TiledPageBuffer::TILE_SIZE,
+                                         key.y * TiledPageBuffer::TILE_SIZE);
+                cairo_rectangle(crRect, key.x * TiledPageBuffer::TILE_SIZE, key.y * TiledPageBuffer::TILE_SIZE,
+                                TiledPageBuffer::TILE_SIZE, TiledPageBuffer::TILE_SIZE);
+                cairo_fill(crRect);
+            });
+            cairo_set_operator(crRect, CAIRO_OPERATOR_OVER);
+        }
+        view->drawingMutex.unlock();
     }
 
-    doc->lock();
-    v.drawPage(view->page, crRect, false);
-    doc->unlock();
+    cairo_scale(crRect, scale, scale);
+    renderArea(crRect, rect, scale, copyBackground ? Part::LAYERS : Part::ALL);
 
     cairo_destroy(crRect);
 
     view->drawingMutex.lock();
 
-    cairo_t* crPageBuffer = cairo_create(view->crBuffer);
+    if (!isCurrent()) {
+        view->drawingMutex.unlock();
+        cairo_surface_destroy(rectBuffer);
+        return false;
+    }
+
+    // Tiles of other scales would show outdated content in this area
+    view->buffer.dropOtherScales(scale, rect);
 
-    cairo_set_operator(crPageBuffer, CAIRO_OPERATOR_SOURCE);
-    cairo_set_source_surface(crPageBuffer, rectBuffer, x, y);
-    cairo_rectangle(crPageBuffer, x, y, width, height);
-    cairo_fill(crPageBuffer);
+    view->buffer.forEachTile(scale, rect, [&](const TiledPageBuffer::TileKey& key, cairo_surface_t* tile) {
+        cairo_t* crTile = cairo_create(tile);
+        cairo_translate(crTile, -key.x * TiledPageBuffer::TILE_SIZE, -key.y * TiledPageBuffer::TILE_SIZE);
 
-    cairo_destroy(crPageBuffer);
+        cairo_set_operator(crTile, CAIRO_OPERATOR_SOURCE);
+        cairo_set_source_surface(crTile, rectBuffer, x, y);
+        cairo_rectangle(crTile, x, y, width, height);
+        cairo_fill(crTile);
+
+        cairo_destroy(crTile);
+    });
+    if (this->draft) {
+        view->buffer.markDrafts(scale, rect);
+    }
 
     cairo_surface_destroy(rectBuffer);
 
     view->drawingMutex.unlock();
+    return true;
 }
 
 void RenderJob::run() {
-    double zoom = this->view->xournal->getZoom();
+    Profiler::Scope scope("RenderJob");
+
+    double scale = this->view->xournal->getZoom() * this->view->xournal->getDpiScaleFactor();
 
     this->view->repaintRectMutex.lock();
 
     bool rerenderComplete = this->view->rerenderComplete;
     auto rerenderRects = std::move(this->view->rerenderRects);
+    auto requestedTiles = std::move(this->view->requestedTiles);
+    requestedTiles.insert(requestedTiles.end(), this->view->aheadTiles.begin(), this->view->aheadTiles.end());
 
+    this->draft = this->view->draftRequested && !this->view->finalRequested;
+    this->view->draftRequested = false;
+    this->view->finalRequested = false;
     this->view->rerenderComplete = false;
+    this->view->requestedTiles.clear();
+    this->view->aheadTiles.clear();
+    this->view->runningRenderJobs++;
+    this->view->renderJobs.push_back(this);
+    this->generation = this->view->renderGeneration.load();
 
     this->view->repaintRectMutex.unlock();
 
-    int dpiScaleFactor = this->view->xournal->getDpiScaleFactor();
+    // Tiles requested before a zoom change are not needed anymore
+    double previewScale = TiledPageBuffer::getPreviewScale(scale);
+    std::vector<TiledPageBuffer::TileKey> tiles;
+    std::copy_if(requestedTiles.begin(), requestedTiles.end(), std::back_inserter(tiles),
+                 [scale, previewScale](const TiledPageBuffer::TileKey& key) {
+                     return key.scale == scale || key.scale == previewScale;
+                 });
 
-    if (rerenderComplete || dpiScaleFactor > 1) {
-        Document* doc = this->view->xournal->getDocument();
-
-        int dispWidth = this->view->getDisplayWidth();
-        int dispHeight = this->view->getDisplayHeight();
+    if (rerenderComplete) {
+        this->view->drawingMutex.lock();
+        this->view->buffer.invalidate();
+        auto existing = this->view->buffer.getTileKeys(scale);
+        bool neverPainted = this->view->buffer.isEmpty();
+        this->view->drawingMutex.unlock();
 
-        dispWidth *= dpiScaleFactor;
-        dispHeight *= dpiScaleFactor;
-        zoom *= dpiScaleFactor;
+        tiles.insert(tiles.end(), existing.begin(), existing.end());
 
-        cairo_surface_t* crBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, dispWidth, dispHeight);
-        cairo_t* cr2 = cairo_create(crBuffer);
-        cairo_scale(cr2, zoom, zoom);
+        if (tiles.empty() && neverPainted) {
+            // The page is not displayed yet (preloading): render it if it is small enough
+            auto pageTiles = TiledPageBuffer::tilesInArea(
+                    scale, Rectangle<double>(0, 0, this->view->page->getWidth(), this->view->page->getHeight()));
+            if (pageTiles.size() <= MAX_PRELOAD_TILES) {
+                tiles = std::move(pageTiles);
+            }
+        }
+    }
 
-        XojPdfPageSPtr popplerPage;
+    std::sort(tiles.begin(), tiles.end());
+    tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
 
-        doc->lock();
+    bool fullResolution = false;
+    for (auto const& key: tiles) {
+        if (!isCurrent()) {
+            break;
+        }
+        if (isSuperseded(key.scale)) {
+            // The zoom changed meanwhile, e.g. during a zoom gesture
+            continue;
+        }
 
-        Control* control = view->getXournal()->getControl();
-        DocumentView localView;
-        localView.setMarkAudioStroke(control->getToolHandler()->getToolType() == TOOL_PLAY_OBJECT);
-        auto width = this->view->page->getWidth();
-        auto height = this->view->page->getHeight();
+        cairo_surface_t* background = nullptr;
+        cairo_surface_t* tile = renderTile(key, &background);
 
-        bool backgroundVisible = this->view->page->isLayerVisible(0);
-        if (backgroundVisible && this->view->page->getBackgroundType().isPdfPage()) {
-            auto pgNo = this->view->page->getPdfPageNr();
-            PdfView::drawPage(this->view->xournal->getCache(), pgNo, cr2, zoom, width, height);
+        // A tile drawn partially or for an outdated request is not stored
+        this->view->drawingMutex.lock();
+        if (isCurrent()) {
+            this->view->buffer.putTile(key, tile, background, this->draft);
+            fullResolution = fullResolution || key.scale == scale;
+        } else {
+            cairo_surface_destroy(tile);
+            if (background) {
+                cairo_surface_destroy(background);
+            }
         }
-        localView.drawPage(this->view->page, cr2, false);
-
-        cairo_destroy(cr2);
+        this->view->drawingMutex.unlock();
+    }
 
+    if (fullResolution && !isSuperseded(scale)) {
+        // The tiles of the current scale are available, the stretched ones are not needed anymore
         this->view->drawingMutex.lock();
+        this->view->buffer.dropOtherScales(scale);
+        this->view->drawingMutex.unlock();
+    }
 
-        if (this->view->crBuffer) {
-            cairo_surface_destroy(this->view->crBuffer);
+    if (!rerenderComplete) {
+        // Rapid edits, e.g. an eraser pass, request many small overlapping rectangles
+        xoj::util::mergeRectangles(rerenderRects, MAX_RERENDER_WASTE);
+        if (rerenderRects.size() > MAX_RERENDER_RECTS) {
+            for (size_t i = 1; i < rerenderRects.size(); i++) { rerenderRects.front().unite(rerenderRects[i]); }
+            rerenderRects.resize(1);
         }
-        this->view->crBuffer = crBuffer;
 
-        this->view->drawingMutex.unlock();
-        doc->unlock();
-    } else {
-        for (Rectangle<double> const& rect: rerenderRects) { rerenderRectangle(rect); }
+        for (Rectangle<double> const& rect: rerenderRects) {
+            if (!rerenderRectangle(rect, scale)) {
+                // The changes must not be lost: the tiles are rendered again when they are painted next
+                this->view->drawingMutex.lock();
+                this->view->buffer.invalidate();
+                this->view->drawingMutex.unlock();
+                rerenderComplete = true;
+                break;
+            }
+        }
     }
 
-    // Schedule a repaint of the widget
-    repaintWidget(this->view->getXournal()->getWidget());
+    this->view->repaintRectMutex.lock();
+    this->view->runningRenderJobs--;
+    auto& jobs = this->view->renderJobs;
+    jobs.erase(std::remove(jobs.begin(), jobs.end(), this), jobs.end());
+    this->view->repaintRectMutex.unlock();
+
+    // Schedule a repaint of the page: the rest of the frame is still valid while scrolling
+    int x = this->view->getX();
+    int y = this->view->getY();
+    int displayWidth = this->view->getDisplayWidth();
+    int displayHeight = this->view->getDisplayHeight();
+    GtkWidget* widget = this->view->getXournal()->getWidget();
+    if (rerenderComplete || !tiles.empty()) {
+        repaintWidget(widget, x, y, x + displayWidth, y + displayHeight);
+        return;
+    }
+
+    // Only the rectangles changed: the widget is in logical pixels, which the rendered device pixels may overlap
+    double zoom = this->view->xournal->getZoom();
+    for (Rectangle<double> const& rect: rerenderRects) {
+        int x1 = std::clamp(static_cast<int>(std::floor(rect.x * zoom)) - 1, 0, displayWidth);
+        int y1 = std::clamp(static_cast<int>(std::floor(rect.y * zoom)) - 1, 0, displayHeight);
+        int x2 = std::clamp(static_cast<int>(std::ceil((rect.x + rect.width) * zoom)) + 1, 0, displayWidth);
+        int y2 = std::clamp(static_cast<int>(std::ceil((rect.y + rect.height) * zoom)) + 1, 0, displayHeight);
+        if (x1 < x2 && y1 < y2) {
+            repaintWidget(widget, x + x1, y + y1, x + x2, y + y2);
+        }
+    }
+}
+
+namespace {
+/**
+ * The areas of each widget rendered since the UI thread last repainted them: the areas of all the render jobs are
+ * repainted by one callback
+ */
+std::mutex pendingRepaintsMutex;
+std::unordered_map<GtkWidget*, cairo_region_t*> pendingRepaints;
+
+void repaintPendingAreas() {
+    std::unordered_map<GtkWidget*, cairo_region_t*> repaints;
+    {
+        std::lock_guard<std::mutex> lock(pendingRepaintsMutex);
+        repaints.swap(pendingRepaints);
+    }
+    for (auto& [widget, region]: repaints) {
+        for (int i = 0; i < cairo_region_num_rectangles(region); i++) {
+            cairo_rectangle_int_t rect;
+            cairo_region_get_rectangle(region, i, &rect);
+            gtk_xournal_repaint_area(widget, rect.x, rect.y, rect.x + rect.width, rect.y + rect.height);
+        }
+        cairo_region_destroy(region);
+    }
 }
+}  // namespace
 
 /**
- * Repaint the widget in UI Thread
+ * Repaint the area of the widget in UI Thread
  */
-void RenderJob::repaintWidget(GtkWidget* widget) {
-    // "this" is not needed, "widget" is in
-    // the closure, therefore no sync needed
-    // Because of this the argument "widget" is needed
-    Util::execInUiThread([=]() { gtk_widget_queue_draw(widget); });
+void RenderJob::repaintWidget(GtkWidget* widget, int x1, int y1, int x2, int y2) {
+    // "this" is not needed, the widget outlives the jobs of its pages
+    cairo_rectangle_int_t rect = {x1, y1, x2 - x1, y2 - y1};
+
+    std::lock_guard<std::mutex> lock(pendingRepaintsMutex);
+    bool scheduled = !pendingRepaints.empty();
+    auto [it, inserted] = pendingRepaints.try_emplace(widget, nullptr);
+    if (inserted) {
+        it->second = cairo_region_create_rectangle(&rect);
+    } else {
+        cairo_region_union_rectangle(it->second, &rect);
+    }
+    if (!scheduled) {
+        Util::execInUiThread(repaintPendingAreas);
+    }
 }
 
 auto RenderJob::getType() -> JobType { return JOB_TYPE_RENDER; }
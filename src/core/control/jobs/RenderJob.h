@@ -11,11 +11,13 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include <gtk/gtk.h>
 
+#include "gui/TiledPageBuffer.h"
 #include "util/Rectangle.h"
 
 #include "Job.h"
@@ -39,12 +41,70 @@ public:
 
 private:
     /**
-     * Repaint the widget in UI Thread
+     * Repaint the area of the widget in UI Thread
      */
-    static void repaintWidget(GtkWidget* widget);
+    static void repaintWidget(GtkWidget* widget, int x1, int y1, int x2, int y2);
 
-    void rerenderRectangle(xoj::util::Rectangle<double> const& rect);
+    /**
+     * @return false if the job was cancelled, and the rectangle not updated
+     */
+    bool rerenderRectangle(xoj::util::Rectangle<double> const& rect, double scale);
+
+    /**
+     * @return Whether the job may store its tiles: it was not cancelled, see XojPageView::cancelRendering()
+     */
+    bool isCurrent() const;
+
+    /**
+     * @return Whether the tiles of this scale are not needed anymore, after a zoom change
+     */
+    bool isSuperseded(double tileScale) const;
+
+    /**
+     * Renders a tile of the view buffer into a new surface
+     *
+     * @param background Set to a new surface of the background alone if keepsBackground(), to nullptr otherwise
+     */
+    cairo_surface_t* renderTile(TiledPageBuffer::TileKey const& key, cairo_surface_t** background);
+
+    enum class Part { ALL, BACKGROUND, LAYERS };
+
+    /**
+     * Draws the given area of the page, in page coordinates, on cr
+     */
+    void renderArea(cairo_t* cr, xoj::util::Rectangle<double> const& area, double scale, Part part = Part::ALL);
+
+    /**
+     * @return Whether the background of the page is costly to draw (PDF or image), and kept by the tiles
+     */
+    bool keepsBackground() const;
 
 private:
+    /**
+     * Number of tiles rendered at most for a page which was never painted (e.g. preloaded pages)
+     */
+    static constexpr size_t MAX_PRELOAD_TILES = 16;
+
+    /**
+     * The rerendered rectangles are merged while their union is at most this times the sum of their areas
+     */
+    static constexpr double MAX_RERENDER_WASTE = 1.5;
+
+    /**
+     * Beyond this number of rectangles after merging, their bounding box is rerendered at once
+     */
+    static constexpr size_t MAX_RERENDER_RECTS = 16;
+
     XojPageView* view;
+
+    /**
+     * XojPageView::renderGeneration when the job started
+     */
+    uint64_t generation = 0;
+
+    /**
+     * All the requests taken were made during an interaction: the tiles are rendered with the fast antialiasing and
+     * filters, and rendered again once the view settles, see XournalView::isDraftRendering()
+     */
+    bool draft = false;
 };
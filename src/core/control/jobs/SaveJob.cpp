@@ -1,8 +1,12 @@
 #include "SaveJob.h"
 
+#include <memory>
+
 #include <config.h>
 
 #include "control/Control.h"
+#include "control/xojfile/IndexedSaveHandler.h"
+#include "control/xojfile/RemoteFile.h"
 #include "control/xojfile/SaveHandler.h"
 #include "util/PathUtil.h"
 #include "util/XojMsgBox.h"
@@ -21,6 +25,9 @@ void SaveJob::run() {
 
     if (this->control->getWindow()) {
         callAfterRun();
+    } else if (this->lastError.empty()) {
+        // Nothing uploads it in the background
+        upload();
     }
 }
 
@@ -29,7 +36,19 @@ void SaveJob::afterRun() {
         XojMsgBox::showErrorToUser(control->getGtkWindow(), this->lastError);
     } else {
         this->control->resetSavedStatus();
+        if (!this->staged.empty()) {
+            this->control->uploadInBackground(this->staged, this->target);
+        }
+    }
+}
+
+auto SaveJob::upload() -> bool {
+    if (this->staged.empty()) {
+        return true;
     }
+    bool uploaded = RemoteFile::upload(this->staged, this->target, nullptr, nullptr, this->lastError);
+    this->staged.clear();
+    return uploaded;
 }
 
 void SaveJob::updatePreview(Control* control) {
@@ -41,6 +60,13 @@ void SaveJob::updatePreview(Control* control) {
 
     if (doc->getPageCount() > 0) {
         PageRef page = doc->getPage(0);
+        if (doc->isPreviewUpToDate(page)) {
+            // Saved again without a change of the first page
+            doc->unlock();
+            return;
+        }
+        // Before the rendering: a change made meanwhile renders the preview again on the next save
+        uint64_t revision = page->getRevision();
 
         double width = page->getWidth();
         double height = page->getHeight();
@@ -72,7 +98,7 @@ void SaveJob::updatePreview(Control* control) {
         DocumentView view;
         view.drawPage(page, cr, true);
         cairo_destroy(cr);
-        doc->setPreview(crBuffer);
+        doc->setPreview(crBuffer, page, revision);
         cairo_surface_destroy(crBuffer);
     } else {
         doc->setPreview(nullptr);
@@ -84,30 +110,57 @@ void SaveJob::updatePreview(Control* control) {
 auto SaveJob::save() -> bool {
     updatePreview(control);
     Document* doc = this->control->getDocument();
-    SaveHandler h;
+    SaveHandler plainHandler;
+    IndexedSaveHandler indexedHandler;
+    SaveHandler& h = this->control->getSettings()->isSaveIndexedLayout() ? indexedHandler : plainHandler;
+    h.setBinaryStrokes(this->control->getSettings()->isSaveBinaryStrokes());
 
     doc->lock();
-    h.prepareSave(doc);
     fs::path filepath = doc->getFilepath();
     doc->unlock();
 
     Util::clearExtensions(filepath, ".pdf");
     auto const target = fs::path{filepath}.concat(".xopp");
-    auto const createBackup = doc->shouldCreateBackupOnSave();
-
-    if (createBackup) {
-        try {
-            // Note: The backup must be created for the target as this is the filepath
-            // which will be written to. Do not use the `filepath` variable!
-            Util::safeRenameFile(target, fs::path{target} += "~");
-        } catch (fs::filesystem_error const& fe) {
-            g_warning("Could not create backup! Failed with %s", fe.what());
+    h.loadOverwrittenLayers(doc, target);
+
+    // A remote file is saved into a local staging folder, which is uploaded in the background, see RemoteFile
+    this->target = target;
+    this->staged.clear();
+    if (RemoteFile::isRemote(target)) {
+        fs::path folder = RemoteFile::createStagingFolder();
+        if (folder.empty()) {
+            this->lastError = FS(_F("Save file error: {1}") % _("Could not create the staging folder of the upload"));
             return false;
         }
+        this->staged = folder / target.filename();
     }
 
+    // The document is saved from a snapshot, so that it can be edited in the meantime
+    doc->lock();
+    std::unique_ptr<Document> snapshot = doc->snapshot();
+    doc->unlock();
+
+    h.prepareSave(snapshot.get());
+    // The upload also replaces the target once the new file is written
+    auto const createBackup = snapshot->shouldCreateBackupOnSave() && this->staged.empty();
+
+    // The handlers replace the target once the new file is written, and keep it on a failure. The previous version is
+    // kept as a hard link during the save: nothing is copied.
+    auto const backup = fs::path{target} += "~";
+    std::error_code ec;
+    if (createBackup && fs::exists(target, ec)) {
+        // Note: The backup must be created for the target as this is the filepath
+        // which will be written to. Do not use the `filepath` variable!
+        fs::remove(backup, ec);
+        fs::create_hard_link(target, backup, ec);
+        if (ec) {
+            g_message("Could not create backup, the target is replaced once saved: %s", ec.message().c_str());
+        }
+    }
+
+    h.saveTo(this->staged.empty() ? target : this->staged, this->control);
+
     doc->lock();
-    h.saveTo(target, this->control);
     doc->setFilepath(target);
     doc->unlock();
 
@@ -116,12 +169,17 @@ auto SaveJob::save() -> bool {
         if (!control->getWindow()) {
             g_error("%s", this->lastError.c_str());
         }
+        if (!this->staged.empty()) {
+            fs::remove_all(this->staged.parent_path(), ec);
+            this->staged.clear();
+        }
         return false;
     } else if (createBackup) {
-        try {
-            // If a backup was created it can be removed now since no error occured during the save
-            fs::remove(fs::path{target} += "~");
-        } catch (fs::filesystem_error const& fe) { g_warning("Could not delete backup! Failed with %s", fe.what()); }
+        // If a backup was created it can be removed now since no error occured during the save
+        fs::remove(backup, ec);
+        if (ec) {
+            g_warning("Could not delete backup! Failed with %s", ec.message().c_str());
+        }
     } else {
         doc->setCreateBackupOnSave(true);
     }
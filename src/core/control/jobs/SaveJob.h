@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "BlockingJob.h"
+#include "filesystem.h"
 
 
 class SaveJob: public BlockingJob {
@@ -29,6 +30,12 @@ public:
 
     bool save();
 
+    /**
+     * Uploads a remote document saved by save() on the calling thread, instead of in the background
+     * @return false if the upload failed
+     */
+    bool upload();
+
     static void updatePreview(Control* control);
 
 protected:
@@ -36,4 +43,10 @@ protected:
 
 private:
     std::string lastError;
+
+    /**
+     * The file saved to, and its copy in a staging folder to upload if it is remote
+     */
+    fs::path target;
+    fs::path staged;
 };
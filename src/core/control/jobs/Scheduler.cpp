@@ -1,10 +1,14 @@
 #include "Scheduler.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
+#include <thread>
 
 #include <config-debug.h>
 
+#include "util/Profiler.h"
+
 #ifdef DEBUG_SHEDULER
 #define SDEBUG g_message
 #else
@@ -39,25 +43,40 @@ Scheduler::~Scheduler() {
     }
 }
 
+void Scheduler::setWorkerCount(unsigned int count) {
+    g_return_if_fail(this->threads.empty());
+    this->workerCount = count;
+}
+
 void Scheduler::start() {
     SDEBUG("Starting scheduler");
-    g_return_if_fail(this->thread == nullptr);
+    g_return_if_fail(this->threads.empty());
+
+    unsigned int count = this->workerCount;
+    if (count == 0) {
+        // Keep one core for the UI thread
+        count = std::clamp(std::thread::hardware_concurrency(), 2U, 9U) - 1;
+    }
 
-    this->thread = g_thread_new(name.c_str(), reinterpret_cast<GThreadFunc>(jobThreadCallback), this);
+    for (unsigned int i = 0; i < count; i++) {
+        this->threads.push_back(g_thread_new(name.c_str(), reinterpret_cast<GThreadFunc>(jobThreadCallback), this));
+    }
 }
 
 void Scheduler::stop() {
     SDEBUG("Stopping scheduler");
 
-    if (!this->threadRunning) {
-        return;
+    {
+        std::lock_guard lock{this->jobQueueMutex};
+        if (!this->threadRunning) {
+            return;
+        }
+        this->threadRunning = false;
     }
-    this->threadRunning = false;
     this->jobQueueCond.notify_all();
 
-    if (this->thread) {
-        g_thread_join(this->thread);
-    }
+    for (GThread* thread: this->threads) { g_thread_join(thread); }
+    this->threads.clear();
 }
 
 void Scheduler::addJob(Job* job, JobPriority priority) {
@@ -67,37 +86,82 @@ void Scheduler::addJob(Job* job, JobPriority priority) {
         std::lock_guard lock{this->jobQueueMutex};
 
         job->ref();
+        job->queuedAt = std::chrono::steady_clock::now();
         this->jobQueue[priority]->push_back(job);
+        reportQueueLengthsUnlocked();
     }
 
     SDEBUG("add job: %" PRId64 "; type: %" PRId64, (uint64_t)job, (uint64_t)job->getType());
     this->jobQueueCond.notify_all();
 }
 
-auto Scheduler::getNextJobUnlocked(bool onlyNotRender, bool* hasRenderJobs) -> Job* {
-    Job* job = nullptr;
+auto Scheduler::isParallelizable(Job* job) -> bool {
+    JobType type = job->getType();
+    return type == JOB_TYPE_RENDER || type == JOB_TYPE_PREVIEW;
+}
+
+auto Scheduler::canRunUnlocked(Job* job) const -> bool {
+    if (this->exclusiveJobRunning) {
+        return false;
+    }
+    if (!isParallelizable(job)) {
+        return this->runningJobs == 0;
+    }
+    void* source = job->getSource();
+    return source == nullptr ||
+           std::find(this->runningSources.begin(), this->runningSources.end(), source) == this->runningSources.end();
+}
 
+auto Scheduler::getEffectivePriority(int priority, std::chrono::steady_clock::duration waited) -> int {
+    auto const deadline = DEADLINES[static_cast<size_t>(priority)];
+    if (waited <= deadline) {
+        return priority;
+    }
+    auto const missed = static_cast<int>(std::min<int64_t>(waited / deadline, JOB_N_PRIORITIES));
+    return std::max(priority - missed, static_cast<int>(JOB_PRIORITY_URGENT));
+}
+
+auto Scheduler::getNextJobUnlocked(bool onlyNotRender, bool* hasRenderJobs) -> Job* {
+    // The queues by the effective priority of their oldest job, then by its deadline
+    auto const now = std::chrono::steady_clock::now();
+    std::array<int, JOB_N_PRIORITIES> order{};
+    std::array<std::pair<int, std::chrono::steady_clock::time_point>, JOB_N_PRIORITIES> ranks{};
     for (int i = JOB_PRIORITY_URGENT; i < JOB_N_PRIORITIES; i++) {
-        std::deque<Job*>& queue = *this->jobQueue[i];
+        order[i] = i;
+        ranks[i] = {i, now};
+        if (!this->jobQueue[i]->empty()) {
+            auto const queuedAt = this->jobQueue[i]->front()->queuedAt;
+            ranks[i] = {getEffectivePriority(i, now - queuedAt), queuedAt + DEADLINES[i]};
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&ranks](int a, int b) { return ranks[a] < ranks[b]; });
 
-        if (onlyNotRender) {
-            for (auto it = queue.begin(); it != queue.end(); ++it) {
-                job = *it;
+    for (int i: order) {
+        std::deque<Job*>& queue = *this->jobQueue[i];
 
-                if (job->getType() != JOB_TYPE_RENDER) {
-                    queue.erase(it);
-                    return job;
-                }
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            Job* job = *it;
+            assert(job != nullptr);
 
+            if (onlyNotRender && job->getType() == JOB_TYPE_RENDER) {
                 if (hasRenderJobs != nullptr) {
                     *hasRenderJobs = true;
                 }
+                continue;
+            }
+
+            if (!canRunUnlocked(job)) {
+                if (!isParallelizable(job)) {
+                    // Do not overtake a job waiting for the others to finish, or it may never run
+                    return nullptr;
+                }
+                // Another job with the same source is running
+                continue;
             }
-        } else if (!queue.empty()) {
-            job = queue.front();
-            queue.pop_front();
-            assert(job != nullptr);
 
+            queue.erase(it);
+            reportQueueLengthsUnlocked();
+            reportWaitUnlocked(job, i, now);
             return job;
         }
     }
@@ -105,15 +169,63 @@ auto Scheduler::getNextJobUnlocked(bool onlyNotRender, bool* hasRenderJobs) -> J
     return nullptr;
 }
 
+void Scheduler::reportWaitUnlocked(Job* job, int priority, std::chrono::steady_clock::time_point now) const {
+    auto& profiler = xoj::util::Profiler::getInstance();
+    if (!profiler.isEnabled()) {
+        return;
+    }
+
+    static constexpr std::array<const char*, JOB_N_PRIORITIES> NAMES = {"wait urgent", "wait high", "wait low",
+                                                                         "wait none"};
+    profiler.addTiming(NAMES[priority], "scheduler", job->queuedAt, now - job->queuedAt);
+    // A hit is a deadline met
+    profiler.countAccess("job deadlines", now - job->queuedAt <= DEADLINES[priority]);
+}
+
+void Scheduler::reportQueueLengthsUnlocked() const {
+    auto& profiler = xoj::util::Profiler::getInstance();
+    if (!profiler.isEnabled()) {
+        return;
+    }
+
+    static constexpr std::array<const char*, JOB_N_PRIORITIES> NAMES = {"queue urgent", "queue high", "queue low",
+                                                                         "queue none"};
+    for (int i = JOB_PRIORITY_URGENT; i < JOB_N_PRIORITIES; i++) {
+        profiler.setCounter(NAMES[i], static_cast<int64_t>(this->jobQueue[i]->size()));
+    }
+}
+
 /**
  * Locks the complete scheduler
  */
-void Scheduler::lock() { this->schedulerMutex.lock(); }
+void Scheduler::lock() {
+    std::unique_lock lock{this->jobQueueMutex};
+    this->pendingLockRequests++;
+    this->jobQueueCond.wait(lock, [this]() { return this->runningJobs == 0 && !this->locked; });
+    this->pendingLockRequests--;
+    this->locked = true;
+}
 
 /**
  * Unlocks the complete scheduler
  */
-void Scheduler::unlock() { this->schedulerMutex.unlock(); }
+void Scheduler::unlock() {
+    {
+        std::lock_guard lock{this->jobQueueMutex};
+        this->locked = false;
+    }
+    this->jobQueueCond.notify_all();
+}
+
+void Scheduler::awaitRunningJobs() {
+    {
+        std::unique_lock lock{this->jobQueueMutex};
+        this->pendingLockRequests++;
+        this->jobQueueCond.wait(lock, [this]() { return this->runningJobs == 0; });
+        this->pendingLockRequests--;
+    }
+    this->jobQueueCond.notify_all();
+}
 
 #define ZOOM_WAIT_US_TIMEOUT 300000  // 0.3s
 
@@ -180,10 +292,14 @@ auto Scheduler::jobRenderThreadTimer(Scheduler* scheduler) -> bool {
 }
 
 auto Scheduler::jobThreadCallback(Scheduler* scheduler) -> gpointer {
+    std::unique_lock jobLock{scheduler->jobQueueMutex};
+
     while (scheduler->threadRunning) {
-        // lock the whole scheduler
-        std::unique_lock schedulerLock{scheduler->schedulerMutex};
-        SDEBUG("Job Thread: Blocked scheduler.");
+        if (scheduler->locked || scheduler->pendingLockRequests > 0) {
+            SDEBUG("Job Thread: Scheduler locked.");
+            scheduler->jobQueueCond.wait(jobLock);
+            continue;
+        }
 
         bool onlyNonRenderJobs = false;
         glong diff = 1000;
@@ -205,44 +321,50 @@ auto Scheduler::jobThreadCallback(Scheduler* scheduler) -> gpointer {
             }
         }
 
-        Job* job;
-
-        {
-            std::unique_lock jobLock{scheduler->jobQueueMutex};
-            SDEBUG("Job Thread: Locked job queue.");
+        bool hasOnlyRenderJobs = false;
+        Job* job = scheduler->getNextJobUnlocked(onlyNonRenderJobs, &hasOnlyRenderJobs);
+        SDEBUG("get job: %" PRId64, (uint64_t)job);
 
-            bool hasOnlyRenderJobs = false;
-            job = scheduler->getNextJobUnlocked(onlyNonRenderJobs, &hasOnlyRenderJobs);
-            if (job != nullptr) {
-                hasOnlyRenderJobs = false;
+        if (job == nullptr) {
+            if (hasOnlyRenderJobs) {
+                if (scheduler->jobRenderThreadTimerId) {
+                    g_source_remove(scheduler->jobRenderThreadTimerId);
+                }
+                scheduler->jobRenderThreadTimerId = g_timeout_add(
+                        static_cast<guint>(diff), reinterpret_cast<GSourceFunc>(jobRenderThreadTimer), scheduler);
             }
 
-            SDEBUG("get job: %" PRId64, (uint64_t)job);
-
-            if (job == nullptr) {
-                // unlock the whole scheduler
-                schedulerLock.unlock();
+            scheduler->jobQueueCond.wait(jobLock);
+            continue;
+        }
 
-                if (hasOnlyRenderJobs) {
-                    if (scheduler->jobRenderThreadTimerId) {
-                        g_source_remove(scheduler->jobRenderThreadTimerId);
-                    }
-                    scheduler->jobRenderThreadTimerId = g_timeout_add(
-                            static_cast<guint>(diff), reinterpret_cast<GSourceFunc>(jobRenderThreadTimer), scheduler);
-                }
+        bool exclusive = !isParallelizable(job);
+        void* source = job->getSource();
 
-                scheduler->jobQueueCond.wait(jobLock);
-                continue;
-            }
+        scheduler->runningJobs++;
+        scheduler->exclusiveJobRunning = exclusive;
+        if (source) {
+            scheduler->runningSources.push_back(source);
         }
 
         // Run the job.
-        {
-            std::lock_guard lock{scheduler->jobRunningMutex};
-            SDEBUG("do job: %" PRId64, (uint64_t)job);
-            job->execute();
-            job->unref();
+        jobLock.unlock();
+        SDEBUG("do job: %" PRId64, (uint64_t)job);
+        job->execute();
+        job->unref();
+        jobLock.lock();
+
+        scheduler->runningJobs--;
+        if (exclusive) {
+            scheduler->exclusiveJobRunning = false;
         }
+        if (source) {
+            auto& sources = scheduler->runningSources;
+            sources.erase(std::find(sources.begin(), sources.end(), source));
+        }
+
+        // Wake up the other workers, and the threads waiting in lock() or awaitRunningJobs()
+        scheduler->jobQueueCond.notify_all();
 
         SDEBUG("next");
     }
@@ -14,10 +14,12 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <gtk/gtk.h>
 
@@ -33,7 +35,7 @@
  *
  * The priority of the job affects the order of execution:
  * Jobs with higher priority are processed before the
- * lower ones.
+ * lower ones, until they waited past their deadline (see Scheduler::DEADLINES).
  */
 enum JobPriority {
     /**
@@ -79,11 +81,18 @@ public:
      */
     void addJob(Job* job, JobPriority priority);
 
+    /**
+     * Sets the number of worker threads. Must be called before start().
+     *
+     * @param count the number of threads, or 0 to pick one depending on the number of CPU cores
+     */
+    void setWorkerCount(unsigned int count);
+
     void start();
     void stop();
 
     /**
-     * Locks the complete scheduler
+     * Locks the complete scheduler: waits for all running jobs to finish, no job is started until unlock() is called
      */
     void lock();
 
@@ -102,28 +111,99 @@ public:
      */
     void unblockRerenderZoom();
 
+    /**
+     * @return The priority a job of the given priority competes with once it waited for the given time: one level
+     *         higher for each deadline it missed
+     */
+    static int getEffectivePriority(int priority, std::chrono::steady_clock::duration waited);
+
+    /**
+     * The time a job of each priority may wait in its queue: a frame for the visible pages, somewhat longer for the
+     * previews and the pages around, then the other jobs (autosave, saving, export...). A job which waited longer is
+     * aged, see getEffectivePriority(): among the queues of the same effective priority, the one whose oldest job has
+     * the earliest deadline goes first. A continuous stream of render jobs then delays the other jobs by a few of their
+     * deadlines at most.
+     */
+    static constexpr std::array<std::chrono::milliseconds, JOB_N_PRIORITIES> DEADLINES = {
+            std::chrono::milliseconds(16), std::chrono::milliseconds(100), std::chrono::milliseconds(500),
+            std::chrono::milliseconds(2000)};
+
+protected:
+    /**
+     * Blocks until all currently running Job%s have been executed
+     */
+    void awaitRunningJobs();
+
 private:
     static gpointer jobThreadCallback(Scheduler* scheduler);
     Job* getNextJobUnlocked(bool onlyNotRender = false, bool* hasRenderJobs = nullptr);
 
+    /**
+     * Jobs of those types may run in parallel to each other, as long as they do not share the same source.
+     * Any other job runs alone.
+     */
+    static bool isParallelizable(Job* job);
+
+    /**
+     * Whether the job may be started now, given the currently running jobs. jobQueueMutex must be locked.
+     */
+    bool canRunUnlocked(Job* job) const;
+
     static bool jobRenderThreadTimer(Scheduler* scheduler);
 
+protected:
+    /**
+     * Reports the length of each queue to the Profiler. jobQueueMutex must be locked.
+     */
+    void reportQueueLengthsUnlocked() const;
+
+    /**
+     * Reports the time the job waited in its queue to the Profiler, by priority, and whether it met its deadline.
+     * jobQueueMutex must be locked.
+     */
+    void reportWaitUnlocked(Job* job, int priority, std::chrono::steady_clock::time_point now) const;
+
 protected:
     bool threadRunning = true;
 
     int jobRenderThreadTimerId = 0;
 
-    GThread* thread = nullptr;
+    unsigned int workerCount = 0;
+    std::vector<GThread*> threads;
 
     std::condition_variable jobQueueCond{};
+
+    /**
+     * Protects the queues and the state of the running jobs below
+     */
     std::mutex jobQueueMutex{};
-    std::mutex schedulerMutex{};
 
     /**
+     * Number of jobs being executed.
      * This is need to be sure there is no job running if we delete a page.
      * If a job is, we may access deleted memory.
      */
-    std::mutex jobRunningMutex{};
+    int runningJobs = 0;
+
+    /**
+     * A job which is not parallelizable is running
+     */
+    bool exclusiveJobRunning = false;
+
+    /**
+     * Sources of the running jobs
+     */
+    std::vector<void*> runningSources;
+
+    /**
+     * Number of threads waiting in lock() or awaitRunningJobs(). No new job is started while this is not 0.
+     */
+    int pendingLockRequests = 0;
+
+    /**
+     * The scheduler is locked by lock()
+     */
+    bool locked = false;
 
     /**
      * Jobs of each priority. New jobs
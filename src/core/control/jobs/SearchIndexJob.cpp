@@ -0,0 +1,11 @@
+#include "SearchIndexJob.h"
+
+#include <utility>
+
+SearchIndexJob::SearchIndexJob(std::shared_ptr<SearchIndex::PdfText> text): text(std::move(text)) {}
+
+auto SearchIndexJob::getType() -> JobType { return JOB_TYPE_RENDER; }
+
+auto SearchIndexJob::getSource() -> void* { return this->text.get(); }
+
+void SearchIndexJob::run() { this->text->extract(); }
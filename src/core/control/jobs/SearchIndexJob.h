@@ -0,0 +1,39 @@
+/*
+ * Xournal++
+ *
+ * Extracts the text of the PDF pages for the search
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "control/SearchIndex.h"
+
+#include "Job.h"
+
+/**
+ * @brief Fills the SearchIndex with the text of the pages of the PDF background
+ */
+class SearchIndexJob: public Job {
+public:
+    explicit SearchIndexJob(std::shared_ptr<SearchIndex::PdfText> text);
+
+protected:
+    ~SearchIndexJob() override = default;
+
+public:
+    JobType getType() override;
+
+    void* getSource() override;
+
+    void run() override;
+
+private:
+    std::shared_ptr<SearchIndex::PdfText> text;
+};
@@ -0,0 +1,88 @@
+#include "SearchJob.h"
+
+#include <utility>
+#include <vector>
+
+#include "control/SearchControl.h"
+#include "control/SearchIndex.h"
+#include "gui/SearchBar.h"
+#include "model/Document.h"
+#include "model/XojPage.h"
+#include "util/Util.h"
+
+SearchJob::SearchJob(SearchBar* bar, Document* doc, const SearchIndex* index, std::string text, size_t startPage,
+                     bool forward, std::shared_ptr<std::atomic<bool>> cancelled):
+        bar(bar),
+        doc(doc),
+        index(index),
+        text(std::move(text)),
+        startPage(startPage),
+        forward(forward),
+        cancelled(std::move(cancelled)),
+        foundPage(npos) {}
+
+auto SearchJob::getType() -> JobType { return JOB_TYPE_RENDER; }
+
+auto SearchJob::getSource() -> void* { return this->bar; }
+
+void SearchJob::run() {
+    this->doc->lockShared();
+    size_t count = this->doc->getPageCount();
+    this->doc->unlockShared();
+
+    for (size_t i = 1; i < count && !*this->cancelled; i++) {
+        size_t pageNr = this->forward ? (this->startPage + i) % count : (this->startPage + count - i) % count;
+        if (searchPage(pageNr)) {
+            this->foundPage = pageNr;
+            break;
+        }
+        if (i % 10 == 0) {
+            reportProgress(i, count);
+        }
+    }
+
+    callAfterRun();
+}
+
+auto SearchJob::searchPage(size_t pageNr) -> bool {
+    this->doc->lockShared();
+    PageRef page = this->doc->getPage(pageNr);
+    this->doc->unlockShared();
+    if (!page) {
+        return false;
+    }
+
+    this->doc->lockPage(*page);
+    if (!this->index->mayContain(page, this->text)) {
+        this->doc->unlockPage(*page);
+        return false;
+    }
+    std::vector<XojPdfRectangle> results = SearchControl::findInTextElements(page, this->text);
+    size_t pdfPage = page->getPdfPageNr();
+    XojPdfPageSPtr pdf = pdfPage != npos ? this->doc->getPdfPage(pdfPage) : nullptr;
+    this->doc->unlockPage(*page);
+
+    // Without the document lock: Poppler can take a while
+    if (pdf) {
+        std::vector<XojPdfRectangle> pdfResults = pdf->findText(this->text);
+        results.insert(results.end(), pdfResults.begin(), pdfResults.end());
+    }
+
+    this->occurrences = static_cast<int>(results.size());
+    this->top = SearchControl::getTop(results);
+    return !results.empty();
+}
+
+void SearchJob::reportProgress(size_t searched, size_t count) {
+    Util::execInUiThread([bar = this->bar, cancelled = this->cancelled, searched, count]() {
+        if (!*cancelled) {
+            bar->searchProgress(searched, count);
+        }
+    });
+}
+
+void SearchJob::afterRun() {
+    if (!*this->cancelled) {
+        this->bar->searchFinished(this->foundPage, this->occurrences, this->top);
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * Xournal++
+ *
+ * Searches the pages for the next occurrence of a text
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "Job.h"
+
+class Document;
+class SearchBar;
+class SearchIndex;
+
+/**
+ * @brief Searches the pages after (or before) the current one for a text, in the background
+ *
+ * The pages are searched in the order they are shown, wrapping around, skipping the pages the SearchIndex rules out.
+ * The progress and the first page the text is found on are given to the SearchBar in the UI thread, unless the search
+ * was cancelled in the meantime, e.g. because the text changed.
+ */
+class SearchJob: public Job {
+public:
+    /**
+     * @param cancelled Set by the SearchBar to stop the search
+     */
+    SearchJob(SearchBar* bar, Document* doc, const SearchIndex* index, std::string text, size_t startPage,
+              bool forward, std::shared_ptr<std::atomic<bool>> cancelled);
+
+protected:
+    ~SearchJob() override = default;
+
+public:
+    JobType getType() override;
+
+    void* getSource() override;
+
+    void run() override;
+
+protected:
+    void afterRun() override;
+
+private:
+    /**
+     * @return true if the text is on the page
+     */
+    bool searchPage(size_t pageNr);
+
+    void reportProgress(size_t searched, size_t count);
+
+private:
+    SearchBar* bar;
+    Document* doc;
+    const SearchIndex* index;
+    std::string text;
+    size_t startPage;
+    bool forward;
+    std::shared_ptr<std::atomic<bool>> cancelled;
+
+    /**
+     * The result, set by run()
+     */
+    size_t foundPage;
+    int occurrences = 0;
+    double top = 0;
+};
@@ -0,0 +1,46 @@
+#include "UploadJob.h"
+
+#include <utility>
+
+#include "control/Control.h"
+#include "control/xojfile/RemoteFile.h"
+#include "util/i18n.h"
+#include "util/logger/AsyncLog.h"
+
+UploadJob::UploadJob(Control* control, fs::path staged, fs::path target):
+        control(control), staged(std::move(staged)), target(std::move(target)), cancellable(g_cancellable_new()) {}
+
+UploadJob::~UploadJob() { g_object_unref(this->cancellable); }
+
+void UploadJob::run() {
+    gint64 startTime = g_get_monotonic_time();
+    if (!RemoteFile::upload(this->staged, this->target, this, this->cancellable, this->error)) {
+        if (this->error.empty()) {
+            this->error = FS(_F("Could not write file \"{1}\"") % this->target.u8string());
+        }
+        g_warning("%s", this->error.c_str());
+    }
+
+    XOJ_LOG_EVENT("upload", {{"ms", static_cast<double>(g_get_monotonic_time() - startTime) / 1000},
+                             {"failed", this->error.empty() ? 0.0 : 1.0}});
+}
+
+void UploadJob::afterRun() { this->control->backgroundUploadFinished(); }
+
+auto UploadJob::getType() -> JobType { return JOB_TYPE_AUTOSAVE; }
+
+void UploadJob::runInBackground() {
+    run();
+    callAfterRun();
+}
+
+void UploadJob::cancelUpload() {
+    cancel();
+    g_cancellable_cancel(this->cancellable);
+}
+
+auto UploadJob::getError() const -> const std::string& { return this->error; }
+
+void UploadJob::setMaximumState(int max) { this->control->setMaximumState(max); }
+
+void UploadJob::setCurrentState(int state) { this->control->setCurrentState(state); }
@@ -0,0 +1,68 @@
+/*
+ * Xournal++
+ *
+ * Uploads a saved document to its remote file
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <string>
+
+#include <gio/gio.h>
+
+#include "Job.h"
+#include "ProgressListener.h"
+#include "filesystem.h"
+
+class Control;
+
+/**
+ * @brief Uploads the files which a SaveJob wrote into a staging folder to the remote folder of the document, see
+ * RemoteFile::upload(). Runs on a thread of its own, without blocking the UI, see Control::uploadInBackground().
+ */
+class UploadJob: public Job, public ProgressListener {
+public:
+    UploadJob(Control* control, fs::path staged, fs::path target);
+
+protected:
+    ~UploadJob() override;
+
+public:
+    void run() override;
+    void afterRun() override;
+
+    JobType getType() override;
+
+    /**
+     * Runs the upload on the calling thread, then calls Control::backgroundUploadFinished() from the UI thread
+     */
+    void runInBackground();
+
+    /**
+     * Stops the upload at once, the remote file is kept
+     */
+    void cancelUpload();
+
+    /**
+     * @return The error message, empty if the file was uploaded. Only valid once finished.
+     */
+    const std::string& getError() const;
+
+public:
+    // ProgressListener interface, forwarded to the Control
+    void setMaximumState(int max) override;
+    void setCurrentState(int state) override;
+
+private:
+    Control* control = nullptr;
+    fs::path staged;
+    fs::path target;
+
+    GCancellable* cancellable = nullptr;
+    std::string error;
+};
@@ -1,7 +1,17 @@
 #include "XournalScheduler.h"
 
+#include <utility>
+
+#include "control/Control.h"
+
+#include "OutlineJob.h"
+#include "PdfPrefetchJob.h"
+#include "PdfReloadJob.h"
+#include "PdfTextJob.h"
+#include "PrintPageJob.h"
 #include "PreviewJob.h"
 #include "RenderJob.h"
+#include "SearchIndexJob.h"
 
 XournalScheduler::XournalScheduler() { this->name = "XournalScheduler"; }
 
@@ -14,7 +24,21 @@ void XournalScheduler::removeSidebar(SidebarPreviewBaseEntry* preview) {
     removeSource(preview, JOB_TYPE_PREVIEW, JOB_PRIORITY_HIGH, waitForTaskCompletion);
 }
 
-void XournalScheduler::removePage(XojPageView* view) { removeSource(view, JOB_TYPE_RENDER, JOB_PRIORITY_URGENT); }
+void XournalScheduler::removePage(XojPageView* view) {
+    removeSource(view, JOB_TYPE_RENDER, JOB_PRIORITY_HIGH, false);
+    removeSource(view, JOB_TYPE_RENDER, JOB_PRIORITY_URGENT);
+}
+
+void XournalScheduler::removePdfCache(PdfCache* cache) { removeSource(cache, JOB_TYPE_RENDER, JOB_PRIORITY_LOW); }
+
+void XournalScheduler::removePdfTextCache(PdfTextCache* cache) {
+    removeSource(cache, JOB_TYPE_RENDER, JOB_PRIORITY_LOW);
+}
+
+void XournalScheduler::removePrintPages(void* printOperation) {
+    // The running jobs do not report to a finished print operation
+    removeSource(printOperation, JOB_TYPE_RENDER, JOB_PRIORITY_LOW, false);
+}
 
 void XournalScheduler::removeAllJobs() {
     std::lock_guard lock{this->jobQueueMutex};
@@ -41,9 +65,10 @@ void XournalScheduler::removeAllJobs() {
             }
         }
     }
+    reportQueueLengthsUnlocked();
 }
 
-void XournalScheduler::finishTask() { std::lock_guard lock{this->jobRunningMutex}; }
+void XournalScheduler::finishTask() { awaitRunningJobs(); }
 
 void XournalScheduler::removeSource(void* source, JobType type, JobPriority priority, bool awaitFinishTask) {
     {
@@ -65,6 +90,7 @@ void XournalScheduler::removeSource(void* source, JobType type, JobPriority prio
                 ++it;
             }
         }
+        reportQueueLengthsUnlocked();
     }
 
     // wait until the last job is done
@@ -107,3 +133,61 @@ void XournalScheduler::addRerenderPage(XojPageView* view) {
     addJob(job, JOB_PRIORITY_URGENT);
     job->unref();
 }
+
+void XournalScheduler::addRenderAhead(XojPageView* view) {
+    if (existsSource(view, JOB_TYPE_RENDER, JOB_PRIORITY_HIGH)) {
+        return;
+    }
+
+    auto* job = new RenderJob(view);
+    addJob(job, JOB_PRIORITY_HIGH);
+    job->unref();
+}
+
+void XournalScheduler::removeRenderAhead(XojPageView* view) {
+    removeSource(view, JOB_TYPE_RENDER, JOB_PRIORITY_HIGH, false);
+}
+
+void XournalScheduler::addPdfPrefetch(PdfCache* cache, std::vector<size_t> pdfPages, double zoom) {
+    removeSource(cache, JOB_TYPE_RENDER, JOB_PRIORITY_LOW, false);
+
+    auto* job = new PdfPrefetchJob(cache, std::move(pdfPages), zoom);
+    addJob(job, JOB_PRIORITY_LOW);
+    job->unref();
+}
+
+void XournalScheduler::addPdfText(PdfTextCache* cache, size_t pdfPage) {
+    auto* job = new PdfTextJob(cache, pdfPage);
+    addJob(job, JOB_PRIORITY_LOW);
+    job->unref();
+}
+
+void XournalScheduler::addPrintPage(void* printOperation, Document* doc, PageRef page,
+                                    std::function<void(cairo_surface_t*)> rendered) {
+    auto* job = new PrintPageJob(printOperation, doc, std::move(page), std::move(rendered));
+    addJob(job, JOB_PRIORITY_LOW);
+    job->unref();
+}
+
+void XournalScheduler::addSearchIndex(std::shared_ptr<SearchIndex::PdfText> text) {
+    auto* job = new SearchIndexJob(std::move(text));
+    addJob(job, JOB_PRIORITY_LOW);
+    job->unref();
+}
+
+void XournalScheduler::addReadOutline(Control* control, XojPdfDocument pdf) {
+    // A job which did not start yet reads the same outline
+    removeSource(control->getDocument(), JOB_TYPE_RENDER, JOB_PRIORITY_LOW, false);
+
+    auto* job = new OutlineJob(control, std::move(pdf));
+    addJob(job, JOB_PRIORITY_LOW);
+    job->unref();
+}
+
+void XournalScheduler::addReloadPdf(Control* control, unsigned int generation, fs::path file, XojPdfDocument previous,
+                                    std::vector<PdfPageSignature> previousSignatures) {
+    auto* job = new PdfReloadJob(control, generation, std::move(file), std::move(previous),
+                                 std::move(previousSignatures));
+    addJob(job, JOB_PRIORITY_LOW);
+    job->unref();
+}
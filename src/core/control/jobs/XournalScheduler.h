@@ -13,14 +13,25 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "control/PdfPageSignature.h"
+#include "control/SearchIndex.h"
 #include "gui/PageView.h"
 #include "gui/sidebar/previews/page/SidebarPreviewPageEntry.h"
+#include "model/PageRef.h"
+#include "pdf/base/XojPdfDocument.h"
 
 #include "Scheduler.h"
+#include "filesystem.h"
 
+class Control;
+class Document;
+class PdfCache;
+class PdfTextCache;
 class XournalScheduler: public Scheduler {
 public:
     XournalScheduler();
@@ -33,6 +44,9 @@ public:
      */
     void removeSidebar(SidebarPreviewBaseEntry* preview);
     void removePage(XojPageView* view);
+    void removePdfCache(PdfCache* cache);
+    void removePdfTextCache(PdfTextCache* cache);
+    void removePrintPages(void* printOperation);
 
     /**
      * Removes all PreviewJob%s / RenderJob%s scheduled to be run
@@ -42,6 +56,51 @@ public:
     void addRepaintSidebar(SidebarPreviewBaseEntry* preview);
     void addRerenderPage(XojPageView* view);
 
+    /**
+     * Renders the tiles of the page about to enter the viewport, after the visible ones
+     */
+    void addRenderAhead(XojPageView* view);
+
+    /**
+     * The page is not about to enter the viewport anymore
+     */
+    void removeRenderAhead(XojPageView* view);
+
+    /**
+     * Rasterizes the given PDF pages into the cache in the background.
+     * Replaces the prefetching which is still waiting for this cache.
+     */
+    void addPdfPrefetch(PdfCache* cache, std::vector<size_t> pdfPages, double zoom);
+
+    /**
+     * Extracts the text layout of the PDF page into the cache in the background, see PdfTextJob.
+     * The page must have been marked as pending, see PdfTextCache::markPending().
+     */
+    void addPdfText(PdfTextCache* cache, size_t pdfPage);
+
+    /**
+     * Records the drawing of a page to be printed in the background, see PrintPageJob
+     * @param rendered Called on the UI thread with the recording
+     */
+    void addPrintPage(void* printOperation, Document* doc, PageRef page,
+                      std::function<void(cairo_surface_t*)> rendered);
+
+    /**
+     * Extracts the text of the PDF pages for the search in the background
+     */
+    void addSearchIndex(std::shared_ptr<SearchIndex::PdfText> text);
+
+    /**
+     * Reads the outline of the PDF of the document in the background, see OutlineJob
+     */
+    void addReadOutline(Control* control, XojPdfDocument pdf);
+
+    /**
+     * Reads the PDF background file again in the background, see PdfReloadJob
+     */
+    void addReloadPdf(Control* control, unsigned int generation, fs::path file, XojPdfDocument previous,
+                      std::vector<PdfPageSignature> previousSignatures);
+
     /**
      * Blocks until all currently running Job%s have been executed
      */
@@ -0,0 +1,79 @@
+#include "LatexCache.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <glib.h>
+
+#include "util/PathUtil.h"
+
+LatexCache::LatexCache(fs::path folder): folder(std::move(folder)) {}
+
+auto LatexCache::getKey(const LatexSettings& settings, const std::string& texFileContents) -> std::string {
+    GChecksum* checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    // The command is followed by its terminating null character, so that it cannot run into the contents
+    g_checksum_update(checksum, reinterpret_cast<const guchar*>(settings.genCmd.c_str()),
+                      static_cast<gssize>(settings.genCmd.length() + 1));
+    g_checksum_update(checksum, reinterpret_cast<const guchar*>(texFileContents.data()),
+                      static_cast<gssize>(texFileContents.length()));
+    std::string key = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+    return key;
+}
+
+auto LatexCache::getFile(const std::string& key) const -> fs::path { return this->folder / (key + ".pdf"); }
+
+auto LatexCache::load(const std::string& key) -> std::optional<std::string> {
+    fs::path file = getFile(key);
+    std::error_code ec;
+    if (!fs::exists(file, ec)) {
+        return std::nullopt;
+    }
+
+    auto contents = Util::readString(file, false);
+    if (contents) {
+        // Most recently used
+        fs::last_write_time(file, fs::file_time_type::clock::now(), ec);
+    }
+    return contents;
+}
+
+void LatexCache::store(const std::string& key, const std::string& pdf) {
+    std::error_code ec;
+    fs::create_directories(this->folder, ec);
+    if (ec) {
+        g_warning("Could not create the LaTeX cache folder %s: %s", this->folder.u8string().c_str(),
+                  ec.message().c_str());
+        return;
+    }
+
+    // Written atomically, so that another instance never loads a partial file
+    fs::path file = getFile(key);
+    GError* err = nullptr;
+    if (!g_file_set_contents(file.u8string().c_str(), pdf.data(), static_cast<gssize>(pdf.length()), &err)) {
+        g_warning("Could not write the LaTeX cache file %s: %s", file.u8string().c_str(), err->message);
+        g_error_free(err);
+        return;
+    }
+
+    trim();
+}
+
+void LatexCache::trim() {
+    std::error_code ec;
+    std::vector<std::pair<fs::file_time_type, fs::path>> files;
+    for (const auto& entry: fs::directory_iterator(this->folder, ec)) {
+        if (entry.is_regular_file(ec) && entry.path().extension() == ".pdf") {
+            files.emplace_back(fs::last_write_time(entry.path(), ec), entry.path());
+        }
+    }
+    if (files.size() <= MAX_FILES) {
+        return;
+    }
+
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = MAX_FILES; i < files.size(); i++) {
+        fs::remove(files[i].second, ec);
+    }
+}
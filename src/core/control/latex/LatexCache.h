@@ -0,0 +1,61 @@
+/*
+ * Xournal++
+ *
+ * Cache of the compiled LaTeX formulas
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "control/settings/LatexSettings.h"
+
+#include "filesystem.h"
+
+/**
+ * @brief PDF files of the compiled formulas, stored in the cache folder by content hash
+ *
+ * The key of a formula is the hash of the instantiated template, which contains the formula and its color, and of the
+ * generator command. Editing a formula back to a previous state, or inserting a formula again, thus shows it without
+ * running LaTeX.
+ *
+ * The MAX_FILES most recently used formulas are kept.
+ */
+class LatexCache {
+public:
+    explicit LatexCache(fs::path folder);
+
+public:
+    /**
+     * @param texFileContents The instantiated template, see LatexGenerator::templateSub()
+     * @return The key of the compiled formula
+     */
+    static std::string getKey(const LatexSettings& settings, const std::string& texFileContents);
+
+    /**
+     * @return The PDF compiled for the key, or nothing if it is not in the cache
+     */
+    std::optional<std::string> load(const std::string& key);
+
+    void store(const std::string& key, const std::string& pdf);
+
+    static constexpr size_t MAX_FILES = 1000;
+
+private:
+    fs::path getFile(const std::string& key) const;
+
+    /**
+     * Delete the least recently used files
+     */
+    void trim();
+
+private:
+    fs::path folder;
+};
@@ -120,10 +120,11 @@ void LayerController::hideAllLayer() { hideOrHideAllLayer(false); }
  */
 void LayerController::hideOrHideAllLayer(bool show) {
     PageRef page = getCurrentPage();
+    auto previous = page->getLayerVisibility();
     for (Layer::Index i = 1; i <= page->getLayerCount(); i++) { page->setLayerVisible(i, show); }
 
     fireLayerVisibilityChanged();
-    control->getWindow()->getXournal()->layerChanged(selectedPage);
+    control->getWindow()->getXournal()->layerVisibilityChanged(selectedPage, previous);
 }
 
 void LayerController::addNewLayer() {
@@ -293,10 +294,12 @@ auto LayerController::getCurrentPage() const -> PageRef { return control->getDoc
 auto LayerController::getCurrentPageId() const -> size_t { return selectedPage; }
 
 void LayerController::setLayerVisible(Layer::Index layerId, bool visible) {
-    getCurrentPage()->setLayerVisible(layerId, visible);
+    PageRef page = getCurrentPage();
+    auto previous = page->getLayerVisibility();
+    page->setLayerVisible(layerId, visible);
     fireLayerVisibilityChanged();
 
-    control->getWindow()->getXournal()->layerChanged(selectedPage);
+    control->getWindow()->getXournal()->layerVisibilityChanged(selectedPage, previous);
 }
 
 /**
@@ -313,6 +316,7 @@ void LayerController::switchToLay(Layer::Index layerId, bool hideShow) {
         return;
     }
 
+    auto previous = p->getLayerVisibility();
     p->setSelectedLayerId(layerId);
 
     if (hideShow) {
@@ -320,7 +324,7 @@ void LayerController::switchToLay(Layer::Index layerId, bool hideShow) {
     }
 
     // Repaint page
-    control->getWindow()->getXournal()->layerChanged(selectedPage);
+    control->getWindow()->getXournal()->layerVisibilityChanged(selectedPage, previous);
     fireLayerVisibilityChanged();
 }
 
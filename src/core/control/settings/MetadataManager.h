@@ -12,27 +12,12 @@
 #pragma once
 
 #include <mutex>
-#include <string>
-#include <vector>
-
-#include <glib.h>
+#include <optional>
 
+#include "MetadataStore.h"
 #include "filesystem.h"
 
 
-class MetadataEntry {
-public:
-    MetadataEntry();
-
-public:
-    fs::path metadataFile;
-    bool valid;
-    fs::path path;
-    double zoom;
-    int page;
-    gint64 time;
-};
-
 class MetadataManager {
 public:
     MetadataManager();
@@ -55,29 +40,10 @@ public:
     void documentChanged();
 
 private:
-    /**
-     * Delete an old metadata file
-     */
-    static void deleteMetadataFile(fs::path const& path);
-
-    /**
-     * Parse a single metadata file
-     */
-    static MetadataEntry loadMetadataFile(fs::path const& path, fs::path const& file);
-
-    /**
-     * Store metadata to file
-     */
-    static void storeMetadata(MetadataEntry* m);
+    std::mutex mutex;
 
-private:
     /**
-     * Load the metadata list (sorted)
+     * The state of the current document, written to the MetadataStore once it is closed
      */
-    static std::vector<MetadataEntry> loadList();
-
-
-private:
-    std::mutex mutex;
-    MetadataEntry* metadata;
+    std::optional<MetadataEntry> metadata;
 };
@@ -0,0 +1,232 @@
+#include "MetadataStore.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "util/PathUtil.h"
+#include "util/serdesstream.h"
+
+MetadataEntry::MetadataEntry(): valid(false), zoom(1), page(0), time(0) {}
+
+MetadataStore::MetadataStore(fs::path file): file(std::move(file)) {
+    load();
+    this->writer = std::thread(&MetadataStore::writeLoop, this);
+}
+
+MetadataStore::~MetadataStore() {
+    {
+        std::lock_guard lock(this->mutex);
+        this->stopping = true;
+    }
+    this->changed.notify_all();
+    this->writer.join();
+}
+
+auto MetadataStore::getInstance() -> MetadataStore& {
+    static MetadataStore store(Util::getConfigSubfolder("metadata") / "metadata.log");
+    return store;
+}
+
+auto MetadataStore::formatRecord(const MetadataEntry& entry) -> std::string {
+    auto out = serdes_stream<std::ostringstream>();
+    out << entry.time << ' ' << entry.page << ' ' << entry.zoom << ' ' << entry.path.u8string() << '\n';
+    return out.str();
+}
+
+auto MetadataStore::parseRecord(const std::string& line) -> std::optional<MetadataEntry> {
+    auto in = serdes_stream<std::istringstream>(line);
+    MetadataEntry entry;
+    in >> entry.time >> entry.page >> entry.zoom;
+    if (in.fail() || in.get() != ' ') {
+        return std::nullopt;
+    }
+    std::string path;
+    std::getline(in, path);
+    if (path.empty()) {
+        return std::nullopt;
+    }
+    entry.path = fs::u8path(path);
+    entry.valid = true;
+    return entry;
+}
+
+void MetadataStore::load() {
+    std::ifstream in(this->file);
+    if (!in) {
+        importMetadataFiles();
+        return;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line != HEADER) {
+        g_warning("Ignoring the invalid metadata log %s", this->file.u8string().c_str());
+        this->writes.push_back({true, compacted()});
+        this->records = 0;
+        return;
+    }
+    while (std::getline(in, line)) {
+        // A record cut by a crash is skipped
+        if (auto entry = parseRecord(line)) {
+            put(std::move(*entry));
+            this->records++;
+        }
+    }
+    if (this->records > 2 * this->entries.size() + MAX_ENTRIES) {
+        this->writes.push_back({true, compacted()});
+        this->records = this->entries.size();
+    }
+}
+
+/**
+ * The format of the older versions: a file per document, named after the time it was stored
+ */
+void MetadataStore::importMetadataFiles() {
+    std::vector<fs::path> files;
+    try {
+        for (auto const& f: fs::directory_iterator(this->file.parent_path())) {
+            if (f.path().extension() == ".metadata") {
+                files.push_back(f.path());
+            }
+        }
+    } catch (const fs::filesystem_error& e) { g_warning("Could not read the metadata folder: %s", e.what()); }
+
+    for (const auto& path: files) {
+        std::ifstream in(path);
+        std::string header;
+        std::string document;
+        std::string page;
+        std::string zoom;
+        if (std::getline(in, header) && header == "XOJ-METADATA/1.0" && std::getline(in, document) &&
+            std::getline(in, page) && page.rfind("page=", 0) == 0 && std::getline(in, zoom) &&
+            zoom.rfind("zoom=", 0) == 0) {
+            MetadataEntry entry;
+            std::istringstream(document) >> entry.path;
+            entry.time = std::strtoll(path.stem().string().c_str(), nullptr, 10);
+            entry.page = static_cast<int>(std::strtol(page.c_str() + 5, nullptr, 10));
+            entry.zoom = std::strtod(zoom.c_str() + 5, nullptr);
+            entry.valid = !entry.path.empty();
+            if (entry.valid) {
+                put(std::move(entry));
+            }
+        }
+        in.close();
+
+        try {
+            fs::remove(path);
+        } catch (const fs::filesystem_error&) {
+            g_warning("Could not delete metadata file %s", path.u8string().c_str());
+        }
+    }
+    this->writes.push_back({true, compacted()});
+    this->records = this->entries.size();
+}
+
+void MetadataStore::put(MetadataEntry entry) {
+    auto key = entry.path.u8string();
+    auto it = this->entries.find(key);
+    if (it != this->entries.end() && it->second.time > entry.time) {
+        return;
+    }
+    this->entries[key] = std::move(entry);
+
+    if (this->entries.size() > MAX_ENTRIES) {
+        auto oldest = std::min_element(this->entries.begin(), this->entries.end(),
+                                       [](const auto& a, const auto& b) { return a.second.time < b.second.time; });
+        this->entries.erase(oldest);
+    }
+}
+
+auto MetadataStore::compacted() const -> std::string {
+    std::vector<const MetadataEntry*> sorted;
+    sorted.reserve(this->entries.size());
+    for (const auto& [key, entry]: this->entries) { sorted.push_back(&entry); }
+    std::sort(sorted.begin(), sorted.end(), [](auto* a, auto* b) { return a->time < b->time; });
+
+    std::string data = std::string(HEADER) + '\n';
+    for (const MetadataEntry* entry: sorted) { data += formatRecord(*entry); }
+    return data;
+}
+
+auto MetadataStore::get(const fs::path& document) const -> MetadataEntry {
+    std::lock_guard lock(this->mutex);
+    auto it = this->entries.find(document.u8string());
+    return it == this->entries.end() ? MetadataEntry() : it->second;
+}
+
+void MetadataStore::store(const MetadataEntry& entry) {
+    auto path = entry.path.u8string();
+    if (!entry.valid || path.empty() || path.find('\n') != std::string::npos) {
+        return;
+    }
+
+    {
+        std::lock_guard lock(this->mutex);
+        put(entry);
+        this->records++;
+        if (this->records > 2 * this->entries.size() + MAX_ENTRIES) {
+            this->records = this->entries.size();
+            this->writes.push_back({true, compacted()});
+        } else {
+            this->writes.push_back({false, formatRecord(entry)});
+        }
+    }
+    this->changed.notify_all();
+}
+
+void MetadataStore::flush() {
+    std::unique_lock lock(this->mutex);
+    this->changed.wait(lock, [this]() { return this->writes.empty() && !this->writing; });
+}
+
+auto MetadataStore::size() const -> size_t {
+    std::lock_guard lock(this->mutex);
+    return this->entries.size();
+}
+
+void MetadataStore::writeLoop() {
+    std::unique_lock lock(this->mutex);
+    while (true) {
+        this->changed.wait(lock, [this]() { return this->stopping || !this->writes.empty(); });
+        if (this->writes.empty()) {
+            return;
+        }
+        Write write = std::move(this->writes.front());
+        this->writes.pop_front();
+        this->writing = true;
+        lock.unlock();
+
+        if (write.replace) {
+            // Written beside and renamed, so that a crash leaves either log complete
+            auto tmp = this->file;
+            tmp += ".tmp";
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            out << write.data;
+            out.close();
+            std::error_code ec;
+            if (!out.fail()) {
+                fs::rename(tmp, this->file, ec);
+            }
+            if (out.fail() || ec) {
+                g_warning("Could not write the metadata log %s", this->file.u8string().c_str());
+            }
+        } else {
+            bool exists = fs::exists(this->file);
+            std::ofstream out(this->file, std::ios::binary | std::ios::app);
+            if (!exists) {
+                out << HEADER << '\n';
+            }
+            out << write.data;
+            if (out.fail()) {
+                g_warning("Could not write the metadata log %s", this->file.u8string().c_str());
+            }
+        }
+
+        lock.lock();
+        this->writing = false;
+        this->changed.notify_all();
+    }
+}
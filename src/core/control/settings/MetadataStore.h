@@ -0,0 +1,136 @@
+/*
+ * Xournal++
+ *
+ * The page and zoom of the recently opened documents
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <glib.h>
+
+#include "filesystem.h"
+
+class MetadataEntry {
+public:
+    MetadataEntry();
+
+public:
+    bool valid;
+    fs::path path;
+    double zoom;
+    int page;
+    gint64 time;
+};
+
+/**
+ * @brief The metadata of the documents in one log file, read once and written in the background
+ *
+ * Each store appends a record to the log, and the latest record of a document wins. The log is compacted, i.e.
+ * rewritten with one record per document, once it holds more than twice as many records as there are documents.
+ * Only the MAX_ENTRIES most recently stored documents are kept.
+ *
+ * The metadata files of the older versions, one per document in the same folder, are imported into the log once and
+ * deleted. Thread safe.
+ */
+class MetadataStore {
+public:
+    /**
+     * @param file The log. Created if missing, with the records of the metadata files of its folder.
+     */
+    explicit MetadataStore(fs::path file);
+
+    /**
+     * Writes the pending records
+     */
+    ~MetadataStore();
+
+    MetadataStore(const MetadataStore&) = delete;
+    MetadataStore& operator=(const MetadataStore&) = delete;
+
+    /**
+     * @return The store of the config folder
+     */
+    static MetadataStore& getInstance();
+
+public:
+    /**
+     * @return The metadata of the document, or an invalid entry
+     */
+    MetadataEntry get(const fs::path& document) const;
+
+    /**
+     * Replace the metadata of the document. Written to the disk in the background.
+     */
+    void store(const MetadataEntry& entry);
+
+    /**
+     * Wait until the records stored so far are written
+     */
+    void flush();
+
+    size_t size() const;
+
+    static constexpr size_t MAX_ENTRIES = 20;
+
+    static constexpr const char* HEADER = "XOJ-METADATA-LOG/1.0";
+
+private:
+    /**
+     * One line: the time, the page, the zoom and the path of the document, which ends the line
+     */
+    static std::string formatRecord(const MetadataEntry& entry);
+    static std::optional<MetadataEntry> parseRecord(const std::string& line);
+
+    /**
+     * Read the log, or import the metadata files of the older versions if there is none
+     */
+    void load();
+    void importMetadataFiles();
+
+    /**
+     * Apply a record, with the mutex locked
+     */
+    void put(MetadataEntry entry);
+
+    /**
+     * @return The log with one record per document, with the mutex locked
+     */
+    std::string compacted() const;
+
+    void writeLoop();
+
+private:
+    fs::path file;
+
+    std::unordered_map<std::string, MetadataEntry> entries;
+
+    /// The records in the log, to know when it is due for compaction
+    size_t records = 0;
+
+    struct Write {
+        /// Replace the log with the data instead of appending it
+        bool replace;
+        std::string data;
+    };
+    std::deque<Write> writes;
+    bool writing = false;
+    bool stopping = false;
+
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    std::thread writer;
+};
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <fstream>
 #include <utility>
 
 #include "control/DeviceListHelper.h"
@@ -31,6 +32,16 @@ constexpr auto DEFAULT_FONT_SIZE = 12;
 Settings::Settings(fs::path filepath): filepath(std::move(filepath)) { loadDefault(); }
 
 Settings::~Settings() {
+    flush();
+    {
+        std::lock_guard lock(this->writeMutex);
+        this->stopping = true;
+    }
+    this->writeChanged.notify_all();
+    if (this->writer.joinable()) {
+        this->writer.join();
+    }
+
     for (auto& i: this->buttonConfig) {
         delete i;
         i = nullptr;
@@ -155,6 +166,17 @@ void Settings::loadDefault() {
     this->preloadPagesBefore = 3U;
     this->preloadPagesAfter = 5U;
     this->eagerPageCleanup = true;
+    this->schedulerThreadCount = 0U;
+    this->pageBufferCacheSize = 256U;
+    this->pdfCacheMemorySize = 128U;
+    this->lazyPageLoading = true;
+    this->pageMemorySize = 1024U;
+    this->saveIndexedLayout = false;
+    this->saveBinaryStrokes = false;
+    this->compactStrokeStorage = false;
+    this->acceleratedCompositing = false;
+    this->draftRendering = DRAFT_RENDERING_INTERACTION;
+    this->imageImportDpi = 150U;
 
     this->selectionBorderColor = 0xff0000U;  // red
     this->selectionMarkerColor = 0x729fcfU;  // light blue
@@ -173,6 +195,7 @@ void Settings::loadDefault() {
 
     this->pluginEnabled = "";
     this->pluginDisabled = "";
+    this->pluginInstructionBudget = 200;
 
     this->numIgnoredStylusEvents = 0;
 
@@ -187,6 +210,7 @@ void Settings::loadDefault() {
     this->trySelectOnStrokeFiltered = false;
 
     this->snapRecognizedShapesEnabled = false;
+    this->snapStrokeEndpointsEnabled = false;
     this->restoreLineWidthEnabled = false;
 
     this->inTransaction = false;
@@ -203,7 +227,10 @@ void Settings::loadDefault() {
     this->stabilizerDrag = 0.4;
     this->stabilizerMass = 5.0;
     this->stabilizerFinalizeStroke = true;
+    this->stabilizerPredictionTime = 0;
     /**/
+
+    this->strokeDecimationTolerance = 0.5;
 }
 
 /**
@@ -419,6 +446,9 @@ void Settings::parseItem(xmlDocPtr doc, xmlNodePtr cur) {
         this->pluginEnabled = reinterpret_cast<const char*>(value);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pluginDisabled")) == 0) {
         this->pluginDisabled = reinterpret_cast<const char*>(value);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pluginInstructionBudget")) == 0) {
+        this->pluginInstructionBudget =
+                std::max<int>(g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10), 0);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pageTemplate")) == 0) {
         this->pageTemplate = reinterpret_cast<const char*>(value);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("sizeUnit")) == 0) {
@@ -445,6 +475,28 @@ void Settings::parseItem(xmlDocPtr doc, xmlNodePtr cur) {
         this->preloadPagesAfter = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("eagerPageCleanup")) == 0) {
         this->eagerPageCleanup = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("schedulerThreadCount")) == 0) {
+        this->schedulerThreadCount = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pageBufferCacheSize")) == 0) {
+        this->pageBufferCacheSize = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pdfCacheMemorySize")) == 0) {
+        this->pdfCacheMemorySize = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pageMemorySize")) == 0) {
+        this->pageMemorySize = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("lazyPageLoading")) == 0) {
+        this->lazyPageLoading = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("saveIndexedLayout")) == 0) {
+        this->saveIndexedLayout = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("saveBinaryStrokes")) == 0) {
+        this->saveBinaryStrokes = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("compactStrokeStorage")) == 0) {
+        this->compactStrokeStorage = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("acceleratedCompositing")) == 0) {
+        this->acceleratedCompositing = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("draftRendering")) == 0) {
+        this->draftRendering = draftRenderingFromString(reinterpret_cast<const char*>(value));
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("imageImportDpi")) == 0) {
+        this->imageImportDpi = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("selectionBorderColor")) == 0) {
         this->selectionBorderColor = Color(g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10));
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("selectionMarkerColor")) == 0) {
@@ -529,6 +581,8 @@ void Settings::parseItem(xmlDocPtr doc, xmlNodePtr cur) {
         this->latexSettings.genCmd = reinterpret_cast<char*>(value);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("snapRecognizedShapesEnabled")) == 0) {
         this->snapRecognizedShapesEnabled = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("snapStrokeEndpointsEnabled")) == 0) {
+        this->snapStrokeEndpointsEnabled = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("restoreLineWidthEnabled")) == 0) {
         this->restoreLineWidthEnabled = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("preferredLocale")) == 0) {
@@ -556,6 +610,10 @@ void Settings::parseItem(xmlDocPtr doc, xmlNodePtr cur) {
         this->stabilizerCuspDetection = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("stabilizerFinalizeStroke")) == 0) {
         this->stabilizerFinalizeStroke = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("stabilizerPredictionTime")) == 0) {
+        this->stabilizerPredictionTime = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("strokeDecimationTolerance")) == 0) {
+        this->strokeDecimationTolerance = tempg_ascii_strtod(reinterpret_cast<const char*>(value), nullptr);
     }
     /**/
 
@@ -798,10 +856,75 @@ void Settings::transactionEnd() {
 }
 
 void Settings::save() {
-    if (inTransaction) {
+    if (inTransaction || this->saveTimeout != 0) {
         return;
     }
+    this->saveTimeout = g_timeout_add(SAVE_DELAY_MS, reinterpret_cast<GSourceFunc>(saveTimer), this);
+}
 
+auto Settings::saveTimer(Settings* settings) -> gboolean {
+    settings->saveTimeout = 0;
+    settings->writeInBackground(settings->serialize());
+    return false;
+}
+
+void Settings::flush() {
+    if (this->saveTimeout != 0) {
+        g_source_remove(this->saveTimeout);
+        this->saveTimeout = 0;
+        writeInBackground(serialize());
+    }
+    std::unique_lock lock(this->writeMutex);
+    this->writeChanged.wait(lock, [this]() { return !this->pendingWrite && !this->writing; });
+}
+
+void Settings::writeInBackground(std::string content) {
+    if (content.empty()) {
+        return;
+    }
+    {
+        std::lock_guard lock(this->writeMutex);
+        this->pendingWrite = std::move(content);
+        if (!this->writer.joinable()) {
+            this->writer = std::thread(&Settings::writeLoop, this);
+        }
+    }
+    this->writeChanged.notify_all();
+}
+
+void Settings::writeLoop() {
+    std::unique_lock lock(this->writeMutex);
+    while (true) {
+        this->writeChanged.wait(lock, [this]() { return this->stopping || this->pendingWrite; });
+        if (!this->pendingWrite) {
+            return;
+        }
+        std::string content = std::move(*this->pendingWrite);
+        this->pendingWrite.reset();
+        this->writing = true;
+        lock.unlock();
+
+        // Written beside and renamed, so that a crash leaves either settings file complete
+        auto tmp = this->filepath;
+        tmp += ".tmp";
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out << content;
+        out.close();
+        std::error_code ec;
+        if (!out.fail()) {
+            fs::rename(tmp, this->filepath, ec);
+        }
+        if (out.fail() || ec) {
+            g_warning("Could not write the settings file %s", this->filepath.u8string().c_str());
+        }
+
+        lock.lock();
+        this->writing = false;
+        this->writeChanged.notify_all();
+    }
+}
+
+auto Settings::serialize() -> std::string {
     xmlDocPtr doc = nullptr;
     xmlNodePtr root = nullptr;
     xmlNodePtr xmlNode = nullptr;
@@ -810,7 +933,7 @@ void Settings::save() {
 
     doc = xmlNewDoc(reinterpret_cast<const xmlChar*>("1.0"));
     if (doc == nullptr) {
-        return;
+        return {};
     }
 
     saveButtonConfig();
@@ -940,6 +1063,24 @@ void Settings::save() {
     SAVE_UINT_PROP(preloadPagesBefore);
     SAVE_UINT_PROP(preloadPagesAfter);
     SAVE_BOOL_PROP(eagerPageCleanup);
+    SAVE_UINT_PROP(schedulerThreadCount);
+    ATTACH_COMMENT("Number of threads running background jobs (0: depending on the number of CPU cores).");
+    SAVE_UINT_PROP(pageBufferCacheSize);
+    ATTACH_COMMENT("The memory available for the rendered tiles of all pages, in MiB.");
+    SAVE_UINT_PROP(pdfCacheMemorySize);
+    ATTACH_COMMENT("The memory available for the rasterized PDF pages, in MiB.");
+    SAVE_BOOL_PROP(lazyPageLoading);
+    SAVE_UINT_PROP(pageMemorySize);
+    ATTACH_COMMENT("The memory available for the elements of the loaded pages, in MiB (0: no limit).");
+    SAVE_BOOL_PROP(saveIndexedLayout);
+    SAVE_BOOL_PROP(saveBinaryStrokes);
+    SAVE_BOOL_PROP(compactStrokeStorage);
+    SAVE_BOOL_PROP(acceleratedCompositing);
+    xmlNode = saveProperty("draftRendering", draftRenderingToString(this->draftRendering), root);
+    ATTACH_COMMENT("When the pages are rendered in draft quality, then again once the view settles, allowed values are "
+                   "\"never\", \"zoom\" (pinch) and \"interaction\" (pinch, scrolling and drags of the tools)");
+    SAVE_UINT_PROP(imageImportDpi);
+    ATTACH_COMMENT("The resolution of the images imported as pages, in dots per inch (0: their own size).");
 
     SAVE_STRING_PROP(pageTemplate);
     ATTACH_COMMENT("Config for new pages");
@@ -957,6 +1098,7 @@ void Settings::save() {
 
     SAVE_STRING_PROP(pluginEnabled);
     SAVE_STRING_PROP(pluginDisabled);
+    SAVE_INT_PROP(pluginInstructionBudget);
 
     SAVE_INT_PROP(strokeFilterIgnoreTime);
     SAVE_DOUBLE_PROP(strokeFilterIgnoreLength);
@@ -966,6 +1108,7 @@ void Settings::save() {
     SAVE_BOOL_PROP(trySelectOnStrokeFiltered);
 
     SAVE_BOOL_PROP(snapRecognizedShapesEnabled);
+    SAVE_BOOL_PROP(snapStrokeEndpointsEnabled);
     SAVE_BOOL_PROP(restoreLineWidthEnabled);
 
     SAVE_INT_PROP(numIgnoredStylusEvents);
@@ -987,8 +1130,13 @@ void Settings::save() {
     SAVE_DOUBLE_PROP(stabilizerMass);
     SAVE_BOOL_PROP(stabilizerCuspDetection);
     SAVE_BOOL_PROP(stabilizerFinalizeStroke);
+    SAVE_UINT_PROP(stabilizerPredictionTime);
     /**/
 
+    SAVE_DOUBLE_PROP(strokeDecimationTolerance);
+    ATTACH_COMMENT("The largest deviation of the dropped input points from the drawn stroke, in screen pixels (0: "
+                   "keep all the points).");
+
     SAVE_BOOL_PROP(latexSettings.autoCheckDependencies);
     // Inline SAVE_STRING_PROP(latexSettings.globalTemplatePath) since it
     // breaks on Windows due to the native character representation being
@@ -1012,8 +1160,16 @@ void Settings::save() {
 
     for (std::map<string, SElement>::value_type p: data) { saveData(root, p.first, p.second); }
 
-    xmlSaveFormatFileEnc(filepath.u8string().c_str(), doc, "UTF-8", 1);
+    xmlChar* buffer = nullptr;
+    int size = 0;
+    xmlDocDumpFormatMemoryEnc(doc, &buffer, &size, "UTF-8", 1);
+    std::string content;
+    if (buffer != nullptr) {
+        content.assign(reinterpret_cast<const char*>(buffer), static_cast<size_t>(size));
+        xmlFree(buffer);
+    }
     xmlFreeDoc(doc);
+    return content;
 }
 
 void Settings::saveData(xmlNodePtr root, const string& name, SElement& elem) {
@@ -1827,6 +1983,116 @@ void Settings::setEagerPageCleanup(bool b) {
     save();
 }
 
+auto Settings::getSchedulerThreadCount() const -> unsigned int { return this->schedulerThreadCount; }
+
+void Settings::setSchedulerThreadCount(unsigned int value) {
+    if (this->schedulerThreadCount == value) {
+        return;
+    }
+    this->schedulerThreadCount = value;
+    save();
+}
+
+auto Settings::getPageBufferCacheSize() const -> unsigned int { return this->pageBufferCacheSize; }
+
+void Settings::setPageBufferCacheSize(unsigned int value) {
+    if (this->pageBufferCacheSize == value) {
+        return;
+    }
+    this->pageBufferCacheSize = value;
+    save();
+}
+
+auto Settings::getPdfCacheMemorySize() const -> unsigned int { return this->pdfCacheMemorySize; }
+
+void Settings::setPdfCacheMemorySize(unsigned int value) {
+    if (this->pdfCacheMemorySize == value) {
+        return;
+    }
+    this->pdfCacheMemorySize = value;
+    save();
+}
+
+auto Settings::getPageMemorySize() const -> unsigned int { return this->pageMemorySize; }
+
+void Settings::setPageMemorySize(unsigned int value) {
+    if (this->pageMemorySize == value) {
+        return;
+    }
+    this->pageMemorySize = value;
+    save();
+}
+
+auto Settings::isLazyPageLoading() const -> bool { return this->lazyPageLoading; }
+
+void Settings::setLazyPageLoading(bool value) {
+    if (this->lazyPageLoading == value) {
+        return;
+    }
+    this->lazyPageLoading = value;
+    save();
+}
+
+auto Settings::isSaveIndexedLayout() const -> bool { return this->saveIndexedLayout; }
+
+void Settings::setSaveIndexedLayout(bool value) {
+    if (this->saveIndexedLayout == value) {
+        return;
+    }
+    this->saveIndexedLayout = value;
+    save();
+}
+
+auto Settings::isSaveBinaryStrokes() const -> bool { return this->saveBinaryStrokes; }
+
+void Settings::setSaveBinaryStrokes(bool value) {
+    if (this->saveBinaryStrokes == value) {
+        return;
+    }
+    this->saveBinaryStrokes = value;
+    save();
+}
+
+auto Settings::isCompactStrokeStorage() const -> bool { return this->compactStrokeStorage; }
+
+void Settings::setCompactStrokeStorage(bool value) {
+    if (this->compactStrokeStorage == value) {
+        return;
+    }
+    this->compactStrokeStorage = value;
+    save();
+}
+
+auto Settings::isAcceleratedCompositing() const -> bool { return this->acceleratedCompositing; }
+
+void Settings::setAcceleratedCompositing(bool value) {
+    if (this->acceleratedCompositing == value) {
+        return;
+    }
+    this->acceleratedCompositing = value;
+    save();
+}
+
+auto Settings::getDraftRendering() const -> DraftRendering { return this->draftRendering; }
+
+void Settings::setDraftRendering(DraftRendering value) {
+    if (this->draftRendering == value) {
+        return;
+    }
+    this->draftRendering = value;
+    save();
+}
+
+auto Settings::getImageImportDpi() const -> unsigned int { return this->imageImportDpi; }
+
+void Settings::setImageImportDpi(unsigned int value) {
+    if (this->imageImportDpi == value) {
+        return;
+    }
+    this->imageImportDpi = value;
+    save();
+}
+
 auto Settings::getBorderColor() const -> Color { return this->selectionBorderColor; }
 
 void Settings::setBorderColor(Color color) {
@@ -1935,6 +2201,16 @@ void Settings::setPluginDisabled(const string& pluginDisabled) {
     save();
 }
 
+auto Settings::getPluginInstructionBudget() const -> int { return this->pluginInstructionBudget; }
+
+void Settings::setPluginInstructionBudget(int millions) {
+    if (this->pluginInstructionBudget == millions) {
+        return;
+    }
+    this->pluginInstructionBudget = millions;
+    save();
+}
+
 
 void Settings::getStrokeFilter(int* ignoreTime, double* ignoreLength, int* successiveTime) const {
     *ignoreTime = this->strokeFilterIgnoreTime;
@@ -1964,6 +2240,10 @@ void Settings::setSnapRecognizedShapesEnabled(bool enabled) { this->snapRecogniz
 
 auto Settings::getSnapRecognizedShapesEnabled() const -> bool { return this->snapRecognizedShapesEnabled; }
 
+void Settings::setSnapStrokeEndpointsEnabled(bool enabled) { this->snapStrokeEndpointsEnabled = enabled; }
+
+auto Settings::getSnapStrokeEndpointsEnabled() const -> bool { return this->snapStrokeEndpointsEnabled; }
+
 
 void Settings::setRestoreLineWidthEnabled(bool enabled) { this->restoreLineWidthEnabled = enabled; }
 
@@ -2222,6 +2502,7 @@ auto Settings::getStabilizerAveragingMethod() const -> StrokeStabilizer::Averagi
     return stabilizerAveragingMethod;
 }
 auto Settings::getStabilizerPreprocessor() const -> StrokeStabilizer::Preprocessor { return stabilizerPreprocessor; }
+auto Settings::getStabilizerPredictionTime() const -> unsigned int { return stabilizerPredictionTime; }
 
 void Settings::setStabilizerCuspDetection(bool cuspDetection) {
     if (stabilizerCuspDetection == cuspDetection) {
@@ -2292,6 +2573,23 @@ void Settings::setStabilizerPreprocessor(StrokeStabilizer::Preprocessor preproce
     stabilizerPreprocessor = p;
     save();
 }
+void Settings::setStabilizerPredictionTime(unsigned int predictionTime) {
+    if (stabilizerPredictionTime == predictionTime) {
+        return;
+    }
+    stabilizerPredictionTime = predictionTime;
+    save();
+}
+
+auto Settings::getStrokeDecimationTolerance() const -> double { return strokeDecimationTolerance; }
+
+void Settings::setStrokeDecimationTolerance(double tolerance) {
+    if (strokeDecimationTolerance == tolerance) {
+        return;
+    }
+    strokeDecimationTolerance = tolerance;
+    save();
+}
 
 /**
  * @brief Get Color Palette used for Tools
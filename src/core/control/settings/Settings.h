@@ -11,8 +11,13 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
 
 #include <config-dev.h>
 #include <libxml/xmlreader.h>
@@ -95,8 +100,19 @@ public:
     bool load();
     void parseData(xmlNodePtr cur, SElement& elem);
 
+    /**
+     * Marks the settings as changed. They are written SAVE_DELAY_MS later in the background, once for all the changes
+     * made in between.
+     */
     void save();
 
+    /**
+     * Writes the changed settings now, and waits until they are on the disk
+     */
+    void flush();
+
+    static constexpr guint SAVE_DELAY_MS = 500;
+
 private:
     void loadDefault();
     void parseItem(xmlDocPtr doc, xmlNodePtr cur);
@@ -108,6 +124,19 @@ private:
 
     void saveData(xmlNodePtr root, const std::string& name, SElement& elem);
 
+    /**
+     * @return The settings file, serialized on the UI thread
+     */
+    std::string serialize();
+
+    /**
+     * Hands the serialized settings to the writer thread, replacing the ones it did not write yet
+     */
+    void writeInBackground(std::string content);
+    void writeLoop();
+
+    static gboolean saveTimer(Settings* settings);
+
     void saveButtonConfig();
     void loadButtonConfig();
 
@@ -358,6 +387,39 @@ public:
     bool isEagerPageCleanup() const;
     void setEagerPageCleanup(bool b);
 
+    unsigned int getSchedulerThreadCount() const;
+    void setSchedulerThreadCount(unsigned int value);
+
+    unsigned int getPageBufferCacheSize() const;
+    void setPageBufferCacheSize(unsigned int value);
+
+    unsigned int getPdfCacheMemorySize() const;
+    void setPdfCacheMemorySize(unsigned int value);
+
+    bool isLazyPageLoading() const;
+    void setLazyPageLoading(bool value);
+
+    unsigned int getPageMemorySize() const;
+    void setPageMemorySize(unsigned int value);
+
+    bool isSaveIndexedLayout() const;
+    void setSaveIndexedLayout(bool value);
+
+    bool isSaveBinaryStrokes() const;
+    void setSaveBinaryStrokes(bool value);
+
+    bool isCompactStrokeStorage() const;
+    void setCompactStrokeStorage(bool value);
+
+    bool isAcceleratedCompositing() const;
+    void setAcceleratedCompositing(bool value);
+
+    DraftRendering getDraftRendering() const;
+    void setDraftRendering(DraftRendering value);
+
+    unsigned int getImageImportDpi() const;
+    void setImageImportDpi(unsigned int value);
+
     std::string const& getPageTemplate() const;
     void setPageTemplate(const std::string& pageTemplate);
 
@@ -385,6 +447,12 @@ public:
     std::string const& getPluginDisabled() const;
     void setPluginDisabled(const std::string& pluginDisabled);
 
+    /**
+     * @return Millions of Lua instructions a plugin may run per call before it is aborted, 0 for no limit
+     */
+    int getPluginInstructionBudget() const;
+    void setPluginInstructionBudget(int millions);
+
     /**
      * Sets #numIgnoredStylusEvents. If given a negative value writes 0 instead.
      */
@@ -480,6 +548,16 @@ public:
      */
     bool getSnapRecognizedShapesEnabled() const;
 
+    /**
+     * Set snapping to the end points of the strokes of the current layer enabled
+     */
+    void setSnapStrokeEndpointsEnabled(bool enabled);
+
+    /**
+     * Get snapping to the end points of the strokes of the current layer enabled
+     */
+    bool getSnapStrokeEndpointsEnabled() const;
+
     /**
      * Set line width restoring for resized edit selctions enabled
      */
@@ -512,6 +590,7 @@ public:
     double getStabilizerSigma() const;
     StrokeStabilizer::AveragingMethod getStabilizerAveragingMethod() const;
     StrokeStabilizer::Preprocessor getStabilizerPreprocessor() const;
+    unsigned int getStabilizerPredictionTime() const;
 
     void setStabilizerCuspDetection(bool cuspDetection);
     void setStabilizerFinalizeStroke(bool finalizeStroke);
@@ -522,6 +601,10 @@ public:
     void setStabilizerSigma(double sigma);
     void setStabilizerAveragingMethod(StrokeStabilizer::AveragingMethod averagingMethod);
     void setStabilizerPreprocessor(StrokeStabilizer::Preprocessor preprocessor);
+    void setStabilizerPredictionTime(unsigned int predictionTime);
+
+    double getStrokeDecimationTolerance() const;
+    void setStrokeDecimationTolerance(double tolerance);
 
     const Palette& getColorPalette();
 
@@ -552,6 +635,21 @@ private:
      */
     fs::path filepath;
 
+    /**
+     * The timeout of the pending save(), 0 if the settings were not changed since the last write
+     */
+    guint saveTimeout = 0;
+
+    /**
+     * The settings to be written by the writer thread, which writes them beside the settings file and renames them
+     */
+    std::optional<std::string> pendingWrite;
+    bool writing = false;
+    bool stopping = false;
+    std::mutex writeMutex;
+    std::condition_variable writeChanged;
+    std::thread writer;
+
 private:
     /**
      * The settings tree
@@ -965,6 +1063,11 @@ private:
      */
     std::string pluginDisabled;
 
+    /**
+     * Millions of Lua instructions a plugin call may run on the UI thread, 0 for no limit
+     */
+    int pluginInstructionBudget{};
+
 
     /**
      * Used to filter strokes of short time and length unless successive in order to do something else ( i.e. select
@@ -983,6 +1086,11 @@ private:
      */
     bool snapRecognizedShapesEnabled{};
 
+    /**
+     * Whether the drawn shapes snap to the end points of the existing strokes
+     */
+    bool snapStrokeEndpointsEnabled{};
+
     /**
      * Whether the line width should be preserved in a resizing operation
      */
@@ -1028,12 +1136,68 @@ private:
      */
     bool eagerPageCleanup{};
 
+    /**
+     * Number of threads running the background jobs (rendering, previews...). 0 means automatic.
+     */
+    unsigned int schedulerThreadCount{};
+
+    /**
+     * Memory available for the rendered tiles of all pages, in MiB
+     */
+    unsigned int pageBufferCacheSize{};
+
+    /**
+     * Memory available for the rasterized PDF pages, in MiB
+     */
+    unsigned int pdfCacheMemorySize{};
+
+    /**
+     * Parse the layers of a page when it is first shown, instead of when the file is opened
+     */
+    bool lazyPageLoading{};
+
+    /**
+     * Memory available for the elements of the loaded pages, in MiB, 0 for no limit. See PageResidency.
+     */
+    unsigned int pageMemorySize{};
+
+    /**
+     * Save the files with a compressed entry per page, so that unchanged pages are not written again
+     */
+    bool saveIndexedLayout{};
+
+    /**
+     * Save the points of the strokes as delta-encoded fixed-point numbers instead of decimal text. The files are
+     * smaller and load faster, but older versions of Xournal++ cannot read them
+     */
+    bool saveBinaryStrokes{};
+
+    /**
+     * Pack the points of the strokes of the pages out of view as floats, to save memory
+     */
+    bool compactStrokeStorage{};
+
+    /**
+     * Copy the rendered tiles to surfaces of the display backend, which composites and scales them (e.g. XRender,
+     * accelerated by the GPU on most X servers), instead of sending their pixels at every frame
+     */
+    bool acceleratedCompositing{};
+
+    /**
+     * The interactions during which the pages are rendered in draft quality, then again once the view settles
+     */
+    DraftRendering draftRendering{};
+
+    /**
+     * The resolution the images imported as pages are downsampled to, in dots per inch of the page, 0 to keep them
+     */
+    unsigned int imageImportDpi{};
+
     /**
      * Stabilizer related settings
      */
     bool stabilizerCuspDetection{};
     bool stabilizerFinalizeStroke{};
-
     size_t stabilizerBuffersize{};
     double stabilizerDeadzoneRadius{};
     double stabilizerDrag{};
@@ -1042,6 +1206,18 @@ private:
     StrokeStabilizer::AveragingMethod stabilizerAveragingMethod{};
     StrokeStabilizer::Preprocessor stabilizerPreprocessor{};
 
+    /**
+     * How far ahead of the last event, in ms, the tip of the stroke is predicted while drawing. 0 disables the
+     * prediction. Only used without stabilization.
+     */
+    unsigned int stabilizerPredictionTime{};
+
+    /**
+     * The input points of a stroke within this distance of the segment drawn instead, in screen pixels, are dropped.
+     * 0 keeps all the points. See StrokeDecimator.
+     */
+    double strokeDecimationTolerance{};
+
     /**
      * @brief Color Palette for tool colors
      *
@@ -27,3 +27,17 @@ auto iconThemeFromString(const std::string& iconThemeStr) -> IconTheme {
     g_warning("Settings::Unknown icon theme: %s\n", iconThemeStr.c_str());
     return ICON_THEME_COLOR;
 }
+
+auto draftRenderingFromString(const std::string& draftRenderingStr) -> DraftRendering {
+    if (draftRenderingStr == "never") {
+        return DRAFT_RENDERING_NEVER;
+    }
+    if (draftRenderingStr == "zoom") {
+        return DRAFT_RENDERING_ZOOM;
+    }
+    if (draftRenderingStr == "interaction") {
+        return DRAFT_RENDERING_INTERACTION;
+    }
+    g_warning("Settings::Unknown draft rendering: %s\n", draftRenderingStr.c_str());
+    return DRAFT_RENDERING_INTERACTION;
+}
@@ -74,6 +74,17 @@ enum IconTheme {
     ICON_THEME_LUCIDE = 1,
 };
 
+/**
+ * When the pages are rendered in draft quality (fast antialiasing and filters), then again once the view settles
+ */
+enum DraftRendering {
+    DRAFT_RENDERING_NEVER = 0,
+    /// During the zoom gestures
+    DRAFT_RENDERING_ZOOM = 1,
+    /// During the zoom gestures, the scrolling and the drags of the tools
+    DRAFT_RENDERING_INTERACTION = 2,
+};
+
 constexpr auto buttonToString(Button button) -> const char* {
     switch (button) {
         case BUTTON_ERASER:
@@ -121,5 +132,19 @@ constexpr auto iconThemeToString(IconTheme iconTheme) -> const char* {
     }
 }
 
+constexpr auto draftRenderingToString(DraftRendering draftRendering) -> const char* {
+    switch (draftRendering) {
+        case DRAFT_RENDERING_NEVER:
+            return "never";
+        case DRAFT_RENDERING_ZOOM:
+            return "zoom";
+        case DRAFT_RENDERING_INTERACTION:
+            return "interaction";
+        default:
+            return "unknown";
+    }
+}
+
 StylusCursorType stylusCursorTypeFromString(const std::string& stylusCursorTypeStr);
 IconTheme iconThemeFromString(const std::string& iconThemeStr);
+DraftRendering draftRenderingFromString(const std::string& draftRenderingStr);
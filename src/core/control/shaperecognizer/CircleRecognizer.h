@@ -20,7 +20,10 @@ private:
     virtual ~CircleRecognizer();
 
 public:
-    static Stroke* recognize(Stroke* s);
+    /**
+     * @param inertia The Inertia of all the points of the stroke
+     */
+    static Stroke* recognize(Stroke* s, Inertia& inertia);
 
 private:
     static Stroke* makeCircleShape(Stroke* originalStroke, Inertia& inertia);
@@ -78,6 +78,17 @@ void Inertia::increase(Point p1, Point p2, int coef) {
     this->sxy += dm * p1.x * p1.y;
 }
 
+auto Inertia::operator-(const Inertia& other) const -> Inertia {
+    Inertia result(*this);
+    result.mass -= other.mass;
+    result.sx -= other.sx;
+    result.sy -= other.sy;
+    result.sxx -= other.sxx;
+    result.sxy -= other.sxy;
+    result.syy -= other.syy;
+    return result;
+}
+
 void Inertia::calc(const Point* pt, int start, int end) {
     this->mass = this->sx = this->sy = this->sxx = this->sxy = this->syy = 0.;
     for (int i = start; i < end - 1; i++) { this->increase(pt[i], pt[i + 1], 1); }
@@ -38,6 +38,12 @@ public:
     double getMass() const;
 
     void increase(Point p1, Point p2, int coef);
+
+    /**
+     * @return The moments of the segments of this Inertia which are not in the other one
+     */
+    Inertia operator-(const Inertia& other) const;
+
     void calc(const Point* pt, int start, int end);
 
 private:
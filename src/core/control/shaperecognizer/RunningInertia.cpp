@@ -0,0 +1,31 @@
+#include "RunningInertia.h"
+
+#include <algorithm>
+
+#include "model/Point.h"
+
+void RunningInertia::update(const std::vector<Point>& points) {
+    prefix.reserve(points.size());
+    for (size_t i = prefix.size(); i < points.size(); i++) {
+        if (i == 0) {
+            prefix.emplace_back();
+            continue;
+        }
+        Inertia next = prefix.back();
+        next.increase(points[i - 1], points[i], 1);
+        prefix.push_back(next);
+    }
+}
+
+void RunningInertia::truncate(size_t pointCount) { prefix.resize(std::min(prefix.size(), pointCount)); }
+
+void RunningInertia::reset() { prefix.clear(); }
+
+auto RunningInertia::getPointCount() const -> size_t { return prefix.size(); }
+
+auto RunningInertia::range(int start, int end) const -> Inertia {
+    if (end - 1 <= start) {
+        return Inertia();
+    }
+    return prefix[end - 1] - prefix[start];
+}
@@ -0,0 +1,53 @@
+/*
+ * Xournal++
+ *
+ * Part of the Xournal shape recognizer
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Inertia.h"
+
+class Point;
+
+/**
+ * @brief The Inertia of any range of points of a stroke, from running sums updated while the stroke is drawn
+ *
+ * The recognizer computes the Inertia of several ranges of the stroke when it ends. With the sums over the prefixes of
+ * the stroke, each of them costs a subtraction instead of a pass over the points of the range.
+ */
+class RunningInertia {
+public:
+    /**
+     * Adds the points of the stroke which were not added yet. The points added before must not have moved.
+     */
+    void update(const std::vector<Point>& points);
+
+    /**
+     * Forgets the points from the index on, e.g. before the last point of the stroke is moved
+     */
+    void truncate(size_t pointCount);
+
+    void reset();
+
+    size_t getPointCount() const;
+
+    /**
+     * @return The same as Inertia::calc(points, start, end), for 0 <= start <= end <= getPointCount()
+     */
+    Inertia range(int start, int end) const;
+
+private:
+    /**
+     * prefix[i] is Inertia::calc(points, 0, i + 1): the segments between the first i + 1 points
+     */
+    std::vector<Inertia> prefix;
+};
@@ -94,7 +94,8 @@ auto ShapeRecognizer::tryRectangle() -> Stroke* {
 /*
  * check if something is a polygonal line with at most nsides sides
  */
-auto ShapeRecognizer::findPolygonal(const Point* pt, int start, int end, int nsides, int* breaks, Inertia* ss) -> int {
+auto ShapeRecognizer::findPolygonal(const Point* pt, const RunningInertia& inertia, int start, int end, int nsides,
+                                    int* breaks, Inertia* ss) -> int {
     Inertia s;
     int i1 = 0, i2 = 0, n1 = 0, n2 = 0;
 
@@ -115,7 +116,7 @@ auto ShapeRecognizer::findPolygonal(const Point* pt, int start, int end, int nsi
     for (; k < nsides; k++) {
         i1 = start + (k * (end - start)) / nsides;
         i2 = start + ((k + 1) * (end - start)) / nsides;
-        s.calc(pt, i1, i2);
+        s = inertia.range(i1, i2);
         if (s.det() < LINE_MAX_DET) {
             break;
         }
@@ -159,7 +160,7 @@ auto ShapeRecognizer::findPolygonal(const Point* pt, int start, int end, int nsi
     }
 
     if (i1 > start) {
-        n1 = findPolygonal(pt, start, i1, (i2 == end) ? (nsides - 1) : (nsides - 2), breaks, ss);
+        n1 = findPolygonal(pt, inertia, start, i1, (i2 == end) ? (nsides - 1) : (nsides - 2), breaks, ss);
         if (n1 == 0) {
             return 0;  // it doesn't work
         }
@@ -172,7 +173,7 @@ auto ShapeRecognizer::findPolygonal(const Point* pt, int start, int end, int nsi
     ss[n1] = s;
 
     if (i2 < end) {
-        n2 = findPolygonal(pt, i2, end, nsides - n1 - 1, breaks + n1 + 1, ss + n1 + 1);
+        n2 = findPolygonal(pt, inertia, i2, end, nsides - n1 - 1, breaks + n1 + 1, ss + n1 + 1);
         if (n2 == 0) {
             return 0;
         }
@@ -238,17 +239,28 @@ void ShapeRecognizer::optimizePolygonal(const Point* pt, int nsides, int* breaks
  * The main pattern recognition function
  */
 auto ShapeRecognizer::recognizePatterns(Stroke* stroke) -> Stroke* {
+    RunningInertia inertia;
+    return recognizePatterns(stroke, inertia);
+}
+
+auto ShapeRecognizer::recognizePatterns(Stroke* stroke, RunningInertia& inertia) -> Stroke* {
     this->stroke = stroke;
 
     if (stroke->getPointCount() < 3) {
         return nullptr;
     }
 
+    if (inertia.getPointCount() > static_cast<size_t>(stroke->getPointCount())) {
+        // Not the points of this stroke
+        inertia.reset();
+    }
+    inertia.update(stroke->getPointVector());
+
     Inertia ss[4];
     int brk[5] = {0};
 
     // first see if it's a polygon
-    int n = findPolygonal(stroke->getPoints(), 0, stroke->getPointCount() - 1, MAX_POLYGON_SIDES, brk, ss);
+    int n = findPolygonal(stroke->getPoints(), inertia, 0, stroke->getPointCount() - 1, MAX_POLYGON_SIDES, brk, ss);
     if (n > 0) {
         optimizePolygonal(stroke->getPoints(), n, brk, ss);
 #ifdef DEBUG_RECOGNIZER
@@ -318,7 +330,8 @@ auto ShapeRecognizer::recognizePatterns(Stroke* stroke) -> Stroke* {
     }
 
     // not a polygon: maybe a circle ?
-    Stroke* s = CircleRecognizer::recognize(stroke);
+    Inertia whole = inertia.range(0, stroke->getPointCount());
+    Stroke* s = CircleRecognizer::recognize(stroke, whole);
     if (s) {
         RDEBUG("return circle");
         return s;
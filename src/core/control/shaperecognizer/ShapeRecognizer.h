@@ -15,6 +15,7 @@
 
 #include "CircleRecognizer.h"
 #include "RecoSegment.h"
+#include "RunningInertia.h"
 #include "ShapeRecognizerConfig.h"
 
 class Stroke;
@@ -26,6 +27,12 @@ public:
     virtual ~ShapeRecognizer();
 
     Stroke* recognizePatterns(Stroke* stroke);
+
+    /**
+     * @param inertia Updated with the points of the stroke while it was drawn, see StrokeHandler. The points missing
+     *                are added.
+     */
+    Stroke* recognizePatterns(Stroke* stroke, RunningInertia& inertia);
     void resetRecognizer();
 
 private:
@@ -34,7 +41,8 @@ private:
 
     static void optimizePolygonal(const Point* pt, int nsides, int* breaks, Inertia* ss);
 
-    int findPolygonal(const Point* pt, int start, int end, int nsides, int* breaks, Inertia* ss);
+    int findPolygonal(const Point* pt, const RunningInertia& inertia, int start, int end, int nsides, int* breaks,
+                      Inertia* ss);
 
 private:
     std::array<RecoSegment, MAX_POLYGON_SIDES + 1> queue{};
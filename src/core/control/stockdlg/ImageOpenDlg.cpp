@@ -1,5 +1,9 @@
 #include "ImageOpenDlg.h"
 
+#include <algorithm>
+#include <string>
+#include <utility>
+
 #include <config.h>
 
 #include "control/settings/Settings.h"
@@ -7,7 +11,8 @@
 #include "util/Util.h"
 #include "util/i18n.h"
 
-auto ImageOpenDlg::show(GtkWindow* win, Settings* settings, bool localOnly, bool* attach) -> GFile* {
+auto ImageOpenDlg::createDialog(GtkWindow* win, Settings* settings, bool localOnly, bool attach, GtkWidget** cbAttach)
+        -> GtkWidget* {
     GtkWidget* dialog = gtk_file_chooser_dialog_new(_("Open Image"), win, GTK_FILE_CHOOSER_ACTION_OPEN, _("_Cancel"),
                                                     GTK_RESPONSE_CANCEL, _("_Open"), GTK_RESPONSE_OK, nullptr);
 
@@ -23,11 +28,11 @@ auto ImageOpenDlg::show(GtkWindow* win, Settings* settings, bool localOnly, bool
                                             Util::toGFilename(settings->getLastImagePath()).c_str());
     }
 
-    GtkWidget* cbAttach = nullptr;
+    *cbAttach = nullptr;
     if (attach) {
-        cbAttach = gtk_check_button_new_with_label(_("Attach file to the journal"));
-        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(cbAttach), false);
-        gtk_file_chooser_set_extra_widget(GTK_FILE_CHOOSER(dialog), cbAttach);
+        *cbAttach = gtk_check_button_new_with_label(_("Attach file to the journal"));
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(*cbAttach), false);
+        gtk_file_chooser_set_extra_widget(GTK_FILE_CHOOSER(dialog), *cbAttach);
     }
 
     GtkWidget* image = gtk_image_new();
@@ -35,6 +40,21 @@ auto ImageOpenDlg::show(GtkWindow* win, Settings* settings, bool localOnly, bool
     g_signal_connect(dialog, "update-preview", G_CALLBACK(updatePreviewCallback), nullptr);
 
     gtk_window_set_transient_for(GTK_WINDOW(dialog), win);
+    return dialog;
+}
+
+void ImageOpenDlg::storeFolder(GtkWidget* dialog, Settings* settings) {
+    // e.g. from last used files, there is no folder selected
+    // in this case do not store the folder
+    if (auto folder = Util::fromGFilename(gtk_file_chooser_get_current_folder(GTK_FILE_CHOOSER(dialog)));
+        !folder.empty()) {
+        settings->setLastImagePath(folder);
+    }
+}
+
+auto ImageOpenDlg::show(GtkWindow* win, Settings* settings, bool localOnly, bool* attach) -> GFile* {
+    GtkWidget* cbAttach = nullptr;
+    GtkWidget* dialog = createDialog(win, settings, localOnly, attach != nullptr, &cbAttach);
     if (gtk_dialog_run(GTK_DIALOG(dialog)) != GTK_RESPONSE_OK) {
         gtk_widget_destroy(dialog);
         return nullptr;
@@ -44,15 +64,44 @@ auto ImageOpenDlg::show(GtkWindow* win, Settings* settings, bool localOnly, bool
         *attach = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(cbAttach));
     }
 
+    storeFolder(dialog, settings);
+    gtk_widget_destroy(dialog);
+    return file;
+}
+
+auto ImageOpenDlg::showMultiple(GtkWindow* win, Settings* settings, bool* attach) -> std::vector<fs::path> {
+    GtkWidget* cbAttach = nullptr;
+    GtkWidget* dialog = createDialog(win, settings, true, attach != nullptr, &cbAttach);
+    gtk_file_chooser_set_select_multiple(GTK_FILE_CHOOSER(dialog), true);
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) != GTK_RESPONSE_OK) {
+        gtk_widget_destroy(dialog);
+        return {};
+    }
+
+    // The pages of a scanned notebook are numbered by their names: "page10" goes after "page9"
+    std::vector<std::pair<std::string, fs::path>> sorted;
+    GSList* list = gtk_file_chooser_get_files(GTK_FILE_CHOOSER(dialog));
+    for (GSList* l = list; l != nullptr; l = l->next) {
+        if (auto path = Util::fromGFile(G_FILE(l->data)); !path.empty()) {
+            gchar* key = g_utf8_collate_key_for_filename(path.filename().u8string().c_str(), -1);
+            sorted.emplace_back(key, std::move(path));
+            g_free(key);
+        }
+    }
+    g_slist_free_full(list, g_object_unref);
+    std::sort(sorted.begin(), sorted.end());
 
-    // e.g. from last used files, there is no folder selected
-    // in this case do not store the folder
-    if (auto folder = Util::fromGFilename(gtk_file_chooser_get_current_folder(GTK_FILE_CHOOSER(dialog)));
-        !folder.empty()) {
-        settings->setLastImagePath(folder);
+    std::vector<fs::path> files;
+    files.reserve(sorted.size());
+    for (auto& entry: sorted) { files.push_back(std::move(entry.second)); }
+
+    if (attach) {
+        *attach = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(cbAttach));
     }
+
+    storeFolder(dialog, settings);
     gtk_widget_destroy(dialog);
-    return file;
+    return files;
 }
 
 // Source: Empathy
@@ -11,8 +11,12 @@
 
 #pragma once
 
+#include <vector>
+
 #include <gtk/gtk.h>
 
+#include "filesystem.h"
+
 class Settings;
 
 class ImageOpenDlg {
@@ -23,7 +27,17 @@ private:
 public:
     static GFile* show(GtkWindow* win, Settings* settings, bool localOnly = false, bool* attach = nullptr);
 
+    /**
+     * Lets the user select several local images at once, e.g. to import them as pages
+     * @return The selected files, in the order of their names. Empty if the user canceled.
+     */
+    static std::vector<fs::path> showMultiple(GtkWindow* win, Settings* settings, bool* attach = nullptr);
+
 private:
+    static GtkWidget* createDialog(GtkWindow* win, Settings* settings, bool localOnly, bool attach,
+                                   GtkWidget** cbAttach);
+    static void storeFolder(GtkWidget* dialog, Settings* settings);
+
     static void updatePreviewCallback(GtkFileChooser* fileChooser, void* userData);
     static GdkPixbuf* pixbufScaleDownIfNecessary(GdkPixbuf* pixbuf, gint maxSize);
 };
@@ -1,5 +1,6 @@
 #include "BaseStrokeHandler.h"
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 
@@ -8,6 +9,7 @@
 #include "gui/XournalView.h"
 #include "gui/XournalppCursor.h"
 #include "undo/InsertUndoAction.h"
+#include "util/Range.h"
 #include "view/StrokeView.h"
 
 using xoj::util::Rectangle;
@@ -20,7 +22,7 @@ BaseStrokeHandler::BaseStrokeHandler(XournalView* xournal, XojPageView* redrawab
         InputHandler(xournal, redrawable, page),
         flipShift(flipShift),
         flipControl(flipControl),
-        snappingHandler(xournal->getControl()->getSettings()) {}
+        snappingHandler(xournal->getControl()->getSettings(), page) {}
 
 BaseStrokeHandler::~BaseStrokeHandler() = default;
 
@@ -35,8 +37,6 @@ void BaseStrokeHandler::draw(cairo_t* cr) {
 
 auto BaseStrokeHandler::onKeyEvent(GdkEventKey* event) -> bool {
     if (event->is_modifier) {
-        Rectangle<double> rect = stroke->boundingRect();
-
         PositionInputData pos{};
         pos.x = pos.y = pos.pressure = 0;  // not used in redraw
         if (event->keyval == GDK_KEY_Shift_L || event->keyval == GDK_KEY_Shift_R) {
@@ -51,18 +51,13 @@ auto BaseStrokeHandler::onKeyEvent(GdkEventKey* event) -> bool {
             return false;
         }
 
-        this->redrawable->repaintRect(stroke->getX(), stroke->getY(), stroke->getElementWidth(),
-                                      stroke->getElementHeight());
-
+        // The previous shape is erased, the new one drawn
+        repaintShape();
 
         Point malleablePoint = this->currPoint;  // make a copy as it might get snapped to grid.
         this->drawShape(malleablePoint, pos);
 
-
-        rect.unite(stroke->boundingRect());
-
-        double w = stroke->getWidth();
-        redrawable->repaintRect(rect.x - w, rect.y - w, rect.width + 2 * w, rect.height + 2 * w);
+        repaintShape();
 
         return true;
     }
@@ -80,7 +75,6 @@ auto BaseStrokeHandler::onMotionNotifyEvent(const PositionInputData& pos) -> boo
     int pointCount = stroke->getPointCount();
 
     Point currentPoint(x, y);
-    Rectangle<double> rect = stroke->boundingRect();
 
     if (pointCount > 0) {
         if (!validMotion(currentPoint, stroke->getPoint(pointCount - 1))) {
@@ -88,19 +82,35 @@ auto BaseStrokeHandler::onMotionNotifyEvent(const PositionInputData& pos) -> boo
         }
     }
 
-    this->redrawable->repaintRect(stroke->getX(), stroke->getY(), stroke->getElementWidth(),
-                                  stroke->getElementHeight());
+    // The previous shape is erased, the new one drawn
+    repaintShape();
 
     drawShape(currentPoint, pos);
 
-    rect.unite(stroke->boundingRect());
-    double w = stroke->getWidth();
-
-    redrawable->repaintRect(rect.x - w, rect.y - w, rect.width + 2 * w, rect.height + 2 * w);
+    repaintShape();
 
     return true;
 }
 
+void BaseStrokeHandler::repaintShape() const {
+    const double w = stroke->getWidth();
+    const auto& points = stroke->getPointVector();
+    if (stroke->getFill() != -1 || points.size() < 2) {
+        Rectangle<double> rect = stroke->boundingRect();
+        redrawable->repaintRect(rect.x - w, rect.y - w, rect.width + 2 * w, rect.height + 2 * w);
+        return;
+    }
+
+    const size_t segments = points.size() - 1;
+    const size_t step = (segments + MAX_REPAINT_RECTS - 1) / MAX_REPAINT_RECTS;
+    for (size_t first = 0; first < segments; first += step) {
+        const size_t last = std::min(first + step, segments);
+        Range rg(points[first].x, points[first].y);
+        for (size_t i = first + 1; i <= last; i++) { rg.addPoint(points[i].x, points[i].y); }
+        redrawable->repaintRect(rg.getX() - w, rg.getY() - w, rg.getWidth() + 2 * w, rg.getHeight() + 2 * w);
+    }
+}
+
 void BaseStrokeHandler::onMotionCancelEvent() {
     delete stroke;
     stroke = nullptr;
@@ -54,6 +54,17 @@ protected:
      */
     void modifyModifiersByDrawDir(double width, double height, bool changeCursor = true);
 
+    /**
+     * @brief Repaint the area the shape covers: around its segments only, unless it is filled, so that dragging a
+     * large shape does not repaint the whole inside of its bounding box
+     */
+    void repaintShape() const;
+
+    /**
+     * The outline of a shape is repainted in at most this many rectangles, each around consecutive segments
+     */
+    static constexpr size_t MAX_REPAINT_RECTS = 32;
+
 protected:
     Point currPoint;
     Point buttonDownPoint;  // used for tapSelect and filtering - never snapped to grid. See startPoint defined in
@@ -0,0 +1,91 @@
+#include "BulkTransform.h"
+
+#include <cmath>
+
+#include "control/jobs/Executor.h"
+#include "model/Element.h"
+#include "model/Stroke.h"
+
+BulkTransform::BulkTransform() { cairo_matrix_init_identity(&this->matrix); }
+
+auto BulkTransform::move(double dx, double dy) -> BulkTransform& {
+    this->operations.push_back({Operation::MOVE, dx, dy, 1, 1, 0, false});
+
+    cairo_matrix_t m;
+    cairo_matrix_init_translate(&m, dx, dy);
+    cairo_matrix_multiply(&this->matrix, &this->matrix, &m);
+    return *this;
+}
+
+auto BulkTransform::scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth)
+        -> BulkTransform& {
+    this->operations.push_back({Operation::SCALE, x0, y0, fx, fy, rotation, restoreLineWidth});
+
+    // As Stroke::scale()
+    cairo_matrix_t m;
+    cairo_matrix_init_identity(&m);
+    cairo_matrix_translate(&m, x0, y0);
+    cairo_matrix_rotate(&m, rotation);
+    cairo_matrix_scale(&m, fx, fy);
+    cairo_matrix_rotate(&m, -rotation);
+    cairo_matrix_translate(&m, -x0, -y0);
+    cairo_matrix_multiply(&this->matrix, &this->matrix, &m);
+    if (!restoreLineWidth) {
+        this->widthFactor *= std::sqrt(std::abs(fx * fy));
+    }
+    return *this;
+}
+
+auto BulkTransform::rotate(double x0, double y0, double th) -> BulkTransform& {
+    this->operations.push_back({Operation::ROTATE, x0, y0, 1, 1, th, false});
+
+    // As Stroke::rotate()
+    cairo_matrix_t m;
+    cairo_matrix_init_identity(&m);
+    cairo_matrix_translate(&m, x0, y0);
+    cairo_matrix_rotate(&m, th);
+    cairo_matrix_translate(&m, -x0, -y0);
+    cairo_matrix_multiply(&this->matrix, &this->matrix, &m);
+    return *this;
+}
+
+void BulkTransform::applyTo(Element* e) const {
+    for (const Operation& op: this->operations) {
+        switch (op.type) {
+            case Operation::MOVE:
+                e->move(op.x, op.y);
+                break;
+            case Operation::SCALE:
+                e->scale(op.x, op.y, op.fx, op.fy, op.rotation, op.restoreLineWidth);
+                break;
+            case Operation::ROTATE:
+                e->rotate(op.x, op.y, op.rotation);
+                break;
+        }
+    }
+}
+
+void BulkTransform::apply(const std::vector<Element*>& elements) const {
+    if (this->operations.empty()) {
+        return;
+    }
+
+    std::vector<Stroke*> strokes;
+    for (Element* e: elements) {
+        if (e->getType() == ELEMENT_STROKE) {
+            strokes.push_back(dynamic_cast<Stroke*>(e));
+        } else {
+            applyTo(e);
+        }
+    }
+
+    if (strokes.size() < MIN_PARALLEL_STROKES) {
+        for (Stroke* s: strokes) { s->transform(this->matrix, this->widthFactor); }
+        return;
+    }
+
+    // Each task only writes the points and the bounds of its own strokes
+    TaskGroup tasks(JOB_PRIORITY_URGENT);
+    tasks.forEach(strokes.size(), [this, &strokes](size_t i) { strokes[i]->transform(this->matrix, this->widthFactor); });
+    tasks.join();
+}
@@ -0,0 +1,71 @@
+/*
+ * Xournal++
+ *
+ * Moves, scales and rotates many elements at once
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <cairo.h>
+
+class Element;
+
+/**
+ * @brief The moves, scales and rotations of a selection, applied to all its elements at once
+ *
+ * The operations of the strokes are composed into one affine matrix: each point is transformed once and the bounds are
+ * computed in the same pass, see Stroke::transform(). The strokes of a large selection are transformed concurrently on
+ * the Executor. The other elements get the operations one after the other, as Element::move(), Element::scale() and
+ * Element::rotate().
+ *
+ * The elements must not be accessed by other threads meanwhile, e.g. they are selected or the document is locked.
+ */
+class BulkTransform {
+public:
+    BulkTransform();
+
+public:
+    /**
+     * The operations, applied in the order they are added. Same parameters as the ones of Element.
+     */
+    BulkTransform& move(double dx, double dy);
+    BulkTransform& scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth);
+    BulkTransform& rotate(double x0, double y0, double th);
+
+    void apply(const std::vector<Element*>& elements) const;
+
+    /**
+     * Selections with fewer strokes are transformed on the calling thread
+     */
+    static constexpr size_t MIN_PARALLEL_STROKES = 64;
+
+private:
+    struct Operation {
+        enum { MOVE, SCALE, ROTATE } type;
+        double x;
+        double y;
+        double fx;
+        double fy;
+        double rotation;
+        bool restoreLineWidth;
+    };
+
+    void applyTo(Element* e) const;
+
+private:
+    std::vector<Operation> operations;
+
+    /**
+     * The operations composed, for the strokes
+     */
+    cairo_matrix_t matrix;
+    double widthFactor = 1.0;
+};
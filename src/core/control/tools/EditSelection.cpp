@@ -71,7 +71,7 @@ EditSelection::EditSelection(UndoRedoHandler* undo, Selection* selection, XojPag
         this->sourceLayer->removeElement(e, false);
     }
 
-    view->rerenderPage();
+    view->rerenderRect(this->x, this->y, this->width, this->height);
 }
 
 EditSelection::EditSelection(UndoRedoHandler* undo, Element* e, XojPageView* view, const PageRef& page):
@@ -96,7 +96,7 @@ EditSelection::EditSelection(UndoRedoHandler* undo, const vector<Element*>& elem
         this->sourceLayer->removeElement(e, false);
     }
 
-    view->rerenderPage();
+    view->rerenderRect(this->x, this->y, this->width, this->height);
 }
 
 EditSelection::EditSelection(UndoRedoHandler* undo, XojPageView* view, const PageRef& page, Layer* layer):
@@ -113,7 +113,7 @@ EditSelection::EditSelection(UndoRedoHandler* undo, XojPageView* view, const Pag
 
     layer->clearNoFree();
 
-    view->rerenderPage();
+    view->rerenderRect(this->x, this->y, this->width, this->height);
 }
 
 void EditSelection::calcSizeFromElements(vector<Element*> elements) {
@@ -1056,6 +1056,8 @@ void EditSelection::drawDeleteRect(cairo_t* cr, double x, double y, double zoom)
 
 auto EditSelection::getView() -> XojPageView* { return this->view; }
 
+void EditSelection::repaintElements() { this->contents->repaintElements(); }
+
 void EditSelection::serialize(ObjectOutputStream& out) const {
     out.writeObject("EditSelection");
 
@@ -238,6 +238,11 @@ public:
 public:
     XojPageView* getView();
 
+    /**
+     * The elements look different, e.g. the data of an image is ready: draw them again
+     */
+    void repaintElements();
+
 public:
     // Serialize interface
     void serialize(ObjectOutputStream& out) const override;
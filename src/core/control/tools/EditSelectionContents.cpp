@@ -2,6 +2,8 @@
 
 #include <cmath>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "control/Control.h"
 #include "gui/PageView.h"
@@ -26,6 +28,7 @@
 #include "util/serializing/ObjectOutputStream.h"
 #include "view/SelectionView.h"
 
+#include "BulkTransform.h"
 #include "Selection.h"
 
 using std::vector;
@@ -326,6 +329,11 @@ auto EditSelectionContents::repaintSelection(EditSelectionContents* selection) -
     return false;
 }
 
+void EditSelectionContents::repaintElements() {
+    deleteViewBuffer();
+    this->sourceView->getXournal()->repaintSelection();
+}
+
 /**
  * Delete our internal View buffer,
  * it will be recreated when the selection is painted next time
@@ -359,25 +367,33 @@ void EditSelectionContents::finalizeSelection(Rectangle<double> bounds, Rectangl
 
     bool move = mx != 0 || my != 0;
 
+    BulkTransform transform;
+    if (move) {
+        transform.move(mx, my);
+    }
+    if (scale) {
+        transform.scale(bounds.x, bounds.y, fx, fy, 0, this->restoreLineWidth);
+    }
+    if (rotate) {
+        transform.rotate(snappedBounds.x + this->lastSnappedBounds.width / 2,
+                         snappedBounds.y + this->lastSnappedBounds.height / 2, this->rotation);
+    }
+    transform.apply(this->selected);
+
     g_assert(this->selected.size() == this->insertOrder.size());
+    std::vector<Element*> appended;
+    std::vector<std::pair<Element*, Element::Index>> inserted;
     for (auto&& [e, index]: this->insertOrder) {
-        if (move) {
-            e->move(mx, my);
-        }
-        if (scale) {
-            e->scale(bounds.x, bounds.y, fx, fy, 0, this->restoreLineWidth);
-        }
-        if (rotate) {
-            e->rotate(snappedBounds.x + this->lastSnappedBounds.width / 2,
-                      snappedBounds.y + this->lastSnappedBounds.height / 2, this->rotation);
-        }
         if (index == Element::InvalidIndex) {
             // if the element didn't have a source layer (e.g, clipboard)
-            layer->addElement(e);
+            appended.push_back(e);
         } else {
-            layer->insertElement(e, index);
+            inserted.emplace_back(e, index);
         }
     }
+    // The elements without a source layer come first in the insert order
+    layer->addElements(appended);
+    layer->insertElements(inserted);
 }
 
 auto EditSelectionContents::getOriginalX() const -> double { return this->originalBounds.x; }
@@ -498,8 +514,11 @@ void EditSelectionContents::paint(cairo_t* cr, double x, double y, double rotati
         cairo_translate(cr2, -dx, -dy);
         cairo_scale(cr2, zoom, zoom);
 
+        // Drawn on the UI thread: the images being prepared are drawn once they are ready, see repaintElements()
         xoj::view::SelectionView view(this);
-        view.draw(xoj::view::Context::createDefault(cr2));
+        auto context = xoj::view::Context::createDefault(cr2);
+        context.pendingImages = xoj::view::PLACEHOLDER_FOR_PENDING_IMAGES;
+        view.draw(context);
 
         cairo_destroy(cr2);
     }
@@ -515,10 +534,12 @@ void EditSelectionContents::paint(cairo_t* cr, double x, double y, double rotati
     double sx = static_cast<double>(wTarget) / wImg;
     double sy = static_cast<double>(hTarget) / hImg;
 
-    if (wTarget != wImg || hTarget != hImg || std::abs(rotation) > __DBL_EPSILON__) {
-        if (!this->rescaleId) {
-            this->rescaleId = g_idle_add(reinterpret_cast<GSourceFunc>(repaintSelection), this);
+    if (wTarget != wImg || hTarget != hImg) {
+        // Stretch the buffer while the size changes, render it again once it settles
+        if (this->rescaleId) {
+            g_source_remove(this->rescaleId);
         }
+        this->rescaleId = g_timeout_add(RERENDER_DELAY, reinterpret_cast<GSourceFunc>(repaintSelection), this);
         cairo_scale(cr, sx, sy);
     }
 
@@ -545,7 +566,7 @@ auto EditSelectionContents::copySelection(PageRef page, XojPageView* view, doubl
         new_elems.push_back(ec);
     }
 
-    view->rerenderPage();
+    view->rerenderRect(x, y, this->originalBounds.width, this->originalBounds.height);
 
     return new InsertsUndoAction(page, layer, new_elems);
 }
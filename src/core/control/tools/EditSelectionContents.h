@@ -117,6 +117,11 @@ public:
                        bool aspectRatio, Layer* layer, const PageRef& targetPage, XojPageView* targetView,
                        UndoRedoHandler* undo, CursorSelectionType type);
 
+    /**
+     * The elements look different, e.g. the data of an image is ready: draw them again
+     */
+    void repaintElements();
+
 private:
     /**
      * Delete our internal View buffer,
@@ -208,6 +213,11 @@ private:
      */
     int rescaleId = 0;
 
+    /**
+     * Time in ms without a change of size before the buffer is rendered again at the new size
+     */
+    static constexpr unsigned int RERENDER_DELAY = 150;
+
     /**
      * Source Page for Undo operations
      */
@@ -17,6 +17,7 @@
 #include "undo/UndoRedoHandler.h"
 #include "util/Range.h"
 #include "util/Rectangle.h"
+#include "util/ParallelLoop.h"
 #include "util/SmallVector.h"
 
 EraseHandler::EraseHandler(UndoRedoHandler* undo, Document* doc, const PageRef& page, ToolHandler* handler,
@@ -36,6 +37,19 @@ EraseHandler::~EraseHandler() {
     }
 }
 
+/**
+ * Below this number of strokes under the eraser, the threads cost more than they save
+ */
+constexpr size_t MIN_STROKES_FOR_THREADS = 8;
+
+/**
+ * The threads shared by the EraseHandler%s of all the pages, only used from the UI thread
+ */
+static auto eraserLoop() -> xoj::util::ParallelLoop& {
+    static xoj::util::ParallelLoop loop;
+    return loop;
+}
+
 /**
  * Handle eraser event: "Delete Stroke" and "Standard", Whiteout is not handled here
  */
@@ -48,87 +62,116 @@ void EraseHandler::erase(double x, double y) {
 
     Layer* l = page->getSelectedLayer();
 
-    for (Element* e: l->getElements()) {
+    // Work on a copy: eraseStroke() may remove elements from the layer
+    auto candidates = l->getElementsInArea(xoj::util::Rectangle<double>(eraserRect.x, eraserRect.y,
+                                                                         eraserRect.width, eraserRect.height));
+    std::vector<Stroke*> strokes;
+    for (Element* e: candidates) {
         if (e->getType() == ELEMENT_STROKE && e->intersectsArea(&eraserRect)) {
-            eraseStroke(l, dynamic_cast<Stroke*>(e), x, y, range);
+            strokes.push_back(dynamic_cast<Stroke*>(e));
+        }
+    }
+
+    // The intersections of each stroke with the eraser only depend on the stroke: they are computed in parallel. The
+    // changes to the layer and to the undo actions follow, in the order of the layer.
+    const bool deleteStroke = this->handler->getEraserType() == ERASER_TYPE_DELETE_STROKE;
+    std::vector<StrokeIntersection> intersections(strokes.size(), StrokeIntersection(x, y));
+    auto intersect = [&](size_t i) { intersectStroke(strokes[i], x, y, deleteStroke, intersections[i]); };
+    if (strokes.size() >= MIN_STROKES_FOR_THREADS) {
+        eraserLoop().run(strokes.size(), intersect);
+    } else {
+        for (size_t i = 0; i < strokes.size(); i++) {
+            intersect(i);
         }
     }
 
+    for (size_t i = 0; i < strokes.size(); i++) {
+        eraseStroke(l, strokes[i], x, y, intersections[i], range);
+    }
+
     this->view->rerenderRange(range);
 }
 
-void EraseHandler::eraseStroke(Layer* l, Stroke* s, double x, double y, Range& range) {
-    ErasableStroke* erasable = s->getErasable();
-    if (!erasable) {
-        if (this->handler->getEraserType() == ERASER_TYPE_DELETE_STROKE) {
-            if (!s->intersects(x, y, halfEraserSize)) {
-                // The stroke does not intersect the eraser square
-                return;
-            }
-
-            // delete the entire stroke
-            this->doc->lock();
-            auto pos = l->removeElement(s, false);
-            this->doc->unlock();
-
-            if (pos == -1) {
-                return;
-            }
-            range.addPoint(s->getX(), s->getY());
-            range.addPoint(s->getX() + s->getElementWidth(), s->getY() + s->getElementHeight());
-
-            // removed the if statement - this prevents us from putting multiple elements into a
-            // stroke erase operation, but it also prevents the crashing and layer issues!
-            if (!this->eraseDeleteUndoAction) {
-                auto eraseDel = std::make_unique<DeleteUndoAction>(this->page, true);
-                // Todo check dangerous: this->eraseDeleteUndoAction could be a dangling reference
-                this->eraseDeleteUndoAction = eraseDel.get();
-                this->undo->addUndoAction(std::move(eraseDel));
-            }
-
-            this->eraseDeleteUndoAction->addElement(l, s, pos);
-        } else {  // Default eraser
-            auto pos = l->indexOf(s);
-            if (pos == -1) {
-                return;
-            }
-
-            const double paddingCoeff = PADDING_COEFFICIENT_CAP[s->getStrokeCapStyle()];
-            const PaddedBox paddedEraserBox{{x, y}, halfEraserSize, halfEraserSize + paddingCoeff * s->getWidth()};
-            auto intersectionParameters = s->intersectWithPaddedBox(paddedEraserBox);
-
-            if (intersectionParameters.empty()) {
-                // The stroke does not intersect the eraser square
-                return;
-            }
-
-            if (this->eraseUndoAction == nullptr) {
-                auto eraseUndo = std::make_unique<EraseUndoAction>(this->page);
-                // Todo check dangerous: this->eraseDeleteUndoAction could be a dangling reference
-                this->eraseUndoAction = eraseUndo.get();
-                this->undo->addUndoAction(std::move(eraseUndo));
-            }
-
-            doc->lock();
-            erasable = new ErasableStroke(*s);
-            s->setErasable(erasable);
-            doc->unlock();
-            this->eraseUndoAction->addOriginal(l, s, pos);
-            erasable->beginErasure(intersectionParameters, range);
-            paddedEraserBox.addToRange(range);
-        }
-    } else {
+void EraseHandler::intersectStroke(Stroke* s, double x, double y, bool deleteStroke,
+                                   StrokeIntersection& intersection) const {
+    std::shared_ptr<ErasableStroke> erasable = s->getErasable();
+    if (erasable) {
         /**
          * This stroke has already been touched by the eraser
          * (Necessarily the default eraser)
          */
+        const double paddingCoeff = PADDING_COEFFICIENT_CAP[s->getStrokeCapStyle()];
+        const PaddedBox paddedEraserBox{{x, y}, halfEraserSize, halfEraserSize + paddingCoeff * s->getWidth()};
+        erasable->erase(paddedEraserBox, intersection.range);
+        intersection.erased = true;
+    } else if (deleteStroke) {
+        intersection.hit = s->intersects(x, y, halfEraserSize);
+    } else {
+        const double paddingCoeff = PADDING_COEFFICIENT_CAP[s->getStrokeCapStyle()];
+        const PaddedBox paddedEraserBox{{x, y}, halfEraserSize, halfEraserSize + paddingCoeff * s->getWidth()};
+        intersection.parameters = s->intersectWithPaddedBox(paddedEraserBox);
+        intersection.hit = !intersection.parameters.empty();
+    }
+}
+
+void EraseHandler::eraseStroke(Layer* l, Stroke* s, double x, double y, StrokeIntersection& intersection,
+                               Range& range) {
+    if (intersection.erased) {
+        // Already erased from the stroke, only the area to rerender is left
+        range.addPoint(intersection.range.getX(), intersection.range.getY());
+        range.addPoint(intersection.range.getX2(), intersection.range.getY2());
+        return;
+    }
+    if (!intersection.hit) {
+        // The stroke does not intersect the eraser square
+        return;
+    }
+
+    if (this->handler->getEraserType() == ERASER_TYPE_DELETE_STROKE) {
+        // delete the entire stroke
+        this->doc->lockPage(*this->page);
+        auto pos = l->removeElement(s, false);
+        this->doc->unlockPage(*this->page);
+
+        if (pos == -1) {
+            return;
+        }
+        range.addPoint(s->getX(), s->getY());
+        range.addPoint(s->getX() + s->getElementWidth(), s->getY() + s->getElementHeight());
+
+        // removed the if statement - this prevents us from putting multiple elements into a
+        // stroke erase operation, but it also prevents the crashing and layer issues!
+        if (!this->eraseDeleteUndoAction) {
+            auto eraseDel = std::make_unique<DeleteUndoAction>(this->page, true);
+            // Todo check dangerous: this->eraseDeleteUndoAction could be a dangling reference
+            this->eraseDeleteUndoAction = eraseDel.get();
+            this->undo->addUndoAction(std::move(eraseDel));
+        }
+
+        this->eraseDeleteUndoAction->addElement(l, s, pos);
+    } else {  // Default eraser
         auto pos = l->indexOf(s);
         if (pos == -1) {
             return;
         }
+
+        if (this->eraseUndoAction == nullptr) {
+            auto eraseUndo = std::make_unique<EraseUndoAction>(this->page);
+            // Todo check dangerous: this->eraseDeleteUndoAction could be a dangling reference
+            this->eraseUndoAction = eraseUndo.get();
+            this->undo->addUndoAction(std::move(eraseUndo));
+        }
+
         const double paddingCoeff = PADDING_COEFFICIENT_CAP[s->getStrokeCapStyle()];
         const PaddedBox paddedEraserBox{{x, y}, halfEraserSize, halfEraserSize + paddingCoeff * s->getWidth()};
-        erasable->erase(paddedEraserBox, range);
+
+        doc->lockPage(*this->page);
+        auto erasable = std::make_shared<ErasableStroke>(*s);
+        s->setErasable(erasable);
+        doc->unlockPage(*this->page);
+        this->eraseUndoAction->addOriginal(l, s, pos);
+        erasable->beginErasure(intersection.parameters, range);
+        paddedEraserBox.addToRange(range);
     }
 }
 
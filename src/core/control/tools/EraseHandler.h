@@ -15,15 +15,15 @@
 #include <vector>
 
 #include "model/PageRef.h"
+#include "model/Stroke.h"
+#include "util/Range.h"
 
 
 class DeleteUndoAction;
 class Document;
 class EraseUndoAction;
 class Layer;
-class Range;
 class Redrawable;
-class Stroke;
 class ToolHandler;
 class UndoRedoHandler;
 
@@ -37,7 +37,40 @@ public:
     void finalize();
 
 private:
-    void eraseStroke(Layer* l, Stroke* s, double x, double y, Range& range);
+    /**
+     * How the eraser intersects a stroke
+     */
+    struct StrokeIntersection {
+        StrokeIntersection(double x, double y): range(x, y) {}
+
+        /**
+         * The stroke was already being erased, and it was erased further
+         */
+        bool erased = false;
+
+        /**
+         * The stroke is not being erased yet, and the eraser intersects it
+         */
+        bool hit = false;
+
+        IntersectionParametersContainer parameters;
+
+        /**
+         * The area to rerender, if erased
+         */
+        Range range;
+    };
+
+    /**
+     * Find the intersection of the eraser with the stroke, and erase it further if it is already being erased.
+     * Changes nothing but the ErasableStroke of the stroke: called on several strokes in parallel.
+     */
+    void intersectStroke(Stroke* s, double x, double y, bool deleteStroke, StrokeIntersection& intersection) const;
+
+    /**
+     * Apply the intersection to the layer and to the undo actions
+     */
+    void eraseStroke(Layer* l, Stroke* s, double x, double y, StrokeIntersection& intersection, Range& range);
 
 private:
     PageRef page;
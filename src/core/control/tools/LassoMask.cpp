@@ -0,0 +1,201 @@
+#include "LassoMask.h"
+
+#include <algorithm>
+#include <cmath>
+
+using xoj::util::Rectangle;
+
+LassoMask::LassoMask(const Rectangle<double>& area, double cellSize) {
+    this->cellSize = std::max(cellSize, std::sqrt(area.width * area.height / static_cast<double>(MAX_CELLS)));
+    this->originX = area.x;
+    this->originY = area.y;
+    this->columns = std::max<std::ptrdiff_t>(1, static_cast<std::ptrdiff_t>(std::ceil(area.width / this->cellSize)));
+    this->rows = std::max<std::ptrdiff_t>(1, static_cast<std::ptrdiff_t>(std::ceil(area.height / this->cellSize)));
+    this->cells.assign(static_cast<size_t>(this->columns * this->rows), OUTSIDE);
+}
+
+void LassoMask::addPoint(double x, double y) {
+    Point p(x, y);
+    if (this->points.empty()) {
+        this->points.push_back(p);
+        this->minX = this->maxX = x;
+        this->minY = this->maxY = y;
+        return;
+    }
+
+    const Point first = this->points.front();
+    const Point previous = this->points.back();
+    this->points.push_back(p);
+
+    this->minX = std::min(this->minX, x);
+    this->maxX = std::max(this->maxX, x);
+    this->minY = std::min(this->minY, y);
+    this->maxY = std::max(this->maxY, y);
+
+    // The edge from previous to first was marked with previous
+    markEdge(previous, p);
+    markEdge(p, first);
+    flipTriangle(first, previous, p);
+}
+
+auto LassoMask::getPoints() const -> const std::vector<Point>& { return this->points; }
+
+auto LassoMask::getBoundingBox() const -> Rectangle<double> {
+    return {this->minX, this->minY, this->maxX - this->minX, this->maxY - this->minY};
+}
+
+auto LassoMask::column(double x) const -> std::ptrdiff_t {
+    double c = std::floor((x - this->originX) / this->cellSize);
+    return static_cast<std::ptrdiff_t>(std::clamp(c, -1.0, static_cast<double>(this->columns)));
+}
+
+auto LassoMask::row(double y) const -> std::ptrdiff_t {
+    double r = std::floor((y - this->originY) / this->cellSize);
+    return static_cast<std::ptrdiff_t>(std::clamp(r, -1.0, static_cast<double>(this->rows)));
+}
+
+void LassoMask::markEdge(const Point& a, const Point& b) {
+    const Point& top = a.y <= b.y ? a : b;
+    const Point& bottom = a.y <= b.y ? b : a;
+
+    std::ptrdiff_t firstRow = std::max<std::ptrdiff_t>(row(top.y), 0);
+    std::ptrdiff_t lastRow = std::min(row(bottom.y), this->rows - 1);
+
+    for (std::ptrdiff_t r = firstRow; r <= lastRow; r++) {
+        double x1 = top.x;
+        double x2 = bottom.x;
+        if (top.y != bottom.y) {
+            // The part of the edge within the row
+            double rowTop = std::max(this->originY + static_cast<double>(r) * this->cellSize, top.y);
+            double rowBottom = std::min(this->originY + static_cast<double>(r + 1) * this->cellSize, bottom.y);
+            double slope = (bottom.x - top.x) / (bottom.y - top.y);
+            x1 = top.x + (rowTop - top.y) * slope;
+            x2 = top.x + (rowBottom - top.y) * slope;
+        }
+
+        // One more cell on each side, for the rounding errors
+        std::ptrdiff_t firstColumn = std::max<std::ptrdiff_t>(column(std::min(x1, x2)) - 1, 0);
+        std::ptrdiff_t lastColumn = std::min(column(std::max(x1, x2)) + 1, this->columns - 1);
+        for (std::ptrdiff_t c = firstColumn; c <= lastColumn; c++) {
+            this->cells[static_cast<size_t>(r * this->columns + c)] = EDGE;
+        }
+    }
+}
+
+void LassoMask::flipTriangle(const Point& a, const Point& b, const Point& c) {
+    auto cross = [](const Point& o, const Point& p, double x, double y) {
+        return (p.x - o.x) * (y - o.y) - (p.y - o.y) * (x - o.x);
+    };
+
+    double orientation = cross(a, b, c.x, c.y);
+    if (orientation == 0) {
+        return;
+    }
+
+    std::ptrdiff_t firstRow = std::max<std::ptrdiff_t>(row(std::min({a.y, b.y, c.y})), 0);
+    std::ptrdiff_t lastRow = std::min(row(std::max({a.y, b.y, c.y})), this->rows - 1);
+    std::ptrdiff_t firstColumn = std::max<std::ptrdiff_t>(column(std::min({a.x, b.x, c.x})), 0);
+    std::ptrdiff_t lastColumn = std::min(column(std::max({a.x, b.x, c.x})), this->columns - 1);
+
+    for (std::ptrdiff_t r = firstRow; r <= lastRow; r++) {
+        double y = this->originY + (static_cast<double>(r) + 0.5) * this->cellSize;
+        for (std::ptrdiff_t col = firstColumn; col <= lastColumn; col++) {
+            Cell& cell = this->cells[static_cast<size_t>(r * this->columns + col)];
+            if (cell == EDGE) {
+                continue;
+            }
+            // No edge crosses the cell: it lies inside the triangle if its center does
+            double x = this->originX + (static_cast<double>(col) + 0.5) * this->cellSize;
+            double s1 = cross(a, b, x, y);
+            double s2 = cross(b, c, x, y);
+            double s3 = cross(c, a, x, y);
+            bool inside = orientation > 0 ? s1 > 0 && s2 > 0 && s3 > 0 : s1 < 0 && s2 < 0 && s3 < 0;
+            if (inside) {
+                cell = cell == INSIDE ? OUTSIDE : INSIDE;
+            }
+        }
+    }
+}
+
+auto LassoMask::contains(double x, double y) const -> bool {
+    if (this->points.size() <= 2) {
+        return false;
+    }
+    if (x < this->minX || x > this->maxX || y < this->minY || y > this->maxY) {
+        return false;
+    }
+
+    std::ptrdiff_t r = row(y);
+    std::ptrdiff_t c = column(x);
+    if (r >= 0 && r < this->rows && c >= 0 && c < this->columns) {
+        Cell cell = this->cells[static_cast<size_t>(r * this->columns + c)];
+        if (cell != EDGE) {
+            return cell == INSIDE;
+        }
+    }
+
+    return polygonContains(x, y);
+}
+
+auto LassoMask::polygonContains(double x, double y) const -> bool {
+    int hits = 0;
+
+    const Point& last = points.back();
+
+    double lastx = last.x;
+    double lasty = last.y;
+    double curx = NAN, cury = NAN;
+
+    // Walk the edges of the polygon
+    for (auto pointIterator = points.begin(); pointIterator != points.end();
+         lastx = curx, lasty = cury, ++pointIterator) {
+        curx = pointIterator->x;
+        cury = pointIterator->y;
+
+        if (cury == lasty) {
+            continue;
+        }
+
+        int leftx = 0;
+        if (curx < lastx) {
+            if (x >= lastx) {
+                continue;
+            }
+            leftx = static_cast<int>(curx);
+        } else {
+            if (x >= curx) {
+                continue;
+            }
+            leftx = static_cast<int>(lastx);
+        }
+
+        double test1 = NAN, test2 = NAN;
+        if (cury < lasty) {
+            if (y < cury || y >= lasty) {
+                continue;
+            }
+            if (x < leftx) {
+                hits++;
+                continue;
+            }
+            test1 = x - curx;
+            test2 = y - cury;
+        } else {
+            if (y < lasty || y >= cury) {
+                continue;
+            }
+            if (x < leftx) {
+                hits++;
+                continue;
+            }
+            test1 = x - lastx;
+            test2 = y - lasty;
+        }
+
+        if (test1 < (test2 / (lasty - cury) * (lastx - curx))) {
+            hits++;
+        }
+    }
+
+    return (hits & 1) != 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * Xournal++
+ *
+ * Coarse raster of the inside of a lasso, updated point by point
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "model/Point.h"
+#include "util/Rectangle.h"
+
+/**
+ * @brief The lasso polygon and a grid telling, for each of its cells, whether the cell is inside the polygon, outside
+ * of it, or crossed by one of its edges
+ *
+ * The polygon is implicitly closed by an edge from its last point to its first one. Adding a point replaces this edge
+ * by two edges: the even-odd inside of the polygon only changes in the triangle they form with it, so are the cells.
+ *
+ * contains() answers from the grid when the cell is not crossed by an edge, and from the polygon otherwise.
+ */
+class LassoMask {
+public:
+    /**
+     * @param area The area covered by the grid, typically the page. The points outside of it are tested against the
+     *             polygon.
+     */
+    explicit LassoMask(const xoj::util::Rectangle<double>& area, double cellSize = CELL_SIZE);
+
+public:
+    void addPoint(double x, double y);
+
+    /**
+     * Even-odd test, false while there are fewer than 3 points
+     */
+    bool contains(double x, double y) const;
+
+    const std::vector<Point>& getPoints() const;
+
+    /**
+     * @return The bounding box of the points, empty while there is none
+     */
+    xoj::util::Rectangle<double> getBoundingBox() const;
+
+    /**
+     * Side of the cells, in page coordinates
+     */
+    static constexpr double CELL_SIZE = 2.0;
+
+    /**
+     * Larger areas get larger cells
+     */
+    static constexpr size_t MAX_CELLS = 1U << 22U;
+
+private:
+    enum Cell : uint8_t { OUTSIDE, INSIDE, EDGE };
+
+    /**
+     * Exact even-odd test against the polygon
+     */
+    bool polygonContains(double x, double y) const;
+
+    void markEdge(const Point& a, const Point& b);
+    void flipTriangle(const Point& a, const Point& b, const Point& c);
+
+    /**
+     * @return -1 if x lies left of the grid, columns if it lies to its right
+     */
+    std::ptrdiff_t column(double x) const;
+    std::ptrdiff_t row(double y) const;
+
+private:
+    std::vector<Point> points;
+
+    double minX = 0;
+    double minY = 0;
+    double maxX = 0;
+    double maxY = 0;
+
+    double originX;
+    double originY;
+    double cellSize;
+    std::ptrdiff_t columns;
+    std::ptrdiff_t rows;
+    std::vector<Cell> cells;
+};
@@ -1,10 +1,12 @@
 #include "PdfElemSelection.h"
 
+#include <cmath>
 #include <limits>
 
 #include <cairo.h>
 
 #include "control/Control.h"
+#include "control/PdfTextLayout.h"
 #include "gui/XournalView.h"
 #include "pdf/base/XojPdfPage.h"
 
@@ -49,6 +51,13 @@ bool PdfElemSelection::finalizeSelection(XojPdfPageSelectionStyle style) {
         cairo_region_destroy(this->selectedTextRegion);
     }
 
+    if (const PdfTextLayout* textLayout = getTextLayout()) {
+        this->selectedTextRects = textLayout->selectTextLines(this->bounds, style);
+        this->selectedTextRegion = regionFromRects(this->selectedTextRects);
+        this->selectedText = textLayout->selectText(this->bounds, style);
+        return !this->selectedTextRects.empty();
+    }
+
     XojPdfPage::TextSelection selection = this->pdf->selectTextLines(this->bounds, style);
     this->selectedTextRegion = selection.region;
     this->selectedTextRects = std::move(selection.rects);
@@ -56,6 +65,26 @@ bool PdfElemSelection::finalizeSelection(XojPdfPageSelectionStyle style) {
     return !this->selectedTextRects.empty();
 }
 
+auto PdfElemSelection::getTextLayout() -> const PdfTextLayout* {
+    if (!this->layout && this->selectionPageNr != npos) {
+        this->layout = this->view->getXournal()->getPdfTextLayout(this->selectionPageNr);
+    }
+    return this->layout.get();
+}
+
+auto PdfElemSelection::regionFromRects(const std::vector<XojPdfRectangle>& rects) -> cairo_region_t* {
+    cairo_region_t* region = cairo_region_create();
+    for (const XojPdfRectangle& r: rects) {
+        auto x = static_cast<int>(std::floor(r.x1));
+        auto y = static_cast<int>(std::floor(r.y1));
+        auto width = static_cast<int>(std::ceil(r.x2)) - x;
+        auto height = static_cast<int>(std::ceil(r.y2)) - y;
+        cairo_rectangle_int_t crect = {x, y, width, height};
+        cairo_region_union_rectangle(region, &crect);
+    }
+    return region;
+}
+
 void PdfElemSelection::paint(cairo_t* cr, XojPdfPageSelectionStyle style) {
     if (!this->pdf)
         return;
@@ -157,7 +186,12 @@ auto PdfElemSelection::selectTextRegion(XojPdfPageSelectionStyle style) -> bool
         cairo_region_destroy(this->selectedTextRegion);
     }
 
-    this->selectedTextRegion = this->pdf->selectTextRegion(this->bounds, style);
+    // Called on each motion: the layout avoids laying the page out again
+    if (const PdfTextLayout* textLayout = getTextLayout()) {
+        this->selectedTextRegion = regionFromRects(textLayout->selectTextLines(this->bounds, style));
+    } else {
+        this->selectedTextRegion = this->pdf->selectTextRegion(this->bounds, style);
+    }
     g_assert_nonnull(this->selectedTextRegion);
 
     return !cairo_region_is_empty(this->selectedTextRegion);
@@ -10,6 +10,7 @@
  */
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,8 @@
 #include "model/PageRef.h"
 #include "pdf/base/XojPdfPage.h"
 
+class PdfTextLayout;
+
 /// Represents elements selected from a PDF page, such as text.
 class PdfElemSelection {
 public:
@@ -75,8 +78,15 @@ private:
     /// Assigns the selected text region to the current selection bounds.
     bool selectTextRegion(XojPdfPageSelectionStyle style);
 
+    /// The text layout of the page, once it is extracted. Until then, Poppler is queried.
+    const PdfTextLayout* getTextLayout();
+
+    /// @return A new region of the rectangles
+    static cairo_region_t* regionFromRects(const std::vector<XojPdfRectangle>& rects);
+
     XojPageView* view;
     XojPdfPageSPtr pdf;
+    std::shared_ptr<const PdfTextLayout> layout;
 
     /// The rectangles corresponding to the lines of selected text.
     std::vector<XojPdfRectangle> selectedTextRects;
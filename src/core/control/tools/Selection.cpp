@@ -116,20 +116,16 @@ void RectSelection::paint(cairo_t* cr, double zoom) {
 
 //////////////////////////////////////////////////////////
 
-class RegionPoint {
-public:
-    RegionPoint(double x, double y) {
-        this->x = x;
-        this->y = y;
-    }
-
-    double x;
-    double y;
-};
-
-RegionSelect::RegionSelect(double x, double y, Redrawable* view): Selection(view) { currentPos(x, y); }
+RegionSelect::RegionSelect(double x, double y, const PageRef& page, Redrawable* view):
+        Selection(view),
+        mask(xoj::util::Rectangle<double>(0, 0, page->getWidth(), page->getHeight())),
+        layer(page->getSelectedLayer()) {
+    this->page = page;
+    currentPos(x, y);
+}
 
 void RegionSelect::paint(cairo_t* cr, double zoom) {
+    const auto& points = this->mask.getPoints();
     // at least three points needed
     if (points.size() >= 3) {
         GdkRGBA selectionColor = view->getSelectionColor();
@@ -138,7 +134,7 @@ void RegionSelect::paint(cairo_t* cr, double zoom) {
         cairo_set_line_width(cr, 1 / zoom);
         gdk_cairo_set_source_rgba(cr, &selectionColor);
 
-        const RegionPoint& r0 = points.front();
+        const Point& r0 = points.front();
         cairo_move_to(cr, r0.x, r0.y);
 
         for (auto pointIterator = points.begin() + 1; pointIterator != points.end(); ++pointIterator) {
@@ -155,118 +151,88 @@ void RegionSelect::paint(cairo_t* cr, double zoom) {
 }
 
 void RegionSelect::currentPos(double x, double y) {
-    points.emplace_back(x, y);
+    const auto& points = this->mask.getPoints();
+    if (points.empty()) {
+        this->mask.addPoint(x, y);
+        return;
+    }
 
-    // at least three points needed
-    if (points.size() >= 3) {
-        const RegionPoint& r0 = points.front();
-        double ax = r0.x;
-        double bx = r0.x;
-        double ay = r0.y;
-        double by = r0.y;
-
-        for (const RegionPoint& p: points) {
-            ax = std::min(ax, p.x);
-            bx = std::max(bx, p.x);
-            ay = std::min(ay, p.y);
-            by = std::max(by, p.y);
+    // The lasso, its outline and its fill only change in this triangle
+    const Point& first = points.front();
+    const Point& previous = points.back();
+    double ax = std::min({first.x, previous.x, x});
+    double bx = std::max({first.x, previous.x, x});
+    double ay = std::min({first.y, previous.y, y});
+    double by = std::max({first.y, previous.y, y});
+
+    this->mask.addPoint(x, y);
+
+    if (this->layer) {
+        for (Element* e: this->layer->getElementsInArea(xoj::util::Rectangle<double>(ax, ay, bx - ax, by - ay))) {
+            invalidate(e);
         }
+        evaluatePending(std::chrono::steady_clock::now() + EVALUATION_BUDGET);
+    }
 
+    // at least three points needed
+    if (points.size() >= 3) {
         view->repaintArea(ax, ay, bx, by);
     }
 }
 
-auto RegionSelect::contains(double x, double y) -> bool {
-    if (x < this->x1Box || x > this->x2Box) {
-        return false;
-    }
-    if (y < this->y1Box || y > this->y2Box) {
-        return false;
-    }
-    if (points.size() <= 2) {
-        return false;
+void RegionSelect::invalidate(Element* e) {
+    auto [it, inserted] = this->evaluations.emplace(e, Evaluation::PENDING);
+    if (inserted || it->second != Evaluation::PENDING) {
+        it->second = Evaluation::PENDING;
+        this->pending.push_back(e);
     }
+}
 
-    int hits = 0;
-
-    const RegionPoint& last = points.back();
-
-    double lastx = last.x;
-    double lasty = last.y;
-    double curx = NAN, cury = NAN;
-
-    // Walk the edges of the polygon
-    for (auto pointIterator = points.begin(); pointIterator != points.end();
-         lastx = curx, lasty = cury, ++pointIterator) {
-        curx = pointIterator->x;
-        cury = pointIterator->y;
-
-        if (cury == lasty) {
-            continue;
-        }
-
-        int leftx = 0;
-        if (curx < lastx) {
-            if (x >= lastx) {
-                continue;
-            }
-            leftx = static_cast<int>(curx);
-        } else {
-            if (x >= curx) {
-                continue;
-            }
-            leftx = static_cast<int>(lastx);
-        }
-
-        double test1 = NAN, test2 = NAN;
-        if (cury < lasty) {
-            if (y < cury || y >= lasty) {
-                continue;
-            }
-            if (x < leftx) {
-                hits++;
-                continue;
-            }
-            test1 = x - curx;
-            test2 = y - cury;
-        } else {
-            if (y < lasty || y >= cury) {
-                continue;
-            }
-            if (x < leftx) {
-                hits++;
-                continue;
-            }
-            test1 = x - lastx;
-            test2 = y - lasty;
-        }
-
-        if (test1 < (test2 / (lasty - cury) * (lastx - curx))) {
-            hits++;
-        }
+void RegionSelect::evaluatePending(std::chrono::steady_clock::time_point deadline) {
+    while (!this->pending.empty() && std::chrono::steady_clock::now() < deadline) {
+        Element* e = this->pending.back();
+        this->pending.pop_back();
+        this->evaluations[e] = isInLasso(e) ? Evaluation::INSIDE : Evaluation::OUTSIDE;
     }
+}
 
-    return (hits & 1) != 0;
+auto RegionSelect::isInLasso(Element* e) -> bool {
+    // The points tested by isInSelection() all lie in these bounds
+    auto bounds = e->getType() == ELEMENT_STROKE ? e->getSnappedBounds() : e->boundingRect();
+    auto lasso = this->mask.getBoundingBox();
+    if (bounds.x < lasso.x || bounds.y < lasso.y || bounds.x + bounds.width > lasso.x + lasso.width ||
+        bounds.y + bounds.height > lasso.y + lasso.height) {
+        return false;
+    }
+    return e->isInSelection(this);
 }
 
+auto RegionSelect::contains(double x, double y) -> bool { return this->mask.contains(x, y); }
+
 auto RegionSelect::finalize(PageRef page) -> bool {
     this->page = page;
 
-    this->x1Box = DBL_MAX;
-    this->x2Box = 0;
-    this->y1Box = DBL_MAX;
-    this->y2Box = 0;
+    auto box = this->mask.getBoundingBox();
+    this->x1Box = box.x;
+    this->x2Box = box.x + box.width;
+    this->y1Box = box.y;
+    this->y2Box = box.y + box.height;
 
-    for (const RegionPoint& p: points) {
-        this->x1Box = std::min(this->x1Box, p.x);
-        this->x2Box = std::max(this->x2Box, p.x);
-        this->y1Box = std::min(this->y1Box, p.y);
-        this->y2Box = std::max(this->y2Box, p.y);
+    Layer* l = page->getSelectedLayer();
+    if (l != this->layer) {
+        // Not the layer indexed while drawing the lasso
+        this->layer = l;
+        this->evaluations.clear();
+        this->pending.clear();
+        for (Element* e: l->getElements()) {
+            invalidate(e);
+        }
     }
+    evaluatePending(std::chrono::steady_clock::time_point::max());
 
-    Layer* l = page->getSelectedLayer();
     for (Element* e: l->getElements()) {
-        if (e->isInSelection(this)) {
+        auto it = this->evaluations.find(e);
+        if (it != this->evaluations.end() && it->second == Evaluation::INSIDE) {
             this->selectedElements.push_back(e);
         }
     }
@@ -278,8 +244,9 @@ auto RegionSelect::finalize(PageRef page) -> bool {
 
 auto RegionSelect::userTapped(double zoom) -> bool {
     double maxDist = 10 / zoom;
-    const RegionPoint& r0 = points.front();
-    for (const RegionPoint& p: points) {
+    const auto& points = this->mask.getPoints();
+    const Point& r0 = points.front();
+    for (const Point& p: points) {
         if (std::abs(r0.x - p.x) > maxDist || std::abs(r0.y - p.y) > maxDist) {
             return false;
         }
@@ -11,7 +11,9 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "gui/Redrawable.h"
@@ -19,6 +21,8 @@
 #include "model/PageRef.h"
 #include "util/Util.h"
 
+#include "LassoMask.h"
+
 
 class Selection: public ShapeContainer {
 public:
@@ -73,11 +77,18 @@ private:
     double y2;
 };
 
-class RegionPoint;
+class Layer;
 
+/**
+ * @brief Lasso selection, computed while the lasso is drawn
+ *
+ * Each new point of the lasso only changes its inside in the triangle formed with the previous point and the first
+ * one. The elements whose bounding box meets this triangle are tested again, for a bounded time per point: finalize()
+ * only tests those left.
+ */
 class RegionSelect: public Selection {
 public:
-    RegionSelect(double x, double y, Redrawable* view);
+    RegionSelect(double x, double y, const PageRef& page, Redrawable* view);
 
 public:
     bool finalize(PageRef page) override;
@@ -86,6 +97,34 @@ public:
     bool contains(double x, double y) override;
     bool userTapped(double zoom) override;
 
+    /**
+     * Time spent testing elements for each point of the lasso
+     */
+    static constexpr std::chrono::milliseconds EVALUATION_BUDGET{2};
+
 private:
-    std::vector<RegionPoint> points;
+    enum class Evaluation { PENDING, INSIDE, OUTSIDE };
+
+    void invalidate(Element* e);
+
+    /**
+     * Test the pending elements until the deadline
+     */
+    void evaluatePending(std::chrono::steady_clock::time_point deadline);
+
+    bool isInLasso(Element* e);
+
+private:
+    LassoMask mask;
+
+    /**
+     * The layer the elements are selected from
+     */
+    Layer* layer;
+
+    /**
+     * The elements whose bounding box met the lasso, the others are outside of it
+     */
+    std::unordered_map<Element*, Evaluation> evaluations;
+    std::vector<Element*> pending;
 };
@@ -1,9 +1,18 @@
 #include "SnapToGridInputHandler.h"
 
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
 #include "control/settings/Settings.h"
+#include "model/Layer.h"
 #include "model/Snapping.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+#include "util/Rectangle.h"
 
-SnapToGridInputHandler::SnapToGridInputHandler(Settings* settings): settings(settings) {}
+SnapToGridInputHandler::SnapToGridInputHandler(Settings* settings, PageRef page):
+        settings(settings), page(std::move(page)) {}
 
 double SnapToGridInputHandler::snapVertically(double y, bool alt) {
     if (alt != settings->isSnapGrid()) {
@@ -20,6 +29,9 @@ double SnapToGridInputHandler::snapHorizontally(double x, bool alt) {
 }
 
 Point SnapToGridInputHandler::snapToGrid(Point const& pos, bool alt) {
+    if (auto endpoint = snapToStrokeEndpoint(pos, alt)) {
+        return *endpoint;
+    }
     if (alt != settings->isSnapGrid()) {
         return Snapping::snapToGrid(pos, settings->getSnapGridSize(), settings->getSnapGridTolerance());
     }
@@ -40,7 +52,59 @@ Point SnapToGridInputHandler::snapRotation(Point const& pos, Point const& center
     return pos;
 }
 
+std::optional<Point> SnapToGridInputHandler::snapToStrokeEndpoint(Point const& pos, bool alt) {
+    if (!page || alt || !settings->getSnapStrokeEndpointsEnabled()) {
+        return std::nullopt;
+    }
+    Layer* layer = page->getSelectedLayer();
+    if (!layer) {
+        return std::nullopt;
+    }
+
+    // The same tolerance as for snapping to a grid point
+    const double tolerance = settings->getSnapGridSize() / std::sqrt(2) * settings->getSnapGridTolerance();
+    xoj::util::Rectangle<double> area{pos.x - tolerance, pos.y - tolerance, 2 * tolerance, 2 * tolerance};
+
+    std::optional<Point> nearest;
+    double minDist = tolerance;
+    for (Element* e: layer->getElementsInArea(area)) {
+        if (e->getType() != ELEMENT_STROKE) {
+            continue;
+        }
+        auto* stroke = dynamic_cast<Stroke*>(e);
+        if (stroke->getPointCount() == 0) {
+            continue;
+        }
+        for (const Point& p: {stroke->getPoint(0), stroke->getPoint(stroke->getPointCount() - 1)}) {
+            double dist = std::hypot(p.x - pos.x, p.y - pos.y);
+            if (dist < minDist) {
+                minDist = dist;
+                nearest = Point(p.x, p.y, pos.z);
+            }
+        }
+    }
+    return nearest;
+}
+
 Point SnapToGridInputHandler::snap(Point const& pos, Point const& center, bool alt) {
+    if (auto endpoint = snapToStrokeEndpoint(pos, alt)) {
+        return *endpoint;
+    }
     Point rotationSnappedPoint{snapRotation(pos, center, alt)};
     return snapToGrid(rotationSnappedPoint, alt);
 }
+
+void SnapToGridInputHandler::snapShapeToGrid(Stroke* shape) {
+    xoj::util::Rectangle<double> oldBounds = shape->getSnappedBounds();
+    Point topLeft = Point(oldBounds.x, oldBounds.y);
+    Point topLeftSnapped = snapToGrid(topLeft, false);
+
+    shape->move(topLeftSnapped.x - topLeft.x, topLeftSnapped.y - topLeft.y);
+    xoj::util::Rectangle<double> bounds = shape->getSnappedBounds();
+    Point belowRight = Point(bounds.x + bounds.width, bounds.y + bounds.height);
+    Point belowRightSnapped = snapToGrid(belowRight, false);
+
+    double fx = (std::abs(bounds.width) > DBL_EPSILON) ? (belowRightSnapped.x - topLeftSnapped.x) / bounds.width : 1;
+    double fy = (std::abs(bounds.height) > DBL_EPSILON) ? (belowRightSnapped.y - topLeftSnapped.y) / bounds.height : 1;
+    shape->scale(topLeftSnapped.x, topLeftSnapped.y, fx, fy, 0, false);
+}
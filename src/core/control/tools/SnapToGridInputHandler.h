@@ -10,17 +10,26 @@
  */
 #pragma once
 
+#include <optional>
+
+#include "model/PageRef.h"
 #include "model/Point.h"
 
 class Settings;
+class Stroke;
 
 class SnapToGridInputHandler final {
 
 public:
-    SnapToGridInputHandler(Settings* settings);
+    /**
+     * @param page The page whose current layer has the strokes to snap to, see snapToStrokeEndpoint(). None for no
+     * stroke snapping.
+     */
+    SnapToGridInputHandler(Settings* settings, PageRef page = nullptr);
 
 protected:
     const Settings* settings;
+    PageRef page;
 
 public:
     /**
@@ -47,6 +56,16 @@ public:
      */
     [[nodiscard]] Point snapToGrid(Point const& pos, bool alt);
 
+    /**
+     * @brief If snapping to the strokes is enabled and an end point of a stroke of the current layer is within the grid
+     * snapping tolerance, it returns the nearest one. The strokes near the point are looked up with the spatial index
+     * of the layer: the cost does not depend on the number of strokes.
+     * Used by snapToGrid() and snap(), which prefer the end points to the grid.
+     * @param pos the position
+     * @param alt indicates whether snapping mode is altered (via the Alt key): no stroke snapping
+     */
+    [[nodiscard]] std::optional<Point> snapToStrokeEndpoint(Point const& pos, bool alt);
+
     /**
      * @brief if the angles distance to a multiple quarter of PI is under a certain tolerance, it returns the latter.
      * Otherwise the original angle.
@@ -71,4 +90,11 @@ public:
      * @param alt indicates whether snapping mode is altered (via the Alt key)
      */
     [[nodiscard]] Point snap(Point const& pos, Point const& center, bool alt);
+
+    /**
+     * @brief Moves and scales a recognized shape so that the corners of its snapped bounds are on the grid, see
+     * Settings::getSnapRecognizedShapesEnabled()
+     * @param shape the shape, not yet in its layer
+     */
+    void snapShapeToGrid(Stroke* shape);
 };
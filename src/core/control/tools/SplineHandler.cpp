@@ -16,7 +16,7 @@ using xoj::util::Rectangle;
 guint32 SplineHandler::lastStrokeTime;  // persist for next stroke
 
 SplineHandler::SplineHandler(XournalView* xournal, XojPageView* redrawable, const PageRef& page):
-        InputHandler(xournal, redrawable, page), snappingHandler(xournal->getControl()->getSettings()) {}
+        InputHandler(xournal, redrawable, page), snappingHandler(xournal->getControl()->getSettings(), page) {}
 
 SplineHandler::~SplineHandler() = default;
 
@@ -364,8 +364,9 @@ void SplineHandler::updateStroke() {
 
     // convert collection of segments to stroke
     stroke->deletePointsFrom(0);
+    const double tolerance = SplineSegment::toleranceForZoom(xournal->getZoom());
     for (auto s: segments) {
-        for (auto p: s.toPointSequence()) { stroke->addPoint(p); }
+        for (auto p: s.toPointSequence(false, tolerance)) { stroke->addPoint(p); }
     }
     if (!segments.empty()) {
         stroke->addPoint(segments.back().secondKnot);
@@ -0,0 +1,44 @@
+#include "StrokeDecimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @return The square of the distance from the point to the segment
+ */
+static auto squaredDistanceToSegment(const Point& p, const Point& a, const Point& b) -> double {
+    const double dx = b.x - a.x;
+    const double dy = b.y - a.y;
+    const double lengthSqrd = dx * dx + dy * dy;
+    double t = lengthSqrd > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSqrd : 0.0;
+    t = std::clamp(t, 0.0, 1.0);
+    const double ex = a.x + t * dx - p.x;
+    const double ey = a.y + t * dy - p.y;
+    return ex * ex + ey * ey;
+}
+
+StrokeDecimator::StrokeDecimator(double tolerance): tolerance(tolerance) {}
+
+void StrokeDecimator::setTolerance(double tolerance) { this->tolerance = tolerance; }
+
+auto StrokeDecimator::replacesLast(const Point& anchor, const Point& last, const Point& next, double widthDelta)
+        -> bool {
+    // The edges of the stroke move by half the width variation
+    if (this->tolerance <= 0 || std::abs(widthDelta) > 2 * this->tolerance ||
+        this->replaced.size() >= MAX_REPLACED_POINTS) {
+        reset();
+        return false;
+    }
+
+    const double toleranceSqrd = this->tolerance * this->tolerance;
+    auto isClose = [&](const Point& p) { return squaredDistanceToSegment(p, anchor, next) <= toleranceSqrd; };
+    if (!isClose(last) || !std::all_of(this->replaced.begin(), this->replaced.end(), isClose)) {
+        reset();
+        return false;
+    }
+
+    this->replaced.push_back(last);
+    return true;
+}
+
+void StrokeDecimator::reset() { this->replaced.clear(); }
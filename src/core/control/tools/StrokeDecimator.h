@@ -0,0 +1,65 @@
+/*
+ * Xournal++
+ *
+ * Drops the input points which do not change the view of a stroke
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "model/Point.h"
+
+/**
+ * @brief Decides whether the last point of a stroke being drawn can be replaced by the next input point
+ *
+ * The point is replaced when the segment from the point before it (the anchor) to the next point passes within the
+ * tolerance of it, and of all the points it replaced before, and when its width stays within the tolerance of the
+ * width of the segment from the anchor. Runs of samples of a pen held still or moving slowly, or along a straight
+ * line, are then kept as a single segment. As the deviation from the replaced points is bounded, so is the turn the
+ * stroke makes at them: no separate angle threshold is needed.
+ */
+class StrokeDecimator {
+public:
+    /**
+     * @param tolerance The largest distance of a replaced point from the segment drawn instead, in page coordinates.
+     *                  0 keeps all the points.
+     */
+    explicit StrokeDecimator(double tolerance = 0);
+
+    void setTolerance(double tolerance);
+
+    /**
+     * @param anchor The point of the stroke before the last one
+     * @param last The last point of the stroke
+     * @param next The input point
+     * @param widthDelta The difference between the width of the segment which would start at the last point and the
+     *                   one of the segment from the anchor, 0 without pressure
+     * @return true if the last point is to be replaced by the next one, false if the next one is to be added
+     */
+    bool replacesLast(const Point& anchor, const Point& last, const Point& next, double widthDelta);
+
+    /**
+     * A point was added to the stroke: the next ones are measured from it
+     */
+    void reset();
+
+    /**
+     * Bounds the cost of replacesLast(), which measures all the points replaced since the anchor
+     */
+    static constexpr size_t MAX_REPLACED_POINTS = 64;
+
+private:
+    double tolerance;
+
+    /**
+     * The points replaced since the anchor, not including the last point
+     */
+    std::vector<Point> replaced;
+};
@@ -46,7 +46,7 @@ void StrokeHandler::draw(cairo_t* cr) {
 
     if (this->mask) {
         setColorAndBlendMode();
-        cairo_mask_surface(cr, mask->surf, 0, 0);
+        this->mask->paint(cr);
     } else {
         if (this->stroke->getPointCount() == 1) {
             // drawStroke does not handle single dots
@@ -58,6 +58,40 @@ void StrokeHandler::draw(cairo_t* cr) {
             strokeView->draw(xoj::view::Context::createDefault(cr));
         }
     }
+
+    if (this->predictedTip) {
+        // Highlighters would darken where the tip overlaps the stroke
+        if (stroke->getToolType() != STROKE_TOOL_HIGHLIGHTER) {
+            const Point& last = this->stroke->getPoint(this->stroke->getPointCount() - 1);
+            setColorAndBlendMode();
+            cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+            cairo_set_line_width(cr, last.z != Point::NO_PRESSURE ? last.z : this->stroke->getWidth());
+            cairo_move_to(cr, last.x, last.y);
+            cairo_line_to(cr, this->predictedTip->x, this->predictedTip->y);
+            cairo_stroke(cr);
+        }
+    }
+}
+
+void StrokeHandler::setPredictedTip(const std::optional<Point>& tip) {
+    if (!this->predictedTip && !tip) {
+        return;
+    }
+
+    const Point& last = this->stroke->getPoint(this->stroke->getPointCount() - 1);
+    Range rg(last.x, last.y);
+    if (this->predictedTip) {
+        rg.addPoint(this->predictedTip->x, this->predictedTip->y);
+    }
+    if (tip) {
+        rg.addPoint(tip->x, tip->y);
+    }
+    this->predictedTip = tip;
+
+    // The previous tip is erased, the new one drawn
+    const double width = last.z != Point::NO_PRESSURE ? last.z : this->stroke->getWidth();
+    this->redrawable->repaintRect(rg.getX() - 0.5 * width, rg.getY() - 0.5 * width, rg.getWidth() + width,
+                                  rg.getHeight() + width);
 }
 
 auto StrokeHandler::onKeyEvent(GdkEventKey* event) -> bool { return false; }
@@ -96,13 +130,22 @@ void StrokeHandler::paintTo(const Point& point) {
 
                 double width = this->stroke->getWidth() * point.z;
                 if (mask) {
-                    this->paintDot(mask->cr, endPoint.x, endPoint.y, width);
+                    this->paintDotToMask(endPoint.x, endPoint.y, width);
                 }
                 // Trigger a call to `draw`. If mask == nullopt, the `paintDot` is called in `draw`
                 this->redrawable->repaintRect(endPoint.x - 0.5 * width, endPoint.y - 0.5 * width, width, width);
             }
             return;
         }
+        if (pointCount >= 2 && !this->firstPointPressureChange) {
+            // anchor.z is the width of the segment from it, point.z a pressure not multiplied by the width yet
+            const Point& anchor = stroke->getPoint(pointCount - 2);
+            const double widthDelta = this->hasPressure ? point.z * stroke->getWidth() - anchor.z : 0.0;
+            if (this->decimator.replacesLast(anchor, endPoint, point, widthDelta)) {
+                replaceLastPoint(point);
+                return;
+            }
+        }
         if (this->hasPressure) {
             /**
              * Both device and tool are pressure sensitive
@@ -142,13 +185,32 @@ void StrokeHandler::paintTo(const Point& point) {
 }
 
 void StrokeHandler::drawSegmentTo(const Point& point) {
-
+    if (const int count = stroke->getPointCount(); count >= 2) {
+        this->dashOffset += stroke->getPoint(count - 2).lineLengthTo(stroke->getPoint(count - 1));
+    }
     stroke->addPoint(this->hasPressure ? point : Point(point.x, point.y));
+    this->decimator.reset();
+    drawLastSegment();
+}
+
+void StrokeHandler::replaceLastPoint(const Point& point) {
+    stroke->setLastPoint(this->hasPressure ? point : Point(point.x, point.y));
+    if (this->recognizerInertia) {
+        this->recognizerInertia->truncate(static_cast<size_t>(stroke->getPointCount() - 1));
+    }
+    drawLastSegment();
+}
+
+void StrokeHandler::drawLastSegment() {
+    if (this->recognizerInertia) {
+        this->recognizerInertia->update(stroke->getPointVector());
+    }
 
     double width = stroke->getWidth();
 
     assert(stroke->getPointCount() >= 2);
     const Point& prevPoint(stroke->getPoint(stroke->getPointCount() - 2));
+    const Point& point(stroke->getPoint(stroke->getPointCount() - 1));
 
     Range rg(prevPoint.x, prevPoint.y);
     rg.addPoint(point.x, point.y);
@@ -161,15 +223,35 @@ void StrokeHandler::drawSegmentTo(const Point& point) {
         const Point& firstPoint = stroke->getPointVector().front();
         rg.addPoint(firstPoint.x, firstPoint.y);
     } else if (mask) {
-        Stroke lastSegment;
+        // Only the tiles of the mask around the segment are touched
+        const double segmentWidth = prevPoint.z != Point::NO_PRESSURE ? prevPoint.z : width;
+        Rectangle<double> area(rg.getX() - 0.5 * segmentWidth, rg.getY() - 0.5 * segmentWidth,
+                               rg.getWidth() + segmentWidth, rg.getHeight() + segmentWidth);
+
+        const double* dashes = nullptr;
+        int dashCount = 0;
+        if (stroke->getLineStyle().getDashes(dashes, dashCount)) {
+            // The dashes of the segment go on from the ones of the stroke so far
+            this->mask->draw(area, [&](cairo_t* cr) {
+                cairo_set_source_rgba(cr, 1, 1, 1, 1);
+                cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+                cairo_set_line_cap(cr, xoj::view::StrokeView::CAIRO_LINE_CAP[stroke->getStrokeCapStyle()]);
+                cairo_set_line_width(cr, segmentWidth);
+                cairo_set_dash(cr, dashes, dashCount, this->dashOffset);
+                cairo_move_to(cr, prevPoint.x, prevPoint.y);
+                cairo_line_to(cr, point.x, point.y);
+                cairo_stroke(cr);
+            });
+        } else {
+            Stroke lastSegment;
 
-        lastSegment.addPoint(prevPoint);
-        lastSegment.addPoint(point);
-        lastSegment.setWidth(width);
+            lastSegment.addPoint(prevPoint);
+            lastSegment.addPoint(point);
+            lastSegment.setWidth(width);
 
-        auto context = xoj::view::Context::createColorBlind(mask->cr);
-        xoj::view::StrokeView sView(&lastSegment);
-        sView.draw(context);
+            xoj::view::StrokeView sView(&lastSegment);
+            this->mask->draw(area, [&sView](cairo_t* cr) { sView.draw(xoj::view::Context::createColorBlind(cr)); });
+        }
     }
 
     width = prevPoint.z != Point::NO_PRESSURE ? prevPoint.z : width;
@@ -182,6 +264,8 @@ void StrokeHandler::drawSegmentTo(const Point& point) {
 void StrokeHandler::onMotionCancelEvent() {
     delete stroke;
     stroke = nullptr;
+    predictedTip.reset();
+    recognizerInertia.reset();
 }
 
 void StrokeHandler::onButtonReleaseEvent(const PositionInputData& pos) {
@@ -194,7 +278,8 @@ void StrokeHandler::onButtonReleaseEvent(const PositionInputData& pos) {
      * Fill this gap.
      */
     stabilizer->finalizeStroke();
-
+    // The tip must not be drawn into the page with the stroke
+    setPredictedTip(std::nullopt);
 
     Control* control = xournal->getControl();
     Settings* settings = control->getSettings();
@@ -261,7 +346,11 @@ void StrokeHandler::onButtonReleaseEvent(const PositionInputData& pos) {
     if (h->getDrawingType() == DRAWING_TYPE_STROKE_RECOGNIZER) {
         ShapeRecognizer reco;
 
-        Stroke* recognized = reco.recognizePatterns(stroke);
+        if (!this->recognizerInertia) {
+            this->recognizerInertia.emplace();
+        }
+        Stroke* recognized = reco.recognizePatterns(stroke, *this->recognizerInertia);
+        this->recognizerInertia.reset();
 
         if (recognized) {
             strokeRecognizerDetected(recognized, layer);
@@ -291,22 +380,7 @@ void StrokeHandler::strokeRecognizerDetected(Stroke* recognized, Layer* layer) {
     // snapping
     Stroke* snappedStroke = recognized->cloneStroke();
     if (xournal->getControl()->getSettings()->getSnapRecognizedShapesEnabled()) {
-        Rectangle<double> oldSnappedBounds = recognized->getSnappedBounds();
-        Point topLeft = Point(oldSnappedBounds.x, oldSnappedBounds.y);
-        Point topLeftSnapped = snappingHandler.snapToGrid(topLeft, false);
-
-        snappedStroke->move(topLeftSnapped.x - topLeft.x, topLeftSnapped.y - topLeft.y);
-        Rectangle<double> snappedBounds = snappedStroke->getSnappedBounds();
-        Point belowRight = Point(snappedBounds.x + snappedBounds.width, snappedBounds.y + snappedBounds.height);
-        Point belowRightSnapped = snappingHandler.snapToGrid(belowRight, false);
-
-        double fx = (std::abs(snappedBounds.width) > DBL_EPSILON) ?
-                            (belowRightSnapped.x - topLeftSnapped.x) / snappedBounds.width :
-                            1;
-        double fy = (std::abs(snappedBounds.height) > DBL_EPSILON) ?
-                            (belowRightSnapped.y - topLeftSnapped.y) / snappedBounds.height :
-                            1;
-        snappedStroke->scale(topLeftSnapped.x, topLeftSnapped.y, fx, fy, 0, false);
+        snappingHandler.snapShapeToGrid(snappedStroke);
     }
 
     auto recognizerUndo = std::make_unique<RecognizerUndoAction>(page, layer, stroke, snappedStroke);
@@ -336,16 +410,27 @@ void StrokeHandler::onButtonPressEvent(const PositionInputData& pos) {
 
         this->hasPressure = this->stroke->getToolType() == STROKE_TOOL_PEN && pos.pressure != Point::NO_PRESSURE;
 
+        if (xournal->getControl()->getToolHandler()->getDrawingType() == DRAWING_TYPE_STROKE_RECOGNIZER) {
+            this->recognizerInertia.emplace();
+            this->recognizerInertia->update(this->stroke->getPointVector());
+        } else {
+            this->recognizerInertia.reset();
+        }
+
         stabilizer->initialize(this, zoom, pos);
+
+        this->dashOffset = 0;
+        this->decimator.reset();
+        this->decimator.setTolerance(xournal->getControl()->getSettings()->getStrokeDecimationTolerance() / zoom);
     }
 
     double width = this->hasPressure ? this->stroke->getWidth() * pos.pressure : this->stroke->getWidth();
 
-    bool needAMask = this->stroke->getFill() == -1 && !stroke->getLineStyle().hasDashes();
+    bool needAMask = this->stroke->getFill() == -1;
     if (needAMask) {
         // Strokes that require a full redraw don't use a mask
         this->createMask();
-        this->paintDot(mask->cr, this->buttonDownPoint.x, this->buttonDownPoint.y, width);
+        this->paintDotToMask(this->buttonDownPoint.x, this->buttonDownPoint.y, width);
     } else {
         strokeView.emplace(stroke);
     }
@@ -367,31 +452,13 @@ void StrokeHandler::paintDot(cairo_t* cr, const double x, const double y, const
     cairo_stroke(cr);
 }
 
-StrokeHandler::Mask::Mask(int width, int height) {
-    surf = cairo_image_surface_create(CAIRO_FORMAT_A8, width, height);
-    cr = cairo_create(surf);
-    cairo_set_source_rgba(cr, 1, 1, 1, 1);
-    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
-}
-
-StrokeHandler::Mask::~Mask() noexcept {
-    cairo_destroy(cr);
-    cairo_surface_destroy(surf);
+void StrokeHandler::paintDotToMask(const double x, const double y, const double width) {
+    Rectangle<double> area(x - 0.5 * width, y - 0.5 * width, width, width);
+    this->mask->draw(area, [&](cairo_t* cr) { this->paintDot(cr, x, y, width); });
 }
 
 void StrokeHandler::createMask() {
-    const double ratio = xournal->getZoom() * static_cast<double>(xournal->getDpiScaleFactor());
-
-    std::unique_ptr<Rectangle<double>> visibleRect(xournal->getVisibleRect(redrawable));
-
-    // We add a padding to limit graphical bugs when scrolling right after completing a stroke
-    const double strokeWidth = this->stroke->getWidth();
-    const int width = static_cast<int>(std::ceil((visibleRect->width + strokeWidth) * ratio));
-    const int height = static_cast<int>(std::ceil((visibleRect->height + strokeWidth) * ratio));
-
-    mask.emplace(width, height);
-
-    cairo_surface_set_device_offset(mask->surf, (0.5 * strokeWidth - visibleRect->x) * ratio,
-                                    (0.5 * strokeWidth - visibleRect->y) * ratio);
-    cairo_surface_set_device_scale(mask->surf, ratio, ratio);
+    // The tiles are allocated while the stroke goes: nothing to clear over the whole visible area when the pen is
+    // pressed, and scrolling does not leave parts of the stroke out of the mask
+    mask.emplace(xournal->getZoom() * static_cast<double>(xournal->getDpiScaleFactor()));
 }
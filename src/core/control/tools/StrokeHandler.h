@@ -11,10 +11,15 @@
 
 #pragma once
 
+#include <optional>
+
+#include "control/shaperecognizer/RunningInertia.h"
+#include "gui/TiledMask.h"
 #include "view/View.h"
 
 #include "InputHandler.h"
 #include "SnapToGridInputHandler.h"
+#include "StrokeDecimator.h"
 
 namespace StrokeStabilizer {
 class Base;
@@ -24,10 +29,10 @@ class Active;
 /**
  * @brief The stroke handler draws a stroke on a XojPageView
  *
- * The stroke is drawn using a cairo_surface_t* as a mask:
+ * The stroke is drawn using a TiledMask:
  * As the pointer moves on the canvas single segments are
- * drawn opaquely on the initially transparent masking
- * surface. The surface is used to mask the stroke
+ * drawn opaquely on the initially transparent tiles of the
+ * mask around them. The mask is used to mask the stroke
  * when drawing it to the XojPageView
  */
 class StrokeHandler: public InputHandler {
@@ -56,6 +61,12 @@ public:
      */
     void paintDot(cairo_t* cr, const double x, const double y, const double width) const;
 
+    /**
+     * @brief Set the provisional end of the stroke, drawn from its last point but never added to it
+     * @param tip The predicted position of the pointer, or std::nullopt to remove the previous one
+     */
+    void setPredictedTip(const std::optional<Point>& tip);
+
 protected:
     /**
      * @brief Unconditionally add a segment to the stroke.
@@ -64,6 +75,17 @@ protected:
      */
     void drawSegmentTo(const Point& point);
 
+    /**
+     * @brief Move the last point of the stroke, see StrokeDecimator
+     * @param point The new endpoint of the last segment
+     */
+    void replaceLastPoint(const Point& point);
+
+    /**
+     * @brief Draw the last segment of the stroke, once its endpoint was added or moved
+     */
+    void drawLastSegment();
+
     void strokeRecognizerDetected(Stroke* recognized, Layer* layer);
 
 protected:
@@ -77,37 +99,38 @@ private:
      * For those strokes, whenever a new input event is received, the new segment is simply added to the mask.
      * The mask is then blitted upon a call to `draw`.
      *
-     * A stroke requires a full redraw if
-     *      * it has a filling (the filling can not be computed simply from just the last segment)
-     *      * or it has dashes (to get the dash offset right)
-     *
-     * Nb: the dashed exception could be avoided if we recorded the dash offset (= the stroke's length so far)
+     * A stroke requires a full redraw if it has a filling (the filling can not be computed simply from just the last
+     * segment). The dashes of the last segment start at dashOffset.
      */
     void createMask();
 
-    // Helper class to safely handle cairo surface and context
-    class Mask {
-    public:
-        Mask() = delete;
-        Mask(const Mask&) = delete;
-        Mask(Mask&&) = delete;
-        Mask& operator=(const Mask&) = delete;
-        Mask& operator=(Mask&&) = delete;
-
-        Mask(int width, int height);
-        ~Mask() noexcept;
-
-        /**
-         * The masking surface
-         */
-        cairo_surface_t* surf = nullptr;
-
-        /**
-         * And the corresponding cairo_t*
-         */
-        cairo_t* cr = nullptr;
-    };
-    std::optional<Mask> mask;
+    /**
+     * @brief Paints a single dot on the mask
+     */
+    void paintDotToMask(const double x, const double y, const double width);
+
+    std::optional<TiledMask> mask;
+
+    /**
+     * The length of the stroke up to the first point of its last segment: the offset of the dashes of that segment
+     */
+    double dashOffset = 0;
+
+    /**
+     * See setPredictedTip()
+     */
+    std::optional<Point> predictedTip;
+
+    /**
+     * The moments of the stroke for the shape recognizer, updated with each segment if the recognizer is enabled, so
+     * that the recognition does not sum over all the points once the stroke ends
+     */
+    std::optional<RunningInertia> recognizerInertia;
+
+    /**
+     * Drops the input points which would not change the view of the stroke, with a tolerance scaled by the zoom
+     */
+    StrokeDecimator decimator;
 
     // to filter out short strokes (usually the user tapping on the page to select it)
     guint32 startStrokeTime{};
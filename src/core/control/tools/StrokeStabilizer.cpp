@@ -1,5 +1,6 @@
 #include "StrokeStabilizer.h"
 
+#include <cmath>
 #include <numeric>
 
 #include "control/settings/Settings.h"
@@ -58,6 +59,10 @@ auto StrokeStabilizer::get(Settings* settings) -> std::unique_ptr<StrokeStabiliz
                 settings->getStabilizerFinalizeStroke(), settings->getStabilizerDrag(), settings->getStabilizerMass());
     }
 
+    if (auto predictionTime = settings->getStabilizerPredictionTime(); predictionTime > 0) {
+        return std::make_unique<StrokeStabilizer::Prediction>(predictionTime);
+    }
+
     /**
      * Defaults to no stabilization
      */
@@ -137,7 +142,7 @@ void StrokeStabilizer::Active::quadraticSplineTo(const Event& ev) {
     /**
      * TODO Add support for spline segments in Stroke and replace this point sequence by a single spline segment
      */
-    std::list<Point> pointsToPaint = spline.toPointSequence(usePressure);
+    std::list<Point> pointsToPaint = spline.toPointSequence(usePressure, SplineSegment::toleranceForZoom(zoom));
 
     pointsToPaint.pop_front();  // Point B has already been painted
 
@@ -273,42 +278,56 @@ void StrokeStabilizer::Inertia::rebalanceStrokePressures() {
 }
 
 
+/**
+ * StrokeStabilizer::ArithmeticMean
+ */
+void StrokeStabilizer::ArithmeticMean::assign(const Event& ev) {
+    buffer.assign(ev);
+    double n = static_cast<double>(buffer.size());
+    sum = Event(n * ev.x, n * ev.y, n * ev.pressure);
+    pushesSinceSum = 0;
+}
+
+auto StrokeStabilizer::ArithmeticMean::push(const Event& ev) -> Event {
+    Event replaced = buffer.back();
+    buffer.push_front(ev);
+
+    if (++pushesSinceSum < buffer.size()) {
+        sum.x += ev.x - replaced.x;
+        sum.y += ev.y - replaced.y;
+        sum.pressure += ev.pressure - replaced.pressure;
+    } else {
+        sum = std::accumulate(buffer.begin(), buffer.end(), Event(0, 0, 0), [](auto&& lhs, auto&& rhs) {
+            return Event(lhs.x + rhs.x, lhs.y + rhs.y, lhs.pressure + rhs.pressure);
+        });
+        pushesSinceSum = 0;
+    }
+
+    double d = static_cast<double>(buffer.size());
+    return Event(sum.x / d, sum.y / d, sum.pressure / d);
+}
+
 /**
  * StrokeStabilizer::Arithmetic
  */
 void StrokeStabilizer::Arithmetic::recordFirstEvent(const PositionInputData& pos) {
-    eventBuffer.assign(Event(pos));  // Fill the buffer with copies of Event(pos)
+    mean.assign(Event(pos));  // Fill the buffer with copies of Event(pos)
 }
 
 void StrokeStabilizer::Arithmetic::averageAndPaint(const Event& ev, guint32 timestamp) {
     /**
      * Push the event and overwrite the oldest event in the buffer
      */
-    eventBuffer.push_front(ev);
-
-    /**
-     * Average the coordinates using an arithmetic mean
-     */
-    Event sum = std::accumulate(begin(eventBuffer), end(eventBuffer), Event(0, 0, 0), [](auto&& lhs, auto&& rhs) {
-        return Event(lhs.x + rhs.x, lhs.y + rhs.y, lhs.pressure + rhs.pressure);
-    });
-
-    /**
-     * Rescale the averaged coordinates and draw
-     */
-    double d = static_cast<double>(eventBuffer.size());
-    sum.pressure /= d;
-    sum.x /= d;
-    sum.y /= d;
-    setLastPaintedEvent(sum);
-    drawEvent(sum);
+    Event average = mean.push(ev);
+    setLastPaintedEvent(average);
+    drawEvent(average);
 }
 
-auto StrokeStabilizer::Arithmetic::getLastEvent() -> Event { return eventBuffer.front(); }
+auto StrokeStabilizer::Arithmetic::getLastEvent() -> Event { return mean.newest(); }
 
 void StrokeStabilizer::Arithmetic::resetBuffer(Event& ev, guint32 timestamp) {
-    if (eventBuffer.back() != ev) {
-        eventBuffer.assign(ev);  // Replace the entire content of the buffer with copies of ev
+    if (mean.oldest() != ev) {
+        mean.assign(ev);  // Replace the entire content of the buffer with copies of ev
     }
 }
 
@@ -340,37 +359,53 @@ void StrokeStabilizer::VelocityGaussian::averageAndPaint(const Event& ev, guint3
     }
     lastEventTimestamp = timestamp;
 
+    auto [average, kept] = VelocityGaussian::average(eventBuffer, twoSigmaSquared, weights);
+    eventBuffer.resize(kept);
+
+    setLastPaintedEvent(average);
+    drawEvent(average);
+}
+
+auto StrokeStabilizer::VelocityGaussian::average(const std::deque<VelocityEvent>& events, double twoSigmaSquared,
+                                                 std::vector<double>& weights) -> std::pair<Event, size_t> {
     /**
-     * Average the coordinates using the gimp-like weights
+     * exp(-v² / 2σ²) < MIN_WEIGHT if and only if v² > 2σ² * log(1 / MIN_WEIGHT)
      */
-    Event weightedSum = {0, 0, 0};
-    double weight;
-    double sumOfWeights = 0;
-    double sumOfVelocities = 0;
+    const double maxSquaredVelocity = twoSigmaSquared * std::log(1 / MIN_WEIGHT);
 
-    auto it = eventBuffer.cbegin();
-    for (; it != eventBuffer.cend(); ++it) {
-        /**
-         * The first weight is always 1
-         */
-        weight = exp(-sumOfVelocities * sumOfVelocities / twoSigmaSquared);
-        if (weight < 0.01) {
+    /**
+     * The exponents. The first weight is always 1
+     */
+    weights.clear();
+    double sumOfVelocities = 0;
+    for (const VelocityEvent& e: events) {
+        double squaredVelocity = sumOfVelocities * sumOfVelocities;
+        if (squaredVelocity > maxSquaredVelocity) {
             break;
         }
-        sumOfVelocities += (*it).velocity;
-        weightedSum.x += weight * (*it).x;
-        weightedSum.y += weight * (*it).y;
-        weightedSum.pressure += weight * (*it).pressure;
-        sumOfWeights += weight;
+        weights.push_back(-squaredVelocity / twoSigmaSquared);
+        sumOfVelocities += e.velocity;
     }
-    eventBuffer.erase(it, eventBuffer.cend());
 
-    weightedSum.x /= sumOfWeights;
-    weightedSum.y /= sumOfWeights;
-    weightedSum.pressure /= sumOfWeights;
+    const size_t n = weights.size();
+    double* w = weights.data();
+    for (size_t i = 0; i < n; i++) { w[i] = std::exp(w[i]); }
 
-    setLastPaintedEvent(weightedSum);
-    drawEvent(weightedSum);
+    Event weightedSum = {0, 0, 0};
+    double sumOfWeights = 0;
+    for (size_t i = 0; i < n; i++) {
+        const VelocityEvent& e = events[i];
+        weightedSum.x += w[i] * e.x;
+        weightedSum.y += w[i] * e.y;
+        weightedSum.pressure += w[i] * e.pressure;
+        sumOfWeights += w[i];
+    }
+
+    if (n == 0) {
+        return {weightedSum, 0};
+    }
+    return {Event(weightedSum.x / sumOfWeights, weightedSum.y / sumOfWeights, weightedSum.pressure / sumOfWeights),
+            n};
 }
 
 auto StrokeStabilizer::VelocityGaussian::getLastEvent() -> Event {
@@ -388,3 +423,74 @@ void StrokeStabilizer::VelocityGaussian::resetBuffer(Event& ev, guint32 timestam
         eventBuffer.emplace_front(ev);
     }
 }
+
+/**
+ * StrokeStabilizer::Prediction
+ */
+void StrokeStabilizer::Prediction::recordFirstEvent(const PositionInputData& pos) {
+    samples.clear();
+    samples.push_back({pos.x, pos.y, pos.timestamp});
+}
+
+void StrokeStabilizer::Prediction::processEvent(const PositionInputData& pos) {
+    strokeHandler->paintTo(Point(pos.x / zoom, pos.y / zoom, pos.pressure));
+
+    if (!samples.empty() && samples.back().timestamp == pos.timestamp) {
+        // Several events in the same millisecond: only the last one gives the velocity
+        samples.back() = {pos.x, pos.y, pos.timestamp};
+    } else {
+        samples.push_back({pos.x, pos.y, pos.timestamp});
+        if (samples.size() > 3) {
+            samples.pop_front();
+        }
+    }
+
+    MathVect displacement = extrapolate(samples, predictionTime);
+    if (displacement.dx == 0 && displacement.dy == 0) {
+        strokeHandler->setPredictedTip(std::nullopt);
+        return;
+    }
+    strokeHandler->setPredictedTip(
+            Point((pos.x + displacement.dx) / zoom, (pos.y + displacement.dy) / zoom, pos.pressure));
+}
+
+auto StrokeStabilizer::Prediction::extrapolate(const std::deque<Sample>& samples, double time) -> MathVect {
+    const size_t n = samples.size();
+    if (n < 2) {
+        return {};
+    }
+
+    const Sample& last = samples[n - 1];
+    const Sample& previous = samples[n - 2];
+    const double dt = last.timestamp - previous.timestamp;
+    if (dt <= 0 || dt > MAX_EVENT_INTERVAL) {
+        return {};
+    }
+    MathVect velocity{(last.x - previous.x) / dt, (last.y - previous.y) / dt};
+
+    MathVect acceleration{};
+    if (n >= 3) {
+        const Sample& first = samples[n - 3];
+        const double dt0 = previous.timestamp - first.timestamp;
+        if (dt0 > 0 && dt0 <= MAX_EVENT_INTERVAL) {
+            MathVect previousVelocity{(previous.x - first.x) / dt0, (previous.y - first.y) / dt0};
+            const double interval = 0.5 * (dt + dt0);
+            acceleration = {(velocity.dx - previousVelocity.dx) / interval,
+                            (velocity.dy - previousVelocity.dy) / interval};
+        }
+    }
+
+    MathVect displacement{velocity.dx * time + 0.5 * acceleration.dx * time * time,
+                          velocity.dy * time + 0.5 * acceleration.dy * time * time};
+    if (MathVect::scalarProduct(displacement, velocity) <= 0) {
+        // The pointer stops or turns back: a wrong guess would be very visible
+        return {};
+    }
+
+    const double distance = displacement.norm();
+    if (distance > MAX_PREDICTION_DISTANCE) {
+        displacement.dx *= MAX_PREDICTION_DISTANCE / distance;
+        displacement.dy *= MAX_PREDICTION_DISTANCE / distance;
+    }
+    return displacement;
+}
@@ -14,6 +14,9 @@
 #include <cmath>
 #include <deque>
 #include <functional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "control/tools/StrokeHandler.h"
 #include "util/CircularBuffer.h"
@@ -49,6 +52,40 @@ struct Event {
     double pressure{};
 };
 
+/**
+ * @brief The arithmetic mean of the last events, updated in constant time per event
+ *
+ * The sum of the events in the buffer is kept up to date by adding the new event and subtracting the one it replaces.
+ * It is recomputed from scratch once per length of the buffer, so that the rounding errors do not pile up.
+ */
+class ArithmeticMean {
+public:
+    explicit ArithmeticMean(size_t length): buffer(length) {}
+
+    /**
+     * @brief Replace the entire content of the buffer with copies of ev
+     */
+    void assign(const Event& ev);
+
+    /**
+     * @brief Push the event, overwriting the oldest event in the buffer
+     * @return The mean of the events in the buffer
+     */
+    Event push(const Event& ev);
+
+    inline Event newest() { return buffer.front(); }
+    inline Event oldest() { return buffer.back(); }
+
+private:
+    CircularBuffer<Event> buffer;
+    Event sum;
+
+    /**
+     * @brief The number of pushes since the sum was computed from scratch
+     */
+    size_t pushesSinceSum = 0;
+};
+
 /**
  * @brief Base stabilizer class. Also used as default (no stabilization).
  */
@@ -368,6 +405,33 @@ public:
                std::to_string(twoSigmaSquared);
     }
 
+    /**
+     * @brief Structure containing the event's information relevant to the VelocityGaussian stabilizer
+     */
+    struct VelocityEvent: public Event {
+        VelocityEvent() = default;
+        VelocityEvent(double x, double y, double pressure, double velocity):
+                Event(x, y, pressure), velocity(velocity) {}
+        VelocityEvent(const PositionInputData& pos, double velocity = 0): Event(pos), velocity(velocity) {}
+        VelocityEvent(const Event& ev, double velocity = 0): Event(ev), velocity(velocity) {}
+        double velocity{};
+    };
+
+    /**
+     * @brief Average the events using the gimp-like weights exp(-v² / 2σ²), where v is the sum of the velocities of
+     * the more recent events
+     * @param events The events, the most recent first
+     * @param weights Scratch space for the weights, kept by the caller to avoid an allocation per event
+     * @return The average and the number of events whose weight is at least MIN_WEIGHT. The other ones can be dropped.
+     *
+     * The cut is found from the velocities alone, so only the weights of the events kept are computed. They are
+     * computed in one pass over a contiguous array, which the compiler can vectorize.
+     */
+    static std::pair<Event, size_t> average(const std::deque<VelocityEvent>& events, double twoSigmaSquared,
+                                            std::vector<double>& weights);
+
+    static constexpr double MIN_WEIGHT = 0.01;
+
 protected:
     /**
      * @brief Upon initialization, record the first event for the stabilizer's benefits.
@@ -389,18 +453,6 @@ protected:
      */
     void resetBuffer(Event& ev, guint32 timestamp) override;
 
-    /**
-     * @brief Structure containing the event's information relevant to the VelocityGaussian stabilizer
-     */
-    struct VelocityEvent: public Event {
-        VelocityEvent() = default;
-        VelocityEvent(double x, double y, double pressure, double velocity):
-                Event(x, y, pressure), velocity(velocity) {}
-        VelocityEvent(const PositionInputData& pos, double velocity = 0): Event(pos), velocity(velocity) {}
-        VelocityEvent(const Event& ev, double velocity = 0): Event(ev), velocity(velocity) {}
-        double velocity{};
-    };
-
     /**
      * @brief A queue containing the relevant information on the last events
      * The beginning of the queue contains the most recent event
@@ -420,6 +472,11 @@ private:
      */
     const double twoSigmaSquared;
 
+    /**
+     * @brief The weights of the last average, see average()
+     */
+    std::vector<double> weights;
+
     /**
      * @brief Timestamp of the last event received. Used to compute the velocity of the next event
      */
@@ -428,7 +485,7 @@ private:
 
 class Arithmetic: virtual public Active {
 public:
-    Arithmetic(bool finalize, size_t buffersize): Active(finalize), bufferLength(buffersize), eventBuffer(buffersize) {}
+    Arithmetic(bool finalize, size_t buffersize): Active(finalize), bufferLength(buffersize), mean(buffersize) {}
     ~Arithmetic() override = default;
 
     [[maybe_unused]] auto getInfo() -> std::string override {
@@ -462,11 +519,9 @@ protected:
     const size_t bufferLength;
 
     /**
-     * @brief A circular buffer containing the relevant information on the last events
-     * The front of the buffer contains the most recent event
-     * The back of the buffer contains the most ancient event stored
+     * @brief The last events and their mean
      */
-    CircularBuffer<Event> eventBuffer;
+    ArithmeticMean mean;
 
 private:
     /**
@@ -585,6 +640,65 @@ private:
     inline Event getLastEvent() override { return Inertia::getLastEvent(); }
 };
 
+/**
+ * @brief No stabilization, but the tip of the stroke is extrapolated ahead of the last event to hide the latency
+ * between the input device and the screen.
+ *
+ * The velocity and the acceleration of the pointer are estimated from the timestamps of the last three events. The
+ * predicted tip is only drawn (see StrokeHandler::setPredictedTip()): it is replaced at each event and never added
+ * to the stroke. Stabilizers lag behind the pointer on purpose, so the prediction is only used without them.
+ */
+class Prediction: public Base {
+public:
+    /**
+     * @param predictionTime How far ahead of the last event the tip is predicted, in ms
+     */
+    Prediction(double predictionTime): predictionTime(predictionTime) {}
+    ~Prediction() override = default;
+
+    void processEvent(const PositionInputData& pos) override;
+
+    [[maybe_unused]] auto getInfo() -> std::string override {
+        return "Prediction of " + std::to_string(static_cast<int>(predictionTime)) + " ms";
+    }
+
+    struct Sample {
+        double x{};
+        double y{};
+        guint32 timestamp{};
+    };
+
+    /**
+     * @brief Extrapolate the motion of the pointer
+     * @param samples The last events, the most recent last, with strictly increasing timestamps
+     * @param time How far ahead of the last sample, in ms
+     * @return The displacement from the last sample, in the coordinates of the samples. (0, 0) if the pointer is
+     * not moving or turning back.
+     */
+    static MathVect extrapolate(const std::deque<Sample>& samples, double time);
+
+    /**
+     * The predicted tip is never further than this from the last event, in screen pixels
+     */
+    static constexpr double MAX_PREDICTION_DISTANCE = 32;
+
+    /**
+     * Above this time between two events, in ms, the pointer is considered as stopped
+     */
+    static constexpr guint32 MAX_EVENT_INTERVAL = 50;
+
+protected:
+    void recordFirstEvent(const PositionInputData& pos) override;
+
+private:
+    const double predictionTime;
+
+    /**
+     * The last three events
+     */
+    std::deque<Sample> samples;
+};
+
 /**
  * @brief Stabilizer factory: create a stabilizer of the right kind
  * @param settings The Settings instance to read to determine what kind of stabilizer to create
@@ -44,7 +44,7 @@ void VerticalToolHandler::adoptElements(const Side side) {
     this->spacingSide = side;
 
     // Return current elements back to page
-    for (Element* e: this->elements) { this->layer->addElement(e); }
+    this->layer->addElements(this->elements);
     this->elements.clear();
 
     // Add new elements based on position
@@ -55,7 +55,7 @@ void VerticalToolHandler::adoptElements(const Side side) {
         }
     }
 
-    for (Element* e: this->elements) { this->layer->removeElement(e, false); }
+    this->layer->removeElements(this->elements);
 
     if (this->crBuffer) {
         redrawBuffer();
@@ -161,11 +161,8 @@ auto VerticalToolHandler::finalize() -> std::unique_ptr<MoveUndoAction> {
     auto undo =
             std::make_unique<MoveUndoAction>(this->layer, this->page, &this->elements, 0, dY, this->layer, this->page);
 
-    for (Element* e: this->elements) {
-        e->move(0, dY);
-
-        this->layer->addElement(e);
-    }
+    for (Element* e: this->elements) { e->move(0, dY); }
+    this->layer->addElements(this->elements);
 
     view->rerenderPage();
 
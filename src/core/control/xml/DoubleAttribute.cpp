@@ -8,7 +8,6 @@ DoubleAttribute::~DoubleAttribute() = default;
 
 void DoubleAttribute::writeOut(OutputStream* out) {
     char str[G_ASCII_DTOSTR_BUF_SIZE];
-    // g_ascii_ version uses C locale always.
-    g_ascii_formatd(str, G_ASCII_DTOSTR_BUF_SIZE, Util::PRECISION_FORMAT_STRING, value);
-    out->write(str);
+    char* end = Util::formatCoordinate(str, value);
+    out->write(str, static_cast<int>(end - str));
 }
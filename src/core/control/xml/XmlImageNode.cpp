@@ -1,5 +1,10 @@
 #include "XmlImageNode.h"
 
+#include <string_view>
+#include <utility>
+
+#include "model/ImageStore.h"
+
 XmlImageNode::XmlImageNode(const char* tag): XmlNode(tag) {
     this->img = nullptr;
     this->out = nullptr;
@@ -19,6 +24,16 @@ void XmlImageNode::setImage(cairo_surface_t* img) {
     this->img = cairo_surface_reference(img);
 }
 
+void XmlImageNode::setImage(std::shared_ptr<const ImageData> data) {
+    gchar* name = data && data->getFormat() ? gdk_pixbuf_format_get_name(data->getFormat()) : nullptr;
+    if (name && std::string_view(name) == "png") {
+        this->data = std::move(data);
+    } else if (data) {
+        setImage(data->getSurface());
+    }
+    g_free(name);
+}
+
 auto XmlImageNode::pngWriteFunction(XmlImageNode* image, const unsigned char* data, unsigned int length)
         -> cairo_status_t {
     for (unsigned int i = 0; i < length; i++, image->pos++) {
@@ -41,7 +56,17 @@ void XmlImageNode::writeOut(OutputStream* out) {
 
     out->write(">");
 
-    if (this->img == nullptr) {
+    if (this->data) {
+        this->out = out;
+        this->pos = 0;
+        pngWriteFunction(this, reinterpret_cast<const unsigned char*>(this->data->getData().data()),
+                         static_cast<unsigned int>(this->data->getData().size()));
+        gchar* base64_str = g_base64_encode(this->buffer, this->pos);
+        out->write(base64_str);
+        g_free(base64_str);
+
+        this->out = nullptr;
+    } else if (this->img == nullptr) {
         g_error("XmlImageNode::writeOut(); this->img == nullptr");
     } else {
         this->out = out;
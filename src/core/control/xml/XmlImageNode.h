@@ -11,8 +11,12 @@
 
 #pragma once
 
+#include <memory>
+
 #include "XmlNode.h"
 
+class ImageData;
+
 class XmlImageNode: public XmlNode {
 public:
     XmlImageNode(const char* tag);
@@ -21,12 +25,19 @@ public:
 public:
     void setImage(cairo_surface_t* img);
 
+    /**
+     * Write the data of the image as it is if it is a PNG image, read by all the versions. Other images are decoded and
+     * written as PNG.
+     */
+    void setImage(std::shared_ptr<const ImageData> data);
+
     static cairo_status_t pngWriteFunction(XmlImageNode* image, const unsigned char* data, unsigned int length);
 
     void writeOut(OutputStream* out) override;
 
 private:
     cairo_surface_t* img;
+    std::shared_ptr<const ImageData> data;
 
     OutputStream* out;
     int pos;
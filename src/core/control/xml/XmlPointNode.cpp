@@ -1,10 +1,60 @@
 #include "XmlPointNode.h"
 
+#include <algorithm>
+#include <string>
+
+#include "control/xojfile/StrokeEncoding.h"
 #include "util/Util.h"
 
+#include "Attribute.h"
+
+namespace {
+/**
+ * Size of the chunks written to the output stream
+ */
+constexpr size_t WRITE_CHUNK_SIZE = 64 * 1024;
+
+class PressureAttribute: public XMLAttribute {
+public:
+    PressureAttribute(const char* name, double width, const std::vector<Point>& points):
+            XMLAttribute(name), width(width), points(points) {}
+
+    void writeOut(OutputStream* out) override {
+        std::string str;
+        char number[G_ASCII_DTOSTR_BUF_SIZE];
+        str.append(number, Util::formatCoordinate(number, this->width));
+
+        for (size_t i = 0; i + 1 < this->points.size(); i++) {
+            str += ' ';
+            str.append(number, Util::formatCoordinate(number, this->points[i].z));
+            if (str.size() >= WRITE_CHUNK_SIZE) {
+                out->write(str);
+                str.clear();
+            }
+        }
+        out->write(str);
+    }
+
+private:
+    double width;
+    const std::vector<Point>& points;
+};
+}  // namespace
+
 XmlPointNode::XmlPointNode(const char* tag): XmlAudioNode(tag) {}
 
-void XmlPointNode::addPoint(Point point) { points.emplace_back(std::move(point)); }
+void XmlPointNode::setPoints(const std::vector<Point>& points) { this->points = &points; }
+
+void XmlPointNode::setPressureAttrib(const char* attrib, double width) {
+    g_assert(this->points != nullptr);
+    putAttrib(new PressureAttribute(attrib, width, *this->points));
+}
+
+void XmlPointNode::setEncodedPoints(bool pressure) {
+    this->encoded = true;
+    this->encodedPressure = pressure;
+    setAttrib("encoding", StrokeEncoding::NAME);
+}
 
 void XmlPointNode::writeOut(OutputStream* out) {
     /** Write stroke and its attributes */
@@ -14,13 +64,25 @@ void XmlPointNode::writeOut(OutputStream* out) {
 
     out->write(">");
 
-    auto pointIter = points.begin();
-    Util::writeCoordinateString(out, pointIter->x, pointIter->y);
-    ++pointIter;
-    for (; pointIter != points.end(); ++pointIter) {
-        out->write(" ");
-
-        Util::writeCoordinateString(out, pointIter->x, pointIter->y);
+    if (this->points && this->encoded) {
+        out->write(StrokeEncoding::encode(*this->points, this->encodedPressure));
+    } else if (this->points && !this->points->empty()) {
+        std::string str;
+        str.reserve(std::min(this->points->size() * 26, WRITE_CHUNK_SIZE) + 3 * G_ASCII_DTOSTR_BUF_SIZE);
+        char number[G_ASCII_DTOSTR_BUF_SIZE];
+        for (auto it = this->points->begin(); it != this->points->end(); ++it) {
+            if (it != this->points->begin()) {
+                str += ' ';
+            }
+            str.append(number, Util::formatCoordinate(number, it->x));
+            str += ' ';
+            str.append(number, Util::formatCoordinate(number, it->y));
+            if (str.size() >= WRITE_CHUNK_SIZE) {
+                out->write(str);
+                str.clear();
+            }
+        }
+        out->write(str);
     }
 
     out->write("</");
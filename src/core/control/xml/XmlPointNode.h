@@ -17,14 +17,36 @@
 
 #include "XmlAudioNode.h"
 
+/**
+ * A stroke, written straight from the points of the stroke: they are neither copied nor formatted before writeOut()
+ */
 class XmlPointNode: public XmlAudioNode {
 public:
     XmlPointNode(const char* tag);
 
 public:
-    void addPoint(Point point);
+    /**
+     * The points have to outlive the node
+     */
+    void setPoints(const std::vector<Point>& points);
+
+    /**
+     * Set the attribute to the width, followed by the pressure of each point but the last one (one width per
+     * segment)
+     */
+    void setPressureAttrib(const char* attrib, double width);
+
+    /**
+     * Write the points, and their pressure if any, with StrokeEncoding instead of decimal text. Sets the encoding
+     * attribute.
+     */
+    void setEncodedPoints(bool pressure);
+
     void writeOut(OutputStream* out) override;
 
 private:
-    std::vector<Point> points{};
+    const std::vector<Point>* points = nullptr;
+
+    bool encoded = false;
+    bool encodedPressure = false;
 };
@@ -0,0 +1,194 @@
+#include "AutosaveJournal.h"
+
+#include <utility>
+
+#include <zlib.h>
+
+#include "control/xml/XmlNode.h"
+#include "model/BackgroundImage.h"
+#include "util/GzUtil.h"
+#include "util/OutputStream.h"
+#include "util/i18n.h"
+
+#include "SaveHandler.h"
+
+/**
+ * The ids of the attached background images written by the journal, so that they do not replace the ones of the
+ * snapshot
+ */
+constexpr int FIRST_JOURNAL_ATTACH_ID = 100000;
+
+/**
+ * Writes the pages of a record of the journal, the same way as in a saved document
+ */
+class JournalRecordWriter: public SaveHandler {
+public:
+    JournalRecordWriter(int firstAttachId) {
+        // The PDF file is referenced by the snapshot
+        this->firstPdfPageVisited = true;
+        this->attachBgId = firstAttachId;
+        this->root = std::make_unique<XmlNode>("delta");
+    }
+
+    void writePage(const PageRef& p, Document* doc, size_t id) {
+        auto* page = new XmlNode("page");
+        this->root->addChild(page);
+        page->setAttrib("id", id);
+        page->setAttrib("width", p->getWidth());
+        page->setAttrib("height", p->getHeight());
+
+        writeBackground(page, p, doc, static_cast<int>(id));
+        visitLayers(page, p);
+    }
+
+    void setOrder(const std::string& order) { this->root->setAttrib("order", order); }
+
+    std::string serialize() {
+        StringOutputStream out;
+        this->root->writeOut(&out, nullptr);
+        return out.getString();
+    }
+
+    void writeImages(const fs::path& snapshot) { writeBackgroundImages(snapshot); }
+
+    int getNextAttachId() const { return this->attachBgId; }
+};
+
+AutosaveJournal::AutosaveJournal() = default;
+
+AutosaveJournal::~AutosaveJournal() = default;
+
+void AutosaveJournal::undoRedoChanged() {}
+
+void AutosaveJournal::undoRedoPageChanged(PageRef page) {
+    std::lock_guard<std::mutex> lock(this->dirtyMutex);
+    this->dirtyPages.insert(std::move(page));
+}
+
+auto AutosaveJournal::getJournalPath(fs::path snapshot) -> fs::path { return snapshot += ".journal"; }
+
+auto AutosaveJournal::needsSnapshot(Document* doc, const fs::path& filepath) -> bool {
+    if (this->snapshot.empty() || this->snapshot != filepath || this->records >= MAX_RECORDS) {
+        return true;
+    }
+    if (doc->getPdfFilepath() != this->pdfFilepath || doc->isAttachPdf() != this->attachPdf) {
+        return true;
+    }
+
+    if (!this->snapshotHasPdf) {
+        // The journal does not reference the PDF file, the snapshot has to
+        for (size_t i = 0; i < doc->getPageCount(); i++) {
+            if (doc->getPage(i)->getBackgroundType().isPdfPage()) {
+                return true;
+            }
+        }
+    }
+
+    std::error_code ec;
+    auto snapshotSize = fs::file_size(filepath, ec);
+    if (ec) {
+        return true;
+    }
+    // Replaying a journal bigger than the document is slower than writing the document
+    auto journalSize = fs::file_size(getJournalPath(filepath), ec);
+    return !ec && journalSize > snapshotSize;
+}
+
+void AutosaveJournal::snapshotTaken(Document* doc, const fs::path& filepath) {
+    this->snapshot = filepath;
+    this->pdfFilepath = doc->getPdfFilepath();
+    this->attachPdf = doc->isAttachPdf();
+    this->snapshotHasPdf = false;
+    this->records = 0;
+    this->nextAttachId = FIRST_JOURNAL_ATTACH_ID;
+    this->record.reset();
+
+    this->journalPages.clear();
+    this->journalIds.clear();
+    for (size_t i = 0; i < doc->getPageCount(); i++) {
+        PageRef p = doc->getPage(i);
+        this->snapshotHasPdf = this->snapshotHasPdf || p->getBackgroundType().isPdfPage();
+        this->journalIds[p.get()] = i;
+        this->journalPages.push_back(std::move(p));
+    }
+
+    std::lock_guard<std::mutex> lock(this->dirtyMutex);
+    this->dirtyPages.clear();
+}
+
+void AutosaveJournal::reset() {
+    this->snapshot.clear();
+    this->record.reset();
+    this->journalPages.clear();
+    this->journalIds.clear();
+}
+
+void AutosaveJournal::prepareRecord(Document* doc) {
+    std::set<PageRef> dirty;
+    {
+        std::lock_guard<std::mutex> lock(this->dirtyMutex);
+        std::swap(dirty, this->dirtyPages);
+    }
+
+    this->record = std::make_unique<JournalRecordWriter>(this->nextAttachId);
+
+    for (size_t i = 0; i < doc->getPageCount(); i++) {
+        doc->getPage(i)->getBackgroundImage().clearSaveState();
+    }
+
+    std::string order;
+    for (size_t i = 0; i < doc->getPageCount(); i++) {
+        PageRef p = doc->getPage(i);
+
+        size_t id = 0;
+        auto it = this->journalIds.find(p.get());
+        if (it == this->journalIds.end()) {
+            id = this->journalPages.size();
+            this->journalIds[p.get()] = id;
+            this->journalPages.push_back(p);
+            this->record->writePage(p, doc, id);
+        } else {
+            id = it->second;
+            if (dirty.count(p)) {
+                this->record->writePage(p, doc, id);
+            }
+        }
+
+        if (!order.empty()) {
+            order += " ";
+        }
+        order += std::to_string(id);
+    }
+
+    this->record->setOrder(order);
+    this->nextAttachId = this->record->getNextAttachId();
+
+    // The record references the strokes of the document, which can change once it is unlocked
+    this->recordData = this->record->serialize();
+}
+
+auto AutosaveJournal::writeRecord() -> std::string {
+    if (!this->record) {
+        return "";
+    }
+
+    std::string data = std::move(this->recordData);
+    this->recordData.clear();
+    this->record->writeImages(this->snapshot);
+    std::string error = this->record->getErrorMessage();
+    this->record.reset();
+
+    auto filepath = getJournalPath(this->snapshot);
+    gzFile fp = GzUtil::openPath(filepath, "a");
+    if (!fp) {
+        return FS(_F("Error opening file: \"{1}\"") % filepath.u8string());
+    }
+    // Each record is a gzip member of its own, so that a cut off record does not hide the previous ones
+    bool written = gzwrite(fp, data.data(), static_cast<unsigned int>(data.size())) == static_cast<int>(data.size());
+    if (gzclose(fp) != Z_OK || !written) {
+        return FS(_F("Could not write file \"{1}\"") % filepath.u8string());
+    }
+
+    this->records++;
+    return error;
+}
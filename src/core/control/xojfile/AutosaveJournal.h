@@ -0,0 +1,112 @@
+/*
+ * Xournal++
+ *
+ * Journal of the changes of the document between two autosave snapshots
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "model/Document.h"
+#include "model/PageRef.h"
+#include "undo/UndoRedoHandler.h"
+
+#include "filesystem.h"
+
+class JournalRecordWriter;
+
+/**
+ * @brief Lets the autosave append the changed pages to a journal instead of writing the whole document
+ *
+ * The autosave writes a full snapshot of the document only now and then (see needsSnapshot()). In between, each
+ * autosave appends a record to the journal next to the snapshot (see getJournalPath()), with the pages changed since
+ * the previous autosave, as reported by the UndoRedoHandler, and the order of all pages. Pages are identified by
+ * their index in the snapshot, new pages get the next free ids.
+ *
+ * The journal is a sequence of gzip members, one per record:
+ *
+ *     <delta order="0 1 5 2">
+ *         <page id="5" width="..." height="...">...</page>
+ *     </delta>
+ *
+ * LoadHandler replays the journal when the snapshot is opened.
+ */
+class AutosaveJournal: public UndoRedoListener {
+public:
+    AutosaveJournal();
+    ~AutosaveJournal() override;
+
+public:
+    void undoRedoChanged() override;
+    void undoRedoPageChanged(PageRef page) override;
+
+    /**
+     * @return true if the document has to be written as a full snapshot to the autosave file, instead of a record
+     *         of the journal. Must be called with the document locked.
+     */
+    bool needsSnapshot(Document* doc, const fs::path& filepath);
+
+    /**
+     * The document is written as a full snapshot to the autosave file. Must be called with the document locked, when
+     * the snapshot is prepared.
+     */
+    void snapshotTaken(Document* doc, const fs::path& filepath);
+
+    /**
+     * Forget the snapshot, the next autosave writes a new one
+     */
+    void reset();
+
+    /**
+     * Collect the pages changed since the last autosave. Must be called with the document locked.
+     */
+    void prepareRecord(Document* doc);
+
+    /**
+     * Append the record prepared by prepareRecord() to the journal
+     * @return An error message, empty on success
+     */
+    std::string writeRecord();
+
+    static fs::path getJournalPath(fs::path snapshot);
+
+    /**
+     * Number of records after which a new snapshot is written
+     */
+    static constexpr int MAX_RECORDS = 20;
+
+private:
+    /**
+     * The pages changed since the last autosave, protected by dirtyMutex
+     */
+    std::set<PageRef> dirtyPages;
+    std::mutex dirtyMutex;
+
+    fs::path snapshot;
+    fs::path pdfFilepath;
+    bool attachPdf = false;
+    bool snapshotHasPdf = false;
+
+    /**
+     * The pages known by the journal, by id
+     */
+    std::vector<PageRef> journalPages;
+    std::map<XojPage*, size_t> journalIds;
+
+    int records = 0;
+    int nextAttachId = 0;
+
+    std::unique_ptr<JournalRecordWriter> record;
+    std::string recordData;
+};
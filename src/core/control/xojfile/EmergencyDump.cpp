@@ -0,0 +1,275 @@
+#include "EmergencyDump.h"
+
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glib/gstdio.h>
+
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/Image.h"
+#include "model/Layer.h"
+#include "model/PageType.h"
+#include "model/Stroke.h"
+#include "model/TexImage.h"
+#include "model/Text.h"
+#include "model/XojPage.h"
+#include "util/PathUtil.h"
+#include "util/i18n.h"
+#include "util/serializing/BinObjectEncoding.h"
+#include "util/serializing/InputStreamException.h"
+#include "util/serializing/ObjectInputStream.h"
+#include "util/serializing/ObjectOutputStream.h"
+
+#include "SaveHandler.h"
+
+static std::FILE* dumpFile = nullptr;
+static bool dumped = false;
+
+auto EmergencyDump::getFilepath() -> fs::path { return Util::getConfigFile("emergencysave.dump"); }
+
+auto EmergencyDump::prepare() -> bool {
+    if (dumpFile == nullptr) {
+        dumpFile = g_fopen(getFilepath().u8string().c_str(), "wb");
+        if (dumpFile == nullptr) {
+            g_warning("Could not open the emergency dump file \"%s\"", getFilepath().u8string().c_str());
+            return false;
+        }
+        // Written by whole records, which are flushed at once
+        std::setvbuf(dumpFile, nullptr, _IONBF, 0);
+    }
+    return true;
+}
+
+void EmergencyDump::release() {
+    if (dumpFile != nullptr) {
+        std::fclose(dumpFile);
+        dumpFile = nullptr;
+        // Control::quit() dumps the document when it cannot be closed: keep it for the next start
+        if (!dumped) {
+            std::error_code ec;
+            fs::remove(getFilepath(), ec);
+        }
+    }
+}
+
+auto EmergencyDump::write(Document* doc) -> bool {
+    if (dumpFile == nullptr) {
+        return false;
+    }
+    dumped = true;
+    return writeTo(doc, dumpFile);
+}
+
+/**
+ * Writes the stream as one record and frees it
+ */
+static auto writeRecord(ObjectOutputStream& out, std::FILE* file) -> bool {
+    GString* str = out.getStr();
+    size_t length = str->len;
+    bool written = std::fwrite(&length, sizeof(length), 1, file) == 1 &&
+                   std::fwrite(str->str, 1, length, file) == length && std::fflush(file) == 0;
+    g_string_free(str, true);
+    return written;
+}
+
+static void writePage(ObjectOutputStream& out, XojPage& page) {
+    out.writeObject("Page");
+    out.writeDouble(page.getWidth());
+    out.writeDouble(page.getHeight());
+
+    PageType type = page.getBackgroundType();
+    out.writeInt(static_cast<int>(type.format));
+    out.writeString(type.config);
+    out.writeInt(static_cast<int>(uint32_t(page.getBackgroundColor())));
+    out.writeSizeT(page.getPdfPageNr());
+    out.writeSizeT(page.getSelectedLayerId());
+
+    std::vector<Layer*>* layers = page.getLayers();
+    out.writeSizeT(layers->size());
+    for (Layer* layer: *layers) {
+        out.writeObject("Layer");
+        out.writeInt(layer->hasName());
+        out.writeString(layer->getName());
+        out.writeInt(layer->isVisible());
+
+        const std::vector<Element*>& elements = layer->getElements();
+        out.writeSizeT(elements.size());
+        for (Element* e: elements) { e->serialize(out); }
+        out.endObject();
+    }
+    out.endObject();
+}
+
+auto EmergencyDump::writeTo(Document* doc, std::FILE* file) -> bool {
+    std::rewind(file);
+
+    size_t pageCount = doc->getPageCount();
+    {
+        ObjectOutputStream header(new BinObjectEncoding());
+        header.writeObject("EmergencyDump");
+        header.writeString(doc->getPdfFilepath().u8string());
+        header.writeSizeT(pageCount);
+        header.endObject();
+        if (!writeRecord(header, file)) {
+            return false;
+        }
+    }
+
+    // One stream per page: only the encoding of the current page is held in memory
+    for (size_t i = 0; i < pageCount; i++) {
+        ObjectOutputStream out(new BinObjectEncoding());
+        writePage(out, *doc->getPage(i));
+        if (!writeRecord(out, file)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static auto readElement(ObjectInputStream& in) -> std::unique_ptr<Element> {
+    std::string name = in.getNextObjectName();
+    std::unique_ptr<Element> element;
+    if (name == "Stroke") {
+        element = std::make_unique<Stroke>();
+    } else if (name == "Image") {
+        element = std::make_unique<Image>();
+    } else if (name == "TexImage") {
+        element = std::make_unique<TexImage>();
+    } else if (name == "Text") {
+        element = std::make_unique<Text>();
+    } else {
+        throw InputStreamException(FS(FORMAT_STR("Get unknown object {1}") % name), __FILE__, __LINE__);
+    }
+    element->readSerialized(in);
+    return element;
+}
+
+auto EmergencyDump::readPage(ObjectInputStream& in) -> PageRef {
+    in.readObject("Page");
+    double width = in.readDouble();
+    double height = in.readDouble();
+    auto page = std::make_shared<XojPage>(width, height);
+
+    int format = in.readInt();
+    if (format < static_cast<int>(PageTypeFormat::Plain) || format > static_cast<int>(PageTypeFormat::Copy)) {
+        throw InputStreamException(FS(FORMAT_STR("Unknown background format {1}") % format), __FILE__, __LINE__);
+    }
+    PageType type(static_cast<PageTypeFormat>(format));
+    type.config = in.readString();
+    if (type.isImagePage()) {
+        // The image was not dumped
+        type = PageType(PageTypeFormat::Plain);
+    }
+    page->setBackgroundType(type);
+    page->setBackgroundColor(Color(static_cast<uint32_t>(in.readInt())));
+    page->setBackgroundPdfPageNr(in.readSizeT());
+    Layer::Index selectedLayer = in.readSizeT();
+
+    size_t layerCount = in.readSizeT();
+    for (size_t i = 0; i < layerCount; i++) {
+        in.readObject("Layer");
+        auto layer = std::make_unique<Layer>();
+        bool hasName = in.readInt();
+        std::string name = in.readString();
+        if (hasName) {
+            layer->setName(name);
+        }
+        layer->setVisible(in.readInt());
+
+        size_t elementCount = in.readSizeT();
+        for (size_t j = 0; j < elementCount; j++) { layer->addElement(readElement(in).release()); }
+        in.endObject();
+        page->addLayer(layer.release());
+    }
+    page->setSelectedLayerId(selectedLayer);
+    in.endObject();
+    return page;
+}
+
+auto EmergencyDump::readFrom(const fs::path& dump, Document* doc) -> bool {
+    std::ifstream file(dump, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    size_t position = 0;
+    auto readRecord = [&](ObjectInputStream& in) {
+        size_t length = 0;
+        if (data.size() - position < sizeof(length)) {
+            return false;
+        }
+        std::memcpy(&length, data.data() + position, sizeof(length));
+        position += sizeof(length);
+        if (length > data.size() - position || length > INT_MAX) {
+            return false;
+        }
+        bool read = in.read(data.data() + position, static_cast<int>(length));
+        position += length;
+        return read;
+    };
+
+    size_t pageCount = 0;
+    try {
+        ObjectInputStream header;
+        if (!readRecord(header)) {
+            return false;
+        }
+        header.readObject("EmergencyDump");
+        fs::path pdf = fs::u8path(header.readString());
+        pageCount = header.readSizeT();
+        header.endObject();
+
+        std::error_code ec;
+        if (!pdf.empty() && fs::is_regular_file(pdf, ec) && !doc->readPdf(pdf, false, false)) {
+            g_warning("Could not read the PDF background \"%s\" of the emergency dump", pdf.u8string().c_str());
+        }
+    } catch (const InputStreamException& e) {
+        g_warning("Could not read the emergency dump: %s", e.what());
+        return false;
+    }
+
+    doc->lock();
+    for (size_t i = 0; i < pageCount; i++) {
+        ObjectInputStream in;
+        try {
+            if (!readRecord(in)) {
+                g_warning("The emergency dump is truncated after %zu of %zu pages", i, pageCount);
+                break;
+            }
+            doc->addPage(readPage(in));
+        } catch (const InputStreamException& e) {
+            g_warning("Could not read the page %zu of the emergency dump: %s", i + 1, e.what());
+            break;
+        }
+    }
+    doc->unlock();
+    return true;
+}
+
+auto EmergencyDump::convert(const fs::path& dump, const fs::path& target) -> bool {
+    std::error_code ec;
+    if (!fs::exists(dump, ec) || fs::file_size(dump, ec) == 0) {
+        return false;
+    }
+
+    DocumentHandler handler;
+    Document doc(&handler);
+    bool converted = readFrom(dump, &doc) && doc.getPageCount() > 0;
+    if (converted) {
+        SaveHandler saver;
+        saver.prepareSave(&doc);
+        saver.saveTo(target);
+        if (!saver.getErrorMessage().empty()) {
+            g_warning("Could not save the emergency dump: %s", saver.getErrorMessage().c_str());
+            converted = false;
+        }
+    }
+    if (converted) {
+        fs::remove(dump, ec);
+    }
+    return converted;
+}
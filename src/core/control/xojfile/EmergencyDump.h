@@ -0,0 +1,73 @@
+/*
+ * Xournal++
+ *
+ * Binary dump of the document, written when Xournal++ crashes
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdio>
+
+#include "model/PageRef.h"
+
+#include "filesystem.h"
+
+class Document;
+class ObjectInputStream;
+
+/**
+ * @brief Writes the open document from the crash handler, without the XML tree and the compression of SaveHandler
+ *
+ * The dump is a sequence of records, each one a native size_t length followed by an ObjectOutputStream: a header with
+ * the PDF background and the number of pages, then one record per page with its size, its background and its layers,
+ * whose elements are written by Element::serialize() as for the clipboard. Each page is written and flushed as soon as
+ * it is encoded, so a crash while dumping only loses the pages after it. The background images are not dumped.
+ *
+ * The file of the dump is opened by prepare() once the dump of the last session was converted by convert() into the
+ * emergency save file, which is then restored as before.
+ */
+class EmergencyDump {
+public:
+    /**
+     * @return The file which the crash handler dumps the document to
+     */
+    static fs::path getFilepath();
+
+    /**
+     * Opens the file of the dump in advance: the crash handler only writes to it
+     */
+    static bool prepare();
+
+    /**
+     * Closes and removes the file of the dump, on a normal exit
+     */
+    static void release();
+
+    /**
+     * Dumps the document to the file opened by prepare(). The document is not locked: this is only called on a crash.
+     * @return true if the whole document was written
+     */
+    static bool write(Document* doc);
+
+    /**
+     * Reads the dump of the last session, saves it to the target with SaveHandler and removes the dump
+     * @return false if there is no dump, or nothing could be read from it
+     */
+    static bool convert(const fs::path& dump, const fs::path& target);
+
+    static bool writeTo(Document* doc, std::FILE* file);
+
+    /**
+     * Adds the pages read from the dump to the document, up to the first truncated or invalid one
+     * @return false if the header of the dump could not be read
+     */
+    static bool readFrom(const fs::path& dump, Document* doc);
+
+private:
+    static PageRef readPage(ObjectInputStream& in);
+};
@@ -0,0 +1,341 @@
+#include "IndexedSaveHandler.h"
+
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#include "control/jobs/ProgressListener.h"
+#include "control/xml/XmlNode.h"
+#include "model/BackgroundImage.h"
+#include "model/Image.h"
+#include "model/ImageStore.h"
+#include "util/OutputStream.h"
+#include "util/PathUtil.h"
+#include "util/i18n.h"
+
+#include "LazyPageLoader.h"
+
+IndexedSaveHandler::IndexedSaveHandler() = default;
+
+IndexedSaveHandler::~IndexedSaveHandler() { closeSources(); }
+
+void IndexedSaveHandler::writeHeader() {
+    // Called first by prepareSave(): forget the previous save
+    this->pageEntries.clear();
+    this->usedEntryNames.clear();
+    this->nextEntryId = 1;
+    this->images.clear();
+    this->pdfSource = nullptr;
+    this->pdfSourceIndex = -1;
+    closeSources();
+
+    SaveHandler::writeHeader();
+    this->root->setAttrib("layout", "indexed");
+}
+
+auto IndexedSaveHandler::openSource(const fs::path& filepath) -> zip_t* {
+    auto it = this->sources.find(filepath);
+    if (it != this->sources.end()) {
+        return it->second;
+    }
+
+    int zipError = 0;
+    zip_t* source = zip_open(filepath.u8string().c_str(), ZIP_RDONLY, &zipError);
+    this->sources[filepath] = source;
+    return source;
+}
+
+void IndexedSaveHandler::closeSources() {
+    for (auto& [path, source]: this->sources) {
+        if (source) {
+            zip_discard(source);
+        }
+    }
+    this->sources.clear();
+}
+
+auto IndexedSaveHandler::findSource(const fs::path& filepath) const -> zip_t* {
+    for (const auto& [path, source]: this->sources) {
+        std::error_code ec;
+        if (source && fs::equivalent(path, filepath, ec)) {
+            return source;
+        }
+    }
+    return nullptr;
+}
+
+auto IndexedSaveHandler::newEntryName() -> std::string {
+    std::string name;
+    do {
+        name = "pages/" + std::to_string(this->nextEntryId++) + ".xml";
+    } while (this->usedEntryNames.count(name));
+    this->usedEntryNames.insert(name);
+    return name;
+}
+
+auto IndexedSaveHandler::copiesLayers(const LazyPageLoader& loader) const -> bool {
+    return !loader.getEntry().empty() && loader.getSource().indexedLayout;
+}
+
+void IndexedSaveHandler::visitImage(XmlNode* layer, Image* i) {
+    auto content = i->getContent();
+    if (!content) {
+        return;
+    }
+
+    gchar* format = gdk_pixbuf_format_get_name(content->getFormat());
+    std::string name = "images/" + content->getHash() + "." + (format ? format : "img");
+    g_free(format);
+    this->images.emplace(name, std::move(content));
+
+    auto* image = new XmlNode("image");
+    layer->addChild(image);
+    auto* attachment = new XmlNode("attachment");
+    attachment->setAttrib("path", name);
+    image->addChild(attachment);
+    writeImageBounds(image, i);
+}
+
+void IndexedSaveHandler::writeAttachedPdf(Document* doc) {
+    // Copy the entry the PDF was read from, unless the archive was changed since
+    const auto& attachment = doc->getPdfAttachmentSource();
+    if (!attachment.archive.empty()) {
+        if (zip_t* source = openSource(attachment.archive)) {
+            zip_stat_t stat;
+            zip_stat_init(&stat);
+            if (zip_stat(source, attachment.entry.c_str(), 0, &stat) == 0 && (stat.valid & ZIP_STAT_CRC) &&
+                (stat.valid & ZIP_STAT_SIZE) && stat.crc == attachment.crc && stat.size == attachment.size) {
+                this->pdfSource = source;
+                this->pdfSourceIndex = static_cast<zip_int64_t>(stat.index);
+                return;
+            }
+        }
+    }
+
+    SaveHandler::writeAttachedPdf(doc);
+}
+
+void IndexedSaveHandler::visitPage(XmlNode* root, PageRef p, Document* doc, int id) {
+    auto* page = new XmlNode("page");
+    root->addChild(page);
+    page->setAttrib("width", p->getWidth());
+    page->setAttrib("height", p->getHeight());
+
+    writeBackground(page, p, doc, id);
+
+    PageEntry entry;
+    entry.node = page;
+
+    // The layers of the page were not even parsed since the file was opened: they are unchanged
+    auto loader = std::dynamic_pointer_cast<LazyPageLoader>(p->getLayerLoader());
+    if (loader && copiesLayers(*loader)) {
+        if (zip_t* source = openSource(loader->getSource().filepath)) {
+            zip_int64_t index = zip_name_locate(source, loader->getEntry().c_str(), 0);
+            if (index >= 0 && !this->usedEntryNames.count(loader->getEntry())) {
+                entry.name = loader->getEntry();
+                entry.source = source;
+                entry.sourceIndex = index;
+                this->usedEntryNames.insert(entry.name);
+            }
+        }
+    }
+
+    if (!entry.source) {
+        XmlNode layers("page");
+        layers.setAttrib("width", p->getWidth());
+        layers.setAttrib("height", p->getHeight());
+        visitLayers(&layers, p);
+
+        StringOutputStream out;
+        layers.writeOut(&out, nullptr);
+        entry.data = out.getString();
+    }
+
+    this->pageEntries.push_back(std::move(entry));
+}
+
+void IndexedSaveHandler::saveTo(const fs::path& filepath, ProgressListener* listener) {
+    // Update an existing archive, its unchanged entries are not copied from another one
+    int zipError = 0;
+    zip_t* zipFp = nullptr;
+    std::error_code ec;
+    if (fs::exists(filepath, ec)) {
+        zipFp = zip_open(filepath.u8string().c_str(), 0, &zipError);
+    }
+    bool inPlace = zipFp != nullptr;
+    if (!zipFp) {
+        zipFp = zip_open(filepath.u8string().c_str(), ZIP_CREATE | ZIP_TRUNCATE, &zipError);
+    }
+    if (!zipFp) {
+        zip_error_t error;
+        zip_error_init_with_code(&error, zipError);
+        this->errorMessage = FS(_F("Error opening file: \"{1}\"") % filepath.u8string()) + "\n" +
+                             zip_error_strerror(&error);
+        zip_error_fini(&error);
+        return;
+    }
+
+    // The entries of the target which were read, e.g. by the lazily loaded pages
+    zip_t* target = inPlace ? findSource(filepath) : nullptr;
+    auto hasEntry = [&](const std::string& name) { return zip_name_locate(zipFp, name.c_str(), 0) >= 0; };
+
+    // The buffers have to stay alive until the archive is written
+    std::vector<std::string> buffers;
+    buffers.reserve(4 + this->pageEntries.size() + this->backgroundImages.size());
+
+    // The entries of the written file: the others of the updated archive are removed
+    std::set<std::string> written;
+
+    bool ok = true;
+    auto addBuffer = [&](const std::string& name, std::string data, bool compress) {
+        written.insert(name);
+        buffers.push_back(std::move(data));
+        zip_source_t* source = zip_source_buffer(zipFp, buffers.back().data(), buffers.back().size(), 0);
+        zip_int64_t index = source ? zip_file_add(zipFp, name.c_str(), source, ZIP_FL_OVERWRITE) : -1;
+        if (index < 0) {
+            zip_source_free(source);
+            ok = false;
+            return;
+        }
+        if (!compress) {
+            zip_set_file_compression(zipFp, static_cast<zip_uint64_t>(index), ZIP_CM_STORE, 0);
+        }
+    };
+    auto copyEntry = [&](const std::string& name, zip_t* source, zip_uint64_t index) {
+        written.insert(name);
+        if (source == target && hasEntry(name)) {
+            return;
+        }
+        zip_source_t* entry = zip_source_zip(zipFp, source, index, 0, 0, -1);
+        if (!entry || zip_file_add(zipFp, name.c_str(), entry, ZIP_FL_OVERWRITE) < 0) {
+            zip_source_free(entry);
+            ok = false;
+        }
+    };
+
+    addBuffer("mimetype", "application/xournal++", false);
+    addBuffer("META-INF/version",
+              "current=" + std::to_string(this->fileVersion) + "\nmin=" + std::to_string(this->fileVersion) + "\n",
+              false);
+
+    if (listener) {
+        listener->setMaximumState(static_cast<int>(this->pageEntries.size()));
+    }
+
+    int state = 0;
+    for (PageEntry& entry: this->pageEntries) {
+        if (entry.source) {
+            copyEntry(entry.name, entry.source, static_cast<zip_uint64_t>(entry.sourceIndex));
+        } else {
+            entry.name = newEntryName();
+            addBuffer(entry.name, std::move(entry.data), true);
+        }
+        entry.node->setAttrib("layers", entry.name);
+
+        if (listener) {
+            listener->setCurrentState(++state);
+        }
+    }
+
+    // The images are stored as they are: their data is compressed already. Their name is their hash, the ones already
+    // in the archive are unchanged.
+    for (const auto& [name, image]: this->images) {
+        written.insert(name);
+        if (inPlace && hasEntry(name)) {
+            continue;
+        }
+        const std::string& data = image->getData();
+        zip_source_t* source = zip_source_buffer(zipFp, data.data(), data.size(), 0);
+        zip_int64_t index = source ? zip_file_add(zipFp, name.c_str(), source, ZIP_FL_OVERWRITE) : -1;
+        if (index < 0) {
+            zip_source_free(source);
+            ok = false;
+            continue;
+        }
+        zip_set_file_compression(zipFp, static_cast<zip_uint64_t>(index), ZIP_CM_STORE, 0);
+    }
+
+    // The copied pages may show images of their source, which are not parsed: all of them are kept
+    std::set<zip_t*> copiedSources;
+    for (const PageEntry& entry: this->pageEntries) {
+        if (entry.source) {
+            copiedSources.insert(entry.source);
+        }
+    }
+    for (zip_t* source: copiedSources) {
+        zip_int64_t count = zip_get_num_entries(source, 0);
+        for (zip_int64_t i = 0; i < count; i++) {
+            const char* name = zip_get_name(source, static_cast<zip_uint64_t>(i), 0);
+            if (!name || std::string_view(name).rfind("images/", 0) != 0 || written.count(name)) {
+                continue;
+            }
+            copyEntry(name, source, static_cast<zip_uint64_t>(i));
+        }
+    }
+
+    StringOutputStream content;
+    content.write("<?xml version=\"1.0\" standalone=\"no\"?>\n");
+    this->root->writeOut(&content, nullptr);
+    addBuffer("content.xml", content.getString(), true);
+
+    for (BackgroundImage const& img: this->backgroundImages) {
+        gchar* data = nullptr;
+        gsize size = 0;
+        if (gdk_pixbuf_save_to_buffer(img.getPixbuf(), &data, &size, "png", nullptr, nullptr)) {
+            addBuffer(img.getFilepath().u8string(), std::string(data, size), false);
+            g_free(data);
+        } else {
+            if (!this->errorMessage.empty()) {
+                this->errorMessage += "\n";
+            }
+            this->errorMessage +=
+                    FS(_F("Could not write background \"{1}\". Continuing anyway.") % img.getFilepath().u8string());
+        }
+    }
+
+    if (this->pdfSource) {
+        const char* name = zip_get_name(this->pdfSource, static_cast<zip_uint64_t>(this->pdfSourceIndex), 0);
+        if (this->pdfSource == target && name && std::string_view(name) == "bg.pdf") {
+            copyEntry("bg.pdf", this->pdfSource, static_cast<zip_uint64_t>(this->pdfSourceIndex));
+        } else {
+            // Under another name, or in another archive: the entry is overwritten by the copy
+            written.insert("bg.pdf");
+            zip_source_t* source =
+                    zip_source_zip(zipFp, this->pdfSource, static_cast<zip_uint64_t>(this->pdfSourceIndex), 0, 0, -1);
+            if (!source || zip_file_add(zipFp, "bg.pdf", source, ZIP_FL_OVERWRITE) < 0) {
+                zip_source_free(source);
+                ok = false;
+            }
+        }
+    } else if (!this->attachedPdfFilepath.empty()) {
+        written.insert("bg.pdf");
+        zip_source_t* source = zip_source_file(zipFp, this->attachedPdfFilepath.u8string().c_str(), 0, -1);
+        if (!source || zip_file_add(zipFp, "bg.pdf", source, ZIP_FL_OVERWRITE) < 0) {
+            zip_source_free(source);
+            ok = false;
+        }
+    }
+
+    if (inPlace) {
+        zip_int64_t count = zip_get_num_entries(zipFp, 0);
+        for (zip_int64_t i = 0; i < count; i++) {
+            const char* name = zip_get_name(zipFp, static_cast<zip_uint64_t>(i), 0);
+            if (name && !written.count(name)) {
+                zip_delete(zipFp, static_cast<zip_uint64_t>(i));
+            }
+        }
+    }
+
+    if (!ok || zip_close(zipFp) != 0) {
+        if (!this->errorMessage.empty()) {
+            this->errorMessage += "\n";
+        }
+        this->errorMessage += FS(_F("Could not write file \"{1}\": {2}") % filepath.u8string() %
+                                 zip_error_strerror(zip_get_error(zipFp)));
+        zip_discard(zipFp);
+    } else {
+        Util::syncFile(filepath);
+    }
+
+    closeSources();
+}
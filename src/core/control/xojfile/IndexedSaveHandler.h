@@ -0,0 +1,116 @@
+/*
+ * Xournal++
+ *
+ * Saves a document in the indexed layout, with a compressed entry per page
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <zip.h>
+
+#include "SaveHandler.h"
+
+class ImageData;
+
+/**
+ * @brief Writes the indexed layout of .xopp files
+ *
+ * The file is a zip archive, like the one LoadHandler already reads:
+ *  - mimetype and META-INF/version
+ *  - content.xml, the manifest: the document header and, in order, the pages with their size and background.
+ *    Each page element references the archive entry with its layers in its "layers" attribute, this is the page index
+ *  - pages/N.xml: the layers of a page, compressed on their own
+ *  - images/HASH.FORMAT: the data of the images, each written once however many elements show it, in an attachment
+ *    element of the image elements
+ *  - the attached backgrounds
+ *
+ * Pages whose layers were never loaded since the document was opened from an indexed file (see
+ * XojPage::hasPendingLayers()) are not modified: their entry is copied from the original file without being parsed
+ * or compressed again. Only the pages which were accessed are written. The same holds for the images and for an
+ * attached PDF read from an archive (see Document::getPdfAttachmentSource()).
+ *
+ * An existing archive is updated in place: its unchanged entries are kept as they are, the others are replaced and the
+ * ones no longer referenced are removed. libzip writes the result to a temporary file which replaces the archive.
+ */
+class IndexedSaveHandler: public SaveHandler {
+public:
+    IndexedSaveHandler();
+    virtual ~IndexedSaveHandler();
+
+public:
+    void saveTo(const fs::path& filepath, ProgressListener* listener = nullptr) override;
+
+protected:
+    void writeHeader() override;
+    void visitPage(XmlNode* root, PageRef p, Document* doc, int id) override;
+    bool copiesLayers(const LazyPageLoader& loader) const override;
+    void visitImage(XmlNode* layer, Image* i) override;
+    void writeAttachedPdf(Document* doc) override;
+
+private:
+    /**
+     * @return The archive of an indexed file the entries are copied from, opened while the file is not overwritten
+     */
+    zip_t* openSource(const fs::path& filepath);
+
+    /**
+     * @return An entry name not used by any copied page
+     */
+    std::string newEntryName();
+
+    void closeSources();
+
+    /**
+     * @return The source opened for the file, nullptr if there is none
+     */
+    zip_t* findSource(const fs::path& filepath) const;
+
+private:
+    struct PageEntry {
+        /**
+         * The page element in content.xml
+         */
+        XmlNode* node = nullptr;
+
+        /**
+         * The name of the entry, only known once all the pages are visited if the entry is written
+         */
+        std::string name;
+
+        /**
+         * The layers, or empty if the entry is copied
+         */
+        std::string data;
+
+        zip_t* source = nullptr;
+        zip_int64_t sourceIndex = -1;
+    };
+
+    std::vector<PageEntry> pageEntries;
+    std::set<std::string> usedEntryNames;
+    int nextEntryId = 1;
+
+    std::map<fs::path, zip_t*> sources;
+
+    /**
+     * The images of the written pages, by entry name
+     */
+    std::map<std::string, std::shared_ptr<const ImageData>> images;
+
+    /**
+     * The entry of the attached PDF copied from an archive, if any
+     */
+    zip_t* pdfSource = nullptr;
+    zip_int64_t pdfSourceIndex = -1;
+};
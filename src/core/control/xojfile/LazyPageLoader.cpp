@@ -0,0 +1,108 @@
+#include "LazyPageLoader.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "util/i18n.h"
+
+#include "LoadHandler.h"
+
+void PageOffsetScanner::feed(const char* data, size_t len) {
+    static constexpr const char* PAGE = "page";
+
+    for (size_t i = 0; i < len; i++, this->offset++) {
+        char c = data[i];
+
+        switch (this->state) {
+            case TEXT:
+                break;
+            case TAG_OPEN:
+                if (c == '/' && !this->closing) {
+                    this->closing = true;
+                    this->previous = c;
+                    continue;
+                }
+                this->state = TAG_NAME;
+                this->matched = 0;
+                [[fallthrough]];
+            case TAG_NAME:
+                if (this->matched < 4) {
+                    if (c == PAGE[this->matched]) {
+                        this->matched++;
+                        this->previous = c;
+                        continue;
+                    }
+                } else if (g_ascii_isspace(c) || c == '>' || (c == '/' && !this->closing)) {
+                    // The whole name is matched, and is not the prefix of another one
+                    this->state = this->closing ? END_TAG : START_TAG;
+                    this->quote = 0;
+                    // The delimiter is handled below
+                    break;
+                }
+                this->state = TEXT;
+                break;
+            default:
+                break;
+        }
+
+        if (this->state == START_TAG) {
+            if (this->quote) {
+                if (c == this->quote) {
+                    this->quote = 0;
+                }
+            } else if (c == '"' || c == '\'') {
+                this->quote = c;
+            } else if (c == '>') {
+                if (this->previous == '/') {
+                    // An empty page: <page ... />
+                    this->pages.emplace_back(this->tagStart, this->offset + 1);
+                } else {
+                    this->pageStart = this->tagStart;
+                }
+                this->state = TEXT;
+            }
+        } else if (this->state == END_TAG) {
+            if (c == '>') {
+                this->pages.emplace_back(this->pageStart, this->offset + 1);
+                this->state = TEXT;
+            }
+        } else if (c == '<') {
+            this->state = TAG_OPEN;
+            this->tagStart = this->offset;
+            this->closing = false;
+        }
+
+        this->previous = c;
+    }
+}
+
+auto PageOffsetScanner::getPages() const -> const std::vector<Range>& { return this->pages; }
+
+LazyPageLoader::Source::Source(fs::path filepath, int fileVersion, bool indexedLayout, GHashTable* audioFiles):
+        filepath(std::move(filepath)),
+        fileVersion(fileVersion),
+        indexedLayout(indexedLayout),
+        audioFiles(g_hash_table_ref(audioFiles)) {}
+
+LazyPageLoader::Source::~Source() { g_hash_table_unref(this->audioFiles); }
+
+LazyPageLoader::LazyPageLoader(std::shared_ptr<const Source> source, PageOffsetScanner::Range range):
+        source(std::move(source)), range(range) {}
+
+LazyPageLoader::LazyPageLoader(std::shared_ptr<const Source> source, std::string entry):
+        source(std::move(source)), range(0, SIZE_MAX), entry(std::move(entry)) {}
+
+void LazyPageLoader::loadLayers(XojPage& page) {
+    LoadHandler handler;
+    if (!handler.loadPageLayers(*this->source, this->range, this->entry, page)) {
+        g_warning("%s", FC(_F("Could not load the page of \"{1}\": {2}") % this->source->filepath.u8string() %
+                           handler.getLastError()));
+    }
+}
+
+auto LazyPageLoader::getSource() const -> const Source& { return *this->source; }
+
+auto LazyPageLoader::getEntry() const -> const std::string& { return this->entry; }
+
+auto LazyPageLoader::getRange() const -> const PageOffsetScanner::Range& { return this->range; }
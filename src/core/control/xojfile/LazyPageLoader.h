@@ -0,0 +1,133 @@
+/*
+ * Xournal++
+ *
+ * Parses the layers of a page of a loaded document on first access
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glib.h>
+
+#include "model/XojPage.h"
+
+#include "filesystem.h"
+
+/**
+ * @brief Finds the byte ranges of the <page> elements in the XML content stream of a document
+ *
+ * The stream is fed in chunks, in the order it is read. XML escapes '<' in text and attributes, so every "<page"
+ * followed by a delimiter starts a page element.
+ */
+class PageOffsetScanner {
+public:
+    using Range = std::pair<size_t, size_t>;
+
+    void feed(const char* data, size_t len);
+
+    /**
+     * @return The [start, end) range of every complete page element found so far
+     */
+    const std::vector<Range>& getPages() const;
+
+private:
+    enum State {
+        TEXT,       // Outside of the tags of interest
+        TAG_OPEN,   // After '<'
+        TAG_NAME,   // Matching "page"
+        START_TAG,  // In the attributes of a <page> tag
+        END_TAG     // In a </page> tag
+    };
+
+    State state = TEXT;
+
+    /**
+     * Offset in the stream of the next byte fed
+     */
+    size_t offset = 0;
+
+    /**
+     * Offset of the '<' of the tag being matched
+     */
+    size_t tagStart = 0;
+
+    /**
+     * Number of characters of "page" matched so far, and whether it is a closing tag
+     */
+    size_t matched = 0;
+    bool closing = false;
+
+    /**
+     * The quote of the attribute value being read in a start tag, 0 outside of values
+     */
+    char quote = 0;
+    char previous = 0;
+
+    size_t pageStart = 0;
+    std::vector<Range> pages;
+};
+
+/**
+ * @brief Creates the layers of one page by parsing its element in the file again
+ *
+ * The layers are either in the page element of the content stream, or in an entry of their own in the indexed layout
+ * (see IndexedSaveHandler). The source is shared by all the pages of the document, and keeps what is needed to parse
+ * a page on its own.
+ */
+class LazyPageLoader: public XojPageLayerLoader {
+public:
+    struct Source {
+        Source(fs::path filepath, int fileVersion, bool indexedLayout, GHashTable* audioFiles);
+        ~Source();
+        Source(const Source&) = delete;
+        Source& operator=(const Source&) = delete;
+
+        fs::path filepath;
+        int fileVersion;
+        bool indexedLayout;
+
+        /**
+         * The temporary files of the audio attachments, by attachment name
+         */
+        GHashTable* audioFiles;
+    };
+
+    /**
+     * @param range The range of the page element in the content stream
+     */
+    LazyPageLoader(std::shared_ptr<const Source> source, PageOffsetScanner::Range range);
+
+    /**
+     * @param entry The archive entry with the layers of the page
+     */
+    LazyPageLoader(std::shared_ptr<const Source> source, std::string entry);
+
+    void loadLayers(XojPage& page) override;
+
+    const Source& getSource() const;
+
+    /**
+     * @return The archive entry with the layers, empty if they are in the content stream
+     */
+    const std::string& getEntry() const;
+
+    /**
+     * @return The range of the page element in the content stream, if the layers are there
+     */
+    const PageOffsetScanner::Range& getRange() const;
+
+private:
+    std::shared_ptr<const Source> source;
+    PageOffsetScanner::Range range;
+    std::string entry;
+};
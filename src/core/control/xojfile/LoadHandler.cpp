@@ -1,7 +1,12 @@
 #include "LoadHandler.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <memory>
+#include <system_error>
 #include <utility>
+#include <vector>
 
 #include <config.h>
 #include <glib/gstdio.h>
@@ -9,14 +14,22 @@
 
 #include "control/pagetype/PageTypeHandler.h"
 #include "model/BackgroundImage.h"
+#include "model/ImageStore.h"
 #include "model/StrokeStyle.h"
 #include "model/XojPage.h"
-#include "util/GzUtil.h"
+#include "util/GzInputStream.h"
+#include "util/ParallelLoop.h"
+#include "util/Profiler.h"
 #include "util/i18n.h"
 
+#include "AutosaveJournal.h"
 #include "LoadHandlerHelper.h"
+#include "RemoteFile.h"
+#include "StrokeEncoding.h"
 
 using std::string;
+using LoadHandlerHelper::Attribute;
+using LoadHandlerHelper::Tag;
 
 #define error2(var, ...)                                                                \
     if (var == nullptr) {                                                               \
@@ -38,14 +51,11 @@ LoadHandler::LoadHandler():
         minimalFileVersion(0),
         zipFp(nullptr),
         zipContentFile(nullptr),
-        gzFp(nullptr),
         layer(nullptr),
         stroke(nullptr),
         text(nullptr),
         image(nullptr),
         teximage(nullptr),
-        attributeNames(nullptr),
-        attributeValues(nullptr),
         elementName(nullptr),
         loadedTimeStamp(0),
         doc(&dHanlder) {
@@ -55,6 +65,10 @@ LoadHandler::LoadHandler():
 }
 
 LoadHandler::~LoadHandler() {
+    if (this->remainingContext) {
+        discardRemainingPages();
+        closeFile();
+    }
     if (this->audioFiles) {
         g_hash_table_unref(this->audioFiles);
     }
@@ -63,11 +77,9 @@ LoadHandler::~LoadHandler() {
 void LoadHandler::initAttributes() {
     this->zipFp = nullptr;
     this->zipContentFile = nullptr;
-    this->gzFp = nullptr;
+    this->gzIn.reset();
     this->isGzFile = false;
     this->error = nullptr;
-    this->attributeNames = nullptr;
-    this->attributeValues = nullptr;
     this->elementName = nullptr;
     this->pdfFilenameParsed = false;
     this->attachedPdfMissing = false;
@@ -79,6 +91,13 @@ void LoadHandler::initAttributes() {
     this->teximage = nullptr;
     this->text = nullptr;
     this->pages.clear();
+    this->lazyPages.clear();
+    this->pageOffsets = PageOffsetScanner();
+    this->layerEntries.clear();
+    this->indexedLayout = false;
+    this->layerSource.reset();
+    this->attachedLazyPages = 0;
+    this->publishedPages = 0;
 
     if (this->audioFiles) {
         g_hash_table_unref(this->audioFiles);
@@ -99,14 +118,22 @@ void LoadHandler::setPdfReplacement(fs::path filepath, bool attachToDocument) {
     this->pdfReplacementAttach = attachToDocument;
 }
 
+void LoadHandler::setPdfDocumentPool(XojPdfDocumentPool* pool) { this->doc.setPdfDocumentPool(pool); }
+
 auto LoadHandler::openFile(fs::path const& filepath) -> bool {
     this->filepath = filepath;
+    // A remote file is read from a local copy, fetched at once
+    this->localFilepath = RemoteFile::getLocalCopy(filepath, this->lastError);
+    if (this->localFilepath.empty()) {
+        return false;
+    }
+
     int zipError = 0;
-    this->zipFp = zip_open(filepath.u8string().c_str(), ZIP_RDONLY, &zipError);
+    this->zipFp = zip_open(this->localFilepath.u8string().c_str(), ZIP_RDONLY, &zipError);
 
     // Check if the file is actually an old XOPP-File and open it
     if (!this->zipFp && zipError == ZIP_ER_NOZIP) {
-        this->gzFp = GzUtil::openPath(filepath, "r");
+        this->gzIn = std::make_unique<GzInputStream>(this->localFilepath);
         this->isGzFile = true;
     }
 
@@ -162,7 +189,7 @@ auto LoadHandler::openFile(fs::path const& filepath) -> bool {
     }
 
     // Fail if neither utility could open the file
-    if (!this->zipFp && !this->gzFp) {
+    if (!this->zipFp && !(this->gzIn && this->gzIn->isOpen())) {
         this->lastError = FS(_F("Could not open file: \"{1}\"") % filepath.u8string());
         return false;
     }
@@ -171,7 +198,9 @@ auto LoadHandler::openFile(fs::path const& filepath) -> bool {
 
 auto LoadHandler::closeFile() -> bool {
     if (this->isGzFile) {
-        return static_cast<bool>(gzclose(this->gzFp));
+        bool ok = this->gzIn->getLastError().empty();
+        this->gzIn.reset();
+        return ok;
     }
 
     g_assert(this->zipContentFile != nullptr);
@@ -182,10 +211,8 @@ auto LoadHandler::closeFile() -> bool {
 
 auto LoadHandler::readContentFile(char* buffer, zip_uint64_t len) -> zip_int64_t {
     if (this->isGzFile) {
-        if (gzeof(this->gzFp)) {
-            return -1;
-        }
-        return gzread(this->gzFp, buffer, static_cast<unsigned int>(len));
+        int64_t lengthRead = this->gzIn->read(buffer, len);
+        return lengthRead > 0 ? lengthRead : -1;
     }
 
     g_assert(this->zipContentFile != nullptr);
@@ -197,24 +224,19 @@ auto LoadHandler::readContentFile(char* buffer, zip_uint64_t len) -> zip_int64_t
     return -1;
 }
 
-auto LoadHandler::parseXml() -> bool {
-    const GMarkupParser parser = {LoadHandler::parserStartElement, LoadHandler::parserEndElement,
-                                  LoadHandler::parserText, nullptr, nullptr};
-    this->error = nullptr;
+auto LoadHandler::parseContent(GMarkupParseContext* context, size_t stopAt, bool& ended) -> bool {
     gboolean valid = true;
-
-    this->pos = PARSER_POS_NOT_STARTED;
-    this->creator = "Unknown";
-    this->fileVersion = 1;
-
-    GMarkupParseContext* context =
-            g_markup_parse_context_new(&parser, static_cast<GMarkupParseFlags>(0), this, nullptr);
-
     zip_int64_t len = 0;
     do {
-        char buffer[1024];
+        char buffer[64 * 1024];
         len = readContentFile(buffer, sizeof(buffer));
         if (len > 0) {
+            if (this->skipLayers) {
+                this->pageOffsets.feed(buffer, static_cast<size_t>(len));
+            }
+            if (this->keepContent) {
+                this->content.append(buffer, static_cast<size_t>(len));
+            }
             valid = g_markup_parse_context_parse(context, buffer, len, &error);
         }
 
@@ -223,8 +245,45 @@ auto LoadHandler::parseXml() -> bool {
             valid = false;
             break;
         }
+        if (len >= 0 && getCompletePageCount() >= stopAt) {
+            ended = false;
+            return true;
+        }
     } while (len >= 0 && valid && !error);
 
+    ended = true;
+    return valid;
+}
+
+auto LoadHandler::getCompletePageCount() const -> size_t {
+    return std::min(this->pageOffsets.getPages().size(), this->pages.size());
+}
+
+auto LoadHandler::parseXml() -> bool {
+    const GMarkupParser parser = {LoadHandler::parserStartElement, LoadHandler::parserEndElement,
+                                  LoadHandler::parserText, nullptr, nullptr};
+    this->error = nullptr;
+
+    this->pos = PARSER_POS_NOT_STARTED;
+    this->creator = "Unknown";
+    this->fileVersion = 1;
+
+    GMarkupParseContext* context =
+            g_markup_parse_context_new(&parser, static_cast<GMarkupParseFlags>(0), this, nullptr);
+
+    // The pages are only located in the content stream when their layers are loaded lazily
+    bool progressive = this->firstPageCount > 0 && this->lazyPageLoading;
+    bool ended = true;
+    gboolean valid = parseContent(context, progressive ? this->firstPageCount : SIZE_MAX, ended);
+    if (valid && !ended) {
+        // The other pages are parsed by loadRemainingPages()
+        this->remainingContext = context;
+        this->publishedPages = getCompletePageCount();
+        this->doc.addPages(pages.begin(), pages.begin() + static_cast<std::ptrdiff_t>(this->publishedPages));
+        doc.setCreateBackupOnSave(true);
+        return true;
+    }
+
     if (valid) {
         valid = g_markup_parse_context_end_parse(context, &error);
     } else {
@@ -239,8 +298,16 @@ auto LoadHandler::parseXml() -> bool {
 
     g_markup_parse_context_free(context);
 
+    if (valid && this->pos == PASER_POS_FINISHED && this->isGzFile) {
+        auto journal = AutosaveJournal::getJournalPath(this->filepath);
+        if (fs::exists(journal)) {
+            replayJournal(journal);
+        }
+    }
+
     // Add all parsed pages to the document
     this->doc.addPages(pages.begin(), pages.end());
+    this->publishedPages = this->pages.size();
 
     if (this->pos != PASER_POS_FINISHED && this->lastError.empty()) {
         lastError = _("Document is not complete (maybe the end is cut off?)");
@@ -256,32 +323,247 @@ auto LoadHandler::parseXml() -> bool {
     return valid;
 }
 
+void LoadHandler::replayJournal(const fs::path& journalPath) {
+    auto journal = std::make_unique<GzInputStream>(journalPath);
+    if (!journal->isOpen()) {
+        g_warning("%s", FC(_F("Could not open the autosave journal \"{1}\"") % journalPath.u8string()));
+        return;
+    }
+
+    const GMarkupParser parser = {LoadHandler::parserStartElement, LoadHandler::parserEndElement,
+                                  LoadHandler::parserText, nullptr, nullptr};
+    this->error = nullptr;
+
+    Tag rootTag = this->endRootTag;
+    std::swap(this->gzIn, journal);
+    this->replayingJournal = true;
+    this->journalPages = this->pages;
+    this->pos = PARSER_POS_NOT_STARTED;
+
+    GMarkupParseContext* context =
+            g_markup_parse_context_new(&parser, static_cast<GMarkupParseFlags>(0), this, nullptr);
+
+    // The records are appended one after the other, give them a root element
+    gboolean valid = g_markup_parse_context_parse(context, "<journal>", -1, &error);
+    while (valid) {
+        char buffer[64 * 1024];
+        zip_int64_t len = readContentFile(buffer, sizeof(buffer));
+        if (len <= 0) {
+            break;
+        }
+        valid = g_markup_parse_context_parse(context, buffer, len, &error);
+    }
+    if (valid) {
+        valid = g_markup_parse_context_parse(context, "</journal>", -1, &error) &&
+                g_markup_parse_context_end_parse(context, &error);
+    }
+    g_markup_parse_context_free(context);
+
+    if (!valid) {
+        // A record cut off by a crash: the pages are those of the last complete record
+        g_warning("%s", FC(_F("The autosave journal \"{1}\" is incomplete: {2}") % journalPath.u8string() %
+                           (error ? error->message : _("Unknown parser error"))));
+    }
+    if (error) {
+        g_error_free(error);
+        error = nullptr;
+    }
+
+    std::swap(this->gzIn, journal);
+    this->replayingJournal = false;
+    this->journalPages.clear();
+    this->endRootTag = rootTag;
+    this->pos = PASER_POS_FINISHED;
+}
+
+void LoadHandler::applyJournalRecord() {
+    std::vector<PageRef> ordered;
+    ordered.reserve(this->journalOrder.size());
+    for (size_t id: this->journalOrder) {
+        if (id >= this->journalPages.size() || !this->journalPages[id]) {
+            error("%s", FC(_F("Unknown page in the autosave journal: {1}") % id));
+            return;
+        }
+        ordered.push_back(this->journalPages[id]);
+    }
+    this->pages = std::move(ordered);
+}
+
+auto LoadHandler::parsePageXml(PageOffsetScanner::Range range, const std::string* content) -> bool {
+    const GMarkupParser parser = {LoadHandler::parserStartElement, LoadHandler::parserEndElement,
+                                  LoadHandler::parserText, nullptr, nullptr};
+    this->error = nullptr;
+    gboolean valid = true;
+
+    // The page element is parsed as if it was read in the root element
+    this->pos = PARSER_POS_STARTED;
+
+    GMarkupParseContext* context =
+            g_markup_parse_context_new(&parser, static_cast<GMarkupParseFlags>(0), this, nullptr);
+
+    if (content) {
+        size_t end = std::min(range.second, content->size());
+        if (range.first < end) {
+            valid = g_markup_parse_context_parse(context, content->data() + range.first, end - range.first, &error);
+        }
+    }
+
+    // The content stream is compressed and cannot be seeked: skip everything before the page
+    size_t offset = 0;
+    while (!content && offset < range.second && valid) {
+        char buffer[64 * 1024];
+        zip_int64_t len = readContentFile(buffer, sizeof(buffer));
+        if (len <= 0) {
+            break;
+        }
+        size_t chunkStart = offset;
+        offset += static_cast<size_t>(len);
+        if (offset <= range.first) {
+            continue;
+        }
+
+        size_t from = range.first > chunkStart ? range.first - chunkStart : 0;
+        size_t to = std::min(static_cast<size_t>(len), range.second - chunkStart);
+        valid = g_markup_parse_context_parse(context, buffer + from, to - from, &error);
+    }
+
+    if (valid) {
+        valid = g_markup_parse_context_end_parse(context, &error);
+    }
+    g_markup_parse_context_free(context);
+
+    if (error != nullptr) {
+        this->lastError = FS(_F("XML Parser error: {1}") % error->message);
+        g_error_free(error);
+        return false;
+    }
+    if (this->pos != PARSER_POS_STARTED || this->pages.size() != 1) {
+        this->lastError = _("Document is not complete (maybe the end is cut off?)");
+        return false;
+    }
+    return valid;
+}
+
+void LoadHandler::attachLayerLoaders() {
+    const auto& ranges = this->pageOffsets.getPages();
+    if (!this->layerSource) {
+        this->layerSource = std::make_shared<const LazyPageLoader::Source>(this->localFilepath, this->fileVersion,
+                                                                           this->indexedLayout, this->audioFiles);
+    }
+    const auto& source = this->layerSource;
+
+    // Only the published pages, the others are still parsed by loadRemainingPages()
+    for (; this->attachedLazyPages < this->lazyPages.size(); this->attachedLazyPages++) {
+        size_t i = this->lazyPages[this->attachedLazyPages];
+        if (i >= this->publishedPages) {
+            break;
+        }
+        if (this->layerEntries[i].empty()) {
+            this->pages[i]->setLayerLoader(std::make_shared<LazyPageLoader>(source, ranges[i]));
+        } else {
+            this->pages[i]->setLayerLoader(std::make_shared<LazyPageLoader>(source, this->layerEntries[i]));
+        }
+    }
+}
+
+auto LoadHandler::loadSkippedLayers() -> bool {
+    const auto& ranges = this->pageOffsets.getPages();
+    LazyPageLoader::Source source(this->localFilepath, this->fileVersion, this->indexedLayout, this->audioFiles);
+
+    // Each page is parsed by a handler of its own, into its own page: only the audio files and the file are shared
+    std::vector<std::string> errors(this->lazyPages.size());
+    xoj::util::ParallelLoop loop(this->parallelPageLoading ? 0 : 1);
+    loop.run(this->lazyPages.size(), [&](size_t n) {
+        size_t i = this->lazyPages[n];
+        LoadHandler handler;
+        bool loaded = this->layerEntries[i].empty() ?
+                              handler.loadPageLayers(source, ranges[i], "", *this->pages[i], &this->content) :
+                              handler.loadPageLayers(source, {0, SIZE_MAX}, this->layerEntries[i], *this->pages[i]);
+        if (!loaded) {
+            errors[n] = handler.getLastError();
+        }
+    });
+
+    for (const std::string& error: errors) {
+        if (!error.empty()) {
+            this->lastError = error;
+            return false;
+        }
+    }
+    return true;
+}
+
+auto LoadHandler::loadPageLayers(const LazyPageLoader::Source& source, PageOffsetScanner::Range range,
+                                 const std::string& entry, XojPage& page, const std::string* content) -> bool {
+    initAttributes();
+    g_hash_table_unref(this->audioFiles);
+    this->audioFiles = g_hash_table_ref(source.audioFiles);
+
+    if (!openFile(source.filepath)) {
+        return false;
+    }
+    this->xournalFilepath = source.filepath;
+    this->fileVersion = source.fileVersion;
+    this->indexedLayout = source.indexedLayout;
+    this->layersOnly = true;
+
+    if (!entry.empty()) {
+        zip_file_t* entryFile = this->zipFp ? zip_fopen(this->zipFp, entry.c_str(), 0) : nullptr;
+        if (!entryFile) {
+            this->lastError = FS(_F("Failed to open {1} in zip archive: \"{2}\"") % entry %
+                                 (this->zipFp ? zip_error_strerror(zip_get_error(this->zipFp)) : ""));
+            closeFile();
+            return false;
+        }
+        zip_fclose(this->zipContentFile);
+        this->zipContentFile = entryFile;
+    }
+
+    bool valid = parsePageXml(range, content);
+    closeFile();
+    if (!valid) {
+        return false;
+    }
+
+    XojPage& parsed = *this->pages.front();
+    page.layer = std::move(parsed.layer);
+    parsed.layer.clear();
+    page.currentLayer = parsed.currentLayer;
+    return true;
+}
+
 void LoadHandler::parseStart() {
-    if (strcmp(elementName, "xournal") == 0) {
-        endRootTag = "xournal";
+    if (tag == Tag::XOURNAL) {
+        endRootTag = Tag::XOURNAL;
 
         // Read the document version
-        const char* version = LoadHandlerHelper::getAttrib("version", true, this);
+        const char* version = LoadHandlerHelper::getAttrib(Attribute::VERSION, true, this);
         if (version) {
             this->creator = "Xournal ";
             this->creator += version;
         }
 
-        const char* fileversion = LoadHandlerHelper::getAttrib("fileversion", true, this);
+        const char* fileversion = LoadHandlerHelper::getAttrib(Attribute::FILEVERSION, true, this);
         if (fileversion) {
             this->fileVersion = atoi(fileversion);
         }
-        const char* creator = LoadHandlerHelper::getAttrib("creator", true, this);
+        const char* creator = LoadHandlerHelper::getAttrib(Attribute::CREATOR, true, this);
         if (creator) {
             this->creator = creator;
         }
 
+        const char* layout = LoadHandlerHelper::getAttrib(Attribute::LAYOUT, true, this);
+        this->indexedLayout = layout != nullptr && strcmp(layout, "indexed") == 0;
+
         this->pos = PARSER_POS_STARTED;
-    } else if (strcmp(elementName, "MrWriter") == 0) {
-        endRootTag = "MrWriter";
+    } else if (this->replayingJournal && tag == Tag::JOURNAL) {
+        endRootTag = Tag::JOURNAL;
+        this->pos = PARSER_POS_STARTED;
+    } else if (tag == Tag::MRWRITER) {
+        endRootTag = Tag::MRWRITER;
 
         // Read the document version
-        const char* version = LoadHandlerHelper::getAttrib("version", true, this);
+        const char* version = LoadHandlerHelper::getAttrib(Attribute::VERSION, true, this);
         if (version) {
             this->creator = "MrWriter ";
             this->creator += version;
@@ -297,20 +579,49 @@ void LoadHandler::parseStart() {
 }
 
 void LoadHandler::parseContents() {
-    if (strcmp(elementName, "page") == 0) {
+    if (tag == Tag::PAGE) {
         this->pos = PARSER_POS_IN_PAGE;
 
-        double width = LoadHandlerHelper::getAttribDouble("width", this);
-        double height = LoadHandlerHelper::getAttribDouble("height", this);
+        double width = LoadHandlerHelper::getAttribDouble(Attribute::WIDTH, this);
+        double height = LoadHandlerHelper::getAttribDouble(Attribute::HEIGHT, this);
 
         this->page = std::make_unique<XojPage>(width, height);
 
+        if (this->replayingJournal) {
+            // The page replaces the one with the same id, its place is given by the order of the record
+            size_t id = LoadHandlerHelper::getAttribSizeT(Attribute::ID, this);
+            if (id >= this->journalPages.size()) {
+                this->journalPages.resize(id + 1);
+            }
+            this->journalPages[id] = this->page;
+            return;
+        }
+
         pages.push_back(this->page);
-    } else if (strcmp(elementName, "audio") == 0) {
+
+        // In the indexed layout, the layers are in an entry of their own
+        const char* layers = LoadHandlerHelper::getAttrib(Attribute::LAYERS, true, this);
+        this->layerEntries.emplace_back(layers ? layers : "");
+        if (layers) {
+            this->lazyPages.push_back(pages.size() - 1);
+        }
+    } else if (this->replayingJournal && tag == Tag::DELTA) {
+        this->journalOrder.clear();
+        const char* order = LoadHandlerHelper::getAttrib(Attribute::ORDER, false, this);
+        while (order && *order) {
+            gchar* endptr = nullptr;
+            size_t id = static_cast<size_t>(g_ascii_strtoull(order, &endptr, 10));
+            if (endptr == order) {
+                break;
+            }
+            this->journalOrder.push_back(id);
+            order = endptr;
+        }
+    } else if (tag == Tag::AUDIO) {
         this->parseAudio();
-    } else if (strcmp(elementName, "title") == 0) {
+    } else if (tag == Tag::TITLE) {
         // Ignore this tag, it says nothing...
-    } else if (strcmp(elementName, "preview") == 0) {
+    } else if (tag == Tag::PREVIEW) {
         // Ignore this tag, we don't need a preview
     } else {
         g_warning("%s", FC(_F("Unexpected tag in document: \"{1}\"") % elementName));
@@ -319,12 +630,12 @@ void LoadHandler::parseContents() {
 
 void LoadHandler::parseBgSolid() {
     PageType bg;
-    const char* style = LoadHandlerHelper::getAttrib("style", false, this);
+    const char* style = LoadHandlerHelper::getAttrib(Attribute::STYLE, false, this);
     if (style != nullptr) {
         bg.format = PageTypeHandler::getPageTypeFormatForString(style);
     }
 
-    const char* config = LoadHandlerHelper::getAttrib("config", true, this);
+    const char* config = LoadHandlerHelper::getAttrib(Attribute::CONFIG, true, this);
     if (config != nullptr) {
         bg.config = config;
     }
@@ -334,15 +645,15 @@ void LoadHandler::parseBgSolid() {
     Color color = LoadHandlerHelper::parseBackgroundColor(this);
     this->page->setBackgroundColor(color);
 
-    const char* name = LoadHandlerHelper::getAttrib("name", true, this);
+    const char* name = LoadHandlerHelper::getAttrib(Attribute::NAME, true, this);
     if (name != nullptr) {
         this->page->setBackgroundName(name);
     }
 }
 
 void LoadHandler::parseBgPixmap() {
-    const char* domain = LoadHandlerHelper::getAttrib("domain", false, this);
-    const fs::path filepath(LoadHandlerHelper::getAttrib("filename", false, this));
+    const char* domain = LoadHandlerHelper::getAttrib(Attribute::FILE_DOMAIN, false, this);
+    const fs::path filepath(LoadHandlerHelper::getAttrib(Attribute::FILENAME, false, this));
     // in case of a cloned background image, filename is a string representation of the page number from which the image
     // is cloned
 
@@ -396,7 +707,8 @@ void LoadHandler::parseBgPixmap() {
         if (endptr == filename.c_str()) {
             error("%s", FC(_F("Could not read page number for cloned background image: {1}.") % filepath.string()));
         }
-        PageRef p = pages[nr];
+        PageRef p = this->replayingJournal ? (nr < this->journalPages.size() ? this->journalPages[nr] : nullptr) :
+                                             pages[nr];
 
         if (p) {
             this->page->setBackgroundImage(p->getBackgroundImage());
@@ -409,7 +721,7 @@ void LoadHandler::parseBgPixmap() {
 }
 
 void LoadHandler::parseBgPdf() {
-    int pageno = LoadHandlerHelper::getAttribInt("pageno", this);
+    int pageno = LoadHandlerHelper::getAttribInt(Attribute::PAGENO, this);
     bool attachToDocument = false;
     fs::path pdfFilename;
 
@@ -418,9 +730,9 @@ void LoadHandler::parseBgPdf() {
     if (!this->pdfFilenameParsed) {
 
         if (this->pdfReplacementFilepath.empty()) {
-            const char* domain = LoadHandlerHelper::getAttrib("domain", false, this);
+            const char* domain = LoadHandlerHelper::getAttrib(Attribute::FILE_DOMAIN, false, this);
             {
-                const char* sFilename = LoadHandlerHelper::getAttrib("filename", false, this);
+                const char* sFilename = LoadHandlerHelper::getAttrib(Attribute::FILENAME, false, this);
                 if (sFilename == nullptr) {
                     error("PDF Filename missing!");
                     return;
@@ -438,15 +750,28 @@ void LoadHandler::parseBgPdf() {
                 if (this->isGzFile) {
                     pdfFilename = (fs::path{xournalFilepath} += ".") += pdfFilename;
                 } else {
-                    auto readResult = readZipAttachment(pdfFilename);
-                    if (!readResult) {
+                    // The PDF is mapped from a temporary file instead of being held on the heap: the attached
+                    // backgrounds may be as large as the available memory
+                    auto extracted = extractZipAttachment(pdfFilename);
+                    if (!extracted) {
                         return;
                     }
-                    std::string& pdfBytes = readResult.value();
-                    doc.readPdf(pdfFilename, false, attachToDocument, pdfBytes.data(), pdfBytes.size());
+                    doc.readMappedPdf(pdfFilename, *extracted, attachToDocument);
+                    // The mapping remains valid. Where a mapped file can not be removed, the OS cleans it up.
+                    std::error_code ec;
+                    fs::remove(*extracted, ec);
 
                     if (!doc.getLastErrorMsg().empty()) {
                         error("%s", FC(_F("Error reading PDF: {1}") % doc.getLastErrorMsg()));
+                    } else {
+                        // Saving this file again copies the entry instead of writing the PDF
+                        zip_stat_t stat;
+                        zip_stat_init(&stat);
+                        if (zip_stat(this->zipFp, pdfFilename.u8string().c_str(), 0, &stat) == 0 &&
+                            (stat.valid & ZIP_STAT_CRC) && (stat.valid & ZIP_STAT_SIZE)) {
+                            doc.setPdfAttachmentSource(
+                                    {this->xournalFilepath, pdfFilename.u8string(), stat.crc, stat.size});
+                        }
                     }
 
                     this->pdfFilenameParsed = true;
@@ -477,13 +802,26 @@ void LoadHandler::parseBgPdf() {
 }
 
 void LoadHandler::parsePage() {
-    if (!strcmp(elementName, "background")) {
-        const char* name = LoadHandlerHelper::getAttrib("name", true, this);
+    if (this->layersOnly && tag == Tag::BACKGROUND) {
+        // The background was read with the page header
+        return;
+    }
+
+    if (this->skipLayers && tag == Tag::LAYER) {
+        this->pos = PARSER_POS_IN_SKIPPED_LAYER;
+        if (this->lazyPages.empty() || this->lazyPages.back() != this->pages.size() - 1) {
+            this->lazyPages.push_back(this->pages.size() - 1);
+        }
+        return;
+    }
+
+    if (tag == Tag::BACKGROUND) {
+        const char* name = LoadHandlerHelper::getAttrib(Attribute::NAME, true, this);
         if (name != nullptr) {
             this->page->setBackgroundName(name);
         }
 
-        const char* type = LoadHandlerHelper::getAttrib("type", false, this);
+        const char* type = LoadHandlerHelper::getAttrib(Attribute::TYPE, false, this);
 
         if (strcmp("solid", type) == 0) {
             parseBgSolid();
@@ -499,11 +837,11 @@ void LoadHandler::parsePage() {
         } else {
             error("%s", FC(_F("Unknown background type: {1}") % type));
         }
-    } else if (!strcmp(elementName, "layer")) {
+    } else if (tag == Tag::LAYER) {
         this->pos = PARSER_POS_IN_LAYER;
         this->layer = new Layer();
 
-        const char* name = LoadHandlerHelper::getAttrib("name", true, this);
+        const char* name = LoadHandlerHelper::getAttrib(Attribute::NAME, true, this);
         if (name != nullptr) {
             this->layer->setName(name);
         }
@@ -515,8 +853,9 @@ void LoadHandler::parsePage() {
 void LoadHandler::parseStroke() {
     this->stroke = new Stroke();
     this->layer->addElement(this->stroke);
+    this->encodedStroke = false;
 
-    const char* width = LoadHandlerHelper::getAttrib("width", false, this);
+    const char* width = LoadHandlerHelper::getAttrib(Attribute::WIDTH, false, this);
 
     char* endPtr = nullptr;
     stroke->setWidth(g_ascii_strtod(width, &endPtr));
@@ -525,34 +864,38 @@ void LoadHandler::parseStroke() {
         return;
     }
 
+    if (const char* encoding = LoadHandlerHelper::getAttrib(Attribute::ENCODING, true, this)) {
+        if (strcmp(encoding, StrokeEncoding::NAME) != 0) {
+            error("%s", FC(_F("Unknown encoding of the points of a stroke: {1}") % encoding));
+            return;
+        }
+        // The pressure is encoded with the points
+        this->encodedStroke = true;
+    }
+
     // MrWriter writes pressures as separate field
-    const char* pressure = LoadHandlerHelper::getAttrib("pressures", true, this);
+    const char* pressure = LoadHandlerHelper::getAttrib(Attribute::PRESSURES, true, this);
     if (pressure == nullptr) {
         // Xournal / Xournal++ uses the width field
         pressure = endPtr;
     }
 
-    while (*pressure != 0) {
-        char* tmpptr = nullptr;
-        double val = g_ascii_strtod(pressure, &tmpptr);
-        if (tmpptr == pressure) {
-            break;
-        }
-        pressure = tmpptr;
-        this->pressureBuffer.push_back(val);
-    }
+    const char* pressureEnd = pressure + strlen(pressure);
+    this->pressureBuffer.reserve(LoadHandlerHelper::countTokens(pressure, pressureEnd));
+    double val = 0;
+    while (LoadHandlerHelper::parseNextDouble(pressure, pressureEnd, val)) { this->pressureBuffer.push_back(val); }
 
     Color color{0U};
-    const char* sColor = LoadHandlerHelper::getAttrib("color", false, this);
+    const char* sColor = LoadHandlerHelper::getAttrib(Attribute::COLOR, false, this);
     if (!LoadHandlerHelper::parseColor(sColor, color, this)) {
         return;
     }
     stroke->setColor(color);
 
     /** read stroke timestamps (xopp fileformat) */
-    const char* fn = LoadHandlerHelper::getAttrib("fn", true, this);
+    const char* fn = LoadHandlerHelper::getAttrib(Attribute::FN, true, this);
     if (fn != nullptr && strlen(fn) > 0) {
-        if (this->isGzFile) {
+        if (this->isGzFile || this->indexedLayout) {
             stroke->setAudioFilename(fn);
         } else {
             auto tempFile = getTempFileForPath(fn);
@@ -565,22 +908,22 @@ void LoadHandler::parseStroke() {
 
     if (this->fileVersion < 4) {
         int ts = 0;
-        if (LoadHandlerHelper::getAttribInt("ts", true, this, ts)) {
+        if (LoadHandlerHelper::getAttribInt(Attribute::TS, true, this, ts)) {
             stroke->setTimestamp(ts * 1000);
         }
     } else {
         size_t ts = 0;
-        if (LoadHandlerHelper::getAttribSizeT("ts", true, this, ts)) {
+        if (LoadHandlerHelper::getAttribSizeT(Attribute::TS, true, this, ts)) {
             stroke->setTimestamp(ts);
         }
     }
 
     int fill = -1;
-    if (LoadHandlerHelper::getAttribInt("fill", true, this, fill)) {
+    if (LoadHandlerHelper::getAttribInt(Attribute::FILL, true, this, fill)) {
         stroke->setFill(fill);
     }
 
-    const char* capStyleStr = LoadHandlerHelper::getAttrib("capStyle", true, this);
+    const char* capStyleStr = LoadHandlerHelper::getAttrib(Attribute::CAP_STYLE, true, this);
     if (capStyleStr != nullptr) {
         if (strcmp("butt", capStyleStr) == 0) {
             stroke->setStrokeCapStyle(StrokeCapStyle::BUTT);
@@ -593,12 +936,12 @@ void LoadHandler::parseStroke() {
         }
     }
 
-    const char* style = LoadHandlerHelper::getAttrib("style", true, this);
+    const char* style = LoadHandlerHelper::getAttrib(Attribute::STYLE, true, this);
     if (style != nullptr) {
         stroke->setLineStyle(StrokeStyle::parseStyle(style));
     }
 
-    const char* tool = LoadHandlerHelper::getAttrib("tool", false, this);
+    const char* tool = LoadHandlerHelper::getAttrib(Attribute::TOOL, false, this);
 
     if (strcmp("eraser", tool) == 0) {
         stroke->setToolType(STROKE_TOOL_ERASER);
@@ -627,10 +970,10 @@ void LoadHandler::parseText() {
     this->text = new Text();
     this->layer->addElement(this->text);
 
-    const char* sFont = LoadHandlerHelper::getAttrib("font", false, this);
-    double fontSize = LoadHandlerHelper::getAttribDouble("size", this);
-    double x = LoadHandlerHelper::getAttribDouble("x", this);
-    double y = LoadHandlerHelper::getAttribDouble("y", this);
+    const char* sFont = LoadHandlerHelper::getAttrib(Attribute::FONT, false, this);
+    double fontSize = LoadHandlerHelper::getAttribDouble(Attribute::SIZE, this);
+    double x = LoadHandlerHelper::getAttribDouble(Attribute::X, this);
+    double y = LoadHandlerHelper::getAttribDouble(Attribute::Y, this);
 
     this->text->setX(x);
     this->text->setY(y);
@@ -638,14 +981,14 @@ void LoadHandler::parseText() {
     XojFont& f = text->getFont();
     f.setName(sFont);
     f.setSize(fontSize);
-    const char* sColor = LoadHandlerHelper::getAttrib("color", false, this);
+    const char* sColor = LoadHandlerHelper::getAttrib(Attribute::COLOR, false, this);
     Color color{0U};
     LoadHandlerHelper::parseColor(sColor, color, this);
     text->setColor(color);
 
-    const char* fn = LoadHandlerHelper::getAttrib("fn", true, this);
+    const char* fn = LoadHandlerHelper::getAttrib(Attribute::FN, true, this);
     if (fn != nullptr && strlen(fn) > 0) {
-        if (this->isGzFile) {
+        if (this->isGzFile || this->indexedLayout) {
             text->setAudioFilename(fn);
         } else {
             auto tempFile = getTempFileForPath(fn);
@@ -656,16 +999,16 @@ void LoadHandler::parseText() {
     }
 
     size_t ts = 0;
-    if (LoadHandlerHelper::getAttribSizeT("ts", true, this, ts)) {
+    if (LoadHandlerHelper::getAttribSizeT(Attribute::TS, true, this, ts)) {
         text->setTimestamp(ts);
     }
 }
 
 void LoadHandler::parseImage() {
-    double left = LoadHandlerHelper::getAttribDouble("left", this);
-    double top = LoadHandlerHelper::getAttribDouble("top", this);
-    double right = LoadHandlerHelper::getAttribDouble("right", this);
-    double bottom = LoadHandlerHelper::getAttribDouble("bottom", this);
+    double left = LoadHandlerHelper::getAttribDouble(Attribute::LEFT, this);
+    double top = LoadHandlerHelper::getAttribDouble(Attribute::TOP, this);
+    double right = LoadHandlerHelper::getAttribDouble(Attribute::RIGHT, this);
+    double bottom = LoadHandlerHelper::getAttribDouble(Attribute::BOTTOM, this);
 
     g_assert(this->image == nullptr);
     this->image = new Image();
@@ -677,16 +1020,16 @@ void LoadHandler::parseImage() {
 }
 
 void LoadHandler::parseTexImage() {
-    double left = LoadHandlerHelper::getAttribDouble("left", this);
-    double top = LoadHandlerHelper::getAttribDouble("top", this);
-    double right = LoadHandlerHelper::getAttribDouble("right", this);
-    double bottom = LoadHandlerHelper::getAttribDouble("bottom", this);
+    double left = LoadHandlerHelper::getAttribDouble(Attribute::LEFT, this);
+    double top = LoadHandlerHelper::getAttribDouble(Attribute::TOP, this);
+    double right = LoadHandlerHelper::getAttribDouble(Attribute::RIGHT, this);
+    double bottom = LoadHandlerHelper::getAttribDouble(Attribute::BOTTOM, this);
 
-    const char* imText = LoadHandlerHelper::getAttrib("text", false, this);
-    const char* compatibilityTest = LoadHandlerHelper::getAttrib("texlength", true, this);
+    const char* imText = LoadHandlerHelper::getAttrib(Attribute::TEXT, false, this);
+    const char* compatibilityTest = LoadHandlerHelper::getAttrib(Attribute::TEXLENGTH, true, this);
     auto imTextLen = strlen(imText);
     if (compatibilityTest != nullptr) {
-        imTextLen = LoadHandlerHelper::getAttribSizeT("texlength", this);
+        imTextLen = LoadHandlerHelper::getAttribSizeT(Attribute::TEXLENGTH, this);
     }
 
     this->teximage = new TexImage();
@@ -704,7 +1047,7 @@ void LoadHandler::parseAttachment() {
         g_warning("Found attachment tag as child of a tag that should not have such a child (ignoring this tag)");
         return;
     }
-    const char* path = LoadHandlerHelper::getAttrib("path", false, this);
+    const char* path = LoadHandlerHelper::getAttrib(Attribute::PATH, false, this);
 
     auto readResult = readZipAttachment(path);
     if (!readResult) {
@@ -732,23 +1075,23 @@ void LoadHandler::parseLayer() {
      * Used for backwards compatibility
      * against xoj files with timestamps)
      **/
-    if (!strcmp(elementName, "timestamp")) {
-        loadedTimeStamp = LoadHandlerHelper::getAttribInt("ts", this);
-        loadedFilename = LoadHandlerHelper::getAttrib("fn", false, this);
+    if (tag == Tag::TIMESTAMP) {
+        loadedTimeStamp = LoadHandlerHelper::getAttribInt(Attribute::TS, this);
+        loadedFilename = LoadHandlerHelper::getAttrib(Attribute::FN, false, this);
     }
-    if (!strcmp(elementName, "stroke"))  // start of a stroke
+    if (tag == Tag::STROKE)  // start of a stroke
     {
         this->pos = PARSER_POS_IN_STROKE;
         parseStroke();
-    } else if (!strcmp(elementName, "text"))  // start of a text item
+    } else if (tag == Tag::TEXT)  // start of a text item
     {
         this->pos = PARSER_POS_IN_TEXT;
         parseText();
-    } else if (!strcmp(elementName, "image"))  // start of a image item
+    } else if (tag == Tag::IMAGE)  // start of a image item
     {
         this->pos = PARSER_POS_IN_IMAGE;
         parseImage();
-    } else if (!strcmp(elementName, "teximage"))  // start of a image item
+    } else if (tag == Tag::TEXIMAGE)  // start of a image item
     {
         this->pos = PARSER_POS_IN_TEXIMAGE;
         parseTexImage();
@@ -760,7 +1103,7 @@ void LoadHandler::parseLayer() {
  * The OS should take care of removing the file.
  */
 void LoadHandler::parseAudio() {
-    const char* filename = LoadHandlerHelper::getAttrib("fn", false, this);
+    const char* filename = LoadHandlerHelper::getAttrib(Attribute::FN, false, this);
 
     GFileIOStream* fileStream = nullptr;
     GFile* tmpFile = g_file_new_tmp("xournal_audio_XXXXXX.tmp", &fileStream, nullptr);
@@ -833,9 +1176,9 @@ void LoadHandler::parserStartElement(GMarkupParseContext* context, const gchar*
     if (*error) {
         return;
     }
-    handler->attributeNames = attributeNames;
-    handler->attributeValues = attributeValues;
     handler->elementName = elementName;
+    handler->tag = LoadHandlerHelper::lookupTag(elementName);
+    LoadHandlerHelper::decodeAttributes(attributeNames, attributeValues, handler->attributes);
 
     if (handler->pos == PARSER_POS_NOT_STARTED) {
         handler->parseStart();
@@ -847,14 +1190,13 @@ void LoadHandler::parserStartElement(GMarkupParseContext* context, const gchar*
         handler->parseLayer();
     } else if (handler->pos == PARSER_POS_IN_IMAGE || handler->pos == PARSER_POS_IN_TEXIMAGE) {
         // Handle the attachment node within the appropriate nodes
-        if (!strcmp(elementName, "attachment")) {
+        if (handler->tag == Tag::ATTACHMENT) {
             handler->parseAttachment();
         }
     }
 
-    handler->attributeNames = nullptr;
-    handler->attributeValues = nullptr;
     handler->elementName = nullptr;
+    handler->attributes.fill(nullptr);
 }
 
 void LoadHandler::parserEndElement(GMarkupParseContext* context, const gchar* elementName, gpointer userdata,
@@ -865,29 +1207,34 @@ void LoadHandler::parserEndElement(GMarkupParseContext* context, const gchar* el
     }
 
     auto* handler = static_cast<LoadHandler*>(userdata);
-    if (handler->pos == PARSER_POS_STARTED && strcmp(elementName, handler->endRootTag) == 0) {
+    const Tag tag = LoadHandlerHelper::lookupTag(elementName);
+    if (handler->pos == PARSER_POS_STARTED && tag == handler->endRootTag) {
         handler->pos = PASER_POS_FINISHED;
-    } else if (handler->pos == PARSER_POS_IN_PAGE && strcmp(elementName, "page") == 0) {
+    } else if (handler->pos == PARSER_POS_STARTED && handler->replayingJournal && tag == Tag::DELTA) {
+        handler->applyJournalRecord();
+    } else if (handler->pos == PARSER_POS_IN_PAGE && tag == Tag::PAGE) {
         handler->pos = PARSER_POS_STARTED;
         handler->page = nullptr;
-    } else if (handler->pos == PARSER_POS_IN_LAYER && strcmp(elementName, "layer") == 0) {
+    } else if (handler->pos == PARSER_POS_IN_SKIPPED_LAYER && tag == Tag::LAYER) {
+        handler->pos = PARSER_POS_IN_PAGE;
+    } else if (handler->pos == PARSER_POS_IN_LAYER && tag == Tag::LAYER) {
         handler->pos = PARSER_POS_IN_PAGE;
         handler->layer = nullptr;
-    } else if (handler->pos == PARSER_POS_IN_LAYER && strcmp(elementName, "timestamp") == 0) {
+    } else if (handler->pos == PARSER_POS_IN_LAYER && tag == Tag::TIMESTAMP) {
         /** Used for backwards compatibility against xoj files with timestamps) */
         handler->pos = PARSER_POS_IN_LAYER;
         handler->stroke = nullptr;
-    } else if (handler->pos == PARSER_POS_IN_STROKE && strcmp(elementName, "stroke") == 0) {
+    } else if (handler->pos == PARSER_POS_IN_STROKE && tag == Tag::STROKE) {
         handler->pos = PARSER_POS_IN_LAYER;
         handler->stroke = nullptr;
-    } else if (handler->pos == PARSER_POS_IN_TEXT && strcmp(elementName, "text") == 0) {
+    } else if (handler->pos == PARSER_POS_IN_TEXT && tag == Tag::TEXT) {
         handler->pos = PARSER_POS_IN_LAYER;
         handler->text = nullptr;
-    } else if (handler->pos == PARSER_POS_IN_IMAGE && strcmp(elementName, "image") == 0) {
+    } else if (handler->pos == PARSER_POS_IN_IMAGE && tag == Tag::IMAGE) {
         g_assert(handler->image->getImage() != nullptr && "image can't be rendered");
         handler->pos = PARSER_POS_IN_LAYER;
         handler->image = nullptr;
-    } else if (handler->pos == PARSER_POS_IN_TEXIMAGE && strcmp(elementName, "teximage") == 0) {
+    } else if (handler->pos == PARSER_POS_IN_TEXIMAGE && tag == Tag::TEXIMAGE) {
         handler->pos = PARSER_POS_IN_LAYER;
         handler->teximage = nullptr;
     }
@@ -901,31 +1248,39 @@ void LoadHandler::parserText(GMarkupParseContext* context, const gchar* text, gs
     }
 
     auto* handler = static_cast<LoadHandler*>(userdata);
-    if (handler->pos == PARSER_POS_IN_STROKE) {
-        const char* ptr = text;
-        int n = 0;
+    if (handler->pos == PARSER_POS_IN_STROKE && handler->encodedStroke) {
+        handler->pressureBuffer.clear();
 
-        bool xRead = false;
-        double x = 0;
+        std::vector<Point> points;
+        if (!StrokeEncoding::decode(text, textLen, points)) {
+            error2(*error, "%s", _("The points of a stroke are corrupted"));
+            return;
+        }
+        size_t count = points.size();
+        handler->stroke->setPointVector(std::move(points));
 
-        while (textLen > 0) {
-            double tmp = g_ascii_strtod(text, const_cast<char**>(&ptr));
-            if (ptr == text) {
-                break;
-            }
-            textLen -= (ptr - text);
-            text = ptr;
-            n++;
+        if (count < 2) {
+            error2(*error, "%s", FC(_F("Wrong count of points ({1})") % (2 * count)));
+            return;
+        }
+    } else if (handler->pos == PARSER_POS_IN_STROKE) {
+        const char* end = text + textLen;
+
+        // Count the coordinates first, so that the points are allocated at once
+        std::vector<Point> points;
+        points.reserve(LoadHandlerHelper::countTokens(text, end) / 2);
 
-            if (!xRead) {
-                xRead = true;
-                x = tmp;
+        int n = 0;
+        double x = 0;
+        double value = 0;
+        while (LoadHandlerHelper::parseNextDouble(text, end, value)) {
+            if (n++ & 1) {
+                points.emplace_back(x, value);
             } else {
-                xRead = false;
-                handler->stroke->addPoint(Point(x, tmp));
+                x = value;
             }
         }
-        handler->stroke->freeUnusedPointItems();
+        handler->stroke->setPointVector(std::move(points));
 
         if (n < 4 || (n & 1)) {
             error2(*error, "%s", FC(_F("Wrong count of points ({1})") % n));
@@ -975,7 +1330,10 @@ void LoadHandler::readImage(const gchar* base64string, gsize base64stringLen) {
         return;
     }
 
-    this->image->setImage(parseBase64(const_cast<char*>(base64string), base64stringLen));
+    // Decoded on the worker of the ImageStore while the file is parsed
+    this->image->setImage(ImageStore::getAsync([base64 = std::string(base64string, base64stringLen)]() {
+        return ImageStore::Decoded{parseBase64(base64.data(), base64.length())};
+    }));
 }
 
 void LoadHandler::readTexImage(const gchar* base64string, gsize base64stringLen) {
@@ -990,6 +1348,10 @@ void LoadHandler::readTexImage(const gchar* base64string, gsize base64stringLen)
  * Document should not be freed, it will be freed with LoadHandler!
  */
 auto LoadHandler::loadDocument(fs::path const& filepath) -> Document* {
+    if (this->remainingContext) {
+        discardRemainingPages();
+        closeFile();
+    }
     initAttributes();
     doc.clearDocument();
 
@@ -1001,11 +1363,57 @@ auto LoadHandler::loadDocument(fs::path const& filepath) -> Document* {
 
     this->pdfFilenameParsed = false;
 
-    if (!parseXml()) {
+    // Without lazy loading, the layers are parsed once all the page headers are read, see loadSkippedLayers()
+    bool parallel = this->parallelPageLoading && !this->lazyPageLoading;
+    if (this->isGzFile && fs::exists(AutosaveJournal::getJournalPath(filepath))) {
+        // The pages of the journal replace those of the file, see replayJournal()
+        this->lazyPageLoading = false;
+        parallel = false;
+    }
+
+    this->skipLayers = this->lazyPageLoading || parallel;
+    this->keepContent = parallel;
+    bool parsed = parseXml();
+    this->keepContent = false;
+    if (!parsed) {
+        this->content = std::string();
         closeFile();
         return nullptr;
     }
 
+    bool inlinePages = std::any_of(this->lazyPages.begin(), this->lazyPages.end(),
+                                   [this](size_t i) { return this->layerEntries[i].empty(); });
+    // Stopped early, the last page may be incomplete
+    size_t pageCount = this->pages.size() - (this->remainingContext && getCompletePageCount() < this->pages.size());
+    bool located = !inlinePages || this->pageOffsets.getPages().size() == pageCount;
+    if (!located) {
+        // Should not happen with the files we write, but the document can still be read at once
+        g_warning("LoadHandler::loadDocument: could not locate the pages of \"%s\", loading all of them",
+                  filepath.u8string().c_str());
+        this->content = std::string();
+        discardRemainingPages();
+        closeFile();
+        bool lazy = this->lazyPageLoading;
+        bool wasParallel = this->parallelPageLoading;
+        this->lazyPageLoading = false;
+        this->parallelPageLoading = false;
+        Document* loaded = loadDocument(filepath);
+        this->lazyPageLoading = lazy;
+        this->parallelPageLoading = wasParallel;
+        return loaded;
+    }
+
+    if (this->lazyPageLoading) {
+        attachLayerLoaders();
+    } else if (!this->lazyPages.empty()) {
+        bool loaded = loadSkippedLayers();
+        this->content = std::string();
+        if (!loaded) {
+            closeFile();
+            return nullptr;
+        }
+    }
+
     if (fileVersion == 1) {
         // This is a Xournal document, not a Xournal++
         // Even if the new fileextension is .xopp, allow to
@@ -1018,11 +1426,65 @@ auto LoadHandler::loadDocument(fs::path const& filepath) -> Document* {
         doc.setFilepath(filepath);
     }
 
-    closeFile();
+    if (!this->remainingContext) {
+        closeFile();
+    }
 
     return &this->doc;
 }
 
+void LoadHandler::setFirstPageCount(size_t count) { this->firstPageCount = count; }
+
+auto LoadHandler::hasRemainingPages() const -> bool { return this->remainingContext != nullptr; }
+
+auto LoadHandler::loadRemainingPages(const std::function<void(std::vector<PageRef>, const Document*)>& addPages,
+                                     const std::atomic<bool>& cancelled) -> bool {
+    if (!this->remainingContext) {
+        return true;
+    }
+
+    bool ended = false;
+    bool valid = true;
+    while (!ended && valid && !cancelled) {
+        bool pdfParsed = this->pdfFilenameParsed;
+        valid = parseContent(this->remainingContext, getCompletePageCount() + PAGE_BATCH_SIZE, ended);
+
+        size_t published = this->publishedPages;
+        this->publishedPages = ended && valid ? this->pages.size() : getCompletePageCount();
+        attachLayerLoaders();
+        if (this->publishedPages > published) {
+            // The PDF is read with the first page that has it as background: it may be one of the new pages
+            const Document* pdf = pdfParsed != this->pdfFilenameParsed ? &this->doc : nullptr;
+            addPages(std::vector<PageRef>(this->pages.begin() + static_cast<std::ptrdiff_t>(published),
+                                          this->pages.begin() + static_cast<std::ptrdiff_t>(this->publishedPages)),
+                     pdf);
+        }
+    }
+
+    if (valid && ended) {
+        valid = g_markup_parse_context_end_parse(this->remainingContext, &error);
+        if (valid && this->pos != PASER_POS_FINISHED) {
+            this->lastError = _("Document is not complete (maybe the end is cut off?)");
+            valid = false;
+        }
+    }
+    if (error) {
+        this->lastError = FS(_F("XML Parser error: {1}") % error->message);
+        g_error_free(error);
+        error = nullptr;
+    }
+    discardRemainingPages();
+    closeFile();
+    return valid || cancelled;
+}
+
+void LoadHandler::discardRemainingPages() {
+    if (this->remainingContext) {
+        g_markup_parse_context_free(this->remainingContext);
+        this->remainingContext = nullptr;
+    }
+}
+
 auto LoadHandler::readZipAttachment(fs::path const& filename) -> std::optional<std::string> {
     zip_stat_t attachmentFileStat;
     const int statStatus = zip_stat(this->zipFp, filename.u8string().c_str(), 0, &attachmentFileStat);
@@ -1065,6 +1527,54 @@ auto LoadHandler::readZipAttachment(fs::path const& filename) -> std::optional<s
     return {std::move(data)};
 }
 
+auto LoadHandler::extractZipAttachment(fs::path const& filename) -> std::optional<fs::path> {
+    xoj::util::Profiler::Scope scope("extract attachment", "load");
+
+    zip_file_t* attachmentFile = zip_fopen(this->zipFp, filename.u8string().c_str(), 0);
+    if (!attachmentFile) {
+        error("%s", FC(_F("Could not open attachment: {1}. Error message: {2}") % filename.string() %
+                       zip_error_strerror(zip_get_error(this->zipFp))));
+        return {};
+    }
+
+    GFileIOStream* fileStream = nullptr;
+    GFile* tmpFile = g_file_new_tmp("xournal_pdf_XXXXXX.pdf", &fileStream, nullptr);
+    if (!tmpFile) {
+        zip_fclose(attachmentFile);
+        error("%s", FC(_F("Could not open attachment: {1}. Error message: {2}") % filename.string() %
+                       "Unable to create a temporary file"));
+        return {};
+    }
+    GOutputStream* outputStream = g_io_stream_get_output_stream(G_IO_STREAM(fileStream));
+
+    std::vector<char> buffer(1 << 16);
+    bool written = true;
+    zip_int64_t read = 0;
+    while ((read = zip_fread(attachmentFile, buffer.data(), buffer.size())) > 0) {
+        if (!g_output_stream_write_all(outputStream, buffer.data(), static_cast<gsize>(read), nullptr, nullptr,
+                                       nullptr)) {
+            written = false;
+            break;
+        }
+    }
+    zip_fclose(attachmentFile);
+    g_io_stream_close(G_IO_STREAM(fileStream), nullptr, nullptr);
+    g_object_unref(fileStream);
+
+    char* path = g_file_get_path(tmpFile);
+    fs::path tmpPath = path ? fs::u8path(path) : fs::path();
+    g_free(path);
+    g_object_unref(tmpFile);
+
+    if (read < 0 || !written) {
+        std::error_code ec;
+        fs::remove(tmpPath, ec);
+        error("%s", FC(_F("Could not open attachment: {1}. Error message: Could not read file") % filename.string()));
+        return {};
+    }
+    return tmpPath;
+}
+
 auto LoadHandler::getTempFileForPath(fs::path const& filename) -> fs::path {
     gpointer tmpFilename = g_hash_table_lookup(this->audioFiles, filename.u8string().c_str());
     if (tmpFilename) {
@@ -1076,3 +1586,7 @@ auto LoadHandler::getTempFileForPath(fs::path const& filename) -> fs::path {
 }
 
 auto LoadHandler::getFileVersion() const -> int { return this->fileVersion; }
+
+void LoadHandler::setLazyPageLoading(bool lazy) { this->lazyPageLoading = lazy; }
+
+void LoadHandler::setParallelPageLoading(bool parallel) { this->parallelPageLoading = parallel; }
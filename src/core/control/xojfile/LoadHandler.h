@@ -11,12 +11,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <regex>
 #include <string>
 #include <vector>
 
 #include <zip.h>
-#include <zlib.h>
 
 #include "model/Document.h"
 #include "model/Image.h"
@@ -24,18 +26,21 @@
 #include "model/TexImage.h"
 #include "model/Text.h"
 
+#include "LazyPageLoader.h"
 #include "LoadHandlerHelper.h"
 
+class GzInputStream;
 
 enum ParserPosition {
-    PARSER_POS_NOT_STARTED = 1,  // Waiting for opening <xounal> tag
-    PARSER_POS_STARTED,          // Waiting for Metainfo or contents like <page>
-    PARSER_POS_IN_PAGE,          // Starting page tag read
-    PARSER_POS_IN_LAYER,         // Starting layer tag read
-    PARSER_POS_IN_STROKE,        // Starting layer tag read
-    PARSER_POS_IN_TEXT,          // Starting text tag read
-    PARSER_POS_IN_IMAGE,         // Starting image tag read
-    PARSER_POS_IN_TEXIMAGE,      // Starting latex tag read
+    PARSER_POS_NOT_STARTED = 1,   // Waiting for opening <xounal> tag
+    PARSER_POS_STARTED,           // Waiting for Metainfo or contents like <page>
+    PARSER_POS_IN_PAGE,           // Starting page tag read
+    PARSER_POS_IN_LAYER,          // Starting layer tag read
+    PARSER_POS_IN_STROKE,         // Starting layer tag read
+    PARSER_POS_IN_TEXT,           // Starting text tag read
+    PARSER_POS_IN_IMAGE,          // Starting image tag read
+    PARSER_POS_IN_TEXIMAGE,       // Starting latex tag read
+    PARSER_POS_IN_SKIPPED_LAYER,  // Layer tag read, its content is loaded later
 
     PASER_POS_FINISHED  // Document is parsed
 };
@@ -55,9 +60,66 @@ public:
     void removePdfBackground();
     void setPdfReplacement(fs::path filepath, bool attachToDocument);
 
+    /**
+     * Share the PDF backgrounds with the other documents loaded with the pool
+     */
+    void setPdfDocumentPool(XojPdfDocumentPool* pool);
+
     /** @return The version of the loaded file */
     int getFileVersion() const;
 
+    /**
+     * Only read the page headers and backgrounds when loading a document, the layers of a page are parsed when they
+     * are first accessed (see XojPage::setLayerLoader)
+     */
+    void setLazyPageLoading(bool lazy);
+
+    /**
+     * When the layers are not loaded lazily, parse them on several threads once all the page headers are read (on by
+     * default)
+     */
+    void setParallelPageLoading(bool parallel);
+
+    /**
+     * Stop parsing the document once this number of pages is parsed: loadDocument() returns the first pages, and
+     * loadRemainingPages() parses the others. Only with lazy page loading. 0 (the default) to parse the whole document.
+     */
+    void setFirstPageCount(size_t count);
+
+    /**
+     * @return Whether the document returned by loadDocument() lacks the pages after the first ones
+     */
+    bool hasRemainingPages() const;
+
+    /**
+     * Parse the pages after those returned by loadDocument(). May run on another thread than the one using the
+     * document: only the pages passed to addPages, and then the handler's own document, are shared with it.
+     *
+     * @param addPages Called with each batch of consecutive pages, on the calling thread. The document is that of the
+     * handler if it read the PDF background for these pages, nullptr otherwise.
+     * @param cancelled Checked between the batches
+     * @return false on error, see getLastError()
+     */
+    bool loadRemainingPages(const std::function<void(std::vector<PageRef>, const Document*)>& addPages,
+                            const std::atomic<bool>& cancelled);
+
+    /**
+     * Number of pages parsed at least by loadRemainingPages() before each call to addPages
+     */
+    static constexpr size_t PAGE_BATCH_SIZE = 100;
+
+    /**
+     * Parse the layers of a page element of a document, and add them to the page
+     *
+     * @param source The document
+     * @param range The byte range of the page element in the content stream of the document
+     * @param entry The archive entry with the page element, if it is not in the content stream
+     * @param content The decompressed content stream, if it was already read: the range is parsed from it
+     * @return false on error, see getLastError()
+     */
+    bool loadPageLayers(const LazyPageLoader::Source& source, PageOffsetScanner::Range range,
+                        const std::string& entry, XojPage& page, const std::string* content = nullptr);
+
 private:
     void parseStart();
     void parseContents();
@@ -79,6 +141,37 @@ private:
     bool openFile(fs::path const& filepath);
     bool parseXml();
 
+    /**
+     * Feed the content stream to the parser until its end, or until the number of complete pages reaches stopAt
+     * @param ended Set to whether the end of the stream was reached
+     * @return false on a parser error
+     */
+    bool parseContent(GMarkupParseContext* context, size_t stopAt, bool& ended);
+
+    /**
+     * @return The number of pages whose element was parsed to its end
+     */
+    size_t getCompletePageCount() const;
+
+    void discardRemainingPages();
+    bool parsePageXml(PageOffsetScanner::Range range, const std::string* content);
+
+    /**
+     * Apply the changes appended by the autosave since the file was written, see AutosaveJournal
+     */
+    void replayJournal(const fs::path& journalPath);
+    void applyJournalRecord();
+
+    /**
+     * Let the pages with skipped layers load them on first access, once the page elements are located in the file
+     */
+    void attachLayerLoaders();
+
+    /**
+     * Parse the skipped layers of all the pages, on several threads unless parallelPageLoading is off
+     */
+    bool loadSkippedLayers();
+
     static void parserText(GMarkupParseContext* context, const gchar* text, gsize textLen, gpointer userdata,
                            GError** error);
     static void parserEndElement(GMarkupParseContext* context, const gchar* elementName, gpointer userdata,
@@ -86,10 +179,6 @@ private:
     static void parserStartElement(GMarkupParseContext* context, const gchar* elementName, const gchar** attributeNames,
                                    const gchar** attributeValues, gpointer userdata, GError** error);
 
-    const char* getAttrib(const char* name, bool optional = false);
-    double getAttribDouble(const char* name);
-    int getAttribInt(const char* name);
-
     void parseBgSolid();
     void parseBgPixmap();
     void parseBgPdf();
@@ -107,6 +196,12 @@ private:
      */
     std::optional<std::string> readZipAttachment(fs::path const& filename);
 
+    /**
+     * Writes the zip attachment with the given file name to a temporary file, a chunk at a time, and returns its
+     * path, or nullopt if there is no such file or it can not be written.
+     */
+    std::optional<fs::path> extractZipAttachment(fs::path const& filename);
+
     fs::path getTempFileForPath(fs::path const& filename);
 
 private:
@@ -120,6 +215,11 @@ private:
 
     fs::path filepath;
 
+    /**
+     * The file read, a local copy of filepath if it is remote, see RemoteFile
+     */
+    fs::path localFilepath;
+
     bool pdfFilenameParsed;
 
     ParserPosition pos;
@@ -130,11 +230,68 @@ private:
 
     zip_t* zipFp;
     zip_file_t* zipContentFile;
-    gzFile gzFp;
+    std::unique_ptr<GzInputStream> gzIn;
     bool isGzFile = false;
 
+    bool lazyPageLoading = false;
+    bool parallelPageLoading = true;
+
+    /**
+     * The layers are skipped while parsing the document: loaded lazily, or by loadSkippedLayers()
+     */
+    bool skipLayers = false;
+
+    /**
+     * The decompressed content stream, kept while parsing the document for loadSkippedLayers()
+     */
+    bool keepContent = false;
+    std::string content;
+
+    /**
+     * Only the layers of the page are parsed, see loadPageLayers()
+     */
+    bool layersOnly = false;
+
+    /**
+     * The file uses the indexed layout, see IndexedSaveHandler
+     */
+    bool indexedLayout = false;
+
+    /**
+     * The pages whose layers were skipped, and the locations of all pages in the content stream
+     */
+    std::vector<size_t> lazyPages;
+    PageOffsetScanner pageOffsets;
+    std::shared_ptr<const LazyPageLoader::Source> layerSource;
+    size_t attachedLazyPages = 0;
+
+    /**
+     * When the parser stopped after the first pages: the parser of the others, and the number of pages in the document
+     * or passed to loadRemainingPages()'s callback
+     */
+    size_t firstPageCount = 0;
+    GMarkupParseContext* remainingContext = nullptr;
+    size_t publishedPages = 0;
+
+    /**
+     * For each page, the archive entry with its layers, empty if they are in the content stream
+     */
+    std::vector<std::string> layerEntries;
+
+    /**
+     * While the autosave journal is replayed: the pages by id, and the page order of the current record
+     */
+    bool replayingJournal = false;
+    std::vector<PageRef> journalPages;
+    std::vector<size_t> journalOrder;
+
     std::vector<double> pressureBuffer;
 
+    /**
+     * The points of the current stroke are written with StrokeEncoding
+     */
+    bool encodedStroke = false;
+
     std::vector<PageRef> pages;
     PageRef page;
     Layer* layer;
@@ -144,14 +301,17 @@ private:
     TexImage* teximage;
     GHashTable* audioFiles = nullptr;
 
-    const char* endRootTag = "xournal";
+    LoadHandlerHelper::Tag endRootTag = LoadHandlerHelper::Tag::XOURNAL;
 
     fs::path xournalFilepath;
 
     GError* error;
-    const gchar** attributeNames;
-    const gchar** attributeValues;
+    /**
+     * The current element, its attributes are decoded once when it starts
+     */
     const gchar* elementName;
+    LoadHandlerHelper::Tag tag = LoadHandlerHelper::Tag::UNKNOWN;
+    LoadHandlerHelper::Attributes attributes{};
 
     int loadedTimeStamp;
     std::string loadedFilename;
@@ -162,11 +322,13 @@ private:
     friend Color LoadHandlerHelper::parseBackgroundColor(LoadHandler* loadHandler);
     friend bool LoadHandlerHelper::parseColor(const char* text, Color& color, LoadHandler* loadHandler);
 
-    friend const char* LoadHandlerHelper::getAttrib(const char* name, bool optional, LoadHandler* loadHandler);
-    friend double LoadHandlerHelper::getAttribDouble(const char* name, LoadHandler* loadHandler);
-    friend int LoadHandlerHelper::getAttribInt(const char* name, LoadHandler* loadHandler);
-    friend bool LoadHandlerHelper::getAttribInt(const char* name, bool optional, LoadHandler* loadHandler, int& rValue);
-    friend size_t LoadHandlerHelper::getAttribSizeT(const char* name, LoadHandler* loadHandler);
-    friend bool LoadHandlerHelper::getAttribSizeT(const char* name, bool optional, LoadHandler* loadHandler,
-                                                  size_t& rValue);
+    friend const char* LoadHandlerHelper::getAttrib(LoadHandlerHelper::Attribute attribute, bool optional,
+                                                    LoadHandler* loadHandler);
+    friend double LoadHandlerHelper::getAttribDouble(LoadHandlerHelper::Attribute attribute, LoadHandler* loadHandler);
+    friend int LoadHandlerHelper::getAttribInt(LoadHandlerHelper::Attribute attribute, LoadHandler* loadHandler);
+    friend bool LoadHandlerHelper::getAttribInt(LoadHandlerHelper::Attribute attribute, bool optional,
+                                                LoadHandler* loadHandler, int& rValue);
+    friend size_t LoadHandlerHelper::getAttribSizeT(LoadHandlerHelper::Attribute attribute, LoadHandler* loadHandler);
+    friend bool LoadHandlerHelper::getAttribSizeT(LoadHandlerHelper::Attribute attribute, bool optional,
+                                                  LoadHandler* loadHandler, size_t& rValue);
 };
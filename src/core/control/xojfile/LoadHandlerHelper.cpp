@@ -10,6 +10,11 @@
  */
 #include "LoadHandlerHelper.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+
 #include "util/i18n.h"
 
 #include "LoadHandler.h"
@@ -19,8 +24,211 @@
         loadHandler->error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT, __VA_ARGS__); \
     }
 
+/**
+ * FNV-1a hash of a name. The tags and the attributes are recognized by a switch on it: the compiler rejects two known
+ * names with the same hash as duplicate cases, so it is a perfect hash of the known names.
+ */
+static constexpr auto hashName(const char* name) -> uint32_t {
+    uint32_t hash = 2166136261U;
+    for (; *name != '\0'; name++) { hash = (hash ^ static_cast<uint8_t>(*name)) * 16777619U; }
+    return hash;
+}
+
+// By Tag and by Attribute
+constexpr const char* TAG_NAMES[] = {"attachment", "audio", "background", "delta", "image", "journal", "layer", "MrWriter", "page", "preview", "stroke", "teximage", "text", "timestamp", "title", "xournal"};
+constexpr const char* ATTRIBUTE_NAMES[] = {"bottom", "capStyle", "color", "config", "creator", "domain", "encoding", "filename", "fileversion", "fill", "fn", "font", "height", "id", "layers", "layout", "left", "name", "order", "pageno", "path", "pressures", "right", "size", "style", "texlength", "text", "tool", "top", "ts", "type", "version", "width", "x", "y"};
+
+static_assert(std::size(TAG_NAMES) == static_cast<size_t>(LoadHandlerHelper::Tag::UNKNOWN));
+static_assert(std::size(ATTRIBUTE_NAMES) == static_cast<size_t>(LoadHandlerHelper::Attribute::UNKNOWN));
+
+auto LoadHandlerHelper::lookupTag(const char* name) -> Tag {
+    Tag tag = Tag::UNKNOWN;
+    switch (hashName(name)) {
+        case hashName("attachment"):
+            tag = Tag::ATTACHMENT;
+            break;
+        case hashName("audio"):
+            tag = Tag::AUDIO;
+            break;
+        case hashName("background"):
+            tag = Tag::BACKGROUND;
+            break;
+        case hashName("delta"):
+            tag = Tag::DELTA;
+            break;
+        case hashName("image"):
+            tag = Tag::IMAGE;
+            break;
+        case hashName("journal"):
+            tag = Tag::JOURNAL;
+            break;
+        case hashName("layer"):
+            tag = Tag::LAYER;
+            break;
+        case hashName("MrWriter"):
+            tag = Tag::MRWRITER;
+            break;
+        case hashName("page"):
+            tag = Tag::PAGE;
+            break;
+        case hashName("preview"):
+            tag = Tag::PREVIEW;
+            break;
+        case hashName("stroke"):
+            tag = Tag::STROKE;
+            break;
+        case hashName("teximage"):
+            tag = Tag::TEXIMAGE;
+            break;
+        case hashName("text"):
+            tag = Tag::TEXT;
+            break;
+        case hashName("timestamp"):
+            tag = Tag::TIMESTAMP;
+            break;
+        case hashName("title"):
+            tag = Tag::TITLE;
+            break;
+        case hashName("xournal"):
+            tag = Tag::XOURNAL;
+            break;
+    }
+    // An unknown name may have the hash of a known one
+    return tag != Tag::UNKNOWN && strcmp(name, TAG_NAMES[static_cast<size_t>(tag)]) == 0 ? tag : Tag::UNKNOWN;
+}
+
+auto LoadHandlerHelper::lookupAttribute(const char* name) -> Attribute {
+    Attribute attribute = Attribute::UNKNOWN;
+    switch (hashName(name)) {
+        case hashName("bottom"):
+            attribute = Attribute::BOTTOM;
+            break;
+        case hashName("capStyle"):
+            attribute = Attribute::CAP_STYLE;
+            break;
+        case hashName("color"):
+            attribute = Attribute::COLOR;
+            break;
+        case hashName("config"):
+            attribute = Attribute::CONFIG;
+            break;
+        case hashName("creator"):
+            attribute = Attribute::CREATOR;
+            break;
+        case hashName("domain"):
+            attribute = Attribute::FILE_DOMAIN;
+            break;
+        case hashName("encoding"):
+            attribute = Attribute::ENCODING;
+            break;
+        case hashName("filename"):
+            attribute = Attribute::FILENAME;
+            break;
+        case hashName("fileversion"):
+            attribute = Attribute::FILEVERSION;
+            break;
+        case hashName("fill"):
+            attribute = Attribute::FILL;
+            break;
+        case hashName("fn"):
+            attribute = Attribute::FN;
+            break;
+        case hashName("font"):
+            attribute = Attribute::FONT;
+            break;
+        case hashName("height"):
+            attribute = Attribute::HEIGHT;
+            break;
+        case hashName("id"):
+            attribute = Attribute::ID;
+            break;
+        case hashName("layers"):
+            attribute = Attribute::LAYERS;
+            break;
+        case hashName("layout"):
+            attribute = Attribute::LAYOUT;
+            break;
+        case hashName("left"):
+            attribute = Attribute::LEFT;
+            break;
+        case hashName("name"):
+            attribute = Attribute::NAME;
+            break;
+        case hashName("order"):
+            attribute = Attribute::ORDER;
+            break;
+        case hashName("pageno"):
+            attribute = Attribute::PAGENO;
+            break;
+        case hashName("path"):
+            attribute = Attribute::PATH;
+            break;
+        case hashName("pressures"):
+            attribute = Attribute::PRESSURES;
+            break;
+        case hashName("right"):
+            attribute = Attribute::RIGHT;
+            break;
+        case hashName("size"):
+            attribute = Attribute::SIZE;
+            break;
+        case hashName("style"):
+            attribute = Attribute::STYLE;
+            break;
+        case hashName("texlength"):
+            attribute = Attribute::TEXLENGTH;
+            break;
+        case hashName("text"):
+            attribute = Attribute::TEXT;
+            break;
+        case hashName("tool"):
+            attribute = Attribute::TOOL;
+            break;
+        case hashName("top"):
+            attribute = Attribute::TOP;
+            break;
+        case hashName("ts"):
+            attribute = Attribute::TS;
+            break;
+        case hashName("type"):
+            attribute = Attribute::TYPE;
+            break;
+        case hashName("version"):
+            attribute = Attribute::VERSION;
+            break;
+        case hashName("width"):
+            attribute = Attribute::WIDTH;
+            break;
+        case hashName("x"):
+            attribute = Attribute::X;
+            break;
+        case hashName("y"):
+            attribute = Attribute::Y;
+            break;
+    }
+    return attribute != Attribute::UNKNOWN && strcmp(name, getAttributeName(attribute)) == 0 ? attribute :
+                                                                                              Attribute::UNKNOWN;
+}
+
+auto LoadHandlerHelper::getAttributeName(Attribute attribute) -> const char* {
+    return attribute == Attribute::UNKNOWN ? "" : ATTRIBUTE_NAMES[static_cast<size_t>(attribute)];
+}
+
+void LoadHandlerHelper::decodeAttributes(const char** names, const char** values, Attributes& attributes) {
+    attributes.fill(nullptr);
+    for (; *names != nullptr; names++, values++) {
+        Attribute attribute = lookupAttribute(*names);
+        if (attribute != Attribute::UNKNOWN) {
+            attributes[static_cast<size_t>(attribute)] = *values;
+        }
+    }
+}
+
 struct PredefinedColor {
+    constexpr PredefinedColor(const char* name, Color rgb): name(name), hash(hashName(name)), rgb(rgb) {}
+
     const char* name;
+    const uint32_t hash;
     const Color rgb;
 };
 
@@ -31,7 +239,7 @@ constexpr PredefinedColor PREDEFINED_COLORS[] = {
         {"yellow", Color(0xffff00U)},     {"white", Color(0xffffffU)}};
 
 auto LoadHandlerHelper::parseBackgroundColor(LoadHandler* loadHandler) -> Color {
-    const char* sColor = LoadHandlerHelper::getAttrib("color", false, loadHandler);
+    const char* sColor = LoadHandlerHelper::getAttrib(Attribute::COLOR, false, loadHandler);
 
     Color color{0xffffffU};
     if (strcmp("blue", sColor) == 0) {
@@ -71,8 +279,10 @@ auto LoadHandlerHelper::parseColor(const char* text, Color& color, LoadHandler*
     }
 
 
+    // The Xournal files name the colors of all their strokes
+    const uint32_t hash = hashName(text);
     for (auto& i: PREDEFINED_COLORS) {
-        if (!strcmp(text, i.name)) {
+        if (i.hash == hash && !strcmp(text, i.name)) {
             color = i.rgb;
             return true;
         }
@@ -82,64 +292,54 @@ auto LoadHandlerHelper::parseColor(const char* text, Color& color, LoadHandler*
 }
 
 
-auto LoadHandlerHelper::getAttrib(const char* name, bool optional, LoadHandler* loadHandler) -> const char* {
-    const char** aName = loadHandler->attributeNames;
-    const char** aValue = loadHandler->attributeValues;
-
-    while (*aName != nullptr) {
-        if (!strcmp(*aName, name)) {
-            return *aValue;
-        }
-        aName++;
-        aValue++;
+auto LoadHandlerHelper::getAttrib(Attribute attribute, bool optional, LoadHandler* loadHandler) -> const char* {
+    const char* value = loadHandler->attributes[static_cast<size_t>(attribute)];
+    if (value == nullptr && !optional) {
+        g_warning("Parser: attribute %s not found!", getAttributeName(attribute));
     }
-
-    if (!optional) {
-        g_warning("Parser: attribute %s not found!", name);
-    }
-    return nullptr;
+    return value;
 }
 
-auto LoadHandlerHelper::getAttribDouble(const char* name, LoadHandler* loadHandler) -> double {
-    const char* attrib = getAttrib(name, false, loadHandler);
+auto LoadHandlerHelper::getAttribDouble(Attribute attribute, LoadHandler* loadHandler) -> double {
+    const char* attrib = getAttrib(attribute, false, loadHandler);
 
     if (attrib == nullptr) {
-        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as double, the value is nullptr") % name));
+        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as double, the value is nullptr") % getAttributeName(attribute)));
         return 0;
     }
 
     char* ptr = nullptr;
     double val = g_ascii_strtod(attrib, &ptr);
     if (ptr == attrib) {
-        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as double, the value is \"{2}\"") % name % attrib));
+        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as double, the value is \"{2}\"") % getAttributeName(attribute) % attrib));
     }
 
     return val;
 }
 
-auto LoadHandlerHelper::getAttribInt(const char* name, LoadHandler* loadHandler) -> int {
-    const char* attrib = getAttrib(name, false, loadHandler);
+auto LoadHandlerHelper::getAttribInt(Attribute attribute, LoadHandler* loadHandler) -> int {
+    const char* attrib = getAttrib(attribute, false, loadHandler);
 
     if (attrib == nullptr) {
-        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as int, the value is nullptr") % name));
+        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as int, the value is nullptr") % getAttributeName(attribute)));
         return 0;
     }
 
     char* ptr = nullptr;
     int val = strtol(attrib, &ptr, 10);
     if (ptr == attrib) {
-        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as int, the value is \"{2}\"") % name % attrib));
+        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as int, the value is \"{2}\"") % getAttributeName(attribute) % attrib));
     }
 
     return val;
 }
 
-auto LoadHandlerHelper::getAttribInt(const char* name, bool optional, LoadHandler* loadHandler, int& rValue) -> bool {
-    const char* attrib = getAttrib(name, optional, loadHandler);
+auto LoadHandlerHelper::getAttribInt(Attribute attribute, bool optional, LoadHandler* loadHandler, int& rValue) -> bool {
+    const char* attrib = getAttrib(attribute, optional, loadHandler);
 
     if (attrib == nullptr) {
         if (!optional) {
-            g_warning("Parser: attribute %s not found!", name);
+            g_warning("Parser: attribute %s not found!", getAttributeName(attribute));
         }
         return false;
     }
@@ -147,7 +347,7 @@ auto LoadHandlerHelper::getAttribInt(const char* name, bool optional, LoadHandle
     char* ptr = nullptr;
     int val = strtol(attrib, &ptr, 10);
     if (ptr == attrib) {
-        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as int, the value is \"{2}\"") % name % attrib));
+        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as int, the value is \"{2}\"") % getAttributeName(attribute) % attrib));
     }
 
     rValue = val;
@@ -155,30 +355,30 @@ auto LoadHandlerHelper::getAttribInt(const char* name, bool optional, LoadHandle
     return true;
 }
 
-auto LoadHandlerHelper::getAttribSizeT(const char* name, LoadHandler* loadHandler) -> size_t {
-    const char* attrib = getAttrib(name, false, loadHandler);
+auto LoadHandlerHelper::getAttribSizeT(Attribute attribute, LoadHandler* loadHandler) -> size_t {
+    const char* attrib = getAttrib(attribute, false, loadHandler);
 
     if (attrib == nullptr) {
-        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as size_t, the value is nullptr") % name));
+        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as size_t, the value is nullptr") % getAttributeName(attribute)));
         return 0;
     }
 
     char* ptr = nullptr;
     size_t val = g_ascii_strtoull(attrib, &ptr, 10);
     if (ptr == attrib) {
-        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as size_t, the value is \"{2}\"") % name % attrib));
+        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as size_t, the value is \"{2}\"") % getAttributeName(attribute) % attrib));
     }
 
     return val;
 }
 
-auto LoadHandlerHelper::getAttribSizeT(const char* name, bool optional, LoadHandler* loadHandler, size_t& rValue)
+auto LoadHandlerHelper::getAttribSizeT(Attribute attribute, bool optional, LoadHandler* loadHandler, size_t& rValue)
         -> bool {
-    const char* attrib = getAttrib(name, optional, loadHandler);
+    const char* attrib = getAttrib(attribute, optional, loadHandler);
 
     if (attrib == nullptr) {
         if (!optional) {
-            g_warning("Parser: attribute %s not found!", name);
+            g_warning("Parser: attribute %s not found!", getAttributeName(attribute));
         }
         return false;
     }
@@ -186,10 +386,47 @@ auto LoadHandlerHelper::getAttribSizeT(const char* name, bool optional, LoadHand
     char* ptr = nullptr;
     size_t val = strtoull(attrib, &ptr, 10);
     if (ptr == attrib) {
-        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as size_t, the value is \"{2}\"") % name % attrib));
+        error("%s", FC(_F("Attribute \"{1}\" could not be parsed as size_t, the value is \"{2}\"") % getAttributeName(attribute) % attrib));
     }
 
     rValue = val;
 
     return true;
 }
+
+auto LoadHandlerHelper::countTokens(const char* text, const char* end) -> size_t {
+    size_t count = 0;
+    bool inToken = false;
+    for (; text < end; text++) {
+        bool space = g_ascii_isspace(*text);
+        if (!space && !inToken) {
+            count++;
+        }
+        inToken = !space;
+    }
+    return count;
+}
+
+auto LoadHandlerHelper::parseNextDouble(const char*& text, const char* end, double& value) -> bool {
+    while (text < end && g_ascii_isspace(*text)) {
+        text++;
+    }
+    if (text >= end) {
+        return false;
+    }
+
+    auto [ptr, ec] = std::from_chars(text, end, value);
+    if (ec == std::errc() && (ptr == end || g_ascii_isspace(*ptr))) {
+        text = ptr;
+        return true;
+    }
+
+    // Not a plain decimal number (e.g. a leading '+', or out of range): use the lenient glib parser
+    char* endPtr = nullptr;
+    value = g_ascii_strtod(text, &endPtr);
+    if (endPtr == text) {
+        return false;
+    }
+    text = std::min<const char*>(endPtr, end);
+    return true;
+}
@@ -11,6 +11,10 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
 #include <glib.h>
 
 #include "util/Color.h"
@@ -18,13 +22,116 @@
 class LoadHandler;
 
 namespace LoadHandlerHelper {
+/**
+ * The tags known to the parser, recognized once per element by lookupTag()
+ */
+enum class Tag : uint8_t {
+    ATTACHMENT,
+    AUDIO,
+    BACKGROUND,
+    DELTA,
+    IMAGE,
+    JOURNAL,
+    LAYER,
+    MRWRITER,
+    PAGE,
+    PREVIEW,
+    STROKE,
+    TEXIMAGE,
+    TEXT,
+    TIMESTAMP,
+    TITLE,
+    XOURNAL,
+
+    UNKNOWN
+};
+
+/**
+ * The attributes read by the parser. The attributes of an element are decoded in a single pass when it starts (see
+ * decodeAttributes()), the getAttrib functions then read them by index.
+ */
+enum class Attribute : uint8_t {
+    BOTTOM,
+    CAP_STYLE,
+    COLOR,
+    CONFIG,
+    CREATOR,
+    FILE_DOMAIN,  // "domain", not to clash with the macro of the older math.h
+    ENCODING,
+    FILENAME,
+    FILEVERSION,
+    FILL,
+    FN,
+    FONT,
+    HEIGHT,
+    ID,
+    LAYERS,
+    LAYOUT,
+    LEFT,
+    NAME,
+    ORDER,
+    PAGENO,
+    PATH,
+    PRESSURES,
+    RIGHT,
+    SIZE,
+    STYLE,
+    TEXLENGTH,
+    TEXT,
+    TOOL,
+    TOP,
+    TS,
+    TYPE,
+    VERSION,
+    WIDTH,
+    X,
+    Y,
+
+    UNKNOWN
+};
+
+/**
+ * The values of the attributes of the current element by Attribute, nullptr if not set
+ */
+using Attributes = std::array<const char*, static_cast<size_t>(Attribute::UNKNOWN)>;
+
+/**
+ * @return The tag, Tag::UNKNOWN if the parser does not know it
+ */
+Tag lookupTag(const char* name);
+
+/**
+ * @return The attribute, Attribute::UNKNOWN if the parser does not read it
+ */
+Attribute lookupAttribute(const char* name);
+const char* getAttributeName(Attribute attribute);
+
+/**
+ * Sets the attributes to the values of the null terminated names and values of an element, the unknown ones are
+ * ignored
+ */
+void decodeAttributes(const char** names, const char** values, Attributes& attributes);
+
 Color parseBackgroundColor(LoadHandler* loadHandler);
 bool parseColor(const char* text, Color& color, LoadHandler* loadHandler);
 
-const char* getAttrib(const char* name, bool optional, LoadHandler* loadHandler);
-double getAttribDouble(const char* name, LoadHandler* loadHandler);
-int getAttribInt(const char* name, LoadHandler* loadHandler);
-bool getAttribInt(const char* name, bool optional, LoadHandler* loadHandler, int& rValue);
-size_t getAttribSizeT(const char* name, LoadHandler* loadHandler);
-bool getAttribSizeT(const char* name, bool optional, LoadHandler* loadHandler, size_t& rValue);
+const char* getAttrib(Attribute attribute, bool optional, LoadHandler* loadHandler);
+double getAttribDouble(Attribute attribute, LoadHandler* loadHandler);
+int getAttribInt(Attribute attribute, LoadHandler* loadHandler);
+bool getAttribInt(Attribute attribute, bool optional, LoadHandler* loadHandler, int& rValue);
+size_t getAttribSizeT(Attribute attribute, LoadHandler* loadHandler);
+bool getAttribSizeT(Attribute attribute, bool optional, LoadHandler* loadHandler, size_t& rValue);
+
+/**
+ * Count the whitespace separated tokens of [text, end), used to reserve memory before parsing a list of numbers
+ */
+size_t countTokens(const char* text, const char* end);
+
+/**
+ * Parse the next number of a whitespace separated list, and advance text past it.
+ * The text has to be null terminated (at end or later).
+ *
+ * @return false if there is no number left
+ */
+bool parseNextDouble(const char*& text, const char* end, double& value);
 };  // namespace LoadHandlerHelper
@@ -0,0 +1,184 @@
+#include "RemoteFile.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "control/jobs/ProgressListener.h"
+#include "util/PathUtil.h"
+#include "util/i18n.h"
+
+struct LocalCopy {
+    fs::path copy;
+    fs::file_time_type time;
+};
+
+/**
+ * The local copies of the remote files, by remote file, and those of their previous versions
+ */
+static std::mutex localCopiesMutex;
+static std::map<fs::path, LocalCopy> localCopies;
+static std::vector<fs::path> previousCopies;
+
+/**
+ * @return A new empty folder in the subfolder of the cache
+ */
+static auto createCacheFolder(const char* subfolder) -> fs::path {
+    std::string folder = (Util::getCacheSubfolder(subfolder) / "XXXXXX").u8string();
+    if (g_mkdtemp(folder.data()) == nullptr) {
+        return {};
+    }
+    return fs::u8path(folder);
+}
+
+static auto blockCount(const fs::path& file) -> size_t {
+    std::error_code ec;
+    auto size = fs::file_size(file, ec);
+    return ec ? 1 : static_cast<size_t>(size / RemoteFile::BUFFER_SIZE) + 1;
+}
+
+/**
+ * Copies the file, adding the number of blocks written to blocks
+ */
+static auto copyBlocks(const fs::path& from, const fs::path& to, ProgressListener* listener, GCancellable* cancellable,
+                       std::string& error, size_t& blocks) -> bool {
+    GFile* source = Util::toGFile(from);
+    GFile* target = Util::toGFile(to);
+    GError* err = nullptr;
+
+    GFileInputStream* in = g_file_read(source, cancellable, &err);
+    // Written to a temporary file by GIO, which replaces the target once closed
+    GFileOutputStream* out =
+            in ? g_file_replace(target, nullptr, false, G_FILE_CREATE_NONE, cancellable, &err) : nullptr;
+
+    bool copied = out != nullptr;
+    if (copied) {
+        std::vector<char> buffer(RemoteFile::BUFFER_SIZE);
+        gsize read = buffer.size();
+        while (copied && read == buffer.size()) {
+            copied = g_input_stream_read_all(G_INPUT_STREAM(in), buffer.data(), buffer.size(), &read, cancellable,
+                                             &err) &&
+                     g_output_stream_write_all(G_OUTPUT_STREAM(out), buffer.data(), read, nullptr, cancellable, &err);
+            if (copied && listener) {
+                listener->setCurrentState(static_cast<int>(++blocks));
+            }
+        }
+
+        if (copied) {
+            copied = g_output_stream_close(G_OUTPUT_STREAM(out), cancellable, &err);
+        } else {
+            // Closed while cancelled, the stream keeps the target
+            GCancellable* abort = g_cancellable_new();
+            g_cancellable_cancel(abort);
+            g_output_stream_close(G_OUTPUT_STREAM(out), abort, nullptr);
+            g_object_unref(abort);
+        }
+        g_object_unref(out);
+    }
+    if (in) {
+        g_object_unref(in);
+    }
+
+    if (err) {
+        error = FS(_F("Could not copy \"{1}\" to \"{2}\": {3}") % from.u8string() % to.u8string() % err->message);
+        g_error_free(err);
+    }
+    g_object_unref(source);
+    g_object_unref(target);
+    return copied;
+}
+
+auto RemoteFile::isRemote(const fs::path& file) -> bool {
+    // Not yet written on a "Save as"
+    std::error_code ec;
+    GFile* f = Util::toGFile(fs::exists(file, ec) ? file : file.parent_path());
+    GFileInfo* info = g_file_query_filesystem_info(f, G_FILE_ATTRIBUTE_FILESYSTEM_REMOTE, nullptr, nullptr);
+    bool remote = info != nullptr && g_file_info_get_attribute_boolean(info, G_FILE_ATTRIBUTE_FILESYSTEM_REMOTE);
+    if (info) {
+        g_object_unref(info);
+    }
+    g_object_unref(f);
+    return remote;
+}
+
+auto RemoteFile::getLocalCopy(const fs::path& file, std::string& error) -> fs::path {
+    if (!isRemote(file)) {
+        return file;
+    }
+
+    std::error_code ec;
+    auto time = fs::last_write_time(file, ec);
+    if (ec) {
+        error = FS(_F("Could not open file: \"{1}\"") % file.u8string());
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock(localCopiesMutex);
+    auto it = localCopies.find(file);
+    if (it != localCopies.end() && it->second.time == time && fs::exists(it->second.copy, ec)) {
+        return it->second.copy;
+    }
+
+    // The previous version may still be read by the pages of an open document: it is kept until the end
+    fs::path folder = createCacheFolder("remote");
+    if (folder.empty()) {
+        error = FS(_F("Could not create a local copy of \"{1}\"") % file.u8string());
+        return {};
+    }
+    fs::path copy = folder / file.filename();
+    size_t blocks = 0;
+    if (!copyBlocks(file, copy, nullptr, nullptr, error, blocks)) {
+        fs::remove_all(folder, ec);
+        return {};
+    }
+    if (it != localCopies.end()) {
+        previousCopies.push_back(it->second.copy);
+    }
+    localCopies[file] = {copy, time};
+    return copy;
+}
+
+void RemoteFile::removeLocalCopies() {
+    std::lock_guard<std::mutex> lock(localCopiesMutex);
+    for (const auto& [file, local]: localCopies) { previousCopies.push_back(local.copy); }
+    for (const fs::path& copy: previousCopies) {
+        std::error_code ec;
+        fs::remove_all(copy.parent_path(), ec);
+    }
+    localCopies.clear();
+    previousCopies.clear();
+}
+
+auto RemoteFile::createStagingFolder() -> fs::path { return createCacheFolder("upload"); }
+
+auto RemoteFile::upload(const fs::path& staged, const fs::path& target, ProgressListener* listener,
+                        GCancellable* cancellable, std::string& error) -> bool {
+    const fs::path folder = staged.parent_path();
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (const auto& entry: fs::directory_iterator(folder, ec)) {
+        if (entry.path() != staged) {
+            files.push_back(entry.path());
+        }
+    }
+    // The attachments first: the document is complete once it is replaced
+    files.push_back(staged);
+
+    if (listener) {
+        size_t total = 0;
+        for (const fs::path& file: files) { total += blockCount(file); }
+        listener->setMaximumState(static_cast<int>(total));
+    }
+
+    bool uploaded = true;
+    size_t blocks = 0;
+    for (const fs::path& file: files) {
+        const fs::path to = file == staged ? target : target.parent_path() / file.filename();
+        if (!copyBlocks(file, to, listener, cancellable, error, blocks)) {
+            uploaded = false;
+            break;
+        }
+    }
+    fs::remove_all(folder, ec);
+    return uploaded;
+}
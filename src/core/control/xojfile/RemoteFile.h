@@ -0,0 +1,70 @@
+/*
+ * Xournal++
+ *
+ * Reads and writes the files on remote mounts through local copies
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <gio/gio.h>
+
+#include "filesystem.h"
+
+class ProgressListener;
+
+/**
+ * @brief The files on a remote file system (SMB, NFS, the GVFS mounts...) are only accessed with large sequential reads
+ * and writes through GIO
+ *
+ * A remote document is opened from a local copy, fetched at once by getLocalCopy() and kept until the end of the
+ * session: the lazily loaded pages are read from it. A remote document is saved into a staging folder, see
+ * createStagingFolder(), whose files are then uploaded by upload(), usually in the background by an UploadJob.
+ *
+ * Thread safe.
+ */
+class RemoteFile {
+public:
+    /**
+     * @return true if the file, or its folder if it does not exist yet, is on a remote file system
+     */
+    static bool isRemote(const fs::path& file);
+
+    /**
+     * @return The file if it is local, else a copy of its current version in the cache. Empty on a failure.
+     */
+    static fs::path getLocalCopy(const fs::path& file, std::string& error);
+
+    /**
+     * Removes the local copies, once the documents read from them are closed
+     */
+    static void removeLocalCopies();
+
+    /**
+     * @return A new empty folder in the cache to save a remote document to. Empty on a failure.
+     */
+    static fs::path createStagingFolder();
+
+    /**
+     * Uploads the files saved into a staging folder next to the target, the file named like the target last, then
+     * removes the folder. The files are copied by blocks of BUFFER_SIZE bytes, each target is only replaced once its
+     * new content is completely written.
+     * @param staged The file in the staging folder which replaces the target
+     * @param listener The progress, in blocks
+     * @return false on a failure or if cancelled, with the error
+     */
+    static bool upload(const fs::path& staged, const fs::path& target, ProgressListener* listener,
+                       GCancellable* cancellable, std::string& error);
+
+    /**
+     * The size of the reads and writes, large enough to amortize the round trips of the remote file systems
+     */
+    static constexpr size_t BUFFER_SIZE = 1024 * 1024;
+};
@@ -22,6 +22,14 @@
 #include "util/PathUtil.h"
 #include "util/i18n.h"
 
+#include "LazyPageLoader.h"
+#include "StrokeEncoding.h"
+
+/**
+ * The last file format version without binary strokes
+ */
+constexpr int TEXT_STROKES_FILE_VERSION = 4;
+
 SaveHandler::SaveHandler() {
     this->firstPdfPageVisited = false;
     this->attachBgId = 1;
@@ -35,6 +43,7 @@ void SaveHandler::prepareSave(Document* doc) {
 
     this->firstPdfPageVisited = false;
     this->attachBgId = 1;
+    this->attachedPdfFilepath.clear();
 
     root.reset(new XmlNode("xournal"));
 
@@ -58,9 +67,13 @@ void SaveHandler::prepareSave(Document* doc) {
     }
 }
 
+void SaveHandler::setBinaryStrokes(bool binaryStrokes) { this->binaryStrokes = binaryStrokes; }
+
 void SaveHandler::writeHeader() {
+    // Files without binary strokes can still be opened by older versions without a warning
+    this->fileVersion = this->binaryStrokes ? FILE_FORMAT_VERSION : TEXT_STROKES_FILE_VERSION;
     this->root->setAttrib("creator", PROJECT_STRING);
-    this->root->setAttrib("fileversion", FILE_FORMAT_VERSION);
+    this->root->setAttrib("fileversion", this->fileVersion);
     this->root->addChild(new XmlTextNode("title", std::string{"Xournal++ document - see "} + PROJECT_URL));
 }
 
@@ -97,16 +110,14 @@ void SaveHandler::visitStroke(XmlPointNode* stroke, Stroke* s) {
 
     stroke->setAttrib("color", getColorStr(s->getColor(), alpha).c_str());
 
-    int pointCount = s->getPointCount();
-
-    for (int i = 0; i < pointCount; i++) { stroke->addPoint(s->getPoint(i)); }
-
-    if (s->hasPressure()) {
-        auto* values = new double[pointCount + 1];
-        values[0] = s->getWidth();
-        for (int i = 0; i < pointCount; i++) { values[i + 1] = s->getPoint(i).z; }
+    // The points are written from the stroke when the file is written
+    stroke->setPoints(s->getPointVector());
 
-        stroke->setAttrib("width", values, pointCount);
+    if (this->binaryStrokes && StrokeEncoding::canEncode(s->getPointVector(), s->hasPressure())) {
+        stroke->setAttrib("width", s->getWidth());
+        stroke->setEncodedPoints(s->hasPressure());
+    } else if (s->hasPressure()) {
+        stroke->setPressureAttrib("width", s->getWidth());
     } else {
         stroke->setAttrib("width", s->getWidth());
     }
@@ -167,16 +178,7 @@ void SaveHandler::visitLayer(XmlNode* page, Layer* l) {
 
             writeTimestamp(t, text);
         } else if (e->getType() == ELEMENT_IMAGE) {
-            auto* i = dynamic_cast<Image*>(e);
-            auto* image = new XmlImageNode("image");
-            layer->addChild(image);
-
-            image->setImage(i->getImage());
-
-            image->setAttrib("left", i->getX());
-            image->setAttrib("top", i->getY());
-            image->setAttrib("right", i->getX() + i->getElementWidth());
-            image->setAttrib("bottom", i->getY() + i->getElementHeight());
+            visitImage(layer, dynamic_cast<Image*>(e));
         } else if (e->getType() == ELEMENT_TEXIMAGE) {
             auto* i = dynamic_cast<TexImage*>(e);
             auto* image = new XmlTexNode("teximage", std::string(i->getBinaryData()));
@@ -197,6 +199,51 @@ void SaveHandler::visitPage(XmlNode* root, PageRef p, Document* doc, int id) {
     page->setAttrib("width", p->getWidth());
     page->setAttrib("height", p->getHeight());
 
+    writeBackground(page, p, doc, id);
+    visitLayers(page, p);
+}
+
+void SaveHandler::visitImage(XmlNode* layer, Image* i) {
+    auto* image = new XmlImageNode("image");
+    layer->addChild(image);
+
+    image->setImage(i->getContent());
+    writeImageBounds(image, i);
+}
+
+void SaveHandler::writeImageBounds(XmlNode* image, Image* i) {
+    image->setAttrib("left", i->getX());
+    image->setAttrib("top", i->getY());
+    image->setAttrib("right", i->getX() + i->getElementWidth());
+    image->setAttrib("bottom", i->getY() + i->getElementHeight());
+}
+
+void SaveHandler::writeAttachedPdf(Document* doc) {
+    auto filepath = doc->getFilepath();
+    Util::clearExtensions(filepath);
+    filepath += ".xopp.bg.pdf";
+    this->attachedPdfFilepath = filepath;
+
+    // The PDF was read from this file: it is unchanged, and would be overwritten while it is read
+    std::error_code ec;
+    if (fs::equivalent(doc->getPdfFilepath(), filepath, ec)) {
+        return;
+    }
+
+    GError* error = nullptr;
+    doc->getPdfDocument().save(filepath, &error);
+
+    if (error) {
+        if (!this->errorMessage.empty()) {
+            this->errorMessage += "\n";
+        }
+        this->errorMessage += FS(_F("Could not write background \"{1}\", {2}") % filepath.u8string() % error->message);
+
+        g_error_free(error);
+    }
+}
+
+void SaveHandler::writeBackground(XmlNode* page, PageRef p, Document* doc, int id) {
     auto* background = new XmlNode("background");
     page->addChild(background);
 
@@ -214,23 +261,8 @@ void SaveHandler::visitPage(XmlNode* root, PageRef p, Document* doc, int id) {
 
             if (doc->isAttachPdf()) {
                 background->setAttrib("domain", "attach");
-                auto filepath = doc->getFilepath();
-                Util::clearExtensions(filepath);
-                filepath += ".xopp.bg.pdf";
                 background->setAttrib("filename", "bg.pdf");
-
-                GError* error = nullptr;
-                doc->getPdfDocument().save(filepath, &error);
-
-                if (error) {
-                    if (!this->errorMessage.empty()) {
-                        this->errorMessage += "\n";
-                    }
-                    this->errorMessage +=
-                            FS(_F("Could not write background \"{1}\", {2}") % filepath.u8string() % error->message);
-
-                    g_error_free(error);
-                }
+                writeAttachedPdf(doc);
             } else {
                 background->setAttrib("domain", "absolute");
                 background->setAttrib("filename", doc->getPdfFilepath().string());
@@ -264,7 +296,9 @@ void SaveHandler::visitPage(XmlNode* root, PageRef p, Document* doc, int id) {
     } else {
         writeSolidBackground(background, p);
     }
+}
 
+void SaveHandler::visitLayers(XmlNode* page, const PageRef& p) {
     // no layer, but we need to write one layer, else the old Xournal cannot read the file
     if (p->getLayers()->empty()) {
         auto* layer = new XmlNode("layer");
@@ -294,7 +328,12 @@ void SaveHandler::writeBackgroundName(XmlNode* background, PageRef p) {
 }
 
 void SaveHandler::saveTo(const fs::path& filepath, ProgressListener* listener) {
-    GzOutputStream out(filepath);
+    // Written next to the file, which is only replaced once the new content is on the disk: a failed save keeps it
+    std::error_code ec;
+    const fs::path file = fs::is_symlink(filepath, ec) ? fs::canonical(filepath, ec) : filepath;
+    const fs::path tmp = fs::path(file) += ".tmp";
+
+    GzOutputStream out(tmp);
 
     if (!out.getLastError().empty()) {
         this->errorMessage = out.getLastError();
@@ -305,9 +344,29 @@ void SaveHandler::saveTo(const fs::path& filepath, ProgressListener* listener) {
 
     out.close();
 
-    if (this->errorMessage.empty()) {
-        this->errorMessage = out.getLastError();
+    if (!out.getLastError().empty()) {
+        if (this->errorMessage.empty()) {
+            this->errorMessage = out.getLastError();
+        }
+        fs::remove(tmp, ec);
+        return;
     }
+
+    if (fs::exists(file, ec)) {
+        fs::permissions(tmp, fs::status(file, ec).permissions(), ec);
+    }
+    Util::syncFile(tmp);
+    fs::rename(tmp, file, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        if (!this->errorMessage.empty()) {
+            this->errorMessage += "\n";
+        }
+        this->errorMessage += FS(_F("Could not write file \"{1}\": {2}") % file.u8string() % ec.message());
+        return;
+    }
+    // The directory entry of the renamed file
+    Util::syncFile(file);
 }
 
 void SaveHandler::saveTo(OutputStream* out, const fs::path& filepath, ProgressListener* listener) {
@@ -316,6 +375,10 @@ void SaveHandler::saveTo(OutputStream* out, const fs::path& filepath, ProgressLi
     out->write("<?xml version=\"1.0\" standalone=\"no\"?>\n");
     root->writeOut(out, listener);
 
+    writeBackgroundImages(filepath);
+}
+
+void SaveHandler::writeBackgroundImages(const fs::path& filepath) {
     for (BackgroundImage const& img: backgroundImages) {
         auto tmpfn = (fs::path(filepath) += ".") += img.getFilepath();
         if (!gdk_pixbuf_save(img.getPixbuf(), tmpfn.u8string().c_str(), "png", nullptr, nullptr)) {
@@ -329,3 +392,37 @@ void SaveHandler::saveTo(OutputStream* out, const fs::path& filepath, ProgressLi
 }
 
 auto SaveHandler::getErrorMessage() -> std::string { return this->errorMessage; }
+
+auto SaveHandler::copiesLayers(const LazyPageLoader& loader) const -> bool { return false; }
+
+void SaveHandler::loadOverwrittenLayers(Document* doc, const fs::path& target) {
+    doc->lock();
+    std::vector<PageRef> pages;
+    pages.reserve(doc->getPageCount());
+    for (size_t i = 0; i < doc->getPageCount(); i++) { pages.push_back(doc->getPage(i)); }
+    doc->unlock();
+
+    auto isTarget = [&target](const LazyPageLoader& loader) {
+        std::error_code ec;
+        const fs::path& source = loader.getSource().filepath;
+        return source == target || fs::equivalent(source, target, ec);
+    };
+
+    // The layers are loaded without the lock, as when the pages are accessed
+    for (const PageRef& p: pages) {
+        // The loaded layers cannot be unloaded and parsed again from the overwritten file
+        auto reloader = std::dynamic_pointer_cast<LazyPageLoader>(p->getLayerReloader());
+        if (reloader && isTarget(*reloader)) {
+            p->forgetLayerReloader();
+        }
+
+        auto loader = std::dynamic_pointer_cast<LazyPageLoader>(p->getLayerLoader());
+        if (!loader || copiesLayers(*loader)) {
+            continue;
+        }
+        if (isTarget(*loader)) {
+            p->getLayerCount();
+            p->forgetLayerReloader();
+        }
+    }
+}
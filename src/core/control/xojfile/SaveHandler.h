@@ -22,6 +22,8 @@
 #include "util/OutputStream.h"
 
 
+class Image;
+class LazyPageLoader;
 class XmlNode;
 class XmlPointNode;
 class ProgressListener;
@@ -31,18 +33,57 @@ public:
     SaveHandler();
 
 public:
+    /**
+     * Write the points of the strokes with StrokeEncoding instead of decimal text. Must be set before prepareSave().
+     */
+    void setBinaryStrokes(bool binaryStrokes);
+
+    /**
+     * Build the contents of the file. The points of the strokes are not copied: the document must not be modified
+     * until the file is written, see Document::snapshot()
+     */
     void prepareSave(Document* doc);
-    void saveTo(const fs::path& filepath, ProgressListener* listener = nullptr);
+    virtual void saveTo(const fs::path& filepath, ProgressListener* listener = nullptr);
     void saveTo(OutputStream* out, const fs::path& filepath, ProgressListener* listener = nullptr);
     std::string getErrorMessage();
 
+    /**
+     * Load the layers which the pages would read lazily from the file about to be overwritten, unless this handler
+     * copies them from the file. Must be called before the file is overwritten, with the document unlocked.
+     */
+    void loadOverwrittenLayers(Document* doc, const fs::path& target);
+
 protected:
+    /**
+     * @return true if the handler copies the layers of the page from the file they are loaded from, without loading
+     *         them
+     */
+    virtual bool copiesLayers(const LazyPageLoader& loader) const;
+
     static std::string getColorStr(Color c, unsigned char alpha = 0xff);
 
     virtual void visitPage(XmlNode* root, PageRef p, Document* doc, int id);
+    void writeBackground(XmlNode* page, PageRef p, Document* doc, int id);
+
+    /**
+     * Write the attached PDF background next to the file, see attachedPdfFilepath
+     */
+    virtual void writeAttachedPdf(Document* doc);
+    void visitLayers(XmlNode* page, const PageRef& p);
+
+    /**
+     * Write the attached background images next to the file
+     */
+    void writeBackgroundImages(const fs::path& filepath);
     virtual void visitLayer(XmlNode* page, Layer* l);
     virtual void visitStroke(XmlPointNode* stroke, Stroke* s);
 
+    /**
+     * Write the image element in the layer
+     */
+    virtual void visitImage(XmlNode* layer, Image* i);
+    void writeImageBounds(XmlNode* image, Image* i);
+
     /**
      * Export the fill attributes
      */
@@ -60,5 +101,17 @@ protected:
 
     std::string errorMessage;
 
+    bool binaryStrokes = false;
+
+    /**
+     * The file format version written, set by writeHeader()
+     */
+    int fileVersion = 0;
+
+    /**
+     * The attached PDF background written next to the file, if any
+     */
+    fs::path attachedPdfFilepath;
+
     std::vector<BackgroundImage> backgroundImages{};
 };
@@ -0,0 +1,128 @@
+#include "StrokeEncoding.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include <glib.h>
+
+namespace {
+/**
+ * Largest absolute quantized value, so that the differences cannot overflow
+ */
+constexpr double MAX_QUANTIZED = 1e15;
+
+void writeVarint(std::string& data, uint64_t value) {
+    while (value >= 0x80) {
+        data += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    data += static_cast<char>(value);
+}
+
+auto readVarint(const unsigned char*& data, const unsigned char* end, uint64_t& value) -> bool {
+    value = 0;
+    for (int shift = 0; shift < 64 && data < end; shift += 7) {
+        uint64_t byte = *data++;
+        value |= (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void writeDelta(std::string& data, int64_t value, int64_t& previous) {
+    int64_t delta = value - previous;
+    previous = value;
+    writeVarint(data, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+}
+
+auto readDelta(const unsigned char*& data, const unsigned char* end, int64_t& previous, double& value) -> bool {
+    uint64_t zigzag = 0;
+    if (!readVarint(data, end, zigzag)) {
+        return false;
+    }
+    previous += static_cast<int64_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+    value = static_cast<double>(previous) / StrokeEncoding::SCALE;
+    return true;
+}
+
+auto fits(double value) -> bool {
+    // Also false for NaN
+    return std::abs(value * StrokeEncoding::SCALE) <= MAX_QUANTIZED;
+}
+
+auto quantize(double value) -> int64_t { return static_cast<int64_t>(std::round(value * StrokeEncoding::SCALE)); }
+}  // namespace
+
+auto StrokeEncoding::canEncode(const std::vector<Point>& points, bool pressure) -> bool {
+    for (const Point& p: points) {
+        if (!fits(p.x) || !fits(p.y) || (pressure && !fits(p.z))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto StrokeEncoding::encode(const std::vector<Point>& points, bool pressure) -> std::string {
+    std::string data;
+    // Small deltas take 1-2 bytes each
+    data.reserve(points.size() * (pressure ? 5 : 4) + 12);
+    writeVarint(data, points.size());
+    writeVarint(data, pressure ? PRESSURE : 0);
+
+    int64_t x = 0;
+    int64_t y = 0;
+    int64_t z = 0;
+    for (const Point& p: points) {
+        writeDelta(data, quantize(p.x), x);
+        writeDelta(data, quantize(p.y), y);
+        if (pressure) {
+            writeDelta(data, quantize(p.z), z);
+        }
+    }
+
+    gchar* base64 = g_base64_encode(reinterpret_cast<const guchar*>(data.data()), data.size());
+    std::string encoded(base64);
+    g_free(base64);
+    return encoded;
+}
+
+auto StrokeEncoding::decode(const char* text, size_t length, std::vector<Point>& points) -> bool {
+    std::string data(length / 4 * 3 + 3, '\0');
+    gint state = 0;
+    guint save = 0;
+    size_t size = g_base64_decode_step(text, length, reinterpret_cast<guchar*>(&data[0]), &state, &save);
+
+    const auto* pos = reinterpret_cast<const unsigned char*>(data.data());
+    const auto* end = pos + size;
+
+    uint64_t count = 0;
+    uint64_t flags = 0;
+    if (!readVarint(pos, end, count) || !readVarint(pos, end, flags)) {
+        return false;
+    }
+    bool pressure = flags & PRESSURE;
+    // Each point takes at least a byte per value
+    if (count > static_cast<uint64_t>(end - pos)) {
+        return false;
+    }
+
+    points.clear();
+    points.reserve(count);
+
+    int64_t x = 0;
+    int64_t y = 0;
+    int64_t z = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        Point p;
+        if (!readDelta(pos, end, x, p.x) || !readDelta(pos, end, y, p.y)) {
+            return false;
+        }
+        if (pressure && !readDelta(pos, end, z, p.z)) {
+            return false;
+        }
+        points.push_back(p);
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+/*
+ * Xournal++
+ *
+ * Binary encoding of the points of a stroke
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "model/Point.h"
+
+/**
+ * The points of a stroke, written as the base64 text of the stroke element instead of the decimal coordinates when
+ * the element has the attribute encoding="delta":
+ *
+ *     <stroke tool="pen" color="#000000ff" width="1.41" encoding="delta">BASE64</stroke>
+ *
+ * The data is a sequence of LEB128 varints: the number of points, the flags (PRESSURE if the points have a pressure),
+ * then for each point x, y and, with PRESSURE, z. The values are quantized to 1 / SCALE and each one is stored as the
+ * zigzag-encoded difference to the same value of the previous point. The width attribute only holds the width.
+ */
+namespace StrokeEncoding {
+constexpr const char* NAME = "delta";
+
+/**
+ * Quantization steps per unit (point of the page, or width for the pressure)
+ */
+constexpr double SCALE = 10000;
+
+/**
+ * The points have a pressure
+ */
+constexpr unsigned int PRESSURE = 1;
+
+/**
+ * @return false if a coordinate does not fit the fixed-point range, the points are then written as text
+ */
+bool canEncode(const std::vector<Point>& points, bool pressure);
+
+/**
+ * @return The base64 encoded points, see canEncode()
+ */
+std::string encode(const std::vector<Point>& points, bool pressure);
+
+/**
+ * Decode the base64 text of a stroke element
+ *
+ * @return false if the data is corrupted
+ */
+bool decode(const char* text, size_t length, std::vector<Point>& points);
+};  // namespace StrokeEncoding
@@ -31,6 +31,9 @@ void XojExportHandler::visitStrokeExtended(XmlPointNode* stroke, Stroke* s) {
 }
 
 void XojExportHandler::writeHeader() {
+    // Xournal does not read the encoded points
+    this->binaryStrokes = false;
+
     this->root->setAttrib("creator", PROJECT_STRING);
     // Keep this version on 2, as this is anyway not read by Xournal
     this->root->setAttrib("fileversion", "2");
@@ -18,6 +18,12 @@
 #include "SaveHandler.h"
 
 
+/**
+ * @brief Writes the .xoj files of Xournal
+ *
+ * Only the attributes are changed: the file is written like a .xopp file (see SaveHandler::saveTo()), the points
+ * straight from the strokes and compressed in parallel blocks. The points are always written as text.
+ */
 class XojExportHandler: public SaveHandler {
 public:
     XojExportHandler();
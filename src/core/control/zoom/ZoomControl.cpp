@@ -41,7 +41,7 @@ auto onTouchpadPinchEvent(GtkWidget* widget, GdkEventTouchpadPinch* event, ZoomC
                 // Need to adjust the center because the event coordinates are relative
                 // to the widget, not to the zoomed (and translated) view
                 center += {zoom->getVisibleRect().x, zoom->getVisibleRect().y};
-                zoom->startZoomSequence(center);
+                zoom->startZoomGesture(center);
                 break;
             case GDK_TOUCHPAD_GESTURE_PHASE_UPDATE:
                 zoom->zoomSequenceChange(event->scale, true);
@@ -59,28 +59,59 @@ auto onTouchpadPinchEvent(GtkWidget* widget, GdkEventTouchpadPinch* event, ZoomC
 }
 
 
-// Todo: try to connect this function with the "expose_event", it would be way cleaner and we dont need to align/layout
-//       the pages manually, but it only works with the top Widget (GtkWindow) for now this works "fine"
-//       see https://stackoverflow.com/questions/1060039/gtk-detecting-window-resize-from-the-user
-auto onWindowSizeChangedEvent(GtkWidget* widget, GdkEvent* event, ZoomControl* zoom) -> bool {
-    g_assert_true(widget != zoom->view->getWidget());
-    auto layout = gtk_xournal_get_layout(zoom->view->getWidget());
-    // Todo (fabian): The following code is a hack.
-    //    Problem size-allocate:
-    //    when using the size-allocate signal, we cant use layout->recalculate() directly.
-    //    But using the xournal-widgets allocation is wrong, since the calculation is skipped already.
-    //    using size-allocate's allocation is wrong, since it is the alloc of the toplevel.
-    //    Problem expose-event:
-    //    when using the expose-event signal, the new Allocation is not known yet; calculation must be deferred.
-    //    (minimize / maximize wont work)
-    Util::execInUiThread([layout, zoom]() {
-        zoom->updateZoomPresentationValue();
-        zoom->updateZoomFitValue();
-        layout->recalculate();
+// The window, the sidebar and the fullscreen mode resize the view: the zoom is fitted once the layout knows the new
+// size, and the pages are rendered at the end of the resize, see ZoomControl::isResizeActive()
+void onViewSizeAllocate(GtkWidget* widget, GdkRectangle* allocation, ZoomControl* zoom) {
+    if (allocation->width == zoom->viewWidth && allocation->height == zoom->viewHeight) {
+        return;
+    }
+    zoom->viewWidth = allocation->width;
+    zoom->viewHeight = allocation->height;
+    zoom->viewResized();
+}
+
+ZoomControl::~ZoomControl() {
+    if (this->resizeTimeout) {
+        g_source_remove(this->resizeTimeout);
+    }
+}
+
+void ZoomControl::viewResized() {
+    if (this->resizeTimeout) {
+        g_source_remove(this->resizeTimeout);
+    }
+    this->resizeTimeout = g_timeout_add(RESIZE_DEBOUNCE_MS, reinterpret_cast<GSourceFunc>(endResize), this);
+
+    // One update for all the allocations before the layout is recalculated
+    if (this->resizeUpdatePending) {
+        return;
+    }
+    this->resizeUpdatePending = true;
+    Util::execInUiThread([this]() {
+        this->resizeUpdatePending = false;
+        updateZoomPresentationValue();
+        updateZoomFitValue();
+        gtk_xournal_get_layout(this->view->getWidget())->recalculateZoom();
     });
+}
+
+auto ZoomControl::endResize(ZoomControl* zoom) -> bool {
+    zoom->resizeTimeout = 0;
+
+    zoom->updateZoomPresentationValue();
+    zoom->updateZoomFitValue();
+    if (zoom->zoomFitMode || zoom->zoomPresentationMode) {
+        // The full update of the views, skipped during the resize
+        zoom->fireZoomChanged();
+    }
+
+    // Like at the end of a pinch gesture: the visible pages are rendered once, at the final zoom
+    zoom->fireZoomGestureEnded();
     return false;
 }
 
+auto ZoomControl::isResizeActive() const -> bool { return this->resizeTimeout != 0; }
+
 auto ZoomControl::withZoomStep(ZoomDirection direction, double zoomStep) const -> double {
     double multiplier = 1.0 + zoomStep;
     double newZoom;
@@ -146,6 +177,13 @@ void ZoomControl::startZoomSequence(utl::Point<double> zoomCenter) {
     setScrollPositionAfterZoom(view_pos);
 }
 
+void ZoomControl::startZoomGesture(utl::Point<double> zoomCenter) {
+    startZoomSequence(zoomCenter);
+    this->zoomGestureActive = true;
+}
+
+auto ZoomControl::isZoomGestureActive() const -> bool { return this->zoomGestureActive; }
+
 void ZoomControl::zoomSequenceChange(double zoom, bool relative) {
     if (relative && this->zoomSequenceStart != -1) {
         zoom *= zoomSequenceStart;
@@ -157,6 +195,11 @@ void ZoomControl::zoomSequenceChange(double zoom, bool relative) {
 void ZoomControl::endZoomSequence() {
     scrollPosition = {-1, -1};
     zoomSequenceStart = -1;
+
+    if (this->zoomGestureActive) {
+        this->zoomGestureActive = false;
+        fireZoomGestureEnded();
+    }
 }
 
 void ZoomControl::cancelZoomSequence() {
@@ -213,13 +256,13 @@ void ZoomControl::removeZoomListener(ZoomListener* l) {
     }
 }
 
-void ZoomControl::initZoomHandler(GtkWidget* window, GtkWidget* widget, XournalView* v, Control* c) {
+void ZoomControl::initZoomHandler(GtkWidget* widget, XournalView* v, Control* c) {
     this->control = c;
     this->view = v;
     gtk_widget_add_events(widget, GDK_TOUCHPAD_GESTURE_MASK);
     g_signal_connect(widget, "scroll-event", G_CALLBACK(onScrolledwindowMainScrollEvent), this);
     g_signal_connect(widget, "event", G_CALLBACK(onTouchpadPinchEvent), this);
-    g_signal_connect(window, "configure-event", G_CALLBACK(onWindowSizeChangedEvent), this);
+    g_signal_connect(widget, "size-allocate", G_CALLBACK(onViewSizeAllocate), this);
     registerListener(this->control);
 }
 
@@ -239,6 +282,10 @@ void ZoomControl::fireZoomRangeValueChanged() {
     for (ZoomListener* z: this->listener) { z->zoomRangeValuesChanged(); }
 }
 
+void ZoomControl::fireZoomGestureEnded() {
+    for (ZoomListener* z: this->listener) { z->zoomGestureEnded(); }
+}
+
 auto ZoomControl::getZoom() const -> double { return this->zoom; }
 
 auto ZoomControl::getZoomReal() const -> double { return this->zoom / this->zoom100Value; }
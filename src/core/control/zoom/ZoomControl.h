@@ -35,7 +35,7 @@ class DocumentListener;
 class ZoomControl: public DocumentListener {
 public:
     ZoomControl() = default;
-    ~ZoomControl() override = default;
+    ~ZoomControl() override;
 
     /**
      * Zoom one step
@@ -120,7 +120,7 @@ public:
     void addZoomListener(ZoomListener* listener);
     void removeZoomListener(ZoomListener* listener);
 
-    void initZoomHandler(GtkWidget* window, GtkWidget* widget, XournalView* v, Control* c);
+    void initZoomHandler(GtkWidget* widget, XournalView* v, Control* c);
 
     /**
      * Call this before any zoom is done, it saves the current page and position
@@ -136,6 +136,27 @@ public:
      */
     void startZoomSequence();
 
+    /**
+     * Starts a zoom sequence driven by a pinch gesture. Until it ends, pages are only rendered at low resolution.
+     *
+     * @param zoomCenter position of zoom focus
+     */
+    void startZoomGesture(utl::Point<double> zoomCenter);
+
+    /**
+     * @return true while a pinch gesture zooms (see startZoomGesture())
+     */
+    bool isZoomGestureActive() const;
+
+    /**
+     * @return true from a change of the size of the view (window, sidebar, fullscreen) until RESIZE_DEBOUNCE_MS after
+     *         the last one. Meanwhile the zoom fit follows the size, but the pages are only rendered at the end.
+     */
+    bool isResizeActive() const;
+
+    /// In milliseconds: a resize ends once the size of the view stays unchanged for this long
+    static constexpr guint RESIZE_DEBOUNCE_MS = 200;
+
     /**
      * Change the zoom within a Zoom sequence (startZoomSequence() / endZoomSequence())
      *
@@ -166,6 +187,7 @@ public:
 protected:
     void fireZoomChanged();
     void fireZoomRangeValueChanged();
+    void fireZoomGestureEnded();
 
     void pageSizeChanged(size_t page) override;
     void pageSelected(size_t page) override;
@@ -183,7 +205,17 @@ private:
      */
     double withZoomStep(ZoomDirection direction, double stepSize) const;
 
-    friend bool onWindowSizeChangedEvent(GtkWidget* widget, GdkEvent* event, ZoomControl* zoom);
+    /**
+     * Starts or extends a resize, see isResizeActive()
+     */
+    void viewResized();
+
+    /**
+     * Recalculates the zoom at the final size of the view, then lets the pages render
+     */
+    static bool endResize(ZoomControl* zoom);
+
+    friend void onViewSizeAllocate(GtkWidget* widget, GdkRectangle* allocation, ZoomControl* zoom);
     friend bool onScrolledwindowMainScrollEvent(GtkWidget* widget, GdkEventScroll* event, ZoomControl* zoom);
     friend bool onTouchpadPinchEvent(GtkWidget* widget, GdkEventTouchpadPinch* event, ZoomControl* zoom);
 
@@ -208,6 +240,9 @@ private:
     /// Base zoom on start, for relative zoom (Gesture)
     double zoomSequenceStart = -1;
 
+    /// The zoom sequence is a pinch gesture
+    bool zoomGestureActive = false;
+
     /// Zoom center pos on view, will not be zoomed!
     utl::Point<double> zoomWidgetPos;
 
@@ -248,4 +283,14 @@ private:
     size_t current_page = static_cast<size_t>(-1);
     size_t last_page = static_cast<size_t>(-1);
     bool isZoomFittingNow = false;
+
+    /// The last allocated size of the view, see onViewSizeAllocate()
+    int viewWidth = -1;
+    int viewHeight = -1;
+
+    /// The timeout ending the resize, 0 if there is none
+    guint resizeTimeout = 0;
+
+    /// The zoom fit of the resize is waiting for the layout
+    bool resizeUpdatePending = false;
 };
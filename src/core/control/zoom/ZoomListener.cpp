@@ -3,3 +3,5 @@
 ZoomListener::~ZoomListener() = default;
 
 void ZoomListener::zoomRangeValuesChanged() {}
+
+void ZoomListener::zoomGestureEnded() {}
@@ -15,6 +15,7 @@ class ZoomListener {
 public:
     virtual void zoomChanged() = 0;
     virtual void zoomRangeValuesChanged();
+    virtual void zoomGestureEnded();
 
     virtual ~ZoomListener();
 };
@@ -70,6 +70,7 @@ enum ActionType {
     ACTION_NEW_PAGE_AFTER,
     ACTION_NEW_PAGE_AT_END,
     ACTION_APPEND_NEW_PDF_PAGES,
+    ACTION_IMPORT_IMAGES,
 
     ACTION_CONFIGURE_PAGE_TEMPLATE,
 
@@ -163,6 +164,8 @@ enum ActionType {
     ACTION_SELECT_FONT,
     ACTION_FONT_BUTTON_CHANGED,
     ACTION_TEX,
+    ACTION_TEX_RECOMPILE,
+    ACTION_BEAUTIFY,
 
     // Menu View
     ACTION_ZOOM_IN = 600,
@@ -179,6 +182,7 @@ enum ActionType {
     ACTION_AUDIO_STOP_PLAYBACK,
     ACTION_AUDIO_SEEK_FORWARDS,
     ACTION_AUDIO_SEEK_BACKWARDS,
+    ACTION_AUDIO_TIMELINE,
     ACTION_SET_PAIRS_OFFSET,
     ACTION_SET_COLUMNS,
     ACTION_SET_COLUMNS_1,
@@ -211,6 +215,7 @@ enum ActionType {
     // Menu Help
     ACTION_ABOUT = 800,
     ACTION_HELP,
+    ACTION_MEMORY_REPORT,
 
     // Footer, not really an action, but need an identifier too
     ACTION_FOOTER_PAGESPIN = 900,
@@ -164,6 +164,10 @@ auto ActionType_fromString(const string& value) -> ActionType {
         return ACTION_APPEND_NEW_PDF_PAGES;
     }
 
+    if (value == "ACTION_IMPORT_IMAGES") {
+        return ACTION_IMPORT_IMAGES;
+    }
+
     if (value == "ACTION_CONFIGURE_PAGE_TEMPLATE") {
         return ACTION_CONFIGURE_PAGE_TEMPLATE;
     }
@@ -452,6 +456,14 @@ auto ActionType_fromString(const string& value) -> ActionType {
         return ACTION_TEX;
     }
 
+    if (value == "ACTION_TEX_RECOMPILE") {
+        return ACTION_TEX_RECOMPILE;
+    }
+
+    if (value == "ACTION_BEAUTIFY") {
+        return ACTION_BEAUTIFY;
+    }
+
     if (value == "ACTION_ZOOM_IN") {
         return ACTION_ZOOM_IN;
     }
@@ -508,6 +520,10 @@ auto ActionType_fromString(const string& value) -> ActionType {
         return ACTION_AUDIO_SEEK_BACKWARDS;
     }
 
+    if (value == "ACTION_AUDIO_TIMELINE") {
+        return ACTION_AUDIO_TIMELINE;
+    }
+
     if (value == "ACTION_SET_PAIRS_OFFSET") {
         return ACTION_SET_PAIRS_OFFSET;
     }
@@ -620,6 +636,10 @@ auto ActionType_fromString(const string& value) -> ActionType {
         return ACTION_HELP;
     }
 
+    if (value == "ACTION_MEMORY_REPORT") {
+        return ACTION_MEMORY_REPORT;
+    }
+
     if (value == "ACTION_FOOTER_PAGESPIN") {
         return ACTION_FOOTER_PAGESPIN;
     }
@@ -790,6 +810,10 @@ auto ActionType_toString(ActionType value) -> string {
         return "ACTION_APPEND_NEW_PDF_PAGES";
     }
 
+    if (value == ACTION_IMPORT_IMAGES) {
+        return "ACTION_IMPORT_IMAGES";
+    }
+
     if (value == ACTION_CONFIGURE_PAGE_TEMPLATE) {
         return "ACTION_CONFIGURE_PAGE_TEMPLATE";
     }
@@ -1078,6 +1102,14 @@ auto ActionType_toString(ActionType value) -> string {
         return "ACTION_TEX";
     }
 
+    if (value == ACTION_TEX_RECOMPILE) {
+        return "ACTION_TEX_RECOMPILE";
+    }
+
+    if (value == ACTION_BEAUTIFY) {
+        return "ACTION_BEAUTIFY";
+    }
+
     if (value == ACTION_ZOOM_IN) {
         return "ACTION_ZOOM_IN";
     }
@@ -1134,6 +1166,10 @@ auto ActionType_toString(ActionType value) -> string {
         return "ACTION_AUDIO_SEEK_BACKWARDS";
     }
 
+    if (value == ACTION_AUDIO_TIMELINE) {
+        return "ACTION_AUDIO_TIMELINE";
+    }
+
     if (value == ACTION_SET_PAIRS_OFFSET) {
         return "ACTION_SET_PAIRS_OFFSET";
     }
@@ -1246,6 +1282,10 @@ auto ActionType_toString(ActionType value) -> string {
         return "ACTION_HELP";
     }
 
+    if (value == ACTION_MEMORY_REPORT) {
+        return "ACTION_MEMORY_REPORT";
+    }
+
     if (value == ACTION_FOOTER_PAGESPIN) {
         return "ACTION_FOOTER_PAGESPIN";
     }
@@ -0,0 +1,44 @@
+#include "BlankPageTiles.h"
+
+#include <utility>
+
+#include "model/XojPage.h"
+
+BlankPageTiles::Background::Background(XojPage& page):
+        width(page.getWidth()),
+        height(page.getHeight()),
+        type(page.getBackgroundType()),
+        color(page.getBackgroundColor()),
+        pdfPage(page.getPdfPageNr()),
+        image(page.getBackgroundImage()),
+        visible(page.isLayerVisible(0)) {}
+
+auto BlankPageTiles::Background::operator==(const Background& other) const -> bool {
+    // BackgroundImage compares the shared images
+    return width == other.width && height == other.height && type == other.type && color == other.color &&
+           pdfPage == other.pdfPage && BackgroundImage(image) == other.image && visible == other.visible;
+}
+
+auto BlankPageTiles::isBlank(XojPage& page) -> bool { return !page.hasPendingLayers() && !page.isAnnotated(); }
+
+auto BlankPageTiles::contains(XojPage& page, double scale) const -> bool {
+    return this->tiles && this->scale == scale && this->background == Background(page);
+}
+
+void BlankPageTiles::store(XojPage& page, double scale, std::unique_ptr<TiledPageBuffer> tiles) {
+    this->background.emplace(page);
+    this->scale = scale;
+    this->tiles = std::move(tiles);
+}
+
+auto BlankPageTiles::get(XojPage& page, double scale) const -> std::unique_ptr<TiledPageBuffer> {
+    if (!isBlank(page) || !contains(page, scale)) {
+        return nullptr;
+    }
+    return this->tiles->share();
+}
+
+void BlankPageTiles::clear() {
+    this->background.reset();
+    this->tiles.reset();
+}
@@ -0,0 +1,79 @@
+/*
+ * Xournal++
+ *
+ * The rendered tiles of a blank page, reused by the new pages
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include "model/BackgroundImage.h"
+#include "model/PageType.h"
+#include "util/Color.h"
+
+#include "TiledPageBuffer.h"
+
+class XojPage;
+
+/**
+ * @brief The tiles of the last blank page drawn on, which the new blank pages with the same background start with
+ *
+ * A new page (e.g. "New page after", or at the end of the document while writing) would otherwise be shown blank
+ * until its background is rendered. The tiles are taken from a blank page before the first element is added to it
+ * (see XojPageView::onButtonPressEvent()) and shared by the new pages until they are drawn into, see
+ * TiledPageBuffer::share(). Only one page is kept. Used from the main thread only.
+ */
+class BlankPageTiles {
+public:
+    /**
+     * @return Whether the page has no element, without loading its layers
+     */
+    static bool isBlank(XojPage& page);
+
+    /**
+     * @return Whether the tiles of a page which looks like this one at the given scale are kept
+     */
+    bool contains(XojPage& page, double scale) const;
+
+    /**
+     * Keeps the tiles of the page, which must be blank, rendered at the given scale
+     */
+    void store(XojPage& page, double scale, std::unique_ptr<TiledPageBuffer> tiles);
+
+    /**
+     * @return A copy of the kept tiles if the page is blank and looks like the kept one at the given scale, else
+     *         nullptr
+     */
+    std::unique_ptr<TiledPageBuffer> get(XojPage& page, double scale) const;
+
+    void clear();
+
+private:
+    /**
+     * All that the rendering of a blank page depends on
+     */
+    struct Background {
+        double width;
+        double height;
+        PageType type;
+        Color color;
+        size_t pdfPage;
+        BackgroundImage image;
+        bool visible;
+
+        explicit Background(XojPage& page);
+        bool operator==(const Background& other) const;
+    };
+
+    std::optional<Background> background;
+    double scale = 0;
+    std::unique_ptr<TiledPageBuffer> tiles;
+};
@@ -13,14 +13,17 @@
 GladeGui::GladeGui(GladeSearchpath* gladeSearchPath, const std::string& glade, const std::string& mainWnd) {
     this->gladeSearchPath = gladeSearchPath;
 
-    auto filepath = this->gladeSearchPath->findFile("", glade);
-
     GError* error = nullptr;
     builder = gtk_builder_new();
 
-    if (!gtk_builder_add_from_file(builder, filepath.u8string().c_str(), &error)) {
-        std::string msg =
-                FS(_F("Error loading glade file \"{1}\" (try to load \"{2}\")") % glade % filepath.u8string());
+    // Parsed from the resources linked in if they are, without looking the file up
+    auto resource = GladeSearchpath::findResource(glade);
+    auto filepath = resource.empty() ? this->gladeSearchPath->findFile("", glade).u8string() : resource;
+    bool loaded = resource.empty() ? gtk_builder_add_from_file(builder, filepath.c_str(), &error) :
+                                     gtk_builder_add_from_resource(builder, filepath.c_str(), &error);
+
+    if (!loaded) {
+        std::string msg = FS(_F("Error loading glade file \"{1}\" (try to load \"{2}\")") % glade % filepath);
 
         if (error != nullptr) {
             msg += "\n";
@@ -11,6 +11,8 @@
 
 #include "GladeSearchpath.h"
 
+#include <gio/gio.h>
+
 GladeSearchpath::GladeSearchpath() = default;
 
 GladeSearchpath::~GladeSearchpath() { directories.clear(); }
@@ -35,6 +37,20 @@ auto GladeSearchpath::findFile(fs::path const& subdir, fs::path const& file) ->
     return fs::path{};
 }
 
+auto GladeSearchpath::findResource(fs::path const& file) -> std::string {
+    std::string path = std::string(RESOURCE_PREFIX) + "/" + file.generic_u8string();
+    if (g_resources_get_info(path.c_str(), G_RESOURCE_LOOKUP_FLAGS_NONE, nullptr, nullptr, nullptr)) {
+        return path;
+    }
+
+    // A directory
+    if (gchar** children = g_resources_enumerate_children(path.c_str(), G_RESOURCE_LOOKUP_FLAGS_NONE, nullptr)) {
+        g_strfreev(children);
+        return path;
+    }
+    return {};
+}
+
 /**
  * @return The first search path
  */
@@ -29,6 +29,18 @@ public:
      */
     fs::path findFile(fs::path const& subdir, fs::path const& file);
 
+    /**
+     * @return The path of the file or of the directory in the resources linked into the executable, an empty string if
+     *         it is not there, e.g. if they are not linked in (see ENABLE_UI_RESOURCES). The resources are read first:
+     *         they spare the lookups of the files at startup, which are slow on network mounted installs.
+     */
+    static std::string findResource(fs::path const& file);
+
+    /**
+     * The path of the ui directory in the resources
+     */
+    static constexpr auto RESOURCE_PREFIX = "/com/github/xournalpp/xournalpp/ui";
+
     /**
      * @return The first search path
      */
@@ -1,6 +1,7 @@
 #include "Layout.h"
 
 #include <algorithm>
+#include <cmath>
 #include <numeric>
 #include <optional>
 #include <utility>
@@ -8,6 +9,7 @@
 #include "control/Control.h"
 #include "gui/scroll/ScrollHandling.h"
 #include "gui/widgets/XournalWidget.h"
+#include "model/XojPage.h"
 #include "util/Rectangle.h"
 #include "util/safe_casts.h"
 
@@ -15,6 +17,21 @@
 
 using xoj::util::Rectangle;
 
+/**
+ * Time after which the scrolling is considered stopped, in seconds
+ */
+constexpr double SCROLL_PAUSE = 0.25;
+
+/**
+ * The pages which will enter the viewport within this time, at the current scrolling velocity, are rendered ahead
+ */
+constexpr double RENDER_AHEAD_TIME = 0.5;
+
+/**
+ * Largest distance rendered ahead, in viewports
+ */
+constexpr double MAX_RENDER_AHEAD = 2;
+
 /**
  * Padding outside the pages, including shadow
  */
@@ -40,71 +57,215 @@ Layout::Layout(XournalView* view, ScrollHandling* scrollHandling): view(view), s
     lastScrollVertical = gtk_adjustment_get_value(scrollHandling->getVertical());
 }
 
+Layout::~Layout() {
+    if (this->scrollTickId) {
+        gtk_widget_remove_tick_callback(this->scrollTickWidget, this->scrollTickId);
+    }
+}
+
 void Layout::horizontalScrollChanged(GtkAdjustment* adjustment, Layout* layout) {
-    Layout::checkScroll(adjustment, layout->lastScrollHorizontal);
+    Layout::checkScroll(adjustment, layout->lastScrollHorizontal, layout->horizontalMotion);
     layout->updateVisibility();
 }
 
 void Layout::verticalScrollChanged(GtkAdjustment* adjustment, Layout* layout) {
-    Layout::checkScroll(adjustment, layout->lastScrollVertical);
+    Layout::checkScroll(adjustment, layout->lastScrollVertical, layout->verticalMotion);
     layout->updateVisibility();
 }
 
 
-void Layout::checkScroll(GtkAdjustment* adjustment, double& lastScroll) {
-    lastScroll = gtk_adjustment_get_value(adjustment);
+void Layout::checkScroll(GtkAdjustment* adjustment, double& lastScroll, ScrollMotion& motion) {
+    double value = gtk_adjustment_get_value(adjustment);
+    gint64 now = g_get_monotonic_time();
+    double elapsed = static_cast<double>(now - motion.time) / G_USEC_PER_SEC;
+
+    if (motion.time == 0 || elapsed > SCROLL_PAUSE) {
+        // Starts scrolling
+        motion.velocity = 0;
+    } else if (elapsed > 0) {
+        // Smoothed, the scroll events come at irregular intervals
+        motion.velocity = 0.5 * motion.velocity + 0.5 * (value - lastScroll) / elapsed;
+    }
+    motion.time = now;
+
+    lastScroll = value;
+}
+
+auto Layout::getPagesInArea(const Rectangle<double>& area) const -> std::vector<size_t> {
+    // The rows and columns overlapping the area. rowYStart and colXStart hold the end of each row and column, in
+    // increasing order.
+    auto range = [](const std::vector<unsigned>& ends, double start, double end) -> std::pair<size_t, size_t> {
+        auto first = std::lower_bound(ends.begin(), ends.end(), start,
+                                      [](unsigned e, double v) { return static_cast<double>(e) < v; });
+        auto last = std::upper_bound(ends.begin(), ends.end(), end,
+                                     [](double v, unsigned e) { return v < static_cast<double>(e); });
+        // The row or column ending after the area may start before its end
+        if (last != ends.end()) {
+            ++last;
+        }
+        return {static_cast<size_t>(first - ends.begin()), static_cast<size_t>(last - ends.begin())};
+    };
+    auto [firstRow, endRow] = range(this->rowYStart, area.y, area.y + area.height);
+    auto [firstCol, endCol] = range(this->colXStart, area.x, area.x + area.width);
+
+    std::vector<size_t> pages;
+    for (size_t row = firstRow; row < endRow; ++row) {
+        for (size_t col = firstCol; col < endCol; ++col) {
+            if (auto optionalPage = this->mapper.at({col, row}); optionalPage) {
+                pages.push_back(*optionalPage);
+            }
+        }
+    }
+    return pages;
 }
 
 void Layout::updateVisibility() {
     Rectangle visRect = getVisibleRect();
 
-    // step through every possible page position and update using p->setIsVisible()
-    // Using initial grid aprox speeds things up by a factor of 5.  See previous git check-in for specifics.
-    int x1 = 0;
-    int y1 = 0;
-
     // Data to select page based on visibility
     std::optional<size_t> mostPageNr;
     double mostPagePercent = 0;
 
-    for (size_t row = 0; row < this->rowYStart.size(); ++row) {
-        auto y2 = as_signed_strict(this->rowYStart[row]);
-        for (size_t col = 0; col < this->colXStart.size(); ++col) {
-            auto x2 = as_signed_strict(this->colXStart[col]);
-            auto optionalPage = this->mapper.at({col, row});
-            if (optionalPage)  // a page exists at this grid location
-            {
-                XojPageView* pageView = this->view->viewPages[*optionalPage];
-
-
-                // check if grid location is visible as an aprox for page visiblity:
-                if (!(visRect.x > x2 || visRect.x + visRect.width < x1)  // visrect not outside current row/col
-                    && !(visRect.y > y2 || visRect.y + visRect.height < y1)) {
-                    // now use exact check of page itself:
-                    // visrect not outside current page dimensions:
-                    auto const& pageRect = pageView->getRect();
-                    if (auto intersection = pageRect.intersects(visRect); intersection) {
-                        pageView->setIsVisible(true);
-                        // Set the selected page
-                        double percent = intersection->area() / pageRect.area();
-
-                        if (percent > mostPagePercent) {
-                            mostPageNr = *optionalPage;
-                            mostPagePercent = percent;
-                        }
-                    }
-                } else {
-                    pageView->setIsVisible(false);
-                }
+    std::vector<size_t> nowVisible;
+    for (size_t page: getPagesInArea(visRect)) {
+        // exact check of the page itself, it may be smaller than its row and column
+        auto const& pageRect = getPageRect(page);
+        if (auto intersection = pageRect.intersects(visRect); intersection) {
+            this->view->getViewFor(page)->setIsVisible(true);
+            nowVisible.push_back(page);
+
+            // Set the selected page
+            double percent = intersection->area() / pageRect.area();
+            if (percent > mostPagePercent) {
+                mostPageNr = page;
+                mostPagePercent = percent;
             }
-            x1 = x2;
         }
-        y1 = y2;
-        x1 = 0;
     }
 
-    if (mostPageNr) {
+    // Only the pages which were visible are hidden, instead of all the other pages of the document
+    std::sort(nowVisible.begin(), nowVisible.end());
+    for (size_t page: this->visiblePages) {
+        XojPageView* pageView = this->view->getExistingViewFor(page);
+        if (pageView && !std::binary_search(nowVisible.begin(), nowVisible.end(), page)) {
+            pageView->setIsVisible(false);
+        }
+    }
+    auto hidden = std::move(this->visiblePages);
+    this->visiblePages = std::move(nowVisible);
+
+    updateRenderAhead(visRect);
+
+    // The pages scrolled away are not drawn anymore: their running jobs are obsolete
+    for (size_t page: hidden) {
+        XojPageView* pageView = this->view->getExistingViewFor(page);
+        if (pageView && !std::binary_search(this->visiblePages.begin(), this->visiblePages.end(), page) &&
+            !std::binary_search(this->renderAheadPages.begin(), this->renderAheadPages.end(), page)) {
+            pageView->cancelRendering();
+        }
+    }
+
+    if (mostPageNr && *mostPageNr != this->view->getCurrentPage()) {
         this->view->getControl()->firePageSelected(*mostPageNr);
+        this->view->prefetchPdfBackgrounds(*mostPageNr);
+    }
+}
+
+void Layout::updateRenderAhead(const Rectangle<double>& visRect) {
+    // The area about to enter the viewport, in the direction of the scrolling
+    Rectangle<double> ahead = visRect;
+    double dx = std::clamp(this->horizontalMotion.velocity * RENDER_AHEAD_TIME, -MAX_RENDER_AHEAD * visRect.width,
+                           MAX_RENDER_AHEAD * visRect.width);
+    double dy = std::clamp(this->verticalMotion.velocity * RENDER_AHEAD_TIME, -MAX_RENDER_AHEAD * visRect.height,
+                           MAX_RENDER_AHEAD * visRect.height);
+    ahead.x += std::min(dx, 0.0);
+    ahead.width += std::abs(dx);
+    ahead.y += std::min(dy, 0.0);
+    ahead.height += std::abs(dy);
+
+    std::vector<size_t> nowAhead;
+    if (dx != 0 || dy != 0) {
+        double zoom = this->view->getZoom();
+        for (size_t page: getPagesInArea(ahead)) {
+            auto const& pageRect = getPageRect(page);
+            auto intersection = pageRect.intersects(ahead);
+            if (!intersection) {
+                continue;
+            }
+            // In page coordinates
+            XojPageView* pageView = this->view->getViewFor(page);
+            pageView->renderAhead(Rectangle<double>((intersection->x - pageRect.x) / zoom,
+                                                    (intersection->y - pageRect.y) / zoom,
+                                                    intersection->width / zoom, intersection->height / zoom));
+            nowAhead.push_back(page);
+        }
+    }
+
+    // The jobs of the pages left behind are obsolete
+    std::sort(nowAhead.begin(), nowAhead.end());
+    for (size_t page: this->renderAheadPages) {
+        XojPageView* pageView = this->view->getExistingViewFor(page);
+        if (pageView && !std::binary_search(nowAhead.begin(), nowAhead.end(), page)) {
+            pageView->cancelRenderAhead();
+        }
+    }
+    this->renderAheadPages = std::move(nowAhead);
+}
+
+auto Layout::getRenderAheadPages() const -> const std::vector<size_t>& { return this->renderAheadPages; }
+
+auto Layout::isScrolling() const -> bool {
+    if (this->kineticScroller.isActive()) {
+        return true;
+    }
+    gint64 last = std::max(this->horizontalMotion.time, this->verticalMotion.time);
+    return last != 0 && static_cast<double>(g_get_monotonic_time() - last) / G_USEC_PER_SEC <= SCROLL_PAUSE;
+}
+
+auto Layout::getVisiblePages() const -> const std::vector<size_t>& { return this->visiblePages; }
+
+auto Layout::getPageRect(size_t page) const -> Rectangle<double> {
+    if (page >= this->mapper.pageToRaster.size() || page >= this->view->pageSlots.size() || this->colX.empty()) {
+        return Rectangle<double>(0, 0, 0, 0);
+    }
+    // Rounded like XojPageView::getRect()
+    double zoom = this->view->getZoom();
+    const PageRef& p = this->view->pageSlots[page].page;
+    auto position = getPagePosition(page);
+    return Rectangle<double>(position.x, position.y, std::lround(p->getWidth() * zoom),
+                             std::lround(p->getHeight() * zoom));
+}
+
+auto Layout::getPagePosition(size_t page) const -> PagePosition {
+    auto const& raster = this->mapper.at(page);
+    if (raster.col >= this->colX.size() || raster.row >= this->rowY.size()) {
+        return {};
+    }
+
+    // Aligned in its column as the pages are laid out
+    double const vDisplayWidth = this->view->pageSlots[page].page->getWidth() * this->pc.zoom;
+    double const columnPadding = this->pc.widthCols[raster.col] - vDisplayWidth;
+    double paddingLeft = 0;
+    if (this->mapper.isPairedPages() && this->view->pageSlots.size() > 1) {
+        // pair pages mode: the even columns are aligned right, the odd ones left
+        paddingLeft = raster.col % 2 == 0 ? XOURNAL_PADDING_BETWEEN - XOURNAL_ROOM_FOR_SHADOW + columnPadding :
+                                            XOURNAL_ROOM_FOR_SHADOW;
+    } else {  // not paired page mode - center
+        paddingLeft = XOURNAL_PADDING_BETWEEN / 2.0 + columnPadding / 2.0;
+    }
+    return {floor_cast<int>(this->colX[raster.col] + paddingLeft), floor_cast<int>(this->rowY[raster.row])};
+}
+
+void Layout::placeView(XojPageView* view, size_t page) const {
+    if (page < this->mapper.pageToRaster.size() && page < this->view->pageSlots.size()) {
+        auto position = getPagePosition(page);
+        view->setX(position.x);
+        view->setY(position.y);
+    }
+    if (page < this->mapper.pageToRaster.size()) {
+        // store row and column for e.g. proper arrow key navigation
+        auto const& raster = this->mapper.at(page);
+        view->setMappedRowCol(strict_cast<int>(raster.row), strict_cast<int>(raster.col));
     }
 }
 
@@ -136,23 +297,47 @@ constexpr auto sumIf = [](auto base, auto addend, bool predicate) {
 };
 void Layout::recalculate_int() const {
     auto* settings = view->getControl()->getSettings();
-    auto len = view->viewPages.size();
-    mapper.configureFromSettings(len, settings);
+    auto len = view->pageSlots.size();
+    double zoom = view->getZoom();
+    if (mapper.configureFromSettings(len, settings)) {
+        // The pages moved to other rows and columns
+        pc.sizesValid = false;
+    }
     auto colCount = mapper.getColumns();
     auto rowCount = mapper.getRows();
 
-    pc.widthCols.assign(colCount, 0);
-    pc.heightRows.assign(rowCount, 0);
-
-    for (size_t pageIdx{}; pageIdx < len; ++pageIdx) {
-        auto const& raster_p = mapper.at(pageIdx);  // auto [c, r] raster = mapper.at();
-        auto const& c = raster_p.col;
-        auto const& r = raster_p.row;
-        XojPageView* v = view->viewPages[pageIdx];
-        pc.widthCols[c] = std::max(pc.widthCols[c], v->getDisplayWidthDouble());
-        pc.heightRows[r] = std::max(pc.heightRows[r], v->getDisplayHeightDouble());
+    if (!pc.sizesValid || pc.pageSizes.size() != len) {
+        pc.pageSizes.resize(len);
+        pc.pageWidthCols.assign(colCount, 0);
+        pc.pageHeightRows.assign(rowCount, 0);
+
+        for (size_t pageIdx{}; pageIdx < len; ++pageIdx) {
+            auto const& raster_p = mapper.at(pageIdx);  // auto [c, r] raster = mapper.at();
+            auto const& c = raster_p.col;
+            auto const& r = raster_p.row;
+            // Only the sizes are needed: most pages have no XojPageView
+            const PageRef& p = view->pageSlots[pageIdx].page;
+            pc.pageSizes[pageIdx] = {p->getWidth(), p->getHeight()};
+            pc.pageWidthCols[c] = std::max(pc.pageWidthCols[c], p->getWidth());
+            pc.pageHeightRows[r] = std::max(pc.pageHeightRows[r], p->getHeight());
+        }
+        pc.dirtyCols.clear();
+        pc.dirtyRows.clear();
+        pc.sizesValid = true;
+    } else {
+        measureDirty();
     }
 
+    // The zoom is applied to the largest page of each column and row only: the largest zoomed page is the zoomed
+    // largest page
+    pc.widthCols.resize(colCount);
+    pc.heightRows.resize(rowCount);
+    std::transform(begin(pc.pageWidthCols), end(pc.pageWidthCols), begin(pc.widthCols),
+                   [zoom](double width) { return width * zoom; });
+    std::transform(begin(pc.pageHeightRows), end(pc.pageHeightRows), begin(pc.heightRows),
+                   [zoom](double height) { return height * zoom; });
+    pc.zoom = zoom;
+
     // add space around the entire page area to accommodate older Wacom tablets with limited sense area.
     auto const vPadding =
             sumIf(XOURNAL_PADDING, settings->getAddVerticalSpaceAmount(), settings->getAddVerticalSpace());
@@ -167,11 +352,74 @@ void Layout::recalculate_int() const {
     pc.valid = true;
 }
 
+void Layout::measureDirty() const {
+    auto sortUnique = [](std::vector<size_t>& v) {
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+    };
+    sortUnique(pc.dirtyCols);
+    sortUnique(pc.dirtyRows);
+
+    for (size_t c: pc.dirtyCols) {
+        pc.pageWidthCols[c] = 0;
+        for (size_t r = 0; r < pc.pageHeightRows.size(); r++) {
+            if (auto page = mapper.at({c, r}); page) {
+                pc.pageWidthCols[c] = std::max(pc.pageWidthCols[c], pc.pageSizes[*page].width);
+            }
+        }
+    }
+    for (size_t r: pc.dirtyRows) {
+        pc.pageHeightRows[r] = 0;
+        for (size_t c = 0; c < pc.pageWidthCols.size(); c++) {
+            if (auto page = mapper.at({c, r}); page) {
+                pc.pageHeightRows[r] = std::max(pc.pageHeightRows[r], pc.pageSizes[*page].height);
+            }
+        }
+    }
+    pc.dirtyCols.clear();
+    pc.dirtyRows.clear();
+}
+
 void Layout::recalculate() {
     pc.valid = false;
+    pc.sizesValid = false;
     gtk_widget_queue_resize(view->getWidget());
 }
 
+void Layout::recalculateZoom() {
+    pc.valid = false;
+    gtk_widget_queue_resize(view->getWidget());
+}
+
+void Layout::recalculatePage(size_t page) {
+    std::lock_guard g{pc.m};
+    if (pc.sizesValid && page < pc.pageSizes.size() && page < mapper.pageToRaster.size() &&
+        page < view->pageSlots.size()) {
+        auto const& raster = mapper.at(page);
+        const PageRef& p = view->pageSlots[page].page;
+        PreCalculated::Size size{p->getWidth(), p->getHeight()};
+        PreCalculated::Size previous = pc.pageSizes[page];
+        pc.pageSizes[page] = size;
+
+        // A larger page is the largest of its column or row, a smaller one may have been
+        double& widthCol = pc.pageWidthCols[raster.col];
+        if (size.width >= widthCol) {
+            widthCol = size.width;
+        } else if (previous.width >= widthCol) {
+            pc.dirtyCols.push_back(raster.col);
+        }
+        double& heightRow = pc.pageHeightRows[raster.row];
+        if (size.height >= heightRow) {
+            heightRow = size.height;
+        } else if (previous.height >= heightRow) {
+            pc.dirtyRows.push_back(raster.row);
+        }
+    } else {
+        pc.sizesValid = false;
+    }
+    recalculateZoom();
+}
+
 void Layout::layoutPages(int width, int height) {
     std::lock_guard g{pc.m};
     if (!pc.valid) {
@@ -181,16 +429,9 @@ void Layout::layoutPages(int width, int height) {
     scrollHandling->setLayoutSize(std::max(width, strict_cast<int>(this->pc.minWidth)),
                                   std::max(height, strict_cast<int>(this->pc.minHeight)));
 
-    size_t const len = this->view->viewPages.size();
+    size_t const len = this->view->pageSlots.size();
     Settings* settings = this->view->getControl()->getSettings();
 
-    // get from mapper (some may have changed to accommodate paired setting etc.)
-    bool const isPairedPages = this->mapper.isPairedPages();
-
-    auto const rows = this->pc.heightRows.size();
-    auto const columns = this->pc.widthCols.size();
-
-
     // add space around the entire page area to accommodate older Wacom tablets with limited sense area.
     auto const v_padding =
             sumIf(XOURNAL_PADDING, settings->getAddVerticalSpaceAmount(), settings->getAddVerticalSpace());
@@ -204,59 +445,27 @@ void Layout::layoutPages(int width, int height) {
     auto const borderX = static_cast<double>(std::max<SBig>(h_padding, centeringXBorder));
     auto const borderY = static_cast<double>(std::max<SBig>(v_padding, centeringYBorder));
 
-    // initialize here and x again in loop below.
-    auto x = borderX;
-    auto y = borderY;
-
-
-    // Iterate over ALL possible rows and columns.
-    // We don't know which page, if any,  is to be displayed in each row, column -  ask the mapper object!
-    // Then assign that page coordinates with center, left or right justify within row,column grid cell as required.
-    for (size_t r = 0; r < rows; r++) {
-        for (size_t c = 0; c < columns; c++) {
-            auto optionalPage = this->mapper.at({c, r});
-
-            if (optionalPage) {
-
-                XojPageView* v = this->view->viewPages[*optionalPage];
-                v->setMappedRowCol(strict_cast<int>(r),
-                                   strict_cast<int>(c));  // store row and column for e.g. proper arrow key navigation
-                auto vDisplayWidth = v->getDisplayWidthDouble();
-                {
-                    auto paddingLeft = 0.0;
-                    auto paddingRight = 0.0;
-                    auto columnPadding = this->pc.widthCols[c] - vDisplayWidth;
-
-                    if (isPairedPages && len > 1) {
-                        // pair pages mode
-                        if (c % 2 == 0) {
-                            // align right
-                            paddingLeft = XOURNAL_PADDING_BETWEEN - XOURNAL_ROOM_FOR_SHADOW + columnPadding;
-                            paddingRight = XOURNAL_ROOM_FOR_SHADOW;
-                        } else {  // align left
-                            paddingLeft = XOURNAL_ROOM_FOR_SHADOW;
-                            paddingRight = XOURNAL_PADDING_BETWEEN - XOURNAL_ROOM_FOR_SHADOW + columnPadding;
-                        }
-                    } else {  // not paired page mode - center
-                        paddingLeft = XOURNAL_PADDING_BETWEEN / 2.0 + columnPadding / 2.0;  // center justify
-                        paddingRight = XOURNAL_PADDING_BETWEEN - paddingLeft + columnPadding / 2.0;
-                    }
-
-                    x += paddingLeft;
-
-                    v->setX(floor_cast<int>(x));  // set the page position
-                    v->setY(floor_cast<int>(y));
-
-                    x += vDisplayWidth + paddingRight;
-                }
-            } else {
-                x += this->pc.widthCols[c] + XOURNAL_PADDING_BETWEEN;
-            }
-        }
-        x = borderX;
+    // The pages are positioned within the grid cells when needed, see getPagePosition(): only the rows and the
+    // columns are laid out, without looking at the pages
+    this->colX.resize(this->pc.widthCols.size());
+    this->rowY.resize(this->pc.heightRows.size());
+    double x = borderX;
+    for (size_t c = 0; c < this->colX.size(); c++) {
+        this->colX[c] = x;
+        x += this->pc.widthCols[c] + XOURNAL_PADDING_BETWEEN;
+    }
+    double y = borderY;
+    for (size_t r = 0; r < this->rowY.size(); r++) {
+        this->rowY[r] = y;
         y += this->pc.heightRows[r] + XOURNAL_PADDING_BETWEEN;
     }
 
+    for (size_t page = 0; page < len; page++) {
+        if (XojPageView* v = this->view->getExistingViewFor(page)) {
+            placeView(v, page);
+        }
+    }
+
     this->colXStart.resize(this->pc.widthCols.size());
     this->rowYStart.resize(this->pc.heightRows.size());
 
@@ -338,6 +547,47 @@ void Layout::scrollAbs(double x, double y) {
     gtk_adjustment_set_value(scrollHandling->getVertical(), y);
 }
 
+void Layout::queueScroll(double x, double y) {
+    this->kineticScroller.addDelta(x, y, g_get_monotonic_time());
+    ensureScrollTick();
+}
+
+void Layout::flingScroll() {
+    this->kineticScroller.release(g_get_monotonic_time());
+    ensureScrollTick();
+}
+
+void Layout::stopFling() { this->kineticScroller.stop(); }
+
+void Layout::ensureScrollTick() {
+    if (this->scrollTickId || !this->kineticScroller.isActive()) {
+        return;
+    }
+    this->scrollTickWidget = this->view->getWidget();
+    this->scrollTickId = gtk_widget_add_tick_callback(this->scrollTickWidget,
+                                                      reinterpret_cast<GtkTickCallback>(scrollTick), this, nullptr);
+}
+
+auto Layout::scrollTick(GtkWidget* widget, GdkFrameClock* clock, Layout* self) -> gboolean {
+    auto delta = self->kineticScroller.frame(gdk_frame_clock_get_frame_time(clock));
+
+    GtkAdjustment* h = self->scrollHandling->getHorizontal();
+    GtkAdjustment* v = self->scrollHandling->getVertical();
+    double x = gtk_adjustment_get_value(h);
+    double y = gtk_adjustment_get_value(v);
+    self->scrollRelative(delta.x, delta.y);
+
+    // The kinetic scrolling stops at the end of the document
+    if (gtk_adjustment_get_value(h) == x && gtk_adjustment_get_value(v) == y) {
+        self->kineticScroller.stop();
+    }
+
+    if (self->kineticScroller.isActive()) {
+        return G_SOURCE_CONTINUE;
+    }
+    self->scrollTickId = 0;
+    return G_SOURCE_REMOVE;
+}
 
 void Layout::ensureRectIsVisible(int x, int y, int width, int height) {
     gtk_adjustment_clamp_page(scrollHandling->getHorizontal(), x - 5, x + width + 10);
@@ -354,8 +604,11 @@ auto Layout::getPageViewAt(int x, int y) -> XojPageView* {
 
     auto optionalPage = this->mapper.at({foundCol, foundRow});
 
-    if (optionalPage && this->view->viewPages[*optionalPage]->containsPoint(x, y, false)) {
-        return this->view->viewPages[*optionalPage];
+    if (optionalPage) {
+        auto rect = getPageRect(*optionalPage);
+        if (rect.x <= x && x <= rect.x + rect.width && rect.y <= y && y <= rect.y + rect.height) {
+            return this->view->getViewFor(*optionalPage);
+        }
     }
 
     return nullptr;
@@ -17,6 +17,7 @@
 
 #include <gtk/gtk.h>
 
+#include "gui/scroll/KineticScroller.h"
 #include "util/Rectangle.h"
 
 #include "LayoutMapper.h"
@@ -36,6 +37,11 @@ class ScrollHandling;
 class Layout final {
 public:
     Layout(XournalView* view, ScrollHandling* scrollHandling);
+    ~Layout();
+
+    Layout(const Layout&) = delete;
+    Layout& operator=(const Layout&) = delete;
+
     struct PreCalculated {
         std::mutex m;
 
@@ -44,7 +50,23 @@ public:
         size_t minHeight = 0;
         std::vector<double> widthCols;
         std::vector<double> heightRows;
+        /// The zoom of widthCols and heightRows
+        double zoom = 1;
         bool valid = false;
+
+        // The same without the zoom, which are kept when only the zoom changes
+        struct Size {
+            double width = 0;
+            double height = 0;
+        };
+        std::vector<Size> pageSizes;
+        std::vector<double> pageWidthCols;
+        std::vector<double> pageHeightRows;
+        bool sizesValid = false;
+
+        /// The columns and rows whose largest page may have shrunk, measured again by recalculate_int()
+        std::vector<size_t> dirtyCols;
+        std::vector<size_t> dirtyRows;
     };
 
 public:
@@ -60,6 +82,22 @@ public:
      */
     void scrollAbs(double x, double y);
 
+    /**
+     * Scrolls by the given amounts at the next frame, with the other amounts of the frame, for the touch scrolling.
+     * Tracks the velocity for flingScroll().
+     */
+    void queueScroll(double x, double y);
+
+    /**
+     * The finger is lifted: keeps scrolling and slows down, if it was moving
+     */
+    void flingScroll();
+
+    /**
+     * Stops the scrolling started by flingScroll()
+     */
+    void stopFling();
+
     // Todo(Fabian): move to XournalView
     /**
      * Changes the adjustments in such a way as to make sure that
@@ -92,6 +130,17 @@ public:
      */
     void recalculate();
 
+    /**
+     * Like recalculate(), once the zoom or the size of the window changed: the sizes of the pages are not measured
+     * again
+     */
+    void recalculateZoom();
+
+    /**
+     * Like recalculate(), once the size of a page changed: only its row and column are measured again
+     */
+    void recalculatePage(size_t page);
+
     /**
      * Performs a layout of the XojPageView's managed in this Layout
      * Sets out pages in a grid.
@@ -108,6 +157,37 @@ public:
      */
     void updateVisibility();
 
+    /**
+     * @return The pages about to enter the viewport, whose buffers are kept, in increasing order
+     */
+    const std::vector<size_t>& getRenderAheadPages() const;
+
+    /**
+     * @return Whether the view scrolled during the last SCROLL_PAUSE, or scrolls kinetically
+     */
+    bool isScrolling() const;
+
+    /**
+     * @return The pages found visible by the last updateVisibility(), in increasing order
+     */
+    const std::vector<size_t>& getVisiblePages() const;
+
+    /**
+     * @return The pages of the grid slots intersecting the area, which may be larger than the pages themselves
+     */
+    std::vector<size_t> getPagesInArea(const xoj::util::Rectangle<double>& area) const;
+
+    /**
+     * @return The area of the page in the widget, as set by the last layoutPages(). The page does not need a
+     *         XojPageView.
+     */
+    xoj::util::Rectangle<double> getPageRect(size_t page) const;
+
+    /**
+     * Sets the position of a XojPageView created after the last layoutPages()
+     */
+    void placeView(XojPageView* view, size_t page) const;
+
     /**
      * Return the pageview containing co-ordinates.
      */
@@ -149,8 +229,51 @@ protected:
 
 private:
     void recalculate_int() const;
+
+    /**
+     * Measures again the rows and columns of recalculatePage()
+     */
+    void measureDirty() const;
+
+    /**
+     * The top left corner of a page
+     */
+    struct PagePosition {
+        int x = 0;
+        int y = 0;
+    };
+
+    /**
+     * @return The position of the page in its grid cell, from the sizes of the last layoutPages()
+     */
+    PagePosition getPagePosition(size_t page) const;
+
+    struct ScrollMotion {
+        /**
+         * In pixels per second
+         */
+        double velocity = 0;
+
+        /**
+         * Of the last scroll event, in microseconds, see g_get_monotonic_time()
+         */
+        gint64 time = 0;
+    };
+
     // Todo(Fabian): move to ScrollHandling also it must not depend on Layout
-    static void checkScroll(GtkAdjustment* adjustment, double& lastScroll);
+    static void checkScroll(GtkAdjustment* adjustment, double& lastScroll, ScrollMotion& motion);
+
+    static gboolean scrollTick(GtkWidget* widget, GdkFrameClock* clock, Layout* self);
+
+    /**
+     * Scrolls at the next frames, as long as the kinetic scroller is active
+     */
+    void ensureScrollTick();
+
+    /**
+     * Renders ahead the pages about to enter the viewport, according to the scrolling velocity
+     */
+    void updateRenderAhead(const xoj::util::Rectangle<double>& visRect);
 
     /**
      * Calls the scroll handler to set the layout size by updating the horizontal and vertical GtkAdjustments
@@ -165,6 +288,17 @@ private:
     // Todo(Fabian): move to ScrollHandling also it must not depend on Layout
     double lastScrollHorizontal = -1;
     double lastScrollVertical = -1;
+    ScrollMotion horizontalMotion;
+    ScrollMotion verticalMotion;
+
+    KineticScroller kineticScroller;
+    GtkWidget* scrollTickWidget = nullptr;
+    guint scrollTickId = 0;
+
+    /**
+     * The pages rendered ahead by the last updateRenderAhead(), in increasing order
+     */
+    std::vector<size_t> renderAheadPages;
 
     /**
      * layoutPages invalidates the precalculation of recalculate
@@ -175,4 +309,16 @@ private:
     mutable PreCalculated pc{};
     mutable std::vector<unsigned> colXStart;
     mutable std::vector<unsigned> rowYStart;
+
+    /**
+     * The left of each column and the top of each row, set by layoutPages()
+     */
+    std::vector<double> colX;
+    std::vector<double> rowY;
+
+
+    /**
+     * The pages found visible by the last updateVisibility(), in increasing order
+     */
+    std::vector<size_t> visiblePages;
 };
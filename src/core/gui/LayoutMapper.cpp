@@ -119,7 +119,7 @@ void calculate(LayoutSettings& data, size_t numRows, size_t numCols, bool useRow
     }
 }
 
-void LayoutMapper::configureFromSettings(size_t numPages, Settings* settings) {
+auto LayoutMapper::configureFromSettings(size_t numPages, Settings* settings) -> bool {
     LayoutSettings data;
     // get from user settings:
     data.actualPages = numPages;
@@ -139,10 +139,11 @@ void LayoutMapper::configureFromSettings(size_t numPages, Settings* settings) {
 
     calculate(data, numRows, numCols, fixRows, pairsOffset);
     if (data == data_) {
-        return;
+        return false;
     }
     data_ = data;
     precalculateMappers();
+    return true;
 }
 
 void LayoutMapper::precalculateMappers() {
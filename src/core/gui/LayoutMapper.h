@@ -79,9 +79,10 @@ public:
      *
      * @param  pages  The number of pages in the document
      * @param  settings  The Settings from which users settings are obtained
+     * @return Whether the pages are mapped to other grid positions than before
      */
 
-    void configureFromSettings(size_t numPages, Settings* settings);
+    bool configureFromSettings(size_t numPages, Settings* settings);
 
     auto at(size_t) const -> GridPosition;
     auto at(GridPosition const&) const -> std::optional<size_t>;
@@ -70,6 +70,7 @@ MainWindow::MainWindow(GladeSearchpath* gladeSearchPath, Control* control):
     g_signal_connect(this->window, "window_state_event", G_CALLBACK(windowStateEventCallback), this);
 
     g_signal_connect(get("buttonCloseSidebar"), "clicked", G_CALLBACK(buttonCloseSidebarClicked), this);
+    g_signal_connect(get("btCancelState"), "clicked", G_CALLBACK(buttonCancelStateClicked), this->control);
 
 
     // "watch over" all events
@@ -253,7 +254,7 @@ void MainWindow::initXournalWidget() {
 
     this->xournal = new XournalView(vpXournal, control, scrollHandling);
 
-    control->getZoomControl()->initZoomHandler(this->window, winXournal, xournal, control);
+    control->getZoomControl()->initZoomHandler(winXournal, xournal, control);
     gtk_widget_show_all(winXournal);
 
     Layout* layout = gtk_xournal_get_layout(this->xournal->getWidget());
@@ -489,6 +490,8 @@ void MainWindow::updateScrollbarSidebarPosition() {
 
 void MainWindow::buttonCloseSidebarClicked(GtkButton* button, MainWindow* win) { win->setSidebarVisible(false); }
 
+void MainWindow::buttonCancelStateClicked(GtkButton* button, Control* control) { control->cancelBackgroundExport(); }
+
 auto MainWindow::onKeyPressCallback(GtkWidget* widget, GdkEventKey* event, MainWindow* win) -> bool {
 
     if (win->getXournal()->getSelection()) {
@@ -543,6 +546,9 @@ void MainWindow::setSidebarVisible(bool visible) {
     }
 
     gtk_widget_set_visible(sidebarWidget, visible);
+    if (control->getSidebar() != nullptr) {
+        control->getSidebar()->setVisible(visible);
+    }
 
     if (visible) {
         gtk_paned_set_position(GTK_PANED(panedContainerWidget), settings->getSidebarWidth());
@@ -755,9 +761,13 @@ void MainWindow::enableAudioPlaybackButtons() { this->getToolMenuHandler()->enab
 void MainWindow::setAudioPlaybackPaused(bool paused) { this->getToolMenuHandler()->setAudioPlaybackPaused(paused); }
 
 void MainWindow::loadMainCSS(GladeSearchpath* gladeSearchPath, const gchar* cssFilename) {
-    auto filepath = gladeSearchPath->findFile("", cssFilename);
     GtkCssProvider* provider = gtk_css_provider_new();
-    gtk_css_provider_load_from_path(provider, filepath.u8string().c_str(), nullptr);
+    if (auto resource = GladeSearchpath::findResource(cssFilename); !resource.empty()) {
+        gtk_css_provider_load_from_resource(provider, resource.c_str());
+    } else {
+        auto filepath = gladeSearchPath->findFile("", cssFilename);
+        gtk_css_provider_load_from_path(provider, filepath.u8string().c_str(), nullptr);
+    }
     gtk_style_context_add_provider_for_screen(gdk_screen_get_default(), GTK_STYLE_PROVIDER(provider),
                                               GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
     g_object_unref(provider);
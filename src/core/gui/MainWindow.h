@@ -129,6 +129,11 @@ private:
 
     static void buttonCloseSidebarClicked(GtkButton* button, MainWindow* win);
 
+    /**
+     * Cancels the export shown in the statusbar
+     */
+    static void buttonCancelStateClicked(GtkButton* button, Control* control);
+
     /**
      * Sidebar show / hidden
      */
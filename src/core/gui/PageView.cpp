@@ -8,8 +8,11 @@
 #include <gdk/gdk.h>
 
 #include "control/Control.h"
+#include "control/PdfLinkIndex.h"
+#include "control/ScrollHandler.h"
 #include "control/SearchControl.h"
 #include "control/jobs/BlockingJob.h"
+#include "control/jobs/RenderJob.h"
 #include "control/settings/ButtonConfig.h"
 #include "control/settings/Settings.h"
 #include "control/tools/ArrowHandler.h"
@@ -25,6 +28,7 @@
 #include "control/tools/SplineHandler.h"
 #include "control/tools/StrokeHandler.h"
 #include "control/tools/VerticalToolHandler.h"
+#include "control/zoom/ZoomControl.h"
 #include "gui/PdfFloatingToolbox.h"
 #include "gui/widgets/XournalWidget.h"
 #include "model/Image.h"
@@ -38,6 +42,7 @@
 #include "undo/TextBoxUndoAction.h"
 #include "util/Range.h"
 #include "util/Rectangle.h"
+#include "util/Profiler.h"
 #include "util/XojMsgBox.h"
 #include "util/i18n.h"
 #include "util/pixbuf-utils.h"
@@ -55,6 +60,12 @@
 using std::string;
 using xoj::util::Rectangle;
 
+/// In pixels: the hand tool follows the link under it if it is released this close to where it was pressed
+constexpr double LINK_TAP_DISTANCE = 4;
+
+/// The page is rendered again as a whole once the rectangles to render again cover this fraction of it
+constexpr double MAX_RERENDER_RECT_RATIO = 0.5;
+
 XojPageView::XojPageView(XournalView* xournal, const PageRef& page):
         page(page),
         xournal(xournal),
@@ -69,6 +80,7 @@ XojPageView::~XojPageView() {
     // Unregister listener before destroying this handler
     this->unregisterListener();
 
+    cancelRendering();
     this->xournal->getControl()->getScheduler()->removePage(this);
     delete this->inputHandler;
     delete this->eraser;
@@ -88,7 +100,8 @@ void XojPageView::setIsVisible(bool visible) {
 }
 
 auto XojPageView::getLastVisibleTime() -> int {
-    if (this->crBuffer == nullptr) {
+    std::lock_guard lock(this->drawingMutex);
+    if (this->buffer.isEmpty()) {
         return -1;
     }
 
@@ -97,13 +110,58 @@ auto XojPageView::getLastVisibleTime() -> int {
 
 void XojPageView::deleteViewBuffer() {
     this->drawingMutex.lock();
-    if (this->crBuffer) {
-        cairo_surface_destroy(this->crBuffer);
-        this->crBuffer = nullptr;
-    }
+    this->buffer.clear();
+    this->layersSnapshot.reset();
     this->drawingMutex.unlock();
 }
 
+auto XojPageView::getTileUses() -> std::vector<uint64_t> {
+    std::lock_guard lock(this->drawingMutex);
+    return this->buffer.getTileUses();
+}
+
+void XojPageView::deleteTilesUsedBefore(uint64_t lastUse) {
+    std::lock_guard lock(this->drawingMutex);
+    this->buffer.dropTilesUsedBefore(lastUse);
+}
+
+auto XojPageView::getSnapshotPixels() -> int {
+    std::lock_guard lock(this->drawingMutex);
+    if (this->layersSnapshot && this->snapshotChanges != this->contentChanges.load()) {
+        // Outdated, it would never be shown again
+        this->layersSnapshot.reset();
+    }
+    return this->layersSnapshot ? static_cast<int>(this->layersSnapshot->getPixelCount()) : 0;
+}
+
+void XojPageView::deleteLayersSnapshot() {
+    std::lock_guard lock(this->drawingMutex);
+    this->layersSnapshot.reset();
+}
+
+auto XojPageView::shareTiles(double scale) -> std::unique_ptr<TiledPageBuffer> {
+    {
+        std::lock_guard rectLock(this->repaintRectMutex);
+        if (this->rerenderComplete || !this->rerenderRects.empty() || this->runningRenderJobs > 0) {
+            return nullptr;
+        }
+    }
+    std::lock_guard lock(this->drawingMutex);
+    if (this->buffer.getTileKeys(scale).empty()) {
+        return nullptr;
+    }
+    auto tiles = this->buffer.share();
+    tiles->dropOtherScales(scale);
+    return tiles;
+}
+
+void XojPageView::adoptTiles(std::unique_ptr<TiledPageBuffer> tiles) {
+    std::lock_guard lock(this->drawingMutex);
+    if (this->buffer.isEmpty()) {
+        this->buffer.swap(*tiles);
+    }
+}
+
 auto XojPageView::containsPoint(int x, int y, bool local) const -> bool {
     if (!local) {
         bool leftOk = this->getX() <= x;
@@ -136,6 +194,12 @@ auto XojPageView::searchTextOnPage(string& text, int* occures, double* top) -> b
         this->search = new SearchControl(page, pdf);
     }
 
+    if (auto pNr = this->page->getPdfPageNr(); pNr != npos) {
+        if (auto layout = xournal->getPdfTextLayout(pNr)) {
+            this->search->setTextLayout(std::move(layout));
+        }
+    }
+
     bool found = this->search->search(text, occures, top);
 
     repaintPage();
@@ -264,8 +328,12 @@ void XojPageView::startText(double x, double y) {
 }
 
 auto XojPageView::onButtonPressEvent(const PositionInputData& pos) -> bool {
+    xoj::util::Profiler::getInstance().markInput();
     Control* control = xournal->getControl();
 
+    // The tools may add the first element to the page
+    xournal->storeBlankPageTiles(this);
+
     if (!this->selected) {
         control->firePageSelected(this->page);
     }
@@ -283,6 +351,16 @@ auto XojPageView::onButtonPressEvent(const PositionInputData& pos) -> bool {
     x /= zoom;
     y /= zoom;
 
+    // Ctrl+click follows the links of the PDF background, a click selects their text
+    if ((h->getToolType() == TOOL_SELECT_PDF_TEXT_LINEAR || h->getToolType() == TOOL_SELECT_PDF_TEXT_RECT) &&
+        pos.isControlDown() && followPdfLinkAt(x, y)) {
+        return true;
+    }
+
+    this->handPressed = h->getToolType() == TOOL_HAND;
+    this->handPressX = x;
+    this->handPressY = y;
+
     XournalppCursor* cursor = xournal->getCursor();
     cursor->setMouseDown(true);
 
@@ -345,7 +423,7 @@ auto XojPageView::onButtonPressEvent(const PositionInputData& pos) -> bool {
                 this->selection = nullptr;
                 repaintPage();
             }
-            this->selection = new RegionSelect(x, y, this);
+            this->selection = new RegionSelect(x, y, this->page, this);
         } else if (h->getToolType() == TOOL_SELECT_PDF_TEXT_LINEAR || h->getToolType() == TOOL_SELECT_PDF_TEXT_RECT) {
             // so if we selected something && the pdf selection toolbox is hidden && we hit within the selection
             // we could call the pdf floating toolbox again
@@ -515,7 +593,8 @@ auto XojPageView::onMotionNotifyEvent(const PositionInputData& pos) -> bool {
 
     if (containsPoint(std::lround(x), std::lround(y), true) && this->inputHandler &&
         this->inputHandler->onMotionNotifyEvent(pos)) {
-        // input handler used this event
+        // input handler used this event, e.g. the live ink
+        xoj::util::Profiler::getInstance().markInput();
     } else if (this->selection) {
         this->selection->currentPos(x, y);
     } else if (auto* selection = pdfToolbox->getSelection(); selection && !selection->isFinalized()) {
@@ -530,11 +609,55 @@ auto XojPageView::onMotionNotifyEvent(const PositionInputData& pos) -> bool {
         this->textEditor->mouseMoved(x - text->getX(), y - text->getY());
     } else if (h->getToolType() == TOOL_ERASER && h->getEraserType() != ERASER_TYPE_WHITEOUT && this->inEraser) {
         this->eraser->erase(x, y);
+    } else if (h->getToolType() == TOOL_SELECT_PDF_TEXT_LINEAR || h->getToolType() == TOOL_SELECT_PDF_TEXT_RECT) {
+        updatePdfLinkHover(pos);
     }
 
     return false;
 }
 
+void XojPageView::updatePdfLinkHover(const PositionInputData& pos) {
+    double zoom = xournal->getZoom();
+    const XojPdfPage::Link* link = getPdfLinkAt(pos.x / zoom, pos.y / zoom);
+    xournal->showPdfLinkHover(link);
+    if (link == nullptr) {
+        this->pdfLinks.reset();
+    }
+}
+
+auto XojPageView::getPdfLinkAt(double x, double y) -> const XojPdfPage::Link* {
+    size_t pdfPage = this->page->getPdfPageNr();
+    if (pdfPage == npos) {
+        return nullptr;
+    }
+    // Looked up again each time: the background may change
+    this->pdfLinks = xournal->getPdfLinks(pdfPage);
+    return this->pdfLinks ? this->pdfLinks->linkAt(x, y) : nullptr;
+}
+
+auto XojPageView::followPdfLinkAt(double x, double y) -> bool {
+    const XojPdfPage::Link* link = getPdfLinkAt(x, y);
+    if (link == nullptr || link->annotation) {
+        return false;
+    }
+
+    Control* control = xournal->getControl();
+    if (link->destPage != npos) {
+        Document* doc = control->getDocument();
+        doc->lock();
+        size_t page = doc->findPdfPage(link->destPage);
+        doc->unlock();
+
+        if (page != npos) {
+            control->getScrollHandler()->scrollToPage(page, link->destTop * control->getZoomControl()->getZoom());
+        }
+        return true;
+    }
+
+    XojMsgBox::showUri(control->getGtkWindow(), link->text);
+    return true;
+}
+
 void XojPageView::onMotionCancelEvent() {
     if (this->inputHandler) {
         this->inputHandler->onMotionCancelEvent();
@@ -556,6 +679,17 @@ auto XojPageView::showPdfToolbox(const PositionInputData& pos) -> void {
 auto XojPageView::onButtonReleaseEvent(const PositionInputData& pos) -> bool {
     Control* control = xournal->getControl();
 
+    if (this->handPressed) {
+        this->handPressed = false;
+        // Dragging scrolls, which moves the page under the pointer
+        double zoom = xournal->getZoom();
+        double x = pos.x / zoom;
+        double y = pos.y / zoom;
+        if (std::hypot(x - this->handPressX, y - this->handPressY) * zoom < LINK_TAP_DISTANCE) {
+            followPdfLinkAt(x, y);
+        }
+    }
+
     if (this->inputHandler) {
         this->inputHandler->onButtonReleaseEvent(pos);
 
@@ -586,9 +720,9 @@ auto XojPageView::onButtonReleaseEvent(const PositionInputData& pos) -> bool {
     if (this->inEraser) {
         this->inEraser = false;
         Document* doc = this->xournal->getControl()->getDocument();
-        doc->lock();
+        doc->lockPage(*this->page);
         this->eraser->finalize();
-        doc->unlock();
+        doc->unlockPage(*this->page);
     }
 
     if (this->verticalSpace) {
@@ -686,10 +820,71 @@ auto XojPageView::onKeyReleaseEvent(GdkEventKey* event) -> bool {
 }
 
 void XojPageView::rerenderPage() {
+    this->contentChanges++;
+    scheduleRerenderPage();
+}
+
+void XojPageView::scheduleRerenderPage() {
     this->rerenderComplete = true;
+    {
+        std::lock_guard lock(this->repaintRectMutex);
+        noteRequestQuality();
+    }
     this->xournal->getControl()->getScheduler()->addRerenderPage(this);
 }
 
+void XojPageView::noteRequestQuality() {
+    if (this->xournal->isDraftRendering()) {
+        this->draftRequested = true;
+    } else {
+        this->finalRequested = true;
+    }
+}
+
+void XojPageView::layerVisibilityChanged(const std::vector<bool>& previous) {
+    auto visibility = this->page->getLayerVisibility();
+    if (visibility == previous) {
+        scheduleRerenderPage();
+        return;
+    }
+
+    // The running jobs render the previous visibility
+    cancelRendering();
+
+    bool restored = false;
+    {
+        std::lock_guard lock(this->drawingMutex);
+
+        bool settled = false;
+        {
+            std::lock_guard rectLock(this->repaintRectMutex);
+            settled = !this->rerenderComplete && this->rerenderRects.empty() && this->runningRenderJobs == 0;
+        }
+
+        uint64_t changes = this->contentChanges.load();
+        if (this->layersSnapshot && this->snapshotChanges == changes && this->snapshotVisibility == visibility) {
+            this->buffer.swap(*this->layersSnapshot);
+            restored = true;
+        } else if (settled) {
+            this->layersSnapshot = this->buffer.share();
+        }
+
+        // Unfinished tiles would be kept for a visibility they do not show
+        if (settled && this->layersSnapshot) {
+            this->snapshotVisibility = previous;
+            this->snapshotChanges = changes;
+        } else {
+            this->layersSnapshot.reset();
+        }
+    }
+
+    if (restored) {
+        repaintPage();
+    } else {
+        scheduleRerenderPage();
+    }
+}
+
 void XojPageView::repaintPage() { xournal->getRepaintHandler()->repaintPage(this); }
 
 void XojPageView::repaintArea(double x1, double y1, double x2, double y2) {
@@ -708,29 +903,108 @@ void XojPageView::rerenderRect(double x, double y, double width, double height)
 }
 
 void XojPageView::addRerenderRect(double x, double y, double width, double height) {
+    this->contentChanges++;
     if (this->rerenderComplete) {
         return;
     }
 
     auto rect = Rectangle<double>{x, y, width, height};
+    const double maxArea = MAX_RERENDER_RECT_RATIO * this->page->getWidth() * this->page->getHeight();
 
     this->repaintRectMutex.lock();
 
+    bool merged = false;
+    double area = 0;
     for (auto&& r: this->rerenderRects) {
         // its faster to redraw only one rect than repaint twice the same area
         // so loop through the rectangles to be redrawn, if new rectangle
         // intersects any of them, replace it by the union with the new one
-        if (r.intersects(rect)) {
+        if (!merged && r.intersects(rect)) {
             r.unite(rect);
-            this->repaintRectMutex.unlock();
-            return;
+            merged = true;
         }
+        area += r.area();
+    }
+    if (!merged) {
+        this->rerenderRects.push_back(rect);
+        area += rect.area();
     }
+    noteRequestQuality();
 
-    this->rerenderRects.push_back(rect);
+    // A large change, e.g. the undo of a move of many elements, is not worth the cutting into rectangles
+    bool large = area >= maxArea;
+    if (large) {
+        this->rerenderRects.clear();
+    }
     this->repaintRectMutex.unlock();
 
-    this->xournal->getControl()->getScheduler()->addRerenderPage(this);
+    if (large) {
+        scheduleRerenderPage();
+    } else if (!merged) {
+        this->xournal->getControl()->getScheduler()->addRerenderPage(this);
+    }
+}
+
+void XojPageView::requestTiles(const std::vector<TiledPageBuffer::TileKey>& tiles) {
+    bool added = false;
+
+    this->repaintRectMutex.lock();
+    for (auto& key: tiles) {
+        if (std::find(this->requestedTiles.begin(), this->requestedTiles.end(), key) == this->requestedTiles.end()) {
+            this->requestedTiles.push_back(key);
+            added = true;
+        }
+    }
+    if (added) {
+        noteRequestQuality();
+    }
+    this->repaintRectMutex.unlock();
+
+    if (added) {
+        this->xournal->getControl()->getScheduler()->addRerenderPage(this);
+    }
+}
+
+void XojPageView::renderAhead(const Rectangle<double>& area) {
+    double scale = xournal->getZoom() * xournal->getDpiScaleFactor();
+    std::vector<TiledPageBuffer::TileKey> tiles;
+    {
+        std::lock_guard lock(this->drawingMutex);
+        tiles = this->buffer.getMissingTiles(scale, area);
+    }
+
+    bool added = false;
+    {
+        std::lock_guard lock(this->repaintRectMutex);
+        for (auto& key: tiles) {
+            if (std::find(this->requestedTiles.begin(), this->requestedTiles.end(), key) ==
+                        this->requestedTiles.end() &&
+                std::find(this->aheadTiles.begin(), this->aheadTiles.end(), key) == this->aheadTiles.end()) {
+                this->aheadTiles.push_back(key);
+                added = true;
+            }
+        }
+        if (added) {
+            noteRequestQuality();
+        }
+    }
+
+    if (added) {
+        this->xournal->getControl()->getScheduler()->addRenderAhead(this);
+    }
+}
+
+void XojPageView::cancelRenderAhead() {
+    this->xournal->getControl()->getScheduler()->removeRenderAhead(this);
+
+    std::lock_guard lock(this->repaintRectMutex);
+    this->aheadTiles.clear();
+}
+
+void XojPageView::cancelRendering() {
+    std::lock_guard lock(this->repaintRectMutex);
+    this->renderGeneration++;
+    for (RenderJob* job: this->renderJobs) { job->cancel(); }
 }
 
 void XojPageView::setSelected(bool selected) {
@@ -799,60 +1073,77 @@ void XojPageView::drawLoadingPage(cairo_t* cr) {
     rerenderPage();
 }
 
+auto XojPageView::paintBufferScaled(cairo_t* cr, double zoom) -> bool {
+    {
+        std::lock_guard lock(this->repaintRectMutex);
+        if (this->rerenderComplete || !this->rerenderRects.empty() || !this->requestedTiles.empty() ||
+            this->runningRenderJobs > 0) {
+            return false;
+        }
+    }
+
+    std::lock_guard lock(this->drawingMutex);
+    double scale = xournal->getZoom() * xournal->getDpiScaleFactor();
+    Rectangle<double> pageRect(0, 0, page->getWidth(), page->getHeight());
+    if (this->buffer.isEmpty() || !this->buffer.getMissingTiles(scale, pageRect).empty()) {
+        return false;
+    }
+    this->buffer.paint(cr, zoom, scale, pageRect, page->getWidth(), page->getHeight());
+    return true;
+}
+
 /**
  * Does the painting, called in synchronized block
  */
 void XojPageView::paintPageSync(cairo_t* cr, GdkRectangle* rect) {
-    if (this->crBuffer == nullptr) {
-        drawLoadingPage(cr);
-        return;
-    }
-
     double zoom = xournal->getZoom();
-    int dispWidth = getDisplayWidth();
-
-    cairo_save(cr);
-
-    double width = cairo_image_surface_get_width(this->crBuffer);
+    double scale = zoom * xournal->getDpiScaleFactor();
 
-    bool rerender = true;
-    if (width / xournal->getDpiScaleFactor() == dispWidth) {
-        rerender = false;
+    // Only the tiles of the area actually painted are needed
+    Rectangle<double> area;
+    if (rect) {
+        area = Rectangle<double>(rect->x, rect->y, rect->width, rect->height);
+    } else {
+        double x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+        cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+        area = Rectangle<double>(x1, y1, x2 - x1, y2 - y1);
     }
+    area *= 1.0 / zoom;
 
-    if (width != dispWidth) {
-        double scale = (static_cast<double>(dispWidth)) / (width);
-
-        // Scale current image to fit the zoom level
-        cairo_scale(cr, scale, scale);
-        cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_FAST);
-
-        cairo_set_source_surface(cr, this->crBuffer, 0, 0);
+    /**
+     * Progressive zoom: while pinching, the tiles of the previous zoom are drawn stretched and only a low resolution
+     * rendering is requested. The full resolution follows when the gesture ends (see XournalView::zoomGestureEnded)
+     */
+    bool zoomGesture = xournal->getControl()->getZoomControl()->isZoomGestureActive();
+    auto visibleArea = area.intersects(Rectangle<double>(0, 0, page->getWidth(), page->getHeight()));
 
-        if (rerender) {
-            rerenderPage();
+    if (this->buffer.isEmpty()) {
+        if (visibleArea) {
+            requestTiles(TiledPageBuffer::tilesInArea(zoomGesture ? TiledPageBuffer::getPreviewScale(scale) : scale,
+                                                      *visibleArea));
         }
-
-        rect = nullptr;
-    } else {
-        cairo_set_source_surface(cr, this->crBuffer, 0, 0);
+        drawLoadingPage(cr);
+        return;
     }
 
-    if (rect) {
-        cairo_rectangle(cr, rect->x, rect->y, rect->width, rect->height);
-        cairo_fill(cr);
+    // The drafts are shown until the interaction ends, then rendered again, see XournalView::isDraftRendering()
+    bool draft = xournal->isDraftRendering();
+    auto missingTiles = this->buffer.paint(cr, zoom, scale, area, page->getWidth(), page->getHeight(), !draft);
+    if (zoomGesture && !missingTiles.empty() && visibleArea) {
+        missingTiles = this->buffer.getMissingTiles(TiledPageBuffer::getPreviewScale(scale), *visibleArea);
+    }
+    if (!missingTiles.empty()) {
+        requestTiles(missingTiles);
+    }
 
 #ifdef DEBUG_SHOW_PAINT_BOUNDS
+    if (rect) {
         cairo_set_source_rgb(cr, 1.0, 0.5, 1.0);
-        cairo_set_line_width(cr, 1. / zoom);
+        cairo_set_line_width(cr, 1.);
         cairo_rectangle(cr, rect->x, rect->y, rect->width, rect->height);
         cairo_stroke(cr);
-#endif
-    } else {
-        cairo_paint(cr);
     }
-
-    cairo_restore(cr);
+#endif
 
     cairo_scale(cr, zoom, zoom);
 
@@ -900,6 +1191,8 @@ void XojPageView::paintPageSync(cairo_t* cr, GdkRectangle* rect) {
 auto XojPageView::paintPage(cairo_t* cr, GdkRectangle* rect) -> bool {
     this->drawingMutex.lock();
 
+    this->buffer.setDeviceCopies(settings->isAcceleratedCompositing());
+
     paintPageSync(cr, rect);
 
     this->drawingMutex.unlock();
@@ -912,11 +1205,15 @@ auto XojPageView::paintPage(cairo_t* cr, GdkRectangle* rect) -> bool {
 
 auto XojPageView::isSelected() const -> bool { return selected; }
 
+auto XojPageView::isRecyclable() const -> bool {
+    return this->textEditor == nullptr && this->inputHandler == nullptr && this->selection == nullptr &&
+           this->verticalSpace == nullptr && !this->inEraser &&
+           (this->search == nullptr || !this->search->hasResults());
+}
+
 auto XojPageView::getBufferPixels() -> int {
-    if (crBuffer) {
-        return cairo_image_surface_get_width(crBuffer) * cairo_image_surface_get_height(crBuffer);
-    }
-    return 0;
+    std::lock_guard lock(this->drawingMutex);
+    return static_cast<int>(this->buffer.getPixelCount());
 }
 
 auto XojPageView::getSelectionColor() -> GdkRGBA { return Util::rgb_to_GdkRGBA(settings->getSelectionColor()); }
@@ -1005,15 +1302,23 @@ void XojPageView::pageChanged() { rerenderPage(); }
 
 void XojPageView::elementChanged(Element* elem) {
     if (this->inputHandler && elem == this->inputHandler->getStroke()) {
+        // The stroke is drawn into the tiles, which the snapshot of the layers may share
+        this->contentChanges++;
         this->drawingMutex.lock();
+        this->layersSnapshot.reset();
 
-        cairo_t* cr = cairo_create(this->crBuffer);
         const double ratio = xournal->getZoom() * static_cast<double>(xournal->getDpiScaleFactor());
-        cairo_scale(cr, ratio, ratio);
+        this->buffer.forEachTile(ratio, elem->boundingRect(),
+                                 [this, ratio](const TiledPageBuffer::TileKey& key, cairo_surface_t* tile) {
+                                     cairo_t* cr = cairo_create(tile);
+                                     cairo_translate(cr, -key.x * TiledPageBuffer::TILE_SIZE,
+                                                     -key.y * TiledPageBuffer::TILE_SIZE);
+                                     cairo_scale(cr, ratio, ratio);
 
-        this->inputHandler->draw(cr);
+                                     this->inputHandler->draw(cr);
 
-        cairo_destroy(cr);
+                                     cairo_destroy(cr);
+                                 });
 
         this->drawingMutex.unlock();
     } else {
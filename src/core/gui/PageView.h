@@ -11,7 +11,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include <cairo.h>
@@ -21,17 +25,21 @@
 #include "model/PageRef.h"
 #include "model/Stroke.h"
 #include "model/TexImage.h"
+#include "pdf/base/XojPdfPage.h"
 #include "util/Range.h"
 
 #include "Layout.h"
 #include "Redrawable.h"
+#include "TiledPageBuffer.h"
 
 class EditSelection;
 class EraseHandler;
 class InputHandler;
+class PdfLinkIndex;
 class SearchControl;
 class Selection;
 class PdfElemSelection;
+class RenderJob;
 class Settings;
 class Text;
 class TextEditor;
@@ -47,6 +55,29 @@ public:
     void updatePageSize(double width, double height);
 
     void rerenderPage() override;
+
+    /**
+     * The visibility of the layers changed: the tiles of the previous visibility are kept, so that toggling a layer
+     * back shows them without rendering the page again
+     *
+     * @param previous The visibility before the change, see XojPage::getLayerVisibility()
+     */
+    void layerVisibilityChanged(const std::vector<bool>& previous);
+
+    /**
+     * Renders the missing tiles of the area (page coordinates), which is about to enter the viewport
+     */
+    void renderAhead(const xoj::util::Rectangle<double>& area);
+
+    /**
+     * The tiles requested by renderAhead() are not needed soon anymore
+     */
+    void cancelRenderAhead();
+
+    /**
+     * Stops the running RenderJob%s, e.g. when the page is scrolled away. Their tiles are not stored.
+     */
+    void cancelRendering();
     void rerenderRect(double x, double y, double width, double height) override;
 
     void repaintPage() override;
@@ -58,6 +89,12 @@ public:
 
     bool isSelected() const;
 
+    /**
+     * @return Whether the view only holds its buffers: no text is edited, no tool is in use and no search result
+     *         is shown. Such a view may be destroyed while its page is far from the viewport, see XournalView.
+     */
+    bool isRecyclable() const;
+
     void endText();
 
     bool searchTextOnPage(std::string& text, int* occures, double* top);
@@ -92,6 +129,37 @@ public:
     GdkRGBA getSelectionColor() override;
     int getBufferPixels();
 
+    /**
+     * Returns the last use of each tile of the view buffer, see TiledPageBuffer
+     */
+    std::vector<uint64_t> getTileUses();
+
+    /**
+     * Frees the tiles of the view buffer which were not used since the given time
+     */
+    void deleteTilesUsedBefore(uint64_t lastUse);
+
+    /**
+     * Returns the number of pixels of the tiles kept for the previous visibility of the layers
+     */
+    int getSnapshotPixels();
+
+    /**
+     * Frees the tiles kept for the previous visibility of the layers
+     */
+    void deleteLayersSnapshot();
+
+    /**
+     * @return A copy sharing the tiles of the view buffer rendered at the given scale, or nullptr if there is none or
+     *         if a rendering is pending, see BlankPageTiles
+     */
+    std::unique_ptr<TiledPageBuffer> shareTiles(double scale);
+
+    /**
+     * Starts the empty view buffer with the given tiles, e.g. these of a page which looks the same
+     */
+    void adoptTiles(std::unique_ptr<TiledPageBuffer> tiles);
+
     /**
      * 0 if currently visible
      * -1 if no image is saved (never visible or cleanup)
@@ -156,6 +224,12 @@ public:  // event handler
     bool onMotionNotifyEvent(const PositionInputData& pos);
     void onMotionCancelEvent();
 
+    /**
+     * Shows whether the pointer hovers a link or an annotation of the PDF background, for the tools following them
+     * (the hand and the PDF text tools)
+     */
+    void updatePdfLinkHover(const PositionInputData& pos);
+
     /**
      * This event fires after onButtonPressEvent and also
      * if no input sequence is actively running and a stylus button was pressed
@@ -168,6 +242,13 @@ public:  // event handler
      */
     bool paintPage(cairo_t* cr, GdkRectangle* rect);
 
+    /**
+     * Paints the whole page from the view buffer at the given zoom, if the buffer covers it and no rendering is pending
+     * @param cr Context in device pixels, translated to the top left corner of the page
+     * @return false if nothing was painted
+     */
+    bool paintBufferScaled(cairo_t* cr, double zoom);
+
     /**
      * Does the painting, called in synchronized block
      */
@@ -186,6 +267,22 @@ private:
 
     void addRerenderRect(double x, double y, double width, double height);
 
+    /**
+     * Renders all the tiles again, without dropping the snapshot of the layers
+     */
+    void scheduleRerenderPage();
+
+    /**
+     * Asks the RenderJob to render the given tiles of the view buffer
+     */
+    void requestTiles(const std::vector<TiledPageBuffer::TileKey>& tiles);
+
+    /**
+     * Notes the quality of a request to the RenderJob, by an interaction or not, see XournalView::isDraftRendering().
+     * Must be called with repaintRectMutex held.
+     */
+    void noteRequestQuality();
+
     void drawLoadingPage(cairo_t* cr);
 
     void setX(int x);
@@ -203,6 +300,18 @@ private:
      */
     void showPdfToolbox(const PositionInputData& pos);
 
+    /**
+     * @return The link or the annotation of the PDF background at the point, or nullptr, e.g. until the links of the
+     *         page are extracted in the background (see XournalView::getPdfLinks())
+     */
+    const XojPdfPage::Link* getPdfLinkAt(double x, double y);
+
+    /**
+     * Scrolls to the destination of the link of the PDF background at the point, or opens its URI
+     * @return false if there is no link
+     */
+    bool followPdfLinkAt(double x, double y);
+
 
 private:
     PageRef page;
@@ -228,10 +337,39 @@ private:
 
     bool selected = false;
 
-    cairo_surface_t* crBuffer = nullptr;
+    /**
+     * The rendered page, guarded by drawingMutex
+     */
+    TiledPageBuffer buffer;
+
+    /**
+     * The tiles of the previous visibility of the layers, or nullptr, guarded by drawingMutex. They share the surfaces
+     * of the buffer until these are rendered again. Only used as long as the content of the page is unchanged.
+     */
+    std::unique_ptr<TiledPageBuffer> layersSnapshot;
+    std::vector<bool> snapshotVisibility;
+    uint64_t snapshotChanges = 0;
+
+    /**
+     * Incremented by every change of the content of the page, which outdates the snapshot of the layers
+     */
+    std::atomic<uint64_t> contentChanges{0};
 
     bool inEraser = false;
 
+    /**
+     * The links of the PDF background, kept while one is hovered, and the tooltip shown for it
+     */
+    std::shared_ptr<const PdfLinkIndex> pdfLinks;
+    std::string pdfLinkTooltip;
+
+    /**
+     * Where the hand tool was pressed: released there, it follows the link
+     */
+    bool handPressed = false;
+    double handPressX = 0;
+    double handPressY = 0;
+
     /**
      * Vertical Space
      */
@@ -250,10 +388,38 @@ private:
     std::mutex repaintRectMutex;
     std::vector<xoj::util::Rectangle<double>> rerenderRects;
     bool rerenderComplete = false;
+    std::vector<TiledPageBuffer::TileKey> requestedTiles;
+
+    /**
+     * Tiles requested by renderAhead(), rendered by a job of lower priority
+     */
+    std::vector<TiledPageBuffer::TileKey> aheadTiles;
+
+    /**
+     * The above requests include ones made during an interaction, and ones made outside of one: the RenderJob renders a
+     * draft if all were made during an interaction
+     */
+    bool draftRequested = false;
+    bool finalRequested = false;
+
+    /**
+     * RenderJobs which took the above requests and did not put their tiles in the buffer yet
+     */
+    int runningRenderJobs = 0;
+
+    /**
+     * The running RenderJob%s, guarded by repaintRectMutex
+     */
+    std::vector<RenderJob*> renderJobs;
+
+    /**
+     * Incremented by cancelRendering(): the RenderJob%s started before only store their tiles if it is unchanged
+     */
+    std::atomic<uint64_t> renderGeneration{0};
 
     std::mutex drawingMutex;
 
-    int dispX{};  // position on display - set in Layout::layoutPages
+    int dispX{};  // position on display - set in Layout::placeView
     int dispY{};
 
 
@@ -268,5 +434,5 @@ private:
     friend class PlayObject;
     friend class PdfFloatingToolbox;
     // only function allowed to setX(), setY(), setMappedRowCol():
-    friend void Layout::layoutPages(int width, int height);
+    friend void Layout::placeView(XojPageView* view, size_t page) const;
 };
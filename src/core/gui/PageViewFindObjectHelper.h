@@ -47,13 +47,14 @@ protected:
          */
         bool found = false;
         double minDistSq = std::numeric_limits<double>::max();
-        for (Element* e: l->getElements()) {
+        const GdkRectangle matchRect = {gint(x - 10), gint(y - 10), 20, 20};
+        const xoj::util::Rectangle<double> area(matchRect.x, matchRect.y, matchRect.width, matchRect.height);
+        for (Element* e: l->getElementsInArea(area)) {
             const double eX = e->getX() + e->getElementWidth() / 2.0;
             const double eY = e->getY() + e->getElementHeight() / 2.0;
             const double dx = eX - this->x;
             const double dy = eY - this->y;
             const double distSq = dx * dx + dy * dy;
-            const GdkRectangle matchRect = {gint(x - 10), gint(y - 10), 20, 20};
             if (e->intersectsArea(&matchRect) && distSq < minDistSq) {
                 if (this->checkElement(e)) {
                     minDistSq = distSq;
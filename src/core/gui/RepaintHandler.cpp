@@ -1,5 +1,7 @@
 #include "RepaintHandler.h"
 
+#include <algorithm>
+
 #include "gui/scroll/ScrollHandling.h"
 #include "gui/widgets/XournalWidget.h"
 
@@ -16,13 +18,43 @@ void RepaintHandler::repaintPage(XojPageView* view) {
     int x2 = x1 + view->getDisplayWidth();
     int y2 = y1 + view->getDisplayHeight();
 
-    gtk_xournal_repaint_area(this->xournal->getWidget(), x1, y1, x2, y2);
+    repaintArea(x1, y1, x2, y2);
 }
 
 void RepaintHandler::repaintPageArea(XojPageView* view, int x1, int y1, int x2, int y2) {
     int x = view->getX();
     int y = view->getY();
-    gtk_xournal_repaint_area(this->xournal->getWidget(), x + x1, y + y1, x + x2, y + y2);
+    repaintArea(x + x1, y + y1, x + x2, y + y2);
+}
+
+void RepaintHandler::repaintArea(int x1, int y1, int x2, int y2) {
+    if (this->batchDepth == 0) {
+        gtk_xournal_repaint_area(this->xournal->getWidget(), x1, y1, x2, y2);
+        return;
+    }
+
+    if (this->batchEmpty) {
+        this->batchX1 = x1;
+        this->batchY1 = y1;
+        this->batchX2 = x2;
+        this->batchY2 = y2;
+        this->batchEmpty = false;
+    } else {
+        this->batchX1 = std::min(this->batchX1, x1);
+        this->batchY1 = std::min(this->batchY1, y1);
+        this->batchX2 = std::max(this->batchX2, x2);
+        this->batchY2 = std::max(this->batchY2, y2);
+    }
+}
+
+void RepaintHandler::beginBatch() { this->batchDepth++; }
+
+void RepaintHandler::endBatch() {
+    if (--this->batchDepth > 0 || this->batchEmpty) {
+        return;
+    }
+    this->batchEmpty = true;
+    gtk_xournal_repaint_area(this->xournal->getWidget(), this->batchX1, this->batchY1, this->batchX2, this->batchY2);
 }
 
-void RepaintHandler::repaintPageBorder(XojPageView* view) { gtk_widget_queue_draw(this->xournal->getWidget()); }
+void RepaintHandler::repaintPageBorder(XojPageView* view) { gtk_xournal_repaint(this->xournal->getWidget()); }
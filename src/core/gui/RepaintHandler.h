@@ -39,6 +39,22 @@ public:
      */
     void repaintPageBorder(XojPageView* view);
 
+    /**
+     * Collect the repainted page areas until endBatch(), and repaint them at once as their bounding box
+     */
+    void beginBatch();
+    void endBatch();
+
+private:
+    void repaintArea(int x1, int y1, int x2, int y2);
+
 private:
     XournalView* xournal;
+
+    int batchDepth = 0;
+    bool batchEmpty = true;
+    int batchX1 = 0;
+    int batchY1 = 0;
+    int batchX2 = 0;
+    int batchY2 = 0;
 };
@@ -3,6 +3,7 @@
 #include <config.h>
 
 #include "control/Control.h"
+#include "control/jobs/SearchJob.h"
 #include "util/i18n.h"
 
 SearchBar::SearchBar(Control* control): control(control) {
@@ -42,7 +43,10 @@ SearchBar::SearchBar(Control* control): control(control) {
                                    GTK_STYLE_PROVIDER(cssTextFild), GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
 }
 
-SearchBar::~SearchBar() { this->control = nullptr; }
+SearchBar::~SearchBar() {
+    cancelSearch();
+    this->control = nullptr;
+}
 
 auto SearchBar::searchTextonCurrentPage(const char* text, int* occures, double* top) -> bool {
     int p = control->getCurrentPageNo();
@@ -51,6 +55,9 @@ auto SearchBar::searchTextonCurrentPage(const char* text, int* occures, double*
 }
 
 void SearchBar::search(const char* text) {
+    // The text changed: the search of the previous one is not needed anymore
+    cancelSearch();
+
     MainWindow* win = control->getWindow();
     GtkWidget* lbSearchState = win->get("lbSearchState");
 
@@ -89,7 +96,11 @@ void SearchBar::searchTextChangedCallback(GtkEntry* entry, SearchBar* searchBar)
 
 void SearchBar::buttonCloseSearchClicked(GtkButton* button, SearchBar* searchBar) { searchBar->showSearchBar(false); }
 
-void SearchBar::searchNext() {
+void SearchBar::searchNext() { startSearch(true); }
+
+void SearchBar::searchPrevious() { startSearch(false); }
+
+void SearchBar::startSearch(bool forward) {
     int page = control->getCurrentPageNo();
     int count = control->getDocument()->getPageCount();
     if (count < 2) {
@@ -98,83 +109,56 @@ void SearchBar::searchNext() {
     }
 
     MainWindow* win = control->getWindow();
-    int x = page + 1;
     GtkWidget* searchTextField = win->get("searchTextField");
     const char* text = gtk_entry_get_text(GTK_ENTRY(searchTextField));
-    GtkWidget* lbSearchState = win->get("lbSearchState");
     if (*text == 0) {
         return;
     }
+    this->index.update(control->getDocument(), control->getScheduler());
 
-    if (x >= count) {
-        x = 0;
-    }
-
-    double top = 0;
-    int occures = 0;
+    cancelSearch();
+    this->searchedText = text;
+    this->searchCancelled = std::make_shared<std::atomic<bool>>(false);
 
-    while (x != page) {
-
-        bool found = control->searchTextOnPage(text, x, &occures, &top);
-        if (found) {
-            control->getScrollHandler()->scrollToPage(x, top);
-            gtk_label_set_text(GTK_LABEL(lbSearchState),
-                               (occures == 1 ? FC(_F("Text found once on page {1}") % (x + 1)) :
-                                               FC(_F("Text found {1} times on page {2}") % occures % (x + 1))));
-            return;
-        }
-
-        x++;
-        if (x >= count) {
-            x = 0;
-        }
-    }
-
-    gtk_label_set_text(GTK_LABEL(lbSearchState), _("Text not found, searched on all pages"));
+    auto* job = new SearchJob(this, control->getDocument(), &this->index, text, static_cast<size_t>(page), forward,
+                              this->searchCancelled);
+    control->getScheduler()->addJob(job, JOB_PRIORITY_URGENT);
+    job->unref();
 }
 
-void SearchBar::searchPrevious() {
-    int page = control->getCurrentPageNo();
-    int count = control->getDocument()->getPageCount();
-    if (count < 2) {
-        // Nothing to do
-        return;
-    }
-
-    MainWindow* win = control->getWindow();
-    int x = page - 1;
-    GtkWidget* searchTextField = win->get("searchTextField");
-    const char* text = gtk_entry_get_text(GTK_ENTRY(searchTextField));
-    GtkWidget* lbSearchState = win->get("lbSearchState");
-    if (*text == 0) {
-        return;
-    }
-
-    if (x < 0) {
-        x = count - 1;
+void SearchBar::cancelSearch() {
+    if (this->searchCancelled) {
+        *this->searchCancelled = true;
+        this->searchCancelled = nullptr;
     }
+}
 
-    double top = 0;
-    int occures = 0;
+void SearchBar::searchProgress(size_t searched, size_t count) {
+    GtkWidget* lbSearchState = control->getWindow()->get("lbSearchState");
+    gtk_label_set_text(GTK_LABEL(lbSearchState), FC(_F("Searching… {1} of {2} pages") % searched % count));
+}
 
-    while (x != page) {
+void SearchBar::searchFinished(size_t page, int occures, double top) {
+    this->searchCancelled = nullptr;
+    GtkWidget* lbSearchState = control->getWindow()->get("lbSearchState");
 
-        bool found = control->searchTextOnPage(text, x, &occures, &top);
-        if (found) {
-            control->getScrollHandler()->scrollToPage(x, top);
-            gtk_label_set_text(GTK_LABEL(lbSearchState),
-                               (occures == 1 ? FC(_F("Text found once on page {1}") % (x + 1)) :
-                                               FC(_F("Text found {1} times on page {2}") % occures % (x + 1))));
-            return;
+    // Only the page the text was found on shows its occurrences
+    for (int i = control->getDocument()->getPageCount() - 1; i >= 0; i--) {
+        if (static_cast<size_t>(i) != page) {
+            control->searchTextOnPage("", i, nullptr, nullptr);
         }
+    }
 
-        x--;
-        if (x < 0) {
-            x = count - 1;
-        }
+    if (page == npos) {
+        gtk_label_set_text(GTK_LABEL(lbSearchState), _("Text not found, searched on all pages"));
+        return;
     }
 
-    gtk_label_set_text(GTK_LABEL(lbSearchState), _("Text not found, searched on all pages"));
+    control->searchTextOnPage(this->searchedText, static_cast<int>(page), &occures, &top);
+    control->getScrollHandler()->scrollToPage(page, top);
+    gtk_label_set_text(GTK_LABEL(lbSearchState),
+                       (occures == 1 ? FC(_F("Text found once on page {1}") % (page + 1)) :
+                                       FC(_F("Text found {1} times on page {2}") % occures % (page + 1))));
 }
 
 void SearchBar::showSearchBar(bool show) {
@@ -185,8 +169,10 @@ void SearchBar::showSearchBar(bool show) {
         GtkWidget* searchTextField = win->get("searchTextField");
         gtk_widget_grab_focus(searchTextField);
         gtk_widget_show_all(searchBar);
+        this->index.update(control->getDocument(), control->getScheduler());
     } else {
         gtk_widget_hide(searchBar);
+        cancelSearch();
         for (int i = control->getDocument()->getPageCount() - 1; i >= 0; i--) {
             control->searchTextOnPage("", i, nullptr, nullptr);
         }
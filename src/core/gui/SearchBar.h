@@ -11,11 +11,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <gtk/gtk.h>
 
+#include "control/SearchIndex.h"
 
 class Control;
 
@@ -26,6 +30,16 @@ public:
 
     void showSearchBar(bool show);
 
+    /**
+     * Called by the SearchJob in the UI thread
+     */
+    void searchProgress(size_t searched, size_t count);
+
+    /**
+     * Called by the SearchJob in the UI thread, with npos if the text was not found
+     */
+    void searchFinished(size_t page, int occures, double top);
+
 private:
     static void buttonCloseSearchClicked(GtkButton* button, SearchBar* searchBar);
     static void searchTextChangedCallback(GtkEntry* entry, SearchBar* searchBar);
@@ -39,7 +53,21 @@ private:
     void search(const char* text);
     bool searchTextonCurrentPage(const char* text, int* occures, double* top);
 
+    /**
+     * Search the next page with the text in the background, see SearchJob
+     */
+    void startSearch(bool forward);
+    void cancelSearch();
+
 private:
     Control* control;
     GtkCssProvider* cssTextFild;
+
+    SearchIndex index;
+
+    /**
+     * The text and the cancellation flag of the running SearchJob
+     */
+    std::string searchedText;
+    std::shared_ptr<std::atomic<bool>> searchCancelled;
 };
@@ -1,6 +1,10 @@
 #include "TextEditor.h"
 
+#include <algorithm>
 #include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
 
 #include <gtk/gtkimmulticontext.h>
 
@@ -14,6 +18,7 @@
 #include "XournalppCursor.h"
 
 using std::string;
+using xoj::util::Rectangle;
 
 TextEditor::TextEditor(XojPageView* gui, GtkWidget* widget, Text* text, bool ownText):
         gui(gui), widget(widget), text(text), ownText(ownText) {
@@ -118,7 +123,7 @@ auto TextEditor::setColor(Color color) -> UndoAction* {
     auto origColor = this->text->getColor();
     this->text->setColor(color);
 
-    repaintEditor();
+    repaintEditor(true);
 
     // This is a new text, so we don't need to create a undo action
     if (this->ownText) {
@@ -134,7 +139,8 @@ auto TextEditor::setColor(Color color) -> UndoAction* {
 void TextEditor::setFont(XojFont font) {
     this->text->setFont(font);
     xoj::view::TextView::updatePangoFont(this->layout, this->text);
-    this->repaintEditor();
+    this->layoutDirty = true;
+    this->repaintEditor(true);
 }
 
 void TextEditor::textCopyed() { this->ownText = false; }
@@ -874,11 +880,7 @@ void TextEditor::resetImContext() {
     }
 }
 
-void TextEditor::repaintCursor() {
-    double x = this->text->getX();
-    double y = this->text->getY();
-    this->gui->repaintArea(x, y, x + this->text->getElementWidth(), y + this->text->getElementHeight());
-}
+void TextEditor::repaintCursor() { repaintEditor(); }
 
 #define CURSOR_ON_MULTIPLIER 2
 #define CURSOR_OFF_MULTIPLIER 1
@@ -905,9 +907,188 @@ auto TextEditor::blinkCallback(TextEditor* te) -> gint {
     return false;
 }
 
-void TextEditor::repaintEditor() {
-    auto rect = text->boundingRect();
-    this->gui->rerenderRect(rect.x, rect.y, rect.width, rect.height);
+void TextEditor::repaintEditor(bool full) {
+    // The text in editing is not part of the rendered page, see TextView::draw(): repainting it is enough
+    Rectangle<double> box(0, 0, this->text->getElementWidth(), this->text->getElementHeight());
+
+    std::optional<Rectangle<double>> damage;
+    if (this->layout) {
+        damage = updateLayout();
+    }
+    if (full || !this->layout) {
+        box.unite(Rectangle<double>(0, 0, this->layoutWidth, this->layoutHeight));
+        damage = box;
+    }
+
+    if (damage) {
+        double x = this->text->getX() + damage->x;
+        double y = this->text->getY() + damage->y;
+        this->gui->repaintArea(x, y, x + damage->width, y + damage->height);
+    }
+}
+
+namespace {
+/**
+ * The extent of the lines with the bytes [start, end], or of the line of start if the range is empty
+ */
+auto linesOf(const std::vector<TextEditor::LayoutLine>& lines, int start, int end)
+        -> std::optional<std::pair<double, double>> {
+    std::optional<std::pair<double, double>> extent;
+    for (const auto& line: lines) {
+        if (line.start > end) {
+            break;
+        }
+        if (line.end >= start) {
+            extent = extent ? std::make_pair(extent->first, line.bottom) : std::make_pair(line.top, line.bottom);
+        }
+    }
+    return extent;
+}
+}  // namespace
+
+auto TextEditor::updateLayout() -> std::optional<Rectangle<double>> {
+    GtkTextIter cursorIter = {nullptr};
+    gtk_text_buffer_get_iter_at_mark(this->buffer, &cursorIter, gtk_text_buffer_get_insert(this->buffer));
+
+    string txt = this->text->getText();
+    bool preedit = !this->preeditString.empty();
+    int preeditPos = 0;
+    int selectionStart = -1;
+    int selectionEnd = -1;
+
+    if (preedit) {
+        int offset = gtk_text_iter_get_offset(&cursorIter);
+        preeditPos = gtk_text_iter_get_line_index(&cursorIter);
+
+        for (gtk_text_iter_set_line_index(&cursorIter, 0); gtk_text_iter_backward_line(&cursorIter);) {
+            preeditPos += gtk_text_iter_get_bytes_in_line(&cursorIter);
+        }
+        gtk_text_iter_set_offset(&cursorIter, offset);
+        txt = txt.substr(0, preeditPos) + preeditString + txt.substr(preeditPos);
+    } else {
+        GtkTextIter start;
+        GtkTextIter end;
+        if (gtk_text_buffer_get_selection_bounds(this->buffer, &start, &end)) {
+            const char* chars = txt.c_str();
+            selectionStart = g_utf8_offset_to_pointer(chars, gtk_text_iter_get_offset(&start)) - chars;
+            selectionEnd = g_utf8_offset_to_pointer(chars, gtk_text_iter_get_offset(&end)) - chars;
+        }
+    }
+
+    bool textChanged = this->layoutDirty || txt != this->layoutText;
+    bool selectionChanged = selectionStart != this->layoutSelectionStart || selectionEnd != this->layoutSelectionEnd;
+
+    // Setting the text or the attributes lays the whole text out again: only when they changed
+    if (textChanged || selectionChanged || preedit || this->layoutPreedit) {
+        PangoAttrList* attrlist = pango_attr_list_new();
+        if (preedit) {
+            pango_attr_list_splice(attrlist, this->preeditAttrList, preeditPos, preeditString.length());
+        } else if (selectionStart >= 0) {
+            auto selectionColorU16 = Util::GdkRGBA_to_ColorU16(this->gui->getSelectionColor());
+            PangoAttribute* attrib =
+                    pango_attr_background_new(selectionColorU16.red, selectionColorU16.green, selectionColorU16.blue);
+            attrib->start_index = static_cast<guint>(selectionStart);
+            attrib->end_index = static_cast<guint>(selectionEnd);
+            pango_attr_list_insert(attrlist, attrib);
+        }
+        pango_layout_set_attributes(this->layout, attrlist);
+        pango_attr_list_unref(attrlist);
+    }
+
+    std::optional<Rectangle<double>> damage;
+    auto addDamage = [&damage](const Rectangle<double>& rect) {
+        if (damage) {
+            damage->unite(rect);
+        } else {
+            damage = rect;
+        }
+    };
+
+    if (textChanged) {
+        pango_layout_set_text(this->layout, txt.c_str(), static_cast<int>(txt.length()));
+
+        std::vector<LayoutLine> lines;
+        PangoLayoutIter* iter = pango_layout_get_iter(this->layout);
+        do {
+            PangoLayoutLine* line = pango_layout_iter_get_line_readonly(iter);
+            int top = 0;
+            int bottom = 0;
+            pango_layout_iter_get_line_yrange(iter, &top, &bottom);
+            lines.push_back({line->start_index, line->start_index + line->length,
+                             static_cast<double>(top) / PANGO_SCALE, static_cast<double>(bottom) / PANGO_SCALE});
+        } while (pango_layout_iter_next_line(iter));
+        pango_layout_iter_free(iter);
+
+        int w = 0;
+        int h = 0;
+        pango_layout_get_size(this->layout, &w, &h);
+        double width = static_cast<double>(w) / PANGO_SCALE;
+        double height = static_cast<double>(h) / PANGO_SCALE;
+
+        // The lines between the common start and the common end of the old and the new text changed
+        size_t prefix = 0;
+        size_t maxCommon = std::min(txt.size(), this->layoutText.size());
+        while (prefix < maxCommon && txt[prefix] == this->layoutText[prefix]) { prefix++; }
+        size_t suffix = 0;
+        while (suffix < maxCommon - prefix &&
+               txt[txt.size() - 1 - suffix] == this->layoutText[this->layoutText.size() - 1 - suffix]) {
+            suffix++;
+        }
+        auto oldLines = linesOf(this->layoutLines, static_cast<int>(prefix),
+                                static_cast<int>(this->layoutText.size() - suffix));
+        auto newLines = linesOf(lines, static_cast<int>(prefix), static_cast<int>(txt.size() - suffix));
+
+        double boxWidth = std::max(width, this->layoutWidth);
+        if (this->layoutDirty || width != this->layoutWidth || !oldLines || !newLines) {
+            addDamage(Rectangle<double>(0, 0, boxWidth, std::max(height, this->layoutHeight)));
+        } else {
+            double top = std::min(oldLines->first, newLines->first);
+            // The lines below moved if some were added or removed
+            double bottom = lines.size() == this->layoutLines.size() ? std::max(oldLines->second, newLines->second) :
+                                                                       std::max(height, this->layoutHeight);
+            addDamage(Rectangle<double>(0, top, boxWidth, bottom - top));
+        }
+
+        this->layoutText = std::move(txt);
+        this->layoutLines = std::move(lines);
+        this->layoutWidth = width;
+        this->layoutHeight = height;
+        this->layoutDirty = false;
+        this->text->setWidth(width);
+        this->text->setHeight(height);
+    } else if (selectionChanged) {
+        int start = std::min(selectionStart < 0 ? selectionEnd : selectionStart,
+                             this->layoutSelectionStart < 0 ? this->layoutSelectionEnd : this->layoutSelectionStart);
+        int end = std::max(selectionEnd, this->layoutSelectionEnd);
+        if (start < 0) {
+            start = std::max(selectionStart, this->layoutSelectionStart);
+        }
+        if (auto extent = linesOf(this->layoutLines, start, end)) {
+            addDamage(Rectangle<double>(0, extent->first, this->layoutWidth, extent->second - extent->first));
+        }
+    }
+    this->layoutSelectionStart = selectionStart;
+    this->layoutSelectionEnd = selectionEnd;
+    this->layoutPreedit = preedit;
+
+    // The cursor, where it was and where it is now
+    addDamage(this->cursorBox);
+
+    int pcursInd = 0;
+    if (preedit && this->preeditCursor != 0) {
+        const gchar* preeditText = this->preeditString.c_str();
+        pcursInd = g_utf8_offset_to_pointer(preeditText, preeditCursor) - preeditText;
+    }
+    int pangoOffset = getByteOffset(gtk_text_iter_get_offset(&cursorIter)) + pcursInd;
+    PangoRectangle rect = {0};
+    pango_layout_index_to_pos(this->layout, pangoOffset, &rect);
+    // repaintArea() adds a margin, which covers the width of the cursor
+    this->cursorBox = Rectangle<double>(static_cast<double>(rect.x) / PANGO_SCALE,
+                                        static_cast<double>(rect.y) / PANGO_SCALE, 0,
+                                        static_cast<double>(rect.height) / PANGO_SCALE);
+    addDamage(this->cursorBox);
+
+    return damage;
 }
 
 /**
@@ -958,10 +1139,6 @@ void TextEditor::paint(cairo_t* cr, double zoom) {
 
     Util::cairo_set_source_rgbi(cr, this->text->getColor());
 
-    GtkTextIter cursorIter = {nullptr};
-    GtkTextMark* cursor = gtk_text_buffer_get_insert(this->buffer);
-    gtk_text_buffer_get_iter_at_mark(this->buffer, &cursorIter, cursor);
-
     double x0 = this->text->getX();
     double y0 = this->text->getY();
     cairo_translate(cr, x0, y0);
@@ -972,72 +1149,15 @@ void TextEditor::paint(cairo_t* cr, double zoom) {
         this->layout = xoj::view::TextView::initPango(cr, this->text);
     }
 
-    if (!this->preeditString.empty()) {
-        string text = this->text->getText();
-        int offset = gtk_text_iter_get_offset(&cursorIter);
-        int pos = gtk_text_iter_get_line_index(&cursorIter);
-
-        for (gtk_text_iter_set_line_index(&cursorIter, 0); gtk_text_iter_backward_line(&cursorIter);) {
-            pos += gtk_text_iter_get_bytes_in_line(&cursorIter);
-        }
-        gtk_text_iter_set_offset(&cursorIter, offset);
-        string txt = text.substr(0, pos) + preeditString + text.substr(pos);
-
-        PangoAttrList* attrlist = pango_attr_list_new();
-        PangoAttrList* preedit_attrlist = this->preeditAttrList;
-        pango_attr_list_splice(attrlist, preedit_attrlist, pos, preeditString.length());
-        pango_layout_set_attributes(this->layout, attrlist);
-        pango_attr_list_unref(attrlist);
-        attrlist = nullptr;
-        pango_layout_set_text(this->layout, txt.c_str(), txt.length());
-    } else {
-        string txt = this->text->getText();
-        pango_layout_set_text(this->layout, txt.c_str(), txt.length());
-
-        GtkTextIter start;
-        GtkTextIter end;
-        bool hasSelection = gtk_text_buffer_get_selection_bounds(this->buffer, &start, &end);
-
-        if (hasSelection) {
-            auto selectionColorU16 = Util::GdkRGBA_to_ColorU16(selectionColor);
-            PangoAttribute* attrib =
-                    pango_attr_background_new(selectionColorU16.red, selectionColorU16.green, selectionColorU16.blue);
-            attrib->start_index = getByteOffset(gtk_text_iter_get_offset(&start));
-            attrib->end_index = getByteOffset(gtk_text_iter_get_offset(&end));
-
-            PangoAttrList* attrlist = pango_attr_list_new();
-            pango_attr_list_insert(attrlist, attrib);
-            pango_layout_set_attributes(this->layout, attrlist);
-            pango_attr_list_unref(attrlist);
-            attrlist = nullptr;
-        } else {
-            // remove all attributes
-            PangoAttrList* attrlist = pango_attr_list_new();
-            pango_layout_set_attributes(this->layout, attrlist);
-            pango_attr_list_unref(attrlist);
-            attrlist = nullptr;
-        }
-    }
+    updateLayout();
 
     pango_cairo_show_layout(cr, this->layout);
-    int w = 0;
-    int h = 0;
-    pango_layout_get_size(this->layout, &w, &h);
-    double width = (static_cast<double>(w)) / PANGO_SCALE;
-    double height = (static_cast<double>(h)) / PANGO_SCALE;
+    double width = this->layoutWidth;
+    double height = this->layoutHeight;
 
-    int offset = gtk_text_iter_get_offset(&cursorIter);
-    PangoRectangle rect = {0};
-    int pcursInd = 0;
-    if (!this->preeditString.empty() && this->preeditCursor != 0) {
-        const gchar* preeditText = this->preeditString.c_str();
-        pcursInd = g_utf8_offset_to_pointer(preeditText, preeditCursor) - preeditText;
-    }
-    int pangoOffset = getByteOffset(offset) + pcursInd;
-    pango_layout_index_to_pos(this->layout, pangoOffset, &rect);
-    double cX = (static_cast<double>(rect.x)) / PANGO_SCALE;
-    double cY = (static_cast<double>(rect.y)) / PANGO_SCALE;
-    double cHeight = (static_cast<double>(rect.height)) / PANGO_SCALE;
+    double cX = this->cursorBox.x;
+    double cY = this->cursorBox.y;
+    double cHeight = this->cursorBox.height;
 
     drawCursor(cr, cX, cY, cHeight, zoom);
 
@@ -1063,9 +1183,6 @@ void TextEditor::paint(cairo_t* cr, double zoom) {
     // // This is also useful, so it is good to make it user's preference.
     gtk_im_context_set_cursor_location(this->imContext, &cursorRect);
 
-    this->text->setWidth(width);
-    this->text->setHeight(height);
-
     if (this->markPosQueue) {
         this->markPosQueue = false;
         markPos(this->markPosX, this->markPosY, this->markPosExtendSelection);
@@ -11,6 +11,10 @@
 
 #pragma once
 
+#include <optional>
+#include <string>
+#include <vector>
+
 #include <gtk/gtk.h>
 
 #include "model/Text.h"
@@ -60,8 +64,32 @@ public:
     void setFont(XojFont font);
     UndoAction* setColor(Color color);
 
+    /**
+     * A line of the layout: its bytes [start, end] and its vertical extent
+     */
+    struct LayoutLine {
+        int start;
+        int end;
+        double top;
+        double bottom;
+    };
+
 private:
-    void repaintEditor();
+    /**
+     * Repaint the part of the text box which changed since the last repaint
+     *
+     * @param full Repaint the whole text box, which changed as a whole
+     */
+    void repaintEditor(bool full = false);
+
+    /**
+     * Set the text, the selection and the preedit string in the layout, if they changed since the last call, and
+     * update the cursor
+     *
+     * @return The area whose drawing changed, in the coordinates of the text: the lines which changed and the cursor
+     */
+    std::optional<xoj::util::Rectangle<double>> updateLayout();
+
     void drawCursor(cairo_t* cr, double x, double y, double height, double zoom);
     void repaintCursor();
     void resetImContext();
@@ -97,6 +125,19 @@ private:
     PangoLayout* layout = nullptr;
     Text* text = nullptr;
 
+    /// What the layout shows, see updateLayout()
+    std::string layoutText;
+    int layoutSelectionStart = -1;
+    int layoutSelectionEnd = -1;
+    bool layoutPreedit = false;
+    bool layoutDirty = true;
+    std::vector<LayoutLine> layoutLines;
+    double layoutWidth = 0;
+    double layoutHeight = 0;
+
+    /// In the coordinates of the text
+    xoj::util::Rectangle<double> cursorBox{};
+
     PangoAttrList* preeditAttrList = nullptr;
     int preeditCursor;
     std::string preeditString;
@@ -0,0 +1,56 @@
+#include "TiledMask.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "util/SurfacePool.h"
+
+using xoj::util::Rectangle;
+
+TiledMask::TiledMask(double scale): scale(scale) {}
+
+TiledMask::~TiledMask() {
+    for (auto& [key, tile]: this->tiles) {
+        cairo_destroy(tile.cr);
+        cairo_surface_destroy(tile.surface);
+    }
+}
+
+void TiledMask::draw(const Rectangle<double>& area, const std::function<void(cairo_t*)>& painter) {
+    // Unlike the pages, the mask does not stop at the origin: strokes can go beyond the page
+    const int x1 = static_cast<int>(std::floor(area.x * this->scale / TILE_SIZE));
+    const int y1 = static_cast<int>(std::floor(area.y * this->scale / TILE_SIZE));
+    const int x2 = static_cast<int>(std::ceil((area.x + area.width) * this->scale / TILE_SIZE));
+    const int y2 = static_cast<int>(std::ceil((area.y + area.height) * this->scale / TILE_SIZE));
+
+    for (int y = y1; y < std::max(y2, y1 + 1); y++) {
+        for (int x = x1; x < std::max(x2, x1 + 1); x++) {
+            Tile& tile = this->tiles[{x, y}];
+            if (!tile.surface) {
+                tile.surface = xoj::util::SurfacePool::createSurface(CAIRO_FORMAT_A8, TILE_SIZE, TILE_SIZE);
+                cairo_surface_set_device_offset(tile.surface, -x * TILE_SIZE, -y * TILE_SIZE);
+                cairo_surface_set_device_scale(tile.surface, this->scale, this->scale);
+                tile.cr = cairo_create(tile.surface);
+                cairo_set_source_rgba(tile.cr, 1, 1, 1, 1);
+                cairo_set_operator(tile.cr, CAIRO_OPERATOR_OVER);
+            }
+            painter(tile.cr);
+        }
+    }
+}
+
+void TiledMask::paint(cairo_t* cr) const {
+    double x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+    const double tileSize = TILE_SIZE / this->scale;
+
+    for (auto& [key, tile]: this->tiles) {
+        const double x = key.first * tileSize;
+        const double y = key.second * tileSize;
+        if (x < x2 && y < y2 && x + tileSize > x1 && y + tileSize > y1) {
+            cairo_mask_surface(cr, tile.surface, 0, 0);
+        }
+    }
+}
+
+auto TiledMask::getTileCount() const -> size_t { return this->tiles.size(); }
@@ -0,0 +1,69 @@
+/*
+ * Xournal++
+ *
+ * Alpha mask split in tiles allocated on first use
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <utility>
+
+#include <cairo.h>
+
+#include "util/Rectangle.h"
+
+/**
+ * @brief Alpha only surface of unbounded size, in page coordinates
+ *
+ * The mask is split in square tiles of TILE_SIZE device pixels, like TiledPageBuffer. A tile is only allocated when
+ * something is drawn on it, so the memory used and the time needed to clear it follow what is drawn, not the size of
+ * the page or of the window. Drawing only touches the tiles of the given area, painting only the tiles of the clip.
+ */
+class TiledMask final {
+public:
+    /**
+     * @param scale Device pixels per page unit (zoom * DPI scale factor)
+     */
+    explicit TiledMask(double scale);
+    ~TiledMask();
+
+    TiledMask(const TiledMask&) = delete;
+    TiledMask& operator=(const TiledMask&) = delete;
+
+public:
+    /**
+     * @brief Calls painter on the context of each tile intersecting the area (page coordinates), allocating the
+     * missing tiles. The contexts are in page coordinates, with an opaque source and CAIRO_OPERATOR_OVER.
+     */
+    void draw(const xoj::util::Rectangle<double>& area, const std::function<void(cairo_t*)>& painter);
+
+    /**
+     * @brief Paints the current source of cr through the mask
+     * @param cr Context in page coordinates, aligned on the device pixels the mask was created for
+     */
+    void paint(cairo_t* cr) const;
+
+    /**
+     * @return The number of tiles allocated
+     */
+    size_t getTileCount() const;
+
+    static constexpr int TILE_SIZE = 256;
+
+private:
+    struct Tile {
+        cairo_surface_t* surface = nullptr;
+        cairo_t* cr = nullptr;
+    };
+
+    double scale;
+
+    std::map<std::pair<int, int>, Tile> tiles;
+};
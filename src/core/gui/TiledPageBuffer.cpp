@@ -0,0 +1,387 @@
+#include "TiledPageBuffer.h"
+
+#include <cmath>
+#include <tuple>
+
+#include "util/Profiler.h"
+
+using xoj::util::Rectangle;
+
+std::atomic<uint64_t> TiledPageBuffer::useClock{0};
+
+auto TiledPageBuffer::TileKey::operator<(const TileKey& other) const -> bool {
+    return std::tie(scale, y, x) < std::tie(other.scale, other.y, other.x);
+}
+
+auto TiledPageBuffer::TileKey::operator==(const TileKey& other) const -> bool {
+    return scale == other.scale && x == other.x && y == other.y;
+}
+
+auto TiledPageBuffer::TileKey::getPageRect() const -> Rectangle<double> {
+    double size = TILE_SIZE / scale;
+    return Rectangle<double>(x * size, y * size, size, size);
+}
+
+static auto copySurface(cairo_surface_t* surface) -> cairo_surface_t* {
+    cairo_surface_t* copy =
+            cairo_image_surface_create(cairo_image_surface_get_format(surface), cairo_image_surface_get_width(surface),
+                                       cairo_image_surface_get_height(surface));
+    cairo_t* cr = cairo_create(copy);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_surface(cr, surface, 0, 0);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+    return copy;
+}
+
+TiledPageBuffer::~TiledPageBuffer() {
+    clear();
+    destroyReleasedCopies();
+}
+
+auto TiledPageBuffer::tilesInArea(double scale, const Rectangle<double>& area) -> std::vector<TileKey> {
+    std::vector<TileKey> keys;
+    if (area.width <= 0 || area.height <= 0) {
+        return keys;
+    }
+
+    int x1 = std::max(0, static_cast<int>(std::floor(area.x * scale / TILE_SIZE)));
+    int y1 = std::max(0, static_cast<int>(std::floor(area.y * scale / TILE_SIZE)));
+    int x2 = static_cast<int>(std::ceil((area.x + area.width) * scale / TILE_SIZE));
+    int y2 = static_cast<int>(std::ceil((area.y + area.height) * scale / TILE_SIZE));
+
+    for (int y = y1; y < y2; y++) {
+        for (int x = x1; x < x2; x++) {
+            keys.push_back({scale, x, y});
+        }
+    }
+    return keys;
+}
+
+auto TiledPageBuffer::getPreviewScale(double scale) -> double {
+    return std::exp2(std::floor(std::log2(scale / PREVIEW_SCALE_DIVISOR)));
+}
+
+auto TiledPageBuffer::getMissingTiles(double scale, const Rectangle<double>& area) const -> std::vector<TileKey> {
+    std::vector<TileKey> missing;
+    for (auto& key: tilesInArea(scale, area)) {
+        auto it = this->tiles.find(key);
+        if (it == this->tiles.end() || it->second.stale) {
+            missing.push_back(key);
+        }
+    }
+    return missing;
+}
+
+auto TiledPageBuffer::paint(cairo_t* cr, double zoom, double scale, const Rectangle<double>& area, double pageWidth,
+                            double pageHeight, bool refineDrafts) -> std::vector<TileKey> {
+    std::vector<TileKey> toRender;
+
+    auto visible = area.intersects(Rectangle<double>(0, 0, pageWidth, pageHeight));
+    if (!visible) {
+        return toRender;
+    }
+
+    destroyReleasedCopies();
+
+    uint64_t now = ++useClock;
+
+    std::vector<TileKey> keys = tilesInArea(scale, *visible);
+    bool complete = true;
+    auto& profiler = xoj::util::Profiler::getInstance();
+    for (auto& key: keys) {
+        auto it = this->tiles.find(key);
+        if (it == this->tiles.end()) {
+            complete = false;
+            toRender.push_back(key);
+        } else {
+            it->second.lastUse = now;
+            if (it->second.stale || (refineDrafts && it->second.draft)) {
+                toRender.push_back(key);
+            }
+        }
+        profiler.countAccess("tiles", it != this->tiles.end() && !it->second.stale);
+    }
+
+    cairo_save(cr);
+    cairo_rectangle(cr, visible->x * zoom, visible->y * zoom, visible->width * zoom, visible->height * zoom);
+    cairo_clip(cr);
+
+    auto paintTile = [this, cr, zoom](const TileKey& key, Tile& tile, bool exactScale) {
+        cairo_surface_t* surface = getDeviceCopy(cr, tile);
+        cairo_save(cr);
+        cairo_scale(cr, zoom / key.scale, zoom / key.scale);
+        cairo_set_source_surface(cr, surface, key.x * TILE_SIZE, key.y * TILE_SIZE);
+        if (!exactScale) {
+            cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_FAST);
+        }
+        cairo_rectangle(cr, key.x * TILE_SIZE, key.y * TILE_SIZE, TILE_SIZE, TILE_SIZE);
+        cairo_fill(cr);
+        cairo_restore(cr);
+    };
+
+    if (!complete) {
+        // Fill the holes with the tiles of the previous scale, stretched, or with a blank page
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_paint(cr);
+        // The map is sorted by scale: the sharpest tiles end up on top
+        for (auto& [key, tile]: this->tiles) {
+            if (key.scale != scale && key.getPageRect().intersects(*visible)) {
+                paintTile(key, tile, false);
+            }
+        }
+    }
+
+    for (auto& key: keys) {
+        auto it = this->tiles.find(key);
+        if (it != this->tiles.end()) {
+            paintTile(key, it->second, true);
+        }
+    }
+
+    cairo_restore(cr);
+
+    return toRender;
+}
+
+void TiledPageBuffer::destroy(Tile& tile) {
+    if (tile.surface) {
+        cairo_surface_destroy(tile.surface);
+    }
+    if (tile.background) {
+        cairo_surface_destroy(tile.background);
+    }
+    if (tile.deviceCopy) {
+        this->releasedCopies.push_back(tile.deviceCopy);
+    }
+    tile.surface = nullptr;
+    tile.background = nullptr;
+    tile.deviceCopy = nullptr;
+}
+
+auto TiledPageBuffer::getDeviceCopy(cairo_t* cr, Tile& tile) -> cairo_surface_t* {
+    cairo_surface_t* target = cairo_get_target(cr);
+    if (!this->deviceCopies || cairo_surface_get_type(target) == CAIRO_SURFACE_TYPE_IMAGE ||
+        cairo_surface_get_type(tile.surface) != CAIRO_SURFACE_TYPE_IMAGE) {
+        // Drawn from the pixels anyway
+        return tile.surface;
+    }
+
+    if (tile.deviceCopy && cairo_surface_get_type(tile.deviceCopy) == cairo_surface_get_type(target) &&
+        cairo_surface_get_device(tile.deviceCopy) == cairo_surface_get_device(target)) {
+        return tile.deviceCopy;
+    }
+    if (tile.deviceCopy) {
+        cairo_surface_destroy(tile.deviceCopy);
+        tile.deviceCopy = nullptr;
+    }
+
+    // The similar surfaces inherit the device scale of the window, the copy has the pixels of the tile instead
+    double scaleX = 1;
+    double scaleY = 1;
+    cairo_surface_get_device_scale(target, &scaleX, &scaleY);
+    int width = cairo_image_surface_get_width(tile.surface);
+    int height = cairo_image_surface_get_height(tile.surface);
+    cairo_surface_t* copy = cairo_surface_create_similar(target, cairo_surface_get_content(tile.surface),
+                                                         static_cast<int>(std::ceil(width / scaleX)),
+                                                         static_cast<int>(std::ceil(height / scaleY)));
+    if (cairo_surface_status(copy) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(copy);
+        return tile.surface;
+    }
+    cairo_surface_set_device_scale(copy, 1, 1);
+
+    cairo_t* crCopy = cairo_create(copy);
+    cairo_set_operator(crCopy, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_surface(crCopy, tile.surface, 0, 0);
+    cairo_paint(crCopy);
+    cairo_destroy(crCopy);
+
+    tile.deviceCopy = copy;
+    return copy;
+}
+
+void TiledPageBuffer::destroyReleasedCopies() {
+    for (cairo_surface_t* copy: this->releasedCopies) {
+        cairo_surface_destroy(copy);
+    }
+    this->releasedCopies.clear();
+}
+
+void TiledPageBuffer::setDeviceCopies(bool enabled) {
+    if (this->deviceCopies == enabled) {
+        return;
+    }
+    this->deviceCopies = enabled;
+    if (!enabled) {
+        for (auto& [key, tile]: this->tiles) {
+            if (tile.deviceCopy) {
+                this->releasedCopies.push_back(tile.deviceCopy);
+                tile.deviceCopy = nullptr;
+            }
+        }
+    }
+}
+
+void TiledPageBuffer::putTile(const TileKey& key, cairo_surface_t* surface, cairo_surface_t* background,
+                              bool draft) {
+    Tile& tile = this->tiles[key];
+    destroy(tile);
+    tile.surface = surface;
+    tile.background = background;
+    tile.stale = false;
+    tile.draft = draft;
+    tile.lastUse = ++useClock;
+}
+
+auto TiledPageBuffer::getTile(const TileKey& key) const -> cairo_surface_t* {
+    auto it = this->tiles.find(key);
+    return it == this->tiles.end() ? nullptr : it->second.surface;
+}
+
+void TiledPageBuffer::forEachTile(double scale, const Rectangle<double>& area,
+                                  const std::function<void(const TileKey&, cairo_surface_t*)>& fn) {
+    for (auto& [key, tile]: this->tiles) {
+        if (key.scale == scale && key.getPageRect().intersects(area)) {
+            if (tile.deviceCopy) {
+                // Uploaded again with the new pixels
+                this->releasedCopies.push_back(tile.deviceCopy);
+                tile.deviceCopy = nullptr;
+            }
+            if (cairo_surface_get_reference_count(tile.surface) > 1) {
+                // Shared with another buffer, see share()
+                cairo_surface_t* copy = copySurface(tile.surface);
+                cairo_surface_destroy(tile.surface);
+                tile.surface = copy;
+            }
+            fn(key, tile.surface);
+        }
+    }
+}
+
+void TiledPageBuffer::markDrafts(double scale, const Rectangle<double>& area) {
+    for (auto& [key, tile]: this->tiles) {
+        if (key.scale == scale && key.getPageRect().intersects(area)) {
+            tile.draft = true;
+        }
+    }
+}
+
+auto TiledPageBuffer::hasBackgrounds(double scale, const Rectangle<double>& area) const -> bool {
+    for (auto& [key, tile]: this->tiles) {
+        if (key.scale == scale && !tile.background && key.getPageRect().intersects(area)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TiledPageBuffer::forEachBackground(double scale, const Rectangle<double>& area,
+                                        const std::function<void(const TileKey&, cairo_surface_t*)>& fn) const {
+    for (auto& [key, tile]: this->tiles) {
+        if (key.scale == scale && tile.background && key.getPageRect().intersects(area)) {
+            fn(key, tile.background);
+        }
+    }
+}
+
+auto TiledPageBuffer::getTileKeys(double scale) const -> std::vector<TileKey> {
+    std::vector<TileKey> keys;
+    for (auto& [key, tile]: this->tiles) {
+        if (key.scale == scale) {
+            keys.push_back(key);
+        }
+    }
+    return keys;
+}
+
+void TiledPageBuffer::invalidate() {
+    for (auto& [key, tile]: this->tiles) {
+        tile.stale = true;
+    }
+}
+
+void TiledPageBuffer::dropOtherScales(double scale, const Rectangle<double>& area) {
+    for (auto it = this->tiles.begin(); it != this->tiles.end();) {
+        if (it->first.scale != scale && it->first.getPageRect().intersects(area)) {
+            destroy(it->second);
+            it = this->tiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TiledPageBuffer::dropOtherScales(double scale) {
+    for (auto it = this->tiles.begin(); it != this->tiles.end();) {
+        if (it->first.scale != scale) {
+            destroy(it->second);
+            it = this->tiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TiledPageBuffer::dropTile(const TileKey& key) {
+    auto it = this->tiles.find(key);
+    if (it != this->tiles.end()) {
+        destroy(it->second);
+        this->tiles.erase(it);
+    }
+}
+
+void TiledPageBuffer::clear() {
+    for (auto& [key, tile]: this->tiles) {
+        destroy(tile);
+    }
+    this->tiles.clear();
+}
+
+void TiledPageBuffer::swap(TiledPageBuffer& other) { this->tiles.swap(other.tiles); }
+
+auto TiledPageBuffer::share() const -> std::unique_ptr<TiledPageBuffer> {
+    auto copy = std::make_unique<TiledPageBuffer>();
+    copy->tiles = this->tiles;
+    for (auto& [key, tile]: copy->tiles) {
+        cairo_surface_reference(tile.surface);
+        if (tile.background) {
+            cairo_surface_reference(tile.background);
+        }
+        if (tile.deviceCopy) {
+            cairo_surface_reference(tile.deviceCopy);
+        }
+    }
+    copy->deviceCopies = this->deviceCopies;
+    return copy;
+}
+
+auto TiledPageBuffer::isEmpty() const -> bool { return this->tiles.empty(); }
+
+auto TiledPageBuffer::getPixelCount() const -> size_t {
+    size_t surfaces = 0;
+    for (auto& [key, tile]: this->tiles) {
+        surfaces += 1 + (tile.background ? 1 : 0) + (tile.deviceCopy ? 1 : 0);
+    }
+    return surfaces * static_cast<size_t>(TILE_SIZE) * static_cast<size_t>(TILE_SIZE);
+}
+
+auto TiledPageBuffer::getTileUses() const -> std::vector<uint64_t> {
+    std::vector<uint64_t> uses;
+    uses.reserve(this->tiles.size());
+    for (auto& [key, tile]: this->tiles) {
+        uses.push_back(tile.lastUse);
+    }
+    return uses;
+}
+
+void TiledPageBuffer::dropTilesUsedBefore(uint64_t lastUse) {
+    for (auto it = this->tiles.begin(); it != this->tiles.end();) {
+        if (it->second.lastUse < lastUse) {
+            destroy(it->second);
+            it = this->tiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
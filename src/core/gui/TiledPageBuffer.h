@@ -0,0 +1,260 @@
+/*
+ * Xournal++
+ *
+ * Rendered image of a page, split in fixed size tiles
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <cairo.h>
+
+#include "util/Rectangle.h"
+
+/**
+ * @brief Cache of the rendered tiles of a single page.
+ *
+ * Instead of one surface covering the whole page (which gets huge at high zoom levels), the page is rendered in
+ * square tiles of TILE_SIZE device pixels. Only the tiles intersecting the visible area are requested, so the
+ * memory used by a page is bounded by what is actually shown on screen.
+ *
+ * Tiles are identified by the scale they were rendered at (zoom * DPI scale factor) and their position in the
+ * tile grid of that scale. Tiles of an outdated scale are kept until the tiles of the current scale are ready,
+ * and are drawn stretched in the meantime (lower resolutions below the higher ones).
+ *
+ * The tiles rendered as a draft during an interaction (see RenderJob) are drawn like the others, and requested again
+ * by the paints which refine the drafts.
+ *
+ * The tiles of the pages with a costly background (PDF or image) also keep the background alone: an edit of the
+ * layers copies it instead of drawing the background again, see RenderJob.
+ *
+ * With setDeviceCopies(), the tiles painted on a window are also copied once to surfaces of the display backend (e.g.
+ * XRender pixmaps), which then composites and scales them, instead of uploading the pixels at every frame.
+ *
+ * This class is not synchronized: the owner (XojPageView) guards all calls with its drawing mutex.
+ */
+class TiledPageBuffer final {
+public:
+    /**
+     * Side length of a tile, in device pixels
+     */
+    static constexpr int TILE_SIZE = 256;
+
+    /**
+     * During a zoom gesture, tiles are rendered at (about) the scale divided by this
+     */
+    static constexpr double PREVIEW_SCALE_DIVISOR = 4.0;
+
+    struct TileKey {
+        double scale;
+        int x;
+        int y;
+
+        bool operator<(const TileKey& other) const;
+        bool operator==(const TileKey& other) const;
+
+        /**
+         * @return The area covered by the tile, in page coordinates
+         */
+        xoj::util::Rectangle<double> getPageRect() const;
+    };
+
+public:
+    TiledPageBuffer() = default;
+    ~TiledPageBuffer();
+
+    TiledPageBuffer(const TiledPageBuffer&) = delete;
+    TiledPageBuffer& operator=(const TiledPageBuffer&) = delete;
+
+public:
+    /**
+     * @brief Paints the available tiles covering the given area
+     *
+     * @param cr Context in display coordinates of the page (i.e. page coordinates scaled by the zoom)
+     * @param zoom The current zoom
+     * @param scale The scale tiles should be rendered at (zoom * DPI scale factor)
+     * @param area The area to paint, in page coordinates
+     * @param pageWidth Width of the page, in page coordinates
+     * @param pageHeight Height of the page, in page coordinates
+     * @param refineDrafts Whether the draft tiles are returned, to be rendered again in full quality
+     *
+     * @return The keys of the tiles of the area which are missing or stale at the given scale
+     */
+    std::vector<TileKey> paint(cairo_t* cr, double zoom, double scale, const xoj::util::Rectangle<double>& area,
+                               double pageWidth, double pageHeight, bool refineDrafts = true);
+
+    /**
+     * @return The keys of the tiles of the area (page coordinates) which are missing or stale at the given scale
+     */
+    std::vector<TileKey> getMissingTiles(double scale, const xoj::util::Rectangle<double>& area) const;
+
+    /**
+     * @return The keys of all tiles of the scale intersecting the area (page coordinates)
+     */
+    static std::vector<TileKey> tilesInArea(double scale, const xoj::util::Rectangle<double>& area);
+
+    /**
+     * @return The low resolution scale used while a zoom gesture is running. It is rounded down to a power of two,
+     *         so the same preview tiles can be shown for many steps of the gesture.
+     */
+    static double getPreviewScale(double scale);
+
+    /**
+     * @brief Stores a rendered tile; the buffer takes ownership of the surfaces
+     *
+     * @param background The background alone, under the layers of surface, or nullptr
+     * @param draft Whether the tile was rendered as a draft, see paint()
+     */
+    void putTile(const TileKey& key, cairo_surface_t* surface, cairo_surface_t* background = nullptr,
+                 bool draft = false);
+
+    /**
+     * @return The surface of the tile or nullptr (still owned by the buffer)
+     */
+    cairo_surface_t* getTile(const TileKey& key) const;
+
+    /**
+     * @brief Calls fn on all tiles of the given scale intersecting the area (page coordinates). It may draw into them:
+     *        the tiles shared with another buffer are copied first.
+     */
+    void forEachTile(double scale, const xoj::util::Rectangle<double>& area,
+                     const std::function<void(const TileKey&, cairo_surface_t*)>& fn);
+
+    /**
+     * @brief Flags the tiles of the given scale intersecting the area (page coordinates) as drafts, e.g. after a draft
+     *        of the area was drawn into them
+     */
+    void markDrafts(double scale, const xoj::util::Rectangle<double>& area);
+
+    /**
+     * @return Whether all the tiles of the given scale intersecting the area (page coordinates) keep their background
+     */
+    bool hasBackgrounds(double scale, const xoj::util::Rectangle<double>& area) const;
+
+    /**
+     * @brief Calls fn on the backgrounds of the tiles of the given scale intersecting the area (page coordinates)
+     */
+    void forEachBackground(double scale, const xoj::util::Rectangle<double>& area,
+                           const std::function<void(const TileKey&, cairo_surface_t*)>& fn) const;
+
+    /**
+     * @return The keys of all the tiles rendered at the given scale
+     */
+    std::vector<TileKey> getTileKeys(double scale) const;
+
+    /**
+     * @brief Flags all tiles as outdated. They are still drawn until they are rendered again.
+     */
+    void invalidate();
+
+    /**
+     * @brief Removes the tiles of the given area which were not rendered at the given scale
+     */
+    void dropOtherScales(double scale, const xoj::util::Rectangle<double>& area);
+
+    /**
+     * @brief Removes all the tiles not rendered at the given scale
+     */
+    void dropOtherScales(double scale);
+
+    /**
+     * @brief Removes a single tile
+     */
+    void dropTile(const TileKey& key);
+
+    /**
+     * @brief Removes all the tiles
+     */
+    void clear();
+
+    /**
+     * @brief Exchanges the tiles of the two buffers
+     */
+    void swap(TiledPageBuffer& other);
+
+    /**
+     * @brief Whether paint() copies the tiles to surfaces of the display backend, if it is not an image surface
+     */
+    void setDeviceCopies(bool enabled);
+
+    /**
+     * @return A copy of the buffer which shares the surfaces of the tiles, until either buffer draws into them with
+     *         forEachTile() or replaces them with putTile()
+     */
+    std::unique_ptr<TiledPageBuffer> share() const;
+
+    bool isEmpty() const;
+
+    /**
+     * @return The number of pixels of all tiles, backgrounds and device copies included
+     */
+    size_t getPixelCount() const;
+
+    /**
+     * @return The last use of every tile. Uses of all pages are comparable.
+     */
+    std::vector<uint64_t> getTileUses() const;
+
+    /**
+     * @brief Removes the tiles which were neither painted nor rendered since the given use
+     */
+    void dropTilesUsedBefore(uint64_t lastUse);
+
+private:
+    struct Tile {
+        cairo_surface_t* surface = nullptr;
+
+        /// The background alone, or nullptr
+        cairo_surface_t* background = nullptr;
+
+        /// The copy of the surface in the display backend, or nullptr
+        cairo_surface_t* deviceCopy = nullptr;
+
+        /// Value of useClock when the tile was last painted or rendered
+        uint64_t lastUse = 0;
+
+        /// The content of the page changed since this tile was rendered
+        bool stale = false;
+
+        /// Rendered in draft quality, to be rendered again once the view settles
+        bool draft = false;
+    };
+
+    /**
+     * Shared by all pages, so tiles of different pages can be evicted in least recently used order
+     */
+    static std::atomic<uint64_t> useClock;
+
+    void destroy(Tile& tile);
+
+    /**
+     * @return The device copy of the tile for the target of cr, uploaded if needed, or the tile itself
+     */
+    cairo_surface_t* getDeviceCopy(cairo_t* cr, Tile& tile);
+
+    /**
+     * Destroys the device copies released by the jobs, on the thread of the display
+     */
+    void destroyReleasedCopies();
+
+    std::map<TileKey, Tile> tiles;
+
+    bool deviceCopies = false;
+
+    /**
+     * The device copies of the tiles replaced or drawn into by the render jobs. The display backends are not thread
+     * safe, so they are destroyed by the next paint().
+     */
+    std::vector<cairo_surface_t*> releasedCopies;
+};
@@ -2,22 +2,32 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <memory>
+#include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include <gdk/gdk.h>
 
 #include "control/Control.h"
+#include "control/PageResidency.h"
 #include "control/PdfCache.h"
+#include "control/PdfTextCache.h"
 #include "control/settings/MetadataManager.h"
 #include "gui/PdfFloatingToolbox.h"
 #include "gui/inputdevices/HandRecognition.h"
+#include "gui/inputdevices/InputContext.h"
 #include "gui/widgets/XournalWidget.h"
 #include "model/Document.h"
 #include "model/Stroke.h"
 #include "undo/DeleteUndoAction.h"
+#include "util/Profiler.h"
 #include "util/Rectangle.h"
 #include "util/Util.h"
+#include "util/i18n.h"
+#include "view/TexImageCache.h"
 
 #include "Layout.h"
 #include "PageView.h"
@@ -28,6 +38,14 @@
 
 using xoj::util::Rectangle;
 
+/**
+ * The TeX images are rasterized within a quarter of the memory budget of the PDF pages
+ */
+static void updateTexImageCache(Settings* settings) {
+    xoj::view::TexImageCache::getInstance().setMaxBytes(size_t{settings->getPdfCacheMemorySize()} * 1024U * 1024U /
+                                                        4U);
+}
+
 std::pair<size_t, size_t> XournalView::preloadPageBounds(size_t page, size_t maxPage) {
     const size_t preloadBefore = this->control->getSettings()->getPreloadPagesBefore();
     const size_t preloadAfter = this->control->getSettings()->getPreloadPagesAfter();
@@ -36,14 +54,38 @@ std::pair<size_t, size_t> XournalView::preloadPageBounds(size_t page, size_t max
     return {lower, upper};
 }
 
+auto XournalView::isPresentationPreload(size_t page) const -> bool {
+    const size_t current = this->currentPage;
+    return this->control->getSettings()->isPresentationMode() && page + PRESENTATION_PRELOAD_PAGES >= current &&
+           page <= current + PRESENTATION_PRELOAD_PAGES;
+}
+
+void XournalView::prerenderPresentationPages() {
+    const size_t first =
+            this->currentPage > PRESENTATION_PRELOAD_PAGES ? this->currentPage - PRESENTATION_PRELOAD_PAGES : 0;
+    const size_t last = std::min(this->pageSlots.size(), this->currentPage + PRESENTATION_PRELOAD_PAGES + 1);
+    for (size_t i = first; i < last; i++) {
+        if (i == this->currentPage) {
+            continue;
+        }
+        // The render ahead jobs wait for the ones of the current page
+        XojPageView* v = getViewFor(i);
+        const PageRef& page = v->getPage();
+        v->renderAhead(xoj::util::Rectangle<double>(0, 0, page->getWidth(), page->getHeight()));
+    }
+}
+
 XournalView::XournalView(GtkWidget* parent, Control* control, ScrollHandling* scrollHandling):
         scrollHandling(scrollHandling), control(control) {
     Document* doc = control->getDocument();
     doc->lock();
     if (doc->getPdfPageCount() != 0) {
-        this->cache = std::make_unique<PdfCache>(doc->getPdfDocument(), control->getSettings());
+        this->cache = PdfCache::getShared(doc->getPdfDocument(), control->getSettings());
+        this->textCache = std::make_unique<PdfTextCache>(doc->getPdfDocument());
     }
     doc->unlock();
+    updateTexImageCache(control->getSettings());
+    this->pageResidency = std::make_unique<PageResidency>(0);
 
     registerListener(control);
 
@@ -71,9 +113,25 @@ XournalView::XournalView(GtkWidget* parent, Control* control, ScrollHandling* sc
 
 XournalView::~XournalView() {
     g_source_remove(this->cleanupTimeout);
+    if (this->profilerTimeout) {
+        g_source_remove(this->profilerTimeout);
+    }
+    if (this->refineTimeout) {
+        g_source_remove(this->refineTimeout);
+        this->refineTimeout = 0;
+    }
 
-    for (auto&& page: viewPages) { delete page; }
-    viewPages.clear();
+    if (this->cache && this->cache.use_count() == 1) {
+        // The jobs of a shared cache may belong to the sidebar
+        control->getScheduler()->removePdfCache(this->cache.get());
+    }
+    if (this->textCache) {
+        control->getScheduler()->removePdfTextCache(this->textCache.get());
+    }
+
+    for (auto&& slot: pageSlots) { delete slot.view; }
+    pageSlots.clear();
+    this->blankPageTiles.clear();
 
     delete this->repaintHandler;
     this->repaintHandler = nullptr;
@@ -97,31 +155,196 @@ void XournalView::staticLayoutPages(GtkWidget* widget, GtkAllocation* allocation
 
 auto XournalView::clearMemoryTimer(XournalView* widget) -> gboolean {
     widget->cleanupBufferCache();
+    // Only from the timer: cleanupBufferCache() also runs on page changes, with the view handling an event on the stack
+    widget->recycleViews();
+    widget->unloadPages();
     return true;
 }
 
+auto XournalView::profilerOverlayTimer(XournalView* view) -> gboolean {
+    // The measurements change without any change of the view
+    const GdkRectangle& r = view->profilerOverlayRect;
+    if (r.width > 0 && r.height > 0) {
+        gtk_widget_queue_draw_area(view->widget, r.x, r.y, r.width, r.height);
+    }
+    return true;
+}
+
+void XournalView::toggleProfilerOverlay() {
+    auto& profiler = xoj::util::Profiler::getInstance();
+    if (this->profilerTimeout) {
+        g_source_remove(this->profilerTimeout);
+        this->profilerTimeout = 0;
+        profiler.setEnabled(this->profilerWasEnabled);
+        const GdkRectangle& r = this->profilerOverlayRect;
+        gtk_widget_queue_draw_area(this->widget, r.x, r.y, r.width, r.height);
+        this->profilerOverlayRect = {};
+        return;
+    }
+
+    this->profilerWasEnabled = profiler.isEnabled();
+    profiler.setEnabled(true);
+    this->profilerTimeout = g_timeout_add(500, reinterpret_cast<GSourceFunc>(profilerOverlayTimer), this);
+    gtk_widget_queue_draw(this->widget);
+}
+
+auto XournalView::isProfilerOverlayVisible() const -> bool { return this->profilerTimeout != 0; }
+
+void XournalView::paintProfilerOverlay(cairo_t* cr) {
+    constexpr double FONT_SIZE = 12;
+    constexpr double LINE_HEIGHT = 15;
+    constexpr double PADDING = 8;
+    constexpr double MARGIN = 10;
+
+    auto lines = xoj::util::Profiler::getInstance().getSummary();
+    auto inputLines = getInputContext()->getInputMetrics().getSummary();
+    lines.insert(lines.end(), inputLines.begin(), inputLines.end());
+    if (lines.empty()) {
+        lines.emplace_back("No measurement yet");
+    }
+
+    cairo_save(cr);
+    cairo_select_font_face(cr, "Monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, FONT_SIZE);
+
+    double width = 0;
+    for (auto& line: lines) {
+        cairo_text_extents_t extents;
+        cairo_text_extents(cr, line.c_str(), &extents);
+        width = std::max(width, extents.x_advance);
+    }
+    width += 2 * PADDING;
+    double height = static_cast<double>(lines.size()) * LINE_HEIGHT + 2 * PADDING;
+
+    auto visible = gtk_xournal_get_layout(this->widget)->getVisibleRect();
+    double x = visible.x + MARGIN;
+    double y = visible.y + MARGIN;
+
+    cairo_set_source_rgba(cr, 0, 0, 0, 0.75);
+    cairo_rectangle(cr, x, y, width, height);
+    cairo_fill(cr);
+
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    for (size_t i = 0; i < lines.size(); i++) {
+        cairo_move_to(cr, x + PADDING, y + PADDING + static_cast<double>(i + 1) * LINE_HEIGHT - 3);
+        cairo_show_text(cr, lines[i].c_str());
+    }
+    cairo_restore(cr);
+
+    this->profilerOverlayRect = {static_cast<int>(x), static_cast<int>(y), static_cast<int>(std::ceil(width)) + 1,
+                                 static_cast<int>(std::ceil(height)) + 1};
+}
+
 auto XournalView::cleanupBufferCache() -> void {
-    const auto& [pagesLower, pagesUpper] = this->preloadPageBounds(this->currentPage, this->viewPages.size());
+    const auto& [pagesLower, pagesUpper] = this->preloadPageBounds(this->currentPage, this->pageSlots.size());
     g_assert(pagesLower <= pagesUpper);
 
-    for (size_t i = 0; i < this->viewPages.size(); i++) {
-        auto&& page = this->viewPages[i];
+    const bool compactStrokes = this->control->getSettings()->isCompactStrokeStorage();
+    Document* doc = this->control->getDocument();
+
+    // The window follows the scrolling: the pages about to enter the viewport are kept as well
+    const auto& renderAhead = gtk_xournal_get_layout(this->widget)->getRenderAheadPages();
+
+    std::vector<XojPageView*> views;
+    // The slides around the current one are pinned: their tiles count against the budget but are never evicted
+    std::vector<XojPageView*> evictable;
+    for (size_t i = 0; i < this->pageSlots.size(); i++) {
+        auto* page = this->pageSlots[i].view;
+        if (page == nullptr) {
+            continue;
+        }
+        views.push_back(page);
+        if (!isPresentationPreload(i)) {
+            evictable.push_back(page);
+        }
         const size_t pageNum = i + 1;
-        const bool isPreload = pagesLower <= pageNum && pageNum <= pagesUpper;
+        const bool isPreload = (pagesLower <= pageNum && pageNum <= pagesUpper) ||
+                               std::binary_search(renderAhead.begin(), renderAhead.end(), i) ||
+                               isPresentationPreload(i);
         if (!isPreload && page->getLastVisibleTime() > 0 && page->getBufferPixels() > 0) {
             page->deleteViewBuffer();
+
+            if (compactStrokes) {
+                // The strokes are not needed until the page is rendered again
+                doc->lock();
+                page->getPage()->compactStrokes();
+                doc->unlock();
+            }
+        }
+    }
+
+    // Keep the most recently used tiles of all pages within the memory budget
+    std::vector<uint64_t> uses;
+    size_t pinnedTiles = 0;
+    size_t snapshotPixels = 0;
+    for (auto* page: views) {
+        auto pageUses = page->getTileUses();
+        if (std::find(evictable.begin(), evictable.end(), page) != evictable.end()) {
+            uses.insert(uses.end(), pageUses.begin(), pageUses.end());
+        } else {
+            pinnedTiles += pageUses.size();
+        }
+        snapshotPixels += static_cast<size_t>(page->getSnapshotPixels());
+    }
+
+    const size_t tilePixels = size_t{TiledPageBuffer::TILE_SIZE} * TiledPageBuffer::TILE_SIZE;
+    const size_t tileBytes = 4U * tilePixels;
+    const size_t budgetTiles = size_t{control->getSettings()->getPageBufferCacheSize()} * 1024U * 1024U / tileBytes;
+    const size_t maxTiles = std::max<size_t>(1, budgetTiles > pinnedTiles ? budgetTiles - pinnedTiles : 0);
+
+    // The tiles kept for toggling the layers go first, the displayed ones are needed more
+    if (snapshotPixels > 0 && uses.size() + snapshotPixels / tilePixels > maxTiles) {
+        for (auto* page: views) {
+            page->deleteLayersSnapshot();
+        }
+    }
+    if (uses.size() > maxTiles) {
+        auto threshold = uses.begin() + static_cast<std::ptrdiff_t>(uses.size() - maxTiles);
+        std::nth_element(uses.begin(), threshold, uses.end());
+        for (auto* page: evictable) {
+            page->deleteTilesUsedBefore(*threshold);
         }
     }
 }
 
+void XournalView::recycleViews() {
+    // A selection or a PDF text selection may refer to any view, e.g. the one it was moved from
+    if (getSelection() || this->control->getWindow()->getPdfToolbox()->getSelection()) {
+        return;
+    }
+
+    const auto& [pagesLower, pagesUpper] = this->preloadPageBounds(this->currentPage, this->pageSlots.size());
+    Layout* layout = gtk_xournal_get_layout(this->widget);
+    const auto& visible = layout->getVisiblePages();
+    const auto& renderAhead = layout->getRenderAheadPages();
+
+    for (size_t i = 0; i < this->pageSlots.size(); i++) {
+        XojPageView*& view = this->pageSlots[i].view;
+        const size_t pageNum = i + 1;
+        const bool isNear = (pagesLower <= pageNum && pageNum <= pagesUpper) ||
+                            std::binary_search(visible.begin(), visible.end(), i) ||
+                            std::binary_search(renderAhead.begin(), renderAhead.end(), i) || isPresentationPreload(i);
+        if (view && !isNear && i != this->currentPage && i != this->lastSelectedPage && view->isRecyclable()) {
+            delete view;
+            view = nullptr;
+        }
+    }
+}
+
+void XournalView::unloadPages() {
+    this->pageResidency->setBudget(size_t{this->control->getSettings()->getPageMemorySize()} * 1024U * 1024U);
+    // The elements of the pages with a view may be referred to, e.g. by the text editor or the search results
+    this->pageResidency->update(*this->control->getDocument(), [this](size_t page) {
+        return page >= this->pageSlots.size() || this->pageSlots[page].view != nullptr || page == this->currentPage;
+    });
+}
+
 auto XournalView::getCurrentPage() const -> size_t { return currentPage; }
 
 const int scrollKeySize = 30;
 
 auto XournalView::onKeyPressEvent(GdkEventKey* event) -> bool {
-    size_t p = getCurrentPage();
-    if (p != npos && p < this->viewPages.size()) {
-        XojPageView* v = this->viewPages[p];
+    if (XojPageView* v = getViewFor(getCurrentPage())) {
         if (v->onKeyPressEvent(event)) {
             return true;
         }
@@ -146,6 +369,11 @@ auto XournalView::onKeyPressEvent(GdkEventKey* event) -> bool {
 
     guint state = event->state & gtk_accelerator_get_default_mod_mask();
 
+    if (event->keyval == GDK_KEY_F12 && state == (GDK_CONTROL_MASK | GDK_SHIFT_MASK)) {
+        toggleProfilerOverlay();
+        return true;
+    }
+
     Layout* layout = gtk_xournal_get_layout(this->widget);
 
     if (state & GDK_SHIFT_MASK) {
@@ -275,9 +503,7 @@ auto XournalView::onKeyPressEvent(GdkEventKey* event) -> bool {
 auto XournalView::getRepaintHandler() -> RepaintHandler* { return this->repaintHandler; }
 
 auto XournalView::onKeyReleaseEvent(GdkEventKey* event) -> bool {
-    size_t p = getCurrentPage();
-    if (p != npos && p < this->viewPages.size()) {
-        XojPageView* v = this->viewPages[p];
+    if (XojPageView* v = getViewFor(getCurrentPage())) {
         if (v->onKeyReleaseEvent(event)) {
             return true;
         }
@@ -296,19 +522,22 @@ void XournalView::onRealized(GtkWidget* widget, XournalView* view) {
 }
 
 void XournalView::onSettingsChanged() {
+    // The settings may change the rendering of the backgrounds
+    this->blankPageTiles.clear();
     if (this->cache) {
         this->cache->updateSettings(control->getSettings());
     }
+    updateTexImageCache(control->getSettings());
 }
 
 // send the focus back to the appropriate widget
 void XournalView::requestFocus() { gtk_widget_grab_focus(this->widget); }
 
 auto XournalView::searchTextOnPage(std::string text, size_t p, int* occures, double* top) -> bool {
-    if (p == npos || p >= this->viewPages.size()) {
+    XojPageView* v = getViewFor(p);
+    if (v == nullptr) {
         return false;
     }
-    XojPageView* v = this->viewPages[p];
 
     return v->searchTextOnPage(text, occures, top);
 }
@@ -321,10 +550,40 @@ void XournalView::forceUpdatePagenumbers() {
 }
 
 auto XournalView::getViewFor(size_t pageNr) -> XojPageView* {
-    if (pageNr == npos || pageNr >= this->viewPages.size()) {
+    if (pageNr == npos || pageNr >= this->pageSlots.size()) {
         return nullptr;
     }
-    return this->viewPages[pageNr];
+
+    PageSlot& slot = this->pageSlots[pageNr];
+    if (slot.view == nullptr) {
+        slot.view = new XojPageView(this, slot.page);
+        gtk_xournal_get_layout(this->widget)->placeView(slot.view, pageNr);
+        slot.view->setSelected(pageNr == this->lastSelectedPage);
+
+        // A new page is shown at once instead of blank until its background is rendered
+        if (auto tiles = this->blankPageTiles.get(*slot.page, getZoom() * getDpiScaleFactor())) {
+            slot.view->adoptTiles(std::move(tiles));
+        }
+    }
+    return slot.view;
+}
+
+auto XournalView::getExistingViewFor(size_t pageNr) const -> XojPageView* {
+    if (pageNr == npos || pageNr >= this->pageSlots.size()) {
+        return nullptr;
+    }
+    return this->pageSlots[pageNr].view;
+}
+
+void XournalView::storeBlankPageTiles(XojPageView* view) {
+    const double scale = getZoom() * getDpiScaleFactor();
+    XojPage& page = *view->getPage();
+    if (!BlankPageTiles::isBlank(page) || this->blankPageTiles.contains(page, scale)) {
+        return;
+    }
+    if (auto tiles = view->shareTiles(scale)) {
+        this->blankPageTiles.store(page, scale, std::move(tiles));
+    }
 }
 
 void XournalView::pageSelected(size_t page) {
@@ -341,16 +600,15 @@ void XournalView::pageSelected(size_t page) {
 
     control->getWindow()->getPdfToolbox()->userCancelSelection();
 
-    if (this->lastSelectedPage != npos && this->lastSelectedPage < this->viewPages.size()) {
-        this->viewPages[this->lastSelectedPage]->setSelected(false);
+    if (XojPageView* last = getExistingViewFor(this->lastSelectedPage)) {
+        last->setSelected(false);
     }
 
     this->currentPage = page;
 
     size_t pdfPage = npos;
 
-    if (page != npos && page < viewPages.size()) {
-        XojPageView* vp = viewPages[page];
+    if (XojPageView* vp = getViewFor(page)) {
         vp->setSelected(true);
         lastSelectedPage = page;
         pdfPage = vp->getPage()->getPdfPageNr();
@@ -358,6 +616,9 @@ void XournalView::pageSelected(size_t page) {
 
     control->updatePageNumbers(currentPage, pdfPage);
 
+    // So that the text is ready once the user selects or searches it
+    getPdfTextLayout(pdfPage);
+
     control->updateBackgroundSizeButton();
 
     if (control->getSettings()->isEagerPageCleanup()) {
@@ -365,31 +626,36 @@ void XournalView::pageSelected(size_t page) {
     }
 
     // Load surrounding pages if they are not
-    const auto& [pagesLower, pagesUpper] = preloadPageBounds(page, this->viewPages.size());
+    const auto& [pagesLower, pagesUpper] = preloadPageBounds(page, this->pageSlots.size());
     g_assert(pagesLower <= pagesUpper);
     for (size_t i = pagesLower; i < pagesUpper; i++) {
-        if (this->viewPages[i]->getBufferPixels() == 0) {
-            this->viewPages[i]->rerenderPage();
+        XojPageView* v = getViewFor(i);
+        if (v->getBufferPixels() == 0) {
+            v->rerenderPage();
         }
     }
+
+    if (control->getSettings()->isPresentationMode()) {
+        prerenderPresentationPages();
+    }
 }
 
 auto XournalView::getControl() -> Control* { return control; }
 
 void XournalView::scrollTo(size_t pageNo, double yDocument) {
-    if (pageNo >= this->viewPages.size()) {
+    if (pageNo >= this->pageSlots.size()) {
         return;
     }
 
-    XojPageView* v = this->viewPages[pageNo];
-
     // Make sure it is visible
     Layout* layout = gtk_xournal_get_layout(this->widget);
 
-    int x = v->getX();
-    int y = v->getY() + std::lround(yDocument);
-    int width = v->getDisplayWidth();
-    int height = v->getDisplayHeight();
+    // The page may have no view yet
+    auto rect = layout->getPageRect(pageNo);
+    int x = static_cast<int>(rect.x);
+    int y = static_cast<int>(rect.y) + std::lround(yDocument);
+    int width = static_cast<int>(rect.width);
+    int height = static_cast<int>(rect.height);
 
     layout->ensureRectIsVisible(x, y, width, height);
 
@@ -414,16 +680,22 @@ void XournalView::pageRelativeXY(int offCol, int offRow) {
 
 
 void XournalView::endTextAllPages(XojPageView* except) {
-    for (auto v: this->viewPages) {
-        if (except != v) {
-            v->endText();
+    for (auto&& slot: this->pageSlots) {
+        if (slot.view && except != slot.view) {
+            slot.view->endText();
         }
     }
 }
 
 void XournalView::layerChanged(size_t page) {
-    if (page != npos && page < this->viewPages.size()) {
-        this->viewPages[page]->rerenderPage();
+    if (XojPageView* v = getExistingViewFor(page)) {
+        v->rerenderPage();
+    }
+}
+
+void XournalView::layerVisibilityChanged(size_t page, const std::vector<bool>& previous) {
+    if (XojPageView* v = getExistingViewFor(page)) {
+        v->layerVisibilityChanged(previous);
     }
 }
 
@@ -448,10 +720,10 @@ void XournalView::getPasteTarget(double& x, double& y) {
  * Or nullptr if the page is not visible
  */
 auto XournalView::getVisibleRect(size_t page) -> Rectangle<double>* {
-    if (page == npos || page >= this->viewPages.size()) {
+    XojPageView* p = getViewFor(page);
+    if (p == nullptr) {
         return nullptr;
     }
-    XojPageView* p = this->viewPages[page];
 
     return getVisibleRect(p);
 }
@@ -472,6 +744,41 @@ auto XournalView::getScrollHandling() -> ScrollHandling* { return scrollHandling
 
 auto XournalView::getWidget() -> GtkWidget* { return widget; }
 
+auto XournalView::getInputContext() -> InputContext* { return GTK_XOURNAL(this->widget)->input; }
+
+auto XournalView::isDraftRendering() -> bool {
+    if (!this->widget) {
+        return false;
+    }
+
+    bool interacting = false;
+    switch (control->getSettings()->getDraftRendering()) {
+        case DRAFT_RENDERING_INTERACTION:
+            interacting = gtk_xournal_get_layout(this->widget)->isScrolling() || getInputContext()->isInputRunning();
+            [[fallthrough]];
+        case DRAFT_RENDERING_ZOOM:
+            interacting = interacting || control->getZoomControl()->isZoomGestureActive();
+            break;
+        default:
+            break;
+    }
+
+    if (interacting && !this->refineTimeout) {
+        this->refineTimeout =
+                g_timeout_add(REFINE_CHECK_PERIOD, reinterpret_cast<GSourceFunc>(refineDraftsTimer), this);
+    }
+    return interacting;
+}
+
+auto XournalView::refineDraftsTimer(XournalView* view) -> gboolean {
+    if (view->isDraftRendering()) {
+        return true;
+    }
+    view->refineTimeout = 0;
+    gtk_xournal_repaint(view->widget);
+    return false;
+}
+
 void XournalView::ensureRectIsVisible(int x, int y, int width, int height) {
     Layout* layout = gtk_xournal_get_layout(this->widget);
     layout->ensureRectIsVisible(x, y, width, height);
@@ -488,7 +795,24 @@ void XournalView::zoomChanged() {
         return;
     }
 
-    layoutPages();
+    // The tiles being rendered are at the former zoom, e.g. during a zoom gesture
+    for (auto&& slot: this->pageSlots) {
+        if (slot.view) {
+            slot.view->cancelRendering();
+        }
+    }
+
+    // The page sizes did not change
+    gtk_xournal_get_layout(this->widget)->recalculateZoom();
+    placePages();
+
+    if (zoom->isResizeActive()) {
+        // The zoom fit follows the size of the window: the tiles are drawn stretched meanwhile. The pages are rendered
+        // and the rest is updated once, at the end of the resize
+        scrollTo(currentPage);
+        this->control->getScheduler()->blockRerenderZoom();
+        return;
+    }
 
     if (zoom->isZoomPresentationMode() || zoom->isZoomFitMode()) {
         scrollTo(currentPage);
@@ -514,36 +838,47 @@ void XournalView::zoomChanged() {
     // and if user clicked the selection again, the floating toolbox shows again
     control->getWindow()->getPdfToolbox()->hide();
 
-    this->control->getScheduler()->blockRerenderZoom();
+    // While pinching, pages are progressively rendered at low resolution, see XojPageView::paintPageSync
+    if (!zoom->isZoomGestureActive()) {
+        this->control->getScheduler()->blockRerenderZoom();
+    }
+}
+
+void XournalView::zoomGestureEnded() {
+    // Painting requests the full resolution tiles of the visible area
+    this->control->getScheduler()->unblockRerenderZoom();
+    gtk_xournal_repaint(this->widget);
 }
 
 void XournalView::pageSizeChanged(size_t page) {
-    layoutPages();
-    if (page != npos && page < this->viewPages.size()) {
-        this->viewPages[page]->rerenderPage();
+    gtk_xournal_get_layout(this->widget)->recalculatePage(page);
+    placePages();
+    if (XojPageView* v = getExistingViewFor(page)) {
+        v->rerenderPage();
     }
 }
 
 void XournalView::pageChanged(size_t page) {
-    if (page != npos && page < this->viewPages.size()) {
-        this->viewPages[page]->rerenderPage();
+    // A page without view is rendered once it gets one
+    if (XojPageView* v = getExistingViewFor(page)) {
+        v->rerenderPage();
     }
 }
 
 void XournalView::pageDeleted(size_t page) {
     size_t currentPage = control->getCurrentPageNo();
 
-    delete this->viewPages[page];
-    viewPages.erase(begin(viewPages) + page);
+    delete this->pageSlots[page].view;
+    pageSlots.erase(begin(pageSlots) + static_cast<std::ptrdiff_t>(page));
 
     layoutPages();
     control->getScrollHandler()->scrollToPage(currentPage);
 }
 
 auto XournalView::getTextEditor() -> TextEditor* {
-    for (auto&& page: viewPages) {
-        if (page->getTextEditor()) {
-            return page->getTextEditor();
+    for (auto&& slot: pageSlots) {
+        if (slot.view && slot.view->getTextEditor()) {
+            return slot.view->getTextEditor();
         }
     }
 
@@ -552,13 +887,92 @@ auto XournalView::getTextEditor() -> TextEditor* {
 
 auto XournalView::getCache() -> PdfCache* { return this->cache.get(); }
 
+void XournalView::prefetchPdfBackgrounds(size_t page) {
+    if (!this->cache) {
+        return;
+    }
+
+    // Same zoom as the one used by the RenderJob
+    double zoom = getZoom() * getDpiScaleFactor();
+
+    std::vector<size_t> pdfPages;
+    std::vector<size_t> neighbours{page + 1, page - 1};
+    if (control->getSettings()->isPresentationMode()) {
+        for (size_t d = 2; d <= PRESENTATION_PRELOAD_PAGES; d++) {
+            neighbours.push_back(page + d);
+            neighbours.push_back(page - d);
+        }
+    }
+    for (size_t neighbour: neighbours) {
+        if (neighbour >= this->pageSlots.size()) {
+            continue;
+        }
+        const PageRef& p = this->pageSlots[neighbour].page;
+        if (p->getBackgroundType().isPdfPage() && !this->cache->contains(p->getPdfPageNr(), zoom)) {
+            pdfPages.push_back(p->getPdfPageNr());
+        }
+    }
+
+    if (!pdfPages.empty()) {
+        control->getScheduler()->addPdfPrefetch(this->cache.get(), std::move(pdfPages), zoom);
+    }
+}
+
+auto XournalView::getPdfTextLayout(size_t pdfPage) -> std::shared_ptr<const PdfTextLayout> {
+    if (!this->textCache || pdfPage == npos) {
+        return nullptr;
+    }
+
+    auto layout = this->textCache->get(pdfPage);
+    if (!layout && this->textCache->markPending(pdfPage)) {
+        control->getScheduler()->addPdfText(this->textCache.get(), pdfPage);
+    }
+    return layout;
+}
+
+auto XournalView::getPdfLinks(size_t pdfPage) -> std::shared_ptr<const PdfLinkIndex> {
+    if (!this->textCache || pdfPage == npos) {
+        return nullptr;
+    }
+
+    auto links = this->textCache->getLinks(pdfPage);
+    if (!links && this->textCache->markPending(pdfPage)) {
+        control->getScheduler()->addPdfText(this->textCache.get(), pdfPage);
+    }
+    return links;
+}
+
+void XournalView::showPdfLinkHover(const XojPdfPage::Link* link) {
+    std::string tooltip;
+    bool followed = false;
+    if (link && link->destPage != npos) {
+        Document* doc = control->getDocument();
+        doc->lock();
+        size_t page = doc->findPdfPage(link->destPage);
+        doc->unlock();
+
+        followed = page != npos;
+        tooltip = followed ? FS(_F("Go to page {1}") % (page + 1)) :
+                             FS(_F("Page {1} of the PDF is not in the document") % (link->destPage + 1));
+    } else if (link) {
+        followed = !link->annotation;
+        tooltip = link->text;
+    }
+
+    getCursor()->setOverPdfLink(followed);
+    if (tooltip != this->pdfLinkTooltip) {
+        this->pdfLinkTooltip = std::move(tooltip);
+        gtk_widget_set_tooltip_text(this->widget, this->pdfLinkTooltip.empty() ? nullptr : this->pdfLinkTooltip.c_str());
+    }
+}
+
 void XournalView::pageInserted(size_t page) {
     Document* doc = control->getDocument();
     doc->lock();
-    auto* pageView = new XojPageView(this, doc->getPage(page));
+    PageSlot slot{doc->getPage(page)};
     doc->unlock();
 
-    viewPages.insert(begin(viewPages) + page, pageView);
+    pageSlots.insert(begin(pageSlots) + static_cast<std::ptrdiff_t>(page), std::move(slot));
 
     layoutPages();
     // check which pages are visible and select the most visible page
@@ -566,6 +980,22 @@ void XournalView::pageInserted(size_t page) {
     layout->updateVisibility();
 }
 
+void XournalView::pagesInserted(size_t first, size_t count) {
+    Document* doc = control->getDocument();
+    std::vector<PageSlot> inserted;
+    inserted.reserve(count);
+    doc->lock();
+    for (size_t i = 0; i < count; i++) { inserted.push_back({doc->getPage(first + i)}); }
+    doc->unlock();
+
+    pageSlots.insert(begin(pageSlots) + static_cast<std::ptrdiff_t>(first), std::make_move_iterator(inserted.begin()),
+                     std::make_move_iterator(inserted.end()));
+
+    layoutPages();
+    Layout* layout = gtk_xournal_get_layout(this->widget);
+    layout->updateVisibility();
+}
+
 auto XournalView::getZoom() -> double { return control->getZoomControl()->getZoom(); }
 
 auto XournalView::getDpiScaleFactor() -> int { return gtk_widget_get_scale_factor(widget); }
@@ -671,14 +1101,20 @@ void XournalView::repaintSetsquare(bool evenWithoutSetsquare) {
 }
 
 void XournalView::layoutPages() {
+    gtk_xournal_get_layout(this->widget)->recalculate();
+    placePages();
+}
+
+void XournalView::placePages() {
     Layout* layout = gtk_xournal_get_layout(this->widget);
-    layout->recalculate();
 
     // Todo (fabian): the following lines are conceptually wrong, the Layout::layoutPages function is meant to be called
     //                by an expose event, but removing it, will break "add page".
     auto rectangle = layout->getVisibleRect();
     layout->layoutPages(std::max<int>(layout->getMinimalWidth(), std::lround(rectangle.width)),
                         std::max<int>(layout->getMinimalHeight(), std::lround(rectangle.height)));
+    // The pages may have moved within the same size
+    gtk_xournal_repaint(this->widget);
 }
 
 auto XournalView::getDisplayHeight() const -> int {
@@ -711,6 +1147,10 @@ auto XournalView::isPageVisible(size_t page, int* visibleHeight) -> bool {
 }
 
 void XournalView::documentChanged(DocumentChangeType type) {
+    if (type == DOCUMENT_CHANGE_PDF_RELOADED) {
+        pdfReloaded();
+        return;
+    }
     if (type != DOCUMENT_CHANGE_CLEARED && type != DOCUMENT_CHANGE_COMPLETE) {
         return;
     }
@@ -721,20 +1161,25 @@ void XournalView::documentChanged(DocumentChangeType type) {
 
     clearSelection();
 
-    for (auto&& page: viewPages) { delete page; }
-    viewPages.clear();
+    for (auto&& slot: pageSlots) { delete slot.view; }
+    pageSlots.clear();
+    this->blankPageTiles.clear();
 
-    this->cache.reset();
+    // Reused by the new cache if the PDF did not change
+    std::shared_ptr<PdfCache> previousCache = std::move(this->cache);
+    this->textCache.reset();
 
     Document* doc = control->getDocument();
     doc->lock();
     if (doc->getPdfPageCount() != 0) {
-        this->cache = std::make_unique<PdfCache>(doc->getPdfDocument(), control->getSettings());
+        this->cache = PdfCache::getShared(doc->getPdfDocument(), control->getSettings());
+        this->textCache = std::make_unique<PdfTextCache>(doc->getPdfDocument());
     }
 
+    // The views are created once the pages are shown
     size_t pagecount = doc->getPageCount();
-    viewPages.reserve(pagecount);
-    for (size_t i = 0; i < pagecount; i++) { viewPages.push_back(new XojPageView(this, doc->getPage(i))); }
+    pageSlots.reserve(pagecount);
+    for (size_t i = 0; i < pagecount; i++) { pageSlots.push_back({doc->getPage(i)}); }
 
     doc->unlock();
 
@@ -744,50 +1189,69 @@ void XournalView::documentChanged(DocumentChangeType type) {
     scheduler->unlock();
 }
 
+void XournalView::pdfReloaded() {
+    XournalScheduler* scheduler = this->control->getScheduler();
+    // No job renders the pages while the cache is replaced
+    scheduler->lock();
+    if (this->cache) {
+        scheduler->removePdfCache(this->cache.get());
+    }
+    if (this->textCache) {
+        scheduler->removePdfTextCache(this->textCache.get());
+    }
+    this->cache.reset();
+    this->textCache.reset();
+
+    // The views are kept: the new cache has the renderings of the pages which did not change
+    Document* doc = control->getDocument();
+    doc->lock();
+    if (doc->getPdfPageCount() != 0) {
+        this->cache = PdfCache::getShared(doc->getPdfDocument(), control->getSettings());
+        this->textCache = std::make_unique<PdfTextCache>(doc->getPdfDocument());
+    }
+    doc->unlock();
+
+    scheduler->unlock();
+}
+
 auto XournalView::cut() -> bool {
-    size_t p = getCurrentPage();
-    if (p == npos || p >= viewPages.size()) {
+    XojPageView* page = getViewFor(getCurrentPage());
+    if (page == nullptr) {
         return false;
     }
 
-    XojPageView* page = viewPages[p];
     return page->cut();
 }
 
 auto XournalView::copy() -> bool {
-    size_t p = getCurrentPage();
-    if (p == npos || p >= viewPages.size()) {
+    XojPageView* page = getViewFor(getCurrentPage());
+    if (page == nullptr) {
         return false;
     }
 
-    XojPageView* page = viewPages[p];
     return page->copy();
 }
 
 auto XournalView::paste() -> bool {
-    size_t p = getCurrentPage();
-    if (p == npos || p >= viewPages.size()) {
+    XojPageView* page = getViewFor(getCurrentPage());
+    if (page == nullptr) {
         return false;
     }
 
-    XojPageView* page = viewPages[p];
     return page->paste();
 }
 
 auto XournalView::actionDelete() -> bool {
-    size_t p = getCurrentPage();
-    if (p == npos || p >= viewPages.size()) {
+    XojPageView* page = getViewFor(getCurrentPage());
+    if (page == nullptr) {
         return false;
     }
 
-    XojPageView* page = viewPages[p];
     return page->actionDelete();
 }
 
 auto XournalView::getDocument() -> Document* { return control->getDocument(); }
 
-auto XournalView::getViewPages() const -> std::vector<XojPageView*> const& { return viewPages; }
-
 auto XournalView::getCursor() -> XournalppCursor* { return control->getCursor(); }
 
 auto XournalView::getSelection() -> EditSelection* {
@@ -11,12 +11,19 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <gtk/gtk.h>
 
 #include "control/zoom/ZoomListener.h"
 #include "gui/widgets/XournalWidget.h"
 #include "model/DocumentListener.h"
 #include "model/PageRef.h"
+#include "pdf/base/XojPdfPage.h"
+
+#include "BlankPageTiles.h"
 
 class Control;
 class XournalppCursor;
@@ -24,12 +31,17 @@ class Document;
 class EditSelection;
 class Layout;
 class PagePositionHandler;
+class PageResidency;
 class XojPageView;
 class PdfCache;
+class PdfTextCache;
+class PdfLinkIndex;
+class PdfTextLayout;
 class RepaintHandler;
 class ScrollHandling;
 class TextEditor;
 class HandRecognition;
+class InputContext;
 
 class XournalView: public DocumentListener, public ZoomListener {
 public:
@@ -55,12 +67,30 @@ public:
 
     void layerChanged(size_t page);
 
+    /**
+     * The visibility of the layers of the page changed, from the given one, see XojPage::getLayerVisibility()
+     */
+    void layerVisibilityChanged(size_t page, const std::vector<bool>& previous);
+
     void requestFocus();
 
     void forceUpdatePagenumbers();
 
+    /**
+     * @return The view of the page, created if the page has none, or nullptr if there is no such page
+     */
     XojPageView* getViewFor(size_t pageNr);
 
+    /**
+     * @return The view of the page, or nullptr if it has none: the views only exist for the pages near the viewport
+     */
+    XojPageView* getExistingViewFor(size_t pageNr) const;
+
+    /**
+     * Keeps the tiles of the view while its page is blank, for the new pages which look the same, see BlankPageTiles
+     */
+    void storeBlankPageTiles(XojPageView* view);
+
     bool searchTextOnPage(std::string text, size_t p, int* occures, double* top);
 
     bool cut();
@@ -91,20 +121,65 @@ public:
     void repaintSetsquare(bool evenWithoutSetsquare = false);
 
     TextEditor* getTextEditor();
-    std::vector<XojPageView*> const& getViewPages() const;
 
     Control* getControl();
     double getZoom();
+
+    /**
+     * @return The device pixels per logical pixel of the widget, by which the zoom is multiplied for the tiles and the
+     *         masks of the tools
+     *
+     * GTK 3 only reports integer scales: on a display with a fractional scale (e.g. 150 %), GTK draws the window at the
+     * next integer scale and the compositor downsamples it, so the pages are rendered at that scale as well. The render
+     * path works with any scale (see RenderJob and TiledPageBuffer), but a window buffer at the fractional scale is not
+     * available before GTK 4.
+     */
     int getDpiScaleFactor();
     Document* getDocument();
     PdfCache* getCache();
+
+    /**
+     * Rasterizes the PDF backgrounds of the pages next to the given one in the background
+     */
+    void prefetchPdfBackgrounds(size_t page);
+
+    /**
+     * The pages rendered in advance on each side of the current one in presentation mode. Their tiles are not evicted
+     * by cleanupBufferCache().
+     */
+    static constexpr size_t PRESENTATION_PRELOAD_PAGES = 2;
+
+    /**
+     * @return The text layout of the PDF page, or nullptr if it is not extracted yet. The extraction is then scheduled
+     *         in the background.
+     * @param pdfPage The page number (in the pdf document)
+     */
+    std::shared_ptr<const PdfTextLayout> getPdfTextLayout(size_t pdfPage);
+
+    /**
+     * @return The links and the annotations of the PDF page, like getPdfTextLayout(): they are extracted together
+     */
+    std::shared_ptr<const PdfLinkIndex> getPdfLinks(size_t pdfPage);
+
+    /**
+     * Shows the hovered link or annotation of a PDF background in the cursor and in the tooltip
+     * @param link nullptr once none is hovered
+     */
+    void showPdfLinkHover(const XojPdfPage::Link* link);
     RepaintHandler* getRepaintHandler();
     GtkWidget* getWidget();
+    InputContext* getInputContext();
     XournalppCursor* getCursor();
 
     xoj::util::Rectangle<double>* getVisibleRect(int page);
     xoj::util::Rectangle<double>* getVisibleRect(XojPageView* redrawable);
 
+    /**
+     * @return Whether the pages are rendered in draft quality now, during an interaction selected by the settings (see
+     *         DraftRendering). The drafts are rendered again once it ends.
+     */
+    bool isDraftRendering();
+
     /**
      * A pen action was detected now, therefore ignore touch events
      * for a short time
@@ -124,6 +199,7 @@ public:
 public:
     // ZoomListener interface
     void zoomChanged() override;
+    void zoomGestureEnded() override;
 
 public:
     // DocumentListener interface
@@ -131,6 +207,7 @@ public:
     void pageSizeChanged(size_t page) override;
     void pageChanged(size_t page) override;
     void pageInserted(size_t page) override;
+    void pagesInserted(size_t first, size_t count) override;
     void pageDeleted(size_t page) override;
     void documentChanged(DocumentChangeType type) override;
 
@@ -142,19 +219,69 @@ public:
 
     void onSettingsChanged();
 
+    /**
+     * Shows or hides the overlay of the render measurements (Ctrl+Shift+F12), see xoj::util::Profiler
+     */
+    void toggleProfilerOverlay();
+    bool isProfilerOverlayVisible() const;
+
+    /**
+     * Draws the overlay in the top left corner of the viewport
+     */
+    void paintProfilerOverlay(cairo_t* cr);
+
 private:
     void fireZoomChanged();
 
     std::pair<size_t, size_t> preloadPageBounds(size_t page, size_t maxPage);
 
+    /**
+     * @return Whether the page is one of the PRESENTATION_PRELOAD_PAGES before or after the current one, in
+     *         presentation mode
+     */
+    bool isPresentationPreload(size_t page) const;
+
+    /**
+     * Renders the pages around the current one in presentation mode, after it: the next or previous slide is then
+     * shown at once. Their PDF backgrounds are rasterized at the zoom of the slides by the same jobs.
+     */
+    void prerenderPresentationPages();
+
     xoj::util::Rectangle<double>* getVisibleRect(size_t page);
 
     static gboolean clearMemoryTimer(XournalView* widget);
 
+    static gboolean profilerOverlayTimer(XournalView* view);
+
+    /**
+     * Repaints the view once the interaction ended, which requests the draft tiles again, see isDraftRendering()
+     */
+    static gboolean refineDraftsTimer(XournalView* view);
+
     void cleanupBufferCache();
 
+    /**
+     * Destroys the views of the pages far from the viewport, if they hold nothing besides their buffers
+     */
+    void recycleViews();
+
+    /**
+     * Unloads the least recently used pages without a view over the memory budget of the settings
+     */
+    void unloadPages();
+
     static void staticLayoutPages(GtkWidget* widget, GtkAllocation* allocation, void* data);
 
+    /**
+     * Lays the pages out, once the Layout is recalculated
+     */
+    void placePages();
+
+    /**
+     * Takes the cache of the new version of the PDF, see PdfReloader
+     */
+    void pdfReloaded();
+
 private:
     /**
      * Scrollbars
@@ -164,14 +291,29 @@ private:
     GtkWidget* widget = nullptr;
     double margin = 75;
 
-    std::vector<XojPageView*> viewPages;
+    /**
+     * One per page of the document. The layout only uses the page sizes, the XojPageView is created once the page
+     * gets near the viewport, see getViewFor(), and destroyed when it is far from it again, see recycleViews().
+     */
+    struct PageSlot {
+        PageRef page;
+        XojPageView* view = nullptr;
+    };
+    std::vector<PageSlot> pageSlots;
 
     Control* control = nullptr;
 
     size_t currentPage = 0;
     size_t lastSelectedPage = -1;
 
-    std::unique_ptr<PdfCache> cache;
+    std::shared_ptr<PdfCache> cache;
+    std::unique_ptr<PdfTextCache> textCache;
+
+    /// Of the hovered link, see showPdfLinkHover()
+    std::string pdfLinkTooltip;
+    std::unique_ptr<PageResidency> pageResidency;
+
+    BlankPageTiles blankPageTiles;
 
     /**
      * Handler for rerendering pages / repainting pages
@@ -188,5 +330,30 @@ private:
      */
     HandRecognition* handRecognition = nullptr;
 
+    /**
+     * Refreshes the overlay of the render measurements while it is shown, or 0
+     */
+    guint profilerTimeout = 0;
+
+    /**
+     * Checks whether the interaction rendering the drafts ended, or 0
+     */
+    guint refineTimeout = 0;
+
+    /**
+     * The period of refineTimeout, in milliseconds
+     */
+    static constexpr guint REFINE_CHECK_PERIOD = 100;
+
+    /**
+     * The profiler was recording before the overlay was shown, e.g. for --profile
+     */
+    bool profilerWasEnabled = false;
+
+    /**
+     * The area of the overlay in the last paint, in widget coordinates
+     */
+    GdkRectangle profilerOverlayRect{};
+
     friend class Layout;
 };
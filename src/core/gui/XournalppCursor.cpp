@@ -1,7 +1,9 @@
 #include "XournalppCursor.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <tuple>
 
 #include "control/Control.h"
 #include "util/Util.h"
@@ -100,7 +102,43 @@ constexpr auto LENGTH_ARROW_HEAD = 0.7;
 constexpr auto RESIZE_CURSOR_HASH_PRECISION = 1000;
 
 
-XournalppCursor::~XournalppCursor() = default;
+XournalppCursor::~XournalppCursor() { clearCache(); }
+
+void XournalppCursor::clearCache() {
+    for (auto& [key, entry]: this->cursorCache) { g_object_unref(entry.cursor); }
+    this->cursorCache.clear();
+}
+
+auto XournalppCursor::getCachedCursor(guint id, gulong flavour, long size, const std::function<GdkCursor*()>& create)
+        -> GdkCursor* {
+    int scale = 1;
+    if (MainWindow* win = control->getWindow(); win && win->getXournal()) {
+        scale = gtk_widget_get_scale_factor(win->getXournal()->getWidget());
+    }
+    auto key = std::make_tuple(id, flavour, size, scale);
+    this->cacheUses++;
+
+    auto it = this->cursorCache.find(key);
+    if (it != this->cursorCache.end()) {
+        it->second.lastUse = this->cacheUses;
+        return GDK_CURSOR(g_object_ref(it->second.cursor));
+    }
+
+    GdkCursor* cursor = create();
+    if (cursor == nullptr) {
+        return nullptr;
+    }
+
+    if (this->cursorCache.size() >= MAX_CACHED_CURSORS) {
+        auto oldest = std::min_element(this->cursorCache.begin(), this->cursorCache.end(), [](auto& a, auto& b) {
+            return a.second.lastUse < b.second.lastUse;
+        });
+        g_object_unref(oldest->second.cursor);
+        this->cursorCache.erase(oldest);
+    }
+    this->cursorCache.emplace(key, CachedCursor{GDK_CURSOR(g_object_ref(cursor)), this->cacheUses});
+    return cursor;
+}
 
 
 void XournalppCursor::setInputDeviceClass(InputDeviceClass device) { this->inputDevice = device; }
@@ -182,6 +220,17 @@ void XournalppCursor::setInsidePage(bool insidePage) {
 }
 
 
+void XournalppCursor::setOverPdfLink(bool overPdfLink) {
+    if (this->overPdfLink == overPdfLink) {
+        return;
+    }
+
+    this->overPdfLink = overPdfLink;
+
+    updateCursor();
+}
+
+
 void XournalppCursor::setInvisible(bool invisible) {
     if (this->invisible == invisible) {
         return;
@@ -214,7 +263,10 @@ void XournalppCursor::updateCursor() {
         ToolType type = handler->getToolType();
 
 
-        if (type == TOOL_HAND) {
+        if (this->overPdfLink && !this->mouseDown &&
+            (type == TOOL_HAND || type == TOOL_SELECT_PDF_TEXT_LINEAR || type == TOOL_SELECT_PDF_TEXT_RECT)) {
+            setCursor(CRSR_HAND2);
+        } else if (type == TOOL_HAND) {
             if (this->mouseDown) {
                 setCursor(CRSR_GRABBING);
             } else {
@@ -329,36 +381,39 @@ auto XournalppCursor::getResizeCursor(double deltaAngle) -> GdkCursor* {
     this->currentCursor = CRSR_RESIZE;
     this->currentCursorFlavour = flavour;
 
-    double a = (this->angle + deltaAngle) * M_PI / 180;
-    cairo_surface_t* crCursor = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, RESIZE_CURSOR_SIZE, RESIZE_CURSOR_SIZE);
-    cairo_t* cr = cairo_create(crCursor);
-    cairo_set_source_rgba(cr, 0.1, 0.1, 0.1, 1);
-    cairo_translate(cr, RESIZE_CURSOR_SIZE / 2, RESIZE_CURSOR_SIZE / 2);
-    cairo_scale(cr, RESIZE_CURSOR_SIZE / 2, RESIZE_CURSOR_SIZE / 2);
-    cairo_set_line_width(cr, 0.2);
-    // draw double headed arrow rotated accordingly
-    cairo_move_to(cr, cos(a), sin(a));
-    cairo_line_to(cr, -cos(a), -sin(a));
-    cairo_stroke(cr);
-    // head and tail
-    for (auto s: {-1, 1}) {
-        cairo_move_to(cr, s * cos(a), s * sin(a));
-        cairo_rel_line_to(cr, s * cos(a + M_PI + DELTA_ANGLE_ARROW_HEAD) * LENGTH_ARROW_HEAD,
-                          s * sin(a + M_PI + DELTA_ANGLE_ARROW_HEAD) * LENGTH_ARROW_HEAD);
-        cairo_move_to(cr, s * cos(a), s * sin(a));
-        cairo_rel_line_to(cr, s * cos(a + M_PI - DELTA_ANGLE_ARROW_HEAD) * LENGTH_ARROW_HEAD,
-                          s * sin(a + M_PI - DELTA_ANGLE_ARROW_HEAD) * LENGTH_ARROW_HEAD);
+    return getCachedCursor(CRSR_RESIZE, flavour, 0, [&]() {
+        double a = (this->angle + deltaAngle) * M_PI / 180;
+        cairo_surface_t* crCursor =
+                cairo_image_surface_create(CAIRO_FORMAT_ARGB32, RESIZE_CURSOR_SIZE, RESIZE_CURSOR_SIZE);
+        cairo_t* cr = cairo_create(crCursor);
+        cairo_set_source_rgba(cr, 0.1, 0.1, 0.1, 1);
+        cairo_translate(cr, RESIZE_CURSOR_SIZE / 2, RESIZE_CURSOR_SIZE / 2);
+        cairo_scale(cr, RESIZE_CURSOR_SIZE / 2, RESIZE_CURSOR_SIZE / 2);
+        cairo_set_line_width(cr, 0.2);
+        // draw double headed arrow rotated accordingly
+        cairo_move_to(cr, cos(a), sin(a));
+        cairo_line_to(cr, -cos(a), -sin(a));
         cairo_stroke(cr);
-    }
+        // head and tail
+        for (auto s: {-1, 1}) {
+            cairo_move_to(cr, s * cos(a), s * sin(a));
+            cairo_rel_line_to(cr, s * cos(a + M_PI + DELTA_ANGLE_ARROW_HEAD) * LENGTH_ARROW_HEAD,
+                              s * sin(a + M_PI + DELTA_ANGLE_ARROW_HEAD) * LENGTH_ARROW_HEAD);
+            cairo_move_to(cr, s * cos(a), s * sin(a));
+            cairo_rel_line_to(cr, s * cos(a + M_PI - DELTA_ANGLE_ARROW_HEAD) * LENGTH_ARROW_HEAD,
+                              s * sin(a + M_PI - DELTA_ANGLE_ARROW_HEAD) * LENGTH_ARROW_HEAD);
+            cairo_stroke(cr);
+        }
 
-    cairo_destroy(cr);
-    GdkPixbuf* pixbuf = xoj_pixbuf_get_from_surface(crCursor, 0, 0, RESIZE_CURSOR_SIZE, RESIZE_CURSOR_SIZE);
-    cairo_surface_destroy(crCursor);
-    GdkCursor* cursor =
-            gdk_cursor_new_from_pixbuf(gtk_widget_get_display(control->getWindow()->getXournal()->getWidget()), pixbuf,
-                                       RESIZE_CURSOR_SIZE / 2, RESIZE_CURSOR_SIZE / 2);
-    g_object_unref(pixbuf);
-    return cursor;
+        cairo_destroy(cr);
+        GdkPixbuf* pixbuf = xoj_pixbuf_get_from_surface(crCursor, 0, 0, RESIZE_CURSOR_SIZE, RESIZE_CURSOR_SIZE);
+        cairo_surface_destroy(crCursor);
+        GdkCursor* cursor = gdk_cursor_new_from_pixbuf(
+                gtk_widget_get_display(control->getWindow()->getXournal()->getWidget()), pixbuf, RESIZE_CURSOR_SIZE / 2,
+                RESIZE_CURSOR_SIZE / 2);
+        g_object_unref(pixbuf);
+        return cursor;
+    });
 }
 
 auto XournalppCursor::getEraserCursor() -> GdkCursor* {
@@ -373,19 +428,21 @@ auto XournalppCursor::getEraserCursor() -> GdkCursor* {
     this->currentCursor = CRSR_ERASER;
     this->currentCursorFlavour = flavour;
 
-    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, cursorSize, cursorSize);
-    cairo_t* cr = cairo_create(surface);
-    cairo_rectangle(cr, 0, 0, cursorSize, cursorSize);
-    cairo_set_source_rgb(cr, 1, 1, 1);
-    cairo_fill(cr);
-    cairo_rectangle(cr, 0, 0, cursorSize, cursorSize);
-    cairo_set_source_rgb(cr, 0, 0, 0);
-    cairo_stroke(cr);
-    cairo_destroy(cr);
-    GdkCursor* cursor =
-            gdk_cursor_new_from_surface(gdk_display_get_default(), surface, cursorSize / 2.0, cursorSize / 2.0);
-    cairo_surface_destroy(surface);
-    return cursor;
+    return getCachedCursor(CRSR_ERASER, flavour, 0, [&]() {
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, cursorSize, cursorSize);
+        cairo_t* cr = cairo_create(surface);
+        cairo_rectangle(cr, 0, 0, cursorSize, cursorSize);
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_fill(cr);
+        cairo_rectangle(cr, 0, 0, cursorSize, cursorSize);
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        cairo_stroke(cr);
+        cairo_destroy(cr);
+        GdkCursor* cursor =
+                gdk_cursor_new_from_surface(gdk_display_get_default(), surface, cursorSize / 2.0, cursorSize / 2.0);
+        cairo_surface_destroy(surface);
+        return cursor;
+    });
 }
 
 
@@ -435,71 +492,75 @@ auto XournalppCursor::createHighlighterOrPenCursor(int size, double alpha) -> Gd
     this->currentCursor = cursor;
     this->currentCursorFlavour = flavour;
 
-    if ((cursorType == STYLUS_CURSOR_BIG) || bright) {
-        height = width = 90;
-    }
-
-    // We change the drawing method, now the center with the colored dot of the pen
-    // is at the center of the cairo surface, and when we load the cursor, we load it
-    // with the relative offset
-    int centerX = width / 2;
-    int centerY = height / 2;
-    cairo_surface_t* crCursor = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
-    cairo_t* cr = cairo_create(crCursor);
-
-    if (cursorType == STYLUS_CURSOR_BIG) {
-        // When using highlighter, paint the icon with the current color
-        if (size == 5) {
-            gdk_cairo_set_source_rgba(cr, &drgb);
-        } else {
-            cairo_set_source_rgb(cr, 1, 1, 1);
+    // The size of the dot is not in the flavour
+    double dotSize = control->getToolHandler()->getThickness() * control->getZoomControl()->getZoom();
+    return getCachedCursor(cursor, flavour, std::lround(64 * dotSize), [&]() {
+        if ((cursorType == STYLUS_CURSOR_BIG) || bright) {
+            height = width = 90;
         }
-        cairo_set_line_width(cr, 1.2);
-
-        // Starting point
-        cairo_move_to(cr, centerX + 2, centerY);
-        // Pencil cursor
-        cairo_line_to(cr, centerX + 2, centerY - 4);
-        cairo_line_to(cr, centerX + 15, centerY - 17.5);
-        cairo_line_to(cr, centerX + 19, centerY - 14);
-        cairo_line_to(cr, centerX + 6, centerY);
-
-        cairo_close_path(cr);
-        cairo_fill_preserve(cr);
-        cairo_set_source_rgb(cr, 0, 0, 0);
-        cairo_stroke(cr);
 
-        cairo_fill_preserve(cr);
-    }
+        // We change the drawing method, now the center with the colored dot of the pen
+        // is at the center of the cairo surface, and when we load the cursor, we load it
+        // with the relative offset
+        int centerX = width / 2;
+        int centerY = height / 2;
+        cairo_surface_t* crCursor = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+        cairo_t* cr = cairo_create(crCursor);
+
+        if (cursorType == STYLUS_CURSOR_BIG) {
+            // When using highlighter, paint the icon with the current color
+            if (size == 5) {
+                gdk_cairo_set_source_rgba(cr, &drgb);
+            } else {
+                cairo_set_source_rgb(cr, 1, 1, 1);
+            }
+            cairo_set_line_width(cr, 1.2);
+
+            // Starting point
+            cairo_move_to(cr, centerX + 2, centerY);
+            // Pencil cursor
+            cairo_line_to(cr, centerX + 2, centerY - 4);
+            cairo_line_to(cr, centerX + 15, centerY - 17.5);
+            cairo_line_to(cr, centerX + 19, centerY - 14);
+            cairo_line_to(cr, centerX + 6, centerY);
+
+            cairo_close_path(cr);
+            cairo_fill_preserve(cr);
+            cairo_set_source_rgb(cr, 0, 0, 0);
+            cairo_stroke(cr);
+
+            cairo_fill_preserve(cr);
+        }
 
-    if (bright) {
-        // Highlight cursor with a circle
-        auto&& color = Util::argb_to_GdkRGBA(control->getSettings()->getCursorHighlightColor());
-        gdk_cairo_set_source_rgba(cr, &color);
-        cairo_arc(cr, centerX, centerY, control->getSettings()->getCursorHighlightRadius(), 0, 2 * M_PI);
-        cairo_fill_preserve(cr);
-        auto&& borderColor = Util::argb_to_GdkRGBA(control->getSettings()->getCursorHighlightBorderColor());
-        gdk_cairo_set_source_rgba(cr, &borderColor);
-        cairo_set_line_width(cr, control->getSettings()->getCursorHighlightBorderWidth());
-        cairo_stroke(cr);
-    }
+        if (bright) {
+            // Highlight cursor with a circle
+            auto&& color = Util::argb_to_GdkRGBA(control->getSettings()->getCursorHighlightColor());
+            gdk_cairo_set_source_rgba(cr, &color);
+            cairo_arc(cr, centerX, centerY, control->getSettings()->getCursorHighlightRadius(), 0, 2 * M_PI);
+            cairo_fill_preserve(cr);
+            auto&& borderColor = Util::argb_to_GdkRGBA(control->getSettings()->getCursorHighlightBorderColor());
+            gdk_cairo_set_source_rgba(cr, &borderColor);
+            cairo_set_line_width(cr, control->getSettings()->getCursorHighlightBorderWidth());
+            cairo_stroke(cr);
+        }
 
-    if (cursorType != STYLUS_CURSOR_NONE) {
-        auto drgbCopy = drgb;
-        drgbCopy.alpha = alpha;
-        gdk_cairo_set_source_rgba(cr, &drgbCopy);
-        double cursorSize = control->getToolHandler()->getThickness() * control->getZoomControl()->getZoom();
-        cairo_arc(cr, centerX, centerY, cursorSize / 2., 0, 2. * M_PI);
-        cairo_fill(cr);
-    }
+        if (cursorType != STYLUS_CURSOR_NONE) {
+            auto drgbCopy = drgb;
+            drgbCopy.alpha = alpha;
+            gdk_cairo_set_source_rgba(cr, &drgbCopy);
+            double cursorSize = control->getToolHandler()->getThickness() * control->getZoomControl()->getZoom();
+            cairo_arc(cr, centerX, centerY, cursorSize / 2., 0, 2. * M_PI);
+            cairo_fill(cr);
+        }
 
-    cairo_destroy(cr);
-    GdkPixbuf* pixbuf = xoj_pixbuf_get_from_surface(crCursor, 0, 0, width, height);
-    cairo_surface_destroy(crCursor);
-    GdkCursor* gdkCursor = gdk_cursor_new_from_pixbuf(
-            gtk_widget_get_display(control->getWindow()->getXournal()->getWidget()), pixbuf, centerX, centerY);
-    g_object_unref(pixbuf);
-    return gdkCursor;
+        cairo_destroy(cr);
+        GdkPixbuf* pixbuf = xoj_pixbuf_get_from_surface(crCursor, 0, 0, width, height);
+        cairo_surface_destroy(crCursor);
+        GdkCursor* gdkCursor = gdk_cursor_new_from_pixbuf(
+                gtk_widget_get_display(control->getWindow()->getXournal()->getWidget()), pixbuf, centerX, centerY);
+        g_object_unref(pixbuf);
+        return gdkCursor;
+    });
 }
 
 
@@ -523,7 +584,9 @@ void XournalppCursor::setCursor(int cursorID) {
         return;
     }
 
-    GdkCursor* cursor = gdk_cursor_new_from_name(gdk_window_get_display(window), cssCursors[cursorID].cssName);
+    GdkCursor* cursor = getCachedCursor(static_cast<guint>(cursorID), 0, 0, [&]() {
+        return gdk_cursor_new_from_name(gdk_window_get_display(window), cssCursors[cursorID].cssName);
+    });
     if (cursor == nullptr)  // failed to get a cursor, try backup cursor.
     {
         if (cursorID != CRSR_nullptr) {
@@ -564,62 +627,64 @@ auto XournalppCursor::createCustomDrawDirCursor(int size, bool shift, bool ctrl)
     this->currentCursor = newCursorID;
     this->currentCursorFlavour = flavour;
 
-    int height = size;
-    int width = size;
-    int fontSize = 8;
-    if (big || bright) {
-        height = width = 60;
-        fontSize = 12;
-    }
-    int centerX = width - width / 4;
-    int centerY = height - height / 4;
-
-
-    cairo_surface_t* crCursor = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
-    cairo_t* cr = cairo_create(crCursor);
-    cairo_set_line_width(cr, 1.2);
-
-    // Starting point
-    cairo_move_to(cr, centerX, height / 2);
-    cairo_line_to(cr, centerX, height);
-    cairo_stroke(cr);
-
-    cairo_move_to(cr, width / 2, centerY);
-    cairo_line_to(cr, width, centerY);
-    cairo_stroke(cr);
-
-    if (ctrl) {
-        cairo_text_extents_t extents;
-        const char* utf8 = "CONTROL";
-        double x = NAN, y = NAN;
-        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
-        cairo_set_font_size(cr, fontSize);
-        cairo_text_extents(cr, utf8, &extents);
-        x = 0;
-        y = extents.height;
-        cairo_move_to(cr, x, y);
-        cairo_show_text(cr, utf8);
-    }
-
-    if (shift) {
-        cairo_text_extents_t extents;
-        const char* utf8 = "SHIFT";
-        double x = NAN, y = NAN;
-        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
-        cairo_set_font_size(cr, fontSize);
-        cairo_text_extents(cr, utf8, &extents);
-        x = 0;
-        y = extents.height * 2.5;
-        cairo_move_to(cr, x, y);
-        cairo_show_text(cr, utf8);
-    }
-
-    cairo_destroy(cr);
-    GdkPixbuf* pixbuf = xoj_pixbuf_get_from_surface(crCursor, 0, 0, width, height);
-    cairo_surface_destroy(crCursor);
-    GdkCursor* cursor = gdk_cursor_new_from_pixbuf(
-            gtk_widget_get_display(control->getWindow()->getXournal()->getWidget()), pixbuf, centerX, centerY);
-    g_object_unref(pixbuf);
+    return getCachedCursor(static_cast<guint>(newCursorID), flavour, 0, [&]() {
+        int height = size;
+        int width = size;
+        int fontSize = 8;
+        if (big || bright) {
+            height = width = 60;
+            fontSize = 12;
+        }
+        int centerX = width - width / 4;
+        int centerY = height - height / 4;
 
-    return cursor;
+
+        cairo_surface_t* crCursor = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+        cairo_t* cr = cairo_create(crCursor);
+        cairo_set_line_width(cr, 1.2);
+
+        // Starting point
+        cairo_move_to(cr, centerX, height / 2);
+        cairo_line_to(cr, centerX, height);
+        cairo_stroke(cr);
+
+        cairo_move_to(cr, width / 2, centerY);
+        cairo_line_to(cr, width, centerY);
+        cairo_stroke(cr);
+
+        if (ctrl) {
+            cairo_text_extents_t extents;
+            const char* utf8 = "CONTROL";
+            double x = NAN, y = NAN;
+            cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+            cairo_set_font_size(cr, fontSize);
+            cairo_text_extents(cr, utf8, &extents);
+            x = 0;
+            y = extents.height;
+            cairo_move_to(cr, x, y);
+            cairo_show_text(cr, utf8);
+        }
+
+        if (shift) {
+            cairo_text_extents_t extents;
+            const char* utf8 = "SHIFT";
+            double x = NAN, y = NAN;
+            cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+            cairo_set_font_size(cr, fontSize);
+            cairo_text_extents(cr, utf8, &extents);
+            x = 0;
+            y = extents.height * 2.5;
+            cairo_move_to(cr, x, y);
+            cairo_show_text(cr, utf8);
+        }
+
+        cairo_destroy(cr);
+        GdkPixbuf* pixbuf = xoj_pixbuf_get_from_surface(crCursor, 0, 0, width, height);
+        cairo_surface_destroy(crCursor);
+        GdkCursor* cursor = gdk_cursor_new_from_pixbuf(
+                gtk_widget_get_display(control->getWindow()->getXournal()->getWidget()), pixbuf, centerX, centerY);
+        g_object_unref(pixbuf);
+
+        return cursor;
+    });
 }
@@ -11,7 +11,12 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <gtk/gtk.h>
@@ -35,11 +40,18 @@ public:
     void setMouseDown(bool mouseDown);
     void setInvisible(bool invisible);
     void setInsidePage(bool insidePage);
+    /// Over a link of the PDF background, which the hand and the PDF text tools follow
+    void setOverPdfLink(bool overPdfLink);
     void activateDrawDirCursor(bool enable, bool shift = false, bool ctrl = false);
     void setInputDeviceClass(InputDeviceClass inputDevice);
     void setRotationAngle(double angle);
     void setMirror(bool mirror);
 
+    /**
+     * Drop the cached cursors, e.g. when the settings they are drawn with changed
+     */
+    void clearCache();
+
 private:
     void setCursor(int id);
 
@@ -52,12 +64,27 @@ private:
     GdkCursor* createHighlighterOrPenCursor(int size, double alpha);
     GdkCursor* createCustomDrawDirCursor(int size, bool shift, bool ctrl);
 
+    /**
+     * @brief The cursors created already, by their id, their flavour, the size of custom cursor's dot and the scale
+     * of the widget
+     *
+     * Hovering over the handles of a selection switches between the same few cursors, and so does switching the tools:
+     * they are drawn and created once. The least recently used cursor is dropped beyond MAX_CACHED_CURSORS.
+     *
+     * @param create Creates the cursor if it is not cached
+     * @return A new reference to the cursor, nullptr if it could not be created
+     */
+    GdkCursor* getCachedCursor(guint id, gulong flavour, long size, const std::function<GdkCursor*()>& create);
+
+    static constexpr size_t MAX_CACHED_CURSORS = 64;
+
 private:
     InputDeviceClass inputDevice = INPUT_DEVICE_MOUSE;
 
     Control* control = nullptr;
     bool busy = false;
     bool insidePage = false;
+    bool overPdfLink = false;
     CursorSelectionType selectionType = CURSOR_SELECTION_NONE;
 
     bool mouseDown = false;
@@ -76,4 +103,11 @@ private:
     // for resizing rotated/mirrored selections
     double angle = 0;
     bool mirror = false;
+
+    struct CachedCursor {
+        GdkCursor* cursor;
+        uint64_t lastUse;
+    };
+    std::map<std::tuple<guint, gulong, long, int>, CachedCursor> cursorCache;
+    uint64_t cacheUses = 0;
 };
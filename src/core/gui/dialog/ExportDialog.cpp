@@ -56,6 +56,9 @@ ExportDialog::ExportDialog(GladeSearchpath* gladeSearchPath):
     });
 
     gtk_widget_hide(get("cbProgressiveMode"));
+    gtk_widget_hide(get("cbSimplifyStrokes"));
+    gtk_widget_hide(get("lbCompression"));
+    gtk_widget_hide(get("sbCompression"));
     g_signal_connect(get("rdRangePages"), "toggled", toggledHandler, this);
     g_signal_connect(get("cbQuality"), "changed", G_CALLBACK(ExportDialog::selectQualityCriterion), this);
     GSList* radios = gtk_radio_button_get_group(GTK_RADIO_BUTTON(get("rdRangeAll")));
@@ -116,6 +119,22 @@ auto ExportDialog::getPngQualityParameter() -> RasterImageQualityParameter {
 
 auto ExportDialog::isConfirmed() const -> bool { return this->confirmed; }
 
+void ExportDialog::showStrokeSimplification() { gtk_widget_show(get("cbSimplifyStrokes")); }
+
+auto ExportDialog::simplifyStrokes() -> bool {
+    return gtk_widget_get_visible(get("cbSimplifyStrokes")) &&
+           gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(get("cbSimplifyStrokes")));
+}
+
+void ExportDialog::showCompressionQuality() {
+    gtk_widget_show(get("lbCompression"));
+    gtk_widget_show(get("sbCompression"));
+}
+
+auto ExportDialog::getCompressionQuality() -> int {
+    return gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(get("sbCompression")));
+}
+
 auto ExportDialog::progressiveMode() -> bool {
     return gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(get("cbProgressiveMode")));
 }
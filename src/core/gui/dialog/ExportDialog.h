@@ -49,6 +49,22 @@ public:
      */
     void showProgressiveMode();
 
+    /**
+     * @brief Show the "simplify strokes" checkbox of the SVG export
+     */
+    void showStrokeSimplification();
+    bool simplifyStrokes();
+
+    /**
+     * @brief Show the compression quality of the JPEG and WebP exports
+     */
+    void showCompressionQuality();
+
+    /**
+     * @return The compression quality, from 1 to 100
+     */
+    int getCompressionQuality();
+
     /**
      * @brief Handler for changes in combobox cbQuality
      */
@@ -0,0 +1,34 @@
+#include "MemoryDialog.h"
+
+#include <string>
+
+#include "control/Control.h"
+#include "control/MemoryReport.h"
+
+/**
+ * Response of the "Refresh" button, see memory.glade
+ */
+constexpr int RESPONSE_REFRESH = 1;
+
+MemoryDialog::MemoryDialog(GladeSearchpath* gladeSearchPath, Control* control):
+        GladeGui(gladeSearchPath, "memory.glade", "memoryDialog"), control(control) {}
+
+MemoryDialog::~MemoryDialog() = default;
+
+void MemoryDialog::updateReport() {
+    MemoryReport report(this->control->getDocument());
+    report.addControl(this->control);
+    std::string text = report.toString(true);
+
+    GtkTextBuffer* buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(get("txtReport")));
+    gtk_text_buffer_set_text(buffer, text.c_str(), -1);
+}
+
+void MemoryDialog::show(GtkWindow* parent) {
+    gtk_window_set_transient_for(GTK_WINDOW(this->window), parent);
+
+    do {
+        updateReport();
+    } while (gtk_dialog_run(GTK_DIALOG(this->window)) == RESPONSE_REFRESH);
+    gtk_widget_hide(this->window);
+}
@@ -0,0 +1,34 @@
+/*
+ * Xournal++
+ *
+ * Shows where the memory of the document goes
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "gui/GladeGui.h"
+
+class Control;
+
+/**
+ * @brief The "Document Statistics" dialog: the MemoryReport of the document, measured again on "Refresh"
+ */
+class MemoryDialog: public GladeGui {
+public:
+    MemoryDialog(GladeSearchpath* gladeSearchPath, Control* control);
+    ~MemoryDialog() override;
+
+public:
+    void show(GtkWindow* parent) override;
+
+private:
+    void updateReport();
+
+private:
+    Control* control;
+};
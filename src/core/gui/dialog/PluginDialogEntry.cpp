@@ -1,5 +1,9 @@
 #include "PluginDialogEntry.h"
 
+#include <cmath>
+#include <cstdint>
+#include <string>
+
 #include "plugin/Plugin.h"
 #include "util/i18n.h"
 
@@ -23,6 +27,19 @@ void PluginDialogEntry::loadSettings() {
     gtk_label_set_text(GTK_LABEL(get("lbDefaultText")),
                        plugin->isDefaultEnabled() ? _("default enabled") : _("default disabled"));
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(get("cbEnabled")), plugin->isEnabled());
+
+    auto const& timings = plugin->getTimings();
+    std::string timingText = _("not loaded");
+    if (plugin->isEnabled() && plugin->isValid()) {
+        timingText = FS(_F("startup {1} ms, {2} callbacks, slowest {3} ms") %
+                        std::lround(timings.loadMs + timings.initMs) % static_cast<int64_t>(timings.callbacks) %
+                        std::lround(timings.callbackMaxMs));
+        if (timings.asyncCalls > 0) {
+            timingText += FS(_F(", {1} on workers in {2} ms") % static_cast<int64_t>(timings.asyncCalls) %
+                             std::lround(timings.asyncTotalMs));
+        }
+    }
+    gtk_label_set_text(GTK_LABEL(get("lbTimings")), timingText.c_str());
 #endif
 }
 
@@ -349,6 +349,7 @@ void SettingsDialog::load() {
     loadCheckbox("cbDoActionOnStrokeFiltered", settings->getDoActionOnStrokeFiltered());
     loadCheckbox("cbTrySelectOnStrokeFiltered", settings->getTrySelectOnStrokeFiltered());
     loadCheckbox("cbSnapRecognizedShapesEnabled", settings->getSnapRecognizedShapesEnabled());
+    loadCheckbox("cbSnapStrokeEndpointsEnabled", settings->getSnapStrokeEndpointsEnabled());
     loadCheckbox("cbRestoreLineWidthEnabled", settings->getRestoreLineWidthEnabled());
     loadCheckbox("cbDarkTheme", settings->isDarkTheme());
     loadCheckbox("cbStockIcons", settings->areStockIconsUsed());
@@ -560,6 +561,9 @@ void SettingsDialog::load() {
     bool disablePen = false;
     touch.getBool("disableTouch", disablePen);
     loadCheckbox("cbDisableTouchOnPenNear", disablePen);
+    bool palmRejection = false;
+    touch.getBool("palmRejection", palmRejection);
+    loadCheckbox("cbPalmRejection", palmRejection);
 
     string disableMethod;
     touch.getString("method", disableMethod);
@@ -692,6 +696,7 @@ void SettingsDialog::save() {
     settings->setDoActionOnStrokeFiltered(getCheckbox("cbDoActionOnStrokeFiltered"));
     settings->setTrySelectOnStrokeFiltered(getCheckbox("cbTrySelectOnStrokeFiltered"));
     settings->setSnapRecognizedShapesEnabled(getCheckbox("cbSnapRecognizedShapesEnabled"));
+    settings->setSnapStrokeEndpointsEnabled(getCheckbox("cbSnapStrokeEndpointsEnabled"));
     settings->setRestoreLineWidthEnabled(getCheckbox("cbRestoreLineWidthEnabled"));
     settings->setDarkTheme(getCheckbox("cbDarkTheme"));
     settings->setAreStockIconsUsed(getCheckbox("cbStockIcons"));
@@ -869,6 +874,7 @@ void SettingsDialog::save() {
 
     SElement& touch = settings->getCustomElement("touch");
     touch.setBool("disableTouch", getCheckbox("cbDisableTouchOnPenNear"));
+    touch.setBool("palmRejection", getCheckbox("cbPalmRejection"));
     int touchMethod = gtk_combo_box_get_active(GTK_COMBO_BOX(get("cbTouchDisableMethod")));
 
     switch (touchMethod) {
@@ -46,6 +46,11 @@ public:
 
     void block(bool block);
     bool isBlocked() const;
+
+    /**
+     * @return Whether a press of the device was handled and not released yet, e.g. a stroke being drawn
+     */
+    bool isInputRunning() const;
     virtual void onBlock();
     virtual void onUnblock();
     bool handle(InputEvent const& event);
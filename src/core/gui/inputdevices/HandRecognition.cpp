@@ -1,5 +1,7 @@
 #include "HandRecognition.h"
 
+#include <algorithm>
+
 #include "control/settings/Settings.h"
 #include "gtk/gtk.h"
 #include "gui/inputdevices/touchdisable/TouchDisableCustom.h"
@@ -38,6 +40,15 @@ HandRecognition::~HandRecognition() {
 void HandRecognition::reload() {
     SElement& touch = settings->getCustomElement("touch");
 
+    bool palmRejection = false;
+    touch.getBool("palmRejection", palmRejection);
+    int palmTimeout = 500;
+    touch.getInt("palmRejectionTimeout", palmTimeout);
+    double maxContactSize = 0;
+    touch.getDouble("palmRejectionContactSize", maxContactSize);
+    inputContext->getPalmRejectionFilter()->configure(palmRejection, static_cast<guint32>(std::max(palmTimeout, 0)),
+                                                      maxContactSize);
+
     enabled = false;
     touch.getBool("disableTouch", enabled);
 
@@ -5,6 +5,9 @@
 #include "InputContext.h"
 
 #include "control/DeviceListHelper.h"
+#include "gui/RepaintHandler.h"
+#include "gui/XournalppCursor.h"
+#include "util/Profiler.h"
 
 #include "InputEvents.h"
 #include "SetsquareInputHandler.h"
@@ -28,6 +31,9 @@ InputContext::InputContext(XournalView* view, ScrollHandling* scrollHandling) {
 InputContext::~InputContext() {
     // Destructor is called in xournal_widget_dispose, so it can still accept events
     g_signal_handler_disconnect(this->widget, signal_id);
+    if (this->tickCallbackId) {
+        gtk_widget_remove_tick_callback(this->widget, this->tickCallbackId);
+    }
 
     delete this->stylusHandler;
     this->stylusHandler = nullptr;
@@ -80,6 +86,9 @@ auto InputContext::handle(GdkEvent* sourceEvent) -> bool {
     }
 
     InputEvent event = InputEvents::translateEvent(sourceEvent, this->getSettings());
+    if (xoj::util::Profiler::getInstance().isEnabled()) {
+        this->metrics.record(event, g_get_monotonic_time());
+    }
 
     // Add the device to the list of known devices if it is currently unknown
     GdkInputSource inputSource = gdk_device_get_source(sourceDevice);
@@ -94,18 +103,110 @@ auto InputContext::handle(GdkEvent* sourceEvent) -> bool {
         this->getSettings()->transactionEnd();
     }
 
+    return handleEvent(std::move(event));
+}
+
+auto InputContext::handleEvent(InputEvent event) -> bool {
+    if (this->recorder) {
+        this->recorder->record(event);
+    }
+
     // We do not handle scroll events manually but let GTK do it for us
     if (event.type == SCROLL_EVENT) {
         // Hand over to standard GTK Scroll / Zoom handling
         return false;
     }
 
+    // The touches of the palm are consumed here, before any handler, so that GTK does not scroll either
+    if (!this->palmRejection.accept(event)) {
+        return true;
+    }
+
     // Deactivate touchscreen when a pen event occurs
     this->getView()->getHandRecognition()->event(event.deviceClass);
 
     // Get the state of all modifiers
     this->modifierState = event.state;
 
+    // The stylus can send several motion events per frame: they are all kept, for the stroke, but dispatched at the
+    // start of the next frame, which draws them at once
+    if (canDefer(event)) {
+        this->pendingMotionEvents.push_back(std::move(event));
+        if (!this->tickCallbackId) {
+            this->tickCallbackId = gtk_widget_add_tick_callback(
+                    this->widget, reinterpret_cast<GtkTickCallback>(tickCallback), this, nullptr);
+        }
+        return true;
+    }
+
+    // Any other event comes after the pending ones
+    flushMotionEvents();
+
+    return dispatch(event);
+}
+
+auto InputContext::canDefer(InputEvent const& event) -> bool {
+    return event.type == MOTION_EVENT &&
+           (event.deviceClass == INPUT_DEVICE_PEN || event.deviceClass == INPUT_DEVICE_ERASER) &&
+           this->stylusHandler->isDeviceClassPressed() && !this->stylusHandler->isBlocked();
+}
+
+auto InputContext::tickCallback(GtkWidget* widget, GdkFrameClock* clock, InputContext* self) -> gboolean {
+    self->tickCallbackId = 0;
+    self->flushMotionEvents();
+    return G_SOURCE_REMOVE;
+}
+
+void InputContext::flushMotionEvents() {
+    if (this->pendingMotionEvents.empty()) {
+        return;
+    }
+
+    // The handlers may queue events while dispatching
+    std::vector<InputEvent> events;
+    std::swap(events, this->pendingMotionEvents);
+
+    RepaintHandler* repaintHandler = this->view->getRepaintHandler();
+    repaintHandler->beginBatch();
+    this->flushingMotionEvents = true;
+    for (InputEvent const& event: events) {
+        dispatch(event);
+    }
+    this->flushingMotionEvents = false;
+    repaintHandler->endBatch();
+
+    XournalppCursor* cursor = this->view->getCursor();
+    cursor->setInvisible(false);
+    cursor->updateCursor();
+}
+
+auto InputContext::isFlushingMotionEvents() const -> bool { return this->flushingMotionEvents; }
+
+auto InputContext::isInputRunning() const -> bool {
+    return this->stylusHandler->isInputRunning() || this->mouseHandler->isInputRunning() ||
+           this->touchDrawingHandler->isInputRunning();
+}
+
+auto InputContext::startRecording(const fs::path& file) -> bool {
+    this->recorder = std::make_unique<InputRecorder>(file);
+    if (!this->recorder->isOpen()) {
+        this->recorder.reset();
+        return false;
+    }
+    return true;
+}
+
+void InputContext::stopRecording() { this->recorder.reset(); }
+
+void InputContext::startReplay(const fs::path& file, std::function<void()> finished) {
+    // Kept after the end, until the next replay
+    this->replay = std::make_unique<InputReplay>(this, file);
+    this->replay->start(std::move(finished));
+}
+
+auto InputContext::dispatch(InputEvent const& event) -> bool {
+    xoj::util::Profiler::Scope scope("input event", "input");
+
     // separate events to appropriate handlers
     // handle setsquare
     if (this->setsquareHandler->handle(event)) {
@@ -165,6 +266,10 @@ auto InputContext::getScrollHandling() -> ScrollHandling* { return this->scrollH
 
 auto InputContext::getModifierState() -> GdkModifierType { return this->modifierState; }
 
+auto InputContext::getPalmRejectionFilter() -> PalmRejectionFilter* { return &this->palmRejection; }
+
+auto InputContext::getInputMetrics() -> InputMetrics& { return this->metrics; }
+
 /**
  * Focus the widget
  */
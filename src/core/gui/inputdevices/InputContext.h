@@ -12,6 +12,7 @@
 #pragma once
 
 
+#include <functional>
 #include <memory>
 #include <set>
 #include <string>
@@ -28,12 +29,16 @@
 
 #include "AbstractInputHandler.h"
 #include "HandRecognition.h"
+#include "InputMetrics.h"
+#include "InputRecording.h"
 #include "KeyboardInputHandler.h"
 #include "MouseInputHandler.h"
+#include "PalmRejectionFilter.h"
 #include "StylusInputHandler.h"
 #include "TouchDrawingInputHandler.h"
 #include "TouchInputHandler.h"
 #include "config-debug.h"
+#include "filesystem.h"
 
 class SetsquareInputHandler;
 
@@ -56,6 +61,23 @@ private:
 
     std::set<std::string> knownDevices;
 
+    PalmRejectionFilter palmRejection;
+
+    /**
+     * Filled while the profiler is enabled
+     */
+    InputMetrics metrics;
+
+    /**
+     * Motion events of the pressed stylus, dispatched once per frame by the tick callback
+     */
+    std::vector<InputEvent> pendingMotionEvents;
+    guint tickCallbackId{0};
+    bool flushingMotionEvents = false;
+
+    std::unique_ptr<InputRecorder> recorder;
+    std::unique_ptr<InputReplay> replay;
+
 public:
     enum DeviceType {
         MOUSE,
@@ -84,6 +106,32 @@ private:
      */
     bool handle(GdkEvent* event);
 
+public:
+    /**
+     * Handle a translated event, e.g. of a replay
+     * @return Whether the event was handled
+     */
+    bool handleEvent(InputEvent event);
+
+private:
+    /**
+     * Send the event to the handler of its device
+     * @return Whether the event was handled
+     */
+    bool dispatch(InputEvent const& event);
+
+    /**
+     * @return Whether the event is a motion of the pressed stylus, which can wait for the next frame
+     */
+    bool canDefer(InputEvent const& event);
+
+    /**
+     * Dispatch the pending motion events, with a single repaint
+     */
+    void flushMotionEvents();
+
+    static gboolean tickCallback(GtkWidget* widget, GdkFrameClock* clock, InputContext* self);
+
     /**
      * Print debug output
      */
@@ -106,4 +154,38 @@ public:
     void blockDevice(DeviceType deviceType);
     void unblockDevice(DeviceType deviceType);
     bool isBlocked(DeviceType deviceType);
+
+    /**
+     * @return The filter dropping the touches of the palm before any handler, configured by HandRecognition::reload()
+     */
+    PalmRejectionFilter* getPalmRejectionFilter();
+
+    /**
+     * @return The rate, jitter and delay of the events received from the devices while the profiler is enabled
+     */
+    InputMetrics& getInputMetrics();
+
+    /**
+     * @return Whether the pending motion events are being dispatched. The cursor is updated once they all are.
+     */
+    bool isFlushingMotionEvents() const;
+
+    /**
+     * @return Whether the stylus, the mouse or a touch is drawing, erasing or dragging on the pages
+     */
+    bool isInputRunning() const;
+
+    /**
+     * Record the handled events to the file, see InputRecorder
+     * @return false if the file could not be opened
+     */
+    bool startRecording(const fs::path& file);
+    void stopRecording();
+
+    /**
+     * Replay the events of a recording, see InputReplay
+     * @param finished Called once all the events are handled
+     * @throws std::runtime_error if the file is not a recording
+     */
+    void startReplay(const fs::path& file, std::function<void()> finished);
 };
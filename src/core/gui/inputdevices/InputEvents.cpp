@@ -116,6 +116,7 @@ auto InputEvents::translateEvent(GdkEvent* sourceEvent, Settings* settings) -> I
     if (sourceEventType == GDK_TOUCH_BEGIN || sourceEventType == GDK_TOUCH_UPDATE || sourceEventType == GDK_TOUCH_END ||
         sourceEventType == GDK_TOUCH_CANCEL) {
         targetEvent.sequence = gdk_event_get_event_sequence(sourceEvent);
+        targetEvent.contactSize = targetEvent.pressure;
         targetEvent.pressure = Point::NO_PRESSURE;
     }
 
@@ -84,6 +84,12 @@ struct InputEvent final {
     GdkModifierType state{};
     gdouble pressure{Point::NO_PRESSURE};
 
+    /**
+     * The pressure axis of a touch, which the touchscreen drivers reporting it derive from the contact area, else
+     * Point::NO_PRESSURE. See PalmRejectionFilter.
+     */
+    gdouble contactSize{Point::NO_PRESSURE};
+
     GdkEventSequence* sequence{};
     guint32 timestamp{0};
 };
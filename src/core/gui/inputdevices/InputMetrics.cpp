@@ -0,0 +1,146 @@
+#include "InputMetrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+void InputMetrics::Histogram::add(int64_t us) {
+    size_t bucket = 0;
+    while (bucket + 1 < BUCKET_COUNT && getBucketLimitUs(bucket) <= us) { bucket++; }
+    this->buckets[bucket]++;
+    this->count++;
+    this->maxUs = std::max(this->maxUs, us);
+}
+
+auto InputMetrics::Histogram::getPercentileUs(double fraction) const -> int64_t {
+    if (this->count == 0) {
+        return 0;
+    }
+    auto rank = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(this->count)));
+    rank = std::clamp<uint64_t>(rank, 1, this->count);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += this->buckets[i];
+        if (seen >= rank) {
+            return std::min(getBucketLimitUs(i), this->maxUs);
+        }
+    }
+    return this->maxUs;
+}
+
+auto InputMetrics::Histogram::getBucketLimitUs(size_t bucket) -> int64_t { return int64_t{2} << bucket; }
+
+auto InputMetrics::Statistics::getRate() const -> double {
+    return this->intervalMeanUs > 0 ? 1e6 / this->intervalMeanUs : 0.0;
+}
+
+auto InputMetrics::Statistics::getJitterMs() const -> double {
+    if (this->intervals.count < 2) {
+        return 0;
+    }
+    return std::sqrt(this->intervalM2 / static_cast<double>(this->intervals.count - 1)) / 1000.0;
+}
+
+void InputMetrics::record(InputEvent const& event, int64_t receivedUs) {
+    Source source = getSource(event.deviceClass);
+    if (source == SOURCE_COUNT || event.type == UNKNOWN || event.type == KEY_PRESS_EVENT ||
+        event.type == KEY_RELEASE_EVENT) {
+        return;
+    }
+
+    Statistics& stats = this->statistics[source];
+    stats.events++;
+
+    // The timestamps of GDK are 32 bit milliseconds: compare them modulo 2^32
+    auto receivedMs = static_cast<uint32_t>(receivedUs / 1000);
+    auto delayUs = static_cast<int64_t>(static_cast<int32_t>(receivedMs - event.timestamp)) * 1000;
+    if (event.timestamp != 0 && delayUs >= 0 && delayUs <= MAX_DELAY_US) {
+        stats.delays.add(delayUs);
+    }
+
+    if (event.type != MOTION_EVENT) {
+        return;
+    }
+    int64_t intervalUs = receivedUs - stats.lastMotionUs;
+    if (stats.lastMotionUs != 0 && intervalUs >= 0 && intervalUs <= MAX_INTERVAL_US) {
+        stats.intervals.add(intervalUs);
+        double deviation = static_cast<double>(intervalUs) - stats.intervalMeanUs;
+        stats.intervalMeanUs += deviation / static_cast<double>(stats.intervals.count);
+        stats.intervalM2 += deviation * (static_cast<double>(intervalUs) - stats.intervalMeanUs);
+    }
+    stats.lastMotionUs = receivedUs;
+}
+
+auto InputMetrics::get(Source source) const -> const Statistics& { return this->statistics[source]; }
+
+auto InputMetrics::getSummary() const -> std::vector<std::string> {
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < SOURCE_COUNT; i++) {
+        const Statistics& stats = this->statistics[i];
+        if (stats.events == 0) {
+            continue;
+        }
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1) << "input " << getName(static_cast<Source>(i)) << ": "
+             << stats.getRate() << " Hz, jitter " << std::setprecision(2) << stats.getJitterMs() << " ms, delay p50 "
+             << static_cast<double>(stats.delays.getPercentileUs(0.5)) / 1000.0 << ", p95 "
+             << static_cast<double>(stats.delays.getPercentileUs(0.95)) / 1000.0 << ", max "
+             << static_cast<double>(stats.delays.maxUs) / 1000.0 << " ms (" << stats.events << ")";
+        lines.push_back(line.str());
+    }
+    return lines;
+}
+
+void InputMetrics::writeCsv(std::ostream& out) const {
+    out << "device,measure,value\n";
+    out << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < SOURCE_COUNT; i++) {
+        const Statistics& stats = this->statistics[i];
+        const char* name = getName(static_cast<Source>(i));
+        out << name << ",events," << stats.events << "\n";
+        out << name << ",rate hz," << stats.getRate() << "\n";
+        out << name << ",interval mean ms," << stats.intervalMeanUs / 1000.0 << "\n";
+        out << name << ",jitter ms," << stats.getJitterMs() << "\n";
+        out << name << ",delay max ms," << static_cast<double>(stats.delays.maxUs) / 1000.0 << "\n";
+        for (auto [histogram, measure]: {std::pair{&stats.intervals, "interval"}, std::pair{&stats.delays, "delay"}}) {
+            for (size_t b = 0; b < BUCKET_COUNT; b++) {
+                if (histogram->buckets[b]) {
+                    out << name << "," << measure << " < " << Histogram::getBucketLimitUs(b) << " us,"
+                        << histogram->buckets[b] << "\n";
+                }
+            }
+        }
+    }
+}
+
+void InputMetrics::reset() { this->statistics = {}; }
+
+auto InputMetrics::getName(Source source) -> const char* {
+    switch (source) {
+        case PEN:
+            return "pen";
+        case TOUCH:
+            return "touch";
+        case MOUSE:
+            return "mouse";
+        default:
+            return "other";
+    }
+}
+
+auto InputMetrics::getSource(InputDeviceClass deviceClass) -> Source {
+    switch (deviceClass) {
+        case INPUT_DEVICE_PEN:
+        case INPUT_DEVICE_ERASER:
+            return PEN;
+        case INPUT_DEVICE_TOUCHSCREEN:
+            return TOUCH;
+        case INPUT_DEVICE_MOUSE:
+        case INPUT_DEVICE_MOUSE_KEYBOARD_COMBO:
+            return MOUSE;
+        default:
+            return SOURCE_COUNT;
+    }
+}
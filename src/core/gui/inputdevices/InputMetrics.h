@@ -0,0 +1,125 @@
+/*
+ * Xournal++
+ *
+ * Rate, jitter and delay of the input events
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "InputEvents.h"
+
+/**
+ * @brief Statistics of the events received by InputContext, per kind of device, while the profiler is enabled
+ *
+ * Two durations are measured for the events of the pen, the touchscreen and the mouse:
+ *  - the interval between two motion events of the same kind of device, from their reception in microseconds: their
+ *    rate and jitter (standard deviation) describe the sampling as seen by the application. An interval longer than
+ *    MAX_INTERVAL_US is a pause (e.g. the pen was lifted), which is not counted.
+ *  - the delay from the timestamp of the event to its reception, i.e. the time spent in the driver, the compositor and
+ *    the queue of GDK. The timestamps of GDK only have a precision of a millisecond, and are taken from the monotonic
+ *    clock: the delays which are negative or longer than MAX_DELAY_US come from another clock and are not counted.
+ *
+ * Both are also kept in histograms of power of two buckets, for the percentiles. The statistics are shown by the
+ * profiler overlay (see XournalView::paintProfilerOverlay()) and written with the measurements of --profile.
+ */
+class InputMetrics {
+public:
+    enum Source { PEN, TOUCH, MOUSE, SOURCE_COUNT };
+
+    /**
+     * The number of buckets of a histogram, the last one goes to about 16 seconds
+     */
+    static constexpr size_t BUCKET_COUNT = 24;
+
+    struct Histogram {
+        /**
+         * The bucket i counts the durations from 2^i to 2^(i+1) microseconds, the first one also counts the shorter
+         * ones and the last one the longer ones
+         */
+        std::array<uint64_t, BUCKET_COUNT> buckets{};
+        uint64_t count = 0;
+        int64_t maxUs = 0;
+
+        void add(int64_t us);
+
+        /**
+         * @param fraction in [0, 1], e.g. 0.95
+         * @return The upper bound of the bucket of the percentile, in microseconds, 0 if the histogram is empty
+         */
+        int64_t getPercentileUs(double fraction) const;
+
+        /**
+         * @return The upper bound of the bucket, in microseconds
+         */
+        static int64_t getBucketLimitUs(size_t bucket);
+    };
+
+    struct Statistics {
+        uint64_t events = 0;
+        Histogram intervals;
+        Histogram delays;
+
+        /// Running mean and sum of the squared deviations of the intervals, in microseconds (Welford)
+        double intervalMeanUs = 0;
+        double intervalM2 = 0;
+
+        /// The reception of the last motion event, 0 before the first one
+        int64_t lastMotionUs = 0;
+
+        /**
+         * @return The number of motion events per second during the movements, 0 without measurements
+         */
+        double getRate() const;
+
+        /**
+         * @return The standard deviation of the intervals, in milliseconds
+         */
+        double getJitterMs() const;
+    };
+
+public:
+    /**
+     * @param event A translated event, before it is dispatched
+     * @param receivedUs The time of its reception, from g_get_monotonic_time()
+     */
+    void record(InputEvent const& event, int64_t receivedUs);
+
+    const Statistics& get(Source source) const;
+
+    /**
+     * @return One line per kind of device which sent events, for the overlay
+     */
+    std::vector<std::string> getSummary() const;
+
+    /**
+     * @brief Writes the statistics and the non empty buckets of the histograms as a CSV table
+     */
+    void writeCsv(std::ostream& out) const;
+
+    void reset();
+
+    static const char* getName(Source source);
+
+    /**
+     * @return The kind of the device, SOURCE_COUNT for the keyboard and the ignored devices
+     */
+    static Source getSource(InputDeviceClass deviceClass);
+
+    static constexpr int64_t MAX_INTERVAL_US = 100000;
+    static constexpr int64_t MAX_DELAY_US = 10000000;
+
+private:
+    std::array<Statistics, SOURCE_COUNT> statistics{};
+};
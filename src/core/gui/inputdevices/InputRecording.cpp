@@ -0,0 +1,244 @@
+#include "InputRecording.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "util/Profiler.h"
+#include "util/StringUtils.h"
+#include "util/serdesstream.h"
+
+#include "InputContext.h"
+
+using Clock = std::chrono::steady_clock;
+
+void RecordedInputEvent::write(std::ostream& out) const {
+    out << timeUs << '\t' << type << '\t' << deviceClass << '\t' << deviceName << '\t' << absoluteX << '\t' << absoluteY
+        << '\t' << relativeX << '\t' << relativeY << '\t' << button << '\t' << state << '\t' << pressure << '\t'
+        << sequence << '\n';
+}
+
+auto RecordedInputEvent::read(const std::string& line) -> bool {
+    std::vector<std::string> fields = StringUtils::split(line, '\t');
+    if (fields.size() != 12) {
+        return false;
+    }
+
+    // All but the device name are numbers
+    std::string numbers;
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (i != 3) {
+            numbers += fields[i] + ' ';
+        }
+    }
+    auto in = serdes_stream<std::istringstream>(numbers);
+    int eventType = 0;
+    int eventDeviceClass = 0;
+    in >> timeUs >> eventType >> eventDeviceClass >> absoluteX >> absoluteY >> relativeX >> relativeY >> button >>
+            state >> pressure >> sequence;
+    if (in.fail() || eventType < UNKNOWN || eventType > KEY_RELEASE_EVENT || eventDeviceClass < INPUT_DEVICE_MOUSE ||
+        eventDeviceClass > INPUT_DEVICE_IGNORE) {
+        return false;
+    }
+    type = static_cast<InputEventType>(eventType);
+    deviceClass = static_cast<InputDeviceClass>(eventDeviceClass);
+    deviceName = fields[3];
+    return true;
+}
+
+InputRecorder::InputRecorder(const fs::path& file): out(file) {
+    this->out.imbue(std::locale::classic());
+    this->out.precision(10);
+    this->out << HEADER << '\n';
+}
+
+auto InputRecorder::isOpen() const -> bool { return this->out.good(); }
+
+void InputRecorder::record(const InputEvent& event) {
+    if (event.type == SCROLL_EVENT || event.type == KEY_PRESS_EVENT || event.type == KEY_RELEASE_EVENT ||
+        event.type == UNKNOWN) {
+        return;
+    }
+
+    auto now = Clock::now();
+    if (this->start == Clock::time_point{}) {
+        this->start = now;
+    }
+
+    RecordedInputEvent recorded;
+    recorded.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(now - this->start).count();
+    recorded.type = event.type;
+    recorded.deviceClass = event.deviceClass;
+    recorded.deviceName = event.deviceName ? event.deviceName : "";
+    // The fields are tab separated
+    std::replace(recorded.deviceName.begin(), recorded.deviceName.end(), '\t', ' ');
+    recorded.absoluteX = event.absoluteX;
+    recorded.absoluteY = event.absoluteY;
+    recorded.relativeX = event.relativeX;
+    recorded.relativeY = event.relativeY;
+    recorded.button = event.button;
+    recorded.state = event.state;
+    recorded.pressure = event.pressure;
+    if (event.sequence) {
+        auto it = this->sequences.emplace(event.sequence, static_cast<int>(this->sequences.size()) + 1).first;
+        recorded.sequence = it->second;
+    }
+
+    recorded.write(this->out);
+    // Motion events are frequent: the file is flushed on the presses and releases only
+    if (event.type != MOTION_EVENT) {
+        this->out.flush();
+    }
+}
+
+InputReplay::InputReplay(InputContext* context, const fs::path& file): context(context) {
+    std::ifstream in(file);
+    if (!in) {
+        throw std::runtime_error("Could not open the input recording " + file.u8string());
+    }
+    this->events = read(in);
+}
+
+InputReplay::~InputReplay() {
+    if (this->timeout) {
+        g_source_remove(this->timeout);
+    }
+}
+
+auto InputReplay::read(std::istream& in) -> std::vector<RecordedInputEvent> {
+    std::string line;
+    if (!std::getline(in, line) || line != InputRecorder::HEADER) {
+        throw std::runtime_error("Not an input recording");
+    }
+
+    std::vector<RecordedInputEvent> events;
+    for (size_t lineNr = 2; std::getline(in, line); lineNr++) {
+        if (line.empty()) {
+            continue;
+        }
+        RecordedInputEvent event;
+        if (!event.read(line)) {
+            throw std::runtime_error("Invalid event on line " + std::to_string(lineNr) + " of the input recording");
+        }
+        events.push_back(std::move(event));
+    }
+    return events;
+}
+
+void InputReplay::start(std::function<void()> finished) {
+    this->finished = std::move(finished);
+    this->next = 0;
+    this->start = Clock::now();
+    xoj::util::Profiler::getInstance().setEnabled(true);
+    replayDue();
+}
+
+auto InputReplay::replayTimeout(InputReplay* self) -> gboolean {
+    self->timeout = 0;
+    self->replayDue();
+    return G_SOURCE_REMOVE;
+}
+
+void InputReplay::replayDue() {
+    auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - this->start).count();
+
+    // The events which arrived together are handled together, as they would be in the main loop
+    while (this->next < this->events.size() && this->events[this->next].timeUs <= elapsedUs) {
+        xoj::util::Profiler::getInstance().markInput();
+        this->context->handleEvent(toInputEvent(this->events[this->next]));
+        this->next++;
+    }
+
+    if (this->next == this->events.size()) {
+        if (this->finished) {
+            // May destroy the replay
+            auto callback = std::move(this->finished);
+            callback();
+        }
+        return;
+    }
+
+    auto delayMs = (this->events[this->next].timeUs - elapsedUs + 999) / 1000;
+    this->timeout = g_timeout_add(static_cast<guint>(std::max<int64_t>(delayMs, 0)),
+                                  reinterpret_cast<GSourceFunc>(replayTimeout), this);
+}
+
+auto InputReplay::toInputEvent(const RecordedInputEvent& recorded) const -> InputEvent {
+    GdkEventType gdkType = GDK_NOTHING;
+    switch (recorded.type) {
+        case BUTTON_PRESS_EVENT:
+            gdkType = GDK_BUTTON_PRESS;
+            break;
+        case BUTTON_2_PRESS_EVENT:
+            gdkType = GDK_2BUTTON_PRESS;
+            break;
+        case BUTTON_3_PRESS_EVENT:
+            gdkType = GDK_3BUTTON_PRESS;
+            break;
+        case BUTTON_RELEASE_EVENT:
+            gdkType = GDK_BUTTON_RELEASE;
+            break;
+        case MOTION_EVENT:
+            gdkType = GDK_MOTION_NOTIFY;
+            break;
+        case ENTER_EVENT:
+            gdkType = GDK_ENTER_NOTIFY;
+            break;
+        case LEAVE_EVENT:
+            gdkType = GDK_LEAVE_NOTIFY;
+            break;
+        case PROXIMITY_IN_EVENT:
+            gdkType = GDK_PROXIMITY_IN;
+            break;
+        case PROXIMITY_OUT_EVENT:
+            gdkType = GDK_PROXIMITY_OUT;
+            break;
+        case GRAB_BROKEN_EVENT:
+            gdkType = GDK_GRAB_BROKEN;
+            break;
+        default:
+            break;
+    }
+
+    auto time = static_cast<guint32>(g_get_monotonic_time() / 1000);
+
+    // The handlers only check that there is a source event: it carries the type, the time and the coordinates
+    GdkEvent* source = gdk_event_new(gdkType);
+    if (gdkType == GDK_MOTION_NOTIFY) {
+        source->motion.time = time;
+        source->motion.x = recorded.relativeX;
+        source->motion.y = recorded.relativeY;
+        source->motion.x_root = recorded.absoluteX;
+        source->motion.y_root = recorded.absoluteY;
+        source->motion.state = recorded.state;
+    } else if (gdkType == GDK_BUTTON_PRESS || gdkType == GDK_2BUTTON_PRESS || gdkType == GDK_3BUTTON_PRESS ||
+               gdkType == GDK_BUTTON_RELEASE) {
+        source->button.time = time;
+        source->button.x = recorded.relativeX;
+        source->button.y = recorded.relativeY;
+        source->button.x_root = recorded.absoluteX;
+        source->button.y_root = recorded.absoluteY;
+        source->button.state = recorded.state;
+        source->button.button = recorded.button;
+    }
+
+    InputEvent event{};
+    event.sourceEvent = source;
+    gdk_event_free(source);
+
+    event.type = recorded.type;
+    event.deviceClass = recorded.deviceClass;
+    event.deviceName = const_cast<gchar*>(recorded.deviceName.c_str());
+    event.absoluteX = recorded.absoluteX;
+    event.absoluteY = recorded.absoluteY;
+    event.relativeX = recorded.relativeX;
+    event.relativeY = recorded.relativeY;
+    event.button = recorded.button;
+    event.state = static_cast<GdkModifierType>(recorded.state);
+    event.pressure = recorded.pressure;
+    event.sequence = reinterpret_cast<GdkEventSequence*>(static_cast<uintptr_t>(recorded.sequence));
+    event.timestamp = time;
+    return event;
+}
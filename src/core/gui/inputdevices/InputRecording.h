@@ -0,0 +1,141 @@
+/*
+ * Xournal++
+ *
+ * Records the input events to a file and replays them
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <gdk/gdk.h>
+#include <glib.h>
+
+#include "InputEvents.h"
+#include "filesystem.h"
+
+class InputContext;
+
+/**
+ * @brief An input event as written to a recording, see InputRecorder
+ */
+struct RecordedInputEvent {
+    /// Since the first recorded event
+    int64_t timeUs = 0;
+
+    InputEventType type = UNKNOWN;
+    InputDeviceClass deviceClass = INPUT_DEVICE_IGNORE;
+    std::string deviceName;
+
+    double absoluteX = 0;
+    double absoluteY = 0;
+    double relativeX = 0;
+    double relativeY = 0;
+
+    guint button = 0;
+    guint state = 0;
+    double pressure = Point::NO_PRESSURE;
+
+    /// The touch sequence, numbered from 1 in the order they appear, 0 for none
+    int sequence = 0;
+
+    /**
+     * One line of tab separated fields, in the order of the members
+     */
+    void write(std::ostream& out) const;
+
+    /**
+     * @return false if the line is not a recorded event
+     */
+    bool read(const std::string& line);
+};
+
+/**
+ * @brief Writes the input events handled by the InputContext to a file, one per line, with their arrival time
+ *
+ * The first line is a header with the format version. The scroll and key events are not recorded: GTK handles the
+ * scrolling, and the key handlers need the native key events.
+ */
+class InputRecorder {
+public:
+    explicit InputRecorder(const fs::path& file);
+
+    /**
+     * @return Whether the file could be opened
+     */
+    bool isOpen() const;
+
+    void record(const InputEvent& event);
+
+    static constexpr const char* HEADER = "xournalpp-input-recording 1";
+
+private:
+    std::ofstream out;
+    std::chrono::steady_clock::time_point start{};
+    std::map<GdkEventSequence*, int> sequences;
+};
+
+/**
+ * @brief Feeds a recording into the InputContext, with the original timing
+ *
+ * The events are passed to InputContext::handleEvent() as if they came from GTK, at the time they arrived relative to
+ * the first one. As the replayed events have no native device, the device classes of the recording are used.
+ *
+ * The handling time of each event and the latencies from the input to the queued redraw and to the paint are recorded
+ * by xoj::util::Profiler, which is enabled for the replay.
+ */
+class InputReplay {
+public:
+    /**
+     * @throws std::runtime_error if the file can not be read or is not a recording
+     */
+    InputReplay(InputContext* context, const fs::path& file);
+    ~InputReplay();
+
+    InputReplay(const InputReplay&) = delete;
+    InputReplay& operator=(const InputReplay&) = delete;
+
+    /**
+     * @param finished Called once all the events are handled
+     */
+    void start(std::function<void()> finished);
+
+    /**
+     * @return The events of a recording
+     * @throws std::runtime_error if it is not a recording
+     */
+    static std::vector<RecordedInputEvent> read(std::istream& in);
+
+private:
+    static gboolean replayTimeout(InputReplay* self);
+
+    /**
+     * Handle the events which are due, and wait for the next one
+     */
+    void replayDue();
+
+    InputEvent toInputEvent(const RecordedInputEvent& recorded) const;
+
+private:
+    InputContext* context;
+    std::vector<RecordedInputEvent> events;
+    size_t next = 0;
+
+    std::chrono::steady_clock::time_point start{};
+    guint timeout = 0;
+    std::function<void()> finished;
+};
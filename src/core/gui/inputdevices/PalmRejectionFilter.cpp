@@ -0,0 +1,77 @@
+#include "PalmRejectionFilter.h"
+
+#include "util/Profiler.h"
+
+void PalmRejectionFilter::configure(bool enabled, guint32 penTimeoutMs, double maxContactSize) {
+    this->enabled = enabled;
+    this->penTimeoutMs = penTimeoutMs;
+    this->maxContactSize = maxContactSize;
+    if (!enabled) {
+        this->rejected.clear();
+    }
+}
+
+auto PalmRejectionFilter::accept(InputEvent const& event) -> bool {
+    if (event.deviceClass == INPUT_DEVICE_PEN || event.deviceClass == INPUT_DEVICE_ERASER) {
+        penEvent(event);
+        return true;
+    }
+    if (!this->enabled || event.deviceClass != INPUT_DEVICE_TOUCHSCREEN || event.sequence == nullptr) {
+        return true;
+    }
+
+    if (event.type == BUTTON_PRESS_EVENT) {
+        if (!isPalm(event)) {
+            return true;
+        }
+        this->rejected.insert(event.sequence);
+        this->rejectedSequences++;
+        drop();
+        return false;
+    }
+
+    auto it = this->rejected.find(event.sequence);
+    if (it == this->rejected.end()) {
+        return true;
+    }
+    if (event.type == BUTTON_RELEASE_EVENT) {
+        this->rejected.erase(it);
+    }
+    drop();
+    return false;
+}
+
+void PalmRejectionFilter::penEvent(InputEvent const& event) {
+    this->penSeen = true;
+    this->lastPenTime = event.timestamp;
+    if (event.type == BUTTON_PRESS_EVENT) {
+        this->penDown = true;
+    } else if (event.type == BUTTON_RELEASE_EVENT || event.type == PROXIMITY_OUT_EVENT) {
+        this->penDown = false;
+    }
+}
+
+auto PalmRejectionFilter::isPalm(InputEvent const& event) const -> bool {
+    if (this->penDown) {
+        return true;
+    }
+    // The hovering pen sends motion events. The timestamps are in ms and wrap around.
+    if (this->penSeen && static_cast<guint32>(event.timestamp - this->lastPenTime) < this->penTimeoutMs) {
+        return true;
+    }
+    return this->maxContactSize > 0 && event.contactSize != Point::NO_PRESSURE &&
+           event.contactSize > this->maxContactSize;
+}
+
+void PalmRejectionFilter::drop() {
+    this->droppedEvents++;
+    auto& profiler = xoj::util::Profiler::getInstance();
+    if (profiler.isEnabled()) {
+        profiler.setCounter("rejected palm touches", static_cast<int64_t>(this->rejectedSequences));
+        profiler.setCounter("dropped palm events", static_cast<int64_t>(this->droppedEvents));
+    }
+}
+
+auto PalmRejectionFilter::getRejectedSequences() const -> uint64_t { return this->rejectedSequences; }
+
+auto PalmRejectionFilter::getDroppedEvents() const -> uint64_t { return this->droppedEvents; }
@@ -0,0 +1,82 @@
+/*
+ * Xournal++
+ *
+ * Drops the touches of the palm before they are dispatched
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <set>
+
+#include <gdk/gdk.h>
+#include <glib.h>
+
+#include "InputEvents.h"
+
+/**
+ * @brief The first stage of InputContext::handleEvent(): rejects the touch sequences of a palm resting on the screen
+ *
+ * A touch sequence is rejected when it starts
+ *  - while the pen touches the screen,
+ *  - less than the timeout after the last pen event: the pen hovering near the screen sends motion events,
+ *  - or with a contact larger than the maximal size, for the touchscreens reporting it (see InputEvent::contactSize).
+ *
+ * All the events of a rejected sequence are then dropped, up to its end: the touch handlers neither scroll nor zoom,
+ * and the touches which started before the pen came are not interrupted. The decision only compares a few fields of
+ * the event, so that the flood of palm events while writing costs nothing else.
+ *
+ * Unlike HandRecognition, which disables the whole touchscreen with a timer, the stylus and the other fingers are not
+ * affected.
+ */
+class PalmRejectionFilter {
+public:
+    /**
+     * @param enabled Whether the touches are filtered at all
+     * @param penTimeoutMs How long after the last pen event a new touch is rejected
+     * @param maxContactSize The largest accepted contact, as reported by InputEvent::contactSize. 0 for no limit.
+     */
+    void configure(bool enabled, guint32 penTimeoutMs, double maxContactSize);
+
+    /**
+     * @return false if the event is to be dropped
+     */
+    bool accept(InputEvent const& event);
+
+    /**
+     * @return The number of rejected touch sequences
+     */
+    uint64_t getRejectedSequences() const;
+
+    /**
+     * @return The number of dropped events, of the rejected sequences
+     */
+    uint64_t getDroppedEvents() const;
+
+private:
+    void penEvent(InputEvent const& event);
+    bool isPalm(InputEvent const& event) const;
+    void drop();
+
+private:
+    bool enabled = false;
+    guint32 penTimeoutMs = 500;
+    double maxContactSize = 0;
+
+    bool penDown = false;
+    bool penSeen = false;
+    guint32 lastPenTime = 0;
+
+    /**
+     * The touch sequences which were rejected and did not end yet
+     */
+    std::set<GdkEventSequence*> rejected;
+
+    uint64_t rejectedSequences = 0;
+    uint64_t droppedEvents = 0;
+};
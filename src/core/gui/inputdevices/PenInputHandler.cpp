@@ -22,6 +22,8 @@ PenInputHandler::PenInputHandler(InputContext* inputContext): AbstractInputHandl
 
 PenInputHandler::~PenInputHandler() = default;
 
+auto PenInputHandler::isDeviceClassPressed() const -> bool { return this->deviceClassPressed; }
+
 void PenInputHandler::updateLastEvent(InputEvent const& event) {
     if (!event) {
         return;
@@ -222,6 +224,11 @@ auto PenInputHandler::actionMotion(InputEvent const& event) -> bool {
             this->handleScrollEvent(event);
             return true;
         }
+        if (XojPageView* currentPage = getPageAtCurrentPosition(event)) {
+            currentPage->updatePdfLinkHover(getInputDataRelativeToCurrentPage(currentPage, event));
+        } else {
+            xournal->view->showPdfLinkHover(nullptr);
+        }
         return false;
     }
     if (xournal->selection) {
@@ -279,6 +286,9 @@ auto PenInputHandler::actionMotion(InputEvent const& event) -> bool {
 
     // Update the cursor
     xournal->view->getCursor()->setInsidePage(currentPage != nullptr);
+    if (currentPage == nullptr) {
+        xournal->view->showPdfLinkHover(nullptr);
+    }
 
     // Selections and single-page elements will always work on one page so we need to handle them differently
     if (this->sequenceStartPage && toolHandler->isSinglePageTool()) {
@@ -317,6 +327,9 @@ auto PenInputHandler::actionEnd(InputEvent const& event) -> bool {
 
     cursor->setMouseDown(false);
 
+    // Before the release is relayed: its edits are rendered in full quality, see XournalView::isDraftRendering()
+    this->inputRunning = false;
+
     EditSelection* sel = xournal->view->getSelection();
     if (sel) {
         sel->mouseUp();
@@ -364,8 +377,6 @@ auto PenInputHandler::actionEnd(InputEvent const& event) -> bool {
         xournal->view->setSelection(tmpSelection);
     }
 
-    this->inputRunning = false;
-
     return false;
 }
 
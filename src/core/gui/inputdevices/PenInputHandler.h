@@ -75,6 +75,11 @@ public:
     explicit PenInputHandler(InputContext* inputContext);
     ~PenInputHandler() override;
 
+    /**
+     * @return Whether a device of the device class has button 1 in pressed state
+     */
+    bool isDeviceClassPressed() const;
+
 protected:
     /**
      * Action for the start of an input
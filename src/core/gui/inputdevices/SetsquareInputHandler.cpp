@@ -2,7 +2,10 @@
 
 #include <cmath>
 
+#include "model/Layer.h"
 #include "model/Snapping.h"
+#include "model/Stroke.h"
+#include "util/Rectangle.h"
 #include "view/SetsquareView.h"
 
 constexpr double MOVE_AMOUNT = HALF_CM / 2.0;
@@ -272,20 +275,6 @@ void SetsquareInputHandler::sequenceStart(InputEvent const& event) {
         this->secLastAbs = {event.absoluteX, event.absoluteY};
         this->secLastRel = {event.relativeX, event.relativeY};
     }
-    const auto view = inputContext->getView();
-    const auto setsquareView = view->getSetsquareView();
-    const auto page = setsquareView->getView()->getPage();
-
-    const auto l = page->getSelectedLayer();
-    this->lines.clear();
-    for (const auto& e: l->getElements()) {
-        if (e->getType() == ELEMENT_STROKE) {
-            auto s = dynamic_cast<Stroke*>(e);
-            if (s->getPointCount() == 2) {
-                lines.push_back(s);
-            }
-        }
-    }
 }
 
 void SetsquareInputHandler::scrollMotion(InputEvent const& event) {
@@ -313,7 +302,18 @@ void SetsquareInputHandler::scrollMotion(InputEvent const& event) {
     // Point snappedPoint{};
     const auto angleSetsquare = setsquareView->getRotation();
     double diffAngle{NAN};
-    for (const auto& l: lines) {
+    // The line segments (strokes with two points) near the setsquare, that are used for rotation snapping it
+    const auto layer = setsquareView->getPage()->getSelectedLayer();
+    const xoj::util::Rectangle<double> area{pos.x - SNAPPING_DISTANCE_TOLERANCE, pos.y - SNAPPING_DISTANCE_TOLERANCE,
+                                            2.0 * SNAPPING_DISTANCE_TOLERANCE, 2.0 * SNAPPING_DISTANCE_TOLERANCE};
+    for (Element* e: layer->getElementsInArea(area)) {
+        if (e->getType() != ELEMENT_STROKE) {
+            continue;
+        }
+        auto l = dynamic_cast<Stroke*>(e);
+        if (l->getPointCount() != 2) {
+            continue;
+        }
         auto first = l->getPoint(0);
         auto second = l->getPoint(1);
         auto dist = Snapping::distanceLine(pos, first, second);
@@ -91,12 +91,6 @@ private:
      */
     bool handScrolling{false};
 
-    /**
-     * @brief the line segments (strokes with two points) of the current layer, that are used for rotation snapping the
-     * setsquare
-     */
-    std::vector<Stroke*> lines;
-
 private:
     /**
      * @brief initializes an input sequence (right after the first or second finger is put onto the screen)
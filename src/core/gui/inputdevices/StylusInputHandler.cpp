@@ -70,9 +70,11 @@ auto StylusInputHandler::handleImpl(InputEvent const& event) -> bool {
         } else {
             this->actionMotion(event);
         }
-        XournalppCursor* cursor = xournal->view->getCursor();
-        cursor->setInvisible(false);
-        cursor->updateCursor();
+        if (!this->inputContext->isFlushingMotionEvents()) {
+            XournalppCursor* cursor = xournal->view->getCursor();
+            cursor->setInvisible(false);
+            cursor->updateCursor();
+        }
     }
 
 
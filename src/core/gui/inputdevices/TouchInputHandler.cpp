@@ -24,6 +24,9 @@ auto TouchInputHandler::handleImpl(InputEvent const& event) -> bool {
         if (this->primarySequence == nullptr && this->secondarySequence == nullptr) {
             this->primarySequence = event.sequence;
 
+            // The finger catches the document
+            inputContext->getView()->getControl()->getWindow()->getLayout()->stopFling();
+
             // Set sequence data
             sequenceStart(event);
         }
@@ -61,6 +64,10 @@ auto TouchInputHandler::handleImpl(InputEvent const& event) -> bool {
         }
 
         if (event.sequence == this->primarySequence) {
+            if (this->secondarySequence == nullptr) {
+                inputContext->getView()->getControl()->getWindow()->getLayout()->flingScroll();
+            }
+
             // If secondarySequence is nullptr, this sets primarySequence
             // to nullptr. If it isn't, then it is now the primary sequence!
             this->primarySequence = this->secondarySequence;
@@ -103,7 +110,7 @@ void TouchInputHandler::scrollMotion(InputEvent const& event) {
 
     auto* layout = inputContext->getView()->getControl()->getWindow()->getLayout();
 
-    layout->scrollRelative(-offset.x, -offset.y);
+    layout->queueScroll(-offset.x, -offset.y);
 }
 
 void TouchInputHandler::zoomStart() {
@@ -130,7 +137,7 @@ void TouchInputHandler::zoomStart() {
     }
 
     auto* mainWindow = inputContext->getView()->getControl()->getWindow();
-    zoomControl->startZoomSequence(center);
+    zoomControl->startZoomGesture(center);
 }
 
 void TouchInputHandler::zoomMotion(InputEvent const& event) {
@@ -0,0 +1,90 @@
+#include "KineticScroller.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Time after which the finger is considered stopped, in seconds
+ */
+constexpr double MOTION_PAUSE = 0.1;
+
+/**
+ * Time constant of the exponential slow down, in seconds
+ */
+constexpr double TIME_CONSTANT = 0.325;
+
+/**
+ * Velocity under which the kinetic scrolling stops, in pixels per second
+ */
+constexpr double MIN_VELOCITY = 20;
+
+/**
+ * Largest velocity of the kinetic scrolling, in pixels per second
+ */
+constexpr double MAX_VELOCITY = 8000;
+
+static auto seconds(gint64 duration) -> double { return static_cast<double>(duration) / G_USEC_PER_SEC; }
+
+void KineticScroller::addDelta(double dx, double dy, gint64 time) {
+    this->pending += {dx, dy};
+    this->coasting = false;
+
+    double elapsed = seconds(time - this->lastDeltaTime);
+    if (this->lastDeltaTime == 0 || elapsed > MOTION_PAUSE) {
+        this->velocity = {};
+    } else if (elapsed > 0) {
+        // Smoothed, the touch events come at irregular intervals
+        this->velocity.x = 0.5 * this->velocity.x + 0.5 * dx / elapsed;
+        this->velocity.y = 0.5 * this->velocity.y + 0.5 * dy / elapsed;
+    }
+    this->lastDeltaTime = time;
+}
+
+void KineticScroller::release(gint64 time) {
+    // The finger rested before it was lifted
+    if (this->lastDeltaTime == 0 || seconds(time - this->lastDeltaTime) > MOTION_PAUSE) {
+        this->velocity = {};
+    }
+    this->lastDeltaTime = 0;
+
+    double speed = std::hypot(this->velocity.x, this->velocity.y);
+    if (speed < MIN_VELOCITY) {
+        this->velocity = {};
+        return;
+    }
+    if (speed > MAX_VELOCITY) {
+        this->velocity *= MAX_VELOCITY / speed;
+    }
+    this->coasting = true;
+    this->lastFrameTime = time;
+}
+
+void KineticScroller::stop() {
+    this->coasting = false;
+    this->velocity = {};
+}
+
+auto KineticScroller::frame(gint64 frameTime) -> utl::Point<double> {
+    utl::Point<double> delta = this->pending;
+    this->pending = {};
+
+    if (this->coasting) {
+        double elapsed = std::max(seconds(frameTime - this->lastFrameTime), 0.0);
+        this->lastFrameTime = frameTime;
+
+        // The integral of the velocity over the frame, so that the distance does not depend on the frame rate
+        double decay = std::exp(-elapsed / TIME_CONSTANT);
+        delta += this->velocity * (TIME_CONSTANT * (1 - decay));
+        this->velocity *= decay;
+        if (std::hypot(this->velocity.x, this->velocity.y) < MIN_VELOCITY) {
+            stop();
+        }
+    }
+    return delta;
+}
+
+auto KineticScroller::isActive() const -> bool {
+    return this->coasting || this->pending != utl::Point<double>{};
+}
+
+auto KineticScroller::getVelocity() const -> utl::Point<double> { return this->velocity; }
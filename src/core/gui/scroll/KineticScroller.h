@@ -0,0 +1,69 @@
+/*
+ * Xournal++
+ *
+ * Scrolling with the finger, which keeps going once the finger is lifted
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "util/Point.h"
+
+/**
+ * @brief The distances to scroll at each frame, for the touch scrolling
+ *
+ * The distances the finger moves are accumulated and scrolled at once at the next frame. When the finger is lifted
+ * while moving, the scrolling goes on and slows down exponentially. The distance scrolled in a frame depends on the
+ * time elapsed since the previous frame only, so that the rate stays steady when frames are late.
+ *
+ * The times are in microseconds, see g_get_monotonic_time() and gdk_frame_clock_get_frame_time().
+ */
+class KineticScroller {
+public:
+    /**
+     * The finger moved by (dx, dy)
+     */
+    void addDelta(double dx, double dy, gint64 time);
+
+    /**
+     * The finger is lifted: keeps scrolling if it was moving
+     */
+    void release(gint64 time);
+
+    /**
+     * Stops scrolling, e.g. once the finger is down again. The pending distance is kept.
+     */
+    void stop();
+
+    /**
+     * @return The distance to scroll at the frame
+     */
+    utl::Point<double> frame(gint64 frameTime);
+
+    /**
+     * @return Whether frame() has to be called at the next frame
+     */
+    bool isActive() const;
+
+    /**
+     * @return In pixels per second
+     */
+    utl::Point<double> getVelocity() const;
+
+private:
+    /// Not scrolled yet
+    utl::Point<double> pending{};
+
+    /// Of the finger, then of the kinetic scrolling, in pixels per second
+    utl::Point<double> velocity{};
+    gint64 lastDeltaTime = 0;
+
+    bool coasting = false;
+    gint64 lastFrameTime = 0;
+};
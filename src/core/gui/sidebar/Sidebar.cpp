@@ -4,12 +4,14 @@
 
 #include "control/Control.h"
 #include "control/PdfCache.h"
+#include "control/settings/Settings.h"
 #include "gui/GladeGui.h"
 #include "gui/sidebar/indextree/SidebarIndexPage.h"
 #include "gui/sidebar/previews/layer/SidebarPreviewLayers.h"
 #include "gui/sidebar/previews/page/SidebarPreviewPages.h"
 #include "model/Document.h"
 #include "model/XojPage.h"
+#include "util/PathUtil.h"
 #include "previews/layer/SidebarLayersContextMenu.h"
 #include "previews/layer/SidebarPreviewLayers.h"
 #include "previews/page/SidebarPreviewPages.h"
@@ -20,6 +22,8 @@ Sidebar::Sidebar(GladeGui* gui, Control* control): toolbar(this, gui), control(c
 
     this->sidebarContents = gui->get("sidebarContents");
 
+    this->thumbnails.setDiskCache(std::make_unique<ThumbnailDiskCache>(Util::getCacheSubfolder("thumbnails")));
+
     this->initPages(sidebarContents, gui);
 
     registerListener(control);
@@ -27,10 +31,12 @@ Sidebar::Sidebar(GladeGui* gui, Control* control): toolbar(this, gui), control(c
 
 void Sidebar::initPages(GtkWidget* sidebarContents, GladeGui* gui) {
     addPage(new SidebarIndexPage(this->control, &this->toolbar));
-    addPage(new SidebarPreviewPages(this->control, this->gui, &this->toolbar));
+    addPage(new SidebarPreviewPages(this->control, this->gui, &this->toolbar, &this->thumbnails));
     auto layersContextMenu = std::make_shared<SidebarLayersContextMenu>(this->gui, &this->toolbar);
-    addPage(new SidebarPreviewLayers(this->control, this->gui, &this->toolbar, false, layersContextMenu));
-    addPage(new SidebarPreviewLayers(this->control, this->gui, &this->toolbar, true, layersContextMenu));
+    addPage(new SidebarPreviewLayers(this->control, this->gui, &this->toolbar, &this->thumbnails, false,
+                                     layersContextMenu));
+    addPage(new SidebarPreviewLayers(this->control, this->gui, &this->toolbar, &this->thumbnails, true,
+                                     layersContextMenu));
 
     // Init toolbar with icons
 
@@ -99,6 +105,8 @@ void Sidebar::setSelectedPage(size_t page) {
     this->visiblePage = nullptr;
     this->currentPage = nullptr;
 
+    bool visible = this->control->getSettings()->isSidebarVisible();
+
     size_t i = 0;
     for (AbstractSidebarPage* p: this->pages) {
         if (page == i) {
@@ -106,7 +114,11 @@ void Sidebar::setSelectedPage(size_t page) {
             gtk_toggle_tool_button_set_active(GTK_TOGGLE_TOOL_BUTTON(p->tabButton), true);
             this->visiblePage = p->getWidget();
             this->currentPage = p;
-            p->enableSidebar();
+            if (visible) {
+                p->enableSidebar();
+            } else {
+                p->disableSidebar();
+            }
         } else {
             p->disableSidebar();
             gtk_widget_hide(p->getWidget());
@@ -134,6 +146,18 @@ void Sidebar::updateVisibleTabs() {
     setSelectedPage(selected);
 }
 
+void Sidebar::setVisible(bool visible) {
+    if (!this->currentPage) {
+        return;
+    }
+
+    if (visible) {
+        this->currentPage->enableSidebar();
+    } else {
+        this->currentPage->disableSidebar();
+    }
+}
+
 void Sidebar::setTmpDisabled(bool disabled) {
     gtk_widget_set_sensitive(this->buttonCloseSidebar, !disabled);
     gtk_widget_set_sensitive(GTK_WIDGET(this->tbSelectPage), !disabled);
@@ -152,14 +176,35 @@ void Sidebar::saveSize() {
 
 auto Sidebar::getToolbar() -> SidebarToolbar* { return &this->toolbar; }
 
+auto Sidebar::getThumbnailCache() -> ThumbnailCache* { return &this->thumbnails; }
+
 auto Sidebar::getControl() -> Control* { return this->control; }
 
 void Sidebar::documentChanged(DocumentChangeType type) {
+    if (type == DOCUMENT_CHANGE_CLEARED || type == DOCUMENT_CHANGE_COMPLETE) {
+        this->thumbnails.clear();
+    }
     if (type == DOCUMENT_CHANGE_CLEARED || type == DOCUMENT_CHANGE_COMPLETE || type == DOCUMENT_CHANGE_PDF_BOOKMARKS) {
         updateVisibleTabs();
     }
 }
 
+void Sidebar::pageChanged(size_t page) {
+    // Also for the pages whose preview is not shown
+    Document* doc = this->control->getDocument();
+    doc->lock();
+    PageRef p = doc->getPage(page);
+    doc->unlock();
+    if (p) {
+        this->thumbnails.invalidate(p);
+    }
+}
+
+void Sidebar::pagesChanged(size_t first, size_t count) {
+    // In one pass over the previews, rather than one per page
+    this->thumbnails.removeOutdated();
+}
+
 SidebarPageButton::SidebarPageButton(Sidebar* sidebar, int index, AbstractSidebarPage* page) {
     this->sidebar = sidebar;
     this->index = index;
@@ -16,6 +16,7 @@
 #include <gtk/gtk.h>
 
 #include "gui/sidebar/previews/base/SidebarToolbar.h"
+#include "gui/sidebar/previews/base/ThumbnailCache.h"
 #include "model/DocumentChangeType.h"
 #include "model/DocumentListener.h"
 
@@ -58,6 +59,12 @@ public:
      */
     void updateVisibleTabs();
 
+    /**
+     * The sidebar was shown or hidden. The selected page is only enabled while the sidebar is shown, so that it builds
+     * its content on first use.
+     */
+    void setVisible(bool visible);
+
     /**
      * Temporary disable Sidebar (e.g. while saving)
      */
@@ -73,9 +80,16 @@ public:
      */
     SidebarToolbar* getToolbar();
 
+    /**
+     * The previews of the pages and of the layers
+     */
+    ThumbnailCache* getThumbnailCache();
+
 public:
     // DocumentListener interface
     void documentChanged(DocumentChangeType type) override;
+    void pageChanged(size_t page) override;
+    void pagesChanged(size_t first, size_t count) override;
 
 private:
     /**
@@ -122,6 +136,11 @@ private:
      * Sidebar toolbar
      */
     SidebarToolbar toolbar;
+
+    /**
+     * Previews of the pages and layers, shared by the preview sidebars
+     */
+    ThumbnailCache thumbnails;
 };
 
 class SidebarPageButton {
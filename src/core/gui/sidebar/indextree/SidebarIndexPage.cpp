@@ -3,6 +3,7 @@
 #include <config.h>
 
 #include "control/Control.h"
+#include "control/jobs/XournalScheduler.h"
 #include "model/LinkDestination.h"
 #include "model/XojPage.h"
 #include "util/Util.h"
@@ -348,6 +349,10 @@ void SidebarIndexPage::documentChanged(DocumentChangeType type) {
         //  lock the document.
         g_signal_handler_block(this->treeViewBookmarks, this->selectHandler);
         doc->lock();
+        if (doc->isOutlineOutdated()) {
+            // Shown once read, with DOCUMENT_CHANGE_PDF_BOOKMARKS
+            this->control->getScheduler()->addReadOutline(this->control, doc->getPdfDocument());
+        }
         GtkTreeModel* model = doc->getContentsModel();
         gtk_tree_view_set_model(GTK_TREE_VIEW(this->treeViewBookmarks), model);
         int count = expandOpenLinks(model, nullptr);
@@ -0,0 +1,29 @@
+/*
+ * Xournal++
+ *
+ * What a preview entry of a sidebar renders
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+typedef enum {
+    /**
+     * Render the whole page
+     */
+    RENDER_TYPE_PAGE_PREVIEW = 1,
+
+    /**
+     * Render only a layer
+     */
+    RENDER_TYPE_PAGE_LAYER,
+
+    /**
+     * Render the stack up to a layer
+     */
+    RENDER_TYPE_PAGE_LAYERSTACK
+} PreviewRenderType;
@@ -1,6 +1,6 @@
 #include "SidebarLayout.h"
 
-#include <list>
+#include <algorithm>
 
 #include "SidebarPreviewBase.h"
 #include "SidebarPreviewBaseEntry.h"
@@ -9,97 +9,62 @@ SidebarLayout::SidebarLayout() = default;
 
 SidebarLayout::~SidebarLayout() = default;
 
-class SidebarRow {
-public:
-    explicit SidebarRow(int width) {
-        this->width = width;
-        this->currentWidth = 0;
-    }
-
-    ~SidebarRow() { clear(); }
+auto SidebarLayout::place(const std::vector<std::pair<int, int>>& sizes, int width) -> Placement {
+    Placement placement;
+    placement.slots.resize(sizes.size());
 
+    int y = 0;
+    size_t rowStart = 0;
+    int rowWidth = 0;
+    int rowHeight = 0;
 
-    auto isSpaceFor(SidebarPreviewBaseEntry* p) -> bool {
-        if (this->list.empty()) {
-            return true;
+    auto finishRow = [&](size_t rowEnd) {
+        int x = 0;
+        for (size_t i = rowStart; i < rowEnd; i++) {
+            Slot& slot = placement.slots[i];
+            slot.x = x;
+            slot.y = y + (rowHeight - sizes[i].second) / 2;
+            slot.width = sizes[i].first;
+            slot.height = sizes[i].second;
+            slot.rowY = y;
+            slot.rowHeight = rowHeight;
+            x += sizes[i].first;
         }
-
-        if (this->currentWidth + p->getWidth() < width) {
-            return true;
+        placement.width = std::max(placement.width, rowWidth);
+        y += rowHeight;
+    };
+
+    for (size_t i = 0; i < sizes.size(); i++) {
+        if (i != rowStart && rowWidth + sizes[i].first >= width) {
+            finishRow(i);
+            rowStart = i;
+            rowWidth = 0;
+            rowHeight = 0;
         }
-        return false;
+        rowWidth += sizes[i].first;
+        rowHeight = std::max(rowHeight, sizes[i].second);
     }
-
-    void add(SidebarPreviewBaseEntry* p) {
-        this->list.push_back(p);
-        this->currentWidth += p->getWidth();
-    }
-
-    void clear() {
-        this->list.clear();
-        this->currentWidth = 0;
+    if (rowStart < sizes.size()) {
+        finishRow(sizes.size());
     }
 
-    auto getCount() -> int { return this->list.size(); }
-
-    auto getWidth() const -> int { return this->currentWidth; }
-
-    auto placeAt(int y, GtkLayout* layout) -> int {
-        int height = 0;
-        int x = 0;
-
-        for (SidebarPreviewBaseEntry* p: this->list) { height = std::max(height, p->getHeight()); }
-
-
-        for (SidebarPreviewBaseEntry* p: this->list) {
-            int currentY = (height - p->getHeight()) / 2;
-
-            gtk_layout_move(layout, p->getWidget(), x, y + currentY);
-
-            x += p->getWidth();
-        }
-
-
-        return height;
-    }
-
-private:
-    int width;
-    int currentWidth;
-
-    std::list<SidebarPreviewBaseEntry*> list;
-};
+    placement.height = y;
+    return placement;
+}
 
 void SidebarLayout::layout(SidebarPreviewBase* sidebar) {
-    int y = 0;
-    int width = 0;
-
     GtkAllocation alloc;
-
     gtk_widget_get_allocation(sidebar->scrollPreview, &alloc);
 
-    SidebarRow row(alloc.width);
-
-    for (SidebarPreviewBaseEntry* p: sidebar->previews) {
-        if (row.isSpaceFor(p)) {
-            row.add(p);
-        } else {
-            y += row.placeAt(y, GTK_LAYOUT(sidebar->iconViewPreview));
-
-            width = std::max(width, row.getWidth());
-
-            row.clear();
-            row.add(p);
-        }
-    }
-
-    if (row.getCount() != 0) {
-        y += row.placeAt(y, GTK_LAYOUT(sidebar->iconViewPreview));
-
-        width = std::max(width, row.getWidth());
+    std::vector<std::pair<int, int>> sizes;
+    sizes.reserve(sidebar->previews.size());
+    for (SidebarPreviewBaseEntry* p: sidebar->previews) { sizes.emplace_back(p->getWidth(), p->getHeight()); }
 
-        row.clear();
+    Placement placement = place(sizes, alloc.width);
+    for (size_t i = 0; i < sidebar->previews.size(); i++) {
+        const Slot& slot = placement.slots[i];
+        gtk_layout_move(GTK_LAYOUT(sidebar->iconViewPreview), sidebar->previews[i]->getWidget(), slot.x, slot.y);
     }
 
-    gtk_layout_set_size(GTK_LAYOUT(sidebar->iconViewPreview), width, y);
+    gtk_layout_set_size(GTK_LAYOUT(sidebar->iconViewPreview), placement.width, placement.height);
 }
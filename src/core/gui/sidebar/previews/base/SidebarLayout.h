@@ -12,6 +12,7 @@
 #pragma once
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <gtk/gtk.h>
@@ -25,6 +26,36 @@ public:
     virtual ~SidebarLayout();
 
 public:
+    struct Slot {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+
+        /**
+         * The row of the slot, in which the previews are centered vertically
+         */
+        int rowY = 0;
+        int rowHeight = 0;
+    };
+
+    struct Placement {
+        std::vector<Slot> slots;
+
+        /**
+         * The size of all the rows
+         */
+        int width = 0;
+        int height = 0;
+    };
+
+    /**
+     * Places the previews in rows as wide as the sidebar, from their sizes only: no widget is needed
+     * @param sizes The width and height of each preview, in order
+     * @param width The width of the sidebar
+     */
+    static Placement place(const std::vector<std::pair<int, int>>& sizes, int width);
+
     /**
      * Layouts the sidebar
      */
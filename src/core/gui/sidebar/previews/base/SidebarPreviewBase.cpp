@@ -7,14 +7,15 @@
 #include "SidebarPreviewBaseEntry.h"
 
 
-SidebarPreviewBase::SidebarPreviewBase(Control* control, GladeGui* gui, SidebarToolbar* toolbar):
-        AbstractSidebarPage(control, toolbar) {
+SidebarPreviewBase::SidebarPreviewBase(Control* control, GladeGui* gui, SidebarToolbar* toolbar,
+                                       ThumbnailCache* thumbnails):
+        AbstractSidebarPage(control, toolbar), thumbnails(thumbnails) {
     this->layoutmanager = new SidebarLayout();
 
     Document* doc = this->control->getDocument();
     doc->lock();
     if (doc->getPdfPageCount() != 0) {
-        this->cache = std::make_unique<PdfCache>(doc->getPdfDocument(), control->getSettings());
+        this->cache = PdfCache::getShared(doc->getPdfDocument(), control->getSettings());
     }
     doc->unlock();
 
@@ -53,7 +54,37 @@ SidebarPreviewBase::~SidebarPreviewBase() {
     this->previews.clear();
 }
 
-void SidebarPreviewBase::enableSidebar() { enabled = true; }
+void SidebarPreviewBase::enableSidebar() {
+    enabled = true;
+    if (this->previewsOutdated) {
+        this->previewsOutdated = false;
+        updatePreviews();
+    }
+}
+
+void SidebarPreviewBase::updatePreviewsIfEnabled() {
+    if (this->enabled) {
+        this->previewsOutdated = false;
+        updatePreviews();
+        return;
+    }
+
+    clearPreviews();
+    this->previewsOutdated = true;
+}
+
+void SidebarPreviewBase::clearPreviews() {
+    for (SidebarPreviewBaseEntry* p: this->previews) { delete p; }
+    this->previews.clear();
+}
+
+auto SidebarPreviewBase::getPreviewArea(size_t index, GtkAllocation& area) -> bool {
+    if (index == npos || index >= this->previews.size()) {
+        return false;
+    }
+    gtk_widget_get_allocation(this->previews[index]->getWidget(), &area);
+    return true;
+}
 
 void SidebarPreviewBase::disableSidebar() { enabled = false; }
 
@@ -74,6 +105,8 @@ auto SidebarPreviewBase::getZoom() const -> double { return this->zoom; }
 
 auto SidebarPreviewBase::getCache() -> PdfCache* { return this->cache.get(); }
 
+auto SidebarPreviewBase::getThumbnailCache() -> ThumbnailCache* { return this->thumbnails; }
+
 void SidebarPreviewBase::layout() { SidebarLayout::layout(this); }
 
 auto SidebarPreviewBase::hasData() -> bool { return true; }
@@ -82,15 +115,32 @@ auto SidebarPreviewBase::getWidget() -> GtkWidget* { return this->scrollPreview;
 
 void SidebarPreviewBase::documentChanged(DocumentChangeType type) {
     if (type == DOCUMENT_CHANGE_COMPLETE || type == DOCUMENT_CHANGE_CLEARED) {
+        // Reused by the new cache if the PDF did not change
+        std::shared_ptr<PdfCache> previousCache = std::move(this->cache);
+
+        Document* doc = control->getDocument();
+        doc->lock();
+        if (doc->getPdfPageCount() != 0) {
+            this->cache = PdfCache::getShared(doc->getPdfDocument(), control->getSettings());
+        }
+        doc->unlock();
+        updatePreviewsIfEnabled();
+    } else if (type == DOCUMENT_CHANGE_PDF_RELOADED) {
+        // The previews are kept: the new cache has the renderings of the pages which did not change
+        XournalScheduler* scheduler = control->getScheduler();
+        scheduler->lock();
+        if (this->cache) {
+            scheduler->removePdfCache(this->cache.get());
+        }
         this->cache.reset();
 
         Document* doc = control->getDocument();
         doc->lock();
         if (doc->getPdfPageCount() != 0) {
-            this->cache = std::make_unique<PdfCache>(doc->getPdfDocument(), control->getSettings());
+            this->cache = PdfCache::getShared(doc->getPdfDocument(), control->getSettings());
         }
         doc->unlock();
-        updatePreviews();
+        scheduler->unlock();
     }
 }
 
@@ -109,16 +159,11 @@ auto SidebarPreviewBase::scrollToPreview(SidebarPreviewBase* sidebar) -> bool {
         return false;
     }
 
-    if (sidebar->selectedEntry != npos && sidebar->selectedEntry < sidebar->previews.size()) {
-        SidebarPreviewBaseEntry* p = sidebar->previews[sidebar->selectedEntry];
-
+    GtkAllocation allocation;
+    if (sidebar->getPreviewArea(sidebar->selectedEntry, allocation)) {
         // scroll to preview
         GtkAdjustment* hadj = gtk_scrolled_window_get_hadjustment(GTK_SCROLLED_WINDOW(sidebar->scrollPreview));
         GtkAdjustment* vadj = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(sidebar->scrollPreview));
-        GtkWidget* widget = p->getWidget();
-
-        GtkAllocation allocation;
-        gtk_widget_get_allocation(widget, &allocation);
         int x = allocation.x;
         int y = allocation.y;
 
@@ -25,10 +25,11 @@ class PdfCache;
 class SidebarLayout;
 class SidebarPreviewBaseEntry;
 class SidebarToolbar;
+class ThumbnailCache;
 
 class SidebarPreviewBase: public AbstractSidebarPage {
 public:
-    SidebarPreviewBase(Control* control, GladeGui* gui, SidebarToolbar* toolbar);
+    SidebarPreviewBase(Control* control, GladeGui* gui, SidebarToolbar* toolbar, ThumbnailCache* thumbnails);
     ~SidebarPreviewBase() override;
 
 public:
@@ -38,13 +39,19 @@ public:
     /**
      * Layout the pages to the current size of the sidebar
      */
-    void layout();
+    virtual void layout();
 
     /**
      * Update the preview images
      */
     virtual void updatePreviews() = 0;
 
+    /**
+     * Update the previews now if the sidebar is shown, or else drop them until it is enabled: building the previews of
+     * a long document takes a while, e.g. at startup
+     */
+    void updatePreviewsIfEnabled();
+
     /**
      * @overwrite
      */
@@ -65,6 +72,11 @@ public:
      */
     PdfCache* getCache();
 
+    /**
+     * @return The previews shared with the other preview sidebars
+     */
+    ThumbnailCache* getThumbnailCache();
+
 public:
     // DocumentListener interface (only the part handled by SidebarPreviewBase)
     void documentChanged(DocumentChangeType type) override;
@@ -77,6 +89,17 @@ protected:
      */
     static bool scrollToPreview(SidebarPreviewBase* sidebar);
 
+    /**
+     * Delete the previews, until they are built again by updatePreviews()
+     */
+    virtual void clearPreviews();
+
+    /**
+     * @param area The place of the preview in the sidebar, x is -1 until it is laid out
+     * @return false if there is no such preview
+     */
+    virtual bool getPreviewArea(size_t index, GtkAllocation& area);
+
     /**
      * The size of the sidebar has chnaged
      */
@@ -102,7 +125,9 @@ private:
     /**
      * For preview rendering
      */
-    std::unique_ptr<PdfCache> cache;
+    std::shared_ptr<PdfCache> cache;
+
+    ThumbnailCache* thumbnails;
 
     /**
      * The layouting class for the prviews
@@ -133,5 +158,11 @@ protected:
      */
     bool enabled = false;
 
+    /**
+     * The document changed while the sidebar was disabled: the previews are built once it is enabled, see
+     * updatePreviewsIfEnabled()
+     */
+    bool previewsOutdated = false;
+
     friend class SidebarLayout;
 };
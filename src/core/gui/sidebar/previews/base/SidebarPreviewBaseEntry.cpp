@@ -1,7 +1,11 @@
 #include "SidebarPreviewBaseEntry.h"
 
 #include "control/Control.h"
+#include "gui/MainWindow.h"
+#include "gui/PageView.h"
 #include "gui/Shadow.h"
+#include "gui/XournalView.h"
+#include "model/Document.h"
 #include "util/i18n.h"
 
 #include "SidebarPreviewBase.h"
@@ -67,7 +71,76 @@ void SidebarPreviewBaseEntry::setSelected(bool selected) {
     gtk_widget_queue_draw(this->widget);
 }
 
-void SidebarPreviewBaseEntry::repaint() { sidebar->getControl()->getScheduler()->addRepaintSidebar(this); }
+auto SidebarPreviewBaseEntry::getPage() const -> const PageRef& { return this->page; }
+
+void SidebarPreviewBaseEntry::setPage(const PageRef& page) {
+    if (this->page == page) {
+        return;
+    }
+    this->sidebar->getControl()->getScheduler()->removeSidebar(this);
+
+    this->drawingMutex.lock();
+    this->page = page;
+    if (this->crBuffer) {
+        cairo_surface_destroy(this->crBuffer);
+        this->crBuffer = nullptr;
+    }
+    this->outdated = false;
+    this->drawingMutex.unlock();
+
+    if (this->page) {
+        updateSize();
+    }
+    gtk_widget_queue_draw(this->widget);
+}
+
+void SidebarPreviewBaseEntry::repaint() {
+    sidebar->getThumbnailCache()->invalidate(this->page);
+    sidebar->getControl()->getScheduler()->addRepaintSidebar(this);
+}
+
+void SidebarPreviewBaseEntry::invalidate() {
+    this->drawingMutex.lock();
+    this->outdated = true;
+    this->drawingMutex.unlock();
+    // Only the previews in the visible part of the sidebar are drawn
+    gtk_widget_queue_draw(this->widget);
+}
+
+auto SidebarPreviewBaseEntry::getThumbnailKey() -> ThumbnailCache::Key {
+    GtkAllocation alloc;
+    gtk_widget_get_allocation(this->widget, &alloc);
+    return ThumbnailCache::makeKey(this->page, getRenderType(), 0, alloc.width, alloc.height);
+}
+
+auto SidebarPreviewBaseEntry::renderFromPageView() -> cairo_surface_t* {
+    if (getRenderType() != RENDER_TYPE_PAGE_PREVIEW) {
+        return nullptr;
+    }
+
+    Control* control = sidebar->getControl();
+    MainWindow* win = control->getWindow();
+    size_t pageNr = control->getDocument()->indexOf(this->page);
+    // Only the pages shown recently have a view with a buffer
+    XojPageView* view = win && pageNr != npos ? win->getXournal()->getExistingViewFor(pageNr) : nullptr;
+    if (view == nullptr) {
+        return nullptr;
+    }
+
+    GtkAllocation alloc;
+    gtk_widget_get_allocation(this->widget, &alloc);
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, alloc.width, alloc.height);
+    cairo_t* cr = cairo_create(surface);
+    cairo_translate(cr, Shadow::getShadowTopLeftSize() + 2, Shadow::getShadowTopLeftSize() + 2);
+    bool painted = view->paintBufferScaled(cr, sidebar->getZoom());
+    cairo_destroy(cr);
+
+    if (!painted) {
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+    return surface;
+}
 
 void SidebarPreviewBaseEntry::drawLoadingPage() {
     GtkAllocation alloc;
@@ -104,10 +177,26 @@ void SidebarPreviewBaseEntry::paint(cairo_t* cr) {
 
     this->drawingMutex.lock();
 
+    if (this->crBuffer == nullptr) {
+        // Rendered before, or already rendered on the page view: no need to render it again
+        ThumbnailCache* thumbnails = sidebar->getThumbnailCache();
+        auto key = getThumbnailKey();
+        this->crBuffer = thumbnails->get(key);
+        if (this->crBuffer == nullptr) {
+            uint64_t revision = thumbnails->getRevision(this->page);
+            if ((this->crBuffer = renderFromPageView())) {
+                thumbnails->put(key, revision, this->crBuffer);
+            }
+        }
+    }
+
     if (this->crBuffer == nullptr) {
         drawLoadingPage();
         doRepaint = true;
+    } else if (this->outdated) {
+        doRepaint = true;
     }
+    this->outdated = false;
 
     cairo_set_source_surface(cr, this->crBuffer, 0, 0);
     cairo_paint(cr);
@@ -137,7 +226,8 @@ void SidebarPreviewBaseEntry::paint(cairo_t* cr) {
     this->drawingMutex.unlock();
 
     if (doRepaint) {
-        repaint();
+        // Not a change of the page, keep its previews
+        sidebar->getControl()->getScheduler()->addRepaintSidebar(this);
     }
 }
 
@@ -145,15 +235,13 @@ void SidebarPreviewBaseEntry::updateSize() {
     gtk_widget_set_size_request(this->widget, getWidgetWidth(), getWidgetHeight());
 }
 
-auto SidebarPreviewBaseEntry::getWidgetWidth() -> int {
-    return page->getWidth() * sidebar->getZoom() + Shadow::getShadowBottomRightSize() + Shadow::getShadowTopLeftSize() +
-           4;
+auto SidebarPreviewBaseEntry::getWidgetSize(double pageSize, double zoom) -> int {
+    return static_cast<int>(pageSize * zoom) + Shadow::getShadowBottomRightSize() + Shadow::getShadowTopLeftSize() + 4;
 }
 
-auto SidebarPreviewBaseEntry::getWidgetHeight() -> int {
-    return page->getHeight() * sidebar->getZoom() + Shadow::getShadowBottomRightSize() +
-           Shadow::getShadowTopLeftSize() + 4;
-}
+auto SidebarPreviewBaseEntry::getWidgetWidth() -> int { return getWidgetSize(page->getWidth(), sidebar->getZoom()); }
+
+auto SidebarPreviewBaseEntry::getWidgetHeight() -> int { return getWidgetSize(page->getHeight(), sidebar->getZoom()); }
 
 auto SidebarPreviewBaseEntry::getWidth() -> int { return getWidgetWidth(); }
 
@@ -20,25 +20,10 @@
 #include "model/PageRef.h"
 #include "util/Util.h"
 
-class SidebarPreviewBase;
-
-typedef enum {
-    /**
-     * Render the whole page
-     */
-    RENDER_TYPE_PAGE_PREVIEW = 1,
-
-    /**
-     * Render only a layer
-     */
-    RENDER_TYPE_PAGE_LAYER,
-
-    /**
-     * Render the stack up to a layer
-     */
-    RENDER_TYPE_PAGE_LAYERSTACK
-} PreviewRenderType;
+#include "PreviewRenderType.h"
+#include "ThumbnailCache.h"
 
+class SidebarPreviewBase;
 
 class SidebarPreviewBaseEntry {
 public:
@@ -52,7 +37,29 @@ public:
 
     virtual void setSelected(bool selected);
 
+    const PageRef& getPage() const;
+
+    /**
+     * Shows another page, e.g. once the preview is recycled for the page scrolled to. Waits for the rendering of the
+     * current page, the document must not be locked.
+     */
+    void setPage(const PageRef& page);
+
+    /**
+     * @return The width or height of the widget showing a page of the given width or height
+     */
+    static int getWidgetSize(double pageSize, double zoom);
+
+    /**
+     * The content of the page changed: render the preview again
+     */
     virtual void repaint();
+
+    /**
+     * The content of the page changed: render the preview again once it is next drawn. Until then, the outdated
+     * preview is shown.
+     */
+    void invalidate();
     virtual void updateSize();
 
     /**
@@ -60,6 +67,11 @@ public:
      */
     virtual PreviewRenderType getRenderType() = 0;
 
+    /**
+     * @return The key of the preview in the ThumbnailCache, for the current size of the widget
+     */
+    virtual ThumbnailCache::Key getThumbnailKey();
+
 private:
     static gboolean drawCallback(GtkWidget* widget, cairo_t* cr, SidebarPreviewBaseEntry* preview);
 
@@ -72,6 +84,12 @@ protected:
     virtual void drawLoadingPage();
     virtual void paint(cairo_t* cr);
 
+    /**
+     * Downsamples the view buffer of the page, if it is complete and up to date
+     * @return The preview or nullptr
+     */
+    cairo_surface_t* renderFromPageView();
+
 private:
 protected:
     /**
@@ -104,5 +122,10 @@ protected:
      */
     cairo_surface_t* crBuffer = nullptr;
 
+    /**
+     * crBuffer is outdated, see invalidate()
+     */
+    bool outdated = false;
+
     friend class PreviewJob;
 };
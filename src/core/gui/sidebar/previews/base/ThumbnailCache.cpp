@@ -0,0 +1,136 @@
+#include "ThumbnailCache.h"
+
+#include <tuple>
+#include <utility>
+
+#include "model/XojPage.h"
+#include "util/Profiler.h"
+
+auto ThumbnailCache::Key::operator<(const Key& other) const -> bool {
+    if (this->page.owner_before(other.page)) {
+        return true;
+    }
+    if (other.page.owner_before(this->page)) {
+        return false;
+    }
+    return std::tie(type, layer, width, height, visibleLayers) <
+           std::tie(other.type, other.layer, other.width, other.height, other.visibleLayers);
+}
+
+auto ThumbnailCache::makeKey(const PageRef& page, PreviewRenderType type, Layer::Index layer, int width, int height)
+        -> Key {
+    Key key{page, type, layer, width, height, {}};
+    // The layer previews are rendered whether the layers are visible or not
+    if (type != RENDER_TYPE_PAGE_PREVIEW) {
+        return key;
+    }
+    for (Layer::Index i = 0; i <= page->getLayerCount(); i++) {
+        key.visibleLayers.push_back(page->isLayerVisible(i));
+    }
+    return key;
+}
+
+ThumbnailCache::ThumbnailCache(size_t maxBytes): maxBytes(maxBytes) {}
+
+ThumbnailCache::~ThumbnailCache() { clear(); }
+
+auto ThumbnailCache::get(const Key& key) -> cairo_surface_t* {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->index.find(key);
+    if (it == this->index.end()) {
+        xoj::util::Profiler::getInstance().countAccess("thumbnails", false);
+        return nullptr;
+    }
+    auto page = key.page.lock();
+    if (!page || page->getRevision() != it->second->revision) {
+        erase(it->second);
+        xoj::util::Profiler::getInstance().countAccess("thumbnails", false);
+        return nullptr;
+    }
+    this->entries.splice(this->entries.begin(), this->entries, it->second);
+    xoj::util::Profiler::getInstance().countAccess("thumbnails", true);
+    return cairo_surface_reference(it->second->surface);
+}
+
+void ThumbnailCache::put(const Key& key, uint64_t revision, cairo_surface_t* surface) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto page = key.page.lock();
+    if (!page || page->getRevision() != revision) {
+        return;
+    }
+
+    if (auto it = this->index.find(key); it != this->index.end()) {
+        erase(it->second);
+    }
+
+    size_t size = static_cast<size_t>(cairo_image_surface_get_stride(surface)) *
+                  static_cast<size_t>(cairo_image_surface_get_height(surface));
+    this->entries.push_front({key, cairo_surface_reference(surface), size, revision});
+    this->index.emplace(key, this->entries.begin());
+    this->bytes += size;
+
+    trim();
+}
+
+auto ThumbnailCache::getRevision(const PageRef& page) -> uint64_t { return page->getRevision(); }
+
+void ThumbnailCache::invalidate(const PageRef& page) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    std::weak_ptr<XojPage> weak = page;
+    for (auto it = this->entries.begin(); it != this->entries.end();) {
+        auto next = std::next(it);
+        if (!it->key.page.owner_before(weak) && !weak.owner_before(it->key.page)) {
+            erase(it);
+        }
+        it = next;
+    }
+}
+
+void ThumbnailCache::removeOutdated() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (auto it = this->entries.begin(); it != this->entries.end();) {
+        auto next = std::next(it);
+        auto page = it->key.page.lock();
+        if (!page || page->getRevision() != it->revision) {
+            erase(it);
+        }
+        it = next;
+    }
+}
+
+void ThumbnailCache::clear() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    while (!this->entries.empty()) {
+        erase(this->entries.begin());
+    }
+}
+
+auto ThumbnailCache::getBytes() const -> size_t {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->bytes;
+}
+
+void ThumbnailCache::setDiskCache(std::unique_ptr<ThumbnailDiskCache> disk) { this->disk = std::move(disk); }
+
+auto ThumbnailCache::getDiskCache() const -> ThumbnailDiskCache* { return this->disk.get(); }
+
+void ThumbnailCache::erase(std::list<Entry>::iterator it) {
+    this->bytes -= it->bytes;
+    cairo_surface_destroy(it->surface);
+    this->index.erase(it->key);
+    this->entries.erase(it);
+}
+
+void ThumbnailCache::trim() {
+    for (auto it = this->entries.begin(); it != this->entries.end();) {
+        auto next = std::next(it);
+        if (it->key.page.expired()) {
+            erase(it);
+        }
+        it = next;
+    }
+
+    while (this->bytes > this->maxBytes && !this->entries.empty()) {
+        erase(std::prev(this->entries.end()));
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ * Xournal++
+ *
+ * Cache of the rendered previews of the sidebars
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <cairo.h>
+
+#include "model/Layer.h"
+#include "model/PageRef.h"
+
+#include "PreviewRenderType.h"
+#include "ThumbnailDiskCache.h"
+
+class XojPage;
+
+/**
+ * @brief Rendered previews of the pages and of their layers, shared by the preview sidebars
+ *
+ * The previews are kept in least recently used order, up to a memory budget: reopening a sidebar, switching between
+ * the page and the layer previews or going back to a page shows them without rendering them again.
+ *
+ * The previews of the single layers are shared by the layer sidebar and the layer stack sidebar, which composes its
+ * previews from them (see PreviewJob).
+ *
+ * Each preview is stored with the revision of its page (see PageHandler::getRevision()) it was rendered from. It is
+ * dropped once the page has another revision, and is not stored if the page changed during its rendering.
+ *
+ * Thread safe: the previews are rendered by the threads of the Scheduler.
+ */
+class ThumbnailCache {
+public:
+    struct Key {
+        std::weak_ptr<XojPage> page;
+        PreviewRenderType type = RENDER_TYPE_PAGE_PREVIEW;
+        Layer::Index layer = 0;
+
+        /**
+         * Size of the preview surface, in pixels
+         */
+        int width = 0;
+        int height = 0;
+
+        /**
+         * Visibility of the background and of each layer, which is not part of the revision. Empty for the layer
+         * previews, which do not depend on it.
+         */
+        std::vector<bool> visibleLayers;
+
+        bool operator<(const Key& other) const;
+    };
+
+    /**
+     * @return The key of the preview of the page, of the given size
+     */
+    static Key makeKey(const PageRef& page, PreviewRenderType type, Layer::Index layer, int width, int height);
+
+    explicit ThumbnailCache(size_t maxBytes = MAX_BYTES);
+    ~ThumbnailCache();
+
+    ThumbnailCache(const ThumbnailCache&) = delete;
+    ThumbnailCache& operator=(const ThumbnailCache&) = delete;
+
+public:
+    /**
+     * @return A new reference to the preview, or nullptr
+     */
+    cairo_surface_t* get(const Key& key);
+
+    /**
+     * Stores the preview, unless the page changed since the given revision. The cache takes a reference of the surface.
+     */
+    void put(const Key& key, uint64_t revision, cairo_surface_t* surface);
+
+    /**
+     * @return The current revision of the page, to be passed to put() along with a preview rendered from now on
+     */
+    static uint64_t getRevision(const PageRef& page);
+
+    /**
+     * The content of the page changed: free its previews now, rather than when they are next looked up
+     */
+    void invalidate(const PageRef& page);
+
+    /**
+     * Free the previews of all the pages which changed, or were deleted, since their previews were rendered
+     */
+    void removeOutdated();
+
+    void clear();
+
+    /**
+     * @return The number of bytes of the previews
+     */
+    size_t getBytes() const;
+
+    /**
+     * Keep the previews of the pages as loaded on disk as well
+     */
+    void setDiskCache(std::unique_ptr<ThumbnailDiskCache> disk);
+
+    /**
+     * @return The previews on disk, nullptr if there are none
+     */
+    ThumbnailDiskCache* getDiskCache() const;
+
+    static constexpr size_t MAX_BYTES = 64U << 20U;
+
+private:
+    struct Entry {
+        Key key;
+        cairo_surface_t* surface;
+        size_t bytes;
+        uint64_t revision;
+    };
+
+    void erase(std::list<Entry>::iterator it);
+
+    /**
+     * Drop the previews of the deleted pages and the least recently used ones over the budget
+     */
+    void trim();
+
+private:
+    size_t maxBytes;
+    size_t bytes = 0;
+
+    /**
+     * The most recently used first
+     */
+    std::list<Entry> entries;
+    std::map<Key, std::list<Entry>::iterator> index;
+
+    std::unique_ptr<ThumbnailDiskCache> disk;
+
+    mutable std::mutex mutex;
+};
@@ -0,0 +1,137 @@
+#include "ThumbnailDiskCache.h"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include <glib.h>
+
+#include "control/xojfile/LazyPageLoader.h"
+#include "model/XojPage.h"
+
+ThumbnailDiskCache::ThumbnailDiskCache(fs::path folder): folder(std::move(folder)) {}
+
+auto ThumbnailDiskCache::getFile(const PageRef& page, int width, int height) -> fs::path {
+    auto loader = std::dynamic_pointer_cast<LazyPageLoader>(page->getLayerLoader());
+    if (!loader || page->getRevision() != page->getLayerLoaderRevision()) {
+        // The layers were parsed already or the page was changed, it may differ from the file
+        return {};
+    }
+
+    std::string hash = getHash(loader->getSource().filepath);
+    if (hash.empty()) {
+        return {};
+    }
+
+    // The page element in the file
+    std::string id = loader->getEntry();
+    if (id.empty()) {
+        const auto& range = loader->getRange();
+        id = std::to_string(range.first) + "-" + std::to_string(range.second);
+    }
+    gchar* name = g_compute_checksum_for_string(G_CHECKSUM_SHA1, id.c_str(), -1);
+
+    fs::path file = this->folder / hash;
+    file /= std::string(name) + "-" + std::to_string(width) + "x" + std::to_string(height) + ".png";
+    g_free(name);
+    return file;
+}
+
+auto ThumbnailDiskCache::load(const fs::path& file, int width, int height) -> cairo_surface_t* {
+    std::error_code ec;
+    if (!fs::exists(file, ec)) {
+        return nullptr;
+    }
+
+    cairo_surface_t* surface = cairo_image_surface_create_from_png(file.u8string().c_str());
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS ||
+        cairo_image_surface_get_format(surface) != CAIRO_FORMAT_ARGB32 ||
+        cairo_image_surface_get_width(surface) != width || cairo_image_surface_get_height(surface) != height) {
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+
+    // Most recently used
+    fs::last_write_time(file.parent_path(), fs::file_time_type::clock::now(), ec);
+    return surface;
+}
+
+void ThumbnailDiskCache::store(const fs::path& file, cairo_surface_t* surface) {
+    std::error_code ec;
+    bool newDocument = !fs::exists(file.parent_path(), ec);
+    fs::create_directories(file.parent_path(), ec);
+    if (ec) {
+        g_warning("Could not create the thumbnail folder %s: %s", file.parent_path().u8string().c_str(),
+                  ec.message().c_str());
+        return;
+    }
+
+    // Written aside, so that a concurrent load never reads a partial file
+    fs::path tmp = file;
+    tmp += ".tmp" + std::to_string(reinterpret_cast<uintptr_t>(g_thread_self()));
+    if (cairo_surface_write_to_png(surface, tmp.u8string().c_str()) != CAIRO_STATUS_SUCCESS) {
+        g_warning("Could not write the thumbnail %s", tmp.u8string().c_str());
+        fs::remove(tmp, ec);
+        return;
+    }
+    fs::rename(tmp, file, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return;
+    }
+
+    if (newDocument) {
+        trim();
+    }
+}
+
+auto ThumbnailDiskCache::getHash(const fs::path& file) -> std::string {
+    std::error_code ec;
+    auto time = fs::last_write_time(file, ec);
+    auto size = ec ? 0 : fs::file_size(file, ec);
+    if (ec) {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (auto it = this->hashes.find(file); it != this->hashes.end() && it->second.time == time &&
+                                           it->second.size == size) {
+        return it->second.hash;
+    }
+
+    // Read once per document, outside of the UI thread
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        return {};
+    }
+    GChecksum* checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    std::vector<char> buffer(1U << 20U);
+    while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        g_checksum_update(checksum, reinterpret_cast<const guchar*>(buffer.data()), in.gcount());
+    }
+    std::string hash = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+
+    this->hashes[file] = {time, size, hash};
+    return hash;
+}
+
+void ThumbnailDiskCache::trim() {
+    std::error_code ec;
+    std::vector<std::pair<fs::file_time_type, fs::path>> documents;
+    for (const auto& entry: fs::directory_iterator(this->folder, ec)) {
+        if (entry.is_directory(ec)) {
+            documents.emplace_back(fs::last_write_time(entry.path(), ec), entry.path());
+        }
+    }
+    if (documents.size() <= MAX_DOCUMENTS) {
+        return;
+    }
+
+    std::sort(documents.begin(), documents.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = MAX_DOCUMENTS; i < documents.size(); i++) {
+        fs::remove_all(documents[i].second, ec);
+    }
+}
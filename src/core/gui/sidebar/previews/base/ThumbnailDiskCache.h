@@ -0,0 +1,83 @@
+/*
+ * Xournal++
+ *
+ * Previews of the pages saved on disk, for the documents opened again
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <cairo.h>
+
+#include "model/PageRef.h"
+
+#include "filesystem.h"
+
+/**
+ * @brief Page previews stored as PNG files in the cache folder, by content hash of the document file
+ *
+ * Only the pages which were not accessed since the document was loaded have a file: their content is exactly the one
+ * of the page element in the document file, which the file name identifies along with the size of the preview. Their
+ * preview is thus shown without parsing their layers.
+ *
+ * The previews of the MAX_DOCUMENTS most recently used documents are kept.
+ *
+ * Thread safe: used by the threads of the Scheduler.
+ */
+class ThumbnailDiskCache {
+public:
+    explicit ThumbnailDiskCache(fs::path folder);
+
+public:
+    /**
+     * @return The file of the preview of the page, of the given size, or an empty path if the page is not the one of
+     *         the document file any more
+     */
+    fs::path getFile(const PageRef& page, int width, int height);
+
+    /**
+     * @return A new preview, or nullptr if there is no file or it is not of the expected size
+     */
+    cairo_surface_t* load(const fs::path& file, int width, int height);
+
+    void store(const fs::path& file, cairo_surface_t* surface);
+
+    static constexpr size_t MAX_DOCUMENTS = 20;
+
+private:
+    /**
+     * @return The hexadecimal SHA-256 of the content of the file, empty if it cannot be read
+     */
+    std::string getHash(const fs::path& file);
+
+    /**
+     * Delete the previews of the least recently used documents
+     */
+    void trim();
+
+private:
+    struct Hash {
+        fs::file_time_type time;
+        uintmax_t size;
+        std::string hash;
+    };
+
+    fs::path folder;
+
+    /**
+     * The hash of each document file, until it is modified
+     */
+    std::map<fs::path, Hash> hashes;
+
+    std::mutex mutex;
+};
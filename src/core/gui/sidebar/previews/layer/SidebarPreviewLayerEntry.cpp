@@ -78,6 +78,12 @@ auto SidebarPreviewLayerEntry::getRenderType() -> PreviewRenderType {
     return stacked ? RENDER_TYPE_PAGE_LAYERSTACK : RENDER_TYPE_PAGE_LAYER;
 }
 
+auto SidebarPreviewLayerEntry::getThumbnailKey() -> ThumbnailCache::Key {
+    auto key = SidebarPreviewBaseEntry::getThumbnailKey();
+    key.layer = this->layerId;
+    return key;
+}
+
 auto SidebarPreviewLayerEntry::getHeight() -> int { return getWidgetHeight() + toolbarHeight; }
 
 auto SidebarPreviewLayerEntry::getLayer() const -> Layer::Index { return layerId; }
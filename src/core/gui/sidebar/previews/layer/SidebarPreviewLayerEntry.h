@@ -38,6 +38,8 @@ public:
      */
     Layer::Index getLayer() const;
 
+    ThumbnailCache::Key getThumbnailKey() override;
+
     GtkWidget* getWidget() override;
 
     /**
@@ -7,9 +7,10 @@
 
 #include "SidebarPreviewLayerEntry.h"
 
-SidebarPreviewLayers::SidebarPreviewLayers(Control* control, GladeGui* gui, SidebarToolbar* toolbar, bool stacked,
+SidebarPreviewLayers::SidebarPreviewLayers(Control* control, GladeGui* gui, SidebarToolbar* toolbar,
+                                           ThumbnailCache* thumbnails, bool stacked,
                                            std::shared_ptr<SidebarLayersContextMenu> contextMenu):
-        SidebarPreviewBase(control, gui, toolbar),
+        SidebarPreviewBase(control, gui, toolbar, thumbnails),
         lc(control->getLayerController()),
         stacked(stacked),
         iconNameHelper(control->getSettings()),
@@ -24,8 +24,8 @@
 
 class SidebarPreviewLayers: public SidebarPreviewBase, public LayerCtrlListener {
 public:
-    SidebarPreviewLayers(Control* control, GladeGui* gui, SidebarToolbar* toolbar, bool stacked,
-                         std::shared_ptr<SidebarLayersContextMenu> contextMenu);
+    SidebarPreviewLayers(Control* control, GladeGui* gui, SidebarToolbar* toolbar, ThumbnailCache* thumbnails,
+                         bool stacked, std::shared_ptr<SidebarLayersContextMenu> contextMenu);
 
     ~SidebarPreviewLayers() override;
 
@@ -1,6 +1,9 @@
 #include "SidebarPreviewPages.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 #include "control/Control.h"
 #include "control/PdfCache.h"
@@ -11,8 +14,9 @@
 
 #include "SidebarPreviewPageEntry.h"
 
-SidebarPreviewPages::SidebarPreviewPages(Control* control, GladeGui* gui, SidebarToolbar* toolbar):
-        SidebarPreviewBase(control, gui, toolbar),
+SidebarPreviewPages::SidebarPreviewPages(Control* control, GladeGui* gui, SidebarToolbar* toolbar,
+                                         ThumbnailCache* thumbnails):
+        SidebarPreviewBase(control, gui, toolbar, thumbnails),
         contextMenu(gui->get("sidebarPreviewContextMenu")),
         iconNameHelper(control->getSettings()) {
     // Connect the context menu actions
@@ -48,9 +52,17 @@ SidebarPreviewPages::SidebarPreviewPages(Control* control, GladeGui* gui, Sideba
     }
     g_assert(this->contextMenuMoveDown != nullptr);
     g_assert(this->contextMenuMoveUp != nullptr);
+
+    GtkAdjustment* vadj = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(getWidget()));
+    g_signal_connect(vadj, "value-changed", G_CALLBACK(scrolled), this);
+    // The height of the visible part changed
+    g_signal_connect(vadj, "changed", G_CALLBACK(scrolled), this);
 }
 
 SidebarPreviewPages::~SidebarPreviewPages() {
+    g_signal_handlers_disconnect_by_data(gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(getWidget())), this);
+    clearPreviews();
+
     for (const auto& signalTuple: this->contextMenuSignals) {
         GtkWidget* const widget = std::get<0>(signalTuple);
         const guint handlerId = std::get<1>(signalTuple);
@@ -182,51 +194,145 @@ void SidebarPreviewPages::actionPerformed(SidebarActions action) {
     }
 }
 
-void SidebarPreviewPages::updatePreviews() {
-    for (SidebarPreviewBaseEntry* p: this->previews) { delete p; }
-    this->previews.clear();
+void SidebarPreviewPages::updatePreviews() { layout(); }
+
+void SidebarPreviewPages::clearPreviews() {
+    for (auto& [nr, entry]: this->entries) { delete entry; }
+    this->entries.clear();
+    for (SidebarPreviewPageEntry* entry: this->spareEntries) { delete entry; }
+    this->spareEntries.clear();
+    this->slots.clear();
+}
 
+void SidebarPreviewPages::layout() {
     Document* doc = this->getControl()->getDocument();
+    double zoom = getZoom();
+    std::vector<std::pair<int, int>> sizes;
     doc->lock();
-    size_t len = doc->getPageCount();
-    for (size_t i = 0; i < len; i++) {
-        SidebarPreviewBaseEntry* p = new SidebarPreviewPageEntry(this, doc->getPage(i));
-        this->previews.push_back(p);
-        gtk_layout_put(GTK_LAYOUT(this->iconViewPreview), p->getWidget(), 0, 0);
+    size_t count = doc->getPageCount();
+    sizes.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        PageRef page = doc->getPage(i);
+        sizes.emplace_back(SidebarPreviewBaseEntry::getWidgetSize(page->getWidth(), zoom),
+                           SidebarPreviewBaseEntry::getWidgetSize(page->getHeight(), zoom));
     }
+    doc->unlock();
 
-    layout();
+    GtkAllocation alloc;
+    gtk_widget_get_allocation(getWidget(), &alloc);
+    SidebarLayout::Placement placement = SidebarLayout::place(sizes, alloc.width);
+    this->slots = std::move(placement.slots);
+    gtk_layout_set_size(GTK_LAYOUT(this->iconViewPreview), placement.width, placement.height);
+
+    updateVisibleEntries();
+}
+
+void SidebarPreviewPages::updateVisibleEntries() {
+    using Slot = SidebarLayout::Slot;
+    GtkAdjustment* vadj = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(getWidget()));
+    double visibleHeight = gtk_adjustment_get_page_size(vadj);
+    double top = gtk_adjustment_get_value(vadj) - visibleHeight;
+    double bottom = gtk_adjustment_get_value(vadj) + 2 * visibleHeight;
+
+    // The rows are sorted from top to bottom
+    auto first = std::partition_point(this->slots.begin(), this->slots.end(),
+                                      [top](const Slot& slot) { return slot.rowY + slot.rowHeight < top; });
+    auto last = std::partition_point(first, this->slots.end(),
+                                     [bottom](const Slot& slot) { return slot.rowY <= bottom; });
+    auto begin = static_cast<size_t>(first - this->slots.begin());
+    auto end = static_cast<size_t>(last - this->slots.begin());
+
+    std::vector<PageRef> pages;
+    Document* doc = control->getDocument();
+    doc->lock();
+    end = std::min(end, doc->getPageCount());
+    for (size_t i = begin; i < end; i++) { pages.push_back(doc->getPage(i)); }
     doc->unlock();
+
+    // The entries of the pages still in range are kept, wherever the pages moved
+    std::map<XojPage*, SidebarPreviewPageEntry*> previous;
+    for (auto& [nr, entry]: this->entries) { previous.emplace(entry->getPage().get(), entry); }
+    std::map<size_t, SidebarPreviewPageEntry*> visible;
+    for (size_t i = begin; i < end; i++) {
+        auto it = previous.find(pages[i - begin].get());
+        if (it != previous.end()) {
+            visible[i] = it->second;
+            previous.erase(it);
+        }
+    }
+    for (auto& [page, entry]: previous) {
+        entry->setPage(nullptr);
+        gtk_widget_hide(entry->getWidget());
+        this->spareEntries.push_back(entry);
+    }
+
+    for (size_t i = begin; i < end; i++) {
+        SidebarPreviewPageEntry*& entry = visible[i];
+        if (entry == nullptr && this->spareEntries.empty()) {
+            entry = new SidebarPreviewPageEntry(this, pages[i - begin]);
+            gtk_layout_put(GTK_LAYOUT(this->iconViewPreview), entry->getWidget(), 0, 0);
+        } else if (entry == nullptr) {
+            entry = this->spareEntries.back();
+            this->spareEntries.pop_back();
+            entry->setPage(pages[i - begin]);
+            gtk_widget_show(entry->getWidget());
+        }
+        const Slot& slot = this->slots[i];
+        gtk_layout_move(GTK_LAYOUT(this->iconViewPreview), entry->getWidget(), slot.x, slot.y);
+        entry->setSelected(i == this->selectedEntry);
+    }
+    this->entries = std::move(visible);
+}
+
+auto SidebarPreviewPages::getEntry(size_t page) const -> SidebarPreviewPageEntry* {
+    auto it = this->entries.find(page);
+    return it == this->entries.end() ? nullptr : it->second;
+}
+
+auto SidebarPreviewPages::getPreviewArea(size_t index, GtkAllocation& area) -> bool {
+    if (index == npos || index >= this->slots.size()) {
+        return false;
+    }
+    const SidebarLayout::Slot& slot = this->slots[index];
+    area = {slot.x, slot.y, slot.width, slot.height};
+    return true;
+}
+
+void SidebarPreviewPages::scrolled(GtkAdjustment* adjustment, SidebarPreviewPages* sidebar) {
+    sidebar->updateVisibleEntries();
 }
 
 void SidebarPreviewPages::pageSizeChanged(size_t page) {
-    if (page == npos || page >= this->previews.size()) {
+    if (page == npos || page >= this->slots.size()) {
         return;
     }
-    SidebarPreviewBaseEntry* p = this->previews[page];
-    p->updateSize();
-    p->repaint();
+    if (SidebarPreviewBaseEntry* p = getEntry(page)) {
+        p->updateSize();
+        p->repaint();
+    }
 
     layout();
 }
 
 void SidebarPreviewPages::pageChanged(size_t page) {
-    if (page == npos || page >= this->previews.size()) {
-        return;
+    // The previews of the other pages are outdated in the ThumbnailCache, and rendered again once scrolled to
+    if (SidebarPreviewBaseEntry* p = getEntry(page)) {
+        p->repaint();
     }
+}
 
-    SidebarPreviewBaseEntry* p = this->previews[page];
-    p->repaint();
+void SidebarPreviewPages::pagesChanged(size_t first, size_t count) {
+    // The previews out of sight are only rendered once they are scrolled to
+    for (auto it = this->entries.lower_bound(first); it != this->entries.end() && it->first < first + count; ++it) {
+        it->second->invalidate();
+    }
 }
 
 void SidebarPreviewPages::pageDeleted(size_t page) {
-    if (page >= previews.size()) {
+    if (page >= this->slots.size()) {
         return;
     }
 
-    delete previews[page];
-    previews.erase(previews.begin() + page);
-
     // Unselect page, to prevent double selection displaying
     unselectPage();
 
@@ -234,16 +340,20 @@ void SidebarPreviewPages::pageDeleted(size_t page) {
 }
 
 void SidebarPreviewPages::pageInserted(size_t page) {
-    Document* doc = control->getDocument();
-    doc->lock();
-
-    SidebarPreviewBaseEntry* p = new SidebarPreviewPageEntry(this, doc->getPage(page));
+    if (this->previewsOutdated || page > this->slots.size()) {
+        return;
+    }
 
-    doc->unlock();
+    // Unselect page, to prevent double selection displaying
+    unselectPage();
 
-    this->previews.insert(this->previews.begin() + page, p);
+    layout();
+}
 
-    gtk_layout_put(GTK_LAYOUT(this->iconViewPreview), p->getWidget(), 0, 0);
+void SidebarPreviewPages::pagesInserted(size_t first, size_t count) {
+    if (this->previewsOutdated || first > this->slots.size()) {
+        return;
+    }
 
     // Unselect page, to prevent double selection displaying
     unselectPage();
@@ -255,12 +365,12 @@ void SidebarPreviewPages::pageInserted(size_t page) {
  * Unselect the last selected page, if any
  */
 void SidebarPreviewPages::unselectPage() {
-    for (SidebarPreviewBaseEntry* p: this->previews) { p->setSelected(false); }
+    for (auto& [nr, entry]: this->entries) { entry->setSelected(false); }
 }
 
 void SidebarPreviewPages::pageSelected(size_t page) {
-    if (this->selectedEntry != npos && this->selectedEntry < this->previews.size()) {
-        this->previews[this->selectedEntry]->setSelected(false);
+    if (SidebarPreviewBaseEntry* p = getEntry(this->selectedEntry)) {
+        p->setSelected(false);
     }
     this->selectedEntry = page;
 
@@ -268,25 +378,27 @@ void SidebarPreviewPages::pageSelected(size_t page) {
         return;
     }
 
-    if (this->selectedEntry != npos && this->selectedEntry < this->previews.size()) {
-        SidebarPreviewBaseEntry* p = this->previews[this->selectedEntry];
-        p->setSelected(true);
+    if (this->selectedEntry != npos && this->selectedEntry < this->slots.size()) {
+        if (SidebarPreviewBaseEntry* p = getEntry(this->selectedEntry)) {
+            p->setSelected(true);
+        }
+        // Binds an entry to the page if it was out of sight
         scrollToPreview(this);
 
         int actions = 0;
-        if (page != 0 && !this->previews.empty()) {
+        if (page != 0 && !this->slots.empty()) {
             actions |= SIDEBAR_ACTION_MOVE_UP;
         }
 
-        if (page != this->previews.size() - 1 && !this->previews.empty()) {
+        if (page != this->slots.size() - 1 && !this->slots.empty()) {
             actions |= SIDEBAR_ACTION_MOVE_DOWN;
         }
 
-        if (!this->previews.empty()) {
+        if (!this->slots.empty()) {
             actions |= SIDEBAR_ACTION_COPY;
         }
 
-        if (this->previews.size() > 1) {
+        if (this->slots.size() > 1) {
             actions |= SIDEBAR_ACTION_DELETE;
         }
 
@@ -11,18 +11,30 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "gui/IconNameHelper.h"
+#include "gui/sidebar/previews/base/SidebarLayout.h"
 #include "gui/sidebar/previews/base/SidebarPreviewBase.h"
 
+class SidebarPreviewPageEntry;
+
+/**
+ * @brief The previews of the pages, with widgets only around the visible part of the sidebar
+ *
+ * The place of each preview is computed from the size of its page by SidebarLayout::place(). Only the pages in the
+ * visible part of the sidebar and one screen above and below it have a SidebarPreviewPageEntry: the entries scrolled
+ * out of this range are hidden and recycled for the pages scrolled to, so that a long document does not create a
+ * widget per page.
+ */
 
 class SidebarPreviewPages: public SidebarPreviewBase {
 public:
-    SidebarPreviewPages(Control* control, GladeGui* gui, SidebarToolbar* toolbar);
+    SidebarPreviewPages(Control* control, GladeGui* gui, SidebarToolbar* toolbar, ThumbnailCache* thumbnails);
     ~SidebarPreviewPages() override;
 
 public:
@@ -55,20 +67,59 @@ public:
      */
     void openPreviewContextMenu() override;
 
+    /**
+     * Places the previews, from the sizes of the pages, and binds the entries to the pages around the visible part
+     */
+    void layout() override;
+
 public:
     // DocumentListener interface (only the part which is not handled by SidebarPreviewBase)
     void pageSizeChanged(size_t page) override;
     void pageChanged(size_t page) override;
+    void pagesChanged(size_t first, size_t count) override;
     void pageSelected(size_t page) override;
     void pageInserted(size_t page) override;
+    void pagesInserted(size_t first, size_t count) override;
     void pageDeleted(size_t page) override;
 
+protected:
+    void clearPreviews() override;
+    bool getPreviewArea(size_t index, GtkAllocation& area) override;
+
 private:
     /**
      * Unselect the last selected page, if any
      */
     void unselectPage();
 
+    /**
+     * Binds the entries to the pages in the visible part of the sidebar and the margin around it, following the
+     * pages which moved, e.g. after an insertion
+     */
+    void updateVisibleEntries();
+
+    /**
+     * @return The entry of the page, nullptr if it is not around the visible part of the sidebar
+     */
+    SidebarPreviewPageEntry* getEntry(size_t page) const;
+
+    static void scrolled(GtkAdjustment* adjustment, SidebarPreviewPages* sidebar);
+
+    /**
+     * The place of the preview of each page
+     */
+    std::vector<SidebarLayout::Slot> slots;
+
+    /**
+     * The entries of the pages around the visible part of the sidebar, by page number
+     */
+    std::map<size_t, SidebarPreviewPageEntry*> entries;
+
+    /**
+     * The entries scrolled out of sight, hidden until they are bound to another page
+     */
+    std::vector<SidebarPreviewPageEntry*> spareEntries;
+
     /**
      * The context menu to display when a page is right-clicked.
      */
@@ -77,6 +77,15 @@ void AbstractItem::actionEnabledAction(ActionType action, bool enabled) {
     }
 }
 
+auto AbstractItem::getListenedAction() const -> ActionType { return this->action; }
+
+auto AbstractItem::getListenedGroup() const -> ActionGroup { return this->group; }
+
+void AbstractItem::setAction(ActionType action) {
+    this->action = action;
+    listenedActionChanged();
+}
+
 void AbstractItem::activated(GdkEvent* event, GtkMenuItem* menuitem, GtkToolButton* toolbutton) {
     bool selected = true;
 
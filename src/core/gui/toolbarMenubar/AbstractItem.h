@@ -38,6 +38,8 @@ public:
     virtual void selected(ActionGroup group, ActionType action);
 
     void actionEnabledAction(ActionType action, bool enabled) override;
+    ActionType getListenedAction() const override;
+    ActionGroup getListenedGroup() const override;
     virtual void activated(GdkEvent* event, GtkMenuItem* menuitem, GtkToolButton* toolbutton);
 
     virtual std::string getId() const;
@@ -55,6 +57,11 @@ public:
 protected:
     virtual void enable(bool enabled);
 
+    /**
+     * Change the action of the item, e.g. of a combo control showing the last selected tool
+     */
+    void setAction(ActionType action);
+
     virtual void actionPerformed(ActionType action, ActionGroup group, GdkEvent* event, GtkMenuItem* menuitem,
                                  GtkToolButton* toolbutton, bool selected);
 
@@ -57,6 +57,9 @@ auto AbstractToolItem::createItem(bool horizontal) -> GtkToolItem* {
 
     this->item = createTmpItem(horizontal);
     g_object_ref(this->item);
+    if (!this->enabled) {
+        enable(false);
+    }
 
     if (GTK_IS_TOOL_BUTTON(this->item) || GTK_IS_TOGGLE_TOOL_BUTTON(this->item)) {
         g_signal_connect(this->item, "clicked", G_CALLBACK(&toolButtonCallback), this);
@@ -0,0 +1,161 @@
+#include "ToolAudioTimeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "control/AudioController.h"
+#include "control/Control.h"
+#include "util/i18n.h"
+
+/// Size of the timeline in the toolbar, in pixels
+constexpr int TIMELINE_WIDTH = 320;
+constexpr int TIMELINE_HEIGHT = 24;
+
+/// A click plays from the next element if its mark is at most so many pixels to the right
+constexpr double SNAP_DISTANCE = 4;
+
+constexpr guint RECORDING_REDRAW_MS = 500;
+
+/**
+ * @return The elements written during the recording, by the names the elements may give it
+ */
+static auto getEntries(Control* control, const fs::path& file, size_t duration) -> std::vector<AudioTimeline::Entry> {
+    AudioTimeline* timeline = control->getAudioController()->getTimeline();
+    Document* doc = control->getDocument();
+    doc->lock();
+    auto entries = timeline->getElementsBetween(doc, file.filename(), 0, duration + 1);
+    if (entries.empty() && file.has_parent_path()) {
+        entries = timeline->getElementsBetween(doc, file, 0, duration + 1);
+    }
+    doc->unlock();
+    return entries;
+}
+
+ToolAudioTimeline::ToolAudioTimeline(ActionHandler* handler, std::string id, ActionType type, Control* control,
+                                     IconNameHelper iconNameHelper):
+        AbstractToolItem(std::move(id), handler, type, nullptr), control(control), iconNameHelper(iconNameHelper) {}
+
+ToolAudioTimeline::~ToolAudioTimeline() {
+    if (this->recordingTimeout) {
+        g_source_remove(this->recordingTimeout);
+    }
+}
+
+void ToolAudioTimeline::update() {
+    if (this->area) {
+        gtk_widget_queue_draw(this->area);
+    }
+    if (!this->recordingTimeout && this->control->getAudioController()->isRecording()) {
+        this->recordingTimeout =
+                g_timeout_add(RECORDING_REDRAW_MS, reinterpret_cast<GSourceFunc>(onRecordingTick), this);
+    }
+}
+
+auto ToolAudioTimeline::onRecordingTick(ToolAudioTimeline* self) -> gboolean {
+    if (self->area) {
+        gtk_widget_queue_draw(self->area);
+    }
+    if (!self->control->getAudioController()->isRecording()) {
+        self->recordingTimeout = 0;
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+auto ToolAudioTimeline::onDraw(GtkWidget* widget, cairo_t* cr, ToolAudioTimeline* self) -> gboolean {
+    auto* audio = self->control->getAudioController();
+    fs::path file = audio->getCurrentAudioFile();
+    auto waveform = file.empty() ? nullptr : audio->getWaveform(file);
+    if (!waveform) {
+        // Drawn once it is computed
+        return false;
+    }
+    size_t duration = waveform->getDuration();
+    int width = gtk_widget_get_allocated_width(widget);
+    int height = gtk_widget_get_allocated_height(widget);
+    if (duration == 0 || width <= 0) {
+        return false;
+    }
+
+    GtkStyleContext* context = gtk_widget_get_style_context(widget);
+    GdkRGBA color;
+    gtk_style_context_get_color(context, gtk_style_context_get_state(context), &color);
+
+    double middle = height / 2.0;
+    auto peaks = waveform->getPeaks(0, duration, static_cast<size_t>(width));
+    for (size_t x = 0; x < peaks.size(); x++) {
+        double top = middle - peaks[x].max * middle;
+        double bottom = middle - peaks[x].min * middle;
+        cairo_rectangle(cr, double(x), top, 1, std::max(1.0, bottom - top));
+    }
+    cairo_set_source_rgba(cr, color.red, color.green, color.blue, 0.5 * color.alpha);
+    cairo_fill(cr);
+
+    // The marks of the elements along the top
+    for (const auto& entry: getEntries(self->control, file, duration)) {
+        double x = std::floor(double(entry.timestamp) * width / double(duration)) + 0.5;
+        cairo_move_to(cr, x, 0);
+        cairo_line_to(cr, x, height / 4.0);
+    }
+    cairo_set_source_rgba(cr, color.red, color.green, color.blue, color.alpha);
+    cairo_set_line_width(cr, 1);
+    cairo_stroke(cr);
+
+    return false;
+}
+
+auto ToolAudioTimeline::onButtonPress(GtkWidget* widget, GdkEventButton* event, ToolAudioTimeline* self) -> gboolean {
+    auto* audio = self->control->getAudioController();
+    fs::path file = audio->getCurrentAudioFile();
+    auto waveform = file.empty() || audio->isRecording() ? nullptr : audio->getWaveform(file);
+    int width = gtk_widget_get_allocated_width(widget);
+    if (event->button != 1 || !waveform || waveform->getDuration() == 0 || width <= 0) {
+        return false;
+    }
+
+    size_t duration = waveform->getDuration();
+    double pixelsPerMs = double(width) / double(duration);
+    auto timestamp = static_cast<size_t>(std::clamp(event->x / pixelsPerMs, 0.0, double(duration)));
+
+    for (const auto& entry: getEntries(self->control, file, duration)) {
+        if (entry.timestamp >= timestamp) {
+            if (double(entry.timestamp - timestamp) * pixelsPerMs <= SNAP_DISTANCE) {
+                timestamp = entry.timestamp;
+            }
+            break;
+        }
+    }
+
+    audio->startPlayback(file, static_cast<unsigned int>(timestamp));
+    return true;
+}
+
+auto ToolAudioTimeline::getToolDisplayName() const -> std::string { return _("Audio Timeline"); }
+
+auto ToolAudioTimeline::getNewToolIcon() const -> GtkWidget* {
+    return gtk_image_new_from_icon_name(iconNameHelper.iconName("audio-record").c_str(), GTK_ICON_SIZE_SMALL_TOOLBAR);
+}
+
+auto ToolAudioTimeline::getNewToolPixbuf() const -> GdkPixbuf* { return getPixbufFromImageIconName(); }
+
+auto ToolAudioTimeline::newItem() -> GtkToolItem* {
+    GtkWidget* drawingArea = gtk_drawing_area_new();
+    gtk_widget_set_size_request(drawingArea, TIMELINE_WIDTH, TIMELINE_HEIGHT);
+    gtk_widget_set_tooltip_text(drawingArea, _("Click to play the recording from there"));
+    gtk_widget_add_events(drawingArea, GDK_BUTTON_PRESS_MASK);
+    g_signal_connect(drawingArea, "draw", G_CALLBACK(onDraw), this);
+    g_signal_connect(drawingArea, "button-press-event", G_CALLBACK(onButtonPress), this);
+    g_signal_connect(drawingArea, "destroy", G_CALLBACK(+[](GtkWidget* widget, ToolAudioTimeline* self) {
+                         if (self->area == widget) {
+                             self->area = nullptr;
+                         }
+                     }),
+                     this);
+    this->area = drawingArea;
+
+    GtkToolItem* it = gtk_tool_item_new();
+    gtk_container_add(GTK_CONTAINER(it), drawingArea);
+    return it;
+}
@@ -0,0 +1,65 @@
+/*
+ * Xournal++
+ *
+ * Toolbar item showing the waveform of the audio recording
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <string>
+
+#include "gui/IconNameHelper.h"
+
+#include "AbstractToolItem.h"
+
+class Control;
+
+/**
+ * @brief The waveform of the recording being made or last played, with a mark at the time of each element
+ *
+ * A click plays the recording from there, or from the element written right after if its mark is that close. The
+ * waveform comes from the AudioController, which computes it in the background the first time.
+ */
+class ToolAudioTimeline: public AbstractToolItem {
+public:
+    ToolAudioTimeline(ActionHandler* handler, std::string id, ActionType type, Control* control,
+                      IconNameHelper iconNameHelper);
+    ~ToolAudioTimeline() override;
+
+public:
+    /**
+     * Draw again, e.g. once the recording changed or a waveform is available
+     */
+    void update();
+
+    std::string getToolDisplayName() const override;
+
+protected:
+    GtkToolItem* newItem() override;
+    GtkWidget* getNewToolIcon() const override;
+    GdkPixbuf* getNewToolPixbuf() const override;
+
+private:
+    static gboolean onDraw(GtkWidget* widget, cairo_t* cr, ToolAudioTimeline* self);
+    static gboolean onButtonPress(GtkWidget* widget, GdkEventButton* event, ToolAudioTimeline* self);
+    static gboolean onRecordingTick(ToolAudioTimeline* self);
+
+private:
+    Control* control = nullptr;
+    IconNameHelper iconNameHelper;
+
+    /**
+     * The drawing area of the last item created, nullptr once it is destroyed
+     */
+    GtkWidget* area = nullptr;
+
+    /**
+     * Redraws the growing waveform while recording
+     */
+    guint recordingTimeout = 0;
+};
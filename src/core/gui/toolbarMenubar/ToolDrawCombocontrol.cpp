@@ -79,7 +79,7 @@ void ToolDrawCombocontrol::selected(ActionGroup group, ActionType action) {
 
     for (ToolDrawType* t: drawTypes) {
         if (action == t->type && this->action != t->type) {
-            this->action = t->type;
+            setAction(t->type);
             gtk_image_set_from_icon_name(GTK_IMAGE(iconWidget), t->icon.c_str(), GTK_ICON_SIZE_SMALL_TOOLBAR);
             description = t->name;
             break;
@@ -18,6 +18,7 @@
 
 #include "FontButton.h"
 #include "MenuItem.h"
+#include "ToolAudioTimeline.h"
 #include "ToolButton.h"
 #include "ToolDrawCombocontrol.h"
 #include "ToolPageLayer.h"
@@ -501,6 +502,8 @@ void ToolMenuHandler::initToolItems() {
     audioSeekBackwardsButton = new ToolButton(listener, "AUDIO_SEEK_BACKWARDS", ACTION_AUDIO_SEEK_BACKWARDS,
                                               iconName("audio-seek-backwards"), _("Back"));
     addToolItem(audioSeekBackwardsButton);
+    audioTimeline = new ToolAudioTimeline(listener, "AUDIO_TIMELINE", ACTION_AUDIO_TIMELINE, control, iconNameHelper);
+    addToolItem(audioTimeline);
 
     /*
      * Menu Help
@@ -626,4 +629,6 @@ void ToolMenuHandler::setAudioPlaybackPaused(bool paused) {
     gtk_check_menu_item_set_active(GTK_CHECK_MENU_ITEM(gui->get("menuAudioPausePlayback")), paused);
 }
 
+void ToolMenuHandler::updateAudioTimeline() { this->audioTimeline->update(); }
+
 auto ToolMenuHandler::iconName(const char* icon) -> std::string { return iconNameHelper.iconName(icon); }
@@ -24,6 +24,7 @@ class FontButton;
 class GladeGui;
 class ToolbarData;
 class ToolbarModel;
+class ToolAudioTimeline;
 class ToolButton;
 class ToolHandler;
 class ToolPageLayer;
@@ -88,6 +89,11 @@ public:
     void enableAudioPlaybackButtons();
 
     void setAudioPlaybackPaused(bool paused);
+
+    /**
+     * Draw the audio timeline again, e.g. once another recording is played
+     */
+    void updateAudioTimeline();
     std::string iconName(const char* icon);
 
 private:
@@ -113,6 +119,7 @@ private:
     ToolButton* audioStopPlaybackButton = nullptr;
     ToolButton* audioSeekBackwardsButton = nullptr;
     ToolButton* audioSeekForwardsButton = nullptr;
+    ToolAudioTimeline* audioTimeline = nullptr;
 
     ToolPageSpinner* toolPageSpinner = nullptr;
     ToolPageLayer* toolPageLayer = nullptr;
@@ -51,13 +51,13 @@ void ToolPdfCombocontrol::selected(ActionGroup group, ActionType action) {
         string description;
 
         if (action == ACTION_TOOL_SELECT_PDF_TEXT_LINEAR && this->action != ACTION_TOOL_SELECT_PDF_TEXT_LINEAR) {
-            this->action = ACTION_TOOL_SELECT_PDF_TEXT_LINEAR;
+            setAction(ACTION_TOOL_SELECT_PDF_TEXT_LINEAR);
             gtk_image_set_from_icon_name(GTK_IMAGE(iconWidget), toolMenuHandler->iconName("select-pdf-text-ht").c_str(),
                                          GTK_ICON_SIZE_LARGE_TOOLBAR);
 
             description = _("Select PDF Text");
         } else if (action == ACTION_TOOL_SELECT_PDF_TEXT_RECT && this->action != ACTION_TOOL_SELECT_PDF_TEXT_RECT) {
-            this->action = ACTION_TOOL_SELECT_PDF_TEXT_RECT;
+            setAction(ACTION_TOOL_SELECT_PDF_TEXT_RECT);
             gtk_image_set_from_icon_name(GTK_IMAGE(iconWidget),
                                          toolMenuHandler->iconName("select-pdf-text-area").c_str(),
                                          GTK_ICON_SIZE_LARGE_TOOLBAR);
@@ -52,25 +52,25 @@ void ToolSelectCombocontrol::selected(ActionGroup group, ActionType action) {
         string description;
 
         if (action == ACTION_TOOL_SELECT_RECT && this->action != ACTION_TOOL_SELECT_RECT) {
-            this->action = ACTION_TOOL_SELECT_RECT;
+            setAction(ACTION_TOOL_SELECT_RECT);
             gtk_image_set_from_icon_name(GTK_IMAGE(iconWidget), toolMenuHandler->iconName("select-rect").c_str(),
                                          GTK_ICON_SIZE_SMALL_TOOLBAR);
 
             description = _("Select Rectangle");
         } else if (action == ACTION_TOOL_SELECT_REGION && this->action != ACTION_TOOL_SELECT_REGION) {
-            this->action = ACTION_TOOL_SELECT_REGION;
+            setAction(ACTION_TOOL_SELECT_REGION);
             gtk_image_set_from_icon_name(GTK_IMAGE(iconWidget), toolMenuHandler->iconName("select-lasso").c_str(),
                                          GTK_ICON_SIZE_SMALL_TOOLBAR);
 
             description = _("Select Region");
         } else if (action == ACTION_TOOL_SELECT_OBJECT && this->action != ACTION_TOOL_SELECT_OBJECT) {
-            this->action = ACTION_TOOL_SELECT_OBJECT;
+            setAction(ACTION_TOOL_SELECT_OBJECT);
             gtk_image_set_from_icon_name(GTK_IMAGE(iconWidget), toolMenuHandler->iconName("object-select").c_str(),
                                          GTK_ICON_SIZE_SMALL_TOOLBAR);
 
             description = _("Select Object");
         } else if (action == ACTION_TOOL_PLAY_OBJECT && this->action != ACTION_TOOL_PLAY_OBJECT) {
-            this->action = ACTION_TOOL_PLAY_OBJECT;
+            setAction(ACTION_TOOL_PLAY_OBJECT);
             gtk_image_set_from_icon_name(GTK_IMAGE(iconWidget), toolMenuHandler->iconName("object-play").c_str(),
                                          GTK_ICON_SIZE_SMALL_TOOLBAR);
 
@@ -1,6 +1,7 @@
 #include "XournalWidget.h"
 
 #include <cmath>
+#include <utility>
 
 #include <config-debug.h>
 #include <gdk/gdk.h>
@@ -14,6 +15,7 @@
 #include "gui/XournalView.h"
 #include "gui/inputdevices/InputContext.h"
 #include "gui/scroll/ScrollHandling.h"
+#include "util/Profiler.h"
 #include "util/Rectangle.h"
 #include "util/Util.h"
 #include "view/SetsquareView.h"
@@ -29,6 +31,7 @@ static void gtk_xournal_size_allocate(GtkWidget* widget, GtkAllocation* allocati
 static void gtk_xournal_realize(GtkWidget* widget);
 static auto gtk_xournal_draw(GtkWidget* widget, cairo_t* cr) -> gboolean;
 static void gtk_xournal_dispose(GObject* object);
+static void gtk_xournal_drop_frame(GtkXournal* xournal);
 
 auto gtk_xournal_get_type(void) -> GType {
     static GType gtk_xournal_type = 0;
@@ -162,6 +165,15 @@ static void gtk_xournal_size_allocate(GtkWidget* widget, GtkAllocation* allocati
     g_return_if_fail(GTK_IS_XOURNAL(widget));
     g_return_if_fail(allocation != nullptr);
 
+    GtkXournal* xournal = GTK_XOURNAL(widget);
+
+    GtkAllocation previous;
+    gtk_widget_get_allocation(widget, &previous);
+    if (previous.width != allocation->width || previous.height != allocation->height) {
+        // The pages moved
+        gtk_xournal_drop_frame(xournal);
+    }
+
     gtk_widget_set_allocation(widget, allocation);
 
     if (gtk_widget_get_realized(widget)) {
@@ -169,8 +181,6 @@ static void gtk_xournal_size_allocate(GtkWidget* widget, GtkAllocation* allocati
                                allocation->height);
     }
 
-    GtkXournal* xournal = GTK_XOURNAL(widget);
-
     // layout the pages in the XournalWidget
     xournal->layout->layoutPages(allocation->width, allocation->height);
 }
@@ -238,15 +248,46 @@ void gtk_xournal_repaint_area(GtkWidget* widget, int x1, int y1, int x2, int y2)
         return;  // outside visible area
     }
 
+    GtkXournal* xournal = GTK_XOURNAL(widget);
+    if (xournal->frame) {
+        if (!xournal->damage) {
+            xournal->damage = cairo_region_create();
+        }
+        GdkRectangle rect = {x1, y1, x2 - x1, y2 - y1};
+        cairo_region_union_rectangle(xournal->damage, &rect);
+    }
+
     gtk_widget_queue_draw_area(widget, x1, y1, x2 - x1, y2 - y1);
+    xoj::util::Profiler::getInstance().markDrawQueued();
 }
 
-static auto gtk_xournal_draw(GtkWidget* widget, cairo_t* cr) -> gboolean {
-    g_return_val_if_fail(widget != nullptr, false);
-    g_return_val_if_fail(GTK_IS_XOURNAL(widget), false);
+void gtk_xournal_repaint(GtkWidget* widget) {
+    g_return_if_fail(widget != nullptr);
+    g_return_if_fail(GTK_IS_XOURNAL(widget));
 
-    GtkXournal* xournal = GTK_XOURNAL(widget);
+    gtk_xournal_drop_frame(GTK_XOURNAL(widget));
+    gtk_widget_queue_draw(widget);
+}
+
+static void gtk_xournal_drop_frame(GtkXournal* xournal) {
+    if (xournal->frame) {
+        cairo_surface_destroy(xournal->frame);
+        xournal->frame = nullptr;
+    }
+    if (xournal->backFrame) {
+        cairo_surface_destroy(xournal->backFrame);
+        xournal->backFrame = nullptr;
+    }
+    if (xournal->damage) {
+        cairo_region_destroy(xournal->damage);
+        xournal->damage = nullptr;
+    }
+}
 
+/**
+ * The background and the pages within the clip of cr
+ */
+static void gtk_xournal_draw_pages(GtkXournal* xournal, cairo_t* cr) {
     double x1 = NAN, x2 = NAN, y1 = NAN, y2 = NAN;
 
     cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
@@ -259,7 +300,9 @@ static auto gtk_xournal_draw(GtkWidget* widget, cairo_t* cr) -> gboolean {
     // Add a padding for the shadow of the pages
     Rectangle clippingRect(x1 - 10, y1 - 10, x2 - x1 + 20, y2 - y1 + 20);
 
-    for (auto&& pv: xournal->view->getViewPages()) {
+    // Only the pages in the clipping area, which creates their views
+    for (size_t page: xournal->layout->getPagesInArea(clippingRect)) {
+        XojPageView* pv = xournal->view->getViewFor(page);
         int px = pv->getX();
         int py = pv->getY();
         int pw = pv->getDisplayWidth();
@@ -277,6 +320,125 @@ static auto gtk_xournal_draw(GtkWidget* widget, cairo_t* cr) -> gboolean {
         pv->paintPage(cr, nullptr);
         cairo_restore(cr);
     }
+}
+
+/**
+ * @return The visible area, in whole pixels of the widget
+ */
+static auto gtk_xournal_get_visible_rect(GtkWidget* widget) -> GdkRectangle {
+    GtkXournal* xournal = GTK_XOURNAL(widget);
+    GtkAdjustment* hadj = xournal->scrollHandling->getHorizontal();
+    GtkAdjustment* vadj = xournal->scrollHandling->getVertical();
+    double x = gtk_adjustment_get_value(hadj);
+    double y = gtk_adjustment_get_value(vadj);
+
+    GdkRectangle visible;
+    visible.x = static_cast<int>(std::floor(x));
+    visible.y = static_cast<int>(std::floor(y));
+    visible.width = static_cast<int>(std::ceil(x + gtk_adjustment_get_page_size(hadj))) - visible.x;
+    visible.height = static_cast<int>(std::ceil(y + gtk_adjustment_get_page_size(vadj))) - visible.y;
+
+    GtkAllocation alloc;
+    gtk_widget_get_allocation(widget, &alloc);
+    GdkRectangle bounds = {0, 0, alloc.width, alloc.height};
+    if (!gdk_rectangle_intersect(&visible, &bounds, &visible)) {
+        return {0, 0, 0, 0};
+    }
+    return visible;
+}
+
+static auto gtk_xournal_create_frame(GtkWidget* widget, const GdkRectangle& rect, int scale) -> cairo_surface_t* {
+    // The background is opaque
+    return gdk_window_create_similar_image_surface(gtk_widget_get_window(widget), CAIRO_FORMAT_RGB24, rect.width,
+                                                   rect.height, scale);
+}
+
+/**
+ * Brings the frame to the visible area: the part of the previous frame still visible and not damaged is copied, at
+ * its new position, and only the rest is painted
+ */
+static void gtk_xournal_update_frame(GtkWidget* widget, const GdkRectangle& visible) {
+    GtkXournal* xournal = GTK_XOURNAL(widget);
+    int scale = gtk_widget_get_scale_factor(widget);
+
+    bool reusable = xournal->frame && xournal->frameScale == scale && xournal->frameRect.width == visible.width &&
+                    xournal->frameRect.height == visible.height;
+    xoj::util::Profiler::getInstance().countAccess("scroll frame", reusable);
+    if (!reusable) {
+        gtk_xournal_drop_frame(xournal);
+        xournal->frame = gtk_xournal_create_frame(widget, visible, scale);
+        xournal->frameScale = scale;
+    }
+
+    cairo_region_t* repaint = cairo_region_create_rectangle(&visible);
+    if (reusable) {
+        cairo_region_t* reused = cairo_region_create_rectangle(&xournal->frameRect);
+        cairo_region_intersect_rectangle(reused, &visible);
+        if (xournal->damage) {
+            cairo_region_subtract(reused, xournal->damage);
+        }
+        cairo_region_subtract(repaint, reused);
+
+        if ((xournal->frameRect.x != visible.x || xournal->frameRect.y != visible.y) &&
+            !cairo_region_is_empty(reused)) {
+            if (!xournal->backFrame) {
+                xournal->backFrame = gtk_xournal_create_frame(widget, visible, scale);
+            }
+            cairo_t* cr = cairo_create(xournal->backFrame);
+            cairo_translate(cr, -visible.x, -visible.y);
+            gdk_cairo_region(cr, reused);
+            cairo_clip(cr);
+            cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+            cairo_set_source_surface(cr, xournal->frame, xournal->frameRect.x, xournal->frameRect.y);
+            cairo_paint(cr);
+            cairo_destroy(cr);
+            std::swap(xournal->frame, xournal->backFrame);
+        }
+        cairo_region_destroy(reused);
+    }
+
+    if (!cairo_region_is_empty(repaint)) {
+        xoj::util::Profiler::Scope scope("exposed area", "paint");
+        cairo_t* cr = cairo_create(xournal->frame);
+        cairo_translate(cr, -visible.x, -visible.y);
+        gdk_cairo_region(cr, repaint);
+        cairo_clip(cr);
+        gtk_xournal_draw_pages(xournal, cr);
+        cairo_destroy(cr);
+    }
+    cairo_region_destroy(repaint);
+
+    xournal->frameRect = visible;
+    if (xournal->damage) {
+        cairo_region_destroy(xournal->damage);
+        xournal->damage = nullptr;
+    }
+}
+
+static auto gtk_xournal_draw(GtkWidget* widget, cairo_t* cr) -> gboolean {
+    g_return_val_if_fail(widget != nullptr, false);
+    g_return_val_if_fail(GTK_IS_XOURNAL(widget), false);
+
+    GtkXournal* xournal = GTK_XOURNAL(widget);
+    xoj::util::Profiler::Scope frame("frame", "paint");
+
+    double x1 = NAN, x2 = NAN, y1 = NAN, y2 = NAN;
+
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+
+    GdkRectangle visible = gtk_xournal_get_visible_rect(widget);
+    if (x1 >= visible.x && y1 >= visible.y && x2 <= visible.x + visible.width && y2 <= visible.y + visible.height &&
+        visible.width > 0 && visible.height > 0) {
+        gtk_xournal_update_frame(widget, visible);
+        cairo_set_source_surface(cr, xournal->frame, visible.x, visible.y);
+        cairo_paint(cr);
+    } else {
+        // Outside of the visible area, e.g. while the adjustments are updated
+        gtk_xournal_draw_pages(xournal, cr);
+    }
+
+    // Add a padding for the shadow of the pages
+    Rectangle clippingRect(x1 - 10, y1 - 10, x2 - x1 + 20, y2 - y1 + 20);
 
     if (xournal->selection) {
         cairo_save(cr);
@@ -302,6 +464,11 @@ static auto gtk_xournal_draw(GtkWidget* widget, cairo_t* cr) -> gboolean {
         }
     }
 
+    xoj::util::Profiler::getInstance().markPainted();
+    if (xournal->view->isProfilerOverlayVisible()) {
+        xournal->view->paintProfilerOverlay(cr);
+    }
+
     return true;
 }
 
@@ -315,6 +482,8 @@ static void gtk_xournal_dispose(GObject* object) {
 
     xournal->setsquareView = nullptr;
 
+    gtk_xournal_drop_frame(xournal);
+
     delete xournal->layout;
     xournal->layout = nullptr;
 
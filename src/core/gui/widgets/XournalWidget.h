@@ -66,6 +66,25 @@ struct _GtkXournal {
      * Input handling
      */
     InputContext* input = nullptr;
+
+    /**
+     * The background and the pages of the visible area, as last painted, reused while scrolling: only the uncovered
+     * area and the damaged one are painted again. The selection, the setsquare and the overlay are painted over it.
+     */
+    cairo_surface_t* frame = nullptr;
+    /**
+     * Where the next frame is painted from the previous one, as they can not overlap
+     */
+    cairo_surface_t* backFrame = nullptr;
+    /**
+     * The visible area of the frame, in the coordinates of the widget
+     */
+    GdkRectangle frameRect;
+    int frameScale;
+    /**
+     * Repainted since the last frame, see gtk_xournal_repaint_area()
+     */
+    cairo_region_t* damage = nullptr;
 };
 
 struct _GtkXournalClass {
@@ -82,6 +101,11 @@ void gtk_xournal_scroll_relative(GtkWidget* widget, double x, double y);
 
 void gtk_xournal_repaint_area(GtkWidget* widget, int x1, int y1, int x2, int y2);
 
+/**
+ * Repaints the whole widget, without reusing the last frame
+ */
+void gtk_xournal_repaint(GtkWidget* widget);
+
 xoj::util::Rectangle<double>* gtk_xournal_get_visible_area(GtkWidget* widget, XojPageView* p);
 
 G_END_DECLS
@@ -2,13 +2,32 @@
 
 #include <utility>
 
+#include "util/InternTable.h"
+
+namespace {
+struct PathHash {
+    auto operator()(const fs::path& path) const -> size_t { return fs::hash_value(path); }
+};
+
+using AudioFilenames = xoj::util::InternTable<fs::path, PathHash>;
+}  // namespace
+
 AudioElement::AudioElement(ElementType type): Element(type) {}
 
 AudioElement::~AudioElement() { this->timestamp = 0; }
 
-void AudioElement::setAudioFilename(fs::path fn) { this->audioFilename = std::move(fn); }
+void AudioElement::setAudioFilename(fs::path fn) {
+    if (fn.empty()) {
+        this->audioFilename.reset();
+    } else {
+        this->audioFilename = AudioFilenames::instance().intern(std::move(fn));
+    }
+}
 
-auto AudioElement::getAudioFilename() const -> fs::path const& { return this->audioFilename; }
+auto AudioElement::getAudioFilename() const -> fs::path const& {
+    static const fs::path none{};
+    return this->audioFilename ? *this->audioFilename : none;
+}
 
 void AudioElement::setTimestamp(size_t timestamp) { this->timestamp = timestamp; }
 
@@ -19,7 +38,7 @@ void AudioElement::serialize(ObjectOutputStream& out) const {
 
     this->Element::serialize(out);
 
-    out.writeString(this->audioFilename.u8string());
+    out.writeString(getAudioFilename().u8string());
     out.writeSizeT(this->timestamp);
 
     out.endObject();
@@ -30,7 +49,7 @@ void AudioElement::readSerialized(ObjectInputStream& in) {
 
     this->Element::readSerialized(in);
 
-    this->audioFilename = in.readString();
+    setAudioFilename(in.readString());
     this->timestamp = in.readSizeT();
 
     in.endObject();
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -46,5 +47,7 @@ protected:
 private:
     // Stroke timestamp, to match it to the audio stream
     size_t timestamp = 0;
-    fs::path audioFilename{};
+    // Held apart: most elements have no audio, and the page iterations do not read it. Interned: the elements
+    // recorded with the same audio file share its path, see xoj::util::InternTable.
+    std::shared_ptr<const fs::path> audioFilename;
 };
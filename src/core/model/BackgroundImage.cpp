@@ -1,5 +1,7 @@
 #include "BackgroundImage.h"
 
+#include <mutex>
+
 #include "util/Stacktrace.h"
 
 /*
@@ -18,6 +20,9 @@ struct BackgroundImage::Content {
     Content(GInputStream* stream, fs::path path, GError** error):
             path(std::move(path)), pixbuf(gdk_pixbuf_new_from_stream(stream, nullptr, error)) {}
 
+    Content(GdkPixbuf* pixbuf, fs::path path, bool attach):
+            path(std::move(path)), pixbuf(pixbuf ? GDK_PIXBUF(g_object_ref(pixbuf)) : nullptr), attach(attach) {}
+
     ~Content() {
         g_object_unref(this->pixbuf);
         this->pixbuf = nullptr;
@@ -54,6 +59,10 @@ void BackgroundImage::loadFile(GInputStream* stream, fs::path const& path, GErro
     this->img = std::make_shared<Content>(stream, path, error);
 }
 
+void BackgroundImage::loadPixbuf(GdkPixbuf* pixbuf, fs::path const& path) {
+    this->img = std::make_shared<Content>(pixbuf, path, false);
+}
+
 auto BackgroundImage::getCloneId() -> int { return this->img ? this->img->pageId : -1; }
 
 void BackgroundImage::setCloneId(int id) {
@@ -64,6 +73,14 @@ void BackgroundImage::setCloneId(int id) {
 
 void BackgroundImage::clearSaveState() { this->setCloneId(-1); }
 
+auto BackgroundImage::cloneSaveState() const -> BackgroundImage {
+    BackgroundImage copy;
+    if (this->img) {
+        copy.img = std::make_shared<Content>(this->img->pixbuf, this->img->path, this->img->attach);
+    }
+    return copy;
+}
+
 auto BackgroundImage::getFilepath() const -> fs::path { return this->img ? this->img->path : fs::path{}; }
 
 void BackgroundImage::setFilepath(fs::path path) {
@@ -85,4 +102,30 @@ void BackgroundImage::setAttach(bool attach) {
 
 auto BackgroundImage::getPixbuf() const -> GdkPixbuf* { return this->img ? this->img->pixbuf : nullptr; }
 
+auto BackgroundImage::getMipmap() const -> const xoj::util::Mipmap* {
+    GdkPixbuf* pixbuf = getPixbuf();
+    if (!pixbuf) {
+        return nullptr;
+    }
+
+    // Kept along with the pixbuf, which the copies of the image share
+    static constexpr auto MIPMAP_KEY = "xournalpp-mipmap";
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto* mipmap = static_cast<xoj::util::Mipmap*>(g_object_get_data(G_OBJECT(pixbuf), MIPMAP_KEY));
+    if (!mipmap) {
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, gdk_pixbuf_get_width(pixbuf),
+                                                              gdk_pixbuf_get_height(pixbuf));
+        cairo_t* cr = cairo_create(surface);
+        gdk_cairo_set_source_pixbuf(cr, pixbuf, 0, 0);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+        mipmap = new xoj::util::Mipmap(surface);
+        cairo_surface_destroy(surface);
+        g_object_set_data_full(G_OBJECT(pixbuf), MIPMAP_KEY, mipmap,
+                               [](gpointer mipmap) { delete static_cast<xoj::util::Mipmap*>(mipmap); });
+    }
+    return mipmap;
+}
+
 auto BackgroundImage::isEmpty() const -> bool { return !this->img; }
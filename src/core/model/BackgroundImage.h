@@ -17,6 +17,8 @@
 
 #include <gtk/gtk.h>
 
+#include "util/Mipmap.h"
+
 #include "filesystem.h"
 
 struct BackgroundImage {
@@ -36,10 +38,20 @@ struct BackgroundImage {
     void loadFile(fs::path const& filepath, GError** error);
     void loadFile(GInputStream* stream, fs::path const& filepath, GError** error);
 
+    /**
+     * Uses a pixbuf already decoded, e.g. downscaled by another thread. Takes a reference to it.
+     */
+    void loadPixbuf(GdkPixbuf* pixbuf, fs::path const& filepath);
+
     int getCloneId();
     void setCloneId(int id);
     void clearSaveState();
 
+    /**
+     * @return A copy of the image with a save state of its own, which shares the pixels with this image
+     */
+    BackgroundImage cloneSaveState() const;
+
     fs::path getFilepath() const;
     void setFilepath(fs::path filepath);
 
@@ -48,6 +60,13 @@ struct BackgroundImage {
 
     GdkPixbuf* getPixbuf() const;
 
+    /**
+     * @return The surface of the pixbuf and its downscaled copies, created once and shared by all the pages with this
+     *         image: it is drawn without converting the pixbuf again, and written once by the PDF export. nullptr if
+     *         there is no image.
+     */
+    const xoj::util::Mipmap* getMipmap() const;
+
     bool isEmpty() const;
 
 private:
@@ -0,0 +1,95 @@
+#include "CompactPoints.h"
+
+std::mutex CompactPoints::mutex;
+
+CompactPoints::CompactPoints(const CompactPoints& other) { *this = other; }
+
+CompactPoints::CompactPoints(CompactPoints&& other) noexcept:
+        data(other.data.exchange(nullptr, std::memory_order_acq_rel)) {}
+
+auto CompactPoints::operator=(const CompactPoints& other) -> CompactPoints& {
+    if (this == &other) {
+        return *this;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Data* shared = other.data.load(std::memory_order_acquire);
+    if (shared) {
+        shared->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    release(this->data.exchange(shared, std::memory_order_acq_rel));
+    return *this;
+}
+
+auto CompactPoints::operator=(CompactPoints&& other) noexcept -> CompactPoints& {
+    if (this != &other) {
+        Data* moved = other.data.exchange(nullptr, std::memory_order_acq_rel);
+        release(this->data.exchange(moved, std::memory_order_acq_rel));
+    }
+    return *this;
+}
+
+CompactPoints::~CompactPoints() { release(this->data.load(std::memory_order_acquire)); }
+
+void CompactPoints::release(Data* d) {
+    if (d && d->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete d;
+    }
+}
+
+void CompactPoints::pack(xoj::util::CowVector<Point>& points) {
+    if (points.empty() || isPacked()) {
+        return;
+    }
+
+    auto* d = new Data();
+    d->x.reserve(points.size());
+    d->y.reserve(points.size());
+    bool pressure = points.front().z != Point::NO_PRESSURE;
+    if (pressure) {
+        d->z.reserve(points.size());
+    }
+
+    for (const Point& p: points) {
+        d->x.push_back(static_cast<float>(p.x));
+        d->y.push_back(static_cast<float>(p.y));
+        if (pressure) {
+            d->z.push_back(static_cast<float>(p.z));
+        }
+    }
+
+    // The clones sharing the points keep them
+    points.clear();
+    this->data.store(d, std::memory_order_release);
+}
+
+void CompactPoints::unpackSlow(xoj::util::CowVector<Point>& points) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Data* d = this->data.load(std::memory_order_acquire);
+    if (!d) {
+        // Unpacked by another thread in the meantime
+        return;
+    }
+
+    std::vector<Point>& unpacked = points.mut();
+    unpacked.clear();
+    unpacked.reserve(d->x.size());
+    for (size_t i = 0; i < d->x.size(); i++) {
+        unpacked.emplace_back(d->x[i], d->y[i], d->z.empty() ? Point::NO_PRESSURE : d->z[i]);
+    }
+
+    this->data.store(nullptr, std::memory_order_release);
+    release(d);
+}
+
+auto CompactPoints::isPacked() const -> bool { return this->data.load(std::memory_order_acquire) != nullptr; }
+
+auto CompactPoints::getMemoryUsage() const -> size_t {
+    Data* d = this->data.load(std::memory_order_acquire);
+    if (!d) {
+        return 0;
+    }
+    return sizeof(Data) + (d->x.capacity() + d->y.capacity() + d->z.capacity()) * sizeof(float);
+}
+
+void CompactPoints::clear() { release(this->data.exchange(nullptr, std::memory_order_acq_rel)); }
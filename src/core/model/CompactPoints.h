@@ -0,0 +1,90 @@
+/*
+ * Xournal++
+ *
+ * The points of a stroke, packed in memory
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "util/CowVector.h"
+
+#include "Point.h"
+
+/**
+ * @brief Keeps the points of a stroke which is not used as floats, in a structure of arrays
+ *
+ * A Point takes 24 bytes. Packed, a point takes 8 bytes, or 12 if the stroke has a pressure: the z array is only
+ * stored when the first point has a pressure. Packing rounds the coordinates to float precision (about 1e-4 pt on a
+ * page of 1000 pt), so that a stroke can be packed and unpacked repeatedly without drifting further.
+ *
+ * The points are unpacked on the first access, by any thread: see unpack(). The copies share the packed points, which
+ * are immutable.
+ */
+class CompactPoints {
+public:
+    CompactPoints() = default;
+    CompactPoints(const CompactPoints& other);
+    CompactPoints(CompactPoints&& other) noexcept;
+    CompactPoints& operator=(const CompactPoints& other);
+    CompactPoints& operator=(CompactPoints&& other) noexcept;
+    ~CompactPoints();
+
+public:
+    /**
+     * Pack the points, and free the vector
+     */
+    void pack(xoj::util::CowVector<Point>& points);
+
+    /**
+     * Restore the points into the vector if they are packed. Can be called by several threads at once.
+     */
+    void unpack(xoj::util::CowVector<Point>& points) {
+        if (this->data.load(std::memory_order_acquire)) {
+            unpackSlow(points);
+        }
+    }
+
+    bool isPacked() const;
+
+    /**
+     * @return The number of bytes of the packed points
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * Drop the packed points, e.g. when the points are replaced
+     */
+    void clear();
+
+private:
+    void unpackSlow(xoj::util::CowVector<Point>& points);
+
+private:
+    struct Data {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+
+        /// The CompactPoints sharing the data
+        std::atomic<int> refs{1};
+    };
+
+    static void release(Data* d);
+
+    std::atomic<Data*> data{nullptr};
+
+    /**
+     * Serializes the unpacking, which is rare: the packed points of all the strokes share it
+     */
+    static std::mutex mutex;
+};
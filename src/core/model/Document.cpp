@@ -1,12 +1,15 @@
 #include "Document.h"
 
 #include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <utility>
 
 #include <config.h>
 
 #include "pdf/base/XojPdfAction.h"
 #include "util/PathUtil.h"
+#include "util/Profiler.h"
 #include "util/Stacktrace.h"
 #include "util/Util.h"
 #include "util/i18n.h"
@@ -30,6 +33,7 @@ void Document::freeTreeContentModel() {
         g_object_unref(this->contentsModel);
         this->contentsModel = nullptr;
     }
+    this->outlineRows.clear();
 }
 
 auto Document::freeTreeContentEntry(GtkTreeModel* treeModel, GtkTreePath* path, GtkTreeIter* iter, Document* doc)
@@ -48,36 +52,97 @@ auto Document::freeTreeContentEntry(GtkTreeModel* treeModel, GtkTreePath* path,
     return false;
 }
 
-void Document::lock() {
-    this->documentLock.lock();
+/**
+ * Takes a lock with tryLock() if possible, otherwise waits in lock() and records the time waited
+ */
+template <class TryLock, class Lock>
+static void takeLock(std::atomic<uint64_t>& contended, std::atomic<int64_t>& waitNs, TryLock tryLock, Lock lock) {
+    if (tryLock()) {
+        return;
+    }
+    auto start = xoj::util::Profiler::Clock::now();
+    lock();
+    auto waited = xoj::util::Profiler::Clock::now() - start;
 
-    //	if(tryLock()) {
-    //		fprintf(stderr, "Locked by\n");
-    //		Stacktrace::printStracktrace();
-    //		fprintf(stderr, "\n\n\n\n");
-    //	} else {
-    //		g_mutex_lock(&this->documentLock);
-    //	}
+    contended++;
+    waitNs += std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count();
+    xoj::util::Profiler::getInstance().addTiming("document lock wait", "lock", start, waited);
 }
 
-void Document::unlock() {
-    this->documentLock.unlock();
-
-    //	fprintf(stderr, "Unlocked by\n");
-    //	Stacktrace::printStracktrace();
-    //	fprintf(stderr, "\n\n\n\n");
+void Document::lock() {
+    this->exclusiveLocks++;
+    takeLock(
+            this->contendedLocks, this->lockWaitNs, [this] { return this->documentLock.try_lock(); },
+            [this] { this->documentLock.lock(); });
 }
 
+void Document::unlock() { this->documentLock.unlock(); }
+
 /*
 ** Returns true when successfully acquiring lock.
 */
 auto Document::tryLock() -> bool { return this->documentLock.try_lock(); }
 
+void Document::lockShared() {
+    this->sharedLocks++;
+    takeLock(
+            this->contendedLocks, this->lockWaitNs, [this] { return this->documentLock.try_lock_shared(); },
+            [this] { this->documentLock.lock_shared(); });
+}
+
+void Document::unlockShared() { this->documentLock.unlock_shared(); }
+
+void Document::lockPage(const XojPage& page) {
+    this->pageLocks++;
+    // Always in this order: the document, then the page
+    takeLock(
+            this->contendedLocks, this->lockWaitNs, [this] { return this->documentLock.try_lock_shared(); },
+            [this] { this->documentLock.lock_shared(); });
+    takeLock(
+            this->contendedLocks, this->lockWaitNs, [&page] { return page.contentMutex.try_lock(); },
+            [&page] { page.contentMutex.lock(); });
+}
+
+void Document::unlockPage(const XojPage& page) {
+    page.contentMutex.unlock();
+    this->documentLock.unlock_shared();
+}
+
+auto Document::lockSnapshot(XojPage& page, const xoj::util::Rectangle<double>& area) -> PageSnapshot {
+    lockPage(page);
+    // Taken with the page lock: waitForSnapshots() may be called with it
+    this->snapshotLock.lock_shared();
+    PageSnapshot snapshot(page, area);
+    page.contentMutex.unlock();
+    return snapshot;
+}
+
+void Document::unlockSnapshot() {
+    this->snapshotLock.unlock_shared();
+    this->documentLock.unlock_shared();
+}
+
+void Document::waitForSnapshots() {
+    this->snapshotLock.lock();
+    this->snapshotLock.unlock();
+}
+
+auto Document::getLockStatistics() const -> LockStatistics {
+    LockStatistics statistics;
+    statistics.exclusive = this->exclusiveLocks;
+    statistics.shared = this->sharedLocks;
+    statistics.page = this->pageLocks;
+    statistics.contended = this->contendedLocks;
+    statistics.waitedMs = static_cast<double>(this->lockWaitNs) / 1e6;
+    return statistics;
+}
+
 void Document::clearDocument(bool destroy) {
     if (this->preview) {
         cairo_surface_destroy(this->preview);
         this->preview = nullptr;
     }
+    this->previewPage.reset();
 
     if (!destroy) {
         // release lock
@@ -93,9 +158,11 @@ void Document::clearDocument(bool destroy) {
     this->pages.clear();
     this->pageIndex.reset();
     freeTreeContentModel();
+    this->outlineOutdated = false;
 
     this->filepath = fs::path{};
     this->pdfFilepath = fs::path{};
+    this->pdfAttachmentSource = PdfAttachmentSource{};
 }
 
 /**
@@ -163,6 +230,17 @@ void Document::setPreview(cairo_surface_t* preview) {
     } else {
         this->preview = nullptr;
     }
+    this->previewPage.reset();
+}
+
+void Document::setPreview(cairo_surface_t* preview, const PageRef& page, uint64_t revision) {
+    setPreview(preview);
+    this->previewPage = page;
+    this->previewRevision = revision;
+}
+
+auto Document::isPreviewUpToDate(const PageRef& page) const -> bool {
+    return this->preview && this->previewPage.lock() == page && page->getRevision() == this->previewRevision;
 }
 
 auto Document::getEvMetadataFilename() const -> fs::path {
@@ -177,6 +255,10 @@ auto Document::getEvMetadataFilename() const -> fs::path {
 
 auto Document::isAttachPdf() const -> bool { return this->attachPdf; }
 
+void Document::setPdfAttachmentSource(PdfAttachmentSource source) { this->pdfAttachmentSource = std::move(source); }
+
+auto Document::getPdfAttachmentSource() const -> const PdfAttachmentSource& { return this->pdfAttachmentSource; }
+
 auto Document::findPdfPage(size_t pdfPage) -> size_t {
     // Create a page index if not already indexed.
     if (!this->pageIndex)
@@ -189,10 +271,29 @@ auto Document::findPdfPage(size_t pdfPage) -> size_t {
     }
 }
 
-void Document::buildTreeContentsModel(GtkTreeIter* parent, XojPdfBookmarkIterator* iter) {
-    do {
-        GtkTreeIter treeIter = {0};
+Document::OutlineEntry::OutlineEntry(OutlineEntry&& other) noexcept:
+        titleMarkup(std::move(other.titleMarkup)),
+        link(std::exchange(other.link, nullptr)),
+        children(std::move(other.children)) {}
+
+auto Document::OutlineEntry::operator=(OutlineEntry&& other) noexcept -> OutlineEntry& {
+    std::swap(this->titleMarkup, other.titleMarkup);
+    std::swap(this->link, other.link);
+    std::swap(this->children, other.children);
+    return *this;
+}
 
+Document::OutlineEntry::~OutlineEntry() {
+    if (this->link) {
+        // Same workaround as in freeTreeContentEntry()
+        delete this->link->dest;
+        this->link->dest = nullptr;
+        g_object_unref(this->link);
+    }
+}
+
+static void readOutlineLevel(XojPdfBookmarkIterator* iter, std::vector<Document::OutlineEntry>& entries) {
+    do {
         XojPdfAction* action = iter->getAction();
         XojLinkDest* link = action->getDestination();
 
@@ -204,18 +305,15 @@ void Document::buildTreeContentsModel(GtkTreeIter* parent, XojPdfBookmarkIterato
 
         link->dest->setExpand(iter->isOpen());
 
-        gtk_tree_store_append(GTK_TREE_STORE(contentsModel), &treeIter, parent);
+        Document::OutlineEntry& entry = entries.emplace_back();
         char* titleMarkup = g_markup_escape_text(action->getTitle().c_str(), -1);
-
-        gtk_tree_store_set(GTK_TREE_STORE(contentsModel), &treeIter, DOCUMENT_LINKS_COLUMN_NAME, titleMarkup,
-                           DOCUMENT_LINKS_COLUMN_LINK, link, DOCUMENT_LINKS_COLUMN_PAGE_NUMBER, "", -1);
-
+        entry.titleMarkup = titleMarkup;
         g_free(titleMarkup);
-        g_object_unref(link);
+        entry.link = link;
 
         XojPdfBookmarkIterator* child = iter->getChildIter();
         if (child) {
-            buildTreeContentsModel(&treeIter, child);
+            readOutlineLevel(child, entry.children);
             delete child;
         }
 
@@ -224,91 +322,158 @@ void Document::buildTreeContentsModel(GtkTreeIter* parent, XojPdfBookmarkIterato
     } while (iter->next());
 }
 
-void Document::indexPdfPages() {
-    auto index = std::make_unique<PageIndex>();
-    for (size_t i = 0; i < this->pages.size(); ++i) {
-        const auto& p = this->pages[i];
-        if (p->getBackgroundType().isPdfPage()) {
-            index->emplace(p->getPdfPageNr(), i);
-        }
+auto Document::readOutline(const XojPdfDocument& pdf) -> std::vector<OutlineEntry> {
+    std::vector<OutlineEntry> outline;
+    XojPdfBookmarkIterator* iter = pdf.getContentsIter();
+    if (iter == nullptr) {
+        // No Bookmarks
+        return outline;
     }
-    this->pageIndex.swap(index);
+    readOutlineLevel(iter, outline);
+    delete iter;
+    return outline;
 }
 
+void Document::buildTreeContentsModel(GtkTreeIter* parent, std::vector<OutlineEntry>& entries) {
+    for (OutlineEntry& entry: entries) {
+        GtkTreeIter treeIter = {0};
+        gtk_tree_store_append(GTK_TREE_STORE(contentsModel), &treeIter, parent);
+        gtk_tree_store_set(GTK_TREE_STORE(contentsModel), &treeIter, DOCUMENT_LINKS_COLUMN_NAME,
+                           entry.titleMarkup.c_str(), DOCUMENT_LINKS_COLUMN_LINK, entry.link,
+                           DOCUMENT_LINKS_COLUMN_PAGE_NUMBER, "", -1);
+        this->outlineRows.push_back({treeIter, entry.link->dest->getPdfPage(), npos});
 
-void Document::buildContentsModel() {
-    freeTreeContentModel();
+        // The model holds the link now
+        g_object_unref(std::exchange(entry.link, nullptr));
 
-    XojPdfBookmarkIterator* iter = pdfDocument.getContentsIter();
-    if (iter == nullptr) {
-        // No Bookmarks
-        return;
+        buildTreeContentsModel(&treeIter, entry.children);
+    }
+}
+
+auto Document::setOutline(XojPdfDocument pdf, std::vector<OutlineEntry> outline) -> bool {
+    if (!this->outlineOutdated || !(pdf == this->pdfDocument)) {
+        return false;
+    }
+    this->outlineOutdated = false;
+
+    freeTreeContentModel();
+    if (outline.empty()) {
+        return true;
     }
 
     this->contentsModel = reinterpret_cast<GtkTreeModel*>(
             gtk_tree_store_new(4, G_TYPE_STRING, G_TYPE_OBJECT, G_TYPE_BOOLEAN, G_TYPE_STRING));
-    buildTreeContentsModel(nullptr, iter);
-    delete iter;
+    buildTreeContentsModel(nullptr, outline);
+    updateIndexPageNumbers();
+    return true;
 }
 
-auto Document::getContentsModel() const -> GtkTreeModel* { return this->contentsModel; }
+auto Document::isOutlineOutdated() const -> bool { return this->outlineOutdated; }
 
-auto Document::fillPageLabels(GtkTreeModel* treeModel, GtkTreePath* path, GtkTreeIter* iter, Document* doc) -> bool {
-    XojLinkDest* link = nullptr;
-    gtk_tree_model_get(treeModel, iter, DOCUMENT_LINKS_COLUMN_LINK, &link, -1);
-
-    if (link == nullptr) {
-        return false;
+void Document::buildContentsModel() {
+    if (this->outlineOutdated) {
+        setOutline(this->pdfDocument, readOutline(this->pdfDocument));
     }
+}
 
-    auto page = doc->findPdfPage(link->dest->getPdfPage());
+auto Document::getContentsModel() const -> GtkTreeModel* { return this->contentsModel; }
 
-    gchar* pageLabel = nullptr;
-    if (page != npos) {
-        pageLabel = g_strdup_printf("%zu", page + 1);
-    }
-    gtk_tree_store_set(GTK_TREE_STORE(treeModel), iter, DOCUMENT_LINKS_COLUMN_PAGE_NUMBER, pageLabel, -1);
-    g_free(pageLabel);
+void Document::updateIndexPageNumbers() {
+    for (OutlineRow& row: this->outlineRows) {
+        size_t page = findPdfPage(row.pdfPage);
+        if (page == row.page) {
+            continue;
+        }
+        row.page = page;
 
-    g_object_unref(link);
-    return false;
+        gchar* pageLabel = nullptr;
+        if (page != npos) {
+            pageLabel = g_strdup_printf("%zu", page + 1);
+        }
+        gtk_tree_store_set(GTK_TREE_STORE(this->contentsModel), &row.iter, DOCUMENT_LINKS_COLUMN_PAGE_NUMBER, pageLabel,
+                           -1);
+        g_free(pageLabel);
+    }
 }
 
-void Document::updateIndexPageNumbers() {
-    if (this->contentsModel != nullptr) {
-        gtk_tree_model_foreach(this->contentsModel, reinterpret_cast<GtkTreeModelForeachFunc>(fillPageLabels), this);
+void Document::indexPdfPages() {
+    auto index = std::make_unique<PageIndex>();
+    for (size_t i = 0; i < this->pages.size(); ++i) {
+        const auto& p = this->pages[i];
+        if (p->getBackgroundType().isPdfPage()) {
+            index->emplace(p->getPdfPageNr(), i);
+        }
     }
+    this->pageIndex.swap(index);
 }
 
+void Document::setPdfDocumentPool(XojPdfDocumentPool* pool) { this->pdfDocumentPool = pool; }
+
 auto Document::readPdf(const fs::path& filename, bool initPages, bool attachToDocument, gpointer data, gsize length)
         -> bool {
+    return loadPdf(filename, initPages, attachToDocument, [&](GError** error) {
+        if (data != nullptr) {
+            return pdfDocument.load(data, length, password, error);
+        }
+        if (this->pdfDocumentPool && password.empty() && this->pdfDocumentPool->get(filename, pdfDocument)) {
+            return true;
+        }
+        if (!pdfDocument.load(filename, password, error)) {
+            return false;
+        }
+        if (this->pdfDocumentPool && password.empty()) {
+            this->pdfDocumentPool->put(filename, pdfDocument);
+        }
+        return true;
+    });
+}
+
+auto Document::readMappedPdf(const fs::path& filename, const fs::path& file, bool attachToDocument) -> bool {
+    return loadPdf(filename, false, attachToDocument,
+                   [&](GError** error) { return pdfDocument.loadMapped(file, password, error); });
+}
+
+void Document::setPdfFrom(const Document& other) {
+    this->pdfDocument = other.pdfDocument;
+    this->pdfFilepath = other.pdfFilepath;
+    this->attachPdf = other.attachPdf;
+    this->pdfAttachmentSource = other.pdfAttachmentSource;
+
+    this->pageIndex.reset();
+    freeTreeContentModel();
+    this->outlineOutdated = true;
+}
+
+void Document::reloadPdf(XojPdfDocument pdf) {
+    this->pdfDocument = std::move(pdf);
+    if (this->pdfDocumentPool) {
+        this->pdfDocumentPool->put(this->pdfFilepath, this->pdfDocument);
+    }
+
+    freeTreeContentModel();
+    this->outlineOutdated = true;
+}
+
+auto Document::loadPdf(const fs::path& filename, bool initPages, bool attachToDocument,
+                       const std::function<bool(GError**)>& load) -> bool {
+    xoj::util::Profiler::Scope scope("open pdf", "load");
     GError* popplerError = nullptr;
 
     lock();
 
-    if (data != nullptr) {
-        if (!pdfDocument.load(data, length, password, &popplerError)) {
-            lastError = FS(_F("Document not loaded! ({1}), {2}") % filename.u8string() % popplerError->message);
+    if (!load(&popplerError)) {
+        lastError = FS(_F("Document not loaded! ({1}), {2}") % filename.u8string() %
+                       (popplerError ? popplerError->message : ""));
+        if (popplerError) {
             g_error_free(popplerError);
-            unlock();
-
-            return false;
-        }
-    } else {
-        if (!pdfDocument.load(filename, password, &popplerError)) {
-            if (popplerError) {
-                lastError = FS(_F("Document not loaded! ({1}), {2}") % filename.u8string() % popplerError->message);
-                g_error_free(popplerError);
-            } else {
-                lastError = FS(_F("Document not loaded! ({1}), {2}") % filename.u8string() % "");
-            }
-            unlock();
-            return false;
         }
+        unlock();
+        return false;
     }
 
     this->pdfFilepath = filename;
     this->attachPdf = attachToDocument;
+    this->pdfAttachmentSource = PdfAttachmentSource{};
     lastError = "";
 
     if (initPages) {
@@ -325,8 +490,9 @@ auto Document::readPdf(const fs::path& filename, bool initPages, bool attachToDo
     }
 
     indexPdfPages();
-    buildContentsModel();
-    updateIndexPageNumbers();
+    // Read on demand, it takes a while on large outlines
+    freeTreeContentModel();
+    this->outlineOutdated = true;
 
     unlock();
 
@@ -397,6 +563,41 @@ auto Document::getPdfPage(size_t page) const -> XojPdfPageSPtr { return this->pd
 
 auto Document::getPdfDocument() const -> const XojPdfDocument& { return this->pdfDocument; }
 
+auto Document::snapshot() const -> std::unique_ptr<Document> {
+    // The snapshot is not shown, nobody listens to it
+    static DocumentHandler snapshotHandler;
+
+    auto copy = std::make_unique<Document>(&snapshotHandler);
+    copy->pdfDocument = this->pdfDocument;
+    copy->filepath = this->filepath;
+    copy->pdfFilepath = this->pdfFilepath;
+    copy->attachPdf = this->attachPdf;
+    copy->pdfAttachmentSource = this->pdfAttachmentSource;
+    copy->password = this->password;
+    copy->createBackupOnSave = this->createBackupOnSave;
+    copy->setPreview(this->preview);
+    // E.g. for the outline of an exported PDF
+    copy->outlineOutdated = this->outlineOutdated || this->contentsModel != nullptr;
+
+    // Saving writes its state into the background images: the copies share them among themselves, not with this
+    // document
+    std::vector<std::pair<BackgroundImage, BackgroundImage>> images;
+    copy->pages.reserve(this->pages.size());
+    for (const PageRef& p: this->pages) {
+        BackgroundImage img = p->getBackgroundImage();
+        if (!img.isEmpty()) {
+            auto it = std::find_if(images.begin(), images.end(), [&img](auto& known) { return known.first == img; });
+            if (it == images.end()) {
+                images.emplace_back(img, img.cloneSaveState());
+                it = std::prev(images.end());
+            }
+            img = it->second;
+        }
+        copy->pages.emplace_back(p->snapshot(std::move(img)));
+    }
+    return copy;
+}
+
 auto Document::operator=(const Document& doc) -> Document& {
     clearDocument();
 
@@ -406,12 +607,13 @@ auto Document::operator=(const Document& doc) -> Document& {
     this->password = doc.password;
     this->createBackupOnSave = doc.createBackupOnSave;
     this->pdfFilepath = doc.pdfFilepath;
+    this->pdfAttachmentSource = doc.pdfAttachmentSource;
     this->filepath = doc.filepath;
     this->pages = doc.pages;
 
     indexPdfPages();
-    buildContentsModel();
-    updateIndexPageNumbers();
+    freeTreeContentModel();
+    this->outlineOutdated = doc.outlineOutdated || doc.contentsModel != nullptr;
 
     bool lastLock = tryLock();
     unlock();
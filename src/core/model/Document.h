@@ -3,7 +3,8 @@
  *
  * The document
  *
- * All methods are unlocked, you need to lock the document before you change something and unlock after.
+ * All methods are unlocked, you need to lock the document before you change something and unlock after, see
+ * Document::lock() and Document::lockPage().
  *
  * @author Xournal++ Team
  * https://github.com/xournalpp/xournalpp
@@ -13,19 +14,25 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
-#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "pdf/base/XojPdfBookmarkIterator.h"
 #include "pdf/base/XojPdfDocument.h"
+#include "pdf/base/XojPdfDocumentPool.h"
 #include "pdf/base/XojPdfPage.h"
 
 #include "DocumentHandler.h"
 #include "LinkDestination.h"
 #include "PageRef.h"
+#include "PageSnapshot.h"
 #include "filesystem.h"
 
 class Document {
@@ -39,6 +46,30 @@ public:
     bool readPdf(const fs::path& filename, bool initPages, bool attachToDocument, gpointer data = nullptr,
                  gsize length = 0);
 
+    /**
+     * Read the PDF from a file mapped in memory instead of from a copy on the heap, see XojPdfDocument::loadMapped()
+     * @param filename The name of the PDF in the document
+     * @param file The file with its content, which can be removed once it is read
+     */
+    bool readMappedPdf(const fs::path& filename, const fs::path& file, bool attachToDocument);
+
+    /**
+     * Use the PDF background read by the other document, e.g. by the handler parsing the pages after the first ones
+     * (see LoadHandler::loadRemainingPages())
+     */
+    void setPdfFrom(const Document& other);
+
+    /**
+     * Use the new version of the PDF file, read again once it changed (see PdfReloader). The pages keep their PDF
+     * page numbers, the outline is read again.
+     */
+    void reloadPdf(XojPdfDocument pdf);
+
+    /**
+     * Take the PDF files read by readPdf() from the pool, and add them to it. The pool must outlive the document.
+     */
+    void setPdfDocumentPool(XojPdfDocumentPool* pool);
+
     size_t getPageCount() const;
     size_t getPdfPageCount() const;
     XojPdfPageSPtr getPdfPage(size_t page) const;
@@ -48,6 +79,11 @@ public:
     void addPage(const PageRef& p);
     template <class InputIter>
     void addPages(InputIter first, InputIter last);
+    /**
+     * Inserts the pages before position, renumbering the pages once
+     */
+    template <class InputIter>
+    void insertPages(InputIter first, InputIter last, size_t position);
     PageRef getPage(size_t page) const;
     void deletePage(size_t pNr);
 
@@ -66,6 +102,12 @@ public:
 
     Document& operator=(const Document& doc);
 
+    /**
+     * @return A copy of the document, which can be saved or exported while this one is edited. The pages are copied,
+     *         the PDF background is shared. Must be called with the document locked, the copy is not locked.
+     */
+    std::unique_ptr<Document> snapshot() const;
+
     void setFilepath(fs::path filepath);
     fs::path getFilepath() const;
     fs::path getPdfFilepath() const;
@@ -74,8 +116,54 @@ public:
 
     fs::path getEvMetadataFilename() const;
 
+    /**
+     * @return The outline of the PDF, nullptr if there is none or if it is outdated, see isOutlineOutdated()
+     */
     GtkTreeModel* getContentsModel() const;
 
+    /**
+     * @brief An entry of the outline of the PDF, see readOutline()
+     */
+    struct OutlineEntry {
+        OutlineEntry() = default;
+        OutlineEntry(OutlineEntry&& other) noexcept;
+        OutlineEntry& operator=(OutlineEntry&& other) noexcept;
+        ~OutlineEntry();
+
+        std::string titleMarkup;
+
+        /**
+         * Owned by the entry until it is added to the contents model
+         */
+        XojLinkDest* link = nullptr;
+
+        std::vector<OutlineEntry> children;
+    };
+
+    /**
+     * @brief Reads the outline of the PDF, which takes a while on large technical documents
+     *
+     * Does not touch the document, so that it can run in a job, see setOutline().
+     */
+    static std::vector<OutlineEntry> readOutline(const XojPdfDocument& pdf);
+
+    /**
+     * @brief Builds the contents model from an outline read by readOutline()
+     * @return false if the model is up to date already, or if the outline is not the one of the current PDF
+     */
+    bool setOutline(XojPdfDocument pdf, std::vector<OutlineEntry> outline);
+
+    /**
+     * @return true if a PDF was loaded but its outline was not read yet. readPdf() does not read it: the sidebar reads
+     * it in the background.
+     */
+    bool isOutlineOutdated() const;
+
+    /**
+     * @brief Reads the outline and builds the contents model now, if it is outdated
+     */
+    void buildContentsModel();
+
     void setCreateBackupOnSave(bool backup);
     bool shouldCreateBackupOnSave() const;
 
@@ -83,30 +171,126 @@ public:
 
     bool isAttachPdf() const;
 
+    /**
+     * The archive entry of a .xopp file the attached PDF was read from: it can be copied as it is when the document is
+     * saved, instead of writing the PDF again. The CRC and the size tell whether the entry was changed since.
+     */
+    struct PdfAttachmentSource {
+        fs::path archive;
+        std::string entry;
+        uint32_t crc = 0;
+        uint64_t size = 0;
+    };
+
+    /**
+     * Set once the attached PDF is read from an archive, cleared when another PDF is read
+     */
+    void setPdfAttachmentSource(PdfAttachmentSource source);
+    const PdfAttachmentSource& getPdfAttachmentSource() const;
+
     cairo_surface_t* getPreview() const;
     void setPreview(cairo_surface_t* preview);
 
+    /**
+     * Set the preview rendered from the page at the given revision (see PageHandler::getRevision())
+     */
+    void setPreview(cairo_surface_t* preview, const PageRef& page, uint64_t revision);
+
+    /**
+     * @return Whether the preview was rendered from the page, and the page did not change since
+     */
+    bool isPreviewUpToDate(const PageRef& page) const;
+
+    /**
+     * @brief The exclusive lock: for the structural changes (pages added, removed, moved...) and the changes of the
+     * elements made without the page lock
+     */
     void lock();
     void unlock();
     bool tryLock();
 
+    /**
+     * @brief The shared lock: for reading the structure of the document, e.g. the pages and their size, but not the
+     * elements. Several threads hold it together, only the exclusive lock excludes them.
+     */
+    void lockShared();
+    void unlockShared();
+
+    /**
+     * @brief The lock of the elements of one page: the shared lock of the document and the lock of the page
+     *
+     * For reading or changing the elements of the page. The threads working on different pages do not wait for each
+     * other. The elements may only be changed with this lock or with the exclusive one.
+     */
+    void lockPage(const XojPage& page);
+    void unlockPage(const XojPage& page);
+
+    /**
+     * @brief The shared lock, and a snapshot of the elements of the page in the area taken with the page lock
+     *
+     * For drawing the elements without the page lock, while they are edited, e.g. by the render jobs. The elements
+     * removed from the page meanwhile must stay alive until unlockSnapshot(): the undo actions owning them are deleted
+     * after waitForSnapshots(). The elements are not changed in place without the exclusive lock, but by the eraser,
+     * see Stroke::getErasable().
+     */
+    PageSnapshot lockSnapshot(XojPage& page, const xoj::util::Rectangle<double>& area);
+    void unlockSnapshot();
+
+    /**
+     * @brief Waits for the snapshots taken so far to be drawn, see lockSnapshot()
+     *
+     * The elements removed from the pages before the call can be deleted afterwards.
+     */
+    void waitForSnapshots();
+
+    struct LockStatistics {
+        uint64_t exclusive = 0;
+        uint64_t shared = 0;
+        uint64_t page = 0;
+
+        /**
+         * The locks which were not immediately available, and the total time spent waiting for them
+         */
+        uint64_t contended = 0;
+        double waitedMs = 0;
+    };
+
+    /**
+     * @return The number of locks taken since the document was created
+     */
+    LockStatistics getLockStatistics() const;
+
 private:
-    void buildContentsModel();
+    /**
+     * Load the PDF with the given function and set it as the background of the document
+     */
+    bool loadPdf(const fs::path& filename, bool initPages, bool attachToDocument,
+                 const std::function<bool(GError**)>& load);
+
     void freeTreeContentModel();
     static bool freeTreeContentEntry(GtkTreeModel* treeModel, GtkTreePath* path, GtkTreeIter* iter, Document* doc);
 
-    void buildTreeContentsModel(GtkTreeIter* parent, XojPdfBookmarkIterator* iter);
+    void buildTreeContentsModel(GtkTreeIter* parent, std::vector<OutlineEntry>& entries);
+
+    /**
+     * Updates the page numbers of the outline entries whose page moved
+     */
     void updateIndexPageNumbers();
-    static bool fillPageLabels(GtkTreeModel* treeModel, GtkTreePath* path, GtkTreeIter* iter, Document* doc);
 
 private:
     DocumentHandler* handler = nullptr;
 
     XojPdfDocument pdfDocument;
 
+    /**
+     * Shared PDF files, may be nullptr
+     */
+    XojPdfDocumentPool* pdfDocumentPool = nullptr;
+
     fs::path filepath;
     fs::path pdfFilepath;
     bool attachPdf = false;
+    PdfAttachmentSource pdfAttachmentSource;
 
     /**
      *  Password: not handled yet
@@ -142,6 +326,22 @@ private:
      */
     GtkTreeModel* contentsModel = nullptr;
 
+    /**
+     * The PDF was loaded, but not its outline
+     */
+    bool outlineOutdated = false;
+
+    /**
+     * The rows of the contents model with the page shown in their page number column. The iterators of a
+     * GtkTreeStore stay valid as long as the row exists.
+     */
+    struct OutlineRow {
+        GtkTreeIter iter;
+        size_t pdfPage;
+        size_t page;
+    };
+    std::vector<OutlineRow> outlineRows;
+
     /**
      *  create a backup before save
      */
@@ -152,10 +352,27 @@ private:
      */
     cairo_surface_t* preview = nullptr;
 
+    /**
+     * The page the preview was rendered from, and its revision then
+     */
+    std::weak_ptr<XojPage> previewPage;
+    uint64_t previewRevision = 0;
+
     /**
      * The lock of the document
      */
-    std::mutex documentLock;
+    std::shared_mutex documentLock;
+
+    /**
+     * Held shared from lockSnapshot() to unlockSnapshot()
+     */
+    std::shared_mutex snapshotLock;
+
+    std::atomic<uint64_t> exclusiveLocks{0};
+    std::atomic<uint64_t> sharedLocks{0};
+    std::atomic<uint64_t> pageLocks{0};
+    std::atomic<uint64_t> contendedLocks{0};
+    std::atomic<int64_t> lockWaitNs{0};
 };
 
 template <class InputIter>
@@ -164,3 +381,10 @@ void Document::addPages(InputIter first, InputIter last) {
     this->pageIndex.reset();
     updateIndexPageNumbers();
 }
+
+template <class InputIter>
+void Document::insertPages(InputIter first, InputIter last, size_t position) {
+    this->pages.insert(this->pages.begin() + static_cast<std::ptrdiff_t>(position), first, last);
+    this->pageIndex.reset();
+    updateIndexPageNumbers();
+}
@@ -11,4 +11,10 @@
 
 #pragma once
 
-enum DocumentChangeType { DOCUMENT_CHANGE_CLEARED, DOCUMENT_CHANGE_COMPLETE, DOCUMENT_CHANGE_PDF_BOOKMARKS };
+enum DocumentChangeType {
+    DOCUMENT_CHANGE_CLEARED,
+    DOCUMENT_CHANGE_COMPLETE,
+    DOCUMENT_CHANGE_PDF_BOOKMARKS,
+    /// A new version of the PDF background file, see PdfReloader. The pages whose background changed are notified after.
+    DOCUMENT_CHANGE_PDF_RELOADED
+};
@@ -18,10 +18,18 @@ void DocumentHandler::firePageChanged(size_t page) {
     for (DocumentListener* dl: this->listener) { dl->pageChanged(page); }
 }
 
+void DocumentHandler::firePagesChanged(size_t first, size_t count) {
+    for (DocumentListener* dl: this->listener) { dl->pagesChanged(first, count); }
+}
+
 void DocumentHandler::firePageInserted(size_t page) {
     for (DocumentListener* dl: this->listener) { dl->pageInserted(page); }
 }
 
+void DocumentHandler::firePagesInserted(size_t first, size_t count) {
+    for (DocumentListener* dl: this->listener) { dl->pagesInserted(first, count); }
+}
+
 void DocumentHandler::firePageDeleted(size_t page) {
     for (DocumentListener* dl: this->listener) { dl->pageDeleted(page); }
 }
@@ -31,7 +31,9 @@ public:
     void fireDocumentChanged(DocumentChangeType type);
     void firePageSizeChanged(size_t page);
     void firePageChanged(size_t page);
+    void firePagesChanged(size_t first, size_t count);
     void firePageInserted(size_t page);
+    void firePagesInserted(size_t first, size_t count);
     void firePageDeleted(size_t page);
     // void firePageLoaded(PageRef page);
     void firePageSelected(size_t page);
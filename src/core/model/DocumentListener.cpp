@@ -23,8 +23,16 @@ void DocumentListener::pageSizeChanged(size_t page) {}
 
 void DocumentListener::pageChanged(size_t page) {}
 
+void DocumentListener::pagesChanged(size_t first, size_t count) {
+    for (size_t i = 0; i < count; i++) { pageChanged(first + i); }
+}
+
 void DocumentListener::pageInserted(size_t page) {}
 
+void DocumentListener::pagesInserted(size_t first, size_t count) {
+    for (size_t i = 0; i < count; i++) { pageInserted(first + i); }
+}
+
 void DocumentListener::pageDeleted(size_t page) {}
 
 void DocumentListener::pageSelected(size_t page) {}
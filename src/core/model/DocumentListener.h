@@ -31,7 +31,17 @@ public:
     virtual void documentChanged(DocumentChangeType type);
     virtual void pageSizeChanged(size_t page);
     virtual void pageChanged(size_t page);
+
+    /**
+     * Consecutive pages changed at once. By default, calls pageChanged() for each of them.
+     */
+    virtual void pagesChanged(size_t first, size_t count);
     virtual void pageInserted(size_t page);
+
+    /**
+     * Consecutive pages inserted at once. By default, calls pageInserted() for each of them.
+     */
+    virtual void pagesInserted(size_t first, size_t count);
     virtual void pageDeleted(size_t page);
     virtual void pageSelected(size_t page);
 
@@ -5,22 +5,64 @@
 #include "util/serializing/ObjectInputStream.h"
 #include "util/serializing/ObjectOutputStream.h"
 
+#include "SpatialIndex.h"
+
 using xoj::util::Rectangle;
 
 Element::Element(ElementType type): type(type) {}
 
-Element::~Element() = default;
+Element::Element(const Element& other):
+        Serializable(other),
+        sizeCalculated(other.sizeCalculated),
+        width(other.width),
+        height(other.height),
+        x(other.x),
+        y(other.y),
+        snappedBounds(other.snappedBounds),
+        type(other.type),
+        color(other.color) {}
+
+auto Element::operator=(const Element& other) -> Element& {
+    if (this != &other) {
+        this->sizeCalculated = other.sizeCalculated;
+        this->width = other.width;
+        this->height = other.height;
+        this->x = other.x;
+        this->y = other.y;
+        this->snappedBounds = other.snappedBounds;
+        this->type = other.type;
+        this->color = other.color;
+        boundsChanged();
+    }
+    return *this;
+}
+
+Element::~Element() {
+    if (this->spatialIndex) {
+        this->spatialIndex->remove(this);
+    }
+}
 
 auto Element::getType() const -> ElementType { return this->type; }
 
 void Element::setX(double x) {
     this->x = x;
     this->sizeCalculated = false;
+    boundsChanged();
 }
 
 void Element::setY(double y) {
     this->y = y;
     this->sizeCalculated = false;
+    boundsChanged();
+}
+
+auto Element::getMemoryUsage() const -> size_t { return sizeof(Element); }
+
+void Element::boundsChanged() const {
+    if (this->spatialIndex) {
+        this->spatialIndex->markDirty(this);
+    }
 }
 
 auto Element::getX() const -> double {
@@ -50,6 +92,7 @@ void Element::move(double dx, double dy) {
     this->x += dx;
     this->y += dy;
     this->snappedBounds = this->snappedBounds.translated(dx, dy);
+    boundsChanged();
 }
 
 auto Element::getElementWidth() const -> double {
@@ -22,6 +22,8 @@
 
 enum ElementType { ELEMENT_STROKE = 1, ELEMENT_IMAGE, ELEMENT_TEXIMAGE, ELEMENT_TEXT };
 
+class SpatialIndex;
+
 class ShapeContainer {
 public:
     virtual bool contains(double x, double y) = 0;
@@ -33,6 +35,12 @@ class Element: public Serializable {
 protected:
     Element(ElementType type);
 
+    /**
+     * The copy is not registered in the spatial index of the original's Layer
+     */
+    Element(const Element& other);
+    Element& operator=(const Element& other);
+
 public:
     ~Element() override;
 
@@ -74,6 +82,12 @@ public:
      */
     virtual Element* clone() const = 0;
 
+    /**
+     * @return The approximate number of bytes held by the element, without decoding or unpacking its content. The data
+     *         shared with other elements (see ImageStore) is counted for each of them.
+     */
+    virtual size_t getMemoryUsage() const;
+
     void serialize(ObjectOutputStream& out) const override;
     void readSerialized(ObjectInputStream& in) override;
 
@@ -81,6 +95,12 @@ private:
 protected:
     virtual void calcSize() const = 0;
 
+    /**
+     * Must be called whenever the bounds of the element may have changed,
+     * so that the spatial index of the Layer containing the element stays up to date
+     */
+    void boundsChanged() const;
+
 protected:
     // If the size has been calculated
     mutable bool sizeCalculated = false;
@@ -105,4 +125,11 @@ private:
      * The color in RGB format
      */
     Color color{0U};
+
+    /**
+     * Index of the Layer this element belongs to, if any
+     */
+    SpatialIndex* spatialIndex = nullptr;
+
+    friend class SpatialIndex;
 };
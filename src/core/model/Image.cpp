@@ -1,10 +1,12 @@
 #include "Image.h"
 
-#include <array>
+#include <atomic>
+#include <chrono>
 #include <utility>
 
 #include <cairo.h>
 
+#include "model/ImageStore.h"
 #include "util/serializing/ObjectInputStream.h"
 #include "util/serializing/ObjectOutputStream.h"
 
@@ -12,17 +14,7 @@ using xoj::util::Rectangle;
 
 Image::Image(): Element(ELEMENT_IMAGE) {}
 
-Image::~Image() {
-    if (this->image) {
-        cairo_surface_destroy(this->image);
-        this->image = nullptr;
-    }
-
-    if (this->format) {
-        gdk_pixbuf_format_free(this->format);
-        this->format = nullptr;
-    }
-}
+Image::~Image() = default;
 
 auto Image::clone() const -> Element* {
     auto* img = new Image();
@@ -32,9 +24,9 @@ auto Image::clone() const -> Element* {
     img->setColor(this->getColor());
     img->width = this->width;
     img->height = this->height;
-    img->data = this->data;
+    img->content = std::atomic_load(&this->content);
+    img->pendingContent = this->pendingContent;
 
-    img->image = cairo_surface_reference(this->image);
     img->snappedBounds = this->snappedBounds;
     img->sizeCalculated = this->sizeCalculated;
 
@@ -44,69 +36,37 @@ auto Image::clone() const -> Element* {
 void Image::setWidth(double width) {
     this->width = width;
     this->calcSize();
+    boundsChanged();
 }
 
 void Image::setHeight(double height) {
     this->height = height;
     this->calcSize();
+    boundsChanged();
 }
 
 void Image::setImage(std::string_view data) { setImage(std::string(data)); }
 
 void Image::setImage(std::string&& data) {
-    if (this->image) {
-        cairo_surface_destroy(this->image);
-        this->image = nullptr;
-    }
-    this->data = std::move(data);
-
-    if (this->format) {
-        gdk_pixbuf_format_free(this->format);
-        this->format = nullptr;
-    }
-
-    // FIXME: awful hack to try to parse the format
-    std::array<char*, 4096> buffer{};
-    GdkPixbufLoader* loader = gdk_pixbuf_loader_new();
-    size_t remaining = this->data.size();
-    while (remaining > 0) {
-        size_t readLen = std::min(remaining, buffer.size());
-        if (!gdk_pixbuf_loader_write(loader, reinterpret_cast<const guchar*>(this->data.c_str()), readLen, nullptr))
-            break;
-        remaining -= readLen;
-
-        // Try to determine the format early, if possible
-        this->format = gdk_pixbuf_loader_get_format(loader);
-        if (this->format) {
-            break;
-        }
-    }
-    gdk_pixbuf_loader_close(loader, nullptr);
-    // if the format was not determined early, it can probably be determined now
-    if (!this->format) {
-        this->format = gdk_pixbuf_loader_get_format(loader);
-    }
-    g_assert(this->format != nullptr && "could not parse the image format!");
-
-    // the format is owned by the pixbuf, so create a copy
-    this->format = gdk_pixbuf_format_copy(this->format);
+    this->pendingContent = {};
+    std::atomic_store(&this->content, data.empty() ? nullptr : ImageStore::get(std::move(data)));
+}
 
-    g_object_unref(loader);
+void Image::setImage(ImageStore::Future data) {
+    std::atomic_store(&this->content, std::shared_ptr<const ImageData>());
+    this->pendingContent = std::move(data);
 }
 
 void Image::setImage(GdkPixbuf* img) {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-    setImage(gdk_cairo_surface_create_from_pixbuf(img, 0, nullptr));
+    cairo_surface_t* surface = gdk_cairo_surface_create_from_pixbuf(img, 0, nullptr);
+    setImage(surface);
+    cairo_surface_destroy(surface);
 #pragma GCC diagnostic pop
 }
 
 void Image::setImage(cairo_surface_t* image) {
-    if (this->image) {
-        cairo_surface_destroy(this->image);
-        this->image = nullptr;
-    }
-
     struct {
         std::string buffer;
         std::string readbuf;
@@ -118,40 +78,32 @@ void Image::setImage(cairo_surface_t* image) {
         return CAIRO_STATUS_SUCCESS;
     };
     cairo_surface_write_to_png_stream(image, writeFunc, &closure_);
-
-    data = std::move(closure_.buffer);
+    setImage(std::move(closure_.buffer));
 }
 
 auto Image::getImage() const -> cairo_surface_t* {
-    g_assert(data.length() > 0 && "image has no data, cannot render it!");
-    if (this->image == nullptr) {
-        GdkPixbufLoader* loader = gdk_pixbuf_loader_new();
-        gdk_pixbuf_loader_write(loader, reinterpret_cast<const guchar*>(this->data.c_str()), this->data.length(),
-                                nullptr);
-        bool success = gdk_pixbuf_loader_close(loader, nullptr);
-        g_assert(success && "errors in loading image data!");
-
-        GdkPixbuf* pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
-        g_assert(pixbuf != nullptr);
-        this->imageSize = {gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf)};
-
-        // TODO: pass in window once this code is refactored into ImageView
-        this->image = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, gdk_pixbuf_get_width(pixbuf),
-                                                 gdk_pixbuf_get_height(pixbuf));
-        g_assert(this->image != nullptr);
-
-        // Paint the pixbuf on to the surface
-        // NOTE: we do this manually instead of using gdk_cairo_surface_create_from_pixbuf
-        // since this does not work in CLI mode.
-        cairo_t* cr = cairo_create(this->image);
-        gdk_cairo_set_source_pixbuf(cr, pixbuf, 0, 0);
-        cairo_paint(cr);
-        cairo_destroy(cr);
-
-        g_object_unref(loader);
+    auto content = getContent();
+    g_assert(content && "image has no data, cannot render it!");
+    return content->getSurface();
+}
+
+auto Image::getContent() const -> std::shared_ptr<const ImageData> {
+    auto content = std::atomic_load(&this->content);
+    if (!content && this->pendingContent.valid()) {
+        content = this->pendingContent.get();
+        std::atomic_store(&this->content, content);
     }
+    return content;
+}
 
-    return this->image;
+auto Image::getContentIfReady() const -> std::shared_ptr<const ImageData> {
+    auto content = std::atomic_load(&this->content);
+    if (!content && this->pendingContent.valid() &&
+        this->pendingContent.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        content = this->pendingContent.get();
+        std::atomic_store(&this->content, content);
+    }
+    return content;
 }
 
 void Image::scale(double x0, double y0, double fx, double fy, double rotation,
@@ -166,6 +118,7 @@ void Image::scale(double x0, double y0, double fx, double fy, double rotation,
     this->width *= fx;
     this->height *= fy;
     this->calcSize();
+    boundsChanged();
 }
 
 void Image::rotate(double x0, double y0, double th) {}
@@ -178,7 +131,8 @@ void Image::serialize(ObjectOutputStream& out) const {
     out.writeDouble(this->width);
     out.writeDouble(this->height);
 
-    out.writeImage(this->data);
+    auto content = getContent();
+    out.writeImage(content ? content->getData() : std::string());
 
     out.endObject();
 }
@@ -191,12 +145,7 @@ void Image::readSerialized(ObjectInputStream& in) {
     this->width = in.readDouble();
     this->height = in.readDouble();
 
-    if (this->image) {
-        cairo_surface_destroy(this->image);
-        this->image = nullptr;
-    }
-
-    this->data = in.readImage();
+    setImage(in.readImage());
 
     in.endObject();
     this->calcSize();
@@ -207,12 +156,26 @@ void Image::calcSize() const {
     this->sizeCalculated = true;
 }
 
-bool Image::hasData() const { return !this->data.empty(); }
+bool Image::hasData() const { return std::atomic_load(&this->content) || this->pendingContent.valid(); }
+
+const unsigned char* Image::getRawData() const {
+    auto content = getContent();
+    return content ? reinterpret_cast<const unsigned char*>(content->getData().data()) : nullptr;
+}
 
-const unsigned char* Image::getRawData() const { return reinterpret_cast<const unsigned char*>(this->data.data()); }
+size_t Image::getRawDataLength() const {
+    auto content = getContent();
+    return content ? content->getData().size() : 0;
+}
 
-size_t Image::getRawDataLength() const { return this->data.size(); }
+size_t Image::getMemoryUsage() const { return sizeof(Image) + getRawDataLength(); }
 
-std::pair<int, int> Image::getImageSize() const { return this->imageSize; }
+std::pair<int, int> Image::getImageSize() const {
+    auto content = getContent();
+    return content ? content->getSize() : NOSIZE;
+}
 
-GdkPixbufFormat* Image::getImageFormat() const { return this->format; }
+GdkPixbufFormat* Image::getImageFormat() const {
+    auto content = getContent();
+    return content ? content->getFormat() : nullptr;
+}
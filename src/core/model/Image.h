@@ -11,10 +11,12 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "Element.h"
+#include "ImageStore.h"
 
 
 class Image: public Element {
@@ -36,6 +38,10 @@ public:
     /// Set the image data by moving the data.
     void setImage(std::string&& data);
 
+    /// Set the image data once it is prepared by the worker of the ImageStore. Meanwhile, the image is drawn as a
+    /// placeholder of its size, which has to be set.
+    void setImage(ImageStore::Future data);
+
     /// Set the image data by copying the data from the provided pixbuf.
     ///
     /// \deprecated Pass the raw image data instead.
@@ -53,6 +59,8 @@ public:
 
     Element* clone() const override;
 
+    size_t getMemoryUsage() const override;
+
     bool hasData() const;
 
     /// Return a pointer to the raw data. Note that the pointer will be invalidated if the data is changed.
@@ -66,6 +74,12 @@ public:
 
     GdkPixbufFormat* getImageFormat() const;
 
+    /// Return the shared data of the image, or nullptr if it has none. Waits for the data which is being prepared.
+    std::shared_ptr<const ImageData> getContent() const;
+
+    /// Return the shared data of the image, or nullptr if it has none or it is still being prepared.
+    std::shared_ptr<const ImageData> getContentIfReady() const;
+
     static constexpr std::pair<int, int> NOSIZE = std::make_pair(-1, -1);
 
 public:
@@ -86,12 +100,10 @@ private:
     /// FIXME: remove this when setImage(GdkPixbuf*) is removed.
     [[deprecated]] void setImage(cairo_surface_t* image);
 
-    /// Temporary surface used as a render buffer.
-    mutable cairo_surface_t* image = nullptr;
-
-    /// Image format information.
-    mutable GdkPixbufFormat* format = nullptr;
-    mutable std::pair<int, int> imageSize = {-1, -1};
+    /// The data, shared with the other elements of the same image, see ImageStore. Set from pendingContent by the
+    /// first thread to see it prepared.
+    mutable std::shared_ptr<const ImageData> content;
 
-    std::string data;
+    /// The data being prepared, if any.
+    ImageStore::Future pendingContent;
 };
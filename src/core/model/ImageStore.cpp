@@ -0,0 +1,251 @@
+#include "ImageStore.h"
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <glib.h>
+
+ImageData::ImageData(std::string data, std::string hash, cairo_surface_t* surface):
+        data(std::move(data)), hash(std::move(hash)) {
+    // FIXME: awful hack to try to parse the format
+    std::array<char*, 4096> buffer{};
+    GdkPixbufLoader* loader = gdk_pixbuf_loader_new();
+    size_t remaining = this->data.size();
+    while (remaining > 0) {
+        size_t readLen = std::min(remaining, buffer.size());
+        if (!gdk_pixbuf_loader_write(loader, reinterpret_cast<const guchar*>(this->data.c_str()), readLen, nullptr))
+            break;
+        remaining -= readLen;
+
+        // Try to determine the format early, if possible
+        this->format = gdk_pixbuf_loader_get_format(loader);
+        if (this->format) {
+            break;
+        }
+    }
+    gdk_pixbuf_loader_close(loader, nullptr);
+
+    // if the format was not determined early, it can probably be determined now
+    if (!this->format) {
+        this->format = gdk_pixbuf_loader_get_format(loader);
+    }
+    g_assert(this->format != nullptr && "could not parse the image format!");
+
+    // the format is owned by the pixbuf, so create a copy
+    this->format = gdk_pixbuf_format_copy(this->format);
+
+    g_object_unref(loader);
+
+    if (surface) {
+        setSurface(cairo_surface_reference(surface));
+    }
+}
+
+ImageData::~ImageData() {
+    this->mipmap.reset();
+    if (this->surface) {
+        cairo_surface_destroy(this->surface);
+        this->surface = nullptr;
+    }
+    if (this->format) {
+        gdk_pixbuf_format_free(this->format);
+        this->format = nullptr;
+    }
+}
+
+auto ImageData::getData() const -> const std::string& { return this->data; }
+
+auto ImageData::getHash() const -> const std::string& { return this->hash; }
+
+auto ImageData::getFormat() const -> GdkPixbufFormat* { return this->format; }
+
+auto ImageData::getSurface() const -> cairo_surface_t* {
+    g_assert(data.length() > 0 && "image has no data, cannot render it!");
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->surface == nullptr) {
+        GdkPixbufLoader* loader = gdk_pixbuf_loader_new();
+        gdk_pixbuf_loader_write(loader, reinterpret_cast<const guchar*>(this->data.c_str()), this->data.length(),
+                                nullptr);
+        bool success = gdk_pixbuf_loader_close(loader, nullptr);
+        g_assert(success && "errors in loading image data!");
+
+        GdkPixbuf* pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
+        g_assert(pixbuf != nullptr);
+
+        // TODO: pass in window once this code is refactored into ImageView
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, gdk_pixbuf_get_width(pixbuf),
+                                                              gdk_pixbuf_get_height(pixbuf));
+        g_assert(surface != nullptr);
+
+        // Paint the pixbuf on to the surface
+        // NOTE: we do this manually instead of using gdk_cairo_surface_create_from_pixbuf
+        // since this does not work in CLI mode.
+        cairo_t* cr = cairo_create(surface);
+        gdk_cairo_set_source_pixbuf(cr, pixbuf, 0, 0);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+
+        g_object_unref(loader);
+
+        setSurface(surface);
+    }
+
+    return this->surface;
+}
+
+auto ImageData::getMipmap() const -> const xoj::util::Mipmap& {
+    getSurface();
+    return *this->mipmap;
+}
+
+auto ImageData::getSize() const -> std::pair<int, int> {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->size;
+}
+
+void ImageData::setSurface(cairo_surface_t* surface) const {
+    this->surface = surface;
+    this->size = {cairo_image_surface_get_width(surface), cairo_image_surface_get_height(surface)};
+    setMimeData();
+    this->mipmap = std::make_unique<xoj::util::Mipmap>(this->surface);
+}
+
+void ImageData::setMimeData() const {
+    // The surface keeps its own copies, it may be referenced by a PDF export beyond this data
+    std::string uniqueId = "xournalpp-image-" + this->hash;
+    auto* idCopy = static_cast<unsigned char*>(g_memdup(uniqueId.data(), static_cast<guint>(uniqueId.length())));
+    cairo_surface_set_mime_data(this->surface, CAIRO_MIME_TYPE_UNIQUE_ID, idCopy, uniqueId.length(), g_free, idCopy);
+
+    gchar* name = this->format ? gdk_pixbuf_format_get_name(this->format) : nullptr;
+    if (name && std::string_view(name) == "jpeg") {
+        auto* dataCopy =
+                static_cast<unsigned char*>(g_memdup(this->data.data(), static_cast<guint>(this->data.length())));
+        cairo_surface_set_mime_data(this->surface, CAIRO_MIME_TYPE_JPEG, dataCopy, this->data.length(), g_free,
+                                    dataCopy);
+    }
+    g_free(name);
+}
+
+auto ImageStore::getInstance() -> ImageStore& {
+    // Never destroyed: the last elements may be freed after the static objects
+    static auto* store = new ImageStore();
+    return *store;
+}
+
+auto ImageStore::get(std::string data, cairo_surface_t* surface) -> std::shared_ptr<const ImageData> {
+    gchar* checksum =
+            g_compute_checksum_for_data(G_CHECKSUM_SHA1, reinterpret_cast<const guchar*>(data.data()), data.length());
+    std::string hash = checksum;
+    g_free(checksum);
+
+    ImageStore& store = getInstance();
+    std::lock_guard<std::mutex> lock(store.mutex);
+    auto& entry = store.images[hash];
+    if (auto image = entry.lock()) {
+        if (image->getData() == data) {
+            return image;
+        }
+        // Hash collision: not shared
+        return std::make_shared<const ImageData>(std::move(data), std::move(hash), surface);
+    }
+
+    std::shared_ptr<const ImageData> image(new ImageData(std::move(data), hash, surface), [](const ImageData* image) {
+        getInstance().release(image->getHash());
+        delete image;
+    });
+    entry = image;
+    return image;
+}
+
+void ImageStore::release(const std::string& hash) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (auto it = this->images.find(hash); it != this->images.end() && it->second.expired()) {
+        this->images.erase(it);
+    }
+}
+
+auto ImageStore::getCount() -> size_t {
+    ImageStore& store = getInstance();
+    std::lock_guard<std::mutex> lock(store.mutex);
+    return store.images.size();
+}
+
+auto ImageStore::getBytes() -> size_t {
+    // Released out of the lock: the last user releases its data from the store
+    std::vector<std::shared_ptr<const ImageData>> images;
+    {
+        ImageStore& store = getInstance();
+        std::lock_guard<std::mutex> lock(store.mutex);
+        for (const auto& [hash, weak]: store.images) {
+            if (auto data = weak.lock()) {
+                images.push_back(std::move(data));
+            }
+        }
+    }
+
+    size_t bytes = 0;
+    for (const auto& data: images) {
+        bytes += data->getData().size();
+        auto [width, height] = data->getSize();
+        if (width > 0 && height > 0) {
+            // ARGB32, and about a third more for the mipmap
+            bytes += static_cast<size_t>(width) * static_cast<size_t>(height) * 4 * 4 / 3;
+        }
+    }
+    return bytes;
+}
+
+auto ImageStore::getAsync(std::function<Decoded()> prepare, std::function<void()> onReady) -> Future {
+    auto promise = std::make_shared<std::promise<std::shared_ptr<const ImageData>>>();
+    Future future = promise->get_future().share();
+
+    ImageStore& store = getInstance();
+    std::lock_guard<std::mutex> lock(store.tasksMutex);
+    store.tasks.emplace_back([promise, prepare = std::move(prepare), onReady = std::move(onReady)]() {
+        Decoded decoded = prepare();
+        auto image = decoded.data.empty() ? nullptr : get(std::move(decoded.data), decoded.surface);
+        if (decoded.surface) {
+            cairo_surface_destroy(decoded.surface);
+        }
+        promise->set_value(std::move(image));
+        if (onReady) {
+            onReady();
+        }
+    });
+
+    if (!store.workerStarted) {
+        // Runs as long as the store
+        std::thread([&store]() { store.runWorker(); }).detach();
+        store.workerStarted = true;
+    }
+    store.tasksChanged.notify_one();
+    return future;
+}
+
+void ImageStore::runWorker() {
+    std::unique_lock<std::mutex> lock(this->tasksMutex);
+    while (true) {
+        this->tasksChanged.wait(lock, [this]() { return !this->tasks.empty(); });
+        auto task = std::move(this->tasks.front());
+        this->tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+auto ImageStore::encodePng(cairo_surface_t* surface) -> std::string {
+    std::string data;
+    cairo_surface_write_to_png_stream(
+            surface,
+            [](void* closure, const unsigned char* bytes, unsigned int length) -> cairo_status_t {
+                static_cast<std::string*>(closure)->append(reinterpret_cast<const char*>(bytes), length);
+                return CAIRO_STATUS_SUCCESS;
+            },
+            &data);
+    return data;
+}
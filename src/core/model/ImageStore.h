@@ -0,0 +1,182 @@
+/*
+ * Xournal++
+ *
+ * The image data shared by the image elements
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <cairo.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include "util/Mipmap.h"
+
+/**
+ * @brief The encoded data of an image, and the surface decoded from it on first use
+ *
+ * Immutable, shared by all the image elements with the same data, see ImageStore. Thread safe.
+ */
+class ImageData {
+public:
+    /**
+     * @param surface The surface decoded from the data if known already, or nullptr. The data takes a reference.
+     */
+    ImageData(std::string data, std::string hash, cairo_surface_t* surface = nullptr);
+    ~ImageData();
+
+    ImageData(const ImageData&) = delete;
+    ImageData& operator=(const ImageData&) = delete;
+
+public:
+    /**
+     * @return The encoded data, as read from the file or the clipboard
+     */
+    const std::string& getData() const;
+
+    /**
+     * @return The hexadecimal SHA-1 of the data
+     */
+    const std::string& getHash() const;
+
+    GdkPixbufFormat* getFormat() const;
+
+    /**
+     * @return The surface, decoded on the first call. The PDF export writes it once, and JPEG data as it is.
+     */
+    cairo_surface_t* getSurface() const;
+
+    /**
+     * @return The size of the image in pixels, or (-1, -1) if it has not been decoded yet
+     */
+    std::pair<int, int> getSize() const;
+
+    /**
+     * @return The surface and its downscaled copies, to draw the image
+     */
+    const xoj::util::Mipmap& getMipmap() const;
+
+private:
+    /**
+     * Attach the data to the surface for the vector backends
+     */
+    void setMimeData() const;
+
+    /**
+     * Set the decoded surface, with the mutex locked
+     */
+    void setSurface(cairo_surface_t* surface) const;
+
+private:
+    std::string data;
+    std::string hash;
+    GdkPixbufFormat* format = nullptr;
+
+    mutable cairo_surface_t* surface = nullptr;
+    mutable std::unique_ptr<xoj::util::Mipmap> mipmap;
+    mutable std::pair<int, int> size = {-1, -1};
+    mutable std::mutex mutex;
+};
+
+/**
+ * @brief Content addressed store of the image data
+ *
+ * An image pasted or duplicated many times, in one document or in several, is kept once in memory and decoded once:
+ * the elements share the ImageData of their content, which lives as long as one of them uses it.
+ *
+ * The store is process wide rather than per document, since the elements are moved between the documents through
+ * the clipboard and the undo actions without knowing their document. Thread safe.
+ *
+ * The data of the pasted and loaded images is prepared on a worker thread, see getAsync().
+ */
+class ImageStore {
+public:
+    using Future = std::shared_future<std::shared_ptr<const ImageData>>;
+
+    struct Decoded {
+        /**
+         * The encoded data
+         */
+        std::string data;
+
+        /**
+         * The surface decoded from it if known already, or nullptr. Destroyed by the store.
+         */
+        cairo_surface_t* surface = nullptr;
+    };
+
+    /**
+     * @param surface The surface decoded from the data if known already, or nullptr. The store takes a reference.
+     * @return The shared data equal to the given one, added if there is none
+     */
+    static std::shared_ptr<const ImageData> get(std::string data, cairo_surface_t* surface = nullptr);
+
+    /**
+     * Prepare the data on the worker thread of the store, e.g. decode it from base64 or encode pixels
+     *
+     * @param prepare Called on the worker
+     * @param onReady Called on the worker once the data is available, if set
+     * @return The data, once prepared
+     */
+    static Future getAsync(std::function<Decoded()> prepare, std::function<void()> onReady = nullptr);
+
+    /**
+     * @return The surface encoded as PNG
+     */
+    static std::string encodePng(cairo_surface_t* surface);
+
+    /**
+     * @return The number of distinct image data in use
+     */
+    static size_t getCount();
+
+    /**
+     * @return The approximate memory of the data in use, each counted once: the encoded data, the decoded surfaces and
+     *         their downscaled copies
+     */
+    static size_t getBytes();
+
+private:
+    static ImageStore& getInstance();
+
+    /**
+     * Forget the data, unless it was added again since its last user released it
+     */
+    void release(const std::string& hash);
+
+    /**
+     * The loop of the worker thread
+     */
+    void runWorker();
+
+private:
+    /**
+     * By hash of the data
+     */
+    std::unordered_map<std::string, std::weak_ptr<const ImageData>> images;
+
+    std::mutex mutex;
+
+    /**
+     * The tasks of getAsync(), in order
+     */
+    std::deque<std::function<void()>> tasks;
+    bool workerStarted = false;
+    std::mutex tasksMutex;
+    std::condition_variable tasksChanged;
+};
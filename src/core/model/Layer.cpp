@@ -1,10 +1,14 @@
 #include "Layer.h"
 
+#include <algorithm>
+#include <unordered_set>
+
 #include "util/Stacktrace.h"
 
 Layer::Layer() = default;
 
 Layer::~Layer() {
+    this->index.clear();
     for (Element* e: this->elements) { delete e; }
     this->elements.clear();
 }
@@ -16,7 +20,13 @@ auto Layer::clone() const -> Layer* {
         layer->setName(getName());
     }
 
-    for (Element* e: this->elements) { layer->addElement(e->clone()); }
+    // The clones are new: no need to look for them on the layer as addElement() does
+    layer->elements.reserve(this->elements.size());
+    for (Element* e: this->elements) {
+        Element* clone = e->clone();
+        layer->index.insert(clone, static_cast<double>(layer->elements.size()));
+        layer->elements.push_back(clone);
+    }
 
     return layer;
 }
@@ -28,14 +38,29 @@ void Layer::addElement(Element* e) {
         return;
     }
 
-    for (Element* elem2: this->elements) {
-        if (e == elem2) {
-            g_warning("Layer::addElement: Element is already on this layer!");
-            return;
-        }
+    if (this->index.contains(e)) {
+        g_warning("Layer::addElement: Element is already on this layer!");
+        return;
     }
 
+    double order = this->elements.empty() ? 0.0 : this->index.getOrder(this->elements.back()) + 1.0;
     this->elements.push_back(e);
+    this->index.insert(e, order);
+    this->revision++;
+}
+
+void Layer::addElements(const std::vector<Element*>& elements) {
+    if (elements.empty()) {
+        return;
+    }
+
+    double order = this->elements.empty() ? 0.0 : this->index.getOrder(this->elements.back()) + 1.0;
+    this->elements.reserve(this->elements.size() + elements.size());
+    for (Element* e: elements) {
+        this->elements.push_back(e);
+        this->index.insert(e, order++);
+    }
+    this->revision++;
 }
 
 void Layer::insertElement(Element* e, Element::Index pos) {
@@ -45,12 +70,10 @@ void Layer::insertElement(Element* e, Element::Index pos) {
         return;
     }
 
-    for (Element* elem2: this->elements) {
-        if (e == elem2) {
-            g_warning("Layer::insertElement() try to add an element twice!");
-            Stacktrace::printStracktrace();
-            return;
-        }
+    if (this->index.contains(e)) {
+        g_warning("Layer::insertElement() try to add an element twice!");
+        Stacktrace::printStracktrace();
+        return;
     }
 
     // prevent crash, even if this never should happen,
@@ -59,42 +82,157 @@ void Layer::insertElement(Element* e, Element::Index pos) {
         pos = 0;
     }
 
+    this->revision++;
+
     // If the element should be inserted at the top
     if (pos >= static_cast<int>(this->elements.size())) {
+        double order = this->elements.empty() ? 0.0 : this->index.getOrder(this->elements.back()) + 1.0;
         this->elements.push_back(e);
-    } else {
-        this->elements.insert(this->elements.begin() + pos, e);
+        this->index.insert(e, order);
+        return;
+    }
+
+    double next = this->index.getOrder(this->elements[static_cast<size_t>(pos)]);
+    double prev = pos > 0 ? this->index.getOrder(this->elements[static_cast<size_t>(pos) - 1]) : next - 2.0;
+    double order = prev + (next - prev) / 2.0;
+
+    this->elements.insert(this->elements.begin() + pos, e);
+    this->index.insert(e, order);
+
+    if (!(prev < order && order < next)) {
+        // Out of precision between the neighbours: renumber everything
+        for (size_t i = 0; i < this->elements.size(); i++) {
+            this->index.setOrder(this->elements[i], static_cast<double>(i));
+        }
     }
 }
 
-auto Layer::indexOf(Element* e) const -> Element::Index {
-    for (unsigned int i = 0; i < this->elements.size(); i++) {
-        if (this->elements[i] == e) {
-            return i;
+void Layer::insertElements(const std::vector<std::pair<Element*, Element::Index>>& elements) {
+    auto notIncreasing = [](const auto& a, const auto& b) { return a.second >= b.second; };
+    if (std::adjacent_find(elements.begin(), elements.end(), notIncreasing) != elements.end()) {
+        for (auto&& [e, pos]: elements) { insertElement(e, pos); }
+        return;
+    }
+
+    std::vector<Element*> merged;
+    std::vector<bool> isNew;
+    merged.reserve(this->elements.size() + elements.size());
+    isNew.reserve(this->elements.size() + elements.size());
+
+    auto next = this->elements.begin();
+    auto entry = elements.begin();
+    while (entry != elements.end() || next != this->elements.end()) {
+        if (entry != elements.end() &&
+            (next == this->elements.end() || entry->second <= static_cast<Element::Index>(merged.size()))) {
+            if (entry->first == nullptr || this->index.contains(entry->first)) {
+                g_warning("Layer::insertElements() try to add a null element or an element twice!");
+            } else {
+                merged.push_back(entry->first);
+                isNew.push_back(true);
+            }
+            ++entry;
+        } else {
+            merged.push_back(*next++);
+            isNew.push_back(false);
+        }
+    }
+    if (merged.size() == this->elements.size()) {
+        return;
+    }
+
+    // The runs of new elements take the orders between the ones of their neighbours
+    bool renumber = false;
+    for (size_t i = 0; i < merged.size();) {
+        if (!isNew[i]) {
+            i++;
+            continue;
         }
+        const size_t start = i;
+        size_t end = i;
+        while (end < merged.size() && isNew[end]) { end++; }
+
+        auto count = static_cast<double>(end - start);
+        double prev = start > 0 ? this->index.getOrder(merged[start - 1]) : -1.0;
+        double last = end < merged.size() ? this->index.getOrder(merged[end]) : prev + count + 1.0;
+        if (start == 0) {
+            prev = last - count - 1.0;
+        }
+        double step = (last - prev) / (count + 1.0);
+        double order = prev;
+        for (; i < end; i++) {
+            double nextOrder = prev + step * static_cast<double>(i - start + 1);
+            renumber = renumber || !(order < nextOrder && nextOrder < last);
+            order = nextOrder;
+            this->index.insert(merged[i], order);
+        }
+    }
+
+    this->elements = std::move(merged);
+    this->revision++;
+
+    if (renumber) {
+        // Out of precision between the neighbours: renumber everything
+        for (size_t i = 0; i < this->elements.size(); i++) {
+            this->index.setOrder(this->elements[i], static_cast<double>(i));
+        }
+    }
+}
+
+auto Layer::indexOf(Element* e) const -> Element::Index {
+    if (!this->index.contains(e)) {
+        return Element::InvalidIndex;
     }
 
-    return Element::InvalidIndex;
+    // The order keys increase along the list
+    double order = this->index.getOrder(e);
+    auto it = std::lower_bound(this->elements.begin(), this->elements.end(), order,
+                               [this](const Element* x, double o) { return this->index.getOrder(x) < o; });
+    if (it == this->elements.end() || *it != e) {
+        return Element::InvalidIndex;
+    }
+    return static_cast<Element::Index>(it - this->elements.begin());
 }
 
 auto Layer::removeElement(Element* e, bool free) -> Element::Index {
-    for (unsigned int i = 0; i < this->elements.size(); i++) {
-        if (e == this->elements[i]) {
-            this->elements.erase(this->elements.begin() + i);
+    Element::Index pos = indexOf(e);
+    if (pos == Element::InvalidIndex) {
+        g_warning("Could not remove element from layer, it's not on the layer!");
+        Stacktrace::printStracktrace();
+        return Element::InvalidIndex;
+    }
 
-            if (free) {
-                delete e;
-            }
-            return i;
-        }
+    this->elements.erase(this->elements.begin() + pos);
+    this->index.remove(e);
+    this->revision++;
+
+    if (free) {
+        delete e;
     }
+    return pos;
+}
 
-    g_warning("Could not remove element from layer, it's not on the layer!");
-    Stacktrace::printStracktrace();
-    return Element::InvalidIndex;
+void Layer::removeElements(const std::vector<Element*>& elements) {
+    std::unordered_set<const Element*> removed(elements.begin(), elements.end());
+    size_t kept = 0;
+    for (Element* e: this->elements) {
+        if (removed.count(e)) {
+            this->index.remove(e);
+        } else {
+            this->elements[kept++] = e;
+        }
+    }
+    if (kept == this->elements.size()) {
+        return;
+    }
+    this->elements.resize(kept);
+    this->revision++;
 }
 
-void Layer::clearNoFree() { this->elements.clear(); }
+void Layer::clearNoFree() {
+    this->elements.clear();
+    this->index.clear();
+    this->revision++;
+}
 
 auto Layer::isAnnotated() const -> bool { return !this->elements.empty(); }
 
@@ -106,12 +244,31 @@ auto Layer::isVisible() const -> bool { return visible; }
 /**
  * @return true if the layer is visible
  */
-void Layer::setVisible(bool visible) { this->visible = visible; }
+void Layer::setVisible(bool visible) {
+    this->visible = visible;
+    this->revision++;
+}
 
 auto Layer::getElements() const -> const std::vector<Element*>& { return this->elements; }
 
+auto Layer::getElementsInArea(const xoj::util::Rectangle<double>& area) const -> std::vector<Element*> {
+    return this->index.query(area);
+}
+
+void Layer::reindex() {
+    this->index.clear();
+    for (size_t i = 0; i < this->elements.size(); i++) {
+        this->index.insert(this->elements[i], static_cast<double>(i));
+    }
+}
+
 auto Layer::hasName() const -> bool { return name.has_value(); }
 
 auto Layer::getName() const -> std::string { return name.value_or(""); }
 
-void Layer::setName(const std::string& newName) { this->name = newName; }
+void Layer::setName(const std::string& newName) {
+    this->name = newName;
+    this->revision++;
+}
+
+auto Layer::getRevision() const -> uint64_t { return this->revision.load(); }
@@ -11,10 +11,16 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "util/Rectangle.h"
+
 #include "Element.h"
+#include "SpatialIndex.h"
 
 template <class T>
 using optional = std::optional<T>;
@@ -34,6 +40,13 @@ public:
      */
     void addElement(Element* e);
 
+    /**
+     * Appends Element%s to this Layer, in their order
+     *
+     * @note Unlike addElement(), does not check whether they are already contained in the Layer: they must not be
+     */
+    void addElements(const std::vector<Element*>& elements);
+
     /**
      * Inserts an Element in the specified position of the Layer%s internal list
      *
@@ -41,8 +54,19 @@ public:
      */
     void insertElement(Element* e, Element::Index pos);
 
+    /**
+     * Inserts Element%s in the specified positions of the Layer%s internal list, as successive calls to
+     * insertElement() in their order would
+     *
+     * @note Takes a single pass over the list when the positions strictly increase. The Element%s already contained in
+     * the Layer are skipped.
+     */
+    void insertElements(const std::vector<std::pair<Element*, Element::Index>>& elements);
+
     /**
      * Returns the index of the given Element with respect to the internal list
+     *
+     * @note Logarithmic in the number of Element%s: searches the order keys of the spatial index
      */
     Element::Index indexOf(Element* e) const;
 
@@ -51,6 +75,12 @@ public:
      */
     Element::Index removeElement(Element* e, bool free);
 
+    /**
+     * Removes Element%s from the Layer *without freeing them*, in a single pass over its list. The Element%s not
+     * contained in the Layer are ignored.
+     */
+    void removeElements(const std::vector<Element*>& elements);
+
     /**
      * Removes all Elements from the Layer *without freeing them*
      */
@@ -61,6 +91,21 @@ public:
      */
     const std::vector<Element*>& getElements() const;
 
+    /**
+     * Returns the Element%s whose bounding box intersects the given area, in the same order as in getElements()
+     *
+     * @note Uses the spatial index of the layer: the cost depends on the number of elements near the area, not on the
+     * total number of elements
+     */
+    std::vector<Element*> getElementsInArea(const xoj::util::Rectangle<double>& area) const;
+
+    /**
+     * Rebuilds the spatial index of the Layer from scratch
+     *
+     * Only required if the Element%s of this Layer were also added to, then removed from, another Layer
+     */
+    void reindex();
+
     /**
      * Returns whether or not the Layer is empty
      */
@@ -96,10 +141,25 @@ public:
      */
     void setName(const std::string& newName);
 
+    /**
+     * @return The revision of the layer, increased by every modification of its list of elements, of its visibility and
+     *         of its name. The modifications of the elements themselves only increase the revision of the page, see
+     *         PageHandler::getRevision(). Thread safe.
+     */
+    uint64_t getRevision() const;
+
 private:
     std::vector<Element*> elements;
 
+    /**
+     * Index of the elements' bounding boxes.
+     * The order keys registered in the index follow the order of the elements in the vector above.
+     */
+    SpatialIndex index;
+
     bool visible = true;
 
     optional<std::string> name;
+
+    std::atomic<uint64_t> revision{0};
 };
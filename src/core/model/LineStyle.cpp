@@ -1,35 +1,40 @@
 #include "LineStyle.h"
 
+#include <functional>
+
+#include "util/InternTable.h"
 #include "util/serializing/ObjectInputStream.h"
 #include "util/serializing/ObjectOutputStream.h"
 
 
-LineStyle::LineStyle() = default;
+namespace {
+struct DashesHash {
+    auto operator()(const std::vector<double>& dashes) const -> size_t {
+        size_t hash = dashes.size();
+        for (double d: dashes) { hash = hash * 31 + std::hash<double>()(d); }
+        return hash;
+    }
+};
 
-LineStyle::LineStyle(const LineStyle& other) { *this = other; }
+using DashesTable = xoj::util::InternTable<std::vector<double>, DashesHash>;
+}  // namespace
 
-LineStyle::~LineStyle() {
-    g_free(this->dashes);
-    this->dashes = nullptr;
-    this->dashCount = 0;
-}
+LineStyle::LineStyle() = default;
 
-void LineStyle::operator=(const LineStyle& other) {
-    if (this == &other) {
-        return;
-    }
-    const double* dashes = nullptr;
-    int dashCount = 0;
+LineStyle::LineStyle(const LineStyle& other) = default;
 
-    other.getDashes(dashes, dashCount);
-    setDashes(dashes, dashCount);
-}
+LineStyle::~LineStyle() = default;
+
+void LineStyle::operator=(const LineStyle& other) { this->dashes = other.dashes; }
 
 
 void LineStyle::serialize(ObjectOutputStream& out) const {
     out.writeObject("LineStyle");
 
-    out.writeData(this->dashes, this->dashCount, sizeof(double));
+    const double* data = nullptr;
+    int count = 0;
+    getDashes(data, count);
+    out.writeData(data, count, sizeof(double));
 
     out.endObject();
 }
@@ -37,10 +42,8 @@ void LineStyle::serialize(ObjectOutputStream& out) const {
 void LineStyle::readSerialized(ObjectInputStream& in) {
     in.readObject("LineStyle");
 
-    g_free(this->dashes);
-    this->dashes = nullptr;
-    this->dashCount = 0;
-    in.readData(reinterpret_cast<void**>(&this->dashes), &this->dashCount);
+    auto data = in.readData<double>();
+    setDashes(data.data(), static_cast<int>(data.size()));
 
     in.endObject();
 }
@@ -51,10 +54,15 @@ void LineStyle::readSerialized(ObjectInputStream& in) {
  * @return true if dashed
  */
 auto LineStyle::getDashes(const double*& dashes, int& dashCount) const -> bool {
-    dashes = this->dashes;
-    dashCount = this->dashCount;
+    if (!this->dashes) {
+        dashes = nullptr;
+        dashCount = 0;
+        return false;
+    }
+    dashes = this->dashes->data();
+    dashCount = static_cast<int>(this->dashes->size());
 
-    return this->dashCount > 0;
+    return true;
 }
 
 /**
@@ -63,19 +71,13 @@ auto LineStyle::getDashes(const double*& dashes, int& dashCount) const -> bool {
  * @param dashes Dash data, will be copied
  * @param dashCount Count of entries
  */
-// Todo(fabian): memmory use after free
 void LineStyle::setDashes(const double* dashes, int dashCount) {
-    g_free(this->dashes);
-    if (dashCount == 0 || dashes == nullptr) {
-        this->dashCount = 0;
-        this->dashes = nullptr;
+    if (dashCount <= 0 || dashes == nullptr) {
+        this->dashes.reset();
         return;
     }
 
-    this->dashes = static_cast<double*>(g_malloc(dashCount * sizeof(double)));
-    this->dashCount = dashCount;
-
-    memcpy(this->dashes, dashes, this->dashCount * sizeof(double));
+    this->dashes = DashesTable::instance().intern(std::vector<double>(dashes, dashes + dashCount));
 }
 
 /**
@@ -83,4 +85,4 @@ void LineStyle::setDashes(const double* dashes, int dashCount) {
  *
  * @return true if dashed
  */
-auto LineStyle::hasDashes() const -> bool { return this->dashCount > 0; }
+auto LineStyle::hasDashes() const -> bool { return this->dashes != nullptr; }
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -53,12 +54,8 @@ public:
 
 private:
     /**
-     * Dash definition (nullptr for no Dash)
+     * Dash definition (nullptr for no Dash). Interned: the strokes with the same dashes share them, see
+     * xoj::util::InternTable.
      */
-    double* dashes = nullptr;
-
-    /**
-     * Dash count (0 for no dash)
-     */
-    int dashCount = 0;
+    std::shared_ptr<const std::vector<double>> dashes;
 };
@@ -13,17 +13,25 @@ void PageHandler::addListener(PageListener* l) { this->listener.push_back(l); }
 void PageHandler::removeListener(PageListener* l) { this->listener.remove(l); }
 
 void PageHandler::fireRectChanged(Rectangle<double>& rect) {
+    increaseRevision();
     for (PageListener* pl: this->listener) { pl->rectChanged(rect); }
 }
 
 void PageHandler::fireRangeChanged(Range& range) {
+    increaseRevision();
     for (PageListener* pl: this->listener) { pl->rangeChanged(range); }
 }
 
 void PageHandler::fireElementChanged(Element* elem) {
+    increaseRevision();
     for (PageListener* pl: this->listener) { pl->elementChanged(elem); }
 }
 
 void PageHandler::firePageChanged() {
+    increaseRevision();
     for (PageListener* pl: this->listener) { pl->pageChanged(); }
 }
+
+auto PageHandler::getRevision() const -> uint64_t { return this->revision.load(std::memory_order_acquire); }
+
+void PageHandler::increaseRevision() { this->revision.fetch_add(1, std::memory_order_acq_rel); }
@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <list>
 #include <string>
 #include <vector>
@@ -33,6 +35,16 @@ public:
     void fireElementChanged(Element* elem);
     void firePageChanged();
 
+    /**
+     * @return The revision of the page, increased by every change of the page which is notified to its listeners (see
+     *         the fire...() methods) and by the setters of the page. Caches of the rendering of the page can compare it
+     *         with the revision they were filled at. Thread safe.
+     */
+    uint64_t getRevision() const;
+
+protected:
+    void increaseRevision();
+
 private:
     void addListener(PageListener* l);
     void removeListener(PageListener* l);
@@ -40,5 +52,7 @@ private:
 private:
     std::list<PageListener*> listener;
 
+    std::atomic<uint64_t> revision{0};
+
     friend class PageListener;
 };
@@ -0,0 +1,15 @@
+#include "PageSnapshot.h"
+
+#include "Layer.h"
+#include "XojPage.h"
+
+PageSnapshot::PageSnapshot(XojPage& page, const xoj::util::Rectangle<double>& area) {
+    for (Layer* layer: *page.getLayers()) {
+        if (layer->isVisible()) {
+            // The spatial index returns a copy
+            this->layers.push_back(layer->getElementsInArea(area));
+        }
+    }
+}
+
+auto PageSnapshot::getLayers() const -> const std::vector<std::vector<Element*>>& { return this->layers; }
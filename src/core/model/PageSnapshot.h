@@ -0,0 +1,44 @@
+/*
+ * Xournal++
+ *
+ * The elements of a page at one point in time
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "util/Rectangle.h"
+
+class Element;
+class XojPage;
+
+/**
+ * @brief The elements of the visible layers of a page in an area, copied with the page lock to be drawn without it
+ *
+ * The layers keep changing while the snapshot is drawn. The snapshot only holds pointers: see Document::lockSnapshot()
+ * for the lifetime of the elements.
+ */
+class PageSnapshot {
+public:
+    PageSnapshot() = default;
+
+    /**
+     * The caller holds the lock of the page
+     */
+    PageSnapshot(XojPage& page, const xoj::util::Rectangle<double>& area);
+
+public:
+    /**
+     * @return The elements of each visible layer in the area, from the bottom layer up, in the order of the layer
+     */
+    const std::vector<std::vector<Element*>>& getLayers() const;
+
+private:
+    std::vector<std::vector<Element*>> layers;
+};
@@ -0,0 +1,229 @@
+#include "SegmentKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SEGMENT_KERNELS_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SEGMENT_KERNELS_NEON
+#endif
+
+using xoj::util::Rectangle;
+
+namespace {
+
+/**
+ * The box and the constants of the hit test, computed once per test
+ */
+struct HitTest {
+    explicit HitTest(const SegmentKernels::HitBox& box):
+            x(box.x),
+            y(box.y),
+            halfSize(box.halfSize),
+            halfDiagonal(box.halfSize * std::sqrt(2.0)),
+            x1(box.x - box.halfSize),
+            x2(box.x + box.halfSize),
+            y1(box.y - box.halfSize),
+            y2(box.y + box.halfSize) {}
+
+    bool contains(const Point& p) const { return p.x >= x1 && p.y >= y1 && p.x <= x2 && p.y <= y2; }
+
+    /**
+     * @return The distance of the center to the middle of the segment, less the half diagonal
+     */
+    double distanceToMiddle(const Point& last, const Point& point) const {
+        double dx = x - (last.x + point.x) / 2;
+        double dy = y - (last.y + point.y) / 2;
+        return std::sqrt(dx * dx + dy * dy) - halfDiagonal;
+    }
+
+    bool hits(const Point& last, const Point& point) const {
+        if (contains(point)) {
+            return true;
+        }
+        double dx = point.x - last.x;
+        double dy = point.y - last.y;
+        double len = std::sqrt(dx * dx + dy * dy);
+        if (!(len >= halfSize)) {
+            return false;
+        }
+        // The distance of the center to the line through the segment
+        double p = std::abs((x - last.x) * (last.y - point.y) + (y - last.y) * (point.x - last.x)) / len;
+        // The center is in the circle around the middle of the segment, whose radius is its half length, the half
+        // diagonal of the box and the padding
+        return p <= halfSize && distanceToMiddle(last, point) <= len / 2 + SegmentKernels::HIT_PADDING;
+    }
+
+    double x;
+    double y;
+    double halfSize;
+    double halfDiagonal;
+    double x1;
+    double x2;
+    double y1;
+    double y2;
+};
+
+auto touches(const Point& p, const Point& q, const Rectangle<double>& area) -> bool {
+    return std::min(p.x, q.x) <= area.x + area.width && std::max(p.x, q.x) >= area.x &&
+           std::min(p.y, q.y) <= area.y + area.height && std::max(p.y, q.y) >= area.y;
+}
+
+#if defined(SEGMENT_KERNELS_SSE2)
+#define SEGMENT_KERNELS_VECTOR
+
+/**
+ * Two lanes of doubles, the first one for the first segment
+ */
+using Double2 = __m128d;
+using Mask2 = __m128d;
+
+inline auto set(double a, double b) -> Double2 { return _mm_set_pd(b, a); }
+inline auto splat(double a) -> Double2 { return _mm_set1_pd(a); }
+inline auto add(Double2 a, Double2 b) -> Double2 { return _mm_add_pd(a, b); }
+inline auto sub(Double2 a, Double2 b) -> Double2 { return _mm_sub_pd(a, b); }
+inline auto mul(Double2 a, Double2 b) -> Double2 { return _mm_mul_pd(a, b); }
+inline auto divide(Double2 a, Double2 b) -> Double2 { return _mm_div_pd(a, b); }
+inline auto squareRoot(Double2 a) -> Double2 { return _mm_sqrt_pd(a); }
+inline auto absolute(Double2 a) -> Double2 { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+inline auto lower(Double2 a, Double2 b) -> Double2 { return _mm_min_pd(a, b); }
+inline auto upper(Double2 a, Double2 b) -> Double2 { return _mm_max_pd(a, b); }
+inline auto le(Double2 a, Double2 b) -> Mask2 { return _mm_cmple_pd(a, b); }
+inline auto ge(Double2 a, Double2 b) -> Mask2 { return _mm_cmpge_pd(a, b); }
+inline auto both(Mask2 a, Mask2 b) -> Mask2 { return _mm_and_pd(a, b); }
+inline auto either(Mask2 a, Mask2 b) -> Mask2 { return _mm_or_pd(a, b); }
+/**
+ * @return Bit 0 for the first lane, bit 1 for the second one
+ */
+inline auto bits(Mask2 m) -> int { return _mm_movemask_pd(m); }
+
+#elif defined(SEGMENT_KERNELS_NEON)
+#define SEGMENT_KERNELS_VECTOR
+
+using Double2 = float64x2_t;
+using Mask2 = uint64x2_t;
+
+inline auto set(double a, double b) -> Double2 { return vcombine_f64(vdup_n_f64(a), vdup_n_f64(b)); }
+inline auto splat(double a) -> Double2 { return vdupq_n_f64(a); }
+inline auto add(Double2 a, Double2 b) -> Double2 { return vaddq_f64(a, b); }
+inline auto sub(Double2 a, Double2 b) -> Double2 { return vsubq_f64(a, b); }
+inline auto mul(Double2 a, Double2 b) -> Double2 { return vmulq_f64(a, b); }
+inline auto divide(Double2 a, Double2 b) -> Double2 { return vdivq_f64(a, b); }
+inline auto squareRoot(Double2 a) -> Double2 { return vsqrtq_f64(a); }
+inline auto absolute(Double2 a) -> Double2 { return vabsq_f64(a); }
+inline auto lower(Double2 a, Double2 b) -> Double2 { return vminq_f64(a, b); }
+inline auto upper(Double2 a, Double2 b) -> Double2 { return vmaxq_f64(a, b); }
+inline auto le(Double2 a, Double2 b) -> Mask2 { return vcleq_f64(a, b); }
+inline auto ge(Double2 a, Double2 b) -> Mask2 { return vcgeq_f64(a, b); }
+inline auto both(Mask2 a, Mask2 b) -> Mask2 { return vandq_u64(a, b); }
+inline auto either(Mask2 a, Mask2 b) -> Mask2 { return vorrq_u64(a, b); }
+inline auto bits(Mask2 m) -> int {
+    return static_cast<int>((vgetq_lane_u64(m, 0) & 1U) | ((vgetq_lane_u64(m, 1) & 1U) << 1U));
+}
+
+#endif
+
+}  // namespace
+
+auto SegmentKernels::findHit(const Point* points, size_t first, size_t last, const HitBox& box) -> size_t {
+    const HitTest test(box);
+    if (first > last) {
+        return last + 1;
+    }
+    if (test.contains(points[first])) {
+        return first;
+    }
+
+    size_t i = first + 1;
+#ifdef SEGMENT_KERNELS_VECTOR
+    const Double2 x = splat(test.x);
+    const Double2 y = splat(test.y);
+    const Double2 halfSize = splat(test.halfSize);
+    const Double2 halfDiagonal = splat(test.halfDiagonal);
+    const Double2 half = splat(0.5);
+    const Double2 padding = splat(HIT_PADDING);
+    const Double2 x1 = splat(test.x1);
+    const Double2 x2 = splat(test.x2);
+    const Double2 y1 = splat(test.y1);
+    const Double2 y2 = splat(test.y2);
+
+    // The segments i - 1 -> i and i -> i + 1
+    for (; i + 1 <= last; i += 2) {
+        const Point& a = points[i - 1];
+        const Point& b = points[i];
+        const Point& c = points[i + 1];
+        const Double2 lastX = set(a.x, b.x);
+        const Double2 lastY = set(a.y, b.y);
+        const Double2 px = set(b.x, c.x);
+        const Double2 py = set(b.y, c.y);
+
+        const Mask2 inside = both(both(ge(px, x1), ge(py, y1)), both(le(px, x2), le(py, y2)));
+
+        const Double2 dx = sub(px, lastX);
+        const Double2 dy = sub(py, lastY);
+        const Double2 len = squareRoot(add(mul(dx, dx), mul(dy, dy)));
+        const Double2 cross = add(mul(sub(x, lastX), sub(lastY, py)), mul(sub(y, lastY), sub(px, lastX)));
+        const Double2 p = divide(absolute(cross), len);
+
+        const Double2 mx = sub(x, mul(add(lastX, px), half));
+        const Double2 my = sub(y, mul(add(lastY, py), half));
+        const Double2 distance = sub(squareRoot(add(mul(mx, mx), mul(my, my))), halfDiagonal);
+
+        const Mask2 close =
+                both(both(ge(len, halfSize), le(p, halfSize)), le(distance, add(mul(len, half), padding)));
+        if (int hit = bits(either(inside, close))) {
+            return (hit & 1) ? i : i + 1;
+        }
+    }
+#endif
+
+    for (; i <= last; i++) {
+        if (test.hits(points[i - 1], points[i])) {
+            return i;
+        }
+    }
+    return last + 1;
+}
+
+auto SegmentKernels::getHitGap(const Point& last, const Point& point, const HitBox& box) -> double {
+    const HitTest test(box);
+    return test.contains(point) ? 0.0 : test.distanceToMiddle(last, point);
+}
+
+auto SegmentKernels::findSegmentTouching(const Point* points, size_t first, size_t last, const Rectangle<double>& area)
+        -> size_t {
+    size_t i = first;
+#ifdef SEGMENT_KERNELS_VECTOR
+    const Double2 minX = splat(area.x);
+    const Double2 maxX = splat(area.x + area.width);
+    const Double2 minY = splat(area.y);
+    const Double2 maxY = splat(area.y + area.height);
+
+    // The segments i -> i + 1 and i + 1 -> i + 2
+    for (; i + 1 <= last; i += 2) {
+        const Point& a = points[i];
+        const Point& b = points[i + 1];
+        const Point& c = points[i + 2];
+        const Double2 px = set(a.x, b.x);
+        const Double2 py = set(a.y, b.y);
+        const Double2 qx = set(b.x, c.x);
+        const Double2 qy = set(b.y, c.y);
+
+        const Mask2 touching = both(both(le(lower(px, qx), maxX), ge(upper(px, qx), minX)),
+                                    both(le(lower(py, qy), maxY), ge(upper(py, qy), minY)));
+        if (int hit = bits(touching)) {
+            return (hit & 1) ? i : i + 1;
+        }
+    }
+#endif
+
+    for (; i <= last; i++) {
+        if (touches(points[i], points[i + 1], area)) {
+            return i;
+        }
+    }
+    return last + 1;
+}
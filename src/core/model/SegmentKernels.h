@@ -0,0 +1,62 @@
+/*
+ * Xournal++
+ *
+ * Hit tests on runs of consecutive stroke segments
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "util/Rectangle.h"
+
+#include "Point.h"
+
+/**
+ * @brief The innermost loops of the hit tests of the strokes, two segments at a time
+ *
+ * The eraser, the selection and the hover tests go through the segments of the runs found by StrokeSegmentTree. The
+ * segments are tested two by two with SSE2 on x86-64 and NEON on AArch64, which are part of the base instruction
+ * sets there, or one by one on the other targets. All the targets give the same results.
+ */
+namespace SegmentKernels {
+
+/**
+ * The tolerance of the segment test of findHit()
+ */
+constexpr double HIT_PADDING = 0.1;
+
+/**
+ * The eraser box of Stroke::intersects(): a square of the given half size around the center
+ */
+struct HitBox {
+    double x;
+    double y;
+    double halfSize;
+};
+
+/**
+ * @return The first index i of [first, last] such that the point i is in the box, or (for i > first) the segment from
+ *         the point i - 1 to the point i passes close to the center of the box. last + 1 if there is none.
+ */
+size_t findHit(const Point* points, size_t first, size_t last, const HitBox& box);
+
+/**
+ * @return The gap reported by Stroke::intersects() for a hit found by findHit() on the segment from last to point: 0 if
+ *         the point is in the box, else the distance of the center of the box to the segment, less the half diagonal
+ *         of the box
+ */
+double getHitGap(const Point& last, const Point& point, const HitBox& box);
+
+/**
+ * @return The first index i of [first, last] such that the bounding box of the segment from the point i to the point
+ *         i + 1 intersects the area (closed). last + 1 if there is none.
+ */
+size_t findSegmentTouching(const Point* points, size_t first, size_t last, const xoj::util::Rectangle<double>& area);
+
+}  // namespace SegmentKernels
@@ -33,10 +33,14 @@ constexpr double rad(int n) { return rad(static_cast<double>(n)); }
 constexpr double deg(double a) { return a * 180.0 / M_PI; }
 inline double cathete(double h, double o) { return std::sqrt(std::pow(h, 2) - std::pow(o, 2)); }
 
-Setsquare::Setsquare(): height(INITIAL_HEIGHT), rotation(.0), translationX(INITIAL_X), translationY(INITIAL_Y) {}
+Setsquare::Setsquare(): height(INITIAL_HEIGHT), rotation(.0), translationX(INITIAL_X), translationY(INITIAL_Y) {
+    updateMatrix();
+}
 
 Setsquare::Setsquare(double height, double rotation, double x, double y):
-        height(height), rotation(rotation), translationX(x), translationY(y) {}
+        height(height), rotation(rotation), translationX(x), translationY(y) {
+    updateMatrix();
+}
 
 Setsquare::~Setsquare() {}
 
@@ -58,16 +62,28 @@ void Setsquare::updateValues() {
     maxHmark = static_cast<int>(std::floor(height * 10.0)) - SKIPPED_HMARKS;
 }
 
-void Setsquare::setHeight(double height) { this->height = height; }
+void Setsquare::setHeight(double height) {
+    this->height = height;
+    updateMatrix();
+}
 auto Setsquare::getHeight() const -> double { return this->height; }
 
-void Setsquare::setRotation(double rotation) { this->rotation = rotation; }
+void Setsquare::setRotation(double rotation) {
+    this->rotation = rotation;
+    updateMatrix();
+}
 auto Setsquare::getRotation() const -> double { return this->rotation; }
 
-void Setsquare::setTranslationX(double x) { this->translationX = x; }
+void Setsquare::setTranslationX(double x) {
+    this->translationX = x;
+    updateMatrix();
+}
 auto Setsquare::getTranslationX() const -> double { return this->translationX; }
 
-void Setsquare::setTranslationY(double y) { this->translationY = y; }
+void Setsquare::setTranslationY(double y) {
+    this->translationY = y;
+    updateMatrix();
+}
 auto Setsquare::getTranslationY() const -> double { return this->translationY; }
 
 auto Setsquare::getRadius() const -> double { return this->radius; }
@@ -75,25 +91,38 @@ auto Setsquare::getRadius() const -> double { return this->radius; }
 void Setsquare::move(double x, double y) {
     this->translationX += x;
     this->translationY += y;
+    updateMatrix();
 }
 
-void Setsquare::rotate(double da) { this->rotation += da; }
+void Setsquare::rotate(double da) {
+    this->rotation += da;
+    updateMatrix();
+}
+
+void Setsquare::scale(double f) {
+    this->height *= f;
+    updateMatrix();
+}
 
-void Setsquare::scale(double f) { this->height *= f; }
+void Setsquare::updateMatrix() {
+    cairo_matrix_init_identity(&this->matrix);
+    cairo_matrix_translate(&this->matrix, this->translationX, this->translationY);
+    cairo_matrix_rotate(&this->matrix, this->rotation);
+    cairo_matrix_scale(&this->matrix, CM, CM);
 
-void Setsquare::getMatrix(cairo_matrix_t& matrix) const {
-    cairo_matrix_init_identity(&matrix);
-    cairo_matrix_translate(&matrix, this->translationX, this->translationY);
-    cairo_matrix_rotate(&matrix, this->rotation);
-    cairo_matrix_scale(&matrix, CM, CM);
+    // A rotation and a uniform scaling: always invertible
+    this->inverseMatrix = this->matrix;
+    cairo_matrix_invert(&this->inverseMatrix);
 }
 
+void Setsquare::getMatrix(cairo_matrix_t& matrix) const { matrix = this->matrix; }
+
+void Setsquare::getInverseMatrix(cairo_matrix_t& matrix) const { matrix = this->inverseMatrix; }
+
 void Setsquare::paint(cairo_t* cr) {
     cairo_save(cr);
 
-    cairo_matrix_t matrix{};
-    getMatrix(matrix);
-    cairo_transform(cr, &matrix);
+    cairo_transform(cr, &this->matrix);
     cairo_set_line_width(cr, LINE_WIDTH);
     cairo_set_fill_rule(cr, CAIRO_FILL_RULE_EVEN_ODD);
     cairo_select_font_face(cr, "Arial", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
@@ -83,6 +83,13 @@ public:
      */
     void getMatrix(cairo_matrix_t& matrix) const;
 
+    /**
+     * @brief returns the matrix which translates from document coordinates to user coordinates, the inverse of
+     * getMatrix()
+     * @param matrix the matrix into which the result gets stored
+     */
+    void getInverseMatrix(cairo_matrix_t& matrix) const;
+
 private:
     /**
      * @brief the height of the setsquare (regarded as an isoceles triangle)
@@ -142,6 +149,18 @@ private:
      */
     int maxHmark = 70;
 
+    /**
+     * @brief the matrices of getMatrix() and getInverseMatrix(), computed once per change of the pose rather than on
+     * each input event
+     */
+    cairo_matrix_t matrix{};
+    cairo_matrix_t inverseMatrix{};
+
+    /**
+     * @brief updates the matrices from the height, the rotation and the translation
+     */
+    void updateMatrix();
+
     void drawVerticalMarks(cairo_t* cr) const;
     void drawHorizontalMarks(cairo_t* cr) const;
     void drawAngularMarks(cairo_t* cr) const;
@@ -0,0 +1,208 @@
+#include "SpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "Element.h"
+
+using xoj::util::Rectangle;
+
+SpatialIndex::~SpatialIndex() { clear(); }
+
+auto SpatialIndex::CellRange::cellCount() const -> size_t {
+    return static_cast<size_t>(maxX - minX + 1) * static_cast<size_t>(maxY - minY + 1);
+}
+
+auto SpatialIndex::cellRangeOf(const Rectangle<double>& rect) -> CellRange {
+    auto toCell = [](double v) {
+        // Clamp to avoid overflows with absurd coordinates
+        return static_cast<int32_t>(std::clamp(std::floor(v / CELL_SIZE), -1e9, 1e9));
+    };
+    return {toCell(rect.x), toCell(rect.y), toCell(rect.x + rect.width), toCell(rect.y + rect.height)};
+}
+
+auto SpatialIndex::cellKey(int32_t x, int32_t y) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32U) | static_cast<uint32_t>(y);
+}
+
+void SpatialIndex::insert(Element* e, double order) {
+    std::lock_guard lock(mutex);
+    auto [it, inserted] = entries.try_emplace(e, Entry{e, order});
+    if (!inserted) {
+        it->second.order = order;
+        return;
+    }
+    e->spatialIndex = this;
+    dirtyElements.push_back(e);
+}
+
+void SpatialIndex::remove(Element* e) {
+    std::lock_guard lock(mutex);
+    auto it = entries.find(e);
+    if (it == entries.end()) {
+        return;
+    }
+    unregisterEntry(it->second);
+    entries.erase(it);
+    if (e->spatialIndex == this) {
+        e->spatialIndex = nullptr;
+    }
+}
+
+void SpatialIndex::clear() {
+    std::lock_guard lock(mutex);
+    for (auto& [e, entry]: entries) {
+        if (entry.element->spatialIndex == this) {
+            entry.element->spatialIndex = nullptr;
+        }
+    }
+    entries.clear();
+    cells.clear();
+    oversized.clear();
+    dirtyElements.clear();
+}
+
+void SpatialIndex::markDirty(const Element* e) {
+    std::lock_guard lock(mutex);
+    auto it = entries.find(e);
+    if (it != entries.end() && !it->second.dirty) {
+        it->second.dirty = true;
+        dirtyElements.push_back(e);
+    }
+}
+
+auto SpatialIndex::contains(const Element* e) const -> bool {
+    std::lock_guard lock(mutex);
+    return entries.count(e) != 0;
+}
+
+auto SpatialIndex::getOrder(const Element* e) const -> double {
+    std::lock_guard lock(mutex);
+    auto it = entries.find(e);
+    return it == entries.end() ? 0.0 : it->second.order;
+}
+
+void SpatialIndex::setOrder(const Element* e, double order) {
+    std::lock_guard lock(mutex);
+    auto it = entries.find(e);
+    if (it != entries.end()) {
+        it->second.order = order;
+    }
+}
+
+void SpatialIndex::registerEntry(Entry& entry) const {
+    entry.bounds = entry.element->boundingRect();
+    entry.cells = cellRangeOf(entry.bounds);
+    entry.oversized = entry.cells.cellCount() > MAX_CELLS_PER_ELEMENT;
+
+    if (entry.oversized) {
+        oversized.push_back(entry.element);
+    } else {
+        for (int32_t x = entry.cells.minX; x <= entry.cells.maxX; x++) {
+            for (int32_t y = entry.cells.minY; y <= entry.cells.maxY; y++) {
+                cells[cellKey(x, y)].push_back(entry.element);
+            }
+        }
+    }
+    entry.indexed = true;
+}
+
+void SpatialIndex::unregisterEntry(Entry& entry) const {
+    if (!entry.indexed) {
+        return;
+    }
+    auto eraseFrom = [e = entry.element](std::vector<Element*>& v) {
+        auto it = std::find(v.begin(), v.end(), e);
+        if (it != v.end()) {
+            *it = v.back();
+            v.pop_back();
+        }
+    };
+
+    if (entry.oversized) {
+        eraseFrom(oversized);
+    } else {
+        for (int32_t x = entry.cells.minX; x <= entry.cells.maxX; x++) {
+            for (int32_t y = entry.cells.minY; y <= entry.cells.maxY; y++) {
+                auto it = cells.find(cellKey(x, y));
+                if (it != cells.end()) {
+                    eraseFrom(it->second);
+                    if (it->second.empty()) {
+                        cells.erase(it);
+                    }
+                }
+            }
+        }
+    }
+    entry.indexed = false;
+}
+
+void SpatialIndex::flush() const {
+    for (const Element* e: dirtyElements) {
+        auto it = entries.find(e);
+        if (it == entries.end() || !it->second.dirty) {
+            // Removed, or already handled through a duplicate
+            continue;
+        }
+        auto& entry = it->second;
+        unregisterEntry(entry);
+        registerEntry(entry);
+        entry.dirty = false;
+    }
+    dirtyElements.clear();
+}
+
+auto SpatialIndex::query(const Rectangle<double>& area) const -> std::vector<Element*> {
+    std::lock_guard lock(mutex);
+    flush();
+
+    auto intersects = [&area](const Rectangle<double>& b) {
+        return b.x <= area.x + area.width && area.x <= b.x + b.width && b.y <= area.y + area.height &&
+               area.y <= b.y + b.height;
+    };
+
+    std::vector<const Entry*> result;
+    CellRange range = cellRangeOf(area);
+    if (range.cellCount() >= entries.size()) {
+        // Large area: walking the grid would cost more than testing every element
+        for (auto& [e, entry]: entries) {
+            if (intersects(entry.bounds)) {
+                result.push_back(&entry);
+            }
+        }
+    } else {
+        for (int32_t x = range.minX; x <= range.maxX; x++) {
+            for (int32_t y = range.minY; y <= range.maxY; y++) {
+                auto it = cells.find(cellKey(x, y));
+                if (it == cells.end()) {
+                    continue;
+                }
+                for (Element* e: it->second) {
+                    const Entry& entry = entries.at(e);
+                    // Only report an element from the first cell it shares with the area, to avoid duplicates
+                    if (x != std::max(entry.cells.minX, range.minX) || y != std::max(entry.cells.minY, range.minY)) {
+                        continue;
+                    }
+                    if (intersects(entry.bounds)) {
+                        result.push_back(&entry);
+                    }
+                }
+            }
+        }
+        for (Element* e: oversized) {
+            const Entry& entry = entries.at(e);
+            if (intersects(entry.bounds)) {
+                result.push_back(&entry);
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const Entry* a, const Entry* b) { return a->order < b->order; });
+
+    std::vector<Element*> elements;
+    elements.reserve(result.size());
+    std::transform(result.begin(), result.end(), std::back_inserter(elements),
+                   [](const Entry* entry) { return entry->element; });
+    return elements;
+}
@@ -0,0 +1,136 @@
+/*
+ * Xournal++
+ *
+ * Uniform grid indexing the Elements of a Layer by their bounding boxes
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "util/Rectangle.h"
+
+class Element;
+
+/**
+ * @brief Spatial index over the elements of a Layer.
+ *
+ * Every element is stored in the cells of a uniform grid covered by its bounding box. Elements covering too many
+ * cells are kept in a separate list and are always returned as candidates.
+ *
+ * Elements notify the index whenever their bounds change (see Element::boundsChanged()). Those notifications are
+ * cheap: the element is only flagged and the grid is updated lazily on the next query. This way, loading a file
+ * or adding the points of a stroke one by one does not trigger any bounding box computation.
+ *
+ * Each element is also given an order key, so that queries can return the elements in their z-order.
+ */
+class SpatialIndex final {
+public:
+    SpatialIndex() = default;
+    ~SpatialIndex();
+
+    SpatialIndex(const SpatialIndex&) = delete;
+    SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+public:
+    /**
+     * @brief Adds an element to the index. The element will notify this index of its changes.
+     * @param order Key defining the z-order of the elements returned by query()
+     */
+    void insert(Element* e, double order);
+
+    /**
+     * @brief Removes an element from the index
+     */
+    void remove(Element* e);
+
+    /**
+     * @brief Removes all elements from the index
+     */
+    void clear();
+
+    /**
+     * @return Whether the element is in the index
+     */
+    bool contains(const Element* e) const;
+
+    /**
+     * @brief Flags the element so that its position in the grid is recomputed before the next query
+     */
+    void markDirty(const Element* e);
+
+    /**
+     * @return The order key of the element, or 0 if it is not in the index
+     */
+    double getOrder(const Element* e) const;
+
+    /**
+     * @brief Changes the order key of an element of the index
+     */
+    void setOrder(const Element* e, double order);
+
+    /**
+     * @brief Get all the elements whose bounding box intersects the given area, sorted by their order key
+     */
+    std::vector<Element*> query(const xoj::util::Rectangle<double>& area) const;
+
+private:
+    struct CellRange {
+        int32_t minX;
+        int32_t minY;
+        int32_t maxX;
+        int32_t maxY;
+
+        size_t cellCount() const;
+    };
+
+    struct Entry {
+        Element* element;
+        double order;
+        xoj::util::Rectangle<double> bounds{};
+        CellRange cells{};
+
+        /// The element is registered in the grid (or in the oversized list)
+        bool indexed = false;
+        /// The element's bounds changed since it was registered
+        bool dirty = true;
+        /// The element covers too many cells to be stored in the grid
+        bool oversized = false;
+    };
+
+    static CellRange cellRangeOf(const xoj::util::Rectangle<double>& rect);
+    static uint64_t cellKey(int32_t x, int32_t y);
+
+    void flush() const;
+    void registerEntry(Entry& entry) const;
+    void unregisterEntry(Entry& entry) const;
+
+private:
+    /**
+     * Side length of a grid cell, in page coordinates
+     */
+    static constexpr double CELL_SIZE = 64.0;
+
+    /**
+     * Elements covering more cells than that are stored in the oversized list
+     */
+    static constexpr size_t MAX_CELLS_PER_ELEMENT = 64;
+
+    mutable std::mutex mutex;
+
+    mutable std::unordered_map<const Element*, Entry> entries;
+
+    mutable std::unordered_map<uint64_t, std::vector<Element*>> cells;
+    mutable std::vector<Element*> oversized;
+
+    /// Elements waiting for their grid cells to be recomputed (may contain duplicates or removed elements)
+    mutable std::vector<const Element*> dirtyElements;
+};
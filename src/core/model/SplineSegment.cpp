@@ -1,5 +1,8 @@
 #include "SplineSegment.h"
 
+#include <algorithm>
+#include <cmath>
+
 SplineSegment::SplineSegment(const Point& p, const Point& q):
         firstKnot(p), firstControlPoint(p), secondKnot(q), secondControlPoint(q) {}
 
@@ -16,14 +19,25 @@ void SplineSegment::draw(cairo_t* cr) const {
                    secondKnot.x, secondKnot.y);
 }
 
-auto SplineSegment::toPointSequence(bool usePressure) const -> std::list<Point> {
-    if (isFlatEnough(usePressure)) {
-        return {firstKnot};
+/**
+ * With 2^10 pieces at most, a spline segment a meter long is still flattened to about a millimeter
+ */
+constexpr int MAX_SUBDIVISION_DEPTH = 10;
+
+auto SplineSegment::toPointSequence(bool usePressure, double tolerance) const -> std::list<Point> {
+    std::list<Point> points;
+    appendPoints(points, usePressure, tolerance, MAX_SUBDIVISION_DEPTH);
+    return points;
+}
+
+void SplineSegment::appendPoints(std::list<Point>& points, bool usePressure, double tolerance, int depth) const {
+    if (depth == 0 || isFlatEnough(usePressure, tolerance)) {
+        points.push_back(firstKnot);
+        return;
     }
     auto const& childSegments = subdivide(0.5, usePressure);
-    auto left_points = childSegments.first.toPointSequence(usePressure);
-    left_points.splice(end(left_points), childSegments.second.toPointSequence(usePressure));
-    return left_points;
+    childSegments.first.appendPoints(points, usePressure, tolerance, depth - 1);
+    childSegments.second.appendPoints(points, usePressure, tolerance, depth - 1);
 }
 
 auto SplineSegment::subdivide(float t, bool usePressure) const -> std::pair<SplineSegment, SplineSegment> {
@@ -53,15 +67,31 @@ auto SplineSegment::linearInterpolate(const Point& p, const Point& q, float t) -
     return Point(p.x * (1 - t) + q.x * t, p.y * (1 - t) + q.y * t);
 }
 
-constexpr double FLATNESS_TOLERANCE = 1.0001;
-constexpr double MIN_KNOT_DISTANCE = 0.3;
 constexpr double MAX_WIDTH_VARIATION = 0.1;
 
-auto SplineSegment::isFlatEnough(bool usePressure) const -> bool {
-    double l1 = firstKnot.lineLengthTo(firstControlPoint);
-    double l2 = firstControlPoint.lineLengthTo(secondControlPoint);
-    double l3 = secondControlPoint.lineLengthTo(secondKnot);
-    double l = firstKnot.lineLengthTo(secondKnot);
-    return l < MIN_KNOT_DISTANCE || (l1 + l2 + l3 < FLATNESS_TOLERANCE * l &&
-                                     ((!usePressure) || std::abs(firstKnot.z - secondKnot.z) <= MAX_WIDTH_VARIATION));
+auto SplineSegment::isFlatEnough(bool usePressure, double tolerance) const -> bool {
+    if (usePressure && std::abs(firstKnot.z - secondKnot.z) > MAX_WIDTH_VARIATION) {
+        return false;
+    }
+
+    double dx = secondKnot.x - firstKnot.x;
+    double dy = secondKnot.y - firstKnot.y;
+    double l = std::hypot(dx, dy);
+    if (l < tolerance) {
+        // The knots (almost) coincide: the distances to the first knot bound the deviation
+        return std::max(firstKnot.lineLengthTo(firstControlPoint), firstKnot.lineLengthTo(secondControlPoint)) <=
+               tolerance;
+    }
+
+    auto isCloseToChord = [&](const Point& c) {
+        // Distance to the line through the knots and position along it, both scaled by l
+        double normal = dx * (c.y - firstKnot.y) - dy * (c.x - firstKnot.x);
+        double along = dx * (c.x - firstKnot.x) + dy * (c.y - firstKnot.y);
+        return std::abs(normal) <= tolerance * l && along >= -tolerance * l && along <= (l + tolerance) * l;
+    };
+    return isCloseToChord(firstControlPoint) && isCloseToChord(secondControlPoint);
+}
+
+auto SplineSegment::toleranceForZoom(double zoom) -> double {
+    return std::min(DEFAULT_TOLERANCE, PIXEL_TOLERANCE / zoom);
 }
@@ -59,9 +59,12 @@ public:
     /**
      * @brief Convert the spline segment to a list of points.
      * @param usePressure If true, interpolate the pressure along the spline. Default: false
+     * @param tolerance The maximal distance between the spline segment and the polyline, see isFlatEnough()
      * @return A point list which represents the spline segment without the end point.
+     *
+     * The segment is subdivided where it is curved only: the straight parts give few points.
      */
-    std::list<Point> toPointSequence(bool usePressure = false) const;
+    std::list<Point> toPointSequence(bool usePressure = false, double tolerance = DEFAULT_TOLERANCE) const;
 
     /**
      * @brief Subdivide the spline into two parts with respect to parameter t.
@@ -83,9 +86,33 @@ public:
     /**
      * @brief checks if the spline segment is flat enough so that it can be drawn as a straight line
      * @param usePressure If true, return false if the endpoints' pressure values are to far appart. Default: false.
+     * @param tolerance The maximal distance of the control points to the line between the knots. The spline segment
+     * lies within 3/4 of this distance from the line.
      * @return true, if the spline segment is flat enough; false otherwise
      */
-    bool isFlatEnough(bool usePressure = false) const;
+    bool isFlatEnough(bool usePressure = false, double tolerance = DEFAULT_TOLERANCE) const;
+
+    /**
+     * @brief The tolerance for a spline segment drawn at the given zoom: DEFAULT_TOLERANCE, finer when zoomed in
+     * enough for it to be more than PIXEL_TOLERANCE on screen
+     */
+    static double toleranceForZoom(double zoom);
+
+    /**
+     * @brief The default tolerance, in document coordinates
+     */
+    static constexpr double DEFAULT_TOLERANCE = 0.1;
+
+    /**
+     * @brief The on screen tolerance of toleranceForZoom(), in pixels
+     */
+    static constexpr double PIXEL_TOLERANCE = 0.25;
+
+private:
+    /**
+     * @brief The recursion of toPointSequence(), subdividing at most depth times
+     */
+    void appendPoints(std::list<Point>& points, bool usePressure, double tolerance, int depth) const;
 
 
 public:
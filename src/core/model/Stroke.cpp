@@ -5,6 +5,7 @@
 
 #include "eraser/PaddedBox.h"
 #include "util/Interval.h"
+#include "util/ObjectPool.h"
 #include "util/PairView.h"
 #include "util/SmallVector.h"
 #include "util/TinyVector.h"
@@ -14,6 +15,7 @@
 #include "util/serializing/ObjectOutputStream.h"
 
 #include "PathParameter.h"
+#include "SegmentKernels.h"
 #include "config-debug.h"
 
 using xoj::util::Rectangle;
@@ -28,31 +30,16 @@ using xoj::util::Rectangle;
 #define DEBUG_ERASER(f)
 #endif
 
-template <typename Float>
-constexpr void updateBounds(Float& x, Float& y, Float& width, Float& height, Rectangle<Float>& snap, Point const& p,
-                            double half_width) {
-    {
-        Float x2 = x + width;
-        Float y2 = y + height;
-
-        x = std::min(x, p.x - half_width);
-        y = std::min(y, p.y - half_width);
-        x2 = std::max(x2, p.x + half_width);
-        y2 = std::max(y2, p.y + half_width);
-        width = x2 - x;
-        height = y2 - y;
-    }
-    {
-        Float snapx2 = snap.x + snap.width;
-        Float snapy2 = snap.y + snap.height;
-
-        snap.x = std::min(snap.x, p.x);
-        snap.y = std::min(snap.y, p.y);
-        snapx2 = std::max(snapx2, p.x);
-        snapy2 = std::max(snapy2, p.y);
-        snap.width = snapx2 - snap.x;
-        snap.height = snapy2 - snap.y;
-    }
+/**
+ * Extend the box to the point
+ */
+static void includePoint(Rectangle<double>& box, const Point& p) {
+    double x2 = std::max(box.x + box.width, p.x);
+    double y2 = std::max(box.y + box.height, p.y);
+    box.x = std::min(box.x, p.x);
+    box.y = std::min(box.y, p.y);
+    box.width = x2 - box.x;
+    box.height = y2 - box.y;
 }
 
 
@@ -60,6 +47,29 @@ Stroke::Stroke(): AudioElement(ELEMENT_STROKE) {}
 
 Stroke::~Stroke() = default;
 
+/**
+ * Never destroyed: strokes may be freed by static destructors
+ */
+static auto strokePool() -> xoj::util::ObjectPool& {
+    static auto* pool = new xoj::util::ObjectPool(sizeof(Stroke));
+    return *pool;
+}
+
+auto Stroke::operator new(size_t size) -> void* {
+    if (size != sizeof(Stroke)) {
+        return ::operator new(size);
+    }
+    return strokePool().allocate();
+}
+
+void Stroke::operator delete(void* p, size_t size) noexcept {
+    if (size != sizeof(Stroke)) {
+        ::operator delete(p);
+        return;
+    }
+    strokePool().deallocate(p);
+}
+
 /**
  * Clone style attributes, but not the data (position, pressure etc.)
  */
@@ -77,12 +87,19 @@ void Stroke::applyStyleFrom(const Stroke* other) {
 auto Stroke::cloneStroke() const -> Stroke* {
     auto* s = new Stroke();
     s->applyStyleFrom(this);
+    // The points, packed or not, and the caches computed from them are shared until one of the strokes changes them
+    s->compactPoints = this->compactPoints;
     s->points = this->points;
+    s->cairoPath = std::atomic_load(&this->cairoPath);
+    s->simplifiedPath = std::atomic_load(&this->simplifiedPath);
+    s->detail = std::atomic_load(&this->detail);
+    s->segmentTree = std::atomic_load(&this->segmentTree);
     s->x = this->x;
     s->y = this->y;
     s->Element::width = this->Element::width;
     s->Element::height = this->Element::height;
     s->snappedBounds = this->snappedBounds;
+    s->maxPressure = this->maxPressure;
     s->sizeCalculated = this->sizeCalculated;
     return s;
 }
@@ -90,6 +107,7 @@ auto Stroke::cloneStroke() const -> Stroke* {
 auto Stroke::clone() const -> Element* { return this->cloneStroke(); }
 
 std::unique_ptr<Stroke> Stroke::cloneSection(const PathParameter& lowerBound, const PathParameter& upperBound) const {
+    unpackPoints();
     assert(lowerBound.isValid() && upperBound.isValid());
     assert(lowerBound <= upperBound);
     assert(upperBound.index < this->points.size() - 1);
@@ -97,24 +115,26 @@ std::unique_ptr<Stroke> Stroke::cloneSection(const PathParameter& lowerBound, co
     auto s = std::make_unique<Stroke>();
     s->applyStyleFrom(this);
 
-    s->points.reserve(upperBound.index - lowerBound.index + 2);
+    std::vector<Point>& points = s->points.mut();
+    points.reserve(upperBound.index - lowerBound.index + 2);
 
-    s->points.emplace_back(this->getPoint(lowerBound));
+    points.emplace_back(this->getPoint(lowerBound));
 
     auto beginIt = std::next(this->points.cbegin(), (std::ptrdiff_t)lowerBound.index + 1);
     auto endIt = std::next(this->points.cbegin(), (std::ptrdiff_t)upperBound.index + 1);
-    std::copy(beginIt, endIt, std::back_inserter(s->points));
+    std::copy(beginIt, endIt, std::back_inserter(points));
 
-    s->points.emplace_back(this->getPoint(upperBound));
+    points.emplace_back(this->getPoint(upperBound));
 
     // Remove unused pressure value
-    s->points.back().z = Point::NO_PRESSURE;
+    points.back().z = Point::NO_PRESSURE;
 
     return s;
 }
 
 std::unique_ptr<Stroke> Stroke::cloneCircularSectionOfClosedStroke(const PathParameter& startParam,
                                                                    const PathParameter& endParam) const {
+    unpackPoints();
     assert(startParam.isValid() && endParam.isValid());
     assert(endParam < startParam);
     assert(startParam.index < this->points.size() - 1);
@@ -122,27 +142,29 @@ std::unique_ptr<Stroke> Stroke::cloneCircularSectionOfClosedStroke(const PathPar
     auto s = std::make_unique<Stroke>();
     s->applyStyleFrom(this);
 
-    s->points.reserve(this->points.size() - startParam.index + endParam.index + 1);
+    std::vector<Point>& points = s->points.mut();
+    points.reserve(this->points.size() - startParam.index + endParam.index + 1);
 
-    s->points.emplace_back(this->getPoint(startParam));
+    points.emplace_back(this->getPoint(startParam));
 
     auto startIt = std::next(this->points.cbegin(), (std::ptrdiff_t)startParam.index + 1);
     // Skip the last point: points.back().equalPos(points.front()) == true and we want this point only once
     assert(startIt != this->points.cend());
-    std::copy(startIt, std::prev(this->points.cend()), std::back_inserter(s->points));
+    std::copy(startIt, std::prev(this->points.cend()), std::back_inserter(points));
 
     auto endIt = std::next(this->points.cbegin(), (std::ptrdiff_t)endParam.index + 1);
-    std::copy(this->points.cbegin(), endIt, std::back_inserter(s->points));
+    std::copy(this->points.cbegin(), endIt, std::back_inserter(points));
 
-    s->points.emplace_back(this->getPoint(endParam));
+    points.emplace_back(this->getPoint(endParam));
 
     // Remove unused pressure value
-    s->points.back().z = Point::NO_PRESSURE;
+    points.back().z = Point::NO_PRESSURE;
 
     return s;
 }
 
 void Stroke::serialize(ObjectOutputStream& out) const {
+    unpackPoints();
     out.writeObject("Stroke");
 
     this->AudioElement::serialize(out);
@@ -155,7 +177,7 @@ void Stroke::serialize(ObjectOutputStream& out) const {
 
     out.writeInt(this->capStyle);
 
-    out.writeData(this->points.data(), this->points.size(), sizeof(Point));
+    out.writeData(this->points.get());
 
     this->lineStyle.serialize(out);
 
@@ -175,11 +197,11 @@ void Stroke::readSerialized(ObjectInputStream& in) {
 
     this->capStyle = static_cast<StrokeCapStyle>(in.readInt());
 
-    Point* p{};
-    int count{};
-    in.readData(reinterpret_cast<void**>(&p), &count);
-    this->points = std::vector<Point>{p, p + count};
-    g_free(p);
+    this->compactPoints.clear();
+    this->points = in.readData<Point>();
+    this->sizeCalculated = false;
+    this->headBoundsValid = false;
+    pointsChanged();
     this->lineStyle.readSerialized(in);
 
     in.endObject();
@@ -203,13 +225,20 @@ auto Stroke::getFill() const -> int { return fill; }
  */
 void Stroke::setFill(int fill) { this->fill = fill; }
 
-void Stroke::setWidth(double width) { this->width = width; }
+void Stroke::setWidth(double width) {
+    this->width = width;
+    if (this->sizeCalculated && !this->points.empty()) {
+        setBounds(Element::snappedBounds, this->maxPressure);
+    }
+    boundsChanged();
+}
 
 auto Stroke::getWidth() const -> double { return this->width; }
 
 auto Stroke::rescaleWithMirror() -> bool { return true; }
 
 auto Stroke::isInSelection(ShapeContainer* container) const -> bool {
+    unpackPoints();
     for (auto&& p: this->points) {
         double px = p.x;
         double py = p.y;
@@ -223,44 +252,105 @@ auto Stroke::isInSelection(ShapeContainer* container) const -> bool {
 }
 
 void Stroke::setFirstPoint(double x, double y) {
+    unpackPoints();
     if (!this->points.empty()) {
-        Point& p = this->points.front();
-        p.x = x;
-        p.y = y;
-        this->sizeCalculated = false;
+        Point& p = this->points.mut().front();
+        if (this->sizeCalculated && isInnerPoint(p)) {
+            p.x = x;
+            p.y = y;
+            includePoint(Element::snappedBounds, p);
+            setBounds(Element::snappedBounds, this->maxPressure);
+        } else {
+            p.x = x;
+            p.y = y;
+            this->sizeCalculated = false;
+        }
+        this->headBoundsValid = false;
+        boundsChanged();
+        pointsChanged();
     }
 }
 
 void Stroke::setLastPoint(double x, double y) { setLastPoint({x, y}); }
 
 void Stroke::setLastPoint(const Point& p) {
+    unpackPoints();
     if (!this->points.empty()) {
-        this->points.back() = p;
-        this->sizeCalculated = false;
+        this->points.mut().back() = p;
+        updateBoundsOfLastPoint();
+        boundsChanged();
+        pointsChanged();
     }
 }
 
 void Stroke::addPoint(const Point& p) {
-    this->points.emplace_back(p);
-    updateBounds(Element::x, Element::y, Element::width, Element::height, Element::snappedBounds, p,
-                 hasPressure() ? p.z / 2.0 : this->width / 2.0);
+    unpackPoints();
+    if (this->headBoundsValid) {
+        const Point& last = this->points.back();
+        includePoint(this->headBounds, last);
+        this->headMaxPressure = std::max(this->headMaxPressure, last.z);
+    } else if (this->points.size() == 1) {
+        const Point& first = this->points.front();
+        this->headBounds = Rectangle<double>(first.x, first.y, 0, 0);
+        this->headMaxPressure = first.z;
+        this->headBoundsValid = true;
+    }
+    this->points.mut().emplace_back(p);
+
+    if (this->headBoundsValid || this->points.size() == 1) {
+        updateBoundsOfLastPoint();
+    } else if (this->sizeCalculated) {
+        includePoint(Element::snappedBounds, p);
+        setBounds(Element::snappedBounds, std::max(this->maxPressure, p.z));
+    }
+    boundsChanged();
+    pointsChanged();
 }
 
-auto Stroke::getPointCount() const -> int { return this->points.size(); }
+auto Stroke::getPointCount() const -> int {
+    unpackPoints();
+    return this->points.size();
+}
 
-auto Stroke::getPointVector() const -> std::vector<Point> const& { return points; }
+auto Stroke::getPointVector() const -> std::vector<Point> const& {
+    unpackPoints();
+    return points;
+}
 
-void Stroke::deletePointsFrom(int index) {
-    points.resize(std::min(size_t(index), points.size()));
+void Stroke::setPointVector(std::vector<Point> other) {
+    this->compactPoints.clear();
+    this->points = std::move(other);
     this->sizeCalculated = false;
+    this->headBoundsValid = false;
+    boundsChanged();
+    pointsChanged();
+}
+
+void Stroke::deletePointsFrom(int index) {
+    unpackPoints();
+    const size_t count = std::min(size_t(index), points.size());
+    // The box stays the same without the inner points
+    bool inner = this->sizeCalculated && count > 0;
+    for (size_t i = count; inner && i < points.size(); i++) { inner = isInnerPoint(points[i]); }
+    points.mut().resize(count);
+    this->sizeCalculated = inner;
+    this->headBoundsValid = false;
+    boundsChanged();
+    pointsChanged();
 }
 
 void Stroke::deletePoint(int index) {
-    this->points.erase(std::next(begin(this->points), index));
-    this->sizeCalculated = false;
+    unpackPoints();
+    this->sizeCalculated = this->sizeCalculated && this->points.size() > 1 && isInnerPoint(this->points[index]);
+    this->headBoundsValid = false;
+    std::vector<Point>& points = this->points.mut();
+    points.erase(std::next(begin(points), index));
+    boundsChanged();
+    pointsChanged();
 }
 
 auto Stroke::getPoint(int index) const -> Point {
+    unpackPoints();
     if (index < 0 || index >= this->points.size()) {
         g_warning("Stroke::getPoint(%i) out of bounds!", index);
         return Point(0, 0, Point::NO_PRESSURE);
@@ -269,6 +359,7 @@ auto Stroke::getPoint(int index) const -> Point {
 }
 
 Point Stroke::getPoint(PathParameter parameter) const {
+    unpackPoints();
     assert(parameter.isValid() && parameter.index < this->points.size() - 1);
 
     const Point& p = this->points[parameter.index];
@@ -282,26 +373,99 @@ Point Stroke::getPoint(PathParameter parameter) const {
     return p.relativeLineTo(q, parameter.t);
 }
 
-auto Stroke::getPoints() const -> const Point* { return this->points.data(); }
+auto Stroke::getPoints() const -> const Point* {
+    unpackPoints();
+    return this->points.data();
+}
+
+void Stroke::freeUnusedPointItems() {
+    unpackPoints();
+    this->points = std::vector<Point>(this->points.begin(), this->points.end());
+}
+
+void Stroke::compact() {
+    this->compactPoints.pack(this->points);
+    // Not needed until the stroke is drawn again
+    pointsChanged();
+}
+
+auto Stroke::isCompact() const -> bool { return this->compactPoints.isPacked(); }
+
+auto Stroke::getMemoryUsage() const -> size_t {
+    return sizeof(Stroke) + this->points.capacity() * sizeof(Point) + this->compactPoints.getMemoryUsage();
+}
+
+auto Stroke::getCairoPath() const -> std::shared_ptr<const StrokeCairoPath> {
+    auto path = std::atomic_load(&this->cairoPath);
+    if (!path) {
+        path = StrokeCairoPath::create(getPointVector());
+        std::atomic_store(&this->cairoPath, path);
+    }
+    return path;
+}
+
+auto Stroke::getSimplifiedCairoPath(double tolerance) const -> std::shared_ptr<const StrokeCairoPath> {
+    // Rounded down, the path is never coarser than asked for
+    const double rounded = std::exp2(std::floor(std::log2(tolerance)));
+    auto path = std::atomic_load(&this->simplifiedPath);
+    if (!path || path->getTolerance() != rounded) {
+        path = StrokeCairoPath::create(getPointVector(), *getDetail(), rounded);
+        std::atomic_store(&this->simplifiedPath, path);
+    }
+    return path;
+}
+
+auto Stroke::getDetail() const -> std::shared_ptr<const StrokeDetail> {
+    auto d = std::atomic_load(&this->detail);
+    if (!d) {
+        d = std::make_shared<const StrokeDetail>(getPointVector());
+        std::atomic_store(&this->detail, d);
+    }
+    return d;
+}
+
+auto Stroke::getSegmentTree() const -> std::shared_ptr<const StrokeSegmentTree> {
+    if (getPointCount() < MIN_POINTS_FOR_SEGMENT_TREE) {
+        return nullptr;
+    }
+    auto tree = std::atomic_load(&this->segmentTree);
+    if (!tree) {
+        tree = std::make_shared<const StrokeSegmentTree>(getPointVector());
+        std::atomic_store(&this->segmentTree, tree);
+    }
+    return tree;
+}
 
-void Stroke::freeUnusedPointItems() { this->points = {begin(this->points), end(this->points)}; }
+void Stroke::pointsChanged() {
+    std::atomic_store(&this->cairoPath, std::shared_ptr<const StrokeCairoPath>());
+    std::atomic_store(&this->simplifiedPath, std::shared_ptr<const StrokeCairoPath>());
+    std::atomic_store(&this->detail, std::shared_ptr<const StrokeDetail>());
+    std::atomic_store(&this->segmentTree, std::shared_ptr<const StrokeSegmentTree>());
+}
 
 void Stroke::setToolType(StrokeTool type) { this->toolType = type; }
 
 auto Stroke::getToolType() const -> StrokeTool { return this->toolType; }
 
-void Stroke::setLineStyle(const LineStyle& style) { this->lineStyle = style; }
+void Stroke::setLineStyle(const LineStyle& style) {
+    this->lineStyle = style;
+    pointsChanged();
+}
 
 auto Stroke::getLineStyle() const -> const LineStyle& { return this->lineStyle; }
 
 void Stroke::move(double dx, double dy) {
-    for (auto&& point: points) {
+    unpackPoints();
+    for (auto&& point: points.mut()) {
         point.x += dx;
         point.y += dy;
     }
     Element::x += dx;
     Element::y += dy;
     Element::snappedBounds = Element::snappedBounds.translated(dx, dy);
+    this->headBounds = this->headBounds.translated(dx, dy);
+    boundsChanged();
+    pointsChanged();
 }
 
 void Stroke::rotate(double x0, double y0, double th) {
@@ -311,9 +475,8 @@ void Stroke::rotate(double x0, double y0, double th) {
     cairo_matrix_rotate(&rotMatrix, th);
     cairo_matrix_translate(&rotMatrix, -x0, -y0);
 
-    for (auto&& p: points) { cairo_matrix_transform_point(&rotMatrix, &p.x, &p.y); }
-    this->sizeCalculated = false;
-    // Width and Height will likely be changed after this operation
+    // The bounds are collected along with the rotated points
+    transform(rotMatrix, 1.0);
 }
 
 void Stroke::scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth) {
@@ -326,19 +489,43 @@ void Stroke::scale(double x0, double y0, double fx, double fy, double rotation,
     cairo_matrix_rotate(&scaleMatrix, -rotation);
     cairo_matrix_translate(&scaleMatrix, -x0, -y0);
 
-    for (auto&& p: points) {
-        cairo_matrix_transform_point(&scaleMatrix, &p.x, &p.y);
+    // The bounds are collected along with the scaled points
+    transform(scaleMatrix, fz);
+}
 
+void Stroke::transform(const cairo_matrix_t& matrix, double widthFactor) {
+    unpackPoints();
+    double minX = DBL_MAX;
+    double minY = DBL_MAX;
+    double maxX = -DBL_MAX;
+    double maxY = -DBL_MAX;
+    double maxPressure = 0.0;
+    for (auto&& p: points.mut()) {
+        cairo_matrix_transform_point(&matrix, &p.x, &p.y);
         if (p.z != Point::NO_PRESSURE) {
-            p.z *= fz;
+            p.z *= widthFactor;
         }
+        maxPressure = std::max(maxPressure, p.z);
+        minX = std::min(minX, p.x);
+        minY = std::min(minY, p.y);
+        maxX = std::max(maxX, p.x);
+        maxY = std::max(maxY, p.y);
     }
-    this->width *= fz;
+    this->width *= widthFactor;
 
-    this->sizeCalculated = false;
+    if (this->points.empty()) {
+        this->sizeCalculated = false;
+    } else {
+        setBounds(minX, minY, maxX, maxY, maxPressure);
+        this->sizeCalculated = true;
+    }
+    this->headBoundsValid = false;
+    boundsChanged();
+    pointsChanged();
 }
 
 auto Stroke::hasPressure() const -> bool {
+    unpackPoints();
     if (!this->points.empty()) {
         return this->points[0].z != Point::NO_PRESSURE;
     }
@@ -346,36 +533,64 @@ auto Stroke::hasPressure() const -> bool {
 }
 
 auto Stroke::getAvgPressure() const -> double {
-    return std::accumulate(begin(this->points), end(this->points), 0.0,
+    unpackPoints();
+    return std::accumulate(this->points.begin(), this->points.end(), 0.0,
                            [](double l, Point const& p) { return l + p.z; }) /
            this->points.size();
 }
 
 void Stroke::scalePressure(double factor) {
+    unpackPoints();
     if (!hasPressure()) {
         return;
     }
-    for (auto&& p: this->points) { p.z *= factor; }
+    for (auto&& p: this->points.mut()) { p.z *= factor; }
+    this->maxPressure *= factor;
+    this->headMaxPressure *= factor;
+    if (this->sizeCalculated) {
+        setBounds(Element::snappedBounds, this->maxPressure);
+    }
+    boundsChanged();
 }
 
 void Stroke::clearPressure() {
-    for (auto&& p: points) { p.z = Point::NO_PRESSURE; }
+    unpackPoints();
+    for (auto&& p: points.mut()) { p.z = Point::NO_PRESSURE; }
+    this->maxPressure = Point::NO_PRESSURE;
+    this->headMaxPressure = Point::NO_PRESSURE;
+    if (this->sizeCalculated && !this->points.empty()) {
+        setBounds(Element::snappedBounds, this->maxPressure);
+    }
+    boundsChanged();
 }
 
 void Stroke::setLastPressure(double pressure) {
+    unpackPoints();
     if (!this->points.empty()) {
-        this->points.back().z = pressure;
+        this->points.mut().back().z = pressure;
+        updateBoundsOfLastPoint();
+        boundsChanged();
     }
 }
 
 void Stroke::setSecondToLastPressure(double pressure) {
+    unpackPoints();
     auto const pointCount = this->getPointCount();
     if (pointCount >= 2) {
-        this->points[pointCount - 2].z = pressure;
+        Point& p = this->points.mut()[pointCount - 2];
+        // Lowering the largest pressure of the points
+        if (pressure < p.z && p.z >= this->headMaxPressure) {
+            this->headBoundsValid = false;
+        }
+        p.z = pressure;
+        this->headMaxPressure = std::max(this->headMaxPressure, pressure);
+        updateBoundsOfLastPoint();
+        boundsChanged();
     }
 }
 
 void Stroke::setPressure(const std::vector<double>& pressure) {
+    unpackPoints();
     // The last pressure is not used - as there is no line drawn from this point
     if (this->points.size() - 1 != pressure.size()) {
         g_warning("invalid pressure point count: %s, expected %s", std::to_string(pressure.size()).data(),
@@ -383,7 +598,16 @@ void Stroke::setPressure(const std::vector<double>& pressure) {
     }
 
     auto max_size = std::min(pressure.size(), this->points.size() - 1);
-    for (size_t i = 0U; i != max_size; ++i) { this->points[i].z = pressure[i]; }
+    std::vector<Point>& points = this->points.mut();
+    for (size_t i = 0U; i != max_size; ++i) { points[i].z = pressure[i]; }
+    if (this->sizeCalculated && !points.empty()) {
+        // The box of the points is the same
+        double max = 0.0;
+        for (const Point& p: points) { max = std::max(max, p.z); }
+        setBounds(Element::snappedBounds, max);
+    }
+    this->headBoundsValid = false;
+    boundsChanged();
 }
 
 /**
@@ -397,65 +621,41 @@ auto Stroke::intersects(double x, double y, double halfEraserSize) const -> bool
  * checks if the stroke is intersected by the eraser rectangle
  */
 auto Stroke::intersects(double x, double y, double halfEraserSize, double* gap) const -> bool {
+    unpackPoints();
     if (this->points.empty()) {
         return false;
     }
 
-    double x1 = x - halfEraserSize;
-    double x2 = x + halfEraserSize;
-    double y1 = y - halfEraserSize;
-    double y2 = y + halfEraserSize;
-
-    double lastX = points[0].x;
-    double lastY = points[0].y;
-    for (auto&& point: points) {
-        double px = point.x;
-        double py = point.y;
-
-        if (px >= x1 && py >= y1 && px <= x2 && py <= y2) {
-            if (gap) {
-                *gap = 0;
-            }
-            return true;
+    const SegmentKernels::HitBox box{x, y, halfEraserSize};
+    // The gap of the hit on the point i, tested with the segment ending on it
+    auto setGap = [&](size_t i, size_t first) {
+        if (gap) {
+            *gap = SegmentKernels::getHitGap(points[i == first ? first : i - 1], points[i], box);
         }
+    };
 
-        double len = hypot(px - lastX, py - lastY);
-        if (len >= halfEraserSize) {
-            /**
-             * The distance of the center of the eraser box to the line passing through (lastx, lasty) and (px, py)
-             */
-            double p = std::abs((x - lastX) * (lastY - py) + (y - lastY) * (px - lastX)) / len;
-
-            // If the distance p of the center of the eraser box to the (full) line is in the range,
-            // we check whether the eraser box is not too far from the line segment through the two points.
-
-            if (p <= halfEraserSize) {
-                double centerX = (lastX + px) / 2;
-                double centerY = (lastY + py) / 2;
-                double distance = hypot(x - centerX, y - centerY);
-
-                // For the above check we imagine a circle whose center is the mid point of the two points of the stroke
-                // and whose radius is half the length of the line segment plus half the diameter of the eraser box
-                // plus some small padding
-                // If the center of the eraser box lies within that circle then we consider it to be close enough
-
-                distance -= halfEraserSize * std::sqrt(2);
-
-                constexpr double PADDING = 0.1;
-
-                if (distance <= len / 2 + PADDING) {
-                    if (gap) {
-                        *gap = distance;
-                    }
-                    return true;
-                }
+    if (auto tree = getSegmentTree()) {
+        // findHit() only accepts an eraser center closer to the segment than 2 * halfEraserSize + HIT_PADDING
+        const double margin = 2 * halfEraserSize + SegmentKernels::HIT_PADDING;
+        const Rectangle<double> area(x - margin, y - margin, 2 * margin, 2 * margin);
+        bool found = false;
+        tree->forEachRun(area, [&](size_t first, size_t last) {
+            // The run covers the points first to last + 1
+            size_t i = SegmentKernels::findHit(points.data(), first, last + 1, box);
+            found = i <= last + 1;
+            if (found) {
+                setGap(i, first);
             }
-        }
-
-        lastX = px;
-        lastY = py;
+            return !found;
+        });
+        return found;
     }
 
+    size_t i = SegmentKernels::findHit(points.data(), 0, points.size() - 1, box);
+    if (i < points.size()) {
+        setGap(i, 0);
+        return true;
+    }
     return false;
 }
 
@@ -529,6 +729,7 @@ static TinyVector<double, 2> intersectLineSegmentWithRectangle(const Point& p, c
 }
 
 auto Stroke::intersectWithPaddedBox(const PaddedBox& box) const -> IntersectionParametersContainer {
+    unpackPoints();
     auto pointCount = this->points.size();
     if (pointCount < 2) {
         if (pointCount == 1 && this->points.back().isInside(box.getInnerRectangle())) {
@@ -544,6 +745,7 @@ auto Stroke::intersectWithPaddedBox(const PaddedBox& box) const -> IntersectionP
 
 auto Stroke::intersectWithPaddedBox(const PaddedBox& box, size_t firstIndex, size_t lastIndex) const
         -> IntersectionParametersContainer {
+    unpackPoints();
     assert(firstIndex <= lastIndex && lastIndex < this->points.size() - 1);
 
     const auto innerBox = box.getInnerRectangle();
@@ -570,7 +772,7 @@ auto Stroke::intersectWithPaddedBox(const PaddedBox& box, size_t firstIndex, siz
 
     size_t index = firstIndex;
 
-    const PairView segments(this->points);
+    const PairView segments(this->points.get());
     auto segmentIt = std::next(segments.begin(), (std::ptrdiff_t)index);
 
     Flags flags = initializeFlagsFromHalfTangentAtFirstKnot(segmentIt.first(), segmentIt.second());
@@ -667,10 +869,31 @@ auto Stroke::intersectWithPaddedBox(const PaddedBox& box, size_t firstIndex, siz
         DEBUG_ERASER(debugstream << "|  |__** result.size() = " << std::setw(3) << result.size() << std::endl;)
     };
 
-    auto endSegmentIt = std::next(segments.begin(), (std::ptrdiff_t)(lastIndex + 1));
-    for (; segmentIt != endSegmentIt; segmentIt++, index++) {
-        processSegment(segmentIt.first(), segmentIt.second(), index);
+    // The segments whose bounding box misses outerBox leave the flags and the result as they are: only process the
+    // others of the segments first to last
+    auto processSegmentsTouching = [&](size_t first, size_t last) {
+        for (size_t i = first; i <= last; i++) {
+            i = SegmentKernels::findSegmentTouching(this->points.data(), i, last, outerBox);
+            if (i > last) {
+                break;
+            }
+            auto it = std::next(segments.begin(), (std::ptrdiff_t)i);
+            processSegment(it.first(), it.second(), i);
+        }
+    };
+
+    if (auto tree = getSegmentTree()) {
+        tree->forEachRun(outerBox, [&](size_t first, size_t last) {
+            if (last >= firstIndex) {
+                processSegmentsTouching(std::max(first, firstIndex), std::min(last, lastIndex));
+            }
+            return last < lastIndex;
+        });
+    } else {
+        processSegmentsTouching(firstIndex, lastIndex);
     }
+    index = lastIndex + 1;
+    segmentIt = std::next(segments.begin(), (std::ptrdiff_t)index);
 
     auto isHalfTangentAtLastKnotGoingTowardInnerBox =
             [&innerBox, &outerBox](const Point& lastKnot, const Point& halfTangentControlPoint) -> bool {
@@ -762,6 +985,7 @@ auto Stroke::intersectWithPaddedBox(const PaddedBox& box, size_t firstIndex, siz
  * Also used for Selected Bounding box.
  */
 void Stroke::calcSize() const {
+    unpackPoints();
     if (this->points.empty()) {
         Element::x = 0;
         Element::y = 0;
@@ -772,47 +996,83 @@ void Stroke::calcSize() const {
 
         // used for snapping
         Element::snappedBounds = Rectangle<double>{};
+        return;
     }
 
     double minSnapX = DBL_MAX;
-    double maxSnapX = DBL_MIN;
+    double maxSnapX = -DBL_MAX;
     double minSnapY = DBL_MAX;
-    double maxSnapY = DBL_MIN;
+    double maxSnapY = -DBL_MAX;
 
-    auto halfThick = 0.0;
+    auto maxPressure = 0.0;
 
     //#pragma omp parralel
     for (auto&& p: points) {
-        halfThick = std::max(halfThick, p.z);
+        maxPressure = std::max(maxPressure, p.z);
         minSnapX = std::min(minSnapX, p.x);
         minSnapY = std::min(minSnapY, p.y);
         maxSnapX = std::max(maxSnapX, p.x);
         maxSnapY = std::max(maxSnapY, p.y);
     }
 
-    halfThick = points[0].z != Point::NO_PRESSURE ? halfThick / 2.0 : this->width / 2.0;
+    setBounds(minSnapX, minSnapY, maxSnapX, maxSnapY, maxPressure);
+}
+
+void Stroke::setBounds(double minX, double minY, double maxX, double maxY, double maxPressure) const {
+    auto halfThick = points[0].z != Point::NO_PRESSURE ? maxPressure / 2.0 : this->width / 2.0;
+    this->maxPressure = maxPressure;
+
+    Element::x = minX - halfThick;
+    Element::y = minY - halfThick;
+    Element::width = maxX - minX + 2 * halfThick;
+    Element::height = maxY - minY + 2 * halfThick;
+    Element::snappedBounds = Rectangle<double>(minX, minY, maxX - minX, maxY - minY);
+}
+
+void Stroke::setBounds(const Rectangle<double>& box, double maxPressure) const {
+    setBounds(box.x, box.y, box.x + box.width, box.y + box.height, maxPressure);
+}
 
-    auto minX = minSnapX - halfThick;
-    auto minY = minSnapY - halfThick;
-    auto maxX = maxSnapX + halfThick;
-    auto maxY = maxSnapY + halfThick;
+auto Stroke::isInnerPoint(const Point& p) const -> bool {
+    const Rectangle<double>& box = Element::snappedBounds;
+    return p.x > box.x && p.x < box.x + box.width && p.y > box.y && p.y < box.y + box.height &&
+           (!hasPressure() || p.z < this->maxPressure);
+}
 
-    Element::x = minX;
-    Element::y = minY;
-    Element::width = maxX - minX;
-    Element::height = maxY - minY;
-    Element::snappedBounds = Rectangle<double>(minSnapX, minSnapY, maxSnapX - minSnapX, maxSnapY - minSnapY);
+void Stroke::updateBoundsOfLastPoint() {
+    const Point& last = this->points.back();
+    if (this->points.size() == 1) {
+        setBounds(last.x, last.y, last.x, last.y, last.z);
+    } else {
+        if (!this->headBoundsValid) {
+            const Point& first = this->points.front();
+            this->headBounds = Rectangle<double>(first.x, first.y, 0, 0);
+            this->headMaxPressure = first.z;
+            for (size_t i = 1; i + 1 < this->points.size(); i++) {
+                includePoint(this->headBounds, this->points[i]);
+                this->headMaxPressure = std::max(this->headMaxPressure, this->points[i].z);
+            }
+            this->headBoundsValid = true;
+        }
+        Rectangle<double> box = this->headBounds;
+        includePoint(box, last);
+        setBounds(box, std::max(this->headMaxPressure, last.z));
+    }
+    this->sizeCalculated = true;
 }
 
-auto Stroke::getErasable() const -> ErasableStroke* { return this->erasable; }
+auto Stroke::getErasable() const -> std::shared_ptr<ErasableStroke> { return std::atomic_load(&this->erasable); }
 
-void Stroke::setErasable(ErasableStroke* erasable) { this->erasable = erasable; }
+void Stroke::setErasable(std::shared_ptr<ErasableStroke> erasable) {
+    std::atomic_store(&this->erasable, std::move(erasable));
+}
 
 auto Stroke::getStrokeCapStyle() const -> StrokeCapStyle { return this->capStyle; }
 
 void Stroke::setStrokeCapStyle(const StrokeCapStyle capStyle) { this->capStyle = capStyle; }
 
 void Stroke::debugPrint() const {
+    unpackPoints();
     g_message("%s", FC(FORMAT_STR("Stroke {1} / hasPressure() = {2}") % (uint64_t)this % this->hasPressure()));
 
     for (auto&& p: points) { g_message("%lf / %lf / %lf", p.x, p.y, p.z); }
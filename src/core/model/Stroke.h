@@ -11,12 +11,19 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
+#include <cairo.h>
+
 #include "AudioElement.h"
+#include "CompactPoints.h"
 #include "Element.h"
 #include "LineStyle.h"
 #include "Point.h"
+#include "StrokeCairoPath.h"
+#include "StrokeDetail.h"
+#include "StrokeSegmentTree.h"
 
 enum StrokeTool { STROKE_TOOL_PEN, STROKE_TOOL_ERASER, STROKE_TOOL_HIGHLIGHTER };
 enum StrokeCapStyle {
@@ -50,6 +57,13 @@ public:
     Stroke& operator=(Stroke&&) = default;
     ~Stroke() override;
 
+    /**
+     * The strokes are allocated from a pool: the strokes loaded or drawn one after the other are close in memory, and
+     * a page is rendered without chasing pointers all over the heap. See xoj::util::ObjectPool.
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size) noexcept;
+
 public:
     Stroke* cloneStroke() const;
     Element* clone() const override;
@@ -100,11 +114,58 @@ public:
     void setLastPoint(const Point& p);
     int getPointCount() const;
     void freeUnusedPointItems();
+    /**
+     * Replace all the points at once, e.g. when loading a file
+     */
+    void setPointVector(std::vector<Point> other);
     std::vector<Point> const& getPointVector() const;
     Point getPoint(int index) const;
     Point getPoint(PathParameter parameter) const;
     const Point* getPoints() const;
 
+    /**
+     * Pack the points in memory until they are accessed again, see CompactPoints. Must be called with the document
+     * locked, while the stroke is not edited.
+     */
+    void compact();
+    bool isCompact() const;
+
+    /**
+     * @return The approximate number of bytes held by the stroke, without unpacking its points
+     */
+    size_t getMemoryUsage() const override;
+
+    /**
+     * @return The path through the points, cached until they change, or nullptr if it cannot be cached (see
+     *         StrokeCairoPath). Can be called by several threads at once.
+     */
+    std::shared_ptr<const StrokeCairoPath> getCairoPath() const;
+
+    /**
+     * @return The path through the points kept by the levels of detail for the tolerance rounded down to a power of 2,
+     *         or nullptr if it cannot be cached. The path of the last such tolerance is cached until the points change:
+     *         redrawing at zooms close to each other does not go through all the points again. Can be called by
+     *         several threads at once.
+     */
+    std::shared_ptr<const StrokeCairoPath> getSimplifiedCairoPath(double tolerance) const;
+
+    /**
+     * @return The levels of detail of the stroke, cached until the points change. Can be called by several threads
+     *         at once.
+     */
+    std::shared_ptr<const StrokeDetail> getDetail() const;
+
+    /**
+     * @return The bounding boxes of the segments, cached until the points change, or nullptr if the stroke is too short
+     *         to need them. Can be called by several threads at once.
+     */
+    std::shared_ptr<const StrokeSegmentTree> getSegmentTree() const;
+
+    /**
+     * Strokes with fewer points are intersected by going through all their segments
+     */
+    static constexpr int MIN_POINTS_FOR_SEGMENT_TREE = 64;
+
     void deletePoint(int index);
     void deletePointsFrom(int index);
 
@@ -147,10 +208,20 @@ public:
     void scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth) override;
     void rotate(double x0, double y0, double th) override;
 
+    /**
+     * Applies the affine matrix to the points, e.g. several moves, scales and rotations at once, and computes the
+     * bounds in the same pass instead of invalidating them
+     * @param widthFactor Factor of the width and of the pressures
+     */
+    void transform(const cairo_matrix_t& matrix, double widthFactor);
+
     bool isInSelection(ShapeContainer* container) const override;
 
-    ErasableStroke* getErasable() const;
-    void setErasable(ErasableStroke* erasable);
+    /**
+     * @return The stroke being erased, kept alive by the caller: the render jobs draw it while the eraser finalizes it
+     */
+    std::shared_ptr<ErasableStroke> getErasable() const;
+    void setErasable(std::shared_ptr<ErasableStroke> erasable);
 
     StrokeCapStyle getStrokeCapStyle() const;
     void setStrokeCapStyle(const StrokeCapStyle capStyle);
@@ -167,20 +238,73 @@ public:
 protected:
     void calcSize() const override;
 
+private:
+    void unpackPoints() const { this->compactPoints.unpack(this->points); }
+
+    /**
+     * Set the bounds from those of the points
+     * @param maxPressure The largest pressure of the points
+     */
+    void setBounds(double minX, double minY, double maxX, double maxY, double maxPressure) const;
+    void setBounds(const xoj::util::Rectangle<double>& box, double maxPressure) const;
+
+    /**
+     * @return true if the bounds do not depend on the point: it is strictly inside the box of the points and its
+     *         pressure is not the largest one. Only meaningful while the size is calculated.
+     */
+    bool isInnerPoint(const Point& p) const;
+
+    /**
+     * Set the bounds from the box of all the points but the last one, collected once, and from the last point: the
+     * last point of a stroke being drawn is added or replaced on every event
+     */
+    void updateBoundsOfLastPoint();
+
+    /**
+     * Drop the cached paths, levels of detail and segment tree, the points changed
+     */
+    void pointsChanged();
+
 private:
     // The stroke width cannot be inherited from Element
     double width = 0;
     StrokeTool toolType = STROKE_TOOL_PEN;
 
-    // The array with the points
-    std::vector<Point> points{};
+    // The array with the points, empty while they are packed in compactPoints (mutable: unpacked by the getters).
+    // Shared with the clones until one of them modifies its points.
+    mutable xoj::util::CowVector<Point> points{};
+    mutable CompactPoints compactPoints;
+
+    /**
+     * Accessed with std::atomic_load / std::atomic_store, see getCairoPath() and getDetail()
+     */
+    mutable std::shared_ptr<const StrokeCairoPath> cairoPath;
+    mutable std::shared_ptr<const StrokeCairoPath> simplifiedPath;
+    mutable std::shared_ptr<const StrokeDetail> detail;
+    mutable std::shared_ptr<const StrokeSegmentTree> segmentTree;
+
+    /**
+     * The largest pressure of the points, along with Element::snappedBounds while the size is calculated: the bounds
+     * are updated from them without going through all the points again
+     */
+    mutable double maxPressure = 0;
+
+    /**
+     * The box and the largest pressure of all the points but the last one, see updateBoundsOfLastPoint()
+     */
+    xoj::util::Rectangle<double> headBounds{};
+    double headMaxPressure = 0;
+    bool headBoundsValid = false;
 
     /**
      * Dashed line
      */
     LineStyle lineStyle;
 
-    ErasableStroke* erasable = nullptr;
+    /**
+     * Accessed with std::atomic_load / std::atomic_store, see getErasable()
+     */
+    std::shared_ptr<ErasableStroke> erasable;
 
     /**
      * Option to fill the shape:
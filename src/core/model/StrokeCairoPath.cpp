@@ -0,0 +1,56 @@
+#include "StrokeCairoPath.h"
+
+#include "StrokeDetail.h"
+
+std::atomic<size_t> StrokeCairoPath::memoryUsed{0};
+
+StrokeCairoPath::StrokeCairoPath(const std::vector<Point>& points, double tolerance): tolerance(tolerance) {
+    // A header and a point for each move_to / line_to
+    this->data.resize(2 * points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        cairo_path_data_t* d = &this->data[2 * i];
+        d[0].header.type = i == 0 ? CAIRO_PATH_MOVE_TO : CAIRO_PATH_LINE_TO;
+        d[0].header.length = 2;
+        d[1].point.x = points[i].x;
+        d[1].point.y = points[i].y;
+    }
+
+    this->path.status = CAIRO_STATUS_SUCCESS;
+    this->path.data = this->data.data();
+    this->path.num_data = static_cast<int>(this->data.size());
+}
+
+StrokeCairoPath::~StrokeCairoPath() { memoryUsed -= this->data.size() * sizeof(cairo_path_data_t); }
+
+auto StrokeCairoPath::create(const std::vector<Point>& points) -> std::shared_ptr<const StrokeCairoPath> {
+    return build(points, 0);
+}
+
+auto StrokeCairoPath::create(const std::vector<Point>& points, const StrokeDetail& detail, double tolerance)
+        -> std::shared_ptr<const StrokeCairoPath> {
+    std::vector<Point> kept;
+    for (size_t i = 0; i < points.size(); i++) {
+        if (detail.keeps(i, tolerance)) {
+            kept.push_back(points[i]);
+        }
+    }
+    return build(kept, tolerance);
+}
+
+auto StrokeCairoPath::build(const std::vector<Point>& points, double tolerance)
+        -> std::shared_ptr<const StrokeCairoPath> {
+    if (points.size() < 2) {
+        return nullptr;
+    }
+
+    size_t size = 2 * points.size() * sizeof(cairo_path_data_t);
+    if (memoryUsed.fetch_add(size) + size > MEMORY_BUDGET) {
+        memoryUsed -= size;
+        return nullptr;
+    }
+    return std::shared_ptr<const StrokeCairoPath>(new StrokeCairoPath(points, tolerance));
+}
+
+auto StrokeCairoPath::get() const -> const cairo_path_t* { return &this->path; }
+
+auto StrokeCairoPath::getTolerance() const -> double { return this->tolerance; }
@@ -0,0 +1,73 @@
+/*
+ * Xournal++
+ *
+ * The points of a stroke as a cairo path
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <cairo.h>
+
+#include "Point.h"
+
+class StrokeDetail;
+
+/**
+ * @brief The path through the points of a stroke, in page coordinates, to be replayed with cairo_append_path()
+ *
+ * Built when a stroke is drawn, and kept by the stroke until its points change (see Stroke::getCairoPath()), so that
+ * redrawing unchanged strokes does not rebuild the path point by point. A path takes 32 bytes per point: all the
+ * cached paths share a memory budget, the strokes drawn once it is exhausted are not cached.
+ */
+class StrokeCairoPath {
+public:
+    StrokeCairoPath(const StrokeCairoPath&) = delete;
+    StrokeCairoPath& operator=(const StrokeCairoPath&) = delete;
+    ~StrokeCairoPath();
+
+    /**
+     * @return The path, or nullptr if there are less than 2 points or the memory budget is exhausted
+     */
+    static std::shared_ptr<const StrokeCairoPath> create(const std::vector<Point>& points);
+
+    /**
+     * @return The path through the points kept by the levels of detail for the tolerance, or nullptr if there are less
+     *         than 2 of them or the memory budget is exhausted
+     */
+    static std::shared_ptr<const StrokeCairoPath> create(const std::vector<Point>& points, const StrokeDetail& detail,
+                                                         double tolerance);
+
+    const cairo_path_t* get() const;
+
+    /**
+     * @return The tolerance the points were simplified with (see StrokeDetail), 0 if the path goes through all of them
+     */
+    double getTolerance() const;
+
+    /**
+     * Memory for all the cached paths
+     */
+    static constexpr size_t MEMORY_BUDGET = 64 * 1024 * 1024;
+
+private:
+    StrokeCairoPath(const std::vector<Point>& points, double tolerance);
+
+    static std::shared_ptr<const StrokeCairoPath> build(const std::vector<Point>& points, double tolerance);
+
+private:
+    std::vector<cairo_path_data_t> data;
+    cairo_path_t path{};
+    double tolerance;
+
+    static std::atomic<size_t> memoryUsed;
+};
@@ -0,0 +1,54 @@
+#include "StrokeDetail.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+namespace {
+auto distanceToSegment(const Point& p, const Point& a, const Point& b) -> double {
+    const double dx = b.x - a.x;
+    const double dy = b.y - a.y;
+    const double length2 = dx * dx + dy * dy;
+    double t = length2 > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length2 : 0;
+    t = std::clamp(t, 0.0, 1.0);
+    return std::hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+}
+}  // namespace
+
+StrokeDetail::StrokeDetail(const std::vector<Point>& points): significance(points.size(), 0) {
+    constexpr float ALWAYS = std::numeric_limits<float>::infinity();
+    const size_t n = points.size();
+
+    // The ranges still to split: first point, last point, significance of the point which split them
+    std::vector<std::tuple<size_t, size_t, float>> ranges;
+    for (size_t first = 0; first < n; first += CHUNK_SIZE) {
+        size_t last = std::min(first + CHUNK_SIZE, n - 1);
+        this->significance[first] = ALWAYS;
+        this->significance[last] = ALWAYS;
+        ranges.emplace_back(first, last, ALWAYS);
+    }
+
+    while (!ranges.empty()) {
+        auto [first, last, limit] = ranges.back();
+        ranges.pop_back();
+        if (last - first < 2) {
+            continue;
+        }
+
+        size_t split = first + 1;
+        double maxDistance = -1;
+        for (size_t i = first + 1; i < last; i++) {
+            double d = distanceToSegment(points[i], points[first], points[last]);
+            if (d > maxDistance) {
+                maxDistance = d;
+                split = i;
+            }
+        }
+
+        float s = std::min(static_cast<float>(maxDistance), limit);
+        this->significance[split] = s;
+        ranges.emplace_back(first, split, s);
+        ranges.emplace_back(split, last, s);
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * Xournal++
+ *
+ * Levels of detail of a stroke
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Point.h"
+
+/**
+ * @brief The Douglas-Peucker simplification of a stroke, for all the tolerances at once
+ *
+ * Each point gets the tolerance above which Douglas-Peucker drops it (its significance). The significance of a point
+ * is never above the one of the point which split its range, so the points kept for a tolerance are exactly the
+ * Douglas-Peucker simplification for that tolerance: drawing a stroke at any zoom is a single pass over its points.
+ *
+ * The stroke is simplified in chunks of CHUNK_SIZE points, whose ends are always kept, which bounds the cost of
+ * strokes on which Douglas-Peucker degenerates (e.g. spirals).
+ */
+class StrokeDetail {
+public:
+    explicit StrokeDetail(const std::vector<Point>& points);
+
+public:
+    /**
+     * @return true if the point is drawn when the stroke is simplified with the tolerance, in page coordinates
+     */
+    bool keeps(size_t index, double tolerance) const { return this->significance[index] > tolerance; }
+
+    static constexpr size_t CHUNK_SIZE = 1024;
+
+private:
+    std::vector<float> significance;
+};
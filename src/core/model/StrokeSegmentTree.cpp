@@ -0,0 +1,34 @@
+#include "StrokeSegmentTree.h"
+
+#include <algorithm>
+#include <limits>
+
+StrokeSegmentTree::StrokeSegmentTree(const std::vector<Point>& points) {
+    this->segmentCount = points.size() < 2 ? 0 : points.size() - 1;
+
+    size_t leaves = (this->segmentCount + LEAF_SEGMENTS - 1) / LEAF_SEGMENTS;
+    while (this->leafCount < leaves) {
+        this->leafCount *= 2;
+    }
+
+    // The leaves without segments never intersect anything
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    this->nodes.assign(2 * this->leafCount, Box{INF, INF, -INF, -INF});
+
+    for (size_t i = 0; i < this->segmentCount; i++) {
+        Box& leaf = this->nodes[this->leafCount + i / LEAF_SEGMENTS];
+        leaf.minX = std::min({leaf.minX, points[i].x, points[i + 1].x});
+        leaf.minY = std::min({leaf.minY, points[i].y, points[i + 1].y});
+        leaf.maxX = std::max({leaf.maxX, points[i].x, points[i + 1].x});
+        leaf.maxY = std::max({leaf.maxY, points[i].y, points[i + 1].y});
+    }
+
+    for (size_t n = this->leafCount - 1; n >= 1; n--) {
+        const Box& a = this->nodes[2 * n];
+        const Box& b = this->nodes[2 * n + 1];
+        this->nodes[n] = {std::min(a.minX, b.minX), std::min(a.minY, b.minY), std::max(a.maxX, b.maxX),
+                          std::max(a.maxY, b.maxY)};
+    }
+}
+
+auto StrokeSegmentTree::getSegmentCount() const -> size_t { return this->segmentCount; }
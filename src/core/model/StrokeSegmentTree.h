@@ -0,0 +1,115 @@
+/*
+ * Xournal++
+ *
+ * Bounding volume hierarchy of the segments of a stroke
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "util/Rectangle.h"
+
+#include "Point.h"
+
+/**
+ * @brief Bounding boxes of the segments of a stroke, grouped in a balanced binary tree
+ *
+ * Segment i goes from point i to point i + 1. The leaves hold LEAF_SEGMENTS consecutive segments, each node the union
+ * of the boxes of its children. The boxes do not include the width of the stroke: queries pad their area instead.
+ *
+ * Used by the intersection tests of Stroke, so that the eraser or a click on a long stroke only goes through the
+ * segments close to it.
+ */
+class StrokeSegmentTree {
+public:
+    explicit StrokeSegmentTree(const std::vector<Point>& points);
+
+public:
+    /**
+     * Calls f(first, last) for the runs of consecutive segments [first, last] whose bounding box may intersect the
+     * area (closed), by increasing index. The segments outside of the runs do not intersect the area. Stops once f
+     * returns false.
+     */
+    template <class F>
+    void forEachRun(const xoj::util::Rectangle<double>& area, F f) const;
+
+    size_t getSegmentCount() const;
+
+    static constexpr size_t LEAF_SEGMENTS = 8;
+
+private:
+    struct Box {
+        double minX;
+        double minY;
+        double maxX;
+        double maxY;
+
+        bool intersects(const xoj::util::Rectangle<double>& r) const {
+            return minX <= r.x + r.width && maxX >= r.x && minY <= r.y + r.height && maxY >= r.y;
+        }
+    };
+
+    /**
+     * @return false if f returned false
+     */
+    template <class F>
+    bool visit(size_t node, const xoj::util::Rectangle<double>& area, F& emit) const;
+
+private:
+    size_t segmentCount = 0;
+
+    /**
+     * Number of leaves, a power of 2
+     */
+    size_t leafCount = 1;
+
+    /**
+     * The nodes as a heap: the root is 1, the children of n are 2n and 2n + 1, the leaves start at leafCount
+     */
+    std::vector<Box> nodes;
+};
+
+template <class F>
+void StrokeSegmentTree::forEachRun(const xoj::util::Rectangle<double>& area, F f) const {
+    if (this->segmentCount == 0) {
+        return;
+    }
+    size_t runFirst = 0;
+    size_t runLast = 0;
+    bool pending = false;
+    auto emit = [&](size_t first, size_t last) {
+        if (pending && first == runLast + 1) {
+            runLast = last;
+            return true;
+        }
+        bool carryOn = !pending || f(runFirst, runLast);
+        runFirst = first;
+        runLast = last;
+        pending = true;
+        return carryOn;
+    };
+    if (visit(1, area, emit) && pending) {
+        f(runFirst, runLast);
+    }
+}
+
+template <class F>
+bool StrokeSegmentTree::visit(size_t node, const xoj::util::Rectangle<double>& area, F& emit) const {
+    if (!this->nodes[node].intersects(area)) {
+        return true;
+    }
+    if (node >= this->leafCount) {
+        size_t first = (node - this->leafCount) * LEAF_SEGMENTS;
+        size_t last = std::min(first + LEAF_SEGMENTS, this->segmentCount) - 1;
+        return emit(first, last);
+    }
+    return visit(2 * node, area, emit) && visit(2 * node + 1, area, emit);
+}
@@ -1,5 +1,6 @@
 #include "TexImage.h"
 
+#include <atomic>
 #include <utility>
 
 #include "util/pixbuf-utils.h"
@@ -8,6 +9,8 @@
 
 using xoj::util::Rectangle;
 
+static std::atomic<uint64_t> lastRenderId{0};
+
 TexImage::TexImage(): Element(ELEMENT_TEXIMAGE) { this->sizeCalculated = true; }
 
 TexImage::~TexImage() { freeImageAndPdf(); }
@@ -18,10 +21,11 @@ void TexImage::freeImageAndPdf() {
         this->image = nullptr;
     }
 
-    if (this->pdf) {
-        g_object_unref(this->pdf);
-        this->pdf = nullptr;
-    }
+    std::lock_guard<std::mutex> lock(this->pdfMutex);
+    g_clear_object(&this->pdf);
+    this->pdfWidth = 0;
+    this->pdfHeight = 0;
+    this->pdfInvalid = false;
 }
 
 auto TexImage::clone() const -> Element* {
@@ -35,11 +39,14 @@ auto TexImage::clone() const -> Element* {
     img->snappedBounds = this->snappedBounds;
     img->sizeCalculated = this->sizeCalculated;
 
-    img->pdf = this->pdf;
-    g_object_ref(this->pdf);
-
+    // The clone parses its own PDF if it is not drawn from the shared rasterizations
     img->loadData(std::string(this->binaryData), nullptr);
-
+    img->renderId = this->renderId;
+    {
+        std::lock_guard<std::mutex> lock(this->pdfMutex);
+        img->pdfWidth = this->pdfWidth;
+        img->pdfHeight = this->pdfHeight;
+    }
 
     return img;
 }
@@ -47,11 +54,13 @@ auto TexImage::clone() const -> Element* {
 void TexImage::setWidth(double width) {
     this->width = width;
     this->calcSize();
+    boundsChanged();
 }
 
 void TexImage::setHeight(double height) {
     this->height = height;
     this->calcSize();
+    boundsChanged();
 }
 
 auto TexImage::cairoReadFunction(TexImage* image, unsigned char* data, unsigned int length) -> cairo_status_t {
@@ -70,6 +79,11 @@ auto TexImage::cairoReadFunction(TexImage* image, unsigned char* data, unsigned
  */
 auto TexImage::getBinaryData() const -> std::string const& { return this->binaryData; }
 
+auto TexImage::getMemoryUsage() const -> size_t {
+    std::lock_guard<std::mutex> lock(this->pdfMutex);
+    return sizeof(TexImage) + this->binaryData.size() * (this->pdf ? 2 : 1);
+}
+
 void TexImage::setText(std::string text) { this->text = std::move(text); }
 
 auto TexImage::getText() const -> std::string { return this->text; }
@@ -77,21 +91,21 @@ auto TexImage::getText() const -> std::string { return this->text; }
 auto TexImage::loadData(std::string&& bytes, GError** err) -> bool {
     this->freeImageAndPdf();
     this->binaryData = bytes;
+    this->renderId = ++lastRenderId;
     if (this->binaryData.length() < 4) {
         return false;
     }
 
     const std::string type = binaryData.substr(1, 3);
     if (type == "PDF") {
-        // Note: binaryData must not be modified while pdf is live.
-        this->pdf = poppler_document_new_from_data(this->binaryData.data(), this->binaryData.size(), nullptr, err);
-        if (!pdf || poppler_document_get_n_pages(this->pdf) < 1) {
-            return false;
-        }
+        // The loaded images know their size: their PDF is only parsed when they are drawn
         if (!this->width && !this->height) {
-            PopplerPage* page = poppler_document_get_page(this->pdf, 0);
-            poppler_page_get_size(page, &this->width, &this->height);
-            g_object_unref(page);
+            std::lock_guard<std::mutex> lock(this->pdfMutex);
+            if (!parsePdf(err)) {
+                return false;
+            }
+            this->width = this->pdfWidth;
+            this->height = this->pdfHeight;
         }
     } else if (type == "PNG") {
         this->image = cairo_image_surface_create_from_png_stream(
@@ -105,7 +119,67 @@ auto TexImage::loadData(std::string&& bytes, GError** err) -> bool {
 
 auto TexImage::getImage() const -> cairo_surface_t* { return this->image; }
 
-auto TexImage::getPdf() const -> PopplerDocument* { return this->pdf; }
+auto TexImage::hasPdf() const -> bool {
+    return this->binaryData.length() >= 4 && this->binaryData.compare(1, 3, "PDF") == 0;
+}
+
+auto TexImage::parsePdf(GError** err) const -> bool {
+    // Note: binaryData must not be modified while pdf is live.
+    this->pdf = poppler_document_new_from_data(const_cast<char*>(this->binaryData.data()),
+                                               static_cast<int>(this->binaryData.size()), nullptr, err);
+    if (!this->pdf || poppler_document_get_n_pages(this->pdf) < 1) {
+        g_clear_object(&this->pdf);
+        this->pdfInvalid = true;
+        return false;
+    }
+    PopplerPage* page = poppler_document_get_page(this->pdf, 0);
+    poppler_page_get_size(page, &this->pdfWidth, &this->pdfHeight);
+    g_object_unref(page);
+    return true;
+}
+
+auto TexImage::openPdf() const -> PopplerDocument* {
+    if (!hasPdf()) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(this->pdfMutex);
+    if (!this->pdf && !this->pdfInvalid) {
+        GError* err = nullptr;
+        if (!parsePdf(&err)) {
+            g_warning("Could not read the latex PDF of \"%s\": %s", this->text.c_str(),
+                      err ? err->message : "no page");
+            g_clear_error(&err);
+        }
+    }
+    return this->pdf ? static_cast<PopplerDocument*>(g_object_ref(this->pdf)) : nullptr;
+}
+
+void TexImage::releasePdf() const {
+    std::lock_guard<std::mutex> lock(this->pdfMutex);
+    g_clear_object(&this->pdf);
+}
+
+auto TexImage::getPdfPageSize(double& pageWidth, double& pageHeight) const -> bool {
+    {
+        std::lock_guard<std::mutex> lock(this->pdfMutex);
+        if (this->pdfWidth > 0 && this->pdfHeight > 0) {
+            pageWidth = this->pdfWidth;
+            pageHeight = this->pdfHeight;
+            return true;
+        }
+    }
+    PopplerDocument* doc = openPdf();
+    if (!doc) {
+        return false;
+    }
+    g_object_unref(doc);
+    std::lock_guard<std::mutex> lock(this->pdfMutex);
+    pageWidth = this->pdfWidth;
+    pageHeight = this->pdfHeight;
+    return true;
+}
+
+auto TexImage::getRenderId() const -> uint64_t { return this->renderId; }
 
 void TexImage::scale(double x0, double y0, double fx, double fy, double rotation,
                      bool) {  // line width scaling option is not used
@@ -116,6 +190,7 @@ void TexImage::scale(double x0, double y0, double fx, double fy, double rotation
     this->width *= fx;
     this->height *= fy;
     this->calcSize();
+    boundsChanged();
 }
 
 void TexImage::rotate(double x0, double y0, double th) {
@@ -147,11 +222,9 @@ void TexImage::readSerialized(ObjectInputStream& in) {
 
     freeImageAndPdf();
 
-    char* data = nullptr;
-    int len = 0;
-    in.readData(reinterpret_cast<void**>(&data), &len);
+    std::vector<char> data = in.readData<char>();
 
-    this->loadData(std::string(data, len), nullptr);
+    this->loadData(std::string(data.begin(), data.end()), nullptr);
 
     in.endObject();
     this->calcSize();
@@ -11,7 +11,9 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -44,11 +46,33 @@ public:
     cairo_surface_t* getImage() const;
 
     /**
-     * @return The PDF Document, if rendered as a PDF.
-     *
-     * The document needs to be referenced, if it will be hold somewhere
+     * @return true if the image is rendered as a PDF
      */
-    PopplerDocument* getPdf() const;
+    bool hasPdf() const;
+
+    /**
+     * @return A new reference to the PDF Document, or nullptr if the image is not rendered as a PDF or if the PDF is
+     *         invalid. The document is parsed from the binary data on the first call, and kept until releasePdf().
+     *         Thread safe.
+     */
+    PopplerDocument* openPdf() const;
+
+    /**
+     * Drops the parsed PDF Document, e.g. once it is rasterized. It is parsed again by the next call to openPdf().
+     */
+    void releasePdf() const;
+
+    /**
+     * Gets the size of the page of the PDF, in points. The PDF is parsed if the size is not known yet.
+     * @return false if the image is not rendered as a PDF or if the PDF has no page
+     */
+    bool getPdfPageSize(double& pageWidth, double& pageHeight) const;
+
+    /**
+     * @return Identifies the rendered content, e.g. for the rasterizations of xoj::view::TexImageCache. Changes
+     *         whenever data is loaded, and is shared by the clones.
+     */
+    uint64_t getRenderId() const;
 
     void scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth) override;
     void rotate(double x0, double y0, double th) override;
@@ -59,6 +83,11 @@ public:
 
     Element* clone() const override;
 
+    /**
+     * The parsed PDF is counted as large as its data
+     */
+    size_t getMemoryUsage() const override;
+
     /**
      * @return true if the binary data (PNG or PDF) was loaded successfully.
      */
@@ -79,11 +108,32 @@ private:
      */
     void freeImageAndPdf();
 
+    /**
+     * Parses the PDF and reads the size of its page. Must be called with pdfMutex held.
+     */
+    bool parsePdf(GError** err) const;
+
 private:
     /**
-     * Tex PDF Document, if rendered as PDF
+     * Tex PDF Document, if rendered as PDF. Parsed on demand, see openPdf().
+     */
+    mutable PopplerDocument* pdf = nullptr;
+
+    /**
+     * Size of the page of the PDF, 0 until it is parsed
      */
-    PopplerDocument* pdf = nullptr;
+    mutable double pdfWidth = 0;
+    mutable double pdfHeight = 0;
+
+    /**
+     * The PDF could not be parsed: it is not parsed again for each drawing
+     */
+    mutable bool pdfInvalid = false;
+
+    /**
+     * Guards the parsed PDF, which is opened from the threads of the previews and of the export
+     */
+    mutable std::mutex pdfMutex;
 
     /**
      * Tex image, if rendered as image. Note: this is deprecated and subject to removal in a later version.
@@ -104,4 +154,6 @@ private:
      * Tex String
      */
     std::string text;
+
+    uint64_t renderId = 0;
 };
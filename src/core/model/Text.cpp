@@ -14,7 +14,11 @@ Text::Text(): AudioElement(ELEMENT_TEXT) {
     this->font.setSize(12);
 }
 
-Text::~Text() = default;
+Text::~Text() {
+    if (this->layout) {
+        g_object_unref(this->layout);
+    }
+}
 
 auto Text::clone() const -> Element* {
     Text* text = new Text();
@@ -35,7 +39,10 @@ auto Text::clone() const -> Element* {
 
 auto Text::getFont() -> XojFont& { return font; }
 
-void Text::setFont(const XojFont& font) { this->font = font; }
+void Text::setFont(const XojFont& font) {
+    this->font = font;
+    boundsChanged();
+}
 
 auto Text::getFontSize() const -> double { return font.getSize(); }
 
@@ -43,10 +50,13 @@ auto Text::getFontName() const -> std::string { return font.getName(); }
 
 auto Text::getText() const -> std::string { return this->text; }
 
+auto Text::getMemoryUsage() const -> size_t { return sizeof(Text) + this->text.capacity(); }
+
 void Text::setText(std::string text) {
     this->text = std::move(text);
 
     calcSize();
+    boundsChanged();
 }
 
 void Text::calcSize() const {
@@ -57,11 +67,13 @@ void Text::calcSize() const {
 void Text::setWidth(double width) {
     this->width = width;
     this->updateSnapping();
+    boundsChanged();
 }
 
 void Text::setHeight(double height) {
     this->height = height;
     this->updateSnapping();
+    boundsChanged();
 }
 
 void Text::setInEditing(bool inEditing) { this->inEditing = inEditing; }
@@ -85,12 +97,27 @@ void Text::scale(double x0, double y0, double fx, double fy, double rotation,
     this->font.setSize(size);
 
     calcSize();
+    boundsChanged();
 }
 
 void Text::rotate(double x0, double y0, double th) {}
 
 auto Text::isInEditing() const -> bool { return this->inEditing; }
 
+void Text::withLayout(const std::function<void(PangoLayout*)>& f) const {
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+    if (!this->layout || this->layoutText != this->text || this->layoutFont.getName() != this->font.getName() ||
+        this->layoutFont.getSize() != this->font.getSize()) {
+        if (this->layout) {
+            g_object_unref(this->layout);
+        }
+        this->layout = xoj::view::TextView::createLayout(this);
+        this->layoutText = this->text;
+        this->layoutFont = this->font;
+    }
+    f(this->layout);
+}
+
 auto Text::rescaleOnlyAspectRatio() -> bool { return true; }
 
 auto Text::intersects(double x, double y, double halfEraserSize) const -> bool {
@@ -11,6 +11,10 @@
 
 #pragma once
 
+#include <functional>
+#include <mutex>
+#include <string>
+
 #include <gtk/gtk.h>
 
 #include "AudioElement.h"
@@ -37,6 +41,13 @@ public:
     void setInEditing(bool inEditing);
     bool isInEditing() const;
 
+    /**
+     * Call the function with the layout of the text, created on first use and again once the text or the font
+     * changed, see TextView::createLayout(). Can be called by several threads at once: the layout is only used by one
+     * of them at a time.
+     */
+    void withLayout(const std::function<void(PangoLayout*)>& f) const;
+
     void scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth) override;
     void rotate(double x0, double y0, double th) override;
 
@@ -47,6 +58,8 @@ public:
      */
     Element* clone() const override;
 
+    size_t getMemoryUsage() const override;
+
     bool intersects(double x, double y, double halfEraserSize) const override;
     bool intersects(double x, double y, double halfEraserSize, double* gap) const override;
 
@@ -65,4 +78,12 @@ private:
     std::string text;
 
     bool inEditing = false;
+
+    /**
+     * The cached layout, and the text and the font it was created for (the font can be edited through getFont())
+     */
+    mutable PangoLayout* layout = nullptr;
+    mutable std::string layoutText;
+    mutable XojFont layoutFont;
+    mutable std::mutex layoutMutex;
 };
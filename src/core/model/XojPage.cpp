@@ -8,6 +8,7 @@
 
 #include "BackgroundImage.h"
 #include "Document.h"
+#include "Stroke.h"
 
 XojPage::XojPage(double width, double height): width(width), height(height), bgType(PageTypeFormat::Lined) {}
 
@@ -24,6 +25,8 @@ XojPage::XojPage(XojPage const& page):
         bgType(page.bgType),
         pdfBackgroundPage(page.pdfBackgroundPage),
         backgroundColor(page.backgroundColor) {
+    page.loadLayers();
+    this->currentLayer = page.currentLayer;
     this->layer.reserve(page.layer.size());
     std::transform(begin(page.layer), end(page.layer), std::back_inserter(this->layer),
                    [](auto* layer) { return layer->clone(); });
@@ -31,12 +34,123 @@ XojPage::XojPage(XojPage const& page):
 
 auto XojPage::clone() -> XojPage* { return new XojPage(*this); }
 
+auto XojPage::snapshot(BackgroundImage backgroundImage) const -> XojPage* {
+    XojPage* copy = nullptr;
+    if (auto loader = getLayerLoader()) {
+        copy = new XojPage(this->width, this->height);
+        copy->bgType = this->bgType;
+        copy->pdfBackgroundPage = this->pdfBackgroundPage;
+        copy->backgroundColor = this->backgroundColor;
+        copy->setLayerLoader(std::move(loader));
+    } else {
+        copy = new XojPage(*this);
+    }
+    copy->backgroundImage = std::move(backgroundImage);
+    copy->backgroundVisible = this->backgroundVisible;
+    copy->backgroundName = this->backgroundName;
+    return copy;
+}
+
+void XojPage::setLayerLoader(std::shared_ptr<XojPageLayerLoader> loader) {
+    std::lock_guard<std::mutex> lock(this->layerLoaderMutex);
+    this->layerLoader = std::move(loader);
+    this->layerReloader = nullptr;
+    this->layersLoaded = this->layerLoader == nullptr;
+    this->layerLoaderRevision = getRevision();
+}
+
+auto XojPage::hasPendingLayers() const -> bool { return !this->layersLoaded; }
+
+auto XojPage::getLayerLoader() const -> std::shared_ptr<XojPageLayerLoader> {
+    std::lock_guard<std::mutex> lock(this->layerLoaderMutex);
+    return this->layerLoader;
+}
+
+auto XojPage::getLayerLoaderRevision() const -> uint64_t {
+    std::lock_guard<std::mutex> lock(this->layerLoaderMutex);
+    return this->layerLoaderRevision;
+}
+
+void XojPage::compactStrokes() {
+    if (hasPendingLayers()) {
+        return;
+    }
+
+    for (Layer* l: this->layer) {
+        for (Element* e: l->getElements()) {
+            if (e->getType() == ELEMENT_STROKE) {
+                dynamic_cast<Stroke*>(e)->compact();
+            }
+        }
+    }
+}
+
+auto XojPage::unloadLayers(std::shared_ptr<XojPageLayerLoader> loader) -> bool {
+    std::lock_guard<std::mutex> lock(this->layerLoaderMutex);
+    if (!loader || getRevision() != this->layerLoaderRevision) {
+        return false;
+    }
+
+    for (Layer* l: this->layer) { delete l; }
+    this->layer.clear();
+    this->currentLayer = npos;
+    this->layerLoader = std::move(loader);
+    this->layerReloader = nullptr;
+    this->layersLoaded = false;
+    return true;
+}
+
+auto XojPage::getLayerReloader() const -> std::shared_ptr<XojPageLayerLoader> {
+    std::lock_guard<std::mutex> lock(this->layerLoaderMutex);
+    if (!this->layersLoaded || getRevision() != this->layerLoaderRevision) {
+        return nullptr;
+    }
+    return this->layerReloader;
+}
+
+void XojPage::forgetLayerReloader() {
+    std::lock_guard<std::mutex> lock(this->layerLoaderMutex);
+    this->layerReloader = nullptr;
+}
+
+auto XojPage::getMemoryUsage() const -> size_t {
+    if (hasPendingLayers()) {
+        return 0;
+    }
+
+    size_t bytes = 0;
+    for (const Layer* l: this->layer) {
+        bytes += sizeof(Layer);
+        for (const Element* e: l->getElements()) { bytes += e->getMemoryUsage(); }
+    }
+    return bytes;
+}
+
+void XojPage::loadLayers() const {
+    if (this->layersLoaded) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->layerLoaderMutex);
+    if (this->layerLoader) {
+        auto loader = std::move(this->layerLoader);
+        this->layerLoader = nullptr;
+        // The loader only adds the layers, it does not modify the page otherwise
+        loader->loadLayers(const_cast<XojPage&>(*this));
+        this->layerReloader = std::move(loader);
+    }
+    this->layersLoaded = true;
+}
+
 void XojPage::addLayer(Layer* layer) {
+    loadLayers();
     this->layer.push_back(layer);
     this->currentLayer = npos;
+    increaseRevision();
 }
 
 void XojPage::insertLayer(Layer* layer, Layer::Index index) {
+    loadLayers();
     if (index >= this->layer.size()) {
         addLayer(layer);
         return;
@@ -44,25 +158,38 @@ void XojPage::insertLayer(Layer* layer, Layer::Index index) {
 
     this->layer.insert(std::next(this->layer.begin(), static_cast<ptrdiff_t>(index)), layer);
     this->currentLayer = index + 1;
+    increaseRevision();
 }
 
 void XojPage::removeLayer(Layer* l) {
+    loadLayers();
     if (auto it = std::find(layer.begin(), layer.end(), l); it != layer.end()) {
         this->layer.erase(it);
     }
     this->currentLayer = npos;
+    increaseRevision();
 }
 
-void XojPage::setSelectedLayerId(Layer::Index id) { this->currentLayer = id; }
+void XojPage::setSelectedLayerId(Layer::Index id) {
+    loadLayers();
+    this->currentLayer = id;
+}
 
-auto XojPage::getLayers() -> std::vector<Layer*>* { return &this->layer; }
+auto XojPage::getLayers() -> std::vector<Layer*>* {
+    loadLayers();
+    return &this->layer;
+}
 
-auto XojPage::getLayerCount() const -> Layer::Index { return this->layer.size(); }
+auto XojPage::getLayerCount() const -> Layer::Index {
+    loadLayers();
+    return this->layer.size();
+}
 
 /**
  * Layer ID 0 = Background, Layer ID 1 = Layer 1
  */
 auto XojPage::getSelectedLayerId() -> Layer::Index {
+    loadLayers();
     if (this->currentLayer == npos) {
         this->currentLayer = this->layer.size();
     }
@@ -71,6 +198,8 @@ auto XojPage::getSelectedLayerId() -> Layer::Index {
 }
 
 void XojPage::setLayerVisible(Layer::Index layerId, bool visible) {
+    loadLayers();
+    increaseRevision();
     if (layerId == 0) {
         backgroundVisible = visible;
         return;
@@ -85,6 +214,7 @@ void XojPage::setLayerVisible(Layer::Index layerId, bool visible) {
 }
 
 auto XojPage::isLayerVisible(Layer::Index layerId) const -> bool {
+    loadLayers();
     if (layerId == 0) {
         return backgroundVisible;
     }
@@ -97,19 +227,33 @@ auto XojPage::isLayerVisible(Layer::Index layerId) const -> bool {
     return this->layer[layerId]->isVisible();
 }
 
+auto XojPage::getLayerVisibility() const -> std::vector<bool> {
+    loadLayers();
+    std::vector<bool> visibility;
+    visibility.reserve(this->layer.size() + 1);
+    visibility.push_back(backgroundVisible);
+    for (Layer* l: this->layer) { visibility.push_back(l->isVisible()); }
+    return visibility;
+}
+
 void XojPage::setBackgroundPdfPageNr(size_t page) {
     this->pdfBackgroundPage = page;
     this->bgType.format = PageTypeFormat::Pdf;
     this->bgType.config = "";
+    increaseRevision();
 }
 
-void XojPage::setBackgroundColor(Color color) { this->backgroundColor = color; }
+void XojPage::setBackgroundColor(Color color) {
+    this->backgroundColor = color;
+    increaseRevision();
+}
 
 auto XojPage::getBackgroundColor() const -> Color { return this->backgroundColor; }
 
 void XojPage::setSize(double width, double height) {
     this->width = width;
     this->height = height;
+    increaseRevision();
 }
 
 auto XojPage::getWidth() const -> double { return this->width; }
@@ -119,6 +263,7 @@ auto XojPage::getHeight() const -> double { return this->height; }
 auto XojPage::getPdfPageNr() const -> size_t { return this->pdfBackgroundPage; }
 
 auto XojPage::isAnnotated() const -> bool {
+    loadLayers();
     for (Layer* l: this->layer) {
         if (l->isAnnotated()) {
             return true;
@@ -136,15 +281,20 @@ void XojPage::setBackgroundType(const PageType& bgType) {
     if (!bgType.isImagePage()) {
         this->backgroundImage.free();
     }
+    increaseRevision();
 }
 
 auto XojPage::getBackgroundType() -> PageType { return this->bgType; }
 
 auto XojPage::getBackgroundImage() -> BackgroundImage& { return this->backgroundImage; }
 
-void XojPage::setBackgroundImage(BackgroundImage img) { this->backgroundImage = std::move(img); }
+void XojPage::setBackgroundImage(BackgroundImage img) {
+    this->backgroundImage = std::move(img);
+    increaseRevision();
+}
 
 auto XojPage::getSelectedLayer() -> Layer* {
+    loadLayers();
     if (this->layer.empty()) {
         addLayer(new Layer());
     }
@@ -161,4 +311,7 @@ auto XojPage::getBackgroundName() const -> std::string { return backgroundName.v
 
 auto XojPage::backgroundHasName() const -> bool { return backgroundName.has_value(); }
 
-void XojPage::setBackgroundName(const std::string& newName) { backgroundName = newName; }
+void XojPage::setBackgroundName(const std::string& newName) {
+    backgroundName = newName;
+    increaseRevision();
+}
@@ -11,6 +11,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -24,6 +27,21 @@
 template <class T>
 using optional = std::optional<T>;
 
+class XojPage;
+
+/**
+ * Creates the layers of a page the first time they are accessed, e.g. when the file is loaded lazily
+ */
+class XojPageLayerLoader {
+public:
+    virtual ~XojPageLayerLoader() = default;
+
+    /**
+     * Add the layers to the page, which has no layers yet
+     */
+    virtual void loadLayers(XojPage& page) = 0;
+};
+
 class XojPage: public PageHandler {
 public:
     XojPage(double width, double height);
@@ -67,6 +85,11 @@ public:
     void setSelectedLayerId(Layer::Index id);
     bool isLayerVisible(Layer::Index layerId) const;
 
+    /**
+     * @return The visibility of the background and of each layer, by layer id
+     */
+    std::vector<bool> getLayerVisibility() const;
+
     Layer* getSelectedLayer();
 
     BackgroundImage& getBackgroundImage();
@@ -81,6 +104,75 @@ public:
      */
     XojPage* clone();
 
+    /**
+     * Copies this page for a snapshot of the document (see Document::snapshot()). Layers which are not loaded yet
+     * are not loaded: the copy loads them on its own from the same source.
+     *
+     * @param backgroundImage The background image of the copy
+     */
+    XojPage* snapshot(BackgroundImage backgroundImage) const;
+
+    /**
+     * Defer the creation of the layers until they are first accessed
+     */
+    void setLayerLoader(std::shared_ptr<XojPageLayerLoader> loader);
+
+    /**
+     * @return true if the layers of the page are not created yet
+     */
+    bool hasPendingLayers() const;
+
+    /**
+     * @return The loader which will create the layers, or nullptr if they are already loaded
+     */
+    std::shared_ptr<XojPageLayerLoader> getLayerLoader() const;
+
+    /**
+     * @return The revision of the page when the layer loader was set: the page is the one of the file while it has
+     *         this revision and its layers are pending
+     */
+    uint64_t getLayerLoaderRevision() const;
+
+    /**
+     * Pack the points of the strokes in memory until they are used again, see Stroke::compact(). Pages whose layers
+     * are not loaded are left as they are. Must be called with the document locked.
+     */
+    void compactStrokes();
+
+    /**
+     * Delete the layers, to be created again by the loader on next access. Frees the memory of a page which was only
+     * read since it was loaded from the loader, e.g. by an export.
+     *
+     * Only for a page whose layers are not used by anyone else, like the pages of a document snapshot.
+     *
+     * @param loader The loader the page had before its layers were loaded, see getLayerLoader()
+     * @return false if the page was changed since the loader was set: the layers are kept
+     */
+    bool unloadLayers(std::shared_ptr<XojPageLayerLoader> loader);
+
+    /**
+     * @return The loader which created the layers, while the page is unchanged since: the layers can be unloaded and
+     *         created again, see unloadLayers(). nullptr if the layers are pending, changed or not from a loader.
+     */
+    std::shared_ptr<XojPageLayerLoader> getLayerReloader() const;
+
+    /**
+     * The layers cannot be created again by their loader anymore, e.g. its file is overwritten: they are kept
+     */
+    void forgetLayerReloader();
+
+    /**
+     * @return The approximate memory of the elements, 0 if the layers are pending. Must be called with the document
+     *         locked.
+     */
+    size_t getMemoryUsage() const;
+
+private:
+    /**
+     * Run the layer loader, if any. Called by all the methods accessing the layers.
+     */
+    void loadLayers() const;
+
 private:
     /**
      * The Background image if any
@@ -128,9 +220,31 @@ private:
      */
     optional<std::string> backgroundName;
 
+    /**
+     * Creates the layers on first access, see setLayerLoader()
+     */
+    mutable std::shared_ptr<XojPageLayerLoader> layerLoader;
+
+    /**
+     * The loader which created the layers, see getLayerReloader()
+     */
+    mutable std::shared_ptr<XojPageLayerLoader> layerReloader;
+    mutable std::atomic<bool> layersLoaded{true};
+    uint64_t layerLoaderRevision = 0;
+    mutable std::mutex layerLoaderMutex;
+
+    /**
+     * Guards the elements of the page, see Document::lockPage()
+     */
+    mutable std::mutex contentMutex;
+    friend class Document;
+
     // Allow LoadHandler to add layers directly
     friend class LoadHandler;
 
+    // Allow EmergencyDump to add the layers it read
+    friend class EmergencyDump;
+
     // Allow LayerController to modify layers of a page
     // Notifications were be sent
     friend class LayerController;
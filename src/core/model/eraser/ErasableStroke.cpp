@@ -49,7 +49,7 @@ void ErasableStroke::beginErasure(const IntersectionParametersContainer& paddedI
 
     assert(paddedIntersections.size() % 2 == 0);
 
-    UnionOfIntervals<PathParameter> erasedSections;
+    SubSections erasedSections;
     erasedSections.appendData(paddedIntersections);
 
     // Now remaining sections
@@ -131,7 +131,7 @@ void ErasableStroke::erase(const PaddedBox& box, Range& range) {
      *
      * This avoids computing a segment's intersections with the eraser box twice
      */
-    std::vector<Interval<size_t>> indexIntervals;
+    SmallVector<Interval<size_t>, 4> indexIntervals;
 
     for (const SubSection& section: sections) {
         if (getSubSectionBoundingBox(section).intersects(box.getInnerRectangle())) {
@@ -148,7 +148,7 @@ void ErasableStroke::erase(const PaddedBox& box, Range& range) {
         }
     }
 
-    UnionOfIntervals<PathParameter> newErasedSections;
+    SubSections newErasedSections;
 
     for (auto& i: indexIntervals) {
         newErasedSections.appendData(this->stroke.intersectWithPaddedBox(box, i.min, i.max));
@@ -20,6 +20,7 @@
 #include "model/PathParameter.h"
 #include "model/Stroke.h"
 #include "util/Rectangle.h"
+#include "util/SmallVector.h"
 #include "util/UnionOfIntervals.h"
 
 #include "config-debug.h"
@@ -37,6 +38,12 @@ public:
      */
     using SubSection = Interval<PathParameter>;
 
+    /**
+     * @brief Type for the unions of subsections, updated at each eraser event
+     * Erasing seldom leaves more than a few subsections: their bounds are stored without allocation
+     */
+    using SubSections = UnionOfIntervals<PathParameter, SmallVector<PathParameter, 8>>;
+
 public:
     /**
      * @brief Starts erasing the stroke, with the already computed intersection parameters
@@ -104,7 +111,7 @@ protected:
      * @brief Parameters for the subsections that have not (yet) been erased
      * Protected by the associated mutex
      */
-    UnionOfIntervals<PathParameter> remainingSections{};
+    SubSections remainingSections{};
     mutable std::mutex sectionsMutex;
 
     /**
@@ -1,13 +1,18 @@
 #include "XojCairoPdfExport.h"
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
 #include <map>
 #include <sstream>
 #include <stack>
+#include <utility>
 #include <vector>
 
 #include <cairo-pdf.h>
 #include <config.h>
 
+#include "control/jobs/Executor.h"
 #include "util/Util.h"
 #include "util/i18n.h"
 #include "util/serdesstream.h"
@@ -31,6 +36,8 @@ void XojCairoPdfExport::setExportBackground(ExportBackgroundType exportBackgroun
     this->exportBackground = exportBackground;
 }
 
+void XojCairoPdfExport::setStreaming(bool streaming) { this->streaming = streaming; }
+
 auto XojCairoPdfExport::startPdf(const fs::path& file) -> bool {
     this->surface = cairo_pdf_surface_create(file.u8string().c_str(), 0, 0);
     this->cr = cairo_create(surface);
@@ -38,6 +45,8 @@ auto XojCairoPdfExport::startPdf(const fs::path& file) -> bool {
 #if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 16, 0)
     cairo_pdf_surface_set_metadata(surface, CAIRO_PDF_METADATA_TITLE, doc->getFilepath().filename().u8string().c_str());
     cairo_pdf_surface_set_metadata(surface, CAIRO_PDF_METADATA_CREATOR, PROJECT_STRING);
+    // The outline of the document is read on demand, and the exported snapshots never read it
+    doc->buildContentsModel();
     GtkTreeModel* tocModel = doc->getContentsModel();
     this->populatePdfOutline(tocModel);
 #endif
@@ -96,38 +105,103 @@ void XojCairoPdfExport::populatePdfOutline(GtkTreeModel* tocModel) {
 #endif
 
 void XojCairoPdfExport::endPdf() {
+    for (auto& [pdfPage, recording]: this->backgrounds) {
+        cairo_surface_destroy(recording);
+    }
+    this->backgrounds.clear();
+    this->backgroundUses.clear();
+
     cairo_destroy(this->cr);
     this->cr = nullptr;
     cairo_surface_destroy(this->surface);
     this->surface = nullptr;
 }
 
+void XojCairoPdfExport::drawPageContent(const PageRef& p, cairo_t* cr) const {
+    DocumentView view;
+    view.setLevelOfDetail(STROKE_DETAIL_SCALE);
+    view.drawPage(p, cr, true /* dont render eraseable */, true /* don't rerender the pdf background */,
+                  exportBackground == EXPORT_BACKGROUND_NONE, exportBackground <= EXPORT_BACKGROUND_UNRULED);
+}
+
 void XojCairoPdfExport::exportPage(size_t page) {
     PageRef p = doc->getPage(page);
 
     cairo_pdf_surface_set_size(this->surface, p->getWidth(), p->getHeight());
 
-    DocumentView view;
-
     cairo_save(this->cr);
 
     if (p->getBackgroundType().isPdfPage() && (exportBackground != EXPORT_BACKGROUND_NONE)) {
-        auto pgNo = p->getPdfPageNr();
-        XojPdfPageSPtr popplerPage = doc->getPdfPage(pgNo);
-
-        popplerPage->renderForPrinting(cr);
+        drawPdfBackground(p->getPdfPageNr());
     }
 
-    view.drawPage(p, this->cr, true /* dont render eraseable */, true /* don't rerender the pdf background */,
-                  exportBackground == EXPORT_BACKGROUND_NONE, exportBackground <= EXPORT_BACKGROUND_UNRULED);
+    drawPageContent(p, this->cr);
 
     // next page
     cairo_show_page(this->cr);
     cairo_restore(this->cr);
 }
 
+void XojCairoPdfExport::countBackgroundUses(size_t page, bool progressiveMode) {
+    PageRef p = doc->getPage(page);
+    if (!p || !p->getBackgroundType().isPdfPage() || exportBackground == EXPORT_BACKGROUND_NONE) {
+        return;
+    }
+    if (!progressiveMode) {
+        this->backgroundUses[p->getPdfPageNr()]++;
+        return;
+    }
+
+    // See exportPageLayers(). Counting the layers parses them: a streaming export parses them again when exporting.
+    auto loader = this->streaming ? p->getLayerLoader() : nullptr;
+    this->backgroundUses[p->getPdfPageNr()] += p->getLayerCount();
+    if (loader) {
+        p->unloadLayers(std::move(loader));
+    }
+}
+
+void XojCairoPdfExport::drawPdfBackground(size_t pdfPage) {
+    XojPdfPageSPtr popplerPage = doc->getPdfPage(pdfPage);
+    if (!popplerPage) {
+        return;
+    }
+
+    auto uses = this->backgroundUses.find(pdfPage);
+    auto recorded = this->backgrounds.find(pdfPage);
+    if (recorded == this->backgrounds.end() && (uses == this->backgroundUses.end() || uses->second <= 1)) {
+        // Used once: nothing to share
+        popplerPage->renderForPrinting(cr);
+        if (uses != this->backgroundUses.end()) {
+            this->backgroundUses.erase(uses);
+        }
+        return;
+    }
+
+    if (recorded == this->backgrounds.end()) {
+        cairo_rectangle_t extents{0, 0, popplerPage->getWidth(), popplerPage->getHeight()};
+        cairo_surface_t* recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &extents);
+        cairo_t* recordingCr = cairo_create(recording);
+        popplerPage->renderForPrinting(recordingCr);
+        cairo_destroy(recordingCr);
+        recorded = this->backgrounds.emplace(pdfPage, recording).first;
+    }
+
+    cairo_save(cr);
+    cairo_set_source_surface(cr, recorded->second, 0, 0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    if (uses == this->backgroundUses.end() || --uses->second == 0) {
+        cairo_surface_destroy(recorded->second);
+        this->backgrounds.erase(recorded);
+        if (uses != this->backgroundUses.end()) {
+            this->backgroundUses.erase(uses);
+        }
+    }
+}
+
 // export layers one by one to produce as many PDF pages as there are layers.
-void XojCairoPdfExport::exportPageLayers(size_t page) {
+void XojCairoPdfExport::exportPageLayers(size_t page, const std::function<void()>& exportStep) const {
     PageRef p = doc->getPage(page);
 
     // We keep a copy of the layers initial Visible state
@@ -141,56 +215,188 @@ void XojCairoPdfExport::exportPageLayers(size_t page) {
     // only Layer 1 visible, the last has all layers visible.
     for (const auto& layer: *p->getLayers()) {
         layer->setVisible(true);
-        exportPage(page);
+        exportStep();
     }
 
     // We restore the initial visibilities
     for (const auto& layer: *p->getLayers()) layer->setVisible(initialVisibility[layer]);
 }
 
-auto XojCairoPdfExport::createPdf(fs::path const& file, const PageRangeVector& range, bool progressiveMode) -> bool {
-    if (range.empty()) {
-        this->lastError = _("No pages to export!");
-        return false;
-    }
+void XojCairoPdfExport::exportPageStep(size_t page, bool progressiveMode, int state) {
+    auto start = std::chrono::steady_clock::now();
 
-    if (!startPdf(file)) {
-        this->lastError = _("Failed to initialize PDF Cairo surface");
-        this->lastError += "\nCairo error: ";
-        this->lastError += cairo_status_to_string(cairo_surface_status(this->surface));
-        return false;
+    PageRef p = doc->getPage(page);
+    // The loader of the layers, if they are parsed by this export
+    auto loader = this->streaming ? p->getLayerLoader() : nullptr;
+
+    if (progressiveMode) {
+        exportPageLayers(page, [this, page]() { exportPage(page); });
+    } else {
+        exportPage(page);
     }
 
-    size_t count = 0;
-    for (const auto& e: range) { count += e.last - e.first + 1; }
+    // cairo writes the content of each page when it is shown: only the shared resources (fonts, images, recorded
+    // backgrounds) stay in memory until the end
+    cairo_surface_flush(this->surface);
+    if (loader) {
+        p->unloadLayers(std::move(loader));
+    }
 
     if (this->progressListener) {
-        this->progressListener->setMaximumState(count);
+        this->progressListener->setCurrentState(state);
+        this->progressListener->setStateDuration(state, std::chrono::steady_clock::now() - start);
     }
+}
 
-    size_t c = 0;
-    for (const auto& e: range) {
-        auto max = std::min(e.last, doc->getPageCount());
-        for (size_t i = e.first; i <= max; i++) {
-            if (progressiveMode) {
-                exportPageLayers(i);
-            } else {
-                exportPage(i);
-            }
+XojCairoPdfExport::RecordedPage::RecordedPage(size_t page): page(page), sharedBackground(npos) {}
 
-            if (this->progressListener) {
-                this->progressListener->setCurrentState(c++);
+XojCairoPdfExport::RecordedPage::~RecordedPage() {
+    for (Recording& r: this->recordings) {
+        cairo_surface_destroy(r.surface);
+    }
+}
+
+auto XojCairoPdfExport::prepareRecording(size_t page) const -> RecordedPage {
+    RecordedPage recorded(page);
+    PageRef p = doc->getPage(page);
+    if (!p->getBackgroundType().isPdfPage() || exportBackground == EXPORT_BACKGROUND_NONE) {
+        return recorded;
+    }
+
+    // As drawPdfBackground(): a background used once is drawn by Poppler into the page, in parallel
+    size_t pdfPage = p->getPdfPageNr();
+    auto uses = this->backgroundUses.find(pdfPage);
+    if (this->backgrounds.count(pdfPage) || (uses != this->backgroundUses.end() && uses->second > 1)) {
+        recorded.sharedBackground = pdfPage;
+    } else {
+        recorded.recordBackground = true;
+    }
+    return recorded;
+}
+
+void XojCairoPdfExport::recordPage(RecordedPage& recorded, bool progressiveMode) const {
+    auto start = std::chrono::steady_clock::now();
+
+    PageRef p = doc->getPage(recorded.page);
+    auto loader = this->streaming ? p->getLayerLoader() : nullptr;
+
+    auto record = [&]() {
+        cairo_rectangle_t extents{0, 0, p->getWidth(), p->getHeight()};
+        cairo_surface_t* recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &extents);
+        cairo_t* recordingCr = cairo_create(recording);
+        if (recorded.recordBackground) {
+            if (XojPdfPageSPtr popplerPage = doc->getPdfPage(p->getPdfPageNr())) {
+                popplerPage->renderForPrinting(recordingCr);
             }
         }
+        drawPageContent(p, recordingCr);
+        cairo_destroy(recordingCr);
+        recorded.recordings.push_back({p->getWidth(), p->getHeight(), recording});
+    };
+
+    if (progressiveMode) {
+        // The task has the page to itself
+        exportPageLayers(recorded.page, record);
+    } else {
+        record();
     }
 
-    endPdf();
+    // The recordings keep what they need of the elements
+    if (loader) {
+        p->unloadLayers(std::move(loader));
+    }
+    recorded.duration = std::chrono::steady_clock::now() - start;
+}
+
+void XojCairoPdfExport::writeRecordedPage(RecordedPage& recorded, int state) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (RecordedPage::Recording& r: recorded.recordings) {
+        cairo_pdf_surface_set_size(this->surface, r.width, r.height);
+        cairo_save(this->cr);
+        if (recorded.sharedBackground != npos) {
+            drawPdfBackground(recorded.sharedBackground);
+        }
+        cairo_set_source_surface(this->cr, r.surface, 0, 0);
+        cairo_paint(this->cr);
+        cairo_show_page(this->cr);
+        cairo_restore(this->cr);
+
+        cairo_surface_destroy(r.surface);
+    }
+    recorded.recordings.clear();
+    cairo_surface_flush(this->surface);
+
+    if (this->progressListener) {
+        this->progressListener->setCurrentState(state);
+        this->progressListener->setStateDuration(state,
+                                                 recorded.duration + (std::chrono::steady_clock::now() - start));
+    }
+}
+
+auto XojCairoPdfExport::exportPagesInParallel(const std::vector<size_t>& pages, bool progressiveMode) -> bool {
+    const size_t batchSize = PAGES_PER_THREAD * Executor::getInstance().getThreadCount();
+
+    auto prepare = [&](size_t from) {
+        std::vector<RecordedPage> batch;
+        batch.reserve(batchSize);
+        for (size_t i = from; i < std::min(from + batchSize, pages.size()); i++) {
+            batch.push_back(prepareRecording(pages[i]));
+        }
+        return batch;
+    };
+    auto record = [&](TaskGroup& tasks, std::vector<RecordedPage>& batch) {
+        tasks.forEach(batch.size(), [&](size_t i) { recordPage(batch[i], progressiveMode); });
+    };
+    auto join = [&](TaskGroup& tasks) {
+        try {
+            tasks.join();
+            return true;
+        } catch (const std::exception& e) {
+            this->lastError = e.what();
+            return false;
+        }
+    };
+
+    std::vector<RecordedPage> current = prepare(0);
+    {
+        TaskGroup tasks;
+        record(tasks, current);
+        if (!join(tasks)) {
+            return false;
+        }
+    }
+
+    for (size_t from = 0; from < pages.size(); from += batchSize) {
+        // The backgrounds of the next batch are assigned before those of this one are drawn, see prepareRecording()
+        std::vector<RecordedPage> next = prepare(from + batchSize);
+        TaskGroup tasks;
+        record(tasks, next);
+
+        bool cancelled = false;
+        for (size_t i = 0; i < current.size(); i++) {
+            if (this->progressListener && this->progressListener->isCancelRequested()) {
+                tasks.cancel();
+                cancelled = true;
+                break;
+            }
+            writeRecordedPage(current[i], static_cast<int>(from + i));
+        }
+        if (!join(tasks)) {
+            return false;
+        }
+        if (cancelled) {
+            this->lastError = _("The export was cancelled");
+            return false;
+        }
+        current = std::move(next);
+    }
     return true;
 }
 
-auto XojCairoPdfExport::createPdf(fs::path const& file, bool progressiveMode) -> bool {
-    if (doc->getPageCount() < 1) {
-        lastError = _("No pages to export!");
+auto XojCairoPdfExport::createPdf(fs::path const& file, const PageRangeVector& range, bool progressiveMode) -> bool {
+    if (range.empty()) {
+        this->lastError = _("No pages to export!");
         return false;
     }
 
@@ -201,25 +407,48 @@ auto XojCairoPdfExport::createPdf(fs::path const& file, bool progressiveMode) ->
         return false;
     }
 
-    auto count = doc->getPageCount();
+    size_t count = 0;
+    for (const auto& e: range) { count += e.last - e.first + 1; }
+
     if (this->progressListener) {
         this->progressListener->setMaximumState(count);
     }
 
-    for (decltype(count) i = 0; i < count; i++) {
-        if (progressiveMode) {
-            exportPageLayers(i);
-        } else {
-            exportPage(i);
+    std::vector<size_t> pages;
+    pages.reserve(count);
+    for (const auto& e: range) {
+        for (size_t i = e.first; i <= e.last && i < doc->getPageCount(); i++) {
+            countBackgroundUses(i, progressiveMode);
+            pages.push_back(i);
         }
+    }
 
-        if (this->progressListener) {
-            this->progressListener->setCurrentState(i);
+    if (pages.size() > 1 && Executor::getInstance().getThreadCount() > 1) {
+        bool exported = exportPagesInParallel(pages, progressiveMode);
+        endPdf();
+        return exported;
+    }
+
+    for (size_t c = 0; c < pages.size(); c++) {
+        if (this->progressListener && this->progressListener->isCancelRequested()) {
+            endPdf();
+            this->lastError = _("The export was cancelled");
+            return false;
         }
+        exportPageStep(pages[c], progressiveMode, static_cast<int>(c));
     }
 
     endPdf();
     return true;
 }
 
+auto XojCairoPdfExport::createPdf(fs::path const& file, bool progressiveMode) -> bool {
+    if (doc->getPageCount() < 1) {
+        lastError = _("No pages to export!");
+        return false;
+    }
+
+    return createPdf(file, {PageRangeEntry(0, doc->getPageCount() - 1)}, progressiveMode);
+}
+
 auto XojCairoPdfExport::getLastError() -> std::string { return lastError; }
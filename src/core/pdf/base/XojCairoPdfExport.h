@@ -11,6 +11,10 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
 #include <vector>
 
 #include "control/jobs/BaseExportJob.h"
@@ -35,6 +39,8 @@ public:
      */
     void setExportBackground(ExportBackgroundType exportBackground) override;
 
+    void setStreaming(bool streaming) override;
+
 private:
     bool startPdf(const fs::path& file);
 #if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 16, 0)
@@ -50,10 +56,109 @@ private:
 #endif
     void endPdf();
     void exportPage(size_t page);
+
+    /**
+     * Draw the layers of the page, above its PDF background
+     */
+    void drawPageContent(const PageRef& p, cairo_t* cr) const;
+
+    /**
+     * The strokes are exported with the points visible at this scale, in device pixels per point (1800 DPI): the
+     * points of the tablets which are closer than 0.01 pt to the drawn line are dropped, no printer or zoom shows them
+     */
+    static constexpr double STROKE_DETAIL_SCALE = 25;
+
     /**
      * Export as a PDF document where each additional layer creates a
-     * new page */
-    void exportPageLayers(size_t page);
+     * new page
+     * @param exportStep Exports the page once the visibility of the layers is set
+     */
+    void exportPageLayers(size_t page, const std::function<void()>& exportStep) const;
+
+    /**
+     * Export the page as one or several PDF pages, then hand them over to the output and report the time taken
+     *
+     * @param state The progress state reached after the page
+     */
+    void exportPageStep(size_t page, bool progressiveMode, int state);
+
+    /**
+     * Count the uses of the PDF background of the page, see drawPdfBackground()
+     */
+    void countBackgroundUses(size_t page, bool progressiveMode);
+
+    /**
+     * Draw a page of the background PDF. A PDF page drawn several times in the export (cloned background pages,
+     * progressive mode) is rendered once by Poppler, in a recording surface: cairo writes it once in the PDF, as a form
+     * referenced by each page.
+     */
+    void drawPdfBackground(size_t pdfPage);
+
+    /**
+     * A page of the document recorded by a task of the Executor, to be written to the PDF surface in order
+     */
+    struct RecordedPage {
+        explicit RecordedPage(size_t page);
+        ~RecordedPage();
+        RecordedPage(RecordedPage&&) = default;
+        RecordedPage(const RecordedPage&) = delete;
+        RecordedPage& operator=(const RecordedPage&) = delete;
+
+        size_t page;
+
+        /**
+         * The PDF background drawn by the task into the recordings, if it is used only by this page
+         */
+        bool recordBackground = false;
+
+        /**
+         * The PDF background shared with other pages, drawn by drawPdfBackground() when the page is written. npos if
+         * none.
+         */
+        size_t sharedBackground;
+
+        /**
+         * One PDF page each, several in progressive mode, with their size
+         */
+        struct Recording {
+            double width;
+            double height;
+            cairo_surface_t* surface;
+        };
+        std::vector<Recording> recordings;
+
+        std::chrono::steady_clock::duration duration{};
+    };
+
+    /**
+     * Export the pages in batches: the pages of a batch are recorded in parallel while the previous batch is written
+     * to the PDF surface by this thread. cairo writes the surface with one thread, the drawing of the pages, their PDF
+     * backgrounds and their parsing in streaming mode is parallel.
+     *
+     * @return false if the export was cancelled
+     */
+    bool exportPagesInParallel(const std::vector<size_t>& pages, bool progressiveMode);
+
+    /**
+     * Which of the backgrounds of the page the task draws. Called by the exporting thread.
+     */
+    RecordedPage prepareRecording(size_t page) const;
+
+    /**
+     * Record the page, called by the tasks of the Executor
+     */
+    void recordPage(RecordedPage& recorded, bool progressiveMode) const;
+
+    /**
+     * Write the recorded page to the PDF surface and report its time
+     */
+    void writeRecordedPage(RecordedPage& recorded, int state);
+
+    /**
+     * Number of pages recorded ahead per thread of the Executor, until they are written: the recordings of the
+     * drawings take memory
+     */
+    static constexpr size_t PAGES_PER_THREAD = 2;
 
 private:
     Document* doc = nullptr;
@@ -64,5 +169,20 @@ private:
 
     ExportBackgroundType exportBackground = EXPORT_BACKGROUND_ALL;
 
+    /**
+     * Unload the layers of the exported pages, see setStreaming()
+     */
+    bool streaming = false;
+
+    /**
+     * The number of remaining uses of each PDF page in the export
+     */
+    std::map<size_t, size_t> backgroundUses;
+
+    /**
+     * The recorded PDF pages used more than once, until their last use
+     */
+    std::map<size_t, cairo_surface_t*> backgrounds;
+
     std::string lastError;
 };
@@ -38,6 +38,10 @@ auto XojPdfDocument::load(gpointer data, gsize length, std::string password, GEr
     return doc->load(data, length, password, error);
 }
 
+auto XojPdfDocument::loadMapped(fs::path const& file, std::string password, GError** error) -> bool {
+    return doc->loadMapped(file, password, error);
+}
+
 auto XojPdfDocument::isLoaded() const -> bool { return doc->isLoaded(); }
 
 auto XojPdfDocument::getPage(size_t page) const -> XojPdfPageSPtr { return doc->getPage(page); }
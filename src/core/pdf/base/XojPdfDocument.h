@@ -37,6 +37,7 @@ public:
     bool save(fs::path const& file, GError** error) const override;
     bool load(fs::path const& file, std::string password, GError** error) override;
     bool load(gpointer data, gsize length, std::string password, GError** error) override;
+    bool loadMapped(fs::path const& file, std::string password, GError** error) override;
     bool isLoaded() const override;
 
     XojPdfPageSPtr getPage(size_t page) const override;
@@ -31,6 +31,11 @@ public:
     virtual bool save(fs::path const& file, GError** error) const = 0;
     virtual bool load(fs::path const& file, std::string password, GError** error) = 0;
     virtual bool load(gpointer data, gsize length, std::string password, GError** error) = 0;
+    /**
+     * Load the file by mapping it in memory: its content is not copied to the heap, and the file can be removed once
+     * it is loaded (where the system allows removing a mapped file).
+     */
+    virtual bool loadMapped(fs::path const& file, std::string password, GError** error) = 0;
     virtual bool isLoaded() const = 0;
 
     virtual XojPdfPageSPtr getPage(size_t page) const = 0;
@@ -0,0 +1,44 @@
+#include "XojPdfDocumentPool.h"
+
+auto XojPdfDocumentPool::getInstance() -> XojPdfDocumentPool& {
+    static XojPdfDocumentPool instance;
+    return instance;
+}
+
+auto XojPdfDocumentPool::get(const fs::path& file, XojPdfDocument& doc) -> bool {
+    std::error_code ec;
+    auto time = fs::last_write_time(file, ec);
+    if (ec) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (auto it = this->entries.begin(); it != this->entries.end(); ++it) {
+        if (it->file != file) {
+            continue;
+        }
+        if (it->time != time) {
+            this->entries.erase(it);
+            return false;
+        }
+        this->entries.splice(this->entries.begin(), this->entries, it);
+        doc = it->doc;
+        return true;
+    }
+    return false;
+}
+
+void XojPdfDocumentPool::put(const fs::path& file, const XojPdfDocument& doc) {
+    std::error_code ec;
+    auto time = fs::last_write_time(file, ec);
+    if (ec) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->entries.remove_if([&](const Entry& e) { return e.file == file; });
+    this->entries.push_front({file, time, doc});
+    while (this->entries.size() > MAX_DOCUMENTS) {
+        this->entries.pop_back();
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * Xournal++
+ *
+ * PDF documents shared by the documents loaded one after another
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+
+#include "XojPdfDocument.h"
+#include "filesystem.h"
+
+/**
+ * @brief The PDF files opened last, so that documents with the same PDF background do not parse it again
+ *
+ * A document found in the pool shares its Poppler document with the pool, see XojPdfDocument::assign(). A file is
+ * opened again once it is modified. The documents sharing a Poppler document also share their rasterizations, see
+ * PdfCache::getShared().
+ */
+class XojPdfDocumentPool {
+public:
+    /**
+     * @return The pool of the process, used by the documents of the main window and by the batch exports
+     */
+    static XojPdfDocumentPool& getInstance();
+
+    /**
+     * @return true if the file is in the pool, which is then assigned to doc
+     */
+    bool get(const fs::path& file, XojPdfDocument& doc);
+
+    void put(const fs::path& file, const XojPdfDocument& doc);
+
+    static constexpr size_t MAX_DOCUMENTS = 16;
+
+private:
+    struct Entry {
+        fs::path file;
+        fs::file_time_type time;
+        XojPdfDocument doc;
+    };
+
+    /**
+     * The most recently used first
+     */
+    std::list<Entry> entries;
+
+    std::mutex mutex;
+};
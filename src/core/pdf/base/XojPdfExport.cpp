@@ -10,3 +10,10 @@ XojPdfExport::~XojPdfExport() = default;
 void XojPdfExport::setExportBackground(ExportBackgroundType exportBackground) {
     // Does nothing in the base class
 }
+
+/**
+ * Free each page once it is exported
+ */
+void XojPdfExport::setStreaming(bool streaming) {
+    // Does nothing in the base class
+}
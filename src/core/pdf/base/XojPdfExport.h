@@ -33,5 +33,11 @@ public:
      */
     virtual void setExportBackground(ExportBackgroundType exportBackground);
 
+    /**
+     * Free each page once it is exported, to bound the memory used by the export of huge documents. Only for a
+     * document which is not used by anyone else during the export, like a snapshot.
+     */
+    virtual void setStreaming(bool streaming);
+
 private:
 };
@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <limits>
 #include <memory>  // std::shared_ptr
 #include <string>
 #include <vector>
@@ -48,6 +50,24 @@ public:
         std::vector<XojPdfRectangle> rects;
     };
 
+    struct TextLayout {
+        std::string text;
+        /// One per character (not byte) of the text
+        std::vector<XojPdfRectangle> charBoxes;
+    };
+
+    /// A link, or an annotation with a text, with the origin in the top left corner
+    struct Link {
+        XojPdfRectangle rect;
+        /// The page (number in the pdf document) an internal link goes to, else npos
+        size_t destPage = std::numeric_limits<size_t>::max();
+        /// The top of the destination on that page
+        double destTop = 0;
+        /// The URI of an external link, or the text of an annotation
+        std::string text;
+        bool annotation = false;
+    };
+
     virtual double getWidth() const = 0;
     virtual double getHeight() const = 0;
 
@@ -64,6 +84,19 @@ public:
 
     virtual std::vector<XojPdfRectangle> findText(std::string& text) = 0;
 
+    /// Retrieve all the text of the page. Can be called by several threads at once.
+    /// @return The text, in reading order.
+    virtual std::string getText() const = 0;
+
+    /// Retrieve the text of the page with the box of each character, to look the selections up without Poppler. Can
+    /// be called by several threads at once.
+    /// @return The text, in reading order, and the boxes, with the origin in the top left corner.
+    virtual TextLayout getTextLayout() const = 0;
+
+    /// Retrieve the links and the annotations of the page. Can be called by several threads at once.
+    /// @return The internal links, the external links and the annotations which have a text
+    virtual std::vector<Link> getLinks() const = 0;
+
     /// Retrieve the text contained in the provided rectangle using the given
     /// selection style.
     /// @param rect start and end points
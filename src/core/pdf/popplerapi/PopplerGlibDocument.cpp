@@ -1,6 +1,8 @@
 #include "PopplerGlibDocument.h"
 
+#include <limits>
 #include <memory>
+#include <utility>
 
 #include "util/PathUtil.h"
 #include "util/Util.h"
@@ -13,7 +15,8 @@ using std::string;
 
 PopplerGlibDocument::PopplerGlibDocument() = default;
 
-PopplerGlibDocument::PopplerGlibDocument(const PopplerGlibDocument& doc): document(doc.document) {
+PopplerGlibDocument::PopplerGlibDocument(const PopplerGlibDocument& doc):
+        document(doc.document), renderHandles(doc.renderHandles), pageSizes(doc.pageSizes) {
     if (document) {
         g_object_ref(document);
     }
@@ -32,6 +35,8 @@ void PopplerGlibDocument::assign(XojPdfDocumentInterface* doc) {
     }
 
     document = (dynamic_cast<PopplerGlibDocument*>(doc))->document;
+    renderHandles = (dynamic_cast<PopplerGlibDocument*>(doc))->renderHandles;
+    pageSizes = (dynamic_cast<PopplerGlibDocument*>(doc))->pageSizes;
     if (document) {
         g_object_ref(document);
     }
@@ -65,16 +70,54 @@ auto PopplerGlibDocument::load(fs::path const& file, string password, GError** e
     }
 
     this->document = poppler_document_new_from_file(uri->c_str(), password.c_str(), error);
+    this->renderHandles =
+            this->document ? std::make_shared<PopplerGlibRenderHandles>(*uri, std::move(password)) : nullptr;
+    this->pageSizes = this->document ? std::make_shared<PopplerGlibPageSizes>(this->document) : nullptr;
     return this->document != nullptr;
 }
 
 auto PopplerGlibDocument::load(gpointer data, gsize length, string password, GError** error) -> bool {
+    // Poppler does not copy the data, which the caller may free: one copy, shared by all the handles
+    GBytes* bytes = g_bytes_new(data, length);
+    bool loaded = load(bytes, std::move(password), error);
+    g_bytes_unref(bytes);
+    return loaded;
+}
+
+auto PopplerGlibDocument::loadMapped(fs::path const& file, string password, GError** error) -> bool {
+    GMappedFile* mapped = g_mapped_file_new(file.u8string().c_str(), false, error);
+    if (!mapped) {
+        return false;
+    }
+    GBytes* bytes = g_mapped_file_get_bytes(mapped);
+    g_mapped_file_unref(mapped);
+
+    bool loaded = load(bytes, std::move(password), error);
+    g_bytes_unref(bytes);
+    return loaded;
+}
+
+auto PopplerGlibDocument::load(GBytes* data, string password, GError** error) -> bool {
     if (document) {
         g_object_unref(document);
+        document = nullptr;
+    }
+
+    gsize length = 0;
+    const auto* bytes = static_cast<const char*>(g_bytes_get_data(data, &length));
+    if (length > static_cast<gsize>(std::numeric_limits<int>::max())) {
+        g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_FBIG, "The PDF document is too large");
+        this->renderHandles = nullptr;
+        this->pageSizes = nullptr;
+        return false;
     }
 
-    this->document =
-            poppler_document_new_from_data(static_cast<char*>(data), static_cast<int>(length), password.c_str(), error);
+    this->document = poppler_document_new_from_data(const_cast<char*>(bytes), static_cast<int>(length),
+                                                    password.c_str(), error);
+    // The render handles keep the data alive as long as a handle, a page or a copy of the document exists
+    this->renderHandles =
+            this->document ? std::make_shared<PopplerGlibRenderHandles>(data, std::move(password)) : nullptr;
+    this->pageSizes = this->document ? std::make_shared<PopplerGlibPageSizes>(this->document) : nullptr;
     return this->document != nullptr;
 }
 
@@ -85,11 +128,11 @@ auto PopplerGlibDocument::getPage(size_t page) const -> XojPdfPageSPtr {
         return nullptr;
     }
 
-    PopplerPage* pg = poppler_document_get_page(document, int(page));
-    XojPdfPageSPtr pageptr = std::make_shared<PopplerGlibPage>(pg);
-    g_object_unref(pg);
-
-    return pageptr;
+    if (page >= getPageCount()) {
+        return nullptr;
+    }
+    // Does not open the Poppler page yet
+    return std::make_shared<PopplerGlibPage>(document, static_cast<int>(page), pageSizes, renderHandles);
 }
 
 auto PopplerGlibDocument::getPageCount() const -> size_t {
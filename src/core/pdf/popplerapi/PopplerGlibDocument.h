@@ -11,10 +11,14 @@
 
 #pragma once
 
+#include <memory>
+
 #include <poppler.h>
 
 #include "pdf/base/XojPdfDocumentInterface.h"
 
+#include "PopplerGlibPageSizes.h"
+#include "PopplerGlibRenderHandles.h"
 #include "filesystem.h"
 
 class PopplerGlibDocument: public XojPdfDocumentInterface {
@@ -31,12 +35,29 @@ public:
     bool save(fs::path const& filepath, GError** error) const override;
     bool load(fs::path const& filepath, std::string password, GError** error) override;
     bool load(gpointer data, gsize length, std::string password, GError** error) override;
+    bool loadMapped(fs::path const& file, std::string password, GError** error) override;
     bool isLoaded() const override;
 
     XojPdfPageSPtr getPage(size_t page) const override;
     size_t getPageCount() const override;
     XojPdfBookmarkIterator* getContentsIter() const override;
 
+private:
+    /**
+     * Load the document from the data, which is shared with the render handles instead of being copied
+     */
+    bool load(GBytes* data, std::string password, GError** error);
+
 private:
     PopplerDocument* document = nullptr;
+
+    /**
+     * Handles used to render the pages concurrently, shared with the pages
+     */
+    std::shared_ptr<PopplerGlibRenderHandles> renderHandles;
+
+    /**
+     * Sizes of the pages, shared with the pages
+     */
+    std::shared_ptr<PopplerGlibPageSizes> pageSizes;
 };
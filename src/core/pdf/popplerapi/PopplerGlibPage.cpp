@@ -1,6 +1,9 @@
 #include "PopplerGlibPage.h"
 
+#include <algorithm>
+#include <mutex>
 #include <sstream>
+#include <utility>
 
 #include <poppler-page.h>
 #include <poppler.h>
@@ -8,78 +11,234 @@
 #include "pdf/base/XojPdfPage.h"
 #include "util/GListView.h"
 #include "util/Rectangle.h"
+#include "util/Util.h"
 
 #include "cairo.h"
 
-PopplerGlibPage::PopplerGlibPage(PopplerPage* page): page(page) {
-    if (page != nullptr) {
-        g_object_ref(page);
-    }
+PopplerGlibPage::PopplerGlibPage(PopplerDocument* document, int index, std::shared_ptr<PopplerGlibPageSizes> sizes,
+                                 std::shared_ptr<PopplerGlibRenderHandles> renderHandles):
+        document(document), index(index), renderHandles(std::move(renderHandles)), sizes(std::move(sizes)) {
+    g_object_ref(this->document);
 }
 
-PopplerGlibPage::PopplerGlibPage(const PopplerGlibPage& other): page(other.page) {
-    if (page != nullptr) {
-        g_object_ref(page);
+PopplerGlibPage::PopplerGlibPage(const PopplerGlibPage& other):
+        document(other.document), index(other.index), renderHandles(other.renderHandles), sizes(other.sizes) {
+    g_object_ref(this->document);
+    if (PopplerPage* otherPage = other.page.load()) {
+        this->page = static_cast<PopplerPage*>(g_object_ref(otherPage));
     }
 }
 
 PopplerGlibPage::~PopplerGlibPage() {
-    if (page) {
-        g_object_unref(page);
-        page = nullptr;
+    if (PopplerPage* p = page.exchange(nullptr)) {
+        g_object_unref(p);
     }
+    g_object_unref(this->document);
 }
 
 PopplerGlibPage& PopplerGlibPage::operator=(const PopplerGlibPage& other) {
     if (&other == this) {
         return *this;
     }
-    if (page) {
-        g_object_unref(page);
-        page = nullptr;
+    if (PopplerPage* p = page.exchange(nullptr)) {
+        g_object_unref(p);
     }
-
-    page = other.page;
-    if (page != nullptr) {
-        g_object_ref(page);
+    g_object_ref(other.document);
+    g_object_unref(this->document);
+
+    this->document = other.document;
+    this->index = other.index;
+    this->sizes = other.sizes;
+    this->renderHandles = other.renderHandles;
+    if (PopplerPage* otherPage = other.page.load()) {
+        this->page = static_cast<PopplerPage*>(g_object_ref(otherPage));
     }
     return *this;
 }
 
-auto PopplerGlibPage::getWidth() const -> double {
-    double width = 0;
-    poppler_page_get_size(page, &width, nullptr);
+auto PopplerGlibPage::getPopplerPage() const -> PopplerPage* {
+    PopplerPage* current = this->page.load(std::memory_order_acquire);
+    if (current) {
+        return current;
+    }
 
-    return width;
+    PopplerPage* opened = poppler_document_get_page(this->document, this->index);
+    if (this->page.compare_exchange_strong(current, opened, std::memory_order_acq_rel)) {
+        return opened;
+    }
+    // Opened by another thread meanwhile
+    if (opened) {
+        g_object_unref(opened);
+    }
+    return current;
 }
 
-auto PopplerGlibPage::getHeight() const -> double {
-    double height = 0;
-    poppler_page_get_size(page, nullptr, &height);
+auto PopplerGlibPage::getWidth() const -> double { return this->sizes->get(this->index).first; }
+
+auto PopplerGlibPage::getHeight() const -> double { return this->sizes->get(this->index).second; }
+
+/**
+ * Poppler does not guarantee that pages of the same document can be rendered concurrently.
+ * Only used if no separate document handle is available.
+ */
+static std::mutex popplerRenderMutex;
 
-    return height;
+template <class Func>
+void PopplerGlibPage::withConcurrentPage(Func f) const {
+    PopplerDocument* handle = renderHandles ? renderHandles->acquire() : nullptr;
+    PopplerPage* handlePage = handle ? poppler_document_get_page(handle, this->index) : nullptr;
+
+    if (handlePage) {
+        f(handle, handlePage);
+        g_object_unref(handlePage);
+    } else {
+        std::lock_guard lock(popplerRenderMutex);
+        f(this->document, getPopplerPage());
+    }
+
+    if (handle) {
+        renderHandles->release(handle);
+    }
 }
 
-void PopplerGlibPage::render(cairo_t* cr) const { poppler_page_render(page, cr); }
+template <class RenderFunc>
+void PopplerGlibPage::renderConcurrently(cairo_t* cr, RenderFunc render) const {
+    withConcurrentPage([&](PopplerDocument*, PopplerPage* page) { render(page, cr); });
+}
 
-void PopplerGlibPage::renderForPrinting(cairo_t* cr) const { poppler_page_render_for_printing(page, cr); }
+void PopplerGlibPage::render(cairo_t* cr) const { renderConcurrently(cr, poppler_page_render); }
 
-auto PopplerGlibPage::getPageId() const -> int { return poppler_page_get_index(page); }
+void PopplerGlibPage::renderForPrinting(cairo_t* cr) const { renderConcurrently(cr, poppler_page_render_for_printing); }
+
+auto PopplerGlibPage::getPageId() const -> int { return this->index; }
 
 auto PopplerGlibPage::findText(std::string& text) -> std::vector<XojPdfRectangle> {
     std::vector<XojPdfRectangle> findings;
 
     double height = getHeight();
-    GList* matches = poppler_page_find_text(page, text.c_str());
-    for (auto& rect: GListView<PopplerRectangle>(matches)) {
-        findings.emplace_back(rect.x1, height - rect.y1, rect.x2, height - rect.y2);
-        poppler_rectangle_free(&rect);
-    }
-    g_list_free(matches);
+    // Also called by the SearchJob
+    renderConcurrently(nullptr, [&](PopplerPage* page, cairo_t*) {
+        GList* matches = poppler_page_find_text(page, text.c_str());
+        for (auto& rect: GListView<PopplerRectangle>(matches)) {
+            findings.emplace_back(rect.x1, height - rect.y1, rect.x2, height - rect.y2);
+            poppler_rectangle_free(&rect);
+        }
+        g_list_free(matches);
+    });
 
     return findings;
 }
 
+auto PopplerGlibPage::getText() const -> std::string {
+    std::string text;
+    // Extracting the text lays the page out, like rendering it
+    renderConcurrently(nullptr, [&text](PopplerPage* page, cairo_t*) {
+        gchar* pageText = poppler_page_get_text(page);
+        if (pageText) {
+            text = pageText;
+            g_free(pageText);
+        }
+    });
+    return text;
+}
+
+auto PopplerGlibPage::getTextLayout() const -> TextLayout {
+    TextLayout layout;
+    renderConcurrently(nullptr, [&layout](PopplerPage* page, cairo_t*) {
+        gchar* pageText = poppler_page_get_text(page);
+        if (pageText) {
+            layout.text = pageText;
+            g_free(pageText);
+        }
+
+        PopplerRectangle* rectArray = nullptr;
+        guint numRects = 0;
+        if (poppler_page_get_text_layout(page, &rectArray, &numRects)) {
+            layout.charBoxes.reserve(numRects);
+            for (guint i = 0; i < numRects; i++) {
+                layout.charBoxes.emplace_back(rectArray[i].x1, rectArray[i].y1, rectArray[i].x2, rectArray[i].y2);
+            }
+            g_free(rectArray);
+        }
+    });
+    return layout;
+}
+
+/**
+ * Sets the page and the top of the destination of the link, following the named destinations
+ */
+static void setLinkDestination(PopplerDocument* document, PopplerDest* dest, XojPdfPage::Link& link) {
+    if (dest->type == POPPLER_DEST_NAMED) {
+        if (PopplerDest* named = poppler_document_find_dest(document, dest->named_dest)) {
+            setLinkDestination(document, named, link);
+            poppler_dest_free(named);
+        }
+        return;
+    }
+    if (dest->page_num < 1) {
+        return;
+    }
+
+    link.destPage = static_cast<size_t>(dest->page_num - 1);
+    if (dest->type == POPPLER_DEST_XYZ && dest->change_top) {
+        if (PopplerPage* page = poppler_document_get_page(document, dest->page_num - 1)) {
+            double width = 0;
+            double height = 0;
+            poppler_page_get_size(page, &width, &height);
+            link.destTop = std::clamp(height - dest->top, 0.0, height);
+            g_object_unref(page);
+        }
+    }
+}
+
+auto PopplerGlibPage::getLinks() const -> std::vector<Link> {
+    std::vector<Link> links;
+
+    // The areas have their origin in the bottom left corner
+    double height = getHeight();
+    auto toRectangle = [height](const PopplerRectangle& area) {
+        return XojPdfRectangle(area.x1, height - area.y2, area.x2, height - area.y1);
+    };
+
+    withConcurrentPage([&](PopplerDocument* document, PopplerPage* page) {
+        GList* linkMapping = poppler_page_get_link_mapping(page);
+        for (auto& mapping: GListView<PopplerLinkMapping>(linkMapping)) {
+            Link link;
+            link.rect = toRectangle(mapping.area);
+            PopplerAction* action = mapping.action;
+            if (action->type == POPPLER_ACTION_GOTO_DEST && action->goto_dest.dest) {
+                setLinkDestination(document, action->goto_dest.dest, link);
+            } else if (action->type == POPPLER_ACTION_URI && action->uri.uri) {
+                link.text = action->uri.uri;
+            }
+            // Every other action is not supported in Xournal
+            if (link.destPage != npos || !link.text.empty()) {
+                links.push_back(std::move(link));
+            }
+        }
+        poppler_page_free_link_mapping(linkMapping);
+
+        GList* annotMapping = poppler_page_get_annot_mapping(page);
+        for (auto& mapping: GListView<PopplerAnnotMapping>(annotMapping)) {
+            if (poppler_annot_get_annot_type(mapping.annot) == POPPLER_ANNOT_LINK) {
+                continue;
+            }
+            gchar* contents = poppler_annot_get_contents(mapping.annot);
+            if (contents && *contents) {
+                Link annotation;
+                annotation.rect = toRectangle(mapping.area);
+                annotation.text = contents;
+                annotation.annotation = true;
+                links.push_back(std::move(annotation));
+            }
+            g_free(contents);
+        }
+        poppler_page_free_annot_mapping(annotMapping);
+    });
+
+    return links;
+}
+
 auto getPopplerSelectionStyle(XojPdfPageSelectionStyle style) -> PopplerSelectionStyle {
     switch (style) {
         case XojPdfPageSelectionStyle::Word:
@@ -95,12 +254,13 @@ auto getPopplerSelectionStyle(XojPdfPageSelectionStyle style) -> PopplerSelectio
 }
 
 auto PopplerGlibPage::selectText(const XojPdfRectangle& rect, XojPdfPageSelectionStyle style) -> std::string {
+    PopplerPage* page = getPopplerPage();
     PopplerRectangle pRect = {rect.x1, rect.y1, rect.x2, rect.y2};
     const auto pStyle = getPopplerSelectionStyle(style);
     if (style == XojPdfPageSelectionStyle::Area) {
         PopplerRectangle* rectArray = nullptr;
         guint numRects = 0;
-        if (!poppler_page_get_text_layout_for_area(this->page, &pRect, &rectArray, &numRects)) {
+        if (!poppler_page_get_text_layout_for_area(page, &pRect, &rectArray, &numRects)) {
             return "";
         }
         char* textBytes = poppler_page_get_text_for_area(page, &pRect);
@@ -148,6 +308,7 @@ auto PopplerGlibPage::selectText(const XojPdfRectangle& rect, XojPdfPageSelectio
 }
 
 auto PopplerGlibPage::selectTextRegion(const XojPdfRectangle& rect, XojPdfPageSelectionStyle style) -> cairo_region_t* {
+    PopplerPage* page = getPopplerPage();
     PopplerRectangle pRect = {rect.x1, rect.y1, rect.x2, rect.y2};
     const auto pStyle = getPopplerSelectionStyle(style);
     // The computed region is technically wrong for
@@ -165,6 +326,7 @@ cairo_rectangle_int_t cairoRectFromDouble(double x1, double y1, double width, do
 
 auto PopplerGlibPage::selectTextLines(const XojPdfRectangle& selectRect, XojPdfPageSelectionStyle style)
         -> TextSelection {
+    PopplerPage* page = getPopplerPage();
     std::vector<XojPdfRectangle> textRects;
 
     // The selection rectangle may be "improper" by having x2 <= x1 or y1 <= y2 (e.g., if user
@@ -178,11 +340,11 @@ auto PopplerGlibPage::selectTextLines(const XojPdfRectangle& selectRect, XojPdfP
     if (style == XojPdfPageSelectionStyle::Area) {
         // We always want to select in the "proper" rectangle.
         PopplerRectangle area{rect.x1, rect.y1, rect.x2, rect.y2};
-        if (!poppler_page_get_text_layout_for_area(this->page, &area, &rectArray, &numRects)) {
+        if (!poppler_page_get_text_layout_for_area(page, &area, &rectArray, &numRects)) {
             return {.region = cairo_region_create(), .rects = textRects};
         }
     } else {
-        if (!poppler_page_get_text_layout(this->page, &rectArray, &numRects)) {
+        if (!poppler_page_get_text_layout(page, &rectArray, &numRects)) {
             return {.region = cairo_region_create(), .rects = textRects};
         }
     }
@@ -11,14 +11,27 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+
 #include <poppler.h>
 
 #include "pdf/base/XojPdfPage.h"
 
+#include "PopplerGlibPageSizes.h"
+#include "PopplerGlibRenderHandles.h"
+
 
+/**
+ * @brief A page of a PopplerGlibDocument
+ *
+ * The Poppler page is only opened once it is rendered or its text is used: its size comes from the table of the
+ * document. Creating the pages of a large document is thus cheap.
+ */
 class PopplerGlibPage: public XojPdfPage {
 public:
-    PopplerGlibPage(PopplerPage* page);
+    PopplerGlibPage(PopplerDocument* document, int index, std::shared_ptr<PopplerGlibPageSizes> sizes,
+                    std::shared_ptr<PopplerGlibRenderHandles> renderHandles = nullptr);
     PopplerGlibPage(const PopplerGlibPage& other);
     virtual ~PopplerGlibPage();
     PopplerGlibPage& operator=(const PopplerGlibPage& other);
@@ -32,6 +45,12 @@ public:
 
     std::vector<XojPdfRectangle> findText(std::string& text) override;
 
+    std::string getText() const override;
+
+    TextLayout getTextLayout() const override;
+
+    std::vector<Link> getLinks() const override;
+
     std::string selectText(const XojPdfRectangle& rect, XojPdfPageSelectionStyle style) override;
 
     cairo_region_t* selectTextRegion(const XojPdfRectangle& rect, XojPdfPageSelectionStyle style) override;
@@ -42,5 +61,29 @@ public:
     int getPageId() const override;
 
 private:
-    PopplerPage* page;
+    /**
+     * Renders the page with a document handle which is not used by any other thread
+     */
+    template <class RenderFunc>
+    void renderConcurrently(cairo_t* cr, RenderFunc render) const;
+
+    /**
+     * Calls f(document, page) with a document handle which is not used by any other thread, see renderConcurrently()
+     */
+    template <class Func>
+    void withConcurrentPage(Func f) const;
+
+    /**
+     * @return The Poppler page, opened on the first call. Thread safe.
+     */
+    PopplerPage* getPopplerPage() const;
+
+private:
+    PopplerDocument* document;
+    int index;
+    mutable std::atomic<PopplerPage*> page{nullptr};
+
+    /// May own the data of the document: destroyed after the sizes, which reference the document
+    std::shared_ptr<PopplerGlibRenderHandles> renderHandles;
+    std::shared_ptr<PopplerGlibPageSizes> sizes;
 };
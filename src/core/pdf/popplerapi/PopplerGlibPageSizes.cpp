@@ -0,0 +1,25 @@
+#include "PopplerGlibPageSizes.h"
+
+PopplerGlibPageSizes::PopplerGlibPageSizes(PopplerDocument* document):
+        document(document), sizes(static_cast<size_t>(poppler_document_get_n_pages(document)), {-1, -1}) {
+    g_object_ref(this->document);
+}
+
+PopplerGlibPageSizes::~PopplerGlibPageSizes() { g_object_unref(this->document); }
+
+auto PopplerGlibPageSizes::get(int page) -> std::pair<double, double> {
+    std::lock_guard lock(this->sizesMutex);
+    if (page < 0 || static_cast<size_t>(page) >= this->sizes.size()) {
+        return {0, 0};
+    }
+
+    auto& size = this->sizes[static_cast<size_t>(page)];
+    if (size.first < 0) {
+        size = {0, 0};
+        if (PopplerPage* popplerPage = poppler_document_get_page(this->document, page)) {
+            poppler_page_get_size(popplerPage, &size.first, &size.second);
+            g_object_unref(popplerPage);
+        }
+    }
+    return size;
+}
@@ -0,0 +1,47 @@
+/*
+ * Xournal++
+ *
+ * The sizes of the pages of a PDF document
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <poppler.h>
+
+/**
+ * @brief Table of the page sizes of a document, shared by its pages
+ *
+ * The Xournal++ pages need the size of their PDF page long before it is rendered. The size of each page is read once,
+ * without keeping its Poppler page open, so that a PopplerGlibPage only opens the Poppler page when it renders,
+ * searches or selects.
+ */
+class PopplerGlibPageSizes {
+public:
+    explicit PopplerGlibPageSizes(PopplerDocument* document);
+    ~PopplerGlibPageSizes();
+
+    PopplerGlibPageSizes(const PopplerGlibPageSizes&) = delete;
+    PopplerGlibPageSizes& operator=(const PopplerGlibPageSizes&) = delete;
+
+public:
+    /**
+     * @return The width and the height of the page, read from Poppler the first time. Thread safe.
+     */
+    std::pair<double, double> get(int page);
+
+private:
+    PopplerDocument* document;
+
+    std::mutex sizesMutex;
+    /// Negative for the pages whose size was not read yet
+    std::vector<std::pair<double, double>> sizes;
+};
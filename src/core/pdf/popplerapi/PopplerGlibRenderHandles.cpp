@@ -0,0 +1,55 @@
+#include "PopplerGlibRenderHandles.h"
+
+#include <utility>
+
+PopplerGlibRenderHandles::PopplerGlibRenderHandles(std::string uri, std::string password):
+        uri(std::move(uri)), password(std::move(password)) {}
+
+PopplerGlibRenderHandles::PopplerGlibRenderHandles(GBytes* data, std::string password):
+        data(g_bytes_ref(data)), password(std::move(password)) {}
+
+PopplerGlibRenderHandles::~PopplerGlibRenderHandles() {
+    for (PopplerDocument* doc: this->idleHandles) { g_object_unref(doc); }
+    this->idleHandles.clear();
+    if (this->data) {
+        g_bytes_unref(this->data);
+    }
+}
+
+auto PopplerGlibRenderHandles::open() -> PopplerDocument* {
+    GError* error = nullptr;
+    PopplerDocument* doc = nullptr;
+    if (!this->data) {
+        doc = poppler_document_new_from_file(this->uri.c_str(), this->password.c_str(), &error);
+    } else {
+        gsize length = 0;
+        const auto* bytes = static_cast<const char*>(g_bytes_get_data(this->data, &length));
+        doc = poppler_document_new_from_data(const_cast<char*>(bytes), static_cast<int>(length),
+                                             this->password.c_str(), &error);
+    }
+
+    if (error) {
+        g_warning("Could not open an additional handle on the PDF document: %s", error->message);
+        g_error_free(error);
+    }
+    return doc;
+}
+
+auto PopplerGlibRenderHandles::acquire() -> PopplerDocument* {
+    {
+        std::lock_guard lock(this->handlesMutex);
+        if (!this->idleHandles.empty()) {
+            PopplerDocument* doc = this->idleHandles.back();
+            this->idleHandles.pop_back();
+            return doc;
+        }
+    }
+
+    // Parsing the document can take a while: do not block the other threads meanwhile
+    return open();
+}
+
+void PopplerGlibRenderHandles::release(PopplerDocument* doc) {
+    std::lock_guard lock(this->handlesMutex);
+    this->idleHandles.push_back(doc);
+}
@@ -0,0 +1,60 @@
+/*
+ * Xournal++
+ *
+ * Poppler GLib Implementation
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <poppler.h>
+
+/**
+ * @brief Additional handles on a PDF document, used for rendering its pages
+ *
+ * Poppler does not support rendering the pages of a single PopplerDocument from several threads at once. Each
+ * rendering thus borrows a handle that nobody else is using, and a new one is opened if all of them are busy.
+ * The number of handles stays bounded by the number of threads rendering at the same time.
+ */
+class PopplerGlibRenderHandles {
+public:
+    PopplerGlibRenderHandles(std::string uri, std::string password);
+    /**
+     * @param data The content of the document, referenced by the handles
+     */
+    PopplerGlibRenderHandles(GBytes* data, std::string password);
+    ~PopplerGlibRenderHandles();
+
+    PopplerGlibRenderHandles(const PopplerGlibRenderHandles&) = delete;
+    PopplerGlibRenderHandles& operator=(const PopplerGlibRenderHandles&) = delete;
+
+public:
+    /**
+     * @return A document handle used by no other thread, or nullptr if the document could not be opened again.
+     *         It has to be given back with release().
+     */
+    PopplerDocument* acquire();
+
+    void release(PopplerDocument* doc);
+
+private:
+    PopplerDocument* open();
+
+private:
+    std::mutex handlesMutex;
+    std::vector<PopplerDocument*> idleHandles;
+
+    std::string uri;
+    /// The document data, if it was loaded from memory (Poppler does not copy it). Also used by the main handle.
+    GBytes* data = nullptr;
+    std::string password;
+};
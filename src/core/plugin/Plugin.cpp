@@ -1,8 +1,16 @@
 #include "Plugin.h"
 #ifdef ENABLE_PLUGINS
 
+#include <algorithm>
+#include <chrono>
 #include <utility>
 
+#include "control/Control.h"
+#include "control/jobs/Executor.h"
+#include "control/settings/Settings.h"
+#include "model/Document.h"
+#include "util/Profiler.h"
+#include "util/Util.h"
 #include "util/i18n.h"
 
 #include "config.h"
@@ -21,11 +29,26 @@ extern "C" {
  */
 constexpr std::array loadedlibs{luaL_Reg{"app", luaopen_app}};
 
+using Clock = std::chrono::steady_clock;
+
+static auto millisecondsSince(Clock::time_point start) -> double {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
 Plugin::Plugin(Control* control, std::string name, fs::path path):
         control(control), name(std::move(name)), path(std::move(path)) {
     loadIni();
 }
 
+Plugin::~Plugin() {
+    *this->alive = false;
+    if (this->asyncTasks) {
+        this->asyncTasks->cancel();
+        // Joined by the group
+        this->asyncTasks.reset();
+    }
+}
+
 auto Plugin::getPluginFromLua(lua_State* lua) -> Plugin* {
     lua_getfield(lua, LUA_REGISTRYINDEX, "Xournalpp_Plugin");
 
@@ -48,7 +71,7 @@ void Plugin::registerToolbar() {
     lua_getglobal(lua.get(), "initUi");
     if (lua_isfunction(lua.get(), -1) == 1) {
         if (callFunction("initUi")) {
-            g_message("Plugin \"%s\" UI initialized", name.c_str());
+            g_message("Plugin \"%s\" UI initialized in %.1f ms", name.c_str(), timings.initMs);
         } else {
             g_warning("Plugin \"%s\" init failed!", name.c_str());
         }
@@ -114,6 +137,8 @@ auto Plugin::registerMenu(std::string menu, std::string callback, std::string ac
 
 auto Plugin::getControl() const -> Control* { return control; }
 
+auto Plugin::getTimings() const -> PluginTimings const& { return timings; }
+
 void Plugin::loadIni() {
     GKeyFile* config = g_key_file_new();
     g_key_file_set_list_separator(config, ',');
@@ -161,33 +186,38 @@ void Plugin::registerXournalppLibs(lua_State* luaPtr) {
     }
 }
 
-void Plugin::addPluginToLuaPath() {
-    lua_getglobal(lua.get(), "package");
+void Plugin::addPluginToLuaPath(lua_State* lua, const fs::path& path) {
+    lua_getglobal(lua, "package");
 
     // get field "path" from table at top of stack (-1)
-    lua_getfield(lua.get(), -1, "path");
+    lua_getfield(lua, -1, "path");
 
     // grab path string from top of stack
-    std::string luaPath = lua_tostring(lua.get(), -1);
+    std::string luaPath = lua_tostring(lua, -1);
 
     // prepend the path of the current plugin
-    auto curPath = this->path / "?.lua";
+    auto curPath = path / "?.lua";
     std::string combinedPath = curPath.string() + ";" + luaPath;
 
     // get rid of the std::string on the stack we just pushed
-    lua_pop(lua.get(), 1);
+    lua_pop(lua, 1);
 
     // push the new one
-    lua_pushstring(lua.get(), combinedPath.c_str());
+    lua_pushstring(lua, combinedPath.c_str());
 
     // set the field "path" in table at -2 with value at top of stack
-    lua_setfield(lua.get(), -2, "path");
+    lua_setfield(lua, -2, "path");
 
     // get rid of package table from top of stack
-    lua_pop(lua.get(), 1);
+    lua_pop(lua, 1);
 }
 
 void Plugin::loadScript() {
+    compileScript();
+    runScript();
+}
+
+void Plugin::compileScript() {
     if (mainfile.empty()) {
         this->valid = false;
         return;
@@ -203,6 +233,7 @@ void Plugin::loadScript() {
         return;
     }
 
+    auto start = Clock::now();
 
     // Create Lua state variable
     lua.reset(luaL_newstate());
@@ -219,32 +250,62 @@ void Plugin::loadScript() {
         return;
     }
 
+    this->compiled = true;
+    timings.loadMs = millisecondsSince(start);
+}
+
+void Plugin::runScript() {
+    if (!this->compiled) {
+        return;
+    }
+    this->compiled = false;
+
+    xoj::util::Profiler::Scope scope("plugin: load", "plugin");
+    auto start = Clock::now();
+
     // Register Plugin object to Lua instance
     lua_pushlightuserdata(lua.get(), this);
     lua_setfield(lua.get(), LUA_REGISTRYINDEX, "Xournalpp_Plugin");
 
     registerXournalppLibs(lua.get());
 
-    addPluginToLuaPath();
+    addPluginToLuaPath(lua.get(), this->path);
 
     // Run the loaded Lua script
-    if (lua_pcall(lua.get(), 0, 0, 0) != LUA_OK) {
+    int status = callWithBudget();
+    timings.loadMs += millisecondsSince(start);
+    if (status != LUA_OK) {
         const char* errMsg = lua_tostring(lua.get(), -1);
         std::map<int, std::string> button;
         button.insert(std::pair<int, std::string>(0, _("OK")));
         XojMsgBox::showPluginMessage(name, errMsg, button, true);
 
-        g_warning("Could not run plugin Lua file: \"%s\", error: \"%s\"", luafile.string().c_str(), errMsg);
+        g_warning("Could not run plugin Lua file: \"%s\", error: \"%s\"", (path / mainfile).string().c_str(), errMsg);
         this->valid = false;
         return;
     }
 }
 
-auto Plugin::callFunction(const std::string& fnc) -> bool {
+auto Plugin::callFunction(const std::string& fnc, const std::vector<PluginValue>& args) -> bool {
+    xoj::util::Profiler::Scope scope(inInitUi ? "plugin: init ui" : "plugin: callback", "plugin");
+    auto start = Clock::now();
+
     lua_getglobal(lua.get(), fnc.c_str());
+    for (const PluginValue& arg: args) { arg.push(lua.get()); }
 
     // Run the function
-    if (lua_pcall(lua.get(), 0, 0, 0)) {
+    int status = callWithBudget(static_cast<int>(args.size()));
+
+    double ms = millisecondsSince(start);
+    if (inInitUi) {
+        timings.initMs += ms;
+    } else {
+        timings.callbacks++;
+        timings.callbackTotalMs += ms;
+        timings.callbackMaxMs = std::max(timings.callbackMaxMs, ms);
+    }
+
+    if (status != LUA_OK) {
         const char* errMsg = lua_tostring(lua.get(), -1);
         std::map<int, std::string> button;
         button.insert(std::pair<int, std::string>(0, _("OK")));
@@ -257,6 +318,137 @@ auto Plugin::callFunction(const std::string& fnc) -> bool {
     return true;
 }
 
+auto Plugin::callWithBudget(int nargs) -> int {
+    int budget = control->getSettings()->getPluginInstructionBudget();
+    if (budget > 0) {
+        // Coroutines created by the plugin inherit the hook
+        this->instructionsLeft = static_cast<int64_t>(budget) * 1000000;
+        lua_sethook(lua.get(), &Plugin::budgetHook, LUA_MASKCOUNT, BUDGET_CHECK_INTERVAL);
+    }
+
+    int status = lua_pcall(lua.get(), nargs, 0, 0);
+
+    lua_sethook(lua.get(), nullptr, 0, 0);
+    return status;
+}
+
+void Plugin::budgetHook(lua_State* lua, lua_Debug* ar) {
+    Plugin* plugin = getPluginFromLua(lua);
+    if (plugin == nullptr) {
+        return;
+    }
+
+    plugin->instructionsLeft -= BUDGET_CHECK_INTERVAL;
+    if (plugin->instructionsLeft <= 0) {
+        // The hook stays: if the plugin catches the error, the next check raises it again
+        int budget = plugin->control->getSettings()->getPluginInstructionBudget();
+        luaL_error(lua, "Aborted after %d million Lua instructions, see the setting pluginInstructionBudget", budget);
+    }
+}
+
+void Plugin::runAsync(std::string module, std::string function, std::string callback, PluginValue args,
+                      std::unique_ptr<Document> snapshot) {
+    if (!this->asyncTasks) {
+        // Not a Job: the Scheduler runs the other jobs only once all the rendering is done, and the reverse
+        this->asyncTasks = std::make_unique<TaskGroup>(JOB_PRIORITY_NONE);
+    }
+
+    // Copyable, for the std::function of the task
+    std::shared_ptr<Document> doc = std::move(snapshot);
+    TaskGroup* tasks = this->asyncTasks.get();
+    this->asyncTasks->fork([plugin = this, alive = this->alive, path = this->path, module = std::move(module),
+                            function = std::move(function), callback = std::move(callback), args = std::move(args),
+                            doc = std::move(doc), tasks]() {
+        auto start = Clock::now();
+        PluginValue result;
+        bool succeeded = runWorker(path, module, function, args, doc.get(), *tasks, result);
+        double ms = millisecondsSince(start);
+
+        Util::execInUiThread([plugin, alive, callback, succeeded, result = std::move(result), ms]() {
+            if (!*alive) {
+                return;
+            }
+            plugin->timings.asyncCalls++;
+            plugin->timings.asyncTotalMs += ms;
+
+            if (callback.empty()) {
+                if (!succeeded) {
+                    g_warning("Error in Plugin: \"%s\", error: \"%s\"", plugin->name.c_str(),
+                              result.getString().c_str());
+                }
+                return;
+            }
+            if (succeeded) {
+                plugin->callFunction(callback, {result, PluginValue()});
+            } else {
+                plugin->callFunction(callback, {PluginValue(), result});
+            }
+        });
+    });
+}
+
+auto Plugin::runWorker(const fs::path& path, const std::string& module, const std::string& function,
+                       const PluginValue& args, Document* snapshot, const TaskGroup& tasks, PluginValue& result)
+        -> bool {
+    xoj::util::Profiler::Scope scope("plugin: worker", "plugin");
+
+    std::unique_ptr<lua_State, LuaDeleter> worker(luaL_newstate());
+    lua_State* L = worker.get();
+    luaL_openlibs(L);
+    addPluginToLuaPath(L, path);
+
+    // No app library: it is only used on the UI thread
+    lua_pushlightuserdata(L, snapshot);
+    lua_setfield(L, LUA_REGISTRYINDEX, "Xournalpp_Snapshot");
+    luaL_requiref(L, "snapshot", luaopen_snapshot, 1);
+    lua_pop(L, 1);
+
+    // No instruction budget off the UI thread, only the cancellation
+    lua_pushlightuserdata(L, const_cast<TaskGroup*>(&tasks));
+    lua_setfield(L, LUA_REGISTRYINDEX, "Xournalpp_Tasks");
+    lua_sethook(L, &Plugin::cancelHook, LUA_MASKCOUNT, BUDGET_CHECK_INTERVAL);
+
+    lua_getglobal(L, "require");
+    lua_pushstring(L, module.c_str());
+    int status = lua_pcall(L, 1, 1, 0);
+    if (status == LUA_OK) {
+        if (!lua_istable(L, -1)) {
+            result = PluginValue(FS(_F("Module \"{1}\" is not a table") % module));
+            return false;
+        }
+        lua_getfield(L, -1, function.c_str());
+        if (!lua_isfunction(L, -1)) {
+            result = PluginValue(FS(_F("Module \"{1}\" has no function \"{2}\"") % module % function));
+            return false;
+        }
+        args.push(L);
+        status = lua_pcall(L, 1, 1, 0);
+    }
+
+    if (status != LUA_OK) {
+        const char* errMsg = lua_tostring(L, -1);
+        result = PluginValue(errMsg ? errMsg : "Unknown error");
+        return false;
+    }
+
+    std::string error;
+    if (!PluginValue::fromLua(L, -1, result, error)) {
+        result = PluginValue(FS(_F("Invalid result: {1}") % error));
+        return false;
+    }
+    return true;
+}
+
+void Plugin::cancelHook(lua_State* lua, lua_Debug* ar) {
+    lua_getfield(lua, LUA_REGISTRYINDEX, "Xournalpp_Tasks");
+    auto* tasks = static_cast<TaskGroup*>(lua_touserdata(lua, -1));
+    lua_pop(lua, 1);
+
+    if (tasks != nullptr && tasks->isCancelled()) {
+        luaL_error(lua, "Aborted, the plugin is unloaded");
+    }
+}
+
 auto Plugin::isValid() const -> bool { return valid; }
 
 #endif
@@ -15,6 +15,9 @@
 
 #ifdef ENABLE_PLUGINS
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -23,12 +26,16 @@
 
 #include "filesystem.h"
 
+#include "PluginValue.h"
+
 extern "C" {
 #include <lua.h>
 }
 
 class Plugin;
 class Control;
+class Document;
+class TaskGroup;
 
 struct MenuEntry final {
     MenuEntry() = default;
@@ -44,6 +51,19 @@ struct MenuEntry final {
     ///< https://developer.gnome.org/gtk3/stable/gtk3-Keyboard-Accelerators.html#gtk-accelerator-parse
 };
 
+/**
+ * Time spent in the Lua code of a plugin, on the UI thread except for the compilation of the script
+ */
+struct PluginTimings final {
+    double loadMs = 0;  ///< Compiling and running the main script
+    double initMs = 0;  ///< Running initUi
+    size_t callbacks = 0;
+    double callbackTotalMs = 0;
+    double callbackMaxMs = 0;
+    size_t asyncCalls = 0;  ///< Functions run on a worker, see app.runAsync()
+    double asyncTotalMs = 0;
+};
+
 struct LuaDeleter {
     void operator()(lua_State* ptr) const { lua_close(ptr); }
 };
@@ -52,10 +72,22 @@ class Plugin final {
 public:
     Plugin(Control* control, std::string name, fs::path path);
 
+    /// Cancels the functions running on a worker and waits for them, their callbacks are dropped
+    ~Plugin();
+
 public:
     /// Load the plugin script
     void loadScript();
 
+    /**
+     * First half of loadScript(): creates the Lua engine and compiles the script, without running it.
+     * Touches nothing outside of the plugin, so that the plugins can be compiled in parallel.
+     */
+    void compileScript();
+
+    /// Second half of loadScript(): runs the compiled script, on the UI thread
+    void runScript();
+
     /// Check if this plugin is valid
     auto isValid() const -> bool;
 
@@ -99,18 +131,50 @@ public:
     ///@return The main controller
     auto getControl() const -> Control*;
 
+    /// @return The time spent in the plugin so far
+    auto getTimings() const -> PluginTimings const&;
+
+    /**
+     * Runs module.function(args) on a worker, with a Lua engine of its own, then the callback with its result on the
+     * UI thread, see app.runAsync()
+     * @param snapshot Read by the function through the snapshot library, if not nullptr
+     */
+    void runAsync(std::string module, std::string function, std::string callback, PluginValue args,
+                  std::unique_ptr<Document> snapshot);
+
 private:
     /// Load ini file
     void loadIni();
 
     /// Execute lua function
-    auto callFunction(const std::string& fnc) -> bool;
+    auto callFunction(const std::string& fnc, const std::vector<PluginValue>& args = {}) -> bool;
+
+    /**
+     * Call the function on top of the stack, below its arguments, aborting it with an error once it exceeds the
+     * instruction budget of the settings
+     * @return The status of lua_pcall
+     */
+    auto callWithBudget(int nargs = 0) -> int;
+
+    /// Count hook of callWithBudget()
+    static void budgetHook(lua_State* lua, lua_Debug* ar);
+
+    /**
+     * Body of the workers of runAsync(), on a thread of the Executor
+     * @param result The result of the function, or the error message if it fails
+     * @return false on an error
+     */
+    static bool runWorker(const fs::path& path, const std::string& module, const std::string& function,
+                          const PluginValue& args, Document* snapshot, const TaskGroup& tasks, PluginValue& result);
+
+    /// Count hook of runWorker(), aborts the function once the plugin is unloaded
+    static void cancelHook(lua_State* lua, lua_Debug* ar);
 
     /// Load custom Lua Libraries
     static void registerXournalppLibs(lua_State* luaPtr);
 
     /// Add the plugin folder to the lua path
-    void addPluginToLuaPath();
+    static void addPluginToLuaPath(lua_State* lua, const fs::path& path);
 
 public:
     /// Get Plugin from lua engine
@@ -131,6 +195,16 @@ private:
     bool defaultEnabled = false;  ///< The plugin is default enabled
     bool inInitUi = false;        ///< Flag to check if init ui is currently running
     bool valid = false;           ///< Flag if the plugin is valid / correct loaded
+    bool compiled = false;        ///< The script is compiled and waits on the stack to be run
+
+    int64_t instructionsLeft = 0;  ///< Of the budget of the running call, if limited
+    PluginTimings timings;
+
+    std::unique_ptr<TaskGroup> asyncTasks;  ///< The workers of runAsync(), created by the first one
+    std::shared_ptr<bool> alive = std::make_shared<bool>(true);  ///< Checked by their callbacks, on the UI thread
+
+    /// Lua instructions between two checks of the budget
+    static constexpr int BUDGET_CHECK_INTERVAL = 10000;
 };
 
 #else
@@ -7,6 +7,7 @@
 #include "control/Control.h"
 #include "gui/GladeSearchpath.h"
 #include "gui/dialog/PluginDialog.h"
+#include "util/ParallelLoop.h"
 #include "util/StringUtils.h"
 
 #include "Plugin.h"
@@ -25,6 +26,7 @@ void PluginController::loadPluginsFrom(fs::path const& path) {
     std::vector<std::string> pluginEnabled = StringUtils::split(settings->getPluginEnabled(), ',');
     std::vector<std::string> pluginDisabled = StringUtils::split(settings->getPluginDisabled(), ',');
 
+    std::vector<std::unique_ptr<Plugin>> loaded;
     try {
         for (auto const& f: fs::directory_iterator(path)) {
             const auto& pluginPath = f.path();
@@ -42,14 +44,23 @@ void PluginController::loadPluginsFrom(fs::path const& path) {
                                    pluginEnabled.end());
             }
 
-            plugin->loadScript();
-
-            this->plugins.emplace_back(std::move(plugin));
+            loaded.emplace_back(std::move(plugin));
         }
     } catch (fs::filesystem_error const& e) {
         g_warning("Could not open plugin dir: \"%s\"", path.string().c_str());
         return;
     }
+
+    // Reading and compiling the scripts is independent of the rest of the application, unlike running them
+    xoj::util::ParallelLoop().run(loaded.size(), [&loaded](size_t i) { loaded[i]->compileScript(); });
+
+    for (auto& plugin: loaded) {
+        plugin->runScript();
+        if (plugin->isEnabled() && plugin->isValid()) {
+            g_message("Plugin \"%s\" loaded in %.1f ms", plugin->getName().c_str(), plugin->getTimings().loadMs);
+        }
+        this->plugins.emplace_back(std::move(plugin));
+    }
 #endif
 }
 
@@ -0,0 +1,98 @@
+#include "PluginValue.h"
+#ifdef ENABLE_PLUGINS
+
+extern "C" {
+#include <lauxlib.h>
+}
+
+PluginValue::PluginValue(std::string string): type(Type::STRING), string(std::move(string)) {}
+
+auto PluginValue::fromLua(lua_State* L, int index, PluginValue& value, std::string& error) -> bool {
+    return fromLua(L, lua_absindex(L, index), value, error, 0);
+}
+
+auto PluginValue::fromLua(lua_State* L, int index, PluginValue& value, std::string& error, int depth) -> bool {
+    value = PluginValue();
+    switch (lua_type(L, index)) {
+        case LUA_TNIL:
+            return true;
+        case LUA_TBOOLEAN:
+            value.type = Type::BOOLEAN;
+            value.boolean = lua_toboolean(L, index);
+            return true;
+        case LUA_TNUMBER:
+            if (lua_isinteger(L, index)) {
+                value.type = Type::INTEGER;
+                value.integer = lua_tointeger(L, index);
+            } else {
+                value.type = Type::NUMBER;
+                value.number = lua_tonumber(L, index);
+            }
+            return true;
+        case LUA_TSTRING: {
+            size_t length = 0;
+            const char* data = lua_tolstring(L, index, &length);
+            value.type = Type::STRING;
+            value.string.assign(data, length);
+            return true;
+        }
+        case LUA_TTABLE:
+            break;
+        default:
+            error = std::string("Cannot pass a ") + luaL_typename(L, index) + " to another Lua engine";
+            return false;
+    }
+
+    if (depth >= MAX_DEPTH || !lua_checkstack(L, 3)) {
+        error = "Cannot pass a table nested this deep (or a cycle) to another Lua engine";
+        return false;
+    }
+
+    value.type = Type::TABLE;
+    lua_pushnil(L);
+    while (lua_next(L, index) != 0) {
+        PluginValue key;
+        PluginValue item;
+        if (!fromLua(L, lua_absindex(L, -2), key, error, depth + 1) ||
+            !fromLua(L, lua_absindex(L, -1), item, error, depth + 1)) {
+            lua_pop(L, 2);
+            return false;
+        }
+        value.table.emplace_back(std::move(key), std::move(item));
+        lua_pop(L, 1);
+    }
+    return true;
+}
+
+void PluginValue::push(lua_State* L) const {
+    switch (this->type) {
+        case Type::NIL:
+            lua_pushnil(L);
+            break;
+        case Type::BOOLEAN:
+            lua_pushboolean(L, this->boolean);
+            break;
+        case Type::INTEGER:
+            lua_pushinteger(L, this->integer);
+            break;
+        case Type::NUMBER:
+            lua_pushnumber(L, this->number);
+            break;
+        case Type::STRING:
+            lua_pushlstring(L, this->string.data(), this->string.size());
+            break;
+        case Type::TABLE:
+            luaL_checkstack(L, 3, "Table nested too deep");
+            lua_createtable(L, 0, static_cast<int>(this->table.size()));
+            for (const auto& [key, item]: this->table) {
+                key.push(L);
+                item.push(L);
+                lua_rawset(L, -3);
+            }
+            break;
+    }
+}
+
+auto PluginValue::getString() const -> const std::string& { return this->string; }
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Xournal++
+ *
+ * A Lua value copied between the Lua engines of a plugin
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "config-features.h"
+
+#ifdef ENABLE_PLUGINS
+
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <lua.h>
+}
+
+/**
+ * @brief A Lua value out of any lua_State: nil, a boolean, a number, a string or a table of them
+ *
+ * The arguments and the result of the functions run by app.runAsync() are copied through it, from the Lua engine of
+ * the plugin to the one of the worker and back. A lua_State is only used by one thread at a time.
+ */
+class PluginValue final {
+public:
+    PluginValue() = default;
+    explicit PluginValue(std::string string);
+
+    /**
+     * Copies the value at the index of the stack. Tables are copied deeply, their metatables are dropped.
+     * @return false for a function, a userdata, a coroutine, or a table nested deeper than MAX_DEPTH (e.g. a cycle),
+     *         with the error
+     */
+    static bool fromLua(lua_State* L, int index, PluginValue& value, std::string& error);
+
+    /**
+     * Pushes a copy of the value
+     */
+    void push(lua_State* L) const;
+
+    /**
+     * @return The string, empty if the value is not one
+     */
+    const std::string& getString() const;
+
+    static constexpr int MAX_DEPTH = 64;
+
+private:
+    static bool fromLua(lua_State* L, int index, PluginValue& value, std::string& error, int depth);
+
+private:
+    enum class Type { NIL, BOOLEAN, INTEGER, NUMBER, STRING, TABLE };
+
+    Type type = Type::NIL;
+    bool boolean = false;
+    lua_Integer integer = 0;
+    lua_Number number = 0;
+    std::string string;
+    std::vector<std::pair<PluginValue, PluginValue>> table;
+};
+
+#endif
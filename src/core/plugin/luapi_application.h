@@ -10,8 +10,14 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <cstring>
+#include <limits>
 #include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include <gtk/gtk.h>
 #include <stdint.h>
@@ -19,20 +25,28 @@
 #include "control/Control.h"
 #include "control/ExportHelper.h"
 #include "control/PageBackgroundChangeController.h"
+#include "control/MemoryReport.h"
 #include "control/Tool.h"
 #include "control/layer/LayerController.h"
 #include "control/pagetype/PageTypeHandler.h"
+#include "control/tools/EditSelection.h"
 #include "gui/XournalView.h"
 #include "gui/widgets/XournalWidget.h"
 #include "model/Font.h"
 #include "model/SplineSegment.h"
+#include "model/Stroke.h"
 #include "model/StrokeStyle.h"
 #include "model/Text.h"
+#include "undo/GroupUndoAction.h"
 #include "undo/InsertUndoAction.h"
+#include "undo/MoveUndoAction.h"
+#include "undo/ScaleUndoAction.h"
 #include "util/StringUtils.h"
 #include "util/XojMsgBox.h"
 #include "util/safe_casts.h"
 
+#include "PluginValue.h"
+
 /**
  * Renames file 'from' to file 'to' in the file system.
  * Overwrites 'to' if it already exists.
@@ -381,15 +395,47 @@ static int applib_layerAction(lua_State* L) {
     return 1;
 }
 
+/*
+ * The packed points of app.getStrokes and app.addStrokes are a copy of the point vector of the stroke: three native
+ * doubles x, y and pressure per point, the pressure being -1 without pressure. In Lua, they are read with
+ * string.unpack("ddd", points, 1 + 24 * i) and written with string.pack("ddd", x, y, pressure).
+ */
+static_assert(sizeof(Point) == 3 * sizeof(double) && std::is_trivially_copyable_v<Point>,
+              "The packed points are copied from and to the point vectors");
+
+static void pushPackedPoints(lua_State* L, const Stroke* stroke) {
+    const std::vector<Point>& points = stroke->getPointVector();
+    lua_pushlstring(L, reinterpret_cast<const char*>(points.data()), points.size() * sizeof(Point));
+}
+
+/**
+ * Checks the packed points at the given index of the stack, before copying them with copyPackedPoints()
+ * @return The number of points
+ */
+static size_t checkPackedPoints(lua_State* L, int index) {
+    size_t length = 0;
+    lua_tolstring(L, index, &length);
+    if (length % sizeof(Point) != 0) {
+        luaL_error(L, "Packed points must be three doubles per point!");
+    }
+    return length / sizeof(Point);
+}
+
+static std::vector<Point> copyPackedPoints(lua_State* L, int index) {
+    size_t length = 0;
+    const char* data = lua_tolstring(L, index, &length);
+    std::vector<Point> points(length / sizeof(Point));
+    std::memcpy(points.data(), data, points.size() * sizeof(Point));
+    return points;
+}
+
 /**
  * Helper function for addStroke API. Parses pen settings from API call, taking
- * in a Stroke and a chosen Layer, sets the pen settings, and applies the stroke.
+ * in a Stroke, and sets the pen settings. The caller adds the stroke to the layer.
  */
 static void addStrokeHelper(lua_State* L, Stroke* stroke) {
     Plugin* plugin = Plugin::getPluginFromLua(L);
     Control* ctrl = plugin->getControl();
-    PageRef const& page = ctrl->getCurrentPage();
-    Layer* layer = page->getSelectedLayer();
 
     std::string size;
     double thickness;
@@ -471,10 +517,6 @@ static void addStrokeHelper(lua_State* L, Stroke* stroke) {
         stroke->setLineStyle(StrokeStyle::parseStyle(lineStyle.data()));
 
     lua_pop(L, 5);  // Finally done with all that Lua data.
-
-    // Add the stroke
-    layer->addElement(stroke);
-    return;
 }
 
 /**
@@ -546,9 +588,9 @@ static int applib_addSplines(lua_State* L) {
         if (!lua_istable(L, -1))
             luaL_error(L, "Missing coordinate table!");
         size_t numCoords = lua_rawlen(L, -1);
+        coordStream.reserve(numCoords);
         for (size_t b = 1; b <= numCoords; b++) {
-            lua_pushnumber(L, b);
-            lua_gettable(L, -2);
+            lua_rawgeti(L, -1, static_cast<lua_Integer>(b));
             double point = lua_tonumber(L, -1);
             coordStream.push_back(point);  // Each segment is going to have multiples of 8 points.
             lua_pop(L, 1);
@@ -587,6 +629,9 @@ static int applib_addSplines(lua_State* L) {
 
     lua_pop(L, 1);  // Stack is now the same as it was on entry to this function
 
+    // Add the strokes to the layer at once
+    ctrl->getCurrentPage()->getSelectedLayer()->addElements(strokes);
+
     // Check how the user wants to handle undoing
     lua_getfield(L, 1, "allowUndoRedoAction");
     allowUndoRedoAction = luaL_optstring(L, -1, "grouped");
@@ -624,6 +669,12 @@ static int applib_addSplines(lua_State* L) {
  * The function checks for consistency among table lengths, and throws an
  * error if there is a discrepancy
  *
+ * Instead of the X, Y and pressure tables, a stroke can give its points packed in a string, as returned by
+ * app.getStrokes: ["points"] = string.pack("dddddd", x1, y1, pressure1, x2, y2, pressure2). Packed points are copied
+ * at once, without reading a Lua table per coordinate.
+ *
+ * All the strokes are added with a single undo action by default. Call app.refreshPage() once after adding them.
+ *
  * Example:
  *
  * app.addStrokes({
@@ -684,17 +735,36 @@ static int applib_addStrokes(lua_State* L) {
         std::vector<double> pressureStream;
         Stroke* stroke = new Stroke();
 
-        // Fetch table of X values from the Lua stack
         lua_pushnumber(L, a);
         lua_gettable(L, -2);
 
+        // Packed points, copied at once
+        lua_getfield(L, -1, "points");
+        if (lua_type(L, -1) == LUA_TSTRING) {
+            if (checkPackedPoints(L, -1) < 2) {
+                delete stroke;
+                g_warning("Stroke shorter than two points. Discarding. (Has %zu/2)", checkPackedPoints(L, -1));
+                lua_pop(L, 2);
+                continue;
+            }
+            stroke->setPointVector(copyPackedPoints(L, -1));
+            lua_pop(L, 1);
+
+            addStrokeHelper(L, stroke);
+            strokes.push_back(stroke);
+            lua_pop(L, 1);
+            continue;
+        }
+        lua_pop(L, 1);
+
+        // Fetch table of X values from the Lua stack
         lua_getfield(L, -1, "x");
         if (!lua_istable(L, -1))
             luaL_error(L, "Missing X-Coordinate table!");
         size_t xPoints = lua_rawlen(L, -1);
+        xStream.reserve(xPoints);
         for (size_t b = 1; b <= xPoints; b++) {
-            lua_pushnumber(L, b);
-            lua_gettable(L, -2);
+            lua_rawgeti(L, -1, static_cast<lua_Integer>(b));
             double value = lua_tonumber(L, -1);
             xStream.push_back(value);
             lua_pop(L, 1);
@@ -706,9 +776,9 @@ static int applib_addStrokes(lua_State* L) {
         if (!lua_istable(L, -1))
             luaL_error(L, "Missing Y-Coordinate table!");
         size_t yPoints = lua_rawlen(L, -1);
+        yStream.reserve(yPoints);
         for (size_t b = 1; b <= yPoints; b++) {
-            lua_pushnumber(L, b);
-            lua_gettable(L, -2);
+            lua_rawgeti(L, -1, static_cast<lua_Integer>(b));
             double value = lua_tonumber(L, -1);
             yStream.push_back(value);
             lua_pop(L, 1);
@@ -719,9 +789,9 @@ static int applib_addStrokes(lua_State* L) {
         lua_getfield(L, -1, "pressure");
         if (lua_istable(L, -1)) {
             size_t pressurePoints = lua_rawlen(L, -1);
+            pressureStream.reserve(pressurePoints);
             for (size_t b = 1; b <= pressurePoints; b++) {
-                lua_pushnumber(L, b);
-                lua_gettable(L, -2);
+                lua_rawgeti(L, -1, static_cast<lua_Integer>(b));
                 double value = lua_tonumber(L, -1);
                 pressureStream.push_back(value);
                 lua_pop(L, 1);
@@ -742,6 +812,7 @@ static int applib_addStrokes(lua_State* L) {
         // Check and make sure there's enough points (need at least 2)
         if (xStream.size() < 2) {
             g_warning("Stroke shorter than two points. Discarding. (Has %ld/2)", xStream.size());
+            ctrl->getCurrentPage()->getSelectedLayer()->addElements(strokes);
             return 1;
         }
         // Add points to the stroke. Include pressure, if it exists.
@@ -764,6 +835,9 @@ static int applib_addStrokes(lua_State* L) {
         lua_pop(L, 1);
     }
 
+    // Add the strokes to the layer at once
+    ctrl->getCurrentPage()->getSelectedLayer()->addElements(strokes);
+
     // Check how the user wants to handle undoing
     lua_getfield(L, 1, "allowUndoRedoAction");
     allowUndoRedoAction = luaL_optstring(L, -1, "grouped");
@@ -787,6 +861,193 @@ static int applib_addStrokes(lua_State* L) {
     return 0;
 }
 
+/**
+ * Pushes the strokes of the layer in the format of app.getStrokes
+ */
+static void pushStrokes(lua_State* L, Layer* layer) {
+    const std::vector<Element*>& elements = layer->getElements();
+    lua_createtable(L, static_cast<int>(elements.size()), 0);
+    lua_Integer i = 0;
+    for (Element* e: elements) {
+        if (e->getType() != ELEMENT_STROKE) {
+            continue;
+        }
+        auto* stroke = static_cast<Stroke*>(e);
+
+        lua_createtable(L, 0, 7);
+
+        pushPackedPoints(L, stroke);
+        lua_setfield(L, -2, "points");
+
+        lua_pushinteger(L, stroke->getPointCount());
+        lua_setfield(L, -2, "pointCount");
+
+        switch (stroke->getToolType()) {
+            case STROKE_TOOL_HIGHLIGHTER:
+                lua_pushliteral(L, "highlighter");
+                break;
+            case STROKE_TOOL_ERASER:
+                lua_pushliteral(L, "eraser");
+                break;
+            default:
+                lua_pushliteral(L, "pen");
+                break;
+        }
+        lua_setfield(L, -2, "tool");
+
+        lua_pushnumber(L, stroke->getWidth());
+        lua_setfield(L, -2, "width");
+
+        lua_pushinteger(L, int(uint32_t(stroke->getColor())));
+        lua_setfield(L, -2, "color");
+
+        lua_pushinteger(L, stroke->getFill());
+        lua_setfield(L, -2, "fill");
+
+        lua_pushstring(L, StrokeStyle::formatStyle(stroke->getLineStyle()).c_str());
+        lua_setfield(L, -2, "lineStyle");
+
+        lua_rawseti(L, -2, ++i);
+    }
+}
+
+/**
+ * Returns the strokes of a layer, with their points packed in a string (see app.addStrokes). The other elements of the
+ * layer are skipped. Without arguments, returns the strokes of the current layer of the current page.
+ *
+ * Optional Arguments: page, layer (both starting at 1)
+ *
+ * Example: local strokes = app.getStrokes({["page"] = 2, ["layer"] = 1})
+ * returns
+ * {
+ *   {
+ *     ["points"] = string,  -- x, y and pressure of each point, local x, y, pressure = string.unpack("ddd", points, 1)
+ *     ["pointCount"] = integer,
+ *     ["tool"] = "pen", "highlighter" or "eraser",
+ *     ["width"] = number,
+ *     ["color"] = integer RGB hex code,
+ *     ["fill"] = integer (-1 if not filled),
+ *     ["lineStyle"] = string,
+ *   },
+ *   ...
+ * }
+ */
+static int applib_getStrokes(lua_State* L) {
+    Plugin* plugin = Plugin::getPluginFromLua(L);
+    Control* control = plugin->getControl();
+    Document* doc = control->getDocument();
+
+    // Discard any extra arguments passed in
+    lua_settop(L, 1);
+
+    lua_Integer pageNr = 0;
+    lua_Integer layerNr = 0;
+    if (lua_istable(L, 1)) {
+        lua_getfield(L, 1, "page");
+        lua_getfield(L, 1, "layer");
+        pageNr = luaL_optinteger(L, -2, 0);
+        layerNr = luaL_optinteger(L, -1, 0);
+        lua_pop(L, 2);
+    }
+
+    if (pageNr < 0 || pageNr > static_cast<lua_Integer>(doc->getPageCount())) {
+        luaL_error(L, "Invalid page number %d!", static_cast<int>(pageNr));
+    }
+    // No PageRef: luaL_error does not run the destructors. The document keeps the page alive.
+    XojPage* page = pageNr > 0 ? doc->getPage(static_cast<size_t>(pageNr - 1)).get() : control->getCurrentPage().get();
+    if (page == nullptr) {
+        luaL_error(L, "No page!");
+    }
+    if (layerNr < 0 || layerNr > static_cast<lua_Integer>(page->getLayerCount())) {
+        luaL_error(L, "Invalid layer number %d!", static_cast<int>(layerNr));
+    }
+    Layer* layer = layerNr > 0 ? page->getLayers()->at(static_cast<size_t>(layerNr - 1)) : page->getSelectedLayer();
+
+    // The points of compacted strokes are unpacked while reading them
+    doc->lock();
+    pushStrokes(L, layer);
+    doc->unlock();
+
+    return 1;
+}
+
+/**
+ * Scales and then moves all the selected elements at once, with a single undo action. The selection is scaled from its
+ * upper left corner. The elements stay selected.
+ *
+ * Optional Arguments: dx, dy (in points, default 0), scaleX, scaleY (default 1), restoreLineWidth (default false, keep
+ * the width of the strokes while scaling)
+ *
+ * Example: app.transformSelection({["dx"] = 20, ["scaleX"] = 2, ["scaleY"] = 2})
+ * doubles the size of the selection and moves it 20pt right
+ */
+static int applib_transformSelection(lua_State* L) {
+    Plugin* plugin = Plugin::getPluginFromLua(L);
+    Control* control = plugin->getControl();
+    XournalView* xournal = control->getWindow()->getXournal();
+
+    // Discard any extra arguments passed in
+    lua_settop(L, 1);
+    luaL_checktype(L, 1, LUA_TTABLE);
+
+    lua_getfield(L, 1, "dx");
+    lua_getfield(L, 1, "dy");
+    lua_getfield(L, 1, "scaleX");
+    lua_getfield(L, 1, "scaleY");
+    lua_getfield(L, 1, "restoreLineWidth");
+
+    double dx = luaL_optnumber(L, -5, 0);
+    double dy = luaL_optnumber(L, -4, 0);
+    double fx = luaL_optnumber(L, -3, 1);
+    double fy = luaL_optnumber(L, -2, 1);
+    bool restoreLineWidth = lua_toboolean(L, -1);
+    lua_pop(L, 5);
+
+    if (!(fx > 0) || !(fy > 0)) {
+        luaL_error(L, "The scale factors must be positive!");
+    }
+
+    EditSelection* selection = xournal->getSelection();
+    if (selection == nullptr) {
+        luaL_error(L, "No selection!");
+    }
+
+    std::vector<Element*> elements = selection->getElements();
+    XojPageView* view = selection->getView();
+    if (elements.empty()) {
+        return 0;
+    }
+
+    // Put the elements back on their layer, and transform them there like the undo actions do
+    control->clearSelection();
+
+    PageRef page = view->getPage();
+    Layer* layer = page->getSelectedLayer();
+
+    double x0 = std::numeric_limits<double>::max();
+    double y0 = std::numeric_limits<double>::max();
+    for (Element* e: elements) {
+        x0 = std::min(x0, e->getX());
+        y0 = std::min(y0, e->getY());
+    }
+
+    auto undo = std::make_unique<GroupUndoAction>();
+    if (fx != 1 || fy != 1) {
+        for (Element* e: elements) { e->scale(x0, y0, fx, fy, 0, restoreLineWidth); }
+        undo->addAction(std::make_unique<ScaleUndoAction>(page, &elements, x0, y0, fx, fy, 0, restoreLineWidth));
+    }
+    if (dx != 0 || dy != 0) {
+        for (Element* e: elements) { e->move(dx, dy); }
+        undo->addAction(std::make_unique<MoveUndoAction>(layer, page, &elements, dx, dy, layer, page));
+    }
+    control->getUndoRedoHandler()->addUndoAction(std::move(undo));
+
+    page->firePageChanged();
+    xournal->setSelection(new EditSelection(control->getUndoRedoHandler(), elements, view, page));
+
+    return 0;
+}
+
 /**
  * Notifies program of any updates to the working document caused
  * by the API.
@@ -1640,7 +1901,100 @@ static int applib_getDisplayDpi(lua_State* L) {
 
 
 /**
- * Exports the current document as a pdf or as a svg or png image
+ * Pushes a table {count = integer, bytes = integer}
+ */
+static void pushMemoryCounter(lua_State* L, const MemoryReport::Counter& counter) {
+    lua_newtable(L);
+    lua_pushinteger(L, static_cast<lua_Integer>(counter.count));
+    lua_setfield(L, -2, "count");
+    lua_pushinteger(L, static_cast<lua_Integer>(counter.bytes));
+    lua_setfield(L, -2, "bytes");
+}
+
+/**
+ * Pushes a table {strokes = counter, images = counter, texImages = counter, texts = counter, others = counter,
+ * bytes = integer}, see pushMemoryCounter()
+ */
+static void pushMemoryPage(lua_State* L, const MemoryReport::Page& page) {
+    lua_newtable(L);
+    pushMemoryCounter(L, page.strokes);
+    lua_setfield(L, -2, "strokes");
+    pushMemoryCounter(L, page.images);
+    lua_setfield(L, -2, "images");
+    pushMemoryCounter(L, page.texImages);
+    lua_setfield(L, -2, "texImages");
+    pushMemoryCounter(L, page.texts);
+    lua_setfield(L, -2, "texts");
+    pushMemoryCounter(L, page.others);
+    lua_setfield(L, -2, "others");
+    lua_pushinteger(L, static_cast<lua_Integer>(page.getBytes()));
+    lua_setfield(L, -2, "bytes");
+}
+
+/**
+ * Returns the approximate memory used by the document and by the caches, in bytes
+ *
+ * {
+ *   "elements" = {
+ *     "strokes" = {"count" = integer, "bytes" = integer},
+ *     "images" = ..., "texImages" = ..., "texts" = ..., "others" = ...,
+ *     "bytes" = integer
+ *   },
+ *   "pages" = {
+ *     [1] = {"loaded" = false} if the page is not loaded, or the same table as "elements" for the page
+ *     ...
+ *   },
+ *   "imageStore" = integer, "texImageCache" = integer, "undo" = integer,
+ *   "pageBuffers" = {"count" = integer, "bytes" = integer}, "snapshots" = integer,
+ *   "pdfCache" = integer, "previews" = integer,
+ *   "total" = integer
+ * }
+ *
+ * Example: local memory = app.getMemoryReport()
+ *          print(memory.pages[1].strokes.bytes)
+ */
+static int applib_getMemoryReport(lua_State* L) {
+    Plugin* plugin = Plugin::getPluginFromLua(L);
+    Control* control = plugin->getControl();
+
+    MemoryReport report(control->getDocument());
+    report.addControl(control);
+
+    lua_newtable(L);
+    pushMemoryPage(L, report.elements);
+    lua_setfield(L, -2, "elements");
+
+    lua_newtable(L);
+    for (size_t i = 0; i < report.pages.size(); i++) {
+        if (report.pages[i].pending) {
+            lua_newtable(L);
+            lua_pushboolean(L, false);
+            lua_setfield(L, -2, "loaded");
+        } else {
+            pushMemoryPage(L, report.pages[i]);
+        }
+        lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+    }
+    lua_setfield(L, -2, "pages");
+
+    const std::pair<const char*, size_t> sizes[] = {
+            {"imageStore", report.imageStoreBytes}, {"texImageCache", report.texImageCacheBytes},
+            {"undo", report.undoBytes},             {"snapshots", report.snapshotBytes},
+            {"pdfCache", report.pdfCacheBytes},     {"previews", report.previewBytes},
+            {"total", report.getTotalBytes()}};
+    for (const auto& [name, bytes]: sizes) {
+        lua_pushinteger(L, static_cast<lua_Integer>(bytes));
+        lua_setfield(L, -2, name);
+    }
+    pushMemoryCounter(L, report.pageBuffers);
+    lua_setfield(L, -2, "pageBuffers");
+
+    return 1;
+}
+
+
+/**
+ * Exports the current document as a pdf or as a svg, png, jpg or webp image
 
  * Example 1:
  * app.export({["outputFile"] = "Test.pdf", ["range"] = "2-5; 7", ["background"] = "none", ["progressiveMode"] = true})
@@ -1652,6 +2006,10 @@ static int applib_getDisplayDpi(lua_State* L) {
  *
  * Example 3:
  * app.export({["outputFile"] = "Test.png", ["range"] = "1-2", ["background"] = "all", ["pngWidth"] = 800})
+ *
+ * Example 4:
+ * app.export({["outputFile"] = "Test.jpg", ["pngDpi"] = 150, ["quality"] = 80})
+ * the quality of the JPEG and WebP compression is from 1 to 100, 90 by default
  **/
 static int applib_export(lua_State* L) {
     Plugin* plugin = Plugin::getPluginFromLua(L);
@@ -1669,14 +2027,16 @@ static int applib_export(lua_State* L) {
     lua_getfield(L, 1, "pngDpi");
     lua_getfield(L, 1, "pngWidth");
     lua_getfield(L, 1, "dpiHeight");
+    lua_getfield(L, 1, "quality");
 
-    const char* outputFile = luaL_optstring(L, -7, nullptr);
-    const char* range = luaL_optstring(L, -6, nullptr);
-    const char* background = luaL_optstring(L, -5, "all");
-    bool progressiveMode = lua_toboolean(L, -4);  // true unless nil or false
-    int pngDpi = luaL_optinteger(L, -3, -1);
-    int pngWidth = luaL_optinteger(L, -2, -1);
-    int pngHeight = luaL_optinteger(L, -1, -1);
+    const char* outputFile = luaL_optstring(L, -8, nullptr);
+    const char* range = luaL_optstring(L, -7, nullptr);
+    const char* background = luaL_optstring(L, -6, "all");
+    bool progressiveMode = lua_toboolean(L, -5);  // true unless nil or false
+    int pngDpi = luaL_optinteger(L, -4, -1);
+    int pngWidth = luaL_optinteger(L, -3, -1);
+    int pngHeight = luaL_optinteger(L, -2, -1);
+    int quality = luaL_optinteger(L, -1, -1);
 
     ExportBackgroundType bgType = EXPORT_BACKGROUND_ALL;
     if (strcmp(background, "unruled") == 0) {
@@ -1694,17 +2054,79 @@ static int applib_export(lua_State* L) {
 
     if (extension == ".pdf") {
         ExportHelper::exportPdf(doc, outputFile, range, bgType, progressiveMode);
-    } else if (extension == ".svg" || extension == ".png") {
-        ExportHelper::exportImg(doc, outputFile, range, pngDpi, pngWidth, pngHeight, bgType);
+    } else if (ImageExport::getFormatForExtension(file) != EXPORT_GRAPHICS_UNDEFINED) {
+        ExportHelper::exportImg(doc, outputFile, range, pngDpi, pngWidth, pngHeight, quality, bgType);
     }
 
     // Make sure to remove all vars which are put to the stack before!
-    lua_pop(L, 7);
+    lua_pop(L, 8);
 
     return 1;
 }
 
 
+/**
+ * Runs a function of a module of the plugin on a worker thread, with a Lua engine of its own, so that a long
+ * computation (a recognition, a layout...) does not block the UI. The function gets a copy of args and its result is
+ * copied back: nil, booleans, numbers, strings and tables of them, but no functions. It cannot use the app library;
+ * with snapshot = true it reads a copy of the document, taken by this call, through the snapshot library. Once it
+ * returns, the callback is called on the UI thread with (result, nil), or with (nil, error message) on an error.
+ * The workers of a plugin are cancelled when it is unloaded.
+ *
+ * Required Arguments: module (found like require() does, e.g. a file of the plugin folder), function
+ * Optional Arguments: args, callback (name of a global function), snapshot (default false)
+ *
+ * Example: app.runAsync({["module"] = "recognizer", ["function"] = "recognize", ["args"] = {["page"] = 2},
+ *                        ["callback"] = "onRecognized", ["snapshot"] = true})
+ * runs recognize({["page"] = 2}) of the table returned by recognizer.lua, which may call
+ * snapshot.getStrokes({["page"] = 2}), and then onRecognized(result, nil)
+ */
+static int applib_runAsync(lua_State* L) {
+    Plugin* plugin = Plugin::getPluginFromLua(L);
+    Control* control = plugin->getControl();
+    Document* doc = control->getDocument();
+
+    // Discard any extra arguments passed in
+    lua_settop(L, 1);
+    luaL_checktype(L, 1, LUA_TTABLE);
+
+    lua_getfield(L, 1, "module");
+    lua_getfield(L, 1, "function");
+    lua_getfield(L, 1, "callback");
+    lua_getfield(L, 1, "snapshot");
+    lua_getfield(L, 1, "args");
+
+    const char* module = luaL_optstring(L, -5, nullptr);
+    const char* function = luaL_optstring(L, -4, nullptr);
+    const char* callback = luaL_optstring(L, -3, "");
+    bool takeSnapshot = lua_toboolean(L, -2);
+
+    if (module == nullptr || function == nullptr) {
+        luaL_error(L, "Missing module or function!");
+    }
+
+    // Scoped: luaL_error does not run the destructors
+    {
+        PluginValue args;
+        std::string error;
+        if (PluginValue::fromLua(L, -1, args, error)) {
+            std::unique_ptr<Document> snapshot;
+            if (takeSnapshot) {
+                doc->lock();
+                snapshot = doc->snapshot();
+                doc->unlock();
+            }
+            plugin->runAsync(module, function, callback, std::move(args), std::move(snapshot));
+
+            // Make sure to remove all vars which are put to the stack before!
+            lua_pop(L, 5);
+            return 0;
+        }
+        lua_pushfstring(L, "Invalid args: %s", error.c_str());
+    }
+    return lua_error(L);
+}
+
 /*
  * The full Lua Plugin API.
  * See above for example usage of each function.
@@ -1732,11 +2154,15 @@ static const luaL_Reg applib[] = {{"msgbox", applib_msgbox},
                                   {"setBackgroundName", applib_setBackgroundName},
                                   {"scaleTextElements", applib_scaleTextElements},
                                   {"getDisplayDpi", applib_getDisplayDpi},
+                                  {"getMemoryReport", applib_getMemoryReport},
                                   {"export", applib_export},
                                   {"addStrokes", applib_addStrokes},
                                   {"addSplines", applib_addSplines},
+                                  {"getStrokes", applib_getStrokes},
+                                  {"transformSelection", applib_transformSelection},
                                   {"getFilePath", applib_getFilePath},
                                   {"refreshPage", applib_refreshPage},
+                                  {"runAsync", applib_runAsync},
                                   // Placeholder
                                   //	{"MSG_BT_OK", nullptr},
 
@@ -1751,3 +2177,118 @@ LUAMOD_API int luaopen_app(lua_State* L) {
     //	lua_setfield(L, -2, "MSG_BT_OK");
     return 1;
 }
+
+/**
+ * @return The copy of the document taken by app.runAsync() for the worker running the function
+ */
+static Document* getSnapshot(lua_State* L) {
+    lua_getfield(L, LUA_REGISTRYINDEX, "Xournalpp_Snapshot");
+    auto* doc = static_cast<Document*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    if (doc == nullptr) {
+        luaL_error(L, "No snapshot, see the argument snapshot of app.runAsync!");
+    }
+    return doc;
+}
+
+/**
+ * @return The page of the snapshot numbered by the argument (starting at 1, default 1)
+ */
+static XojPage* getSnapshotPage(lua_State* L, Document* doc, lua_Integer pageNr) {
+    if (pageNr < 1 || pageNr > static_cast<lua_Integer>(doc->getPageCount())) {
+        luaL_error(L, "Invalid page number %d!", static_cast<int>(pageNr));
+    }
+    // The snapshot keeps the page alive
+    return doc->getPage(static_cast<size_t>(pageNr - 1)).get();
+}
+
+/**
+ * Returns the number of pages of the snapshot
+ *
+ * Example: local count = snapshot.getPageCount()
+ */
+static int snapshotlib_getPageCount(lua_State* L) {
+    Document* doc = getSnapshot(L);
+    lua_pushinteger(L, static_cast<lua_Integer>(doc->getPageCount()));
+    return 1;
+}
+
+/**
+ * Returns the width and the height of a page of the snapshot, in points
+ *
+ * Required Arguments: page (starting at 1)
+ *
+ * Example: local width, height = snapshot.getPageSize(1)
+ */
+static int snapshotlib_getPageSize(lua_State* L) {
+    Document* doc = getSnapshot(L);
+    XojPage* page = getSnapshotPage(L, doc, luaL_checkinteger(L, 1));
+    lua_pushnumber(L, page->getWidth());
+    lua_pushnumber(L, page->getHeight());
+    return 2;
+}
+
+/**
+ * Returns the number of layers of a page of the snapshot, the background excluded
+ *
+ * Required Arguments: page (starting at 1)
+ *
+ * Example: local count = snapshot.getLayerCount(1)
+ */
+static int snapshotlib_getLayerCount(lua_State* L) {
+    Document* doc = getSnapshot(L);
+    XojPage* page = getSnapshotPage(L, doc, luaL_checkinteger(L, 1));
+    lua_pushinteger(L, static_cast<lua_Integer>(page->getLayerCount()));
+    return 1;
+}
+
+/**
+ * Returns the strokes of a layer of the snapshot, in the format of app.getStrokes
+ *
+ * Optional Arguments: page, layer (both starting at 1, default the first page and its current layer)
+ *
+ * Example: local strokes = snapshot.getStrokes({["page"] = 2, ["layer"] = 1})
+ */
+static int snapshotlib_getStrokes(lua_State* L) {
+    Document* doc = getSnapshot(L);
+
+    // Discard any extra arguments passed in
+    lua_settop(L, 1);
+
+    lua_Integer pageNr = 1;
+    lua_Integer layerNr = 0;
+    if (lua_istable(L, 1)) {
+        lua_getfield(L, 1, "page");
+        lua_getfield(L, 1, "layer");
+        pageNr = luaL_optinteger(L, -2, 1);
+        layerNr = luaL_optinteger(L, -1, 0);
+        lua_pop(L, 2);
+    }
+
+    XojPage* page = getSnapshotPage(L, doc, pageNr);
+    if (layerNr < 0 || layerNr > static_cast<lua_Integer>(page->getLayerCount())) {
+        luaL_error(L, "Invalid layer number %d!", static_cast<int>(layerNr));
+    }
+    Layer* layer = layerNr > 0 ? page->getLayers()->at(static_cast<size_t>(layerNr - 1)) : page->getSelectedLayer();
+
+    // The snapshot is only read by this worker
+    pushStrokes(L, layer);
+    return 1;
+}
+
+/**
+ * The read-only library of the workers of app.runAsync()
+ */
+static const luaL_Reg snapshotlib[] = {{"getPageCount", snapshotlib_getPageCount},
+                                       {"getPageSize", snapshotlib_getPageSize},
+                                       {"getLayerCount", snapshotlib_getLayerCount},
+                                       {"getStrokes", snapshotlib_getStrokes},
+                                       {nullptr, nullptr}};
+
+/**
+ * Open snapshot Library
+ */
+LUAMOD_API int luaopen_snapshot(lua_State* L) {
+    luaL_newlib(L, snapshotlib);
+    return 1;
+}
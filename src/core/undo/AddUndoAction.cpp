@@ -21,10 +21,8 @@ auto AddUndoAction::redo(Control*) -> bool {
         return false;
     }
 
-    for (const auto& elem: elements) {
-        elem.layer->insertElement(elem.element, elem.pos);
-        this->page->fireElementChanged(elem.element);
-    }
+    insertEntries(elements);
+    for (const auto& elem: elements) { this->page->fireElementChanged(elem.element); }
 
     this->undone = true;
     return true;
@@ -38,10 +36,8 @@ auto AddUndoAction::undo(Control*) -> bool {
         return false;
     }
 
-    for (const auto& elem: elements) {
-        elem.layer->removeElement(elem.element, false);
-        this->page->fireElementChanged(elem.element);
-    }
+    removeEntries(elements);
+    for (const auto& elem: elements) { this->page->fireElementChanged(elem.element); }
 
     this->undone = false;
 
@@ -3,6 +3,7 @@
 #include "model/Element.h"
 #include "model/PageRef.h"
 #include "util/Range.h"
+#include "util/Rectangle.h"
 
 ArrangeUndoAction::ArrangeUndoAction(const PageRef& page, Layer* layer, std::string desc, InsertOrder oldOrder,
                                      InsertOrder newOrder):
@@ -33,7 +34,13 @@ void ArrangeUndoAction::applyRearrange() {
 
     for (const auto& [e, i]: tgtOrder) { layer->insertElement(e, i); }
 
-    this->page->firePageChanged();
+    // Only the overlaps of the rearranged elements look different
+    if (tgtOrder.empty()) {
+        return;
+    }
+    xoj::util::Rectangle<double> rect = tgtOrder.front().first->boundingRect();
+    for (const auto& [e, _]: tgtOrder) { rect.unite(e->boundingRect()); }
+    this->page->fireRectChanged(rect);
 }
 
 std::string ArrangeUndoAction::getText() { return this->description; }
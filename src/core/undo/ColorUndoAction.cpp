@@ -82,3 +82,19 @@ auto ColorUndoAction::redo(Control* control) -> bool {
 }
 
 auto ColorUndoAction::getText() -> std::string { return _("Change color"); }
+
+auto ColorUndoAction::merge(UndoAction& next) -> bool {
+    auto* color = dynamic_cast<ColorUndoAction*>(&next);
+    if (!color || this->page != color->page || this->data.size() != color->data.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < this->data.size(); i++) {
+        if (this->data[i]->e != color->data[i]->e || this->data[i]->newColor != color->data[i]->oldColor) {
+            return false;
+        }
+    }
+
+    // Keep the original colors, up to the last new ones
+    for (size_t i = 0; i < this->data.size(); i++) { this->data[i]->newColor = color->data[i]->newColor; }
+    return true;
+}
@@ -31,6 +31,7 @@ public:
     bool undo(Control* control) override;
     bool redo(Control* control) override;
     std::string getText() override;
+    bool merge(UndoAction& next) override;
 
     void addStroke(Element* e, Color originalColor, Color newColor);
 
@@ -3,6 +3,7 @@
 #include "model/Element.h"
 #include "model/Layer.h"
 #include "model/PageRef.h"
+#include "model/Stroke.h"
 #include "util/i18n.h"
 
 
@@ -20,10 +21,8 @@ auto DeleteUndoAction::undo(Control*) -> bool {
         return false;
     }
 
-    for (const auto& elem: elements) {
-        elem.layer->insertElement(elem.element, elem.pos);
-        this->page->fireElementChanged(elem.element);
-    }
+    insertEntries(elements);
+    for (const auto& elem: elements) { this->page->fireElementChanged(elem.element); }
 
     this->undone = true;
     return true;
@@ -37,16 +36,37 @@ auto DeleteUndoAction::redo(Control*) -> bool {
         return false;
     }
 
-    for (const auto& elem: elements) {
-        elem.layer->removeElement(elem.element, false);
-        this->page->fireElementChanged(elem.element);
-    }
+    removeEntries(elements);
+    for (const auto& elem: elements) { this->page->fireElementChanged(elem.element); }
 
     this->undone = false;
 
     return true;
 }
 
+auto DeleteUndoAction::getMemoryUsage() const -> size_t {
+    size_t bytes = sizeof(*this);
+    for (const auto& elem: elements) {
+        bytes += sizeof(elem);
+        // Once undone, the elements are in the document again
+        if (!this->undone) {
+            bytes += elem.element->getMemoryUsage();
+        }
+    }
+    return bytes;
+}
+
+void DeleteUndoAction::compact() {
+    if (this->undone) {
+        return;
+    }
+    for (const auto& elem: elements) {
+        if (auto* stroke = dynamic_cast<Stroke*>(elem.element)) {
+            stroke->compact();
+        }
+    }
+}
+
 auto DeleteUndoAction::getText() -> std::string {
     if (eraser) {
         return _("Erase stroke");
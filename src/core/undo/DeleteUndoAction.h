@@ -29,6 +29,9 @@ public:
 
     std::string getText() override;
 
+    size_t getMemoryUsage() const override;
+    void compact() override;
+
 private:
     std::multiset<PageLayerPosEntry<Element>> elements{};
     bool eraser = true;
@@ -1,8 +1,11 @@
 #include "EraseUndoAction.h"
 
+#include <optional>
+
 #include "model/Layer.h"
 #include "model/Stroke.h"
 #include "model/eraser/ErasableStroke.h"
+#include "util/Rectangle.h"
 #include "util/i18n.h"
 
 
@@ -22,15 +25,23 @@ void EraseUndoAction::removeEdited(Stroke* element) {
 }
 
 void EraseUndoAction::finalize() {
+    // The copies are drawn where the erased strokes were
+    std::optional<xoj::util::Rectangle<double>> rect;
     for (auto const& entry: original) {
         if (entry.element->getPointCount() == 0) {
             // TODO (Marmare314): is this really expected behaviour?
             continue;
         } else {
+            if (rect) {
+                rect->unite(entry.element->boundingRect());
+            } else {
+                rect = entry.element->boundingRect();
+            }
+
             // Remove the original and add the copy
             int pos = static_cast<int>(entry.layer->removeElement(entry.element, false));
 
-            ErasableStroke* e = entry.element->getErasable();
+            std::shared_ptr<ErasableStroke> e = entry.element->getErasable();
             std::vector<std::unique_ptr<Stroke>> strokeList = e->getStrokes();
             for (auto& stroke: strokeList) {
                 // TODO (Marmare314): should use unique_ptr in layer
@@ -40,42 +51,47 @@ void EraseUndoAction::finalize() {
                 pos++;
             }
 
-            delete e;
-            e = nullptr;
+            // Deleted once the render jobs drawing it are done
             entry.element->setErasable(nullptr);
         }
     }
 
-    this->page->firePageChanged();
+    if (rect) {
+        this->page->fireRectChanged(*rect);
+    }
 }
 
 auto EraseUndoAction::getText() -> std::string { return _("Erase stroke"); }
 
+auto EraseUndoAction::getMemoryUsage() const -> size_t {
+    // The action owns the strokes out of the document
+    const auto& owned = this->undone ? edited : original;
+    size_t bytes = sizeof(*this);
+    for (auto const& entry: owned) { bytes += sizeof(entry) + entry.element->getMemoryUsage(); }
+    return bytes;
+}
+
+void EraseUndoAction::compact() {
+    for (auto const& entry: this->undone ? edited : original) { entry.element->compact(); }
+}
+
 auto EraseUndoAction::undo(Control* control) -> bool {
-    for (auto const& entry: edited) {
-        entry.layer->removeElement(entry.element, false);
-        this->page->fireElementChanged(entry.element);
-    }
+    removeEntries(edited);
+    for (auto const& entry: edited) { this->page->fireElementChanged(entry.element); }
 
-    for (auto const& entry: original) {
-        entry.layer->insertElement(entry.element, entry.pos);
-        this->page->fireElementChanged(entry.element);
-    }
+    insertEntries(original);
+    for (auto const& entry: original) { this->page->fireElementChanged(entry.element); }
 
     this->undone = true;
     return true;
 }
 
 auto EraseUndoAction::redo(Control* control) -> bool {
-    for (auto const& entry: original) {
-        entry.layer->removeElement(entry.element, false);
-        page->fireElementChanged(entry.element);
-    }
+    removeEntries(original);
+    for (auto const& entry: original) { page->fireElementChanged(entry.element); }
 
-    for (auto const& entry: edited) {
-        entry.layer->insertElement(entry.element, entry.pos);
-        page->fireElementChanged(entry.element);
-    }
+    insertEntries(edited);
+    for (auto const& entry: edited) { page->fireElementChanged(entry.element); }
 
     this->undone = false;
     return true;
@@ -35,6 +35,9 @@ public:
 
     std::string getText() override;
 
+    size_t getMemoryUsage() const override;
+    void compact() override;
+
 private:
     std::multiset<PageLayerPosEntry<Stroke>> edited{};
     std::multiset<PageLayerPosEntry<Stroke>> original{};
@@ -78,10 +78,8 @@ InsertsUndoAction::~InsertsUndoAction() {
 auto InsertsUndoAction::getText() -> std::string { return _("Insert elements"); }
 
 auto InsertsUndoAction::undo(Control* control) -> bool {
-    for (Element* elem: this->elements) {
-        this->layer->removeElement(elem, false);
-        this->page->fireElementChanged(elem);
-    }
+    this->layer->removeElements(this->elements);
+    for (Element* elem: this->elements) { this->page->fireElementChanged(elem); }
 
     this->undone = true;
 
@@ -89,10 +87,8 @@ auto InsertsUndoAction::undo(Control* control) -> bool {
 }
 
 auto InsertsUndoAction::redo(Control* control) -> bool {
-    for (Element* elem: this->elements) {
-        this->layer->addElement(elem);
-        this->page->fireElementChanged(elem);
-    }
+    this->layer->addElements(this->elements);
+    for (Element* elem: this->elements) { this->page->fireElementChanged(elem); }
 
     this->undone = false;
 
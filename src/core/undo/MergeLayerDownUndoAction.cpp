@@ -26,8 +26,10 @@ auto MergeLayerDownUndoAction::getText() -> std::string { return _("Merge layer
 
 auto MergeLayerDownUndoAction::undo(Control* control) -> bool {
     // remove all elements present in the upper layer from the lower layer again
-    const bool free_elems = false;  // don't free the elems, they're still used
-    for (Element* elem: this->upperLayer->getElements()) { this->lowerLayer->removeElement(elem, free_elems); }
+    // (without freeing them, they're still used)
+    this->lowerLayer->removeElements(this->upperLayer->getElements());
+    // the elements were temporarily tracked by the index of the lower layer
+    this->upperLayer->reindex();
     // add the upper layer back at its old pos
     layerController->insertLayer(this->page, this->upperLayer, upperLayerPos);
     // set the selected layer back to the ID of the upper layer
@@ -44,7 +46,7 @@ auto MergeLayerDownUndoAction::redo(Control* control) -> bool {
     // remove the upper layer
     layerController->removeLayer(this->page, this->upperLayer);
     // add all elements back to the lower layer
-    for (Element* elem: this->upperLayer->getElements()) { this->lowerLayer->addElement(elem); }
+    this->lowerLayer->addElements(this->upperLayer->getElements());
     // set the selected layer back to the ID of the lower layer
     this->page->setSelectedLayerId(this->lowerLayerID);
 
@@ -61,8 +63,8 @@ void MergeLayerDownUndoAction::triggerUIUpdate(Control* control) {
      *     When this implementation is called by the `UndoRedoHandler` the
      *     document is locked. Calling `layerChanged` adds a render job which
      *     can only be processed when the document is unlocked again, but might
-     *     have already claimed `Scheduler::jobRunningMutex`.
-     *     `fireRebuildLayerMenu` will wait for `jobRunningMutex` to be free,
+     *     have already been started by the `Scheduler`.
+     *     `fireRebuildLayerMenu` will wait for the running jobs to finish,
      *     so calling `fireRebuildLayerMenu` AFTER `layerChanged` will likely
      *     result in a DEADLOCK.
      */
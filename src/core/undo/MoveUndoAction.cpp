@@ -1,10 +1,12 @@
 #include "MoveUndoAction.h"
 
+#include "control/tools/BulkTransform.h"
 #include "control/tools/EditSelection.h"
 #include "gui/Redrawable.h"
 #include "model/Element.h"
 #include "model/Layer.h"
 #include "model/PageRef.h"
+#include "util/Rectangle.h"
 #include "util/i18n.h"
 
 MoveUndoAction::MoveUndoAction(Layer* sourceLayer, const PageRef& sourcePage, std::vector<Element*>* selected,
@@ -29,9 +31,9 @@ MoveUndoAction::~MoveUndoAction() = default;
 
 void MoveUndoAction::move() {
     if (this->undone) {
-        for (Element* e: this->elements) { e->move(dx, dy); }
+        BulkTransform().move(dx, dy).apply(this->elements);
     } else {
-        for (Element* e: this->elements) { e->move(-dx, -dy); }
+        BulkTransform().move(-dx, -dy).apply(this->elements);
     }
 }
 
@@ -60,10 +62,8 @@ auto MoveUndoAction::redo(Control* control) -> bool {
 }
 
 void MoveUndoAction::switchLayer(std::vector<Element*>* entries, Layer* oldLayer, Layer* newLayer) {
-    for (Element* e: this->elements) {
-        oldLayer->removeElement(e, false);
-        newLayer->addElement(e);
-    }
+    oldLayer->removeElements(this->elements);
+    newLayer->addElements(this->elements);
 }
 
 void MoveUndoAction::repaint() {
@@ -71,10 +71,15 @@ void MoveUndoAction::repaint() {
         return;
     }
 
-    this->page->firePageChanged();
+    // The elements at their new position and where they were before move()
+    xoj::util::Rectangle<double> rect = this->elements.front()->boundingRect();
+    for (Element* e: this->elements) { rect.unite(e->boundingRect()); }
+    rect.unite(this->undone ? rect.translated(-dx, -dy) : rect.translated(dx, dy));
+
+    this->page->fireRectChanged(rect);
 
     if (this->targetPage) {
-        this->targetPage->firePageChanged();
+        this->targetPage->fireRectChanged(rect);
     }
 }
 
@@ -86,3 +91,16 @@ auto MoveUndoAction::getPages() -> std::vector<PageRef> {
 }
 
 auto MoveUndoAction::getText() -> std::string { return text; }
+
+auto MoveUndoAction::merge(UndoAction& next) -> bool {
+    auto* move = dynamic_cast<MoveUndoAction*>(&next);
+    // Only the moves of the same elements within a layer add up
+    if (!move || this->targetLayer || move->targetLayer || this->page != move->page ||
+        this->sourceLayer != move->sourceLayer || this->elements != move->elements) {
+        return false;
+    }
+
+    this->dx += move->dx;
+    this->dy += move->dy;
+    return true;
+}
@@ -28,6 +28,7 @@ public:
     bool redo(Control* control) override;
     std::vector<PageRef> getPages() override;
     std::string getText() override;
+    bool merge(UndoAction& next) override;
 
 private:
     void switchLayer(std::vector<Element*>* entries, Layer* oldLayer, Layer* newLayer);
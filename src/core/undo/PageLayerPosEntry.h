@@ -12,8 +12,12 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
 
-class Layer;
+#include "model/Layer.h"
 
 template <class T>
 struct PageLayerPosEntry {
@@ -29,3 +33,26 @@ template <typename T>
 constexpr auto operator<(const PageLayerPosEntry<T>& lhs, const PageLayerPosEntry<T>& rhs) -> bool {
     return lhs.pos < rhs.pos;
 }
+
+/**
+ * Inserts the elements of the entries in their layers, as successive calls to Layer::insertElement() in the order of
+ * the entries would
+ */
+template <typename T>
+void insertEntries(const std::multiset<PageLayerPosEntry<T>>& entries) {
+    std::map<Layer*, std::vector<std::pair<Element*, Element::Index>>> byLayer;
+    for (const auto& entry: entries) { byLayer[entry.layer].emplace_back(entry.element, entry.pos); }
+
+    for (auto& [layer, elements]: byLayer) { layer->insertElements(elements); }
+}
+
+/**
+ * Removes the elements of the entries from their layers, in a single pass over each layer
+ */
+template <typename T>
+void removeEntries(const std::multiset<PageLayerPosEntry<T>>& entries) {
+    std::map<Layer*, std::vector<Element*>> byLayer;
+    for (const auto& entry: entries) { byLayer[entry.layer].push_back(entry.element); }
+
+    for (auto& [layer, elements]: byLayer) { layer->removeElements(elements); }
+}
@@ -1,5 +1,6 @@
 #include "RotateUndoAction.h"
 
+#include "control/tools/BulkTransform.h"
 #include "model/Element.h"
 #include "model/PageRef.h"
 #include "util/Range.h"
@@ -39,7 +40,9 @@ void RotateUndoAction::applyRotation(double rotation) {
     for (Element* e: this->elements) {
         r.addPoint(e->getX(), e->getY());
         r.addPoint(e->getX() + e->getElementWidth(), e->getY() + e->getElementHeight());
-        e->rotate(this->x0, this->y0, rotation);
+    }
+    BulkTransform().rotate(this->x0, this->y0, rotation).apply(this->elements);
+    for (Element* e: this->elements) {
         r.addPoint(e->getX(), e->getY());
         r.addPoint(e->getX() + e->getElementWidth(), e->getY() + e->getElementHeight());
     }
@@ -2,6 +2,7 @@
 
 #include <cmath>
 
+#include "control/tools/BulkTransform.h"
 #include "model/Element.h"
 #include "model/PageRef.h"
 #include "util/Range.h"
@@ -44,7 +45,9 @@ void ScaleUndoAction::applyScale(double fx, double fy, bool restoreLineWidth) {
     for (Element* e: this->elements) {
         r.addPoint(e->getX(), e->getY());
         r.addPoint(e->getX() + e->getElementWidth(), e->getY() + e->getElementHeight());
-        e->scale(this->x0, this->y0, fx, fy, this->rotation, restoreLineWidth);
+    }
+    BulkTransform().scale(this->x0, this->y0, fx, fy, this->rotation, restoreLineWidth).apply(this->elements);
+    for (Element* e: this->elements) {
         r.addPoint(e->getX(), e->getY());
         r.addPoint(e->getX() + e->getElementWidth(), e->getY() + e->getElementHeight());
     }
@@ -10,4 +10,10 @@ auto UndoAction::getPages() -> std::vector<PageRef> {
     return pages;
 }
 
+auto UndoAction::getMemoryUsage() const -> size_t { return sizeof(*this); }
+
+void UndoAction::compact() {}
+
+auto UndoAction::merge(UndoAction& next) -> bool { return false; }
+
 auto UndoAction::getClassName() const -> std::string const& { return this->className; }
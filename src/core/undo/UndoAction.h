@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 #include "model/PageRef.h"
 
 #include "config.h"
@@ -34,6 +36,24 @@ public:
      */
     virtual std::vector<PageRef> getPages();
 
+    /**
+     * @return The approximate number of bytes held by the action, e.g. the elements it removed from the document
+     */
+    virtual size_t getMemoryUsage() const;
+
+    /**
+     * Reduce the memory held by the action, called on the old actions once the history is over its memory budget.
+     * The elements must keep their identity: the other actions refer to them.
+     */
+    virtual void compact();
+
+    /**
+     * Absorb the next action if it continues this one, e.g. another nudge of the same selection. Both actions are done.
+     *
+     * @return true if merged: the next action is not needed anymore
+     */
+    virtual bool merge(UndoAction& next);
+
     auto getClassName() const -> std::string const&;
 
 protected:
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <iterator>
 
 #include "control/Control.h"
 #include "util/XojMsgBox.h"
@@ -57,7 +58,7 @@ void UndoRedoHandler::printContents() {
     }
 }
 
-UndoRedoHandler::UndoRedoHandler(Control* control): control(control) {}
+UndoRedoHandler::UndoRedoHandler(Control* control, size_t maxMemory): control(control), maxMemory(maxMemory) {}
 
 UndoRedoHandler::~UndoRedoHandler() { clearContents(); }
 
@@ -69,11 +70,16 @@ void UndoRedoHandler::clearContents() {
     }
 #endif  // UNDO_TRACE
 
+    if (!undoList.empty()) {
+        waitForSnapshots();
+    }
     undoList.clear();
     clearRedo();
 
     this->savedUndo = nullptr;
     this->autosavedUndo = nullptr;
+    this->savedDropped = false;
+    this->autosavedDropped = false;
 
     printContents();
 }
@@ -88,6 +94,12 @@ void UndoRedoHandler::clearRedo() {
     printContents();
 }
 
+void UndoRedoHandler::waitForSnapshots() {
+    if (this->control) {
+        this->control->getDocument()->waitForSnapshots();
+    }
+}
+
 void UndoRedoHandler::undo() {
     if (this->undoList.empty()) {
         return;
@@ -157,8 +169,15 @@ void UndoRedoHandler::addUndoAction(UndoActionPtr action) {
         return;
     }
 
+    if (merge(*action)) {
+        fireUpdateUndoRedoButtons(this->undoList.back()->getPages());
+        printContents();
+        return;
+    }
+
     this->undoList.emplace_back(std::move(action));
     clearRedo();
+    trim();
     fireUpdateUndoRedoButtons(this->undoList.back()->getPages());
 
     printContents();
@@ -174,6 +193,7 @@ void UndoRedoHandler::addUndoActionBefore(UndoActionPtr action, UndoAction* befo
     }
     this->undoList.emplace(iter, std::move(action));
     clearRedo();
+    trim();
     fireUpdateUndoRedoButtons(this->undoList.back()->getPages());
 
     printContents();
@@ -185,6 +205,7 @@ auto UndoRedoHandler::removeUndoAction(UndoAction* action) -> bool {
     if (iter == end(this->undoList)) {
         return false;
     }
+    waitForSnapshots();
     this->undoList.erase(iter);
     clearRedo();
     fireUpdateUndoRedoButtons(action->getPages());
@@ -230,6 +251,9 @@ void UndoRedoHandler::fireUpdateUndoRedoButtons(const std::vector<PageRef>& page
 void UndoRedoHandler::addUndoRedoListener(UndoRedoListener* listener) { this->listener.emplace_back(listener); }
 
 auto UndoRedoHandler::isChanged() -> bool {
+    if (this->savedDropped) {
+        return true;
+    }
     if (this->undoList.empty()) {
         return this->savedUndo;
     }
@@ -238,6 +262,9 @@ auto UndoRedoHandler::isChanged() -> bool {
 }
 
 auto UndoRedoHandler::isChangedAutosave() -> bool {
+    if (this->autosavedDropped) {
+        return true;
+    }
     if (this->undoList.empty()) {
         return this->autosavedUndo;
     }
@@ -245,9 +272,79 @@ auto UndoRedoHandler::isChangedAutosave() -> bool {
 }
 
 void UndoRedoHandler::documentAutosaved() {
+    this->autosavedDropped = false;
     this->autosavedUndo = this->undoList.empty() ? nullptr : this->undoList.back().get();
 }
 
 void UndoRedoHandler::documentSaved() {
+    this->savedDropped = false;
     this->savedUndo = this->undoList.empty() ? nullptr : this->undoList.back().get();
 }
+
+void UndoRedoHandler::documentSaveFailed() { this->savedDropped = true; }
+
+auto UndoRedoHandler::getMemoryUsage() const -> size_t {
+    size_t bytes = 0;
+    for (auto const& action: this->undoList) { bytes += action->getMemoryUsage(); }
+    for (auto const& action: this->redoList) { bytes += action->getMemoryUsage(); }
+    return bytes;
+}
+
+void UndoRedoHandler::setMaxMemory(size_t bytes) {
+    this->maxMemory = bytes;
+    trim();
+}
+
+void UndoRedoHandler::trim() {
+    size_t bytes = getMemoryUsage();
+    if (bytes <= this->maxMemory || this->undoList.size() < 2) {
+        return;
+    }
+
+    // The last action may still be extended, e.g. by the eraser while it is down
+    auto last = std::prev(this->undoList.end());
+    for (auto it = this->undoList.begin(); it != last && bytes > this->maxMemory; ++it) {
+        size_t before = (*it)->getMemoryUsage();
+        (*it)->compact();
+        bytes = bytes - before + (*it)->getMemoryUsage();
+    }
+
+    if (bytes > this->maxMemory) {
+        waitForSnapshots();
+    }
+    while (bytes > this->maxMemory && this->undoList.size() > 1) {
+        UndoAction* action = this->undoList.front().get();
+        size_t actionBytes = action->getMemoryUsage();
+        g_debug("Undo history over its memory budget, dropping %s (%zu bytes)", action->getClassName().c_str(),
+                actionBytes);
+
+        // nullptr is the state before the first action: the saved state cannot be reached by undoing anymore
+        if (this->savedUndo == action || this->savedUndo == nullptr) {
+            this->savedUndo = nullptr;
+            this->savedDropped = true;
+        }
+        if (this->autosavedUndo == action || this->autosavedUndo == nullptr) {
+            this->autosavedUndo = nullptr;
+            this->autosavedDropped = true;
+        }
+        this->undoList.pop_front();
+        bytes -= actionBytes;
+    }
+}
+
+auto UndoRedoHandler::merge(UndoAction& action) -> bool {
+    auto now = std::chrono::steady_clock::now();
+    bool recent = now - this->lastAdded < MERGE_INTERVAL;
+    this->lastAdded = now;
+
+    if (!recent || this->undoList.empty() || !this->redoList.empty()) {
+        return false;
+    }
+
+    // The saved state must stay reachable
+    UndoAction* last = this->undoList.back().get();
+    if (last == this->savedUndo || last == this->autosavedUndo) {
+        return false;
+    }
+    return last->merge(action);
+}
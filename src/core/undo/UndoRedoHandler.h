@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <deque>
 #include <memory>
 #include <stack>
@@ -30,9 +32,18 @@ public:
     virtual ~UndoRedoListener() = default;
 };
 
+/**
+ * @brief The undo and redo history of the document
+ *
+ * The history is kept within a memory budget: once over it, the old actions are compacted (see UndoAction::compact())
+ * and, if that is not enough, the oldest ones are dropped. The last action is always kept.
+ *
+ * An action added shortly after the previous one is merged into it when it continues it (see UndoAction::merge()),
+ * e.g. the nudges of a selection with the arrow keys: they are undone at once.
+ */
 class UndoRedoHandler {
 public:
-    explicit UndoRedoHandler(Control* control);
+    explicit UndoRedoHandler(Control* control, size_t maxMemory = MAX_MEMORY);
     virtual ~UndoRedoHandler();
 
     void undo();
@@ -58,8 +69,43 @@ public:
     void documentAutosaved();
     void documentSaved();
 
+    /**
+     * The save marked by documentSaved() did not reach the file, e.g. its upload failed: the document is changed
+     */
+    void documentSaveFailed();
+
+    /**
+     * @return The approximate number of bytes held by the undo and redo actions
+     */
+    size_t getMemoryUsage() const;
+
+    void setMaxMemory(size_t bytes);
+
+    static constexpr size_t MAX_MEMORY = 256U << 20U;
+
+    /**
+     * The longest time between two actions merged together
+     */
+    static constexpr std::chrono::milliseconds MERGE_INTERVAL{1000};
+
 private:
     void clearRedo();
+
+    /**
+     * Called before deleting the actions of the undo list: their elements may still be drawn by the render jobs, see
+     * Document::lockSnapshot(). The ones of the redo list were removed with the exclusive lock, no snapshot has them.
+     */
+    void waitForSnapshots();
+
+    /**
+     * Compact and drop the old actions until the undo list is within the memory budget
+     */
+    void trim();
+
+    /**
+     * @return true if the action was merged into the last one
+     */
+    bool merge(UndoAction& action);
     void printContents();
 
 private:
@@ -69,7 +115,20 @@ private:
     UndoAction* savedUndo = nullptr;
     UndoAction* autosavedUndo = nullptr;
 
+    /**
+     * The saved state was dropped from the history: it cannot be reached anymore
+     */
+    bool savedDropped = false;
+    bool autosavedDropped = false;
+
     std::vector<UndoRedoListener*> listener;
 
+    size_t maxMemory;
+
+    /**
+     * When the last action was added
+     */
+    std::chrono::steady_clock::time_point lastAdded;
+
     Control* control = nullptr;
 };
@@ -23,6 +23,18 @@ using xoj::util::Rectangle;
  */
 void DocumentView::setMarkAudioStroke(bool markAudioStroke) { this->markAudioStroke = markAudioStroke; }
 
+void DocumentView::setLevelOfDetail(double scale) {
+    this->detailTolerance = scale > 0 ? xoj::view::LOD_PIXEL_TOLERANCE / scale : 0;
+}
+
+auto DocumentView::getDetailTolerance() const -> double { return this->detailTolerance; }
+
+void DocumentView::setCancellation(const std::atomic<bool>* cancelled) { this->cancelled = cancelled; }
+
+void DocumentView::setDraft(bool draft) { this->draft = draft; }
+
+void DocumentView::setSnapshot(const PageSnapshot* snapshot) { this->snapshot = snapshot; }
+
 void DocumentView::limitArea(double x, double y, double width, double height) {
     this->lX = x;
     this->lY = y;
@@ -77,7 +89,8 @@ void DocumentView::drawBackground(bool hidePdfBackground, bool hideImageBackgrou
     if (pt.isPdfPage()) {
         // Handled in PdfView
     } else if (pt.isImagePage() && !hideImageBackground) {
-        xoj::view::ImageBackgroundView bgView(page->getBackgroundImage(), page->getWidth(), page->getHeight());
+        xoj::view::ImageBackgroundView bgView(page->getBackgroundImage(), page->getWidth(), page->getHeight(),
+                                              this->draft ? CAIRO_FILTER_FAST : CAIRO_FILTER_GOOD);
         bgView.draw(cr);
     } else if (!hideRulingBackground) {
         auto bgView =
@@ -96,7 +109,25 @@ void DocumentView::drawBackground(bool hidePdfBackground, bool hideImageBackgrou
 void DocumentView::drawPage(PageRef page, cairo_t* cr, bool dontRenderEditingStroke, bool hidePdfBackground,
                             bool hideImageBackground, bool hideRulingBackground) {
     initDrawing(page, cr, dontRenderEditingStroke);
+    drawBackgroundOrPattern(hidePdfBackground, hideImageBackground, hideRulingBackground);
+    drawLayers();
+    finializeDrawing();
+}
+
+void DocumentView::drawPageBackground(PageRef page, cairo_t* cr) {
+    initDrawing(page, cr, true);
+    drawBackgroundOrPattern(false, false, false);
+    finializeDrawing();
+}
+
+void DocumentView::drawPageLayers(PageRef page, cairo_t* cr, bool dontRenderEditingStroke) {
+    initDrawing(page, cr, dontRenderEditingStroke);
+    drawLayers();
+    finializeDrawing();
+}
 
+void DocumentView::drawBackgroundOrPattern(bool hidePdfBackground, bool hideImageBackground,
+                                           bool hideRulingBackground) {
     bool backgroundVisible = page->isLayerVisible(0);
 
     if (backgroundVisible) {
@@ -107,11 +138,28 @@ void DocumentView::drawPage(PageRef page, cairo_t* cr, bool dontRenderEditingStr
         xoj::view::TransparentCheckerboardBackgroundView bgView(page->getWidth(), page->getHeight());
         bgView.draw(cr);
     }
+}
 
+void DocumentView::drawLayers() {
     xoj::view::Context context{cr, (xoj::view::NonAudioTreatment)this->markAudioStroke,
                                (xoj::view::EditionTreatment) !this->dontRenderEditingStroke, xoj::view::NORMAL_COLOR};
+    context.detailTolerance = this->draft ? this->detailTolerance * DRAFT_DETAIL_FACTOR : this->detailTolerance;
+    context.cancelled = this->cancelled;
+    context.draft = this->draft;
     const Rectangle<double> drawArea{this->lX, this->lY, this->lWidth, this->lHeight};
+    if (this->snapshot) {
+        for (const auto& elements: this->snapshot->getLayers()) {
+            if (context.isCancelled()) {
+                break;
+            }
+            xoj::view::LayerView::drawElements(elements, context, drawArea);
+        }
+        return;
+    }
     for (Layer* layer: *page->getLayers()) {
+        if (context.isCancelled()) {
+            break;
+        }
         if (layer->isVisible()) {
             xoj::view::LayerView layerView(layer);
             if (this->lX == -1) {
@@ -121,6 +169,4 @@ void DocumentView::drawPage(PageRef page, cairo_t* cr, bool dontRenderEditingStr
             }
         }
     }
-
-    finializeDrawing();
 }
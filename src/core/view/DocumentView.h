@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,7 @@
 #include "model/ElementContainer.h"
 #include "model/Image.h"
 #include "model/PageRef.h"
+#include "model/PageSnapshot.h"
 #include "model/Stroke.h"
 #include "model/TexImage.h"
 #include "model/Text.h"
@@ -42,6 +44,16 @@ public:
     void drawPage(PageRef page, cairo_t* cr, bool dontRenderEditingStroke, bool hidePdfBackground = false,
                   bool hideImageBackground = false, bool hideRulingBackground = false);
 
+    /**
+     * Draw only what drawPage() draws under the layers, e.g. to keep it. The PDF background is not drawn.
+     */
+    void drawPageBackground(PageRef page, cairo_t* cr);
+
+    /**
+     * Draw only the layers of the page, without the background, e.g. over a copy of drawPageBackground()
+     */
+    void drawPageLayers(PageRef page, cairo_t* cr, bool dontRenderEditingStroke);
+
     void limitArea(double x, double y, double width, double height);
 
     /**
@@ -49,6 +61,40 @@ public:
      */
     void setMarkAudioStroke(bool markAudioStroke);
 
+    /**
+     * Draw the strokes with only the points visible at this scale. By default all the points are drawn, as needed
+     * by exports and printing.
+     * @param scale Device pixels per page unit
+     */
+    void setLevelOfDetail(double scale);
+
+    /**
+     * @return The tolerance of the strokes set by setLevelOfDetail(), see xoj::view::Context::detailTolerance
+     */
+    double getDetailTolerance() const;
+
+    /**
+     * Stop drawing the layers once the flag is true, e.g. the one of a cancelled Job
+     */
+    void setCancellation(const std::atomic<bool>* cancelled);
+
+    /**
+     * Draw a draft, rendered again once the view settles: the images with the fast filter, and the strokes with
+     * DRAFT_DETAIL_FACTOR times the tolerance of setLevelOfDetail()
+     */
+    void setDraft(bool draft);
+
+    /**
+     * The tolerance of the strokes of a draft, relative to the one of setLevelOfDetail()
+     */
+    static constexpr double DRAFT_DETAIL_FACTOR = 4.0;
+
+    /**
+     * Draw the elements of the snapshot instead of the ones of the layers of the page, see Document::lockSnapshot().
+     * The snapshot covers the area of limitArea().
+     */
+    void setSnapshot(const PageSnapshot* snapshot);
+
     // API for special drawing, usually you won't call this methods
 public:
     /**
@@ -65,6 +111,16 @@ public:
     void drawBackground(bool hidePdfBackground = false, bool hideImageBackground = false,
                         bool hideRulingBackground = false);
 
+    /**
+     * Draw the background, or the transparent pattern if the background layer is hidden
+     */
+    void drawBackgroundOrPattern(bool hidePdfBackground, bool hideImageBackground, bool hideRulingBackground);
+
+    /**
+     * Draw the visible layers, in the area of limitArea() if set
+     */
+    void drawLayers();
+
     /**
      * Draw background if there is no background shown, like in GIMP etc.
      */
@@ -82,6 +138,10 @@ private:
     double height = 0;
     bool dontRenderEditingStroke = false;
     bool markAudioStroke = false;
+    double detailTolerance = 0;
+    const std::atomic<bool>* cancelled = nullptr;
+    const PageSnapshot* snapshot = nullptr;
+    bool draft = false;
 
     double lX = -1;
     double lY = -1;
@@ -27,3 +27,24 @@ auto ElementView::createFromElement(const Element* e) -> std::unique_ptr<Element
             return nullptr;
     }
 }
+
+void ElementView::drawElement(const Element* e, const Context& ctx) {
+    // The views only hold a pointer to the element: constructing them on the stack is free, and the calls to draw()
+    // are resolved statically
+    switch (e->getType()) {
+        case ELEMENT_STROKE:
+            StrokeView(static_cast<const Stroke*>(e)).draw(ctx);
+            break;
+        case ELEMENT_TEXT:
+            TextView(static_cast<const Text*>(e)).draw(ctx);
+            break;
+        case ELEMENT_IMAGE:
+            ImageView(static_cast<const Image*>(e)).draw(ctx);
+            break;
+        case ELEMENT_TEXIMAGE:
+            TexImageView(static_cast<const TexImage*>(e)).draw(ctx);
+            break;
+        default:
+            assert(false && "ElementView::drawElement: Unknown element type!");
+    }
+}
@@ -1,8 +1,10 @@
 #include "ErasableStrokeView.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "model/Stroke.h"
+#include "model/StrokeSegmentTree.h"
 #include "model/eraser/ErasableStroke.h"
 
 #include "DocumentView.h"
@@ -13,6 +15,48 @@ using namespace xoj::view;
 
 ErasableStrokeView::ErasableStrokeView(const ErasableStroke& erasableStroke): erasableStroke(erasableStroke) {}
 
+/**
+ * Calls f(start, first, last, end) for the parts of the subsection which may be drawn in the area: a part goes from
+ * start through the points [first, last) to end. Without a segment tree, the whole subsection is a single part.
+ */
+template <class F>
+static void forEachPartInArea(const Stroke& stroke, const ErasableStroke::SubSection& section,
+                              const StrokeSegmentTree* tree, const Rectangle<double>& area, F f) {
+    const std::vector<Point>& data = stroke.getPointVector();
+    // The part through the segments [a, b] of the subsection
+    auto emit = [&](size_t a, size_t b) {
+        Point start = a == section.min.index ? stroke.getPoint(section.min) : data[a];
+        Point end = b == section.max.index ? stroke.getPoint(section.max) : data[b + 1];
+        f(start, a + 1, b + 1, end);
+    };
+
+    if (!tree) {
+        emit(section.min.index, section.max.index);
+        return;
+    }
+    tree->forEachRun(area, [&](size_t first, size_t last) {
+        const size_t a = std::max(first, section.min.index);
+        const size_t b = std::min(last, section.max.index);
+        if (a <= b) {
+            emit(a, b);
+        }
+        return last < section.max.index;
+    });
+}
+
+/**
+ * @return The clip extents of the context, padded by the width
+ */
+static auto getDrawnArea(cairo_t* cr, double width) -> Rectangle<double> {
+    double x1 = 0;
+    double y1 = 0;
+    double x2 = 0;
+    double y2 = 0;
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+    // The segments within a width of the area may paint in it, with their caps and joins
+    return Rectangle<double>(x1 - width, y1 - width, x2 - x1 + 2 * width, y2 - y1 + 2 * width);
+}
+
 void ErasableStrokeView::draw(cairo_t* cr) const {
     std::vector<ErasableStroke::SubSection> sections = erasableStroke.getRemainingSubSectionsVector();
 
@@ -31,7 +75,34 @@ void ErasableStrokeView::draw(cairo_t* cr) const {
 
     cairo_save(cr);
 
-    if (stroke.hasPressure()) {
+    /**
+     * While erasing, the page is only repainted around the sections erased at the last iteration (see
+     * ErasableStroke::erase()): the segments of the long subsections away from the repainted area are skipped.
+     * The dashes restart with each part of a subsection, those strokes are drawn entirely.
+     */
+    auto tree = dashes ? nullptr : stroke.getSegmentTree();
+
+    if (stroke.hasPressure() && tree) {
+        double maxWidth = 0;
+        for (const Point& p: data) { maxWidth = std::max(maxWidth, p.z); }
+        const Rectangle<double> area = getDrawnArea(cr, maxWidth);
+
+        for (const auto& interval: sections) {
+            forEachPartInArea(stroke, interval, tree.get(), area,
+                              [&](const Point& start, size_t first, size_t last, const Point& end) {
+                                  const Point* p = &start;
+                                  auto segmentTo = [&](const Point& q) {
+                                      cairo_set_line_width(cr, p->z);
+                                      cairo_move_to(cr, p->x, p->y);
+                                      cairo_line_to(cr, q.x, q.y);
+                                      cairo_stroke(cr);
+                                      p = &q;
+                                  };
+                                  for (size_t i = first; i < last; i++) { segmentTo(data[i]); }
+                                  segmentTo(end);
+                              });
+        }
+    } else if (stroke.hasPressure()) {
         double dashOffset = 0;
         for (const auto& interval: sections) {
             Point p = stroke.getPoint(interval.min);
@@ -98,18 +169,15 @@ void ErasableStrokeView::draw(cairo_t* cr) const {
             --sectionEndIt;
         }
 
+        const Rectangle<double> area = getDrawnArea(cr, stroke.getWidth());
         for (; sectionIt != sectionEndIt; ++sectionIt) {
-            Point p = stroke.getPoint(sectionIt->min);
-            cairo_move_to(cr, p.x, p.y);
-
-            auto endIt = std::next(data.cbegin(), (std::ptrdiff_t)sectionIt->max.index + 1);
-            for (auto it = std::next(data.cbegin(), (std::ptrdiff_t)sectionIt->min.index + 1); it != endIt; ++it) {
-                cairo_line_to(cr, it->x, it->y);
-            }
-
-            Point q = stroke.getPoint(sectionIt->max);
-            cairo_line_to(cr, q.x, q.y);
-            cairo_stroke(cr);
+            forEachPartInArea(stroke, *sectionIt, tree.get(), area,
+                              [&](const Point& start, size_t first, size_t last, const Point& end) {
+                                  cairo_move_to(cr, start.x, start.y);
+                                  for (size_t i = first; i < last; i++) { cairo_line_to(cr, data[i].x, data[i].y); }
+                                  cairo_line_to(cr, end.x, end.y);
+                                  cairo_stroke(cr);
+                              });
         }
     }
 
@@ -1,6 +1,7 @@
 #include "ImageView.h"
 
 #include "model/Image.h"
+#include "model/ImageStore.h"
 
 using namespace xoj::view;
 
@@ -11,26 +12,25 @@ ImageView::~ImageView() = default;
 void ImageView::draw(const Context& ctx) const {
     cairo_t* cr = ctx.cr;
 
-    cairo_save(cr);
-
-    cairo_surface_t* img = image->getImage();
-    int width = cairo_image_surface_get_width(img);
-    int height = cairo_image_surface_get_height(img);
+    auto content = ctx.pendingImages == WAIT_FOR_IMAGES ? image->getContent() : image->getContentIfReady();
+    if (!content && image->hasData()) {
+        // The data is being prepared: show where the image will be
+        cairo_save(cr);
+        cairo_rectangle(cr, image->getX(), image->getY(), image->getElementWidth(), image->getElementHeight());
+        cairo_set_source_rgba(cr, 0.5, 0.5, 0.5, 0.25);
+        cairo_fill(cr);
+        cairo_restore(cr);
+        return;
+    }
+    g_assert(content && "image has no data, cannot render it!");
 
+    cairo_save(cr);
     cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
 
-    double xFactor = image->getElementWidth() / width;
-    double yFactor = image->getElementHeight() / height;
-
-    cairo_scale(cr, xFactor, yFactor);
-
-    cairo_set_source_surface(cr, img, image->getX() / xFactor, image->getY() / yFactor);
     // make images translucent when highlighting elements with audio, as they can not have audio
-    if (ctx.fadeOutNonAudio) {
-        cairo_paint_with_alpha(cr, OPACITY_NO_AUDIO);
-    } else {
-        cairo_paint(cr);
-    }
+    content->getMipmap().paint(cr, image->getX(), image->getY(), image->getElementWidth(), image->getElementHeight(),
+                               ctx.fadeOutNonAudio ? OPACITY_NO_AUDIO : 1.0,
+                               ctx.draft ? CAIRO_FILTER_FAST : CAIRO_FILTER_GOOD);
 
     cairo_restore(cr);
 }
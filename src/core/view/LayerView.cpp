@@ -1,18 +1,117 @@
 #include "LayerView.h"
 
+#include <vector>
+
 #include "model/Layer.h"
+#include "model/Stroke.h"
+
+#include "StrokeView.h"
 
 using xoj::util::Rectangle;
 using namespace xoj::view;
 
+namespace {
+/**
+ * Draws the elements in order, with the consecutive strokes of the same style in one batch (see
+ * StrokeView::drawBatch()), the consecutive pressure sensitive strokes of the same color in one filling (see
+ * StrokeView::drawPressureBatch()), and the consecutive highlighter strokes of the same color in one mask (see
+ * StrokeView::drawHighlighterBatch())
+ */
+class BatchedElementDrawer {
+public:
+    explicit BatchedElementDrawer(const Context& ctx): ctx(ctx) {}
+
+    void draw(const Element* e) {
+        if (e->getType() == ELEMENT_STROKE) {
+            const auto* s = static_cast<const Stroke*>(e);
+            Kind kind = kindOf(s);
+            if (kind != NONE) {
+                if (!this->batch.empty() && (kind != this->kind || !haveSameStyle(s))) {
+                    flush();
+                }
+                this->kind = kind;
+                this->batch.push_back(s);
+                return;
+            }
+        }
+        flush();
+        ElementView::drawElement(e, this->ctx);
+    }
+
+    /**
+     * Draw the strokes of the current batch, must be called once all the elements are drawn
+     */
+    void flush() {
+        if (this->batch.size() == 1) {
+            ElementView::drawElement(this->batch.front(), this->ctx);
+        } else if (!this->batch.empty()) {
+            switch (this->kind) {
+                case HIGHLIGHTERS:
+                    StrokeView::drawHighlighterBatch(this->batch, this->ctx);
+                    break;
+                case PRESSURE:
+                    StrokeView::drawPressureBatch(this->batch, this->ctx);
+                    break;
+                default:
+                    StrokeView::drawBatch(this->batch, this->ctx);
+                    break;
+            }
+        }
+        this->batch.clear();
+    }
+
+private:
+    enum Kind { NONE, STROKES, PRESSURE, HIGHLIGHTERS };
+
+    Kind kindOf(const Stroke* s) const {
+        if (StrokeView::isBatchable(s, this->ctx)) {
+            return STROKES;
+        }
+        if (StrokeView::isPressureBatchable(s, this->ctx)) {
+            return PRESSURE;
+        }
+        return StrokeView::isHighlighterBatchable(s, this->ctx) ? HIGHLIGHTERS : NONE;
+    }
+
+    bool haveSameStyle(const Stroke* s) const {
+        switch (this->kind) {
+            case HIGHLIGHTERS:
+                return StrokeView::haveSameHighlighterStyle(this->batch.front(), s);
+            case PRESSURE:
+                return StrokeView::haveSamePressureStyle(this->batch.front(), s);
+            default:
+                return StrokeView::haveSameStyle(this->batch.front(), s);
+        }
+    }
+
+    const Context& ctx;
+    std::vector<const Stroke*> batch;
+
+    /**
+     * The kind of strokes in the batch
+     */
+    Kind kind = NONE;
+};
+}  // namespace
+
 LayerView::LayerView(const Layer* layer): layer(layer) {}
 
 void LayerView::draw(const Context& ctx, const Rectangle<double>& drawArea) const {
+    // Only the elements close to drawArea are returned by the spatial index
+    drawElements(layer->getElementsInArea(drawArea), ctx, drawArea);
+}
+
+void LayerView::drawElements(const std::vector<Element*>& elements, const Context& ctx,
+                             const Rectangle<double>& drawArea) {
 #ifdef DEBUG_SHOW_REPAINT_BOUNDS
     int drawn = 0;
     int notDrawn = 0;
 #endif  // DEBUG_SHOW_REPAINT_BOUNDS
-    for (Element* e: layer->getElements()) {
+    BatchedElementDrawer drawer(ctx);
+    for (Element* e: elements) {
+        if (ctx.isCancelled()) {
+            break;
+        }
 #ifdef DEBUG_SHOW_ELEMENT_BOUNDS
         auto cr = ctx.cr;
         cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
@@ -23,8 +122,7 @@ void LayerView::draw(const Context& ctx, const Rectangle<double>& drawArea) cons
 #endif  // DEBUG_SHOW_REPAINT_BOUNDS
 
         if (e->intersectsArea(drawArea.x, drawArea.y, drawArea.width, drawArea.height)) {
-            auto elementView = ElementView::createFromElement(e);
-            elementView->draw(ctx);
+            drawer.draw(e);
 #ifdef DEBUG_SHOW_REPAINT_BOUNDS
             drawn++;
 #endif  // DEBUG_SHOW_REPAINT_BOUNDS
@@ -35,13 +133,18 @@ void LayerView::draw(const Context& ctx, const Rectangle<double>& drawArea) cons
         }
 #endif  // DEBUG_SHOW_REPAINT_BOUNDS
     }
+    drawer.flush();
 #ifdef DEBUG_SHOW_REPAINT_BOUNDS
     g_message("DBG:DocumentView: draw %i / not draw %i", drawn, notDrawn);
 #endif  // DEBUG_SHOW_REPAINT_BOUNDS
 }
 
 void LayerView::draw(const Context& ctx) const {
+    BatchedElementDrawer drawer(ctx);
     for (Element* e: layer->getElements()) {
+        if (ctx.isCancelled()) {
+            break;
+        }
 #ifdef DEBUG_SHOW_ELEMENT_BOUNDS
         auto cr = ctx.cr;
         cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
@@ -50,7 +153,7 @@ void LayerView::draw(const Context& ctx) const {
         cairo_rectangle(cr, e->getX(), e->getY(), e->getElementWidth(), e->getElementHeight());
         cairo_stroke(cr);
 #endif  // DEBUG_SHOW_ELEMENT_BOUNDS
-        auto elementView = ElementView::createFromElement(e);
-        elementView->draw(ctx);
+        drawer.draw(e);
     }
+    drawer.flush();
 }
@@ -11,10 +11,13 @@
 
 #pragma once
 
+#include <vector>
+
 #include "util/Rectangle.h"
 
 #include "View.h"
 
+class Element;
 class Layer;
 
 class xoj::view::LayerView {
@@ -31,6 +34,12 @@ public:
      */
     void draw(const Context& ctx) const;
 
+    /**
+     * @brief Draws the elements of a layer (e.g. of a PageSnapshot) which intersect drawArea
+     */
+    static void drawElements(const std::vector<Element*>& elements, const Context& ctx,
+                             const xoj::util::Rectangle<double>& drawArea);
+
 private:
     const Layer* layer;
 };
@@ -8,11 +8,12 @@ PdfView::PdfView() = default;
 
 PdfView::~PdfView() = default;
 
-void PdfView::drawPage(PdfCache* cache, size_t pageNo, cairo_t* cr, double zoom, double width, double height) {
+void PdfView::drawPage(PdfCache* cache, size_t pageNo, cairo_t* cr, double zoom, double width, double height,
+                       bool draft) {
     if (cache) {
         cairo_set_source_rgb(cr, 1., 1., 1.);
         cairo_paint(cr);
-        cache->render(cr, pageNo, zoom, width, height);
+        cache->render(cr, pageNo, zoom, width, height, draft);
     } else {
         PdfCache::renderMissingPdfPage(cr, width, height);
     }
@@ -22,5 +22,9 @@ private:
     virtual ~PdfView();
 
 public:
-    static void drawPage(PdfCache* cache, size_t pageNo, cairo_t* cr, double zoom, double width, double height);
+    /**
+     * @param draft See PdfCache::render()
+     */
+    static void drawPage(PdfCache* cache, size_t pageNo, cairo_t* cr, double zoom, double width, double height,
+                         bool draft = false);
 };
@@ -0,0 +1,190 @@
+#include "PressureOutline.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace xoj::view;
+
+/**
+ * Distance of the control points of a bezier curve approximating a quarter circle, for a radius of 1
+ */
+constexpr double QUARTER_CIRCLE_KAPPA = 0.5522847498307936;
+
+PressureOutline::PressureOutline(const std::vector<Point>& points, double width, StrokeCapStyle cap): cap(cap) {
+    auto widthOf = [width](const Point& p) { return p.z != Point::NO_PRESSURE ? p.z : width; };
+
+    if (!points.empty()) {
+        this->x.push_back(points.front().x);
+        this->y.push_back(points.front().y);
+    }
+    for (size_t i = 1; i < points.size(); i++) {
+        // A segment of length 0 has no direction, the segments around it are joined instead
+        if (points[i].x != this->x.back() || points[i].y != this->y.back()) {
+            this->x.push_back(points[i].x);
+            this->y.push_back(points[i].y);
+            this->h.push_back(widthOf(points[i - 1]) / 2);
+        }
+    }
+
+    // The normals of all the segments in one branch free loop, which the compiler vectorizes
+    const size_t segments = this->h.size();
+    this->nx.resize(segments);
+    this->ny.resize(segments);
+    const double* px = this->x.data();
+    const double* py = this->y.data();
+    double* pnx = this->nx.data();
+    double* pny = this->ny.data();
+    for (size_t i = 0; i < segments; i++) {
+        const double dx = px[i + 1] - px[i];
+        const double dy = py[i + 1] - py[i];
+        const double inverseLength = 1 / std::sqrt(dx * dx + dy * dy);
+        pnx[i] = -dy * inverseLength;
+        pny[i] = dx * inverseLength;
+    }
+
+    // Two lines per segment and side, and room for the joins
+    this->data.reserve(16 * segments + 32);
+
+    if (segments > 0) {
+        side(true);
+        side(false);
+    } else if (!points.empty() && cap == StrokeCapStyle::ROUND) {
+        // All the points are at the same place: a dot
+        const double r = widthOf(points.front()) / 2;
+        moveTo(this->x[0] + r, this->y[0]);
+        capTo(this->x[0], this->y[0], r, 1, 0);
+        capTo(this->x[0], this->y[0], r, -1, 0);
+    }
+
+    if (!this->data.empty()) {
+        cairo_path_data_t close;
+        close.header.type = CAIRO_PATH_CLOSE_PATH;
+        close.header.length = 1;
+        this->data.push_back(close);
+    }
+
+    this->path.status = CAIRO_STATUS_SUCCESS;
+    this->path.data = this->data.data();
+    this->path.num_data = static_cast<int>(this->data.size());
+}
+
+auto PressureOutline::get() const -> const cairo_path_t* { return &this->path; }
+
+void PressureOutline::moveTo(double x, double y) {
+    cairo_path_data_t d[2];
+    d[0].header.type = CAIRO_PATH_MOVE_TO;
+    d[0].header.length = 2;
+    d[1].point.x = x;
+    d[1].point.y = y;
+    this->data.insert(this->data.end(), d, d + 2);
+}
+
+void PressureOutline::lineTo(double x, double y) {
+    cairo_path_data_t d[2];
+    d[0].header.type = CAIRO_PATH_LINE_TO;
+    d[0].header.length = 2;
+    d[1].point.x = x;
+    d[1].point.y = y;
+    this->data.insert(this->data.end(), d, d + 2);
+}
+
+void PressureOutline::curveTo(double x1, double y1, double x2, double y2, double x3, double y3) {
+    cairo_path_data_t d[4];
+    d[0].header.type = CAIRO_PATH_CURVE_TO;
+    d[0].header.length = 4;
+    d[1].point.x = x1;
+    d[1].point.y = y1;
+    d[2].point.x = x2;
+    d[2].point.y = y2;
+    d[3].point.x = x3;
+    d[3].point.y = y3;
+    this->data.insert(this->data.end(), d, d + 4);
+}
+
+void PressureOutline::arc(double cx, double cy, double r, double ax, double ay, double bx, double by) {
+    // 4/3 tan(angle / 4), with tan(angle / 2) = sin / (1 + cos)
+    const double cos = ax * bx + ay * by;
+    const double sin = std::abs(ax * by - ay * bx);
+    const double k = 4.0 / 3.0 * sin / (1 + cos + std::sqrt(2 * (1 + cos)));
+    curveTo(cx + r * (ax + k * ay), cy + r * (ay - k * ax), cx + r * (bx - k * by), cy + r * (by + k * bx), cx + r * bx,
+            cy + r * by);
+}
+
+void PressureOutline::join(double cx, double cy, double r, double ax, double ay, double bx, double by) {
+    // Split at the middle, each half is at most 90 degrees
+    double mx = ax + bx;
+    double my = ay + by;
+    const double length = std::sqrt(mx * mx + my * my);
+    if (length < 1e-9) {
+        // The stroke turns back: the join goes around the front
+        mx = ay;
+        my = -ax;
+    } else {
+        mx /= length;
+        my /= length;
+    }
+    arc(cx, cy, r, ax, ay, mx, my);
+    arc(cx, cy, r, mx, my, bx, by);
+}
+
+void PressureOutline::capTo(double cx, double cy, double h, double nx, double ny) {
+    // Direction of the stroke at its end
+    const double dx = ny;
+    const double dy = -nx;
+
+    switch (this->cap) {
+        case StrokeCapStyle::ROUND: {
+            const double k = QUARTER_CIRCLE_KAPPA * h;
+            curveTo(cx + h * nx + k * dx, cy + h * ny + k * dy, cx + h * dx + k * nx, cy + h * dy + k * ny, cx + h * dx,
+                    cy + h * dy);
+            curveTo(cx + h * dx - k * nx, cy + h * dy - k * ny, cx - h * nx + k * dx, cy - h * ny + k * dy, cx - h * nx,
+                    cy - h * ny);
+            break;
+        }
+        case StrokeCapStyle::SQUARE:
+            lineTo(cx + h * (nx + dx), cy + h * (ny + dy));
+            lineTo(cx + h * (dx - nx), cy + h * (dy - ny));
+            break;
+        case StrokeCapStyle::BUTT:
+            // The other side starts right across
+            break;
+    }
+}
+
+void PressureOutline::side(bool forward) {
+    const size_t segments = this->h.size();
+    const double sign = forward ? 1 : -1;
+
+    for (size_t k = 0; k < segments; k++) {
+        const size_t i = forward ? k : segments - 1 - k;
+        const size_t start = forward ? i : i + 1;
+        const size_t end = forward ? i + 1 : i;
+        const double ax = sign * this->nx[i];
+        const double ay = sign * this->ny[i];
+        const double hi = this->h[i];
+
+        if (forward && k == 0) {
+            moveTo(this->x[start] + hi * ax, this->y[start] + hi * ay);
+        } else {
+            lineTo(this->x[start] + hi * ax, this->y[start] + hi * ay);
+        }
+        lineTo(this->x[end] + hi * ax, this->y[end] + hi * ay);
+
+        if (k + 1 == segments) {
+            capTo(this->x[end], this->y[end], hi, ax, ay);
+            break;
+        }
+
+        const size_t j = forward ? i + 1 : i - 1;
+        const double bx = sign * this->nx[j];
+        const double by = sign * this->ny[j];
+        // The side is the outer one if it turns like the arcs, otherwise it overlaps the stroke
+        if (ax * by - ay * bx < 0) {
+            const double r = std::max(hi, this->h[j]);
+            if (r > hi) {
+                lineTo(this->x[end] + r * ax, this->y[end] + r * ay);
+            }
+            join(this->x[end], this->y[end], r, ax, ay, bx, by);
+        }
+    }
+}
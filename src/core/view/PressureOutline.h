@@ -0,0 +1,93 @@
+/*
+ * Xournal++
+ *
+ * The outline of a stroke with pressure
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <cairo.h>
+
+#include "model/Point.h"
+#include "model/Stroke.h"
+
+namespace xoj {
+namespace view {
+
+/**
+ * @brief The variable width outline of a stroke, filled at once instead of stroking each segment on its own
+ *
+ * Each segment has the width of its first point, like the segments drawn by StrokeView::drawWithPressure(). The
+ * outline goes along one side of the stroke, around the cap of its last point, back along the other side and around
+ * the cap of its first point. The outer sides of the joins are round, the inner sides overlap the stroke.
+ *
+ * The outline crosses itself where the stroke does: it has to be filled with CAIRO_FILL_RULE_WINDING.
+ */
+class PressureOutline {
+public:
+    /**
+     * @param points The points of the stroke
+     * @param width The width of the points without pressure
+     * @param cap The cap of the ends of the stroke
+     */
+    PressureOutline(const std::vector<Point>& points, double width, StrokeCapStyle cap);
+
+public:
+    const cairo_path_t* get() const;
+
+private:
+    void moveTo(double x, double y);
+    void lineTo(double x, double y);
+    void curveTo(double x1, double y1, double x2, double y2, double x3, double y3);
+
+    /**
+     * Arc of at most 90 degrees, turning from a towards (a.y, -a.x), like all the arcs of the outline
+     * @param a, b The unit vectors from the center to both ends of the arc
+     */
+    void arc(double cx, double cy, double r, double ax, double ay, double bx, double by);
+
+    /**
+     * Round join at the outer side of a join, of at most 180 degrees
+     */
+    void join(double cx, double cy, double r, double ax, double ay, double bx, double by);
+
+    /**
+     * Cap from the current side of the stroke to the other one
+     * @param n The unit normal of the current side
+     */
+    void capTo(double cx, double cy, double h, double nx, double ny);
+
+    /**
+     * One side of the stroke
+     * @param forward true for the side along the points, false for the one back
+     */
+    void side(bool forward);
+
+private:
+    StrokeCapStyle cap;
+
+    /**
+     * The points without consecutive duplicates, segment i goes from point i to point i + 1
+     */
+    std::vector<double> x;
+    std::vector<double> y;
+
+    /**
+     * For each segment: its unit normal (-dy, dx) and half of its width
+     */
+    std::vector<double> nx;
+    std::vector<double> ny;
+    std::vector<double> h;
+
+    std::vector<cairo_path_data_t> data;
+    cairo_path_t path{};
+};
+};  // namespace view
+};  // namespace xoj
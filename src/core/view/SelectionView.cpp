@@ -8,8 +8,5 @@ using namespace xoj::view;
 SelectionView::SelectionView(const ElementContainer* container): container(container) {}
 
 void SelectionView::draw(const Context& ctx) const {
-    for (Element* e: container->getElements()) {
-        auto elementView = ElementView::createFromElement(e);
-        elementView->draw(ctx);
-    }
+    for (Element* e: container->getElements()) { ElementView::drawElement(e, ctx); }
 }
@@ -70,9 +70,12 @@ auto SetsquareView::getPage() const -> PageRef { return view->getPage(); }
 
 auto SetsquareView::posRelToSide(Leg leg, double x, double y) const -> utl::Point<double> {
     cairo_matrix_t matrix{};
-    s->getMatrix(matrix);
-    cairo_matrix_invert(&matrix);
+    s->getInverseMatrix(matrix);
     cairo_matrix_transform_point(&matrix, &x, &y);
+    return userPosRelToSide(leg, x, y);
+}
+
+auto SetsquareView::userPosRelToSide(Leg leg, double x, double y) const -> utl::Point<double> {
     switch (leg) {
         case HYPOTENUSE:
             return utl::Point<double>(x, -y);
@@ -86,8 +89,12 @@ auto SetsquareView::posRelToSide(Leg leg, double x, double y) const -> utl::Poin
 }
 
 auto SetsquareView::isInsideSetsquare(double x, double y, double border) const -> bool {
-    return posRelToSide(HYPOTENUSE, x, y).y < border && posRelToSide(LEFT_LEG, x, y).y < border &&
-           posRelToSide(RIGHT_LEG, x, y).y < border;
+    // Transformed once for the three sides
+    cairo_matrix_t matrix{};
+    s->getInverseMatrix(matrix);
+    cairo_matrix_transform_point(&matrix, &x, &y);
+    return userPosRelToSide(HYPOTENUSE, x, y).y < border && userPosRelToSide(LEFT_LEG, x, y).y < border &&
+           userPosRelToSide(RIGHT_LEG, x, y).y < border;
 }
 
 auto SetsquareView::getPointForPos(double xCoord) const -> utl::Point<double> {
@@ -169,6 +169,11 @@ public:
     bool existsRadius();
 
 private:
+    /**
+     * @brief as posRelToSide(), for a point in the coordinates of the setsquare (see Setsquare::getMatrix())
+     */
+    utl::Point<double> userPosRelToSide(Leg leg, double x, double y) const;
+
     /**
      * @brief draws the temporary stroke at the longest side of the setsquare to a cairo context
      * @param cr the cairo context drawn to
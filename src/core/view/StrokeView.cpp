@@ -1,29 +1,108 @@
 #include "StrokeView.h"
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 #include "model/Stroke.h"
 #include "model/eraser/ErasableStroke.h"
-#include "util/LoopUtil.h"
+#include "util/SurfacePool.h"
 
 #include "DocumentView.h"
 #include "ErasableStrokeView.h"
+#include "PressureOutline.h"
 
 using xoj::util::Rectangle;
 using namespace xoj::view;
 
 StrokeView::StrokeView(const Stroke* s): s(s) {}
 
-void StrokeView::pathToCairo(cairo_t* cr) const {
-    for_first_then_each(
-            s->getPointVector(), [cr](auto const& first) { cairo_move_to(cr, first.x, first.y); },
-            [cr](auto const& other) { cairo_line_to(cr, other.x, other.y); });
+/**
+ * The loops over the points are specialized for the strokes drawn with all their points and for those drawn with a
+ * level of detail: the choice is made once per stroke, not for each point.
+ */
+template <bool Detailed>
+static inline auto isDrawn(const StrokeDetail* detail, size_t index, double tolerance) -> bool {
+    if constexpr (Detailed) {
+        return detail->keeps(index, tolerance);
+    } else {
+        return true;
+    }
+}
+
+template <bool Detailed>
+static void linesToCairo(cairo_t* cr, const std::vector<Point>& points, const StrokeDetail* detail, double tolerance) {
+    cairo_move_to(cr, points.front().x, points.front().y);
+    for (size_t i = 1; i < points.size(); i++) {
+        if (isDrawn<Detailed>(detail, i, tolerance)) {
+            cairo_line_to(cr, points[i].x, points[i].y);
+        }
+    }
+}
+
+/**
+ * Each segment between two drawn points has the pressure of its first point, the dashes continue along the stroke
+ */
+template <bool Detailed>
+static void drawDashedSegments(cairo_t* cr, const std::vector<Point>& points, const StrokeDetail* detail,
+                               double tolerance, double width, const double* dashes, int dashCount) {
+    double dashOffset = 0;
+    size_t last = 0;
+    for (size_t i = 1; i < points.size(); i++) {
+        if (!isDrawn<Detailed>(detail, i, tolerance)) {
+            continue;
+        }
+        const Point& p1 = points[last];
+        const Point& p2 = points[i];
+        last = i;
+
+        const double offset = dashOffset;
+        const double length = p1.lineLengthTo(p2);
+        dashOffset += length;
+        if (StrokeView::isInDashGap(dashes, dashCount, offset, length)) {
+            // The segments of the stroke are often shorter than the gaps
+            continue;
+        }
+        cairo_set_dash(cr, dashes, dashCount, offset);
+        cairo_set_line_width(cr, p1.z != Point::NO_PRESSURE ? p1.z : width);
+        cairo_move_to(cr, p1.x, p1.y);
+        cairo_line_to(cr, p2.x, p2.y);
+        cairo_stroke(cr);
+    }
+}
+
+auto StrokeView::getDetail(double tolerance) const -> std::shared_ptr<const StrokeDetail> {
+    if (tolerance <= 0 || s->getPointCount() < MIN_POINTS_FOR_DETAIL) {
+        return nullptr;
+    }
+    return s->getDetail();
+}
+
+void StrokeView::pathToCairo(cairo_t* cr, double tolerance) const {
+    if (auto detail = getDetail(tolerance)) {
+        if (s->getFill() != -1) {
+            // Filled shapes are often large, and go through the path twice: keep their simplified path
+            if (auto path = s->getSimplifiedCairoPath(tolerance)) {
+                cairo_append_path(cr, path->get());
+                return;
+            }
+        }
+        linesToCairo<true>(cr, s->getPointVector(), detail.get(), tolerance);
+        return;
+    }
+
+    if (auto path = s->getCairoPath()) {
+        cairo_append_path(cr, path->get());
+        return;
+    }
+
+    linesToCairo<false>(cr, s->getPointVector(), nullptr, tolerance);
 }
 
 /**
  * No pressure sensitivity, one line is drawn
  */
-void StrokeView::drawNoPressure(cairo_t* cr) const {
+void StrokeView::drawNoPressure(cairo_t* cr, double tolerance) const {
     cairo_set_line_width(cr, s->getWidth());
 
     const double* dashes = nullptr;
@@ -32,32 +111,197 @@ void StrokeView::drawNoPressure(cairo_t* cr) const {
     assert((dashCount == 0 && dashes == nullptr) || (dashCount != 0 && dashes != nullptr));
     cairo_set_dash(cr, dashes, dashCount, 0);
 
-    pathToCairo(cr);
+    pathToCairo(cr, tolerance);
     cairo_stroke(cr);
 }
 
+auto StrokeView::isInDashGap(const double* dashes, int dashCount, double offset, double length) -> bool {
+    // Like cairo, an odd number of dashes is repeated for the dashes and gaps to alternate
+    const int entries = dashCount % 2 ? 2 * dashCount : dashCount;
+    double period = 0;
+    for (int i = 0; i < entries; i++) { period += dashes[i % dashCount]; }
+    if (!(period > 0)) {
+        return false;
+    }
+
+    const double pos = std::fmod(offset, period);
+    double start = 0;
+    for (int i = 0; i < entries; i++) {
+        const double end = start + dashes[i % dashCount];
+        if (pos < end) {
+            return i % 2 == 1 && pos > start && pos + length < end;
+        }
+        start = end;
+    }
+    return false;
+}
+
 /**
  * Draw a stroke with pressure, for this multiple lines with different widths needs to be drawn
  */
-void StrokeView::drawWithPressure(cairo_t* cr) const {
-    double dashOffset = 0;
+void StrokeView::drawWithPressure(cairo_t* cr, double tolerance) const {
     const double* dashes = nullptr;
     int dashCount = 0;
     s->getLineStyle().getDashes(dashes, dashCount);
     assert((dashCount == 0 && dashes == nullptr) || (dashCount != 0 && dashes != nullptr));
 
-    for (auto p1i = begin(s->getPointVector()), p2i = std::next(p1i), endi = end(s->getPointVector());
-         p1i != endi && p2i != endi; ++p1i, ++p2i) {
-        auto width = p1i->z != Point::NO_PRESSURE ? p1i->z : s->getWidth();
-        cairo_set_line_width(cr, width);
-        if (dashes) {
-            cairo_set_dash(cr, dashes, dashCount, dashOffset);
-            dashOffset += p1i->lineLengthTo(*p2i);
+    const auto& points = s->getPointVector();
+    auto detail = getDetail(tolerance);
+
+    if (dashes) {
+        if (detail) {
+            drawDashedSegments<true>(cr, points, detail.get(), tolerance, s->getWidth(), dashes, dashCount);
+        } else {
+            drawDashedSegments<false>(cr, points, nullptr, tolerance, s->getWidth(), dashes, dashCount);
         }
-        cairo_move_to(cr, p1i->x, p1i->y);
-        cairo_line_to(cr, p2i->x, p2i->y);
-        cairo_stroke(cr);
+        return;
+    }
+
+    // The whole stroke is filled at once
+    cairo_set_fill_rule(cr, CAIRO_FILL_RULE_WINDING);
+    pressureOutlineToCairo(cr, tolerance);
+    cairo_fill(cr);
+}
+
+void StrokeView::pressureOutlineToCairo(cairo_t* cr, double tolerance) const {
+    const auto& points = s->getPointVector();
+    auto detail = getDetail(tolerance);
+
+    std::vector<Point> kept;
+    if (detail) {
+        for (size_t i = 0; i < points.size(); i++) {
+            if (isDrawn<true>(detail.get(), i, tolerance)) {
+                kept.push_back(points[i]);
+            }
+        }
+    }
+    PressureOutline outline(detail ? kept : points, s->getWidth(), s->getStrokeCapStyle());
+    cairo_append_path(cr, outline.get());
+}
+
+auto StrokeView::isBatchable(const Stroke* s, const Context& ctx) -> bool {
+    return s->getPointCount() >= 2 && s->getToolType() != STROKE_TOOL_HIGHLIGHTER && !s->hasPressure() &&
+           s->getFill() == -1 && !(ctx.fadeOutNonAudio && s->getAudioFilename().empty()) &&
+           !(ctx.showCurrentEdition && s->getErasable() != nullptr);
+}
+
+auto StrokeView::haveSameStyle(const Stroke* s1, const Stroke* s2) -> bool {
+    if (s1->getColor() != s2->getColor() || s1->getWidth() != s2->getWidth() ||
+        s1->getStrokeCapStyle() != s2->getStrokeCapStyle()) {
+        return false;
+    }
+
+    const double* dashes1 = nullptr;
+    const double* dashes2 = nullptr;
+    int count1 = 0;
+    int count2 = 0;
+    s1->getLineStyle().getDashes(dashes1, count1);
+    s2->getLineStyle().getDashes(dashes2, count2);
+    return count1 == count2 && std::equal(dashes1, dashes1 + count1, dashes2);
+}
+
+void StrokeView::drawBatch(const std::vector<const Stroke*>& strokes, const Context& ctx) {
+    assert(!strokes.empty());
+    const Stroke* first = strokes.front();
+    cairo_t* cr = ctx.cr;
+
+    cairo_save(cr);
+
+    cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
+    cairo_set_line_cap(cr, CAIRO_LINE_CAP[first->getStrokeCapStyle()]);
+    if (ctx.noColor) {
+        cairo_set_source_rgba(cr, 1, 1, 1, 1);
+    } else {
+        Util::cairo_set_source_rgbi(cr, first->getColor());
+    }
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_line_width(cr, first->getWidth());
+
+    const double* dashes = nullptr;
+    int dashCount = 0;
+    first->getLineStyle().getDashes(dashes, dashCount);
+    // The dashes start again at each sub path, like for strokes drawn on their own
+    cairo_set_dash(cr, dashes, dashCount, 0);
+
+    for (const Stroke* s: strokes) { StrokeView(s).pathToCairo(cr, ctx.detailTolerance); }
+    cairo_stroke(cr);
+
+    cairo_restore(cr);
+}
+
+auto StrokeView::isHighlighterBatchable(const Stroke* s, const Context& ctx) -> bool {
+    return s->getPointCount() >= 2 && s->getToolType() == STROKE_TOOL_HIGHLIGHTER && !ctx.noColor &&
+           !(ctx.fadeOutNonAudio && s->getAudioFilename().empty()) &&
+           !(ctx.showCurrentEdition && s->getErasable() != nullptr);
+}
+
+auto StrokeView::haveSameHighlighterStyle(const Stroke* s1, const Stroke* s2) -> bool {
+    return s1->getColor() == s2->getColor() && s1->getFill() == s2->getFill();
+}
+
+void StrokeView::drawHighlighterBatch(const std::vector<const Stroke*>& strokes, const Context& ctx) {
+    assert(!strokes.empty());
+    const Stroke* first = strokes.front();
+    cairo_t* cr = ctx.cr;
+
+    cairo_save(cr);
+
+    // The group is clipped like the target: the mask only covers the area being drawn
+    cairo_push_group_with_content(cr, CAIRO_CONTENT_ALPHA);
+    cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
+    cairo_set_source_rgba(cr, 1, 1, 1, 1);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    for (const Stroke* s: strokes) {
+        StrokeView view(s);
+        cairo_set_line_cap(cr, CAIRO_LINE_CAP[s->getStrokeCapStyle()]);
+        if (s->getFill() != -1) {
+            view.pathToCairo(cr, ctx.detailTolerance);
+            cairo_fill(cr);
+        }
+        // The highlighter ignores the pressure
+        view.drawNoPressure(cr, ctx.detailTolerance);
     }
+    cairo_pattern_t* mask = cairo_pop_group(cr);
+
+    // Same opacities as the mask of draw()
+    double alpha = first->getFill() != -1 ? static_cast<double>(first->getFill()) / 255.0 : OPACITY_HIGHLIGHTER;
+    Util::cairo_set_source_rgbi(cr, first->getColor(), alpha);
+    cairo_set_operator(cr, CAIRO_OPERATOR_MULTIPLY);
+    cairo_mask(cr, mask);
+    cairo_pattern_destroy(mask);
+
+    cairo_restore(cr);
+}
+
+auto StrokeView::isPressureBatchable(const Stroke* s, const Context& ctx) -> bool {
+    return s->getPointCount() >= 2 && s->getToolType() != STROKE_TOOL_HIGHLIGHTER && s->hasPressure() &&
+           s->getFill() == -1 && !s->getLineStyle().hasDashes() &&
+           !(ctx.fadeOutNonAudio && s->getAudioFilename().empty()) &&
+           !(ctx.showCurrentEdition && s->getErasable() != nullptr);
+}
+
+auto StrokeView::haveSamePressureStyle(const Stroke* s1, const Stroke* s2) -> bool {
+    return s1->getColor() == s2->getColor();
+}
+
+void StrokeView::drawPressureBatch(const std::vector<const Stroke*>& strokes, const Context& ctx) {
+    assert(!strokes.empty());
+    cairo_t* cr = ctx.cr;
+
+    cairo_save(cr);
+
+    if (ctx.noColor) {
+        cairo_set_source_rgba(cr, 1, 1, 1, 1);
+    } else {
+        Util::cairo_set_source_rgbi(cr, strokes.front()->getColor());
+    }
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_fill_rule(cr, CAIRO_FILL_RULE_WINDING);
+
+    for (const Stroke* s: strokes) { StrokeView(s).pressureOutlineToCairo(cr, ctx.detailTolerance); }
+    cairo_fill(cr);
+
+    cairo_restore(cr);
 }
 
 void StrokeView::draw(const Context& ctx) const {
@@ -73,9 +317,9 @@ void StrokeView::draw(const Context& ctx) const {
     const bool drawTranslucent = ctx.fadeOutNonAudio && s->getAudioFilename().empty();
     const bool useMask = (!ctx.noColor && filledHighlighter) || drawTranslucent;
 
-    if (ctx.showCurrentEdition && filledHighlighter && s->getErasable() != nullptr) {
+    if (auto erasable = s->getErasable(); ctx.showCurrentEdition && filledHighlighter && erasable) {
         // Currently being erased filled highlighter strokes need a special treatment
-        ErasableStrokeView erasableStrokeView(*s->getErasable());
+        ErasableStrokeView erasableStrokeView(*erasable);
         erasableStrokeView.paintFilledHighlighter(ctx.cr);
         return;
     }
@@ -113,7 +357,7 @@ void StrokeView::draw(const Context& ctx) const {
         const int width = static_cast<int>(std::ceil(box.width * matrix.xx));
         const int height = static_cast<int>(std::ceil(box.height * matrix.yy));
 
-        surfMask = cairo_image_surface_create(CAIRO_FORMAT_A8, width, height);
+        surfMask = xoj::util::SurfacePool::createSurface(CAIRO_FORMAT_A8, width, height);
 
         // Apply offset and scaling
         cairo_surface_set_device_offset(surfMask, -box.x * matrix.xx, -box.y * matrix.yy);
@@ -147,12 +391,12 @@ void StrokeView::draw(const Context& ctx) const {
         }
         cairo_set_operator(cr, useMask ? CAIRO_OPERATOR_SOURCE : CAIRO_OPERATOR_OVER);
 
-        if (ErasableStroke* erasable = s->getErasable(); erasable != nullptr && ctx.showCurrentEdition) {
+        if (auto erasable = s->getErasable(); erasable != nullptr && ctx.showCurrentEdition) {
             // don't render erasable for previews
             ErasableStrokeView erasableStrokeView(*erasable);
             erasableStrokeView.drawFilling(cr);
         } else {
-            pathToCairo(cr);
+            pathToCairo(cr, ctx.detailTolerance);
             cairo_fill(cr);
         }
     }
@@ -180,14 +424,14 @@ void StrokeView::draw(const Context& ctx) const {
         cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
     }
 
-    if (ErasableStroke* erasable = s->getErasable(); erasable != nullptr && ctx.showCurrentEdition) {
+    if (auto erasable = s->getErasable(); erasable != nullptr && ctx.showCurrentEdition) {
         // don't render erasable for previews
         ErasableStrokeView erasableStrokeView(*erasable);
         erasableStrokeView.draw(cr);
     } else if (s->hasPressure() && !highlighter) {
-        drawWithPressure(cr);
+        drawWithPressure(cr, ctx.detailTolerance);
     } else {
-        drawNoPressure(cr);
+        drawNoPressure(cr, ctx.detailTolerance);
     }
 
     if (useMask) {
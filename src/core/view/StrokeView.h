@@ -12,10 +12,13 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <vector>
 
 #include "View.h"
 
 class Stroke;
+class StrokeDetail;
 
 class xoj::view::StrokeView: public xoj::view::ElementView {
 public:
@@ -32,19 +35,89 @@ public:
      */
     void draw(const Context& ctx) const override;
 
+    /**
+     * @return true if the stroke can be drawn together with other strokes of the same style, by drawBatch(): an opaque
+     * stroke without pressure, filling or mask
+     */
+    static bool isBatchable(const Stroke* s, const Context& ctx);
+
+    /**
+     * @return true if two batchable strokes are drawn with the same color, width, cap and dashes
+     */
+    static bool haveSameStyle(const Stroke* s1, const Stroke* s2);
+
+    /**
+     * @brief Draw batchable strokes of the same style with a single cairo_stroke(). The strokes are opaque: drawing
+     * them together looks like drawing them one after the other.
+     */
+    static void drawBatch(const std::vector<const Stroke*>& strokes, const Context& ctx);
+
+    /**
+     * @return true if the stroke can be drawn together with other highlighter strokes of the same color, by
+     * drawHighlighterBatch(): a highlighter stroke, neither faded out nor being erased
+     */
+    static bool isHighlighterBatchable(const Stroke* s, const Context& ctx);
+
+    /**
+     * @return true if two highlighter strokes are composited with the same color and opacity
+     */
+    static bool haveSameHighlighterStyle(const Stroke* s1, const Stroke* s2);
+
+    /**
+     * @brief Draw batchable highlighter strokes of the same color on a single alpha mask, composited once. Where the
+     * strokes overlap, the page is not darker than under a single stroke.
+     */
+    static void drawHighlighterBatch(const std::vector<const Stroke*>& strokes, const Context& ctx);
+
+    /**
+     * @return true if the stroke can be drawn together with other pressure sensitive strokes of the same color, by
+     * drawPressureBatch(): an opaque stroke with pressure, without dashes, filling or mask
+     */
+    static bool isPressureBatchable(const Stroke* s, const Context& ctx);
+
+    /**
+     * @return true if two pressure sensitive strokes are filled with the same color
+     */
+    static bool haveSamePressureStyle(const Stroke* s1, const Stroke* s2);
+
+    /**
+     * @brief Fill the outlines of pressure sensitive strokes of the same color with a single cairo_fill(). All the
+     * outlines turn the same way (see PressureOutline): where they overlap, the winding rule fills them like one.
+     */
+    static void drawPressureBatch(const std::vector<const Stroke*>& strokes, const Context& ctx);
+
+    /**
+     * @return true if the part of a dashed line from the offset, of the length, is strictly inside a gap between two
+     * dashes: drawing it paints nothing
+     */
+    static bool isInDashGap(const double* dashes, int dashCount, double offset, double length);
+
 private:
-    inline void pathToCairo(cairo_t* cr) const;
+    /**
+     * @param tolerance See Context::detailTolerance
+     */
+    inline void pathToCairo(cairo_t* cr, double tolerance) const;
 
     /**
      * No pressure sensitivity, one line is drawn
      */
-    void drawNoPressure(cairo_t* cr) const;
+    void drawNoPressure(cairo_t* cr, double tolerance) const;
+
+    /**
+     * Draw a stroke with pressure: its outline is filled (see PressureOutline), or with dashes each segment is drawn
+     * with its own width
+     */
+    void drawWithPressure(cairo_t* cr, double tolerance) const;
+
+    /**
+     * Append the variable width outline of a stroke with pressure and without dashes to the path
+     */
+    void pressureOutlineToCairo(cairo_t* cr, double tolerance) const;
 
     /**
-     * Draw a stroke with pressure, for this multiple
-     * lines with different widths needs to be drawn
+     * @return The levels of detail to draw the stroke with, or nullptr to draw all the points
      */
-    void drawWithPressure(cairo_t* cr) const;
+    std::shared_ptr<const StrokeDetail> getDetail(double tolerance) const;
 
 private:
     const Stroke* s;
@@ -53,6 +126,11 @@ public:
     static constexpr double OPACITY_HIGHLIGHTER = 0.47;
     static constexpr double MINIMAL_ALPHA = 0.04;
 
+    /**
+     * Shorter strokes are always drawn with all their points
+     */
+    static constexpr int MIN_POINTS_FOR_DETAIL = 32;
+
     //  Must match the enum StrokeCapStyle in Stroke.h
     static constexpr cairo_line_cap_t CAIRO_LINE_CAP[] = {CAIRO_LINE_CAP_ROUND, CAIRO_LINE_CAP_BUTT,
                                                           CAIRO_LINE_CAP_SQUARE};
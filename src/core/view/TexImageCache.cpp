@@ -0,0 +1,118 @@
+#include "TexImageCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <poppler.h>
+
+#include "model/TexImage.h"
+#include "util/Profiler.h"
+
+using namespace xoj::view;
+
+/**
+ * Rasterizations not smaller than 1/8 of a device pixel per point, nor larger than 16
+ */
+constexpr int MIN_BUCKET = -3;
+constexpr int MAX_BUCKET = 4;
+
+TexImageCache::TexImageCache(size_t maxBytes): maxBytes(maxBytes) {}
+
+TexImageCache::~TexImageCache() { clear(); }
+
+auto TexImageCache::getInstance() -> TexImageCache& {
+    static TexImageCache instance;
+    return instance;
+}
+
+auto TexImageCache::bucketFor(double scale) -> int {
+    int bucket = static_cast<int>(std::ceil(std::log2(std::max(scale, 1e-3)) - 1e-9));
+    return std::clamp(bucket, MIN_BUCKET, MAX_BUCKET);
+}
+
+auto TexImageCache::bucketZoom(int bucket) -> double { return std::ldexp(1.0, bucket); }
+
+auto TexImageCache::get(const TexImage* image, double scale) -> cairo_surface_t* {
+    if (!image->hasPdf()) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    const Key key{image->getRenderId(), bucketFor(scale)};
+    if (auto it = this->index.find(key); it != this->index.end()) {
+        this->entries.splice(this->entries.begin(), this->entries, it->second);
+        xoj::util::Profiler::getInstance().countAccess("TeX images", true);
+        return cairo_surface_reference(it->second->surface);
+    }
+    xoj::util::Profiler::getInstance().countAccess("TeX images", false);
+
+    double pageWidth = 0;
+    double pageHeight = 0;
+    if (!image->getPdfPageSize(pageWidth, pageHeight)) {
+        return nullptr;
+    }
+
+    const double zoom = bucketZoom(key.second);
+    const int width = std::max(static_cast<int>(std::ceil(pageWidth * zoom)), 1);
+    const int height = std::max(static_cast<int>(std::ceil(pageHeight * zoom)), 1);
+    const size_t size = static_cast<size_t>(cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width)) *
+                        static_cast<size_t>(height);
+    if (width > MAX_SIZE || height > MAX_SIZE || size > this->maxBytes) {
+        return nullptr;
+    }
+
+    PopplerDocument* pdf = image->openPdf();
+    if (!pdf) {
+        return nullptr;
+    }
+    PopplerPage* page = poppler_document_get_page(pdf, 0);
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_surface_set_device_scale(surface, zoom, zoom);
+    cairo_t* cr = cairo_create(surface);
+    poppler_page_render(page, cr);
+    cairo_destroy(cr);
+    g_object_unref(page);
+    g_object_unref(pdf);
+
+    // The rasterization is drawn from now on: only the binary data of the image is kept
+    image->releasePdf();
+
+    this->entries.push_front({key, surface, size});
+    this->index.emplace(key, this->entries.begin());
+    this->bytes += size;
+
+    trim();
+
+    return cairo_surface_reference(surface);
+}
+
+void TexImageCache::setMaxBytes(size_t newMaxBytes) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->maxBytes = newMaxBytes;
+    trim();
+}
+
+void TexImageCache::clear() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    while (!this->entries.empty()) {
+        erase(this->entries.begin());
+    }
+}
+
+auto TexImageCache::getBytes() const -> size_t {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->bytes;
+}
+
+void TexImageCache::erase(std::list<Entry>::iterator it) {
+    this->bytes -= it->bytes;
+    cairo_surface_destroy(it->surface);
+    this->index.erase(it->key);
+    this->entries.erase(it);
+}
+
+void TexImageCache::trim() {
+    while (this->bytes > this->maxBytes && !this->entries.empty()) {
+        erase(std::prev(this->entries.end()));
+    }
+}
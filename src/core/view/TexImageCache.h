@@ -0,0 +1,119 @@
+/*
+ * Xournal++
+ *
+ * Cache of the rasterized TeX images
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include <cairo.h>
+
+class TexImage;
+
+namespace xoj {
+namespace view {
+
+/**
+ * @brief Rasterizations of the PDF of the TeX images, for the drawings on the screen
+ *
+ * The PDF is rasterized at zoom levels which are powers of 2 ("buckets"), so that zooming reuses the rasterizations
+ * and scrolling only paints them. The vector source is still used for the export and the printing, see TexImageView.
+ *
+ * The rasterizations are keyed by (TexImage::getRenderId(), bucket), so the clones of an image share them, and kept
+ * in least recently used order up to a memory budget, like the ones of PdfCache. Those of the deleted images are
+ * evicted in turn.
+ *
+ * Once an image is rasterized, its parsed PDF is released (see TexImage::releasePdf()): it is parsed again from its
+ * binary data only for another bucket, or for the vector targets.
+ *
+ * Process wide, as the elements are moved between the documents. Thread safe.
+ */
+class TexImageCache {
+public:
+    explicit TexImageCache(size_t maxBytes = MAX_BYTES);
+    ~TexImageCache();
+
+    TexImageCache(const TexImageCache&) = delete;
+    TexImageCache& operator=(const TexImageCache&) = delete;
+
+    static TexImageCache& getInstance();
+
+public:
+    /**
+     * @param scale The number of device pixels per point of the PDF of the image
+     * @return A new reference to the rasterization of the PDF, whose device scale maps it to the points of the PDF, or
+     *         nullptr if the image has no PDF or if its rasterization would not fit in the budget
+     */
+    cairo_surface_t* get(const TexImage* image, double scale);
+
+    /**
+     * @brief Set the memory budget of the cache, in bytes
+     */
+    void setMaxBytes(size_t newMaxBytes);
+
+    void clear();
+
+    /**
+     * @return The number of bytes of the rasterizations
+     */
+    size_t getBytes() const;
+
+    static constexpr size_t MAX_BYTES = 32U << 20U;
+
+    /**
+     * Largest rasterized side, in pixels: larger images are drawn from their vector source
+     */
+    static constexpr int MAX_SIZE = 4096;
+
+private:
+    using Key = std::pair<uint64_t, int>;
+
+    struct Entry {
+        Key key;
+        cairo_surface_t* surface;
+        size_t bytes;
+    };
+
+    /**
+     * @return The bucket of the zoom level, see bucketZoom()
+     */
+    static int bucketFor(double scale);
+    static double bucketZoom(int bucket);
+
+    void erase(std::list<Entry>::iterator it);
+
+    /**
+     * Drop the least recently used rasterizations over the budget. Must be called with the lock held.
+     */
+    void trim();
+
+private:
+    size_t maxBytes;
+    size_t bytes = 0;
+
+    /**
+     * The most recently used first
+     */
+    std::list<Entry> entries;
+    std::map<Key, std::list<Entry>::iterator> index;
+
+    /**
+     * Also held while rasterizing, so that an image is rasterized once for each bucket
+     */
+    mutable std::mutex mutex;
+};
+
+};  // namespace view
+};  // namespace xoj
@@ -1,7 +1,12 @@
 #include "TexImageView.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "model/TexImage.h"
 
+#include "TexImageCache.h"
+
 using namespace xoj::view;
 
 TexImageView::TexImageView(const TexImage* texImage): texImage(texImage) {}
@@ -13,20 +18,15 @@ void TexImageView::draw(const Context& ctx) const {
     cairo_t* cr = ctx.cr;
     cairo_save(cr);
 
-    PopplerDocument* pdf = texImage->getPdf();
     cairo_surface_t* img = texImage->getImage();
 
-    if (pdf != nullptr) {
-        if (poppler_document_get_n_pages(pdf) < 1) {
-            g_warning("Got latex PDF without pages!: %s", texImage->getText().c_str());
-            return;
-        }
-
-        PopplerPage* page = poppler_document_get_page(pdf, 0);
-
+    if (texImage->hasPdf()) {
         double pageWidth = 0;
         double pageHeight = 0;
-        poppler_page_get_size(page, &pageWidth, &pageHeight);
+        if (!texImage->getPdfPageSize(pageWidth, pageHeight)) {
+            cairo_restore(cr);
+            return;
+        }
 
         double xFactor = texImage->getElementWidth() / pageWidth;
         double yFactor = texImage->getElementHeight() / pageHeight;
@@ -35,23 +35,42 @@ void TexImageView::draw(const Context& ctx) const {
         cairo_translate(cr, texImage->getX(), texImage->getY());
         cairo_scale(cr, xFactor, yFactor);
 
-        // Make TeX images translucent when highlighting audio strokes as they can not have audio
-        if (ctx.fadeOutNonAudio) {
-            /**
-             * Switch to a temporary surface, render the page, then switch back.
-             * This sets the current pattern to the temporary surface.
-             */
-            cairo_push_group(cr);
-            poppler_page_render(page, cr);
-            cairo_pop_group_to_source(cr);
-
-            // paint the temporary surface with opacity level
-            cairo_paint_with_alpha(cr, OPACITY_NO_AUDIO);
-        } else {
-            poppler_page_render(page, cr);
+        // The screen shows a rasterization, the export and the printing keep the vector source
+        cairo_surface_t* rendered = nullptr;
+        if (cairo_surface_get_type(cairo_get_target(cr)) == CAIRO_SURFACE_TYPE_IMAGE) {
+            double dx = 1;
+            double dy = 0;
+            cairo_user_to_device_distance(cr, &dx, &dy);
+            double ex = 0;
+            double ey = 1;
+            cairo_user_to_device_distance(cr, &ex, &ey);
+            rendered = TexImageCache::getInstance().get(texImage, std::max(std::hypot(dx, dy), std::hypot(ex, ey)));
         }
 
-        g_clear_object(&page);
+        if (rendered) {
+            cairo_set_source_surface(cr, rendered, 0, 0);
+            // Make TeX images translucent when highlighting audio strokes as they can not have audio
+            cairo_paint_with_alpha(cr, ctx.fadeOutNonAudio ? OPACITY_NO_AUDIO : 1.0);
+            cairo_surface_destroy(rendered);
+        } else if (PopplerDocument* pdf = texImage->openPdf()) {
+            PopplerPage* page = poppler_document_get_page(pdf, 0);
+            if (ctx.fadeOutNonAudio) {
+                /**
+                 * Switch to a temporary surface, render the page, then switch back.
+                 * This sets the current pattern to the temporary surface.
+                 */
+                cairo_push_group(cr);
+                poppler_page_render(page, cr);
+                cairo_pop_group_to_source(cr);
+
+                // paint the temporary surface with opacity level
+                cairo_paint_with_alpha(cr, OPACITY_NO_AUDIO);
+            } else {
+                poppler_page_render(page, cr);
+            }
+            g_clear_object(&page);
+            g_object_unref(pdf);
+        }
     } else if (img != nullptr) {
         int width = cairo_image_surface_get_width(img);
         int height = cairo_image_surface_get_height(img);
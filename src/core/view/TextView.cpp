@@ -38,6 +38,19 @@ void TextView::updatePangoFont(PangoLayout* layout, const Text* t) {
     pango_font_description_free(desc);
 }
 
+auto TextView::createLayout(const Text* t) -> PangoLayout* {
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+    cairo_t* cr = cairo_create(surface);
+
+    PangoLayout* layout = initPango(cr, t);
+    std::string content = t->getText();
+    pango_layout_set_text(layout, content.c_str(), static_cast<int>(content.length()));
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    return layout;
+}
+
 void TextView::draw(const Context& ctx) const {
     if (text->isInEditing()) {
         // The drawing is handled by gui/TextEditor
@@ -57,13 +70,19 @@ void TextView::draw(const Context& ctx) const {
 
     cairo_translate(ctx.cr, text->getX(), text->getY());
 
-    PangoLayout* layout = initPango(ctx.cr, text);
-    std::string content = text->getText();
-    pango_layout_set_text(layout, content.c_str(), static_cast<int>(content.length()));
+    if (cairo_surface_get_type(cairo_get_target(ctx.cr)) == CAIRO_SURFACE_TYPE_IMAGE) {
+        // Laid out like on the surface of createLayout()
+        text->withLayout([cr = ctx.cr](PangoLayout* layout) { pango_cairo_show_layout(cr, layout); });
+    } else {
+        // The vector backends have other font options
+        PangoLayout* layout = initPango(ctx.cr, text);
+        std::string content = text->getText();
+        pango_layout_set_text(layout, content.c_str(), static_cast<int>(content.length()));
 
-    pango_cairo_show_layout(ctx.cr, layout);
+        pango_cairo_show_layout(ctx.cr, layout);
 
-    g_object_unref(layout);
+        g_object_unref(layout);
+    }
 
     cairo_restore(ctx.cr);
 }
@@ -74,55 +93,35 @@ auto TextView::findText(const Text* t, std::string& search) -> std::vector<XojPd
         return {};
     }
 
-    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
-    cairo_t* cr = cairo_create(surface);
-
-    PangoLayout* layout = initPango(cr, t);
-    std::string content = t->getText();
-    pango_layout_set_text(layout, content.c_str(), static_cast<int>(content.length()));
-
-
-    std::string text = StringUtils::toLowerCase(content);
+    std::string text = StringUtils::toLowerCase(t->getText());
 
     std::string pattern = StringUtils::toLowerCase(search);
 
     std::vector<XojPdfRectangle> list;
 
-    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
-        XojPdfRectangle mark;
-        PangoRectangle rect = {0};
-        pango_layout_index_to_pos(layout, static_cast<int>(pos), &rect);
-        mark.x1 = (static_cast<double>(rect.x)) / PANGO_SCALE + t->getX();
-        mark.y1 = (static_cast<double>(rect.y)) / PANGO_SCALE + t->getY();
+    t->withLayout([&](PangoLayout* layout) {
+        for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+            XojPdfRectangle mark;
+            PangoRectangle rect = {0};
+            pango_layout_index_to_pos(layout, static_cast<int>(pos), &rect);
+            mark.x1 = (static_cast<double>(rect.x)) / PANGO_SCALE + t->getX();
+            mark.y1 = (static_cast<double>(rect.y)) / PANGO_SCALE + t->getY();
 
-        pango_layout_index_to_pos(layout, static_cast<int>(pos + patternLength - 1), &rect);
-        mark.x2 = (static_cast<double>(rect.x) + rect.width) / PANGO_SCALE + t->getX();
-        mark.y2 = (static_cast<double>(rect.y) + rect.height) / PANGO_SCALE + t->getY();
+            pango_layout_index_to_pos(layout, static_cast<int>(pos + patternLength - 1), &rect);
+            mark.x2 = (static_cast<double>(rect.x) + rect.width) / PANGO_SCALE + t->getX();
+            mark.y2 = (static_cast<double>(rect.y) + rect.height) / PANGO_SCALE + t->getY();
 
-        list.push_back(mark);
-    }
-
-    g_object_unref(layout);
-    cairo_surface_destroy(surface);
-    cairo_destroy(cr);
+            list.push_back(mark);
+        }
+    });
 
     return list;
 }
 
 void TextView::calcSize(const Text* t, double& width, double& height) {
-    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
-    cairo_t* cr = cairo_create(surface);
-
-    PangoLayout* layout = initPango(cr, t);
-    std::string content = t->getText();
-    pango_layout_set_text(layout, content.c_str(), static_cast<int>(content.length()));
     int w = 0;
     int h = 0;
-    pango_layout_get_size(layout, &w, &h);
+    t->withLayout([&](PangoLayout* layout) { pango_layout_get_size(layout, &w, &h); });
     width = (static_cast<double>(w)) / PANGO_SCALE;
     height = (static_cast<double>(h)) / PANGO_SCALE;
-    g_object_unref(layout);
-
-    cairo_destroy(cr);
-    cairo_surface_destroy(surface);
 }
@@ -47,6 +47,11 @@ public:
      */
     static void updatePangoFont(PangoLayout* layout, const Text* t);
 
+    /**
+     * @return A new layout of the text, for an image surface. Cached by the Text, see Text::withLayout().
+     */
+    static PangoLayout* createLayout(const Text* t);
+
 private:
     const Text* text;
 };
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include <gtk/gtk.h>
@@ -23,6 +24,7 @@ namespace view {
 enum NonAudioTreatment : bool { FADE_OUT_NON_AUDIO_ = true, NORMAL_NON_AUDIO = false };
 enum EditionTreatment : bool { SHOW_CURRENT_EDITING = true, HIDE_CURRENT_EDITING = false };
 enum ColorTreatment : bool { COLORBLIND = true, NORMAL_COLOR = false };
+enum PendingImageTreatment : bool { WAIT_FOR_IMAGES = true, PLACEHOLDER_FOR_PENDING_IMAGES = false };
 
 struct Context {
     cairo_t* cr;
@@ -30,6 +32,30 @@ struct Context {
     EditionTreatment showCurrentEdition;
     ColorTreatment noColor;
 
+    /**
+     * Distance, in page coordinates, within which the points of the strokes may be dropped. 0 draws all the points.
+     * See DocumentView::setLevelOfDetail()
+     */
+    double detailTolerance = 0;
+
+    /**
+     * Whether the images whose data is still being prepared (see Image::getContentIfReady()) are waited for, or drawn
+     * as a placeholder by the drawings of the UI thread
+     */
+    PendingImageTreatment pendingImages = WAIT_FOR_IMAGES;
+
+    /**
+     * Draw the images with the fast filter, for a rendering done again once the view settles, see RenderJob
+     */
+    bool draft = false;
+
+    /**
+     * If set, the drawing stops between the elements once it is true, see Job::cancel()
+     */
+    const std::atomic<bool>* cancelled = nullptr;
+
+    bool isCancelled() const { return cancelled && cancelled->load(std::memory_order_relaxed); }
+
     static Context createDefault(cairo_t* cr) { return {cr, NORMAL_NON_AUDIO, HIDE_CURRENT_EDITING, NORMAL_COLOR}; }
     static Context createColorBlind(cairo_t* cr) { return {cr, NORMAL_NON_AUDIO, HIDE_CURRENT_EDITING, COLORBLIND}; }
 };
@@ -39,6 +65,12 @@ public:
     virtual ~ElementView() = default;
     virtual void draw(const Context& ctx) const = 0;
     static std::unique_ptr<ElementView> createFromElement(const Element* e);
+
+    /**
+     * @brief Draws the element without allocating a view on the heap.
+     * Prefer this over createFromElement() in loops over many elements.
+     */
+    static void drawElement(const Element* e, const Context& ctx);
 };
 
 class TexImageView;
@@ -51,5 +83,10 @@ class SelectionView;
 class BackgroundView;
 
 constexpr double OPACITY_NO_AUDIO = 0.3;
+
+/**
+ * Distance, in device pixels, within which the points of a stroke are dropped when it is drawn for the screen
+ */
+constexpr double LOD_PIXEL_TOLERANCE = 0.25;
 };  // namespace view
 };  // namespace xoj
@@ -0,0 +1,130 @@
+#include "BackgroundPatternCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace xoj::view;
+
+/**
+ * Steps of the zoom levels of the rasterizations, per power of 2
+ */
+constexpr double BUCKETS_PER_OCTAVE = 8;
+
+BackgroundPatternCache::~BackgroundPatternCache() { clear(); }
+
+auto BackgroundPatternCache::getInstance() -> BackgroundPatternCache& {
+    static BackgroundPatternCache instance;
+    return instance;
+}
+
+auto BackgroundPatternCache::createPattern(cairo_t* cr, const Cell& cell, double originX, double originY)
+        -> cairo_pattern_t* {
+    if (cairo_surface_get_type(cairo_get_target(cr)) == CAIRO_SURFACE_TYPE_SVG) {
+        return createVectorPattern(cell, originX, originY);
+    }
+    if (cairo_surface_get_type(cairo_get_target(cr)) != CAIRO_SURFACE_TYPE_IMAGE) {
+        return nullptr;
+    }
+
+    double dx = 1;
+    double dy = 0;
+    cairo_user_to_device_distance(cr, &dx, &dy);
+    double ex = 0;
+    double ey = 1;
+    cairo_user_to_device_distance(cr, &ex, &ey);
+    if (dy != 0 || ex != 0) {
+        // Rotated, the cells would not be aligned on the pixels
+        return nullptr;
+    }
+
+    cairo_surface_t* surface = get(cell, std::max(std::abs(dx), std::abs(ey)));
+    if (!surface) {
+        return nullptr;
+    }
+
+    cairo_pattern_t* pattern = cairo_pattern_create_for_surface(surface);
+    cairo_surface_destroy(surface);
+    cairo_pattern_set_extend(pattern, CAIRO_EXTEND_REPEAT);
+
+    cairo_matrix_t matrix;
+    cairo_matrix_init_translate(&matrix, -originX, -originY);
+    cairo_pattern_set_matrix(pattern, &matrix);
+    return pattern;
+}
+
+auto BackgroundPatternCache::createVectorPattern(const Cell& cell, double originX, double originY)
+        -> cairo_pattern_t* {
+    if (!(cell.width > 0) || !(cell.height > 0)) {
+        return nullptr;
+    }
+
+    // Bounded: the drawing of the neighbour cells is clipped as on the images. Not cached, the page is drawn once.
+    cairo_rectangle_t extents{0, 0, cell.width, cell.height};
+    cairo_surface_t* surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &extents);
+    cairo_t* cr = cairo_create(surface);
+    cell.paint(cr);
+    cairo_destroy(cr);
+
+    cairo_pattern_t* pattern = cairo_pattern_create_for_surface(surface);
+    cairo_surface_destroy(surface);
+    cairo_pattern_set_extend(pattern, CAIRO_EXTEND_REPEAT);
+
+    cairo_matrix_t matrix;
+    cairo_matrix_init_translate(&matrix, -originX, -originY);
+    cairo_pattern_set_matrix(pattern, &matrix);
+    return pattern;
+}
+
+auto BackgroundPatternCache::get(const Cell& cell, double scale) -> cairo_surface_t* {
+    if (!(scale > 0) || !(cell.width > 0) || !(cell.height > 0)) {
+        return nullptr;
+    }
+
+    const int bucket = static_cast<int>(std::lround(std::log2(scale) * BUCKETS_PER_OCTAVE));
+    const double zoom = std::exp2(bucket / BUCKETS_PER_OCTAVE);
+    const int width = static_cast<int>(std::lround(cell.width * zoom));
+    const int height = static_cast<int>(std::lround(cell.height * zoom));
+    if (std::min(width, height) < MIN_SIZE || std::max(width, height) > MAX_SIZE) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    Key key{cell.type, cell.params, uint32_t(cell.color), cell.width, cell.height, bucket};
+    if (auto it = this->index.find(key); it != this->index.end()) {
+        this->entries.splice(this->entries.begin(), this->entries, it->second);
+        return cairo_surface_reference(it->second->surface);
+    }
+
+    // The whole pixels of the image span exactly one cell
+    const double scaleX = width / cell.width;
+    const double scaleY = height / cell.height;
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_t* cr = cairo_create(surface);
+    cairo_scale(cr, scaleX, scaleY);
+    cell.paint(cr);
+    cairo_destroy(cr);
+    cairo_surface_set_device_scale(surface, scaleX, scaleY);
+
+    this->entries.push_front({std::move(key), surface});
+    this->index.emplace(this->entries.front().key, this->entries.begin());
+
+    while (this->entries.size() > MAX_CELLS) {
+        this->index.erase(this->entries.back().key);
+        cairo_surface_destroy(this->entries.back().surface);
+        this->entries.pop_back();
+    }
+
+    return cairo_surface_reference(surface);
+}
+
+void BackgroundPatternCache::clear() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (Entry& entry: this->entries) { cairo_surface_destroy(entry.surface); }
+    this->entries.clear();
+    this->index.clear();
+}
+
+auto BackgroundPatternCache::getSize() const -> size_t {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->entries.size();
+}
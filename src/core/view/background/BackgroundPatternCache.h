@@ -0,0 +1,131 @@
+/*
+ * Xournal++
+ *
+ * Cache of the rasterized cells of the repeating backgrounds
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <cairo.h>
+
+#include "util/Color.h"
+
+namespace xoj {
+namespace view {
+
+/**
+ * @brief Rasterizations of the cells which the grid and dotted backgrounds repeat
+ *
+ * Instead of stroking every line or dot of the pattern on every render, the background views draw one cell of the
+ * pattern into an image, once for each zoom level, and fill the page with it repeated. The SVG export repeats a
+ * vector drawing of the cell instead, which cairo writes once per page as a <pattern>, instead of every line or dot.
+ * The drawing of all the lines is still used for the PDF export and the printing.
+ *
+ * The zoom levels are rounded to steps of 2^(1/8), so that a zoom gesture reuses the cells. Process wide, kept in
+ * least recently used order up to MAX_CELLS. Thread safe.
+ */
+class BackgroundPatternCache {
+public:
+    struct Cell {
+        /**
+         * Identifies the drawing of the cell together with params and color, e.g. the name of the background
+         */
+        std::string type;
+
+        /**
+         * E.g. the line width
+         */
+        std::vector<double> params;
+        Color color;
+
+        /**
+         * The size of the cell, in page coordinates
+         */
+        double width;
+        double height;
+
+        /**
+         * Draws the cell on a transparent image, in cell coordinates (0, 0, width, height). The drawing of the
+         * neighbour cells overlapping the cell must be included, e.g. the four quarters of the dots at the corners.
+         */
+        std::function<void(cairo_t*)> paint;
+    };
+
+    BackgroundPatternCache() = default;
+    ~BackgroundPatternCache();
+
+    BackgroundPatternCache(const BackgroundPatternCache&) = delete;
+    BackgroundPatternCache& operator=(const BackgroundPatternCache&) = delete;
+
+    static BackgroundPatternCache& getInstance();
+
+public:
+    /**
+     * @param origin{X,Y} A corner of a cell, in page coordinates
+     * @return A new repeating pattern of the rasterized cell, in page coordinates, to fill some parts of the page with.
+     *         A pattern of the vector drawing of the cell if cr draws on an SVG surface. nullptr if cr draws on another
+     *         surface, or if the cell is too small or too large on the device: the caller draws the cells itself.
+     */
+    cairo_pattern_t* createPattern(cairo_t* cr, const Cell& cell, double originX, double originY);
+
+    void clear();
+
+    /**
+     * @return The number of rasterized cells
+     */
+    size_t getSize() const;
+
+    static constexpr size_t MAX_CELLS = 64;
+
+    /**
+     * Range of the cell sides, in pixels: the smaller cells would be blurred by the resampling, and the larger ones
+     * are cheap to draw
+     */
+    static constexpr int MIN_SIZE = 4;
+    static constexpr int MAX_SIZE = 512;
+
+private:
+    using Key = std::tuple<std::string, std::vector<double>, uint32_t, double, double, int>;
+
+    struct Entry {
+        Key key;
+        cairo_surface_t* surface;
+    };
+
+    /**
+     * @return A new repeating pattern of a recording of the cell, nullptr if the cell is empty
+     */
+    static cairo_pattern_t* createVectorPattern(const Cell& cell, double originX, double originY);
+
+    /**
+     * @return A new reference to the rasterization, or nullptr if it is too small or too large
+     */
+    cairo_surface_t* get(const Cell& cell, double scale);
+
+private:
+    /**
+     * The most recently used first
+     */
+    std::list<Entry> entries;
+    std::map<Key, std::list<Entry>::iterator> index;
+
+    mutable std::mutex mutex;
+};
+
+};  // namespace view
+};  // namespace xoj
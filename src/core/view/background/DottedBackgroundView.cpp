@@ -5,6 +5,8 @@
 #include "model/BackgroundConfig.h"
 #include "util/Util.h"
 
+#include "BackgroundPatternCache.h"
+
 using namespace background_config_strings;
 using namespace xoj::view;
 
@@ -35,6 +37,33 @@ void DottedBackgroundView::draw(cairo_t* cr) const {
     auto [indexMinY, indexMaxY] =
             getIndexBounds(minY - halfLineWidth, maxY + halfLineWidth, squareSize, squareSize, pageHeight);
 
+    if (indexMinX > indexMaxX || indexMinY > indexMaxY) {
+        return;
+    }
+
+    // The dots do not overlap: the page is tiled by a cell with a quarter of a dot in each corner
+    if (halfLineWidth < 0.5 * squareSize) {
+        BackgroundPatternCache::Cell cell{"dotted", {lineWidth}, foregroundColor, squareSize, squareSize,
+                                          [this](cairo_t* cr) {
+                                              for (double x: {0.0, squareSize}) {
+                                                  for (double y: {0.0, squareSize}) {
+                                                      cairo_move_to(cr, x, y);
+                                                      cairo_line_to(cr, x, y);
+                                                  }
+                                              }
+                                              strokeCell(cr, CAIRO_LINE_CAP_ROUND);
+                                          }};
+        if (auto* pattern = BackgroundPatternCache::getInstance().createPattern(cr, cell, 0, 0)) {
+            // Halfway to the dots which are not drawn
+            const double pad = 0.5 * squareSize;
+            fillWithPattern(cr, pattern,
+                            {{indexMinX * squareSize - pad, indexMinY * squareSize - pad,
+                              (indexMaxX - indexMinX) * squareSize + 2 * pad,
+                              (indexMaxY - indexMinY) * squareSize + 2 * pad}});
+            return;
+        }
+    }
+
     for (int i = indexMinX; i <= indexMaxX; ++i) {
         double x = i * squareSize;
         for (int j = indexMinY; j <= indexMaxY; ++j) {
@@ -5,8 +5,11 @@
 #include "model/BackgroundConfig.h"
 #include "util/Util.h"
 
+#include "BackgroundPatternCache.h"
+
 using namespace background_config_strings;
 using namespace xoj::view;
+using xoj::util::Rectangle;
 
 GraphBackgroundView::GraphBackgroundView(double pageWidth, double pageHeight, Color backgroundColor,
                                          const BackgroundConfig& config):
@@ -54,6 +57,16 @@ void GraphBackgroundView::draw(cairo_t* cr) const {
         maxY = maxY == pageHeight - margin ? indexMaxY * squareSize : maxY;
     }
 
+    // Across the lines, halfway to the lines which are not drawn. Along them, up to the end of their square caps.
+    const double pad = 0.5 * squareSize;
+    if (paintPattern(cr,
+                     {indexMinX * squareSize - pad, minY - halfLineWidth, (indexMaxX - indexMinX + 1) * squareSize,
+                      maxY - minY + lineWidth},
+                     {minX - halfLineWidth, indexMinY * squareSize - pad, maxX - minX + lineWidth,
+                      (indexMaxY - indexMinY + 1) * squareSize})) {
+        return;
+    }
+
     for (int i = indexMinX; i <= indexMaxX; ++i) {
         cairo_move_to(cr, i * squareSize, minY);
         cairo_line_to(cr, i * squareSize, maxY);
@@ -70,3 +83,61 @@ void GraphBackgroundView::draw(cairo_t* cr) const {
     cairo_stroke(cr);
     cairo_restore(cr);
 }
+
+auto GraphBackgroundView::paintPattern(cairo_t* cr, const Rectangle<double>& vLines,
+                                       const Rectangle<double>& hLines) const -> bool {
+    if (lineWidth >= squareSize) {
+        return false;
+    }
+
+    // The lines cross the whole cells, their ends are drawn by the areas
+    auto makeCell = [this](const char* type, bool vertical, bool horizontal) {
+        return BackgroundPatternCache::Cell{type, {lineWidth}, foregroundColor, squareSize, squareSize,
+                                            [this, vertical, horizontal](cairo_t* cr) {
+                                                for (double pos: {0.0, squareSize}) {
+                                                    if (vertical) {
+                                                        cairo_move_to(cr, pos, -squareSize);
+                                                        cairo_line_to(cr, pos, 2 * squareSize);
+                                                    }
+                                                    if (horizontal) {
+                                                        cairo_move_to(cr, -squareSize, pos);
+                                                        cairo_line_to(cr, 2 * squareSize, pos);
+                                                    }
+                                                }
+                                                strokeCell(cr, CAIRO_LINE_CAP_BUTT);
+                                            }};
+    };
+
+    auto& cache = BackgroundPatternCache::getInstance();
+    cairo_pattern_t* grid = cache.createPattern(cr, makeCell("graph", true, true), 0, 0);
+    cairo_pattern_t* vertical = cache.createPattern(cr, makeCell("graph-v", true, false), 0, 0);
+    cairo_pattern_t* horizontal = cache.createPattern(cr, makeCell("graph-h", false, true), 0, 0);
+    if (!grid || !vertical || !horizontal) {
+        for (cairo_pattern_t* pattern: {grid, vertical, horizontal}) {
+            if (pattern) {
+                cairo_pattern_destroy(pattern);
+            }
+        }
+        return false;
+    }
+
+    // Where both the vertical and the horizontal lines are, the grid cell. Around, the lines of one direction.
+    auto both = vLines.intersects(hLines);
+    if (!both) {
+        cairo_pattern_destroy(grid);
+        fillWithPattern(cr, vertical, {vLines});
+        fillWithPattern(cr, horizontal, {hLines});
+        return true;
+    }
+
+    auto outside = [&b = *both](const Rectangle<double>& r) -> std::vector<Rectangle<double>> {
+        return {{r.x, r.y, r.width, b.y - r.y},
+                {r.x, b.y + b.height, r.width, r.y + r.height - b.y - b.height},
+                {r.x, b.y, b.x - r.x, b.height},
+                {b.x + b.width, b.y, r.x + r.width - b.x - b.width, b.height}};
+    };
+    fillWithPattern(cr, grid, {*both});
+    fillWithPattern(cr, vertical, outside(vLines));
+    fillWithPattern(cr, horizontal, outside(hLines));
+    return true;
+}
@@ -23,6 +23,14 @@ public:
     virtual void draw(cairo_t* cr) const override;
 
 protected:
+    /**
+     * Fill the areas of the lines with the cells of BackgroundPatternCache
+     * @param vLines, hLines The areas of the vertical and the horizontal lines, including their width
+     * @return false if the cells are not rasterized for cr: the caller draws the lines
+     */
+    bool paintPattern(cairo_t* cr, const xoj::util::Rectangle<double>& vLines,
+                      const xoj::util::Rectangle<double>& hLines) const;
+
     bool roundUpMargin = false;
     double margin = 0.0;
     double squareSize = 14.17;  // 5mm
@@ -17,7 +17,11 @@ struct BackgroundImage;
 
 class xoj::view::ImageBackgroundView: public BackgroundView {
 public:
-    ImageBackgroundView(const BackgroundImage& image, double pageWidth, double pageHeight);
+    /**
+     * @param filter The filter the image is drawn with, e.g. CAIRO_FILTER_FAST for a draft
+     */
+    ImageBackgroundView(const BackgroundImage& image, double pageWidth, double pageHeight,
+                        cairo_filter_t filter = CAIRO_FILTER_GOOD);
 
     /**
      * @brief Draws the background on the entire mask represented by the cairo context ctx.cr
@@ -26,4 +30,5 @@ public:
 
 private:
     const BackgroundImage& image;
+    cairo_filter_t filter;
 };
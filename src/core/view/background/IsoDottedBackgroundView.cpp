@@ -1,10 +1,14 @@
 #include "IsoDottedBackgroundView.h"
 
+#include <algorithm>
 #include <cmath>
+#include <utility>
 
 #include "model/BackgroundConfig.h"
 #include "util/Util.h"
 
+#include "BackgroundPatternCache.h"
+
 using namespace xoj::view;
 
 IsoDottedBackgroundView::IsoDottedBackgroundView(double pageWidth, double pageHeight, Color backgroundColor,
@@ -14,6 +18,9 @@ IsoDottedBackgroundView::IsoDottedBackgroundView(double pageWidth, double pageHe
 
 void IsoDottedBackgroundView::paintGrid(cairo_t* cr, int cols, int rows, double xstep, double ystep, double xOffset,
                                         double yOffset) const {
+    if (paintPattern(cr, cols, rows, xstep, ystep, xOffset, yOffset)) {
+        return;
+    }
 
     auto drawDot = [&](double x, double y) {
         cairo_move_to(cr, xOffset + x, yOffset + y);
@@ -33,3 +40,32 @@ void IsoDottedBackgroundView::paintGrid(cairo_t* cr, int cols, int rows, double
         }
     }
 }
+
+auto IsoDottedBackgroundView::paintPattern(cairo_t* cr, int cols, int rows, double xstep, double ystep,
+                                           double xOffset, double yOffset) const -> bool {
+    // Halfway to the nearest dots which are not drawn
+    const double pad = 0.5 * std::min(xstep, ystep);
+    if (0.5 * lineWidth >= pad || cols < 0 || rows < 0) {
+        return false;
+    }
+
+    // The dots of paintGrid() are those with (col + row) odd: a cell spans two columns and two rows
+    BackgroundPatternCache::Cell cell{"isodotted", {lineWidth, xstep, ystep}, foregroundColor, 2 * xstep, 2 * ystep,
+                                      [&](cairo_t* cr) {
+                                          for (auto [x, y]: {std::pair{xstep, 0.0}, std::pair{0.0, ystep},
+                                                             std::pair{2 * xstep, ystep}, std::pair{xstep, 2 * ystep}}) {
+                                              cairo_move_to(cr, x, y);
+                                              cairo_line_to(cr, x, y);
+                                          }
+                                          strokeCell(cr, CAIRO_LINE_CAP_ROUND);
+                                      }};
+    cairo_pattern_t* pattern = BackgroundPatternCache::getInstance().createPattern(cr, cell, xOffset, yOffset);
+    if (!pattern) {
+        return false;
+    }
+
+    // No dot is drawn on an odd last row
+    const int lastRow = rows % 2 ? rows - 1 : rows;
+    fillWithPattern(cr, pattern, {{xOffset - pad, yOffset - pad, cols * xstep + 2 * pad, lastRow * ystep + 2 * pad}});
+    return true;
+}
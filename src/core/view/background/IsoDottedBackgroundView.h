@@ -24,6 +24,13 @@ protected:
     virtual void paintGrid(cairo_t* cr, int cols, int rows, double xstep, double ystep, double xOffset,
                            double yOffset) const override;
 
+    /**
+     * Fill the grid with the cells of BackgroundPatternCache
+     * @return false if the cells are not rasterized for cr: the caller draws the dots
+     */
+    bool paintPattern(cairo_t* cr, int cols, int rows, double xstep, double ystep, double xOffset,
+                      double yOffset) const;
+
 protected:
     constexpr static double DEFAULT_LINE_WIDTH = 1.5;
 };
@@ -24,6 +24,28 @@ OneColorBackgroundView::OneColorBackgroundView(double pageWidth, double pageHeig
 
 void xoj::view::OneColorBackgroundView::multiplyLineWidth(double factor) { lineWidth *= factor; }
 
+void OneColorBackgroundView::fillWithPattern(cairo_t* cr, cairo_pattern_t* pattern,
+                                             const std::vector<xoj::util::Rectangle<double>>& areas) {
+    cairo_save(cr);
+    cairo_set_source(cr, pattern);
+    cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
+    for (auto const& area: areas) {
+        if (area.width > 0 && area.height > 0) {
+            cairo_rectangle(cr, area.x, area.y, area.width, area.height);
+        }
+    }
+    cairo_fill(cr);
+    cairo_restore(cr);
+    cairo_pattern_destroy(pattern);
+}
+
+void OneColorBackgroundView::strokeCell(cairo_t* cr, cairo_line_cap_t cap) const {
+    Util::cairo_set_source_rgbi(cr, foregroundColor);
+    cairo_set_line_width(cr, lineWidth);
+    cairo_set_line_cap(cr, cap);
+    cairo_stroke(cr);
+}
+
 Color OneColorBackgroundView::getColorOr(const BackgroundConfig& config, const std::string& str,
                                          const Color& defaultColor) {
     if (uint32_t hexColor; config.loadValueHex(str, hexColor)) {
@@ -11,6 +11,10 @@
 
 #pragma once
 
+#include <vector>
+
+#include "util/Rectangle.h"
+
 #include "PlainBackgroundView.h"
 
 class BackgroundConfig;
@@ -30,6 +34,19 @@ protected:
      */
     static Color getColorOr(const BackgroundConfig& config, const std::string& str, const Color& defaultColor);
 
+    /**
+     * @brief Fill the areas with the pattern, e.g. of BackgroundPatternCache, and destroy it
+     *
+     * The areas are not antialiased: the adjacent areas filled with different patterns have no seam.
+     */
+    static void fillWithPattern(cairo_t* cr, cairo_pattern_t* pattern,
+                                const std::vector<xoj::util::Rectangle<double>>& areas);
+
+    /**
+     * Stroke the path of the cell of a BackgroundPatternCache, with the line width and the color of the background
+     */
+    void strokeCell(cairo_t* cr, cairo_line_cap_t cap) const;
+
 protected:
     Color foregroundColor;
     double lineWidth;
@@ -11,6 +11,7 @@
 
 #include "control/CrashHandler.h"
 #include "control/XournalMain.h"
+#include "util/logger/AsyncLog.h"
 #include "util/logger/Logger.h"
 
 #include "filesystem.h"
@@ -28,6 +29,9 @@ auto main(int argc, char* argv[]) -> int {
     // init crash handler
     installCrashHandlers();
 
+    // The messages are written by a background thread from now on
+    xoj::util::AsyncLog::start();
+
 #ifdef DEV_CALL_LOG
     Log::initlog();
 #endif
@@ -47,5 +51,7 @@ auto main(int argc, char* argv[]) -> int {
     Log::closelog();
 #endif
 
+    xoj::util::AsyncLog::stop();
+
     return result;
 }
@@ -0,0 +1,186 @@
+#include "util/GzInputStream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "util/GzUtil.h"
+#include "util/ParallelLoop.h"
+#include "util/i18n.h"
+
+static auto readLittleEndian(const std::string& data, size_t pos, size_t bytes) -> uLong {
+    uLong value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= static_cast<uLong>(static_cast<unsigned char>(data[pos + i])) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @return Whether the data has the header of a member written by GzOutputStream at the position
+ */
+static auto hasMemberHeader(const std::string& data, size_t pos) -> bool {
+    if (data.size() - pos < GzUtil::MEMBER_HEADER_SIZE) {
+        return false;
+    }
+    // Deflate, only the extra field, with a single subfield
+    const char header[] = {'\x1f', '\x8b', 8, 4};
+    return data.compare(pos, sizeof(header), header, sizeof(header)) == 0 &&
+           readLittleEndian(data, pos + 10, 2) == 8 && data[pos + 12] == GzUtil::MEMBER_SIZE_ID[0] &&
+           data[pos + 13] == GzUtil::MEMBER_SIZE_ID[1] && readLittleEndian(data, pos + 14, 2) == 4;
+}
+
+/**
+ * @return The size of the member written by GzOutputStream at the position, 0 if there is none
+ */
+static auto getMemberSize(const std::string& data, size_t pos) -> size_t {
+    if (!hasMemberHeader(data, pos)) {
+        return 0;
+    }
+    size_t size = readLittleEndian(data, pos + 16, 4);
+    if (size < GzUtil::MEMBER_HEADER_SIZE + GzUtil::MEMBER_TRAILER_SIZE || size > data.size() - pos) {
+        return 0;
+    }
+    return size;
+}
+
+/**
+ * Inflate a member written by GzOutputStream
+ * @return false if the data is corrupted
+ */
+static auto inflateMember(const std::string& data, size_t pos, size_t size, std::string& out) -> bool {
+    size_t trailer = pos + size - GzUtil::MEMBER_TRAILER_SIZE;
+    uLong crc = readLittleEndian(data, trailer, 4);
+    uLong length = readLittleEndian(data, trailer + 4, 4);
+
+    z_stream strm{};
+    if (inflateInit2(&strm, -15) != Z_OK) {
+        return false;
+    }
+    out.resize(length);
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data() + pos + GzUtil::MEMBER_HEADER_SIZE));
+    strm.avail_in = static_cast<uInt>(size - GzUtil::MEMBER_HEADER_SIZE - GzUtil::MEMBER_TRAILER_SIZE);
+    strm.next_out = reinterpret_cast<Bytef*>(out.data());
+    strm.avail_out = static_cast<uInt>(out.size());
+    int ret = inflate(&strm, Z_FINISH);
+    bool complete = ret == Z_STREAM_END && strm.avail_out == 0 && strm.avail_in == 0;
+    inflateEnd(&strm);
+
+    const auto* inflated = reinterpret_cast<const Bytef*>(out.data());
+    return complete && crc32(crc32(0L, Z_NULL, 0), inflated, static_cast<uInt>(out.size())) == crc;
+}
+
+GzInputStream::GzInputStream(const fs::path& file): file(file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in.is_open()) {
+        this->error = FS(_F("Could not open file: \"{1}\"") % file.u8string());
+        return;
+    }
+
+    std::string header(GzUtil::MEMBER_HEADER_SIZE, '\0');
+    in.read(header.data(), static_cast<std::streamsize>(header.size()));
+    header.resize(static_cast<size_t>(in.gcount()));
+    if (hasMemberHeader(header, 0)) {
+        in.seekg(0);
+        this->compressed.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (locateMembers()) {
+            this->loop = std::make_unique<xoj::util::ParallelLoop>();
+            return;
+        }
+        this->compressed = std::string();
+        this->members.clear();
+    }
+
+    // Not written by GzOutputStream: gzread also reads the files which are not compressed
+    in.close();
+    this->fp = GzUtil::openPath(file, "r");
+    if (!this->fp) {
+        this->error = FS(_F("Could not open file: \"{1}\"") % file.u8string());
+    }
+}
+
+GzInputStream::~GzInputStream() {
+    if (this->fp) {
+        gzclose(this->fp);
+    }
+}
+
+auto GzInputStream::isOpen() const -> bool { return this->fp || this->loop; }
+
+auto GzInputStream::isParallel() const -> bool { return static_cast<bool>(this->loop); }
+
+auto GzInputStream::getLastError() const -> const std::string& { return this->error; }
+
+auto GzInputStream::locateMembers() -> bool {
+    size_t pos = 0;
+    while (pos < this->compressed.size()) {
+        size_t size = getMemberSize(this->compressed, pos);
+        if (size == 0) {
+            return false;
+        }
+        this->members.emplace_back(pos, size);
+        pos += size;
+    }
+    return !this->members.empty();
+}
+
+auto GzInputStream::inflateBatch() -> bool {
+    size_t count = std::min(this->loop->getThreadCount() * MEMBERS_PER_THREAD, this->members.size() - this->nextMember);
+    this->batch.resize(count);
+    this->batchIndex = 0;
+    this->batchOffset = 0;
+
+    std::vector<char> ok(count, false);
+    this->loop->run(count, [this, &ok](size_t i) {
+        const auto& [pos, size] = this->members[this->nextMember + i];
+        ok[i] = inflateMember(this->compressed, pos, size, this->batch[i]);
+    });
+    this->nextMember += count;
+
+    if (std::find(ok.begin(), ok.end(), false) != ok.end()) {
+        this->error = FS(_F("The file is corrupted: \"{1}\"") % this->file.u8string());
+        return false;
+    }
+    return true;
+}
+
+auto GzInputStream::read(char* buffer, size_t len) -> int64_t {
+    if (this->fp) {
+        int read = gzread(this->fp, buffer, static_cast<unsigned int>(std::min<size_t>(len, INT32_MAX)));
+        if (read < 0) {
+            int errnum = Z_OK;
+            this->error = gzerror(this->fp, &errnum);
+        }
+        return read;
+    }
+    if (!this->loop || this->failed) {
+        return -1;
+    }
+
+    size_t read = 0;
+    while (read < len) {
+        if (this->batchIndex == this->batch.size()) {
+            if (this->nextMember == this->members.size()) {
+                break;
+            }
+            if (!inflateBatch()) {
+                this->failed = true;
+                return -1;
+            }
+            continue;
+        }
+
+        std::string& member = this->batch[this->batchIndex];
+        size_t count = std::min(len - read, member.size() - this->batchOffset);
+        std::memcpy(buffer + read, member.data() + this->batchOffset, count);
+        read += count;
+        this->batchOffset += count;
+        if (this->batchOffset == member.size()) {
+            member = std::string();
+            this->batchIndex++;
+            this->batchOffset = 0;
+        }
+    }
+    return static_cast<int64_t>(read);
+}
@@ -0,0 +1,102 @@
+#include "util/Mipmap.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace xoj::util;
+
+Mipmap::Mipmap(cairo_surface_t* image): image(cairo_surface_reference(image)) {}
+
+Mipmap::~Mipmap() {
+    for (cairo_surface_t* level: this->levels) { cairo_surface_destroy(level); }
+    cairo_surface_destroy(this->image);
+}
+
+auto Mipmap::getImage() const -> cairo_surface_t* { return this->image; }
+
+auto Mipmap::getLevel(double scale) const -> std::pair<cairo_surface_t*, int> {
+    int factor = 1;
+    cairo_surface_t* surface = this->image;
+    if (!(scale > 0) || scale >= 0.5) {
+        return {surface, factor};
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (size_t level = 0; scale * 2 * factor <= 1.0; level++) {
+        int width = cairo_image_surface_get_width(surface) / 2;
+        int height = cairo_image_surface_get_height(surface) / 2;
+        if (std::min(width, height) < MIN_SIZE) {
+            break;
+        }
+
+        if (level == this->levels.size()) {
+            cairo_surface_t* half = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+            cairo_t* cr = cairo_create(half);
+            cairo_scale(cr, static_cast<double>(width) / cairo_image_surface_get_width(surface),
+                        static_cast<double>(height) / cairo_image_surface_get_height(surface));
+            cairo_set_source_surface(cr, surface, 0, 0);
+            cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+            cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+            cairo_paint(cr);
+            cairo_destroy(cr);
+            this->levels.push_back(half);
+        }
+        surface = this->levels[level];
+        factor *= 2;
+    }
+    return {surface, factor};
+}
+
+/**
+ * @return true if the target keeps the image data, rather than pixels
+ */
+static auto isVectorTarget(cairo_t* cr) -> bool {
+    switch (cairo_surface_get_type(cairo_get_target(cr))) {
+        case CAIRO_SURFACE_TYPE_PDF:
+        case CAIRO_SURFACE_TYPE_PS:
+        case CAIRO_SURFACE_TYPE_SVG:
+        case CAIRO_SURFACE_TYPE_RECORDING:
+        case CAIRO_SURFACE_TYPE_SCRIPT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void Mipmap::paint(cairo_t* cr, double x, double y, double width, double height, double alpha,
+                   cairo_filter_t filter) const {
+    int imageWidth = cairo_image_surface_get_width(this->image);
+    int imageHeight = cairo_image_surface_get_height(this->image);
+    if (imageWidth <= 0 || imageHeight <= 0) {
+        return;
+    }
+
+    cairo_save(cr);
+    cairo_translate(cr, x, y);
+    cairo_scale(cr, width / imageWidth, height / imageHeight);
+
+    cairo_surface_t* surface = this->image;
+    if (!isVectorTarget(cr)) {
+        // Device pixels per image pixel, along the most magnified axis
+        double dx = 1, dy = 0;
+        cairo_user_to_device_distance(cr, &dx, &dy);
+        double ex = 0, ey = 1;
+        cairo_user_to_device_distance(cr, &ex, &ey);
+        double scale = std::max(std::hypot(dx, dy), std::hypot(ex, ey));
+
+        surface = getLevel(scale).first;
+        if (surface != this->image) {
+            cairo_scale(cr, static_cast<double>(imageWidth) / cairo_image_surface_get_width(surface),
+                        static_cast<double>(imageHeight) / cairo_image_surface_get_height(surface));
+        }
+    }
+
+    cairo_set_source_surface(cr, surface, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), filter);
+    if (alpha < 1.0) {
+        cairo_paint_with_alpha(cr, alpha);
+    } else {
+        cairo_paint(cr);
+    }
+    cairo_restore(cr);
+}
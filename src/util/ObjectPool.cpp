@@ -0,0 +1,66 @@
+#include "util/ObjectPool.h"
+
+#include <algorithm>
+#include <new>
+
+using namespace xoj::util;
+
+ObjectPool::ObjectPool(size_t objectSize, size_t objectsPerChunk):
+        objectsPerChunk(std::max<size_t>(objectsPerChunk, 1)) {
+    constexpr size_t alignment = alignof(std::max_align_t);
+    size_t size = std::max(objectSize, sizeof(FreeBlock));
+    this->blockSize = (size + alignment - 1) / alignment * alignment;
+}
+
+ObjectPool::~ObjectPool() {
+    for (unsigned char* chunk: this->chunks) { ::operator delete(chunk); }
+}
+
+auto ObjectPool::allocate() -> void* {
+    std::lock_guard lock(this->mutex);
+    this->used++;
+    if (this->freeBlocks) {
+        FreeBlock* block = this->freeBlocks;
+        this->freeBlocks = block->next;
+        return block;
+    }
+
+    if (this->next == this->end) {
+        auto* chunk = static_cast<unsigned char*>(::operator new(this->blockSize * this->objectsPerChunk));
+        try {
+            this->chunks.push_back(chunk);
+        } catch (...) {
+            ::operator delete(chunk);
+            this->used--;
+            throw;
+        }
+        this->next = chunk;
+        this->end = chunk + this->blockSize * this->objectsPerChunk;
+    }
+    void* block = this->next;
+    this->next += this->blockSize;
+    return block;
+}
+
+void ObjectPool::deallocate(void* p) noexcept {
+    if (!p) {
+        return;
+    }
+    std::lock_guard lock(this->mutex);
+    this->used--;
+    auto* block = static_cast<FreeBlock*>(p);
+    block->next = this->freeBlocks;
+    this->freeBlocks = block;
+}
+
+auto ObjectPool::getBlockSize() const -> size_t { return this->blockSize; }
+
+auto ObjectPool::getUsedCount() const -> size_t {
+    std::lock_guard lock(this->mutex);
+    return this->used;
+}
+
+auto ObjectPool::getChunkCount() const -> size_t {
+    std::lock_guard lock(this->mutex);
+    return this->chunks.size();
+}
@@ -1,5 +1,9 @@
 #include "util/OutputStream.h"
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
 #include <glib.h>
 
 #include "util/GzUtil.h"
@@ -17,27 +21,239 @@ void OutputStream::write(const char* str) { write(str, strlen(str)); }
 /// GzOutputStream /////////////////////////////////////
 ////////////////////////////////////////////////////////
 
+/**
+ * Maximum number of worker threads
+ */
+constexpr unsigned int MAX_WORKERS = 8;
+
+struct GzOutputStream::Block {
+    std::string input;
+
+    /// The whole gzip member
+    std::string output;
+    bool ok = true;
+    bool done = false;
+};
+
 GzOutputStream::GzOutputStream(fs::path file): file(std::move(file)) {
-    this->fp = GzUtil::openPath(this->file, "w");
-    if (this->fp == nullptr) {
+    this->out.open(this->file, std::ios::binary | std::ios::trunc);
+    if (!this->out.is_open()) {
         this->error = FS(_F("Error opening file: \"{1}\"") % this->file.u8string());
+        this->closed = true;
+        return;
     }
+
+    this->buffer.reserve(BLOCK_SIZE);
 }
 
 GzOutputStream::~GzOutputStream() {
-    if (this->fp) {
-        close();
-    }
-    this->fp = nullptr;
+    close();
+    stopWorkers();
 }
 
 auto GzOutputStream::getLastError() -> std::string& { return this->error; }
 
-void GzOutputStream::write(const char* data, int len) { gzwrite(this->fp, data, len); }
+void GzOutputStream::write(const char* data, int len) {
+    if (this->closed || len <= 0) {
+        return;
+    }
+
+    auto length = static_cast<size_t>(len);
+    while (length > 0) {
+        size_t count = std::min(length, BLOCK_SIZE - this->buffer.size());
+        this->buffer.append(data, count);
+        data += count;
+        length -= count;
+
+        if (this->buffer.size() == BLOCK_SIZE) {
+            submitBlock(false);
+        }
+    }
+}
 
 void GzOutputStream::close() {
-    if (this->fp) {
-        gzclose(this->fp);
-        this->fp = nullptr;
+    if (this->closed) {
+        return;
+    }
+    this->closed = true;
+
+    // An empty file is still a gzip member
+    if (!this->buffer.empty() || !this->submitted) {
+        submitBlock(true);
+    }
+    writeCompressedBlocks(true);
+    stopWorkers();
+
+    this->out.close();
+    if (this->out.fail() && this->error.empty()) {
+        this->error = FS(_F("Could not write file \"{1}\"") % this->file.u8string());
+    }
+}
+
+void GzOutputStream::submitBlock(bool last) {
+    auto block = std::make_unique<Block>();
+    block->input = std::move(this->buffer);
+    this->submitted = true;
+
+    this->buffer = std::string();
+    if (!last) {
+        this->buffer.reserve(BLOCK_SIZE);
+    }
+
+    if (last && this->blocks.empty() && this->workers.empty()) {
+        // Not worth starting threads
+        compress(*block);
+        block->done = true;
+        this->blocks.push_back(std::move(block));
+        return;
+    }
+
+    startWorkers();
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->queue.push_back(block.get());
+        this->blocks.push_back(std::move(block));
+    }
+    this->blockQueued.notify_one();
+
+    // Limit the memory used by the blocks waiting to be written
+    while (this->blocks.size() > 2 * this->workers.size()) {
+        writeCompressedBlocks(false);
+        if (this->blocks.size() > 2 * this->workers.size()) {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->blockCompressed.wait(lock, [this]() { return this->blocks.front()->done; });
+        }
+    }
+}
+
+void GzOutputStream::writeCompressedBlocks(bool all) {
+    while (!this->blocks.empty()) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            if (all) {
+                this->blockCompressed.wait(lock, [this]() { return this->blocks.front()->done; });
+            } else if (!this->blocks.front()->done) {
+                return;
+            }
+        }
+
+        std::unique_ptr<Block> block = std::move(this->blocks.front());
+        this->blocks.pop_front();
+
+        if (!block->ok && this->error.empty()) {
+            this->error = FS(_F("Could not write file \"{1}\"") % this->file.u8string());
+        }
+        writeBytes(block->output.data(), block->output.size());
+    }
+}
+
+void GzOutputStream::writeBytes(const char* data, size_t len) {
+    this->out.write(data, static_cast<std::streamsize>(len));
+    if (this->out.fail() && this->error.empty()) {
+        this->error = FS(_F("Could not write file \"{1}\"") % this->file.u8string());
     }
 }
+
+void GzOutputStream::startWorkers() {
+    if (!this->workers.empty()) {
+        return;
+    }
+
+    unsigned int count = std::clamp(std::thread::hardware_concurrency(), 1U, MAX_WORKERS);
+    for (unsigned int i = 0; i < count; i++) {
+        this->workers.emplace_back(&GzOutputStream::compressLoop, this);
+    }
+}
+
+void GzOutputStream::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->blockQueued.notify_all();
+
+    for (std::thread& worker: this->workers) {
+        worker.join();
+    }
+    this->workers.clear();
+}
+
+void GzOutputStream::compressLoop() {
+    while (true) {
+        Block* block = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->blockQueued.wait(lock, [this]() { return this->stopping || !this->queue.empty(); });
+            if (this->queue.empty()) {
+                return;
+            }
+            block = this->queue.front();
+            this->queue.pop_front();
+        }
+
+        compress(*block);
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            block->done = true;
+        }
+        this->blockCompressed.notify_all();
+    }
+}
+
+static void writeLittleEndian(std::string& out, size_t pos, uLong value) {
+    for (size_t i = 0; i < 4; i++) {
+        out[pos + i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+void GzOutputStream::compress(Block& block) {
+    const auto* input = reinterpret_cast<const Bytef*>(block.input.data());
+
+    z_stream strm{};
+    // Raw deflate, the gzip header and trailer of the member are written here
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        block.ok = false;
+        return;
+    }
+
+    const size_t headerSize = GzUtil::MEMBER_HEADER_SIZE;
+    block.output.resize(headerSize + deflateBound(&strm, static_cast<uLong>(block.input.size())));
+    strm.next_in = const_cast<Bytef*>(input);
+    strm.avail_in = static_cast<uInt>(block.input.size());
+
+    int ret = Z_OK;
+    size_t written = headerSize;
+    do {
+        if (written == block.output.size()) {
+            block.output.resize(block.output.size() * 2);
+        }
+        strm.next_out = reinterpret_cast<Bytef*>(&block.output[written]);
+        strm.avail_out = static_cast<uInt>(block.output.size() - written);
+        ret = deflate(&strm, Z_FINISH);
+        written = block.output.size() - strm.avail_out;
+    } while (ret == Z_OK);
+    block.ok = ret == Z_STREAM_END;
+    deflateEnd(&strm);
+
+    block.output.resize(written + GzUtil::MEMBER_TRAILER_SIZE);
+    // Header: deflate, extra field, no mtime, no name, Unix, then the subfield with the size of the member
+    const char header[] = {'\x1f', '\x8b', 8, 4, 0, 0, 0, 0, 0, 3, 8, 0, GzUtil::MEMBER_SIZE_ID[0],
+                           GzUtil::MEMBER_SIZE_ID[1], 4, 0};
+    std::copy(std::begin(header), std::end(header), block.output.begin());
+    writeLittleEndian(block.output, sizeof(header), static_cast<uLong>(block.output.size()));
+
+    // Trailer: CRC32 and size of the uncompressed data
+    writeLittleEndian(block.output, written, crc32(crc32(0L, Z_NULL, 0), input, static_cast<uInt>(block.input.size())));
+    writeLittleEndian(block.output, written + 4, static_cast<uLong>(block.input.size()));
+}
+
+////////////////////////////////////////////////////////
+/// StringOutputStream /////////////////////////////////
+////////////////////////////////////////////////////////
+
+void StringOutputStream::write(const char* data, int len) { this->data.append(data, static_cast<size_t>(len)); }
+
+void StringOutputStream::close() {}
+
+auto StringOutputStream::getString() const -> const std::string& { return this->data; }
@@ -0,0 +1,89 @@
+#include "util/ParallelLoop.h"
+
+#include <algorithm>
+
+using namespace xoj::util;
+
+ParallelLoop::ParallelLoop(unsigned int maxThreads) {
+    unsigned int threads = maxThreads == 0 ? std::thread::hardware_concurrency() : maxThreads;
+    this->threadCount = std::clamp(threads, 1U, MAX_THREADS);
+}
+
+ParallelLoop::~ParallelLoop() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->loopStarted.notify_all();
+
+    for (std::thread& worker: this->workers) {
+        worker.join();
+    }
+}
+
+auto ParallelLoop::getThreadCount() const -> unsigned int { return this->threadCount; }
+
+void ParallelLoop::run(size_t count, const std::function<void(size_t)>& f) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1 || this->threadCount == 1) {
+        for (size_t i = 0; i < count; i++) {
+            f(i);
+        }
+        return;
+    }
+
+    if (this->workers.empty()) {
+        for (unsigned int i = 1; i < this->threadCount; i++) {
+            this->workers.emplace_back(&ParallelLoop::workerLoop, this);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->body = &f;
+        this->count = count;
+        this->next = 0;
+        this->generation++;
+        this->busyWorkers = static_cast<unsigned int>(this->workers.size());
+    }
+    this->loopStarted.notify_all();
+
+    runIterations();
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->loopDone.wait(lock, [this]() { return this->busyWorkers == 0; });
+    this->body = nullptr;
+}
+
+void ParallelLoop::runIterations() {
+    for (size_t i = this->next++; i < this->count; i = this->next++) {
+        (*this->body)(i);
+    }
+}
+
+void ParallelLoop::workerLoop() {
+    size_t done = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->loopStarted.wait(lock, [&]() { return this->stopping || this->generation != done; });
+            if (this->stopping) {
+                return;
+            }
+            done = this->generation;
+        }
+
+        runIterations();
+
+        bool last = false;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            last = --this->busyWorkers == 0;
+        }
+        if (last) {
+            this->loopDone.notify_one();
+        }
+    }
+}
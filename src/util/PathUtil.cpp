@@ -14,6 +14,11 @@
 #include "util/XojMsgBox.h"
 #include "util/i18n.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #ifdef GHC_FILESYSTEM
 // Fix of ghc::filesystem bug (path::operator/=() won't support string_views)
 constexpr auto const* CONFIG_FOLDER_NAME = "xournalpp";
@@ -305,6 +310,19 @@ bool Util::safeRenameFile(fs::path const& from, fs::path const& to) {
     return true;
 }
 
+void Util::syncFile(fs::path const& path) {
+#ifndef _WIN32
+    fs::path folder = path.parent_path();
+    for (const fs::path& p: {path, folder.empty() ? fs::path(".") : folder}) {
+        int fd = open(p.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            fsync(fd);
+            close(fd);
+        }
+    }
+#endif
+}
+
 auto Util::getDataPath() -> fs::path {
 #ifdef _WIN32
     TCHAR szFileName[MAX_PATH];
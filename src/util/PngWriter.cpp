@@ -0,0 +1,218 @@
+#include "util/PngWriter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#include "util/i18n.h"
+
+using namespace xoj::util;
+
+static constexpr unsigned char PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+/**
+ * 4 bytes per pixel: RGBA, 8 bits per channel
+ */
+static constexpr size_t BYTES_PER_PIXEL = 4;
+
+static void putUint32(unsigned char* dest, uint32_t value) {
+    dest[0] = static_cast<unsigned char>(value >> 24U);
+    dest[1] = static_cast<unsigned char>(value >> 16U);
+    dest[2] = static_cast<unsigned char>(value >> 8U);
+    dest[3] = static_cast<unsigned char>(value);
+}
+
+static auto paeth(int a, int b, int c) -> int {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+/**
+ * Unpremultiplies the pixels like cairo_surface_write_to_png()
+ */
+static void toRgba(const uint32_t* pixels, uint32_t width, unsigned char* rgba) {
+    for (uint32_t i = 0; i < width; i++, rgba += BYTES_PER_PIXEL) {
+        uint32_t p = pixels[i];
+        uint32_t alpha = p >> 24U;
+        if (alpha == 0) {
+            std::fill(rgba, rgba + BYTES_PER_PIXEL, 0);
+            continue;
+        }
+        uint32_t channels[3] = {(p >> 16U) & 0xffU, (p >> 8U) & 0xffU, p & 0xffU};
+        for (int c = 0; c < 3; c++) {
+            rgba[c] = static_cast<unsigned char>((channels[c] * 255U + alpha / 2) / alpha);
+        }
+        rgba[3] = static_cast<unsigned char>(alpha);
+    }
+}
+
+PngWriter::PngWriter(fs::path file, uint32_t width, uint32_t height):
+        width(width), height(height), file(std::move(file)) {
+    const size_t rowBytes = static_cast<size_t>(width) * BYTES_PER_PIXEL;
+    this->previous.assign(rowBytes, 0);
+    this->current.resize(rowBytes);
+    for (auto& f: this->filtered) { f.resize(rowBytes + 1); }
+    this->compressed.resize(CHUNK_SIZE);
+
+    this->out.open(this->file, std::ios::binary | std::ios::trunc);
+    if (!this->out.is_open()) {
+        setError(FS(_F("Error opening file: \"{1}\"") % this->file.u8string()));
+        return;
+    }
+    if (deflateInit(&this->stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        setError(_("Could not initialize the compression of the image"));
+        return;
+    }
+    this->streamOpen = true;
+    this->stream.next_out = this->compressed.data();
+    this->stream.avail_out = static_cast<uInt>(this->compressed.size());
+
+    this->out.write(reinterpret_cast<const char*>(PNG_SIGNATURE), sizeof(PNG_SIGNATURE));
+
+    // Bit depth 8, color type 6 (RGBA), default compression, filters and no interlacing
+    unsigned char header[13] = {};
+    putUint32(header, width);
+    putUint32(header + 4, height);
+    header[8] = 8;
+    header[9] = 6;
+    writeChunk("IHDR", header, sizeof(header));
+}
+
+PngWriter::~PngWriter() {
+    if (this->streamOpen) {
+        deflateEnd(&this->stream);
+    }
+}
+
+auto PngWriter::getLastError() const -> const std::string& { return this->error; }
+
+void PngWriter::setError(const std::string& message) {
+    if (this->error.empty()) {
+        this->error = message;
+    }
+    this->closed = true;
+}
+
+void PngWriter::writeChunk(const char* type, const unsigned char* data, size_t len) {
+    unsigned char length[4];
+    putUint32(length, static_cast<uint32_t>(len));
+    uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(type), 4);
+    if (len > 0) {
+        crc = crc32(crc, data, static_cast<uInt>(len));
+    }
+    unsigned char checksum[4];
+    putUint32(checksum, static_cast<uint32_t>(crc));
+
+    this->out.write(reinterpret_cast<const char*>(length), 4);
+    this->out.write(type, 4);
+    this->out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(len));
+    this->out.write(reinterpret_cast<const char*>(checksum), 4);
+    if (!this->out) {
+        setError(FS(_F("Error writing file: \"{1}\"") % this->file.u8string()));
+    }
+}
+
+auto PngWriter::deflateInput(int flush) -> bool {
+    while (!this->closed) {
+        int status = deflate(&this->stream, flush);
+        if (status == Z_STREAM_ERROR) {
+            setError(_("Could not compress the image"));
+            return false;
+        }
+        size_t full = this->compressed.size() - this->stream.avail_out;
+        bool finished = status == Z_STREAM_END;
+        if (this->stream.avail_out == 0 || (finished && full > 0)) {
+            writeChunk("IDAT", this->compressed.data(), full);
+            this->stream.next_out = this->compressed.data();
+            this->stream.avail_out = static_cast<uInt>(this->compressed.size());
+        }
+        if (flush == Z_FINISH ? finished : this->stream.avail_in == 0 && this->stream.avail_out > 0) {
+            return !this->closed;
+        }
+    }
+    return false;
+}
+
+auto PngWriter::writeRow(const uint32_t* pixels) -> bool {
+    if (this->closed || this->rows >= this->height) {
+        return false;
+    }
+
+    toRgba(pixels, this->width, this->current.data());
+
+    // None, Sub, Up, Average and Paeth, see the PNG specification
+    const size_t rowBytes = this->current.size();
+    size_t best = 0;
+    size_t bestSum = SIZE_MAX;
+    for (size_t type = 0; type < 5; type++) {
+        unsigned char* dest = this->filtered[type].data();
+        dest[0] = static_cast<unsigned char>(type);
+        size_t sum = 0;
+        for (size_t i = 0; i < rowBytes; i++) {
+            int x = this->current[i];
+            int a = i >= BYTES_PER_PIXEL ? this->current[i - BYTES_PER_PIXEL] : 0;
+            int b = this->previous[i];
+            int c = i >= BYTES_PER_PIXEL ? this->previous[i - BYTES_PER_PIXEL] : 0;
+            int predicted = 0;
+            switch (type) {
+                case 1:
+                    predicted = a;
+                    break;
+                case 2:
+                    predicted = b;
+                    break;
+                case 3:
+                    predicted = (a + b) / 2;
+                    break;
+                case 4:
+                    predicted = paeth(a, b, c);
+                    break;
+                default:
+                    break;
+            }
+            auto value = static_cast<unsigned char>(x - predicted);
+            dest[i + 1] = value;
+            sum += static_cast<size_t>(std::abs(static_cast<int>(static_cast<signed char>(value))));
+        }
+        if (sum < bestSum) {
+            best = type;
+            bestSum = sum;
+        }
+    }
+    std::swap(this->previous, this->current);
+    this->rows++;
+
+    this->stream.next_in = this->filtered[best].data();
+    this->stream.avail_in = static_cast<uInt>(rowBytes + 1);
+    return deflateInput(Z_NO_FLUSH);
+}
+
+auto PngWriter::close() -> bool {
+    if (this->closed) {
+        return false;
+    }
+    if (this->rows != this->height) {
+        setError(_("The image is incomplete"));
+        return false;
+    }
+
+    this->stream.next_in = nullptr;
+    this->stream.avail_in = 0;
+    if (!deflateInput(Z_FINISH)) {
+        return false;
+    }
+    writeChunk("IEND", nullptr, 0);
+    this->out.close();
+    if (this->closed || this->out.fail()) {
+        setError(FS(_F("Error writing file: \"{1}\"") % this->file.u8string()));
+        return false;
+    }
+    this->closed = true;
+    return true;
+}
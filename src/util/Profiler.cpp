@@ -0,0 +1,252 @@
+#include "util/Profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace xoj::util;
+
+static auto toMs(Profiler::Clock::duration duration) -> double {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+static void writeJsonString(std::ostream& out, const char* str) {
+    out << '"';
+    for (const char* c = str; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\';
+        }
+        out << *c;
+    }
+    out << '"';
+}
+
+static void writeCsvString(std::ostream& out, const std::string& str) {
+    out << '"';
+    for (char c: str) {
+        if (c == '"') {
+            out << '"';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+Profiler::Scope::Scope(const char* name, const char* category):
+        name(name), category(category), active(Profiler::getInstance().isEnabled()) {
+    if (this->active) {
+        this->start = Clock::now();
+    }
+}
+
+Profiler::Scope::~Scope() {
+    if (this->active) {
+        Profiler::getInstance().addTiming(this->name, this->category, this->start, Clock::now() - this->start);
+    }
+}
+
+auto Profiler::getInstance() -> Profiler& {
+    // Never destroyed: the worker threads may still report while the process exits
+    static auto* profiler = new Profiler();
+    return *profiler;
+}
+
+void Profiler::setEnabled(bool enabled) { this->enabled = enabled; }
+
+auto Profiler::isEnabled() const -> bool { return this->enabled.load(std::memory_order_relaxed); }
+
+auto Profiler::toMicroseconds(Clock::time_point time) const -> int64_t {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - this->origin).count();
+}
+
+auto Profiler::getThreadNumber(std::thread::id id) -> int {
+    auto it = this->threads.find(id);
+    if (it == this->threads.end()) {
+        it = this->threads.emplace(id, static_cast<int>(this->threads.size()) + 1).first;
+    }
+    return it->second;
+}
+
+void Profiler::addEvent(const Event& event) {
+    if (this->events.size() >= MAX_EVENTS) {
+        this->events.pop_front();
+    }
+    this->events.push_back(event);
+}
+
+void Profiler::addTiming(const char* name, const char* category, Clock::time_point start,
+                         Clock::duration duration) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    double ms = toMs(duration);
+
+    std::lock_guard lock(this->mutex);
+    Timing& timing = this->timings[name];
+    timing.count++;
+    timing.totalMs += ms;
+    timing.maxMs = std::max(timing.maxMs, ms);
+    timing.lastMs = ms;
+
+    addEvent({name, category, 'X', toMicroseconds(start),
+              std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 0,
+              getThreadNumber(std::this_thread::get_id())});
+}
+
+void Profiler::setCounter(const char* name, int64_t value) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    std::lock_guard lock(this->mutex);
+    auto it = this->counters.find(name);
+    if (it != this->counters.end() && it->second == value) {
+        return;
+    }
+    this->counters[name] = value;
+    addEvent({name, "counter", 'C', toMicroseconds(Clock::now()), 0, value, 0});
+}
+
+void Profiler::countAccess(const char* cache, bool hit) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    std::lock_guard lock(this->mutex);
+    CacheAccesses& accesses = this->caches[cache];
+    (hit ? accesses.hits : accesses.misses)++;
+}
+
+void Profiler::markInput() {
+    if (!isEnabled()) {
+        return;
+    }
+
+    std::lock_guard lock(this->mutex);
+    auto now = Clock::now();
+    if (this->pendingInput == Clock::time_point{}) {
+        this->pendingInput = now;
+    }
+    if (this->pendingUnqueuedInput == Clock::time_point{}) {
+        this->pendingUnqueuedInput = now;
+    }
+}
+
+void Profiler::markDrawQueued() {
+    if (!isEnabled()) {
+        return;
+    }
+
+    Clock::time_point input;
+    {
+        std::lock_guard lock(this->mutex);
+        input = this->pendingUnqueuedInput;
+        this->pendingUnqueuedInput = Clock::time_point{};
+    }
+    if (input != Clock::time_point{}) {
+        addTiming(INPUT_TO_QUEUE_DRAW, "input", input, Clock::now() - input);
+    }
+}
+
+void Profiler::markPainted() {
+    if (!isEnabled()) {
+        return;
+    }
+
+    Clock::time_point input;
+    {
+        std::lock_guard lock(this->mutex);
+        input = this->pendingInput;
+        this->pendingInput = Clock::time_point{};
+    }
+    if (input != Clock::time_point{}) {
+        addTiming(INPUT_TO_PAINT, "input", input, Clock::now() - input);
+    }
+}
+
+auto Profiler::getTimings() const -> std::map<std::string, Timing> {
+    std::lock_guard lock(this->mutex);
+    return this->timings;
+}
+
+auto Profiler::getCounters() const -> std::map<std::string, int64_t> {
+    std::lock_guard lock(this->mutex);
+    return this->counters;
+}
+
+auto Profiler::getCacheAccesses() const -> std::map<std::string, CacheAccesses> {
+    std::lock_guard lock(this->mutex);
+    return this->caches;
+}
+
+auto Profiler::getSummary() const -> std::vector<std::string> {
+    std::vector<std::string> lines;
+
+    std::lock_guard lock(this->mutex);
+    for (auto& [name, timing]: this->timings) {
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(2) << name << ": " << timing.lastMs << " ms, avg "
+             << timing.totalMs / static_cast<double>(timing.count) << ", max " << timing.maxMs << " (" << timing.count
+             << ")";
+        lines.push_back(line.str());
+    }
+    for (auto& [name, value]: this->counters) { lines.push_back(name + ": " + std::to_string(value)); }
+    for (auto& [name, accesses]: this->caches) {
+        uint64_t total = accesses.hits + accesses.misses;
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1) << name << ": "
+             << (total ? 100.0 * static_cast<double>(accesses.hits) / static_cast<double>(total) : 0.0) << "% hits ("
+             << total << ")";
+        lines.push_back(line.str());
+    }
+    return lines;
+}
+
+void Profiler::writeTrace(std::ostream& out) const {
+    std::lock_guard lock(this->mutex);
+
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (const Event& event: this->events) {
+        out << (first ? "\n" : ",\n") << "{\"name\":";
+        writeJsonString(out, event.name);
+        out << ",\"cat\":";
+        writeJsonString(out, event.category);
+        out << ",\"ph\":\"" << event.phase << "\",\"ts\":" << event.startUs << ",\"pid\":1,\"tid\":" << event.thread;
+        if (event.phase == 'X') {
+            out << ",\"dur\":" << event.durationUs;
+        } else {
+            out << ",\"args\":{\"value\":" << event.value << "}";
+        }
+        out << "}";
+        first = false;
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void Profiler::writeCsv(std::ostream& out) const {
+    std::lock_guard lock(this->mutex);
+
+    out << "name,count,total ms,average ms,max ms,hits,misses\n";
+    out << std::fixed << std::setprecision(3);
+    for (auto& [name, timing]: this->timings) {
+        writeCsvString(out, name);
+        out << "," << timing.count << "," << timing.totalMs << "," << timing.totalMs / static_cast<double>(timing.count)
+            << "," << timing.maxMs << ",,\n";
+    }
+    for (auto& [name, accesses]: this->caches) {
+        writeCsvString(out, name);
+        out << ",,,,," << accesses.hits << "," << accesses.misses << "\n";
+    }
+}
+
+void Profiler::reset() {
+    std::lock_guard lock(this->mutex);
+    this->timings.clear();
+    this->counters.clear();
+    this->caches.clear();
+    this->events.clear();
+    this->pendingInput = Clock::time_point{};
+    this->pendingUnqueuedInput = Clock::time_point{};
+}
@@ -8,16 +8,6 @@ Range::Range(double x, double y) {
     this->y2 = y;
 }
 
-Range::~Range() = default;
-
-void Range::addPoint(double x, double y) {
-    this->x1 = std::min(this->x1, x);
-    this->x2 = std::max(this->x2, x);
-
-    this->y1 = std::min(this->y1, y);
-    this->y2 = std::max(this->y2, y);
-}
-
 auto Range::getX() const -> double { return this->x1; }
 
 auto Range::getY() const -> double { return this->y1; }
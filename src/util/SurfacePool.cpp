@@ -0,0 +1,124 @@
+#include "util/SurfacePool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace xoj::util;
+
+static const cairo_user_data_key_t LEASE_KEY = {};
+
+SurfacePool::SurfacePool(size_t maxBytes): state(std::make_shared<State>()) { this->state->maxBytes = maxBytes; }
+
+auto SurfacePool::getInstance() -> SurfacePool& {
+    static SurfacePool pool;
+    return pool;
+}
+
+auto SurfacePool::createSurface(cairo_format_t format, int width, int height) -> cairo_surface_t* {
+    return getInstance().create(format, width, height);
+}
+
+auto SurfacePool::sizeClass(size_t bytes) -> size_t {
+    size_t power = 1;
+    while (power <= bytes / 2) { power *= 2; }
+    size_t step = std::max<size_t>(power / 4, 1);
+    return (bytes + step - 1) / step * step;
+}
+
+auto SurfacePool::create(cairo_format_t format, int width, int height) -> cairo_surface_t* {
+    int stride = cairo_format_stride_for_width(format, width);
+    if (stride <= 0 || height <= 0 || static_cast<size_t>(stride) * static_cast<size_t>(height) < MIN_BYTES) {
+        return cairo_image_surface_create(format, width, height);
+    }
+
+    size_t bytes = static_cast<size_t>(stride) * static_cast<size_t>(height);
+    size_t size = sizeClass(bytes);
+    unsigned char* data = this->state->take(size);
+    if (data) {
+        std::memset(data, 0, bytes);
+    } else {
+        // The pages of a new allocation are zeroed already
+        data = static_cast<unsigned char*>(std::calloc(size, 1));
+        if (!data) {
+            return cairo_image_surface_create(format, width, height);
+        }
+    }
+
+    cairo_surface_t* surface = cairo_image_surface_create_for_data(data, format, width, height, stride);
+    auto* lease = new Lease{this->state, data, size};
+    cairo_status_t status = cairo_surface_set_user_data(surface, &LEASE_KEY, lease, [](void* p) {
+        auto* lease = static_cast<Lease*>(p);
+        lease->state->giveBack(lease->data, lease->size);
+        delete lease;
+    });
+    if (status != CAIRO_STATUS_SUCCESS) {
+        // Also the case of an error surface
+        cairo_surface_destroy(surface);
+        delete lease;
+        std::free(data);
+        return cairo_image_surface_create(format, width, height);
+    }
+    return surface;
+}
+
+void SurfacePool::setMaxBytes(size_t newMaxBytes) {
+    std::lock_guard lock(this->state->mutex);
+    this->state->maxBytes = newMaxBytes;
+    this->state->trim();
+}
+
+void SurfacePool::clear() {
+    std::lock_guard lock(this->state->mutex);
+    for (auto& [size, buffers]: this->state->idle) {
+        for (unsigned char* data: buffers) { std::free(data); }
+    }
+    this->state->idle.clear();
+    this->state->idleBytes = 0;
+}
+
+auto SurfacePool::getIdleBytes() const -> size_t {
+    std::lock_guard lock(this->state->mutex);
+    return this->state->idleBytes;
+}
+
+auto SurfacePool::State::take(size_t size) -> unsigned char* {
+    std::lock_guard lock(this->mutex);
+    auto it = this->idle.find(size);
+    if (it == this->idle.end() || it->second.empty()) {
+        return nullptr;
+    }
+    unsigned char* data = it->second.back();
+    it->second.pop_back();
+    this->idleBytes -= size;
+    return data;
+}
+
+void SurfacePool::State::giveBack(unsigned char* data, size_t size) {
+    std::lock_guard lock(this->mutex);
+    // A single large buffer, e.g. of an export, would hold most of the budget for a long time
+    if (size > this->maxBytes / 4 || this->idleBytes + size > this->maxBytes) {
+        std::free(data);
+        return;
+    }
+    this->idle[size].push_back(data);
+    this->idleBytes += size;
+}
+
+void SurfacePool::State::trim() {
+    // The largest buffers first: they are the least likely to be reused
+    for (auto it = this->idle.rbegin(); it != this->idle.rend() && this->idleBytes > this->maxBytes; ++it) {
+        auto& buffers = it->second;
+        while (!buffers.empty() && this->idleBytes > this->maxBytes) {
+            std::free(buffers.back());
+            buffers.pop_back();
+            this->idleBytes -= it->first;
+        }
+    }
+}
+
+SurfacePool::State::~State() {
+    for (auto& [size, buffers]: this->idle) {
+        for (unsigned char* data: buffers) { std::free(data); }
+    }
+}
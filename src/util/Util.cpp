@@ -1,7 +1,12 @@
 #include "util/Util.h"
 
-#include <array>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
 
 #include <unistd.h>
 
@@ -10,6 +15,58 @@
 #include "util/XojMsgBox.h"
 #include "util/i18n.h"
 
+namespace {
+/**
+ * The callbacks of one priority for the UI thread: pushed by any thread without locking, and run in order by a single
+ * idle source, instead of one source per callback
+ */
+class UiDispatchQueue {
+public:
+    explicit UiDispatchQueue(gint priority): priority(priority) {}
+
+    void push(std::function<void()>&& callback) {
+        auto* node = new Node{std::move(callback), this->head.load(std::memory_order_relaxed)};
+        while (!this->head.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                                 std::memory_order_relaxed)) {}
+        // The first callback of an empty queue schedules the source
+        if (node->next == nullptr) {
+            gdk_threads_add_idle_full(this->priority, reinterpret_cast<GSourceFunc>(drain), this, nullptr);
+        }
+    }
+
+private:
+    struct Node {
+        std::function<void()> callback;
+        Node* next;
+    };
+
+    /**
+     * This method is called in the GTK UI Thread: runs the callbacks pushed so far, the ones pushed meanwhile schedule
+     * the next source
+     */
+    static auto drain(UiDispatchQueue* self) -> gboolean {
+        // Pushed on a stack: the last one first
+        Node* stack = self->head.exchange(nullptr, std::memory_order_acquire);
+        Node* queue = nullptr;
+        while (stack) {
+            Node* next = stack->next;
+            stack->next = queue;
+            queue = stack;
+            stack = next;
+        }
+        while (queue) {
+            Node* next = queue->next;
+            queue->callback();
+            delete queue;
+            queue = next;
+        }
+        return G_SOURCE_REMOVE;
+    }
+
+    gint priority;
+    std::atomic<Node*> head{nullptr};
+};
+
 struct CallbackUiData {
     explicit CallbackUiData(std::function<void()> callback): callback(std::move(callback)) {}
 
@@ -19,13 +76,14 @@ struct CallbackUiData {
 /**
  * This method is called in the GTK UI Thread
  */
-static auto execInUiThreadCallback(CallbackUiData* cb) -> bool {
+auto execInUiThreadCallback(CallbackUiData* cb) -> bool {
     cb->callback();
 
     delete cb;
     // Do not call again
     return false;
 }
+}  // namespace
 
 /**
  * Execute the callback in the UI Thread.
@@ -33,9 +91,58 @@ static auto execInUiThreadCallback(CallbackUiData* cb) -> bool {
  * Make sure the container class is not deleted before the UI stuff is finished!
  */
 void Util::execInUiThread(std::function<void()>&& callback, gint priority) {
-    // Note: nullptr = GDestroyNotify notify.
-    gdk_threads_add_idle_full(priority, reinterpret_cast<GSourceFunc>(execInUiThreadCallback),
-                              new CallbackUiData(std::move(callback)), nullptr);
+    static UiDispatchQueue highQueue(G_PRIORITY_HIGH);
+    static UiDispatchQueue defaultQueue(G_PRIORITY_DEFAULT);
+    static UiDispatchQueue idleQueue(G_PRIORITY_DEFAULT_IDLE);
+    static UiDispatchQueue lowQueue(G_PRIORITY_LOW);
+
+    switch (priority) {
+        case G_PRIORITY_HIGH:
+            highQueue.push(std::move(callback));
+            break;
+        case G_PRIORITY_DEFAULT:
+            defaultQueue.push(std::move(callback));
+            break;
+        case G_PRIORITY_DEFAULT_IDLE:
+            idleQueue.push(std::move(callback));
+            break;
+        case G_PRIORITY_LOW:
+            lowQueue.push(std::move(callback));
+            break;
+        default:
+            // Note: nullptr = GDestroyNotify notify.
+            gdk_threads_add_idle_full(priority, reinterpret_cast<GSourceFunc>(execInUiThreadCallback),
+                                      new CallbackUiData(std::move(callback)), nullptr);
+            break;
+    }
+}
+
+void Util::queueDrawInUiThread(GtkWidget* widget) {
+    static std::mutex mutex;
+    static std::vector<GtkWidget*> pending;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (std::find(pending.begin(), pending.end(), widget) != pending.end()) {
+        return;
+    }
+    // The widget may be destroyed meanwhile
+    g_object_ref(widget);
+    pending.push_back(widget);
+    if (pending.size() > 1) {
+        return;
+    }
+
+    execInUiThread([]() {
+        std::vector<GtkWidget*> widgets;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            widgets.swap(pending);
+        }
+        for (GtkWidget* w: widgets) {
+            gtk_widget_queue_draw(w);
+            g_object_unref(w);
+        }
+    });
 }
 
 void Util::cairo_set_source_rgbi(cairo_t* cr, Color color) {
@@ -60,13 +167,16 @@ auto Util::paintBackgroundWhite(GtkWidget* widget, cairo_t* cr, void*) -> gboole
     return false;
 }
 
-void Util::writeCoordinateString(OutputStream* out, double xVal, double yVal) {
-    std::array<char, G_ASCII_DTOSTR_BUF_SIZE> coordString{};
-    g_ascii_formatd(coordString.data(), G_ASCII_DTOSTR_BUF_SIZE, Util::PRECISION_FORMAT_STRING, xVal);
-    out->write(coordString.data());
-    out->write(" ");
-    g_ascii_formatd(coordString.data(), G_ASCII_DTOSTR_BUF_SIZE, Util::PRECISION_FORMAT_STRING, yVal);
-    out->write(coordString.data());
+auto Util::formatCoordinate(char* buffer, double value) -> char* {
+    // std::to_chars formats like printf in the C locale. Like g_ascii_formatd, the result is cut to the buffer size
+    // of G_ASCII_DTOSTR_BUF_SIZE, including the null terminator.
+    char* last = buffer + G_ASCII_DTOSTR_BUF_SIZE - 1;
+    auto [end, ec] = std::to_chars(buffer, last, value, std::chars_format::fixed, PRECISION_DIGITS);
+    if (ec != std::errc()) {
+        g_ascii_formatd(buffer, G_ASCII_DTOSTR_BUF_SIZE, PRECISION_FORMAT_STRING, value);
+        return buffer + std::strlen(buffer);
+    }
+    return end;
 }
 
 void Util::systemWithMessage(const char* command) {
@@ -99,3 +99,20 @@ void XojMsgBox::showHelp(GtkWindow* win) {
     }
 #endif
 }
+
+void XojMsgBox::showUri(GtkWindow* win, const std::string& uri) {
+#ifdef _WIN32
+    // Like showHelp
+    ShellExecute(nullptr, "open", uri.c_str(), nullptr, nullptr, SW_SHOW);
+#else
+    GError* error = nullptr;
+    gtk_show_uri(gtk_window_get_screen(win), uri.c_str(), gtk_get_current_event_time(), &error);
+
+    if (error) {
+        string msg = FS(_F("Could not open the link \"{1}\": {2}") % uri % error->message);
+        XojMsgBox::showErrorToUser(win, msg);
+
+        g_error_free(error);
+    }
+#endif
+}
@@ -1,7 +1,7 @@
 #include "util/XojPreviewExtractor.h"
 
-#include <array>
 #include <cstring>
+#include <string>
 
 #include <glib.h>
 #include <zip.h>
@@ -19,6 +19,9 @@ const int TAG_PAGE_NAME_LEN = strlen(TAG_PAGE_NAME);
 const char* TAG_PREVIEW_END_NAME = "/preview";
 const int TAG_PREVIEW_END_NAME_LEN = strlen(TAG_PREVIEW_END_NAME);
 constexpr auto BUF_SIZE = 8192;
+// The preview is at the start of the file: give up on files where it does not end within this size
+constexpr size_t MAX_PREVIEW_SEARCH = 4 * 1024 * 1024;
+constexpr const char* ZIP_THUMBNAIL = "thumbnails/thumbnail.png";
 
 XojPreviewExtractor::XojPreviewExtractor() = default;
 
@@ -110,13 +113,20 @@ auto XojPreviewExtractor::readFile(const fs::path& file) -> PreviewExtractResult
             return PREVIEW_RESULT_COULD_NOT_OPEN_FILE;
         }
 
-        // The <preview> Tag is within the first 179 Bytes
-        // The Preview should end within the first 8k
-
-        std::array<char, BUF_SIZE> buffer{};
-        int readLen = gzread(fp, buffer.data(), BUF_SIZE);
-
-        PreviewExtractResult result = readPreview(buffer.data(), readLen);
+        // The <preview> Tag is within the first 179 Bytes, the preview usually ends within the first 8k: read the
+        // file chunk by chunk until the end of the preview or the first page, never the whole document
+        std::string buffer;
+        PreviewExtractResult result = PREVIEW_RESULT_ERROR_READING_PREVIEW;
+        while (result == PREVIEW_RESULT_ERROR_READING_PREVIEW && buffer.size() < MAX_PREVIEW_SEARCH) {
+            size_t oldSize = buffer.size();
+            buffer.resize(oldSize + BUF_SIZE);
+            int readLen = gzread(fp, buffer.data() + oldSize, BUF_SIZE);
+            if (readLen <= 0) {
+                break;
+            }
+            buffer.resize(oldSize + static_cast<size_t>(readLen));
+            result = readPreview(buffer.data(), static_cast<int>(buffer.size()));
+        }
 
         gzclose(fp);
         return result;
@@ -125,9 +135,10 @@ auto XojPreviewExtractor::readFile(const fs::path& file) -> PreviewExtractResult
         return PREVIEW_RESULT_COULD_NOT_OPEN_FILE;
     }
 
+    // Only the central directory and the thumbnail entry are read
+    zip_int64_t thumbIndex = zip_name_locate(zipFp, ZIP_THUMBNAIL, 0);
     zip_stat_t thumbStat;
-    int statStatus = zip_stat(zipFp, "thumbnails/thumbnail.png", 0, &thumbStat);
-    if (statStatus != 0) {
+    if (thumbIndex < 0 || zip_stat_index(zipFp, static_cast<zip_uint64_t>(thumbIndex), 0, &thumbStat) != 0) {
         zip_close(zipFp);
         return PREVIEW_RESULT_NO_PREVIEW;
     }
@@ -139,7 +150,7 @@ auto XojPreviewExtractor::readFile(const fs::path& file) -> PreviewExtractResult
         return PREVIEW_RESULT_ERROR_READING_PREVIEW;
     }
 
-    zip_file_t* thumb = zip_fopen(zipFp, "thumbnails/thumbnail.png", 0);
+    zip_file_t* thumb = zip_fopen_index(zipFp, static_cast<zip_uint64_t>(thumbIndex), 0);
 
     if (!thumb) {
         zip_close(zipFp);
@@ -149,9 +160,11 @@ auto XojPreviewExtractor::readFile(const fs::path& file) -> PreviewExtractResult
     data = static_cast<unsigned char*>(g_malloc(thumbStat.size));
     zip_uint64_t readBytes = 0;
     while (readBytes < dataLen) {
-        zip_int64_t read = zip_fread(thumb, data, thumbStat.size);
-        if (read == -1) {
+        zip_int64_t read = zip_fread(thumb, data + readBytes, dataLen - readBytes);
+        if (read <= 0) {
             g_free(data);
+            data = nullptr;
+            dataLen = 0;
             zip_fclose(thumb);
             zip_close(zipFp);
             return PREVIEW_RESULT_ERROR_READING_PREVIEW;
@@ -0,0 +1,95 @@
+/*
+ * Xournal++
+ *
+ * A vector shared by its copies until it is modified
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace xoj::util {
+
+/**
+ * @brief A vector whose copies share their elements until one of them is modified
+ *
+ * Copying a CowVector does not copy the elements. The read interface is const only, so that the reads never copy
+ * them, even through a mutable member. mut() returns the vector to modify, which is copied first if it is shared.
+ *
+ * The shared elements can be read by several threads at once. A CowVector itself is not thread safe: mut() must not
+ * run while the same CowVector is read.
+ */
+template <typename T>
+class CowVector {
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    CowVector() = default;
+    CowVector(std::vector<T> elements) { *this = std::move(elements); }
+
+    CowVector& operator=(std::vector<T> elements) {
+        this->shared = elements.empty() ? nullptr : std::make_shared<std::vector<T>>(std::move(elements));
+        return *this;
+    }
+
+public:
+    const std::vector<T>& get() const { return this->shared ? *this->shared : emptyVector(); }
+    operator const std::vector<T>&() const { return get(); }
+
+    size_t size() const { return get().size(); }
+    bool empty() const { return get().empty(); }
+    size_t capacity() const { return get().capacity(); }
+
+    const T& operator[](size_t i) const { return get()[i]; }
+    const T& at(size_t i) const { return get().at(i); }
+    const T& front() const { return get().front(); }
+    const T& back() const { return get().back(); }
+    const T* data() const { return get().data(); }
+
+    const_iterator begin() const { return get().begin(); }
+    const_iterator end() const { return get().end(); }
+    const_iterator cbegin() const { return get().cbegin(); }
+    const_iterator cend() const { return get().cend(); }
+
+    /**
+     * @return The vector to modify, not shared with any other copy anymore
+     */
+    std::vector<T>& mut() {
+        if (!this->shared) {
+            this->shared = std::make_shared<std::vector<T>>();
+        } else if (this->shared.use_count() > 1) {
+            this->shared = std::make_shared<std::vector<T>>(*this->shared);
+        }
+        return *this->shared;
+    }
+
+    /**
+     * Releases the elements, without copying them if they are shared
+     */
+    void clear() { this->shared.reset(); }
+
+    /**
+     * @return Whether the elements are shared with another copy
+     */
+    bool isShared() const { return this->shared && this->shared.use_count() > 1; }
+
+private:
+    static const std::vector<T>& emptyVector() {
+        static const std::vector<T> empty;
+        return empty;
+    }
+
+    std::shared_ptr<std::vector<T>> shared;
+};
+
+}  // namespace xoj::util
@@ -0,0 +1,101 @@
+/*
+ * Xournal++
+ *
+ * Reads a gzip file, inflating its members in parallel when possible
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <zlib.h>
+
+#include "filesystem.h"
+
+namespace xoj::util {
+class ParallelLoop;
+};
+
+/**
+ * @brief Reads the uncompressed data of a gzip file as a stream
+ *
+ * The files written by GzOutputStream are a sequence of members which locate each other (see
+ * GzUtil::MEMBER_SIZE_ID): a few of them are inflated at once on several threads, ahead of the reads. Any other file,
+ * e.g. written by an older version, is read with gzread on the calling thread.
+ */
+class GzInputStream {
+public:
+    explicit GzInputStream(const fs::path& file);
+    ~GzInputStream();
+
+    GzInputStream(const GzInputStream&) = delete;
+    GzInputStream& operator=(const GzInputStream&) = delete;
+
+public:
+    /**
+     * @return false if the file could not be opened
+     */
+    bool isOpen() const;
+
+    /**
+     * @return The number of bytes read, 0 at the end of the data, -1 on error (see getLastError())
+     */
+    int64_t read(char* buffer, size_t len);
+
+    /**
+     * @return Whether the members are inflated in parallel
+     */
+    bool isParallel() const;
+
+    const std::string& getLastError() const;
+
+    /**
+     * Number of members inflated at once, per thread
+     */
+    static constexpr size_t MEMBERS_PER_THREAD = 2;
+
+private:
+    /**
+     * Locate the members of the file read in memory
+     * @return false if one of them was not written by GzOutputStream
+     */
+    bool locateMembers();
+
+    /**
+     * Inflate the next members into the batch
+     * @return false on error
+     */
+    bool inflateBatch();
+
+private:
+    gzFile fp = nullptr;
+
+    /**
+     * The compressed file and the offset and size of each of its members, in parallel mode
+     */
+    std::string compressed;
+    std::vector<std::pair<size_t, size_t>> members;
+    size_t nextMember = 0;
+    std::unique_ptr<xoj::util::ParallelLoop> loop;
+
+    /**
+     * The inflated members not yet read, and the position of the read in them
+     */
+    std::vector<std::string> batch;
+    size_t batchIndex = 0;
+    size_t batchOffset = 0;
+
+    bool failed = false;
+    std::string error;
+    fs::path file;
+};
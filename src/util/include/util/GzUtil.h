@@ -11,6 +11,9 @@
 
 #pragma once
 
+#include <cstddef>
+#include <string>
+
 #include <zlib.h>
 
 #include "filesystem.h"
@@ -22,4 +25,21 @@ private:
 
 public:
     static gzFile openPath(const fs::path& path, const std::string& flags);
+
+    /**
+     * The gzip files written by GzOutputStream are a sequence of independent members. The header of each member has
+     * an extra subfield with this id, holding the size of the whole member (32 bits, little endian), so that the
+     * members can be located without decompressing them, see GzInputStream.
+     */
+    static constexpr char MEMBER_SIZE_ID[2] = {'X', 'P'};
+
+    /**
+     * Size of the member header written by GzOutputStream: fixed part, extra length, subfield id, length and value
+     */
+    static constexpr size_t MEMBER_HEADER_SIZE = 10 + 2 + 4 + 4;
+
+    /**
+     * Size of the member trailer: CRC32 and size of the uncompressed data
+     */
+    static constexpr size_t MEMBER_TRAILER_SIZE = 8;
 };
@@ -0,0 +1,93 @@
+/*
+ * Xournal++
+ *
+ * Shares the equal immutable values
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace xoj::util {
+
+/**
+ * @brief Table of the values in use, so that the equal values are held once
+ *
+ * intern() returns the value of the table equal to the given one, or adds it. The values are immutable and shared:
+ * a value is removed from the table once the last of its users released it.
+ *
+ * The tables are meant to be process wide and never destroyed (see instance()), as the values may be released by
+ * static destructors. Thread safe.
+ */
+template <class T, class Hash = std::hash<T>>
+class InternTable {
+public:
+    InternTable() = default;
+    InternTable(const InternTable&) = delete;
+    InternTable& operator=(const InternTable&) = delete;
+
+    /**
+     * @return The table of the process for the values of type T
+     */
+    static InternTable& instance() {
+        static auto* table = new InternTable();
+        return *table;
+    }
+
+public:
+    std::shared_ptr<const T> intern(T value) {
+        std::lock_guard lock(this->mutex);
+        auto it = this->values.find(value);
+        if (it != this->values.end()) {
+            if (auto shared = it->second.lock()) {
+                return shared;
+            }
+        }
+
+        auto* stored = new T(std::move(value));
+        std::shared_ptr<const T> shared(stored, [this](const T* v) { release(v); });
+        if (it != this->values.end()) {
+            // Released, but its deleter has not removed it yet
+            this->values.erase(it);
+        }
+        this->values.emplace(*stored, shared);
+        return shared;
+    }
+
+    /**
+     * @return The number of values in use
+     */
+    size_t size() const {
+        std::lock_guard lock(this->mutex);
+        return this->values.size();
+    }
+
+private:
+    void release(const T* v) {
+        {
+            std::lock_guard lock(this->mutex);
+            auto it = this->values.find(*v);
+            // The value may have been interned again meanwhile
+            if (it != this->values.end() && it->second.expired()) {
+                this->values.erase(it);
+            }
+        }
+        delete v;
+    }
+
+private:
+    std::unordered_map<T, std::weak_ptr<const T>, Hash> values;
+    mutable std::mutex mutex;
+};
+
+}  // namespace xoj::util
@@ -0,0 +1,69 @@
+/*
+ * Xournal++
+ *
+ * Downscaled copies of an image, to draw it small
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <cairo.h>
+
+namespace xoj::util {
+
+/**
+ * @brief An image surface and its copies halved in size, down to MIN_SIZE pixels, created on first use
+ *
+ * Drawing a large image small makes cairo filter all its pixels on each draw: paint() draws the smallest copy which
+ * still has at least one pixel per device pixel instead. Vector targets, like the PDF export, get the image itself.
+ *
+ * Thread safe.
+ */
+class Mipmap {
+public:
+    /**
+     * @param image An image surface, the mipmap takes a reference of it
+     */
+    explicit Mipmap(cairo_surface_t* image);
+    ~Mipmap();
+
+    Mipmap(const Mipmap&) = delete;
+    Mipmap& operator=(const Mipmap&) = delete;
+
+public:
+    cairo_surface_t* getImage() const;
+
+    /**
+     * Paint the image in the rectangle of the user space
+     * @param filter The filter of the copy painted, e.g. CAIRO_FILTER_FAST for a draft
+     */
+    void paint(cairo_t* cr, double x, double y, double width, double height, double alpha = 1.0,
+               cairo_filter_t filter = CAIRO_FILTER_GOOD) const;
+
+    /**
+     * @param scale The number of device pixels per pixel of the image
+     * @return The copy to draw at this scale, and its downscaling factor from the image
+     */
+    std::pair<cairo_surface_t*, int> getLevel(double scale) const;
+
+    static constexpr int MIN_SIZE = 16;
+
+private:
+    cairo_surface_t* image;
+
+    /**
+     * The halved copies created so far, from the largest
+     */
+    mutable std::vector<cairo_surface_t*> levels;
+    mutable std::mutex mutex;
+};
+
+};  // namespace xoj::util
@@ -0,0 +1,81 @@
+/*
+ * Xournal++
+ *
+ * Fixed size blocks for the objects allocated by the thousands
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace xoj::util {
+
+/**
+ * @brief Allocator of blocks of one size, carved from large chunks
+ *
+ * The objects allocated one after the other, as the elements of a loaded page, are placed next to each other in the
+ * chunks: iterating over them touches contiguous memory instead of blocks scattered over the heap. The blocks freed
+ * are reused first, the most recently freed one first. The chunks are only freed with the pool. Thread safe.
+ */
+class ObjectPool {
+public:
+    explicit ObjectPool(size_t objectSize, size_t objectsPerChunk = OBJECTS_PER_CHUNK);
+    ~ObjectPool();
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+public:
+    /**
+     * @return A block of the object size, aligned as with operator new
+     * @throws std::bad_alloc
+     */
+    void* allocate();
+
+    /**
+     * @param p A block of allocate()
+     */
+    void deallocate(void* p) noexcept;
+
+    /**
+     * @return The size of a block, at least the object size
+     */
+    size_t getBlockSize() const;
+
+    /**
+     * @return The number of blocks in use
+     */
+    size_t getUsedCount() const;
+
+    size_t getChunkCount() const;
+
+    static constexpr size_t OBJECTS_PER_CHUNK = 256;
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t blockSize;
+    size_t objectsPerChunk;
+
+    std::vector<unsigned char*> chunks;
+
+    /// The blocks of the last chunk which were never allocated: [next, end)
+    unsigned char* next = nullptr;
+    unsigned char* end = nullptr;
+
+    FreeBlock* freeBlocks = nullptr;
+    size_t used = 0;
+
+    mutable std::mutex mutex;
+};
+
+}  // namespace xoj::util
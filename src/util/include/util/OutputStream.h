@@ -11,7 +11,13 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <zlib.h>
@@ -31,6 +37,13 @@ public:
     virtual void close() = 0;
 };
 
+/**
+ * Writes a gzip file
+ *
+ * The data is cut into blocks which are deflated in parallel, each into an independent gzip member: any gzip reader
+ * reads the members one after the other, and GzInputStream inflates them in parallel (see GzUtil::MEMBER_SIZE_ID).
+ * Small files are compressed on the calling thread.
+ */
 class GzOutputStream: public OutputStream {
 public:
     GzOutputStream(fs::path file);
@@ -43,11 +56,71 @@ public:
 
     std::string& getLastError();
 
+    /**
+     * Size of the uncompressed blocks
+     */
+    static constexpr size_t BLOCK_SIZE = 256 * 1024;
+
+private:
+    struct Block;
+
+    /**
+     * Queue the buffered data for compression
+     */
+    void submitBlock(bool last);
+
+    /**
+     * Write the compressed blocks at the front of the queue to the file
+     * @param all Wait until all the blocks are compressed
+     */
+    void writeCompressedBlocks(bool all);
+
+    void writeBytes(const char* data, size_t len);
+
+    void startWorkers();
+    void stopWorkers();
+    void compressLoop();
+
+    static void compress(Block& block);
+
 private:
-    gzFile fp = nullptr;
+    std::ofstream out;
+    bool closed = false;
+
+    std::string buffer;
+    bool submitted = false;
+
+    /**
+     * The blocks not yet written, in order
+     */
+    std::deque<std::unique_ptr<Block>> blocks;
+
+    /**
+     * The blocks to compress, protected by mutex
+     */
+    std::deque<Block*> queue;
+    std::mutex mutex;
+    std::condition_variable blockQueued;
+    std::condition_variable blockCompressed;
+    std::vector<std::thread> workers;
+    bool stopping = false;
 
     std::string error;
 
-    std::string target;
     fs::path file;
 };
+
+/**
+ * Keeps the output in memory
+ */
+class StringOutputStream: public OutputStream {
+public:
+    void write(const char* data, int len) override;
+
+    void close() override;
+
+    const std::string& getString() const;
+
+private:
+    std::string data;
+};
@@ -0,0 +1,79 @@
+/*
+ * Xournal++
+ *
+ * Threads running the iterations of a loop in parallel
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace xoj::util {
+
+/**
+ * @brief Runs the iterations of short loops on a few threads, for work done on the UI thread for each input event
+ *
+ * The threads are started by the first loop and wait for the next one in between, so that a loop costs no thread
+ * creation. The calling thread runs iterations as well.
+ */
+class ParallelLoop {
+public:
+    /**
+     * @param maxThreads Number of threads, including the calling one, up to MAX_THREADS. 0 for the number of cores.
+     */
+    explicit ParallelLoop(unsigned int maxThreads = 0);
+    ~ParallelLoop();
+
+    ParallelLoop(const ParallelLoop&) = delete;
+    ParallelLoop& operator=(const ParallelLoop&) = delete;
+
+public:
+    /**
+     * Calls f(i) for each i in [0, count), in any order and on any of the threads. Returns once all the calls returned.
+     * Not reentrant: f must not run a loop of the same ParallelLoop.
+     */
+    void run(size_t count, const std::function<void(size_t)>& f);
+
+    unsigned int getThreadCount() const;
+
+    static constexpr unsigned int MAX_THREADS = 8;
+
+private:
+    void workerLoop();
+
+    /**
+     * Runs the iterations of the current loop until there is none left
+     */
+    void runIterations();
+
+private:
+    unsigned int threadCount;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable loopStarted;
+    std::condition_variable loopDone;
+
+    /**
+     * The current loop, protected by mutex, except for the atomic index of the next iteration
+     */
+    const std::function<void(size_t)>* body = nullptr;
+    size_t count = 0;
+    std::atomic<size_t> next{0};
+    size_t generation = 0;
+    unsigned int busyWorkers = 0;
+    bool stopping = false;
+};
+
+};  // namespace xoj::util
@@ -110,6 +110,11 @@ void openFileWithFilebrowser(const fs::path& filename);
 
 [[maybe_unused]] bool safeRenameFile(fs::path const& from, fs::path const& to);
 
+/**
+ * Flush the file and its directory entry to the disk, e.g. once it replaced another file. Does nothing on Windows.
+ */
+void syncFile(fs::path const& path);
+
 [[maybe_unused]] fs::path ensureFolderExists(const fs::path& p);
 
 /**
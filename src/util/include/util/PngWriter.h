@@ -0,0 +1,101 @@
+/*
+ * Xournal++
+ *
+ * Writes PNG images row by row
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "filesystem.h"
+
+namespace xoj::util {
+
+/**
+ * @brief Writes a PNG image one row after the other, so that an image larger than the memory can be written
+ *
+ * The rows are given as the pixels of a CAIRO_FORMAT_ARGB32 surface and written as 8 bit RGBA, like
+ * cairo_surface_write_to_png() does. Each row is filtered with the PNG filter which gives the smallest sum of absolute
+ * differences (the heuristic of libpng), then deflated into the IDAT chunks as it comes: only the previous row and a
+ * chunk of compressed data are kept.
+ */
+class PngWriter {
+public:
+    PngWriter(fs::path file, uint32_t width, uint32_t height);
+    ~PngWriter();
+
+    PngWriter(const PngWriter&) = delete;
+    PngWriter& operator=(const PngWriter&) = delete;
+
+public:
+    /**
+     * @param pixels The width pixels of the next row, premultiplied ARGB in native byte order like CAIRO_FORMAT_ARGB32
+     * @return false on an error, see getLastError()
+     */
+    bool writeRow(const uint32_t* pixels);
+
+    /**
+     * Writes the end of the image, once all its rows are written
+     * @return false on an error, see getLastError()
+     */
+    bool close();
+
+    const std::string& getLastError() const;
+
+    /**
+     * The maximum size of the data of an IDAT chunk
+     */
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+private:
+    void writeChunk(const char* type, const unsigned char* data, size_t len);
+
+    /**
+     * Deflates the input of the stream, writing the full chunks
+     * @param flush Z_NO_FLUSH or Z_FINISH
+     */
+    bool deflateInput(int flush);
+
+    void setError(const std::string& message);
+
+private:
+    std::ofstream out;
+    z_stream stream{};
+    bool streamOpen = false;
+    bool closed = false;
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t rows = 0;
+
+    /**
+     * The unfiltered RGBA bytes of the previous and of the current row
+     */
+    std::vector<unsigned char> previous;
+    std::vector<unsigned char> current;
+
+    /**
+     * The current row filtered by each PNG filter, preceded by the filter type
+     */
+    std::vector<unsigned char> filtered[5];
+
+    std::vector<unsigned char> compressed;
+
+    std::string error;
+
+    fs::path file;
+};
+
+}  // namespace xoj::util
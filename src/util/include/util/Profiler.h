@@ -0,0 +1,194 @@
+/*
+ * Xournal++
+ *
+ * Runtime measurements of the rendering
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xoj::util {
+
+/**
+ * @brief Timings, counters and cache hit rates of the rendering, recorded while enabled
+ *
+ * The render jobs, the scheduler, the caches and the widget report to the profiler of the process. The measurements are
+ * summed up by name for the overlay of the main view, and the recent events are kept for a trace in the Chrome trace
+ * event format (chrome://tracing, Perfetto) or a CSV table of the sums.
+ *
+ * The names and categories must be string literals: the events keep the pointers. When disabled, every call returns
+ * after reading an atomic flag. Thread safe.
+ */
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Profiler() = default;
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static Profiler& getInstance();
+
+    /**
+     * @brief Records the duration of a task until the end of the scope, if the profiler is enabled at its start
+     */
+    class Scope {
+    public:
+        explicit Scope(const char* name, const char* category = "render");
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        const char* category;
+        Clock::time_point start;
+        bool active;
+    };
+
+    struct Timing {
+        uint64_t count = 0;
+        double totalMs = 0;
+        double maxMs = 0;
+        double lastMs = 0;
+    };
+
+    struct CacheAccesses {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+public:
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    /**
+     * @brief Records a task which took the given time
+     */
+    void addTiming(const char* name, const char* category, Clock::time_point start, Clock::duration duration);
+
+    /**
+     * @brief Sets the current value of a counter, e.g. the length of a queue
+     */
+    void setCounter(const char* name, int64_t value);
+
+    /**
+     * @brief Counts a lookup in a cache
+     */
+    void countAccess(const char* cache, bool hit);
+
+    /**
+     * @brief An input event is about to change the view: the next paint measures the latency from the first such event
+     */
+    void markInput();
+
+    /**
+     * @brief A redraw of the view was queued, after the input events passed to markInput() if any
+     */
+    void markDrawQueued();
+
+    /**
+     * @brief The view was painted, after the input events passed to markInput() if any
+     */
+    void markPainted();
+
+    std::map<std::string, Timing> getTimings() const;
+    std::map<std::string, int64_t> getCounters() const;
+    std::map<std::string, CacheAccesses> getCacheAccesses() const;
+
+    /**
+     * @return One line per timing, counter and cache, for the overlay
+     */
+    std::vector<std::string> getSummary() const;
+
+    /**
+     * @brief Writes the recent events as a JSON trace of the Chrome trace event format
+     */
+    void writeTrace(std::ostream& out) const;
+
+    /**
+     * @brief Writes the timings and the cache accesses as a CSV table
+     */
+    void writeCsv(std::ostream& out) const;
+
+    /**
+     * Forget all the measurements
+     */
+    void reset();
+
+    /**
+     * The names of the latencies of the input events in the timings
+     */
+    static constexpr const char* INPUT_TO_PAINT = "input to paint";
+    static constexpr const char* INPUT_TO_QUEUE_DRAW = "input to queued draw";
+
+    /**
+     * Number of events kept for the trace, the oldest are dropped
+     */
+    static constexpr size_t MAX_EVENTS = 100000;
+
+private:
+    struct Event {
+        const char* name;
+        const char* category;
+
+        /// 'X' for a task, 'C' for a counter
+        char phase;
+        int64_t startUs;
+        int64_t durationUs;
+        int64_t value;
+        int thread;
+    };
+
+    void addEvent(const Event& event);
+
+    /**
+     * @return A small number for the trace, the order in which the threads first report
+     */
+    int getThreadNumber(std::thread::id id);
+
+    int64_t toMicroseconds(Clock::time_point time) const;
+
+private:
+    std::atomic<bool> enabled{false};
+
+    Clock::time_point origin = Clock::now();
+
+    std::map<std::string, Timing> timings;
+    std::map<std::string, int64_t> counters;
+    std::map<std::string, CacheAccesses> caches;
+    std::deque<Event> events;
+    std::map<std::thread::id, int> threads;
+
+    /**
+     * The first input event not painted yet, or the epoch
+     */
+    Clock::time_point pendingInput{};
+
+    /**
+     * The first input event without a queued redraw yet, or the epoch
+     */
+    Clock::time_point pendingUnqueuedInput{};
+
+    mutable std::mutex mutex;
+};
+
+}  // namespace xoj::util
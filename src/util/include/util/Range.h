@@ -11,16 +11,26 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
 
+/**
+ * The bounding box of points, e.g. of the area to rerender. Not virtual and inline: widened once per point on the
+ * eraser and rerender paths.
+ */
 class Range {
 public:
     Range(double x, double y);
-    virtual ~Range();
 
-    void addPoint(double x, double y);
+    void addPoint(double x, double y) {
+        this->x1 = std::min(this->x1, x);
+        this->x2 = std::max(this->x2, x);
+
+        this->y1 = std::min(this->y1, y);
+        this->y2 = std::max(this->y2, y);
+    }
 
     double getX() const;
     double getY() const;
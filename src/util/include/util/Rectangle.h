@@ -14,6 +14,7 @@
 #include <algorithm>
 #include <cassert>
 #include <optional>
+#include <vector>
 
 #include "util/Range.h"
 
@@ -85,4 +86,32 @@ public:
     T height{};
 };
 
+/**
+ * Replaces the rectangles by fewer ones covering them. Two rectangles are merged when their union is at most maxWaste
+ * times the sum of their areas, e.g. when they overlap or touch, so that an area is not drawn several times.
+ *
+ * Quadratic in the number of rectangles.
+ */
+template <class T>
+void mergeRectangles(std::vector<Rectangle<T>>& rects, double maxWaste) {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < rects.size(); i++) {
+            for (size_t j = i + 1; j < rects.size();) {
+                Rectangle<T> u = rects[i];
+                u.unite(rects[j]);
+                if (u.area() <= maxWaste * (rects[i].area() + rects[j].area())) {
+                    rects[i] = u;
+                    rects[j] = rects.back();
+                    rects.pop_back();
+                    merged = true;
+                } else {
+                    j++;
+                }
+            }
+        }
+    }
+}
+
 }  // namespace xoj::util
\ No newline at end of file
@@ -11,6 +11,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
 #include <vector>
 
 #include "BasePointerIterator.h"
@@ -124,6 +127,8 @@ public:
     const_iterator begin() const { return nb <= N ? dataArray.data() : dataVector.data(); }
     iterator end() { return nb <= N ? dataArray.data() + nb : dataVector.data() + nb; }
     const_iterator end() const { return nb <= N ? dataArray.data() + nb : dataVector.data() + nb; }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
 
     template <class... Args>
     void emplace_back(Args&&... args) {
@@ -157,6 +162,59 @@ public:
         }
         --nb;
     }
+    /**
+     * @brief Inserts value before pos
+     * @return An iterator to the inserted value
+     */
+    iterator insert(iterator pos, const T& value) {
+        auto index = static_cast<size_type>(pos - begin());
+        T copy(value);  // value may be an element of this
+        if (nb < N) {
+            T* p = dataArray.data();
+            if (index == nb) {
+                ::new (p + nb) T(std::move(copy));
+            } else {
+                ::new (p + nb) T(std::move(p[nb - 1]));
+                std::move_backward(p + index, p + nb - 1, p + nb);
+                p[index] = std::move(copy);
+            }
+        } else {
+            if (nb == N) {
+                dataVector.reserve(N + 1);
+                std::move(dataArrayBegin(), dataArrayEnd(), std::back_inserter(dataVector));
+                dataArrayClear();
+            }
+            dataVector.insert(std::next(dataVector.begin(), static_cast<difference_type>(index)), std::move(copy));
+        }
+        ++nb;
+        return begin() + static_cast<difference_type>(index);
+    }
+
+    /**
+     * @brief Removes the elements of [first, last)
+     * @return An iterator to the element following the removed ones
+     */
+    iterator erase(iterator first, iterator last) {
+        auto index = static_cast<size_type>(first - begin());
+        auto count = static_cast<size_type>(last - first);
+        size_type newSize = nb - count;
+        if (nb > N) {
+            auto it = std::next(dataVector.begin(), static_cast<difference_type>(index));
+            dataVector.erase(it, std::next(it, static_cast<difference_type>(count)));
+            if (newSize <= N) {
+                std::uninitialized_move(dataVector.begin(), dataVector.end(), dataArray.data());
+                dataVector = std::vector<value_type>(0);
+            }
+        } else {
+            T* p = dataArray.data();
+            std::move(p + index + count, p + nb, p + index);
+            std::destroy(p + newSize, p + nb);
+        }
+        nb = newSize;
+        return begin() + static_cast<difference_type>(index);
+    }
+    iterator erase(iterator pos) { return erase(pos, std::next(pos)); }
+
     void clear() {
         if (nb > N) {
             dataVector = std::vector<value_type>(0);
@@ -0,0 +1,121 @@
+/*
+ * Xournal++
+ *
+ * Reusable memory of the transient image surfaces
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <cairo.h>
+
+namespace xoj::util {
+
+/**
+ * @brief Pool of the pixel buffers of the image surfaces which are created and destroyed all the time
+ *
+ * The render tiles, the masks of the strokes and the previews are allocated and freed over and over, and each large
+ * allocation maps fresh pages that the kernel zeroes and faults in. The surfaces of the pool draw into buffers which
+ * are reused instead: once such a surface is destroyed, its buffer goes back to the pool, for the next surface of
+ * about the same size.
+ *
+ * The buffers are grouped by size classes of a quarter of a power of 2, so a buffer is at most 25% larger than needed.
+ * The idle buffers are kept up to a memory budget, and those larger than a quarter of it are not kept. The surfaces may outlive their pool. Thread safe.
+ */
+class SurfacePool {
+public:
+    explicit SurfacePool(size_t maxBytes = MAX_BYTES);
+
+    SurfacePool(const SurfacePool&) = delete;
+    SurfacePool& operator=(const SurfacePool&) = delete;
+
+    static SurfacePool& getInstance();
+
+public:
+    /**
+     * Like cairo_image_surface_create(), drop in: the surface is cleared and freed with cairo_surface_destroy()
+     */
+    cairo_surface_t* create(cairo_format_t format, int width, int height);
+
+    /**
+     * create() with the pool of the process
+     */
+    static cairo_surface_t* createSurface(cairo_format_t format, int width, int height);
+
+    /**
+     * @brief Set the memory budget of the idle buffers, in bytes
+     */
+    void setMaxBytes(size_t newMaxBytes);
+
+    /**
+     * Free the idle buffers
+     */
+    void clear();
+
+    /**
+     * @return The number of bytes of the idle buffers
+     */
+    size_t getIdleBytes() const;
+
+    static constexpr size_t MAX_BYTES = 64U << 20U;
+
+    /**
+     * Smaller surfaces are allocated by cairo: the allocator reuses their memory already
+     */
+    static constexpr size_t MIN_BYTES = 16U << 10U;
+
+private:
+    struct State {
+        /**
+         * @return An idle buffer of the size class, or nullptr
+         */
+        unsigned char* take(size_t size);
+
+        /**
+         * Keep the buffer for the next surface, or free it if over the budget
+         */
+        void giveBack(unsigned char* data, size_t size);
+
+        void trim();
+
+        ~State();
+
+        size_t maxBytes;
+        size_t idleBytes = 0;
+
+        /**
+         * By size class
+         */
+        std::map<size_t, std::vector<unsigned char*>> idle;
+        mutable std::mutex mutex;
+    };
+
+    /**
+     * Data of a surface of the pool, freed with the surface
+     */
+    struct Lease {
+        std::shared_ptr<State> state;
+        unsigned char* data;
+        size_t size;
+    };
+
+    static size_t sizeClass(size_t bytes);
+
+private:
+    /**
+     * Shared with the surfaces, which can outlive the pool
+     */
+    std::shared_ptr<State> state;
+};
+
+}  // namespace xoj::util
@@ -11,7 +11,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <vector>
 
 #include "Interval.h"
@@ -22,8 +24,10 @@
  * The intervals are stored as a sorted list of their bounds. The list must be of even length.
  * This data structure makes the computation of the union/intersection/complement of those intervals very simple.
  * The downside is: it makes iterating through the structure a bit weird. See cloneToIntervalVector below for an example
+ *
+ * The bounds are stored in a Container, e.g. a SmallVector for the unions updated often which have only a few intervals
  */
-template <class T>
+template <class T, class Container = std::vector<T>>
 class UnionOfIntervals final {
 public:
     UnionOfIntervals() = default;
@@ -193,12 +197,12 @@ public:
     /**
      * @brief Get a reference to the data
      */
-    const std::vector<T>& getData() const { return data; }
+    const Container& getData() const { return data; }
 
     /**
      * @brief Swap the content with that of other
      */
-    void swap(UnionOfIntervals<T>& other) { data.swap(other.data); }
+    void swap(UnionOfIntervals& other) { data.swap(other.data); }
 
     /**
      * @brief Append raw data to the union's data
@@ -216,5 +220,5 @@ public:
     }
 
 private:
-    std::vector<T> data;
+    Container data;
 };
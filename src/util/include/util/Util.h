@@ -38,16 +38,29 @@ void systemWithMessage(const char* command);
  */
 void execInUiThread(std::function<void()>&& callback, gint priority = G_PRIORITY_DEFAULT_IDLE);
 
+/**
+ * Queue a redraw of the widget from any thread. The requests made until the UI thread handles them are merged: the
+ * widget is queued for drawing once.
+ */
+void queueDrawInUiThread(GtkWidget* widget);
+
 gboolean paintBackgroundWhite(GtkWidget* widget, cairo_t* cr, void* unused);
 
 /**
- * Format coordinates to use 8 digits of precision https://m.xkcd.com/2170/
- * This function directly writes to the given OutputStream.
+ * Format a coordinate with 8 digits of precision https://m.xkcd.com/2170/, without the locale overhead of printf
+ *
+ * @param buffer At least G_ASCII_DTOSTR_BUF_SIZE characters, the result is not null terminated
+ * @return The end of the formatted number in the buffer
  */
-extern void writeCoordinateString(OutputStream* out, double xVal, double yVal);
+extern char* formatCoordinate(char* buffer, double value);
 
 constexpr const gchar* PRECISION_FORMAT_STRING = "%.8f";
 
+/**
+ * The precision of PRECISION_FORMAT_STRING
+ */
+constexpr int PRECISION_DIGITS = 8;
+
 constexpr const auto DPI_NORMALIZATION_FACTOR = 72.0;
 
 }  // namespace Util
@@ -32,4 +32,9 @@ public:
                                  const std::map<int, std::string>& button, bool error = false);
     static int replaceFileQuestion(GtkWindow* win, const std::string& msg);
     static void showHelp(GtkWindow* win);
+
+    /**
+     * Opens the URI with the default application, e.g. a link of a PDF in the browser. Shows the error, if any.
+     */
+    static void showUri(GtkWindow* win, const std::string& uri);
 };
@@ -0,0 +1,160 @@
+/*
+ * Xournal++
+ *
+ * Logging without writing in the calling thread
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <config-dev.h>
+#include <glib.h>
+
+namespace xoj::util {
+
+/**
+ * @brief Bounded queue of log lines: any thread pushes, one thread pops
+ *
+ * The slots are allocated once. Pushing copies the line into a slot, truncated to LINE_SIZE, without locking nor
+ * allocating. A full buffer drops the line.
+ */
+class LogBuffer {
+public:
+    /**
+     * @param capacity The number of lines, rounded up to a power of two
+     */
+    explicit LogBuffer(size_t capacity);
+
+    LogBuffer(const LogBuffer&) = delete;
+    LogBuffer& operator=(const LogBuffer&) = delete;
+
+    /**
+     * @return false if the buffer is full
+     */
+    bool push(int64_t timeUs, std::string_view line);
+
+    /**
+     * @return false if the buffer is empty. Only called by one thread at a time.
+     */
+    bool pop(int64_t& timeUs, std::string& line);
+
+    size_t getCapacity() const;
+
+    static constexpr size_t LINE_SIZE = 500;
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        int64_t timeUs = 0;
+        size_t length = 0;
+        char text[LINE_SIZE];
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    std::atomic<size_t> pushPosition{0};
+    size_t popPosition = 0;
+};
+
+/**
+ * @brief The log of the process: the messages of GLib and of the XOJ_LOG macros, written by a background thread
+ *
+ * Writing to a slow disk or terminal used to stall the UI thread. Once started, the messages are queued in a LogBuffer
+ * and written every FLUSH_INTERVAL_MS by a background thread, or at once for the warnings and above. The messages
+ * dropped because the buffer is full are counted in the log. The fatal messages are written before GLib aborts.
+ * Before start() and after stop(), the messages are written in the calling thread. Thread safe.
+ */
+class AsyncLog {
+public:
+    // Not in capitals: DEBUG and ERROR are macros on some platforms
+    enum class Level { Debug, Info, Message, Warning, Critical, Error };
+
+    /**
+     * @brief Starts the background thread, and handles the messages of GLib
+     *
+     * @param out Where the messages are written, stderr by default. It must stay open until stop().
+     */
+    static void start(std::FILE* out = stderr);
+
+    /**
+     * @brief Writes the queued messages and stops the background thread
+     */
+    static void stop();
+
+    /**
+     * @brief Waits until the messages logged so far are written
+     */
+    static void flush();
+
+    static void write(Level level, const char* domain, const char* message);
+    static void printf(Level level, const char* format, ...) G_GNUC_PRINTF(2, 3);
+
+    /**
+     * @brief Logs a structured event as one line of JSON, e.g. {"event":"autosave","timeUs":...,"ms":12.5}
+     *
+     * Written as the info messages of EVENTS_DOMAIN, e.g. with G_MESSAGES_DEBUG=events.
+     *
+     * @param name A name without quotes nor backslashes
+     */
+    static void event(const char* name, std::initializer_list<std::pair<const char*, double>> fields);
+
+    /**
+     * @return The number of messages dropped because the buffer was full
+     */
+    static uint64_t getDropped();
+
+    static constexpr const char* EVENTS_DOMAIN = "events";
+
+    static constexpr size_t CAPACITY = 1024;
+    static constexpr int FLUSH_INTERVAL_MS = 200;
+
+private:
+    AsyncLog() = delete;
+};
+
+}  // namespace xoj::util
+
+/**
+ * The least level of the XOJ_LOG macros compiled in, see DEV_LOG_LEVEL: 0 for debug, 1 for info, 2 for message...
+ */
+#ifndef XOJ_LOG_MIN_LEVEL
+#define XOJ_LOG_MIN_LEVEL 1
+#endif
+
+/**
+ * Log with a printf format. The levels under XOJ_LOG_MIN_LEVEL cost nothing: the arguments are not evaluated.
+ */
+#define XOJ_LOG(level, ...)                                                   \
+    do {                                                                      \
+        if constexpr (static_cast<int>(level) >= XOJ_LOG_MIN_LEVEL) {         \
+            xoj::util::AsyncLog::printf(level, __VA_ARGS__);                  \
+        }                                                                     \
+    } while (false)
+
+#define XOJ_LOG_DEBUG(...) XOJ_LOG(xoj::util::AsyncLog::Level::Debug, __VA_ARGS__)
+#define XOJ_LOG_INFO(...) XOJ_LOG(xoj::util::AsyncLog::Level::Info, __VA_ARGS__)
+#define XOJ_LOG_MESSAGE(...) XOJ_LOG(xoj::util::AsyncLog::Level::Message, __VA_ARGS__)
+#define XOJ_LOG_WARNING(...) XOJ_LOG(xoj::util::AsyncLog::Level::Warning, __VA_ARGS__)
+
+/**
+ * Log a structured event at the info level, e.g. XOJ_LOG_EVENT("autosave", {{"ms", 12.5}})
+ */
+#define XOJ_LOG_EVENT(name, ...)                                                                 \
+    do {                                                                                         \
+        if constexpr (static_cast<int>(xoj::util::AsyncLog::Level::Info) >= XOJ_LOG_MIN_LEVEL) { \
+            xoj::util::AsyncLog::event(name, __VA_ARGS__);                                       \
+        }                                                                                        \
+    } while (false)
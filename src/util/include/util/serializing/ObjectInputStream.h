@@ -12,6 +12,9 @@
 #pragma once
 
 #include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include <gtk/gtk.h>
 
@@ -39,12 +42,34 @@ public:
 
     void readData(void** data, int* len);
 
+    /**
+     * Read an array written by ObjectOutputStream::writeData(), directly into the vector
+     */
+    template <typename T>
+    std::vector<T> readData() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::vector<T> data(readDataLength(sizeof(T)));
+        readBytes(data.data(), data.size() * sizeof(T));
+        return data;
+    }
+
     /// Reads raw image data from the stream.
     std::string readImage();
 
 private:
     void checkType(char type);
 
+    /**
+     * @return The number of elements of the data, which must be of the given width
+     */
+    size_t readDataLength(size_t width);
+    void readBytes(void* data, size_t length);
+
+    /**
+     * @return The number of bytes left to read
+     */
+    size_t remaining();
+
     static std::string getType(char type);
 
 private:
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <gtk/gtk.h>
@@ -37,6 +38,15 @@ public:
 
     void writeData(const void* data, int len, int width);
 
+    /**
+     * Write the array in one block, to be read by ObjectInputStream::readData<T>()
+     */
+    template <typename T>
+    void writeData(const std::vector<T>& data) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        writeData(data.data(), static_cast<int>(data.size()), sizeof(T));
+    }
+
     /// Writes the raw image data to the output stream.
     void writeImage(const std::string_view& imgData);
 
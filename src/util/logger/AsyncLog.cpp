@@ -0,0 +1,365 @@
+#include "util/logger/AsyncLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+using xoj::util::AsyncLog;
+using xoj::util::LogBuffer;
+
+LogBuffer::LogBuffer(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) { size <<= 1; }
+    this->slots = std::make_unique<Slot[]>(size);
+    // The sequence of a slot is the push position it waits for, and that position + 1 once it holds the line
+    for (size_t i = 0; i < size; i++) { this->slots[i].sequence.store(i, std::memory_order_relaxed); }
+    this->mask = size - 1;
+}
+
+auto LogBuffer::push(int64_t timeUs, std::string_view line) -> bool {
+    size_t position = this->pushPosition.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &this->slots[position & this->mask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(sequence - position);
+        if (diff == 0) {
+            if (this->pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Not popped since the previous round: full
+            return false;
+        } else {
+            position = this->pushPosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->timeUs = timeUs;
+    slot->length = std::min(line.size(), LINE_SIZE);
+    std::memcpy(slot->text, line.data(), slot->length);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+auto LogBuffer::pop(int64_t& timeUs, std::string& line) -> bool {
+    Slot& slot = this->slots[this->popPosition & this->mask];
+    if (slot.sequence.load(std::memory_order_acquire) != this->popPosition + 1) {
+        return false;
+    }
+    timeUs = slot.timeUs;
+    line.assign(slot.text, slot.length);
+    slot.sequence.store(this->popPosition + this->mask + 1, std::memory_order_release);
+    this->popPosition++;
+    return true;
+}
+
+auto LogBuffer::getCapacity() const -> size_t { return this->mask + 1; }
+
+namespace {
+struct LogState {
+    std::unique_ptr<LogBuffer> buffer;
+    std::FILE* out = stderr;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> dropped{0};
+
+    /// A warning or worse was queued: written without waiting for FLUSH_INTERVAL_MS
+    std::atomic<bool> urgent{false};
+
+    /// Only accessed by the background thread
+    uint64_t reportedDropped = 0;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable flushed;
+    bool stopping = false;
+    uint64_t flushRequests = 0;
+    uint64_t flushesDone = 0;
+
+    GLogFunc previousHandler = nullptr;
+    gpointer previousHandlerData = nullptr;
+};
+
+auto getState() -> LogState& {
+    // Never destroyed: the messages logged while the process exits are still written
+    static auto* state = new LogState();
+    return *state;
+}
+
+auto getLevelName(AsyncLog::Level level) -> const char* {
+    switch (level) {
+        case AsyncLog::Level::Debug:
+            return "DEBUG";
+        case AsyncLog::Level::Info:
+            return "INFO";
+        case AsyncLog::Level::Message:
+            return "Message";
+        case AsyncLog::Level::Warning:
+            return "WARNING";
+        case AsyncLog::Level::Critical:
+            return "CRITICAL";
+        case AsyncLog::Level::Error:
+            return "ERROR";
+    }
+    return "";
+}
+
+auto toLevel(GLogLevelFlags flags) -> AsyncLog::Level {
+    if (flags & G_LOG_LEVEL_ERROR) {
+        return AsyncLog::Level::Error;
+    }
+    if (flags & G_LOG_LEVEL_CRITICAL) {
+        return AsyncLog::Level::Critical;
+    }
+    if (flags & G_LOG_LEVEL_WARNING) {
+        return AsyncLog::Level::Warning;
+    }
+    if (flags & G_LOG_LEVEL_MESSAGE) {
+        return AsyncLog::Level::Message;
+    }
+    if (flags & G_LOG_LEVEL_INFO) {
+        return AsyncLog::Level::Info;
+    }
+    return AsyncLog::Level::Debug;
+}
+
+/**
+ * As GLib: the debug and info messages are only written for the domains of G_MESSAGES_DEBUG
+ */
+auto isEnabled(AsyncLog::Level level, const char* domain) -> bool {
+    if (level > AsyncLog::Level::Info) {
+        return true;
+    }
+    const char* domains = g_getenv("G_MESSAGES_DEBUG");
+    if (domains == nullptr) {
+        return false;
+    }
+    if (std::strcmp(domains, "all") == 0) {
+        return true;
+    }
+    return domain != nullptr && std::strstr(domains, domain) != nullptr;
+}
+
+void writeLine(std::FILE* out, int64_t timeUs, const std::string& line) {
+    // The structured events are JSON lines with their own time
+    if (!line.empty() && line.front() == '{') {
+        std::fprintf(out, "%s\n", line.c_str());
+        return;
+    }
+    GDateTime* time = g_date_time_new_from_unix_local(timeUs / G_USEC_PER_SEC);
+    if (time == nullptr) {
+        std::fprintf(out, "%s\n", line.c_str());
+        return;
+    }
+    std::fprintf(out, "%02d:%02d:%02d.%03d %s\n", g_date_time_get_hour(time), g_date_time_get_minute(time),
+                 g_date_time_get_second(time), static_cast<int>(timeUs % G_USEC_PER_SEC / 1000), line.c_str());
+    g_date_time_unref(time);
+}
+
+/**
+ * Writes the lines of the buffer, in the background thread
+ */
+void writePending(LogState& state) {
+    int64_t timeUs = 0;
+    std::string line;
+    bool written = false;
+    while (state.buffer->pop(timeUs, line)) {
+        writeLine(state.out, timeUs, line);
+        written = true;
+    }
+
+    uint64_t dropped = state.dropped.load();
+    if (dropped != state.reportedDropped) {
+        std::fprintf(state.out, "%llu log messages dropped, the log was too busy\n",
+                     static_cast<unsigned long long>(dropped - state.reportedDropped));
+        state.reportedDropped = dropped;
+        written = true;
+    }
+    if (written) {
+        std::fflush(state.out);
+    }
+}
+
+void run(LogState& state) {
+    std::unique_lock<std::mutex> lock(state.mutex);
+    for (;;) {
+        uint64_t requests = state.flushRequests;
+        bool stopping = state.stopping;
+        lock.unlock();
+        writePending(state);
+        lock.lock();
+
+        state.flushesDone = requests;
+        state.flushed.notify_all();
+        if (stopping) {
+            return;
+        }
+        state.wakeUp.wait_for(lock, std::chrono::milliseconds(AsyncLog::FLUSH_INTERVAL_MS), [&state, requests]() {
+            return state.stopping || state.flushRequests != requests || state.urgent.exchange(false);
+        });
+    }
+}
+
+void queue(AsyncLog::Level level, std::string_view line) {
+    LogState& state = getState();
+    int64_t timeUs = g_get_real_time();
+
+    // The lines too long for a slot are rare: written at once, so that they are not cut
+    if (!state.running.load() || line.size() > LogBuffer::LINE_SIZE) {
+        writeLine(state.out, timeUs, std::string(line));
+        std::fflush(state.out);
+        return;
+    }
+
+    if (!state.buffer->push(timeUs, line)) {
+        state.dropped++;
+    }
+    if (level >= AsyncLog::Level::Warning) {
+        state.urgent = true;
+        state.wakeUp.notify_one();
+    }
+}
+
+void queueFormatted(AsyncLog::Level level, const char* domain, const char* format, va_list args) {
+    char line[LogBuffer::LINE_SIZE + 1];
+    int prefix = std::snprintf(line, sizeof(line), "%s%s%s: ", domain ? domain : "", domain ? "-" : "",
+                               getLevelName(level));
+    prefix = std::clamp(prefix, 0, static_cast<int>(LogBuffer::LINE_SIZE));
+
+    va_list copy;
+    va_copy(copy, args);
+    int length = std::vsnprintf(line + prefix, sizeof(line) - static_cast<size_t>(prefix), format, copy);
+    va_end(copy);
+    if (length < 0) {
+        return;
+    }
+
+    if (static_cast<size_t>(prefix + length) <= LogBuffer::LINE_SIZE) {
+        queue(level, std::string_view(line, static_cast<size_t>(prefix + length)));
+    } else {
+        gchar* message = g_strdup_vprintf(format, args);
+        std::string longLine(line, static_cast<size_t>(prefix));
+        longLine += message;
+        g_free(message);
+        queue(level, longLine);
+    }
+}
+
+void handleGLibMessage(const gchar* domain, GLogLevelFlags flags, const gchar* message, gpointer) {
+    AsyncLog::Level level = toLevel(flags);
+    if (!isEnabled(level, domain)) {
+        return;
+    }
+    if ((flags & G_LOG_FLAG_FATAL) || level == AsyncLog::Level::Error) {
+        // GLib aborts after the handler: the queued messages are written first
+        AsyncLog::flush();
+        LogState& state = getState();
+        writeLine(state.out, g_get_real_time(),
+                  std::string(domain ? domain : "") + (domain ? "-" : "") + getLevelName(level) + ": " + message);
+        std::fflush(state.out);
+        return;
+    }
+    AsyncLog::write(level, domain, message);
+}
+}  // namespace
+
+void AsyncLog::start(std::FILE* out) {
+    LogState& state = getState();
+    if (state.running.load()) {
+        return;
+    }
+    if (!state.buffer) {
+        state.buffer = std::make_unique<LogBuffer>(CAPACITY);
+    }
+    state.out = out;
+    state.stopping = false;
+    state.thread = std::thread([&state]() { run(state); });
+    state.running = true;
+    state.previousHandler = g_log_set_default_handler(handleGLibMessage, nullptr);
+}
+
+void AsyncLog::stop() {
+    LogState& state = getState();
+    if (!state.running.exchange(false)) {
+        return;
+    }
+    g_log_set_default_handler(state.previousHandler, state.previousHandlerData);
+
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stopping = true;
+    }
+    state.wakeUp.notify_one();
+    state.thread.join();
+    // The lines pushed while stopping
+    writePending(state);
+    state.out = stderr;
+}
+
+void AsyncLog::flush() {
+    LogState& state = getState();
+    if (!state.running.load()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(state.mutex);
+    uint64_t request = ++state.flushRequests;
+    state.wakeUp.notify_one();
+    state.flushed.wait(lock, [&state, request]() { return state.flushesDone >= request || state.stopping; });
+}
+
+void AsyncLog::write(Level level, const char* domain, const char* message) {
+    char line[LogBuffer::LINE_SIZE + 1];
+    int length = std::snprintf(line, sizeof(line), "%s%s%s: %s", domain ? domain : "", domain ? "-" : "",
+                               getLevelName(level), message);
+    if (length < 0) {
+        return;
+    }
+    if (static_cast<size_t>(length) <= LogBuffer::LINE_SIZE) {
+        queue(level, std::string_view(line, static_cast<size_t>(length)));
+    } else {
+        queue(level, std::string(domain ? domain : "") + (domain ? "-" : "") + getLevelName(level) + ": " + message);
+    }
+}
+
+void AsyncLog::printf(Level level, const char* format, ...) {
+    if (!isEnabled(level, nullptr)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    queueFormatted(level, nullptr, format, args);
+    va_end(args);
+}
+
+void AsyncLog::event(const char* name, std::initializer_list<std::pair<const char*, double>> fields) {
+    if (!isEnabled(Level::Info, EVENTS_DOMAIN)) {
+        return;
+    }
+    std::string line = "{\"event\":\"";
+    line += name;
+    line += "\",\"timeUs\":";
+    line += std::to_string(g_get_real_time());
+    for (const auto& [key, value]: fields) {
+        line += ",\"";
+        line += key;
+        line += "\":";
+        if (std::isfinite(value)) {
+            // Not the decimal separator of the locale
+            char number[G_ASCII_DTOSTR_BUF_SIZE];
+            line += g_ascii_formatd(number, sizeof(number), "%.6g", value);
+        } else {
+            line += "null";
+        }
+    }
+    line += '}';
+    queue(Level::Info, line);
+}
+
+auto AsyncLog::getDropped() -> uint64_t { return getState().dropped.load(); }
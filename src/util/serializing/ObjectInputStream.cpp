@@ -6,11 +6,10 @@
 
 // This function requires that T is read from its binary representation to work (e.g. integer type)
 template <typename T>
-T readTypeFromSStream(std::istringstream& istream) {
-    if (istream.str().size() < sizeof(T)) {
+T readTypeFromSStream(std::istringstream& istream, size_t remaining) {
+    if (remaining < sizeof(T)) {
         std::ostringstream oss;
-        oss << "End reached: trying to read " << sizeof(T) << " bytes while only " << istream.str().size()
-            << " bytes available";
+        oss << "End reached: trying to read " << sizeof(T) << " bytes while only " << remaining << " bytes available";
         throw InputStreamException(oss.str(), __FILE__, __LINE__);
     }
     T output;
@@ -22,6 +21,14 @@ T readTypeFromSStream(std::istringstream& istream) {
 
 size_t ObjectInputStream::pos() { return istream.tellg(); }
 
+auto ObjectInputStream::remaining() -> size_t {
+    auto position = istream.tellg();
+    if (position < 0 || static_cast<size_t>(position) > len) {
+        return 0;
+    }
+    return len - static_cast<size_t>(position);
+}
+
 auto ObjectInputStream::read(const char* data, int data_len) -> bool {
     istream.clear();
     len = (size_t)data_len;
@@ -69,25 +76,25 @@ void ObjectInputStream::endObject() { checkType('}'); }
 
 auto ObjectInputStream::readInt() -> int {
     checkType('i');
-    return readTypeFromSStream<int>(istream);
+    return readTypeFromSStream<int>(istream, remaining());
 }
 
 auto ObjectInputStream::readDouble() -> double {
     checkType('d');
-    return readTypeFromSStream<double>(istream);
+    return readTypeFromSStream<double>(istream, remaining());
 }
 
 auto ObjectInputStream::readSizeT() -> size_t {
     checkType('l');
-    return readTypeFromSStream<size_t>(istream);
+    return readTypeFromSStream<size_t>(istream, remaining());
 }
 
 auto ObjectInputStream::readString() -> std::string {
     checkType('s');
 
-    size_t lenString = (size_t)readTypeFromSStream<int>(istream);
+    size_t lenString = (size_t)readTypeFromSStream<int>(istream, remaining());
 
-    if (istream.str().size() < len) {
+    if (remaining() < lenString) {
         throw InputStreamException("End reached, but try to read an string", __FILE__, __LINE__);
     }
 
@@ -102,14 +109,14 @@ auto ObjectInputStream::readString() -> std::string {
 void ObjectInputStream::readData(void** data, int* length) {
     checkType('b');
 
-    if (istream.str().size() < 2 * sizeof(int)) {
+    if (remaining() < 2 * sizeof(int)) {
         throw InputStreamException("End reached, but try to read data len and width", __FILE__, __LINE__);
     }
 
-    int len = readTypeFromSStream<int>(istream);
-    int width = readTypeFromSStream<int>(istream);
+    int len = readTypeFromSStream<int>(istream, remaining());
+    int width = readTypeFromSStream<int>(istream, remaining());
 
-    if (istream.str().size() < (len * width)) {
+    if (remaining() < static_cast<size_t>(len * width)) {
         throw InputStreamException("End reached, but try to read data", __FILE__, __LINE__);
     }
 
@@ -124,15 +131,40 @@ void ObjectInputStream::readData(void** data, int* length) {
     }
 }
 
+auto ObjectInputStream::readDataLength(size_t width) -> size_t {
+    checkType('b');
+
+    if (remaining() < 2 * sizeof(int)) {
+        throw InputStreamException("End reached, but try to read data len and width", __FILE__, __LINE__);
+    }
+
+    int len = readTypeFromSStream<int>(istream, remaining());
+    int dataWidth = readTypeFromSStream<int>(istream, remaining());
+
+    if (len < 0 || static_cast<size_t>(dataWidth) != width) {
+        throw InputStreamException(FS(FORMAT_STR("Expected data of width {1} but read {2} elements of width {3}") %
+                                      width % len % dataWidth),
+                                   __FILE__, __LINE__);
+    }
+    if (remaining() < static_cast<size_t>(len) * width) {
+        throw InputStreamException("End reached, but try to read data", __FILE__, __LINE__);
+    }
+    return static_cast<size_t>(len);
+}
+
+void ObjectInputStream::readBytes(void* data, size_t length) {
+    istream.read(static_cast<char*>(data), static_cast<std::streamsize>(length));
+}
+
 auto ObjectInputStream::readImage() -> std::string {
     checkType('m');
 
-    if (istream.str().size() < sizeof(size_t)) {
+    if (remaining() < sizeof(size_t)) {
         throw InputStreamException("End reached, but try to read an image's data's length", __FILE__, __LINE__);
     }
 
-    const size_t len = readTypeFromSStream<size_t>(istream);
-    if (istream.str().size() < len) {
+    const size_t len = readTypeFromSStream<size_t>(istream, remaining());
+    if (remaining() < len) {
         throw InputStreamException("End reached, but try to read an image", __FILE__, __LINE__);
     }
     std::string data;
@@ -143,7 +175,7 @@ auto ObjectInputStream::readImage() -> std::string {
 }
 
 void ObjectInputStream::checkType(char type) {
-    if (istream.str().size() < 2) {
+    if (remaining() < 2) {
         throw InputStreamException(FS(FORMAT_STR("End reached, but try to read {1}, index {2} of {3}") % getType(type) %
                                       (uint32_t)pos() % (uint32_t)len),
                                    __FILE__, __LINE__);
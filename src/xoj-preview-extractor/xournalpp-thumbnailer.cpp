@@ -15,6 +15,7 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <system_error>
 
 #include <cairo.h>
 #include <librsvg/rsvg.h>
@@ -105,6 +106,41 @@ fs::path findAppIcon() {
     return "";
 }
 
+/**
+ * The thumbnails already written, by the MD5 of the absolute path of the document, in the cache folder of Xournal++.
+ * An entry is valid while it is newer than the document, so that browsing a folder again reads none of the documents.
+ *
+ * @return The cache entry of the document, empty if there is no cache folder
+ */
+fs::path getCachedThumbnail(const fs::path& input) {
+    std::error_code ec;
+    auto absolute = fs::absolute(input, ec);
+    if (ec) {
+        return "";
+    }
+    // Not Util::getCacheSubfolder(), which reports its errors in a dialog
+    auto folder = fs::u8path(g_get_user_cache_dir()) / "xournalpp" / "thumbnails";
+    fs::create_directories(folder, ec);
+    if (ec) {
+        return "";
+    }
+
+    gchar* hash = g_compute_checksum_for_string(G_CHECKSUM_MD5, absolute.u8string().c_str(), -1);
+    fs::path cached = folder / (std::string(hash) + ".png");
+    g_free(hash);
+    return cached;
+}
+
+bool isCachedThumbnailValid(const fs::path& input, const fs::path& cached) {
+    std::error_code ec;
+    auto documentTime = fs::last_write_time(input, ec);
+    if (ec) {
+        return false;
+    }
+    auto cachedTime = fs::last_write_time(cached, ec);
+    return !ec && cachedTime >= documentTime;
+}
+
 int main(int argc, char* argv[]) {
     initLocalisation();
 
@@ -114,8 +150,19 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    const fs::path input = fs::u8path(argv[1]);
+    const fs::path output = fs::u8path(argv[2]);
+    const fs::path cached = getCachedThumbnail(input);
+
+    std::error_code ec;
+    if (!cached.empty() && isCachedThumbnailValid(input, cached) &&
+        fs::copy_file(cached, output, fs::copy_options::overwrite_existing, ec)) {
+        logMessage(_("xoj-preview-extractor: successfully extracted"), false);
+        return 0;
+    }
+
     XojPreviewExtractor extractor;
-    PreviewExtractResult result = extractor.readFile(argv[1]);
+    PreviewExtractResult result = extractor.readFile(input);
 
     switch (result) {
         case PREVIEW_RESULT_IMAGE_READ:
@@ -198,6 +245,11 @@ int main(int argc, char* argv[]) {
         fclose(fp);
     }
 
+    if (!cached.empty()) {
+        // Not an error: the thumbnail is only extracted again the next time
+        fs::copy_file(output, cached, fs::copy_options::overwrite_existing, ec);
+    }
+
     logMessage(_("xoj-preview-extractor: successfully extracted"), false);
     return 0;
 }
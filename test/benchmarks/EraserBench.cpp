@@ -0,0 +1,86 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal Benchmarks
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "model/Point.h"
+#include "model/Stroke.h"
+#include "model/eraser/ErasableStroke.h"
+#include "model/eraser/PaddedBox.h"
+#include "util/Range.h"
+
+#include "Fixtures.h"
+
+static constexpr double HALF_ERASER_SIZE = 5;
+static constexpr double PADDING = 0.5;
+
+/**
+ * @return The positions of an eraser going along the stroke, like the erasure of a word
+ */
+static auto makePass(const Stroke& stroke, size_t step) -> std::vector<PaddedBox> {
+    std::vector<PaddedBox> pass;
+    const auto& points = stroke.getPointVector();
+    for (size_t i = 0; i < points.size(); i += step) {
+        pass.push_back({{points[i].x, points[i].y}, HALF_ERASER_SIZE, HALF_ERASER_SIZE + PADDING * stroke.getWidth()});
+    }
+    return pass;
+}
+
+static void intersectLongStroke(benchmark::State& state) {
+    auto stroke = bench::makeStroke(static_cast<size_t>(state.range(0)), true, 5);
+    auto pass = makePass(*stroke, 97);
+
+    for (auto _: state) {
+        for (const PaddedBox& box: pass) {
+            auto parameters = stroke->intersectWithPaddedBox(box);
+            benchmark::DoNotOptimize(parameters);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(pass.size()));
+}
+BENCHMARK(intersectLongStroke)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * The hit test of the whole stroke eraser and of the selection, next to the stroke so that most of the runs miss
+ */
+static void hitTestLongStroke(benchmark::State& state) {
+    auto stroke = bench::makeStroke(static_cast<size_t>(state.range(0)), true, 5);
+    auto pass = makePass(*stroke, 97);
+
+    for (auto _: state) {
+        for (const PaddedBox& box: pass) {
+            double gap = 0;
+            bool hit = stroke->intersects(box.center.x + HALF_ERASER_SIZE, box.center.y, HALF_ERASER_SIZE, &gap);
+            benchmark::DoNotOptimize(hit);
+            benchmark::DoNotOptimize(gap);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(pass.size()));
+}
+BENCHMARK(hitTestLongStroke)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+static void eraseLongStroke(benchmark::State& state) {
+    auto stroke = bench::makeStroke(static_cast<size_t>(state.range(0)), true, 6);
+    auto pass = makePass(*stroke, 20);
+
+    for (auto _: state) {
+        Range range(pass.front().center.x, pass.front().center.y);
+        ErasableStroke erasable(*stroke);
+        erasable.beginErasure(stroke->intersectWithPaddedBox(pass.front()), range);
+        for (size_t i = 1; i < pass.size(); i++) { erasable.erase(pass[i], range); }
+        auto strokes = erasable.getStrokes();
+        benchmark::DoNotOptimize(strokes);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(pass.size()));
+}
+BENCHMARK(eraseLongStroke)->Arg(2000)->Arg(10000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,106 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal Benchmarks
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include "control/xojfile/LoadHandler.h"
+#include "control/xojfile/SaveHandler.h"
+#include "control/xojfile/XojExportHandler.h"
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+
+#include "Fixtures.h"
+#include "filesystem.h"
+
+/**
+ * @return A document of dense pages
+ */
+static auto makeDocument(DocumentHandler* handler, size_t pages) -> std::unique_ptr<Document> {
+    auto doc = std::make_unique<Document>(handler);
+    for (size_t i = 0; i < pages; i++) { doc->addPage(bench::makeDensePage(2000, 40, static_cast<uint32_t>(i))); }
+    return doc;
+}
+
+static void loadDocument(benchmark::State& state, const fs::path& file) {
+    if (!fs::exists(file)) {
+        state.SkipWithError("The file does not exist");
+        return;
+    }
+
+    for (auto _: state) {
+        LoadHandler handler;
+        std::unique_ptr<Document> doc(handler.loadDocument(file));
+        if (!doc) {
+            state.SkipWithError("The file could not be loaded");
+            return;
+        }
+        benchmark::DoNotOptimize(doc->getPageCount());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(fs::file_size(file)));
+}
+
+static void loadBigTest(benchmark::State& state) { loadDocument(state, bench::getTestFile("big-test.xoj")); }
+BENCHMARK(loadBigTest)->Unit(benchmark::kMillisecond);
+
+static void loadDensePages(benchmark::State& state) {
+    auto file = bench::getOutputDirectory() / "load.xopp";
+    {
+        DocumentHandler docHandler;
+        auto doc = makeDocument(&docHandler, 10);
+        SaveHandler handler;
+        handler.prepareSave(doc.get());
+        handler.saveTo(file);
+    }
+    loadDocument(state, file);
+}
+BENCHMARK(loadDensePages)->Unit(benchmark::kMillisecond);
+
+static void saveDensePages(benchmark::State& state) {
+    auto file = bench::getOutputDirectory() / "save.xopp";
+    DocumentHandler docHandler;
+    auto doc = makeDocument(&docHandler, 10);
+
+    for (auto _: state) {
+        SaveHandler handler;
+        handler.setBinaryStrokes(state.range(0) != 0);
+        handler.prepareSave(doc.get());
+        handler.saveTo(file);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(fs::file_size(file)));
+}
+BENCHMARK(saveDensePages)->ArgName("binary")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+/**
+ * Exports to .xoj and loads the result again, as the compatibility exports do
+ */
+static void exportXojRoundTrip(benchmark::State& state) {
+    auto file = bench::getOutputDirectory() / "export.xoj";
+    DocumentHandler docHandler;
+    auto doc = makeDocument(&docHandler, 10);
+
+    for (auto _: state) {
+        XojExportHandler handler;
+        handler.prepareSave(doc.get());
+        handler.saveTo(file);
+
+        LoadHandler loadHandler;
+        std::unique_ptr<Document> loaded(loadHandler.loadDocument(file));
+        if (!loaded) {
+            state.SkipWithError("The file could not be loaded");
+            return;
+        }
+        benchmark::DoNotOptimize(loaded->getPageCount());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(fs::file_size(file)));
+}
+BENCHMARK(exportXojRoundTrip)->Unit(benchmark::kMillisecond);
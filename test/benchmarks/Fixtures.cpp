@@ -0,0 +1,133 @@
+#include "Fixtures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <cairo-pdf.h>
+#include <cairo.h>
+#include <config-test.h>
+
+#include "model/Font.h"
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include "model/Text.h"
+#include "model/XojPage.h"
+#include "util/PathUtil.h"
+
+namespace bench {
+
+static auto makeWalk(std::mt19937& random, size_t points, bool pressure) -> std::unique_ptr<Stroke> {
+    std::uniform_real_distribution<double> startX(20, PAGE_WIDTH - 20);
+    std::uniform_real_distribution<double> startY(20, PAGE_HEIGHT - 20);
+    std::normal_distribution<double> step(0, 0.3);
+    std::uniform_real_distribution<double> force(0.3, 1.0);
+
+    auto stroke = std::make_unique<Stroke>();
+    stroke->setWidth(1.4);
+    stroke->setColor(Color(0x1a3d8fU));
+
+    double x = startX(random);
+    double y = startY(random);
+    double angle = 0;
+    for (size_t i = 0; i < points; i++) {
+        angle += step(random);
+        x = std::clamp(x + 1.5 * std::cos(angle), 0.0, PAGE_WIDTH);
+        y = std::clamp(y + 1.5 * std::sin(angle), 0.0, PAGE_HEIGHT);
+        stroke->addPoint(pressure ? Point(x, y, force(random)) : Point(x, y));
+    }
+    return stroke;
+}
+
+auto makeStroke(size_t points, bool pressure, uint32_t seed) -> std::unique_ptr<Stroke> {
+    std::mt19937 random(seed);
+    return makeWalk(random, points, pressure);
+}
+
+auto makeDensePage(size_t strokes, size_t pointsPerStroke, uint32_t seed) -> PageRef {
+    std::mt19937 random(seed);
+    auto page = std::make_shared<XojPage>(PAGE_WIDTH, PAGE_HEIGHT);
+    auto* layer = new Layer();
+    for (size_t i = 0; i < strokes; i++) {
+        auto stroke = makeWalk(random, pointsPerStroke, i % 2 == 0);
+        if (i % 10 == 9) {
+            stroke->setToolType(STROKE_TOOL_HIGHLIGHTER);
+            stroke->setWidth(8);
+            stroke->setColor(Color(0xffff00U));
+        }
+        layer->addElement(stroke.release());
+    }
+    page->addLayer(layer);
+    return page;
+}
+
+auto makeTextPage(size_t texts, uint32_t seed) -> PageRef {
+    static const std::vector<std::string> WORDS = {"lorem", "ipsum", "dolor",  "sit",    "amet",  "integral",
+                                                   "vector", "matrix", "proof", "lemma", "ẞtraße", "αβγ"};
+
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<size_t> word(0, WORDS.size() - 1);
+    std::uniform_real_distribution<double> x(10, PAGE_WIDTH - 200);
+    std::uniform_real_distribution<double> y(10, PAGE_HEIGHT - 60);
+
+    XojFont font;
+    font.setName("Sans");
+    font.setSize(12);
+
+    auto page = std::make_shared<XojPage>(PAGE_WIDTH, PAGE_HEIGHT);
+    auto* layer = new Layer();
+    for (size_t i = 0; i < texts; i++) {
+        std::string content;
+        for (size_t line = 0; line < 3; line++) {
+            for (size_t w = 0; w < 6; w++) { content += WORDS[word(random)] + " "; }
+            content += "\n";
+        }
+
+        auto* text = new Text();
+        text->setFont(font);
+        text->setText(content);
+        text->setX(x(random));
+        text->setY(y(random));
+        layer->addElement(text);
+    }
+    page->addLayer(layer);
+    return page;
+}
+
+void writePdf(const fs::path& file, size_t pages, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> coordinate(0, 1);
+
+    cairo_surface_t* surface = cairo_pdf_surface_create(file.u8string().c_str(), PAGE_WIDTH, PAGE_HEIGHT);
+    cairo_t* cr = cairo_create(surface);
+    for (size_t p = 0; p < pages; p++) {
+        // A diagram of curves and a column of text
+        cairo_set_line_width(cr, 0.8);
+        for (int i = 0; i < 200; i++) {
+            cairo_move_to(cr, coordinate(random) * PAGE_WIDTH, coordinate(random) * PAGE_HEIGHT);
+            cairo_curve_to(cr, coordinate(random) * PAGE_WIDTH, coordinate(random) * PAGE_HEIGHT,
+                           coordinate(random) * PAGE_WIDTH, coordinate(random) * PAGE_HEIGHT,
+                           coordinate(random) * PAGE_WIDTH, coordinate(random) * PAGE_HEIGHT);
+        }
+        cairo_stroke(cr);
+
+        cairo_set_font_size(cr, 10);
+        for (int line = 0; line < 60; line++) {
+            cairo_move_to(cr, 40, 40 + line * 12);
+            cairo_show_text(cr, ("Page " + std::to_string(p + 1) + ", line " + std::to_string(line + 1) +
+                                 ": the quick brown fox jumps over the lazy dog")
+                                        .c_str());
+        }
+        cairo_show_page(cr);
+    }
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+}
+
+auto getTestFile(const char* name) -> fs::path { return fs::path(PROJECT_SOURCE_DIR) / "test" / "files" / name; }
+
+auto getOutputDirectory() -> fs::path { return Util::getTmpDirSubfolder("bench"); }
+
+};  // namespace bench
@@ -0,0 +1,64 @@
+/*
+ * Xournal++
+ *
+ * Reproducible documents for the benchmarks
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "model/PageRef.h"
+
+#include "filesystem.h"
+
+class Stroke;
+
+/**
+ * The generators draw from a fixed seed: the same arguments always give the same content, so the results of two
+ * versions are comparable.
+ */
+namespace bench {
+
+constexpr double PAGE_WIDTH = 595;
+constexpr double PAGE_HEIGHT = 842;
+
+/**
+ * @return A random walk across the page, like handwriting
+ * @param pressure Whether the points have a pressure
+ */
+std::unique_ptr<Stroke> makeStroke(size_t points, bool pressure, uint32_t seed);
+
+/**
+ * @return A page with one layer of short strokes, e.g. dense handwritten notes, highlighted every tenth stroke
+ */
+PageRef makeDensePage(size_t strokes, size_t pointsPerStroke, uint32_t seed);
+
+/**
+ * @return A page with one layer of text elements of a few lines each
+ */
+PageRef makeTextPage(size_t texts, uint32_t seed);
+
+/**
+ * Writes a PDF with simple vector content and text on each page, e.g. slides or scanned lecture notes
+ */
+void writePdf(const fs::path& file, size_t pages, uint32_t seed);
+
+/**
+ * @return The path of a test file, see test/files
+ */
+fs::path getTestFile(const char* name);
+
+/**
+ * @return The directory for the files written by the benchmarks, created if needed
+ */
+fs::path getOutputDirectory();
+
+};  // namespace bench
@@ -0,0 +1,56 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal Benchmarks
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "model/PathParameter.h"
+#include "util/Range.h"
+#include "util/SmallVector.h"
+#include "util/UnionOfIntervals.h"
+
+/**
+ * As ErasableStroke::erase, once per eraser event: a stroke cut in a few sections, a few more erased, then the
+ * remaining sections updated
+ */
+template <class Container>
+static void eraseSections(benchmark::State& state) {
+    const size_t segments = 1000;
+    UnionOfIntervals<PathParameter, Container> remaining;
+    remaining.set({0, 0.0}, {segments - 1, 1.0});
+    remaining.intersect(std::vector<PathParameter>{{0, 0.0}, {300, 0.5}, {600, 0.5}, {segments - 1, 1.0}});
+
+    for (auto _: state) {
+        UnionOfIntervals<PathParameter, Container> erased;
+        erased.appendData(std::vector<PathParameter>{{100, 0.25}, {101, 0.75}});
+        erased.complement({0, 0.0}, {segments - 1, 1.0});
+
+        auto sections = remaining;
+        sections.intersect(erased.getData());
+        benchmark::DoNotOptimize(sections);
+    }
+}
+BENCHMARK_TEMPLATE(eraseSections, std::vector<PathParameter>);
+BENCHMARK_TEMPLATE(eraseSections, SmallVector<PathParameter, 8>);
+
+static void widenRange(benchmark::State& state) {
+    std::vector<double> coordinates;
+    for (int i = 0; i < 1000; i++) { coordinates.push_back((i * 37) % 1000); }
+
+    for (auto _: state) {
+        Range range(coordinates.front(), coordinates.back());
+        for (size_t i = 1; i < coordinates.size(); i++) { range.addPoint(coordinates[i - 1], coordinates[i]); }
+        benchmark::DoNotOptimize(range);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(coordinates.size()));
+}
+BENCHMARK(widenRange);
@@ -0,0 +1,58 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal Benchmarks
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "control/settings/Settings.h"
+#include "gui/LayoutMapper.h"
+
+#include "Fixtures.h"
+
+/*
+ * The Layout itself needs the widgets of the main window: the benchmarks measure the mapping of the pages to the grid,
+ * which it recomputes and queries for every page on each layout change
+ */
+
+static void configureLayout(benchmark::State& state) {
+    Settings settings(bench::getOutputDirectory() / "settings.xml");
+    settings.setViewColumns(4);
+    auto pages = static_cast<size_t>(state.range(0));
+
+    for (auto _: state) {
+        LayoutMapper mapper;
+        mapper.configureFromSettings(pages, &settings);
+        for (size_t i = 0; i < pages; i++) {
+            auto position = mapper.at(i);
+            benchmark::DoNotOptimize(position);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(configureLayout)->Arg(100)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+static void findPageOfCell(benchmark::State& state) {
+    Settings settings(bench::getOutputDirectory() / "settings.xml");
+    settings.setShowPairedPages(true);
+    auto pages = static_cast<size_t>(state.range(0));
+    LayoutMapper mapper;
+    mapper.configureFromSettings(pages, &settings);
+
+    for (auto _: state) {
+        for (size_t row = 0; row < mapper.getRows(); row++) {
+            for (size_t col = 0; col < mapper.getColumns(); col++) {
+                auto page = mapper.at(GridPosition{col, row});
+                benchmark::DoNotOptimize(page);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(mapper.getRows() * mapper.getColumns()));
+}
+BENCHMARK(findPageOfCell)->Arg(10000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,161 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal Benchmarks
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <benchmark/benchmark.h>
+#include <cairo.h>
+
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/Stroke.h"
+#include "model/StrokeStyle.h"
+#include "model/XojPage.h"
+#include "view/DocumentView.h"
+#include "view/StrokeView.h"
+#include "view/View.h"
+
+#include "Fixtures.h"
+
+static constexpr double ZOOM = 2;
+
+/**
+ * A surface of the page at the zoom, like a tile buffer of the view
+ */
+class PageSurface {
+public:
+    PageSurface():
+            surface(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, static_cast<int>(bench::PAGE_WIDTH * ZOOM),
+                                               static_cast<int>(bench::PAGE_HEIGHT * ZOOM))),
+            cr(cairo_create(surface)) {
+        cairo_scale(cr, ZOOM, ZOOM);
+    }
+    ~PageSurface() {
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+    }
+
+    void clear() {
+        cairo_save(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
+        cairo_restore(cr);
+    }
+
+    cairo_surface_t* surface;
+    cairo_t* cr;
+};
+
+static void renderDensePage(benchmark::State& state) {
+    PageRef page = bench::makeDensePage(static_cast<size_t>(state.range(0)), 40, 1);
+    PageSurface target;
+    DocumentView view;
+
+    for (auto _: state) {
+        target.clear();
+        view.drawPage(page, target.cr, false);
+        cairo_surface_flush(target.surface);
+    }
+    state.counters["strokes"] = static_cast<double>(state.range(0));
+}
+BENCHMARK(renderDensePage)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+static void renderLongStroke(benchmark::State& state) {
+    auto stroke = bench::makeStroke(static_cast<size_t>(state.range(0)), state.range(1) != 0, 2);
+    PageSurface target;
+
+    for (auto _: state) {
+        target.clear();
+        xoj::view::StrokeView(stroke.get()).draw(xoj::view::Context::createDefault(target.cr));
+        cairo_surface_flush(target.surface);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(renderLongStroke)
+        ->ArgNames({"points", "pressure"})
+        ->Args({10000, 0})
+        ->Args({10000, 1})
+        ->Args({100000, 0})
+        ->Args({100000, 1})
+        ->Unit(benchmark::kMillisecond);
+
+/**
+ * The kernels of StrokeView: dashed strokes with pressure are drawn segment by segment, with all their points or, when
+ * zoomed out (detail tolerance), with their level of detail
+ */
+static void renderDashedPressureStroke(benchmark::State& state) {
+    auto stroke = bench::makeStroke(static_cast<size_t>(state.range(0)), true, 2);
+    stroke->setLineStyle(StrokeStyle::parseStyle("dash"));
+    PageSurface target;
+    auto ctx = xoj::view::Context::createDefault(target.cr);
+    ctx.detailTolerance = static_cast<double>(state.range(1)) / 10.0;
+
+    for (auto _: state) {
+        target.clear();
+        xoj::view::StrokeView(stroke.get()).draw(ctx);
+        cairo_surface_flush(target.surface);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(renderDashedPressureStroke)
+        ->ArgNames({"points", "tolerance/10"})
+        ->Args({10000, 0})
+        ->Args({10000, 5})
+        ->Unit(benchmark::kMillisecond);
+
+static void renderDensePageZoomedOut(benchmark::State& state) {
+    PageRef page = bench::makeDensePage(static_cast<size_t>(state.range(0)), 40, 1);
+    PageSurface target;
+    DocumentView view;
+    // As in the previews of the sidebar
+    view.setLevelOfDetail(0.25);
+
+    for (auto _: state) {
+        target.clear();
+        view.drawPage(page, target.cr, false);
+        cairo_surface_flush(target.surface);
+    }
+    state.counters["strokes"] = static_cast<double>(state.range(0));
+}
+BENCHMARK(renderDensePageZoomedOut)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+static void renderTextPage(benchmark::State& state) {
+    PageRef page = bench::makeTextPage(static_cast<size_t>(state.range(0)), 3);
+    PageSurface target;
+    DocumentView view;
+
+    for (auto _: state) {
+        target.clear();
+        view.drawPage(page, target.cr, false);
+        cairo_surface_flush(target.surface);
+    }
+}
+BENCHMARK(renderTextPage)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+static void renderPdfPages(benchmark::State& state) {
+    auto file = bench::getOutputDirectory() / "render.pdf";
+    bench::writePdf(file, 20, 4);
+
+    DocumentHandler handler;
+    Document doc(&handler);
+    if (!doc.readPdf(file, true, false)) {
+        state.SkipWithError("The PDF could not be read");
+        return;
+    }
+
+    PageSurface target;
+    size_t page = 0;
+    for (auto _: state) {
+        target.clear();
+        doc.getPdfPage(page)->render(target.cr);
+        cairo_surface_flush(target.surface);
+        page = (page + 1) % doc.getPdfPageCount();
+    }
+}
+BENCHMARK(renderPdfPages)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,100 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal Benchmarks
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <cmath>
+#include <deque>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "control/tools/StrokeStabilizer.h"
+
+using StrokeStabilizer::Event;
+
+/**
+ * @return The positions of a pen drawing loops at 240 Hz, in pixels
+ */
+static auto makeEvents(size_t count) -> std::vector<Event> {
+    std::vector<Event> events;
+    events.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        double t = static_cast<double>(i) / 240;
+        events.emplace_back(300 + 100 * std::cos(3 * t) + 40 * t, 300 + 100 * std::sin(5 * t), 0.5 + 0.3 * std::sin(t));
+    }
+    return events;
+}
+
+/**
+ * One stroke through the arithmetic stabilizer, the argument is the length of the buffer
+ */
+static void arithmeticMean(benchmark::State& state) {
+    auto events = makeEvents(2400);
+    StrokeStabilizer::ArithmeticMean mean(static_cast<size_t>(state.range(0)));
+
+    for (auto _: state) {
+        mean.assign(events.front());
+        for (const Event& ev: events) {
+            Event average = mean.push(ev);
+            benchmark::DoNotOptimize(average);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(events.size()));
+}
+BENCHMARK(arithmeticMean)->Arg(5)->Arg(20)->Arg(100);
+
+/**
+ * One stroke through the velocity based gaussian stabilizer, the argument is σ in tenths of pixel per ms
+ */
+static void velocityGaussianAverage(benchmark::State& state) {
+    auto events = makeEvents(2400);
+    const double sigma = static_cast<double>(state.range(0)) / 10;
+    using VelocityEvent = StrokeStabilizer::VelocityGaussian::VelocityEvent;
+
+    std::deque<VelocityEvent> buffer;
+    std::vector<double> weights;
+    for (auto _: state) {
+        buffer.clear();
+        buffer.emplace_front(events.front());
+        for (const Event& ev: events) {
+            // 240 Hz: about one event per 4 ms
+            const VelocityEvent& last = buffer.front();
+            buffer.emplace_front(ev, std::hypot(ev.x - last.x, ev.y - last.y) / 4);
+            auto [average, kept] = StrokeStabilizer::VelocityGaussian::average(buffer, 2 * sigma * sigma, weights);
+            buffer.resize(kept);
+            benchmark::DoNotOptimize(average);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(events.size()));
+}
+BENCHMARK(velocityGaussianAverage)->Arg(5)->Arg(20)->Arg(100);
+
+/**
+ * The extrapolation of the prediction stabilizer
+ */
+static void predictionExtrapolate(benchmark::State& state) {
+    auto events = makeEvents(2400);
+    using Sample = StrokeStabilizer::Prediction::Sample;
+
+    for (auto _: state) {
+        std::deque<Sample> samples;
+        guint32 timestamp = 0;
+        for (const Event& ev: events) {
+            samples.push_back({ev.x, ev.y, timestamp += 4});
+            if (samples.size() > 3) {
+                samples.pop_front();
+            }
+            auto displacement = StrokeStabilizer::Prediction::extrapolate(samples, 15);
+            benchmark::DoNotOptimize(displacement);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(events.size()));
+}
+BENCHMARK(predictionExtrapolate);
@@ -0,0 +1,112 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <iterator>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "audio/AudioQueue.h"
+
+TEST(AudioQueue, testWrapAround) {
+    AudioQueue<float> queue;
+    queue.setAudioAttributes(48000, 2);
+
+    std::vector<float> in(1000);
+    std::vector<float> out;
+    float next = 0;
+    float expected = 0;
+    // Enough rounds to wrap around the ring buffer several times
+    for (size_t round = 0; round < 3 * AudioQueue<float>::CAPACITY_FRAMES * 2 / in.size(); round++) {
+        std::iota(in.begin(), in.end(), next);
+        next += in.size();
+        EXPECT_EQ(queue.emplace(in.begin(), in.end()), in.size());
+
+        // Keep some samples in the queue, so the reads and the writes wrap around at different places
+        out.clear();
+        queue.pop(std::back_inserter(out), round % 2 ? 600 : 1400);
+        for (float sample: out) {
+            ASSERT_EQ(sample, expected++);
+        }
+        ASSERT_EQ(queue.size(), static_cast<size_t>(next - expected));
+    }
+    EXPECT_EQ(queue.getDroppedSamples(), 0);
+}
+
+TEST(AudioQueue, testWholeFrames) {
+    AudioQueue<float> queue;
+    queue.setAudioAttributes(48000, 2);
+
+    std::vector<float> in(5, 1.0f);
+    queue.emplace(in.begin(), in.end());
+
+    std::vector<float> out;
+    queue.pop(std::back_inserter(out), 100);
+    EXPECT_EQ(out.size(), 4);
+    EXPECT_EQ(queue.size(), 1);
+}
+
+TEST(AudioQueue, testOverflowDropsFrames) {
+    AudioQueue<float> queue;
+    queue.setAudioAttributes(48000, 2);
+
+    const size_t capacity = 2 * AudioQueue<float>::CAPACITY_FRAMES;
+    std::vector<float> in(capacity - 3, 1.0f);
+    EXPECT_EQ(queue.emplace(in.begin(), in.end()), in.size());
+
+    // 3 samples are free: only one frame fits
+    std::vector<float> more(6, 2.0f);
+    EXPECT_EQ(queue.emplace(more.begin(), more.end()), 2);
+    EXPECT_EQ(queue.getDroppedSamples(), 4);
+    EXPECT_EQ(queue.size(), capacity - 1);
+
+    queue.reset();
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.getDroppedSamples(), 0);
+}
+
+TEST(AudioQueue, testProducerConsumer) {
+    AudioQueue<float> queue;
+    queue.setAudioAttributes(48000, 1);
+
+    const size_t total = 1000000;
+    std::thread producer([&]() {
+        std::vector<float> in(64);
+        for (size_t sent = 0; sent < total; sent += in.size()) {
+            std::iota(in.begin(), in.end(), static_cast<float>(sent % 4096));
+            while (queue.size() >= 16384) {
+                queue.waitForConsumer(16384);
+            }
+            queue.emplace(in.begin(), in.end());
+        }
+        queue.signalEndOfStream();
+    });
+
+    std::vector<float> out;
+    size_t received = 0;
+    bool ordered = true;
+    while (!(queue.hasStreamEnded() && queue.empty())) {
+        queue.waitForProducer(0);
+        out.clear();
+        queue.pop(std::back_inserter(out), 256);
+        for (float sample: out) {
+            ordered = ordered && sample == static_cast<float>(received % 4096);
+            received++;
+        }
+    }
+    producer.join();
+
+    EXPECT_EQ(received, total);
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(queue.getDroppedSamples(), 0);
+}
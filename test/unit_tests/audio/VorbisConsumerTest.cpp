@@ -0,0 +1,30 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <gtest/gtest.h>
+
+#include "audio/VorbisConsumer.h"
+
+TEST(VorbisConsumer, testAdaptQuality) {
+    const double q = VorbisConsumer::DEFAULT_QUALITY;
+
+    // Fast enough: unchanged, or back up to the default
+    EXPECT_DOUBLE_EQ(VorbisConsumer::adaptQuality(q, 8, false), q);
+    EXPECT_DOUBLE_EQ(VorbisConsumer::adaptQuality(q, 100, false), q);
+    EXPECT_DOUBLE_EQ(VorbisConsumer::adaptQuality(q - 0.2, 100, false), q - 0.15);
+    // Nothing was encoded
+    EXPECT_DOUBLE_EQ(VorbisConsumer::adaptQuality(q, 0, false), q);
+
+    // Too slow or lost samples: lower, down to the minimum
+    EXPECT_DOUBLE_EQ(VorbisConsumer::adaptQuality(q, 2, false), q - 0.1);
+    EXPECT_DOUBLE_EQ(VorbisConsumer::adaptQuality(q, 100, true), q - 0.1);
+    EXPECT_DOUBLE_EQ(VorbisConsumer::adaptQuality(VorbisConsumer::MIN_QUALITY, 1, true), VorbisConsumer::MIN_QUALITY);
+}
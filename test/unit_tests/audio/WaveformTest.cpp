@@ -0,0 +1,111 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "audio/Waveform.h"
+#include "filesystem.h"
+
+constexpr double SAMPLE_RATE = 48000;
+
+/**
+ * @return One second of stereo audio, silent but for a full scale burst of the left channel at 250 ms
+ */
+static auto makeSecond() -> std::vector<float> {
+    std::vector<float> samples(2 * static_cast<size_t>(SAMPLE_RATE), 0.0f);
+    for (size_t i = 12000; i < 12000 + 960; i++) { samples[2 * i] = (i % 2) ? 1.0f : -1.0f; }
+    return samples;
+}
+
+TEST(Waveform, testPeaksAtAnyResolution) {
+    Waveform waveform(SAMPLE_RATE);
+    auto samples = makeSecond();
+    waveform.addFrames(samples.data(), samples.size() / 2, 2);
+    waveform.finish();
+    EXPECT_EQ(waveform.getDuration(), 1000U);
+
+    // One column per 10 ms, from the first level
+    auto fine = waveform.getPeaks(0, 1000, 100);
+    ASSERT_EQ(fine.size(), 100U);
+    EXPECT_FLOAT_EQ(fine[0].max, 0);
+    EXPECT_FLOAT_EQ(fine[25].min, -1);
+    EXPECT_FLOAT_EQ(fine[25].max, 1);
+    EXPECT_FLOAT_EQ(fine[50].max, 0);
+
+    // One column for the whole second, from the coarsest levels and the last peaks of the first one
+    auto coarse = waveform.getPeaks(0, 1000, 1);
+    EXPECT_FLOAT_EQ(coarse[0].min, -1);
+    EXPECT_FLOAT_EQ(coarse[0].max, 1);
+
+    auto quiet = waveform.getPeaks(500, 1000, 3);
+    for (const auto& peak: quiet) { EXPECT_FLOAT_EQ(peak.max, 0); }
+
+    // After the end of the audio
+    auto after = waveform.getPeaks(2000, 3000, 4);
+    ASSERT_EQ(after.size(), 4U);
+    EXPECT_FLOAT_EQ(after[3].min, 0);
+    EXPECT_FLOAT_EQ(after[3].max, 0);
+}
+
+TEST(Waveform, testAddedInPieces) {
+    Waveform whole(SAMPLE_RATE);
+    Waveform pieces(SAMPLE_RATE);
+    auto samples = makeSecond();
+    whole.addFrames(samples.data(), samples.size() / 2, 2);
+    // Blocks which do not end on a peak, as given by the encoder
+    for (size_t frame = 0; frame < samples.size() / 2; frame += 1000) {
+        pieces.addFrames(samples.data() + 2 * frame, std::min<size_t>(1000, samples.size() / 2 - frame), 2);
+    }
+
+    for (size_t columns: {1U, 7U, 100U, 1000U}) {
+        auto a = whole.getPeaks(0, 1000, columns);
+        auto b = pieces.getPeaks(0, 1000, columns);
+        for (size_t i = 0; i < columns; i++) {
+            EXPECT_FLOAT_EQ(a[i].min, b[i].min);
+            EXPECT_FLOAT_EQ(a[i].max, b[i].max);
+        }
+    }
+}
+
+TEST(Waveform, testSavedNextToTheAudio) {
+    const fs::path audio = fs::temp_directory_path() / "xournalpp-test-units_Waveform.ogg";
+    std::ofstream(audio, std::ios::binary) << "not really audio";
+
+    Waveform waveform(SAMPLE_RATE);
+    auto samples = makeSecond();
+    waveform.addFrames(samples.data(), samples.size() / 2, 2);
+    waveform.finish();
+    ASSERT_TRUE(waveform.save(audio));
+    EXPECT_TRUE(fs::exists(Waveform::getPath(audio)));
+
+    auto loaded = Waveform::load(audio);
+    ASSERT_TRUE(loaded);
+    EXPECT_DOUBLE_EQ(loaded->getSampleRate(), SAMPLE_RATE);
+    EXPECT_EQ(loaded->getDuration(), waveform.getDuration());
+    auto a = waveform.getPeaks(0, 1000, 50);
+    auto b = loaded->getPeaks(0, 1000, 50);
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_FLOAT_EQ(a[i].min, b[i].min);
+        EXPECT_FLOAT_EQ(a[i].max, b[i].max);
+    }
+
+    // Another recording under the same name
+    std::ofstream(audio, std::ios::binary | std::ios::app) << "more";
+    EXPECT_FALSE(Waveform::load(audio));
+
+    fs::remove(Waveform::getPath(audio));
+    fs::remove(audio);
+    EXPECT_FALSE(Waveform::load(audio));
+}
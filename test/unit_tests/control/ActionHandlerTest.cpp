@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "control/Actions.h"
+
+class TestActionHandler: public ActionHandler {
+public:
+    void actionPerformed(ActionType type, ActionGroup group, GdkEvent* event, GtkMenuItem* menuitem,
+                         GtkToolButton* toolbutton, bool enabled) override {}
+};
+
+class TestListener: public ActionEnabledListener, public ActionSelectionListener {
+public:
+    TestListener(ActionHandler* handler, ActionType action, ActionGroup group): action(action), group(group) {
+        ActionEnabledListener::registerListener(handler);
+        ActionSelectionListener::registerListener(handler);
+    }
+
+    void actionEnabledAction(ActionType action, bool enabled) override {
+        EXPECT_EQ(action, this->action);
+        this->enabledCalls++;
+        this->enabled = enabled;
+    }
+
+    ActionType getListenedAction() const override { return this->action; }
+
+    ActionGroup getListenedGroup() const override { return this->group; }
+
+    void actionSelected(ActionGroup group, ActionType action) override {
+        EXPECT_EQ(group, this->group);
+        this->selectedCalls++;
+    }
+
+    void setAction(ActionType action) {
+        this->action = action;
+        listenedActionChanged();
+    }
+
+    ActionType action;
+    ActionGroup group;
+    bool enabled = true;
+    int enabledCalls = 0;
+    int selectedCalls = 0;
+};
+
+TEST(ActionHandler, testOnlyTheListenersOfTheActionAreNotified) {
+    TestActionHandler handler;
+    TestListener save(&handler, ACTION_SAVE, GROUP_NOGROUP);
+    TestListener pen(&handler, ACTION_TOOL_PEN, GROUP_TOOL);
+
+    handler.fireEnableAction(ACTION_SAVE, false);
+    EXPECT_EQ(save.enabledCalls, 1);
+    EXPECT_FALSE(save.enabled);
+    EXPECT_EQ(pen.enabledCalls, 0);
+
+    handler.fireActionSelected(GROUP_TOOL, ACTION_TOOL_PEN);
+    EXPECT_EQ(pen.selectedCalls, 1);
+    EXPECT_EQ(save.selectedCalls, 0);
+}
+
+TEST(ActionHandler, testUnchangedStateIsNotNotified) {
+    TestActionHandler handler;
+    TestListener save(&handler, ACTION_SAVE, GROUP_NOGROUP);
+
+    handler.fireEnableAction(ACTION_SAVE, false);
+    handler.fireEnableAction(ACTION_SAVE, false);
+    EXPECT_EQ(save.enabledCalls, 1);
+    EXPECT_FALSE(handler.isActionEnabled(ACTION_SAVE));
+    EXPECT_TRUE(handler.isActionEnabled(ACTION_OPEN));
+
+    handler.fireEnableAction(ACTION_SAVE, true);
+    EXPECT_EQ(save.enabledCalls, 2);
+    EXPECT_TRUE(save.enabled);
+}
+
+TEST(ActionHandler, testNewListenersGetTheCurrentState) {
+    TestActionHandler handler;
+    TestListener save(&handler, ACTION_SAVE, GROUP_NOGROUP);
+    handler.fireEnableAction(ACTION_SAVE, false);
+
+    TestListener saveMenu(&handler, ACTION_SAVE, GROUP_NOGROUP);
+    TestListener open(&handler, ACTION_OPEN, GROUP_NOGROUP);
+    handler.fireEnableAction(ACTION_OPEN, true);
+    EXPECT_FALSE(saveMenu.enabled);
+    EXPECT_EQ(save.enabledCalls, 1);
+
+    // An item showing another action
+    open.setAction(ACTION_SAVE);
+    handler.fireEnableAction(ACTION_NEW, true);
+    EXPECT_FALSE(open.enabled);
+}
+
+TEST(ActionHandler, testRemovedListenersAreNotNotified) {
+    TestActionHandler handler;
+    TestListener pen(&handler, ACTION_TOOL_PEN, GROUP_TOOL);
+    { TestListener eraser(&handler, ACTION_TOOL_ERASER, GROUP_TOOL); }
+
+    handler.fireActionSelected(GROUP_TOOL, ACTION_TOOL_ERASER);
+    handler.fireEnableAction(ACTION_TOOL_ERASER, false);
+    EXPECT_EQ(pen.selectedCalls, 1);
+    EXPECT_EQ(pen.enabledCalls, 0);
+}
@@ -0,0 +1,104 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "control/AudioTimeline.h"
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include "model/Text.h"
+#include "model/XojPage.h"
+
+static auto addStroke(const PageRef& page, const fs::path& file, size_t timestamp) -> Stroke* {
+    auto* s = new Stroke();
+    s->addPoint(Point(0, 0));
+    s->addPoint(Point(10, 10));
+    s->setAudioFilename(file);
+    s->setTimestamp(timestamp);
+    (*page->getLayers())[0]->addElement(s);
+    return s;
+}
+
+static auto makePage() -> PageRef {
+    auto page = std::make_shared<XojPage>(100, 100);
+    page->getLayers()->push_back(new Layer());
+    return page;
+}
+
+TEST(AudioTimeline, testQueries) {
+    DocumentHandler handler;
+    Document doc(&handler);
+    PageRef first = makePage();
+    PageRef second = makePage();
+    doc.addPage(first);
+    doc.addPage(second);
+
+    Stroke* a = addStroke(second, "rec.ogg", 1000);
+    Stroke* b = addStroke(first, "rec.ogg", 3000);
+    Stroke* c = addStroke(first, "other.ogg", 2000);
+    addStroke(first, "", 2000);
+    auto* text = new Text();
+    text->setAudioFilename("rec.ogg");
+    text->setTimestamp(2000);
+    (*second->getLayers())[0]->addElement(text);
+
+    AudioTimeline timeline;
+    auto entries = timeline.getElementsBetween(&doc, "rec.ogg", 0, 5000);
+    ASSERT_EQ(entries.size(), 3);
+    EXPECT_EQ(entries[0].element, a);
+    EXPECT_EQ(entries[0].page, second);
+    EXPECT_EQ(entries[1].element, text);
+    EXPECT_EQ(entries[2].element, b);
+    EXPECT_EQ(entries[2].timestamp, 3000);
+
+    EXPECT_EQ(timeline.getElementsBetween(&doc, "rec.ogg", 1000, 3000).size(), 2);
+    EXPECT_TRUE(timeline.getElementsBetween(&doc, "missing.ogg", 0, 5000).empty());
+
+    ASSERT_TRUE(timeline.findNext(&doc, "other.ogg", 1500));
+    EXPECT_EQ(timeline.findNext(&doc, "other.ogg", 1500)->element, c);
+    EXPECT_FALSE(timeline.findNext(&doc, "other.ogg", 2001));
+    ASSERT_TRUE(timeline.findPrevious(&doc, "rec.ogg", 2000));
+    EXPECT_EQ(timeline.findPrevious(&doc, "rec.ogg", 2000)->element, a);
+    EXPECT_FALSE(timeline.findPrevious(&doc, "rec.ogg", 1000));
+}
+
+TEST(AudioTimeline, testUpdates) {
+    DocumentHandler handler;
+    Document doc(&handler);
+    PageRef first = makePage();
+    doc.addPage(first);
+    addStroke(first, "rec.ogg", 1000);
+
+    AudioTimeline timeline;
+    EXPECT_EQ(timeline.getElementsBetween(&doc, "rec.ogg", 0, 5000).size(), 1);
+
+    // A changed page is indexed again once it is reported
+    Stroke* added = addStroke(first, "rec.ogg", 500);
+    EXPECT_EQ(timeline.getElementsBetween(&doc, "rec.ogg", 0, 5000).size(), 1);
+    timeline.undoRedoPageChanged(first);
+    auto entries = timeline.getElementsBetween(&doc, "rec.ogg", 0, 5000);
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].element, added);
+
+    // New pages are indexed, removed pages are dropped
+    PageRef second = makePage();
+    addStroke(second, "rec.ogg", 4000);
+    doc.insertPage(second, 0);
+    EXPECT_EQ(timeline.getElementsBetween(&doc, "rec.ogg", 0, 5000).size(), 3);
+    doc.deletePage(1);
+    entries = timeline.getElementsBetween(&doc, "rec.ogg", 0, 5000);
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries[0].page, second);
+}
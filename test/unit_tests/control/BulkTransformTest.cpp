@@ -0,0 +1,54 @@
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "control/tools/BulkTransform.h"
+#include "model/Stroke.h"
+
+static auto makeStroke(int n, bool pressure) -> std::unique_ptr<Stroke> {
+    auto s = std::make_unique<Stroke>();
+    s->setWidth(1.4);
+    for (int i = 0; i < 20; i++) {
+        s->addPoint(Point(10.0 * n + i * 0.5, 20.0 - n + i * 0.25, pressure ? 0.5 + i * 0.01 : Point::NO_PRESSURE));
+    }
+    return s;
+}
+
+static void expectSameStroke(const Stroke& a, const Stroke& b) {
+    ASSERT_EQ(a.getPointCount(), b.getPointCount());
+    for (int i = 0; i < a.getPointCount(); i++) {
+        EXPECT_NEAR(a.getPoint(i).x, b.getPoint(i).x, 1e-9);
+        EXPECT_NEAR(a.getPoint(i).y, b.getPoint(i).y, 1e-9);
+        EXPECT_NEAR(a.getPoint(i).z, b.getPoint(i).z, 1e-9);
+    }
+    EXPECT_NEAR(a.getWidth(), b.getWidth(), 1e-9);
+    EXPECT_NEAR(a.getX(), b.getX(), 1e-9);
+    EXPECT_NEAR(a.getY(), b.getY(), 1e-9);
+    EXPECT_NEAR(a.getElementWidth(), b.getElementWidth(), 1e-9);
+    EXPECT_NEAR(a.getElementHeight(), b.getElementHeight(), 1e-9);
+    EXPECT_NEAR(a.getSnappedBounds().width, b.getSnappedBounds().width, 1e-9);
+}
+
+TEST(BulkTransform, testSameAsTheElementOperations) {
+    // Enough strokes to be transformed in parallel
+    for (int count: {3, static_cast<int>(BulkTransform::MIN_PARALLEL_STROKES) * 4}) {
+        std::vector<std::unique_ptr<Stroke>> strokes;
+        std::vector<std::unique_ptr<Stroke>> expected;
+        std::vector<Element*> elements;
+        for (int n = 0; n < count; n++) {
+            strokes.push_back(makeStroke(n, n % 2 == 0));
+            expected.push_back(makeStroke(n, n % 2 == 0));
+            elements.push_back(strokes.back().get());
+        }
+
+        BulkTransform().move(3, -4).scale(1, 2, 1.5, 0.5, 0.3, false).rotate(5, 6, 0.7).apply(elements);
+
+        for (auto& s: expected) {
+            s->move(3, -4);
+            s->scale(1, 2, 1.5, 0.5, 0.3, false);
+            s->rotate(5, 6, 0.7);
+        }
+        for (int n = 0; n < count; n++) { expectSameStroke(*strokes[n], *expected[n]); }
+    }
+}
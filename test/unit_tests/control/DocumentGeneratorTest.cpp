@@ -0,0 +1,90 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "control/DocumentGenerator.h"
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/Element.h"
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+
+TEST(DocumentGenerator, testParseOptions) {
+    auto options = DocumentGenerator::parseOptions("pages=3,strokes=7,points=12,pressure=0,images=1,texts=2,tex=4");
+    EXPECT_EQ(options.pages, 3);
+    EXPECT_EQ(options.layers, 1);
+    EXPECT_EQ(options.strokes, 7);
+    EXPECT_EQ(options.points, 12);
+    EXPECT_FALSE(options.pressure);
+    EXPECT_EQ(options.images, 1);
+    EXPECT_EQ(options.texts, 2);
+    EXPECT_EQ(options.texImages, 4);
+
+    EXPECT_EQ(DocumentGenerator::parseOptions("").pages, DocumentGenerator::Options().pages);
+    EXPECT_THROW(DocumentGenerator::parseOptions("pages"), std::invalid_argument);
+    EXPECT_THROW(DocumentGenerator::parseOptions("pages=-1"), std::invalid_argument);
+    EXPECT_THROW(DocumentGenerator::parseOptions("pages=3x"), std::invalid_argument);
+    EXPECT_THROW(DocumentGenerator::parseOptions("colors=3"), std::invalid_argument);
+}
+
+TEST(DocumentGenerator, testGeneratesTheRequestedContent) {
+    DocumentHandler handler;
+    Document doc(&handler);
+    DocumentGenerator(DocumentGenerator::parseOptions("pages=4,layers=2,strokes=5,points=30,texts=3")).generate(&doc);
+
+    ASSERT_EQ(doc.getPageCount(), 4);
+    for (size_t p = 0; p < doc.getPageCount(); p++) {
+        auto page = doc.getPage(p);
+        ASSERT_EQ(page->getLayerCount(), 2);
+        EXPECT_EQ(page->getLayers()->at(0)->getElements().size(), 5 + 3);
+        EXPECT_EQ(page->getLayers()->at(1)->getElements().size(), 5);
+
+        auto* stroke = dynamic_cast<Stroke*>(page->getLayers()->at(1)->getElements().front());
+        ASSERT_NE(stroke, nullptr);
+        EXPECT_EQ(stroke->getPointCount(), 30);
+        EXPECT_TRUE(stroke->hasPressure());
+    }
+}
+
+TEST(DocumentGenerator, testIsReproducible) {
+    auto options = DocumentGenerator::parseOptions("pages=2,strokes=3,points=20,seed=7");
+
+    DocumentHandler handler;
+    Document first(&handler);
+    Document second(&handler);
+    DocumentGenerator(options).generate(&first);
+    DocumentGenerator(options).generate(&second);
+
+    for (size_t p = 0; p < 2; p++) {
+        auto& firstElements = first.getPage(p)->getLayers()->front()->getElements();
+        auto& secondElements = second.getPage(p)->getLayers()->front()->getElements();
+        ASSERT_EQ(firstElements.size(), secondElements.size());
+        for (size_t i = 0; i < firstElements.size(); i++) {
+            auto* a = dynamic_cast<Stroke*>(firstElements[i]);
+            auto* b = dynamic_cast<Stroke*>(secondElements[i]);
+            ASSERT_TRUE(a && b);
+            ASSERT_EQ(a->getPointCount(), b->getPointCount());
+            for (int j = 0; j < a->getPointCount(); j++) {
+                EXPECT_TRUE(a->getPoint(j).equalsPos(b->getPoint(j)));
+                EXPECT_DOUBLE_EQ(a->getPoint(j).z, b->getPoint(j).z);
+            }
+        }
+    }
+
+    // The pages differ from each other
+    auto* a = dynamic_cast<Stroke*>(first.getPage(0)->getLayers()->front()->getElements().front());
+    auto* b = dynamic_cast<Stroke*>(first.getPage(1)->getLayers()->front()->getElements().front());
+    EXPECT_FALSE(a->getPoint(0).equalsPos(b->getPoint(0)));
+}
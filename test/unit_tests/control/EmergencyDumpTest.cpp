@@ -0,0 +1,98 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <cstdio>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "control/xojfile/EmergencyDump.h"
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+
+#include "filesystem.h"
+
+static void addPage(Document& doc, double width, int strokes) {
+    auto page = std::make_shared<XojPage>(width, 842);
+    page->setBackgroundType(PageType(PageTypeFormat::Graph));
+    page->setBackgroundColor(Color(0xffeeddU));
+    auto* layer = new Layer();
+    layer->setName("notes");
+    for (int i = 0; i < strokes; i++) {
+        auto* stroke = new Stroke();
+        stroke->addPoint(Point(i, 10));
+        stroke->addPoint(Point(i + 10, 20));
+        layer->addElement(stroke);
+    }
+    page->getLayers()->push_back(layer);
+    doc.addPage(page);
+}
+
+static void writeDump(Document& doc, const fs::path& path) {
+    std::FILE* file = std::fopen(path.string().c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    EXPECT_TRUE(EmergencyDump::writeTo(&doc, file));
+    std::fclose(file);
+}
+
+TEST(EmergencyDump, testPagesAreRestored) {
+    const fs::path path = fs::temp_directory_path() / "xournalpp-test-units_EmergencyDump.dump";
+    DocumentHandler handler;
+    Document doc(&handler);
+    addPage(doc, 595, 3);
+    addPage(doc, 600, 1);
+    writeDump(doc, path);
+
+    Document restored(&handler);
+    ASSERT_TRUE(EmergencyDump::readFrom(path, &restored));
+    ASSERT_EQ(restored.getPageCount(), 2);
+    auto page = restored.getPage(0);
+    EXPECT_EQ(page->getWidth(), 595);
+    EXPECT_EQ(page->getBackgroundType().format, PageTypeFormat::Graph);
+    EXPECT_EQ(page->getBackgroundColor(), Color(0xffeeddU));
+    ASSERT_EQ(page->getLayers()->size(), 1);
+    Layer* layer = page->getLayers()->front();
+    EXPECT_EQ(layer->getName(), "notes");
+    ASSERT_EQ(layer->getElements().size(), 3);
+    auto* stroke = dynamic_cast<Stroke*>(layer->getElements()[2]);
+    ASSERT_NE(stroke, nullptr);
+    EXPECT_EQ(stroke->getPointCount(), 2);
+    EXPECT_EQ(stroke->getPoint(1).x, 12);
+    EXPECT_EQ(restored.getPage(1)->getWidth(), 600);
+
+    fs::remove(path);
+}
+
+TEST(EmergencyDump, testTruncatedDumpKeepsTheWrittenPages) {
+    const fs::path path = fs::temp_directory_path() / "xournalpp-test-units_EmergencyDump_truncated.dump";
+    DocumentHandler handler;
+    Document doc(&handler);
+    addPage(doc, 595, 2);
+    addPage(doc, 600, 50);
+    writeDump(doc, path);
+
+    // The process died while writing the last page
+    fs::resize_file(path, fs::file_size(path) - 100);
+    Document restored(&handler);
+    ASSERT_TRUE(EmergencyDump::readFrom(path, &restored));
+    ASSERT_EQ(restored.getPageCount(), 1);
+    EXPECT_EQ(restored.getPage(0)->getLayers()->front()->getElements().size(), 2);
+
+    // Nothing to restore
+    fs::resize_file(path, 4);
+    Document empty(&handler);
+    EXPECT_FALSE(EmergencyDump::readFrom(path, &empty));
+
+    fs::remove(path);
+}
@@ -0,0 +1,74 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "control/jobs/Executor.h"
+
+TEST(ControlExecutor, testEachIterationOnce) {
+    Executor executor(4);
+    for (size_t count: {0, 1, 7, 1000}) {
+        std::vector<std::atomic<int>> calls(count);
+        TaskGroup group(JOB_PRIORITY_LOW, nullptr, executor);
+        group.forEach(count, [&](size_t i) { calls[i]++; });
+        group.join();
+        for (size_t i = 0; i < count; i++) { EXPECT_EQ(calls[i], 1) << i << " of " << count; }
+    }
+}
+
+TEST(ControlExecutor, testNestedForkJoin) {
+    Executor executor(3);
+    std::atomic<long> sum{0};
+    std::function<void(int, int)> add = [&](int begin, int end) {
+        if (end - begin < 16) {
+            for (int i = begin; i < end; i++) { sum += i; }
+            return;
+        }
+        // Joined from the threads of the executor
+        TaskGroup group(JOB_PRIORITY_HIGH, nullptr, executor);
+        int middle = (begin + end) / 2;
+        group.fork([&, begin, middle]() { add(begin, middle); });
+        group.fork([&, middle, end]() { add(middle, end); });
+        group.join();
+    };
+    add(0, 100000);
+    EXPECT_EQ(sum, 100000L * 99999L / 2);
+}
+
+TEST(ControlExecutor, testExceptionAndCancellation) {
+    Executor executor(2);
+    {
+        TaskGroup group(JOB_PRIORITY_NONE, nullptr, executor);
+        for (int i = 0; i < 100; i++) {
+            group.fork([i]() {
+                if (i == 3) {
+                    throw std::runtime_error("task failed");
+                }
+            });
+        }
+        EXPECT_THROW(group.join(), std::runtime_error);
+        EXPECT_TRUE(group.isCancelled());
+        // Rethrown once
+        EXPECT_NO_THROW(group.join());
+    }
+
+    std::atomic<bool> cancelled{true};
+    std::atomic<int> calls{0};
+    TaskGroup group(JOB_PRIORITY_NONE, &cancelled, executor);
+    group.forEach(100, [&](size_t) { calls++; });
+    group.join();
+    EXPECT_EQ(calls, 0);
+}
@@ -0,0 +1,49 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <gtest/gtest.h>
+
+#include "control/jobs/ImageImportJob.h"
+
+// A4
+constexpr double WIDTH = 595;
+constexpr double HEIGHT = 842;
+
+TEST(ImageImportJob, testThePageFitsTheTemplate) {
+    // A scan of an A4 page at 300 DPI
+    auto l = ImageImportJob::layout(2480, 3508, WIDTH, HEIGHT, 0);
+    EXPECT_NEAR(l.pageWidth, WIDTH, 0.5);
+    EXPECT_NEAR(l.pageHeight, HEIGHT, 0.5);
+    EXPECT_DOUBLE_EQ(l.pixelScale, 1.0);
+
+    // A narrower image keeps its proportions
+    l = ImageImportJob::layout(1000, 2000, WIDTH, HEIGHT, 0);
+    EXPECT_DOUBLE_EQ(l.pageHeight, HEIGHT);
+    EXPECT_DOUBLE_EQ(l.pageWidth, HEIGHT / 2);
+}
+
+TEST(ImageImportJob, testLandscapeImagesTurnThePage) {
+    auto l = ImageImportJob::layout(4000, 3000, WIDTH, HEIGHT, 0);
+    EXPECT_GT(l.pageWidth, l.pageHeight);
+    EXPECT_LE(l.pageWidth, HEIGHT + 1e-9);
+    EXPECT_LE(l.pageHeight, WIDTH + 1e-9);
+    EXPECT_DOUBLE_EQ(l.pageWidth / l.pageHeight, 4.0 / 3.0);
+}
+
+TEST(ImageImportJob, testTheImageIsDownscaledToTheResolution) {
+    auto l = ImageImportJob::layout(2480, 3508, WIDTH, HEIGHT, 150);
+    EXPECT_NEAR(l.pixelScale, 0.5, 0.01);
+    EXPECT_NEAR(l.pageWidth / 72 * 150, 2480 * l.pixelScale, 1);
+
+    // Never upscaled
+    l = ImageImportJob::layout(620, 877, WIDTH, HEIGHT, 150);
+    EXPECT_DOUBLE_EQ(l.pixelScale, 1.0);
+}
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "control/tools/LassoMask.h"
+#include "model/Point.h"
+#include "util/Rectangle.h"
+
+using xoj::util::Rectangle;
+
+static auto evenOdd(const std::vector<Point>& polygon, double x, double y) -> bool {
+    bool inside = false;
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        const Point& a = polygon[i];
+        const Point& b = polygon[j];
+        if ((a.y > y) != (b.y > y) && x < (b.x - a.x) * (y - a.y) / (b.y - a.y) + a.x) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+static void expectSameAsPolygon(const LassoMask& mask, std::mt19937& gen) {
+    std::uniform_real_distribution<double> coord(-20, 220);
+    const auto& polygon = mask.getPoints();
+    for (int i = 0; i < 2000; i++) {
+        double x = coord(gen);
+        double y = coord(gen);
+        ASSERT_EQ(mask.contains(x, y), evenOdd(polygon, x, y)) << polygon.size() << " points, " << x << " " << y;
+    }
+}
+
+TEST(LassoMask, testFewPointsContainNothing) {
+    LassoMask mask(Rectangle<double>(0, 0, 100, 100));
+    EXPECT_FALSE(mask.contains(10, 10));
+    mask.addPoint(0, 0);
+    mask.addPoint(50, 0);
+    EXPECT_FALSE(mask.contains(10, 0));
+    mask.addPoint(50, 50);
+    EXPECT_TRUE(mask.contains(40, 10));
+    EXPECT_FALSE(mask.contains(10, 40));
+}
+
+TEST(LassoMask, testSquare) {
+    LassoMask mask(Rectangle<double>(0, 0, 100, 100));
+    mask.addPoint(10, 10);
+    mask.addPoint(90, 10);
+    mask.addPoint(90, 90);
+    mask.addPoint(10, 90);
+
+    EXPECT_TRUE(mask.contains(50, 50));
+    EXPECT_TRUE(mask.contains(11, 89));
+    EXPECT_FALSE(mask.contains(5, 50));
+    EXPECT_FALSE(mask.contains(95, 95));
+
+    auto box = mask.getBoundingBox();
+    EXPECT_DOUBLE_EQ(box.x, 10);
+    EXPECT_DOUBLE_EQ(box.width, 80);
+}
+
+TEST(LassoMask, testRandomLassoMatchesPolygon) {
+    // A random walk crossing itself, partly outside of the grid
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> step(-15, 15);
+    LassoMask mask(Rectangle<double>(0, 0, 200, 200));
+    double x = 100;
+    double y = 100;
+    for (int i = 0; i < 300; i++) {
+        mask.addPoint(x, y);
+        x = std::clamp(x + step(gen), -10.0, 210.0);
+        y = std::clamp(y + step(gen), -10.0, 210.0);
+        if (i % 50 == 10) {
+            expectSameAsPolygon(mask, gen);
+        }
+    }
+    expectSameAsPolygon(mask, gen);
+}
+
+TEST(LassoMask, testLargeAreaGetsLargerCells) {
+    LassoMask mask(Rectangle<double>(0, 0, 1e5, 1e5));
+    mask.addPoint(0, 0);
+    mask.addPoint(1e5, 0);
+    mask.addPoint(1e5, 1e5);
+    EXPECT_TRUE(mask.contains(9e4, 1e4));
+    EXPECT_FALSE(mask.contains(1e4, 9e4));
+}
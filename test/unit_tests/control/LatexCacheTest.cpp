@@ -0,0 +1,42 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "control/latex/LatexCache.h"
+#include "control/settings/LatexSettings.h"
+
+#include "filesystem.h"
+
+TEST(LatexCache, testKeyDependsOnContentsAndCommand) {
+    LatexSettings settings;
+    auto key = LatexCache::getKey(settings, "x^2");
+    EXPECT_EQ(LatexCache::getKey(settings, "x^2"), key);
+    EXPECT_NE(LatexCache::getKey(settings, "x^3"), key);
+
+    LatexSettings other;
+    other.genCmd = "lualatex '{}'";
+    EXPECT_NE(LatexCache::getKey(other, "x^2"), key);
+}
+
+TEST(LatexCache, testStoreAndLoad) {
+    const fs::path folder = fs::temp_directory_path() / "xournalpp-test-units_LatexCache";
+    fs::remove_all(folder);
+    LatexCache cache(folder);
+
+    LatexSettings settings;
+    auto key = LatexCache::getKey(settings, "x^2");
+    EXPECT_FALSE(cache.load(key));
+
+    const std::string pdf("%PDF-1.5\0binary", 15);
+    cache.store(key, pdf);
+    auto loaded = cache.load(key);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(*loaded, pdf);
+
+    // Another instance finds it as well
+    LatexCache again(folder);
+    EXPECT_TRUE(again.load(key));
+    EXPECT_FALSE(again.load(LatexCache::getKey(settings, "x^3")));
+
+    fs::remove_all(folder);
+}
@@ -0,0 +1,50 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <cstddef>
+
+#include <gtest/gtest.h>
+
+#include "control/xojfile/LoadHandlerHelper.h"
+
+using LoadHandlerHelper::Attribute;
+using LoadHandlerHelper::Tag;
+
+TEST(LoadHandlerHelper, testAttributeNamesRoundTrip) {
+    for (size_t i = 0; i < static_cast<size_t>(Attribute::UNKNOWN); i++) {
+        auto attribute = static_cast<Attribute>(i);
+        EXPECT_EQ(LoadHandlerHelper::lookupAttribute(LoadHandlerHelper::getAttributeName(attribute)), attribute);
+    }
+    EXPECT_STREQ(LoadHandlerHelper::getAttributeName(Attribute::CAP_STYLE), "capStyle");
+    EXPECT_EQ(LoadHandlerHelper::lookupAttribute("capstyle"), Attribute::UNKNOWN);
+    EXPECT_EQ(LoadHandlerHelper::lookupAttribute(""), Attribute::UNKNOWN);
+}
+
+TEST(LoadHandlerHelper, testLookupTag) {
+    EXPECT_EQ(LoadHandlerHelper::lookupTag("stroke"), Tag::STROKE);
+    EXPECT_EQ(LoadHandlerHelper::lookupTag("teximage"), Tag::TEXIMAGE);
+    EXPECT_EQ(LoadHandlerHelper::lookupTag("MrWriter"), Tag::MRWRITER);
+    EXPECT_EQ(LoadHandlerHelper::lookupTag("strokes"), Tag::UNKNOWN);
+}
+
+TEST(LoadHandlerHelper, testDecodeAttributes) {
+    const char* names[] = {"tool", "color", "unknown", "width", nullptr};
+    const char* values[] = {"pen", "#000000ff", "ignored", "1.41 1.2", nullptr};
+
+    LoadHandlerHelper::Attributes attributes;
+    attributes.fill("previous element");
+    LoadHandlerHelper::decodeAttributes(names, values, attributes);
+
+    EXPECT_STREQ(attributes[static_cast<size_t>(Attribute::TOOL)], "pen");
+    EXPECT_STREQ(attributes[static_cast<size_t>(Attribute::COLOR)], "#000000ff");
+    EXPECT_STREQ(attributes[static_cast<size_t>(Attribute::WIDTH)], "1.41 1.2");
+    EXPECT_EQ(attributes[static_cast<size_t>(Attribute::FILL)], nullptr);
+}
@@ -9,13 +9,24 @@
  * @license GNU GPLv2 or later
  */
 
+#include <atomic>
 #include <cmath>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include <config-test.h>
+#include <config.h>
 #include <gtest/gtest.h>
+#include <zip.h>
 
+#include "control/xojfile/AutosaveJournal.h"
+#include "control/xojfile/IndexedSaveHandler.h"
 #include "control/xojfile/LoadHandler.h"
 #include "control/xojfile/SaveHandler.h"
 #include "util/PathUtil.h"
@@ -425,3 +436,399 @@ TEST(ControlLoadHandler, testLoadStoreLoadGerman) {
     setlocale(LC_ALL, "C");
 }
 #endif
+
+TEST(ControlLoadHandler, testParseCoordinates) {
+    const char* text = " 1.5 -2\n3e2\t+4 5.25x";
+    const char* end = text + strlen(text);
+    EXPECT_EQ(LoadHandlerHelper::countTokens(text, end), 5U);
+
+    std::vector<double> values;
+    double value = 0;
+    while (LoadHandlerHelper::parseNextDouble(text, end, value)) { values.push_back(value); }
+
+    // The trailing garbage is parsed the same way as g_ascii_strtod does
+    EXPECT_EQ(values, (std::vector<double>{1.5, -2, 300, 4, 5.25}));
+    EXPECT_EQ(*text, 'x');
+}
+
+TEST(ControlLoadHandler, testLazyPageLoading) {
+    for (auto file: {"packaged_xopp/suite.xopp", "big-test.xoj"}) {
+        LoadHandler eagerHandler;
+        Document* eager = eagerHandler.loadDocument(GET_TESTFILE(file));
+        ASSERT_TRUE(eager);
+
+        LoadHandler lazyHandler;
+        lazyHandler.setLazyPageLoading(true);
+        Document* lazy = lazyHandler.loadDocument(GET_TESTFILE(file));
+        ASSERT_TRUE(lazy);
+        ASSERT_EQ(lazy->getPageCount(), eager->getPageCount());
+
+        for (size_t i = 0; i < lazy->getPageCount(); i++) {
+            PageRef lazyPage = lazy->getPage(i);
+            PageRef eagerPage = eager->getPage(i);
+            EXPECT_EQ(lazyPage->hasPendingLayers(), eagerPage->getLayerCount() > 0);
+            EXPECT_EQ(lazyPage->getBackgroundType(), eagerPage->getBackgroundType());
+
+            // Accessing the layers parses them
+            ASSERT_EQ(lazyPage->getLayerCount(), eagerPage->getLayerCount());
+            EXPECT_FALSE(lazyPage->hasPendingLayers());
+            for (size_t l = 0; l < lazyPage->getLayerCount(); l++) {
+                auto& lazyElements = (*lazyPage->getLayers())[l]->getElements();
+                auto& eagerElements = (*eagerPage->getLayers())[l]->getElements();
+                ASSERT_EQ(lazyElements.size(), eagerElements.size());
+                for (size_t e = 0; e < lazyElements.size(); e++) {
+                    EXPECT_EQ(lazyElements[e]->getType(), eagerElements[e]->getType());
+                    EXPECT_DOUBLE_EQ(lazyElements[e]->getX(), eagerElements[e]->getX());
+                    EXPECT_DOUBLE_EQ(lazyElements[e]->getElementWidth(), eagerElements[e]->getElementWidth());
+                }
+            }
+        }
+    }
+}
+
+TEST(ControlLoadHandler, testParallelPageLoading) {
+    for (auto file: {"packaged_xopp/suite.xopp", "big-test.xoj"}) {
+        LoadHandler sequentialHandler;
+        sequentialHandler.setParallelPageLoading(false);
+        Document* sequential = sequentialHandler.loadDocument(GET_TESTFILE(file));
+        ASSERT_TRUE(sequential);
+
+        LoadHandler parallelHandler;
+        Document* parallel = parallelHandler.loadDocument(GET_TESTFILE(file));
+        ASSERT_TRUE(parallel);
+        ASSERT_EQ(parallel->getPageCount(), sequential->getPageCount());
+
+        // Same pages, in the same order, with all their layers loaded
+        for (size_t i = 0; i < parallel->getPageCount(); i++) {
+            PageRef parallelPage = parallel->getPage(i);
+            PageRef sequentialPage = sequential->getPage(i);
+            EXPECT_FALSE(parallelPage->hasPendingLayers());
+            ASSERT_EQ(parallelPage->getLayerCount(), sequentialPage->getLayerCount());
+            for (size_t l = 0; l < parallelPage->getLayerCount(); l++) {
+                auto& parallelElements = (*parallelPage->getLayers())[l]->getElements();
+                auto& sequentialElements = (*sequentialPage->getLayers())[l]->getElements();
+                ASSERT_EQ(parallelElements.size(), sequentialElements.size());
+                for (size_t e = 0; e < parallelElements.size(); e++) {
+                    EXPECT_EQ(parallelElements[e]->getType(), sequentialElements[e]->getType());
+                    EXPECT_DOUBLE_EQ(parallelElements[e]->getX(), sequentialElements[e]->getX());
+                    EXPECT_DOUBLE_EQ(parallelElements[e]->getY(), sequentialElements[e]->getY());
+                }
+            }
+        }
+    }
+}
+
+TEST(ControlLoadHandler, testRemainingPages) {
+    LoadHandler fullHandler;
+    fullHandler.setLazyPageLoading(true);
+    Document* full = fullHandler.loadDocument(GET_TESTFILE("big-test.xoj"));
+    ASSERT_TRUE(full);
+    ASSERT_GT(full->getPageCount(), 10 + LoadHandler::PAGE_BATCH_SIZE);
+
+    LoadHandler handler;
+    handler.setLazyPageLoading(true);
+    handler.setFirstPageCount(10);
+    Document* doc = handler.loadDocument(GET_TESTFILE("big-test.xoj"));
+    ASSERT_TRUE(doc);
+    ASSERT_TRUE(handler.hasRemainingPages());
+    EXPECT_GE(doc->getPageCount(), 10);
+    EXPECT_LT(doc->getPageCount(), full->getPageCount());
+
+    // The batches follow each other, and the pages load their layers
+    std::vector<PageRef> pages;
+    for (size_t i = 0; i < doc->getPageCount(); i++) { pages.push_back(doc->getPage(i)); }
+    size_t batches = 0;
+    std::atomic<bool> cancelled{false};
+    EXPECT_TRUE(handler.loadRemainingPages(
+            [&](std::vector<PageRef> batch, const Document* pdf) {
+                EXPECT_FALSE(batch.empty());
+                EXPECT_EQ(pdf, nullptr);
+                pages.insert(pages.end(), batch.begin(), batch.end());
+                batches++;
+            },
+            cancelled));
+    EXPECT_FALSE(handler.hasRemainingPages());
+    EXPECT_GE(batches, 2);
+
+    ASSERT_EQ(pages.size(), full->getPageCount());
+    for (size_t i = 0; i < pages.size(); i++) {
+        PageRef fullPage = full->getPage(i);
+        EXPECT_EQ(pages[i]->getBackgroundType(), fullPage->getBackgroundType());
+        ASSERT_EQ(pages[i]->getLayerCount(), fullPage->getLayerCount());
+        for (size_t l = 0; l < pages[i]->getLayerCount(); l++) {
+            EXPECT_EQ((*pages[i]->getLayers())[l]->getElements().size(),
+                      (*fullPage->getLayers())[l]->getElements().size());
+        }
+    }
+
+    // Cancelled: the parser stops after the current batch
+    LoadHandler cancelledHandler;
+    cancelledHandler.setLazyPageLoading(true);
+    cancelledHandler.setFirstPageCount(10);
+    ASSERT_TRUE(cancelledHandler.loadDocument(GET_TESTFILE("big-test.xoj")));
+    EXPECT_TRUE(cancelledHandler.loadRemainingPages(
+            [&](std::vector<PageRef>, const Document*) { cancelled = true; }, cancelled));
+    EXPECT_FALSE(cancelledHandler.hasRemainingPages());
+}
+
+TEST(ControlLoadHandler, testIndexedLayout) {
+    auto countElements = [](Document* doc) {
+        std::vector<size_t> counts;
+        for (size_t i = 0; i < doc->getPageCount(); i++) {
+            for (Layer* l: *doc->getPage(i)->getLayers()) { counts.push_back(l->getElements().size()); }
+        }
+        return counts;
+    };
+
+    LoadHandler handler;
+    Document* doc = handler.loadDocument(GET_TESTFILE("packaged_xopp/suite.xopp"));
+    ASSERT_TRUE(doc);
+    auto expected = countElements(doc);
+
+    IndexedSaveHandler h;
+    h.prepareSave(doc);
+    auto tmp = Util::getTmpDirSubfolder() / "indexed.xopp";
+    h.saveTo(tmp);
+    EXPECT_EQ(h.getErrorMessage(), "");
+
+    LoadHandler eagerHandler;
+    Document* eager = eagerHandler.loadDocument(tmp);
+    ASSERT_TRUE(eager);
+    EXPECT_FALSE(eager->getPage(0)->hasPendingLayers());
+    EXPECT_EQ(countElements(eager), expected);
+
+    // Saving a document whose pages were not accessed copies their entries
+    LoadHandler lazyHandler;
+    lazyHandler.setLazyPageLoading(true);
+    Document* lazy = lazyHandler.loadDocument(tmp);
+    ASSERT_TRUE(lazy);
+    EXPECT_TRUE(lazy->getPage(0)->hasPendingLayers());
+
+    IndexedSaveHandler h2;
+    h2.prepareSave(lazy);
+    EXPECT_TRUE(lazy->getPage(0)->hasPendingLayers());
+    auto tmp2 = Util::getTmpDirSubfolder() / "indexed2.xopp";
+    h2.saveTo(tmp2);
+    EXPECT_EQ(h2.getErrorMessage(), "");
+
+    LoadHandler reloadHandler;
+    Document* reloaded = reloadHandler.loadDocument(tmp2);
+    ASSERT_TRUE(reloaded);
+    EXPECT_EQ(countElements(reloaded), expected);
+    EXPECT_EQ(countElements(lazy), expected);
+}
+
+TEST(ControlLoadHandler, testIndexedLayoutUpdatedInPlace) {
+    auto getCrc = [](const fs::path& file, const char* entry) -> std::optional<uint32_t> {
+        zip_t* zip = zip_open(file.u8string().c_str(), ZIP_RDONLY, nullptr);
+        if (!zip) {
+            return std::nullopt;
+        }
+        zip_stat_t stat;
+        zip_stat_init(&stat);
+        std::optional<uint32_t> crc;
+        if (zip_stat(zip, entry, 0, &stat) == 0) {
+            crc = stat.crc;
+        }
+        zip_discard(zip);
+        return crc;
+    };
+
+    LoadHandler handler;
+    Document* doc = handler.loadDocument(GET_TESTFILE("packaged_xopp/pdfBackground/new.xopp"));
+    ASSERT_TRUE(doc);
+    ASSERT_TRUE(doc->isAttachPdf());
+    uint32_t pdfCrc = doc->getPdfAttachmentSource().crc;
+    EXPECT_EQ(doc->getPdfAttachmentSource().entry, "attachments/bg.pdf");
+
+    auto tmp = Util::getTmpDirSubfolder() / "inplace.xopp";
+    auto writtenPdf = Util::getTmpDirSubfolder() / "inplace.xopp.bg.pdf";
+    fs::remove(tmp);
+    fs::remove(writtenPdf);
+    doc->setFilepath(tmp);
+
+    // The attached PDF is copied from the archive it was read from, instead of being written
+    IndexedSaveHandler h;
+    h.prepareSave(doc);
+    h.saveTo(tmp);
+    EXPECT_EQ(h.getErrorMessage(), "");
+    EXPECT_FALSE(fs::exists(writtenPdf));
+    EXPECT_EQ(getCrc(tmp, "bg.pdf"), pdfCrc);
+
+    zip_t* zip = zip_open(tmp.u8string().c_str(), 0, nullptr);
+    ASSERT_TRUE(zip);
+    zip_source_t* stale = zip_source_buffer(zip, "stale", 5, 0);
+    ASSERT_GE(zip_file_add(zip, "pages/stale.xml", stale, 0), 0);
+    ASSERT_EQ(zip_close(zip), 0);
+
+    // Saved again: the unchanged entries are kept, the ones no longer referenced are removed
+    LoadHandler lazyHandler;
+    lazyHandler.setLazyPageLoading(true);
+    Document* lazy = lazyHandler.loadDocument(tmp);
+    ASSERT_TRUE(lazy);
+    EXPECT_EQ(lazy->getPdfAttachmentSource().entry, "bg.pdf");
+    auto pageCrc = getCrc(tmp, "pages/1.xml");
+    ASSERT_TRUE(pageCrc);
+
+    IndexedSaveHandler h2;
+    h2.prepareSave(lazy);
+    h2.saveTo(tmp);
+    EXPECT_EQ(h2.getErrorMessage(), "");
+    EXPECT_FALSE(fs::exists(writtenPdf));
+    EXPECT_EQ(getCrc(tmp, "bg.pdf"), pdfCrc);
+    EXPECT_EQ(getCrc(tmp, "pages/1.xml"), pageCrc);
+    EXPECT_FALSE(getCrc(tmp, "pages/stale.xml"));
+
+    LoadHandler reloadHandler;
+    Document* reloaded = reloadHandler.loadDocument(tmp);
+    ASSERT_TRUE(reloaded);
+    EXPECT_EQ(reloaded->getPageCount(), doc->getPageCount());
+    EXPECT_EQ(reloaded->getPdfPageCount(), doc->getPdfPageCount());
+}
+
+TEST(ControlLoadHandler, testAutosaveJournal) {
+    LoadHandler handler;
+    Document* doc = handler.loadDocument(GET_TESTFILE("packaged_xopp/suite.xopp"));
+    ASSERT_TRUE(doc);
+    size_t pageCount = doc->getPageCount();
+
+    auto snapshot = Util::getTmpDirSubfolder() / "journal.autosave.xopp";
+    fs::remove(AutosaveJournal::getJournalPath(snapshot));
+
+    AutosaveJournal journal;
+    EXPECT_TRUE(journal.needsSnapshot(doc, snapshot));
+    SaveHandler h;
+    h.prepareSave(doc);
+    journal.snapshotTaken(doc, snapshot);
+    h.saveTo(snapshot);
+    EXPECT_EQ(h.getErrorMessage(), "");
+    EXPECT_FALSE(journal.needsSnapshot(doc, snapshot));
+
+    // Change the first page, and add pages at the end and at the front
+    PageRef first = doc->getPage(0);
+    size_t layerCount = first->getLayerCount();
+    first->getLayers()->push_back(new Layer());
+    journal.undoRedoPageChanged(first);
+    doc->addPage(std::make_shared<XojPage>(100, 200));
+    doc->insertPage(std::make_shared<XojPage>(300, 400), 0);
+
+    journal.prepareRecord(doc);
+    EXPECT_EQ(journal.writeRecord(), "");
+
+    LoadHandler reloadHandler;
+    Document* reloaded = reloadHandler.loadDocument(snapshot);
+    ASSERT_TRUE(reloaded);
+    ASSERT_EQ(reloaded->getPageCount(), pageCount + 2);
+    EXPECT_DOUBLE_EQ(reloaded->getPage(0)->getWidth(), 300);
+    EXPECT_EQ(reloaded->getPage(1)->getLayerCount(), layerCount + 1);
+    EXPECT_DOUBLE_EQ(reloaded->getPage(pageCount + 1)->getHeight(), 200);
+
+    fs::remove(AutosaveJournal::getJournalPath(snapshot));
+}
+
+TEST(ControlLoadHandler, testDocumentSnapshot) {
+    LoadHandler handler;
+    handler.setLazyPageLoading(true);
+    Document* doc = handler.loadDocument(GET_TESTFILE("big-test.xoj"));
+    ASSERT_TRUE(doc);
+    size_t layerCount = doc->getPage(0)->getLayerCount();
+    ASSERT_TRUE(doc->getPage(1)->hasPendingLayers());
+
+    std::unique_ptr<Document> snapshot = doc->snapshot();
+    ASSERT_EQ(snapshot->getPageCount(), doc->getPageCount());
+
+    // The pages which are not loaded yet are not loaded by the snapshot
+    EXPECT_TRUE(doc->getPage(1)->hasPendingLayers());
+    EXPECT_TRUE(snapshot->getPage(1)->hasPendingLayers());
+
+    // Editing the document does not change the snapshot
+    doc->getPage(0)->getLayers()->push_back(new Layer());
+    EXPECT_EQ(snapshot->getPage(0)->getLayerCount(), layerCount);
+
+    EXPECT_EQ(snapshot->getPage(1)->getLayerCount(), doc->getPage(1)->getLayerCount());
+    EXPECT_NE(snapshot->getPage(1)->getLayers()->front(), doc->getPage(1)->getLayers()->front());
+}
+
+TEST(ControlLoadHandler, testBinaryStrokes) {
+    auto getStrokes = [](Document* doc) {
+        std::vector<Stroke*> strokes;
+        for (size_t i = 0; i < doc->getPageCount(); i++) {
+            for (Layer* l: *doc->getPage(i)->getLayers()) {
+                for (Element* e: l->getElements()) {
+                    if (e->getType() == ELEMENT_STROKE) {
+                        strokes.push_back(dynamic_cast<Stroke*>(e));
+                    }
+                }
+            }
+        }
+        return strokes;
+    };
+
+    LoadHandler handler;
+    Document* doc = handler.loadDocument(GET_TESTFILE("packaged_xopp/suite.xopp"));
+    ASSERT_TRUE(doc);
+    auto expected = getStrokes(doc);
+    ASSERT_FALSE(expected.empty());
+
+    SaveHandler h;
+    h.setBinaryStrokes(true);
+    h.prepareSave(doc);
+    auto tmp = Util::getTmpDirSubfolder() / "binary.xopp";
+    h.saveTo(tmp);
+    EXPECT_EQ(h.getErrorMessage(), "");
+
+    LoadHandler reloadHandler;
+    Document* reloaded = reloadHandler.loadDocument(tmp);
+    ASSERT_TRUE(reloaded);
+    EXPECT_EQ(reloadHandler.getFileVersion(), FILE_FORMAT_VERSION);
+    auto strokes = getStrokes(reloaded);
+    ASSERT_EQ(strokes.size(), expected.size());
+
+    // The coordinates are quantized to 1 / StrokeEncoding::SCALE
+    for (size_t i = 0; i < strokes.size(); i++) {
+        EXPECT_DOUBLE_EQ(strokes[i]->getWidth(), expected[i]->getWidth());
+        EXPECT_EQ(strokes[i]->hasPressure(), expected[i]->hasPressure());
+        ASSERT_EQ(strokes[i]->getPointCount(), expected[i]->getPointCount());
+        for (int j = 0; j < strokes[i]->getPointCount(); j++) {
+            Point p = strokes[i]->getPoint(j);
+            Point q = expected[i]->getPoint(j);
+            EXPECT_NEAR(p.x, q.x, 1e-4);
+            EXPECT_NEAR(p.y, q.y, 1e-4);
+            if (j + 1 < strokes[i]->getPointCount() && expected[i]->hasPressure()) {
+                EXPECT_NEAR(p.z, q.z, 1e-4);
+            }
+        }
+    }
+}
+
+TEST(ControlLoadHandler, testSaveReplacesTheFile) {
+    LoadHandler handler;
+    Document* doc = handler.loadDocument(GET_TESTFILE("packaged_xopp/suite.xopp"));
+    ASSERT_TRUE(doc);
+
+    auto target = Util::getTmpDirSubfolder() / "replaced.xopp";
+    auto backup = fs::path{target} += "~";
+    {
+        std::ofstream previous(target);
+        previous << "previous version";
+    }
+    fs::remove(backup);
+    fs::create_hard_link(target, backup);
+
+    SaveHandler h;
+    h.prepareSave(doc);
+    h.saveTo(target);
+    EXPECT_EQ(h.getErrorMessage(), "");
+    EXPECT_FALSE(fs::exists(fs::path{target} += ".tmp"));
+
+    // The new file replaced the target, the link still holds the previous version
+    std::ifstream kept(backup);
+    std::string content((std::istreambuf_iterator<char>(kept)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, "previous version");
+
+    LoadHandler reloadHandler;
+    Document* reloaded = reloadHandler.loadDocument(target);
+    ASSERT_TRUE(reloaded);
+    EXPECT_EQ(reloaded->getPageCount(), doc->getPageCount());
+    fs::remove(backup);
+}
@@ -0,0 +1,58 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "control/MemoryReport.h"
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include "model/Text.h"
+#include "model/XojPage.h"
+
+static Stroke* makeStroke(int points) {
+    auto* s = new Stroke();
+    s->setWidth(1);
+    for (int i = 0; i < points; i++) { s->addPoint(Point(i, i)); }
+    return s;
+}
+
+TEST(MemoryReport, testCountsTheElementsByPage) {
+    DocumentHandler handler;
+    Document doc(&handler);
+    for (int i = 0; i < 2; i++) { doc.addPage(std::make_shared<XojPage>(100, 100)); }
+
+    Stroke* small = makeStroke(2);
+    Stroke* large = makeStroke(1000);
+    auto* text = new Text();
+    text->setText("Some text");
+    Layer* layer = doc.getPage(1)->getSelectedLayer();
+    layer->addElement(small);
+    layer->addElement(large);
+    layer->addElement(text);
+
+    MemoryReport report(&doc);
+    ASSERT_EQ(report.pages.size(), 2);
+    EXPECT_EQ(report.pages[0].strokes.count, 0);
+    EXPECT_EQ(report.pages[1].strokes.count, 2);
+    EXPECT_EQ(report.pages[1].strokes.bytes, small->getMemoryUsage() + large->getMemoryUsage());
+    EXPECT_GT(large->getMemoryUsage(), small->getMemoryUsage());
+    EXPECT_EQ(report.pages[1].texts.count, 1);
+    EXPECT_EQ(report.pages[1].texts.bytes, text->getMemoryUsage());
+
+    EXPECT_EQ(report.elements.strokes.count, 2);
+    EXPECT_EQ(report.elements.getBytes(), report.pages[0].getBytes() + report.pages[1].getBytes());
+    EXPECT_GE(report.getTotalBytes(), report.elements.getBytes());
+    EXPECT_FALSE(report.toString(true).empty());
+}
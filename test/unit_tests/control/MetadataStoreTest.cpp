@@ -0,0 +1,123 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "control/settings/MetadataStore.h"
+
+#include "filesystem.h"
+
+namespace {
+class MetadataStoreTest: public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::string name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        folder = fs::temp_directory_path() / ("xournalpp-metadata-" + name);
+        fs::remove_all(folder);
+        fs::create_directories(folder);
+        log = folder / "metadata.log";
+    }
+
+    void TearDown() override { fs::remove_all(folder); }
+
+    static auto entry(const fs::path& path, int page, double zoom, gint64 time) -> MetadataEntry {
+        MetadataEntry e;
+        e.valid = true;
+        e.path = path;
+        e.page = page;
+        e.zoom = zoom;
+        e.time = time;
+        return e;
+    }
+
+    static auto countLines(const fs::path& file) -> size_t {
+        std::ifstream in(file);
+        size_t lines = 0;
+        for (std::string line; std::getline(in, line);) { lines++; }
+        return lines;
+    }
+
+    fs::path folder;
+    fs::path log;
+};
+}  // namespace
+
+TEST_F(MetadataStoreTest, testStoredEntriesAreReadBack) {
+    {
+        MetadataStore store(log);
+        EXPECT_FALSE(store.get("/home/user/notes.xopp").valid);
+        store.store(entry("/home/user/notes.xopp", 3, 1.5, 100));
+        store.store(entry("/home/user/space name.xopp", 7, 0.75, 200));
+        store.store(entry("/home/user/notes.xopp", 4, 2.0, 300));
+
+        auto e = store.get("/home/user/notes.xopp");
+        EXPECT_TRUE(e.valid);
+        EXPECT_EQ(e.page, 4);
+    }
+
+    MetadataStore store(log);
+    EXPECT_EQ(store.size(), 2U);
+    auto e = store.get("/home/user/notes.xopp");
+    ASSERT_TRUE(e.valid);
+    EXPECT_EQ(e.page, 4);
+    EXPECT_DOUBLE_EQ(e.zoom, 2.0);
+    EXPECT_EQ(e.time, 300);
+
+    e = store.get("/home/user/space name.xopp");
+    ASSERT_TRUE(e.valid);
+    EXPECT_EQ(e.page, 7);
+    EXPECT_DOUBLE_EQ(e.zoom, 0.75);
+}
+
+TEST_F(MetadataStoreTest, testLogIsCompacted) {
+    MetadataStore store(log);
+    for (int i = 0; i < 200; i++) { store.store(entry("/home/user/notes.xopp", i, 1, i + 1)); }
+    store.flush();
+
+    // The header and at most one record per document and the slack before the compaction
+    EXPECT_LE(countLines(log), 1 + 2 + MetadataStore::MAX_ENTRIES + 1);
+    EXPECT_EQ(store.get("/home/user/notes.xopp").page, 199);
+}
+
+TEST_F(MetadataStoreTest, testOnlyTheRecentEntriesAreKept) {
+    MetadataStore store(log);
+    for (int i = 0; i < 30; i++) { store.store(entry("/document" + std::to_string(i), i, 1, i + 1)); }
+    EXPECT_EQ(store.size(), MetadataStore::MAX_ENTRIES);
+    EXPECT_FALSE(store.get("/document0").valid);
+    EXPECT_TRUE(store.get("/document29").valid);
+}
+
+TEST_F(MetadataStoreTest, testMetadataFilesAreImported) {
+    {
+        std::ofstream out(folder / "1234.metadata");
+        out << "XOJ-METADATA/1.0\n\"/home/user/old.xopp\"\npage=5\nzoom=1.25\n";
+    }
+    {
+        std::ofstream out(folder / "1235.metadata");
+        out << "garbage\n";
+    }
+
+    MetadataStore store(log);
+    auto e = store.get("/home/user/old.xopp");
+    ASSERT_TRUE(e.valid);
+    EXPECT_EQ(e.page, 5);
+    EXPECT_DOUBLE_EQ(e.zoom, 1.25);
+    EXPECT_EQ(e.time, 1234);
+    EXPECT_EQ(store.size(), 1U);
+
+    store.flush();
+    EXPECT_FALSE(fs::exists(folder / "1234.metadata"));
+    EXPECT_FALSE(fs::exists(folder / "1235.metadata"));
+    EXPECT_TRUE(fs::exists(log));
+}
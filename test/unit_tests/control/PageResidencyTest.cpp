@@ -0,0 +1,97 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <vector>
+
+#include <config-test.h>
+#include <gtest/gtest.h>
+
+#include "control/PageResidency.h"
+#include "control/xojfile/LoadHandler.h"
+#include "model/Document.h"
+#include "model/XojPage.h"
+
+/**
+ * @return The document, with the layers of all its pages loaded
+ */
+static auto loadLazily(LoadHandler& handler) -> Document* {
+    handler.setLazyPageLoading(true);
+    Document* doc = handler.loadDocument(GET_TESTFILE("big-test.xoj"));
+    if (doc) {
+        for (size_t i = 0; i < doc->getPageCount(); i++) { doc->getPage(i)->getLayerCount(); }
+    }
+    return doc;
+}
+
+static auto countElements(const PageRef& page) -> size_t {
+    size_t count = 0;
+    for (Layer* l: *page->getLayers()) { count += l->getElements().size(); }
+    return count;
+}
+
+TEST(PageResidency, testUnloadsTheLeastRecentlyUsedPages) {
+    LoadHandler handler;
+    Document* doc = loadLazily(handler);
+    ASSERT_TRUE(doc);
+    ASSERT_GE(doc->getPageCount(), 3);
+
+    std::vector<size_t> elements;
+    for (size_t i = 0; i < doc->getPageCount(); i++) {
+        PageRef page = doc->getPage(i);
+        elements.push_back(countElements(page));
+        EXPECT_FALSE(page->hasPendingLayers());
+        EXPECT_NE(page->getLayerReloader(), nullptr);
+    }
+
+    // No limit: all the pages stay loaded
+    PageResidency residency(0);
+    EXPECT_EQ(residency.update(*doc, [](size_t) { return true; }), 0);
+    size_t loaded = residency.getLoadedMemory();
+    EXPECT_GT(loaded, 0);
+    EXPECT_EQ(residency.update(*doc, [](size_t) { return false; }), 0);
+
+    // The page in use is kept, the changed page cannot be loaded again
+    PageRef changed = doc->getPage(1);
+    changed->setBackgroundColor(Color(0x123456U));
+    EXPECT_EQ(changed->getLayerReloader(), nullptr);
+
+    residency.setBudget(1);
+    residency.update(*doc, [](size_t page) { return page == 0; });
+    EXPECT_LT(residency.getLoadedMemory(), loaded);
+    EXPECT_FALSE(doc->getPage(0)->hasPendingLayers());
+    EXPECT_FALSE(changed->hasPendingLayers());
+    for (size_t i = 2; i < doc->getPageCount(); i++) { EXPECT_TRUE(doc->getPage(i)->hasPendingLayers()); }
+
+    // Loaded again on access
+    for (size_t i = 0; i < doc->getPageCount(); i++) { EXPECT_EQ(countElements(doc->getPage(i)), elements[i]); }
+    EXPECT_NE(doc->getPage(2)->getLayerReloader(), nullptr);
+}
+
+TEST(PageResidency, testKeepsTheMostRecentlyUsedPages) {
+    LoadHandler handler;
+    Document* doc = loadLazily(handler);
+    ASSERT_TRUE(doc);
+    ASSERT_GE(doc->getPageCount(), 3);
+
+    PageResidency residency(0);
+    // The last page is used longer ago than the others
+    residency.update(*doc, [](size_t) { return true; });
+    size_t last = doc->getPageCount() - 1;
+    residency.update(*doc, [last](size_t page) { return page != last; });
+
+    // Within the budget once the last page is unloaded
+    size_t lastBytes = doc->getPage(last)->getMemoryUsage();
+    ASSERT_GT(lastBytes, 0);
+    residency.setBudget(residency.getLoadedMemory() - lastBytes);
+    EXPECT_EQ(residency.update(*doc, [](size_t) { return false; }), 1);
+    EXPECT_TRUE(doc->getPage(last)->hasPendingLayers());
+    for (size_t i = 0; i < last; i++) { EXPECT_FALSE(doc->getPage(i)->hasPendingLayers()); }
+}
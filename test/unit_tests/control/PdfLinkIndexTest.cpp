@@ -0,0 +1,66 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "control/PdfLinkIndex.h"
+
+static auto makeLink(double x1, double y1, double x2, double y2, std::string text, bool annotation = false)
+        -> XojPdfPage::Link {
+    XojPdfPage::Link link;
+    link.rect = XojPdfRectangle(x1, y1, x2, y2);
+    link.text = std::move(text);
+    link.annotation = annotation;
+    return link;
+}
+
+TEST(PdfLinkIndex, testLinkAt) {
+    std::vector<XojPdfPage::Link> links;
+    links.push_back(makeLink(10, 10, 100, 20, "first"));
+    // Given upside down
+    links.push_back(makeLink(400, 790, 500, 700, "last"));
+    PdfLinkIndex index(links, 595, 842);
+
+    ASSERT_EQ(index.getLinkCount(), 2);
+    ASSERT_NE(index.linkAt(50, 15), nullptr);
+    EXPECT_EQ(index.linkAt(50, 15)->text, "first");
+    ASSERT_NE(index.linkAt(450, 750), nullptr);
+    EXPECT_EQ(index.linkAt(450, 750)->text, "last");
+
+    EXPECT_EQ(index.linkAt(50, 25), nullptr);
+    EXPECT_EQ(index.linkAt(300, 400), nullptr);
+    // Outside of the page
+    EXPECT_EQ(index.linkAt(-5, -5), nullptr);
+    EXPECT_EQ(index.linkAt(1000, 1000), nullptr);
+}
+
+TEST(PdfLinkIndex, testOverlappingLinks) {
+    std::vector<XojPdfPage::Link> links;
+    links.push_back(makeLink(0, 0, 200, 200, "note", true));
+    links.push_back(makeLink(0, 0, 200, 200, "large"));
+    links.push_back(makeLink(50, 50, 60, 60, "small"));
+    PdfLinkIndex index(links, 595, 842);
+
+    EXPECT_EQ(index.linkAt(55, 55)->text, "small");
+    EXPECT_EQ(index.linkAt(150, 150)->text, "large");
+}
+
+TEST(PdfLinkIndex, testLargePage) {
+    std::vector<XojPdfPage::Link> links;
+    for (int i = 0; i < 1000; i++) { links.push_back(makeLink(10, i * 20.0, 60, i * 20.0 + 10, std::to_string(i))); }
+    PdfLinkIndex index(links, 100, 20000);
+
+    EXPECT_EQ(index.linkAt(30, 12345)->text, "617");
+    EXPECT_EQ(index.linkAt(30, 12355), nullptr);
+}
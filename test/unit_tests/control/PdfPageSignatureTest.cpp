@@ -0,0 +1,56 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "control/PdfPageSignature.h"
+#include "util/Util.h"
+
+static auto sign(uint64_t hash, double width = 595, double height = 842) -> PdfPageSignature {
+    PdfPageSignature signature;
+    signature.width = width;
+    signature.height = height;
+    signature.hash = hash;
+    return signature;
+}
+
+TEST(PdfPageSignature, testUnchangedPagesKeepTheirNumber) {
+    const std::vector<PdfPageSignature> before = {sign(1), sign(2), sign(3)};
+    const std::vector<PdfPageSignature> after = {sign(1), sign(7), sign(3), sign(8)};
+
+    EXPECT_EQ(PdfPageSignature::match(before, after), (std::vector<size_t>{0, npos, 2, npos}));
+    EXPECT_EQ(PdfPageSignature::match(before, {}), std::vector<size_t>{});
+    EXPECT_EQ(PdfPageSignature::match({}, before), (std::vector<size_t>{npos, npos, npos}));
+}
+
+TEST(PdfPageSignature, testInsertedPageShiftsTheNextOnes) {
+    const std::vector<PdfPageSignature> before = {sign(1), sign(2), sign(3), sign(4)};
+    const std::vector<PdfPageSignature> inserted = {sign(1), sign(9), sign(2), sign(3), sign(4)};
+    EXPECT_EQ(PdfPageSignature::match(before, inserted), (std::vector<size_t>{0, npos, 1, 2, 3}));
+
+    const std::vector<PdfPageSignature> removed = {sign(1), sign(3), sign(4)};
+    EXPECT_EQ(PdfPageSignature::match(before, removed), (std::vector<size_t>{0, 2, 3}));
+}
+
+TEST(PdfPageSignature, testSameContentsTakeTheClosestPage) {
+    // E.g. the blank pages of a document
+    const std::vector<PdfPageSignature> before = {sign(5), sign(1), sign(5), sign(2), sign(3), sign(5)};
+    const std::vector<PdfPageSignature> after = {sign(1), sign(5), sign(2), sign(3), sign(5), sign(6)};
+    EXPECT_EQ(PdfPageSignature::match(before, after), (std::vector<size_t>{1, 0, 3, 4, 5, npos}));
+}
+
+TEST(PdfPageSignature, testTheSizeOfThePageCounts) {
+    const std::vector<PdfPageSignature> before = {sign(1), sign(1, 842, 595)};
+    const std::vector<PdfPageSignature> after = {sign(1, 842, 595), sign(1, 100, 100)};
+    EXPECT_EQ(PdfPageSignature::match(before, after), (std::vector<size_t>{1, npos}));
+}
@@ -0,0 +1,105 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "control/PdfTextLayout.h"
+
+/**
+ * Two lines "Hello world" and "Second line", as Poppler extracts them: 10 wide characters, 20 high lines, with a box
+ * for each newline
+ */
+static auto makeLayout() -> PdfTextLayout {
+    std::string text = "Hello world\nSecond line";
+    std::vector<XojPdfRectangle> boxes;
+    double x = 0;
+    double y = 0;
+    for (char c: text) {
+        if (c == '\n') {
+            boxes.emplace_back(x, y, x, y + 20);
+            x = 0;
+            y += 30;
+            continue;
+        }
+        boxes.emplace_back(x, y, x + 10, y + 20);
+        x += 10;
+    }
+    return PdfTextLayout(text, boxes);
+}
+
+TEST(PdfTextLayout, testLines) {
+    auto layout = makeLayout();
+    EXPECT_EQ(layout.getCharCount(), 23);
+    EXPECT_EQ(layout.getLineCount(), 2);
+}
+
+TEST(PdfTextLayout, testLinearSelection) {
+    auto layout = makeLayout();
+    // From the middle of "world" to the middle of "line"
+    XojPdfRectangle rect(67, 10, 92, 40);
+    EXPECT_EQ(layout.selectText(rect, XojPdfPageSelectionStyle::Linear), "orld\nSecond li");
+
+    auto lines = layout.selectTextLines(rect, XojPdfPageSelectionStyle::Linear);
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_DOUBLE_EQ(lines[0].x1, 70);
+    EXPECT_DOUBLE_EQ(lines[0].x2, 110);
+    EXPECT_DOUBLE_EQ(lines[1].x1, 0);
+    EXPECT_DOUBLE_EQ(lines[1].x2, 90);
+    EXPECT_DOUBLE_EQ(lines[1].y1, 30);
+
+    // Backwards
+    XojPdfRectangle backwards(92, 40, 67, 10);
+    EXPECT_EQ(layout.selectText(backwards, XojPdfPageSelectionStyle::Linear), "orld\nSecond li");
+}
+
+TEST(PdfTextLayout, testWordAndLineSelection) {
+    auto layout = makeLayout();
+    XojPdfRectangle click(23, 5, 23, 5);
+    EXPECT_EQ(layout.selectText(click, XojPdfPageSelectionStyle::Word), "Hello");
+    EXPECT_EQ(layout.selectText(click, XojPdfPageSelectionStyle::Line), "Hello world\n");
+
+    auto lines = layout.selectTextLines(click, XojPdfPageSelectionStyle::Line);
+    ASSERT_EQ(lines.size(), 1);
+    EXPECT_DOUBLE_EQ(lines[0].x2, 110);
+}
+
+TEST(PdfTextLayout, testAreaSelection) {
+    auto layout = makeLayout();
+    // The columns of "lo wo" and "ond l"
+    XojPdfRectangle area(35, 5, 75, 45);
+    EXPECT_EQ(layout.selectText(area, XojPdfPageSelectionStyle::Area), "lo wo\nond l");
+
+    auto boxes = layout.selectTextLines(area, XojPdfPageSelectionStyle::Area);
+    ASSERT_EQ(boxes.size(), 2);
+    EXPECT_DOUBLE_EQ(boxes[0].x1, 30);
+    EXPECT_DOUBLE_EQ(boxes[0].x2, 80);
+
+    // Touching the characters only does not select them
+    EXPECT_EQ(layout.selectText(XojPdfRectangle(0, 20, 110, 30), XojPdfPageSelectionStyle::Area), "");
+}
+
+TEST(PdfTextLayout, testFindText) {
+    auto layout = makeLayout();
+    auto results = layout.findText("LINE");
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_DOUBLE_EQ(results[0].x1, 70);
+    EXPECT_DOUBLE_EQ(results[0].y1, 30);
+    EXPECT_DOUBLE_EQ(results[0].x2, 110);
+
+    // Across the lines, the newline matches a space: one box per line
+    EXPECT_EQ(layout.findText("world  second").size(), 2);
+    EXPECT_EQ(layout.findText("o").size(), 3);
+    EXPECT_TRUE(layout.findText("other").empty());
+    EXPECT_TRUE(layout.findText(" ").empty());
+}
@@ -0,0 +1,65 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "control/xojfile/RemoteFile.h"
+
+#include "filesystem.h"
+
+static void writeFile(const fs::path& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+}
+
+static auto readFile(const fs::path& path) -> std::string {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+TEST(RemoteFile, testLocalFilesAreReadInPlace) {
+    const fs::path path = fs::temp_directory_path() / "xournalpp-test-units_RemoteFile_local.xopp";
+    writeFile(path, "content");
+
+    std::string error;
+    if (!RemoteFile::isRemote(path)) {
+        EXPECT_EQ(RemoteFile::getLocalCopy(path, error), path);
+        EXPECT_TRUE(error.empty());
+    }
+    fs::remove(path);
+}
+
+TEST(RemoteFile, testUploadReplacesTheTargetAndItsAttachments) {
+    const fs::path folder = fs::temp_directory_path() / "xournalpp-test-units_RemoteFile";
+    fs::create_directories(folder);
+    const fs::path target = folder / "notes.xopp";
+    writeFile(target, "previous version");
+
+    const fs::path staging = RemoteFile::createStagingFolder();
+    ASSERT_FALSE(staging.empty());
+    const fs::path staged = staging / target.filename();
+    // Larger than a block
+    const std::string content(RemoteFile::BUFFER_SIZE + 123, 'x');
+    writeFile(staged, content);
+    writeFile(fs::path(staged) += ".bg_1.png", "image");
+
+    std::string error;
+    ASSERT_TRUE(RemoteFile::upload(staged, target, nullptr, nullptr, error)) << error;
+    EXPECT_EQ(readFile(target), content);
+    EXPECT_EQ(readFile(fs::path(target) += ".bg_1.png"), "image");
+    EXPECT_FALSE(fs::exists(staging));
+
+    fs::remove_all(folder);
+}
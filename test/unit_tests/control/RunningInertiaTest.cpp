@@ -0,0 +1,80 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "control/shaperecognizer/Inertia.h"
+#include "control/shaperecognizer/RunningInertia.h"
+#include "model/Point.h"
+
+static auto makePoints(size_t count) -> std::vector<Point> {
+    std::vector<Point> points;
+    for (size_t i = 0; i < count; i++) {
+        double t = static_cast<double>(i) / 10;
+        points.emplace_back(300 + 100 * std::cos(t) + t, 400 + 80 * std::sin(2 * t));
+    }
+    return points;
+}
+
+static void expectSameInertia(const Inertia& expected, const Inertia& actual) {
+    EXPECT_NEAR(expected.getMass(), actual.getMass(), 1e-6);
+    if (expected.getMass() > 1) {
+        EXPECT_NEAR(expected.centerX(), actual.centerX(), 1e-6);
+        EXPECT_NEAR(expected.centerY(), actual.centerY(), 1e-6);
+        EXPECT_NEAR(expected.xx(), actual.xx(), 1e-4);
+        EXPECT_NEAR(expected.xy(), actual.xy(), 1e-4);
+        EXPECT_NEAR(expected.yy(), actual.yy(), 1e-4);
+        EXPECT_NEAR(expected.det(), actual.det(), 1e-6);
+    }
+}
+
+TEST(RunningInertia, testRangesMatchCalc) {
+    std::vector<Point> points = makePoints(500);
+
+    RunningInertia inertia;
+    inertia.update(points);
+    ASSERT_EQ(inertia.getPointCount(), points.size());
+
+    for (int start: {0, 1, 17, 250, 498, 499}) {
+        for (int end: {start, start + 1, start + 2, start + 40, 500}) {
+            if (end > 500) {
+                continue;
+            }
+            Inertia expected;
+            expected.calc(points.data(), start, end);
+            expectSameInertia(expected, inertia.range(start, end));
+        }
+    }
+}
+
+TEST(RunningInertia, testUpdatedWhileDrawing) {
+    std::vector<Point> points = makePoints(200);
+
+    RunningInertia inertia;
+    std::vector<Point> drawn;
+    for (const Point& p: points) {
+        drawn.push_back(p);
+        inertia.update(drawn);
+    }
+    // Nothing new
+    inertia.update(drawn);
+    ASSERT_EQ(inertia.getPointCount(), points.size());
+
+    Inertia expected;
+    expected.calc(points.data(), 0, 200);
+    expectSameInertia(expected, inertia.range(0, 200));
+
+    inertia.reset();
+    EXPECT_EQ(inertia.getPointCount(), 0);
+}
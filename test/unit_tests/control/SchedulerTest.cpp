@@ -0,0 +1,34 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include "control/jobs/Scheduler.h"
+
+using namespace std::chrono_literals;
+
+TEST(Scheduler, testJobsAgeOnePriorityPerMissedDeadline) {
+    EXPECT_EQ(Scheduler::getEffectivePriority(JOB_PRIORITY_NONE, 0ms), JOB_PRIORITY_NONE);
+    EXPECT_EQ(Scheduler::getEffectivePriority(JOB_PRIORITY_NONE, Scheduler::DEADLINES[JOB_PRIORITY_NONE]),
+              JOB_PRIORITY_NONE);
+    EXPECT_EQ(Scheduler::getEffectivePriority(JOB_PRIORITY_NONE, Scheduler::DEADLINES[JOB_PRIORITY_NONE] + 1ms),
+              JOB_PRIORITY_LOW);
+    EXPECT_EQ(Scheduler::getEffectivePriority(JOB_PRIORITY_NONE, 2 * Scheduler::DEADLINES[JOB_PRIORITY_NONE] + 1ms),
+              JOB_PRIORITY_HIGH);
+
+    // An autosave waiting for minutes competes with the visible pages
+    EXPECT_EQ(Scheduler::getEffectivePriority(JOB_PRIORITY_NONE, 5min), JOB_PRIORITY_URGENT);
+    EXPECT_EQ(Scheduler::getEffectivePriority(JOB_PRIORITY_LOW, Scheduler::DEADLINES[JOB_PRIORITY_LOW] * 3 / 2),
+              JOB_PRIORITY_HIGH);
+    EXPECT_EQ(Scheduler::getEffectivePriority(JOB_PRIORITY_URGENT, 1s), JOB_PRIORITY_URGENT);
+}
@@ -0,0 +1,38 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "control/SearchIndex.h"
+#include "model/Layer.h"
+#include "model/Text.h"
+#include "model/XojPage.h"
+
+TEST(SearchIndex, testNormalize) {
+    EXPECT_EQ(SearchIndex::normalize("Hello\n  World "), "hello world");
+    EXPECT_EQ(SearchIndex::normalize("  "), "");
+    // Ligature, as extracted from some PDF files
+    EXPECT_EQ(SearchIndex::normalize("\xef\xac\x81nd"), "find");
+    EXPECT_EQ(SearchIndex::normalize("\xc3\x89t\xc3\xa9"), SearchIndex::normalize("\xc3\xa9t\xc3\xa9"));
+}
+
+TEST(SearchIndex, testTextElementsAreSearched) {
+    auto page = std::make_shared<XojPage>(100, 100);
+    auto* layer = new Layer();
+    page->addLayer(layer);
+
+    auto* text = new Text();
+    text->setText("Some Notes");
+    layer->addElement(text);
+
+    SearchIndex index;
+    EXPECT_TRUE(index.mayContain(page, "notes"));
+    EXPECT_FALSE(index.mayContain(page, "other"));
+    EXPECT_FALSE(index.mayContain(page, ""));
+
+    // Edits are taken into account at once
+    text->setText("Other");
+    EXPECT_TRUE(index.mayContain(page, "other"));
+
+    layer->setVisible(false);
+    EXPECT_FALSE(index.mayContain(page, "other"));
+}
@@ -0,0 +1,101 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "control/tools/StrokeDecimator.h"
+#include "model/Point.h"
+
+/**
+ * @return The points kept of the input, added to a stroke as StrokeHandler::paintTo() does
+ */
+static auto decimate(StrokeDecimator& decimator, const std::vector<Point>& input) -> std::vector<Point> {
+    std::vector<Point> stroke{input.front()};
+    for (size_t i = 1; i < input.size(); i++) {
+        if (stroke.size() >= 2 && decimator.replacesLast(stroke[stroke.size() - 2], stroke.back(), input[i], 0)) {
+            stroke.back() = input[i];
+        } else {
+            stroke.push_back(input[i]);
+            decimator.reset();
+        }
+    }
+    return stroke;
+}
+
+static auto distanceToPolyline(const Point& p, const std::vector<Point>& line) -> double {
+    double best = p.lineLengthTo(line.front());
+    for (size_t i = 1; i < line.size(); i++) {
+        const Point& a = line[i - 1];
+        const Point& b = line[i];
+        double lengthSqrd = (b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y);
+        double t = lengthSqrd > 0 ? ((p.x - a.x) * (b.x - a.x) + (p.y - a.y) * (b.y - a.y)) / lengthSqrd : 0;
+        t = std::clamp(t, 0.0, 1.0);
+        best = std::min(best, p.lineLengthTo(Point(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y))));
+    }
+    return best;
+}
+
+TEST(StrokeDecimator, testStraightLine) {
+    std::vector<Point> input;
+    for (int i = 0; i <= 100; i++) { input.emplace_back(i, 0.01 * (i % 2)); }
+
+    // The second point has no segment before it to be measured against
+    StrokeDecimator decimator(0.1);
+    auto stroke = decimate(decimator, input);
+    EXPECT_EQ(stroke.size(), 3);
+    EXPECT_EQ(stroke.back().x, 100);
+}
+
+TEST(StrokeDecimator, testCornerIsKept) {
+    std::vector<Point> input;
+    for (int i = 0; i <= 10; i++) { input.emplace_back(i, 0); }
+    for (int i = 1; i <= 10; i++) { input.emplace_back(10, i); }
+
+    StrokeDecimator decimator(0.1);
+    auto stroke = decimate(decimator, input);
+    ASSERT_EQ(stroke.size(), 3);
+    EXPECT_EQ(stroke[1].x, 10);
+    EXPECT_EQ(stroke[1].y, 0);
+}
+
+TEST(StrokeDecimator, testCurveStaysWithinTolerance) {
+    // A slow arc: the deviation of a whole run of replaced points is bounded, not only the one of the last point
+    std::vector<Point> input;
+    for (int i = 0; i <= 2000; i++) {
+        double a = i * 0.001;
+        input.emplace_back(100 * std::cos(a), 100 * std::sin(a));
+    }
+
+    const double tolerance = 0.05;
+    StrokeDecimator decimator(tolerance);
+    auto stroke = decimate(decimator, input);
+    EXPECT_LT(stroke.size(), input.size() / 10);
+    for (const Point& p: input) { EXPECT_LE(distanceToPolyline(p, stroke), tolerance + 1e-9); }
+}
+
+TEST(StrokeDecimator, testWidthVariation) {
+    StrokeDecimator decimator(0.1);
+    Point anchor(0, 0), last(1, 0), next(2, 0);
+    EXPECT_FALSE(decimator.replacesLast(anchor, last, next, 0.3));
+    EXPECT_TRUE(decimator.replacesLast(anchor, last, next, 0.1));
+}
+
+TEST(StrokeDecimator, testDisabled) {
+    std::vector<Point> input;
+    for (int i = 0; i <= 10; i++) { input.emplace_back(i, 0); }
+
+    StrokeDecimator decimator(0);
+    EXPECT_EQ(decimate(decimator, input).size(), input.size());
+}
@@ -0,0 +1,46 @@
+#include <deque>
+
+#include <gtest/gtest.h>
+
+#include "control/tools/StrokeStabilizer.h"
+
+using StrokeStabilizer::Prediction;
+
+TEST(StrokePrediction, testConstantVelocity) {
+    std::deque<Prediction::Sample> samples{{0, 0, 100}, {2, 1, 105}, {4, 2, 110}};
+    auto d = Prediction::extrapolate(samples, 10);
+    EXPECT_DOUBLE_EQ(d.dx, 4);
+    EXPECT_DOUBLE_EQ(d.dy, 2);
+
+    // With two samples only the velocity is known
+    samples.pop_front();
+    d = Prediction::extrapolate(samples, 10);
+    EXPECT_DOUBLE_EQ(d.dx, 4);
+    EXPECT_DOUBLE_EQ(d.dy, 2);
+}
+
+TEST(StrokePrediction, testAcceleration) {
+    // Velocity 0.2 then 0.4 px/ms: acceleration 0.04 px/ms²
+    std::deque<Prediction::Sample> samples{{0, 0, 0}, {1, 0, 5}, {3, 0, 10}};
+    auto d = Prediction::extrapolate(samples, 5);
+    EXPECT_DOUBLE_EQ(d.dx, 0.4 * 5 + 0.5 * 0.04 * 25);
+    EXPECT_DOUBLE_EQ(d.dy, 0);
+}
+
+TEST(StrokePrediction, testNoPrediction) {
+    // Single event
+    EXPECT_EQ(Prediction::extrapolate({{0, 0, 0}}, 10).norm(), 0);
+
+    // The pointer stopped a while ago
+    EXPECT_EQ(Prediction::extrapolate({{0, 0, 0}, {1, 0, 100}}, 10).norm(), 0);
+
+    // Braking so hard that the extrapolation turns back
+    EXPECT_EQ(Prediction::extrapolate({{0, 0, 0}, {10, 0, 5}, {11, 0, 10}}, 20).norm(), 0);
+}
+
+TEST(StrokePrediction, testMaximumDistance) {
+    std::deque<Prediction::Sample> samples{{0, 0, 0}, {100, 0, 5}};
+    auto d = Prediction::extrapolate(samples, 20);
+    EXPECT_DOUBLE_EQ(d.dx, Prediction::MAX_PREDICTION_DISTANCE);
+    EXPECT_DOUBLE_EQ(d.dy, 0);
+}
@@ -0,0 +1,87 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <cmath>
+#include <deque>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "control/tools/StrokeStabilizer.h"
+
+using StrokeStabilizer::ArithmeticMean;
+using StrokeStabilizer::Event;
+using StrokeStabilizer::VelocityGaussian;
+
+TEST(StrokeStabilizer, testArithmeticMean) {
+    ArithmeticMean mean(4);
+    mean.assign(Event(1, 2, 0.5));
+    EXPECT_DOUBLE_EQ(mean.oldest().x, 1);
+
+    std::deque<Event> last(4, Event(1, 2, 0.5));
+    for (int i = 0; i < 50; i++) {
+        Event ev(0.1 * i * i, 3.0 - i, 0.01 * i);
+        last.push_front(ev);
+        last.pop_back();
+
+        Event average = mean.push(ev);
+        double x = 0;
+        double y = 0;
+        double pressure = 0;
+        for (const Event& e: last) {
+            x += e.x;
+            y += e.y;
+            pressure += e.pressure;
+        }
+        EXPECT_NEAR(average.x, x / 4, 1e-9);
+        EXPECT_NEAR(average.y, y / 4, 1e-9);
+        EXPECT_NEAR(average.pressure, pressure / 4, 1e-9);
+        EXPECT_DOUBLE_EQ(mean.newest().x, ev.x);
+        EXPECT_DOUBLE_EQ(mean.oldest().x, last.back().x);
+    }
+}
+
+TEST(StrokeStabilizer, testVelocityGaussianAverage) {
+    const double twoSigmaSquared = 2 * 0.5 * 0.5;
+    std::deque<VelocityGaussian::VelocityEvent> events;
+    for (int i = 0; i < 20; i++) { events.emplace_back(i, 2 * i, 0.5, 0.1 * (i + 1)); }
+
+    std::vector<double> weights;
+    auto [average, kept] = VelocityGaussian::average(events, twoSigmaSquared, weights);
+
+    // The direct formula, which stops at the first weight under MIN_WEIGHT
+    double x = 0;
+    double sumOfWeights = 0;
+    double sumOfVelocities = 0;
+    size_t expectedKept = 0;
+    for (const auto& e: events) {
+        double weight = std::exp(-sumOfVelocities * sumOfVelocities / twoSigmaSquared);
+        if (weight < VelocityGaussian::MIN_WEIGHT) {
+            break;
+        }
+        sumOfVelocities += e.velocity;
+        x += weight * e.x;
+        sumOfWeights += weight;
+        expectedKept++;
+    }
+
+    EXPECT_EQ(kept, expectedKept);
+    EXPECT_LT(kept, events.size());
+    EXPECT_NEAR(average.x, x / sumOfWeights, 1e-12);
+    EXPECT_NEAR(average.y, 2 * x / sumOfWeights, 1e-12);
+    EXPECT_DOUBLE_EQ(average.pressure, 0.5);
+
+    // A single event is its own average
+    events.resize(1);
+    std::tie(average, kept) = VelocityGaussian::average(events, twoSigmaSquared, weights);
+    EXPECT_EQ(kept, 1);
+    EXPECT_DOUBLE_EQ(average.x, 0);
+}
@@ -0,0 +1,81 @@
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "gui/inputdevices/InputMetrics.h"
+
+static auto makeEvent(InputEventType type, InputDeviceClass deviceClass, guint32 timestamp) -> InputEvent {
+    InputEvent event{};
+    event.type = type;
+    event.deviceClass = deviceClass;
+    event.timestamp = timestamp;
+    return event;
+}
+
+TEST(InputMetrics, testRateAndJitter) {
+    InputMetrics metrics;
+    // 200 Hz, alternating 4.5 and 5.5 ms
+    int64_t us = 1000000;
+    for (int i = 0; i < 101; i++) {
+        metrics.record(makeEvent(MOTION_EVENT, INPUT_DEVICE_PEN, static_cast<guint32>(us / 1000)), us);
+        us += i % 2 ? 5500 : 4500;
+    }
+
+    const auto& stats = metrics.get(InputMetrics::PEN);
+    EXPECT_EQ(stats.events, 101U);
+    EXPECT_EQ(stats.intervals.count, 100U);
+    EXPECT_NEAR(stats.getRate(), 200.0, 1e-6);
+    EXPECT_NEAR(stats.getJitterMs(), 0.5, 0.01);
+    EXPECT_EQ(metrics.get(InputMetrics::TOUCH).events, 0U);
+    EXPECT_EQ(metrics.getSummary().size(), 1U);
+}
+
+TEST(InputMetrics, testPausesAreNotCounted) {
+    InputMetrics metrics;
+    metrics.record(makeEvent(MOTION_EVENT, INPUT_DEVICE_MOUSE, 1000), 1000000);
+    metrics.record(makeEvent(MOTION_EVENT, INPUT_DEVICE_MOUSE, 1010), 1010000);
+    metrics.record(makeEvent(MOTION_EVENT, INPUT_DEVICE_MOUSE, 3000), 3000000);
+    metrics.record(makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_MOUSE, 3005), 3005000);
+
+    const auto& stats = metrics.get(InputMetrics::MOUSE);
+    EXPECT_EQ(stats.events, 4U);
+    EXPECT_EQ(stats.intervals.count, 1U);
+    EXPECT_EQ(stats.intervals.maxUs, 10000);
+}
+
+TEST(InputMetrics, testDelay) {
+    InputMetrics metrics;
+    for (int i = 0; i < 20; i++) {
+        metrics.record(makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_TOUCHSCREEN, 1000),
+                       (1000 + (i == 19 ? 30 : 2)) * 1000);
+    }
+    // Another clock
+    metrics.record(makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_TOUCHSCREEN, 900000), 1000000);
+
+    const auto& delays = metrics.get(InputMetrics::TOUCH).delays;
+    EXPECT_EQ(delays.count, 20U);
+    EXPECT_EQ(delays.maxUs, 30000);
+    EXPECT_EQ(delays.getPercentileUs(0.5), 2048);
+    EXPECT_EQ(delays.getPercentileUs(1), 30000);
+}
+
+TEST(InputMetrics, testHistogramBuckets) {
+    InputMetrics::Histogram histogram;
+    histogram.add(0);
+    histogram.add(3);
+    histogram.add(1000000000);
+    EXPECT_EQ(histogram.buckets[0], 1U);
+    EXPECT_EQ(histogram.buckets[1], 1U);
+    EXPECT_EQ(histogram.buckets[InputMetrics::BUCKET_COUNT - 1], 1U);
+}
+
+TEST(InputMetrics, testKeyboardIsIgnored) {
+    InputMetrics metrics;
+    metrics.record(makeEvent(KEY_PRESS_EVENT, INPUT_DEVICE_KEYBOARD, 1000), 1000000);
+    metrics.record(makeEvent(KEY_PRESS_EVENT, INPUT_DEVICE_MOUSE_KEYBOARD_COMBO, 1000), 1000000);
+    EXPECT_TRUE(metrics.getSummary().empty());
+
+    std::ostringstream csv;
+    metrics.writeCsv(csv);
+    EXPECT_NE(csv.str().find("pen,events,0"), std::string::npos);
+}
@@ -0,0 +1,87 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "gui/scroll/KineticScroller.h"
+
+/// 60 frames per second, in microseconds
+constexpr gint64 FRAME = 16667;
+
+TEST(KineticScroller, testDeltasAreMergedInTheFrame) {
+    KineticScroller scroller;
+    EXPECT_FALSE(scroller.isActive());
+
+    scroller.addDelta(3, 1, 1000000);
+    scroller.addDelta(4, -2, 1004000);
+    EXPECT_TRUE(scroller.isActive());
+
+    auto delta = scroller.frame(1010000);
+    EXPECT_DOUBLE_EQ(delta.x, 7);
+    EXPECT_DOUBLE_EQ(delta.y, -1);
+    EXPECT_FALSE(scroller.isActive());
+}
+
+TEST(KineticScroller, testNoFlingAfterTheFingerRested) {
+    KineticScroller scroller;
+    for (gint64 t = 1000000; t < 1100000; t += 10000) { scroller.addDelta(0, 10, t); }
+    scroller.frame(1100000);
+
+    scroller.release(1500000);
+    EXPECT_FALSE(scroller.isActive());
+}
+
+TEST(KineticScroller, testFlingSlowsDownAndStops) {
+    KineticScroller scroller;
+    gint64 t = 1000000;
+    for (; t < 1100000; t += 10000) { scroller.addDelta(0, 10, t); }
+    scroller.frame(t);
+    scroller.release(t);
+    EXPECT_TRUE(scroller.isActive());
+    EXPECT_GT(scroller.getVelocity().y, 900);
+
+    double previous = HUGE_VAL;
+    int frames = 0;
+    while (scroller.isActive() && frames < 1000) {
+        t += FRAME;
+        double dy = scroller.frame(t).y;
+        EXPECT_GT(dy, 0);
+        EXPECT_LE(dy, previous);
+        previous = dy;
+        frames++;
+    }
+    EXPECT_FALSE(scroller.isActive());
+    EXPECT_LT(frames, 1000);
+}
+
+TEST(KineticScroller, testDistanceDoesNotDependOnTheFrameRate) {
+    auto distance = [](gint64 frame) {
+        KineticScroller scroller;
+        gint64 t = 1000000;
+        for (; t < 1100000; t += 10000) { scroller.addDelta(20, 0, t); }
+        scroller.frame(t);
+        scroller.release(t);
+
+        double total = 0;
+        // Over 36 frames at 60 frames per second
+        for (gint64 end = t + 36 * FRAME; t < end;) {
+            t += frame;
+            total += scroller.frame(t).x;
+        }
+        return total;
+    };
+
+    double at60 = distance(FRAME * 3);
+    double at20 = distance(FRAME * 9);
+    EXPECT_NEAR(at60, at20, 1e-6 * at60);
+}
+
+TEST(KineticScroller, testStop) {
+    KineticScroller scroller;
+    gint64 t = 1000000;
+    for (; t < 1100000; t += 10000) { scroller.addDelta(0, -10, t); }
+    scroller.frame(t);
+    scroller.release(t);
+    scroller.stop();
+    EXPECT_FALSE(scroller.isActive());
+    EXPECT_DOUBLE_EQ(scroller.frame(t + FRAME).y, 0);
+}
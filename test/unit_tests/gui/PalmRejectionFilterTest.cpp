@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include "gui/inputdevices/PalmRejectionFilter.h"
+
+static auto makeEvent(InputEventType type, InputDeviceClass deviceClass, guint32 timestamp, uintptr_t sequence = 0)
+        -> InputEvent {
+    InputEvent event{};
+    event.type = type;
+    event.deviceClass = deviceClass;
+    event.timestamp = timestamp;
+    event.sequence = reinterpret_cast<GdkEventSequence*>(sequence);
+    return event;
+}
+
+TEST(PalmRejectionFilter, testDisabledAcceptsAll) {
+    PalmRejectionFilter filter;
+    EXPECT_TRUE(filter.accept(makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_PEN, 1000)));
+    EXPECT_TRUE(filter.accept(makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_TOUCHSCREEN, 1010, 1)));
+    EXPECT_EQ(filter.getDroppedEvents(), 0U);
+}
+
+TEST(PalmRejectionFilter, testTouchWhileWritingIsDroppedToItsEnd) {
+    PalmRejectionFilter filter;
+    filter.configure(true, 500, 0);
+
+    EXPECT_TRUE(filter.accept(makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_PEN, 1000)));
+    EXPECT_FALSE(filter.accept(makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_TOUCHSCREEN, 1010, 1)));
+    EXPECT_TRUE(filter.accept(makeEvent(BUTTON_RELEASE_EVENT, INPUT_DEVICE_PEN, 2000)));
+
+    // Still the palm, long after the pen was lifted
+    EXPECT_FALSE(filter.accept(makeEvent(MOTION_EVENT, INPUT_DEVICE_TOUCHSCREEN, 5000, 1)));
+    EXPECT_FALSE(filter.accept(makeEvent(BUTTON_RELEASE_EVENT, INPUT_DEVICE_TOUCHSCREEN, 5010, 1)));
+    EXPECT_EQ(filter.getRejectedSequences(), 1U);
+    EXPECT_EQ(filter.getDroppedEvents(), 3U);
+
+    // A new touch, once the pen is gone
+    EXPECT_TRUE(filter.accept(makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_TOUCHSCREEN, 6000, 1)));
+    EXPECT_TRUE(filter.accept(makeEvent(MOTION_EVENT, INPUT_DEVICE_TOUCHSCREEN, 6010, 1)));
+}
+
+TEST(PalmRejectionFilter, testTouchShortlyAfterThePen) {
+    PalmRejectionFilter filter;
+    filter.configure(true, 500, 0);
+
+    // The hovering pen
+    EXPECT_TRUE(filter.accept(makeEvent(MOTION_EVENT, INPUT_DEVICE_PEN, 1000)));
+    EXPECT_FALSE(filter.accept(makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_TOUCHSCREEN, 1400, 1)));
+    EXPECT_TRUE(filter.accept(makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_TOUCHSCREEN, 1600, 2)));
+
+    // The touches started before the pen are not interrupted
+    EXPECT_TRUE(filter.accept(makeEvent(MOTION_EVENT, INPUT_DEVICE_PEN, 1700)));
+    EXPECT_TRUE(filter.accept(makeEvent(MOTION_EVENT, INPUT_DEVICE_TOUCHSCREEN, 1710, 2)));
+}
+
+TEST(PalmRejectionFilter, testLargeContact) {
+    PalmRejectionFilter filter;
+    filter.configure(true, 500, 0.5);
+
+    auto finger = makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_TOUCHSCREEN, 1000, 1);
+    finger.contactSize = 0.2;
+    EXPECT_TRUE(filter.accept(finger));
+
+    auto palm = makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_TOUCHSCREEN, 1000, 2);
+    palm.contactSize = 0.9;
+    EXPECT_FALSE(filter.accept(palm));
+
+    // No contact size reported
+    EXPECT_TRUE(filter.accept(makeEvent(BUTTON_PRESS_EVENT, INPUT_DEVICE_TOUCHSCREEN, 1000, 3)));
+}
@@ -0,0 +1,48 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gui/sidebar/previews/base/SidebarLayout.h"
+
+TEST(SidebarLayout, testRowsAreFilledUpToTheWidth) {
+    // Two previews fit side by side in a row, the third one starts the next row
+    std::vector<std::pair<int, int>> sizes{{40, 60}, {40, 50}, {40, 60}};
+    auto placement = SidebarLayout::place(sizes, 100);
+    ASSERT_EQ(placement.slots.size(), 3);
+
+    EXPECT_EQ(placement.slots[0].x, 0);
+    EXPECT_EQ(placement.slots[1].x, 40);
+    EXPECT_EQ(placement.slots[2].x, 0);
+
+    // Centered vertically in the row
+    EXPECT_EQ(placement.slots[0].y, 0);
+    EXPECT_EQ(placement.slots[1].y, 5);
+    EXPECT_EQ(placement.slots[1].rowHeight, 60);
+    EXPECT_EQ(placement.slots[2].y, 60);
+    EXPECT_EQ(placement.slots[2].rowY, 60);
+
+    EXPECT_EQ(placement.width, 80);
+    EXPECT_EQ(placement.height, 120);
+}
+
+TEST(SidebarLayout, testWidePreviewGetsItsOwnRow) {
+    std::vector<std::pair<int, int>> sizes{{300, 10}, {300, 20}};
+    auto placement = SidebarLayout::place(sizes, 100);
+    EXPECT_EQ(placement.slots[1].y, 10);
+    EXPECT_EQ(placement.width, 300);
+    EXPECT_EQ(placement.height, 30);
+
+    EXPECT_TRUE(SidebarLayout::place({}, 100).slots.empty());
+}
@@ -0,0 +1,150 @@
+#include <memory>
+
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "gui/sidebar/previews/base/ThumbnailCache.h"
+#include "model/XojPage.h"
+
+static auto makeSurface(int size) -> cairo_surface_t* {
+    return cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size, size);
+}
+
+TEST(ThumbnailCache, testPutAndGet) {
+    ThumbnailCache cache;
+    PageRef page = std::make_shared<XojPage>(100, 100);
+    auto key = ThumbnailCache::makeKey(page, RENDER_TYPE_PAGE_PREVIEW, 0, 10, 10);
+
+    EXPECT_EQ(cache.get(key), nullptr);
+
+    cairo_surface_t* surface = makeSurface(10);
+    cache.put(key, cache.getRevision(page), surface);
+    cairo_surface_t* cached = cache.get(key);
+    EXPECT_EQ(cached, surface);
+    EXPECT_GT(cache.getBytes(), 0U);
+    cairo_surface_destroy(cached);
+
+    // Another size or layer is another preview
+    EXPECT_EQ(cache.get(ThumbnailCache::makeKey(page, RENDER_TYPE_PAGE_PREVIEW, 0, 20, 20)), nullptr);
+    EXPECT_EQ(cache.get(ThumbnailCache::makeKey(page, RENDER_TYPE_PAGE_LAYER, 1, 10, 10)), nullptr);
+
+    cairo_surface_destroy(surface);
+}
+
+TEST(ThumbnailCache, testLayerPreviewsDoNotDependOnTheVisibility) {
+    PageRef page = std::make_shared<XojPage>(100, 100);
+    auto layerKey = ThumbnailCache::makeKey(page, RENDER_TYPE_PAGE_LAYER, 0, 10, 10);
+    auto stackKey = ThumbnailCache::makeKey(page, RENDER_TYPE_PAGE_LAYERSTACK, 0, 10, 10);
+    auto pageKey = ThumbnailCache::makeKey(page, RENDER_TYPE_PAGE_PREVIEW, 0, 10, 10);
+
+    page->setLayerVisible(0, false);
+    auto hiddenLayerKey = ThumbnailCache::makeKey(page, RENDER_TYPE_PAGE_LAYER, 0, 10, 10);
+    auto hiddenStackKey = ThumbnailCache::makeKey(page, RENDER_TYPE_PAGE_LAYERSTACK, 0, 10, 10);
+    auto hiddenPageKey = ThumbnailCache::makeKey(page, RENDER_TYPE_PAGE_PREVIEW, 0, 10, 10);
+
+    EXPECT_FALSE(layerKey < hiddenLayerKey || hiddenLayerKey < layerKey);
+    EXPECT_FALSE(stackKey < hiddenStackKey || hiddenStackKey < stackKey);
+    EXPECT_TRUE(pageKey < hiddenPageKey || hiddenPageKey < pageKey);
+}
+
+TEST(ThumbnailCache, testOutdatedPreviewIsNotStored) {
+    ThumbnailCache cache;
+    PageRef page = std::make_shared<XojPage>(100, 100);
+    auto key = ThumbnailCache::makeKey(page, RENDER_TYPE_PAGE_PREVIEW, 0, 10, 10);
+
+    auto revision = cache.getRevision(page);
+    page->firePageChanged();
+
+    cairo_surface_t* surface = makeSurface(10);
+    cache.put(key, revision, surface);
+    EXPECT_EQ(cache.get(key), nullptr);
+    EXPECT_EQ(cache.getBytes(), 0U);
+    cairo_surface_destroy(surface);
+}
+
+TEST(ThumbnailCache, testChangedPageIsDropped) {
+    ThumbnailCache cache;
+    PageRef page = std::make_shared<XojPage>(100, 100);
+    auto key = ThumbnailCache::makeKey(page, RENDER_TYPE_PAGE_PREVIEW, 0, 10, 10);
+
+    cairo_surface_t* surface = makeSurface(10);
+    cache.put(key, cache.getRevision(page), surface);
+    page->setBackgroundColor(Color(0x000000U));
+    EXPECT_EQ(cache.get(key), nullptr);
+    EXPECT_EQ(cache.getBytes(), 0U);
+    cairo_surface_destroy(surface);
+}
+
+TEST(ThumbnailCache, testInvalidateDropsOnlyThePage) {
+    ThumbnailCache cache;
+    PageRef page1 = std::make_shared<XojPage>(100, 100);
+    PageRef page2 = std::make_shared<XojPage>(100, 100);
+    auto key1 = ThumbnailCache::makeKey(page1, RENDER_TYPE_PAGE_PREVIEW, 0, 10, 10);
+    auto key2 = ThumbnailCache::makeKey(page2, RENDER_TYPE_PAGE_PREVIEW, 0, 10, 10);
+
+    cairo_surface_t* surface = makeSurface(10);
+    cache.put(key1, cache.getRevision(page1), surface);
+    cache.put(key2, cache.getRevision(page2), surface);
+
+    cache.invalidate(page1);
+    EXPECT_EQ(cache.get(key1), nullptr);
+    cairo_surface_t* cached = cache.get(key2);
+    EXPECT_EQ(cached, surface);
+    cairo_surface_destroy(cached);
+
+    cache.clear();
+    EXPECT_EQ(cache.get(key2), nullptr);
+    EXPECT_EQ(cache.getBytes(), 0U);
+    cairo_surface_destroy(surface);
+}
+
+TEST(ThumbnailCache, testRemoveOutdatedKeepsTheUnchangedPages) {
+    ThumbnailCache cache;
+    PageRef page1 = std::make_shared<XojPage>(100, 100);
+    PageRef page2 = std::make_shared<XojPage>(100, 100);
+    auto key1 = ThumbnailCache::makeKey(page1, RENDER_TYPE_PAGE_PREVIEW, 0, 10, 10);
+    auto key2 = ThumbnailCache::makeKey(page2, RENDER_TYPE_PAGE_PREVIEW, 0, 10, 10);
+
+    cairo_surface_t* surface = makeSurface(10);
+    cache.put(key1, cache.getRevision(page1), surface);
+    cache.put(key2, cache.getRevision(page2), surface);
+    size_t bytes = cache.getBytes();
+
+    page1->setBackgroundColor(Color(0x000000U));
+    cache.removeOutdated();
+    EXPECT_EQ(cache.getBytes(), bytes / 2);
+    cairo_surface_t* cached = cache.get(key2);
+    EXPECT_EQ(cached, surface);
+    cairo_surface_destroy(cached);
+
+    cairo_surface_destroy(surface);
+}
+
+TEST(ThumbnailCache, testLeastRecentlyUsedIsEvicted) {
+    // Room for two 10x10 ARGB previews
+    ThumbnailCache cache(2 * 10 * 10 * 4);
+    PageRef page1 = std::make_shared<XojPage>(100, 100);
+    PageRef page2 = std::make_shared<XojPage>(100, 100);
+    PageRef page3 = std::make_shared<XojPage>(100, 100);
+    auto key1 = ThumbnailCache::makeKey(page1, RENDER_TYPE_PAGE_PREVIEW, 0, 10, 10);
+    auto key2 = ThumbnailCache::makeKey(page2, RENDER_TYPE_PAGE_PREVIEW, 0, 10, 10);
+    auto key3 = ThumbnailCache::makeKey(page3, RENDER_TYPE_PAGE_PREVIEW, 0, 10, 10);
+
+    cairo_surface_t* surface = makeSurface(10);
+    cache.put(key1, cache.getRevision(page1), surface);
+    cache.put(key2, cache.getRevision(page2), surface);
+
+    // page1 becomes the most recently used
+    cairo_surface_destroy(cache.get(key1));
+    cache.put(key3, cache.getRevision(page3), surface);
+
+    EXPECT_EQ(cache.get(key2), nullptr);
+    cairo_surface_t* cached = cache.get(key1);
+    EXPECT_NE(cached, nullptr);
+    cairo_surface_destroy(cached);
+    cached = cache.get(key3);
+    EXPECT_NE(cached, nullptr);
+    cairo_surface_destroy(cached);
+
+    cairo_surface_destroy(surface);
+}
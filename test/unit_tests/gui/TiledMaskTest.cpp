@@ -0,0 +1,57 @@
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "gui/TiledMask.h"
+#include "util/Rectangle.h"
+
+using xoj::util::Rectangle;
+
+TEST(TiledMask, testTilesAllocatedOnUse) {
+    // At scale 2, a tile covers 128x128 page units
+    TiledMask mask(2.0);
+    EXPECT_EQ(mask.getTileCount(), 0U);
+
+    int calls = 0;
+    mask.draw(Rectangle<double>(10, 10, 5, 5), [&](cairo_t*) { calls++; });
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(mask.getTileCount(), 1U);
+
+    // The mask goes beyond the origin
+    calls = 0;
+    mask.draw(Rectangle<double>(-10, 100, 20, 50), [&](cairo_t*) { calls++; });
+    EXPECT_EQ(calls, 4);
+    EXPECT_EQ(mask.getTileCount(), 4U);
+
+    mask.draw(Rectangle<double>(20, 20, 0, 0), [](cairo_t*) {});
+    EXPECT_EQ(mask.getTileCount(), 4U);
+}
+
+TEST(TiledMask, testPaint) {
+    const double scale = 2.0;
+    TiledMask mask(scale);
+    // Across the border of two tiles
+    mask.draw(Rectangle<double>(120, 10, 20, 10), [](cairo_t* cr) {
+        cairo_rectangle(cr, 120, 10, 20, 10);
+        cairo_fill(cr);
+    });
+
+    cairo_surface_t* target = cairo_image_surface_create(CAIRO_FORMAT_A8, 512, 64);
+    cairo_t* cr = cairo_create(target);
+    cairo_scale(cr, scale, scale);
+    cairo_set_source_rgba(cr, 0, 0, 0, 1);
+    mask.paint(cr);
+    cairo_destroy(cr);
+    cairo_surface_flush(target);
+
+    const unsigned char* data = cairo_image_surface_get_data(target);
+    const int stride = cairo_image_surface_get_stride(target);
+    auto alphaAt = [&](double x, double y) {
+        return data[static_cast<int>(y * scale) * stride + static_cast<int>(x * scale)];
+    };
+    EXPECT_EQ(alphaAt(125, 15), 255);
+    EXPECT_EQ(alphaAt(135, 15), 255);
+    EXPECT_EQ(alphaAt(115, 15), 0);
+    EXPECT_EQ(alphaAt(125, 25), 0);
+
+    cairo_surface_destroy(target);
+}
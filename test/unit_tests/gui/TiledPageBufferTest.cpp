@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <vector>
+
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "gui/TiledPageBuffer.h"
+#include "util/Rectangle.h"
+
+using xoj::util::Rectangle;
+
+static cairo_surface_t* makeTile() {
+    return cairo_image_surface_create(CAIRO_FORMAT_ARGB32, TiledPageBuffer::TILE_SIZE, TiledPageBuffer::TILE_SIZE);
+}
+
+TEST(TiledPageBuffer, testTilesInArea) {
+    // At scale 2, a tile covers 128x128 page units
+    auto keys = TiledPageBuffer::tilesInArea(2.0, Rectangle<double>(100, 0, 100, 10));
+    ASSERT_EQ(keys.size(), 2U);
+    EXPECT_EQ(keys[0], (TiledPageBuffer::TileKey{2.0, 0, 0}));
+    EXPECT_EQ(keys[1], (TiledPageBuffer::TileKey{2.0, 1, 0}));
+
+    EXPECT_EQ(TiledPageBuffer::tilesInArea(1.0, Rectangle<double>(0, 0, 512, 512)).size(), 4U);
+    EXPECT_TRUE(TiledPageBuffer::tilesInArea(1.0, Rectangle<double>(0, 0, 0, 100)).empty());
+}
+
+TEST(TiledPageBuffer, testDropOtherScalesAndLeastRecentlyUsed) {
+    TiledPageBuffer buffer;
+    buffer.putTile({1.0, 0, 0}, makeTile());
+    buffer.putTile({1.0, 1, 0}, makeTile());
+    buffer.putTile({2.0, 0, 0}, makeTile());
+    EXPECT_EQ(buffer.getPixelCount(), 3U * TiledPageBuffer::TILE_SIZE * TiledPageBuffer::TILE_SIZE);
+
+    buffer.dropOtherScales(1.0);
+    EXPECT_EQ(buffer.getTileKeys(1.0).size(), 2U);
+    EXPECT_EQ(buffer.getTile({2.0, 0, 0}), nullptr);
+
+    // Rendering the tile again makes it the most recently used one
+    buffer.putTile({1.0, 0, 0}, makeTile());
+    auto uses = buffer.getTileUses();
+    ASSERT_EQ(uses.size(), 2U);
+    buffer.dropTilesUsedBefore(std::max(uses[0], uses[1]));
+    EXPECT_NE(buffer.getTile({1.0, 0, 0}), nullptr);
+    EXPECT_EQ(buffer.getTile({1.0, 1, 0}), nullptr);
+
+    buffer.clear();
+    EXPECT_TRUE(buffer.isEmpty());
+}
+
+TEST(TiledPageBuffer, testPreviewScaleIsStableDuringGesture) {
+    EXPECT_DOUBLE_EQ(TiledPageBuffer::getPreviewScale(8.0), 2.0);
+    EXPECT_DOUBLE_EQ(TiledPageBuffer::getPreviewScale(6.0), 1.0);
+    EXPECT_DOUBLE_EQ(TiledPageBuffer::getPreviewScale(7.9), 1.0);
+}
+
+TEST(TiledPageBuffer, testBackgroundsAreKeptWithTheTiles) {
+    TiledPageBuffer buffer;
+    cairo_surface_t* background = makeTile();
+    buffer.putTile({1.0, 0, 0}, makeTile(), background);
+    buffer.putTile({1.0, 1, 0}, makeTile());
+    EXPECT_EQ(buffer.getPixelCount(), 3U * TiledPageBuffer::TILE_SIZE * TiledPageBuffer::TILE_SIZE);
+
+    EXPECT_TRUE(buffer.hasBackgrounds(1.0, Rectangle<double>(0, 0, 100, 100)));
+    EXPECT_FALSE(buffer.hasBackgrounds(1.0, Rectangle<double>(200, 0, 100, 100)));
+
+    std::vector<cairo_surface_t*> backgrounds;
+    buffer.forEachBackground(1.0, Rectangle<double>(0, 0, 512, 100),
+                             [&](const TiledPageBuffer::TileKey&, cairo_surface_t* bg) { backgrounds.push_back(bg); });
+    ASSERT_EQ(backgrounds.size(), 1U);
+    EXPECT_EQ(backgrounds[0], background);
+
+    // Rendered again without background
+    buffer.putTile({1.0, 0, 0}, makeTile());
+    EXPECT_FALSE(buffer.hasBackgrounds(1.0, Rectangle<double>(0, 0, 100, 100)));
+    EXPECT_EQ(buffer.getPixelCount(), 2U * TiledPageBuffer::TILE_SIZE * TiledPageBuffer::TILE_SIZE);
+}
+
+TEST(TiledPageBuffer, testDraftsAreRequestedOnceRefined) {
+    TiledPageBuffer buffer;
+    buffer.putTile({1.0, 0, 0}, makeTile(), nullptr, true);
+    buffer.putTile({1.0, 1, 0}, makeTile());
+
+    cairo_surface_t* target = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 512, 256);
+    cairo_t* cr = cairo_create(target);
+    const Rectangle<double> area(0, 0, 512, 256);
+
+    // Shown as they are during the interaction
+    EXPECT_TRUE(buffer.paint(cr, 1.0, 1.0, area, 512, 256, false).empty());
+    EXPECT_EQ(buffer.paint(cr, 1.0, 1.0, area, 512, 256), (std::vector<TiledPageBuffer::TileKey>{{1.0, 0, 0}}));
+
+    buffer.putTile({1.0, 0, 0}, makeTile());
+    EXPECT_TRUE(buffer.paint(cr, 1.0, 1.0, area, 512, 256).empty());
+
+    // A draft of an edit drawn into the tiles
+    buffer.markDrafts(1.0, Rectangle<double>(300, 0, 10, 10));
+    EXPECT_EQ(buffer.paint(cr, 1.0, 1.0, area, 512, 256), (std::vector<TiledPageBuffer::TileKey>{{1.0, 1, 0}}));
+    EXPECT_TRUE(buffer.getMissingTiles(1.0, area).empty());
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(target);
+}
+
+TEST(TiledPageBuffer, testSharedCopyKeepsTheReplacedTiles) {
+    TiledPageBuffer buffer;
+    cairo_surface_t* tile = makeTile();
+    buffer.putTile({1.0, 0, 0}, tile);
+
+    auto copy = buffer.share();
+    EXPECT_EQ(copy->getTile({1.0, 0, 0}), tile);
+    EXPECT_EQ(cairo_surface_get_reference_count(tile), 2U);
+
+    // Rendered again in the buffer only
+    cairo_surface_t* other = makeTile();
+    buffer.putTile({1.0, 0, 0}, other);
+    EXPECT_EQ(copy->getTile({1.0, 0, 0}), tile);
+    EXPECT_EQ(cairo_surface_get_reference_count(tile), 1U);
+
+    buffer.swap(*copy);
+    EXPECT_EQ(buffer.getTile({1.0, 0, 0}), tile);
+    EXPECT_EQ(copy->getTile({1.0, 0, 0}), other);
+
+    copy.reset();
+    EXPECT_EQ(buffer.getTile({1.0, 0, 0}), tile);
+}
+
+TEST(TiledPageBuffer, testSharedTilesAreCopiedWhenDrawnInto) {
+    TiledPageBuffer buffer;
+    cairo_surface_t* tile = makeTile();
+    buffer.putTile({1.0, 0, 0}, tile);
+    auto copy = buffer.share();
+
+    cairo_surface_t* drawn = nullptr;
+    buffer.forEachTile(1.0, Rectangle<double>(0, 0, 100, 100),
+                       [&drawn](const TiledPageBuffer::TileKey&, cairo_surface_t* surface) { drawn = surface; });
+    EXPECT_NE(drawn, tile);
+    EXPECT_EQ(buffer.getTile({1.0, 0, 0}), drawn);
+    EXPECT_EQ(copy->getTile({1.0, 0, 0}), tile);
+    EXPECT_EQ(cairo_surface_get_reference_count(tile), 1U);
+
+    // No longer shared: drawn in place
+    copy->forEachTile(1.0, Rectangle<double>(0, 0, 100, 100),
+                      [&drawn](const TiledPageBuffer::TileKey&, cairo_surface_t* surface) { drawn = surface; });
+    EXPECT_EQ(drawn, tile);
+}
+
+TEST(TiledPageBuffer, testDeviceCopiesAreDroppedWhenDrawnInto) {
+    const size_t tilePixels = size_t{TiledPageBuffer::TILE_SIZE} * TiledPageBuffer::TILE_SIZE;
+    TiledPageBuffer buffer;
+    buffer.putTile({1.0, 0, 0}, makeTile());
+
+    // Any surface which is not an image stands for the display
+    cairo_surface_t* target = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+    cairo_t* cr = cairo_create(target);
+
+    buffer.paint(cr, 1.0, 1.0, Rectangle<double>(0, 0, 100, 100), 100, 100);
+    EXPECT_EQ(buffer.getPixelCount(), tilePixels);
+
+    buffer.setDeviceCopies(true);
+    buffer.paint(cr, 1.0, 1.0, Rectangle<double>(0, 0, 100, 100), 100, 100);
+    EXPECT_EQ(buffer.getPixelCount(), 2 * tilePixels);
+
+    buffer.forEachTile(1.0, Rectangle<double>(0, 0, 100, 100),
+                       [](const TiledPageBuffer::TileKey&, cairo_surface_t*) {});
+    EXPECT_EQ(buffer.getPixelCount(), tilePixels);
+
+    buffer.paint(cr, 1.0, 1.0, Rectangle<double>(0, 0, 100, 100), 100, 100);
+    buffer.setDeviceCopies(false);
+    EXPECT_EQ(buffer.getPixelCount(), tilePixels);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(target);
+}
@@ -0,0 +1,84 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/Stroke.h"
+
+static Stroke makeStroke(bool pressure) {
+    Stroke s;
+    s.setWidth(1.4);
+    for (int i = 0; i < 100; i++) {
+        s.addPoint(Point(100.25 + i * 0.5, 700.125 - i * 0.25, pressure ? 0.5 + i * 0.01 : Point::NO_PRESSURE));
+    }
+    return s;
+}
+
+TEST(CompactPoints, testPackUnpack) {
+    for (bool pressure: {false, true}) {
+        Stroke s = makeStroke(pressure);
+        std::vector<Point> expected = s.getPointVector();
+
+        s.compact();
+        EXPECT_TRUE(s.isCompact());
+
+        // A clone stays packed
+        std::unique_ptr<Stroke> clone(s.cloneStroke());
+        EXPECT_TRUE(clone->isCompact());
+
+        // Any access unpacks the points, rounded to float precision
+        ASSERT_EQ(s.getPointCount(), static_cast<int>(expected.size()));
+        EXPECT_FALSE(s.isCompact());
+        EXPECT_EQ(s.hasPressure(), pressure);
+        const std::vector<Point>& points = s.getPointVector();
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_NEAR(points[i].x, expected[i].x, 1e-4);
+            EXPECT_NEAR(points[i].y, expected[i].y, 1e-4);
+            EXPECT_NEAR(points[i].z, expected[i].z, 1e-4);
+        }
+        EXPECT_EQ(clone->getPointVector().size(), expected.size());
+
+        // Packing again does not change the points any further
+        std::vector<Point> unpacked = s.getPointVector();
+        s.compact();
+        const std::vector<Point>& repacked = s.getPointVector();
+        for (size_t i = 0; i < unpacked.size(); i++) {
+            EXPECT_EQ(repacked[i].x, unpacked[i].x);
+            EXPECT_EQ(repacked[i].z, unpacked[i].z);
+        }
+    }
+}
+
+TEST(CompactPoints, testConcurrentUnpack) {
+    Stroke s = makeStroke(true);
+    s.compact();
+
+    std::vector<std::thread> threads;
+    std::vector<int> counts(4);
+    for (size_t i = 0; i < counts.size(); i++) {
+        threads.emplace_back([&s, &counts, i]() { counts[i] = s.getPointCount(); });
+    }
+    for (auto& t: threads) {
+        t.join();
+    }
+    EXPECT_EQ(counts, std::vector<int>(4, 100));
+}
+
+TEST(CompactPoints, testClonesShareThePoints) {
+    Stroke s = makeStroke(true);
+    std::unique_ptr<Stroke> clone(s.cloneStroke());
+    EXPECT_EQ(clone->getPointVector().data(), s.getPointVector().data());
+
+    // Modifying the clone copies its points first
+    clone->move(10, 0);
+    EXPECT_NE(clone->getPointVector().data(), s.getPointVector().data());
+    EXPECT_DOUBLE_EQ(clone->getPoint(0).x, s.getPoint(0).x + 10);
+
+    // The packed clones unpack the shared points separately
+    s.compact();
+    std::unique_ptr<Stroke> packed(s.cloneStroke());
+    EXPECT_EQ(s.getPointCount(), 100);
+    EXPECT_TRUE(packed->isCompact());
+    EXPECT_EQ(packed->getPointCount(), 100);
+    EXPECT_DOUBLE_EQ(packed->getPoint(99).x, s.getPoint(99).x);
+}
@@ -0,0 +1,134 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/Layer.h"
+#include "model/PageSnapshot.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+#include "util/Rectangle.h"
+
+TEST(DocumentLock, testSharedLocksDoNotExcludeEachOther) {
+    DocumentHandler handler;
+    Document doc(&handler);
+
+    doc.lockShared();
+    std::thread reader([&doc]() {
+        doc.lockShared();
+        doc.unlockShared();
+    });
+    reader.join();
+
+    // The exclusive lock waits for the readers
+    std::thread([&doc]() { EXPECT_FALSE(doc.tryLock()); }).join();
+    doc.unlockShared();
+    EXPECT_TRUE(doc.tryLock());
+    doc.unlock();
+}
+
+TEST(DocumentLock, testPageLocks) {
+    DocumentHandler handler;
+    Document doc(&handler);
+    XojPage first(595, 842);
+    XojPage second(595, 842);
+
+    // Different pages: no wait
+    doc.lockPage(first);
+    std::thread([&doc, &second]() {
+        doc.lockPage(second);
+        doc.unlockPage(second);
+    }).join();
+
+    // The same page: waits until it is unlocked
+    std::atomic<bool> locked{false};
+    std::thread writer([&doc, &first, &locked]() {
+        doc.lockPage(first);
+        locked = true;
+        doc.unlockPage(first);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(locked);
+    doc.unlockPage(first);
+    writer.join();
+    EXPECT_TRUE(locked);
+
+    auto statistics = doc.getLockStatistics();
+    EXPECT_EQ(statistics.page, 3);
+    EXPECT_GE(statistics.contended, 1);
+    EXPECT_GT(statistics.waitedMs, 0);
+}
+
+TEST(DocumentLock, testExclusiveLockExcludesPageLocks) {
+    DocumentHandler handler;
+    Document doc(&handler);
+    XojPage page(595, 842);
+
+    doc.lock();
+    std::atomic<bool> locked{false};
+    std::thread renderer([&doc, &page, &locked]() {
+        doc.lockPage(page);
+        locked = true;
+        doc.unlockPage(page);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(locked);
+    doc.unlock();
+    renderer.join();
+    EXPECT_TRUE(locked);
+    EXPECT_EQ(doc.getLockStatistics().exclusive, 1);
+}
+
+TEST(DocumentLock, testSnapshotsLeaveThePageUnlocked) {
+    DocumentHandler handler;
+    Document doc(&handler);
+    XojPage page(595, 842);
+    auto* layer = new Layer();
+    page.getLayers()->push_back(layer);
+    auto* first = new Stroke();
+    first->addPoint(Point(10, 10));
+    first->addPoint(Point(20, 20));
+    layer->addElement(first);
+
+    PageSnapshot snapshot = doc.lockSnapshot(page, xoj::util::Rectangle<double>(0, 0, 595, 842));
+    ASSERT_EQ(snapshot.getLayers().size(), 1);
+    EXPECT_EQ(snapshot.getLayers()[0].size(), 1);
+
+    // A tool changes the page while the snapshot is drawn
+    std::thread([&doc, &page, layer]() {
+        doc.lockPage(page);
+        auto* second = new Stroke();
+        second->addPoint(Point(30, 30));
+        second->addPoint(Point(40, 40));
+        layer->addElement(second);
+        doc.unlockPage(page);
+    }).join();
+    EXPECT_EQ(snapshot.getLayers()[0].size(), 1);
+    EXPECT_EQ(layer->getElements().size(), 2);
+
+    // The elements removed meanwhile are deleted once the snapshot is drawn
+    std::atomic<bool> waited{false};
+    std::thread undo([&doc, &waited]() {
+        doc.waitForSnapshots();
+        waited = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(waited);
+    doc.unlockSnapshot();
+    undo.join();
+    EXPECT_TRUE(waited);
+}
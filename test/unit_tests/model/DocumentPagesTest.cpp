@@ -0,0 +1,54 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/DocumentListener.h"
+#include "model/XojPage.h"
+
+namespace {
+class InsertionListener: public DocumentListener {
+public:
+    void pageInserted(size_t page) override { inserted.push_back(page); }
+
+    std::vector<size_t> inserted;
+};
+};  // namespace
+
+TEST(DocumentPages, testInsertPages) {
+    DocumentHandler handler;
+    Document doc(&handler);
+    for (int i = 0; i < 3; i++) { doc.addPage(std::make_shared<XojPage>(100 + i, 100)); }
+
+    std::vector<PageRef> pages = {std::make_shared<XojPage>(200, 100), std::make_shared<XojPage>(201, 100)};
+    doc.insertPages(pages.begin(), pages.end(), 1);
+
+    ASSERT_EQ(doc.getPageCount(), 5);
+    EXPECT_EQ(doc.getPage(0)->getWidth(), 100);
+    EXPECT_EQ(doc.getPage(1), pages[0]);
+    EXPECT_EQ(doc.getPage(2), pages[1]);
+    EXPECT_EQ(doc.getPage(3)->getWidth(), 101);
+    EXPECT_EQ(doc.indexOf(pages[1]), 2);
+}
+
+TEST(DocumentPages, testPagesInsertedDefaultsToPageInserted) {
+    DocumentHandler handler;
+    InsertionListener listener;
+    listener.registerListener(&handler);
+
+    handler.firePagesInserted(4, 3);
+    EXPECT_EQ(listener.inserted, (std::vector<size_t>{4, 5, 6}));
+}
@@ -0,0 +1,41 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <memory>
+
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "util/Color.h"
+#include "model/XojPage.h"
+
+TEST(DocumentPreview, testPreviewIsUpToDateUntilThePageChanges) {
+    DocumentHandler handler;
+    Document doc(&handler);
+    auto page = std::make_shared<XojPage>(100, 100);
+    doc.addPage(page);
+    EXPECT_FALSE(doc.isPreviewUpToDate(page));
+
+    cairo_surface_t* preview = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 16, 16);
+    doc.setPreview(preview, page, page->getRevision());
+    EXPECT_TRUE(doc.isPreviewUpToDate(page));
+    EXPECT_FALSE(doc.isPreviewUpToDate(std::make_shared<XojPage>(100, 100)));
+
+    page->setBackgroundColor(Color(0xff0000U));
+    EXPECT_FALSE(doc.isPreviewUpToDate(page));
+
+    doc.setPreview(preview, page, page->getRevision());
+    doc.setPreview(nullptr);
+    EXPECT_FALSE(doc.isPreviewUpToDate(page));
+    cairo_surface_destroy(preview);
+}
@@ -1,5 +1,6 @@
 #include <array>
 #include <map>
+#include <memory>
 
 #include <gtest/gtest.h>
 
@@ -121,8 +122,9 @@ TEST(ErasableStroke, testGetStrokes) {
     strokes[2].setFill(-1);
     strokes[2].setToolType(StrokeTool::STROKE_TOOL_HIGHLIGHTER);
 
-    std::array<ErasableStroke, 3> erasables = {ErasableStroke(strokes[0]), ErasableStroke(strokes[1]),
-                                               ErasableStroke(strokes[2])};
+    std::array<std::shared_ptr<ErasableStroke>, 3> erasables = {std::make_shared<ErasableStroke>(strokes[0]),
+                                                               std::make_shared<ErasableStroke>(strokes[1]),
+                                                               std::make_shared<ErasableStroke>(strokes[2])};
 
     std::array<bool, 3> areClosed = {false, true, true};
 
@@ -147,11 +149,11 @@ TEST(ErasableStroke, testGetStrokes) {
 
     unsigned int i = 0;
     for (auto& erasable: erasables) {
-        strokes[i].setErasable(&erasable);
+        strokes[i].setErasable(erasable);
         Range range(0, 0);
-        erasable.beginErasure(fakeIntersections[i], range);
-        ASSERT_EQ(erasable.isClosedStroke(), areClosed[i]);
-        auto res = erasable.getStrokes();
+        erasable->beginErasure(fakeIntersections[i], range);
+        ASSERT_EQ(erasable->isClosedStroke(), areClosed[i]);
+        auto res = erasable->getStrokes();
         ASSERT_EQ(res.size(), resultingPaths[i].size());
         for (unsigned int j = 0; j < res.size(); ++j) {
             ASSERT_EQ(res[j]->getWidth(), strokes[i].getWidth());
@@ -0,0 +1,84 @@
+#include <memory>
+#include <string>
+
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "model/Image.h"
+#include "model/ImageStore.h"
+
+static auto makePng(int size) -> std::string {
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size, size);
+    std::string data;
+    cairo_surface_write_to_png_stream(
+            surface,
+            [](void* closure, const unsigned char* bytes, unsigned int length) -> cairo_status_t {
+                static_cast<std::string*>(closure)->append(reinterpret_cast<const char*>(bytes), length);
+                return CAIRO_STATUS_SUCCESS;
+            },
+            &data);
+    cairo_surface_destroy(surface);
+    return data;
+}
+
+TEST(ImageStore, testSameDataIsShared) {
+    auto count = ImageStore::getCount();
+    std::string png = makePng(4);
+
+    auto image1 = std::make_unique<Image>();
+    image1->setImage(png);
+    auto image2 = std::make_unique<Image>();
+    image2->setImage(png);
+
+    EXPECT_EQ(ImageStore::getCount(), count + 1);
+    EXPECT_EQ(image1->getContent(), image2->getContent());
+    EXPECT_EQ(image1->getImage(), image2->getImage());
+    EXPECT_EQ(image1->getImageSize(), std::make_pair(4, 4));
+
+    auto other = std::make_unique<Image>();
+    other->setImage(makePng(8));
+    EXPECT_EQ(ImageStore::getCount(), count + 2);
+    EXPECT_NE(other->getContent(), image1->getContent());
+
+    std::unique_ptr<Image> clone(dynamic_cast<Image*>(image1->clone()));
+    EXPECT_EQ(clone->getContent(), image1->getContent());
+}
+
+TEST(ImageStore, testDataIsReleasedWithTheLastImage) {
+    auto count = ImageStore::getCount();
+    std::string png = makePng(6);
+
+    auto image1 = std::make_unique<Image>();
+    image1->setImage(png);
+    auto image2 = std::make_unique<Image>();
+    image2->setImage(png);
+    EXPECT_EQ(ImageStore::getCount(), count + 1);
+
+    image1.reset();
+    EXPECT_EQ(ImageStore::getCount(), count + 1);
+    image2.reset();
+    EXPECT_EQ(ImageStore::getCount(), count);
+
+    // Added again
+    auto image3 = std::make_unique<Image>();
+    image3->setImage(png);
+    EXPECT_EQ(ImageStore::getCount(), count + 1);
+    EXPECT_EQ(image3->getRawDataLength(), png.size());
+}
+
+TEST(ImageStore, testAsyncDataIsShared) {
+    std::string png = makePng(5);
+    auto image1 = std::make_unique<Image>();
+    image1->setImage(png);
+
+    auto image2 = std::make_unique<Image>();
+    image2->setImage(ImageStore::getAsync([png]() { return ImageStore::Decoded{png}; }));
+    EXPECT_TRUE(image2->hasData());
+
+    // Waits for the data
+    EXPECT_EQ(image2->getContent(), image1->getContent());
+    EXPECT_EQ(image2->getContentIfReady(), image1->getContent());
+
+    std::unique_ptr<Image> clone(dynamic_cast<Image*>(image2->clone()));
+    EXPECT_EQ(clone->getContent(), image1->getContent());
+}
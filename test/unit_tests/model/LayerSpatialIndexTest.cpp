@@ -0,0 +1,154 @@
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include "util/Rectangle.h"
+
+using xoj::util::Rectangle;
+
+static Stroke* makeStroke(double x, double y) {
+    auto* s = new Stroke();
+    s->setWidth(1);
+    s->addPoint(Point(x, y));
+    s->addPoint(Point(x + 2, y + 2));
+    return s;
+}
+
+TEST(LayerSpatialIndex, testQueryReturnsElementsInLayerOrder) {
+    Layer layer;
+    Stroke* a = makeStroke(10, 10);
+    Stroke* b = makeStroke(500, 500);
+    Stroke* c = makeStroke(12, 12);
+    layer.addElement(a);
+    layer.addElement(b);
+    layer.addElement(c);
+
+    auto found = layer.getElementsInArea(Rectangle<double>(0, 0, 20, 20));
+    EXPECT_EQ(found, (std::vector<Element*>{a, c}));
+
+    // Insert an element below all the others
+    Stroke* d = makeStroke(11, 11);
+    layer.insertElement(d, 0);
+    found = layer.getElementsInArea(Rectangle<double>(0, 0, 20, 20));
+    EXPECT_EQ(found, (std::vector<Element*>{d, a, c}));
+
+    // Whole page query
+    found = layer.getElementsInArea(Rectangle<double>(-1000, -1000, 3000, 3000));
+    EXPECT_EQ(found, layer.getElements());
+}
+
+TEST(LayerSpatialIndex, testIndexFollowsElementChanges) {
+    Layer layer;
+    Stroke* a = makeStroke(10, 10);
+    layer.addElement(a);
+
+    a->move(300, 0);
+    EXPECT_TRUE(layer.getElementsInArea(Rectangle<double>(0, 0, 20, 20)).empty());
+    EXPECT_EQ(layer.getElementsInArea(Rectangle<double>(300, 0, 20, 20)), (std::vector<Element*>{a}));
+
+    a->addPoint(Point(1000, 1000));
+    EXPECT_EQ(layer.getElementsInArea(Rectangle<double>(990, 990, 20, 20)), (std::vector<Element*>{a}));
+
+    layer.removeElement(a, false);
+    EXPECT_TRUE(layer.getElementsInArea(Rectangle<double>(0, 0, 2000, 2000)).empty());
+
+    // Not on the layer anymore: changes are not tracked
+    a->move(-300, 0);
+    EXPECT_TRUE(layer.getElementsInArea(Rectangle<double>(0, 0, 2000, 2000)).empty());
+    delete a;
+}
+
+TEST(LayerSpatialIndex, testManyInsertionsAtSamePosition) {
+    Layer layer;
+    std::vector<Element*> expected;
+    for (int i = 0; i < 200; i++) {
+        Stroke* s = makeStroke(i, i);
+        layer.insertElement(s, 1);
+        if (expected.empty()) {
+            expected.push_back(s);
+        } else {
+            expected.insert(expected.begin() + 1, s);
+        }
+    }
+    EXPECT_EQ(layer.getElementsInArea(Rectangle<double>(0, 0, 300, 300)), expected);
+}
+
+TEST(LayerSpatialIndex, testBulkRemoveAndAdd) {
+    Layer layer;
+    std::vector<Element*> all;
+    for (int i = 0; i < 10; i++) {
+        all.push_back(makeStroke(10 * i, 10 * i));
+        layer.addElement(all.back());
+    }
+
+    std::vector<Element*> moved{all[2], all[5], all[7]};
+    uint64_t revision = layer.getRevision();
+    layer.removeElements(moved);
+    EXPECT_GT(layer.getRevision(), revision);
+    EXPECT_EQ(layer.getElements(), (std::vector<Element*>{all[0], all[1], all[3], all[4], all[6], all[8], all[9]}));
+    EXPECT_TRUE(layer.getElementsInArea(Rectangle<double>(49, 49, 4, 4)).empty());
+
+    // Not on the layer anymore: nothing changes
+    revision = layer.getRevision();
+    layer.removeElements(moved);
+    EXPECT_EQ(layer.getRevision(), revision);
+
+    // Appended on top, in their order
+    for (Element* e: moved) { e->move(0, 100); }
+    layer.addElements(moved);
+    std::vector<Element*> expected{all[0], all[1], all[3], all[4], all[6], all[8], all[9], all[2], all[5], all[7]};
+    EXPECT_EQ(layer.getElements(), expected);
+    EXPECT_EQ(layer.getElementsInArea(Rectangle<double>(-1000, -1000, 3000, 3000)), layer.getElements());
+    EXPECT_EQ(layer.getElementsInArea(Rectangle<double>(49, 149, 4, 4)), (std::vector<Element*>{all[5]}));
+
+    // The check of addElement() is still done
+    layer.addElement(all[5]);
+    EXPECT_EQ(layer.getElements().size(), all.size());
+}
+
+TEST(LayerSpatialIndex, testBatchInsertion) {
+    Layer layer;
+    std::vector<Element*> all;
+    for (int i = 0; i < 10; i++) { all.push_back(makeStroke(10 * i, 10 * i)); }
+
+    // Removed as an undo action records them, then inserted back at once
+    std::vector<std::pair<Element*, Element::Index>> removed{{all[0], 0}, {all[3], 3}, {all[4], 4}, {all[9], 9}};
+    for (size_t i = 0; i < all.size(); i++) {
+        if (i != 0 && i != 3 && i != 4 && i != 9) {
+            layer.addElement(all[i]);
+        }
+    }
+    uint64_t revision = layer.getRevision();
+    layer.insertElements(removed);
+    EXPECT_GT(layer.getRevision(), revision);
+    EXPECT_EQ(layer.getElements(), all);
+    EXPECT_EQ(layer.getElementsInArea(Rectangle<double>(-1000, -1000, 3000, 3000)), all);
+    for (size_t i = 0; i < all.size(); i++) { EXPECT_EQ(layer.indexOf(all[i]), static_cast<Element::Index>(i)); }
+
+    // Positions which do not increase: as successive insertElement() calls
+    Stroke* a = makeStroke(1, 1);
+    Stroke* b = makeStroke(2, 2);
+    layer.insertElements({{a, 2}, {b, 2}, {all[1], 5}});
+    std::vector<Element*> expected = all;
+    expected.insert(expected.begin() + 2, a);
+    expected.insert(expected.begin() + 2, b);
+    EXPECT_EQ(layer.getElements(), expected);
+    EXPECT_EQ(layer.getElementsInArea(Rectangle<double>(-1000, -1000, 3000, 3000)), expected);
+
+    // Many insertions between the same neighbours
+    std::vector<std::pair<Element*, Element::Index>> many;
+    for (int i = 0; i < 100; i++) {
+        many.emplace_back(makeStroke(i, 0), 1 + i);
+        expected.insert(expected.begin() + 1 + i, many.back().first);
+    }
+    layer.insertElements(many);
+    EXPECT_EQ(layer.getElements(), expected);
+    EXPECT_EQ(layer.getElementsInArea(Rectangle<double>(-1000, -1000, 3000, 3000)), expected);
+
+    Stroke* outside = makeStroke(0, 0);
+    EXPECT_EQ(layer.indexOf(outside), Element::InvalidIndex);
+    delete outside;
+}
@@ -0,0 +1,60 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+#include "util/Rectangle.h"
+
+using xoj::util::Rectangle;
+
+TEST(Revision, testLayerRevisionIncreasesOnEveryModification) {
+    Layer layer;
+    auto revision = layer.getRevision();
+
+    auto* stroke = new Stroke();
+    stroke->addPoint(Point(0, 0));
+    layer.addElement(stroke);
+    EXPECT_GT(layer.getRevision(), revision);
+    revision = layer.getRevision();
+
+    layer.removeElement(stroke, false);
+    EXPECT_GT(layer.getRevision(), revision);
+    revision = layer.getRevision();
+
+    layer.insertElement(stroke, 0);
+    EXPECT_GT(layer.getRevision(), revision);
+    revision = layer.getRevision();
+
+    layer.setVisible(false);
+    EXPECT_GT(layer.getRevision(), revision);
+    revision = layer.getRevision();
+
+    // Reading leaves the revision as it is
+    EXPECT_EQ(layer.getElements().size(), 1U);
+    EXPECT_FALSE(layer.isVisible());
+    EXPECT_EQ(layer.getRevision(), revision);
+}
+
+TEST(Revision, testPageRevisionIncreasesOnNotificationsAndSetters) {
+    auto page = std::make_shared<XojPage>(100, 100);
+    auto revision = page->getRevision();
+
+    Rectangle<double> rect(0, 0, 10, 10);
+    page->fireRectChanged(rect);
+    EXPECT_GT(page->getRevision(), revision);
+    revision = page->getRevision();
+
+    page->setSize(200, 200);
+    EXPECT_GT(page->getRevision(), revision);
+    revision = page->getRevision();
+
+    page->setBackgroundColor(Color(0x000000U));
+    EXPECT_GT(page->getRevision(), revision);
+    revision = page->getRevision();
+
+    EXPECT_EQ(page->getLayerCount(), 0U);
+    EXPECT_DOUBLE_EQ(page->getWidth(), 200);
+    EXPECT_EQ(page->getRevision(), revision);
+}
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/Point.h"
+#include "model/SegmentKernels.h"
+#include "util/Rectangle.h"
+
+using xoj::util::Rectangle;
+
+/**
+ * The hit test of Stroke::intersects(), one segment at a time
+ */
+static bool referenceHits(const Point& last, const Point& point, const SegmentKernels::HitBox& box) {
+    if (point.x >= box.x - box.halfSize && point.y >= box.y - box.halfSize && point.x <= box.x + box.halfSize &&
+        point.y <= box.y + box.halfSize) {
+        return true;
+    }
+    double len = std::sqrt((point.x - last.x) * (point.x - last.x) + (point.y - last.y) * (point.y - last.y));
+    if (len < box.halfSize) {
+        return false;
+    }
+    double p = std::abs((box.x - last.x) * (last.y - point.y) + (box.y - last.y) * (point.x - last.x)) / len;
+    double mx = box.x - (last.x + point.x) / 2;
+    double my = box.y - (last.y + point.y) / 2;
+    double distance = std::sqrt(mx * mx + my * my) - box.halfSize * std::sqrt(2.0);
+    return p <= box.halfSize && distance <= len / 2 + SegmentKernels::HIT_PADDING;
+}
+
+static size_t referenceFindHit(const std::vector<Point>& points, size_t first, size_t last,
+                               const SegmentKernels::HitBox& box) {
+    for (size_t i = first; i <= last; i++) {
+        if (referenceHits(points[i == first ? first : i - 1], points[i], box)) {
+            return i;
+        }
+    }
+    return last + 1;
+}
+
+static size_t referenceFindSegmentTouching(const std::vector<Point>& points, size_t first, size_t last,
+                                           const Rectangle<double>& area) {
+    for (size_t i = first; i <= last; i++) {
+        const Point& p = points[i];
+        const Point& q = points[i + 1];
+        if (std::min(p.x, q.x) <= area.x + area.width && std::max(p.x, q.x) >= area.x &&
+            std::min(p.y, q.y) <= area.y + area.height && std::max(p.y, q.y) >= area.y) {
+            return i;
+        }
+    }
+    return last + 1;
+}
+
+static auto makeRandomWalk(std::mt19937& gen, size_t n) -> std::vector<Point> {
+    std::uniform_real_distribution<double> step(-3, 3);
+    std::vector<Point> points;
+    Point p(50, 50);
+    for (size_t i = 0; i < n; i++) {
+        points.push_back(p);
+        p.x += step(gen);
+        p.y += step(gen);
+    }
+    return points;
+}
+
+TEST(SegmentKernels, testFindHitMatchesTheSegmentBySegmentTest) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coordinate(20, 80);
+    std::uniform_real_distribution<double> size(0.5, 8);
+
+    for (int run = 0; run < 200; run++) {
+        const auto points = makeRandomWalk(gen, 40);
+        const SegmentKernels::HitBox box{coordinate(gen), coordinate(gen), size(gen)};
+        // Odd and even lengths of the run, including the single point
+        for (size_t first: {0, 1, 5}) {
+            for (size_t last = first; last < points.size(); last++) {
+                ASSERT_EQ(SegmentKernels::findHit(points.data(), first, last, box),
+                          referenceFindHit(points, first, last, box));
+            }
+        }
+    }
+}
+
+TEST(SegmentKernels, testFindHitEdgeCases) {
+    const std::vector<Point> points = {Point(0, 0), Point(10, 0), Point(20, 0), Point(30, 0)};
+
+    // The first point is only tested for being in the box, not with the segment ending on it
+    EXPECT_EQ(SegmentKernels::findHit(points.data(), 1, 3, {5, 0.5, 1}), 4U);
+    EXPECT_EQ(SegmentKernels::findHit(points.data(), 0, 3, {5, 0.5, 1}), 1U);
+    EXPECT_EQ(SegmentKernels::findHit(points.data(), 2, 2, {20, 0, 1}), 2U);
+    EXPECT_EQ(SegmentKernels::findHit(points.data(), 0, 3, {100, 100, 1}), 4U);
+    EXPECT_EQ(SegmentKernels::findHit(points.data(), 2, 1, {20, 0, 1}), 2U);
+
+    // The second lane of a pair of segments
+    EXPECT_EQ(SegmentKernels::findHit(points.data(), 0, 3, {15, 0.5, 1}), 2U);
+}
+
+TEST(SegmentKernels, testGetHitGap) {
+    const Point last(0, 0);
+    const Point point(10, 0);
+    EXPECT_DOUBLE_EQ(SegmentKernels::getHitGap(last, point, {10, 0.5, 1}), 0.0);
+    EXPECT_DOUBLE_EQ(SegmentKernels::getHitGap(last, point, {5, 3, 1}), 3 - std::sqrt(2.0));
+}
+
+TEST(SegmentKernels, testFindSegmentTouchingMatchesTheSegmentBySegmentTest) {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> coordinate(20, 80);
+    std::uniform_real_distribution<double> size(0.5, 10);
+
+    for (int run = 0; run < 200; run++) {
+        const auto points = makeRandomWalk(gen, 40);
+        const Rectangle<double> area(coordinate(gen), coordinate(gen), size(gen), size(gen));
+        for (size_t first: {0, 1, 6}) {
+            for (size_t last = first; last + 1 < points.size(); last++) {
+                ASSERT_EQ(SegmentKernels::findSegmentTouching(points.data(), first, last, area),
+                          referenceFindSegmentTouching(points, first, last, area));
+            }
+        }
+    }
+}
+
+TEST(SegmentKernels, testFindSegmentTouchingOnTheBorder) {
+    const std::vector<Point> points = {Point(0, 0), Point(1, 0), Point(2, 0), Point(3, 5)};
+    // The area is closed
+    EXPECT_EQ(SegmentKernels::findSegmentTouching(points.data(), 0, 2, Rectangle<double>(2.5, 2.5, 1, 1)), 2U);
+    EXPECT_EQ(SegmentKernels::findSegmentTouching(points.data(), 0, 2, Rectangle<double>(2, 0, 1, 1)), 1U);
+    EXPECT_EQ(SegmentKernels::findSegmentTouching(points.data(), 0, 2, Rectangle<double>(10, 10, 1, 1)), 3U);
+    EXPECT_EQ(SegmentKernels::findSegmentTouching(points.data(), 2, 1, Rectangle<double>(0, 0, 1, 1)), 2U);
+}
@@ -0,0 +1,81 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/SplineSegment.h"
+
+/**
+ * @return The largest distance between points on the spline segment and the polyline of its points
+ */
+static auto maxDeviation(const SplineSegment& spline, const std::list<Point>& points) -> double {
+    std::vector<Point> polyline(points.begin(), points.end());
+    polyline.push_back(spline.secondKnot);
+
+    auto distanceToPolyline = [&](const Point& p) {
+        double best = INFINITY;
+        for (size_t i = 0; i + 1 < polyline.size(); i++) {
+            const Point& a = polyline[i];
+            const Point& b = polyline[i + 1];
+            double dx = b.x - a.x;
+            double dy = b.y - a.y;
+            double lengthSqrd = dx * dx + dy * dy;
+            double t = lengthSqrd > 0 ? std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSqrd, 0.0, 1.0) : 0;
+            best = std::min(best, std::hypot(a.x + t * dx - p.x, a.y + t * dy - p.y));
+        }
+        return best;
+    };
+
+    double deviation = 0;
+    for (int i = 0; i <= 200; i++) {
+        double t = i / 200.0;
+        double s = 1 - t;
+        Point p(s * s * s * spline.firstKnot.x + 3 * s * s * t * spline.firstControlPoint.x +
+                        3 * s * t * t * spline.secondControlPoint.x + t * t * t * spline.secondKnot.x,
+                s * s * s * spline.firstKnot.y + 3 * s * s * t * spline.firstControlPoint.y +
+                        3 * s * t * t * spline.secondControlPoint.y + t * t * t * spline.secondKnot.y);
+        deviation = std::max(deviation, distanceToPolyline(p));
+    }
+    return deviation;
+}
+
+TEST(SplineSegment, testStraightSegmentGivesOnePoint) {
+    SplineSegment line(Point(0, 0), Point(30, 0), Point(60, 0), Point(100, 0));
+    EXPECT_EQ(line.toPointSequence().size(), 1);
+    EXPECT_EQ(SplineSegment(Point(0, 0), Point(100, 50)).toPointSequence().size(), 1);
+
+    // On the line, but overshooting the second knot
+    SplineSegment overshoot(Point(0, 0), Point(150, 0), Point(-50, 0), Point(100, 0));
+    EXPECT_GT(overshoot.toPointSequence().size(), 1);
+}
+
+TEST(SplineSegment, testTolerance) {
+    SplineSegment arc(Point(0, 0), Point(0, 55), Point(45, 100), Point(100, 100));
+    for (double tolerance: {1.0, SplineSegment::DEFAULT_TOLERANCE, 0.01}) {
+        auto points = arc.toPointSequence(false, tolerance);
+        EXPECT_LE(maxDeviation(arc, points), tolerance);
+    }
+    EXPECT_LT(arc.toPointSequence(false, 1.0).size(), arc.toPointSequence(false, 0.01).size());
+
+    // A closed loop is subdivided too
+    SplineSegment loop(Point(0, 0), Point(50, 50), Point(-50, 50), Point(0, 0));
+    EXPECT_LE(maxDeviation(loop, loop.toPointSequence()), SplineSegment::DEFAULT_TOLERANCE);
+}
+
+TEST(SplineSegment, testToleranceForZoom) {
+    EXPECT_DOUBLE_EQ(SplineSegment::toleranceForZoom(1), SplineSegment::DEFAULT_TOLERANCE);
+    EXPECT_DOUBLE_EQ(SplineSegment::toleranceForZoom(10), SplineSegment::PIXEL_TOLERANCE / 10);
+}
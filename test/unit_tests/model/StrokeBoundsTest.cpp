@@ -0,0 +1,103 @@
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/Stroke.h"
+
+/**
+ * The bounds of the stroke are the ones calculated from all its points
+ */
+static void expectScannedBounds(const Stroke& stroke) {
+    Stroke scanned;
+    scanned.setWidth(stroke.getWidth());
+    scanned.setPointVector(stroke.getPointVector());
+
+    EXPECT_DOUBLE_EQ(stroke.getX(), scanned.getX());
+    EXPECT_DOUBLE_EQ(stroke.getY(), scanned.getY());
+    EXPECT_DOUBLE_EQ(stroke.getElementWidth(), scanned.getElementWidth());
+    EXPECT_DOUBLE_EQ(stroke.getElementHeight(), scanned.getElementHeight());
+    EXPECT_DOUBLE_EQ(stroke.getSnappedBounds().x, scanned.getSnappedBounds().x);
+    EXPECT_DOUBLE_EQ(stroke.getSnappedBounds().width, scanned.getSnappedBounds().width);
+}
+
+static auto makeStroke(bool pressure) -> Stroke {
+    Stroke stroke;
+    stroke.setWidth(2);
+    for (int i = 0; i < 50; i++) {
+        stroke.addPoint(Point(10 + i, 20 + std::sin(i), pressure ? 1 + (i % 7) * 0.5 : Point::NO_PRESSURE));
+    }
+    return stroke;
+}
+
+TEST(StrokeBounds, testAddAndReplaceTheLastPoint) {
+    for (bool pressure: {false, true}) {
+        Stroke stroke;
+        stroke.setWidth(2);
+        stroke.addPoint(Point(-5, -5, pressure ? 3 : Point::NO_PRESSURE));
+        expectScannedBounds(stroke);
+        for (int i = 0; i < 20; i++) {
+            stroke.addPoint(Point(i, -i, pressure ? 2 : Point::NO_PRESSURE));
+            // Moving back and forth, like the stabilizer and the spline previews
+            stroke.setLastPoint(Point(2 * i, -2 * i, pressure ? 4 : Point::NO_PRESSURE));
+            expectScannedBounds(stroke);
+            stroke.setLastPoint(Point(-i, i, pressure ? 1 : Point::NO_PRESSURE));
+            expectScannedBounds(stroke);
+        }
+        if (pressure) {
+            stroke.setLastPressure(8);
+            expectScannedBounds(stroke);
+            stroke.setLastPressure(1);
+            expectScannedBounds(stroke);
+            stroke.setSecondToLastPressure(0.5);
+            expectScannedBounds(stroke);
+        }
+    }
+}
+
+TEST(StrokeBounds, testDeletePoints) {
+    for (bool pressure: {false, true}) {
+        Stroke stroke = makeStroke(pressure);
+        expectScannedBounds(stroke);
+        // Inner point, then the extreme ones
+        stroke.deletePoint(20);
+        expectScannedBounds(stroke);
+        stroke.deletePoint(0);
+        expectScannedBounds(stroke);
+        stroke.deletePointsFrom(30);
+        expectScannedBounds(stroke);
+        stroke.deletePointsFrom(0);
+        expectScannedBounds(stroke);
+    }
+}
+
+TEST(StrokeBounds, testTransformations) {
+    for (bool pressure: {false, true}) {
+        Stroke stroke = makeStroke(pressure);
+        expectScannedBounds(stroke);
+        stroke.move(3, -7);
+        expectScannedBounds(stroke);
+        stroke.scale(5, 5, 2, -0.5, 0, false);
+        expectScannedBounds(stroke);
+        stroke.scale(5, 5, 1.5, 1.5, 0.3, true);
+        expectScannedBounds(stroke);
+        stroke.rotate(0, 0, 1);
+        expectScannedBounds(stroke);
+        stroke.scalePressure(2);
+        expectScannedBounds(stroke);
+        stroke.setWidth(6);
+        expectScannedBounds(stroke);
+        stroke.clearPressure();
+        expectScannedBounds(stroke);
+    }
+}
+
+TEST(StrokeBounds, testNegativeCoordinates) {
+    Stroke stroke;
+    stroke.setWidth(1);
+    stroke.setPointVector({Point(-10, -20), Point(-30, -5)});
+    EXPECT_DOUBLE_EQ(stroke.getSnappedBounds().x, -30);
+    EXPECT_DOUBLE_EQ(stroke.getSnappedBounds().y, -20);
+    EXPECT_DOUBLE_EQ(stroke.getSnappedBounds().width, 20);
+    EXPECT_DOUBLE_EQ(stroke.getSnappedBounds().height, 15);
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include "model/Stroke.h"
+
+TEST(StrokeCairoPath, testCachedUntilPointsChange) {
+    Stroke s;
+    s.setWidth(1);
+    s.addPoint(Point(1, 2));
+    s.addPoint(Point(3, 4));
+    s.addPoint(Point(5, 6));
+
+    auto path = s.getCairoPath();
+    ASSERT_TRUE(path);
+    EXPECT_EQ(s.getCairoPath(), path);
+
+    const cairo_path_t* p = path->get();
+    ASSERT_EQ(p->num_data, 6);
+    EXPECT_EQ(p->data[0].header.type, CAIRO_PATH_MOVE_TO);
+    EXPECT_EQ(p->data[2].header.type, CAIRO_PATH_LINE_TO);
+    EXPECT_EQ(p->data[5].point.x, 5);
+    EXPECT_EQ(p->data[5].point.y, 6);
+
+    s.move(10, 0);
+    auto moved = s.getCairoPath();
+    ASSERT_TRUE(moved);
+    EXPECT_NE(moved, path);
+    EXPECT_EQ(moved->get()->data[5].point.x, 15);
+
+    s.addPoint(Point(7, 8));
+    EXPECT_EQ(s.getCairoPath()->get()->num_data, 8);
+}
+
+TEST(StrokeCairoPath, testSimplifiedPathPerTolerance) {
+    Stroke s;
+    s.setWidth(1);
+    for (int i = 0; i <= 100; i++) { s.addPoint(Point(i, i % 2 ? 0.1 : 0)); }
+
+    auto path = s.getSimplifiedCairoPath(0.3);
+    ASSERT_TRUE(path);
+    EXPECT_EQ(path->getTolerance(), 0.25);
+    // The straight line is kept for its ends only
+    EXPECT_EQ(path->get()->num_data, 4);
+    EXPECT_EQ(path->get()->data[3].point.x, 100);
+
+    // A close tolerance shares the path, a finer one does not
+    EXPECT_EQ(s.getSimplifiedCairoPath(0.4), path);
+    auto fine = s.getSimplifiedCairoPath(0.01);
+    ASSERT_TRUE(fine);
+    EXPECT_EQ(fine->get()->num_data, 2 * 101);
+
+    s.move(10, 0);
+    auto moved = s.getSimplifiedCairoPath(0.01);
+    ASSERT_TRUE(moved);
+    EXPECT_NE(moved, fine);
+    EXPECT_EQ(moved->get()->data[2 * 100 + 1].point.x, 110);
+}
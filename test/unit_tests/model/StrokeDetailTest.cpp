@@ -0,0 +1,65 @@
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/Stroke.h"
+#include "model/StrokeDetail.h"
+
+TEST(StrokeDetail, testEndsAreKept) {
+    std::vector<Point> points;
+    for (int i = 0; i < 10; i++) { points.emplace_back(i, 0); }
+    StrokeDetail detail(points);
+
+    EXPECT_TRUE(detail.keeps(0, 1000));
+    EXPECT_TRUE(detail.keeps(9, 1000));
+}
+
+TEST(StrokeDetail, testCollinearPointsAreDropped) {
+    std::vector<Point> points;
+    for (int i = 0; i < 100; i++) { points.emplace_back(i, 0.001 * (i % 2)); }
+    StrokeDetail detail(points);
+
+    for (size_t i = 1; i < 99; i++) {
+        EXPECT_FALSE(detail.keeps(i, 0.01)) << i;
+    }
+}
+
+TEST(StrokeDetail, testCornersAreKept) {
+    std::vector<Point> points;
+    for (int i = 0; i <= 50; i++) { points.emplace_back(i, 0); }
+    for (int i = 1; i <= 50; i++) { points.emplace_back(50, i); }
+    StrokeDetail detail(points);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < points.size(); i++) {
+        if (detail.keeps(i, 0.1)) {
+            kept++;
+        }
+    }
+    EXPECT_EQ(kept, 3);
+    EXPECT_TRUE(detail.keeps(50, 0.1));
+    EXPECT_TRUE(detail.keeps(50, 10));
+}
+
+TEST(StrokeDetail, testLongStrokesKeepTheChunkEnds) {
+    std::vector<Point> points;
+    for (size_t i = 0; i < 3 * StrokeDetail::CHUNK_SIZE; i++) { points.emplace_back(static_cast<double>(i), 0); }
+    StrokeDetail detail(points);
+
+    EXPECT_TRUE(detail.keeps(StrokeDetail::CHUNK_SIZE, 1000));
+    EXPECT_FALSE(detail.keeps(StrokeDetail::CHUNK_SIZE / 2, 1));
+}
+
+TEST(StrokeDetail, testResetWhenPointsChange) {
+    Stroke s;
+    s.setWidth(1);
+    for (int i = 0; i < 10; i++) { s.addPoint(Point(i, 0)); }
+
+    auto detail = s.getDetail();
+    ASSERT_TRUE(detail);
+    EXPECT_EQ(s.getDetail(), detail);
+
+    s.addPoint(Point(10, 5));
+    EXPECT_NE(s.getDetail(), detail);
+}
@@ -0,0 +1,124 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/PathParameter.h"
+#include "model/Stroke.h"
+#include "model/StrokeSegmentTree.h"
+#include "model/eraser/PaddedBox.h"
+#include "util/Rectangle.h"
+#include "util/SmallVector.h"
+
+using xoj::util::Rectangle;
+
+static auto randomWalk(size_t count, unsigned int seed) -> std::vector<Point> {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> step(-5.0, 5.0);
+    std::vector<Point> points;
+    Point p(100, 100);
+    for (size_t i = 0; i < count; i++) {
+        points.push_back(p);
+        p.x += step(gen);
+        p.y += step(gen);
+    }
+    return points;
+}
+
+static auto segmentIntersects(const Point& p, const Point& q, const Rectangle<double>& r) -> bool {
+    return std::min(p.x, q.x) <= r.x + r.width && std::max(p.x, q.x) >= r.x && std::min(p.y, q.y) <= r.y + r.height &&
+           std::max(p.y, q.y) >= r.y;
+}
+
+TEST(StrokeSegmentTree, testRunsCoverTheSegmentsInTheArea) {
+    for (size_t count: {2, 9, 100, 1000}) {
+        auto points = randomWalk(count, static_cast<unsigned int>(count));
+        StrokeSegmentTree tree(points);
+        ASSERT_EQ(tree.getSegmentCount(), count - 1);
+
+        for (double x = 0; x < 200; x += 23) {
+            Rectangle<double> area(x, x / 2 + 50, 15, 10);
+            std::vector<bool> covered(count - 1, false);
+            size_t previousLast = 0;
+            bool first = true;
+            tree.forEachRun(area, [&](size_t a, size_t b) {
+                EXPECT_LE(a, b);
+                EXPECT_LT(b, count - 1);
+                // The runs are increasing and not adjacent
+                EXPECT_TRUE(first || a > previousLast + 1);
+                first = false;
+                previousLast = b;
+                for (size_t i = a; i <= b; i++) { covered[i] = true; }
+                return true;
+            });
+            for (size_t i = 0; i + 1 < count; i++) {
+                if (segmentIntersects(points[i], points[i + 1], area)) {
+                    EXPECT_TRUE(covered[i]) << count << " " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST(StrokeSegmentTree, testStopsWhenAsked) {
+    std::vector<Point> points;
+    for (int i = 0; i < 100; i++) { points.emplace_back(i, 10 * (i % 2)); }
+    StrokeSegmentTree tree(points);
+
+    int calls = 0;
+    tree.forEachRun(Rectangle<double>(-1, -1, 200, 20), [&](size_t, size_t) {
+        calls++;
+        return false;
+    });
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(StrokeSegmentTree, testEmpty) {
+    StrokeSegmentTree tree(std::vector<Point>{Point(1, 1)});
+    EXPECT_EQ(tree.getSegmentCount(), 0);
+    tree.forEachRun(Rectangle<double>(0, 0, 10, 10), [](size_t, size_t) {
+        ADD_FAILURE();
+        return true;
+    });
+}
+
+TEST(StrokeSegmentTree, testStrokeIntersectsAsLinearScan) {
+    auto points = randomWalk(500, 7);
+    Stroke stroke;
+    stroke.setPointVector(points);
+    ASSERT_NE(stroke.getSegmentTree(), nullptr);
+
+    for (double x = 0; x < 200; x += 3.7) {
+        for (double y = 0; y < 200; y += 4.3) {
+            // The strokes of two points are scanned without tree
+            bool expected = false;
+            for (size_t i = 0; !expected && i + 1 < points.size(); i++) {
+                Stroke segment;
+                segment.setPointVector({points[i], points[i + 1]});
+                expected = segment.intersects(x, y, 2.0);
+            }
+            EXPECT_EQ(stroke.intersects(x, y, 2.0), expected) << x << " " << y;
+        }
+    }
+}
+
+TEST(StrokeSegmentTree, testPaddedBoxOnLongStroke) {
+    std::vector<Point> points;
+    for (int i = 0; i < 200; i++) { points.emplace_back(i, 0); }
+    Stroke stroke;
+    stroke.setPointVector(points);
+    ASSERT_NE(stroke.getSegmentTree(), nullptr);
+
+    PaddedBox box = {Point(120.5, 0), 1, 2};
+    auto result = stroke.intersectWithPaddedBox(box);
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result[0].index, 118);
+    EXPECT_NEAR(result[0].t, 0.5, 1e-9);
+    EXPECT_EQ(result[1].index, 122);
+    EXPECT_NEAR(result[1].t, 0.5, 1e-9);
+
+    // The tree is dropped with the points
+    stroke.setPointVector({Point(0, 0), Point(1, 1)});
+    EXPECT_EQ(stroke.getSegmentTree(), nullptr);
+}
@@ -0,0 +1,177 @@
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/Layer.h"
+#include "model/PageListener.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+#include "undo/ColorUndoAction.h"
+#include "undo/DeleteUndoAction.h"
+#include "undo/MoveUndoAction.h"
+#include "undo/UndoRedoHandler.h"
+
+static auto makeStroke(int points) -> std::unique_ptr<Stroke> {
+    auto stroke = std::make_unique<Stroke>();
+    for (int i = 0; i < points; i++) { stroke->addPoint(Point(i, i, 1.0)); }
+    return stroke;
+}
+
+/**
+ * Records the notifications of a page
+ */
+class ChangeRecorder: public PageListener {
+public:
+    void rectChanged(xoj::util::Rectangle<double>& rect) override { rects.push_back(rect); }
+    void pageChanged() override { pageChanges++; }
+
+    std::vector<xoj::util::Rectangle<double>> rects;
+    int pageChanges = 0;
+};
+
+static auto makeDeleteAction(Layer* layer, Stroke* stroke) -> std::unique_ptr<DeleteUndoAction> {
+    auto action = std::make_unique<DeleteUndoAction>(nullptr, false);
+    action->addElement(layer, stroke, 0);
+    return action;
+}
+
+TEST(UndoRedoHandler, testMemoryUsageOfTheActions) {
+    Layer layer;
+    UndoRedoHandler handler(nullptr);
+    auto stroke = makeStroke(1000);
+
+    EXPECT_EQ(handler.getMemoryUsage(), 0U);
+    handler.addUndoAction(makeDeleteAction(&layer, stroke.get()));
+    EXPECT_GE(handler.getMemoryUsage(), stroke->getMemoryUsage());
+    EXPECT_GE(stroke->getMemoryUsage(), 1000 * sizeof(Point));
+    EXPECT_FALSE(stroke->isCompact());
+}
+
+TEST(UndoRedoHandler, testOldActionsAreCompactedFirst) {
+    Layer layer;
+    auto stroke1 = makeStroke(1000);
+    auto stroke2 = makeStroke(1000);
+    size_t bytes = stroke1->getMemoryUsage();
+
+    // Room for one stroke as it is and one compacted
+    UndoRedoHandler handler(nullptr, bytes * 3 / 2);
+    handler.addUndoAction(makeDeleteAction(&layer, stroke1.get()));
+    handler.addUndoAction(makeDeleteAction(&layer, stroke2.get()));
+
+    EXPECT_TRUE(stroke1->isCompact());
+    EXPECT_FALSE(stroke2->isCompact());
+    EXPECT_LE(handler.getMemoryUsage(), bytes * 3 / 2);
+
+    // Unpacked again on access
+    EXPECT_EQ(stroke1->getPointCount(), 1000);
+    EXPECT_DOUBLE_EQ(stroke1->getPoint(999).x, 999);
+}
+
+TEST(UndoRedoHandler, testOldestActionsAreDroppedOverTheBudget) {
+    Layer layer;
+    std::vector<std::unique_ptr<Stroke>> strokes;
+    for (int i = 0; i < 3; i++) { strokes.emplace_back(makeStroke(1000)); }
+
+    UndoRedoHandler handler(nullptr, strokes[0]->getMemoryUsage() / 2);
+    handler.addUndoAction(makeDeleteAction(&layer, strokes[0].get()));
+    handler.documentSaved();
+    EXPECT_FALSE(handler.isChanged());
+
+    handler.addUndoAction(makeDeleteAction(&layer, strokes[1].get()));
+    handler.addUndoAction(makeDeleteAction(&layer, strokes[2].get()));
+
+    // The last action is always kept, even over the budget
+    EXPECT_TRUE(handler.canUndo());
+    EXPECT_GE(handler.getMemoryUsage(), strokes[2]->getMemoryUsage());
+    EXPECT_LT(handler.getMemoryUsage(), strokes[1]->getMemoryUsage() + strokes[2]->getMemoryUsage());
+
+    // The saved state was dropped
+    EXPECT_TRUE(handler.isChanged());
+}
+
+TEST(UndoRedoHandler, testConsecutiveMovesAreMerged) {
+    auto page = std::make_shared<XojPage>(100, 100);
+    Layer layer;
+    auto stroke = makeStroke(2);
+    std::vector<Element*> elements = {stroke.get()};
+
+    MoveUndoAction move(&layer, page, &elements, 1, 2, &layer, page);
+    MoveUndoAction next(&layer, page, &elements, 3, 4, &layer, page);
+    stroke->move(4, 6);
+    EXPECT_TRUE(move.merge(next));
+
+    move.undo(nullptr);
+    EXPECT_DOUBLE_EQ(stroke->getPoint(0).x, 0);
+    EXPECT_DOUBLE_EQ(stroke->getPoint(0).y, 0);
+
+    // Not the same elements
+    auto other = makeStroke(2);
+    std::vector<Element*> otherElements = {other.get()};
+    MoveUndoAction otherMove(&layer, page, &otherElements, 1, 1, &layer, page);
+    EXPECT_FALSE(move.merge(otherMove));
+
+    UndoRedoHandler handler(nullptr);
+    handler.addUndoAction(std::make_unique<MoveUndoAction>(&layer, page, &elements, 1, 0, &layer, page));
+    size_t bytes = handler.getMemoryUsage();
+    handler.addUndoAction(std::make_unique<MoveUndoAction>(&layer, page, &elements, 1, 0, &layer, page));
+    EXPECT_EQ(handler.getMemoryUsage(), bytes);
+
+    // The saved state stays reachable
+    handler.documentSaved();
+    handler.addUndoAction(std::make_unique<MoveUndoAction>(&layer, page, &elements, 1, 0, &layer, page));
+    EXPECT_GT(handler.getMemoryUsage(), bytes);
+}
+
+TEST(UndoRedoHandler, testConsecutiveColorChangesAreMerged) {
+    auto page = std::make_shared<XojPage>(100, 100);
+    Layer layer;
+    auto stroke = makeStroke(2);
+    stroke->setColor(Color(0x000000U));
+
+    ColorUndoAction color(page, &layer);
+    color.addStroke(stroke.get(), Color(0x000000U), Color(0xff0000U));
+    ColorUndoAction next(page, &layer);
+    next.addStroke(stroke.get(), Color(0xff0000U), Color(0x00ff00U));
+    stroke->setColor(Color(0x00ff00U));
+    EXPECT_TRUE(color.merge(next));
+
+    color.undo(nullptr);
+    EXPECT_EQ(stroke->getColor(), Color(0x000000U));
+    color.redo(nullptr);
+    EXPECT_EQ(stroke->getColor(), Color(0x00ff00U));
+
+    // Does not continue from the last color
+    ColorUndoAction unrelated(page, &layer);
+    unrelated.addStroke(stroke.get(), Color(0x0000ffU), Color(0xffffffU));
+    EXPECT_FALSE(color.merge(unrelated));
+}
+
+TEST(UndoRedoHandler, testMovesRenderTheMovedElementsOnly) {
+    auto page = std::make_shared<XojPage>(500, 500);
+    Layer layer;
+    auto stroke = makeStroke(11);
+    std::vector<Element*> elements = {stroke.get()};
+    ChangeRecorder recorder;
+    recorder.registerListener(page);
+
+    stroke->move(100, 0);
+    MoveUndoAction move(&layer, page, &elements, 100, 0, &layer, page);
+    move.undo(nullptr);
+
+    // Where the stroke is and where it was
+    EXPECT_EQ(recorder.pageChanges, 0);
+    ASSERT_EQ(recorder.rects.size(), 1U);
+    const auto& rect = recorder.rects.front();
+    EXPECT_LE(rect.x, 0);
+    EXPECT_GE(rect.x + rect.width, 110);
+    EXPECT_LT(rect.width, 150);
+    EXPECT_LT(rect.height, 50);
+
+    move.redo(nullptr);
+    ASSERT_EQ(recorder.rects.size(), 2U);
+    EXPECT_DOUBLE_EQ(recorder.rects.back().x, rect.x);
+    EXPECT_DOUBLE_EQ(recorder.rects.back().width, rect.width);
+
+    recorder.unregisterListener();
+}
@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "util/logger/AsyncLog.h"
+
+using xoj::util::AsyncLog;
+using xoj::util::LogBuffer;
+
+static auto readAll(std::FILE* file) -> std::string {
+    std::string content;
+    std::rewind(file);
+    char buffer[256];
+    size_t read = 0;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) { content.append(buffer, read); }
+    // Before the next lines are written
+    std::fseek(file, 0, SEEK_END);
+    return content;
+}
+
+TEST(LogBuffer, testOrder) {
+    LogBuffer buffer(3);
+    EXPECT_EQ(buffer.getCapacity(), 4);
+
+    int64_t time = 0;
+    std::string line;
+    EXPECT_FALSE(buffer.pop(time, line));
+
+    // Several rounds of the slots
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(buffer.push(i, "first " + std::to_string(i)));
+        EXPECT_TRUE(buffer.push(i + 100, "second"));
+        ASSERT_TRUE(buffer.pop(time, line));
+        EXPECT_EQ(time, i);
+        EXPECT_EQ(line, "first " + std::to_string(i));
+        ASSERT_TRUE(buffer.pop(time, line));
+        EXPECT_EQ(time, i + 100);
+        EXPECT_EQ(line, "second");
+    }
+    EXPECT_FALSE(buffer.pop(time, line));
+}
+
+TEST(LogBuffer, testFullAndTruncated) {
+    LogBuffer buffer(2);
+    EXPECT_TRUE(buffer.push(0, std::string(LogBuffer::LINE_SIZE + 10, 'a')));
+    EXPECT_TRUE(buffer.push(0, "b"));
+    EXPECT_FALSE(buffer.push(0, "c"));
+
+    int64_t time = 0;
+    std::string line;
+    ASSERT_TRUE(buffer.pop(time, line));
+    EXPECT_EQ(line, std::string(LogBuffer::LINE_SIZE, 'a'));
+    EXPECT_TRUE(buffer.push(0, "c"));
+}
+
+TEST(LogBuffer, testConcurrentPush) {
+    LogBuffer buffer(4096);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&buffer, t]() {
+            for (int i = 0; i < 1000; i++) { EXPECT_TRUE(buffer.push(t, std::to_string(i))); }
+        });
+    }
+    for (auto& thread: threads) { thread.join(); }
+
+    // The lines of each thread keep their order
+    std::vector<int> next(4, 0);
+    int64_t time = 0;
+    std::string line;
+    while (buffer.pop(time, line)) {
+        EXPECT_EQ(line, std::to_string(next[static_cast<size_t>(time)]));
+        next[static_cast<size_t>(time)]++;
+    }
+    EXPECT_EQ(next, std::vector<int>(4, 1000));
+}
+
+TEST(AsyncLog, testWrittenByTheBackgroundThread) {
+    g_setenv("G_MESSAGES_DEBUG", AsyncLog::EVENTS_DOMAIN, true);
+    std::FILE* out = std::tmpfile();
+    ASSERT_NE(out, nullptr);
+
+    AsyncLog::start(out);
+    AsyncLog::printf(AsyncLog::Level::Message, "saved %d pages", 3);
+    AsyncLog::event("autosave", {{"ms", 12.5}, {"pages", 3}});
+    AsyncLog::flush();
+    std::string flushed = readAll(out);
+    EXPECT_NE(flushed.find("Message: saved 3 pages\n"), std::string::npos);
+    EXPECT_NE(flushed.find("{\"event\":\"autosave\",\"timeUs\":"), std::string::npos);
+    EXPECT_NE(flushed.find(",\"ms\":12.5,\"pages\":3}\n"), std::string::npos);
+
+    // The debug messages of the other domains are not written
+    AsyncLog::printf(AsyncLog::Level::Debug, "not written");
+    AsyncLog::write(AsyncLog::Level::Warning, "domain", std::string(LogBuffer::LINE_SIZE + 1, 'w').c_str());
+    AsyncLog::stop();
+    std::string stopped = readAll(out);
+    EXPECT_EQ(stopped.find("not written"), std::string::npos);
+    EXPECT_NE(stopped.find("domain-WARNING: " + std::string(LogBuffer::LINE_SIZE + 1, 'w')), std::string::npos);
+    EXPECT_EQ(AsyncLog::getDropped(), 0);
+
+    std::fclose(out);
+    g_unsetenv("G_MESSAGES_DEBUG");
+}
@@ -0,0 +1,52 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "util/CowVector.h"
+
+using xoj::util::CowVector;
+
+TEST(CowVector, testEmpty) {
+    CowVector<int> v;
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(v.size(), 0);
+    EXPECT_EQ(v.begin(), v.end());
+    EXPECT_FALSE(v.isShared());
+}
+
+TEST(CowVector, testCopiesShareUntilModified) {
+    CowVector<int> a(std::vector<int>{1, 2, 3});
+    CowVector<int> b = a;
+    EXPECT_TRUE(a.isShared());
+    EXPECT_EQ(a.data(), b.data());
+
+    b.mut().push_back(4);
+    EXPECT_FALSE(a.isShared());
+    EXPECT_FALSE(b.isShared());
+    EXPECT_NE(a.data(), b.data());
+    EXPECT_EQ(a.get(), (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(b.get(), (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST(CowVector, testMutWithoutCopy) {
+    CowVector<int> a(std::vector<int>{1, 2});
+    const int* data = a.data();
+    a.mut()[0] = 5;
+    // Not shared: modified in place
+    EXPECT_EQ(a.data(), data);
+    EXPECT_EQ(a[0], 5);
+    EXPECT_EQ(a.back(), 2);
+}
+
+TEST(CowVector, testClearKeepsTheCopies) {
+    CowVector<int> a(std::vector<int>{1, 2});
+    CowVector<int> b = a;
+    a.clear();
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(b.size(), 2);
+    EXPECT_FALSE(b.isShared());
+
+    a.mut().push_back(7);
+    EXPECT_EQ(a.size(), 1);
+    EXPECT_EQ(b.size(), 2);
+}
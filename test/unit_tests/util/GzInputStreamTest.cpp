@@ -0,0 +1,118 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include "util/GzInputStream.h"
+#include "util/GzUtil.h"
+#include "util/OutputStream.h"
+
+#include "filesystem.h"
+
+static auto makeData(size_t size) -> std::string {
+    std::string data;
+    for (int i = 0; data.size() < size; i++) {
+        data += "<stroke tool=\"pen\" color=\"#000000ff\" width=\"" + std::to_string(i % 97) + "\">\n";
+    }
+    data.resize(size);
+    return data;
+}
+
+static auto readAll(GzInputStream& in, size_t chunk) -> std::string {
+    std::string data;
+    std::string buffer(chunk, '\0');
+    int64_t read = 0;
+    while ((read = in.read(buffer.data(), buffer.size())) > 0) { data.append(buffer.data(), static_cast<size_t>(read)); }
+    EXPECT_EQ(read, 0) << in.getLastError();
+    return data;
+}
+
+TEST(UtilGzInputStream, testParallelMembers) {
+    const fs::path path = fs::temp_directory_path() / "xournalpp-test-units_UtilGzInputStream_members.gz";
+
+    // Empty, a single member, and more members than inflated at once
+    for (size_t size: {size_t(0), size_t(1000), 40 * GzOutputStream::BLOCK_SIZE + 17}) {
+        std::string data = makeData(size);
+        {
+            GzOutputStream out(path);
+            out.write(data.data(), static_cast<int>(data.size()));
+            out.close();
+            ASSERT_TRUE(out.getLastError().empty());
+        }
+
+        GzInputStream in(path);
+        ASSERT_TRUE(in.isOpen());
+        EXPECT_TRUE(in.isParallel());
+        // Reads not aligned with the members
+        EXPECT_EQ(readAll(in, 12345), data) << size;
+    }
+
+    fs::remove(path);
+}
+
+TEST(UtilGzInputStream, testSingleThreadFallback) {
+    const fs::path path = fs::temp_directory_path() / "xournalpp-test-units_UtilGzInputStream_legacy.gz";
+    std::string data = makeData(3 * GzOutputStream::BLOCK_SIZE);
+
+    // Written by gzwrite, as by the older versions
+    gzFile fp = GzUtil::openPath(path, "w");
+    ASSERT_NE(fp, nullptr);
+    gzwrite(fp, data.data(), static_cast<unsigned int>(data.size()));
+    gzclose(fp);
+    {
+        GzInputStream in(path);
+        ASSERT_TRUE(in.isOpen());
+        EXPECT_FALSE(in.isParallel());
+        EXPECT_EQ(readAll(in, 4096), data);
+    }
+
+    // Not compressed at all
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "<xournal/>";
+    {
+        GzInputStream in(path);
+        ASSERT_TRUE(in.isOpen());
+        EXPECT_FALSE(in.isParallel());
+        EXPECT_EQ(readAll(in, 4096), "<xournal/>");
+    }
+
+    fs::remove(path);
+    GzInputStream missing(path);
+    EXPECT_FALSE(missing.isOpen());
+}
+
+TEST(UtilGzInputStream, testCorruptedMember) {
+    const fs::path path = fs::temp_directory_path() / "xournalpp-test-units_UtilGzInputStream_corrupted.gz";
+    std::string data = makeData(4 * GzOutputStream::BLOCK_SIZE);
+    {
+        GzOutputStream out(path);
+        out.write(data.data(), static_cast<int>(data.size()));
+        out.close();
+    }
+
+    // Flip a byte of the compressed data of the first member
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(GzUtil::MEMBER_HEADER_SIZE + 100);
+        file.put('\xff');
+    }
+
+    GzInputStream in(path);
+    ASSERT_TRUE(in.isParallel());
+    char buffer[4096];
+    EXPECT_EQ(in.read(buffer, sizeof(buffer)), -1);
+    EXPECT_FALSE(in.getLastError().empty());
+
+    fs::remove(path);
+}
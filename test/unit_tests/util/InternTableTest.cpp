@@ -0,0 +1,34 @@
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "util/InternTable.h"
+
+using xoj::util::InternTable;
+
+TEST(InternTable, testEqualValuesAreShared) {
+    InternTable<std::string> table;
+    auto a = table.intern("dashed");
+    auto b = table.intern(std::string("dash") + "ed");
+    auto c = table.intern("dotted");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(*a, "dashed");
+    EXPECT_EQ(table.size(), 2U);
+}
+
+TEST(InternTable, testReleasedValuesAreRemoved) {
+    InternTable<std::string> table;
+    auto a = table.intern("dashed");
+    auto b = a;
+    a.reset();
+    EXPECT_EQ(table.size(), 1U);
+    b.reset();
+    EXPECT_EQ(table.size(), 0U);
+
+    // Interned again after its release
+    auto c = table.intern("dashed");
+    EXPECT_EQ(*c, "dashed");
+    EXPECT_EQ(table.size(), 1U);
+}
@@ -3,6 +3,7 @@
 
 #include <gtest/gtest.h>
 
+#include "util/SmallVector.h"
 #include "util/UnionOfIntervals.h"
 
 TEST(UtilIntervals, testInterval) {
@@ -113,3 +114,26 @@ TEST(UtilIntervals, testUnionOfIntervals) {
         }
     }
 }
+
+TEST(UtilIntervals, testUnionOfIntervalsInSmallVector) {
+    // Crossing the size of the SmallVector both ways
+    UnionOfIntervals<double, SmallVector<double, 4>> intervals;
+    intervals.set(0, 10);
+    EXPECT_TRUE(intervals.intersect(std::vector<double>{1, 2, 3, 4, 5, 6}));
+    EXPECT_EQ(intervals.getData().size(), 6);
+
+    std::vector<double> bounds = {1.5, 5.5};
+    EXPECT_TRUE(intervals.unite(bounds));
+    auto united = intervals.cloneToIntervalVector();
+    ASSERT_EQ(united.size(), 1);
+    EXPECT_EQ(united[0].min, 1);
+    EXPECT_EQ(united[0].max, 6);
+
+    intervals.complement(0, 10);
+    auto complement = intervals.cloneToIntervalVector();
+    ASSERT_EQ(complement.size(), 2);
+    EXPECT_EQ(complement[0].min, 0);
+    EXPECT_EQ(complement[0].max, 1);
+    EXPECT_EQ(complement[1].min, 6);
+    EXPECT_EQ(complement[1].max, 10);
+}
@@ -0,0 +1,41 @@
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "util/Mipmap.h"
+
+using xoj::util::Mipmap;
+
+TEST(UtilMipmap, testLevelByScale) {
+    cairo_surface_t* image = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1024, 512);
+    Mipmap mipmap(image);
+
+    EXPECT_EQ(mipmap.getLevel(1.0), std::make_pair(image, 1));
+    EXPECT_EQ(mipmap.getLevel(0.6), std::make_pair(image, 1));
+
+    auto [half, halfFactor] = mipmap.getLevel(0.5);
+    EXPECT_EQ(halfFactor, 2);
+    EXPECT_EQ(cairo_image_surface_get_width(half), 512);
+    EXPECT_EQ(cairo_image_surface_get_height(half), 256);
+
+    // At least one pixel of the copy per device pixel
+    auto [level, factor] = mipmap.getLevel(0.1);
+    EXPECT_EQ(factor, 8);
+    EXPECT_EQ(cairo_image_surface_get_width(level), 128);
+
+    // The copies are created once
+    EXPECT_EQ(mipmap.getLevel(0.5).first, half);
+
+    // No copy smaller than MIN_SIZE
+    auto [smallest, smallestFactor] = mipmap.getLevel(0.0001);
+    EXPECT_EQ(smallestFactor, 32);
+    EXPECT_EQ(cairo_image_surface_get_height(smallest), 16);
+
+    cairo_surface_destroy(image);
+}
+
+TEST(UtilMipmap, testSmallImageIsNotScaled) {
+    cairo_surface_t* image = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 20, 20);
+    Mipmap mipmap(image);
+    EXPECT_EQ(mipmap.getLevel(0.1), std::make_pair(image, 1));
+    cairo_surface_destroy(image);
+}
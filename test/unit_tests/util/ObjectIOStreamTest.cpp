@@ -349,3 +349,59 @@ TEST(UtilObjectIOStream, testReadStroke) {
         FAIL();
     }
 }
+
+TEST(UtilObjectIOStream, testReadDataVector) {
+    std::vector<double> data{0., 42., -42., 1e50};
+    std::vector<Point> points{Point(1, 2), Point(3, 4, 0.5)};
+
+    ObjectOutputStream outStream(new BinObjectEncoding);
+    outStream.writeData(data);
+    outStream.writeData(points);
+    outStream.writeData(std::vector<float>());
+    outStream.writeData(data);
+    auto gstr = outStream.getStr();
+    std::string str(gstr->str, gstr->len);
+
+    ObjectInputStream stream;
+    EXPECT_TRUE(stream.read(&str[0], (int)str.size()));
+    EXPECT_EQ(stream.readData<double>(), data);
+
+    auto outputPoints = stream.readData<Point>();
+    ASSERT_EQ(outputPoints.size(), points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        EXPECT_TRUE(outputPoints[i].equalsPos(points[i]));
+        EXPECT_EQ(outputPoints[i].z, points[i].z);
+    }
+
+    EXPECT_TRUE(stream.readData<float>().empty());
+
+    // Another element type is an error
+    EXPECT_THROW(stream.readData<float>(), InputStreamException);
+}
+
+TEST(UtilObjectIOStream, testReadManyStrokes) {
+    // Reading checks the bytes left for every value: this stays linear in the size of the stream
+    const int strokeCount = 20000;
+    std::vector<Stroke> strokes(strokeCount);
+    for (int i = 0; i < strokeCount; ++i) {
+        for (int j = 0; j < 50; ++j) { strokes[i].addPoint(Point(i, j, 1.0)); }
+    }
+
+    ObjectOutputStream outStream(new BinObjectEncoding);
+    for (auto&& stroke: strokes) { stroke.serialize(outStream); }
+    auto gstr = outStream.getStr();
+    std::string str(gstr->str, gstr->len);
+
+    ObjectInputStream stream;
+    EXPECT_TRUE(stream.read(&str[0], (int)str.size()));
+    try {
+        for (auto&& stroke: strokes) {
+            Stroke inStroke;
+            inStroke.readSerialized(stream);
+            assertStrokeEquality(stroke, inStroke);
+        }
+    } catch (InputStreamException& e) {
+        std::cerr << "InputStreamException testing many strokes: " << e.what() << std::endl;
+        FAIL();
+    }
+}
@@ -0,0 +1,63 @@
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "util/ObjectPool.h"
+
+using xoj::util::ObjectPool;
+
+TEST(ObjectPool, testBlocksAreContiguous) {
+    ObjectPool pool(40, 16);
+    EXPECT_EQ(pool.getBlockSize() % alignof(std::max_align_t), 0U);
+    EXPECT_GE(pool.getBlockSize(), 40U);
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 16; i++) { blocks.push_back(pool.allocate()); }
+    EXPECT_EQ(pool.getChunkCount(), 1U);
+    EXPECT_EQ(pool.getUsedCount(), 16U);
+    for (size_t i = 1; i < blocks.size(); i++) {
+        EXPECT_EQ(static_cast<unsigned char*>(blocks[i]) - static_cast<unsigned char*>(blocks[i - 1]),
+                  static_cast<std::ptrdiff_t>(pool.getBlockSize()));
+    }
+
+    // The chunk is full
+    void* other = pool.allocate();
+    EXPECT_EQ(pool.getChunkCount(), 2U);
+    pool.deallocate(other);
+
+    for (void* block: blocks) { pool.deallocate(block); }
+    EXPECT_EQ(pool.getUsedCount(), 0U);
+}
+
+TEST(ObjectPool, testFreedBlocksAreReused) {
+    ObjectPool pool(sizeof(double), 4);
+    void* a = pool.allocate();
+    void* b = pool.allocate();
+    pool.deallocate(a);
+    EXPECT_EQ(pool.allocate(), a);
+
+    pool.deallocate(a);
+    pool.deallocate(b);
+    // The most recently freed first
+    EXPECT_EQ(pool.allocate(), b);
+    EXPECT_EQ(pool.allocate(), a);
+    EXPECT_EQ(pool.getChunkCount(), 1U);
+
+    std::set<void*> blocks{a, b};
+    for (int i = 0; i < 10; i++) { EXPECT_TRUE(blocks.insert(pool.allocate()).second); }
+    EXPECT_EQ(pool.getUsedCount(), 12U);
+    EXPECT_EQ(pool.getChunkCount(), 3U);
+    for (void* block: blocks) { pool.deallocate(block); }
+}
+
+TEST(ObjectPool, testSmallObjects) {
+    ObjectPool pool(1);
+    EXPECT_GE(pool.getBlockSize(), sizeof(void*));
+    auto* p = static_cast<char*>(pool.allocate());
+    *p = 'x';
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % alignof(std::max_align_t), 0U);
+    pool.deallocate(p);
+    pool.deallocate(nullptr);
+}
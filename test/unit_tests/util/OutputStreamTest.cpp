@@ -0,0 +1,69 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <algorithm>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include "util/GzUtil.h"
+#include "util/OutputStream.h"
+
+#include "filesystem.h"
+
+static auto readGz(const fs::path& path) -> std::string {
+    gzFile fp = GzUtil::openPath(path, "r");
+    EXPECT_NE(fp, nullptr);
+    if (!fp) {
+        return "";
+    }
+
+    std::string data;
+    char buffer[4096];
+    int read = 0;
+    while ((read = gzread(fp, buffer, sizeof(buffer))) > 0) {
+        data.append(buffer, static_cast<size_t>(read));
+    }
+    int error = Z_OK;
+    gzerror(fp, &error);
+    EXPECT_EQ(error, Z_OK);
+    gzclose(fp);
+    return data;
+}
+
+TEST(UtilOutputStream, testGzOutputStreamBlocks) {
+    const fs::path path = fs::temp_directory_path() / "xournalpp-test-units_UtilOutputStream_blocks.gz";
+
+    // Empty, a single block, and several blocks compressed in parallel
+    for (size_t size: {size_t(0), size_t(1000), GzOutputStream::BLOCK_SIZE, 5 * GzOutputStream::BLOCK_SIZE + 17}) {
+        std::string data;
+        for (int i = 0; data.size() < size; i++) {
+            data += "<stroke tool=\"pen\" color=\"#000000ff\" width=\"" + std::to_string(i % 97) + "\">\n";
+        }
+        data.resize(size);
+
+        {
+            GzOutputStream out(path);
+            ASSERT_TRUE(out.getLastError().empty());
+            // Writes not aligned with the blocks
+            for (size_t pos = 0; pos < data.size(); pos += 12345) {
+                out.write(data.data() + pos, static_cast<int>(std::min<size_t>(12345, data.size() - pos)));
+            }
+            out.close();
+            EXPECT_TRUE(out.getLastError().empty());
+        }
+
+        EXPECT_EQ(readGz(path), data) << size;
+    }
+
+    fs::remove(path);
+}
@@ -0,0 +1,37 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "util/ParallelLoop.h"
+
+TEST(UtilParallelLoop, testEachIterationOnce) {
+    xoj::util::ParallelLoop loop(4);
+    for (size_t count: {0, 1, 2, 7, 1000}) {
+        std::vector<std::atomic<int>> calls(count);
+        loop.run(count, [&](size_t i) { calls[i]++; });
+        for (size_t i = 0; i < count; i++) {
+            EXPECT_EQ(calls[i], 1) << i << " of " << count;
+        }
+    }
+}
+
+TEST(UtilParallelLoop, testManyLoops) {
+    xoj::util::ParallelLoop loop;
+    std::atomic<size_t> sum{0};
+    for (int round = 0; round < 2000; round++) {
+        loop.run(16, [&](size_t i) { sum += i; });
+    }
+    EXPECT_EQ(sum, 2000 * (15 * 16 / 2));
+}
@@ -0,0 +1,53 @@
+#include <cstdint>
+#include <vector>
+
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "util/PngWriter.h"
+
+#include "filesystem.h"
+
+using xoj::util::PngWriter;
+
+TEST(PngWriter, testRowsAreReadBackByCairo) {
+    const fs::path file = fs::temp_directory_path() / "xournalpp-test-units_PngWriter.png";
+    constexpr uint32_t width = 300;
+    constexpr uint32_t height = 200;
+
+    // Opaque gradients, so that the unpremultiplication is exact
+    auto pixel = [](uint32_t x, uint32_t y) -> uint32_t {
+        return 0xff000000U | ((x * 255 / width) << 16U) | ((y * 255 / height) << 8U) | ((x * y) % 256);
+    };
+
+    PngWriter writer(file, width, height);
+    std::vector<uint32_t> row(width);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) { row[x] = pixel(x, y); }
+        ASSERT_TRUE(writer.writeRow(row.data())) << writer.getLastError();
+    }
+    ASSERT_TRUE(writer.close()) << writer.getLastError();
+
+    cairo_surface_t* surface = cairo_image_surface_create_from_png(file.u8string().c_str());
+    ASSERT_EQ(cairo_surface_status(surface), CAIRO_STATUS_SUCCESS);
+    ASSERT_EQ(cairo_image_surface_get_width(surface), static_cast<int>(width));
+    ASSERT_EQ(cairo_image_surface_get_height(surface), static_cast<int>(height));
+    const unsigned char* data = cairo_image_surface_get_data(surface);
+    const int stride = cairo_image_surface_get_stride(surface);
+    for (uint32_t y = 0; y < height; y++) {
+        const auto* read = reinterpret_cast<const uint32_t*>(data + y * stride);
+        for (uint32_t x = 0; x < width; x++) { ASSERT_EQ(read[x], pixel(x, y)) << x << ", " << y; }
+    }
+    cairo_surface_destroy(surface);
+    fs::remove(file);
+}
+
+TEST(PngWriter, testMissingRowsAreAnError) {
+    const fs::path file = fs::temp_directory_path() / "xournalpp-test-units_PngWriter_incomplete.png";
+    PngWriter writer(file, 4, 4);
+    std::vector<uint32_t> row(4, 0xff0000ffU);
+    EXPECT_TRUE(writer.writeRow(row.data()));
+    EXPECT_FALSE(writer.close());
+    EXPECT_FALSE(writer.getLastError().empty());
+    fs::remove(file);
+}
@@ -0,0 +1,111 @@
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "util/Profiler.h"
+
+using xoj::util::Profiler;
+using namespace std::chrono_literals;
+
+TEST(Profiler, testNothingIsRecordedWhenDisabled) {
+    Profiler profiler;
+    profiler.addTiming("task", "test", Profiler::Clock::now(), 1ms);
+    profiler.setCounter("queue", 3);
+    profiler.countAccess("cache", true);
+
+    EXPECT_TRUE(profiler.getTimings().empty());
+    EXPECT_TRUE(profiler.getCounters().empty());
+    EXPECT_TRUE(profiler.getCacheAccesses().empty());
+}
+
+TEST(Profiler, testTimingsAreSummedUp) {
+    Profiler profiler;
+    profiler.setEnabled(true);
+    auto now = Profiler::Clock::now();
+    profiler.addTiming("task", "test", now, 2ms);
+    profiler.addTiming("task", "test", now, 4ms);
+
+    auto timings = profiler.getTimings();
+    ASSERT_EQ(timings.count("task"), 1U);
+    EXPECT_EQ(timings["task"].count, 2U);
+    EXPECT_DOUBLE_EQ(timings["task"].totalMs, 6.0);
+    EXPECT_DOUBLE_EQ(timings["task"].maxMs, 4.0);
+    EXPECT_DOUBLE_EQ(timings["task"].lastMs, 4.0);
+
+    profiler.reset();
+    EXPECT_TRUE(profiler.getTimings().empty());
+}
+
+TEST(Profiler, testCountersAndCacheAccesses) {
+    Profiler profiler;
+    profiler.setEnabled(true);
+    profiler.setCounter("queue", 3);
+    profiler.setCounter("queue", 1);
+    profiler.countAccess("cache", true);
+    profiler.countAccess("cache", true);
+    profiler.countAccess("cache", false);
+
+    EXPECT_EQ(profiler.getCounters()["queue"], 1);
+    auto accesses = profiler.getCacheAccesses()["cache"];
+    EXPECT_EQ(accesses.hits, 2U);
+    EXPECT_EQ(accesses.misses, 1U);
+
+    auto summary = profiler.getSummary();
+    ASSERT_EQ(summary.size(), 2U);
+    EXPECT_EQ(summary[0], "queue: 1");
+    EXPECT_EQ(summary[1], "cache: 66.7% hits (3)");
+}
+
+TEST(Profiler, testInputLatencyIsMeasuredOnce) {
+    Profiler profiler;
+    profiler.setEnabled(true);
+
+    // A paint without input is not a latency
+    profiler.markPainted();
+    EXPECT_TRUE(profiler.getTimings().empty());
+
+    profiler.markInput();
+    profiler.markInput();
+    profiler.markPainted();
+    profiler.markPainted();
+    EXPECT_EQ(profiler.getTimings()[Profiler::INPUT_TO_PAINT].count, 1U);
+}
+
+TEST(Profiler, testQueuedDrawAndPaintAreMeasuredSeparately) {
+    Profiler profiler;
+    profiler.setEnabled(true);
+
+    profiler.markInput();
+    profiler.markDrawQueued();
+    profiler.markDrawQueued();
+    EXPECT_EQ(profiler.getTimings().count(Profiler::INPUT_TO_PAINT), 0U);
+
+    profiler.markPainted();
+    auto timings = profiler.getTimings();
+    EXPECT_EQ(timings[Profiler::INPUT_TO_QUEUE_DRAW].count, 1U);
+    EXPECT_EQ(timings[Profiler::INPUT_TO_PAINT].count, 1U);
+    EXPECT_LE(timings[Profiler::INPUT_TO_QUEUE_DRAW].totalMs, timings[Profiler::INPUT_TO_PAINT].totalMs);
+}
+
+TEST(Profiler, testTraceAndCsv) {
+    Profiler profiler;
+    profiler.setEnabled(true);
+    profiler.addTiming("task", "test", Profiler::Clock::now(), 1500us);
+    profiler.setCounter("queue", 2);
+    profiler.countAccess("cache", false);
+
+    std::ostringstream trace;
+    profiler.writeTrace(trace);
+    EXPECT_NE(trace.str().find("\"name\":\"task\",\"cat\":\"test\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(trace.str().find("\"dur\":1500"), std::string::npos);
+    EXPECT_NE(trace.str().find("\"ph\":\"C\""), std::string::npos);
+    EXPECT_NE(trace.str().find("\"args\":{\"value\":2}"), std::string::npos);
+
+    std::ostringstream csv;
+    profiler.writeCsv(csv);
+    EXPECT_EQ(csv.str(), "name,count,total ms,average ms,max ms,hits,misses\n"
+                         "\"task\",1,1.500,1.500,1.500,,\n"
+                         "\"cache\",,,,,0,1\n");
+}
@@ -0,0 +1,34 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "util/Rectangle.h"
+
+using xoj::util::Rectangle;
+
+TEST(Rectangle, testMergeOverlappingRectangles) {
+    std::vector<Rectangle<double>> rects{{0, 0, 10, 10}, {5, 5, 10, 10}, {2, 2, 2, 2}, {12, 0, 3, 3}};
+    xoj::util::mergeRectangles(rects, 1.5);
+
+    ASSERT_EQ(rects.size(), 1U);
+    EXPECT_DOUBLE_EQ(rects[0].x, 0);
+    EXPECT_DOUBLE_EQ(rects[0].y, 0);
+    EXPECT_DOUBLE_EQ(rects[0].width, 15);
+    EXPECT_DOUBLE_EQ(rects[0].height, 15);
+}
+
+TEST(Rectangle, testMergeAdjacentRectangles) {
+    std::vector<Rectangle<double>> rects{{0, 0, 10, 10}, {10, 0, 10, 10}};
+    xoj::util::mergeRectangles(rects, 1.0);
+
+    ASSERT_EQ(rects.size(), 1U);
+    EXPECT_DOUBLE_EQ(rects[0].width, 20);
+    EXPECT_DOUBLE_EQ(rects[0].height, 10);
+}
+
+TEST(Rectangle, testDistantRectanglesAreKept) {
+    std::vector<Rectangle<double>> rects{{0, 0, 10, 10}, {100, 100, 10, 10}, {0, 100, 10, 10}};
+    xoj::util::mergeRectangles(rects, 1.5);
+
+    EXPECT_EQ(rects.size(), 3U);
+}
@@ -0,0 +1,69 @@
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "util/SurfacePool.h"
+
+using xoj::util::SurfacePool;
+
+TEST(SurfacePool, testBufferIsReused) {
+    SurfacePool pool;
+    cairo_surface_t* surface = pool.create(CAIRO_FORMAT_ARGB32, 256, 256);
+    ASSERT_EQ(cairo_surface_status(surface), CAIRO_STATUS_SUCCESS);
+    EXPECT_EQ(cairo_image_surface_get_width(surface), 256);
+    EXPECT_EQ(cairo_image_surface_get_height(surface), 256);
+    unsigned char* data = cairo_image_surface_get_data(surface);
+
+    cairo_t* cr = cairo_create(surface);
+    cairo_set_source_rgba(cr, 1, 0, 0, 1);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    EXPECT_EQ(pool.getIdleBytes(), 0U);
+    cairo_surface_destroy(surface);
+    EXPECT_GE(pool.getIdleBytes(), 256U * 256U * 4U);
+
+    // A slightly smaller surface is in the same size class, and gets the buffer cleared
+    surface = pool.create(CAIRO_FORMAT_ARGB32, 250, 256);
+    EXPECT_EQ(cairo_image_surface_get_data(surface), data);
+    EXPECT_EQ(pool.getIdleBytes(), 0U);
+    cairo_surface_flush(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+    for (int y = 0; y < 256; y += 17) {
+        for (int x = 0; x < 250 * 4; x += 13) { ASSERT_EQ(data[y * stride + x], 0); }
+    }
+    cairo_surface_destroy(surface);
+}
+
+TEST(SurfacePool, testSmallSurfacesAreNotPooled) {
+    SurfacePool pool;
+    cairo_surface_t* surface = pool.create(CAIRO_FORMAT_ARGB32, 8, 8);
+    EXPECT_EQ(cairo_surface_status(surface), CAIRO_STATUS_SUCCESS);
+    cairo_surface_destroy(surface);
+    EXPECT_EQ(pool.getIdleBytes(), 0U);
+}
+
+TEST(SurfacePool, testBudget) {
+    // Room for four 128x128 ARGB buffers, and too small to keep a 512x512 one
+    SurfacePool pool(4 * 128 * 128 * 4);
+    cairo_surface_t* surface1 = pool.create(CAIRO_FORMAT_ARGB32, 128, 128);
+    cairo_surface_t* surface2 = pool.create(CAIRO_FORMAT_ARGB32, 128, 128);
+    cairo_surface_t* large = pool.create(CAIRO_FORMAT_ARGB32, 512, 512);
+    cairo_surface_destroy(surface1);
+    cairo_surface_destroy(surface2);
+    cairo_surface_destroy(large);
+    EXPECT_LE(pool.getIdleBytes(), 4U * 128U * 128U * 4U);
+    EXPECT_GT(pool.getIdleBytes(), 0U);
+
+    pool.setMaxBytes(0);
+    EXPECT_EQ(pool.getIdleBytes(), 0U);
+}
+
+TEST(SurfacePool, testSurfaceOutlivesThePool) {
+    cairo_surface_t* surface = nullptr;
+    {
+        SurfacePool pool;
+        surface = pool.create(CAIRO_FORMAT_A8, 512, 512);
+    }
+    EXPECT_EQ(cairo_surface_status(surface), CAIRO_STATUS_SUCCESS);
+    cairo_surface_destroy(surface);
+}
@@ -363,3 +363,45 @@ TEST(UtilsVectors, testSmallVectorCopyMove) {
     }
     EXPECT_EQ(TestData::nbData, 0);
 }
+
+TEST(UtilsVectors, testSmallVectorInsertErase) {
+    TestData::nbData = 0;
+    {
+        SmallVector<TestData, 3> vec{TestData(1.0, 1.0), TestData(3.0, 3.0)};
+        auto it = vec.insert(std::next(vec.begin()), TestData(2.0, 2.0));
+        EXPECT_EQ(*it, TestData(2.0, 2.0));
+        EXPECT_EQ(vec.size(), 3);
+        EXPECT_EQ(TestData::nbData, 3);
+
+        // From the stack to the heap
+        it = vec.insert(vec.begin(), TestData(0.0, 0.0));
+        EXPECT_EQ(*it, TestData(0.0, 0.0));
+        vec.insert(vec.end(), TestData(4.0, 4.0));
+        EXPECT_EQ(vec.size(), 5);
+        EXPECT_EQ(TestData::nbData, 5);
+        for (size_t i = 0; i < vec.size(); i++) { EXPECT_EQ(vec[i].t, static_cast<double>(i)); }
+
+        // An element of the vector itself
+        vec.insert(vec.begin(), vec.back());
+        EXPECT_EQ(vec.front(), TestData(4.0, 4.0));
+        EXPECT_EQ(TestData::nbData, 6);
+
+        // Back from the heap to the stack
+        it = vec.erase(vec.begin(), std::next(vec.begin(), 3));
+        EXPECT_EQ(*it, TestData(2.0, 2.0));
+        EXPECT_EQ(vec.size(), 3);
+        EXPECT_EQ(TestData::nbData, 3);
+
+        it = vec.erase(std::next(vec.begin()));
+        EXPECT_EQ(*it, TestData(4.0, 4.0));
+        EXPECT_EQ(vec.size(), 2);
+        EXPECT_EQ(vec.front(), TestData(2.0, 2.0));
+        EXPECT_EQ(TestData::nbData, 2);
+
+        it = vec.erase(vec.begin(), vec.end());
+        EXPECT_EQ(it, vec.end());
+        EXPECT_TRUE(vec.empty());
+        EXPECT_EQ(TestData::nbData, 0);
+    }
+    EXPECT_EQ(TestData::nbData, 0);
+}
@@ -0,0 +1,39 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "util/Util.h"
+
+TEST(UtilFormat, testFormatCoordinate) {
+    // The files written have to stay the same as with g_ascii_formatd()
+    auto check = [](double value) {
+        char expected[G_ASCII_DTOSTR_BUF_SIZE];
+        g_ascii_formatd(expected, G_ASCII_DTOSTR_BUF_SIZE, Util::PRECISION_FORMAT_STRING, value);
+
+        char buffer[G_ASCII_DTOSTR_BUF_SIZE];
+        char* end = Util::formatCoordinate(buffer, value);
+        EXPECT_EQ(std::string(buffer, end), std::string(expected)) << value;
+    };
+
+    for (double value: {0.0, -0.0, 1.0, -1.0, 0.5e-8, 1.5e-8, 2.5e-8, 123.456789125, 595.27559055, 1e20, 1e29, 1e30,
+                        -1e30, 1e300, std::numeric_limits<double>::infinity()}) {
+        check(value);
+    }
+    for (int i = -2000; i < 2000; i++) {
+        check(i * 0.123456789);
+        check(std::ldexp(i, i / 40));
+    }
+}
@@ -11,12 +11,16 @@
 
 #include <cstdlib>
 #include <ctime>
+#include <string>
 
+#include <glib.h>
 #include <gtest/gtest.h>
+#include <zlib.h>
 
 #include "util/XojPreviewExtractor.h"
 
 #include "config-test.h"
+#include "filesystem.h"
 
 
 using namespace std;
@@ -104,3 +108,28 @@ TEST(UtilXojPreviewExtractor, testInvalidFile) {
 
     EXPECT_EQ(PREVIEW_RESULT_ERROR_READING_PREVIEW, result);
 }
+
+TEST(UtilXojPreviewExtractor, testLoadLargeGzippedPreview) {
+    // Larger than the first chunk read from the file
+    std::string image(30000, 'x');
+    gchar* encoded = g_base64_encode(reinterpret_cast<const guchar*>(image.data()), image.size());
+
+    auto file = fs::temp_directory_path() / "xournalpp-large-preview-test.xoj";
+    gzFile fp = gzopen(file.u8string().c_str(), "w");
+    ASSERT_NE(fp, nullptr);
+    gzputs(fp, "<?xml version=\"1.0\" standalone=\"no\"?>\n<xournal version=\"0.4.8\">\n<preview>");
+    gzputs(fp, encoded);
+    gzputs(fp, "</preview>\n<page width=\"612.00\" height=\"792.00\"></page>\n</xournal>\n");
+    gzclose(fp);
+    g_free(encoded);
+
+    XojPreviewExtractor extractor;
+    PreviewExtractResult result = extractor.readFile(file);
+    fs::remove(file);
+
+    EXPECT_EQ(PREVIEW_RESULT_IMAGE_READ, result);
+
+    gsize dataLen = 0;
+    unsigned char* imageData = extractor.getData(dataLen);
+    EXPECT_EQ(image, string((char*)imageData, (size_t)dataLen));
+}
@@ -0,0 +1,111 @@
+#include <string>
+
+#include <cairo-svg.h>
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "view/background/BackgroundPatternCache.h"
+
+using xoj::view::BackgroundPatternCache;
+
+static auto makeCell(double size, int* paintCount) -> BackgroundPatternCache::Cell {
+    return {"test", {1.0}, Color(0x000000U), size, size, [paintCount](cairo_t* cr) {
+                (*paintCount)++;
+                cairo_move_to(cr, 0, 0);
+                cairo_line_to(cr, 0, 0);
+                cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+                cairo_stroke(cr);
+            }};
+}
+
+TEST(BackgroundPatternCache, testCellIsRasterizedOncePerZoomLevel) {
+    BackgroundPatternCache cache;
+    int paintCount = 0;
+    auto cell = makeCell(10, &paintCount);
+
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    cairo_t* cr = cairo_create(surface);
+    cairo_scale(cr, 2, 2);
+
+    cairo_pattern_t* pattern = cache.createPattern(cr, cell, 0, 0);
+    ASSERT_NE(pattern, nullptr);
+    cairo_pattern_destroy(pattern);
+    EXPECT_EQ(paintCount, 1);
+    EXPECT_EQ(cache.getSize(), 1U);
+
+    // About the same zoom
+    cairo_scale(cr, 1.01, 1.01);
+    pattern = cache.createPattern(cr, cell, 5, 5);
+    ASSERT_NE(pattern, nullptr);
+    cairo_pattern_destroy(pattern);
+    EXPECT_EQ(paintCount, 1);
+
+    // Another zoom, or another cell
+    cairo_scale(cr, 2, 2);
+    cairo_pattern_destroy(cache.createPattern(cr, cell, 0, 0));
+    EXPECT_EQ(paintCount, 2);
+    cell.params = {2.0};
+    cairo_pattern_destroy(cache.createPattern(cr, cell, 0, 0));
+    EXPECT_EQ(paintCount, 3);
+    EXPECT_EQ(cache.getSize(), 3U);
+
+    cache.clear();
+    EXPECT_EQ(cache.getSize(), 0U);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+}
+
+TEST(BackgroundPatternCache, testVectorTargetsAreNotRasterized) {
+    BackgroundPatternCache cache;
+    int paintCount = 0;
+    auto cell = makeCell(10, &paintCount);
+
+    cairo_surface_t* surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+    cairo_t* cr = cairo_create(surface);
+    EXPECT_EQ(cache.createPattern(cr, cell, 0, 0), nullptr);
+    EXPECT_EQ(paintCount, 0);
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+}
+
+TEST(BackgroundPatternCache, testTinyAndHugeCellsAreNotRasterized) {
+    BackgroundPatternCache cache;
+    int paintCount = 0;
+
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 10, 10);
+    cairo_t* cr = cairo_create(surface);
+    EXPECT_EQ(cache.createPattern(cr, makeCell(1, &paintCount), 0, 0), nullptr);
+    EXPECT_EQ(cache.createPattern(cr, makeCell(10000, &paintCount), 0, 0), nullptr);
+    EXPECT_EQ(paintCount, 0);
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+}
+
+TEST(BackgroundPatternCache, testSvgTargetsRepeatTheVectorCell) {
+    BackgroundPatternCache cache;
+    int paintCount = 0;
+    auto cell = makeCell(10, &paintCount);
+
+    std::string svg;
+    cairo_surface_t* surface = cairo_svg_surface_create_for_stream(
+            [](void* closure, const unsigned char* data, unsigned int length) {
+                static_cast<std::string*>(closure)->append(reinterpret_cast<const char*>(data), length);
+                return CAIRO_STATUS_SUCCESS;
+            },
+            &svg, 100, 100);
+    cairo_t* cr = cairo_create(surface);
+    cairo_pattern_t* pattern = cache.createPattern(cr, cell, 0, 0);
+    ASSERT_NE(pattern, nullptr);
+    EXPECT_EQ(paintCount, 1);
+    EXPECT_EQ(cache.getSize(), 0U);
+
+    cairo_set_source(cr, pattern);
+    cairo_paint(cr);
+    cairo_pattern_destroy(pattern);
+    cairo_destroy(cr);
+    cairo_surface_finish(surface);
+    cairo_surface_destroy(surface);
+
+    EXPECT_NE(svg.find("<pattern"), std::string::npos);
+}
@@ -0,0 +1,106 @@
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "view/PressureOutline.h"
+
+using xoj::view::PressureOutline;
+
+namespace {
+/**
+ * @return The types of the elements of the path, and their end points
+ */
+auto elementsOf(const cairo_path_t* path) -> std::vector<std::pair<cairo_path_data_type_t, Point>> {
+    std::vector<std::pair<cairo_path_data_type_t, Point>> elements;
+    for (int i = 0; i < path->num_data; i += path->data[i].header.length) {
+        const auto& header = path->data[i].header;
+        Point p;
+        if (header.length > 1) {
+            const auto& point = path->data[i + header.length - 1].point;
+            p = Point(point.x, point.y);
+        }
+        elements.emplace_back(header.type, p);
+    }
+    return elements;
+}
+}  // namespace
+
+TEST(PressureOutline, testButtSegment) {
+    PressureOutline outline({Point(0, 0), Point(10, 0)}, 2, StrokeCapStyle::BUTT);
+    auto elements = elementsOf(outline.get());
+
+    ASSERT_EQ(elements.size(), 5);
+    EXPECT_EQ(elements[0].first, CAIRO_PATH_MOVE_TO);
+    EXPECT_EQ(elements[4].first, CAIRO_PATH_CLOSE_PATH);
+
+    const std::vector<std::pair<double, double>> expected = {{0, 1}, {10, 1}, {10, -1}, {0, -1}};
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_DOUBLE_EQ(elements[i].second.x, expected[i].first) << i;
+        EXPECT_DOUBLE_EQ(elements[i].second.y, expected[i].second) << i;
+    }
+}
+
+TEST(PressureOutline, testWidthOfEachSegment) {
+    PressureOutline outline({Point(0, 0, 2), Point(10, 0, 4), Point(20, 0, 6)}, 1, StrokeCapStyle::BUTT);
+    auto elements = elementsOf(outline.get());
+
+    // Each segment has the width of its first point, the last point has no segment
+    ASSERT_EQ(elements.size(), 9);
+    EXPECT_DOUBLE_EQ(elements[1].second.y, 1);
+    EXPECT_DOUBLE_EQ(elements[2].second.y, 2);
+    EXPECT_DOUBLE_EQ(elements[3].second.y, 2);
+    EXPECT_DOUBLE_EQ(elements[4].second.y, -2);
+    EXPECT_DOUBLE_EQ(elements[7].second.y, -1);
+}
+
+TEST(PressureOutline, testRoundCaps) {
+    PressureOutline outline({Point(0, 0), Point(5, 0), Point(5, 0), Point(10, 0)}, 2, StrokeCapStyle::ROUND);
+    auto elements = elementsOf(outline.get());
+
+    double minX = 0;
+    double maxX = 0;
+    int curves = 0;
+    for (auto& [type, p]: elements) {
+        if (type != CAIRO_PATH_CLOSE_PATH) {
+            minX = std::min(minX, p.x);
+            maxX = std::max(maxX, p.x);
+            EXPECT_LE(std::abs(p.y), 1 + 1e-9);
+        }
+        curves += type == CAIRO_PATH_CURVE_TO;
+    }
+    EXPECT_DOUBLE_EQ(minX, -1);
+    EXPECT_DOUBLE_EQ(maxX, 11);
+    // The duplicated point does not add a join, each cap is a half circle
+    EXPECT_EQ(curves, 4);
+}
+
+TEST(PressureOutline, testOuterJoinIsRound) {
+    // A right angle: the outer side goes around the corner at the distance of half the width
+    PressureOutline outline({Point(0, 0), Point(10, 0), Point(10, 10)}, 2, StrokeCapStyle::BUTT);
+    auto elements = elementsOf(outline.get());
+
+    int curves = 0;
+    for (auto& [type, p]: elements) {
+        if (type == CAIRO_PATH_CURVE_TO) {
+            curves++;
+            EXPECT_NEAR(std::hypot(p.x - 10, p.y), 1, 1e-9);
+        }
+    }
+    EXPECT_EQ(curves, 2);
+}
+
+TEST(PressureOutline, testDot) {
+    PressureOutline outline({Point(3, 4, 2), Point(3, 4, 2)}, 1, StrokeCapStyle::ROUND);
+    auto elements = elementsOf(outline.get());
+
+    ASSERT_EQ(elements.size(), 6);
+    for (size_t i = 1; i < 5; i++) {
+        EXPECT_EQ(elements[i].first, CAIRO_PATH_CURVE_TO);
+        EXPECT_NEAR(std::hypot(elements[i].second.x - 3, elements[i].second.y - 4), 1, 1e-9);
+    }
+
+    PressureOutline butt({Point(3, 4)}, 1, StrokeCapStyle::BUTT);
+    EXPECT_EQ(butt.get()->num_data, 0);
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "model/Stroke.h"
+#include "model/StrokeStyle.h"
+#include "view/StrokeView.h"
+
+using xoj::view::Context;
+using xoj::view::StrokeView;
+
+namespace {
+void initStroke(Stroke& s) {
+    s.setWidth(1.41);
+    s.setColor(Color(0xff0000U));
+    s.addPoint(Point(0, 0));
+    s.addPoint(Point(10, 10));
+}
+}  // namespace
+
+TEST(StrokeBatch, testBatchable) {
+    auto ctx = Context::createDefault(nullptr);
+
+    Stroke pen;
+    initStroke(pen);
+    EXPECT_TRUE(StrokeView::isBatchable(&pen, ctx));
+
+    Stroke highlighter;
+    initStroke(highlighter);
+    highlighter.setToolType(STROKE_TOOL_HIGHLIGHTER);
+    EXPECT_FALSE(StrokeView::isBatchable(&highlighter, ctx));
+
+    Stroke filled;
+    initStroke(filled);
+    filled.setFill(128);
+    EXPECT_FALSE(StrokeView::isBatchable(&filled, ctx));
+
+    Stroke pressure;
+    initStroke(pressure);
+    pressure.setPressure({1});
+    EXPECT_FALSE(StrokeView::isBatchable(&pressure, ctx));
+
+    // Strokes without audio are faded out with a mask
+    ctx.fadeOutNonAudio = xoj::view::FADE_OUT_NON_AUDIO_;
+    EXPECT_FALSE(StrokeView::isBatchable(&pen, ctx));
+}
+
+TEST(StrokeBatch, testSameStyle) {
+    Stroke s1;
+    Stroke s2;
+    initStroke(s1);
+    initStroke(s2);
+    EXPECT_TRUE(StrokeView::haveSameStyle(&s1, &s2));
+
+    s2.setLineStyle(StrokeStyle::parseStyle("dash"));
+    EXPECT_FALSE(StrokeView::haveSameStyle(&s1, &s2));
+    s1.setLineStyle(StrokeStyle::parseStyle("dash"));
+    EXPECT_TRUE(StrokeView::haveSameStyle(&s1, &s2));
+
+    s2.setStrokeCapStyle(StrokeCapStyle::BUTT);
+    EXPECT_FALSE(StrokeView::haveSameStyle(&s1, &s2));
+    s2.setStrokeCapStyle(StrokeCapStyle::ROUND);
+
+    s2.setWidth(2);
+    EXPECT_FALSE(StrokeView::haveSameStyle(&s1, &s2));
+    s2.setWidth(1.41);
+
+    s2.setColor(Color(0x00ff00U));
+    EXPECT_FALSE(StrokeView::haveSameStyle(&s1, &s2));
+}
+
+TEST(StrokeBatch, testHighlighterBatchable) {
+    auto ctx = Context::createDefault(nullptr);
+
+    Stroke highlighter;
+    initStroke(highlighter);
+    highlighter.setToolType(STROKE_TOOL_HIGHLIGHTER);
+    EXPECT_TRUE(StrokeView::isHighlighterBatchable(&highlighter, ctx));
+
+    Stroke pen;
+    initStroke(pen);
+    EXPECT_FALSE(StrokeView::isHighlighterBatchable(&pen, ctx));
+
+    // Filled and pressure sensitive highlighters share the mask too
+    Stroke filled;
+    initStroke(filled);
+    filled.setToolType(STROKE_TOOL_HIGHLIGHTER);
+    filled.setFill(128);
+    filled.setPressure({1});
+    EXPECT_TRUE(StrokeView::isHighlighterBatchable(&filled, ctx));
+    EXPECT_FALSE(StrokeView::haveSameHighlighterStyle(&highlighter, &filled));
+    highlighter.setFill(128);
+    EXPECT_TRUE(StrokeView::haveSameHighlighterStyle(&highlighter, &filled));
+    highlighter.setColor(Color(0x00ff00U));
+    EXPECT_FALSE(StrokeView::haveSameHighlighterStyle(&highlighter, &filled));
+
+    // Only the alpha is painted on a colorblind mask
+    EXPECT_FALSE(StrokeView::isHighlighterBatchable(&filled, Context::createColorBlind(nullptr)));
+
+    ctx.fadeOutNonAudio = xoj::view::FADE_OUT_NON_AUDIO_;
+    EXPECT_FALSE(StrokeView::isHighlighterBatchable(&filled, ctx));
+}
+
+TEST(StrokeBatch, testPressureBatchable) {
+    auto ctx = Context::createDefault(nullptr);
+
+    Stroke pressure;
+    initStroke(pressure);
+    pressure.setPressure({1});
+    EXPECT_TRUE(StrokeView::isPressureBatchable(&pressure, ctx));
+
+    Stroke pen;
+    initStroke(pen);
+    EXPECT_FALSE(StrokeView::isPressureBatchable(&pen, ctx));
+
+    // Each segment of a dashed stroke is drawn with its own width
+    Stroke dashed;
+    initStroke(dashed);
+    dashed.setPressure({1});
+    dashed.setLineStyle(StrokeStyle::parseStyle("dash"));
+    EXPECT_FALSE(StrokeView::isPressureBatchable(&dashed, ctx));
+
+    Stroke highlighter;
+    initStroke(highlighter);
+    highlighter.setToolType(STROKE_TOOL_HIGHLIGHTER);
+    highlighter.setPressure({1});
+    EXPECT_FALSE(StrokeView::isPressureBatchable(&highlighter, ctx));
+
+    // The width of the outline comes from the pressure
+    Stroke wider;
+    initStroke(wider);
+    wider.setWidth(3);
+    wider.setPressure({2});
+    EXPECT_TRUE(StrokeView::haveSamePressureStyle(&pressure, &wider));
+    wider.setColor(Color(0x00ff00U));
+    EXPECT_FALSE(StrokeView::haveSamePressureStyle(&pressure, &wider));
+
+    ctx.fadeOutNonAudio = xoj::view::FADE_OUT_NON_AUDIO_;
+    EXPECT_FALSE(StrokeView::isPressureBatchable(&pressure, ctx));
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include "view/StrokeView.h"
+
+using xoj::view::StrokeView;
+
+TEST(StrokeDash, testGap) {
+    // A dash of 6, a gap of 3
+    const double dashes[] = {6, 3};
+    EXPECT_FALSE(StrokeView::isInDashGap(dashes, 2, 0, 1));
+    EXPECT_FALSE(StrokeView::isInDashGap(dashes, 2, 5, 2));
+    EXPECT_TRUE(StrokeView::isInDashGap(dashes, 2, 6.5, 2));
+    EXPECT_FALSE(StrokeView::isInDashGap(dashes, 2, 6.5, 3));
+
+    // At the boundaries, the caps of the dashes may be drawn
+    EXPECT_FALSE(StrokeView::isInDashGap(dashes, 2, 6, 1));
+
+    // Repeated
+    EXPECT_TRUE(StrokeView::isInDashGap(dashes, 2, 9 * 100 + 7, 1));
+    EXPECT_FALSE(StrokeView::isInDashGap(dashes, 2, 9 * 100 + 1, 1));
+}
+
+TEST(StrokeDash, testOddDashCount) {
+    // Dashes and gaps of 2: a dash from 0, a gap from 2, a dash from 4...
+    const double dots[] = {2};
+    EXPECT_FALSE(StrokeView::isInDashGap(dots, 1, 0.5, 1));
+    EXPECT_TRUE(StrokeView::isInDashGap(dots, 1, 2.5, 1));
+    EXPECT_FALSE(StrokeView::isInDashGap(dots, 1, 4.5, 1));
+    EXPECT_TRUE(StrokeView::isInDashGap(dots, 1, 6.5, 1));
+
+    // Dash 1, gap 2, dash 3, gap 1, dash 2, gap 3
+    const double dashes[] = {1, 2, 3};
+    EXPECT_TRUE(StrokeView::isInDashGap(dashes, 3, 1.5, 1));
+    EXPECT_FALSE(StrokeView::isInDashGap(dashes, 3, 4, 1));
+    EXPECT_TRUE(StrokeView::isInDashGap(dashes, 3, 6.25, 0.5));
+    EXPECT_TRUE(StrokeView::isInDashGap(dashes, 3, 9.5, 2));
+    EXPECT_FALSE(StrokeView::isInDashGap(dashes, 3, 12.5, 1));
+}
@@ -0,0 +1,136 @@
+#include <memory>
+#include <string>
+
+#include <cairo-pdf.h>
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "model/TexImage.h"
+#include "view/TexImageCache.h"
+
+using xoj::view::TexImageCache;
+
+static auto makeTexImage(double width, double height) -> std::unique_ptr<TexImage> {
+    std::string data;
+    cairo_surface_t* surface = cairo_pdf_surface_create_for_stream(
+            [](void* closure, const unsigned char* bytes, unsigned int length) -> cairo_status_t {
+                static_cast<std::string*>(closure)->append(reinterpret_cast<const char*>(bytes), length);
+                return CAIRO_STATUS_SUCCESS;
+            },
+            &data, width, height);
+    cairo_t* cr = cairo_create(surface);
+    cairo_rectangle(cr, 0, 0, width / 2, height / 2);
+    cairo_fill(cr);
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+
+    auto image = std::make_unique<TexImage>();
+    EXPECT_TRUE(image->loadData(std::move(data)));
+    return image;
+}
+
+TEST(TexImageCache, testZoomBucketsAreShared) {
+    TexImageCache cache;
+    auto image = makeTexImage(20, 10);
+
+    cairo_surface_t* rendered = cache.get(image.get(), 1.5);
+    ASSERT_NE(rendered, nullptr);
+    // Rasterized at the next power of 2
+    EXPECT_EQ(cairo_image_surface_get_width(rendered), 40);
+    EXPECT_EQ(cairo_image_surface_get_height(rendered), 20);
+    EXPECT_EQ(cache.getBytes(), 20U * static_cast<size_t>(cairo_image_surface_get_stride(rendered)));
+
+    cairo_surface_t* same = cache.get(image.get(), 1.9);
+    EXPECT_EQ(same, rendered);
+    cairo_surface_destroy(same);
+
+    cairo_surface_t* other = cache.get(image.get(), 2.5);
+    EXPECT_NE(other, rendered);
+    EXPECT_EQ(cairo_image_surface_get_width(other), 80);
+    cairo_surface_destroy(other);
+
+    // The clones share the rasterizations
+    std::unique_ptr<TexImage> clone(dynamic_cast<TexImage*>(image->clone()));
+    same = cache.get(clone.get(), 2.0);
+    EXPECT_EQ(same, rendered);
+    cairo_surface_destroy(same);
+
+    cairo_surface_destroy(rendered);
+}
+
+TEST(TexImageCache, testLoadedDataIsRasterizedAgain) {
+    TexImageCache cache;
+    auto image = makeTexImage(20, 10);
+    cairo_surface_t* rendered = cache.get(image.get(), 1.0);
+    ASSERT_NE(rendered, nullptr);
+
+    auto other = makeTexImage(30, 10);
+    image->loadData(std::string(other->getBinaryData()));
+    cairo_surface_t* reloaded = cache.get(image.get(), 1.0);
+    ASSERT_NE(reloaded, nullptr);
+    EXPECT_EQ(cairo_image_surface_get_width(reloaded), 30);
+
+    cairo_surface_destroy(reloaded);
+    cairo_surface_destroy(rendered);
+}
+
+TEST(TexImageCache, testLeastRecentlyUsedIsEvicted) {
+    // Room for two 10x10 ARGB rasterizations
+    TexImageCache cache(2 * 10 * 10 * 4);
+    auto image1 = makeTexImage(10, 10);
+    auto image2 = makeTexImage(10, 10);
+    auto image3 = makeTexImage(10, 10);
+
+    cairo_surface_destroy(cache.get(image1.get(), 1.0));
+    cairo_surface_destroy(cache.get(image2.get(), 1.0));
+    // image1 becomes the most recently used
+    cairo_surface_t* rendered1 = cache.get(image1.get(), 1.0);
+    cairo_surface_destroy(cache.get(image3.get(), 1.0));
+    EXPECT_EQ(cache.getBytes(), 2U * 10U * 10U * 4U);
+
+    cairo_surface_t* again1 = cache.get(image1.get(), 1.0);
+    EXPECT_EQ(again1, rendered1);
+    cairo_surface_destroy(again1);
+    cairo_surface_destroy(rendered1);
+
+    // Too large for the budget: drawn from the vector source
+    EXPECT_EQ(cache.get(image1.get(), 2.0), nullptr);
+
+    cache.clear();
+    EXPECT_EQ(cache.getBytes(), 0U);
+}
+
+TEST(TexImageCache, testPdfIsParsedOnDemand) {
+    TexImageCache cache;
+    auto source = makeTexImage(20, 10);
+
+    // Like the images of a loaded document, which know their size
+    TexImage image;
+    image.setWidth(40);
+    image.setHeight(20);
+    EXPECT_TRUE(image.loadData(std::string(source->getBinaryData())));
+    EXPECT_TRUE(image.hasPdf());
+
+    cairo_surface_t* rendered = cache.get(&image, 1.0);
+    ASSERT_NE(rendered, nullptr);
+    EXPECT_EQ(cairo_image_surface_get_width(rendered), 20);
+    cairo_surface_destroy(rendered);
+
+    // Released once rasterized, and parsed again when needed
+    double pageWidth = 0;
+    double pageHeight = 0;
+    EXPECT_TRUE(image.getPdfPageSize(pageWidth, pageHeight));
+    EXPECT_EQ(pageWidth, 20);
+    EXPECT_EQ(pageHeight, 10);
+    PopplerDocument* pdf = image.openPdf();
+    ASSERT_NE(pdf, nullptr);
+    EXPECT_EQ(poppler_document_get_n_pages(pdf), 1);
+    g_object_unref(pdf);
+
+    TexImage invalid;
+    invalid.setWidth(10);
+    invalid.setHeight(10);
+    EXPECT_TRUE(invalid.loadData(std::string("%PDF-1.5 truncated")));
+    EXPECT_EQ(invalid.openPdf(), nullptr);
+    EXPECT_EQ(cache.get(&invalid, 1.0), nullptr);
+}